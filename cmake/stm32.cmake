@@ -7,6 +7,8 @@ include(CMakeParseArguments)
 
 option(DEBUG_HARDFAULTS "Enable debugging of hard faults via custom handler")
 option(SEMIHOSTING "Enable semihosting")
+option(TCM_AUTO_PLACE "Let tcm_report_<target> move the hot path code it finds in flash into ITCM on every target")
+set(TCM_ROOTS "taskMainPidLoop;taskGyro" CACHE STRING "Functions whose call graph tcm_report_<target> checks for ITCM placement")
 
 message("-- DEBUG_HARDFAULTS: ${DEBUG_HARDFAULTS}, SEMIHOSTING: ${SEMIHOSTING}")
 
@@ -215,12 +217,48 @@ function(generate_map_file target)
     target_link_options(${target} PRIVATE "-Wl,-Map,${map}")
 endfunction()
 
+function(setup_tcm_placement target name auto_place)
+    # The F7 and H7 linker scripts INCLUDE tcm_auto_place.ld into the ITCM code section, so it must always exist
+    set(tcm_dir ${CMAKE_BINARY_DIR}/tcm/${name})
+    set(tcm_place ${tcm_dir}/tcm_auto_place.ld)
+    set(tcm_disabled "/* Automatic ITCM placement is disabled, see TCM_AUTO_PLACE */\n")
+    set(tcm_current "")
+    if(EXISTS ${tcm_place})
+        file(READ ${tcm_place} tcm_current)
+    endif()
+    # Rewriting an unchanged file would relink the firmware on every configure
+    if(NOT EXISTS ${tcm_place} OR (NOT auto_place AND NOT tcm_current STREQUAL tcm_disabled))
+        file(WRITE ${tcm_place} "${tcm_disabled}")
+    endif()
+    target_link_options(${target} PRIVATE -Wl,-L${tcm_dir})
+    set_property(TARGET ${target} APPEND PROPERTY LINK_DEPENDS ${tcm_place})
+
+    if(CMAKE_VERSION VERSION_LESS 3.15)
+        set(map "$<TARGET_FILE:${target}>.map")
+    else()
+        set(map "$<TARGET_FILE_DIR:${target}>/$<TARGET_FILE_BASE_NAME:${target}>.map")
+    endif()
+    set(tcm_args --objdump ${CMAKE_OBJDUMP} --map ${map})
+    foreach(root ${TCM_ROOTS})
+        list(APPEND tcm_args --root ${root})
+    endforeach()
+    if(auto_place)
+        list(APPEND tcm_args --place ${tcm_place})
+    endif()
+    set(tcm_report_target tcm_report_${name})
+    add_custom_target(${tcm_report_target}
+        COMMAND ${RUBY_EXECUTABLE} ${CMAKE_SOURCE_DIR}/src/utils/tcm_report.rb ${tcm_args} $<TARGET_FILE:${target}>
+    )
+    add_dependencies(${tcm_report_target} ${target})
+    exclude_from_all(${tcm_report_target})
+endfunction()
+
 function(set_linker_script target script)
     set(script_path ${STM32_LINKER_DIR}/${args_LINKER_SCRIPT}.ld)
     if(NOT EXISTS ${script_path})
         message(FATAL_ERROR "linker script ${script_path} doesn't exist")
     endif()
-    set_target_properties(${target} PROPERTIES LINK_DEPENDS ${script_path})
+    set_property(TARGET ${target} APPEND PROPERTY LINK_DEPENDS ${script_path})
     target_link_options(${elf_target} PRIVATE -T${script_path})
 endfunction()
 
@@ -228,7 +266,7 @@ function(add_stm32_executable)
     cmake_parse_arguments(
         args
         # Boolean arguments
-        ""
+        "TCM_AUTO_PLACE"
         # Single value arguments
         "FILENAME;NAME;OPTIMIZATION;OUTPUT_BIN_FILENAME;OUTPUT_HEX_FILENAME;OUTPUT_TARGET_NAME"
         # Multi-value arguments
@@ -252,6 +290,12 @@ function(add_stm32_executable)
     target_link_libraries(${elf_target} PRIVATE ${STM32_LINK_LIBRARIES})
     target_link_options(${elf_target} PRIVATE ${STM32_LINK_OPTIONS} ${args_LINK_OPTIONS})
     generate_map_file(${elf_target})
+    # Adds the -L for tcm_auto_place.ld, which ld only searches when it comes before the -T
+    if(TCM_AUTO_PLACE OR args_TCM_AUTO_PLACE)
+        setup_tcm_placement(${elf_target} ${args_NAME} ON)
+    else()
+        setup_tcm_placement(${elf_target} ${args_NAME} OFF)
+    endif()
     set_linker_script(${elf_target} ${args_LINKER_SCRIPT})
     if(args_FILENAME)
         set(basename ${CMAKE_BINARY_DIR}/${args_FILENAME})
@@ -279,7 +323,7 @@ function(target_stm32)
     cmake_parse_arguments(
         args
         # Boolean arguments
-        "DISABLE_MSC;BOOTLOADER"
+        "DISABLE_MSC;BOOTLOADER;TCM_AUTO_PLACE"
         # Single value arguments
         "HSE_MHZ;LINKER_SCRIPT;NAME;OPENOCD_TARGET;OPTIMIZATION;STARTUP;SVD"
         # Multi-value arguments
@@ -344,6 +388,11 @@ function(target_stm32)
         set(binary_name "${binary_name}_${BUILD_SUFFIX}")
     endif()
 
+    set(tcm_auto_place)
+    if(args_TCM_AUTO_PLACE)
+        set(tcm_auto_place TCM_AUTO_PLACE)
+    endif()
+
     # Main firmware
     add_stm32_executable(
         NAME ${name}
@@ -355,6 +404,7 @@ function(target_stm32)
         LINK_OPTIONS ${args_LINK_OPTIONS}
         LINKER_SCRIPT ${args_LINKER_SCRIPT}
         OPTIMIZATION ${args_OPTIMIZATION}
+        ${tcm_auto_place}
 
         OUTPUT_HEX_FILENAME main_hex_filename
         OUTPUT_TARGET_NAME main_target_name
@@ -398,6 +448,7 @@ function(target_stm32)
             LINK_OPTIONS ${args_LINK_OPTIONS}
             LINKER_SCRIPT ${args_LINKER_SCRIPT}${for_bl_suffix}
             OPTIMIZATION ${args_OPTIMIZATION}
+            ${tcm_auto_place}
 
             OUTPUT_BIN_FILENAME for_bl_bin_filename
             OUTPUT_HEX_FILENAME for_bl_hex_filename
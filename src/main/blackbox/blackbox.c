@@ -71,12 +71,16 @@
 #include "rx/rx.h"
 #include "rx/msp_override.h"
 
+#include "scheduler/protothreads.h"
+#include "scheduler/scheduler.h"
+
 #include "sensors/diagnostics.h"
 #include "sensors/acceleration.h"
 #include "sensors/barometer.h"
 #include "sensors/battery.h"
 #include "sensors/compass.h"
 #include "sensors/gyro.h"
+#include "sensors/opflow.h"
 #include "sensors/pitotmeter.h"
 #include "sensors/rangefinder.h"
 #include "sensors/sensors.h"
@@ -99,16 +103,33 @@
 #define BLACKBOX_INVERTED_CARD_DETECTION 0
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 2);
+PG_REGISTER_WITH_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 9);
+PG_REGISTER_MIGRATION_KEEP_UNTIL(blackboxConfig_t, blackboxConfig, 8, deltaFrames);
 
 PG_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig,
     .device = DEFAULT_BLACKBOX_DEVICE,
     .rate_num = SETTING_BLACKBOX_RATE_NUM_DEFAULT,
     .rate_denom = SETTING_BLACKBOX_RATE_DENOM_DEFAULT,
     .invertedCardDetection = BLACKBOX_INVERTED_CARD_DETECTION,
+#ifdef USE_BLACKBOX_COMPRESSION
+    .compression = SETTING_BLACKBOX_COMPRESSION_DEFAULT,
+#endif
     .includeFlags = BLACKBOX_FEATURE_NAV_PID | BLACKBOX_FEATURE_NAV_POS |
         BLACKBOX_FEATURE_MAG | BLACKBOX_FEATURE_ACC | BLACKBOX_FEATURE_ATTITUDE |
         BLACKBOX_FEATURE_RC_DATA | BLACKBOX_FEATURE_RC_COMMAND | BLACKBOX_FEATURE_MOTORS,
+    .rateDivisor = {
+        [BLACKBOX_RATE_GROUP_NAV] = SETTING_BLACKBOX_NAV_RATE_DIVISOR_DEFAULT,
+        [BLACKBOX_RATE_GROUP_RC] = SETTING_BLACKBOX_RC_RATE_DIVISOR_DEFAULT,
+        [BLACKBOX_RATE_GROUP_ATTITUDE] = SETTING_BLACKBOX_ATTITUDE_RATE_DIVISOR_DEFAULT,
+        [BLACKBOX_RATE_GROUP_SENSORS] = SETTING_BLACKBOX_SENSORS_RATE_DIVISOR_DEFAULT,
+    },
+    .schedulerInterval = SETTING_BLACKBOX_SCHEDULER_INTERVAL_DEFAULT,
+    .sensorLatencyInterval = SETTING_BLACKBOX_SENSOR_LATENCY_INTERVAL_DEFAULT,
+#ifdef USE_FLASHFS_INDEX
+    .flashEraseAhead = SETTING_BLACKBOX_FLASH_ERASE_AHEAD_DEFAULT,
+#endif
+    .serialFlowControl = SETTING_BLACKBOX_SERIAL_FLOW_CONTROL_DEFAULT,
+    .deltaFrames = SETTING_BLACKBOX_DELTA_FRAMES_DEFAULT,
 );
 
 void blackboxIncludeFlagSet(uint32_t mask)
@@ -182,6 +203,15 @@ typedef struct blackboxConditionalFieldDefinition_s {
     uint8_t condition; // Decide whether this field should appear in the log
 } blackboxConditionalFieldDefinition_t;
 
+// How a main frame field is stored in blackboxMainState_t
+typedef enum {
+    BLACKBOX_STATE_NONE = 0,    // Not stored in the main state, written by the frame writer itself
+    BLACKBOX_STATE_S16,
+    BLACKBOX_STATE_U16,
+    BLACKBOX_STATE_S32,
+    BLACKBOX_STATE_U32,
+} blackboxStateType_e;
+
 typedef struct blackboxDeltaFieldDefinition_s {
     const char *name;
     int8_t fieldNameIndex;
@@ -192,184 +222,260 @@ typedef struct blackboxDeltaFieldDefinition_s {
     uint8_t Ppredict;
     uint8_t Pencode;
     uint8_t condition; // Decide whether this field should appear in the log
+
+    // Where the value lives in blackboxMainState_t
+    uint16_t stateOffset;
+    uint8_t stateType;
 } blackboxDeltaFieldDefinition_t;
 
+typedef struct blackboxMainState_s {
+    uint32_t time;
+
+    int32_t axisPID_P[XYZ_AXIS_COUNT];
+    int32_t axisPID_I[XYZ_AXIS_COUNT];
+    int32_t axisPID_D[XYZ_AXIS_COUNT];
+    int32_t axisPID_F[XYZ_AXIS_COUNT];
+    int32_t axisPID_Setpoint[XYZ_AXIS_COUNT];
+
+    int32_t mcPosAxisP[XYZ_AXIS_COUNT];
+    int32_t mcVelAxisPID[4][XYZ_AXIS_COUNT];
+    int32_t mcVelAxisOutput[XYZ_AXIS_COUNT];
+
+    int32_t mcSurfacePID[3];
+    int32_t mcSurfacePIDOutput;
+
+    int32_t fwAltPID[3];
+    int32_t fwAltPIDOutput;
+    int32_t fwPosPID[3];
+    int32_t fwPosPIDOutput;
+
+    int16_t rcData[4];
+    int16_t rcCommand[4];
+    uint16_t rcLatency;
+    int16_t gyroADC[XYZ_AXIS_COUNT];
+    int16_t gyroRaw[XYZ_AXIS_COUNT];
+
+    int16_t gyroPeaksRoll[DYN_NOTCH_PEAK_COUNT];
+    int16_t gyroPeaksPitch[DYN_NOTCH_PEAK_COUNT];
+    int16_t gyroPeaksYaw[DYN_NOTCH_PEAK_COUNT];
+
+    int16_t accADC[XYZ_AXIS_COUNT];
+    int16_t attitude[XYZ_AXIS_COUNT];
+    int32_t debug[DEBUG32_VALUE_COUNT];
+    int16_t motor[MAX_SUPPORTED_MOTORS];
+    int16_t servo[MAX_SUPPORTED_SERVOS];
+
+    uint16_t vbat;
+    int16_t amperage;
+
+#ifdef USE_BARO
+    int32_t BaroAlt;
+#endif
+#ifdef USE_PITOT
+    int32_t airSpeed;
+#endif
+#ifdef USE_MAG
+    int16_t magADC[XYZ_AXIS_COUNT];
+#endif
+#ifdef USE_RANGEFINDER
+    int32_t surfaceRaw;
+#endif
+    uint16_t rssi;
+    int16_t navState;
+    uint16_t navFlags;
+    uint16_t navEPH;
+    uint16_t navEPV;
+    int32_t navPos[XYZ_AXIS_COUNT];
+    int16_t navRealVel[XYZ_AXIS_COUNT];
+    int16_t navAccNEU[XYZ_AXIS_COUNT];
+    int16_t navTargetVel[XYZ_AXIS_COUNT];
+    int32_t navTargetPos[XYZ_AXIS_COUNT];
+    int16_t navHeading;
+    int16_t navTargetHeading;
+    int16_t navSurface;
+} blackboxMainState_t;
+
+#define MAIN_STATE(member, type) .stateOffset = offsetof(blackboxMainState_t, member), .stateType = CONCAT(BLACKBOX_STATE_, type)
+#define MAIN_STATE_NONE .stateOffset = 0, .stateType = BLACKBOX_STATE_NONE
+
 /**
  * Description of the blackbox fields we are writing in our main intra (I) and inter (P) frames. This description is
- * written into the flight log header so the log can be properly interpreted (but these definitions don't actually cause
- * the encoding to happen, we have to encode the flight log ourselves in write{Inter|Intra}frame() in a way that matches
- * the encoding we've promised here).
+ * written into the flight log header so the log can be properly interpreted, and it is also what drives the encoding:
+ * blackboxBuildMainFieldEncoders() compiles the enabled fields into blackboxMainFieldEncoders[] which
+ * write{Inter|Intra}frame() then run over the main state history.
  */
 static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     /* loopIteration doesn't appear in P frames since it always increments */
-    {"loopIteration",-1, UNSIGNED, .Ipredict = PREDICT(0),     .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(INC),           .Pencode = FLIGHT_LOG_FIELD_ENCODING_NULL, CONDITION(ALWAYS)},
+    {"loopIteration",-1, UNSIGNED, .Ipredict = PREDICT(0),     .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(INC),           .Pencode = FLIGHT_LOG_FIELD_ENCODING_NULL, CONDITION(ALWAYS), MAIN_STATE_NONE},
     /* Time advances pretty steadily so the P-frame prediction is a straight line */
-    {"time",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(STRAIGHT_LINE), .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisRate",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisRate",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisRate",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"time",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(STRAIGHT_LINE), .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(time, U32)},
+    {"axisRate",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_Setpoint[0], S32)},
+    {"axisRate",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_Setpoint[1], S32)},
+    {"axisRate",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_Setpoint[2], S32)},
+    {"axisP",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_P[0], S32)},
+    {"axisP",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_P[1], S32)},
+    {"axisP",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(axisPID_P[2], S32)},
     /* I terms get special packed encoding in P frames: */
-    {"axisI",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisI",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisI",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisD",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_0)},
-    {"axisD",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_1)},
-    {"axisD",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_2)},
-    {"axisF",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS},
-    {"axisF",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS},
-    {"axisF",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS},
-
-    {"fwAltP",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwAltI",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwAltD",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwAltOut",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwPosP",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwPosI",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwPosD",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-    {"fwPosOut",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV)},
-
-    {"mcPosAxisP",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcPosAxisP",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcPosAxisP",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisP",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisP",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisP",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisI",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisI",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisI",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisD",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisD",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisD",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisFF", 0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisFF", 1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisFF", 2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisOut",0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisOut",1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcVelAxisOut",2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcSurfaceP", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcSurfaceI", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcSurfaceD", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
-    {"mcSurfaceOut",-1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV)},
+    {"axisI",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS), MAIN_STATE(axisPID_I[0], S32)},
+    {"axisI",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS), MAIN_STATE(axisPID_I[1], S32)},
+    {"axisI",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS), MAIN_STATE(axisPID_I[2], S32)},
+    {"axisD",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_0), MAIN_STATE(axisPID_D[0], S32)},
+    {"axisD",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_1), MAIN_STATE(axisPID_D[1], S32)},
+    {"axisD",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_2), MAIN_STATE(axisPID_D[2], S32)},
+    {"axisF",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS, MAIN_STATE(axisPID_F[0], S32)},
+    {"axisF",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS, MAIN_STATE(axisPID_F[1], S32)},
+    {"axisF",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ALWAYS, MAIN_STATE(axisPID_F[2], S32)},
+
+    {"fwAltP",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwAltPID[0], S32)},
+    {"fwAltI",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwAltPID[1], S32)},
+    {"fwAltD",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwAltPID[2], S32)},
+    {"fwAltOut",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwAltPIDOutput, S32)},
+    {"fwPosP",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwPosPID[0], S32)},
+    {"fwPosI",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwPosPID[1], S32)},
+    {"fwPosD",     -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwPosPID[2], S32)},
+    {"fwPosOut",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(FIXED_WING_NAV), MAIN_STATE(fwPosPIDOutput, S32)},
+
+    {"mcPosAxisP",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcPosAxisP[0], S32)},
+    {"mcPosAxisP",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcPosAxisP[1], S32)},
+    {"mcPosAxisP",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcPosAxisP[2], S32)},
+    {"mcVelAxisP",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[0][0], S32)},
+    {"mcVelAxisP",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[0][1], S32)},
+    {"mcVelAxisP",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[0][2], S32)},
+    {"mcVelAxisI",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[1][0], S32)},
+    {"mcVelAxisI",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[1][1], S32)},
+    {"mcVelAxisI",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[1][2], S32)},
+    {"mcVelAxisD",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[2][0], S32)},
+    {"mcVelAxisD",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[2][1], S32)},
+    {"mcVelAxisD",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[2][2], S32)},
+    {"mcVelAxisFF", 0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[3][0], S32)},
+    {"mcVelAxisFF", 1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[3][1], S32)},
+    {"mcVelAxisFF", 2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisPID[3][2], S32)},
+    {"mcVelAxisOut",0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisOutput[0], S32)},
+    {"mcVelAxisOut",1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisOutput[1], S32)},
+    {"mcVelAxisOut",2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcVelAxisOutput[2], S32)},
+    {"mcSurfaceP", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcSurfacePID[0], S32)},
+    {"mcSurfaceI", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcSurfacePID[1], S32)},
+    {"mcSurfaceD", -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcSurfacePID[2], S32)},
+    {"mcSurfaceOut",-1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(MC_NAV), MAIN_STATE(mcSurfacePIDOutput, S32)},
 
     /* rcData are encoded together as a group: */
-    {"rcData",      0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA},
-    {"rcData",      1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA},
-    {"rcData",      2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA},
-    {"rcData",      3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA},
+    {"rcData",      0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA, MAIN_STATE(rcData[0], S16)},
+    {"rcData",      1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA, MAIN_STATE(rcData[1], S16)},
+    {"rcData",      2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA, MAIN_STATE(rcData[2], S16)},
+    {"rcData",      3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_DATA, MAIN_STATE(rcData[3], S16)},
     /* rcCommands are encoded together as a group in P-frames: */
-    {"rcCommand",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND},
-    {"rcCommand",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND},
-    {"rcCommand",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND},
+    {"rcCommand",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND, MAIN_STATE(rcCommand[0], S16)},
+    {"rcCommand",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND, MAIN_STATE(rcCommand[1], S16)},
+    {"rcCommand",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND, MAIN_STATE(rcCommand[2], S16)},
     /* Throttle is always in the range [minthrottle..maxthrottle]: */
-    {"rcCommand",   3, UNSIGNED, .Ipredict = PREDICT(MINTHROTTLE), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),  .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND},
+    {"rcCommand",   3, UNSIGNED, .Ipredict = PREDICT(MINTHROTTLE), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),  .Pencode = ENCODING(TAG8_4S16), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND, MAIN_STATE(rcCommand[3], S16)},
+    /* Microseconds from the end of the RC frame on the wire to the PID loop using it */
+    {"rcLatency",  -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND, MAIN_STATE(rcLatency, U16)},
 
-    {"vbat",       -1, UNSIGNED, .Ipredict = PREDICT(VBATREF), .Iencode = ENCODING(NEG_14BIT),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_VBAT},
-    {"amperage",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_AMPERAGE},
+    {"vbat",       -1, UNSIGNED, .Ipredict = PREDICT(VBATREF), .Iencode = ENCODING(NEG_14BIT),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_VBAT, MAIN_STATE(vbat, U16)},
+    {"amperage",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_AMPERAGE, MAIN_STATE(amperage, S16)},
 
 #ifdef USE_MAG
-    {"magADC",      0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG},
-    {"magADC",      1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG},
-    {"magADC",      2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG},
+    {"magADC",      0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG, MAIN_STATE(magADC[0], S16)},
+    {"magADC",      1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG, MAIN_STATE(magADC[1], S16)},
+    {"magADC",      2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_MAG, MAIN_STATE(magADC[2], S16)},
 #endif
 #ifdef USE_BARO
-    {"BaroAlt",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_BARO},
+    {"BaroAlt",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_BARO, MAIN_STATE(BaroAlt, S32)},
 #endif
 #ifdef USE_PITOT
-    {"AirSpeed",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_PITOT},
+    {"AirSpeed",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_PITOT, MAIN_STATE(airSpeed, S32)},
 #endif
 #ifdef USE_RANGEFINDER
-    {"surfaceRaw",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_SURFACE},
+    {"surfaceRaw",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_SURFACE, MAIN_STATE(surfaceRaw, S32)},
 #endif
-    {"rssi",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_RSSI},
+    {"rssi",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_RSSI, MAIN_STATE(rssi, U16)},
 
     /* Gyros and accelerometers base their P-predictions on the average of the previous 2 frames to reduce noise impact */
-    {"gyroADC",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"gyroADC",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"gyroADC",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"gyroADC",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(gyroADC[0], S16)},
+    {"gyroADC",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(gyroADC[1], S16)},
+    {"gyroADC",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(gyroADC[2], S16)},
     
-    {"gyroRaw",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW},
-    {"gyroRaw",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW},
-    {"gyroRaw",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW},
+    {"gyroRaw",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW, MAIN_STATE(gyroRaw[0], S16)},
+    {"gyroRaw",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW, MAIN_STATE(gyroRaw[1], S16)},
+    {"gyroRaw",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW, MAIN_STATE(gyroRaw[2], S16)},
     
-    {"gyroPeakRoll",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL},
-    {"gyroPeakRoll",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL},
-    {"gyroPeakRoll",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL},
+    {"gyroPeakRoll",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL, MAIN_STATE(gyroPeaksRoll[0], S16)},
+    {"gyroPeakRoll",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL, MAIN_STATE(gyroPeaksRoll[1], S16)},
+    {"gyroPeakRoll",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL, MAIN_STATE(gyroPeaksRoll[2], S16)},
     
-    {"gyroPeakPitch",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH},
-    {"gyroPeakPitch",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH},
-    {"gyroPeakPitch",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH},
+    {"gyroPeakPitch",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH, MAIN_STATE(gyroPeaksPitch[0], S16)},
+    {"gyroPeakPitch",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH, MAIN_STATE(gyroPeaksPitch[1], S16)},
+    {"gyroPeakPitch",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH, MAIN_STATE(gyroPeaksPitch[2], S16)},
     
-    {"gyroPeakYaw",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW},
-    {"gyroPeakYaw",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW},
-    {"gyroPeakYaw",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW},
+    {"gyroPeakYaw",    0, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW, MAIN_STATE(gyroPeaksYaw[0], S16)},
+    {"gyroPeakYaw",    1, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW, MAIN_STATE(gyroPeaksYaw[1], S16)},
+    {"gyroPeakYaw",    2, UNSIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW, MAIN_STATE(gyroPeaksYaw[2], S16)},
     
 
-    {"accSmooth",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
-    {"accSmooth",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
-    {"accSmooth",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
-    {"attitude",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE},
-    {"attitude",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE},
-    {"attitude",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE},
-    {"debug",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       4, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       5, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       6, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
-    {"debug",       7, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
+    {"accSmooth",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC, MAIN_STATE(accADC[0], S16)},
+    {"accSmooth",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC, MAIN_STATE(accADC[1], S16)},
+    {"accSmooth",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC, MAIN_STATE(accADC[2], S16)},
+    {"attitude",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE, MAIN_STATE(attitude[0], S16)},
+    {"attitude",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE, MAIN_STATE(attitude[1], S16)},
+    {"attitude",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ATTITUDE, MAIN_STATE(attitude[2], S16)},
+    {"debug",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[0], S32)},
+    {"debug",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[1], S32)},
+    {"debug",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[2], S32)},
+    {"debug",       3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[3], S32)},
+    {"debug",       4, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[4], S32)},
+    {"debug",       5, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[5], S32)},
+    {"debug",       6, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[6], S32)},
+    {"debug",       7, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG, MAIN_STATE(debug[7], S32)},
     /* Motors only rarely drops under minthrottle (when stick falls below mincommand), so predict minthrottle for it and use *unsigned* encoding (which is large for negative numbers but more compact for positive ones): */
-    {"motor",       0, UNSIGNED, .Ipredict = PREDICT(MINTHROTTLE), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(AVERAGE_2), .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_1)},
+    {"motor",       0, UNSIGNED, .Ipredict = PREDICT(MINTHROTTLE), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(AVERAGE_2), .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_1), MAIN_STATE(motor[0], S16)},
     /* Subsequent motors base their I-frame values on the first one, P-frame values on the average of last two frames: */
-    {"motor",       1, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_2)},
-    {"motor",       2, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_3)},
-    {"motor",       3, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_4)},
-    {"motor",       4, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_5)},
-    {"motor",       5, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_6)},
-    {"motor",       6, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_7)},
-    {"motor",       7, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_8)},
+    {"motor",       1, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_2), MAIN_STATE(motor[1], S16)},
+    {"motor",       2, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_3), MAIN_STATE(motor[2], S16)},
+    {"motor",       3, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_4), MAIN_STATE(motor[3], S16)},
+    {"motor",       4, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_5), MAIN_STATE(motor[4], S16)},
+    {"motor",       5, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_6), MAIN_STATE(motor[5], S16)},
+    {"motor",       6, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_7), MAIN_STATE(motor[6], S16)},
+    {"motor",       7, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_8), MAIN_STATE(motor[7], S16)},
 
     /* servos */
-    {"servo",       0, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       1, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       2, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       3, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       4, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       5, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       6, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       7, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       8, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       9, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       10, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       11, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       12, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       13, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       14, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-    {"servo",       15, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS)},
-
-    {"navState",  -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"navFlags",  -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"navEPH",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navEPV",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navPos",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navPos",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navPos",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navVel",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navVel",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navVel",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtVel",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtVel",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtVel",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtPos",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtPos",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navTgtPos",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navSurf",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS},
-    {"navAcc",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC},
-    {"navAcc",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC},
-    {"navAcc",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC},
+    {"servo",       0, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[0], S16)},
+    {"servo",       1, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[1], S16)},
+    {"servo",       2, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[2], S16)},
+    {"servo",       3, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[3], S16)},
+    {"servo",       4, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[4], S16)},
+    {"servo",       5, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[5], S16)},
+    {"servo",       6, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[6], S16)},
+    {"servo",       7, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[7], S16)},
+    {"servo",       8, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[8], S16)},
+    {"servo",       9, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[9], S16)},
+    {"servo",       10, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[10], S16)},
+    {"servo",       11, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[11], S16)},
+    {"servo",       12, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[12], S16)},
+    {"servo",       13, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[13], S16)},
+    {"servo",       14, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[14], S16)},
+    {"servo",       15, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),      .Pencode = ENCODING(SIGNED_VB), CONDITION(SERVOS), MAIN_STATE(servo[15], S16)},
+
+    {"navState",  -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(navState, S16)},
+    {"navFlags",  -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS), MAIN_STATE(navFlags, U16)},
+    {"navEPH",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navEPH, U16)},
+    {"navEPV",    -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navEPV, U16)},
+    {"navPos",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navPos[0], S32)},
+    {"navPos",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navPos[1], S32)},
+    {"navPos",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navPos[2], S32)},
+    {"navVel",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navRealVel[0], S16)},
+    {"navVel",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navRealVel[1], S16)},
+    {"navVel",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navRealVel[2], S16)},
+    {"navTgtVel",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetVel[0], S16)},
+    {"navTgtVel",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetVel[1], S16)},
+    {"navTgtVel",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetVel[2], S16)},
+    {"navTgtPos",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetPos[0], S32)},
+    {"navTgtPos",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetPos[1], S32)},
+    {"navTgtPos",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navTargetPos[2], S32)},
+    {"navSurf",   -1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_POS, MAIN_STATE(navSurface, S16)},
+    {"navAcc",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC, MAIN_STATE(navAccNEU[0], S16)},
+    {"navAcc",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC, MAIN_STATE(navAccNEU[1], S16)},
+    {"navAcc",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_NAV_ACC, MAIN_STATE(navAccNEU[2], S16)},
 };
 
 #ifdef USE_GPS
@@ -435,6 +541,26 @@ static const blackboxSimpleFieldDefinition_t blackboxSlowFields[] = {
     {"escTemperature",        -1, SIGNED,   PREDICT(PREVIOUS),      ENCODING(SIGNED_VB)},
 #endif
     {"rxUpdateRate",          -1, UNSIGNED, PREDICT(PREVIOUS),      ENCODING(UNSIGNED_VB)},
+    {"systemLoad",            -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"latestTask",            -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"latestTaskLateness",    -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"slowestTask",           -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"slowestTaskTime",       -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"checkFuncMaxTime",      -1, UNSIGNED, PREDICT(0),             ENCODING(UNSIGNED_VB)},
+    {"gyroLatency",           -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+    {"accLatency",            -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+#ifdef USE_MAG
+    {"magLatency",            -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+#endif
+#ifdef USE_BARO
+    {"baroLatency",           -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+#endif
+#ifdef USE_GPS
+    {"gpsLatency",            -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+#endif
+#ifdef USE_OPFLOW
+    {"flowLatency",           -1, SIGNED,   PREDICT(0),             ENCODING(SIGNED_VB)},
+#endif
 };
 
 typedef enum BlackboxState {
@@ -455,78 +581,30 @@ typedef enum BlackboxState {
 #define BLACKBOX_FIRST_HEADER_SENDING_STATE BLACKBOX_STATE_SEND_HEADER
 #define BLACKBOX_LAST_HEADER_SENDING_STATE BLACKBOX_STATE_SEND_SYSINFO
 
-typedef struct blackboxMainState_s {
-    uint32_t time;
-
-    int32_t axisPID_P[XYZ_AXIS_COUNT];
-    int32_t axisPID_I[XYZ_AXIS_COUNT];
-    int32_t axisPID_D[XYZ_AXIS_COUNT];
-    int32_t axisPID_F[XYZ_AXIS_COUNT];
-    int32_t axisPID_Setpoint[XYZ_AXIS_COUNT];
-
-    int32_t mcPosAxisP[XYZ_AXIS_COUNT];
-    int32_t mcVelAxisPID[4][XYZ_AXIS_COUNT];
-    int32_t mcVelAxisOutput[XYZ_AXIS_COUNT];
-
-    int32_t mcSurfacePID[3];
-    int32_t mcSurfacePIDOutput;
-
-    int32_t fwAltPID[3];
-    int32_t fwAltPIDOutput;
-    int32_t fwPosPID[3];
-    int32_t fwPosPIDOutput;
-
-    int16_t rcData[4];
-    int16_t rcCommand[4];
-    int16_t gyroADC[XYZ_AXIS_COUNT];
-    int16_t gyroRaw[XYZ_AXIS_COUNT];
-
-    int16_t gyroPeaksRoll[DYN_NOTCH_PEAK_COUNT];
-    int16_t gyroPeaksPitch[DYN_NOTCH_PEAK_COUNT];
-    int16_t gyroPeaksYaw[DYN_NOTCH_PEAK_COUNT];
-
-    int16_t accADC[XYZ_AXIS_COUNT];
-    int16_t attitude[XYZ_AXIS_COUNT];
-    int32_t debug[DEBUG32_VALUE_COUNT];
-    int16_t motor[MAX_SUPPORTED_MOTORS];
-    int16_t servo[MAX_SUPPORTED_SERVOS];
-
-    uint16_t vbat;
-    int16_t amperage;
-
-#ifdef USE_BARO
-    int32_t BaroAlt;
-#endif
-#ifdef USE_PITOT
-    int32_t airSpeed;
-#endif
-#ifdef USE_MAG
-    int16_t magADC[XYZ_AXIS_COUNT];
-#endif
-#ifdef USE_RANGEFINDER
-    int32_t surfaceRaw;
-#endif
-    uint16_t rssi;
-    int16_t navState;
-    uint16_t navFlags;
-    uint16_t navEPH;
-    uint16_t navEPV;
-    int32_t navPos[XYZ_AXIS_COUNT];
-    int16_t navRealVel[XYZ_AXIS_COUNT];
-    int16_t navAccNEU[XYZ_AXIS_COUNT];
-    int16_t navTargetVel[XYZ_AXIS_COUNT];
-    int32_t navTargetPos[XYZ_AXIS_COUNT];
-    int16_t navHeading;
-    int16_t navTargetHeading;
-    int16_t navSurface;
-} blackboxMainState_t;
-
 typedef struct blackboxGpsState_s {
     int32_t GPS_home[2];
     int32_t GPS_coord[2];
     uint8_t GPS_numSat;
 } blackboxGpsState_t;
 
+// Capture to use latency of each sensor [us]
+typedef struct blackboxSensorLatency_s {
+    int32_t gyro;
+    int32_t acc;
+#ifdef USE_MAG
+    int32_t mag;
+#endif
+#ifdef USE_BARO
+    int32_t baro;
+#endif
+#ifdef USE_GPS
+    int32_t gps;
+#endif
+#ifdef USE_OPFLOW
+    int32_t flow;
+#endif
+} __attribute__((__packed__)) blackboxSensorLatency_t;
+
 // This data is updated really infrequently:
 typedef struct blackboxSlowState_s {
     uint32_t flightModeFlags; // extend this data size (from uint16_t)
@@ -553,15 +631,24 @@ typedef struct blackboxSlowState_s {
     int8_t escTemperature;
 #endif
     uint16_t rxUpdateRate;
+    uint16_t systemLoad;
+    uint8_t latestTask;
+    uint32_t latestTaskLateness;
+    uint8_t slowestTask;
+    uint32_t slowestTaskTime;
+    uint32_t checkFuncMaxTime;
+    blackboxSensorLatency_t sensorLatency;
 } __attribute__((__packed__)) blackboxSlowState_t; // We pack this struct so that padding doesn't interfere with memcmp()
 
 //From rc_controls.c
-extern boxBitmask_t rcModeActivationMask;
 
 static BlackboxState blackboxState = BLACKBOX_STATE_DISABLED;
 
 static uint32_t blackboxLastArmingBeep = 0;
 static uint32_t blackboxLastFlightModeFlags = 0;
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+static uint8_t blackboxLastTaskHistogramId = 0;
+#endif
 
 static struct {
     uint32_t headerIndex;
@@ -596,6 +683,17 @@ static uint16_t vbatReference;
 
 static blackboxGpsState_t gpsHistory;
 static blackboxSlowState_t slowHistory;
+// Fields of the last G and S frames in definition order, blackbox_delta_frames stores the changes from them
+#ifdef USE_GPS
+static int32_t gpsDeltaHistory[ARRAYLEN(blackboxGpsGFields) - 1];   // Without the time field
+#endif
+static int32_t slowDeltaHistory[ARRAYLEN(blackboxSlowFields)];
+// Scheduler timings only refresh every blackbox_scheduler_interval, so they don't force a slow frame on every change
+static cfSchedulerSample_t blackboxSchedulerSample;
+static timeUs_t blackboxSchedulerSampledAt;
+// Same for the sensor latencies and blackbox_sensor_latency_interval
+static blackboxSensorLatency_t blackboxSensorLatencySample;
+static timeUs_t blackboxSensorLatencySampledAt;
 
 // Keep a history of length 2, plus a buffer for MW to store the new values into
 static EXTENDED_FASTRAM blackboxMainState_t blackboxHistoryRing[3];
@@ -603,6 +701,28 @@ static EXTENDED_FASTRAM blackboxMainState_t blackboxHistoryRing[3];
 // These point into blackboxHistoryRing, use them to know where to store history of a given age (0, 1 or 2 generations old)
 static EXTENDED_FASTRAM blackboxMainState_t* blackboxHistory[3];
 
+/*
+ * The main fields enabled for the current log in header order, along with their state location and I/P-frame
+ * predictors and encodings. Built once at log start, so per frame the encoder only loops over fields it actually writes.
+ */
+typedef struct blackboxMainFieldEncoder_s {
+    uint16_t stateOffset;
+    uint8_t stateType;
+    uint8_t Ipredict;
+    uint8_t Iencode;
+    uint8_t Ppredict;
+    uint8_t Pencode;
+    uint8_t PgroupCount;    // Number of fields starting at this one that the P-frame writes with one grouped encoding
+    uint8_t rateGroup;      // blackboxRateGroup_e, or BLACKBOX_RATE_GROUP_COUNT for fields sampled on every frame
+} blackboxMainFieldEncoder_t;
+
+static EXTENDED_FASTRAM blackboxMainFieldEncoder_t blackboxMainFieldEncoders[ARRAYLEN(blackboxMainFields)];
+static EXTENDED_FASTRAM uint8_t blackboxMainFieldEncoderCount;
+
+// Number of P-frames written since the last I-frame, used to pick the frames that sample the rate divided groups
+static uint16_t blackboxPFrameSampleIndex;
+static uint8_t blackboxRateDivisorScale = 1;    // raised while the PID loop is overloaded, see fc/load_shedding.c
+
 static bool blackboxModeActivationConditionPresent = false;
 
 /**
@@ -755,6 +875,90 @@ static bool testBlackboxCondition(FlightLogFieldCondition condition)
     return (blackboxConditionCache & position) != 0;
 }
 
+static uint8_t blackboxEncodingGroupSize(uint8_t encoding)
+{
+    switch (encoding) {
+    case ENCODING(TAG2_3S32):
+        return 3;
+    case ENCODING(TAG8_4S16):
+        return 4;
+    case ENCODING(TAG8_8SVB):
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+/*
+ * Compile the enabled main fields into blackboxMainFieldEncoders[]. Must be called after blackboxBuildConditionCache(),
+ * the fields chosen here are the ones listed in the log header.
+ */
+static uint8_t blackboxRateGroupForCondition(uint8_t condition)
+{
+    switch (condition) {
+    case FLIGHT_LOG_FIELD_CONDITION_FIXED_WING_NAV:
+    case FLIGHT_LOG_FIELD_CONDITION_MC_NAV:
+    case FLIGHT_LOG_FIELD_CONDITION_NAV_POS:
+    case FLIGHT_LOG_FIELD_CONDITION_NAV_ACC:
+        return BLACKBOX_RATE_GROUP_NAV;
+
+    case FLIGHT_LOG_FIELD_CONDITION_RC_DATA:
+    case FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND:
+        return BLACKBOX_RATE_GROUP_RC;
+
+    case FLIGHT_LOG_FIELD_CONDITION_ACC:
+    case FLIGHT_LOG_FIELD_CONDITION_ATTITUDE:
+        return BLACKBOX_RATE_GROUP_ATTITUDE;
+
+    case FLIGHT_LOG_FIELD_CONDITION_VBAT:
+    case FLIGHT_LOG_FIELD_CONDITION_AMPERAGE:
+    case FLIGHT_LOG_FIELD_CONDITION_MAG:
+    case FLIGHT_LOG_FIELD_CONDITION_BARO:
+    case FLIGHT_LOG_FIELD_CONDITION_PITOT:
+    case FLIGHT_LOG_FIELD_CONDITION_SURFACE:
+    case FLIGHT_LOG_FIELD_CONDITION_RSSI:
+        return BLACKBOX_RATE_GROUP_SENSORS;
+
+    default:
+        return BLACKBOX_RATE_GROUP_COUNT;
+    }
+}
+
+static void blackboxBuildMainFieldEncoders(void)
+{
+    blackboxMainFieldEncoder_t *group = NULL;
+
+    blackboxMainFieldEncoderCount = 0;
+
+    for (unsigned i = 0; i < ARRAYLEN(blackboxMainFields); i++) {
+        const blackboxDeltaFieldDefinition_t *def = &blackboxMainFields[i];
+
+        // loopIteration isn't part of the main state, writeIntraframe() writes it and P-frames omit it
+        if (def->stateType == BLACKBOX_STATE_NONE || !testBlackboxCondition(def->condition)) {
+            continue;
+        }
+
+        blackboxMainFieldEncoder_t *encoder = &blackboxMainFieldEncoders[blackboxMainFieldEncoderCount++];
+
+        encoder->stateOffset = def->stateOffset;
+        encoder->stateType = def->stateType;
+        encoder->Ipredict = def->Ipredict;
+        encoder->Iencode = def->Iencode;
+        encoder->Ppredict = def->Ppredict;
+        encoder->Pencode = def->Pencode;
+        encoder->rateGroup = blackboxRateGroupForCondition(def->condition);
+
+        // Consecutive logged fields sharing a grouped encoding are written together, like the decoder reads them
+        if (group && group->Pencode == def->Pencode && group->PgroupCount < blackboxEncodingGroupSize(def->Pencode)) {
+            group->PgroupCount++;
+            encoder->PgroupCount = 0;
+        } else {
+            encoder->PgroupCount = 1;
+            group = (blackboxEncodingGroupSize(def->Pencode) > 1) ? encoder : NULL;
+        }
+    }
+}
+
 static void blackboxSetState(BlackboxState newState)
 {
     //Perform initial setup required for the new state
@@ -780,460 +984,185 @@ static void blackboxSetState(BlackboxState newState)
     case BLACKBOX_STATE_RUNNING:
         blackboxSlowFrameIterationTimer = blackboxSInterval; //Force a slow frame to be written on the first iteration
         break;
-    case BLACKBOX_STATE_SHUTTING_DOWN:
-        xmitState.u.startTime = millis();
-        break;
-    default:
-        ;
-    }
-    blackboxState = newState;
-}
-
-static void writeIntraframe(void)
-{
-    blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
-
-    blackboxWrite('I');
-
-    blackboxWriteUnsignedVB(blackboxIteration);
-    blackboxWriteUnsignedVB(blackboxCurrent->time);
-
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_Setpoint, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_P, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_I, XYZ_AXIS_COUNT);
-
-    // Don't bother writing the current D term if the corresponding PID setting is zero
-    for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-        if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
-            blackboxWriteSignedVB(blackboxCurrent->axisPID_D[x]);
-        }
-    }
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_F, XYZ_AXIS_COUNT);
-
-    if (testBlackboxCondition(CONDITION(FIXED_WING_NAV))) {
-        blackboxWriteSignedVBArray(blackboxCurrent->fwAltPID, 3);
-        blackboxWriteSignedVB(blackboxCurrent->fwAltPIDOutput);
-        blackboxWriteSignedVBArray(blackboxCurrent->fwPosPID, 3);
-        blackboxWriteSignedVB(blackboxCurrent->fwPosPIDOutput);
-    }
-
-    if (testBlackboxCondition(CONDITION(MC_NAV))) {
-
-        blackboxWriteSignedVBArray(blackboxCurrent->mcPosAxisP, XYZ_AXIS_COUNT);
-
-        for (int i = 0; i < 4; i++) {
-            blackboxWriteSignedVBArray(blackboxCurrent->mcVelAxisPID[i], XYZ_AXIS_COUNT);
-        }
-
-        blackboxWriteSignedVBArray(blackboxCurrent->mcVelAxisOutput, XYZ_AXIS_COUNT);
-
-        blackboxWriteSignedVBArray(blackboxCurrent->mcSurfacePID, 3);
-        blackboxWriteSignedVB(blackboxCurrent->mcSurfacePIDOutput);
-    }
-
-    // Write raw stick positions
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_DATA)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->rcData, 4);
-    }
-
-    // Write roll, pitch and yaw first:
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->rcCommand, 3);
-
-        /*
-        * Write the throttle separately from the rest of the RC data so we can apply a predictor to it.
-        * Throttle lies in range [minthrottle..maxthrottle]:
-        */
-        blackboxWriteUnsignedVB(blackboxCurrent->rcCommand[THROTTLE] - getThrottleIdleValue());
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_VBAT)) {
-        /*
-         * Our voltage is expected to decrease over the course of the flight, so store our difference from
-         * the reference:
-         *
-         * Write 14 bits even if the number is negative (which would otherwise result in 32 bits)
-         */
-        blackboxWriteUnsignedVB((vbatReference - blackboxCurrent->vbat) & 0x3FFF);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AMPERAGE)) {
-        // 12bit value directly from ADC
-        blackboxWriteSignedVB(blackboxCurrent->amperage);
-    }
-
-#ifdef USE_MAG
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_MAG)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->magADC, XYZ_AXIS_COUNT);
-    }
-#endif
-
-#ifdef USE_BARO
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_BARO)) {
-        blackboxWriteSignedVB(blackboxCurrent->BaroAlt);
-    }
-#endif
-
-#ifdef USE_PITOT
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_PITOT)) {
-        blackboxWriteSignedVB(blackboxCurrent->airSpeed);
-    }
-#endif
-
-#ifdef USE_RANGEFINDER
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SURFACE)) {
-        blackboxWriteSignedVB(blackboxCurrent->surfaceRaw);
-    }
-#endif
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RSSI)) {
-        blackboxWriteUnsignedVB(blackboxCurrent->rssi);
-    }
-
-    blackboxWriteSigned16VBArray(blackboxCurrent->gyroADC, XYZ_AXIS_COUNT);
-                     
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->gyroRaw, XYZ_AXIS_COUNT);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL)) {
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksRoll[0]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksRoll[1]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksRoll[2]);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH)) {
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksPitch[0]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksPitch[1]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksPitch[2]);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW)) {
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksYaw[0]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksYaw[1]);
-        blackboxWriteUnsignedVB(blackboxCurrent->gyroPeaksYaw[2]);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ACC)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->accADC, XYZ_AXIS_COUNT);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ATTITUDE)) {
-        blackboxWriteSigned16VBArray(blackboxCurrent->attitude, XYZ_AXIS_COUNT);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
-        blackboxWriteSignedVBArray(blackboxCurrent->debug, DEBUG32_VALUE_COUNT);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_MOTORS)) {
-        //Motors can be below minthrottle when disarmed, but that doesn't happen much
-        blackboxWriteUnsignedVB(blackboxCurrent->motor[0] - getThrottleIdleValue());
-
-        //Motors tend to be similar to each other so use the first motor's value as a predictor of the others
-        const int motorCount = getMotorCount();
-        for (int x = 1; x < motorCount; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->motor[x] - blackboxCurrent->motor[0]);
-        }
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SERVOS)) {
-        for (int x = 0; x < MAX_SUPPORTED_SERVOS; x++) {
-            //Assume that servos spends most of its time around the center
-            blackboxWriteSignedVB(blackboxCurrent->servo[x] - 1500);
-        }
-    }
-
-    blackboxWriteSignedVB(blackboxCurrent->navState);
-    blackboxWriteSignedVB(blackboxCurrent->navFlags);
-
-    /*
-     * NAV_POS fields
-     */
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NAV_POS)) {
-        blackboxWriteSignedVB(blackboxCurrent->navEPH);
-        blackboxWriteSignedVB(blackboxCurrent->navEPV);
-
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navPos[x]);
-        }
-
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navRealVel[x]);
-        }
-
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navTargetVel[x]);
-        }
-
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navTargetPos[x]);
-        }
-
-        blackboxWriteSignedVB(blackboxCurrent->navSurface);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NAV_ACC)) {
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navAccNEU[x]);
-        }
-    }
-
-    //Rotate our history buffers:
-
-    //The current state becomes the new "before" state
-    blackboxHistory[1] = blackboxHistory[0];
-    //And since we have no other history, we also use it for the "before, before" state
-    blackboxHistory[2] = blackboxHistory[0];
-    //And advance the current state over to a blank space ready to be filled
-    blackboxHistory[0] = ((blackboxHistory[0] - blackboxHistoryRing + 1) % 3) + blackboxHistoryRing;
-
-    blackboxLoggedAnyFrames = true;
+    case BLACKBOX_STATE_SHUTTING_DOWN:
+        blackboxDeviceEndCompression();
+        xmitState.u.startTime = millis();
+        break;
+    default:
+        ;
+    }
+    blackboxState = newState;
 }
 
-static void blackboxWriteArrayUsingAveragePredictor16(int arrOffsetInHistory, int count)
+static int32_t blackboxLoadMainField(const blackboxMainState_t *state, const blackboxMainFieldEncoder_t *encoder)
 {
-    int16_t *curr  = (int16_t*) ((char*) (blackboxHistory[0]) + arrOffsetInHistory);
-    int16_t *prev1 = (int16_t*) ((char*) (blackboxHistory[1]) + arrOffsetInHistory);
-    int16_t *prev2 = (int16_t*) ((char*) (blackboxHistory[2]) + arrOffsetInHistory);
-
-    for (int i = 0; i < count; i++) {
-        // Predictor is the average of the previous two history states
-        int32_t predictor = (prev1[i] + prev2[i]) / 2;
-
-        blackboxWriteSignedVB(curr[i] - predictor);
+    const uint8_t *ptr = (const uint8_t *)state + encoder->stateOffset;
+
+    switch (encoder->stateType) {
+    case BLACKBOX_STATE_S16:
+        return *(const int16_t *)ptr;
+    case BLACKBOX_STATE_U16:
+        return *(const uint16_t *)ptr;
+    case BLACKBOX_STATE_S32:
+        return *(const int32_t *)ptr;
+    case BLACKBOX_STATE_U32:
+    default:
+        return *(const uint32_t *)ptr;
     }
 }
 
-static void blackboxWriteArrayUsingAveragePredictor32(int arrOffsetInHistory, int count)
+/*
+ * Repeat the previous frame's value of a field whose rate group isn't sampled on this frame. Every P-frame still carries
+ * the field so existing decoders read the log unchanged, but the held value mostly predicts to a zero delta.
+ */
+static void blackboxHoldMainField(const blackboxMainFieldEncoder_t *encoder)
 {
-    int32_t *curr  = (int32_t*) ((char*) (blackboxHistory[0]) + arrOffsetInHistory);
-    int32_t *prev1 = (int32_t*) ((char*) (blackboxHistory[1]) + arrOffsetInHistory);
-    int32_t *prev2 = (int32_t*) ((char*) (blackboxHistory[2]) + arrOffsetInHistory);
+    const size_t size = (encoder->stateType == BLACKBOX_STATE_S16 || encoder->stateType == BLACKBOX_STATE_U16) ? sizeof(int16_t) : sizeof(int32_t);
 
-    for (int i = 0; i < count; i++) {
-        // Predictor is the average of the previous two history states
-        int32_t predictor = ((int64_t)prev1[i] + (int64_t)prev2[i]) / 2;
-
-        blackboxWriteSignedVB(curr[i] - predictor);
-    }
+    memcpy((uint8_t *)blackboxHistory[0] + encoder->stateOffset, (const uint8_t *)blackboxHistory[1] + encoder->stateOffset, size);
 }
 
-static void writeInterframe(void)
+// Returns the difference between the field's current value and what the given predictor expects it to be
+static int32_t blackboxPredictMainField(const blackboxMainFieldEncoder_t *encoder, uint8_t predictor, int32_t throttleIdle)
 {
-    blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
-    blackboxMainState_t *blackboxLast = blackboxHistory[1];
-
-    blackboxWrite('P');
-
-    //No need to store iteration count since its delta is always 1
-
-    /*
-     * Since the difference between the difference between successive times will be nearly zero (due to consistent
-     * looptime spacing), use second-order differences.
-     */
-    blackboxWriteSignedVB((int32_t) (blackboxHistory[0]->time - 2 * blackboxHistory[1]->time + blackboxHistory[2]->time));
-
-    int32_t deltas[8];
-    arraySubInt32(deltas, blackboxCurrent->axisPID_Setpoint, blackboxLast->axisPID_Setpoint, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
-
-    arraySubInt32(deltas, blackboxCurrent->axisPID_P, blackboxLast->axisPID_P, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
-
-    /*
-     * The PID I field changes very slowly, most of the time +-2, so use an encoding
-     * that can pack all three fields into one byte in that situation.
-     */
-    arraySubInt32(deltas, blackboxCurrent->axisPID_I, blackboxLast->axisPID_I, XYZ_AXIS_COUNT);
-    blackboxWriteTag2_3S32(deltas);
-
-    /*
-     * The PID D term is frequently set to zero for yaw, which makes the result from the calculation
-     * always zero. So don't bother recording D results when PID D terms are zero.
-     */
-    for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-        if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
-            blackboxWriteSignedVB(blackboxCurrent->axisPID_D[x] - blackboxLast->axisPID_D[x]);
-        }
-    }
-
-    arraySubInt32(deltas, blackboxCurrent->axisPID_F, blackboxLast->axisPID_F, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
-
-    if (testBlackboxCondition(CONDITION(FIXED_WING_NAV))) {
-
-        arraySubInt32(deltas, blackboxCurrent->fwAltPID, blackboxLast->fwAltPID, 3);
-        blackboxWriteSignedVBArray(deltas, 3);
-
-        blackboxWriteSignedVB(blackboxCurrent->fwAltPIDOutput - blackboxLast->fwAltPIDOutput);
-
-        arraySubInt32(deltas, blackboxCurrent->fwPosPID, blackboxLast->fwPosPID, 3);
-        blackboxWriteSignedVBArray(deltas, 3);
-
-        blackboxWriteSignedVB(blackboxCurrent->fwPosPIDOutput - blackboxLast->fwPosPIDOutput);
+    const int32_t value = blackboxLoadMainField(blackboxHistory[0], encoder);
 
-    }
-
-    if (testBlackboxCondition(CONDITION(MC_NAV))) {
-        arraySubInt32(deltas, blackboxCurrent->mcPosAxisP, blackboxLast->mcPosAxisP, XYZ_AXIS_COUNT);
-        blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
+    switch (predictor) {
+    case PREDICT(PREVIOUS):
+        return value - blackboxLoadMainField(blackboxHistory[1], encoder);
 
-        for (int i = 0; i < 4; i++) {
-            arraySubInt32(deltas, blackboxCurrent->mcVelAxisPID[i], blackboxLast->mcVelAxisPID[i], XYZ_AXIS_COUNT);
-            blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
-        }
+    case PREDICT(STRAIGHT_LINE):
+        return (int32_t)((uint32_t)value - 2 * (uint32_t)blackboxLoadMainField(blackboxHistory[1], encoder) + (uint32_t)blackboxLoadMainField(blackboxHistory[2], encoder));
 
-        arraySubInt32(deltas, blackboxCurrent->mcVelAxisOutput, blackboxLast->mcVelAxisOutput, XYZ_AXIS_COUNT);
-        blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
+    case PREDICT(AVERAGE_2):
+        return value - (int32_t)(((int64_t)blackboxLoadMainField(blackboxHistory[1], encoder) + blackboxLoadMainField(blackboxHistory[2], encoder)) / 2);
 
-        arraySubInt32(deltas, blackboxCurrent->mcSurfacePID, blackboxLast->mcSurfacePID, 3);
-        blackboxWriteSignedVBArray(deltas, 3);
+    case PREDICT(MINTHROTTLE):
+        return value - throttleIdle;
 
-        blackboxWriteSignedVB(blackboxCurrent->mcSurfacePIDOutput - blackboxLast->mcSurfacePIDOutput);
-    }
+    case PREDICT(MOTOR_0):
+        return value - blackboxHistory[0]->motor[0];
 
-    /*
-     * RC tends to stay the same or fairly small for many frames at a time, so use an encoding that
-     * can pack multiple values per byte:
-     */
+    case PREDICT(1500):
+        return value - 1500;
 
-    // rcData
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_DATA)) {
-        for (int x = 0; x < 4; x++) {
-            deltas[x] = blackboxCurrent->rcData[x] - blackboxLast->rcData[x];
-        }
+    case PREDICT(VBATREF):
+        return value - vbatReference;
 
-        blackboxWriteTag8_4S16(deltas);
+    case PREDICT(0):
+    default:
+        return value;
     }
+}
 
-    // rcCommand
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_COMMAND)) {
-        for (int x = 0; x < 4; x++) {
-            deltas[x] = blackboxCurrent->rcCommand[x] - blackboxLast->rcCommand[x];
-        }
-
-        blackboxWriteTag8_4S16(deltas);
-    }
+static void blackboxWriteMainFieldValue(uint8_t encoding, int32_t value)
+{
+    switch (encoding) {
+    case ENCODING(UNSIGNED_VB):
+        blackboxWriteUnsignedVB(value);
+        break;
 
-    //Check for sensors that are updated periodically (so deltas are normally zero)
-    int optionalFieldCount = 0;
+    case ENCODING(NEG_14BIT):
+        // Write 14 bits even if the number is negative (which would otherwise result in 32 bits)
+        blackboxWriteUnsignedVB(-value & 0x3FFF);
+        break;
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_VBAT)) {
-        deltas[optionalFieldCount++] = (int32_t) blackboxCurrent->vbat - blackboxLast->vbat;
+    case ENCODING(SIGNED_VB):
+    default:
+        blackboxWriteSignedVB(value);
+        break;
     }
+}
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AMPERAGE)) {
-        deltas[optionalFieldCount++] = (int32_t) blackboxCurrent->amperage - blackboxLast->amperage;
-    }
+static void writeIntraframe(void)
+{
+    const int32_t throttleIdle = getThrottleIdleValue();
 
-#ifdef USE_MAG
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_MAG)) {
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            deltas[optionalFieldCount++] = blackboxCurrent->magADC[x] - blackboxLast->magADC[x];
-        }
-    }
-#endif
+    blackboxFrameBegin();
+    blackboxWrite('I');
 
-#ifdef USE_BARO
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_BARO)) {
-        deltas[optionalFieldCount++] = blackboxCurrent->BaroAlt - blackboxLast->BaroAlt;
-    }
-#endif
+    blackboxWriteUnsignedVB(blackboxIteration);
 
-#ifdef USE_PITOT
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_PITOT)) {
-        deltas[optionalFieldCount++] = blackboxCurrent->airSpeed - blackboxLast->airSpeed;
-    }
-#endif
+    // I-frames sample every field, the rate divided groups count their P-frames from here
+    blackboxPFrameSampleIndex = 0;
 
-#ifdef USE_RANGEFINDER
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SURFACE)) {
-        deltas[optionalFieldCount++] = blackboxCurrent->surfaceRaw - blackboxLast->surfaceRaw;
-    }
-#endif
+    for (int i = 0; i < blackboxMainFieldEncoderCount; i++) {
+        const blackboxMainFieldEncoder_t *encoder = &blackboxMainFieldEncoders[i];
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RSSI)) {
-        deltas[optionalFieldCount++] = (int32_t) blackboxCurrent->rssi - blackboxLast->rssi;
+        blackboxWriteMainFieldValue(encoder->Iencode, blackboxPredictMainField(encoder, encoder->Ipredict, throttleIdle));
     }
 
-    blackboxWriteTag8_8SVB(deltas, optionalFieldCount);
+    blackboxFrameEnd();
 
-    //Since gyros, accs and motors are noisy, base their predictions on the average of the history:
-    blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, gyroADC),   XYZ_AXIS_COUNT);
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_RAW)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, gyroRaw), XYZ_AXIS_COUNT);
-    }
-
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_ROLL)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, gyroPeaksRoll), DYN_NOTCH_PEAK_COUNT);
-    }
+    //Rotate our history buffers:
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_PITCH)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, gyroPeaksPitch), DYN_NOTCH_PEAK_COUNT);
-    }
+    //The current state becomes the new "before" state
+    blackboxHistory[1] = blackboxHistory[0];
+    //And since we have no other history, we also use it for the "before, before" state
+    blackboxHistory[2] = blackboxHistory[0];
+    //And advance the current state over to a blank space ready to be filled
+    blackboxHistory[0] = ((blackboxHistory[0] - blackboxHistoryRing + 1) % 3) + blackboxHistoryRing;
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO_PEAKS_YAW)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, gyroPeaksYaw), DYN_NOTCH_PEAK_COUNT);
-    }
+    blackboxLoggedAnyFrames = true;
+}
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ACC)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, accADC), XYZ_AXIS_COUNT);
-    }
+void blackboxSetLoadShedding(bool active)
+{
+    // Held fields encode as zero deltas, this cuts the bytes written without changing the frame layout
+    blackboxRateDivisorScale = active ? 4 : 1;
+}
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ATTITUDE)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, attitude), XYZ_AXIS_COUNT);
-    }
+static void writeInterframe(void)
+{
+    const int32_t throttleIdle = getThrottleIdleValue();
+    int32_t values[8];
+    uint8_t heldRateGroups = 0;
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
-        blackboxWriteArrayUsingAveragePredictor32(offsetof(blackboxMainState_t, debug), DEBUG32_VALUE_COUNT);
-    }
+    blackboxFrameBegin();
+    blackboxWrite('P');
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_MOTORS)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, motor),     getMotorCount());
-    }
+    //No need to store iteration count since its delta is always 1
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SERVOS)) {
-        blackboxWriteArrayUsingAveragePredictor16(offsetof(blackboxMainState_t, servo),     MAX_SUPPORTED_SERVOS);
+    blackboxPFrameSampleIndex++;
+    for (int group = 0; group < BLACKBOX_RATE_GROUP_COUNT; group++) {
+        if (blackboxPFrameSampleIndex % (blackboxConfig()->rateDivisor[group] * blackboxRateDivisorScale) != 0) {
+            heldRateGroups |= 1 << group;
+        }
     }
 
-    blackboxWriteSignedVB(blackboxCurrent->navState - blackboxLast->navState);
-
-    blackboxWriteSignedVB(blackboxCurrent->navFlags - blackboxLast->navFlags);
-
-    /*
-     * NAV_POS fields
-     */
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NAV_POS)) {
-        blackboxWriteSignedVB(blackboxCurrent->navEPH - blackboxLast->navEPH);
-        blackboxWriteSignedVB(blackboxCurrent->navEPV - blackboxLast->navEPV);
+    for (int i = 0; i < blackboxMainFieldEncoderCount; ) {
+        const blackboxMainFieldEncoder_t *encoder = &blackboxMainFieldEncoders[i];
+        const int groupCount = encoder->PgroupCount;
 
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxCurrent->navPos[x] - blackboxLast->navPos[x]);
+        for (int j = 0; j < groupCount; j++) {
+            if (heldRateGroups & (1 << encoder[j].rateGroup)) {
+                blackboxHoldMainField(&encoder[j]);
+            }
+            values[j] = blackboxPredictMainField(&encoder[j], encoder[j].Ppredict, throttleIdle);
         }
 
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxHistory[0]->navRealVel[x] - (blackboxHistory[1]->navRealVel[x] + blackboxHistory[2]->navRealVel[x]) / 2);
-        }
+        switch (encoder->Pencode) {
+        case ENCODING(TAG2_3S32):
+            blackboxWriteTag2_3S32(values);
+            break;
 
+        case ENCODING(TAG8_4S16):
+            blackboxWriteTag8_4S16(values);
+            break;
 
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxHistory[0]->navTargetVel[x] - (blackboxHistory[1]->navTargetVel[x] + blackboxHistory[2]->navTargetVel[x]) / 2);
-        }
+        case ENCODING(TAG8_8SVB):
+            blackboxWriteTag8_8SVB(values, groupCount);
+            break;
 
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxHistory[0]->navTargetPos[x] - blackboxLast->navTargetPos[x]);
+        default:
+            blackboxWriteMainFieldValue(encoder->Pencode, values[0]);
+            break;
         }
 
-        blackboxWriteSignedVB(blackboxCurrent->navSurface - blackboxLast->navSurface);
+        i += groupCount;
     }
 
-    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NAV_ACC)) {
-        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-            blackboxWriteSignedVB(blackboxHistory[0]->navAccNEU[x] - (blackboxHistory[1]->navAccNEU[x] + blackboxHistory[2]->navAccNEU[x]) / 2);
-        }
-    }
+    blackboxFrameEnd();
 
     //Rotate our history buffers
     blackboxHistory[2] = blackboxHistory[1];
@@ -1243,51 +1172,125 @@ static void writeInterframe(void)
     blackboxLoggedAnyFrames = true;
 }
 
-/* Write the contents of the global "slowHistory" to the log as an "S" frame. Because this data is logged so
- * infrequently, delta updates are not reasonable, so we log independent frames. */
-static void writeSlowFrame(void)
+/*
+ * Write the change of each field since the previous frame of the kind, in groups of eight. Fields that did not
+ * change only take a bit of the group header.
+ */
+static void writeDeltaFields(const int32_t *values, int32_t *previous, int count)
 {
-    int32_t values[3];
+    int32_t deltas[8];
 
-    blackboxWrite('S');
+    for (int i = 0; i < count; i += 8) {
+        const int groupCount = MIN(count - i, 8);
+
+        for (int j = 0; j < groupCount; j++) {
+            // Unsigned fields wrap the same way in the decoder
+            deltas[j] = (int32_t)((uint32_t)values[i + j] - (uint32_t)previous[i + j]);
+            previous[i + j] = values[i + j];
+        }
+        blackboxWriteTag8_8SVB(deltas, groupCount);
+    }
+}
 
-    blackboxWriteUnsignedVB(slowHistory.flightModeFlags);
-    blackboxWriteUnsignedVB(slowHistory.stateFlags);
+// The fields of "slowHistory" in the order of blackboxSlowFields
+static void loadSlowFrameValues(int32_t *values)
+{
+    int i = 0;
 
-    /*
-     * Most of the time these three values will be able to pack into one byte for us:
-     */
-    values[0] = slowHistory.failsafePhase;
-    values[1] = slowHistory.rxSignalReceived ? 1 : 0;
-    values[2] = slowHistory.rxFlightChannelsValid ? 1 : 0;
-    blackboxWriteTag2_3S32(values);
+    values[i++] = slowHistory.flightModeFlags;
+    values[i++] = slowHistory.stateFlags;
+
+    values[i++] = slowHistory.failsafePhase;
+    values[i++] = slowHistory.rxSignalReceived ? 1 : 0;
+    values[i++] = slowHistory.rxFlightChannelsValid ? 1 : 0;
 
-    blackboxWriteUnsignedVB(slowHistory.hwHealthStatus);
+    values[i++] = slowHistory.hwHealthStatus;
 
-    blackboxWriteUnsignedVB(slowHistory.powerSupplyImpedance);
-    blackboxWriteUnsignedVB(slowHistory.sagCompensatedVBat);
+    values[i++] = slowHistory.powerSupplyImpedance;
+    values[i++] = slowHistory.sagCompensatedVBat;
 
-    blackboxWriteSigned16VBArray(slowHistory.wind, XYZ_AXIS_COUNT);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        values[i++] = slowHistory.wind[axis];
+    }
 
 #if defined(USE_RX_MSP) && defined(USE_MSP_RC_OVERRIDE)
-    blackboxWriteUnsignedVB(slowHistory.mspOverrideFlags);
+    values[i++] = slowHistory.mspOverrideFlags;
 #endif
 
-    blackboxWriteSignedVB(slowHistory.imuTemperature);
+    values[i++] = slowHistory.imuTemperature;
 
 #ifdef USE_BARO
-    blackboxWriteSignedVB(slowHistory.baroTemperature);
+    values[i++] = slowHistory.baroTemperature;
 #endif
 
 #ifdef USE_TEMPERATURE_SENSOR
-    blackboxWriteSigned16VBArray(slowHistory.tempSensorTemperature, MAX_TEMP_SENSORS);
+    for (int sensor = 0; sensor < MAX_TEMP_SENSORS; sensor++) {
+        values[i++] = slowHistory.tempSensorTemperature[sensor];
+    }
 #endif
 
 #ifdef USE_ESC_SENSOR
-    blackboxWriteUnsignedVB(slowHistory.escRPM);
-    blackboxWriteSignedVB(slowHistory.escTemperature);
+    values[i++] = slowHistory.escRPM;
+    values[i++] = slowHistory.escTemperature;
 #endif
-    blackboxWriteUnsignedVB(slowHistory.rxUpdateRate);
+    values[i++] = slowHistory.rxUpdateRate;
+
+    values[i++] = slowHistory.systemLoad;
+    values[i++] = slowHistory.latestTask;
+    values[i++] = slowHistory.latestTaskLateness;
+    values[i++] = slowHistory.slowestTask;
+    values[i++] = slowHistory.slowestTaskTime;
+    values[i++] = slowHistory.checkFuncMaxTime;
+
+    values[i++] = slowHistory.sensorLatency.gyro;
+    values[i++] = slowHistory.sensorLatency.acc;
+#ifdef USE_MAG
+    values[i++] = slowHistory.sensorLatency.mag;
+#endif
+#ifdef USE_BARO
+    values[i++] = slowHistory.sensorLatency.baro;
+#endif
+#ifdef USE_GPS
+    values[i++] = slowHistory.sensorLatency.gps;
+#endif
+#ifdef USE_OPFLOW
+    values[i++] = slowHistory.sensorLatency.flow;
+#endif
+}
+
+/* Write the contents of the global "slowHistory" to the log as an "S" frame. Because this data is logged so
+ * infrequently, delta updates against the main frames are not reasonable, so we log independent frames unless
+ * blackbox_delta_frames is set. */
+static void writeSlowFrame(void)
+{
+    int32_t values[ARRAYLEN(blackboxSlowFields)];
+
+    loadSlowFrameValues(values);
+
+    blackboxFrameBegin();
+    blackboxWrite('S');
+
+    if (blackboxConfig()->deltaFrames) {
+        writeDeltaFields(values, slowDeltaHistory, ARRAYLEN(blackboxSlowFields));
+    } else {
+        for (unsigned i = 0; i < ARRAYLEN(blackboxSlowFields); i++) {
+            switch (blackboxSlowFields[i].encode) {
+            case FLIGHT_LOG_FIELD_ENCODING_TAG2_3S32:
+                // Most of the time these three values will be able to pack into one byte for us
+                blackboxWriteTag2_3S32(&values[i]);
+                i += 2;
+                break;
+            case FLIGHT_LOG_FIELD_ENCODING_SIGNED_VB:
+                blackboxWriteSignedVB(values[i]);
+                break;
+            default:
+                blackboxWriteUnsignedVB(values[i]);
+                break;
+            }
+        }
+    }
+
+    blackboxFrameEnd();
 
     blackboxSlowFrameIterationTimer = 0;
 }
@@ -1348,6 +1351,51 @@ static void loadSlowState(blackboxSlowState_t *slow)
 #endif
 
     slow->rxUpdateRate = getRcUpdateFrequency();
+
+    slow->systemLoad = blackboxSchedulerSample.systemLoadPercent;
+    slow->latestTask = blackboxSchedulerSample.latestTaskId;
+    slow->latestTaskLateness = blackboxSchedulerSample.maxLateness;
+    slow->slowestTask = blackboxSchedulerSample.slowestTaskId;
+    slow->slowestTaskTime = blackboxSchedulerSample.maxExecutionTime;
+    slow->checkFuncMaxTime = blackboxSchedulerSample.checkFuncMaxExecutionTime;
+    slow->sensorLatency = blackboxSensorLatencySample;
+}
+
+static void blackboxUpdateSchedulerSample(timeUs_t currentTimeUs)
+{
+    const uint16_t intervalMs = blackboxConfig()->schedulerInterval;
+
+    if (intervalMs == 0 || cmpTimeUs(currentTimeUs, blackboxSchedulerSampledAt) < (timeDelta_t)intervalMs * 1000) {
+        return;
+    }
+
+    schedulerGetSample(&blackboxSchedulerSample);
+    blackboxSchedulerSampledAt = currentTimeUs;
+}
+
+static void blackboxUpdateSensorLatencySample(timeUs_t currentTimeUs)
+{
+    const uint16_t intervalMs = blackboxConfig()->sensorLatencyInterval;
+
+    if (intervalMs == 0 || cmpTimeUs(currentTimeUs, blackboxSensorLatencySampledAt) < (timeDelta_t)intervalMs * 1000) {
+        return;
+    }
+
+    blackboxSensorLatencySample.gyro = gyro.sample.latencyUs;
+    blackboxSensorLatencySample.acc = acc.sample.latencyUs;
+#ifdef USE_MAG
+    blackboxSensorLatencySample.mag = mag.sample.latencyUs;
+#endif
+#ifdef USE_BARO
+    blackboxSensorLatencySample.baro = baro.sample.latencyUs;
+#endif
+#ifdef USE_GPS
+    blackboxSensorLatencySample.gps = gpsSol.sample.latencyUs;
+#endif
+#ifdef USE_OPFLOW
+    blackboxSensorLatencySample.flow = opflow.sample.latencyUs;
+#endif
+    blackboxSensorLatencySampledAt = currentTimeUs;
 }
 
 /**
@@ -1439,6 +1487,10 @@ void blackboxStart(void)
     }
 
     memset(&gpsHistory, 0, sizeof(gpsHistory));
+#ifdef USE_GPS
+    memset(gpsDeltaHistory, 0, sizeof(gpsDeltaHistory));
+#endif
+    memset(slowDeltaHistory, 0, sizeof(slowDeltaHistory));
 
     blackboxHistory[0] = &blackboxHistoryRing[0];
     blackboxHistory[1] = &blackboxHistoryRing[1];
@@ -1454,6 +1506,7 @@ void blackboxStart(void)
      * cache those now.
      */
     blackboxBuildConditionCache();
+    blackboxBuildMainFieldEncoders();
 
     blackboxModeActivationConditionPresent = isModeActivationConditionPresent(BOXBLACKBOX);
 
@@ -1494,18 +1547,22 @@ void blackboxFinish(void)
 #ifdef USE_GPS
 static void writeGPSHomeFrame(void)
 {
+    blackboxFrameBegin();
     blackboxWrite('H');
 
     blackboxWriteSignedVB(GPS_home.lat);
     blackboxWriteSignedVB(GPS_home.lon);
     //TODO it'd be great if we could grab the GPS current time and write that too
 
+    blackboxFrameEnd();
+
     gpsHistory.GPS_home[0] = GPS_home.lat;
     gpsHistory.GPS_home[1] = GPS_home.lon;
 }
 
 static void writeGPSFrame(timeUs_t currentTimeUs)
 {
+    blackboxFrameBegin();
     blackboxWrite('G');
 
     /*
@@ -1519,17 +1576,29 @@ static void writeGPSFrame(timeUs_t currentTimeUs)
         blackboxWriteUnsignedVB(currentTimeUs - blackboxHistory[1]->time);
     }
 
-    blackboxWriteUnsignedVB(gpsSol.fixType);
-    blackboxWriteUnsignedVB(gpsSol.numSat);
-    blackboxWriteSignedVB(gpsSol.llh.lat - gpsHistory.GPS_home[0]);
-    blackboxWriteSignedVB(gpsSol.llh.lon - gpsHistory.GPS_home[1]);
-    blackboxWriteSignedVB(gpsSol.llh.alt / 100); // meters
-    blackboxWriteUnsignedVB(gpsSol.groundSpeed);
-    blackboxWriteUnsignedVB(gpsSol.groundCourse);
-    blackboxWriteUnsignedVB(gpsSol.hdop);
-    blackboxWriteUnsignedVB(gpsSol.eph);
-    blackboxWriteUnsignedVB(gpsSol.epv);
-    blackboxWriteSigned16VBArray(gpsSol.velNED, XYZ_AXIS_COUNT);
+    if (blackboxConfig()->deltaFrames) {
+        // Coordinates from the previous G frame rather than home, a few bytes less per frame far out
+        const int32_t values[ARRAYLEN(gpsDeltaHistory)] = {
+            gpsSol.fixType, gpsSol.numSat, gpsSol.llh.lat, gpsSol.llh.lon, gpsSol.llh.alt / 100,
+            gpsSol.groundSpeed, gpsSol.groundCourse, gpsSol.hdop, gpsSol.eph, gpsSol.epv,
+            gpsSol.velNED[X], gpsSol.velNED[Y], gpsSol.velNED[Z]
+        };
+        writeDeltaFields(values, gpsDeltaHistory, ARRAYLEN(gpsDeltaHistory));
+    } else {
+        blackboxWriteUnsignedVB(gpsSol.fixType);
+        blackboxWriteUnsignedVB(gpsSol.numSat);
+        blackboxWriteSignedVB(gpsSol.llh.lat - gpsHistory.GPS_home[0]);
+        blackboxWriteSignedVB(gpsSol.llh.lon - gpsHistory.GPS_home[1]);
+        blackboxWriteSignedVB(gpsSol.llh.alt / 100); // meters
+        blackboxWriteUnsignedVB(gpsSol.groundSpeed);
+        blackboxWriteUnsignedVB(gpsSol.groundCourse);
+        blackboxWriteUnsignedVB(gpsSol.hdop);
+        blackboxWriteUnsignedVB(gpsSol.eph);
+        blackboxWriteUnsignedVB(gpsSol.epv);
+        blackboxWriteSigned16VBArray(gpsSol.velNED, XYZ_AXIS_COUNT);
+    }
+
+    blackboxFrameEnd();
 
     gpsHistory.GPS_numSat = gpsSol.numSat;
     gpsHistory.GPS_coord[0] = gpsSol.llh.lat;
@@ -1605,6 +1674,7 @@ static void loadMainState(timeUs_t currentTimeUs)
         blackboxCurrent->rcData[i] = rxGetChannelValue(i);
         blackboxCurrent->rcCommand[i] = rcCommand[i];
     }
+    blackboxCurrent->rcLatency = getRcLatencyUs();
 
     blackboxCurrent->attitude[0] = attitude.values.roll;
     blackboxCurrent->attitude[1] = attitude.values.pitch;
@@ -1655,6 +1725,27 @@ static void loadMainState(timeUs_t currentTimeUs)
     blackboxCurrent->navSurface = navActualSurface;
 }
 
+/*
+ * With blackbox_delta_frames the G and S fields are predicted from the previous frame of their kind and written in
+ * groups of eight, see writeDeltaFields(). The time of the G frame keeps its own predictor.
+ */
+static uint8_t fieldHeaderValue(char frameChar, const blackboxFieldDefinition_t *def, unsigned headerIndex)
+{
+    const uint8_t value = def->arr[headerIndex - 1];
+
+    if (blackboxConfig()->deltaFrames && (frameChar == 'G' || frameChar == 'S') &&
+        def->arr[1] != PREDICT(LAST_MAIN_FRAME_TIME)) {
+        switch (headerIndex) {
+        case 2:
+            return PREDICT(PREVIOUS);
+        case 3:
+            return ENCODING(TAG8_8SVB);
+        }
+    }
+
+    return value;
+}
+
 /**
  * Transmit the header information for the given field definitions. Transmitted header lines look like:
  *
@@ -1755,7 +1846,7 @@ static bool sendFieldDefinition(char mainFrameChar, char deltaFrameChar, const v
                 }
             } else {
                 //The other headers are integers
-                blackboxPrintf("%d", def->arr[xmitState.headerIndex - 1]);
+                blackboxPrintf("%d", fieldHeaderValue(mainFrameChar, def, xmitState.headerIndex));
             }
         }
     }
@@ -1920,6 +2011,14 @@ static bool blackboxWriteSysinfo(void)
         BLACKBOX_PRINT_HEADER_LINE("rpm_gyro_min_hz", "%d",                 rpmFilterConfig()->gyro_min_hz);
         BLACKBOX_PRINT_HEADER_LINE("rpm_gyro_q", "%d",                      rpmFilterConfig()->gyro_q);
 #endif
+#ifdef USE_BLACKBOX_COMPRESSION
+        BLACKBOX_PRINT_HEADER_LINE("Data compression", "%s",                blackboxConfig()->compression ? "LZ4 blocks" : "none");
+#endif
+        BLACKBOX_PRINT_HEADER_LINE("P rate divisors", "nav:%u,rc:%u,attitude:%u,sensors:%u",
+                                                                            blackboxConfig()->rateDivisor[BLACKBOX_RATE_GROUP_NAV],
+                                                                            blackboxConfig()->rateDivisor[BLACKBOX_RATE_GROUP_RC],
+                                                                            blackboxConfig()->rateDivisor[BLACKBOX_RATE_GROUP_ATTITUDE],
+                                                                            blackboxConfig()->rateDivisor[BLACKBOX_RATE_GROUP_SENSORS]);
         default:
             return true;
     }
@@ -1939,6 +2038,7 @@ void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
     }
 
     //Shared header for event frames
+    blackboxFrameBegin();
     blackboxWrite('E');
     blackboxWrite(event);
 
@@ -1967,11 +2067,33 @@ void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
     case FLIGHT_LOG_EVENT_IMU_FAILURE:
         blackboxWriteUnsignedVB(data->imuError.errorCode);
         break;
+    case FLIGHT_LOG_EVENT_LOAD_SHEDDING:
+        blackboxWrite(data->loadShedding.step);
+        blackboxWrite(data->loadShedding.active);
+        blackboxWrite(data->loadShedding.level);
+        break;
+    case FLIGHT_LOG_EVENT_TASK_HISTOGRAM:
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        {
+            const cfTaskHistogram_t *histogram = getTaskHistogram(data->taskHistogram.taskId);
+            blackboxWrite(data->taskHistogram.taskId);
+            blackboxWrite(SCHEDULER_HISTOGRAM_BUCKETS);
+            for (int i = 0; i < SCHEDULER_HISTOGRAM_BUCKETS; i++) {
+                blackboxWriteUnsignedVB(histogram->executionTime[i]);
+            }
+            for (int i = 0; i < SCHEDULER_HISTOGRAM_BUCKETS; i++) {
+                blackboxWriteUnsignedVB(histogram->lateness[i]);
+            }
+        }
+#endif
+        break;
     case FLIGHT_LOG_EVENT_LOG_END:
         blackboxPrintf("End of log (disarm reason:%d)", getDisarmReason());
         blackboxWrite(0);
         break;
     }
+
+    blackboxFrameEnd();
 }
 
 /* If an arming beep has played since it was last logged, write the time of the arming beep to the log as a synchronization point */
@@ -1999,6 +2121,29 @@ static void blackboxCheckAndLogFlightMode(void)
     }
 }
 
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+/* Every 8 intraframes, write the histograms of the next enabled task so all of them are cycled through during the flight */
+static void blackboxCheckAndLogTaskHistogram(void)
+{
+    if (blackboxPFrameIndex != (blackboxIFrameInterval / 2) || blackboxIFrameIndex % 8 != 0) {
+        return;
+    }
+
+    for (int i = 0; i < TASK_COUNT; i++) {
+        blackboxLastTaskHistogramId = (blackboxLastTaskHistogramId + 1) % TASK_COUNT;
+
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(blackboxLastTaskHistogramId, &taskInfo);
+        if (taskInfo.isEnabled) {
+            flightLogEvent_taskHistogram_t eventData;
+            eventData.taskId = blackboxLastTaskHistogramId;
+            blackboxLogEvent(FLIGHT_LOG_EVENT_TASK_HISTOGRAM, (flightLogEventData_t *)&eventData);
+            return;
+        }
+    }
+}
+#endif
+
 /*
  * Use the user's num/denom settings to decide if the P-frame of the given index should be logged, allowing the user to control
  * the portion of logged loop iterations.
@@ -2032,6 +2177,9 @@ static void blackboxAdvanceIterationTimers(void)
 // Called once every FC loop in order to log the current state
 static void blackboxLogIteration(timeUs_t currentTimeUs)
 {
+    blackboxUpdateSchedulerSample(currentTimeUs);
+    blackboxUpdateSensorLatencySample(currentTimeUs);
+
     // Write a keyframe every BLACKBOX_I_INTERVAL frames so we can resynchronise upon missing frames
     if (blackboxShouldLogIFrame()) {
         /*
@@ -2045,6 +2193,9 @@ static void blackboxLogIteration(timeUs_t currentTimeUs)
     } else {
         blackboxCheckAndLogArmingBeep();
         blackboxCheckAndLogFlightMode();
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        blackboxCheckAndLogTaskHistogram();
+#endif
 
         if (blackboxShouldLogPFrame(blackboxPFrameIndex)) {
             /*
@@ -2083,21 +2234,15 @@ static void blackboxLogIteration(timeUs_t currentTimeUs)
     blackboxDeviceFlush();
 }
 
-/**
- * Call each flight loop iteration to perform blackbox logging.
- */
-void blackboxUpdate(timeUs_t currentTimeUs)
+static bool blackboxIsSendingHeader(void)
 {
-    if (blackboxState >= BLACKBOX_FIRST_HEADER_SENDING_STATE && blackboxState <= BLACKBOX_LAST_HEADER_SENDING_STATE) {
-        blackboxReplenishHeaderBudget();
-    }
+    return blackboxState >= BLACKBOX_FIRST_HEADER_SENDING_STATE && blackboxState <= BLACKBOX_LAST_HEADER_SENDING_STATE;
+}
 
+// Sends the next chunk of the log header within blackboxHeaderBudget
+static void blackboxSendHeaderStep(void)
+{
     switch (blackboxState) {
-    case BLACKBOX_STATE_PREPARE_LOG_FILE:
-        if (blackboxDeviceBeginLog()) {
-            blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
-        }
-        break;
     case BLACKBOX_STATE_SEND_HEADER:
         //On entry of this state, xmitState.headerIndex is 0 and startTime is intialised
 
@@ -2165,10 +2310,63 @@ void blackboxUpdate(timeUs_t currentTimeUs)
              * could wipe out the end of the header if we weren't careful)
              */
             if (blackboxDeviceFlushForce()) {
+                blackboxDeviceBeginCompression();
                 blackboxSetState(BLACKBOX_STATE_RUNNING);
             }
         }
         break;
+    default:
+        break;
+    }
+}
+
+static void blackboxSendHeaderIteration(void)
+{
+    blackboxReplenishHeaderBudget();
+    blackboxSendHeaderStep();
+
+    // Did we run out of room on the device? Stop!
+    if (isBlackboxDeviceFull()) {
+        blackboxSetState(BLACKBOX_STATE_STOPPED);
+    }
+}
+
+#ifdef USE_SCHEDULER_IDLE_JOBS
+// The header is sent in the time the scheduler has left instead of in the PID loop
+STATIC_PROTOTHREAD(blackboxSendHeaderJob)
+{
+    ptBegin(blackboxSendHeaderJob);
+
+    while (blackboxIsSendingHeader()) {
+        blackboxSendHeaderIteration();
+        ptYield();
+    }
+
+    ptEnd(0);
+}
+#endif
+
+/**
+ * Call each flight loop iteration to perform blackbox logging.
+ */
+void blackboxUpdate(timeUs_t currentTimeUs)
+{
+    if (blackboxIsSendingHeader()) {
+#ifdef USE_SCHEDULER_IDLE_JOBS
+        if (schedulerPostIdleProtothread(blackboxSendHeaderJob)) {
+            return;
+        }
+#endif
+        blackboxSendHeaderIteration();
+        return;
+    }
+
+    switch (blackboxState) {
+    case BLACKBOX_STATE_PREPARE_LOG_FILE:
+        if (blackboxDeviceBeginLog()) {
+            blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
+        }
+        break;
     case BLACKBOX_STATE_PAUSED:
         // Only allow resume to occur during an I-frame iteration, so that we have an "I" base to work from
         if (IS_RC_MODE_ACTIVE(BOXBLACKBOX) && blackboxShouldLogIFrame()) {
@@ -2228,6 +2426,8 @@ static bool canUseBlackboxWithCurrentConfiguration(void)
  */
 void blackboxInit(void)
 {
+    blackboxDeviceAllocateBuffers();
+
     if (canUseBlackboxWithCurrentConfiguration()) {
         blackboxSetState(BLACKBOX_STATE_STOPPED);
     } else {
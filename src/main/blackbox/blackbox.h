@@ -36,12 +36,29 @@ typedef enum {
     BLACKBOX_FEATURE_GYRO_PEAKS_PITCH   = 1 << 11,
     BLACKBOX_FEATURE_GYRO_PEAKS_YAW     = 1 << 12,
 } blackboxFeatureMask_e;
+
+// Field groups that can be sampled on fewer P-frames than the gyro, PID and motor fields
+typedef enum {
+    BLACKBOX_RATE_GROUP_NAV = 0,        // NAV_POS, NAV_ACC and the navigation PID fields
+    BLACKBOX_RATE_GROUP_RC,             // RC_DATA and RC_COMMAND
+    BLACKBOX_RATE_GROUP_ATTITUDE,       // ACC and ATTITUDE
+    BLACKBOX_RATE_GROUP_SENSORS,        // vbat, amperage, mag, baro, pitot, rangefinder and rssi
+    BLACKBOX_RATE_GROUP_COUNT
+} blackboxRateGroup_e;
+
 typedef struct blackboxConfig_s {
     uint16_t rate_num;
     uint16_t rate_denom;
     uint8_t device;
     uint8_t invertedCardDetection;
+    uint8_t compression;
     uint32_t includeFlags;
+    uint8_t rateDivisor[BLACKBOX_RATE_GROUP_COUNT];     // Sample the group on every Nth logged main frame
+    uint16_t schedulerInterval;                         // [ms] scheduler load sample interval for the slow frame, 0 disables
+    uint16_t sensorLatencyInterval;                     // [ms] sensor latency sample interval for the slow frame, 0 disables
+    uint16_t flashEraseAhead;                           // [KiB] space kept erased ahead of flash logs, 0 disables
+    uint8_t serialFlowControl;                          // Serial logs wait for the logger's CTS signal
+    uint8_t deltaFrames;                                // G and S frames store changes from the previous frame of their kind
 } blackboxConfig_t;
 
 PG_DECLARE(blackboxConfig_t, blackboxConfig);
@@ -54,5 +71,6 @@ void blackboxStart(void);
 void blackboxFinish(void);
 bool blackboxMayEditConfig(void);
 void blackboxIncludeFlagSet(uint32_t mask);
+void blackboxSetLoadShedding(bool active);
 void blackboxIncludeFlagClear(uint32_t mask);
 bool blackboxIncludeFlag(uint32_t mask);
\ No newline at end of file
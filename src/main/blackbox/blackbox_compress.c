@@ -0,0 +1,140 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_BLACKBOX_COMPRESSION
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "blackbox/blackbox_compress.h"
+
+// LZ4 block format constraints
+#define LZ4_MIN_MATCH           4
+#define LZ4_MFLIMIT             12      // Last match must start at least this many bytes before the end of the block
+#define LZ4_LAST_LITERALS       5       // Last bytes of a block are always literals
+#define LZ4_RUN_MASK            15
+
+#define LZ4_HASH_BITS           8
+
+STATIC_ASSERT(BLACKBOX_COMPRESSION_BLOCK_SIZE <= 0x7FFF, blackbox_compression_block_too_large);
+
+static uint32_t lz4Read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t lz4Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static uint8_t *lz4WriteLength(uint8_t *op, uint32_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = length;
+    return op;
+}
+
+static uint8_t *lz4WriteSequence(uint8_t *op, const uint8_t *literals, uint32_t literalLength, uint16_t offset, uint32_t matchLength)
+{
+    uint8_t *token = op++;
+
+    *token = MIN(literalLength, (uint32_t)LZ4_RUN_MASK) << 4;
+    if (literalLength >= LZ4_RUN_MASK) {
+        op = lz4WriteLength(op, literalLength - LZ4_RUN_MASK);
+    }
+
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    // Final sequence of a block carries literals only
+    if (offset) {
+        *op++ = offset & 0xFF;
+        *op++ = offset >> 8;
+
+        matchLength -= LZ4_MIN_MATCH;
+        *token |= MIN(matchLength, (uint32_t)LZ4_RUN_MASK);
+        if (matchLength >= LZ4_RUN_MASK) {
+            op = lz4WriteLength(op, matchLength - LZ4_RUN_MASK);
+        }
+    }
+
+    return op;
+}
+
+/*
+ * Greedy single-probe LZ4 block compressor. Every input byte costs at most one hash lookup and every byte of a match
+ * one compare, so the time spent on a block is linear in its size.
+ *
+ * dst must have room for BLACKBOX_COMPRESSION_BOUND(srcLen) bytes. Returns the compressed size.
+ */
+int blackboxCompressBlock(const uint8_t *src, int srcLen, uint8_t *dst)
+{
+    uint16_t hashTable[1 << LZ4_HASH_BITS];
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t * const iend = src + srcLen;
+    uint8_t *op = dst;
+
+    if (srcLen > LZ4_MFLIMIT) {
+        const uint8_t * const mflimit = iend - LZ4_MFLIMIT;
+        const uint8_t * const matchlimit = iend - LZ4_LAST_LITERALS;
+
+        memset(hashTable, 0, sizeof(hashTable));
+
+        while (ip < mflimit) {
+            const uint32_t sequence = lz4Read32(ip);
+            const uint32_t hash = lz4Hash(sequence);
+            const uint8_t *ref = src + hashTable[hash];
+
+            hashTable[hash] = ip - src;
+
+            if (ref >= ip || lz4Read32(ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            const uint8_t *matchEnd = ip + LZ4_MIN_MATCH;
+            ref += LZ4_MIN_MATCH;
+            while (matchEnd < matchlimit && *matchEnd == *ref) {
+                matchEnd++;
+                ref++;
+            }
+
+            op = lz4WriteSequence(op, anchor, ip - anchor, matchEnd - ref, matchEnd - ip);
+
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    op = lz4WriteSequence(op, anchor, iend - anchor, 0, 0);
+
+    return op - dst;
+}
+
+#endif
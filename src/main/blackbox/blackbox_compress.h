@@ -0,0 +1,40 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Blackbox frame data is compressed in independent blocks of at most BLACKBOX_COMPRESSION_BLOCK_SIZE bytes, each one
+ * encoded in the LZ4 block format. Matches never reach outside their block, so memory use and the work done per block
+ * are fixed.
+ *
+ * Every block is written to the log as:
+ *  U8  BLACKBOX_COMPRESSION_BLOCK_MARKER
+ *  U16 payload length (little endian), BLACKBOX_COMPRESSION_BLOCK_STORED set if the payload is uncompressed
+ *  payload
+ */
+#define BLACKBOX_COMPRESSION_BLOCK_SIZE         512
+#define BLACKBOX_COMPRESSION_BLOCK_MARKER       'Z'
+#define BLACKBOX_COMPRESSION_BLOCK_STORED       0x8000
+#define BLACKBOX_COMPRESSION_HEADER_SIZE        3
+
+// Worst case size of the LZ4 encoding of len bytes of incompressible data
+#define BLACKBOX_COMPRESSION_BOUND(len)         ((len) + (len) / 255 + 16)
+
+int blackboxCompressBlock(const uint8_t *src, int srcLen, uint8_t *dst);
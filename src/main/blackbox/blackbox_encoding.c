@@ -29,6 +29,7 @@
 #include "common/encoding.h"
 #include "common/printf.h"
 
+#define VB_MAX_BYTES    5   // 7 bits per byte of a 32 bit value
 
 static void _putc(void *p, char c)
 {
@@ -83,14 +84,21 @@ void blackboxPrintfHeaderLine(const char *name, const char *fmt, ...)
 /**
  * Write an unsigned integer to the blackbox serial port using variable byte encoding.
  */
-void blackboxWriteUnsignedVB(uint32_t value)
+static inline uint8_t *writeUnsignedVB(uint8_t *pos, uint32_t value)
 {
     //While this isn't the final byte (we can only write 7 bits at a time)
     while (value > 127) {
-        blackboxWrite((uint8_t) (value | 0x80)); // Set the high bit to mean "more bytes follow"
+        *pos++ = (uint8_t) (value | 0x80); // Set the high bit to mean "more bytes follow"
         value >>= 7;
     }
-    blackboxWrite(value);
+    *pos++ = value;
+
+    return pos;
+}
+
+void blackboxWriteUnsignedVB(uint32_t value)
+{
+    blackboxFrameAdvance(writeUnsignedVB(blackboxFrameReserve(VB_MAX_BYTES), value));
 }
 
 /**
@@ -99,27 +107,31 @@ void blackboxWriteUnsignedVB(uint32_t value)
 void blackboxWriteSignedVB(int32_t value)
 {
     //ZigZag encode to make the value always positive
-    blackboxWriteUnsignedVB(zigzagEncode(value));
+    blackboxFrameAdvance(writeUnsignedVB(blackboxFrameReserve(VB_MAX_BYTES), zigzagEncode(value)));
 }
 
 void blackboxWriteSignedVBArray(int32_t *array, int count)
 {
     for (int i = 0; i < count; i++) {
-        blackboxWriteSignedVB(array[i]);
+        blackboxFrameAdvance(writeUnsignedVB(blackboxFrameReserve(VB_MAX_BYTES), zigzagEncode(array[i])));
     }
 }
 
 void blackboxWriteSigned16VBArray(int16_t *array, int count)
 {
     for (int i = 0; i < count; i++) {
-        blackboxWriteSignedVB(array[i]);
+        blackboxFrameAdvance(writeUnsignedVB(blackboxFrameReserve(VB_MAX_BYTES), zigzagEncode(array[i])));
     }
 }
 
 void blackboxWriteS16(int16_t value)
 {
-    blackboxWrite(value & 0xFF);
-    blackboxWrite((value >> 8) & 0xFF);
+    uint8_t *pos = blackboxFrameReserve(2);
+
+    *pos++ = value & 0xFF;
+    *pos++ = (value >> 8) & 0xFF;
+
+    blackboxFrameAdvance(pos);
 }
 
 /**
@@ -145,6 +157,7 @@ void blackboxWriteTag2_3S32(int32_t *values)
     };
 
     int selector = BITS_2, selector2;
+    uint8_t *pos = blackboxFrameReserve(1 + NUM_FIELDS * 4);
 
     /*
      * Find out how many bits the largest value requires to encode, and use it to choose one of the packing schemes
@@ -178,16 +191,16 @@ void blackboxWriteTag2_3S32(int32_t *values)
 
     switch (selector) {
     case BITS_2:
-        blackboxWrite((selector << 6) | ((values[0] & 0x03) << 4) | ((values[1] & 0x03) << 2) | (values[2] & 0x03));
+        *pos++ = (selector << 6) | ((values[0] & 0x03) << 4) | ((values[1] & 0x03) << 2) | (values[2] & 0x03);
         break;
     case BITS_4:
-        blackboxWrite((selector << 6) | (values[0] & 0x0F));
-        blackboxWrite((values[1] << 4) | (values[2] & 0x0F));
+        *pos++ = (selector << 6) | (values[0] & 0x0F);
+        *pos++ = (values[1] << 4) | (values[2] & 0x0F);
         break;
     case BITS_6:
-        blackboxWrite((selector << 6) | (values[0] & 0x3F));
-        blackboxWrite((uint8_t)values[1]);
-        blackboxWrite((uint8_t)values[2]);
+        *pos++ = (selector << 6) | (values[0] & 0x3F);
+        *pos++ = (uint8_t)values[1];
+        *pos++ = (uint8_t)values[2];
         break;
     case BITS_32:
         /*
@@ -217,33 +230,35 @@ void blackboxWriteTag2_3S32(int32_t *values)
         }
 
         //Write the selectors
-        blackboxWrite((selector << 6) | selector2);
+        *pos++ = (selector << 6) | selector2;
 
         //And now the values according to the selectors we picked for them
         for (int x = 0; x < NUM_FIELDS; x++, selector2 >>= 2) {
             switch (selector2 & 0x03) {
             case BYTES_1:
-                blackboxWrite(values[x]);
+                *pos++ = values[x];
                 break;
             case BYTES_2:
-                blackboxWrite(values[x]);
-                blackboxWrite(values[x] >> 8);
+                *pos++ = values[x];
+                *pos++ = values[x] >> 8;
                 break;
             case BYTES_3:
-                blackboxWrite(values[x]);
-                blackboxWrite(values[x] >> 8);
-                blackboxWrite(values[x] >> 16);
+                *pos++ = values[x];
+                *pos++ = values[x] >> 8;
+                *pos++ = values[x] >> 16;
                 break;
             case BYTES_4:
-                blackboxWrite(values[x]);
-                blackboxWrite(values[x] >> 8);
-                blackboxWrite(values[x] >> 16);
-                blackboxWrite(values[x] >> 24);
+                *pos++ = values[x];
+                *pos++ = values[x] >> 8;
+                *pos++ = values[x] >> 16;
+                *pos++ = values[x] >> 24;
                 break;
             }
         }
         break;
     }
+
+    blackboxFrameAdvance(pos);
 }
 
 /**
@@ -261,6 +276,8 @@ void blackboxWriteTag8_4S16(int32_t *values)
     };
 
     uint8_t selector = 0;
+    uint8_t *pos = blackboxFrameReserve(1 + 4 * 2);
+
     //Encode in reverse order so the first field is in the low bits:
     for (int x = 3; x >= 0; x--) {
         selector <<= 2;
@@ -276,7 +293,7 @@ void blackboxWriteTag8_4S16(int32_t *values)
         }
     }
 
-    blackboxWrite(selector);
+    *pos++ = selector;
 
     int nibbleIndex = 0;
     uint8_t buffer = 0;
@@ -291,16 +308,16 @@ void blackboxWriteTag8_4S16(int32_t *values)
                 buffer = values[x] << 4;
                 nibbleIndex = 1;
             } else {
-                blackboxWrite(buffer | (values[x] & 0x0F));
+                *pos++ = buffer | (values[x] & 0x0F);
                 nibbleIndex = 0;
             }
             break;
         case FIELD_8BIT:
             if (nibbleIndex == 0) {
-                blackboxWrite(values[x]);
+                *pos++ = values[x];
             } else {
                 //Write the high bits of the value first (mask to avoid sign extension)
-                blackboxWrite(buffer | ((values[x] >> 4) & 0x0F));
+                *pos++ = buffer | ((values[x] >> 4) & 0x0F);
                 //Now put the leftover low bits into the top of the next buffer entry
                 buffer = values[x] << 4;
             }
@@ -308,13 +325,13 @@ void blackboxWriteTag8_4S16(int32_t *values)
         case FIELD_16BIT:
             if (nibbleIndex == 0) {
                 //Write high byte first
-                blackboxWrite(values[x] >> 8);
-                blackboxWrite(values[x]);
+                *pos++ = values[x] >> 8;
+                *pos++ = values[x];
             } else {
                 //First write the highest 4 bits
-                blackboxWrite(buffer | ((values[x] >> 12) & 0x0F));
+                *pos++ = buffer | ((values[x] >> 12) & 0x0F);
                 // Then the middle 8
-                blackboxWrite(values[x] >> 4);
+                *pos++ = values[x] >> 4;
                 //Only the smallest 4 bits are still left to write
                 buffer = values[x] << 4;
             }
@@ -323,8 +340,10 @@ void blackboxWriteTag8_4S16(int32_t *values)
     }
     //Anything left over to write?
     if (nibbleIndex == 1) {
-        blackboxWrite(buffer);
+        *pos++ = buffer;
     }
+
+    blackboxFrameAdvance(pos);
 }
 
 /**
@@ -342,6 +361,8 @@ void blackboxWriteTag8_8SVB(int32_t *values, int valueCount)
         if (valueCount == 1) {
             blackboxWriteSignedVB(values[0]);
         } else {
+            uint8_t *pos = blackboxFrameReserve(1 + 8 * VB_MAX_BYTES);
+
             //First write a one-byte header that marks which fields are non-zero
             header = 0;
 
@@ -354,13 +375,15 @@ void blackboxWriteTag8_8SVB(int32_t *values, int valueCount)
                 }
             }
 
-            blackboxWrite(header);
+            *pos++ = header;
 
             for (int i = 0; i < valueCount; i++) {
                 if (values[i] != 0) {
-                    blackboxWriteSignedVB(values[i]);
+                    pos = writeUnsignedVB(pos, zigzagEncode(values[i]));
                 }
             }
+
+            blackboxFrameAdvance(pos);
         }
     }
 }
@@ -368,10 +391,14 @@ void blackboxWriteTag8_8SVB(int32_t *values, int valueCount)
 /** Write unsigned integer **/
 void blackboxWriteU32(int32_t value)
 {
-    blackboxWrite(value & 0xFF);
-    blackboxWrite((value >> 8) & 0xFF);
-    blackboxWrite((value >> 16) & 0xFF);
-    blackboxWrite((value >> 24) & 0xFF);
+    uint8_t *pos = blackboxFrameReserve(4);
+
+    *pos++ = value & 0xFF;
+    *pos++ = (value >> 8) & 0xFF;
+    *pos++ = (value >> 16) & 0xFF;
+    *pos++ = (value >> 24) & 0xFF;
+
+    blackboxFrameAdvance(pos);
 }
 
 /** Write float value in the integer form **/
@@ -129,6 +129,8 @@ typedef enum FlightLogEvent {
     FLIGHT_LOG_EVENT_LOGGING_RESUME = 14,
     FLIGHT_LOG_EVENT_FLIGHTMODE = 30, // Add new event type for flight mode status.
     FLIGHT_LOG_EVENT_IMU_FAILURE = 40,
+    FLIGHT_LOG_EVENT_TASK_HISTOGRAM = 41,
+    FLIGHT_LOG_EVENT_LOAD_SHEDDING = 42,
     FLIGHT_LOG_EVENT_LOG_END = 255
 } FlightLogEvent;
 
@@ -157,6 +159,16 @@ typedef struct flightLogEvent_IMUError_s {
     uint32_t errorCode;
 } flightLogEvent_IMUError_t;
 
+typedef struct flightLogEvent_taskHistogram_s {
+    uint8_t taskId;
+} flightLogEvent_taskHistogram_t;
+
+typedef struct flightLogEvent_loadShedding_s {
+    uint8_t step;
+    bool active;
+    uint8_t level;
+} flightLogEvent_loadShedding_t;
+
 #define FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG 128
 
 typedef union flightLogEventData_u {
@@ -165,6 +177,8 @@ typedef union flightLogEventData_u {
     flightLogEvent_inflightAdjustment_t inflightAdjustment;
     flightLogEvent_loggingResume_t loggingResume;
     flightLogEvent_IMUError_t imuError;
+    flightLogEvent_taskHistogram_t taskHistogram;
+    flightLogEvent_loadShedding_t loadShedding;
 } flightLogEventData_t;
 
 typedef struct flightLogEvent_s {
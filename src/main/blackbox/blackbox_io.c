@@ -24,17 +24,23 @@
 #ifdef USE_BLACKBOX
 
 #include "blackbox.h"
+#include "blackbox_compress.h"
 #include "blackbox_io.h"
 
 #include "common/axis.h"
 #include "common/encoding.h"
 #include "common/maths.h"
+#include "common/memory.h"
 #include "common/printf.h"
 #include "common/typeconversion.h"
+#include "common/utils.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
 
+#include "drivers/sdcard/sdcard.h"
+#include "drivers/time.h"
+
 #include "io/asyncfatfs/asyncfatfs.h"
 #include "io/flashfs.h"
 #include "io/serial.h"
@@ -43,6 +49,7 @@
 
 #include "sensors/gyro.h"
 #include "fc/config.h"
+#include "fc/runtime_config.h"
 
 #define BLACKBOX_SERIAL_PORT_MODE MODE_TX
 
@@ -57,6 +64,28 @@ STATIC_UNIT_TESTED serialPort_t *blackboxPort = NULL;
 static portSharing_e blackboxPortSharing;
 #endif // UNIT_TEST
 
+// Releases what was queued since the last call to the port, one transfer on ports with TX DMA
+static void blackboxSerialFlush(void)
+{
+    serialEndWrite(blackboxPort);
+    serialBeginWrite(blackboxPort);
+}
+
+#ifdef BLACKBOX_SERIAL_BUFFER_SIZE
+/*
+ * TX ring the serial port uses instead of its own small one while it logs, claimed from the memory arena at
+ * boot. Bytes are queued through the iteration and handed to the UART TX DMA stream in one go at its end,
+ * which keeps a 2 Mbaud logger busy without an interrupt per byte.
+ */
+static struct {
+    volatile uint8_t *data;
+    uint32_t size;
+} blackboxSerialBuffer;
+
+// The ring must be a power of two
+#define BLACKBOX_SERIAL_BUFFER_MIN_SIZE     1024
+#endif
+
 #ifdef USE_SDCARD
 
 static struct {
@@ -75,6 +104,96 @@ static struct {
     } state;
 } blackboxSDCard;
 
+/*
+ * Log data is encoded into this RAM ring from the PID loop and drained into the filesystem cache by the
+ * blackbox writer task, so SD card latency never stalls the encoder. The ring is claimed from the memory
+ * arena at boot and gets whatever the other blackbox buffers left, see blackboxDeviceAllocateBuffers().
+ */
+static struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t head;                  // Free-running write index
+    uint32_t tail;                  // Free-running read index
+    uint32_t rateWindowStartMs;
+    uint32_t rateWindowBytes;
+} blackboxSDCardBuffer;
+
+// Smallest ring that still holds a few frames of a fast log
+#define BLACKBOX_SDCARD_BUFFER_MIN_SIZE     1024
+
+static blackboxSDCardBufferStats_t blackboxSDCardBufferStats;
+
+static uint32_t blackboxSDCardBufferUsed(void)
+{
+    return blackboxSDCardBuffer.head - blackboxSDCardBuffer.tail;
+}
+
+static uint32_t blackboxSDCardBufferFree(void)
+{
+    // One byte is kept in reserve to mirror the serial buffer semantics the header budget expects
+    return blackboxSDCardBuffer.size ? blackboxSDCardBuffer.size - 1 - blackboxSDCardBufferUsed() : 0;
+}
+
+static void blackboxSDCardBufferWrite(const uint8_t *data, uint32_t length)
+{
+    // Bytes that don't fit are dropped, the same as afatfs_fwrite() does when its cache is full
+    const uint32_t accepted = MIN(length, blackboxSDCardBufferFree());
+    blackboxSDCardBufferStats.droppedBytes += length - accepted;
+    blackboxSDCardBuffer.rateWindowBytes += accepted;
+    length = accepted;
+
+    while (length > 0) {
+        const uint32_t offset = blackboxSDCardBuffer.head % blackboxSDCardBuffer.size;
+        const uint32_t chunk = MIN(length, blackboxSDCardBuffer.size - offset);
+
+        memcpy(&blackboxSDCardBuffer.data[offset], data, chunk);
+        blackboxSDCardBuffer.head += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    blackboxSDCardBufferStats.peakUsedBytes = MAX(blackboxSDCardBufferStats.peakUsedBytes, blackboxSDCardBufferUsed());
+}
+
+/*
+ * Measure the logging byte rate once a second and work out how much buffer the current card latency estimate
+ * implies: a stall of latencyEstimateUs has to be absorbed by the ring while the PID loop keeps producing data.
+ */
+static void blackboxSDCardBufferUpdateStats(void)
+{
+    const timeMs_t now = millis();
+
+    if (now - blackboxSDCardBuffer.rateWindowStartMs >= 1000) {
+        blackboxSDCardBufferStats.bytesPerSecond = blackboxSDCardBuffer.rateWindowBytes * 1000 / (now - blackboxSDCardBuffer.rateWindowStartMs);
+        blackboxSDCardBuffer.rateWindowBytes = 0;
+        blackboxSDCardBuffer.rateWindowStartMs = now;
+    }
+
+    const uint64_t latencyUs = sdcard_getWriteStats()->latencyEstimateUs;
+    blackboxSDCardBufferStats.requiredBytes = (uint64_t)blackboxSDCardBufferStats.bytesPerSecond * latencyUs / 1000000;
+}
+
+/**
+ * Move buffered log data into the filesystem cache. Returns true once the buffer is empty.
+ */
+static bool blackboxSDCardBufferDrain(void)
+{
+    while (blackboxSDCard.logFile && blackboxSDCardBufferUsed() > 0) {
+        const uint32_t offset = blackboxSDCardBuffer.tail % blackboxSDCardBuffer.size;
+        const uint32_t chunk = MIN(blackboxSDCardBufferUsed(), blackboxSDCardBuffer.size - offset);
+        const uint32_t written = afatfs_fwrite(blackboxSDCard.logFile, &blackboxSDCardBuffer.data[offset], chunk);
+
+        blackboxSDCardBuffer.tail += written;
+
+        if (written < chunk) {
+            // Filesystem cache is full, the rest has to wait until afatfs_poll() pushes sectors to the card
+            break;
+        }
+    }
+
+    return blackboxSDCardBufferUsed() == 0;
+}
+
 #endif
 
 #ifndef UNIT_TEST
@@ -87,58 +206,234 @@ void blackboxOpen(void)
 }
 #endif // UNIT_TEST
 
-void blackboxWrite(uint8_t value)
+#ifdef USE_BLACKBOX_COMPRESSION
+/*
+ * While compression is active the encoder output is collected into blocks here, and each full block goes to the
+ * device as a single compressed write.
+ */
+static struct {
+    bool active;
+    uint16_t used;
+    uint8_t *block;                 // BLACKBOX_COMPRESSION_BLOCK_SIZE bytes
+    uint8_t *output;                // BLACKBOX_COMPRESSION_OUTPUT_SIZE bytes
+} blackboxCompression;
+
+#define BLACKBOX_COMPRESSION_OUTPUT_SIZE    (BLACKBOX_COMPRESSION_HEADER_SIZE + BLACKBOX_COMPRESSION_BOUND(BLACKBOX_COMPRESSION_BLOCK_SIZE))
+
+STATIC_ASSERT(BLACKBOX_COMPRESSION_BLOCK_SIZE + BLACKBOX_COMPRESSION_OUTPUT_SIZE <= BLACKBOX_ARENA_COMPRESSION_SIZE, blackbox_compression_arena_too_small);
+
+static void blackboxDeviceWriteBuf(const uint8_t *data, int length)
 {
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
-        flashfsWriteByte(value); // Write byte asynchronously
+        flashfsWrite(data, length, false);
         break;
 #endif
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        afatfs_fputc(blackboxSDCard.logFile, value);
+        blackboxSDCardBufferWrite(data, length);
         break;
 #endif
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        serialWrite(blackboxPort, value);
+        serialWriteBuf(blackboxPort, data, length);
         break;
     }
 }
 
-// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
-int blackboxPrint(const char *s)
+static void blackboxCompressionFlushBlock(void)
 {
-    int length;
-    const uint8_t *pos;
+    if (blackboxCompression.used == 0) {
+        return;
+    }
 
-    switch (blackboxConfig()->device) {
+    uint8_t * const payload = blackboxCompression.output + BLACKBOX_COMPRESSION_HEADER_SIZE;
+    uint16_t payloadLength = blackboxCompressBlock(blackboxCompression.block, blackboxCompression.used, payload);
+    uint16_t lengthField = payloadLength;
+
+    // Incompressible data is stored as is, so a block never grows by more than its header
+    if (payloadLength >= blackboxCompression.used) {
+        payloadLength = blackboxCompression.used;
+        memcpy(payload, blackboxCompression.block, payloadLength);
+        lengthField = payloadLength | BLACKBOX_COMPRESSION_BLOCK_STORED;
+    }
+
+    blackboxCompression.output[0] = BLACKBOX_COMPRESSION_BLOCK_MARKER;
+    blackboxCompression.output[1] = lengthField & 0xFF;
+    blackboxCompression.output[2] = lengthField >> 8;
+
+    blackboxDeviceWriteBuf(blackboxCompression.output, BLACKBOX_COMPRESSION_HEADER_SIZE + payloadLength);
+    blackboxCompression.used = 0;
+}
+
+static void blackboxCompressionWrite(const uint8_t *data, int length)
+{
+    while (length > 0) {
+        const int chunk = MIN(length, BLACKBOX_COMPRESSION_BLOCK_SIZE - blackboxCompression.used);
+
+        memcpy(blackboxCompression.block + blackboxCompression.used, data, chunk);
+        blackboxCompression.used += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (blackboxCompression.used == BLACKBOX_COMPRESSION_BLOCK_SIZE) {
+            blackboxCompressionFlushBlock();
+        }
+    }
+}
+#endif
+
+/**
+ * Start compressing everything written to the log from now on, if enabled in the config. Called once the
+ * (uncompressed) log headers have been written.
+ */
+void blackboxDeviceBeginCompression(void)
+{
+#ifdef USE_BLACKBOX_COMPRESSION
+    blackboxCompression.used = 0;
+    blackboxCompression.active = blackboxConfig()->compression && blackboxCompression.block && blackboxCompression.output;
+#endif
+}
+
+/**
+ * Write out the partially filled block and stop compressing.
+ */
+void blackboxDeviceEndCompression(void)
+{
+#ifdef USE_BLACKBOX_COMPRESSION
+    if (blackboxCompression.active) {
+        blackboxCompressionFlushBlock();
+        blackboxCompression.active = false;
+    }
+#endif
+}
+
+#ifdef USE_CLI_BENCH
+static bool blackboxBenchSink;
+static uint32_t blackboxBenchSinkBytes;
+
+void blackboxSetBenchSink(bool enabled)
+{
+    blackboxBenchSink = enabled;
+    blackboxBenchSinkBytes = 0;
+}
+
+uint32_t blackboxGetBenchSinkBytes(void)
+{
+    return blackboxBenchSinkBytes;
+}
+#endif
+
+blackboxFrameBuffer_t blackboxFrame = { .pos = blackboxFrame.data };
+
+void blackboxFrameBegin(void)
+{
+    blackboxFrame.open = true;
+}
+
+void blackboxFrameEnd(void)
+{
+    blackboxFrameCommit();
+    blackboxFrame.open = false;
+}
+
+void blackboxFrameCommit(void)
+{
+    const uint32_t length = blackboxFrame.pos - blackboxFrame.data;
+
+    blackboxFrame.pos = blackboxFrame.data;
+    if (length) {
+        blackboxWriteBytes(blackboxFrame.data, length);
+    }
+}
+
+void blackboxWriteBytes(const uint8_t *data, uint32_t length)
+{
+#ifdef USE_CLI_BENCH
+    if (blackboxBenchSink) {
+        blackboxBenchSinkBytes += length;
+        return;
+    }
+#endif
+
+#ifdef USE_BLACKBOX_COMPRESSION
+    if (blackboxCompression.active) {
+        blackboxCompressionWrite(data, length);
+        return;
+    }
+#endif
 
+    switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
-        length = strlen(s);
-        flashfsWrite((const uint8_t*) s, length, false); // Write asynchronously
+        flashfsWrite(data, length, false); // Write asynchronously
         break;
 #endif
-
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        length = strlen(s);
-        afatfs_fwrite(blackboxSDCard.logFile, (const uint8_t*) s, length); // Ignore failures due to buffers filling up
+        blackboxSDCardBufferWrite(data, length); // Ignore failures due to buffers filling up
         break;
 #endif
-
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        pos = (uint8_t*) s;
-        while (*pos) {
-            serialWrite(blackboxPort, *pos);
-            pos++;
-        }
+        serialWriteBuf(blackboxPort, data, length);
+        break;
+    }
+}
+
+void blackboxWrite(uint8_t value)
+{
+    if (blackboxFrame.open) {
+        uint8_t *pos = blackboxFrameReserve(1);
+        *pos++ = value;
+        blackboxFrame.pos = pos;
+        return;
+    }
+
+#ifdef USE_CLI_BENCH
+    if (blackboxBenchSink) {
+        blackboxBenchSinkBytes++;
+        return;
+    }
+#endif
+
+#ifdef USE_BLACKBOX_COMPRESSION
+    if (blackboxCompression.active) {
+        blackboxCompressionWrite(&value, 1);
+        return;
+    }
+#endif
 
-        length = pos - (uint8_t*) s;
+    switch (blackboxConfig()->device) {
+#ifdef USE_FLASHFS
+    case BLACKBOX_DEVICE_FLASH:
+        flashfsWriteByte(value); // Write byte asynchronously
         break;
+#endif
+#ifdef USE_SDCARD
+    case BLACKBOX_DEVICE_SDCARD:
+        blackboxSDCardBufferWrite(&value, 1);
+        break;
+#endif
+    case BLACKBOX_DEVICE_SERIAL:
+    default:
+        serialWrite(blackboxPort, value);
+        break;
+    }
+}
+
+// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
+int blackboxPrint(const char *s)
+{
+    const int length = strlen(s);
+
+    if (blackboxFrame.open) {
+        for (int i = 0; i < length; i++) {
+            blackboxWrite(s[i]);
+        }
+    } else {
+        blackboxWriteBytes((const uint8_t*) s, length);
     }
 
     return length;
@@ -152,6 +447,10 @@ int blackboxPrint(const char *s)
 void blackboxDeviceFlush(void)
 {
     switch (blackboxConfig()->device) {
+    case BLACKBOX_DEVICE_SERIAL:
+        blackboxSerialFlush();
+        break;
+
 #ifdef USE_FLASHFS
         /*
          * This is our only output device which requires us to call flush() in order for it to write anything. The other
@@ -176,7 +475,8 @@ bool blackboxDeviceFlushForce(void)
 {
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
-        // Nothing to speed up flushing on serial, as serial is continuously being drained out of its buffer
+        // Serial is continuously being drained out of its buffer once the queued bytes are released
+        blackboxSerialFlush();
         return isSerialTransmitBufferEmpty(blackboxPort);
 
 #ifdef USE_FLASHFS
@@ -189,7 +489,7 @@ bool blackboxDeviceFlushForce(void)
         /* SD card will flush itself without us calling it, but we need to call flush manually in order to check
          * if it's done yet or not!
          */
-        return afatfs_flush();
+        return blackboxSDCardBufferDrain() && afatfs_flush();
 #endif
 
     default:
@@ -197,6 +497,42 @@ bool blackboxDeviceFlushForce(void)
     }
 }
 
+/**
+ * Claim the buffers the configured device and encoding need from the memory arena. Called once at boot,
+ * buffers that aren't claimed here stay unavailable until the next reboot.
+ */
+void blackboxDeviceAllocateBuffers(void)
+{
+#ifdef USE_BLACKBOX_COMPRESSION
+    if (blackboxConfig()->compression) {
+        blackboxCompression.block = memAllocateArena(BLACKBOX_COMPRESSION_BLOCK_SIZE, BLACKBOX_COMPRESSION_BLOCK_SIZE, NULL, OWNER_BLACKBOX);
+        blackboxCompression.output = memAllocateArena(BLACKBOX_COMPRESSION_OUTPUT_SIZE, BLACKBOX_COMPRESSION_OUTPUT_SIZE, NULL, OWNER_BLACKBOX);
+    }
+#endif
+
+#ifdef BLACKBOX_SERIAL_BUFFER_SIZE
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL) {
+        // Largest power of two the arena still holds
+        uint32_t size = BLACKBOX_SERIAL_BUFFER_SIZE;
+        while (size > BLACKBOX_SERIAL_BUFFER_MIN_SIZE && size > memGetArenaAvailableBytes()) {
+            size /= 2;
+        }
+
+        blackboxSerialBuffer.data = memAllocateArena(size, size, NULL, OWNER_BLACKBOX);
+        blackboxSerialBuffer.size = blackboxSerialBuffer.data ? size : 0;
+    }
+#endif
+
+#ifdef USE_SDCARD
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_SDCARD) {
+        size_t size = 0;
+        blackboxSDCardBuffer.data = memAllocateArena(BLACKBOX_SDCARD_BUFFER_MIN_SIZE, memGetArenaAvailableBytes(), &size, OWNER_BLACKBOX);
+        blackboxSDCardBuffer.size = blackboxSDCardBuffer.data ? size : 0;
+        blackboxSDCardBufferStats.bufferSize = blackboxSDCardBuffer.size;
+    }
+#endif
+}
+
 /**
  * Attempt to open the logging device. Returns true if successful.
  */
@@ -210,6 +546,10 @@ bool blackboxDeviceOpen(void)
             baudRate_e baudRateIndex;
             portOptions_t portOptions = SERIAL_PARITY_NO | SERIAL_NOT_INVERTED;
 
+            if (blackboxConfig()->serialFlowControl) {
+                portOptions |= SERIAL_CTS;
+            }
+
             if (!portConfig) {
                 return false;
             }
@@ -230,6 +570,18 @@ bool blackboxDeviceOpen(void)
             blackboxPort = openSerialPort(portConfig->identifier, FUNCTION_BLACKBOX, NULL, NULL, baudRates[baudRateIndex],
                 BLACKBOX_SERIAL_PORT_MODE, portOptions);
 
+            if (!blackboxPort) {
+                return false;
+            }
+
+#ifdef BLACKBOX_SERIAL_BUFFER_SIZE
+            if (blackboxSerialBuffer.data) {
+                serialSetTxBuffer(blackboxPort, blackboxSerialBuffer.data, blackboxSerialBuffer.size);
+            }
+#endif
+            // Queued bytes are released at the end of each iteration by blackboxDeviceFlush()
+            serialBeginWrite(blackboxPort);
+
             /*
              * The slowest MicroSD cards have a write latency approaching 150ms. The OpenLog's buffer is about 900
              * bytes. In order for its buffer to be able to absorb this latency we must write slower than 6000 B/s.
@@ -242,7 +594,12 @@ bool blackboxDeviceOpen(void)
              */
             blackboxMaxHeaderBytesPerIteration = constrain((getLooptime() * 3) / 500, 1, BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION);
 
-            return blackboxPort != NULL;
+            if (blackboxConfig()->serialFlowControl) {
+                // The logger holds off transmission itself while it writes to its card
+                blackboxMaxHeaderBytesPerIteration = BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION;
+            }
+
+            return true;
         }
         break;
 #ifdef USE_FLASHFS
@@ -258,7 +615,7 @@ bool blackboxDeviceOpen(void)
 #endif
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        if (afatfs_getFilesystemState() == AFATFS_FILESYSTEM_STATE_FATAL || afatfs_getFilesystemState() == AFATFS_FILESYSTEM_STATE_UNKNOWN || afatfs_isFull()) {
+        if (!blackboxSDCardBuffer.data || afatfs_getFilesystemState() == AFATFS_FILESYSTEM_STATE_FATAL || afatfs_getFilesystemState() == AFATFS_FILESYSTEM_STATE_UNKNOWN || afatfs_isFull()) {
             return false;
         }
 
@@ -282,6 +639,7 @@ void blackboxDeviceClose(void)
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         // Since the serial port could be shared with other processes, we have to give it back here
+        serialEndWrite(blackboxPort);
         closeSerialPort(blackboxPort);
         blackboxPort = NULL;
 
@@ -295,6 +653,9 @@ void blackboxDeviceClose(void)
         break;
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
+#ifdef USE_FLASHFS_INDEX
+        flashfsEndLog();
+#endif
         // Some flash device, e.g., NAND devices, require explicit close to flush internally buffered data.
         flashfsClose();
         break;
@@ -325,6 +686,8 @@ static void blackboxLogFileCreated(afatfsFilePtr_t file)
 {
     if (file) {
         blackboxSDCard.logFile = file;
+        blackboxSDCardBuffer.head = 0;
+        blackboxSDCardBuffer.tail = 0;
 
         blackboxSDCard.largestLogFileNumber++;
 
@@ -442,10 +805,20 @@ static bool blackboxSDCardBeginLog(void)
  */
 bool blackboxDeviceBeginLog(void)
 {
+#ifdef USE_BLACKBOX_COMPRESSION
+    // Log headers are never compressed
+    blackboxCompression.active = false;
+#endif
+
     switch (blackboxConfig()->device) {
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
         return blackboxSDCardBeginLog();
+#endif
+#ifdef USE_FLASHFS_INDEX
+    case BLACKBOX_DEVICE_FLASH:
+        flashfsBeginLog();
+        return true;
 #endif
     default:
         return true;
@@ -469,6 +842,11 @@ bool blackboxDeviceEndLog(bool retainLog)
     switch (blackboxConfig()->device) {
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
+        // Everything the encoder produced has to reach the file before it is closed
+        if (retainLog && !blackboxSDCardBufferDrain()) {
+            return false;
+        }
+
         // Keep retrying until the close operation queues
         if (
             (retainLog && afatfs_fclose(blackboxSDCard.logFile, NULL))
@@ -477,6 +855,7 @@ bool blackboxDeviceEndLog(bool retainLog)
             // Don't bother waiting the for the close to complete, it's queued now and will complete eventually
             blackboxSDCard.logFile = NULL;
             blackboxSDCard.state = BLACKBOX_SDCARD_READY_TO_CREATE_LOG;
+            blackboxSDCardBuffer.tail = blackboxSDCardBuffer.head;
             return true;
         }
         return false;
@@ -486,6 +865,50 @@ bool blackboxDeviceEndLog(bool retainLog)
     }
 }
 
+bool blackboxDeviceNeedsWriterTask(void)
+{
+    switch (blackboxConfig()->device) {
+#ifdef USE_SDCARD
+    case BLACKBOX_DEVICE_SDCARD:
+        return true;
+#endif
+#ifdef USE_FLASHFS_INDEX
+    case BLACKBOX_DEVICE_FLASH:
+        return blackboxConfig()->flashEraseAhead > 0;
+#endif
+    default:
+        return false;
+    }
+}
+
+/**
+ * Body of the blackbox writer task: hand buffered log data to the filesystem and let it push full sectors
+ * (as multi-block writes) to the card, outside of the PID loop. On flash it keeps space erased ahead of the log.
+ */
+void blackboxDeviceWriterUpdate(void)
+{
+#ifdef USE_SDCARD
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_SDCARD) {
+        blackboxSDCardBufferDrain();
+        afatfs_poll();
+        blackboxSDCardBufferUpdateStats();
+    }
+#endif
+#ifdef USE_FLASHFS_INDEX
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_FLASH) {
+        // Long erases would stall the mission and terrain stores sharing the chip in flight
+        flashfsEraseAheadUpdate(!ARMING_FLAG(ARMED));
+    }
+#endif
+}
+
+#ifdef USE_SDCARD
+const blackboxSDCardBufferStats_t * blackboxGetSDCardBufferStats(void)
+{
+    return &blackboxSDCardBufferStats;
+}
+#endif
+
 bool isBlackboxDeviceFull(void)
 {
     switch (blackboxConfig()->device) {
@@ -517,6 +940,8 @@ void blackboxReplenishHeaderBudget(void)
 
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
+        // Header bytes written in the last iteration go out now
+        blackboxSerialFlush();
         freeSpace = serialTxBytesFree(blackboxPort);
         break;
 #ifdef USE_FLASHFS
@@ -526,7 +951,7 @@ void blackboxReplenishHeaderBudget(void)
 #endif
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        freeSpace = afatfs_getFreeBufferSpace();
+        freeSpace = blackboxSDCardBufferFree();
         break;
 #endif
     default:
@@ -565,9 +990,9 @@ blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
     case BLACKBOX_DEVICE_SERIAL:
         /*
          * One byte of the tx buffer isn't available for user data (due to its circular list implementation),
-         * hence the -1. Note that the USB VCP implementation doesn't use a buffer and has txBufferSize set to zero.
+         * hence the -1. Note that the USB VCP implementation doesn't use a buffer and has txRing.size set to zero.
          */
-        if (blackboxPort->txBufferSize && bytes > (int32_t) blackboxPort->txBufferSize - 1) {
+        if (blackboxPort->txRing.size && bytes > (int32_t) blackboxPort->txRing.size - 1) {
             return BLACKBOX_RESERVE_PERMANENT_FAILURE;
         }
 
@@ -593,7 +1018,10 @@ blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
 
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        // Assume that all writes will fit in the SDCard's buffers
+        if (blackboxSDCardBuffer.size == 0 || bytes > (int32_t)blackboxSDCardBuffer.size - 1) {
+            return BLACKBOX_RESERVE_PERMANENT_FAILURE;
+        }
+
         return BLACKBOX_RESERVE_TEMPORARY_FAILURE;
 #endif
 
@@ -55,8 +55,62 @@ typedef enum {
 
 extern int32_t blackboxHeaderBudget;
 
+typedef struct blackboxSDCardBufferStats_s {
+    uint32_t bufferSize;
+    uint32_t peakUsedBytes;
+    uint32_t droppedBytes;
+    uint32_t bytesPerSecond;
+    uint32_t requiredBytes;         // Buffer needed to ride out the card's current write latency estimate
+} blackboxSDCardBufferStats_t;
+
 void blackboxOpen(void);
 void blackboxWrite(uint8_t value);
+void blackboxWriteBytes(const uint8_t *data, uint32_t length);
+
+/*
+ * Log frames are staged in RAM while they are encoded and go to the device in one
+ * bulk write when the frame ends, instead of one device call per byte. Encoders
+ * reserve the room they need, store through the returned pointer and hand the
+ * advanced pointer back. Outside a frame the staged bytes are written at once.
+ */
+#define BLACKBOX_FRAME_BUFFER_SIZE 256
+
+typedef struct blackboxFrameBuffer_s {
+    uint8_t *pos;
+    bool open;
+    uint8_t data[BLACKBOX_FRAME_BUFFER_SIZE];
+} blackboxFrameBuffer_t;
+
+extern blackboxFrameBuffer_t blackboxFrame;
+
+void blackboxFrameBegin(void);
+void blackboxFrameEnd(void);
+void blackboxFrameCommit(void);
+
+// length must not exceed BLACKBOX_FRAME_BUFFER_SIZE, a frame too big for the rest of the buffer is committed in parts
+static inline uint8_t *blackboxFrameReserve(uint32_t length)
+{
+    if ((uint32_t)(blackboxFrame.data + BLACKBOX_FRAME_BUFFER_SIZE - blackboxFrame.pos) < length) {
+        blackboxFrameCommit();
+    }
+    return blackboxFrame.pos;
+}
+
+static inline void blackboxFrameAdvance(uint8_t *pos)
+{
+    blackboxFrame.pos = pos;
+    if (!blackboxFrame.open) {
+        blackboxFrameCommit();
+    }
+}
+
+#ifdef USE_CLI_BENCH
+// While set, written bytes are only counted, for timing the frame encoding without a device
+void blackboxSetBenchSink(bool enabled);
+uint32_t blackboxGetBenchSinkBytes(void);
+#endif
+
+void blackboxDeviceAllocateBuffers(void);
 
 void blackboxDeviceFlush(void);
 bool blackboxDeviceFlushForce(void);
@@ -66,6 +120,15 @@ void blackboxDeviceClose(void);
 bool blackboxDeviceBeginLog(void);
 bool blackboxDeviceEndLog(bool retainLog);
 
+void blackboxDeviceBeginCompression(void);
+void blackboxDeviceEndCompression(void);
+
+bool blackboxDeviceNeedsWriterTask(void);
+void blackboxDeviceWriterUpdate(void);
+#ifdef USE_SDCARD
+const blackboxSDCardBufferStats_t * blackboxGetSDCardBufferStats(void);
+#endif
+
 bool isBlackboxDeviceFull(void);
 
 void blackboxReplenishHeaderBudget(void);
@@ -0,0 +1,247 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#ifdef USE_CLI_BENCH
+
+#include "blackbox/blackbox.h"
+#include "blackbox/blackbox_encoding.h"
+#include "blackbox/blackbox_io.h"
+
+#include "build/bench.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/time.h"
+
+#include "fc/config.h"
+#include "fc/runtime_config.h"
+
+#include "flight/dynamic_gyro_notch.h"
+#include "flight/gyroanalyse.h"
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/pid.h"
+
+#include "sensors/gyro.h"
+
+#define BENCH_FRAME_FIELDS  24
+
+static const char * const benchKernelNames[BENCH_KERNEL_COUNT] = {
+    [BENCH_KERNEL_GYRO_FILTER]      = "gyroFilter",
+    [BENCH_KERNEL_IMU_UPDATE]       = "imuUpdateAttitude",
+    [BENCH_KERNEL_FFT_ANALYSIS]     = "gyroDataAnalyse",
+    [BENCH_KERNEL_PID_CONTROLLER]   = "pidController",
+    [BENCH_KERNEL_MIX_TABLE]        = "mixTable",
+    [BENCH_KERNEL_BLACKBOX_ENCODE]  = "blackbox P-frame",
+};
+
+static uint32_t benchLcgState;
+static float benchGyro[XYZ_AXIS_COUNT];
+static int32_t benchFrame[BENCH_FRAME_FIELDS];
+
+const char *benchKernelName(benchKernel_e kernel)
+{
+    return benchKernelNames[kernel];
+}
+
+// Sines at typical frame resonance and motor noise frequencies plus LCG noise, in deg/s
+static void benchNextGyroSample(uint32_t n)
+{
+    const float t = n * US2S(getLooptime());
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        benchLcgState = benchLcgState * 1664525 + 1013904223;
+        const float noise = (int32_t)(benchLcgState >> 16) % 200 - 100;
+        benchGyro[axis] = 100.0f * sin_approx(2 * M_PIf * (5 + axis) * t) + 20.0f * sin_approx(2 * M_PIf * 230 * t) + 0.1f * noise;
+    }
+}
+
+// Main frame fields as a P-frame stores them, mostly small deltas
+static void benchNextFrame(void)
+{
+    for (int i = 0; i < BENCH_FRAME_FIELDS; i++) {
+        benchLcgState = benchLcgState * 1664525 + 1013904223;
+        const int32_t value = (int32_t)(benchLcgState >> 8);
+        benchFrame[i] = (i % 8 == 0) ? value % 4096 : value % 32;
+    }
+}
+
+#ifdef USE_BLACKBOX
+static void benchEncodeFrame(void)
+{
+    blackboxFrameBegin();
+    blackboxWrite('P');
+    blackboxWriteSignedVB(benchFrame[0]);               // Time
+    blackboxWriteSignedVBArray(&benchFrame[1], 3);      // axisP
+    blackboxWriteTag2_3S32(&benchFrame[4]);             // axisI
+    blackboxWriteSignedVBArray(&benchFrame[7], 3);      // axisD
+    blackboxWriteTag8_4S16(&benchFrame[10]);            // rcCommand
+    blackboxWriteTag8_8SVB(&benchFrame[14], 6);         // gyroADC, accSmooth
+    blackboxWriteSignedVBArray(&benchFrame[20], 4);     // motor
+    blackboxFrameEnd();
+}
+#endif
+
+static bool benchKernelAvailable(benchKernel_e kernel)
+{
+    switch (kernel) {
+    case BENCH_KERNEL_GYRO_FILTER:
+    case BENCH_KERNEL_IMU_UPDATE:
+    case BENCH_KERNEL_PID_CONTROLLER:
+    case BENCH_KERNEL_MIX_TABLE:
+        return true;
+    case BENCH_KERNEL_FFT_ANALYSIS:
+#ifdef USE_DYNAMIC_FILTERS
+        // Analysis state is only set up with the dynamic notch enabled
+        return gyroAnalyseState.fftWindowSize > 0;
+#else
+        return false;
+#endif
+    case BENCH_KERNEL_BLACKBOX_ENCODE:
+#ifdef USE_BLACKBOX
+        return blackboxMayEditConfig();
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+// Sets up the input of one call, not timed
+static void benchPrepare(benchKernel_e kernel, uint32_t n)
+{
+    benchNextGyroSample(n);
+
+    switch (kernel) {
+    case BENCH_KERNEL_GYRO_FILTER:
+        gyroBenchPushSample(benchGyro);
+        break;
+    case BENCH_KERNEL_IMU_UPDATE:
+    case BENCH_KERNEL_PID_CONTROLLER:
+        memcpy(gyro.gyroADCf, benchGyro, sizeof(benchGyro));
+        break;
+    case BENCH_KERNEL_FFT_ANALYSIS:
+#ifdef USE_DYNAMIC_FILTERS
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDataAnalysePush(&gyroAnalyseState, axis, benchGyro[axis]);
+        }
+#endif
+        break;
+    case BENCH_KERNEL_MIX_TABLE:
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            axisPID[axis] = lrintf(benchGyro[axis]);
+        }
+        break;
+    case BENCH_KERNEL_BLACKBOX_ENCODE:
+        benchNextFrame();
+        break;
+    default:
+        break;
+    }
+}
+
+static void benchCall(benchKernel_e kernel)
+{
+    switch (kernel) {
+    case BENCH_KERNEL_GYRO_FILTER:
+        gyroFilter();
+        break;
+    case BENCH_KERNEL_IMU_UPDATE:
+        imuUpdateAttitude(micros());
+        break;
+    case BENCH_KERNEL_FFT_ANALYSIS:
+#ifdef USE_DYNAMIC_FILTERS
+        gyroDataAnalyse(&gyroAnalyseState);
+#endif
+        break;
+    case BENCH_KERNEL_PID_CONTROLLER:
+        pidController(US2S(getLooptime()));
+        break;
+    case BENCH_KERNEL_MIX_TABLE:
+        mixTable();
+        break;
+    case BENCH_KERNEL_BLACKBOX_ENCODE:
+#ifdef USE_BLACKBOX
+        benchEncodeFrame();
+#endif
+        break;
+    default:
+        break;
+    }
+}
+
+bool benchRun(benchKernel_e kernel, uint16_t calls, benchResult_t *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    if (ARMING_FLAG(ARMED) || !benchKernelAvailable(kernel)) {
+        return false;
+    }
+
+    // Inputs the kernels share with the flight loop, restored afterwards
+    float gyroADCf[XYZ_AXIS_COUNT];
+    int16_t pidOutput[XYZ_AXIS_COUNT];
+    memcpy(gyroADCf, gyro.gyroADCf, sizeof(gyroADCf));
+    memcpy(pidOutput, axisPID, sizeof(pidOutput));
+
+#ifdef USE_BLACKBOX
+    blackboxSetBenchSink(kernel == BENCH_KERNEL_BLACKBOX_ENCODE);
+#endif
+
+    benchLcgState = 0x12345678;
+    uint64_t totalCycles = 0;
+    calls = constrain(calls, 1, BENCH_MAX_CALLS);
+
+    for (uint32_t n = 0; n < calls; n++) {
+        benchPrepare(kernel, n);
+
+        const uint32_t startCycles = ticks();
+        benchCall(kernel);
+        const uint32_t cycles = ticks() - startCycles;
+
+        result->minCycles = n ? MIN(result->minCycles, cycles) : cycles;
+        result->maxCycles = MAX(result->maxCycles, cycles);
+        totalCycles += cycles;
+    }
+
+#ifdef USE_BLACKBOX
+    blackboxSetBenchSink(false);
+#endif
+
+    memcpy(gyro.gyroADCf, gyroADCf, sizeof(gyroADCf));
+    memcpy(axisPID, pidOutput, sizeof(pidOutput));
+    if (kernel == BENCH_KERNEL_PID_CONTROLLER) {
+        pidResetErrorAccumulators();
+    }
+
+    result->calls = calls;
+    result->avgCycles = totalCycles / calls;
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+/*
+ * On-target timing of the flight kernels with the DWT cycle counter, for the
+ * CLI bench command. Each kernel is the firmware's own function called back to
+ * back on synthetic gyro data, with the configuration of the board. Only
+ * allowed while disarmed, the live filter and estimator state settles again
+ * within a few loops afterwards
+ */
+
+#define BENCH_DEFAULT_CALLS     1000
+#define BENCH_MAX_CALLS         10000
+
+typedef enum {
+    BENCH_KERNEL_GYRO_FILTER = 0,
+    BENCH_KERNEL_IMU_UPDATE,
+    BENCH_KERNEL_FFT_ANALYSIS,
+    BENCH_KERNEL_PID_CONTROLLER,
+    BENCH_KERNEL_MIX_TABLE,
+    BENCH_KERNEL_BLACKBOX_ENCODE,
+    BENCH_KERNEL_COUNT
+} benchKernel_e;
+
+typedef struct benchResult_s {
+    uint16_t calls;
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+} benchResult_t;
+
+#ifdef USE_CLI_BENCH
+
+const char *benchKernelName(benchKernel_e kernel);
+// False if the kernel is not built in or not enabled in the configuration
+bool benchRun(benchKernel_e kernel, uint16_t calls, benchResult_t *result);
+
+#endif
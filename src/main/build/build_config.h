@@ -45,6 +45,13 @@
 #define FASTRAM                     __attribute__ ((section(".fastram_bss"), aligned(4)))
 #endif
 
+#if defined(UNIT_TEST) || defined(__APPLE__)
+#define PERSISTENT
+#else
+// Not cleared by the startup code, keeps its contents across software and watchdog resets
+#define PERSISTENT                  __attribute__ ((section(".persistent_data"), aligned(4)))
+#endif
+
 #if defined (STM32F4) || defined (STM32F7)
 #define EXTENDED_FASTRAM FASTRAM
 #else
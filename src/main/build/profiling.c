@@ -0,0 +1,87 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_PROFILING_ZONES
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "build/profiling.h"
+
+#include "drivers/time.h"
+
+FASTRAM profilingZone_t profilingZones[PROFILING_ZONE_COUNT];
+
+static const char * const profilingZoneNames[PROFILING_ZONE_COUNT] = {
+    [PROFILING_ZONE_GYRO_UPDATE]            = "gyroUpdate",
+    [PROFILING_ZONE_GYRO_FILTER]            = "gyroFilter",
+    [PROFILING_ZONE_IMU_UPDATE_ATTITUDE]    = "imuUpdateAttitude",
+    [PROFILING_ZONE_POSITION_ESTIMATOR]     = "updatePositionEstimator",
+    [PROFILING_ZONE_PID_CONTROLLER]         = "pidController",
+    [PROFILING_ZONE_MIX_TABLE]              = "mixTable",
+    [PROFILING_ZONE_SERVO_MIXER]            = "servoMixer",
+    [PROFILING_ZONE_BLACKBOX_UPDATE]        = "blackboxUpdate",
+    [PROFILING_ZONE_OSD_REFRESH]            = "osdRefresh",
+};
+
+// Called from the SYSTEM task, closes the current window of every zone
+void profilingZonesRotate(void)
+{
+    for (int zone = 0; zone < PROFILING_ZONE_COUNT; zone++) {
+        profilingZone_t *z = &profilingZones[zone];
+
+        z->historyHead = (z->historyHead + 1) % PROFILING_HISTORY_LENGTH;
+        profilingWindow_t *window = &z->history[z->historyHead];
+
+        window->count = z->count;
+        window->minCycles = z->minCycles;
+        window->maxCycles = z->maxCycles;
+        window->avgCycles = z->count ? z->totalCycles / z->count : 0;
+
+        z->minCycles = 0;
+        z->maxCycles = 0;
+        z->totalCycles = 0;
+        z->count = 0;
+    }
+}
+
+const char *profilingZoneName(profilingZone_e zone)
+{
+    return zone < PROFILING_ZONE_COUNT ? profilingZoneNames[zone] : NULL;
+}
+
+const profilingWindow_t *profilingZoneGetWindow(profilingZone_e zone, uint8_t index)
+{
+    if (zone >= PROFILING_ZONE_COUNT || index >= PROFILING_HISTORY_LENGTH) {
+        return NULL;
+    }
+
+    const profilingZone_t *z = &profilingZones[zone];
+    return &z->history[(z->historyHead + PROFILING_HISTORY_LENGTH - index) % PROFILING_HISTORY_LENGTH];
+}
+
+uint32_t profilingCyclesPerUs(void)
+{
+    return usTicks;
+}
+
+#endif
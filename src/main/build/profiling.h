@@ -0,0 +1,103 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+/*
+ * Cycle accurate timing of named code regions, measured with the DWT cycle counter.
+ * Statistics are collected for a window of one SYSTEM task period and then moved
+ * into a short per-zone history
+ */
+
+typedef enum {
+    PROFILING_ZONE_GYRO_UPDATE = 0,
+    PROFILING_ZONE_GYRO_FILTER,
+    PROFILING_ZONE_IMU_UPDATE_ATTITUDE,
+    PROFILING_ZONE_POSITION_ESTIMATOR,
+    PROFILING_ZONE_PID_CONTROLLER,
+    PROFILING_ZONE_MIX_TABLE,
+    PROFILING_ZONE_SERVO_MIXER,
+    PROFILING_ZONE_BLACKBOX_UPDATE,
+    PROFILING_ZONE_OSD_REFRESH,
+    PROFILING_ZONE_COUNT
+} profilingZone_e;
+
+#define PROFILING_HISTORY_LENGTH    8
+
+typedef struct profilingWindow_s {
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+    uint16_t count;                 // Zone executions within the window, 0 if the zone did not run
+} profilingWindow_t;
+
+typedef struct profilingZone_s {
+    uint32_t startCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t totalCycles;
+    uint16_t count;
+    uint8_t historyHead;            // Index of the newest history entry
+    profilingWindow_t history[PROFILING_HISTORY_LENGTH];
+} profilingZone_t;
+
+#ifdef USE_PROFILING_ZONES
+
+#include "common/maths.h"
+
+#include "drivers/time.h"
+
+extern profilingZone_t profilingZones[PROFILING_ZONE_COUNT];
+
+static inline void profilingZoneBegin(profilingZone_e zone)
+{
+    profilingZones[zone].startCycles = ticks();
+}
+
+static inline void profilingZoneEnd(profilingZone_e zone)
+{
+    profilingZone_t *z = &profilingZones[zone];
+    const uint32_t cycles = ticks() - z->startCycles;
+
+    if (z->count < UINT16_MAX) {
+        z->minCycles = z->count ? MIN(z->minCycles, cycles) : cycles;
+        z->maxCycles = MAX(z->maxCycles, cycles);
+        z->totalCycles += cycles;
+        z->count++;
+    }
+}
+
+#define PROFILING_ZONE_BEGIN(zone)  profilingZoneBegin(zone)
+#define PROFILING_ZONE_END(zone)    profilingZoneEnd(zone)
+
+void profilingZonesRotate(void);
+const char *profilingZoneName(profilingZone_e zone);
+// index 0 is the newest completed window
+const profilingWindow_t *profilingZoneGetWindow(profilingZone_e zone, uint8_t index);
+uint32_t profilingCyclesPerUs(void);
+
+#else
+
+#define PROFILING_ZONE_BEGIN(zone)  {}
+#define PROFILING_ZONE_END(zone)    {}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_TRACE_RING
+
+#include "build/build_config.h"
+#include "build/trace_ring.h"
+
+#include "drivers/system.h"
+#include "drivers/time.h"
+
+#include "fc/runtime_config.h"
+
+#define TRACE_RING_MAGIC            0x54524331      // 'TRC1'
+
+typedef struct traceRing_s {
+    uint32_t magic;
+    uint16_t bootCount;
+    uint8_t eventHead;              // Next slot to write
+    uint8_t taskHead;
+    traceEvent_t events[TRACE_RING_EVENT_COUNT];
+    traceTaskStart_t tasks[TRACE_RING_TASK_COUNT];
+} traceRing_t;
+
+static traceRing_t traceRing PERSISTENT;
+// Task starts leading up to the last reset, newest first
+static traceTaskStart_t previousBootTasks[TRACE_RING_TASK_COUNT];
+
+static bool traceRingIsValid(void)
+{
+    return traceRing.magic == TRACE_RING_MAGIC &&
+        traceRing.eventHead < TRACE_RING_EVENT_COUNT &&
+        traceRing.taskHead < TRACE_RING_TASK_COUNT;
+}
+
+void traceRingClear(void)
+{
+    memset(&traceRing, 0, sizeof(traceRing));
+    traceRing.magic = TRACE_RING_MAGIC;
+}
+
+void traceRingInit(void)
+{
+    // After a power cycle the RAM holds garbage, start over
+    if (!traceRingIsValid()) {
+        traceRingClear();
+    }
+
+    // The scheduler overwrites the task ring right away, keep what led to the reset
+    for (unsigned ii = 0; ii < TRACE_RING_TASK_COUNT; ii++) {
+        previousBootTasks[ii] = traceRing.tasks[(traceRing.taskHead + TRACE_RING_TASK_COUNT - 1 - ii) % TRACE_RING_TASK_COUNT];
+    }
+    memset(traceRing.tasks, 0, sizeof(traceRing.tasks));
+    traceRing.taskHead = 0;
+
+    traceRing.bootCount++;
+    traceRingRecord(TRACE_EVENT_BOOT, 0, cachedRccCsrValue);
+}
+
+void traceRingRecord(traceEventType_e type, uint8_t id, uint32_t data)
+{
+    traceEvent_t *event = &traceRing.events[traceRing.eventHead];
+
+    event->timeUs = micros();
+    event->data = data;
+    event->boot = traceRing.bootCount;
+    event->type = type;
+    event->id = id;
+
+    traceRing.eventHead = (traceRing.eventHead + 1) % TRACE_RING_EVENT_COUNT;
+}
+
+void traceRingTaskStart(uint8_t taskId, uint32_t timeUs)
+{
+    traceTaskStart_t *start = &traceRing.tasks[traceRing.taskHead];
+
+    start->timeUs = timeUs;
+    start->taskId = taskId;
+
+    traceRing.taskHead = (traceRing.taskHead + 1) % TRACE_RING_TASK_COUNT;
+}
+
+void traceRingTaskEnd(uint8_t taskId, uint32_t executionTimeUs)
+{
+    if (executionTimeUs > TRACE_RING_LONG_TASK_US && ARMING_FLAG(ARMED)) {
+        traceRingRecord(TRACE_EVENT_LONG_TASK, taskId, executionTimeUs);
+    }
+}
+
+void traceRingBusError(uint8_t device, uint8_t address)
+{
+    if (ARMING_FLAG(ARMED)) {
+        traceRingRecord(TRACE_EVENT_BUS_ERROR, device, address);
+    }
+}
+
+void traceRingRecordFault(const uint32_t *stackFrame)
+{
+    // Exception frame: r0, r1, r2, r3, r12, lr, pc, xpsr
+    traceRingRecord(TRACE_EVENT_FAULT_PC, 0, stackFrame[6]);
+    traceRingRecord(TRACE_EVENT_FAULT_LR, 0, stackFrame[5]);
+    traceRingRecord(TRACE_EVENT_FAULT_STATUS, 0, SCB->CFSR);
+
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    // Make sure the records reach the RAM before the watchdog resets the MCU
+    SCB_CleanDCache();
+#endif
+}
+
+uint16_t traceRingBootCount(void)
+{
+    return traceRing.bootCount;
+}
+
+const traceEvent_t *traceRingGetEvent(unsigned index)
+{
+    if (index >= TRACE_RING_EVENT_COUNT) {
+        return NULL;
+    }
+
+    const traceEvent_t *event = &traceRing.events[(traceRing.eventHead + TRACE_RING_EVENT_COUNT - 1 - index) % TRACE_RING_EVENT_COUNT];
+    return event->type == TRACE_EVENT_NONE ? NULL : event;
+}
+
+const traceTaskStart_t *traceRingGetTaskStart(unsigned index)
+{
+    if (index >= TRACE_RING_TASK_COUNT) {
+        return NULL;
+    }
+
+    const traceTaskStart_t *start = &previousBootTasks[index];
+    return start->timeUs == 0 ? NULL : start;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+/*
+ * Post mortem trace: the latest scheduler task starts, long task executions,
+ * bus errors and fault frames are recorded into rings in RAM that the startup
+ * code does not clear. They survive software, watchdog and fault resets, and
+ * can be read back over MSP or with the CLI "trace" command afterwards.
+ */
+
+typedef enum {
+    TRACE_EVENT_NONE = 0,
+    TRACE_EVENT_BOOT,               // data: MCU reset flags
+    TRACE_EVENT_LONG_TASK,          // id: task, data: execution time [us]
+    TRACE_EVENT_BUS_ERROR,          // id: bus device, data: device address
+    TRACE_EVENT_FAULT_PC,           // data: stacked PC
+    TRACE_EVENT_FAULT_LR,           // data: stacked LR
+    TRACE_EVENT_FAULT_STATUS,       // data: CFSR
+} traceEventType_e;
+
+#define TRACE_RING_EVENT_COUNT      32
+#define TRACE_RING_TASK_COUNT       16
+#define TRACE_RING_LONG_TASK_US     2000    // Task executions above this are recorded
+
+// Long tasks and bus errors are only recorded while armed. On the ground the
+// CLI, calibrations and sensor probing would push the previous flight out.
+
+typedef struct traceEvent_s {
+    uint32_t timeUs;                // Since boot
+    uint32_t data;
+    uint16_t boot;                  // Boot the event was recorded in, see traceRingBootCount()
+    uint8_t type;                   // traceEventType_e
+    uint8_t id;
+} traceEvent_t;
+
+typedef struct traceTaskStart_s {
+    uint32_t timeUs;
+    uint8_t taskId;
+} traceTaskStart_t;
+
+#ifdef USE_TRACE_RING
+
+void traceRingInit(void);
+void traceRingRecord(traceEventType_e type, uint8_t id, uint32_t data);
+void traceRingTaskStart(uint8_t taskId, uint32_t timeUs);
+void traceRingTaskEnd(uint8_t taskId, uint32_t executionTimeUs);
+void traceRingBusError(uint8_t device, uint8_t address);
+void traceRingRecordFault(const uint32_t *stackFrame);
+void traceRingClear(void);
+
+uint16_t traceRingBootCount(void);
+// index 0 is the newest entry, returns NULL past the recorded ones
+const traceEvent_t *traceRingGetEvent(unsigned index);
+// Task starts recorded before the last reset
+const traceTaskStart_t *traceRingGetTaskStart(unsigned index);
+
+#define TRACE_RING_BUS_ERROR(device, address)   traceRingBusError(device, address)
+#else
+#define TRACE_RING_BUS_ERROR(device, address)
+#endif
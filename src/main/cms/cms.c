@@ -85,6 +85,10 @@ static uint8_t entry_flags[32];
 #define SET_PRINTVALUE(p, row) { entry_flags[row] |= PRINT_VALUE; }
 #define CLR_PRINTVALUE(p, row) { entry_flags[row] &= ~PRINT_VALUE; }
 
+// Hash of the value text last written to each screen row, polled values
+// that come back unchanged are not sent to the display again.
+static uint32_t entry_value_hash[32];
+
 #define IS_PRINTLABEL(p, row) (entry_flags[row] & PRINT_LABEL)
 #define SET_PRINTLABEL(p, row) { entry_flags[row] |= PRINT_LABEL; }
 #define CLR_PRINTLABEL(p, row) { entry_flags[row] &= ~PRINT_LABEL; }
@@ -329,6 +333,29 @@ static void cmsPadToSize(char *buf, int size)
     cmsPadLeftToSize(buf, size);
 }
 
+static uint32_t cmsValueHash(const char *buff, int colpos)
+{
+    // FNV-1a, zero is kept for rows without a value on screen
+    uint32_t hash = 2166136261U ^ colpos;
+    for (; *buff; buff++) {
+        hash = (hash ^ (uint8_t)*buff) * 16777619U;
+    }
+    return hash ? hash : 1;
+}
+
+static int cmsWriteValue(displayPort_t *pDisplay, uint8_t col, uint8_t row, const char *text)
+{
+    if (row < ARRAYLEN(entry_value_hash)) {
+        const uint32_t hash = cmsValueHash(text, col);
+        if (entry_value_hash[row] == hash) {
+            return 0;
+        }
+        entry_value_hash[row] = hash;
+    }
+
+    return displayWrite(pDisplay, col, row, text);
+}
+
 static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row, uint8_t maxSize)
 {
     int colpos;
@@ -336,7 +363,7 @@ static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row
 
     cmsPadToSize(buff, maxSize);
     colpos = rightMenuColumn - maxSize;
-    cnt = displayWrite(pDisplay, colpos, row, buff);
+    cnt = cmsWriteValue(pDisplay, colpos, row, buff);
     return cnt;
 }
 
@@ -569,7 +596,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
                 }
             }
             if (text) {
-                cnt = displayWrite(pDisplay,
+                cnt = cmsWriteValue(pDisplay,
                         leftMenuColumn + 1 + (uint8_t) strlen(p->text), row, text);
             }
             CLR_PRINTVALUE(p, screenRow);
@@ -619,6 +646,7 @@ static void cmsDrawMenu(displayPort_t *pDisplay, uint32_t currentTimeUs)
     if (pDisplay->cleared) {
         // Mark all labels and values for printing
         memset(entry_flags, PRINT_LABEL | PRINT_VALUE, sizeof(entry_flags));
+        memset(entry_value_hash, 0, sizeof(entry_value_hash));
         pDisplay->cleared = false;
     } else if (drawPolled) {
         for (p = pageTop, i = 0; p <= pageTop + pageMaxRow; p++, i++) {
@@ -21,23 +21,6 @@
 
 #include "bitarray.h"
 
-#define BITARRAY_BIT_OP(array, bit, op) ((array)[(bit) / (sizeof((array)[0]) * 8)] op (1 << ((bit) % (sizeof((array)[0]) * 8))))
-
-bool bitArrayGet(const bitarrayElement_t *array, unsigned bit)
-{
-    return BITARRAY_BIT_OP((uint32_t*)array, bit, &);
-}
-
-void bitArraySet(bitarrayElement_t *array, unsigned bit)
-{
-    BITARRAY_BIT_OP((uint32_t*)array, bit, |=);
-}
-
-void bitArrayClr(bitarrayElement_t *array, unsigned bit)
-{
-    BITARRAY_BIT_OP((uint32_t*)array, bit, &=~);
-}
-
 void bitArraySetAll(bitarrayElement_t *array, size_t size)
 {
     memset(array, 0xFF, size);
@@ -56,11 +39,12 @@ __attribute__((always_inline)) static inline uint8_t __CTZ(uint32_t val)
     // For other architectures, explicitely implement the same
     // semantics.
 #ifdef __arm__
-    uint8_t zc;
-    __asm__ volatile ("rbit %1, %1\n\t"
-                      "clz %0, %1"
-                    : "=r" (zc)
-                    : "r" (val) );
+    // rbit goes to the output register, val is an input only operand
+    uint32_t zc;
+    __asm__ ("rbit %0, %1\n\t"
+             "clz %0, %0"
+           : "=r" (zc)
+           : "r" (val) );
     return zc;
 #else
     // __builtin_clz is not defined for zero, since it's arch
@@ -91,3 +75,28 @@ int bitArrayFindFirstSet(const bitarrayElement_t *array, unsigned start, size_t
     }
     return -1;
 }
+
+void bitArrayAnd(bitarrayElement_t *dest, const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size)
+{
+    for (size_t i = 0; i < size / sizeof(bitarrayElement_t); i++) {
+        dest[i] = a[i] & b[i];
+    }
+}
+
+void bitArrayOr(bitarrayElement_t *dest, const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size)
+{
+    for (size_t i = 0; i < size / sizeof(bitarrayElement_t); i++) {
+        dest[i] = a[i] | b[i];
+    }
+}
+
+int bitArrayFindFirstDiff(const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size)
+{
+    for (size_t i = 0; i < size / sizeof(bitarrayElement_t); i++) {
+        const uint8_t ret = __CTZ(a[i] ^ b[i]);
+        if (ret != 32) {
+            return i * 32 + ret;
+        }
+    }
+    return -1;
+}
@@ -19,6 +19,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /*
  * These functions expect array to be 4-byte aligned since they alias array
@@ -30,9 +31,24 @@ typedef uint32_t bitarrayElement_t;
 
 #define BITARRAY_DECLARE(name, bits) bitarrayElement_t name[(bits + 31) / 32]
 
-bool bitArrayGet(const bitarrayElement_t *array, unsigned bit);
-void bitArraySet(bitarrayElement_t *array, unsigned bit);
-void bitArrayClr(bitarrayElement_t *array, unsigned bit);
+#define BITARRAY_WORD(bit) ((bit) / 32)
+#define BITARRAY_MASK(bit) (1u << ((bit) % 32))
+
+// Single bit accessors are inlined, they come down to one load and a mask
+static inline bool bitArrayGet(const bitarrayElement_t *array, unsigned bit)
+{
+    return array[BITARRAY_WORD(bit)] & BITARRAY_MASK(bit);
+}
+
+static inline void bitArraySet(bitarrayElement_t *array, unsigned bit)
+{
+    array[BITARRAY_WORD(bit)] |= BITARRAY_MASK(bit);
+}
+
+static inline void bitArrayClr(bitarrayElement_t *array, unsigned bit)
+{
+    array[BITARRAY_WORD(bit)] &= ~BITARRAY_MASK(bit);
+}
 
 void bitArraySetAll(bitarrayElement_t *array, size_t size);
 void bitArrayClrAll(bitarrayElement_t *array, size_t size);
@@ -47,3 +63,16 @@ void bitArrayClrAll(bitarrayElement_t *array, size_t size);
 int bitArrayFindFirstSet(const bitarrayElement_t *array, unsigned start_bit, size_t size);
 
 #define BITARRAY_FIND_FIRST_SET(array, start_bit) bitArrayFindFirstSet(array, start_bit, sizeof(array))
+
+// Word-wise bulk operations over arrays of size bytes. dest may be
+// the same array as either of the operands.
+void bitArrayAnd(bitarrayElement_t *dest, const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size);
+void bitArrayOr(bitarrayElement_t *dest, const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size);
+
+// Returns the first bit that differs between a and b, or -1 if both
+// arrays are equal.
+int bitArrayFindFirstDiff(const bitarrayElement_t *a, const bitarrayElement_t *b, size_t size);
+
+#define BITARRAY_AND(dest, a, b) bitArrayAnd(dest, a, b, sizeof(dest))
+#define BITARRAY_OR(dest, a, b) bitArrayOr(dest, a, b, sizeof(dest))
+#define BITARRAY_FIND_FIRST_DIFF(a, b) bitArrayFindFirstDiff(a, b, sizeof(a))
@@ -20,6 +20,39 @@
 #include "color.h"
 #include "colorconversion.h"
 
+/*
+ * Hue position inside a 60 degree sector scaled to 0..255, replaces the per channel division by 60
+ */
+static const uint8_t hueSectorRamp[60] = {
+      0,   4,   8,  12,  17,  21,  25,  29,  34,  38,  42,  46,
+     51,  55,  59,  64,  68,  72,  76,  81,  85,  89,  93,  98,
+    102, 106, 110, 115, 119, 123, 128, 132, 136, 140, 145, 149,
+    153, 157, 162, 166, 170, 174, 179, 183, 187, 192, 196, 200,
+    204, 209, 213, 217, 221, 226, 230, 234, 238, 243, 247, 251,
+};
+
+/*
+ * 2.2 gamma, WS2811 output is linear in PWM duty while perceived brightness is not
+ */
+static const uint8_t gammaTable[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
 /*
  * Source below found here: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
  */
@@ -41,14 +74,18 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
 
         base = ((255 - sat) * val) >> 8;
 
+        const uint32_t span = val - base;
+        const uint8_t rising = ((span * hueSectorRamp[hue % 60]) >> 8) + base;
+        const uint8_t falling = ((span * (256 - hueSectorRamp[hue % 60])) >> 8) + base;
+
         switch (hue / 60) {
             case 0:
             r.rgb.r = val;
-            r.rgb.g = (((val - base) * hue) / 60) + base;
+            r.rgb.g = rising;
             r.rgb.b = base;
             break;
             case 1:
-            r.rgb.r = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.r = falling;
             r.rgb.g = val;
             r.rgb.b = base;
             break;
@@ -56,17 +93,17 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
             case 2:
             r.rgb.r = base;
             r.rgb.g = val;
-            r.rgb.b = (((val - base) * (hue % 60)) / 60) + base;
+            r.rgb.b = rising;
             break;
 
             case 3:
             r.rgb.r = base;
-            r.rgb.g = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.g = falling;
             r.rgb.b = val;
             break;
 
             case 4:
-            r.rgb.r = (((val - base) * (hue % 60)) / 60) + base;
+            r.rgb.r = rising;
             r.rgb.g = base;
             r.rgb.b = val;
             break;
@@ -74,7 +111,7 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
             case 5:
             r.rgb.r = val;
             r.rgb.g = base;
-            r.rgb.b = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.b = falling;
             break;
 
         }
@@ -82,3 +119,9 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
     return &r;
 }
 
+void rgb24ApplyGamma(rgbColor24bpp_t *c)
+{
+    c->rgb.r = gammaTable[c->rgb.r];
+    c->rgb.g = gammaTable[c->rgb.g];
+    c->rgb.b = gammaTable[c->rgb.b];
+}
@@ -17,3 +17,4 @@
 #pragma once
 
 rgbColor24bpp_t* hsvToRgb24(const hsvColor_t *c);
+void rgb24ApplyGamma(rgbColor24bpp_t *c);
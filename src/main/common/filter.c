@@ -43,6 +43,12 @@ float nullFilterApply4(void *filter, float input, float f_cut, float dt)
     return input;
 }
 
+void nullFilterApplyAxes(filter_t *filter, float *values)
+{
+    UNUSED(filter);
+    UNUSED(values);
+}
+
 // PT1 Low Pass filter
 
 static float pt1ComputeRC(const float f_cut)
@@ -78,12 +84,17 @@ void pt1FilterUpdateCutoff(pt1Filter_t *filter, float f_cut)
     filter->alpha = filter->dT / (filter->RC + filter->dT);
 }
 
-float FAST_CODE NOINLINE pt1FilterApply(pt1Filter_t *filter, float input)
+static inline float pt1FilterStep(pt1Filter_t *filter, float input)
 {
     filter->state = filter->state + filter->alpha * (input - filter->state);
     return filter->state;
 }
 
+float FAST_CODE NOINLINE pt1FilterApply(pt1Filter_t *filter, float input)
+{
+    return pt1FilterStep(filter, input);
+}
+
 float pt1FilterApply3(pt1Filter_t *filter, float input, float dT)
 {
     filter->dT = dT;
@@ -104,11 +115,40 @@ float FAST_CODE NOINLINE pt1FilterApply4(pt1Filter_t *filter, float input, float
     return filter->state;
 }
 
+// pt1FilterApply4() for all axes, the coefficient is computed once and shared
+void FAST_CODE pt1FilterApplyAxes4(filter_t *filter, float *values, float f_cut, float dT)
+{
+    if (!filter[0].pt1.RC) {
+        filter[0].pt1.RC = pt1ComputeRC(f_cut);
+    }
+
+    const float alpha = dT / (filter[0].pt1.RC + dT);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1Filter_t *pt1 = &filter[axis].pt1;
+        pt1->RC = filter[0].pt1.RC;
+        pt1->dT = dT;
+        pt1->alpha = alpha;
+        pt1->state = pt1->state + alpha * (values[axis] - pt1->state);
+        values[axis] = pt1->state;
+    }
+}
+
 void pt1FilterReset(pt1Filter_t *filter, float input)
 {
     filter->state = input;
 }
 
+// One call for all axes, coefficients of all axes stay in registers
+void FAST_CODE pt1FilterApplyAxes(filter_t *filter, float *values)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1Filter_t *pt1 = &filter[axis].pt1;
+        pt1->state = pt1->state + pt1->alpha * (values[axis] - pt1->state);
+        values[axis] = pt1->state;
+    }
+}
+
 /*
  * PT2 LowPassFilter
  */
@@ -134,13 +174,18 @@ void pt2FilterUpdateCutoff(pt2Filter_t *filter, float k)
     filter->k = k;
 }
 
-FAST_CODE float pt2FilterApply(pt2Filter_t *filter, float input)
+static inline float pt2FilterStep(pt2Filter_t *filter, float input)
 {
     filter->state1 = filter->state1 + filter->k * (input - filter->state1);
     filter->state = filter->state + filter->k * (filter->state1 - filter->state);
     return filter->state;
 }
 
+FAST_CODE float pt2FilterApply(pt2Filter_t *filter, float input)
+{
+    return pt2FilterStep(filter, input);
+}
+
 /*
  * PT3 LowPassFilter
  */
@@ -167,7 +212,7 @@ void pt3FilterUpdateCutoff(pt3Filter_t *filter, float k)
     filter->k = k;
 }
 
-FAST_CODE float pt3FilterApply(pt3Filter_t *filter, float input)
+static inline float pt3FilterStep(pt3Filter_t *filter, float input)
 {
     filter->state1 = filter->state1 + filter->k * (input - filter->state1);
     filter->state2 = filter->state2 + filter->k * (filter->state1 - filter->state2);
@@ -175,6 +220,11 @@ FAST_CODE float pt3FilterApply(pt3Filter_t *filter, float input)
     return filter->state;
 }
 
+FAST_CODE float pt3FilterApply(pt3Filter_t *filter, float input)
+{
+    return pt3FilterStep(filter, input);
+}
+
 // rate_limit = maximum rate of change of the output value in units per second
 void rateLimitFilterInit(rateLimitFilter_t *filter)
 {
@@ -222,6 +272,42 @@ static void biquadFilterSetupPassthrough(biquadFilter_t *filter)
     filter->a2 = 0.0f;
 }
 
+/*
+ * Coefficients normalized by a0 from sin and cos of omega, one division for all five
+ */
+static FAST_CODE bool biquadFilterSetCoefficients(biquadFilter_t *filter, float sn, float cs, float Q, biquadFilterType_e filterType)
+{
+    const float alpha = sn / (2 * Q);
+
+    float b0, b1, b2;
+    switch (filterType) {
+        case FILTER_LPF:
+            b0 = (1 - cs) / 2;
+            b1 = 1 - cs;
+            b2 = (1 - cs) / 2;
+            break;
+        case FILTER_NOTCH:
+            b0 = 1;
+            b1 = -2 * cs;
+            b2 = 1;
+            break;
+        default:
+            return false;
+    }
+    const float a0Inverse = 1.0f / (1 + alpha);
+    const float a1 = -2 * cs;
+    const float a2 =  1 - alpha;
+
+    // precompute the coefficients
+    filter->b0 = b0 * a0Inverse;
+    filter->b1 = b1 * a0Inverse;
+    filter->b2 = b2 * a0Inverse;
+    filter->a1 = a1 * a0Inverse;
+    filter->a2 = a2 * a0Inverse;
+
+    return true;
+}
+
 void biquadFilterInit(biquadFilter_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType)
 {
     // Check for Nyquist frequency and if it's not possible to initialize filter as requested - set to no filtering at all
@@ -229,36 +315,10 @@ void biquadFilterInit(biquadFilter_t *filter, uint16_t filterFreq, uint32_t samp
         // setup variables
         const float sampleRate = 1.0f / ((float)samplingIntervalUs * 0.000001f);
         const float omega = 2.0f * M_PIf * ((float)filterFreq) / sampleRate;
-        const float sn = sin_approx(omega);
-        const float cs = cos_approx(omega);
-        const float alpha = sn / (2 * Q);
-
-        float b0, b1, b2;
-        switch (filterType) {
-            case FILTER_LPF:
-                b0 = (1 - cs) / 2;
-                b1 = 1 - cs;
-                b2 = (1 - cs) / 2;
-                break;
-            case FILTER_NOTCH:
-                b0 = 1;
-                b1 = -2 * cs;
-                b2 = 1;
-                break;
-            default:
-                biquadFilterSetupPassthrough(filter);
-                return;
+
+        if (!biquadFilterSetCoefficients(filter, sin_approx(omega), cos_approx(omega), Q, filterType)) {
+            biquadFilterSetupPassthrough(filter);
         }
-        const float a0 =  1 + alpha;
-        const float a1 = -2 * cs;
-        const float a2 =  1 - alpha;
-
-        // precompute the coefficients
-        filter->b0 = b0 / a0;
-        filter->b1 = b1 / a0;
-        filter->b2 = b2 / a0;
-        filter->a1 = a1 / a0;
-        filter->a2 = a2 / a0;
     } else {
         biquadFilterSetupPassthrough(filter);
     }
@@ -268,6 +328,71 @@ void biquadFilterInit(biquadFilter_t *filter, uint16_t filterFreq, uint32_t samp
     filter->y1 = filter->y2 = 0;
 }
 
+/*
+ * Quarter wave sine table for runtime coefficient updates. Linear interpolation over
+ * BIQUAD_SIN_TABLE_SIZE intervals keeps the error below 1e-4, well under sin_approx()
+ */
+#define BIQUAD_SIN_TABLE_SIZE   64
+
+static float biquadSinTable[BIQUAD_SIN_TABLE_SIZE + 1];
+static bool biquadSinTableReady;
+
+static void biquadSinTableInit(void)
+{
+    for (int i = 0; i <= BIQUAD_SIN_TABLE_SIZE; i++) {
+        biquadSinTable[i] = sinf(i * (M_PIf / 2) / BIQUAD_SIN_TABLE_SIZE);
+    }
+    biquadSinTableReady = true;
+}
+
+// x in [0, pi/2]
+static FAST_CODE float biquadQuarterSin(float x)
+{
+    const float position = x * (BIQUAD_SIN_TABLE_SIZE / (M_PIf / 2));
+    const int index = (int)position;
+
+    if (index >= BIQUAD_SIN_TABLE_SIZE) {
+        return biquadSinTable[BIQUAD_SIN_TABLE_SIZE];
+    }
+
+    const float fraction = position - index;
+    return biquadSinTable[index] + fraction * (biquadSinTable[index + 1] - biquadSinTable[index]);
+}
+
+// omega in [0, pi], guaranteed by the Nyquist check
+static FAST_CODE void biquadSinCos(float omega, float *sn, float *cs)
+{
+    if (!biquadSinTableReady) {
+        biquadSinTableInit();
+    }
+
+    if (omega <= M_PIf / 2) {
+        *sn = biquadQuarterSin(omega);
+        *cs = biquadQuarterSin(M_PIf / 2 - omega);
+    } else {
+        *sn = biquadQuarterSin(M_PIf - omega);
+        *cs = -biquadQuarterSin(omega - M_PIf / 2);
+    }
+}
+
+/*
+ * Recompute coefficients from the sine table, state is kept. For filters retuned at runtime
+ */
+static FAST_CODE void biquadFilterUpdateCoefficients(biquadFilter_t *filter, float filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType)
+{
+    if (filterFreq > 0.0f && filterFreq < 500000.0f / samplingIntervalUs) {
+        const float omega = 2.0f * M_PIf * filterFreq * samplingIntervalUs * 0.000001f;
+        float sn, cs;
+
+        biquadSinCos(omega, &sn, &cs);
+        if (biquadFilterSetCoefficients(filter, sn, cs, Q, filterType)) {
+            return;
+        }
+    }
+
+    biquadFilterSetupPassthrough(filter);
+}
+
 FAST_CODE float biquadFilterApplyDF1(biquadFilter_t *filter, float input)
 {
     /* compute result */
@@ -284,8 +409,7 @@ FAST_CODE float biquadFilterApplyDF1(biquadFilter_t *filter, float input)
     return result;
 }
 
-// Computes a biquad_t filter on a sample
-float FAST_CODE NOINLINE biquadFilterApply(biquadFilter_t *filter, float input)
+static inline float biquadFilterStep(biquadFilter_t *filter, float input)
 {
     const float result = filter->b0 * input + filter->x1;
     filter->x1 = filter->b1 * input - filter->a1 * result + filter->x2;
@@ -293,6 +417,24 @@ float FAST_CODE NOINLINE biquadFilterApply(biquadFilter_t *filter, float input)
     return result;
 }
 
+// Computes a biquad_t filter on a sample
+float FAST_CODE NOINLINE biquadFilterApply(biquadFilter_t *filter, float input)
+{
+    return biquadFilterStep(filter, input);
+}
+
+void FAST_CODE biquadFilterApplyAxes(filter_t *filter, float *values)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilter_t *biquad = &filter[axis].biquad;
+        const float input = values[axis];
+        const float result = biquad->b0 * input + biquad->x1;
+        biquad->x1 = biquad->b1 * input - biquad->a1 * result + biquad->x2;
+        biquad->x2 = biquad->b2 * input - biquad->a2 * result;
+        values[axis] = result;
+    }
+}
+
 float biquadFilterReset(biquadFilter_t *filter, float value)
 {
     filter->x1 = value - (value * filter->b0);
@@ -302,19 +444,133 @@ float biquadFilterReset(biquadFilter_t *filter, float value)
 
 FAST_CODE void biquadFilterUpdate(biquadFilter_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
 {
-    // backup state
-    float x1 = filter->x1;
-    float x2 = filter->x2;
-    float y1 = filter->y1;
-    float y2 = filter->y2;
+    biquadFilterUpdateCoefficients(filter, filterFreq, refreshRate, Q, filterType);
+}
+
+void biquadFilterBankInit(biquadFilterBank_t *bank, uint8_t stageCount)
+{
+    bank->stageCount = MIN(stageCount, BIQUAD_FILTER_BANK_MAX_STAGES);
+
+    for (int stage = 0; stage < bank->stageCount; stage++) {
+        float *coeffs = &bank->coeffs[stage * 5];
+        coeffs[0] = 1.0f;
+        coeffs[1] = coeffs[2] = coeffs[3] = coeffs[4] = 0.0f;
+    }
+
+    memset(bank->state, 0, sizeof(bank->state));
+
+#ifdef USE_ARM_MATH
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        arm_biquad_cascade_df1_init_f32(&bank->instance[axis], bank->stageCount, bank->coeffs, bank->state[axis]);
+    }
+#endif
+}
+
+/*
+ * Recompute coefficients of a single stage, keeping the state of all axes
+ */
+FAST_CODE void biquadFilterBankUpdate(biquadFilterBank_t *bank, uint8_t stage, float filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType)
+{
+    if (stage >= bank->stageCount) {
+        return;
+    }
+
+    biquadFilter_t filter;
+    biquadFilterUpdateCoefficients(&filter, filterFreq, samplingIntervalUs, Q, filterType);
+
+    float *coeffs = &bank->coeffs[stage * 5];
+    coeffs[0] = filter.b0;
+    coeffs[1] = filter.b1;
+    coeffs[2] = filter.b2;
+    coeffs[3] = -filter.a1;
+    coeffs[4] = -filter.a2;
+}
+
+/*
+ * Notch with partial attenuation: H = (1 - depth) + depth * Hnotch. Both share the
+ * denominator, so the blend is still a single biquad stage
+ */
+FAST_CODE void biquadFilterBankUpdateNotch(biquadFilterBank_t *bank, uint8_t stage, float filterFreq, uint32_t samplingIntervalUs, float Q, float depth)
+{
+    if (stage >= bank->stageCount) {
+        return;
+    }
 
-    biquadFilterInit(filter, filterFreq, refreshRate, Q, filterType);
+    biquadFilter_t filter;
+    biquadFilterUpdateCoefficients(&filter, filterFreq, samplingIntervalUs, Q, FILTER_NOTCH);
 
-    // restore state
-    filter->x1 = x1;
-    filter->x2 = x2;
-    filter->y1 = y1;
-    filter->y2 = y2;
+    const float passThrough = 1.0f - depth;
+    float *coeffs = &bank->coeffs[stage * 5];
+    coeffs[0] = passThrough + depth * filter.b0;
+    coeffs[1] = passThrough * filter.a1 + depth * filter.b1;
+    coeffs[2] = passThrough * filter.a2 + depth * filter.b2;
+    coeffs[3] = -filter.a1;
+    coeffs[4] = -filter.a2;
+}
+
+/*
+ * Change the number of active stages without touching coefficients or state, stages
+ * past the new count are not run. Capacity is BIQUAD_FILTER_BANK_MAX_STAGES
+ */
+void biquadFilterBankSetStageCount(biquadFilterBank_t *bank, uint8_t stageCount)
+{
+    bank->stageCount = MIN(stageCount, BIQUAD_FILTER_BANK_MAX_STAGES);
+
+#ifdef USE_ARM_MATH
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        bank->instance[axis].numStages = bank->stageCount;
+    }
+#endif
+}
+
+void biquadFilterBankMoveStageState(biquadFilterBank_t *bank, uint8_t fromStage, uint8_t toStage)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        memcpy(&bank->state[axis][toStage * 4], &bank->state[axis][fromStage * 4], 4 * sizeof(float));
+    }
+}
+
+void biquadFilterBankResetStageState(biquadFilterBank_t *bank, uint8_t stage)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        memset(&bank->state[axis][stage * 4], 0, 4 * sizeof(float));
+    }
+}
+
+/*
+ * Run all stages on X, Y and Z, values are filtered in place
+ */
+FAST_CODE void biquadFilterBankApply(biquadFilterBank_t *bank, float *values)
+{
+    // CMSIS-DSP kernel does not handle an empty cascade
+    if (bank->stageCount == 0) {
+        return;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+#ifdef USE_ARM_MATH
+        arm_biquad_cascade_df1_f32(&bank->instance[axis], &values[axis], &values[axis], 1);
+#else
+        float sample = values[axis];
+        const float *coeffs = bank->coeffs;
+        float *state = bank->state[axis];
+
+        for (int stage = 0; stage < bank->stageCount; stage++) {
+            const float result = coeffs[0] * sample + coeffs[1] * state[0] + coeffs[2] * state[1] + coeffs[3] * state[2] + coeffs[4] * state[3];
+
+            state[1] = state[0];
+            state[0] = sample;
+            state[3] = state[2];
+            state[2] = result;
+
+            sample = result;
+            coeffs += 5;
+            state += 4;
+        }
+
+        values[axis] = sample;
+#endif
+    }
 }
 
 FUNCTION_COMPILE_FOR_SIZE
@@ -348,4 +604,137 @@ void assignFilterApplyFn(uint8_t filterType, float cutoffFrequency, filterApplyF
             *applyFn = (filterApplyFnPtr) biquadFilterApply;
         }
     }
-}
\ No newline at end of file
+}
+
+/*
+ * Takes over the coefficients of another filter of the layout applyFn runs on
+ * and keeps the state, a running filter moves to a new cutoff without a step
+ */
+void filterUpdateCoefficients(filterApplyFnPtr applyFn, filter_t *filter, const filter_t *coefficients)
+{
+    if (applyFn == (filterApplyFnPtr) pt1FilterApply) {
+        filter->pt1.RC = coefficients->pt1.RC;
+        filter->pt1.dT = coefficients->pt1.dT;
+        filter->pt1.alpha = coefficients->pt1.alpha;
+    } else if (applyFn == (filterApplyFnPtr) pt2FilterApply) {
+        filter->pt2.k = coefficients->pt2.k;
+    } else if (applyFn == (filterApplyFnPtr) pt3FilterApply) {
+        filter->pt3.k = coefficients->pt3.k;
+    } else if (applyFn == (filterApplyFnPtr) biquadFilterApply) {
+        filter->biquad.b0 = coefficients->biquad.b0;
+        filter->biquad.b1 = coefficients->biquad.b1;
+        filter->biquad.b2 = coefficients->biquad.b2;
+        filter->biquad.a1 = coefficients->biquad.a1;
+        filter->biquad.a2 = coefficients->biquad.a2;
+    }
+}
+
+#ifdef USE_FILTER_CHAIN_SPECIALIZATION
+/*
+ * Two stage chains for every pair of apply functions assignFilterApplyFn() can
+ * pick, run over all three axes. Both stages are inlined into one function, a
+ * chain costs a single indirect call per loop and a disabled stage costs nothing.
+ */
+static inline float filterChainStageNull(filter_t *filter, float input)
+{
+    UNUSED(filter);
+    return input;
+}
+
+static inline float filterChainStagePt1(filter_t *filter, float input)
+{
+    return pt1FilterStep(&filter->pt1, input);
+}
+
+static inline float filterChainStagePt2(filter_t *filter, float input)
+{
+    return pt2FilterStep(&filter->pt2, input);
+}
+
+static inline float filterChainStagePt3(filter_t *filter, float input)
+{
+    return pt3FilterStep(&filter->pt3, input);
+}
+
+static inline float filterChainStageBiquad(filter_t *filter, float input)
+{
+    return biquadFilterStep(&filter->biquad, input);
+}
+
+// Order matches filterChainStageApplyFns[] and the rows of filterChain2ApplyAxesFns[]
+#define FILTER_CHAIN_STAGE_COUNT 5
+
+#define FILTER_CHAIN2_DEFINE(first, second) \
+    static FAST_CODE void filterChain2ApplyAxes##first##second(filter_t *firstFilter, filter_t *secondFilter, float *values) \
+    { \
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) { \
+            values[axis] = filterChainStage##second(&secondFilter[axis], filterChainStage##first(&firstFilter[axis], values[axis])); \
+        } \
+    }
+
+#define FILTER_CHAIN2_DEFINE_ROW(first) \
+    FILTER_CHAIN2_DEFINE(first, Null) \
+    FILTER_CHAIN2_DEFINE(first, Pt1) \
+    FILTER_CHAIN2_DEFINE(first, Pt2) \
+    FILTER_CHAIN2_DEFINE(first, Pt3) \
+    FILTER_CHAIN2_DEFINE(first, Biquad)
+
+#define FILTER_CHAIN2_TABLE_ROW(first) \
+    { \
+        filterChain2ApplyAxes##first##Null, \
+        filterChain2ApplyAxes##first##Pt1, \
+        filterChain2ApplyAxes##first##Pt2, \
+        filterChain2ApplyAxes##first##Pt3, \
+        filterChain2ApplyAxes##first##Biquad, \
+    }
+
+FILTER_CHAIN2_DEFINE_ROW(Null)
+FILTER_CHAIN2_DEFINE_ROW(Pt1)
+FILTER_CHAIN2_DEFINE_ROW(Pt2)
+FILTER_CHAIN2_DEFINE_ROW(Pt3)
+FILTER_CHAIN2_DEFINE_ROW(Biquad)
+
+static const filterChain2ApplyAxesFnPtr filterChain2ApplyAxesFns[FILTER_CHAIN_STAGE_COUNT][FILTER_CHAIN_STAGE_COUNT] = {
+    FILTER_CHAIN2_TABLE_ROW(Null),
+    FILTER_CHAIN2_TABLE_ROW(Pt1),
+    FILTER_CHAIN2_TABLE_ROW(Pt2),
+    FILTER_CHAIN2_TABLE_ROW(Pt3),
+    FILTER_CHAIN2_TABLE_ROW(Biquad),
+};
+
+static int filterChainStageIndex(filterApplyFnPtr applyFn)
+{
+    static const filterApplyFnPtr filterChainStageApplyFns[FILTER_CHAIN_STAGE_COUNT] = {
+        nullFilterApply,
+        (filterApplyFnPtr) pt1FilterApply,
+        (filterApplyFnPtr) pt2FilterApply,
+        (filterApplyFnPtr) pt3FilterApply,
+        (filterApplyFnPtr) biquadFilterApply,
+    };
+
+    for (int i = 0; i < FILTER_CHAIN_STAGE_COUNT; i++) {
+        if (filterChainStageApplyFns[i] == applyFn) {
+            return i;
+        }
+    }
+
+    // assignFilterApplyFn() never picks anything else
+    return 0;
+}
+
+/*
+ * Picks the stages exactly like two assignFilterApplyFn() calls would and
+ * returns the chain applying both of them
+ */
+FUNCTION_COMPILE_FOR_SIZE
+filterChain2ApplyAxesFnPtr assignFilterChain2ApplyAxesFn(uint8_t firstType, float firstCutoff, uint8_t secondType, float secondCutoff)
+{
+    filterApplyFnPtr firstApplyFn;
+    filterApplyFnPtr secondApplyFn;
+
+    assignFilterApplyFn(firstType, firstCutoff, &firstApplyFn);
+    assignFilterApplyFn(secondType, secondCutoff, &secondApplyFn);
+
+    return filterChain2ApplyAxesFns[filterChainStageIndex(firstApplyFn)][filterChainStageIndex(secondApplyFn)];
+}
+#endif
@@ -17,6 +17,12 @@
 
 #pragma once
 
+#include "common/axis.h"
+
+#ifdef USE_ARM_MATH
+#include "arm_math.h"
+#endif
+
 typedef struct rateLimitFilter_s {
     float state;
 } rateLimitFilter_t;
@@ -45,6 +51,23 @@ typedef struct biquadFilter_s {
     float x1, x2, y1, y2;
 } biquadFilter_t;
 
+/*
+ * Cascade of biquad stages applied to all three axes at once. Coefficients are
+ * shared by the axes, only the DF1 state is kept per axis. Layout matches
+ * arm_biquad_cascade_df1_f32(): {b0, b1, b2, -a1, -a2} per stage and
+ * {x1, x2, y1, y2} per stage and axis
+ */
+#define BIQUAD_FILTER_BANK_MAX_STAGES   24      // MAX_SUPPORTED_MOTORS x 3 harmonics
+
+typedef struct biquadFilterBank_s {
+    uint8_t stageCount;
+    float coeffs[BIQUAD_FILTER_BANK_MAX_STAGES * 5];
+    float state[XYZ_AXIS_COUNT][BIQUAD_FILTER_BANK_MAX_STAGES * 4];
+#ifdef USE_ARM_MATH
+    arm_biquad_casd_df1_inst_f32 instance[XYZ_AXIS_COUNT];
+#endif
+} biquadFilterBank_t;
+
 typedef union { 
     biquadFilter_t biquad; 
     pt1Filter_t pt1;
@@ -85,12 +108,17 @@ typedef struct alphaBetaGammaFilter_s {
 
 typedef float (*filterApplyFnPtr)(void *filter, float input);
 typedef float (*filterApply4FnPtr)(void *filter, float input, float f_cut, float dt);
+// Applies filter[X], filter[Y] and filter[Z] of the same type to values[XYZ_AXIS_COUNT] in place
+typedef void (*filterApplyAxesFnPtr)(filter_t *filter, float *values);
+// Applies first[X..Z] and then second[X..Z] to values[XYZ_AXIS_COUNT] in place, both stages specialized into a single function
+typedef void (*filterChain2ApplyAxesFnPtr)(filter_t *first, filter_t *second, float *values);
 
 #define BIQUAD_BANDWIDTH 1.9f     /* bandwidth in octaves */
 #define BIQUAD_Q 1.0f / sqrtf(2.0f)     /* quality factor - butterworth*/
 
 float nullFilterApply(void *filter, float input);
 float nullFilterApply4(void *filter, float input, float f_cut, float dt);
+void nullFilterApplyAxes(filter_t *filter, float *values);
 
 void pt1FilterInit(pt1Filter_t *filter, float f_cut, float dT);
 void pt1FilterInitRC(pt1Filter_t *filter, float tau, float dT);
@@ -101,6 +129,8 @@ float pt1FilterApply(pt1Filter_t *filter, float input);
 float pt1FilterApply3(pt1Filter_t *filter, float input, float dT);
 float pt1FilterApply4(pt1Filter_t *filter, float input, float f_cut, float dt);
 void pt1FilterReset(pt1Filter_t *filter, float input);
+void pt1FilterApplyAxes(filter_t *filter, float *values);
+void pt1FilterApplyAxes4(filter_t *filter, float *values, float f_cut, float dT);
 
 /*
  * PT2 LowPassFilter
@@ -126,12 +156,25 @@ void biquadFilterInitLPF(biquadFilter_t *filter, uint16_t filterFreq, uint32_t s
 void biquadFilterInit(biquadFilter_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType);
 float biquadFilterApply(biquadFilter_t *filter, float sample);
 float biquadFilterReset(biquadFilter_t *filter, float value);
+void biquadFilterApplyAxes(filter_t *filter, float *values);
 float biquadFilterApplyDF1(biquadFilter_t *filter, float input);
 float filterGetNotchQ(float centerFrequencyHz, float cutoffFrequencyHz);
 void biquadFilterUpdate(biquadFilter_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
 
+void biquadFilterBankInit(biquadFilterBank_t *bank, uint8_t stageCount);
+void biquadFilterBankUpdate(biquadFilterBank_t *bank, uint8_t stage, float filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType);
+void biquadFilterBankUpdateNotch(biquadFilterBank_t *bank, uint8_t stage, float filterFreq, uint32_t samplingIntervalUs, float Q, float depth);
+void biquadFilterBankSetStageCount(biquadFilterBank_t *bank, uint8_t stageCount);
+void biquadFilterBankMoveStageState(biquadFilterBank_t *bank, uint8_t fromStage, uint8_t toStage);
+void biquadFilterBankResetStageState(biquadFilterBank_t *bank, uint8_t stage);
+void biquadFilterBankApply(biquadFilterBank_t *bank, float *values);
+
 void alphaBetaGammaFilterInit(alphaBetaGammaFilter_t *filter, float alpha, float boostGain, float halfLife, float dT);
 float alphaBetaGammaFilterApply(alphaBetaGammaFilter_t *filter, float input);
 
 void initFilter(uint8_t filterType, filter_t *filter, float cutoffFrequency, uint32_t refreshRate);
-void assignFilterApplyFn(uint8_t filterType, float cutoffFrequency, filterApplyFnPtr *applyFn);
\ No newline at end of file
+void assignFilterApplyFn(uint8_t filterType, float cutoffFrequency, filterApplyFnPtr *applyFn);
+void filterUpdateCoefficients(filterApplyFnPtr applyFn, filter_t *filter, const filter_t *coefficients);
+#ifdef USE_FILTER_CHAIN_SPECIALIZATION
+filterChain2ApplyAxesFnPtr assignFilterChain2ApplyAxesFn(uint8_t firstType, float firstCutoff, uint8_t secondType, float secondCutoff);
+#endif
\ No newline at end of file
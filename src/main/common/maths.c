@@ -48,6 +48,13 @@ FILE_COMPILE_FOR_SPEED
 #define sinPolyCoef9  2.600054768e-6f                                          // Double:  2.600054767890361277123254766503271638682e-6
 #endif
 
+// Valid for -90..+90 Degree, written as a chain of multiply-adds
+static inline float sinPoly(float x)
+{
+    const float x2 = x * x;
+    return x + x * x2 * (sinPolyCoef3 + x2 * (sinPolyCoef5 + x2 * (sinPolyCoef7 + x2 * sinPolyCoef9)));
+}
+
 float sin_approx(float x)
 {
     int32_t xint = x;
@@ -56,8 +63,7 @@ float sin_approx(float x)
     while (x < -M_PIf) x += (2.0f * M_PIf);
     if (x >  (0.5f * M_PIf)) x =  (0.5f * M_PIf) - (x - (0.5f * M_PIf));   // We just pick -90..+90 Degree
     else if (x < -(0.5f * M_PIf)) x = -(0.5f * M_PIf) - ((0.5f * M_PIf) + x);
-    float x2 = x * x;
-    return x + x * x2 * (sinPolyCoef3 + x2 * (sinPolyCoef5 + x2 * (sinPolyCoef7 + x2 * sinPolyCoef9)));
+    return sinPoly(x);
 }
 
 float cos_approx(float x)
@@ -65,6 +71,31 @@ float cos_approx(float x)
     return sin_approx(x + (0.5f * M_PIf));
 }
 
+// Both from one range reduction: after folding x into -90..+90 Degree, cos(x) = sin(90 Degree - |x|)
+void sincos_approx(float x, float *sinx, float *cosx)
+{
+    int32_t xint = x;
+    if (xint < -32 || xint > 32) {                                          // Same error output as sin_approx() and cos_approx()
+        *sinx = 0.0f;
+        *cosx = 0.0f;
+        return;
+    }
+    while (x >  M_PIf) x -= (2.0f * M_PIf);
+    while (x < -M_PIf) x += (2.0f * M_PIf);
+
+    float cosSign = 1.0f;
+    if (x > (0.5f * M_PIf)) {
+        x = M_PIf - x;
+        cosSign = -1.0f;
+    } else if (x < -(0.5f * M_PIf)) {
+        x = -M_PIf - x;
+        cosSign = -1.0f;
+    }
+
+    *sinx = sinPoly(x);
+    *cosx = cosSign * sinPoly((0.5f * M_PIf) - fabsf(x));
+}
+
 // https://github.com/Crashpilot1000/HarakiriWebstore1/blob/396715f73c6fcf859e0db0f34e12fe44bace6483/src/mw.c#L1292
 // http://http.developer.nvidia.com/Cg/atan2.html (not working correctly!)
 // Poly coefficients by @ledvinap (https://github.com/cleanflight/cleanflight/pull/1107)
@@ -105,8 +136,21 @@ float acos_approx(float x)
     else
         return result;
 }
+#else
+void sincos_approx(float x, float *sinx, float *cosx)
+{
+    *sinx = sinf(x);
+    *cosx = cosf(x);
+}
 #endif
 
+void sincos_approx_array(const float *x, float *sinx, float *cosx, int count)
+{
+    for (int i = 0; i < count; i++) {
+        sincos_approx(x[i], &sinx[i], &cosx[i]);
+    }
+}
+
 int gcd(int num, int denom)
 {
     if (denom == 0) {
@@ -227,15 +271,14 @@ float scaleRangef(float x, float srcMin, float srcMax, float destMin, float dest
 // Build rMat from Tait–Bryan angles (convention X1, Y2, Z3)
 void rotationMatrixFromAngles(fpMat3_t * rmat, const fp_angles_t * angles)
 {
-    float cosx, sinx, cosy, siny, cosz, sinz;
+    float s[3], c[3];
     float coszcosx, sinzcosx, coszsinx, sinzsinx;
 
-    cosx = cos_approx(angles->angles.roll);
-    sinx = sin_approx(angles->angles.roll);
-    cosy = cos_approx(angles->angles.pitch);
-    siny = sin_approx(angles->angles.pitch);
-    cosz = cos_approx(angles->angles.yaw);
-    sinz = sin_approx(angles->angles.yaw);
+    sincos_approx_array(angles->raw, s, c, 3);
+
+    const float cosx = c[0], sinx = s[0];
+    const float cosy = c[1], siny = s[1];
+    const float cosz = c[2], sinz = s[2];
 
     coszcosx = cosz * cosx;
     sinzcosx = sinz * cosx;
@@ -255,8 +298,8 @@ void rotationMatrixFromAngles(fpMat3_t * rmat, const fp_angles_t * angles)
 
 void rotationMatrixFromAxisAngle(fpMat3_t * rmat, const fpAxisAngle_t * a)
 {
-    const float sang = sin_approx(a->angle);
-    const float cang = cos_approx(a->angle);
+    float sang, cang;
+    sincos_approx(a->angle, &sang, &cang);
     const float C = 1.0f - cang;
 
     const float xC  = a->axis.x * C;
@@ -518,12 +561,94 @@ bool sensorCalibrationSolveForScale(sensorCalibrationState_t * state, float resu
     return sensorCalibrationValidateResult(result);
 }
 
+/*
+ * Incremental ellipsoid fit for in-flight sensor calibration. Samples are expected
+ * to be roughly normalized, the fit starts from the unit sphere. Every sample costs
+ * a fixed 6x6 covariance update, no matrix inversion.
+ */
+#define ELLIPSOID_FIT_INITIAL_COVARIANCE    10.0f
+
+void ellipsoidFitReset(ellipsoidFitState_t * state, float forgetting)
+{
+    for (int i = 0; i < ELLIPSOID_FIT_PARAM_COUNT; i++) {
+        for (int j = 0; j < ELLIPSOID_FIT_PARAM_COUNT; j++) {
+            state->P[i][j] = (i == j) ? ELLIPSOID_FIT_INITIAL_COVARIANCE : 0.0f;
+        }
+        state->theta[i] = (i < 3) ? 1.0f : 0.0f;
+    }
+
+    state->forgetting = forgetting;
+    state->sampleCount = 0;
+}
+
+void ellipsoidFitPushSample(ellipsoidFitState_t * state, const float sample[3])
+{
+    const float phi[ELLIPSOID_FIT_PARAM_COUNT] = {
+        sample[0] * sample[0], sample[1] * sample[1], sample[2] * sample[2],
+        sample[0], sample[1], sample[2]
+    };
+
+    float Pphi[ELLIPSOID_FIT_PARAM_COUNT];
+    float denom = state->forgetting;
+    float error = 1.0f;
+
+    for (int i = 0; i < ELLIPSOID_FIT_PARAM_COUNT; i++) {
+        Pphi[i] = 0.0f;
+        for (int j = 0; j < ELLIPSOID_FIT_PARAM_COUNT; j++) {
+            Pphi[i] += state->P[i][j] * phi[j];
+        }
+        denom += phi[i] * Pphi[i];
+        error -= phi[i] * state->theta[i];
+    }
+
+    const float invDenom = 1.0f / denom;
+    const float invForgetting = 1.0f / state->forgetting;
+
+    // P is symmetric, so is Pphi * Pphi'
+    for (int i = 0; i < ELLIPSOID_FIT_PARAM_COUNT; i++) {
+        const float gain = Pphi[i] * invDenom;
+        state->theta[i] += gain * error;
+
+        for (int j = i; j < ELLIPSOID_FIT_PARAM_COUNT; j++) {
+            state->P[i][j] = (state->P[i][j] - gain * Pphi[j]) * invForgetting;
+            state->P[j][i] = state->P[i][j];
+        }
+    }
+
+    state->sampleCount++;
+}
+
+bool ellipsoidFitSolve(const ellipsoidFitState_t * state, float offset[3], float radius[3])
+{
+    float g = 1.0f;
+
+    for (int i = 0; i < 3; i++) {
+        // Also rejects NaN
+        if (!(state->theta[i] > 0.0f)) {
+            return false;
+        }
+
+        offset[i] = -state->theta[i + 3] / (2.0f * state->theta[i]);
+        g += state->theta[i] * offset[i] * offset[i];
+    }
+
+    if (!(g > 0.0f)) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        radius[i] = fast_fsqrtf(g / state->theta[i]);
+    }
+
+    return sensorCalibrationValidateResult(offset) && sensorCalibrationValidateResult(radius);
+}
+
 float bellCurve(const float x, const float curveWidth)
 {
     return powf(M_Ef, -sq(x) / (2.0f * sq(curveWidth)));
 }
 
-float fast_fsqrtf(const double value) {
+float fast_fsqrtf(const float value) {
     float ret = 0.0f;
 #ifdef USE_ARM_MATH
     arm_sqrt_f32(value, &ret);
@@ -142,6 +142,20 @@ void sensorCalibrationPushSampleForScaleCalculation(sensorCalibrationState_t * s
 bool sensorCalibrationSolveForOffset(sensorCalibrationState_t * state, float result[3]);
 bool sensorCalibrationSolveForScale(sensorCalibrationState_t * state, float result[3]);
 
+#define ELLIPSOID_FIT_PARAM_COUNT   6
+
+// Recursive least squares fit of an axis-aligned ellipsoid Ax^2 + By^2 + Cz^2 + Dx + Ey + Fz = 1
+typedef struct {
+    float theta[ELLIPSOID_FIT_PARAM_COUNT];
+    float P[ELLIPSOID_FIT_PARAM_COUNT][ELLIPSOID_FIT_PARAM_COUNT];
+    float forgetting;
+    uint32_t sampleCount;
+} ellipsoidFitState_t;
+
+void ellipsoidFitReset(ellipsoidFitState_t * state, float forgetting);
+void ellipsoidFitPushSample(ellipsoidFitState_t * state, const float sample[3]);
+bool ellipsoidFitSolve(const ellipsoidFitState_t * state, float offset[3], float radius[3]);
+
 int gcd(int num, int denom);
 int32_t applyDeadband(int32_t value, int32_t deadband);
 int32_t applyDeadbandRescaled(int32_t value, int32_t deadband, int32_t min, int32_t max);
@@ -184,10 +198,12 @@ float acos_approx(float x);
 #define acos_approx(x)      acosf(x)
 #define tan_approx(x)       tanf(x)
 #endif
+void sincos_approx(float x, float *sinx, float *cosx);
+void sincos_approx_array(const float *x, float *sinx, float *cosx, int count);
 
 void arraySubInt32(int32_t *dest, int32_t *array1, int32_t *array2, int count);
 
 float bellCurve(const float x, const float curveWidth);
-float fast_fsqrtf(const double value);
+float fast_fsqrtf(const float value);
 float calc_length_pythagorean_2D(const float firstElement, const float secondElement);
 float calc_length_pythagorean_3D(const float firstElement, const float secondElement, const float thirdElement);
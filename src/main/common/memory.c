@@ -28,6 +28,7 @@
 #include "platform.h"
 
 #include "common/log.h"
+#include "common/maths.h"
 #include "common/memory.h"
 
 #include "drivers/resource.h"
@@ -38,10 +39,24 @@
 #define DYNAMIC_HEAP_SIZE   (2048)
 #endif
 
+#if !defined(DYNAMIC_HEAP_ARENA_SIZE)
+#define DYNAMIC_HEAP_ARENA_SIZE     (0)
+#endif
+
 static uint32_t dynHeap[DYNAMIC_HEAP_SIZE / sizeof(uint32_t)];
 static uint32_t dynHeapFreeWord = 0;
 static size_t dynHeapUsage[OWNER_TOTAL_COUNT];
 
+/*
+ * The arena holds the large buffers of optional subsystems. It is claimed at boot, in priority order, only by
+ * the subsystems the active configuration uses, so the space an unused feature would have held statically
+ * lets the next one grow. Its size is the sum target/common_post.h budgets for the optional buffers.
+ */
+#if DYNAMIC_HEAP_ARENA_SIZE > 0
+static uint32_t dynArena[DYNAMIC_HEAP_ARENA_SIZE / sizeof(uint32_t)];
+#endif
+static uint32_t dynArenaFreeWord = 0;
+
 void * memAllocate(size_t wantedSize, resourceOwner_e owner)
 {
     void * retPointer = NULL;
@@ -63,6 +78,45 @@ void * memAllocate(size_t wantedSize, resourceOwner_e owner)
     return retPointer;
 }
 
+/*
+ * Claim up to maxSize bytes of the arena, but not less than minSize. The size handed out is stored in
+ * allocatedSize when given. Returns NULL and leaves the arena untouched when minSize doesn't fit.
+ */
+void * memAllocateArena(size_t minSize, size_t maxSize, size_t *allocatedSize, resourceOwner_e owner)
+{
+    const size_t availableBytes = memGetArenaAvailableBytes();
+
+    if (minSize > availableBytes || minSize > maxSize) {
+        LOG_E(SYSTEM, "Arena too small for %d bytes", (int)minSize);
+        return NULL;
+    }
+
+    const size_t size = MIN(maxSize, availableBytes) & ~(sizeof(uint32_t) - 1);
+#if DYNAMIC_HEAP_ARENA_SIZE > 0
+    void * const retPointer = &dynArena[dynArenaFreeWord];
+#else
+    void * const retPointer = NULL;
+#endif
+    dynArenaFreeWord += size / sizeof(uint32_t);
+    dynHeapUsage[owner] += size;
+
+    if (allocatedSize) {
+        *allocatedSize = size;
+    }
+
+    return retPointer;
+}
+
+size_t memGetArenaAvailableBytes(void)
+{
+    return DYNAMIC_HEAP_ARENA_SIZE / sizeof(uint32_t) * sizeof(uint32_t) - dynArenaFreeWord * sizeof(uint32_t);
+}
+
+size_t memGetArenaSize(void)
+{
+    return DYNAMIC_HEAP_ARENA_SIZE;
+}
+
 size_t memGetUsedBytesByOwner(resourceOwner_e owner)
 {
     return (owner == OWNER_FREE) ? memGetAvailableBytes() : dynHeapUsage[owner];
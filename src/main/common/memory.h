@@ -30,3 +30,6 @@
 size_t memGetAvailableBytes(void);
 size_t memGetUsedBytesByOwner(resourceOwner_e owner);
 void * memAllocate(size_t wantedSize, resourceOwner_e owner);
+void * memAllocateArena(size_t minSize, size_t maxSize, size_t *allocatedSize, resourceOwner_e owner);
+size_t memGetArenaAvailableBytes(void);
+size_t memGetArenaSize(void);
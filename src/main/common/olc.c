@@ -1,4 +1,5 @@
-#include <math.h>
+#include <stdbool.h>
+#include <string.h>
 
 #include "common/maths.h"
 #include "common/olc.h"
@@ -23,39 +24,36 @@
 
 static const char alphabet[] = "23456789CFGHJMPQRVWX";
 
-// Initialized via init_constants()
-static olc_coord_t grid_size;
-static olc_coord_t initial_resolution;
-
-static void init_constants(void)
+// The first pair digit covers 20 degrees, the largest power of the base
+// that fits in 360 degrees. The grid starts at the resolution of the last
+// pair, 20^-3 degrees.
+#define INITIAL_RESOLUTION (ENCODING_BASE * OLC_DEG_MULTIPLIER)
+#define GRID_SIZE (OLC_DEG_MULTIPLIER / (ENCODING_BASE * ENCODING_BASE * ENCODING_BASE))
+
+// Compute the latitude precision value (deg * OLC_DEG_MULTIPLIER) for a given
+// code length.  Lengths <= 10 have the same precision for latitude and
+// longitude, but lengths > 10 have different precisions due to the grid
+// method having fewer columns than rows.
+static int64_t compute_precision_for_length(int length)
 {
-    static bool inited = 0;
-    if (inited) {
-        return;
-    }
-    inited = 1;
-
-    // Work out the encoding base exponent necessary to represent 360 degrees.
-    olc_coord_t initial_exponent = floorf(logf(2 * (LON_MAX / OLC_DEG_MULTIPLIER)) / logf(ENCODING_BASE));
-
-    // Work out the enclosing resolution (in degrees) for the grid algorithm.
-    grid_size = (1 / powf(ENCODING_BASE, PAIR_CODE_LEN / 2 - (initial_exponent + 1))) * OLC_DEG_MULTIPLIER;
-
-    // Work out the initial resolution
-    initial_resolution = powf(ENCODING_BASE, initial_exponent) * OLC_DEG_MULTIPLIER;
-}
+    int64_t precision = OLC_DEG_MULTIPLIER;
 
-// Compute the latitude precision value for a given code length.  Lengths <= 10
-// have the same precision for latitude and longitude, but lengths > 10 have
-// different precisions due to the grid method having fewer columns than rows.
-static float compute_precision_for_length(int length)
-{
-    // Magic numbers!
     if (length <= (int)PAIR_CODE_LEN) {
-        return powf(ENCODING_BASE, floorf((length / -2) + 2));
+        // ENCODING_BASE ^ (2 - length / 2)
+        for (int exponent = 2 - length / 2; exponent > 0; exponent--) {
+            precision *= ENCODING_BASE;
+        }
+        for (int exponent = 2 - length / 2; exponent < 0; exponent++) {
+            precision /= ENCODING_BASE;
+        }
+        return precision;
     }
 
-    return powf(ENCODING_BASE, -3) / powf(5, length - (int)PAIR_CODE_LEN);
+    precision = GRID_SIZE;
+    for (int i = length - (int)PAIR_CODE_LEN; i > 0; i--) {
+        precision /= GRID_ROWS;
+    }
+    return precision;
 }
 
 static olc_coord_t adjust_latitude(olc_coord_t lat, size_t code_len)
@@ -68,8 +66,7 @@ static olc_coord_t adjust_latitude(olc_coord_t lat, size_t code_len)
     }
     if (lat >= LAT_MAX) {
         // Subtract half the code precision to get the latitude into the code area.
-        olc_coord_t precision = compute_precision_for_length(code_len) * OLC_DEG_MULTIPLIER;
-        lat -= precision / 2;
+        lat -= MAX(compute_precision_for_length(code_len) / 2, 1);
     }
     return lat;
 }
@@ -99,7 +96,7 @@ static unsigned encode_pairs(uolc_coord_t lat, uolc_coord_t lon, size_t length,
     }
 
     unsigned pos = 0;
-    olc_coord_t resolution = initial_resolution;
+    olc_coord_t resolution = INITIAL_RESOLUTION;
     // Add two digits on each pass.
     for (size_t digit_count = 0;
          digit_count < length;
@@ -156,8 +153,8 @@ static int encode_grid(uolc_coord_t lat, uolc_coord_t lon, size_t length,
 
     int pos = 0;
 
-    olc_coord_t lat_grid_size = grid_size;
-    olc_coord_t lon_grid_size = grid_size;
+    olc_coord_t lat_grid_size = GRID_SIZE;
+    olc_coord_t lon_grid_size = GRID_SIZE;
 
     lat %= lat_grid_size;
     lon %= lon_grid_size;
@@ -195,8 +192,6 @@ int olc_encode(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_
     uolc_coord_t alat = adjust_latitude(lat, length) + LAT_MAX;
     uolc_coord_t alon = normalize_longitude(lon) + LON_MAX;
 
-    init_constants();
-
     pos += encode_pairs(alat, alon, MIN(length, PAIR_CODE_LEN), buf + pos, bufsize - pos);
     // If the requested length indicates we want grid refined codes.
     if (length > PAIR_CODE_LEN) {
@@ -204,4 +199,35 @@ int olc_encode(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_
     }
     buf[pos] = '\0';
     return pos;
-}
\ No newline at end of file
+}
+int olc_encode_cached(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_t bufsize)
+{
+    // Codes with an even number of pair digits from 8 on, and codes with grid
+    // digits, are prefixes of the longest code of the same position. Except at
+    // the pole, where the latitude is adjusted by length.
+    static struct {
+        bool valid;
+        olc_coord_t lat;
+        olc_coord_t lon;
+        char code[CODE_LEN_MAX + 3];    // encode_grid() wants one spare byte
+    } cache;
+
+    length = MIN(length, CODE_LEN_MAX);
+
+    if (length < SEPARATOR_POS || (length < PAIR_CODE_LEN && (length & 1)) || lat >= LAT_MAX || (length + 1) >= bufsize) {
+        return olc_encode(lat, lon, length, buf, bufsize);
+    }
+
+    if (!cache.valid || cache.lat != lat || cache.lon != lon) {
+        olc_encode(lat, lon, CODE_LEN_MAX, cache.code, sizeof(cache.code));
+        cache.valid = true;
+        cache.lat = lat;
+        cache.lon = lon;
+    }
+
+    // Separator after the 8th digit, the last grid digit may be beyond OLC_DEG_MULTIPLIER
+    const size_t pos = MIN(length + 1, strlen(cache.code));
+    memcpy(buf, cache.code, pos);
+    buf[pos] = '\0';
+    return pos;
+}
@@ -11,4 +11,8 @@ typedef uint32_t uolc_coord_t;
 // olc_encodes the given coordinates in lat and lon (deg * OLC_DEG_MULTIPLIER)
 // as an OLC code of the given length. It returns the number of characters
 // written to buf.
-int olc_encode(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_t bufsize);
\ No newline at end of file
+int olc_encode(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_t bufsize);
+
+// Same as olc_encode(), but the code of the last position is kept and reused
+// until the position changes, whatever length is asked for.
+int olc_encode_cached(olc_coord_t lat, olc_coord_t lon, size_t length, char *buf, size_t bufsize);
\ No newline at end of file
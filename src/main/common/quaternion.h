@@ -160,40 +160,34 @@ static inline fpQuaternion_t * quaternionNormalize(fpQuaternion_t * result, cons
     return result;
 }
 
-static inline fpVector3_t * quaternionRotateVector(fpVector3_t * result, const fpVector3_t * vect, const fpQuaternion_t * ref)
+/*
+ * q * v * q' for a unit quaternion q = (q0, u), expanded to v + q0 * t + u x t with t = 2 * (u x v).
+ * 15 multiplies instead of the 32 of two quaternion products, each term being a multiply-add
+ * onto the previous one.
+ */
+static inline fpVector3_t * quaternionRotateVectorUnit(fpVector3_t * result, const fpVector3_t * vect, float q0, float q1, float q2, float q3)
 {
-    fpQuaternion_t vectQuat, refConj;
+    const float tx = 2.0f * (q2 * vect->z - q3 * vect->y);
+    const float ty = 2.0f * (q3 * vect->x - q1 * vect->z);
+    const float tz = 2.0f * (q1 * vect->y - q2 * vect->x);
 
-    vectQuat.q0 = 0;
-    vectQuat.q1 = vect->x;
-    vectQuat.q2 = vect->y;
-    vectQuat.q3 = vect->z;
+    fpVector3_t r;
+    r.x = vect->x + q0 * tx + (q2 * tz - q3 * ty);
+    r.y = vect->y + q0 * ty + (q3 * tx - q1 * tz);
+    r.z = vect->z + q0 * tz + (q1 * ty - q2 * tx);
 
-    quaternionConjugate(&refConj, ref);
-    quaternionMultiply(&vectQuat, &refConj, &vectQuat);
-    quaternionMultiply(&vectQuat, &vectQuat, ref);
-
-    result->x = vectQuat.q1;
-    result->y = vectQuat.q2;
-    result->z = vectQuat.q3;
+    *result = r;
     return result;
 }
 
-static inline fpVector3_t * quaternionRotateVectorInv(fpVector3_t * result, const fpVector3_t * vect, const fpQuaternion_t * ref)
+// ref' * v * ref, ref has to be normalized
+static inline fpVector3_t * quaternionRotateVector(fpVector3_t * result, const fpVector3_t * vect, const fpQuaternion_t * ref)
 {
-    fpQuaternion_t vectQuat, refConj;
-
-    vectQuat.q0 = 0;
-    vectQuat.q1 = vect->x;
-    vectQuat.q2 = vect->y;
-    vectQuat.q3 = vect->z;
-
-    quaternionConjugate(&refConj, ref);
-    quaternionMultiply(&vectQuat, ref, &vectQuat);
-    quaternionMultiply(&vectQuat, &vectQuat, &refConj);
+    return quaternionRotateVectorUnit(result, vect, ref->q0, -ref->q1, -ref->q2, -ref->q3);
+}
 
-    result->x = vectQuat.q1;
-    result->y = vectQuat.q2;
-    result->z = vectQuat.q3;
-    return result;
+// ref * v * ref', ref has to be normalized
+static inline fpVector3_t * quaternionRotateVectorInv(fpVector3_t * result, const fpVector3_t * vect, const fpQuaternion_t * ref)
+{
+    return quaternionRotateVectorUnit(result, vect, ref->q0, ref->q1, ref->q2, ref->q3);
 }
@@ -0,0 +1,74 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "common/spsc_ring.h"
+
+void spscRingInit(spscRing_t *ring, volatile uint8_t *buffer, uint32_t size)
+{
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+uint32_t spscRingWrite(spscRing_t *ring, const void *data, uint32_t length)
+{
+    const uint8_t *src = data;
+    uint32_t written = 0;
+
+    // At most two spans, up to the end of the buffer and from its start
+    for (int i = 0; i < 2 && written < length; i++) {
+        volatile uint8_t *span;
+        uint32_t count = spscRingWriteSpan(ring, &span);
+        if (count > length - written) {
+            count = length - written;
+        }
+        for (uint32_t n = 0; n < count; n++) {
+            span[n] = src[written + n];
+        }
+        spscRingCommitWrite(ring, count);
+        written += count;
+    }
+
+    return written;
+}
+
+uint32_t spscRingRead(spscRing_t *ring, void *data, uint32_t length)
+{
+    uint8_t *dst = data;
+    uint32_t read = 0;
+
+    for (int i = 0; i < 2 && read < length; i++) {
+        volatile uint8_t *span;
+        uint32_t count = spscRingReadSpan(ring, &span);
+        if (count > length - read) {
+            count = length - read;
+        }
+        for (uint32_t n = 0; n < count; n++) {
+            dst[read + n] = span[n];
+        }
+        spscRingCommitRead(ring, count);
+        read += count;
+    }
+
+    return read;
+}
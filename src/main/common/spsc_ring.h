@@ -0,0 +1,159 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Single producer, single consumer byte ring. Only the producer moves head and only
+ * the consumer moves tail, so an ISR or a DMA stream on one end and a task on the
+ * other need no locking. Head is published with release semantics after the data
+ * was written and read with acquire semantics before the data is, the same for tail
+ * in the other direction.
+ *
+ * The size must be a power of two and one slot always stays empty to tell a full
+ * ring from an empty one. Indices are kept wrapped, so a circular DMA stream can
+ * publish its position as the head directly.
+ *
+ * Spans give zero-copy access: the producer fills the contiguous free space at the
+ * head and commits what it wrote, the consumer does the same with the contiguous
+ * data at the tail. A wrapped ring takes two spans.
+ */
+typedef struct spscRing_s {
+    volatile uint8_t *buffer;
+    uint32_t size;
+    volatile uint32_t head;     // Next slot to write, only moved by the producer
+    volatile uint32_t tail;     // Next slot to read, only moved by the consumer
+} spscRing_t;
+
+void spscRingInit(spscRing_t *ring, volatile uint8_t *buffer, uint32_t size);
+uint32_t spscRingWrite(spscRing_t *ring, const void *data, uint32_t length);
+uint32_t spscRingRead(spscRing_t *ring, void *data, uint32_t length);
+
+static inline uint32_t spscRingLoadHead(const spscRing_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t spscRingLoadTail(const spscRing_t *ring)
+{
+    return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t spscRingCount(const spscRing_t *ring)
+{
+    return (spscRingLoadHead(ring) - spscRingLoadTail(ring)) & (ring->size - 1);
+}
+
+static inline uint32_t spscRingFree(const spscRing_t *ring)
+{
+    return (ring->size - 1) - spscRingCount(ring);
+}
+
+static inline bool spscRingIsEmpty(const spscRing_t *ring)
+{
+    return spscRingLoadHead(ring) == spscRingLoadTail(ring);
+}
+
+// Only while neither side is running, e.g. when a port is opened
+static inline void spscRingReset(spscRing_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+// Producer side
+
+static inline uint32_t spscRingWriteSpan(const spscRing_t *ring, volatile uint8_t **span)
+{
+    const uint32_t head = ring->head;
+    const uint32_t tail = spscRingLoadTail(ring);
+
+    *span = &ring->buffer[head];
+    if (tail > head) {
+        return tail - head - 1;
+    }
+    return ring->size - head - (tail == 0 ? 1 : 0);
+}
+
+static inline void spscRingCommitWrite(spscRing_t *ring, uint32_t length)
+{
+    __atomic_store_n(&ring->head, (ring->head + length) & (ring->size - 1), __ATOMIC_RELEASE);
+}
+
+// Drops the byte when the ring is full
+static inline bool spscRingPut(spscRing_t *ring, uint8_t data)
+{
+    const uint32_t head = ring->head;
+    const uint32_t next = (head + 1) & (ring->size - 1);
+
+    if (next == spscRingLoadTail(ring)) {
+        return false;
+    }
+
+    ring->buffer[head] = data;
+    __atomic_store_n(&ring->head, next, __ATOMIC_RELEASE);
+    return true;
+}
+
+// For a circular DMA stream as producer, head is wherever the stream has written up to
+static inline void spscRingSetHead(spscRing_t *ring, uint32_t head)
+{
+    // The position came from the stream registers, reads of the data must not move ahead of it
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    __atomic_store_n(&ring->head, head & (ring->size - 1), __ATOMIC_RELEASE);
+}
+
+// Consumer side
+
+static inline uint32_t spscRingReadSpan(const spscRing_t *ring, volatile uint8_t **span)
+{
+    const uint32_t head = spscRingLoadHead(ring);
+    const uint32_t tail = ring->tail;
+
+    *span = &ring->buffer[tail];
+    return (head >= tail ? head : ring->size) - tail;
+}
+
+static inline void spscRingCommitRead(spscRing_t *ring, uint32_t length)
+{
+    __atomic_store_n(&ring->tail, (ring->tail + length) & (ring->size - 1), __ATOMIC_RELEASE);
+}
+
+static inline bool spscRingGet(spscRing_t *ring, uint8_t *data)
+{
+    const uint32_t tail = ring->tail;
+
+    if (spscRingLoadHead(ring) == tail) {
+        return false;
+    }
+
+    *data = ring->buffer[tail];
+    __atomic_store_n(&ring->tail, (tail + 1) & (ring->size - 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+// Drops everything queued
+static inline void spscRingFlush(spscRing_t *ring)
+{
+    __atomic_store_n(&ring->tail, spscRingLoadHead(ring), __ATOMIC_RELEASE);
+}
@@ -14,6 +14,7 @@
  * You should have received a copy of the GNU General Public License
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
@@ -81,6 +82,42 @@ void i2a(int num, char *bf)
     ui2a(num, 10, 0, bf);
 }
 
+/*
+ * Decimal right aligned to at least width characters, same as "%<width>d"
+ * with pad ' ' or "%0<width>d" with pad '0' (the zeros go after the sign).
+ * Returns the number of characters written, bf is not terminated.
+ */
+int i2aPadded(int num, int width, char pad, char *bf)
+{
+    char digits[10];
+    int count = 0;
+    const bool negative = num < 0;
+    unsigned int value = negative ? -(unsigned int)num : (unsigned int)num;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    int written = 0;
+    if (pad != '0') {
+        while (written < width - count - negative) {
+            bf[written++] = pad;
+        }
+    }
+    if (negative) {
+        bf[written++] = '-';
+    }
+    while (written < width - count) {
+        bf[written++] = '0';
+    }
+    while (count) {
+        bf[written++] = digits[--count];
+    }
+
+    return written;
+}
+
 int a2d(char ch)
 {
     if (ch >= '0' && ch <= '9')
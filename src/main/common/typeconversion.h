@@ -22,6 +22,7 @@ void uli2a(unsigned long int num, unsigned int base, int uc, char *bf);
 void li2a(long num, char *bf);
 void ui2a(unsigned int num, unsigned int base, int uc, char *bf);
 void i2a(int num, char *bf);
+int i2aPadded(int num, int width, char pad, char *bf);
 int a2d(char ch);
 char a2i(char ch, const char **src, int base, int *nump);
 char *ftoa(float x, char *floatString);
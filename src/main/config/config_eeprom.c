@@ -37,6 +37,9 @@
 #include "fc/config.h"
 
 static uint16_t eepromConfigSize;
+static uint16_t eepromBaseConfigSize;
+static uint16_t eepromBaseChecksum;
+static uint8_t eepromUpdateCount;
 
 typedef enum {
     CR_CLASSICATION_SYSTEM   = 0,
@@ -72,6 +75,19 @@ typedef struct {
 } PG_PACKED configFooter_t;
 // checksum is appended just after footer. It is not included in footer to make checksum calculation consistent
 
+// Header for an update appended after the saved copy. It's followed by the
+// records of the PGs that changed since the previous save and by the checksum
+// of the header and the records. Updates start at a streamer buffer boundary,
+// there is a gap of padding after each one.
+typedef struct {
+    uint16_t size;              // header and records, 0xFFFF is erased flash
+    uint16_t baseChecksum;      // checksum of the saved copy the update applies to
+    uint8_t sequence;           // 1 for the first update after a full save
+} PG_PACKED configUpdateHeader_t;
+
+#define CONFIG_UPDATE_ERASED    0xFFFF
+#define CONFIG_UPDATE_MAX_COUNT UINT8_MAX
+
 // Used to check the compiler packing at build time.
 typedef struct {
     uint8_t byte;
@@ -113,6 +129,7 @@ void initEEPROM(void)
     BUILD_BUG_ON(sizeof(configHeader_t) != 1);
     BUILD_BUG_ON(sizeof(configFooter_t) != 2);
     BUILD_BUG_ON(sizeof(configRecord_t) != 6);
+    BUILD_BUG_ON(sizeof(configUpdateHeader_t) != 5);
 
 #if defined(CONFIG_IN_EXTERNAL_FLASH)
     bool eepromLoaded = loadEEPROMFromExternalFlash();
@@ -123,6 +140,11 @@ void initEEPROM(void)
 #endif
 }
 
+static uint32_t alignUpdateOffset(uint32_t offset)
+{
+    return (offset + CONFIG_STREAMER_BUFFER_SIZE - 1) & ~(CONFIG_STREAMER_BUFFER_SIZE - 1);
+}
+
 // Scan the EEPROM config. Returns true if the config is valid.
 bool isEEPROMContentValid(void)
 {
@@ -164,7 +186,42 @@ bool isEEPROMContentValid(void)
     const uint16_t checkSum = *(uint16_t *)p;
     p += sizeof(checkSum);
     eepromConfigSize = p - &__config_start;
-    return crc == checkSum;
+    eepromBaseConfigSize = eepromConfigSize;
+    eepromBaseChecksum = checkSum;
+    eepromUpdateCount = 0;
+
+    if (crc != checkSum) {
+        return false;
+    }
+
+    // Apply the updates saved after the full copy, stop at the first one that's missing or damaged
+    for (;;) {
+        p = &__config_start + alignUpdateOffset(p - &__config_start);
+        const configUpdateHeader_t *update = (const configUpdateHeader_t *)p;
+
+        if (p + sizeof(*update) + sizeof(uint16_t) > &__config_end) {
+            break;
+        }
+
+        if (update->size == CONFIG_UPDATE_ERASED || update->size < sizeof(*update) || p + update->size + sizeof(uint16_t) > &__config_end) {
+            break;
+        }
+
+        if (update->baseChecksum != eepromBaseChecksum || update->sequence != eepromUpdateCount + 1) {
+            break;
+        }
+
+        const uint16_t updateChecksum = *(uint16_t *)(p + update->size);
+        if (crc16_ccitt_update(0, p, update->size) != updateChecksum) {
+            break;
+        }
+
+        p += update->size + sizeof(updateChecksum);
+        eepromConfigSize = p - &__config_start;
+        eepromUpdateCount++;
+    }
+
+    return true;
 }
 
 uint16_t getEEPROMConfigSize(void)
@@ -172,22 +229,19 @@ uint16_t getEEPROMConfigSize(void)
     return eepromConfigSize;
 }
 
-// find config record for reg + classification (profile info) in EEPROM
+// find config record for reg + classification (profile info) between p and end
 // return NULL when record is not found
-// this function assumes that EEPROM content is valid
-static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFlags_e classification)
+static const configRecord_t *findRecord(const uint8_t *p, const uint8_t *end, const pgRegistry_t *reg, configRecordFlags_e classification)
 {
-    const uint8_t *p = &__config_start;
-    p += sizeof(configHeader_t);             // skip header
     while (true) {
         const configRecord_t *record = (const configRecord_t *)p;
         // Ensure that the record header fits into config memory, otherwise accessing size and flags may cause a hardfault.
-        if (p + sizeof(*record) >= &__config_end) {
+        if (p + sizeof(*record) >= end) {
             break;
         }
 
         // Check that record header makes sense
-        if (record->size == 0 || p + record->size >= &__config_end || record->size < sizeof(*record)) {
+        if (record->size == 0 || p + record->size > end || record->size < sizeof(*record)) {
             break;
         }
 
@@ -202,32 +256,200 @@ static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFla
     return NULL;
 }
 
+// find the latest config record for reg + classification (profile info) in EEPROM
+// return NULL when record is not found
+// this function assumes that EEPROM content is valid
+static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFlags_e classification)
+{
+    const configRecord_t *found = findRecord(&__config_start + sizeof(configHeader_t), &__config_end, reg, classification);
+
+    // Later updates replace the record from the full copy
+    const uint8_t *p = &__config_start + eepromBaseConfigSize;
+    for (int i = 0; i < eepromUpdateCount; i++) {
+        p = &__config_start + alignUpdateOffset(p - &__config_start);
+        const configUpdateHeader_t *update = (const configUpdateHeader_t *)p;
+        const configRecord_t *record = findRecord(p + sizeof(*update), p + update->size, reg, classification);
+        if (record) {
+            found = record;
+        }
+        p += update->size + sizeof(uint16_t);
+    }
+
+    return found;
+}
+
+// Load the config records between p and end into their PGs, records of unknown PGs are skipped
+static void loadRecords(const uint8_t *p, const uint8_t *end)
+{
+    while (true) {
+        const configRecord_t *record = (const configRecord_t *)p;
+        // Same checks as findRecord()
+        if (p + sizeof(*record) >= end) {
+            break;
+        }
+
+        if (record->size == 0 || p + record->size > end || record->size < sizeof(*record)) {
+            break;
+        }
+
+        const pgRegistry_t *reg = pgFind(record->pgn);
+        const configRecordFlags_e cls = record->flags & CR_CLASSIFICATION_MASK;
+        if (reg && (pgIsSystem(reg) ? cls == CR_CLASSICATION_SYSTEM : cls >= CR_CLASSICATION_PROFILE1)) {
+            // pgLoad will handle version mismatch
+            const int profileIndex = pgIsSystem(reg) ? 0 : cls - CR_CLASSICATION_PROFILE1;
+            pgLoad(reg, profileIndex, record->pg, record->size - offsetof(configRecord_t, pg), record->version);
+        }
+
+        p += record->size;
+    }
+}
+
 // Initialize all PG records from EEPROM.
-// This functions processes all PGs sequentially, scanning EEPROM for each one. This is suboptimal,
-//   but each PG is loaded/initialized exactly once and in defined order.
+// All PGs start from their defaults, then the records are loaded in one pass over the saved copy and each update after
+//   it, so a record in a later update replaces the earlier one. This functions assumes that EEPROM content is valid.
 bool loadEEPROM(void)
 {
+    pgResetAll(MAX_PROFILE_COUNT);
+
+    loadRecords(&__config_start + sizeof(configHeader_t), &__config_end);
+
+    const uint8_t *p = &__config_start + eepromBaseConfigSize;
+    for (int i = 0; i < eepromUpdateCount; i++) {
+        p = &__config_start + alignUpdateOffset(p - &__config_start);
+        const configUpdateHeader_t *update = (const configUpdateHeader_t *)p;
+        loadRecords(p + sizeof(*update), p + update->size);
+        p += update->size + sizeof(uint16_t);
+    }
+
+    return true;
+}
+
+static configRecordFlags_e recordClassification(const pgRegistry_t *reg, int instance)
+{
+    return pgIsSystem(reg) ? CR_CLASSICATION_SYSTEM : ((instance + 1) & CR_CLASSIFICATION_MASK);
+}
+
+static bool writeRecord(config_streamer_t *streamer, const pgRegistry_t *reg, int instance, uint16_t *crc)
+{
+    const uint16_t regSize = pgSize(reg);
+    const configRecord_t record = {
+        .size = sizeof(configRecord_t) + regSize,
+        .pgn = pgN(reg),
+        .version = pgVersion(reg),
+        .flags = recordClassification(reg, instance),
+    };
+
+    if (config_streamer_write(streamer, (uint8_t *)&record, sizeof(record)) < 0) {
+        return false;
+    }
+    *crc = crc16_ccitt_update(*crc, (uint8_t *)&record, sizeof(record));
+
+    const uint8_t *address = reg->address + (regSize * instance);
+    if (config_streamer_write(streamer, address, regSize) < 0) {
+        return false;
+    }
+    *crc = crc16_ccitt_update(*crc, address, regSize);
+
+    return true;
+}
+
+// Returns true when the PG instance in RAM differs from its latest saved record
+static bool isRecordChanged(const pgRegistry_t *reg, int instance)
+{
+    const uint16_t regSize = pgSize(reg);
+    const configRecord_t *record = findEEPROM(reg, recordClassification(reg, instance));
+
+    return !record ||
+        record->version != pgVersion(reg) ||
+        record->size != sizeof(configRecord_t) + regSize ||
+        memcmp(record->pg, reg->address + (regSize * instance), regSize) != 0;
+}
+
+// Saves only the PGs that changed as an update after the saved config, this
+// doesn't need a flash erase. Returns false when the update doesn't fit into
+// the erased space left in the config region, the caller does a full save then.
+// Requires the EEPROM content to be valid.
+static bool appendSettingsToEEPROM(void)
+{
+    uint32_t recordsSize = 0;
     PG_FOREACH(reg) {
-        configRecordFlags_e cls_start, cls_end;
-        if (pgIsSystem(reg)) {
-            cls_start = CR_CLASSICATION_SYSTEM;
-            cls_end = CR_CLASSICATION_SYSTEM;
-        } else {
-            cls_start = CR_CLASSICATION_PROFILE1;
-            cls_end = CR_CLASSICATION_PROFILE_LAST;
+        const int instanceCount = pgIsSystem(reg) ? 1 : MAX_PROFILE_COUNT;
+        for (int instance = 0; instance < instanceCount; instance++) {
+            if (isRecordChanged(reg, instance)) {
+                recordsSize += sizeof(configRecord_t) + pgSize(reg);
+            }
+        }
+    }
+
+    if (recordsSize == 0) {
+        // Nothing to save
+        return true;
+    }
+
+    const uint32_t updateSize = sizeof(configUpdateHeader_t) + recordsSize;
+    if (updateSize >= CONFIG_UPDATE_ERASED || eepromUpdateCount == CONFIG_UPDATE_MAX_COUNT) {
+        return false;
+    }
+
+    uint8_t *start = &__config_start + alignUpdateOffset(eepromConfigSize);
+    const uint8_t *end = &__config_start + alignUpdateOffset(start - &__config_start + updateSize + sizeof(uint16_t));
+    if (end > &__config_end) {
+        return false;
+    }
+
+    // Flash can only be programmed once after an erase, the region after the saved config
+    // contains leftovers of older saves when it spans several sectors
+    for (const uint8_t *p = start; p < end; p++) {
+        if (*p != 0xFF) {
+            return false;
         }
-        for (configRecordFlags_e cls = cls_start; cls <= cls_end; cls++) {
-            int profileIndex = cls - cls_start;
-            const configRecord_t *rec = findEEPROM(reg, cls);
-            if (rec) {
-                // config from EEPROM is available, use it to initialize PG. pgLoad will handle version mismatch
-                pgLoad(reg, profileIndex, rec->pg, rec->size - offsetof(configRecord_t, pg), rec->version);
-            } else {
-                pgReset(reg, profileIndex);
+    }
+
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
+
+    config_streamer_start(&streamer, (uintptr_t)start, &__config_end - start);
+
+    const configUpdateHeader_t header = {
+        .size = updateSize,
+        .baseChecksum = eepromBaseChecksum,
+        .sequence = eepromUpdateCount + 1,
+    };
+
+    if (config_streamer_write(&streamer, (uint8_t *)&header, sizeof(header)) < 0) {
+        return false;
+    }
+    uint16_t crc = crc16_ccitt_update(0, (uint8_t *)&header, sizeof(header));
+
+    PG_FOREACH(reg) {
+        const int instanceCount = pgIsSystem(reg) ? 1 : MAX_PROFILE_COUNT;
+        for (int instance = 0; instance < instanceCount; instance++) {
+            if (isRecordChanged(reg, instance) && !writeRecord(&streamer, reg, instance, &crc)) {
+                return false;
             }
         }
     }
-    return true;
+
+    if (config_streamer_write(&streamer, (uint8_t *)&crc, sizeof(crc)) < 0) {
+        return false;
+    }
+
+    if (config_streamer_flush(&streamer) < 0) {
+        return false;
+    }
+
+    if (config_streamer_finish(&streamer) != 0) {
+        return false;
+    }
+
+#ifdef CONFIG_IN_EXTERNAL_FLASH
+    if (!loadEEPROMFromExternalFlash()) {
+        return false;
+    }
+#endif
+
+    const uint8_t previousUpdateCount = eepromUpdateCount;
+    return isEEPROMContentValid() && eepromUpdateCount == previousUpdateCount + 1;
 }
 
 static bool writeSettingsToEEPROM(void)
@@ -246,41 +468,12 @@ static bool writeSettingsToEEPROM(void)
     }
     uint16_t crc = crc16_ccitt_update(0, (uint8_t *)&header, sizeof(header));
     PG_FOREACH(reg) {
-        const uint16_t regSize = pgSize(reg);
-        configRecord_t record = {
-            .size = sizeof(configRecord_t) + regSize,
-            .pgn = pgN(reg),
-            .version = pgVersion(reg),
-            .flags = 0
-        };
-
-        if (pgIsSystem(reg)) {
-            // write the only instance
-            record.flags |= CR_CLASSICATION_SYSTEM;
-            if (config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record)) < 0) {
-                return false;
-            }
-            crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
-            if (config_streamer_write(&streamer, reg->address, regSize) < 0) {
+        // write the only instance or one instance for each profile
+        const int instanceCount = pgIsSystem(reg) ? 1 : MAX_PROFILE_COUNT;
+        for (int instance = 0; instance < instanceCount; instance++) {
+            if (!writeRecord(&streamer, reg, instance, &crc)) {
                 return false;
             }
-            crc = crc16_ccitt_update(crc, reg->address, regSize);
-        } else {
-            // write one instance for each profile
-            for (uint8_t profileIndex = 0; profileIndex < MAX_PROFILE_COUNT; profileIndex++) {
-                record.flags = 0;
-
-                record.flags |= ((profileIndex + 1) & CR_CLASSIFICATION_MASK);
-                if (config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record)) < 0) {
-                    return false;
-                }
-                crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
-                const uint8_t *address = reg->address + (regSize * profileIndex);
-                if (config_streamer_write(&streamer, address, regSize) < 0) {
-                    return false;
-                }
-                crc = crc16_ccitt_update(crc, address, regSize);
-            }
         }
     }
 
@@ -309,6 +502,11 @@ static bool writeSettingsToEEPROM(void)
 
 void writeConfigToEEPROM(void)
 {
+    // Saving only the changes is much faster, erasing a flash sector blocks for up to seconds
+    if (isEEPROMContentValid() && appendSettingsToEEPROM()) {
+        return;
+    }
+
     bool success = false;
     // write it
     for (int attempt = 0; attempt < 3 && !success; attempt++) {
@@ -37,7 +37,7 @@ void config_streamer_init(config_streamer_t *c)
 
 void config_streamer_start(config_streamer_t *c, uintptr_t base, int size)
 {
-    // base must start at FLASH_PAGE_SIZE boundary when using embedded flash.
+    // base must be aligned to the buffer size. When using embedded flash, a sector is erased when writing reaches its start.
     c->address = base;
     c->size = size;
     c->end = base + size;
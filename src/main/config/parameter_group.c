@@ -83,13 +83,33 @@ bool pgResetCopy(void *copy, pgn_t pgn)
     return false;
 }
 
+static void pgMigrate(const pgRegistry_t* reg, uint8_t *base, const void *from, int size, int version)
+{
+    for (const pgMigration_t *migration = __pg_migration_start; migration < __pg_migration_end; migration++) {
+        if (migration->reg != reg || migration->version != version) {
+            continue;
+        }
+
+        if (migration->fn) {
+            if (!migration->fn(base, from, size, version)) {
+                pgResetInstance(reg, base);
+            }
+        } else {
+            memcpy(base, from, MIN(size, migration->keepSize));
+        }
+        return;
+    }
+}
+
 void pgLoad(const pgRegistry_t* reg, int profileIndex, const void *from, int size, int version)
 {
     pgReset(reg, profileIndex);
-    // restore only matching version, keep defaults otherwise
+    // restore matching version, migrate older ones with a registered migration, keep defaults otherwise
     if (version == pgVersion(reg)) {
         const int take = MIN(size, pgSize(reg));
         memcpy(pgOffset(reg, profileIndex), from, take);
+    } else {
+        pgMigrate(reg, pgOffset(reg, profileIndex), from, size, version);
     }
 }
 
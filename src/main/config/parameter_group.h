@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -53,6 +54,18 @@ typedef struct pgRegistry_s {
     } reset;
 } pgRegistry_t;
 
+// function that loads a stored instance of an older version into a group instance holding the defaults.
+// Returns false when it can't, the defaults are kept then.
+typedef bool (pgMigrateFunc)(void * /* base */, const void * /* from */, int /* size */, uint8_t /* version */);
+
+// How to load the records saved by an older version of a group instead of resetting it
+typedef struct pgMigration_s {
+    const pgRegistry_t *reg;
+    uint8_t version;        // The stored version this applies to
+    uint16_t keepSize;      // Without fn, the leading bytes both versions share are kept and the rest is reset
+    pgMigrateFunc *fn;
+} pgMigration_t;
+
 static inline uint16_t pgN(const pgRegistry_t* reg) {return reg->pgn & PGR_PGN_MASK;}
 static inline uint8_t pgVersion(const pgRegistry_t* reg) {return (uint8_t)(reg->pgn >> 12);}
 static inline uint16_t pgSize(const pgRegistry_t* reg) {return reg->size & PGR_SIZE_MASK;}
@@ -69,6 +82,10 @@ extern const pgRegistry_t __pg_registry_end[] __asm("section$end$__DATA$__pg_reg
 extern const uint8_t __pg_resetdata_start[] __asm("section$start$__DATA$__pg_resetdata");
 extern const uint8_t __pg_resetdata_end[] __asm("section$end$__DATA$__pg_resetdata");
 #define PG_RESETDATA_ATTRIBUTES __attribute__ ((section("__DATA,__pg_resetdata"), used, aligned(2)))
+
+extern const pgMigration_t __pg_migration_start[] __asm("section$start$__DATA$__pg_migration");
+extern const pgMigration_t __pg_migration_end[] __asm("section$end$__DATA$__pg_migration");
+#define PG_MIGRATION_ATTRIBUTES __attribute__ ((section("__DATA,__pg_migration"), used, aligned(4)))
 #else
 extern const pgRegistry_t __pg_registry_start[];
 extern const pgRegistry_t __pg_registry_end[];
@@ -77,6 +94,10 @@ extern const pgRegistry_t __pg_registry_end[];
 extern const uint8_t __pg_resetdata_start[];
 extern const uint8_t __pg_resetdata_end[];
 #define PG_RESETDATA_ATTRIBUTES __attribute__ ((section(".pg_resetdata"), used, aligned(2)))
+
+extern const pgMigration_t __pg_migration_start[];
+extern const pgMigration_t __pg_migration_end[];
+#define PG_MIGRATION_ATTRIBUTES __attribute__ ((section(".pg_migration"), used, aligned(4)))
 #endif
 
 #define PG_REGISTRY_SIZE (__pg_registry_end - __pg_registry_start)
@@ -222,6 +243,30 @@ extern const uint8_t __pg_resetdata_end[];
     /**/
 
 
+// Register a migration of the records saved by version _version of a group.
+// Placed next to the PG_REGISTER of the group, _fn is a pgMigrateFunc.
+#define PG_REGISTER_MIGRATION(_name, _version, _fn)                     \
+    extern const pgRegistry_t _name ## _Registry;                       \
+    extern const pgMigration_t _name ## _Migration ## _version;         \
+    const pgMigration_t _name ## _Migration ## _version PG_MIGRATION_ATTRIBUTES = { \
+        .reg = &_name ## _Registry,                                     \
+        .version = _version,                                            \
+        .fn = _fn,                                                      \
+    }                                                                   \
+    /**/
+
+// Version _version of the group had the same fields up to, not including, _field. Fields from _field on are reset.
+// Covers the usual version bump that adds fields at the end.
+#define PG_REGISTER_MIGRATION_KEEP_UNTIL(_type, _name, _version, _field) \
+    extern const pgRegistry_t _name ## _Registry;                       \
+    extern const pgMigration_t _name ## _Migration ## _version;         \
+    const pgMigration_t _name ## _Migration ## _version PG_MIGRATION_ATTRIBUTES = { \
+        .reg = &_name ## _Registry,                                     \
+        .version = _version,                                            \
+        .keepSize = offsetof(_type, _field),                            \
+    }                                                                   \
+    /**/
+
 // Emit reset defaults for config.
 // Config must be registered with PG_REGISTER_<xxx>_WITH_RESET_TEMPLATE macro
 #define PG_RESET_TEMPLATE(_type, _name, ...)                            \
@@ -119,7 +119,10 @@
 #define PG_SECONDARY_IMU 1029
 #define PG_POWER_LIMITS_CONFIG 1030
 #define PG_OSD_COMMON_CONFIG 1031
-#define PG_INAV_END 1031
+#define PG_GEOZONE_CONFIG 1032
+#define PG_GEOZONE_VERTICES 1033
+#define PG_GPS_FAST_START 1034
+#define PG_INAV_END 1034
 
 // OSD configuration (subject to change)
 //#define PG_OSD_FONT_CONFIG 2047
@@ -245,7 +245,7 @@ static bool ds2482OwTriplet(owDev_t *owDev, uint8_t direction, uint8_t *result)
 
 static bool ds2482OwSkipRomCommand(owDev_t *owDev)
 {
-    return ds2482OwWriteByte(owDev, _1WIRE_SKIP_ROM_CMD);
+    return ds2482OwWriteByteCommand(owDev, _1WIRE_SKIP_ROM_CMD);
 }
 
 static bool ds2482OwSkipRom(owDev_t *owDev)
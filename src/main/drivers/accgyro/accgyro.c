@@ -77,6 +77,7 @@ const gyroFilterAndRateConfig_t * chooseGyroConfig(uint8_t desiredLpf, uint16_t
 static void gyroIntExtiHandler(extiCallbackRec_t *cb)
 {
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
+    gyro->dataReadyTimeUs = microsISR();
     gyro->dataReady = true;
     if (gyro->updateFn) {
         gyro->updateFn(gyro);
@@ -111,6 +112,7 @@ void gyroIntExtiInit(gyroDev_t *gyro)
     EXTIConfig(gyro->busDev->irqPin, &gyro->exti, NVIC_PRIO_GYRO_INT_EXTI, EXTI_Trigger_Rising);
     EXTIEnable(gyro->busDev->irqPin, true);
 #endif
+    gyro->dataReadyExtiEnabled = true;
 #endif
 }
 
@@ -31,6 +31,8 @@
 #define GYRO_LPF_5HZ        6
 #define GYRO_LPF_NONE       7
 
+#define GYRO_FIFO_MAX_SAMPLES   8
+
 typedef struct {
     uint8_t gyroLpf;
     uint16_t gyroRateHz;
@@ -52,8 +54,16 @@ typedef struct gyroDev_s {
     uint8_t lpf;                                        // Configuration value: Hardware LPF setting
     uint32_t requestedSampleIntervalUs;                 // Requested sample interval
     volatile bool dataReady;
+    volatile timeUs_t dataReadyTimeUs;                  // Time of the last data-ready interrupt
+    bool dataReadyExtiEnabled;                          // Data-ready interrupt is wired up and configured
     uint32_t sampleRateIntervalUs;                      // Gyro driver should set this to actual sampling rate as signaled by IRQ
     sensor_align_e gyroAlign;
+#ifdef USE_GYRO_FIFO_BURST_READ
+    bool fifoRequested;                                 // Configuration value: read samples in bursts from the sensor FIFO
+    bool fifoEnabled;                                   // Driver has configured the FIFO, readFn fills gyroADCRawFifo
+    uint8_t fifoSampleCount;                            // Number of samples fetched by the last readFn call, oldest first
+    int16_t gyroADCRawFifo[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT];
+#endif
 } gyroDev_t;
 
 typedef struct accDev_s {
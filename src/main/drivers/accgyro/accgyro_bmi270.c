@@ -94,6 +94,7 @@ typedef enum {
 #define BMI270_CHIP_ID 0x24
 
 #define BMI270_CMD_SOFTRESET 0xB6
+#define BMI270_CMD_FIFO_FLUSH 0xB0
 
 #define BMI270_PWR_CONF_HP 0x00
 #define BMI270_PWR_CTRL_GYR_EN 0x02
@@ -121,12 +122,19 @@ typedef enum {
 #define BMI270_BWP_OSR2 0x10
 #define BMI270_BWP_NORM 0x20
 
+#define BMI270_FIFO_CONFIG_0_STREAM 0x00
+#define BMI270_FIFO_CONFIG_1_GYR_EN 0x80
+#define BMI270_FIFO_DOWNS_GYR_FILT_DATA 0x08
+#define BMI270_FIFO_LENGTH_MASK 0x3FFF
+#define BMI270_FIFO_GYRO_FRAME_SIZE 6
+
 typedef struct __attribute__ ((__packed__)) bmi270ContextData_s {
     uint16_t    chipMagicNumber;
     uint8_t     lastReadStatus;
     uint8_t     __padding_dummy;
     uint8_t     accRaw[6];
     uint8_t     gyroRaw[6];
+    uint8_t     fifoEnabled;
 } bmi270ContextData_t;
 
 STATIC_ASSERT(sizeof(bmi270ContextData_t) < BUS_SCRATCHPAD_MEMORY_SIZE, busDevice_scratchpad_memory_too_small);
@@ -226,6 +234,14 @@ static void bmi270AccAndGyroInit(gyroDev_t *gyro)
 
     gyro->sampleRateIntervalUs = 1000000 / config->gyroRateHz;
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (gyro->fifoRequested) {
+        // Run at the highest ODR available for this LPF setting and buffer the samples
+        config = chooseGyroConfig(gyro->lpf, gyroConfigs[0].gyroRateHz, &gyroConfigs[0], ARRAYLEN(gyroConfigs));
+        gyro->sampleRateIntervalUs = 1000000 / config->gyroRateHz;
+    }
+#endif
+
     busWrite(busDev, BMI270_REG_GYRO_CONF, config->gyroConfigValues[0] | BMI270_GYRO_CONF_NOISE_PERF | BMI270_GYRO_CONF_FILTER_PERF);
     delay(1);
 
@@ -239,6 +255,26 @@ static void bmi270AccAndGyroInit(gyroDev_t *gyro)
     delay(1);
 #endif
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+    // Headerless stream mode with filtered gyro data only, so every frame is exactly 6 bytes
+    if (gyro->fifoRequested) {
+        busWrite(busDev, BMI270_REG_FIFO_DOWNS, BMI270_FIFO_DOWNS_GYR_FILT_DATA);
+        delay(1);
+
+        busWrite(busDev, BMI270_REG_FIFO_CONFIG_0, BMI270_FIFO_CONFIG_0_STREAM);
+        delay(1);
+
+        busWrite(busDev, BMI270_REG_FIFO_CONFIG_1, BMI270_FIFO_CONFIG_1_GYR_EN);
+        delay(1);
+
+        gyro->fifoEnabled = true;
+
+        // Gyro reads no longer fill the scratchpad, accelerometer has to fetch its own data
+        bmi270ContextData_t * ctx = busDeviceGetScratchpadMemory(busDev);
+        ctx->fifoEnabled = true;
+    }
+#endif
+
     // Configure the behavior of the INT1 pin
     busWrite(busDev, BMI270_REG_INT1_IO_CTRL, BMI270_INT1_IO_CTRL_ACTIVE_HIGH | BMI270_INT1_IO_CTRL_OUTPUT_EN);
     delay(1);
@@ -250,6 +286,13 @@ static void bmi270AccAndGyroInit(gyroDev_t *gyro)
     // Enable the gyro and accelerometer
     busWrite(busDev, BMI270_REG_PWR_CTRL, BMI270_PWR_CTRL_GYR_EN | BMI270_PWR_CTRL_ACC_EN);
     delay(1);
+
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (gyro->fifoEnabled) {
+        busWrite(busDev, BMI270_REG_CMD, BMI270_CMD_FIFO_FLUSH);
+        delay(1);
+    }
+#endif
 }
 
 
@@ -269,10 +312,70 @@ static bool bmi270yroReadScratchpad(gyroDev_t *gyro)
     return false;
 }
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+static bool bmi270GyroReadFifo(gyroDev_t *gyro)
+{
+    uint8_t fifoLength[3];
+    // First byte of every SPI read is a dummy byte
+    uint8_t fifoData[1 + GYRO_FIFO_MAX_SAMPLES * BMI270_FIFO_GYRO_FRAME_SIZE];
+
+    gyro->fifoSampleCount = 0;
+
+    if (!busReadBuf(gyro->busDev, BMI270_REG_FIFO_LENGTH_LSB, &fifoLength[0], sizeof(fifoLength))) {
+        return false;
+    }
+
+    const uint16_t pendingBytes = ((fifoLength[2] << 8) | fifoLength[1]) & BMI270_FIFO_LENGTH_MASK;
+    const uint16_t pendingFrames = pendingBytes / BMI270_FIFO_GYRO_FRAME_SIZE;
+    if (pendingFrames == 0) {
+        return false;
+    }
+
+    const uint8_t frameCount = MIN(pendingFrames, GYRO_FIFO_MAX_SAMPLES);
+    if (!busReadBuf(gyro->busDev, BMI270_REG_FIFO_DATA, &fifoData[0], 1 + frameCount * BMI270_FIFO_GYRO_FRAME_SIZE)) {
+        return false;
+    }
+
+    for (int i = 0; i < frameCount; i++) {
+        const uint8_t * frame = &fifoData[1 + i * BMI270_FIFO_GYRO_FRAME_SIZE];
+        gyro->gyroADCRawFifo[i][X] = (int16_t)((frame[1] << 8) | frame[0]);
+        gyro->gyroADCRawFifo[i][Y] = (int16_t)((frame[3] << 8) | frame[2]);
+        gyro->gyroADCRawFifo[i][Z] = (int16_t)((frame[5] << 8) | frame[4]);
+    }
+
+    // More data than we can hold means we fell far behind, drop the backlog instead of adding latency
+    if (pendingFrames > GYRO_FIFO_MAX_SAMPLES) {
+        busWrite(gyro->busDev, BMI270_REG_CMD, BMI270_CMD_FIFO_FLUSH);
+    }
+
+    gyro->fifoSampleCount = frameCount;
+    gyro->gyroADCRaw[X] = gyro->gyroADCRawFifo[frameCount - 1][X];
+    gyro->gyroADCRaw[Y] = gyro->gyroADCRawFifo[frameCount - 1][Y];
+    gyro->gyroADCRaw[Z] = gyro->gyroADCRawFifo[frameCount - 1][Z];
+
+    return true;
+}
+
+static bool bmi270GyroRead(gyroDev_t *gyro)
+{
+    if (gyro->fifoEnabled) {
+        return bmi270GyroReadFifo(gyro);
+    }
+
+    return bmi270yroReadScratchpad(gyro);
+}
+#endif
+
 static bool bmi270AccReadScratchpad(accDev_t *acc)
 {
     bmi270ContextData_t * ctx = busDeviceGetScratchpadMemory(acc->busDev);
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (ctx->fifoEnabled) {
+        ctx->lastReadStatus = busReadBuf(acc->busDev, BMI270_REG_ACC_DATA_X_LSB, &ctx->__padding_dummy, 6 + 1);
+    }
+#endif
+
     if (ctx->lastReadStatus) {
         acc->ADCRaw[X] = (int16_t)((ctx->accRaw[1] << 8) | ctx->accRaw[0]);
         acc->ADCRaw[Y] = (int16_t)((ctx->accRaw[3] << 8) | ctx->accRaw[2]);
@@ -346,7 +449,11 @@ bool bmi270GyroDetect(gyroDev_t *gyro)
     ctx->chipMagicNumber = 0xB270;
 
     gyro->initFn = bmi270GyroInit;
+#ifdef USE_GYRO_FIFO_BURST_READ
+    gyro->readFn = bmi270GyroRead;
+#else
     gyro->readFn = bmi270yroReadScratchpad;
+#endif
     gyro->temperatureFn = bmi270TemperatureRead;
     gyro->intStatusFn = gyroCheckDataReady;
     gyro->scale = 1.0f / 16.4f; // 2000 dps
@@ -62,6 +62,7 @@ static uint8_t bno055FrameLength;
 static uint8_t bno055FrameIndex;
 static timeMs_t bno055FrameStartAtMs = 0;
 static uint8_t bno055DataType = BNO055_DATA_TYPE_NONE;
+static timeUs_t bno055RequestAtUs = 0;
 
 
 static void bno055SerialWriteBuffer(const uint8_t reg, const uint8_t *data, const uint8_t count) {
@@ -128,6 +129,7 @@ void bno055SerialDataReceive(uint16_t c, void *data) {
                 secondaryImuState.eulerAngles.raw[0] = ((int16_t)((receiveBuffer[3] << 8) | receiveBuffer[2])) / 1.6f;
                 secondaryImuState.eulerAngles.raw[1] = ((int16_t)((receiveBuffer[5] << 8) | receiveBuffer[4])) / -1.6f; //Pitch has to be reversed to match INAV notation
                 secondaryImuState.eulerAngles.raw[2] = ((int16_t)((receiveBuffer[1] << 8) | receiveBuffer[0])) / 1.6f;
+                secondaryImuState.sampleTimeUs = bno055RequestAtUs - BNO055_OUTPUT_LATENCY_US;
                 secondaryImuProcess();
             }  else if (bno055DataType == BNO055_DATA_TYPE_CALIBRATION_STATS) {
                 secondaryImuState.calibrationStatus.mag = receiveBuffer[0] & 0b00000011;
@@ -224,6 +226,7 @@ bool bno055SerialInit(bno055CalibrationData_t calibrationData, bool setCalibrati
  */
 void bno055SerialFetchEulerAngles() {
     bno055DataType = BNO055_DATA_TYPE_EULER;
+    bno055RequestAtUs = micros();
     bno055SerialRead(BNO055_ADDR_EUL_YAW_LSB, 6);
 }
 
@@ -26,6 +26,9 @@
 
 #include "common/vector.h"
 
+// Age of the fused euler output when it is requested: half of the 100Hz output period plus the fusion filter delay
+#define BNO055_OUTPUT_LATENCY_US 15000
+
 #define BNO055_ADDR_PWR_MODE 0x3E
 #define BNO055_ADDR_OPR_MODE 0x3D
 #define BNO055_ADDR_CALIB_STAT 0x35
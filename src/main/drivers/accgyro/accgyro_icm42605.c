@@ -84,6 +84,28 @@
 #define ICM42605_UI_DRDY_INT1_EN_DISABLED           (0 << 3)
 #define ICM42605_UI_DRDY_INT1_EN_ENABLED            (1 << 3)
 
+#define ICM42605_RA_FIFO_CONFIG                     0x16
+#define ICM42605_FIFO_MODE_STREAM                   (1 << 6)
+
+#define ICM42605_RA_FIFO_CONFIG1                    0x5F
+#define ICM42605_FIFO_GYRO_EN                       (1 << 1)
+
+#define ICM42605_RA_INTF_CONFIG0                    0x4C
+#define ICM42605_FIFO_COUNT_REC                     (1 << 6)
+#define ICM42605_FIFO_COUNT_ENDIAN_BIG              (1 << 5)
+#define ICM42605_SENSOR_DATA_ENDIAN_BIG             (1 << 4)
+
+#define ICM42605_RA_SIGNAL_PATH_RESET               0x4B
+#define ICM42605_FIFO_FLUSH                         (1 << 1)
+
+#define ICM42605_RA_FIFO_COUNTH                     0x2E
+#define ICM42605_RA_FIFO_DATA                       0x30
+
+// FIFO packet 1: header, gyro X/Y/Z, temperature
+#define ICM42605_FIFO_PACKET_SIZE                   8
+#define ICM42605_FIFO_HEADER_EMPTY                  (1 << 7)
+#define ICM42605_FIFO_HEADER_GYRO                   (1 << 5)
+
 
 static void icm42605AccInit(accDev_t *acc)
 {
@@ -156,6 +178,14 @@ static void icm42605AccAndGyroInit(gyroDev_t *gyro)
                                                                 &icm42605GyroConfigs[0], ARRAYLEN(icm42605GyroConfigs));
     gyro->sampleRateIntervalUs = 1000000 / config->gyroRateHz;
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (gyro->fifoRequested) {
+        // Run at the highest ODR available for this LPF setting and buffer the samples
+        config = chooseGyroConfig(gyro->lpf, icm42605GyroConfigs[0].gyroRateHz, &icm42605GyroConfigs[0], ARRAYLEN(icm42605GyroConfigs));
+        gyro->sampleRateIntervalUs = 1000000 / config->gyroRateHz;
+    }
+#endif
+
     gyroIntExtiInit(gyro);
 
     busSetSpeed(dev, BUS_SPEED_INITIALIZATION);
@@ -195,6 +225,25 @@ static void icm42605AccAndGyroInit(gyroDev_t *gyro)
     delay(15);
 #endif
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (gyro->fifoRequested) {
+        // Count FIFO content in packets, gyro only packets are 8 bytes each
+        busWrite(dev, ICM42605_RA_INTF_CONFIG0, ICM42605_FIFO_COUNT_REC | ICM42605_FIFO_COUNT_ENDIAN_BIG | ICM42605_SENSOR_DATA_ENDIAN_BIG);
+        delay(15);
+
+        busWrite(dev, ICM42605_RA_FIFO_CONFIG1, ICM42605_FIFO_GYRO_EN);
+        delay(15);
+
+        busWrite(dev, ICM42605_RA_FIFO_CONFIG, ICM42605_FIFO_MODE_STREAM);
+        delay(15);
+
+        busWrite(dev, ICM42605_RA_SIGNAL_PATH_RESET, ICM42605_FIFO_FLUSH);
+        delay(1);
+
+        gyro->fifoEnabled = true;
+    }
+#endif
+
     busSetSpeed(dev, BUS_SPEED_FAST);
 }
 
@@ -243,6 +292,69 @@ static bool icm42605GyroRead(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_FIFO_BURST_READ
+static bool icm42605GyroReadFifo(gyroDev_t *gyro)
+{
+    uint8_t fifoCount[2];
+    uint8_t fifoData[GYRO_FIFO_MAX_SAMPLES * ICM42605_FIFO_PACKET_SIZE];
+
+    gyro->fifoSampleCount = 0;
+
+    if (!busReadBuf(gyro->busDev, ICM42605_RA_FIFO_COUNTH, fifoCount, 2)) {
+        return false;
+    }
+
+    const uint16_t pendingPackets = (fifoCount[0] << 8) | fifoCount[1];
+    if (pendingPackets == 0) {
+        return false;
+    }
+
+    const uint8_t packetCount = MIN(pendingPackets, GYRO_FIFO_MAX_SAMPLES);
+    if (!busReadBuf(gyro->busDev, ICM42605_RA_FIFO_DATA, fifoData, packetCount * ICM42605_FIFO_PACKET_SIZE)) {
+        return false;
+    }
+
+    uint8_t sampleCount = 0;
+    for (int i = 0; i < packetCount; i++) {
+        const uint8_t * packet = &fifoData[i * ICM42605_FIFO_PACKET_SIZE];
+
+        if ((packet[0] & ICM42605_FIFO_HEADER_EMPTY) || !(packet[0] & ICM42605_FIFO_HEADER_GYRO)) {
+            continue;
+        }
+
+        gyro->gyroADCRawFifo[sampleCount][X] = (int16_t)((packet[1] << 8) | packet[2]);
+        gyro->gyroADCRawFifo[sampleCount][Y] = (int16_t)((packet[3] << 8) | packet[4]);
+        gyro->gyroADCRawFifo[sampleCount][Z] = (int16_t)((packet[5] << 8) | packet[6]);
+        sampleCount++;
+    }
+
+    // More data than we can hold means we fell far behind, drop the backlog instead of adding latency
+    if (pendingPackets > GYRO_FIFO_MAX_SAMPLES) {
+        busWrite(gyro->busDev, ICM42605_RA_SIGNAL_PATH_RESET, ICM42605_FIFO_FLUSH);
+    }
+
+    if (sampleCount == 0) {
+        return false;
+    }
+
+    gyro->fifoSampleCount = sampleCount;
+    gyro->gyroADCRaw[X] = gyro->gyroADCRawFifo[sampleCount - 1][X];
+    gyro->gyroADCRaw[Y] = gyro->gyroADCRawFifo[sampleCount - 1][Y];
+    gyro->gyroADCRaw[Z] = gyro->gyroADCRawFifo[sampleCount - 1][Z];
+
+    return true;
+}
+
+static bool icm42605GyroReadAuto(gyroDev_t *gyro)
+{
+    if (gyro->fifoEnabled) {
+        return icm42605GyroReadFifo(gyro);
+    }
+
+    return icm42605GyroRead(gyro);
+}
+#endif
+
 bool icm42605GyroDetect(gyroDev_t *gyro)
 {
     gyro->busDev = busDeviceInit(BUSTYPE_ANY, DEVHW_ICM42605, gyro->imuSensorToUse, OWNER_MPU);
@@ -260,7 +372,11 @@ bool icm42605GyroDetect(gyroDev_t *gyro)
     ctx->chipMagicNumber = 0x4265;
 
     gyro->initFn = icm42605AccAndGyroInit;
+#ifdef USE_GYRO_FIFO_BURST_READ
+    gyro->readFn = icm42605GyroReadAuto;
+#else
     gyro->readFn = icm42605GyroRead;
+#endif
     gyro->intStatusFn = gyroCheckDataReady;
     gyro->temperatureFn = NULL;
     gyro->scale = 1.0f / 16.4f;     // 16.4 dps/lsb scalefactor
@@ -23,11 +23,12 @@
 #include "build/build_config.h"
 #include "build/debug.h"
 #include "drivers/time.h"
+#include "drivers/adc.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #ifdef USE_ADC
 #include "drivers/io.h"
-#include "drivers/adc.h"
 #include "drivers/adc_impl.h"
 
 #ifndef ADC_INSTANCE
@@ -53,7 +54,15 @@
 static uint8_t activeChannelCount[ADCDEV_COUNT] = {0};
 #endif
 
+typedef struct adcAccumulator_s {
+    uint32_t sum;
+    uint16_t peak;
+    uint16_t samples;
+} adcAccumulator_t;
+
 static int adcFunctionMap[ADC_FUNCTION_COUNT];
+static adcAccumulator_t adcAccumulator[ADC_FUNCTION_COUNT];
+static timeUs_t adcAccumulatorLastUpdateUs;
 adc_config_t adcConfig[ADC_CHN_COUNT];  // index 0 is dummy for ADC_CHN_NONE
 volatile ADC_VALUES_ALIGNMENT(uint16_t adcValues[ADCDEV_COUNT][ADC_CHN_COUNT * ADC_AVERAGE_N_SAMPLES]);
 
@@ -84,6 +93,8 @@ uint16_t adcGetChannel(uint8_t function)
         return 0;
 
     if (adcConfig[channel].adcDevice != ADCINVALID && adcConfig[channel].enabled) {
+        // Circular DMA rewrites the samples behind the cache's back
+        dmaCacheInvalidateForCpu(adcValues[adcConfig[channel].adcDevice], sizeof(adcValues[0]));
 #if !defined(USE_ADC_AVERAGING)
         return adcValues[adcConfig[channel].adcDevice][adcConfig[channel].dmaIndex];
 #else
@@ -98,6 +109,54 @@ uint16_t adcGetChannel(uint8_t function)
     }
 }
 
+void adcAccumulatorUpdate(timeUs_t currentTimeUs)
+{
+    // DMA keeps the sample buffer fresh at the conversion rate, the accumulator
+    // decimates it so consumers running at a few tens of Hz see the whole interval
+    if (cmpTimeUs(currentTimeUs, adcAccumulatorLastUpdateUs) < ADC_ACCUMULATOR_INTERVAL_US) {
+        return;
+    }
+    adcAccumulatorLastUpdateUs = currentTimeUs;
+
+    for (int function = 0; function < ADC_FUNCTION_COUNT; function++) {
+        if (adcFunctionMap[function] == ADC_CHN_NONE) {
+            continue;
+        }
+
+        adcAccumulator_t * acc = &adcAccumulator[function];
+        if (acc->samples == UINT16_MAX) {
+            continue;
+        }
+
+        const uint16_t value = adcGetChannel(function);
+        acc->sum += value;
+        acc->peak = MAX(acc->peak, value);
+        acc->samples++;
+    }
+}
+
+void adcGetChannelWindow(uint8_t function, adcWindow_t *window)
+{
+    adcAccumulator_t * acc = &adcAccumulator[function];
+
+    if (acc->samples == 0) {
+        // Nothing accumulated yet, fall back to the latest DMA average
+        const uint16_t value = adcGetChannel(function);
+        window->average = value;
+        window->peak = value;
+        window->samples = 0;
+        return;
+    }
+
+    window->average = acc->sum / acc->samples;
+    window->peak = acc->peak;
+    window->samples = acc->samples;
+
+    acc->sum = 0;
+    acc->peak = 0;
+    acc->samples = 0;
+}
+
 #if defined(ADC_CHANNEL_1_PIN) || defined(ADC_CHANNEL_2_PIN) || defined(ADC_CHANNEL_3_PIN) || defined(ADC_CHANNEL_4_PIN)
 static bool isChannelInUse(int channel)
 {
@@ -124,6 +183,7 @@ static void disableChannelMapping(int channel)
 void adcInit(drv_adc_config_t *init)
 {
     memset(&adcConfig, 0, sizeof(adcConfig));
+    memset(&adcAccumulator, 0, sizeof(adcAccumulator));
 
     // Remember ADC function to ADC channel mapping
     for (int i = 0; i < ADC_FUNCTION_COUNT; i++) {
@@ -203,6 +263,19 @@ uint16_t adcGetChannel(uint8_t channel)
     return 0;
 }
 
+void adcAccumulatorUpdate(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+}
+
+void adcGetChannelWindow(uint8_t function, adcWindow_t *window)
+{
+    UNUSED(function);
+    window->average = 0;
+    window->peak = 0;
+    window->samples = 0;
+}
+
 #endif
 
 #else // USE_ADC
@@ -211,4 +284,17 @@ uint16_t adcGetChannel(uint8_t channel)
     UNUSED(channel);
     return 0;
 }
+
+void adcAccumulatorUpdate(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+}
+
+void adcGetChannelWindow(uint8_t function, adcWindow_t *window)
+{
+    UNUSED(function);
+    window->average = 0;
+    window->peak = 0;
+    window->samples = 0;
+}
 #endif
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "common/time.h"
 #include "drivers/io_types.h"
 
 typedef enum {
@@ -41,8 +42,19 @@ typedef struct drv_adc_config_s {
     uint8_t adcFunctionChannel[ADC_FUNCTION_COUNT];
 } drv_adc_config_t;
 
+// Decimated view of an ADC function since the previous adcGetChannelWindow() call
+typedef struct adcWindow_s {
+    uint16_t average;
+    uint16_t peak;
+    uint16_t samples;
+} adcWindow_t;
+
+#define ADC_ACCUMULATOR_INTERVAL_US     1000    // 1kHz decimation into the window accumulators
+
 void adcInit(drv_adc_config_t *init);
 uint16_t adcGetChannel(uint8_t channel);
+void adcAccumulatorUpdate(timeUs_t currentTimeUs);
+void adcGetChannelWindow(uint8_t function, adcWindow_t *window);
 bool adcIsFunctionAssigned(uint8_t function);
 int adcGetFunctionChannelAllocation(uint8_t function);
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "drivers/dma_cache.h"
 #include "drivers/io_types.h"
 #include "rcc_types.h"
 
@@ -29,7 +30,7 @@
 #endif
 
 #if defined(STM32H7)
-#define ADC_VALUES_ALIGNMENT(def) DMA_RAM def __attribute__ ((aligned (32)))
+#define ADC_VALUES_ALIGNMENT(def) DMA_RAM def DMA_CACHE_ALIGNED
 #else
 #define ADC_VALUES_ALIGNMENT(def) def 
 #endif
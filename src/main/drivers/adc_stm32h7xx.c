@@ -154,7 +154,14 @@ static void adcInstanceInit(ADCDevice adcDevice)
     adc->ADCHandle.Init.ConversionDataManagement = ADC_CONVERSIONDATA_DMA_CIRCULAR;
 
     adc->ADCHandle.Init.Overrun                  = ADC_OVR_DATA_OVERWRITTEN;
-    adc->ADCHandle.Init.OversamplingMode         = DISABLE;
+
+    // Hardware oversampling: 16 conversions summed and shifted back to 12 bits
+    // for every result the DMA writes, averaging out switching noise for free
+    adc->ADCHandle.Init.OversamplingMode                   = ENABLE;
+    adc->ADCHandle.Init.Oversampling.Ratio                 = 16;
+    adc->ADCHandle.Init.Oversampling.RightBitShift         = ADC_RIGHTBITSHIFT_4;
+    adc->ADCHandle.Init.Oversampling.TriggeredMode         = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+    adc->ADCHandle.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
 
     if (HAL_ADC_Init(&adc->ADCHandle) != HAL_OK) {
         return;
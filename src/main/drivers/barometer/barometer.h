@@ -19,9 +19,15 @@
 
 #include "drivers/bus.h"
 
+typedef enum {
+    BARO_OVERSAMPLING_LOW_NOISE = 0,    // Driver default, highest OSR the driver uses
+    BARO_OVERSAMPLING_LOW_LATENCY,      // Shorter conversions for a faster update rate
+} baroOversampling_e;
+
 struct baroDev_s;
 typedef bool (*baroOpFuncPtr)(struct baroDev_s * baro);
 typedef bool (*baroCalculateFuncPtr)(struct baroDev_s * baro, int32_t *pressure, int32_t *temperature);
+typedef void (*baroOversamplingFuncPtr)(struct baroDev_s * baro, baroOversampling_e oversampling);
 
 typedef struct baroDev_s {
     busDevice_t * busDev;
@@ -32,4 +38,5 @@ typedef struct baroDev_s {
     baroOpFuncPtr start_up;
     baroOpFuncPtr get_up;
     baroCalculateFuncPtr calculate;
+    baroOversamplingFuncPtr set_oversampling;   // Optional, must update ut_delay/up_delay to match
 } baroDev_t;
@@ -236,12 +236,12 @@ static bool deviceDetect(busDevice_t * busDev)
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
         uint8_t chipId = 0;
 
-        delay(10);
-
         bool ack = busRead(busDev, BMP085_CHIP_ID__REG, &chipId);
         if (ack && BMP085_GET_BITSLICE(chipId, BMP085_CHIP_ID) == BMP085_CHIP_ID) {
             return true;
         }
+
+        delay(10);
     };
 
     return false;
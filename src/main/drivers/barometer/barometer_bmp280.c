@@ -162,13 +162,13 @@ static bool deviceDetect(busDevice_t * busDev)
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
         uint8_t chipId = 0;
 
-        delay(100);
-
         bool ack = busRead(busDev, BMP280_CHIP_ID_REG, &chipId);
 
         if ((ack && chipId == BMP280_DEFAULT_CHIP_ID)  || (ack && chipId == BME280_DEFAULT_CHIP_ID)){
             return true;
         }
+
+        delay(100);
     };
 
     return false;
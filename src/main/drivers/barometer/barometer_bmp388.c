@@ -131,8 +131,12 @@
 
 // configure pressure and temperature oversampling, forced sampling mode
 #define BMP388_PRESSURE_OSR              (BMP388_OVERSAMP_8X)
+#define BMP388_PRESSURE_OSR_LOW_LATENCY  (BMP388_OVERSAMP_2X)
 #define BMP388_TEMPERATURE_OSR           (BMP388_OVERSAMP_1X)
 
+#define BMP388_MEASUREMENT_TIME_US(pressureOsr, temperatureOsr) \
+    (234 + (392 + ((1 << ((pressureOsr) + 1)) * 2000)) + (313 + ((1 << ((temperatureOsr) + 1)) * 2000)))
+
 // see Datasheet 3.11.1 Memory Map Trimming Coefficients
 typedef struct bmp388_calib_param_s {
     uint16_t T1;
@@ -168,6 +172,19 @@ static bool bmp388GetUP(baroDev_t *baro);
 
 static bool bmp388Calculate(baroDev_t *baro, int32_t *pressure, int32_t *temperature);
 
+static void bmp388SetOversampling(baroDev_t *baro, baroOversampling_e oversampling)
+{
+    const uint8_t pressureOsr = (oversampling == BARO_OVERSAMPLING_LOW_LATENCY) ? BMP388_PRESSURE_OSR_LOW_LATENCY : BMP388_PRESSURE_OSR;
+
+    // Takes effect with the next forced measurement
+    busWrite(baro->busDev, BMP388_OSR_REG,
+        ((pressureOsr << BMP388_OSR_P_BIT) & BMP388_OSR_P_MASK) |
+        ((BMP388_TEMPERATURE_OSR << BMP388_OSR4_T_BIT) & BMP388_OSR4_T_MASK)
+    );
+
+    baro->up_delay = BMP388_MEASUREMENT_TIME_US(pressureOsr, BMP388_TEMPERATURE_OSR);
+}
+
 static bool bmp388BeginForcedMeasurement(busDevice_t *busdev)
 {
     // enable pressure measurement, temperature measurement, set power mode and start sampling
@@ -310,13 +327,13 @@ static bool deviceDetect(busDevice_t * busDev)
     }
 
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
-        delay(100);
-
         bool ack = busReadBuf(busDev, BMP388_CHIP_ID_REG, chipId, nRead);
 
         if (ack && *pId == BMP388_DEFAULT_CHIP_ID) {
             return true;
         }
+
+        delay(100);
     };
 
     return false;
@@ -348,10 +365,8 @@ bool bmp388Detect(baroDev_t *baro)
     }
 
     // set oversampling + power mode (forced), and start sampling
-    busWrite(baro->busDev, BMP388_OSR_REG,
-        ((BMP388_PRESSURE_OSR << BMP388_OSR_P_BIT) & BMP388_OSR_P_MASK) |
-        ((BMP388_TEMPERATURE_OSR << BMP388_OSR4_T_BIT) & BMP388_OSR4_T_MASK)
-    );
+    bmp388SetOversampling(baro, BARO_OVERSAMPLING_LOW_NOISE);
+    baro->set_oversampling = bmp388SetOversampling;
 
     bmp388BeginForcedMeasurement(baro->busDev);
 
@@ -359,7 +374,6 @@ bool bmp388Detect(baroDev_t *baro)
     baro->get_ut = bmp388GetUT;
     baro->start_ut = bmp388StartUT;
 
-    baro->up_delay = 234 + (392 + ((1 << (BMP388_PRESSURE_OSR + 1)) * 2000)) + (313 + ((1 << (BMP388_TEMPERATURE_OSR + 1)) * 2000));
     baro->start_up = bmp388StartUP;
     baro->get_up = bmp388GetUP;
 
@@ -298,13 +298,13 @@ static bool deviceDetect(busDevice_t * busDev)
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
         uint8_t chipId[1];
 
-        delay(100);
-
         bool ack = busReadBuf(busDev, DPS310_REG_ID, chipId, 1);
 
         if (ack && chipId[0] == DPS310_ID_REV_AND_PROD_ID) {
             return true;
         }
+
+        delay(100);
     };
 
     return false;
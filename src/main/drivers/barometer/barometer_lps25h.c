@@ -279,14 +279,14 @@ static bool deviceDetect(busDevice_t * busDev)
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
         uint8_t chipId = 0;
 
-        delay(100);
-
         bool ack = busRead(busDev, LPS25HB_WHO_AM_I_ADDR, &chipId);
         // verified: id is 189 (0xBD)
 
         if (ack && chipId == LPS25H_CHIP_ID) {
             return true;
         }
+
+        delay(100);
     };
 
     return false;
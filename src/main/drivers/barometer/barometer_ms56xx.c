@@ -111,6 +111,20 @@ static bool ms56xx_get_up(baroDev_t *baro)
     return true;
 }
 
+static void ms56xx_set_oversampling(baroDev_t *baro, baroOversampling_e oversampling)
+{
+    // Delays follow the datasheet maximum conversion times (9.04ms / 2.28ms)
+    if (oversampling == BARO_OVERSAMPLING_LOW_LATENCY) {
+        ms56xx_osr = CMD_ADC_1024;
+        baro->ut_delay = 2500;
+        baro->up_delay = 2500;
+    } else {
+        ms56xx_osr = CMD_ADC_4096;
+        baro->ut_delay = 10000;
+        baro->up_delay = 10000;
+    }
+}
+
 #ifdef USE_BARO_MS5611
 STATIC_UNIT_TESTED bool ms5611_calculate(baroDev_t *baro, int32_t *pressure, int32_t *temperature)
 {
@@ -189,12 +203,12 @@ static bool deviceDetect(busDevice_t * dev)
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
         uint8_t sig = 0;
 
-        delay(10);
-
         bool ack = busRead(dev, CMD_PROM_RD, &sig);
         if (ack && sig != 0xFF) {
             return true;
         }
+
+        delay(10);
     };
 
     return false;
@@ -219,8 +233,8 @@ static bool deviceInit(baroDev_t *baro)
         return false;
     }
 
-    baro->ut_delay = 10000;
-    baro->up_delay = 10000;
+    ms56xx_set_oversampling(baro, BARO_OVERSAMPLING_LOW_NOISE);
+    baro->set_oversampling = ms56xx_set_oversampling;
     baro->start_ut = ms56xx_start_ut;
     baro->get_ut = ms56xx_get_ut;
     baro->start_up = ms56xx_start_up;
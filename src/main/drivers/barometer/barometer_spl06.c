@@ -163,19 +163,29 @@ static bool deviceDetect(busDevice_t * busDev)
 {
     uint8_t chipId;
     for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT; retry++) {
-        delay(100);
         bool ack = busRead(busDev, SPL06_CHIP_ID_REG, &chipId);
         if (ack && chipId == SPL06_DEFAULT_CHIP_ID) {
             return true;
         }
+
+        delay(100);
     };
 
     return false;
 }
 
 static bool read_calibration_coefficients(baroDev_t *baro) {
-    uint8_t sstatus;
-    if (!(busRead(baro->busDev, SPL06_MODE_AND_STATUS_REG, &sstatus) && (sstatus & SPL06_MEAS_CFG_COEFFS_RDY)))
+    // Detection no longer waits up-front, coefficients may need up to ~40ms after power-on
+    bool coeffsReady = false;
+    for (int retry = 0; retry < DETECTION_MAX_RETRY_COUNT && !coeffsReady; retry++) {
+        uint8_t sstatus;
+        coeffsReady = busRead(baro->busDev, SPL06_MODE_AND_STATUS_REG, &sstatus) && (sstatus & SPL06_MEAS_CFG_COEFFS_RDY);
+        if (!coeffsReady) {
+            delay(20);
+        }
+    }
+
+    if (!coeffsReady)
         return false;   // error reading status or coefficients not ready
 
     uint8_t caldata[SPL06_CALIB_COEFFS_LEN];
@@ -403,3 +403,78 @@ bool busIsBusy(const busDevice_t * dev)
             return false;
     }
 }
+
+bool busWriteBufAsync(const busDevice_t * dev, uint8_t reg, const uint8_t * data, uint8_t length)
+{
+    switch (dev->busType) {
+        case BUSTYPE_I2C:
+#ifdef USE_I2C
+            return i2cBusWriteBufferAsync(dev, reg, data, length);
+#else
+            return false;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+bool busReadBufAsync(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint8_t length)
+{
+    switch (dev->busType) {
+        case BUSTYPE_I2C:
+#ifdef USE_I2C
+            return i2cBusReadBufferAsync(dev, reg, data, length);
+#else
+            return false;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+busAsyncState_e busAsyncPoll(const busDevice_t * dev)
+{
+    switch (dev->busType) {
+        case BUSTYPE_I2C:
+#ifdef USE_I2C
+            return i2cBusAsyncPoll(dev);
+#else
+            return BUS_ASYNC_IDLE;
+#endif
+
+        default:
+            return BUS_ASYNC_IDLE;
+    }
+}
+
+void busAsyncProcess(void)
+{
+#ifdef USE_I2C
+    i2cAsyncProcess();
+#endif
+}
+
+#ifdef USE_SPI_DMA
+bool busTransferAsync(busAsyncTransfer_t * transfer)
+{
+    switch (transfer->dev->busType) {
+        case BUSTYPE_SPI:
+#ifdef USE_SPI
+            return spiBusTransferAsync(transfer);
+#else
+            return false;
+#endif
+
+        default:
+            // Async transfers are only supported on SPI bus
+            return false;
+    }
+}
+
+bool busTransferAsyncIsComplete(const busAsyncTransfer_t * transfer)
+{
+    return transfer->state == BUS_ASYNC_DONE || transfer->state == BUS_ASYNC_FAILED;
+}
+#endif
@@ -138,6 +138,7 @@ typedef enum {
 
     /* Other hardware */
     DEVHW_MS4525,       // Pitot meter
+    DEVHW_DLVR,         // Pitot meter
     DEVHW_M25P16,       // SPI NOR flash
     DEVHW_W25N01G,      // SPI 128MB flash
     DEVHW_UG2864,       // I2C OLED display
@@ -281,11 +282,50 @@ typedef struct busTransferDescriptor_s {
     uint32_t        length;
 } busTransferDescriptor_t;
 
+typedef enum {
+    BUS_ASYNC_IDLE      = 0,
+    BUS_ASYNC_QUEUED,
+    BUS_ASYNC_ACTIVE,
+    BUS_ASYNC_DONE,
+    BUS_ASYNC_FAILED,
+} busAsyncState_e;
+
+#ifdef USE_SPI_DMA
+typedef enum {
+    BUS_PRIORITY_LOW    = 0,        // Bulk transfers: OSD, flash
+    BUS_PRIORITY_NORMAL = 1,        // Periodic sensors: baro, compass
+    BUS_PRIORITY_HIGH   = 2,        // Gyro - jumps ahead of everything queued on the bus
+} busTransferPriority_e;
+
+struct busAsyncTransfer_s;
+typedef void (*busAsyncCallbackPtr)(struct busAsyncTransfer_s * transfer, bool success);
+
+/* Asynchronous transfer request. Memory is owned by the caller and must stay valid (together with
+ * the segments and their buffers) until the transfer reaches BUS_ASYNC_DONE or BUS_ASYNC_FAILED */
+typedef struct busAsyncTransfer_s {
+    const busDevice_t *         dev;
+    busTransferDescriptor_t *   segments;       // Clocked out back to back with device selected
+    uint8_t                     segmentCount;
+    busTransferPriority_e       priority;
+    busAsyncCallbackPtr         callback;       // Called from interrupt context, may be NULL. Must not issue blocking bus calls
+    void *                      userParam;
+    volatile busAsyncState_e    state;
+
+    /* Bus-layer private state */
+    struct busAsyncTransfer_s * next;
+    uint8_t                     segmentIndex;
+    uint16_t                    segmentOffset;
+} busAsyncTransfer_t;
+#endif
+
 /* Internal abstraction function */
 bool i2cBusWriteBuffer(const busDevice_t * dev, uint8_t reg, const uint8_t * data, uint8_t length);
 bool i2cBusWriteRegister(const busDevice_t * dev, uint8_t reg, uint8_t data);
 bool i2cBusReadBuffer(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint8_t length);
 bool i2cBusReadRegister(const busDevice_t * dev, uint8_t reg, uint8_t * data);
+bool i2cBusWriteBufferAsync(const busDevice_t * dev, uint8_t reg, const uint8_t * data, uint8_t length);
+bool i2cBusReadBufferAsync(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint8_t length);
+busAsyncState_e i2cBusAsyncPoll(const busDevice_t * dev);
 
 bool spiBusInitHost(const busDevice_t * dev);
 bool spiBusIsBusy(const busDevice_t * dev);
@@ -298,6 +338,9 @@ bool spiBusReadBuffer(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint
 bool spiBusReadRegister(const busDevice_t * dev, uint8_t reg, uint8_t * data);
 void spiBusSelectDevice(const busDevice_t * dev);
 void spiBusDeselectDevice(const busDevice_t * dev);
+#ifdef USE_SPI_DMA
+bool spiBusTransferAsync(busAsyncTransfer_t * transfer);
+#endif
 
 /* Pre-initialize all known device descriptors to make sure hardware state is consistent and known
  * Initialize bus hardware */
@@ -327,3 +370,21 @@ bool busTransfer(const busDevice_t * dev, uint8_t * rxBuf, const uint8_t * txBuf
 bool busTransferMultiple(const busDevice_t * dev, busTransferDescriptor_t * buffers, int count);
 
 bool busIsBusy(const busDevice_t * dev);
+
+/* Non-blocking register access, I2C only. Returns false if the bus is busy with another background
+ * transfer or can't run one, callers can then retry later or use the blocking calls.
+ * Poll with busAsyncPoll() until the state is no longer BUS_ASYNC_ACTIVE, the buffer must stay valid
+ * until then. Background transfers are advanced from the main loop by busAsyncProcess() */
+bool busWriteBufAsync(const busDevice_t * busdev, uint8_t reg, const uint8_t * data, uint8_t length);
+bool busReadBufAsync(const busDevice_t * busdev, uint8_t reg, uint8_t * data, uint8_t length);
+busAsyncState_e busAsyncPoll(const busDevice_t * busdev);
+void busAsyncProcess(void);
+
+#ifdef USE_SPI_DMA
+/* Queue a transfer on the device's bus and return immediately. Transfers are arbitrated per bus by
+ * priority, FIFO within the same priority. Segments are sent over DMA if the bus has DMA streams
+ * assigned, otherwise the transfer is executed synchronously before this returns.
+ * Blocking bus calls wait for the queue of their bus to drain. */
+bool busTransferAsync(busAsyncTransfer_t * transfer);
+bool busTransferAsyncIsComplete(const busAsyncTransfer_t * transfer);
+#endif
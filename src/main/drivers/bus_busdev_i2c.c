@@ -49,4 +49,31 @@ bool i2cBusReadRegister(const busDevice_t * dev, uint8_t reg, uint8_t * data)
     const bool allowRawAccess = (dev->flags & DEVFLAGS_USE_RAW_REGISTERS);
     return i2cRead(dev->busdev.i2c.i2cBus, dev->busdev.i2c.address, reg, 1, data, allowRawAccess);
 }
+
+bool i2cBusWriteBufferAsync(const busDevice_t * dev, uint8_t reg, const uint8_t * data, uint8_t length)
+{
+    const bool allowRawAccess = (dev->flags & DEVFLAGS_USE_RAW_REGISTERS);
+    return i2cWriteBufferAsync(dev->busdev.i2c.i2cBus, dev->busdev.i2c.address, reg, length, data, allowRawAccess);
+}
+
+bool i2cBusReadBufferAsync(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint8_t length)
+{
+    const bool allowRawAccess = (dev->flags & DEVFLAGS_USE_RAW_REGISTERS);
+    return i2cReadAsync(dev->busdev.i2c.i2cBus, dev->busdev.i2c.address, reg, length, data, allowRawAccess);
+}
+
+busAsyncState_e i2cBusAsyncPoll(const busDevice_t * dev)
+{
+    switch (i2cAsyncPoll(dev->busdev.i2c.i2cBus, dev->busdev.i2c.address)) {
+        case I2C_ASYNC_BUSY:
+            return BUS_ASYNC_ACTIVE;
+        case I2C_ASYNC_DONE:
+            return BUS_ASYNC_DONE;
+        case I2C_ASYNC_FAILED:
+            return BUS_ASYNC_FAILED;
+        case I2C_ASYNC_IDLE:
+        default:
+            return BUS_ASYNC_IDLE;
+    }
+}
 #endif
@@ -24,11 +24,34 @@
 
 #if defined(USE_SPI)
 
+#include "build/atomic.h"
+
+#include "common/utils.h"
+
 #include "drivers/io.h"
 #include "drivers/bus.h"
 #include "drivers/bus_spi.h"
+#include "drivers/nvic.h"
 #include "drivers/time.h"
 
+#ifdef USE_SPI_DMA
+typedef struct spiAsyncQueue_s {
+    busAsyncTransfer_t * volatile active;
+    busAsyncTransfer_t * pending;           // Sorted by priority, FIFO within the same priority
+} spiAsyncQueue_t;
+
+static spiAsyncQueue_t spiAsyncQueue[SPIDEV_COUNT];
+
+static void spiAsyncWaitIdle(const busDevice_t * dev)
+{
+    // Blocking access must not interleave with a DMA transaction on the same bus
+    while (spiAsyncQueue[dev->busdev.spi.spiBus].active) {
+    }
+}
+#else
+#define spiAsyncWaitIdle(dev)
+#endif
+
 void spiChipSelectSetupDelay(void)
 {
     // CS->CLK delay, MPU6000 - 8ns
@@ -61,6 +84,8 @@ void spiBusDeselectDevice(const busDevice_t * dev)
 
 void spiBusSetSpeed(const busDevice_t * dev, busSpeed_e speed)
 {
+    spiAsyncWaitIdle(dev);
+
     const SPIClockSpeed_e spiClock[] = { SPI_CLOCK_INITIALIZATON, SPI_CLOCK_SLOW, SPI_CLOCK_STANDARD, SPI_CLOCK_FAST, SPI_CLOCK_ULTRAFAST };
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
@@ -77,6 +102,8 @@ bool spiBusTransfer(const busDevice_t * dev, uint8_t * rxBuf, const uint8_t * tx
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -94,6 +121,8 @@ bool spiBusTransferMultiple(const busDevice_t * dev, busTransferDescriptor_t * d
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -113,6 +142,8 @@ bool spiBusWriteRegister(const busDevice_t * dev, uint8_t reg, uint8_t data)
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -131,6 +162,8 @@ bool spiBusWriteBuffer(const busDevice_t * dev, uint8_t reg, const uint8_t * dat
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -149,6 +182,8 @@ bool spiBusReadBuffer(const busDevice_t * dev, uint8_t reg, uint8_t * data, uint
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -167,6 +202,8 @@ bool spiBusReadRegister(const busDevice_t * dev, uint8_t reg, uint8_t * data)
 {
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
 
+    spiAsyncWaitIdle(dev);
+
     if (!(dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT)) {
         spiBusSelectDevice(dev);
     }
@@ -183,7 +220,161 @@ bool spiBusReadRegister(const busDevice_t * dev, uint8_t reg, uint8_t * data)
 
 bool spiBusIsBusy(const busDevice_t * dev)
 {
+#ifdef USE_SPI_DMA
+    if (spiAsyncQueue[dev->busdev.spi.spiBus].active) {
+        return true;
+    }
+#endif
+
     SPI_TypeDef * instance = spiInstanceByDevice(dev->busdev.spi.spiBus);
     return spiIsBusBusy(instance);
 }
+
+#ifdef USE_SPI_DMA
+static void spiAsyncStartNext(SPIDevice bus);
+static void spiAsyncDmaComplete(SPIDevice bus, bool success);
+
+static bool spiAsyncSkipEmptySegments(busAsyncTransfer_t * transfer)
+{
+    while (transfer->segmentIndex < transfer->segmentCount && transfer->segments[transfer->segmentIndex].length == 0) {
+        transfer->segmentIndex++;
+    }
+
+    return transfer->segmentIndex < transfer->segmentCount;
+}
+
+static void spiAsyncFinish(SPIDevice bus, busAsyncTransfer_t * transfer, bool success)
+{
+    spiBusDeselectDevice(transfer->dev);
+
+    spiAsyncQueue[bus].active = NULL;
+    transfer->state = success ? BUS_ASYNC_DONE : BUS_ASYNC_FAILED;
+
+    if (transfer->callback) {
+        transfer->callback(transfer, success);
+    }
+
+    spiAsyncStartNext(bus);
+}
+
+static void spiAsyncRunChunk(SPIDevice bus, busAsyncTransfer_t * transfer)
+{
+    const busTransferDescriptor_t * segment = &transfer->segments[transfer->segmentIndex];
+    const uint32_t chunkLength = MIN(segment->length - transfer->segmentOffset, (uint32_t)SPI_DMA_BUFFER_SIZE);
+
+    uint8_t * rxBuf = segment->rxBuf ? segment->rxBuf + transfer->segmentOffset : NULL;
+    const uint8_t * txBuf = segment->txBuf ? segment->txBuf + transfer->segmentOffset : NULL;
+
+    if (!spiDmaTransfer(bus, rxBuf, txBuf, chunkLength, spiAsyncDmaComplete)) {
+        spiAsyncFinish(bus, transfer, false);
+    }
+}
+
+// Called from DMA interrupt (or with the queue locked) to advance the active transfer
+static void spiAsyncDmaComplete(SPIDevice bus, bool success)
+{
+    busAsyncTransfer_t * transfer = spiAsyncQueue[bus].active;
+
+    if (!transfer) {
+        return;
+    }
+
+    if (!success) {
+        spiAsyncFinish(bus, transfer, false);
+        return;
+    }
+
+    const busTransferDescriptor_t * segment = &transfer->segments[transfer->segmentIndex];
+    transfer->segmentOffset += MIN(segment->length - transfer->segmentOffset, (uint32_t)SPI_DMA_BUFFER_SIZE);
+
+    if (transfer->segmentOffset >= segment->length) {
+        transfer->segmentIndex++;
+        transfer->segmentOffset = 0;
+
+        if (!spiAsyncSkipEmptySegments(transfer)) {
+            spiAsyncFinish(bus, transfer, true);
+            return;
+        }
+    }
+
+    spiAsyncRunChunk(bus, transfer);
+}
+
+// Must be called with the queue locked or from the DMA interrupt
+static void spiAsyncStartNext(SPIDevice bus)
+{
+    spiAsyncQueue_t * queue = &spiAsyncQueue[bus];
+
+    while (!queue->active && queue->pending) {
+        busAsyncTransfer_t * transfer = queue->pending;
+        queue->pending = transfer->next;
+        transfer->next = NULL;
+
+        transfer->segmentIndex = 0;
+        transfer->segmentOffset = 0;
+
+        if (!spiAsyncSkipEmptySegments(transfer)) {
+            // Nothing to clock out
+            transfer->state = BUS_ASYNC_DONE;
+            if (transfer->callback) {
+                transfer->callback(transfer, true);
+            }
+            continue;
+        }
+
+        queue->active = transfer;
+        transfer->state = BUS_ASYNC_ACTIVE;
+
+        spiBusSelectDevice(transfer->dev);
+        spiAsyncRunChunk(bus, transfer);
+    }
+}
+
+bool spiBusTransferAsync(busAsyncTransfer_t * transfer)
+{
+    const busDevice_t * dev = transfer->dev;
+    const SPIDevice bus = dev->busdev.spi.spiBus;
+
+    // Queue arbitration can't guarantee exclusive bus access to devices selected by the driver itself
+    if (dev->flags & DEVFLAGS_USE_MANUAL_DEVICE_SELECT) {
+        return false;
+    }
+
+    if (transfer->state == BUS_ASYNC_QUEUED || transfer->state == BUS_ASYNC_ACTIVE) {
+        return false;
+    }
+
+    if (!spiDmaIsAvailable(bus)) {
+        // No DMA on this bus, complete the transfer right away
+        transfer->state = BUS_ASYNC_ACTIVE;
+        const bool success = spiBusTransferMultiple(dev, transfer->segments, transfer->segmentCount);
+        transfer->state = success ? BUS_ASYNC_DONE : BUS_ASYNC_FAILED;
+
+        if (transfer->callback) {
+            transfer->callback(transfer, success);
+        }
+
+        return true;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA) {
+        spiAsyncQueue_t * queue = &spiAsyncQueue[bus];
+
+        transfer->state = BUS_ASYNC_QUEUED;
+        transfer->next = NULL;
+
+        // Insert behind all transfers of the same or higher priority
+        busAsyncTransfer_t ** link = &queue->pending;
+        while (*link && (*link)->priority >= transfer->priority) {
+            link = &(*link)->next;
+        }
+        transfer->next = *link;
+        *link = transfer;
+
+        spiAsyncStartNext(bus);
+    }
+
+    return true;
+}
+#endif
 #endif
@@ -46,6 +46,13 @@ typedef enum I2CDevice {
     I2CDEV_COUNT
 } I2CDevice;
 
+typedef enum {
+    I2C_ASYNC_IDLE = 0,
+    I2C_ASYNC_BUSY,
+    I2C_ASYNC_DONE,
+    I2C_ASYNC_FAILED,
+} i2cAsyncState_e;
+
 typedef struct i2cDevice_s {
     I2C_TypeDef *dev;
     ioTag_t scl;
@@ -65,4 +72,13 @@ bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_,
 bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data, bool allowRawAccess);
 bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf, bool allowRawAccess);
 
+/* Background transfers, one per bus. Start returns false if the bus already runs one or the driver
+ * can't run transfers in background. Blocking calls on the same bus wait for it to finish first.
+ * i2cAsyncPoll() reports the state of the transfer started for addr_, a DONE/FAILED result is
+ * reported once. Buffers must stay valid until the transfer is no longer busy */
+bool i2cReadAsync(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf, bool allowRawAccess);
+bool i2cWriteBufferAsync(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, const uint8_t *data, bool allowRawAccess);
+i2cAsyncState_e i2cAsyncPoll(I2CDevice device, uint8_t addr_);
+void i2cAsyncProcess(void);
+
 uint16_t i2cGetErrorCounter(void);
@@ -20,6 +20,8 @@
 
 #include <platform.h>
 
+#include "build/trace_ring.h"
+
 #include "drivers/io.h"
 #include "drivers/time.h"
 
@@ -101,6 +103,12 @@ static volatile uint16_t i2cErrorCount = 0;
 typedef struct {
     bool initialised;
     I2C_HandleTypeDef handle;
+
+    /* Background transfer bookkeeping, data phase runs from the EV/ER interrupts */
+    bool async;
+    uint8_t asyncAddr;
+    i2cAsyncState_e asyncState;
+    timeUs_t asyncStartUs;
 } i2cState_t;
 
 static i2cState_t i2cState[I2CDEV_COUNT];
@@ -158,10 +166,49 @@ void I2C4_EV_IRQHandler(void)
 static bool i2cHandleHardwareFailure(I2CDevice device)
 {
     i2cErrorCount++;
+    TRACE_RING_BUS_ERROR(device, 0);
     i2cInit(device);
     return false;
 }
 
+static void i2cCompleteAsync(I2CDevice device)
+{
+    i2cState_t * state = &(i2cState[device]);
+
+    if (!state->async) {
+        return;
+    }
+
+    if (HAL_I2C_GetState(&state->handle) == HAL_I2C_STATE_READY) {
+        if (HAL_I2C_GetError(&state->handle) == HAL_I2C_ERROR_NONE) {
+            state->asyncState = I2C_ASYNC_DONE;
+        }
+        else {
+            i2cErrorCount++;
+            TRACE_RING_BUS_ERROR(device, state->asyncAddr);
+            state->asyncState = I2C_ASYNC_FAILED;
+        }
+        state->async = false;
+    }
+    else if (cmpTimeUs(micros(), state->asyncStartUs) >= I2C_TIMEOUT) {
+        // Device is holding the bus, interrupts will never finish the transfer.
+        // Reset the peripheral so the handle leaves the busy state
+        i2cErrorCount++;
+        TRACE_RING_BUS_ERROR(device, state->asyncAddr);
+        HAL_I2C_DeInit(&state->handle);
+        HAL_I2C_Init(&state->handle);
+        state->async = false;
+        state->asyncState = I2C_ASYNC_FAILED;
+    }
+}
+
+static void i2cWaitForAsync(I2CDevice device)
+{
+    while (i2cState[device].async) {
+        i2cCompleteAsync(device);
+    }
+}
+
 bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, const uint8_t *data, bool allowRawAccess)
 {
     if (device == I2CINVALID)
@@ -172,6 +219,8 @@ bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_,
     if (!state->initialised)
         return false;
 
+    i2cWaitForAsync(device);
+
     HAL_StatusTypeDef status;
 
     if ((reg_ == 0xFF || len_ == 0) && allowRawAccess) {
@@ -202,6 +251,8 @@ bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t
     if (!state->initialised)
         return false;
 
+    i2cWaitForAsync(device);
+
     HAL_StatusTypeDef status;
 
     if (reg_ == 0xFF && allowRawAccess) {
@@ -217,6 +268,98 @@ bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t
     return true;
 }
 
+static bool i2cStartAsync(I2CDevice device, uint8_t addr_, HAL_StatusTypeDef status)
+{
+    i2cState_t * state = &(i2cState[device]);
+
+    if (status == HAL_BUSY) {
+        return false;
+    }
+
+    if (status != HAL_OK) {
+        i2cHandleHardwareFailure(device);
+        state->asyncAddr = addr_;
+        state->asyncState = I2C_ASYNC_FAILED;
+        return true;
+    }
+
+    state->async = true;
+    state->asyncAddr = addr_;
+    state->asyncState = I2C_ASYNC_BUSY;
+    state->asyncStartUs = micros();
+
+    return true;
+}
+
+// Only the data phase is interrupt driven, HAL still sends the register address in place
+bool i2cReadAsync(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf, bool allowRawAccess)
+{
+    if (device == I2CINVALID)
+        return false;
+
+    i2cState_t * state = &(i2cState[device]);
+
+    if (!state->initialised || state->async)
+        return false;
+
+    HAL_StatusTypeDef status;
+
+    if (reg_ == 0xFF && allowRawAccess) {
+        status = HAL_I2C_Master_Receive_IT(&state->handle, addr_ << 1, buf, len);
+    }
+    else {
+        status = HAL_I2C_Mem_Read_IT(&state->handle, addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT, buf, len);
+    }
+
+    return i2cStartAsync(device, addr_, status);
+}
+
+bool i2cWriteBufferAsync(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, const uint8_t *data, bool allowRawAccess)
+{
+    if (device == I2CINVALID)
+        return false;
+
+    i2cState_t * state = &(i2cState[device]);
+
+    if (!state->initialised || state->async)
+        return false;
+
+    HAL_StatusTypeDef status;
+
+    if ((reg_ == 0xFF || len_ == 0) && allowRawAccess) {
+        status = HAL_I2C_Master_Transmit_IT(&state->handle, addr_ << 1, (uint8_t *)data, len_);
+    }
+    else {
+        status = HAL_I2C_Mem_Write_IT(&state->handle, addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT, (uint8_t *)data, len_);
+    }
+
+    return i2cStartAsync(device, addr_, status);
+}
+
+i2cAsyncState_e i2cAsyncPoll(I2CDevice device, uint8_t addr_)
+{
+    if (device == I2CINVALID || i2cState[device].asyncAddr != addr_) {
+        return I2C_ASYNC_IDLE;
+    }
+
+    i2cCompleteAsync(device);
+
+    const i2cAsyncState_e asyncState = i2cState[device].asyncState;
+    if (asyncState == I2C_ASYNC_DONE || asyncState == I2C_ASYNC_FAILED) {
+        i2cState[device].asyncState = I2C_ASYNC_IDLE;
+    }
+
+    return asyncState;
+}
+
+void i2cAsyncProcess(void)
+{
+    // Interrupts move the data, only watch for completion and stuck buses here
+    for (int device = 0; device < I2CDEV_COUNT; device++) {
+        i2cCompleteAsync(device);
+    }
+}
+
 /*
  * Compute SCLDEL, SDADEL, SCLH and SCLL for TIMINGR register according to reference manuals.
  */
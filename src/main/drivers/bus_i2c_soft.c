@@ -295,5 +295,39 @@ uint16_t i2cGetErrorCounter(void)
     return i2cErrorCount;
 }
 
+// Bit-banged bus can't run transfers in background
+bool i2cReadAsync(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t *buf, bool allowRawAccess)
+{
+    UNUSED(device);
+    UNUSED(addr);
+    UNUSED(reg);
+    UNUSED(len);
+    UNUSED(buf);
+    UNUSED(allowRawAccess);
+    return false;
+}
+
+bool i2cWriteBufferAsync(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, const uint8_t * data, bool allowRawAccess)
+{
+    UNUSED(device);
+    UNUSED(addr);
+    UNUSED(reg);
+    UNUSED(len);
+    UNUSED(data);
+    UNUSED(allowRawAccess);
+    return false;
+}
+
+i2cAsyncState_e i2cAsyncPoll(I2CDevice device, uint8_t addr)
+{
+    UNUSED(device);
+    UNUSED(addr);
+    return I2C_ASYNC_IDLE;
+}
+
+void i2cAsyncProcess(void)
+{
+}
+
 #endif
 
@@ -22,6 +22,7 @@
 #include <platform.h>
 
 #include "build/atomic.h"
+#include "build/trace_ring.h"
 
 #include "common/utils.h"
 
@@ -131,6 +132,11 @@ typedef struct i2cBusState_s {
     uint32_t                    len;    // buffer length
     uint8_t                    *buf;    // buffer
     bool                        txnOk;
+
+    /* Background transfer bookkeeping */
+    bool                        async;          // Active transfer was started by i2c*Async
+    uint8_t                     asyncAddr;
+    i2cAsyncState_e             asyncState;
 } i2cBusState_t;
 
 static volatile uint16_t i2cErrorCount = 0;
@@ -152,6 +158,7 @@ static void i2cResetInterface(i2cBusState_t * i2cBusState)
     IO_t sda = IOGetByTag(i2c->sda);
 
     i2cErrorCount++;
+    TRACE_RING_BUS_ERROR(i2cBusState->device, i2cBusState->addr);
     i2cUnstick(scl, sda);
     i2cInit(i2cBusState->device);
 }
@@ -536,28 +543,48 @@ uint16_t i2cGetErrorCounter(void)
     return i2cErrorCount;
 }
 
+static void i2cCompleteAsync(i2cBusState_t * i2cBusState)
+{
+    if (i2cBusState->async && i2cBusState->state == I2C_STATE_STOPPED) {
+        i2cBusState->asyncState = i2cBusState->txnOk ? I2C_ASYNC_DONE : I2C_ASYNC_FAILED;
+        i2cBusState->async = false;
+    }
+}
+
 static void i2cWaitForCompletion(I2CDevice device)
 {
     do {
         i2cStateMachine(&busState[device], micros());
     } while (busState[device].state != I2C_STATE_STOPPED);
+
+    i2cCompleteAsync(&busState[device]);
 }
 
-bool i2cWriteBuffer(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, const uint8_t * data, bool allowRawAccess)
+static void i2cStartTransfer(I2CDevice device, uint8_t addr, uint8_t reg, i2cTransferDirection_t rw, uint8_t len, uint8_t * buf, bool allowRawAccess)
 {
-    // Don't try to access the non-initialized device
-    if (!busState[device].initialized)
-        return false;
+    // Let a background transfer on this bus run to completion first
+    if (busState[device].state != I2C_STATE_STOPPED) {
+        i2cWaitForCompletion(device);
+    }
 
-    // Set up write transaction
     busState[device].addr = addr << 1;
     busState[device].reg = reg;
-    busState[device].rw = I2C_TXN_WRITE;
+    busState[device].rw = rw;
     busState[device].len = len;
-    busState[device].buf = CONST_CAST(uint8_t*, data);
+    busState[device].buf = buf;
     busState[device].txnOk = false;
     busState[device].state = I2C_STATE_STARTING;
     busState[device].allowRawAccess = allowRawAccess;
+}
+
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, const uint8_t * data, bool allowRawAccess)
+{
+    // Don't try to access the non-initialized device
+    if (!busState[device].initialized)
+        return false;
+
+    // Set up write transaction
+    i2cStartTransfer(device, addr, reg, I2C_TXN_WRITE, len, CONST_CAST(uint8_t*, data), allowRawAccess);
 
     // Inject I2C_EVENT_START
     i2cWaitForCompletion(device);
@@ -577,14 +604,7 @@ bool i2cRead(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t*
         return false;
 
     // Set up read transaction
-    busState[device].addr = addr << 1;
-    busState[device].reg = reg;
-    busState[device].rw = I2C_TXN_READ;
-    busState[device].len = len;
-    busState[device].buf = buf;
-    busState[device].txnOk = false;
-    busState[device].state = I2C_STATE_STARTING;
-    busState[device].allowRawAccess = allowRawAccess;
+    i2cStartTransfer(device, addr, reg, I2C_TXN_READ, len, buf, allowRawAccess);
 
     // Inject I2C_EVENT_START
     i2cWaitForCompletion(device);
@@ -592,6 +612,68 @@ bool i2cRead(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t*
     return busState[device].txnOk;
 }
 
+static bool i2cStartAsync(I2CDevice device, uint8_t addr, uint8_t reg, i2cTransferDirection_t rw, uint8_t len, uint8_t * buf, bool allowRawAccess)
+{
+    if (device == I2CINVALID || !busState[device].initialized || busState[device].state != I2C_STATE_STOPPED) {
+        return false;
+    }
+
+    i2cStartTransfer(device, addr, reg, rw, len, buf, allowRawAccess);
+    busState[device].async = true;
+    busState[device].asyncAddr = addr;
+    busState[device].asyncState = I2C_ASYNC_BUSY;
+
+    // Get the START condition going right away
+    i2cStateMachine(&busState[device], micros());
+
+    return true;
+}
+
+bool i2cReadAsync(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t* buf, bool allowRawAccess)
+{
+    return i2cStartAsync(device, addr, reg, I2C_TXN_READ, len, buf, allowRawAccess);
+}
+
+bool i2cWriteBufferAsync(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, const uint8_t * data, bool allowRawAccess)
+{
+    return i2cStartAsync(device, addr, reg, I2C_TXN_WRITE, len, CONST_CAST(uint8_t*, data), allowRawAccess);
+}
+
+i2cAsyncState_e i2cAsyncPoll(I2CDevice device, uint8_t addr)
+{
+    if (device == I2CINVALID || busState[device].asyncAddr != addr) {
+        return I2C_ASYNC_IDLE;
+    }
+
+    const i2cAsyncState_e asyncState = busState[device].asyncState;
+    if (asyncState == I2C_ASYNC_DONE || asyncState == I2C_ASYNC_FAILED) {
+        busState[device].asyncState = I2C_ASYNC_IDLE;
+    }
+
+    return asyncState;
+}
+
+// Called from the main loop. Steps the bus state machines as long as the hardware
+// has an event ready, never waits for one
+void i2cAsyncProcess(void)
+{
+    for (int device = 0; device < I2CDEV_COUNT; device++) {
+        i2cBusState_t * i2cBusState = &busState[device];
+
+        if (!i2cBusState->async) {
+            continue;
+        }
+
+        i2cState_t prevState;
+        do {
+            prevState = i2cBusState->state;
+            i2cStateMachine(i2cBusState, micros());
+        } while (i2cBusState->state != prevState && i2cBusState->state != I2C_STATE_STOPPED);
+
+        i2cCompleteAsync(i2cBusState);
+    }
+}
+
 static void i2cUnstick(IO_t scl, IO_t sda)
 {
     int i;
@@ -17,15 +17,18 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <platform.h>
 
 #ifdef USE_SPI
 
 #include "drivers/bus_spi.h"
+#include "drivers/dma.h"
 #include "drivers/exti.h"
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
+#include "drivers/nvic.h"
 #include "drivers/rcc.h"
 
 #ifndef SPI1_SCK_PIN
@@ -59,6 +62,33 @@
 #define SPI3_NSS_PIN NONE
 #endif
 
+#ifdef USE_SPI_DMA
+#ifndef SPI1_RX_DMA
+#define SPI1_RX_DMA DMA_NONE
+#define SPI1_TX_DMA DMA_NONE
+#endif
+#ifndef SPI2_RX_DMA
+#define SPI2_RX_DMA DMA_NONE
+#define SPI2_TX_DMA DMA_NONE
+#endif
+#ifndef SPI3_RX_DMA
+#define SPI3_RX_DMA DMA_NONE
+#define SPI3_TX_DMA DMA_NONE
+#endif
+
+// RX and TX DMA stream tags, targets opt in by defining SPIx_RX_DMA and SPIx_TX_DMA
+static const dmaTag_t spiDmaTags[SPIDEV_COUNT][2] = {
+    { SPI1_RX_DMA, SPI1_TX_DMA },
+    { SPI2_RX_DMA, SPI2_TX_DMA },
+    { SPI3_RX_DMA, SPI3_TX_DMA },
+};
+
+static uint8_t spiDmaRxBuffer[SPIDEV_COUNT][SPI_DMA_BUFFER_SIZE];
+static uint8_t spiDmaTxBuffer[SPIDEV_COUNT][SPI_DMA_BUFFER_SIZE];
+
+static bool spiDmaInit(SPIDevice device);
+#endif
+
 #if defined(STM32F4)
 #if defined(USE_SPI_DEVICE_1)
 static const uint32_t spiDivisorMapFast[] = {
@@ -182,6 +212,10 @@ bool spiInitDevice(SPIDevice device, bool leadingEdge)
         IOHi(IOGetByTag(spi->nss));
     }
 
+#ifdef USE_SPI_DMA
+    spiDmaInit(device);
+#endif
+
     spi->initDone = true;
     return true;
 }
@@ -287,4 +321,125 @@ SPI_TypeDef * spiInstanceByDevice(SPIDevice device)
 {
     return spiHardwareMap[device].dev;
 }
+
+#ifdef USE_SPI_DMA
+static void spiDmaIrqHandler(DMA_t descriptor)
+{
+    const SPIDevice device = descriptor->userParam;
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+    const bool success = !DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF);
+
+    DMA_CLEAR_FLAG(spi->rxDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    DMA_CLEAR_FLAG(spi->txDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    DMA_Cmd(spi->rxDma->ref, DISABLE);
+    DMA_Cmd(spi->txDma->ref, DISABLE);
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+
+    if (!success) {
+        spi->errorCount++;
+    } else if (spi->dmaRxData) {
+        memcpy(spi->dmaRxData, spiDmaRxBuffer[device], spi->dmaLength);
+    }
+
+    if (spi->dmaCallback) {
+        spi->dmaCallback(device, success);
+    }
+}
+
+static void spiDmaInitStream(SPIDevice device, DMA_t dma, dmaTag_t tag, bool isRx)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+    DMA_InitTypeDef DMA_InitStructure;
+
+    dmaInit(dma, OWNER_SPI, device + 1);
+
+    DMA_Cmd(dma->ref, DISABLE);
+    DMA_DeInit(dma->ref);
+    DMA_StructInit(&DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Channel = dmaGetChannelByTag(tag);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&spi->dev->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = isRx ? (uint32_t)spiDmaRxBuffer[device] : (uint32_t)spiDmaTxBuffer[device];
+    DMA_InitStructure.DMA_DIR = isRx ? DMA_DIR_PeripheralToMemory : DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = SPI_DMA_BUFFER_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    // RX must win arbitration over TX to avoid overrun
+    DMA_InitStructure.DMA_Priority = isRx ? DMA_Priority_VeryHigh : DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+
+    DMA_Init(dma->ref, &DMA_InitStructure);
+}
+
+static bool spiDmaInit(SPIDevice device)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    const dmaTag_t rxTag = spiDmaTags[device][0];
+    const dmaTag_t txTag = spiDmaTags[device][1];
+    if (rxTag == DMA_NONE || txTag == DMA_NONE) {
+        return false;
+    }
+
+    DMA_t rxDma = dmaGetByTag(rxTag);
+    DMA_t txDma = dmaGetByTag(txTag);
+    if (!rxDma || !txDma || dmaGetOwner(rxDma) != OWNER_FREE || dmaGetOwner(txDma) != OWNER_FREE) {
+        return false;
+    }
+
+    spiDmaInitStream(device, rxDma, rxTag, true);
+    spiDmaInitStream(device, txDma, txTag, false);
+
+    // Both streams finish at the same time, only RX completion is needed to know the last byte was clocked in
+    DMA_ITConfig(rxDma->ref, DMA_IT_TC | DMA_IT_TE, ENABLE);
+    dmaSetHandler(rxDma, spiDmaIrqHandler, NVIC_PRIO_SPI_DMA, device);
+
+    spi->rxDma = rxDma;
+    spi->txDma = txDma;
+    return true;
+}
+
+bool spiDmaIsAvailable(SPIDevice device)
+{
+    return device != SPIINVALID && spiHardwareMap[device].rxDma != NULL;
+}
+
+bool spiDmaTransfer(SPIDevice device, uint8_t *rxData, const uint8_t *txData, int len, spiDmaCallbackPtr callback)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    if (!spi->rxDma || len <= 0 || len > SPI_DMA_BUFFER_SIZE) {
+        return false;
+    }
+
+    if (txData) {
+        memcpy(spiDmaTxBuffer[device], txData, len);
+    } else {
+        memset(spiDmaTxBuffer[device], 0xFF, len);
+    }
+
+    spi->dmaRxData = rxData;
+    spi->dmaLength = len;
+    spi->dmaCallback = callback;
+
+    DMA_CLEAR_FLAG(spi->rxDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    DMA_CLEAR_FLAG(spi->txDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    DMA_SetCurrDataCounter(spi->rxDma->ref, len);
+    DMA_SetCurrDataCounter(spi->txDma->ref, len);
+
+    // Drop any stale byte left in the data register by a previous polled transfer
+    spi->dev->DR;
+
+    DMA_Cmd(spi->rxDma->ref, ENABLE);
+    DMA_Cmd(spi->txDma->ref, ENABLE);
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+
+    return true;
+}
+#endif
 #endif // USE_SPI
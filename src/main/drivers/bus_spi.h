@@ -62,6 +62,13 @@ typedef enum SPIDevice {
 #define SPIDEV_COUNT 4
 #endif
 
+#ifdef USE_SPI_DMA
+// Largest single DMA transfer, longer transfers are split into chunks by the caller
+#define SPI_DMA_BUFFER_SIZE 128
+
+typedef void (*spiDmaCallbackPtr)(SPIDevice device, bool success);
+#endif
+
 typedef struct SPIDevice_s {
     SPI_TypeDef *dev;
     ioTag_t nss;
@@ -79,6 +86,13 @@ typedef struct SPIDevice_s {
     const uint32_t * divisorMap;
     volatile uint16_t errorCount;
     bool initDone;
+#ifdef USE_SPI_DMA
+    DMA_t rxDma;
+    DMA_t txDma;
+    uint8_t * dmaRxData;            // Destination of the transfer in progress, NULL if received data is discarded
+    uint16_t dmaLength;
+    spiDmaCallbackPtr dmaCallback;  // Called from DMA interrupt when the transfer in progress has finished
+#endif
 } spiDevice_t;
 
 bool spiInitDevice(SPIDevice device, bool leadingEdge);
@@ -90,4 +104,9 @@ bool spiTransfer(SPI_TypeDef *instance, uint8_t *rxData, const uint8_t *txData,
 uint16_t spiGetErrorCounter(SPI_TypeDef *instance);
 void spiResetErrorCounter(SPI_TypeDef *instance);
 SPIDevice spiDeviceByInstance(SPI_TypeDef *instance);
-SPI_TypeDef * spiInstanceByDevice(SPIDevice device);
\ No newline at end of file
+SPI_TypeDef * spiInstanceByDevice(SPIDevice device);
+
+#ifdef USE_SPI_DMA
+bool spiDmaIsAvailable(SPIDevice device);
+bool spiDmaTransfer(SPIDevice device, uint8_t *rxData, const uint8_t *txData, int len, spiDmaCallbackPtr callback);
+#endif
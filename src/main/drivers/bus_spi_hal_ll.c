@@ -17,10 +17,12 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <platform.h>
 
 #include "drivers/bus_spi.h"
+#include "drivers/dma_cache.h"
 #include "dma.h"
 #include "drivers/io.h"
 #include "io_impl.h"
@@ -68,6 +70,46 @@
 #define SPI4_NSS_PIN NONE
 #endif
 
+#ifdef USE_SPI_DMA
+#ifndef SPI1_RX_DMA
+#define SPI1_RX_DMA DMA_NONE
+#define SPI1_TX_DMA DMA_NONE
+#endif
+#ifndef SPI2_RX_DMA
+#define SPI2_RX_DMA DMA_NONE
+#define SPI2_TX_DMA DMA_NONE
+#endif
+#ifndef SPI3_RX_DMA
+#define SPI3_RX_DMA DMA_NONE
+#define SPI3_TX_DMA DMA_NONE
+#endif
+#ifndef SPI4_RX_DMA
+#define SPI4_RX_DMA DMA_NONE
+#define SPI4_TX_DMA DMA_NONE
+#endif
+
+// RX and TX DMA stream tags, targets opt in by defining SPIx_RX_DMA and SPIx_TX_DMA
+// On H7 the channel field of the tag holds the DMAMUX request (DMA_REQUEST_SPIx_RX/TX)
+static const dmaTag_t spiDmaTags[SPIDEV_COUNT][2] = {
+    { SPI1_RX_DMA, SPI1_TX_DMA },
+    { SPI2_RX_DMA, SPI2_TX_DMA },
+    { SPI3_RX_DMA, SPI3_TX_DMA },
+    { SPI4_RX_DMA, SPI4_TX_DMA },
+};
+
+static const uint32_t spiDmaLLStreamTable[] = { LL_DMA_STREAM_0, LL_DMA_STREAM_1, LL_DMA_STREAM_2, LL_DMA_STREAM_3, LL_DMA_STREAM_4, LL_DMA_STREAM_5, LL_DMA_STREAM_6, LL_DMA_STREAM_7 };
+
+#if !defined(STM32H7)
+static const uint32_t spiDmaLLChannelTable[] = { LL_DMA_CHANNEL_0, LL_DMA_CHANNEL_1, LL_DMA_CHANNEL_2, LL_DMA_CHANNEL_3, LL_DMA_CHANNEL_4, LL_DMA_CHANNEL_5, LL_DMA_CHANNEL_6, LL_DMA_CHANNEL_7 };
+#endif
+
+// H7 DMA can't reach DTCM, buffers live in D2 SRAM and own whole cache lines
+static DMA_RAM uint8_t spiDmaRxBuffer[SPIDEV_COUNT][SPI_DMA_BUFFER_SIZE] DMA_CACHE_ALIGNED;
+static DMA_RAM uint8_t spiDmaTxBuffer[SPIDEV_COUNT][SPI_DMA_BUFFER_SIZE] DMA_CACHE_ALIGNED;
+
+static bool spiDmaInit(SPIDevice device);
+#endif
+
 #if defined(USE_SPI_DEVICE_1)
 static const uint32_t spiDivisorMapFast[] = {
     LL_SPI_BAUDRATEPRESCALER_DIV256,    // SPI_CLOCK_INITIALIZATON      421.875 KBits/s
@@ -295,6 +337,10 @@ bool spiInitDevice(SPIDevice device, bool leadingEdge)
         IOHi(IOGetByTag(spi->nss));
     }
 
+#ifdef USE_SPI_DMA
+    spiDmaInit(device);
+#endif
+
     spi->initDone = true;
     return true;
 }
@@ -399,3 +445,158 @@ SPI_TypeDef * spiInstanceByDevice(SPIDevice device)
 {
     return spiHardwareMap[device].dev;
 }
+
+#ifdef USE_SPI_DMA
+static void spiDmaIrqHandler(DMA_t descriptor)
+{
+    const SPIDevice device = descriptor->userParam;
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+    const bool success = !DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF);
+
+    DMA_CLEAR_FLAG(spi->rxDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    DMA_CLEAR_FLAG(spi->txDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    LL_DMA_DisableStream(spi->rxDma->dma, spiDmaLLStreamTable[DMATAG_GET_STREAM(spi->rxDma->tag)]);
+    LL_DMA_DisableStream(spi->txDma->dma, spiDmaLLStreamTable[DMATAG_GET_STREAM(spi->txDma->tag)]);
+    LL_SPI_DisableDMAReq_TX(spi->dev);
+    LL_SPI_DisableDMAReq_RX(spi->dev);
+
+#if defined(STM32H7)
+    while (!LL_SPI_IsActiveFlag_EOT(spi->dev));
+    LL_SPI_ClearFlag_EOT(spi->dev);
+    LL_SPI_ClearFlag_TXTF(spi->dev);
+    LL_SPI_Disable(spi->dev);
+#endif
+
+    if (!success) {
+        spi->errorCount++;
+    } else if (spi->dmaRxData) {
+        dmaCacheInvalidateForCpu(spiDmaRxBuffer[device], spi->dmaLength);
+        memcpy(spi->dmaRxData, spiDmaRxBuffer[device], spi->dmaLength);
+    }
+
+    if (spi->dmaCallback) {
+        spi->dmaCallback(device, success);
+    }
+}
+
+static void spiDmaInitStream(SPIDevice device, DMA_t dma, dmaTag_t tag, bool isRx)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+    const uint32_t streamLL = spiDmaLLStreamTable[DMATAG_GET_STREAM(tag)];
+
+    dmaInit(dma, OWNER_SPI, device + 1);
+
+    LL_DMA_DeInit(dma->dma, streamLL);
+
+    LL_DMA_InitTypeDef init;
+    LL_DMA_StructInit(&init);
+
+#if defined(STM32H7)
+    init.PeriphRequest = DMATAG_GET_CHANNEL(tag);
+    init.PeriphOrM2MSrcAddress = isRx ? (uint32_t)&spi->dev->RXDR : (uint32_t)&spi->dev->TXDR;
+#else
+    init.Channel = spiDmaLLChannelTable[DMATAG_GET_CHANNEL(tag)];
+    init.PeriphOrM2MSrcAddress = LL_SPI_DMA_GetRegAddr(spi->dev);
+#endif
+    init.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+    init.PeriphOrM2MSrcDataSize = LL_DMA_PDATAALIGN_BYTE;
+    init.MemoryOrM2MDstAddress = isRx ? (uint32_t)spiDmaRxBuffer[device] : (uint32_t)spiDmaTxBuffer[device];
+    init.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+    init.MemoryOrM2MDstDataSize = LL_DMA_MDATAALIGN_BYTE;
+    init.NbData = SPI_DMA_BUFFER_SIZE;
+    init.Direction = isRx ? LL_DMA_DIRECTION_PERIPH_TO_MEMORY : LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+    init.Mode = LL_DMA_MODE_NORMAL;
+    // RX must win arbitration over TX to avoid overrun
+    init.Priority = isRx ? LL_DMA_PRIORITY_VERYHIGH : LL_DMA_PRIORITY_HIGH;
+    init.FIFOMode = LL_DMA_FIFOMODE_DISABLE;
+
+    LL_DMA_Init(dma->dma, streamLL, &init);
+}
+
+static bool spiDmaInit(SPIDevice device)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    const dmaTag_t rxTag = spiDmaTags[device][0];
+    const dmaTag_t txTag = spiDmaTags[device][1];
+    if (rxTag == DMA_NONE || txTag == DMA_NONE) {
+        return false;
+    }
+
+    DMA_t rxDma = dmaGetByTag(rxTag);
+    DMA_t txDma = dmaGetByTag(txTag);
+    if (!rxDma || !txDma || dmaGetOwner(rxDma) != OWNER_FREE || dmaGetOwner(txDma) != OWNER_FREE) {
+        return false;
+    }
+
+    spiDmaInitStream(device, rxDma, rxTag, true);
+    spiDmaInitStream(device, txDma, txTag, false);
+
+    // Both streams finish at the same time, only RX completion is needed to know the last byte was clocked in
+    const uint32_t rxStreamLL = spiDmaLLStreamTable[DMATAG_GET_STREAM(rxTag)];
+    LL_DMA_EnableIT_TC(rxDma->dma, rxStreamLL);
+    LL_DMA_EnableIT_TE(rxDma->dma, rxStreamLL);
+    dmaSetHandler(rxDma, spiDmaIrqHandler, NVIC_PRIO_SPI_DMA, device);
+
+    spi->rxDma = rxDma;
+    spi->txDma = txDma;
+    return true;
+}
+
+bool spiDmaIsAvailable(SPIDevice device)
+{
+    return device != SPIINVALID && spiHardwareMap[device].rxDma != NULL;
+}
+
+bool spiDmaTransfer(SPIDevice device, uint8_t *rxData, const uint8_t *txData, int len, spiDmaCallbackPtr callback)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    if (!spi->rxDma || len <= 0 || len > SPI_DMA_BUFFER_SIZE) {
+        return false;
+    }
+
+    const uint32_t rxStreamLL = spiDmaLLStreamTable[DMATAG_GET_STREAM(spi->rxDma->tag)];
+    const uint32_t txStreamLL = spiDmaLLStreamTable[DMATAG_GET_STREAM(spi->txDma->tag)];
+
+    if (txData) {
+        memcpy(spiDmaTxBuffer[device], txData, len);
+    } else {
+        memset(spiDmaTxBuffer[device], 0xFF, len);
+    }
+    dmaCacheCleanForDevice(spiDmaTxBuffer[device], len);
+
+    spi->dmaRxData = rxData;
+    spi->dmaLength = len;
+    spi->dmaCallback = callback;
+
+    DMA_CLEAR_FLAG(spi->rxDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    DMA_CLEAR_FLAG(spi->txDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    LL_DMA_SetDataLength(spi->rxDma->dma, rxStreamLL, len);
+    LL_DMA_SetDataLength(spi->txDma->dma, txStreamLL, len);
+
+#if defined(STM32H7)
+    LL_SPI_SetTransferSize(spi->dev, len);
+    LL_SPI_EnableDMAReq_RX(spi->dev);
+    LL_DMA_EnableStream(spi->rxDma->dma, rxStreamLL);
+    LL_DMA_EnableStream(spi->txDma->dma, txStreamLL);
+    LL_SPI_EnableDMAReq_TX(spi->dev);
+    LL_SPI_Enable(spi->dev);
+    LL_SPI_StartMasterTransfer(spi->dev);
+#else
+    // Drop any stale bytes left in the RX FIFO by a previous polled transfer
+    while (LL_SPI_IsActiveFlag_RXNE(spi->dev)) {
+        LL_SPI_ReceiveData8(spi->dev);
+    }
+
+    LL_DMA_EnableStream(spi->rxDma->dma, rxStreamLL);
+    LL_SPI_EnableDMAReq_RX(spi->dev);
+    LL_DMA_EnableStream(spi->txDma->dma, txStreamLL);
+    LL_SPI_EnableDMAReq_TX(spi->dev);
+#endif
+
+    return true;
+}
+#endif
@@ -25,6 +25,8 @@ typedef struct magDev_s {
     busDevice_t * busDev;
     sensorMagInitFuncPtr init;  // initialize function
     sensorMagReadFuncPtr read;  // read 3 axis data function
+    sensorMagReadFuncPtr readAsync;         // optional, queue a background read of the data registers into asyncBuf
+    sensorMagReadFuncPtr readAsyncDecode;   // convert asyncBuf once the background read has completed
     struct {
         bool useExternal;
         union {
@@ -34,4 +36,5 @@ typedef struct magDev_s {
     } magAlign;
     uint8_t magSensorToUse;
     int16_t magADCRaw[XYZ_AXIS_COUNT];
+    uint8_t asyncBuf[6];
 } magDev_t;
@@ -138,6 +138,22 @@ static bool hmc5883lRead(magDev_t * mag)
     return true;
 }
 
+static bool hmc5883lReadAsync(magDev_t * mag)
+{
+    return busReadBufAsync(mag->busDev, MAG_DATA_REGISTER, mag->asyncBuf, 6);
+}
+
+static bool hmc5883lReadAsyncDecode(magDev_t * mag)
+{
+    const uint8_t * buf = mag->asyncBuf;
+
+    mag->magADCRaw[X] = (int16_t)(buf[0] << 8 | buf[1]);
+    mag->magADCRaw[Z] = (int16_t)(buf[2] << 8 | buf[3]);
+    mag->magADCRaw[Y] = (int16_t)(buf[4] << 8 | buf[5]);
+
+    return true;
+}
+
 #define INITIALISATION_MAX_READ_FAILURES 5
 static bool hmc5883lInit(magDev_t * mag)
 {
@@ -185,6 +201,11 @@ bool hmc5883lDetect(magDev_t * mag)
     mag->init = hmc5883lInit;
     mag->read = hmc5883lRead;
 
+    if (mag->busDev->busType == BUSTYPE_I2C) {
+        mag->readAsync = hmc5883lReadAsync;
+        mag->readAsyncDecode = hmc5883lReadAsyncDecode;
+    }
+
     return true;
 }
 #endif
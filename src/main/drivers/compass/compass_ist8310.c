@@ -148,6 +148,23 @@ static bool ist8310Read(magDev_t * mag)
     return true;
 }
 
+static bool ist8310ReadAsync(magDev_t * mag)
+{
+    return busReadBufAsync(mag->busDev, IST8310_REG_DATA, mag->asyncBuf, 6);
+}
+
+static bool ist8310ReadAsyncDecode(magDev_t * mag)
+{
+    const uint8_t * buf = mag->asyncBuf;
+    uint8_t LSB2FSV = 3; // 3mG - 14 bit
+
+    mag->magADCRaw[X] =  (int16_t)(buf[1] << 8 | buf[0]) * LSB2FSV;
+    mag->magADCRaw[Y] = -(int16_t)(buf[3] << 8 | buf[2]) * LSB2FSV;
+    mag->magADCRaw[Z] =  (int16_t)(buf[5] << 8 | buf[4]) * LSB2FSV;
+
+    return true;
+}
+
 #define DETECTION_MAX_RETRY_COUNT   5
 static bool deviceDetect(magDev_t * mag)
 {
@@ -176,6 +193,10 @@ bool ist8310Detect(magDev_t * mag)
         if (deviceDetect(mag)) {
             mag->init = ist8310Init;
             mag->read = ist8310Read;
+            if (mag->busDev->busType == BUSTYPE_I2C) {
+                mag->readAsync = ist8310ReadAsync;
+                mag->readAsyncDecode = ist8310ReadAsyncDecode;
+            }
             return true;
         } else {
             busDeviceDeInit(mag->busDev);
@@ -119,6 +119,23 @@ static bool qmc5883Read(magDev_t * mag)
     return true;
 }
 
+// Continuous mode at 200Hz, the data registers always hold a recent sample and no status check is needed
+static bool qmc5883ReadAsync(magDev_t * mag)
+{
+    return busReadBufAsync(mag->busDev, QMC5883L_REG_DATA_OUTPUT_X, mag->asyncBuf, 6);
+}
+
+static bool qmc5883ReadAsyncDecode(magDev_t * mag)
+{
+    const uint8_t * buf = mag->asyncBuf;
+
+    mag->magADCRaw[X] = (int16_t)(buf[1] << 8 | buf[0]);
+    mag->magADCRaw[Y] = (int16_t)(buf[3] << 8 | buf[2]);
+    mag->magADCRaw[Z] = (int16_t)(buf[5] << 8 | buf[4]);
+
+    return true;
+}
+
 #define DETECTION_MAX_RETRY_COUNT   5
 static bool deviceDetect(magDev_t * mag)
 {
@@ -159,6 +176,11 @@ bool qmc5883Detect(magDev_t * mag)
     mag->init = qmc5883Init;
     mag->read = qmc5883Read;
 
+    if (mag->busDev->busType == BUSTYPE_I2C) {
+        mag->readAsync = qmc5883ReadAsync;
+        mag->readAsyncDecode = qmc5883ReadAsyncDecode;
+    }
+
     return true;
 }
 #endif
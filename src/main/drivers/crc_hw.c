@@ -0,0 +1,122 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * CRC calculation unit of the F7 and H7. Polynomial, width and initial value
+ * are programmable, non-reflected CRC8 and CRC16 map onto it directly.
+ *
+ * The unit is shared between the main loop and the serial receive interrupts.
+ * Whoever finds it in use falls back to the tables, an interrupt always
+ * completes before the code it preempted resumes.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_CRC_HW
+
+#if defined(STM32H7)
+#include "stm32h7xx_ll_crc.h"
+#elif defined(STM32F7)
+#include "stm32f7xx_ll_crc.h"
+#endif
+
+#include "common/crc.h"
+
+#include "drivers/crc_hw.h"
+
+static bool crcHwReady = false;
+static volatile bool crcHwBusy = false;
+
+static bool crcHwCompute(uint32_t polySize, uint32_t polynomial, uint32_t *crc, const uint8_t *p, uint32_t length)
+{
+    if (!crcHwReady || crcHwBusy) {
+        return false;
+    }
+
+    crcHwBusy = true;
+
+    LL_CRC_SetPolynomialSize(CRC, polySize);
+    LL_CRC_SetPolynomialCoef(CRC, polynomial);
+    LL_CRC_SetInitialData(CRC, *crc);
+    LL_CRC_ResetCRCCalculationUnit(CRC);
+
+    // Bytes up to a word boundary, then words. The unit takes the most significant byte of a word first.
+    for (; length > 0 && ((uintptr_t)p & 3); length--) {
+        LL_CRC_FeedData8(CRC, *p++);
+    }
+    for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t), p += sizeof(uint32_t)) {
+        LL_CRC_FeedData32(CRC, __REV(*(const uint32_t *)p));
+    }
+    for (; length > 0; length--) {
+        LL_CRC_FeedData8(CRC, *p++);
+    }
+
+    *crc = LL_CRC_ReadData32(CRC);
+
+    crcHwBusy = false;
+    return true;
+}
+
+bool crcHwUpdate8(uint8_t polynomial, uint8_t *crc, const void *data, uint32_t length)
+{
+    uint32_t value = *crc;
+    if (!crcHwCompute(LL_CRC_POLYLENGTH_8B, polynomial, &value, data, length)) {
+        return false;
+    }
+
+    *crc = value;
+    return true;
+}
+
+bool crcHwUpdate16(uint16_t polynomial, uint16_t *crc, const void *data, uint32_t length)
+{
+    uint32_t value = *crc;
+    if (!crcHwCompute(LL_CRC_POLYLENGTH_16B, polynomial, &value, data, length)) {
+        return false;
+    }
+
+    *crc = value;
+    return true;
+}
+
+void crcHwInit(void)
+{
+    static const uint8_t check[] = "123456789";
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+
+    LL_CRC_SetInputDataReverseMode(CRC, LL_CRC_INDATA_REVERSE_NONE);
+    LL_CRC_SetOutputDataReverseMode(CRC, LL_CRC_OUTDATA_REVERSE_NONE);
+
+    crcHwReady = true;
+
+    // The stored config has to verify the same as with the tables. Compare against the check values
+    // of CRC-16/XMODEM and CRC-8/DVB-S2, the latter continued from a software CRC at an odd address.
+    uint16_t crc16 = 0;
+    uint8_t crc8 = crc8_dvb_s2(0, check[0]);
+    const bool done = crcHwUpdate16(CRC16_CCITT_POLY, &crc16, check, 9) && crcHwUpdate8(CRC8_DVB_S2_POLY, &crc8, check + 1, 8);
+
+    crcHwReady = done && crc16 == 0x31C3 && crc8 == 0xBC;
+}
+
+#endif
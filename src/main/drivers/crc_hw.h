@@ -0,0 +1,36 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CRC16_CCITT_POLY    0x1021
+#define CRC8_DVB_S2_POLY    0xD5
+
+// Shorter buffers are faster through the lookup tables than the peripheral setup
+#define CRC_HW_MIN_LENGTH   16
+
+void crcHwInit(void);
+
+// Continue *crc over the buffer, false when the unit is busy or unusable and the caller has to do it in software
+bool crcHwUpdate8(uint8_t polynomial, uint8_t *crc, const void *data, uint32_t length);
+bool crcHwUpdate16(uint16_t polynomial, uint16_t *crc, const void *data, uint32_t length);
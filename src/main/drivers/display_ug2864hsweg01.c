@@ -24,6 +24,8 @@
 
 #ifdef USE_OLED_UG2864
 
+#include "common/maths.h"
+
 #include "drivers/bus.h"
 #include "drivers/bus_i2c.h"
 #include "drivers/time.h"
@@ -174,24 +176,159 @@ static const uint8_t multiWiiFont[][5] = { // Refer to "Times New Roman" Font Da
 
 // #define OLED_address   0x3C     // OLED at address 0x3C in 7bit
 
+#define OLED_PAGE_COUNT         (SCREEN_HEIGHT / 8)
+#define OLED_CONTROL_CMD        0x80    // Co = 1, another control byte follows
+#define OLED_CONTROL_DATA       0x40    // Co = 0, the rest of the transfer is display RAM
+#define OLED_WINDOW_CMD_LENGTH  11      // Column and page window commands after the first control byte
+
 static busDevice_t *busDev = NULL;
 
+/*
+ * Text and bitmaps only go to the frame buffer, i2c_OLED_flush() sends the
+ * columns that changed to the display, one page per background transfer.
+ * Each page keeps the range of columns that differ from the display RAM.
+ */
+static uint8_t frameBuffer[OLED_PAGE_COUNT][SCREEN_WIDTH];
+static struct {
+    uint8_t firstColumn;
+    uint8_t lastColumn;     // Clean while lastColumn < firstColumn
+} dirty[OLED_PAGE_COUNT];
+
+static uint8_t cursorPage;
+static uint8_t cursorColumn;
+
+static struct {
+    bool active;
+    uint8_t page;
+    uint8_t firstColumn;
+    uint8_t lastColumn;
+    // Window commands and page data of the transfer, stays valid until it completes
+    uint8_t buffer[OLED_WINDOW_CMD_LENGTH + 1 + SCREEN_WIDTH];
+} transfer;
+
 static bool i2c_OLED_send_cmd(uint8_t command)
 {
     if (!busDev) {
         return false;
     }
 
-    return busWrite(busDev, 0x80, command);
+    return busWrite(busDev, OLED_CONTROL_CMD, command);
 }
 
+static void markDirty(uint8_t page, uint8_t firstColumn, uint8_t lastColumn)
+{
+    if (dirty[page].lastColumn < dirty[page].firstColumn) {
+        dirty[page].firstColumn = firstColumn;
+        dirty[page].lastColumn = lastColumn;
+    } else {
+        dirty[page].firstColumn = MIN(dirty[page].firstColumn, firstColumn);
+        dirty[page].lastColumn = MAX(dirty[page].lastColumn, lastColumn);
+    }
+}
+
+static void markClean(uint8_t page)
+{
+    dirty[page].firstColumn = SCREEN_WIDTH - 1;
+    dirty[page].lastColumn = 0;
+}
+
+// Horizontal addressing mode, the cursor moves on to the next page after the last column
 bool i2c_OLED_send_byte(uint8_t val)
 {
     if (!busDev) {
         return false;
     }
 
-    return busWrite(busDev, 0x40, val);
+    if (frameBuffer[cursorPage][cursorColumn] != val) {
+        frameBuffer[cursorPage][cursorColumn] = val;
+        markDirty(cursorPage, cursorColumn, cursorColumn);
+    }
+
+    if (++cursorColumn == SCREEN_WIDTH) {
+        cursorColumn = 0;
+        cursorPage = (cursorPage + 1) % OLED_PAGE_COUNT;
+    }
+
+    return true;
+}
+
+static void clearFrameBuffer(void)
+{
+    cursorPage = 0;
+    cursorColumn = 0;
+    for (int i = 0; i < OLED_PAGE_COUNT * SCREEN_WIDTH; i++) {
+        i2c_OLED_send_byte(0x00);
+    }
+}
+
+// Column and page window followed by the data of one page, all in one I2C write
+static uint8_t preparePageTransfer(uint8_t page, uint8_t firstColumn, uint8_t lastColumn)
+{
+    const uint8_t header[OLED_WINDOW_CMD_LENGTH + 1] = {
+        0x21, OLED_CONTROL_CMD, firstColumn, OLED_CONTROL_CMD, lastColumn,     // Set Column Address
+        OLED_CONTROL_CMD, 0x22, OLED_CONTROL_CMD, page, OLED_CONTROL_CMD, page, // Set Page Address
+        OLED_CONTROL_DATA
+    };
+    const uint8_t length = lastColumn - firstColumn + 1;
+
+    memcpy(transfer.buffer, header, sizeof(header));
+    memcpy(transfer.buffer + sizeof(header), &frameBuffer[page][firstColumn], length);
+
+    return sizeof(header) + length;
+}
+
+static void writeFrameBufferBlocking(void)
+{
+    for (int page = 0; page < OLED_PAGE_COUNT; page++) {
+        if (dirty[page].firstColumn <= dirty[page].lastColumn) {
+            const uint8_t length = preparePageTransfer(page, dirty[page].firstColumn, dirty[page].lastColumn);
+            if (busWriteBuf(busDev, OLED_CONTROL_CMD, transfer.buffer, length)) {
+                markClean(page);
+            }
+        }
+    }
+}
+
+void i2c_OLED_flush(void)
+{
+    if (!busDev) {
+        return;
+    }
+
+#ifdef SOFT_I2C
+    // Bit-banged bus can't run transfers in background
+    writeFrameBufferBlocking();
+#else
+    if (transfer.active) {
+        const busAsyncState_e asyncState = busAsyncPoll(busDev);
+        if (asyncState == BUS_ASYNC_QUEUED || asyncState == BUS_ASYNC_ACTIVE) {
+            return;
+        }
+
+        transfer.active = false;
+        if (asyncState == BUS_ASYNC_FAILED) {
+            markDirty(transfer.page, transfer.firstColumn, transfer.lastColumn);
+        }
+    }
+
+    // Pages in order, starting after the last one sent
+    for (int i = 1; i <= OLED_PAGE_COUNT; i++) {
+        const uint8_t page = (transfer.page + i) % OLED_PAGE_COUNT;
+        if (dirty[page].firstColumn > dirty[page].lastColumn) {
+            continue;
+        }
+
+        const uint8_t length = preparePageTransfer(page, dirty[page].firstColumn, dirty[page].lastColumn);
+        if (busWriteBufAsync(busDev, OLED_CONTROL_CMD, transfer.buffer, length)) {
+            transfer.active = true;
+            transfer.page = page;
+            transfer.firstColumn = dirty[page].firstColumn;
+            transfer.lastColumn = dirty[page].lastColumn;
+            markClean(page);
+        }
+        return;
+    }
+#endif
 }
 
 void i2c_OLED_clear_display(void)
@@ -204,9 +341,15 @@ void i2c_OLED_clear_display(void)
     i2c_OLED_send_cmd(0x40);              // Display start line register to 0
     i2c_OLED_send_cmd(0);                 // Set low col address to 0
     i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for (uint16_t i = 0; i < 1024; i++) {  // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(0x00);  // clear
+
+    // Whatever the display RAM holds, write all of it
+    transfer.active = false;
+    memset(frameBuffer, 0, sizeof(frameBuffer));
+    for (int page = 0; page < OLED_PAGE_COUNT; page++) {
+        markDirty(page, 0, SCREEN_WIDTH - 1);
     }
+    writeFrameBufferBlocking();
+
     i2c_OLED_send_cmd(0x81);              // Setup CONTRAST CONTROL, following byte is the contrast Value... always a 2 byte instruction
     i2c_OLED_send_cmd(200);               // Here you can set the brightness 1 = dull, 255 is very bright
     i2c_OLED_send_cmd(0xaf);              // display on
@@ -214,27 +357,19 @@ void i2c_OLED_clear_display(void)
 
 void i2c_OLED_clear_display_quick(void)
 {
-    i2c_OLED_send_cmd(0xb0);              // set page address to 0
-    i2c_OLED_send_cmd(0x40);              // Display start line register to 0
-    i2c_OLED_send_cmd(0);                 // Set low col address to 0
-    i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for (uint16_t i = 0; i < 1024; i++) {      // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(0x00);  // clear
-    }
+    clearFrameBuffer();
 }
 
 void i2c_OLED_set_xy(uint8_t col, uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row);                      //set page address
-    i2c_OLED_send_cmd(0x00 + ((CHARACTER_WIDTH_TOTAL * col) & 0x0f));         //set low col address
-    i2c_OLED_send_cmd(0x10 + (((CHARACTER_WIDTH_TOTAL * col) >> 4) & 0x0f));  //set high col address
+    cursorPage = row % OLED_PAGE_COUNT;
+    cursorColumn = (CHARACTER_WIDTH_TOTAL * col) % SCREEN_WIDTH;
 }
 
 void i2c_OLED_set_line(uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row); //set page address
-    i2c_OLED_send_cmd(0);          //set low col address
-    i2c_OLED_send_cmd(0x10);       //set high col address
+    cursorPage = row % OLED_PAGE_COUNT;
+    cursorColumn = 0;
 }
 
 void i2c_OLED_send_char(unsigned char ascii)
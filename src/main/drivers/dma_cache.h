@@ -0,0 +1,75 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "platform.h"
+
+/*
+ * Cache maintenance for DMA buffers. On H7 the D-cache is on and DMA_RAM is a
+ * cacheable region, the CPU and the DMA only agree on a buffer's content after
+ * cleaning it before the DMA reads it and invalidating it before the CPU reads
+ * what the DMA wrote. Elsewhere the D-cache is off and these compile to nothing.
+ *
+ * Maintenance works on whole cache lines. A buffer the DMA writes to should be
+ * DMA_CACHE_ALIGNED and own its lines, otherwise invalidating it also drops CPU
+ * writes to its neighbours that did not make it to memory yet.
+ */
+
+#define DMA_CACHE_LINE_SIZE         32
+#define DMA_CACHE_ALIGNED           __attribute__ ((aligned (DMA_CACHE_LINE_SIZE)))
+
+// Round a buffer size up to whole cache lines
+#define DMA_CACHE_ALIGN_SIZE(size)  (((size) + DMA_CACHE_LINE_SIZE - 1) & ~(DMA_CACHE_LINE_SIZE - 1))
+
+#if defined(STM32H7)
+static inline void dmaCacheMaintenanceRange(const volatile void *addr, uint32_t size, uint32_t *start, int32_t *length)
+{
+    *start = (uint32_t)addr & ~(DMA_CACHE_LINE_SIZE - 1);
+    *length = DMA_CACHE_ALIGN_SIZE((uint32_t)addr + size - *start);
+}
+#endif
+
+// CPU writes are pushed to memory, call before handing the buffer to the DMA
+static inline void dmaCacheCleanForDevice(const volatile void *addr, uint32_t size)
+{
+#if defined(STM32H7)
+    uint32_t start;
+    int32_t length;
+    dmaCacheMaintenanceRange(addr, size, &start, &length);
+    SCB_CleanDCache_by_Addr((uint32_t *)start, length);
+#else
+    (void)addr;
+    (void)size;
+#endif
+}
+
+// Stale lines are dropped, call after the DMA wrote the buffer and before the CPU reads it
+static inline void dmaCacheInvalidateForCpu(const volatile void *addr, uint32_t size)
+{
+#if defined(STM32H7)
+    uint32_t start;
+    int32_t length;
+    dmaCacheMaintenanceRange(addr, size, &start, &length);
+    SCB_InvalidateDCache_by_Addr((uint32_t *)start, length);
+#else
+    (void)addr;
+    (void)size;
+#endif
+}
@@ -32,6 +32,7 @@
 #include "flash_m25p16.h"
 #include "flash_w25n01g.h"
 
+#include "common/maths.h"
 #include "common/time.h"
 
 #include "drivers/bus_spi.h"
@@ -52,7 +53,8 @@ static flashDriver_t flashDrivers[] = {
         .pageProgram = m25p16_pageProgram,
         .readBytes = m25p16_readBytes,
         .getGeometry = m25p16_getGeometry,
-        .flush = NULL
+        .flush = NULL,
+        .getHealth = NULL
     },
 #endif
 
@@ -66,7 +68,8 @@ static flashDriver_t flashDrivers[] = {
         .pageProgram = w25n01g_pageProgram,
         .readBytes = w25n01g_readBytes,
         .getGeometry = w25n01g_getGeometry,
-        .flush = w25n01g_flush
+        .flush = w25n01g_flush,
+        .getHealth = w25n01g_getHealth
     },
 #endif
 
@@ -129,7 +132,9 @@ int flashReadBytes(uint32_t address, uint8_t *buffer, int length)
 
 void flashFlush(void)
 {
-    flash->flush();
+    if (flash->flush) {
+        flash->flush();
+    }
 }
 
 const flashGeometry_t *flashGetGeometry(void)
@@ -144,6 +149,16 @@ const flashGeometry_t *flashGetGeometry(void)
     return flash->getGeometry();
 }
 
+bool flashGetHealth(flashHealth_t *health)
+{
+    if (flash == NULL || flash->getHealth == NULL) {
+        return false;
+    }
+
+    flash->getHealth(health);
+    return true;
+}
+
 /*
  * Flash partitioning
  *
@@ -213,6 +228,19 @@ static void flashConfigurePartitions(void)
     createPartition(FLASH_PARTITION_TYPE_CONFIG, configSize, &endSector);
 #endif
 
+#if defined(USE_MISSION_STORE)
+    createPartition(FLASH_PARTITION_TYPE_MISSION, MISSION_STORE_SIZE, &endSector);
+#endif
+
+#if defined(USE_TERRAIN)
+    createPartition(FLASH_PARTITION_TYPE_TERRAIN, TERRAIN_STORE_SIZE, &endSector);
+#endif
+
+#if defined(USE_FLASHFS_INDEX)
+    // The index reuses its oldest sector when full, it needs at least one more
+    createPartition(FLASH_PARTITION_TYPE_FLASHFS_INDEX, MAX(FLASHFS_INDEX_SIZE, 2 * flashGeometry->sectorSize), &endSector);
+#endif
+
 #ifdef USE_FLASHFS
     flashPartitionSet(FLASH_PARTITION_TYPE_FLASHFS, startSector, endSector);
 #endif
@@ -263,9 +291,16 @@ static const char *flashPartitionNames[] = {
     "BBMGMT   ",
     "FIRMWARE ",
     "CONFIG   ",
+    "BACKUP   ",
+    "FW META  ",
     "FW UPDT  ",
+    "MISSION  ",
+    "TERRAIN  ",
+    "FF INDEX ",
 };
 
+STATIC_ASSERT(ARRAYLEN(flashPartitionNames) == FLASH_MAX_PARTITIONS, flash_partition_names_out_of_sync);
+
 const char *flashPartitionGetTypeName(flashPartitionType_e type)
 {
     if (type < ARRAYLEN(flashPartitionNames)) {
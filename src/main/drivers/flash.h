@@ -42,6 +42,16 @@ typedef struct flashGeometry_s {
     flashType_e flashType;
 } flashGeometry_t;
 
+typedef struct flashHealth_s {
+    uint16_t badBlocks;         // Bad blocks that could not be replaced, the data in them is lost
+    uint16_t remappedBlocks;    // Blocks swapped for a spare
+    uint16_t spareBlocks;       // Replacements still available
+    uint32_t eccCorrected;      // Page reads the ECC had to correct
+    uint32_t eccUncorrectable;  // Page reads with errors the ECC could not correct
+    uint16_t programFailures;
+    uint16_t eraseFailures;
+} flashHealth_t;
+
 typedef struct
 {
     bool (*init)(int flashNumToUse);
@@ -53,6 +63,7 @@ typedef struct
     int (*readBytes)(uint32_t address, uint8_t *buffer, int length);
     void (*flush)(void);
     const flashGeometry_t *(*getGeometry)(void);
+    void (*getHealth)(flashHealth_t *health);
 } flashDriver_t;
 
 bool flashInit(void);
@@ -65,6 +76,7 @@ uint32_t flashPageProgram(uint32_t address, const uint8_t *data, int length);
 int flashReadBytes(uint32_t address, uint8_t *buffer, int length);
 void flashFlush(void);
 const flashGeometry_t *flashGetGeometry(void);
+bool flashGetHealth(flashHealth_t *health);
 
 //
 // flash partitioning api
@@ -90,6 +102,9 @@ typedef enum {
     FLASH_PARTITION_TYPE_FULL_BACKUP,
     FLASH_PARTITION_TYPE_FIRMWARE_UPDATE_META,
     FLASH_PARTITION_TYPE_UPDATE_FIRMWARE,
+    FLASH_PARTITION_TYPE_MISSION,
+    FLASH_PARTITION_TYPE_TERRAIN,
+    FLASH_PARTITION_TYPE_FLASHFS_INDEX,
     FLASH_MAX_PARTITIONS
 } flashPartitionType_e;
 
@@ -25,12 +25,15 @@
 
 #ifdef USE_FLASH_W25N01G
 
+#include "common/bitarray.h"
+#include "common/maths.h"
+
 #include "drivers/bus.h"
 #include "drivers/io.h"
 #include "drivers/time.h"
 
 #include "flash_w25n01g.h"
-     
+
 // Device size parameters
 #define W25N01G_PAGE_SIZE       2048
 #define W25N01G_PAGES_PER_BLOCK 64
@@ -110,6 +113,10 @@
 #define W25N01G_BLOCK_TO_PAGE(block) ((block) * W25N01G_PAGES_PER_BLOCK)
 #define W25N01G_BLOCK_TO_LINEAR(block) (W25N01G_BLOCK_TO_PAGE(block) * W25N01G_PAGE_SIZE)
 
+#define W25N01G_SPARE_AREA_COLUMN       W25N01G_PAGE_SIZE
+#define W25N01G_BB_GOOD_BLOCK_MARKER    0xFF
+#define W25N01G_NO_BLOCK                0xFFFF
+
 // IMPORTANT: Timeout values are currently required to be set to the highest value required by any of the supported flash chips by this driver
 // The timeout values (2ms minimum to avoid 1 tick advance in consecutive calls to millis).
 #define W25N01G_TIMEOUT_PAGE_READ_MS        2   // tREmax = 60us (ECC enabled)
@@ -137,6 +144,37 @@ static bool couldBeBusy = false;
 
 static timeMs_t timeoutAt = 0;
 
+// Status register 3 as seen by the last poll
+static uint8_t lastStatus = 0;
+
+static uint32_t currentPage = UINT32_MAX;
+
+bool bufferDirty = false;
+bool isProgramming = false;
+static uint32_t programStartAddress;
+static uint32_t programLoadAddress;
+
+typedef enum {
+    W25N01G_OP_NONE = 0,
+    W25N01G_OP_PROGRAM,
+    W25N01G_OP_ERASE,
+} w25n01gOperation_e;
+
+/*
+ * Bad block management. Blocks carrying a factory bad block marker and blocks that failed to program or erase
+ * are swapped for a block of the replacement area through the chip's BB LUT. The chip then redirects every
+ * access to the bad block on its own, flashfs keeps addressing the same logical block.
+ */
+static struct {
+    w25n01gOperation_e pendingOp;       // Program or erase whose outcome the next idle status tells
+    uint16_t pendingBlock;
+    uint16_t eraseFailedBlock;          // Erased before programming it after it has been replaced
+    uint8_t lutEntries;
+    BITARRAY_DECLARE(unavailableReplacements, W25N01G_BB_REPLACEMENT_BLOCKS);   // In the LUT already or bad
+    BITARRAY_DECLARE(failedBlocks, W25N01G_BB_MANAGEMENT_START_BLOCK);          // Replaced on their next erase
+    flashHealth_t health;
+} bbm;
+
 static bool w25n01g_waitForReadyInternal(void);
 
 static void w25n01g_setTimeout(timeMs_t timeoutMillis)
@@ -190,13 +228,42 @@ static void w25n01g_deviceReset(void)
     w25n01g_writeRegister(W25N01G_CONF_REG, W25N01G_CONFIG_ECC_ENABLE | W25N01G_CONFIG_BUFFER_READ_MODE);
 }
 
+static void w25n01g_checkOperationStatus(uint8_t status)
+{
+    if (bbm.pendingOp == W25N01G_OP_PROGRAM && (status & W25N01G_STATUS_PROGRAM_FAIL)) {
+        bbm.health.programFailures++;
+        bitArraySet(bbm.failedBlocks, bbm.pendingBlock);
+    } else if (bbm.pendingOp == W25N01G_OP_ERASE && (status & W25N01G_STATUS_ERASE_FAIL)) {
+        bbm.health.eraseFailures++;
+        bitArraySet(bbm.failedBlocks, bbm.pendingBlock);
+        bbm.eraseFailedBlock = bbm.pendingBlock;
+    }
+
+    bbm.pendingOp = W25N01G_OP_NONE;
+}
+
+static void w25n01g_setPendingOperation(w25n01gOperation_e op, uint32_t page)
+{
+    const uint16_t block = page / W25N01G_PAGES_PER_BLOCK;
+
+    // Failures in the replacement area land there through remapped blocks, there is nothing left to swap them for
+    bbm.pendingOp = block < W25N01G_BB_MANAGEMENT_START_BLOCK ? op : W25N01G_OP_NONE;
+    bbm.pendingBlock = block;
+}
+
 bool w25n01g_isReady(void)
 {
     uint8_t status = w25n01g_readRegister(W25N01G_STAT_REG);
+    lastStatus = status;
 
     // If couldBeBusy is false, don't bother to poll the flash chip for its status
     couldBeBusy = couldBeBusy && ((status & W25N01G_STATUS_FLAG_BUSY) != 0);
 
+    // P-FAIL and E-FAIL stay valid until the next program or erase starts
+    if (!couldBeBusy && bbm.pendingOp != W25N01G_OP_NONE) {
+        w25n01g_checkOperationStatus(status);
+    }
+
     return !couldBeBusy;
 }
 
@@ -230,6 +297,168 @@ static void w25n01g_writeEnable(void)
     couldBeBusy = true;
 }
 
+/*
+ * Load a page into the data buffer. A partially loaded program buffer is written out first, the page read
+ * would overwrite it otherwise. Returns the ECC status of the page.
+ */
+static bool w25n01g_loadPage(uint32_t page, uint8_t *eccCode)
+{
+    if (bufferDirty) {
+        w25n01g_flush();
+    }
+
+    if (!w25n01g_waitForReadyInternal()) {
+        return false;
+    }
+
+    currentPage = UINT32_MAX;
+    w25n01g_performCommandWithPageAddress(W25N01G_INSTRUCTION_PAGE_DATA_READ, page);
+    if (!w25n01g_waitForReady(W25N01G_TIMEOUT_PAGE_READ_MS)) {
+        return false;
+    }
+    currentPage = page;
+
+    *eccCode = W25N01G_STATUS_FLAG_ECC(lastStatus);
+    return true;
+}
+
+static int w25n01g_readExtensionBytes(uint32_t address, uint8_t *buffer, int length)
+{
+    const uint32_t targetPage = W25N01G_LINEAR_TO_PAGE(address);
+    uint8_t eccCode;
+
+    if (currentPage != targetPage && !w25n01g_loadPage(targetPage, &eccCode)) {
+        return 0;
+    }
+
+    const uint8_t cmd[4] = {W25N01G_INSTRUCTION_READ_DATA, (W25N01G_SPARE_AREA_COLUMN >> 8) & 0xff, W25N01G_SPARE_AREA_COLUMN & 0xff, 0};
+
+    busTransferDescriptor_t readDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = length, .rxBuf = buffer, .txBuf = NULL}};
+    busTransferMultiple(busDev, readDescr, ARRAYLEN(readDescr));
+
+    return length;
+}
+
+// Reads the physical block, unless it is in the BB LUT
+static bool w25n01g_isBlockMarkedBad(uint16_t block)
+{
+    uint8_t marker;
+
+    if (w25n01g_readExtensionBytes(W25N01G_BLOCK_TO_LINEAR(block), &marker, 1) != 1) {
+        return false;
+    }
+
+    return marker != W25N01G_BB_GOOD_BLOCK_MARKER;
+}
+
+static void w25n01g_updateSpareCount(void)
+{
+    uint16_t available = 0;
+    for (int i = 0; i < W25N01G_BB_REPLACEMENT_BLOCKS; i++) {
+        if (!bitArrayGet(bbm.unavailableReplacements, i)) {
+            available++;
+        }
+    }
+
+    bbm.health.remappedBlocks = bbm.lutEntries;
+    bbm.health.spareBlocks = MIN(available, W25N01G_BBLUT_TABLE_ENTRY_COUNT - bbm.lutEntries);
+}
+
+static void w25n01g_readBBLUT(void)
+{
+    const uint8_t cmd[2] = { W25N01G_INSTRUCTION_READ_BBM_LUT, 0 };    // 8 dummy clocks
+    uint8_t lut[W25N01G_BBLUT_TABLE_ENTRY_COUNT * W25N01G_BBLUT_TABLE_ENTRY_SIZE];
+
+    w25n01g_waitForReadyInternal();
+
+    busTransferDescriptor_t readDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = sizeof(lut), .rxBuf = lut, .txBuf = NULL}};
+    busTransferMultiple(busDev, readDescr, ARRAYLEN(readDescr));
+
+    bbm.lutEntries = 0;
+    for (int i = 0; i < W25N01G_BBLUT_TABLE_ENTRY_COUNT; i++) {
+        const uint8_t *entry = &lut[i * W25N01G_BBLUT_TABLE_ENTRY_SIZE];
+        const uint16_t lba = (entry[0] << 8) | entry[1];
+        const uint16_t pba = ((entry[2] << 8) | entry[3]) & ~W25N01G_BBLUT_STATUS_MASK;
+
+        if (lba & W25N01G_BBLUT_STATUS_ENABLED) {
+            bbm.lutEntries++;
+            if (pba >= W25N01G_BB_REPLACEMENT_START_BLOCK && pba < W25N01G_BLOCKS_PER_DIE) {
+                bitArraySet(bbm.unavailableReplacements, pba - W25N01G_BB_REPLACEMENT_START_BLOCK);
+            }
+        }
+    }
+}
+
+/*
+ * Redirect the block to the next good replacement block. The LUT is non-volatile, a block is swapped only once.
+ */
+static bool w25n01g_remapBlock(uint16_t block)
+{
+    for (int i = 0; i < W25N01G_BB_REPLACEMENT_BLOCKS && bbm.lutEntries < W25N01G_BBLUT_TABLE_ENTRY_COUNT; i++) {
+        if (bitArrayGet(bbm.unavailableReplacements, i)) {
+            continue;
+        }
+
+        const uint16_t replacement = W25N01G_BB_REPLACEMENT_START_BLOCK + i;
+        const uint8_t cmd[5] = { W25N01G_INSTRUCTION_BB_MANAGEMENT, block >> 8, block & 0xff, replacement >> 8, replacement & 0xff };
+
+        w25n01g_waitForReadyInternal();
+        w25n01g_writeEnable();
+        busTransfer(busDev, NULL, cmd, sizeof(cmd));
+        w25n01g_setTimeout(W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
+        w25n01g_waitForReadyInternal();
+
+        // The buffered page may belong to the block just redirected
+        currentPage = UINT32_MAX;
+
+        bitArraySet(bbm.unavailableReplacements, i);
+        bbm.lutEntries++;
+        w25n01g_updateSpareCount();
+        return true;
+    }
+
+    return false;
+}
+
+static bool w25n01g_replaceBlock(uint16_t block)
+{
+    bitArrayClr(bbm.failedBlocks, block);
+
+    if (w25n01g_remapBlock(block)) {
+        return true;
+    }
+
+    bbm.health.badBlocks++;
+    return false;
+}
+
+/*
+ * Swap every block with a factory bad block marker that is not in the LUT yet. Remapped blocks read back
+ * through their replacement, the scan finds them good.
+ */
+static void w25n01g_scanBadBlocks(void)
+{
+    bbm.eraseFailedBlock = W25N01G_NO_BLOCK;
+
+    w25n01g_readBBLUT();
+
+    for (int i = 0; i < W25N01G_BB_REPLACEMENT_BLOCKS; i++) {
+        if (!bitArrayGet(bbm.unavailableReplacements, i) && w25n01g_isBlockMarkedBad(W25N01G_BB_REPLACEMENT_START_BLOCK + i)) {
+            bitArraySet(bbm.unavailableReplacements, i);
+        }
+    }
+    w25n01g_updateSpareCount();
+
+    for (uint16_t block = 0; block < W25N01G_BB_MANAGEMENT_START_BLOCK; block++) {
+        if (w25n01g_isBlockMarkedBad(block) && w25n01g_replaceBlock(block)) {
+            // Nothing says what the replacement holds, flashfs expects it erased past the end of the data
+            w25n01g_eraseSector(W25N01G_BLOCK_TO_LINEAR(block));
+        }
+    }
+
+    w25n01g_waitForReadyInternal();
+}
+
 bool w25n01g_detect(uint32_t chipID)
 {
     switch (chipID) {
@@ -252,24 +481,25 @@ bool w25n01g_detect(uint32_t chipID)
     geometry.sectorSize = geometry.pagesPerSector * geometry.pageSize;
     geometry.totalSize = geometry.sectorSize * geometry.sectors;
     
-    /*flashPartitionSet(FLASH_PARTITION_TYPE_BADBLOCK_MANAGEMENT,
+    flashPartitionSet(FLASH_PARTITION_TYPE_BADBLOCK_MANAGEMENT,
             W25N01G_BB_MANAGEMENT_START_BLOCK,
-            W25N01G_BB_MANAGEMENT_START_BLOCK + W25N01G_BB_MANAGEMENT_BLOCKS - 1);*/
+            W25N01G_BB_MANAGEMENT_START_BLOCK + W25N01G_BB_MANAGEMENT_BLOCKS - 1);
 
     couldBeBusy = true; // Just for luck we'll assume the chip could be busy even though it isn't specced to be
 
     w25n01g_deviceReset();
 
-    // Upper 4MB (32 blocks * 128KB/block) will be used for bad block replacement area.
+    w25n01g_scanBadBlocks();
+
+    // Upper 20 blocks (2.5MB) are used as bad block replacement area.
     // Blocks in this area are only written through bad block LUT,
     // and factory written bad block marker in unused blocks are retained.
     // When a replacement block is required,
-    // (1) "Read BB LUT" command is used to obtain the last block mapped,
-    // (2) blocks after the last block is scanned for a good block,
-    // (3) the first good block is used for replacement, and the BB LUT is updated.
-    // There are only 20 BB LUT entries, and there are 32 replacement blocks.
-    // There will be a least chance of running out of replacement blocks.
-    // If it ever run out, the device becomes unusable.
+    // (1) "Read BB LUT" command at boot tells the replacement blocks already mapped,
+    // (2) the first unmapped replacement block without a bad block marker is picked,
+    // (3) the BB LUT is updated through "Bad Block Management".
+    // There are 20 BB LUT entries and 20 replacement blocks.
+    // Once they run out, further bad blocks are only counted in the health report.
 
     return true;
 }
@@ -279,10 +509,19 @@ bool w25n01g_detect(uint32_t chipID)
  */
 void w25n01g_eraseSector(uint32_t address)
 {
+    const uint16_t block = W25N01G_LINEAR_TO_BLOCK(address);
+
     w25n01g_waitForReadyInternal();
+
+    // A block that failed earlier has lost its content by now, swap it before it takes new data
+    if (block < W25N01G_BB_MANAGEMENT_START_BLOCK && bitArrayGet(bbm.failedBlocks, block)) {
+        w25n01g_replaceBlock(block);
+    }
+
     w25n01g_writeEnable();
     w25n01g_performCommandWithPageAddress(W25N01G_INSTRUCTION_BLOCK_ERASE, W25N01G_LINEAR_TO_PAGE(address));
     w25n01g_setTimeout(W25N01G_TIMEOUT_BLOCK_ERASE_MS);
+    w25n01g_setPendingOperation(W25N01G_OP_ERASE, W25N01G_LINEAR_TO_PAGE(address));
 }
 
 // W25N01G does not support full chip erase.
@@ -323,6 +562,7 @@ static void w25n01g_programExecute(uint32_t pageAddress)
     w25n01g_waitForReadyInternal();
     w25n01g_performCommandWithPageAddress(W25N01G_INSTRUCTION_PROGRAM_EXECUTE, pageAddress);
     w25n01g_setTimeout(W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
+    w25n01g_setPendingOperation(W25N01G_OP_PROGRAM, pageAddress);
 }
 
 // Writes are done in three steps:
@@ -352,12 +592,6 @@ pageProgramFinish:
 Observe programLoadAddress. If it's on page boundary, issue PAGE_PROGRAM_EXECUTE and clear dirty, else just return.
 If pageProgramContinue observes the page boundary, then do nothing(?).
 */
-bool bufferDirty = false;
-bool isProgramming = false;
-static uint32_t programStartAddress;
-static uint32_t programLoadAddress;
-static uint32_t currentPage = UINT32_MAX;
-
 void w25n01g_pageProgramBegin(uint32_t address)
 {
     if (bufferDirty) {
@@ -372,6 +606,20 @@ void w25n01g_pageProgramBegin(uint32_t address)
     } else {
         programStartAddress = programLoadAddress = address;
     }
+
+    // The erase ahead of this write has to have worked, retry it on a replacement block otherwise
+    if (bbm.pendingOp == W25N01G_OP_ERASE) {
+        w25n01g_waitForReadyInternal();
+    }
+
+    const uint16_t block = W25N01G_LINEAR_TO_BLOCK(address);
+    if (block == bbm.eraseFailedBlock) {
+        bbm.eraseFailedBlock = W25N01G_NO_BLOCK;
+        if (w25n01g_replaceBlock(block)) {
+            w25n01g_eraseSector(W25N01G_BLOCK_TO_LINEAR(block));
+            w25n01g_waitForReadyInternal();
+        }
+    }
 }
 
 void w25n01g_pageProgramContinue(const uint8_t *data, int length)
@@ -437,10 +685,24 @@ void w25n01g_flush(void)
     }
 }
 
-void w25n01g_addError(uint32_t address, uint8_t code)
+static void w25n01g_addError(uint32_t page, uint8_t code)
 {
-    UNUSED(address);
-    UNUSED(code);
+    switch (code) {
+    case 0: // Successful read, no ECC correction
+        break;
+
+    case 1: // Successful read with ECC correction
+        bbm.health.eccCorrected++;
+        break;
+
+    case 2: // Uncorrectable ECC in a single page
+    case 3: // Uncorrectable ECC in multiple pages
+        bbm.health.eccUncorrectable++;
+        if (page / W25N01G_PAGES_PER_BLOCK < W25N01G_BB_MANAGEMENT_START_BLOCK) {
+            bitArraySet(bbm.failedBlocks, page / W25N01G_PAGES_PER_BLOCK);
+        }
+        break;
+    }
 }
 
 /*
@@ -465,16 +727,13 @@ int w25n01g_readBytes(uint32_t address, uint8_t *buffer, int length)
 {
     uint32_t targetPage = W25N01G_LINEAR_TO_PAGE(address);
 
+    // The ECC status belongs to the page read out of the array, check it once per page
     if (currentPage != targetPage) {
-        if (!w25n01g_waitForReadyInternal()) {
-            return 0;
-        }
-        currentPage = UINT32_MAX;
-        w25n01g_performCommandWithPageAddress(W25N01G_INSTRUCTION_PAGE_DATA_READ, targetPage);
-        if (!w25n01g_waitForReady(W25N01G_TIMEOUT_PAGE_READ_MS)) {
+        uint8_t eccCode;
+        if (!w25n01g_loadPage(targetPage, &eccCode)) {
             return 0;
         }
-        currentPage = targetPage;
+        w25n01g_addError(targetPage, eccCode);
     }
 
     uint16_t column = W25N01G_LINEAR_TO_COLUMN(address);
@@ -491,52 +750,9 @@ int w25n01g_readBytes(uint32_t address, uint8_t *buffer, int length)
     busTransferDescriptor_t readDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = transferLength, .rxBuf = buffer, .txBuf = NULL}};
     busTransferMultiple(busDev, readDescr, ARRAYLEN(readDescr));
 
-    if (!w25n01g_waitForReady(W25N01G_TIMEOUT_PAGE_READ_MS)) {
-        return 0;
-    }
-
-    // Check ECC
-    uint8_t statReg = w25n01g_readRegister(W25N01G_STAT_REG);
-    uint8_t eccCode = W25N01G_STATUS_FLAG_ECC(statReg);
-    switch (eccCode) {
-    case 0: // Successful read, no ECC correction
-        break;
-
-    case 1: // Successful read with ECC correction
-    case 2: // Uncorrectable ECC in a single page
-    case 3: // Uncorrectable ECC in multiple pages
-        w25n01g_addError(address, eccCode);
-        w25n01g_deviceReset();
-        break;
-    }
-
     return transferLength;
 }
 
-int w25n01g_readExtensionBytes(uint32_t address, uint8_t *buffer, int length)
-{
-    if (!w25n01g_waitForReadyInternal()) {
-        return 0;
-    }
-
-    w25n01g_performCommandWithPageAddress(W25N01G_INSTRUCTION_PAGE_DATA_READ, W25N01G_LINEAR_TO_PAGE(address));
-
-    uint32_t column = 2048;
-
-    uint8_t cmd[4];
-    cmd[0] = W25N01G_INSTRUCTION_READ_DATA;
-    cmd[1] = (column >> 8) & 0xff;
-    cmd[2] = (column >> 0) & 0xff;
-    cmd[3] = 0;
-
-    busTransferDescriptor_t readDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = length, .rxBuf = buffer, .txBuf = NULL}};
-    busTransferMultiple(busDev, readDescr, ARRAYLEN(readDescr));
-
-    w25n01g_setTimeout(W25N01G_TIMEOUT_PAGE_READ_MS);
-
-    return length;
-}
-
 /**
  * Fetch information about the detected flash chip layout.
  *
@@ -547,6 +763,11 @@ const flashGeometry_t* w25n01g_getGeometry(void)
     return &geometry;
 }
 
+void w25n01g_getHealth(flashHealth_t *health)
+{
+    *health = bbm.health;
+}
+
 bool w25n01g_init(int flashNumToUse) 
 {
     busDev = busDeviceInit(BUSTYPE_SPI, DEVHW_W25N01G, flashNumToUse, OWNER_FLASH);
@@ -38,4 +38,5 @@ int w25n01g_readBytes(uint32_t address, uint8_t *buffer, int length);
 bool w25n01g_isReady(void);
 bool w25n01g_waitForReady(timeMs_t timeoutMillis);
 
-const flashGeometry_t* w25n01g_getGeometry(void);
\ No newline at end of file
+const flashGeometry_t* w25n01g_getGeometry(void);
+void w25n01g_getHealth(flashHealth_t *health);
\ No newline at end of file
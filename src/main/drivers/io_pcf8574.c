@@ -33,6 +33,7 @@
 #define PCF8574_READ_ADDRESS 0x41
 
 static busDevice_t *busDev;
+static uint8_t asyncWriteData;     // Stays valid while a background write is running
 
 static bool deviceDetect(busDevice_t *busDev)
 {
@@ -76,6 +77,18 @@ void pcf8574Write(uint8_t data)
     busWrite(busDev, PCF8574_WRITE_ADDRESS, data);
 }
 
+// Start a background write, its result is collected with pcf8574WritePoll()
+bool pcf8574WriteAsync(uint8_t data)
+{
+    asyncWriteData = data;
+    return busWriteBufAsync(busDev, PCF8574_WRITE_ADDRESS, &asyncWriteData, 1);
+}
+
+busAsyncState_e pcf8574WritePoll(void)
+{
+    return busAsyncPoll(busDev);
+}
+
 uint8_t pcf8574Read(void)
 {
     uint8_t data;
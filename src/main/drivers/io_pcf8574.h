@@ -24,6 +24,10 @@
 
 #pragma once
 
+#include "drivers/bus.h"
+
 bool pcf8574Init(void);
 void pcf8574Write(uint8_t data);
+bool pcf8574WriteAsync(uint8_t data);
+busAsyncState_e pcf8574WritePoll(void);
 uint8_t pcf8574Read(void);
\ No newline at end of file
@@ -38,6 +38,7 @@ void ioPortExpanderInit(void)
 
     if (ioPortExpanderState.active) {
         ioPortExpanderState.state = 0x00;
+        ioPortExpanderState.written = 0x00;
         pcf8574Write(ioPortExpanderState.state); //Set all ports to OFF
     }
 
@@ -53,14 +54,31 @@ void ioPortExpanderSet(uint8_t pin, uint8_t value)
     value = (bool) value;
 
     ioPortExpanderState.state ^= (-value ^ ioPortExpanderState.state) & (1UL << pin);
-    ioPortExpanderState.shouldSync = true;
 }
 
 void ioPortExpanderSync(void)
 {
-    if (ioPortExpanderState.active && ioPortExpanderState.shouldSync) {
-        pcf8574Write(ioPortExpanderState.state);
-        ioPortExpanderState.shouldSync = false;
+    if (!ioPortExpanderState.active) {
+        return;
+    }
+
+    if (ioPortExpanderState.writing) {
+        const busAsyncState_e asyncState = pcf8574WritePoll();
+        if (asyncState == BUS_ASYNC_QUEUED || asyncState == BUS_ASYNC_ACTIVE) {
+            return;
+        }
+
+        // A failed write leaves its pins dirty and is retried
+        ioPortExpanderState.writing = false;
+        if (asyncState == BUS_ASYNC_DONE) {
+            ioPortExpanderState.written = ioPortExpanderState.pending;
+        }
+    }
+
+    // Only pins that changed make a transfer, retry next time if the bus is busy
+    if ((ioPortExpanderState.state ^ ioPortExpanderState.written) && pcf8574WriteAsync(ioPortExpanderState.state)) {
+        ioPortExpanderState.pending = ioPortExpanderState.state;
+        ioPortExpanderState.writing = true;
     }
 }
 
@@ -28,8 +28,10 @@
 
 typedef struct ioPortExpanderState_s {
     uint8_t active;
-    uint8_t state;
-    uint8_t shouldSync;
+    uint8_t state;          // Requested pin states
+    uint8_t written;        // Pin states on the expander, pins in state ^ written are dirty
+    uint8_t writing;        // A background write of pending is running
+    uint8_t pending;
 } ioPortExpanderState_t;
 
 void ioPortExpanderInit(void);
@@ -37,6 +37,7 @@
 
 #include "common/color.h"
 #include "common/colorconversion.h"
+#include "common/utils.h"
 
 #include "drivers/dma.h"
 #include "drivers/io.h"
@@ -47,17 +48,36 @@
 #define WS2811_BIT_COMPARE_1 ((WS2811_PERIOD * 2) / 3)
 #define WS2811_BIT_COMPARE_0 (WS2811_PERIOD / 3)
 
-static DMA_RAM timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
+#define WS2811_DMA_BUFFER_COUNT 2
+#define WS2811_ALL_LEDS_MASK ((uint32_t)((1ULL << WS2811_LED_STRIP_LENGTH) - 1))
+
+typedef uint32_t ledMask_t;
+STATIC_ASSERT(WS2811_LED_STRIP_LENGTH <= sizeof(ledMask_t) * 8, ws2811_led_mask_too_small);
+
+// Double buffered: the next frame is encoded into one buffer while the other one is being sent
+static DMA_RAM timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_COUNT][WS2811_DMA_BUFFER_SIZE];
 
 static IO_t ws2811IO = IO_NONE;
 static TCH_t * ws2811TCH = NULL;
 static bool ws2811Initialised = false;
+static bool ws2811GammaCorrection = false;
 
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
+static hsvColor_t ledFrameColor[WS2811_LED_STRIP_LENGTH];       // Colors of the last frame handed to DMA
+static ledMask_t ledDirtyMask;                                  // LEDs written since the last frame
+static ledMask_t ledStaleMask[WS2811_DMA_BUFFER_COUNT];         // LEDs whose encoding in the buffer is outdated
+static uint8_t ledTxBuffer;                                     // Buffer last handed to DMA
+static bool ledTxPending;                                       // The other buffer holds a frame waiting for DMA
+
+static bool hsvColorEqual(const hsvColor_t *a, const hsvColor_t *b)
+{
+    return a->h == b->h && a->s == b->s && a->v == b->v;
+}
 
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
     ledColorBuffer[index] = *color;
+    ledDirtyMask |= 1U << index;
 }
 
 void getLedHsv(uint16_t index, hsvColor_t *color)
@@ -68,11 +88,13 @@ void getLedHsv(uint16_t index, hsvColor_t *color)
 void setLedValue(uint16_t index, const uint8_t value)
 {
     ledColorBuffer[index].v = value;
+    ledDirtyMask |= 1U << index;
 }
 
 void scaleLedValue(uint16_t index, const uint8_t scalePercent)
 {
     ledColorBuffer[index].v = ((uint16_t)ledColorBuffer[index].v * scalePercent / 100);
+    ledDirtyMask |= 1U << index;
 }
 
 void setStripColor(const hsvColor_t *color)
@@ -115,13 +137,18 @@ void ws2811LedStripInit(void)
     timerPWMConfigChannel(ws2811TCH, 0);
 
     // If DMA failed - abort
-    if (!timerPWMConfigChannelDMA(ws2811TCH, ledStripDMABuffer, sizeof(ledStripDMABuffer[0]), WS2811_DMA_BUFFER_SIZE)) {
+    if (!timerPWMConfigChannelDMA(ws2811TCH, ledStripDMABuffer[0], sizeof(ledStripDMABuffer[0][0]), WS2811_DMA_BUFFER_SIZE)) {
         ws2811Initialised = false;
         return;
     }
 
-    // Zero out DMA buffer
+    // Zero out DMA buffers, force a full encode of the first frame
     memset(&ledStripDMABuffer, 0, sizeof(ledStripDMABuffer));
+    memset(&ledFrameColor, 0xFF, sizeof(ledFrameColor));
+    ledDirtyMask = WS2811_ALL_LEDS_MASK;
+    ledStaleMask[0] = ledStaleMask[1] = WS2811_ALL_LEDS_MASK;
+    ledTxBuffer = 0;
+    ledTxPending = false;
     ws2811Initialised = true;
 
     ws2811UpdateStrip();
@@ -132,50 +159,83 @@ bool isWS2811LedStripReady(void)
     return !timerPWMDMAInProgress(ws2811TCH);
 }
 
-STATIC_UNIT_TESTED uint16_t dmaBufferOffset;
-static int16_t ledIndex;
-
-STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
+STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(timerDMASafeType_t *dmaBuffer, rgbColor24bpp_t *color)
 {
     uint32_t grb = (color->rgb.g << 16) | (color->rgb.r << 8) | (color->rgb.b);
 
     for (int8_t index = 23; index >= 0; index--) {
-        ledStripDMABuffer[dmaBufferOffset++] = (grb & (1 << index)) ? WS2811_BIT_COMPARE_1 : WS2811_BIT_COMPARE_0;
+        *dmaBuffer++ = (grb & (1 << index)) ? WS2811_BIT_COMPARE_1 : WS2811_BIT_COMPARE_0;
     }
 }
 
-/*
- * This method is non-blocking unless an existing LED update is in progress.
- * it does not wait until all the LEDs have been updated, that happens in the background.
- */
-void ws2811UpdateStrip(void)
+void ws2811LedStripSetGammaCorrection(bool enabled)
 {
-    static rgbColor24bpp_t *rgb24;
+    if (enabled != ws2811GammaCorrection) {
+        ws2811GammaCorrection = enabled;
 
-    // don't wait - risk of infinite block, just get an update next time round
-    if (timerPWMDMAInProgress(ws2811TCH)) {
-        return;
+        // Every LED encoding changes, force a full frame
+        memset(&ledFrameColor, 0xFF, sizeof(ledFrameColor));
+        ledDirtyMask = WS2811_ALL_LEDS_MASK;
     }
+}
 
-    dmaBufferOffset = 0;                // reset buffer memory index
-    ledIndex = 0;                       // reset led index
+static void ws2811StartTransfer(uint8_t buffer)
+{
+    timerPWMSetDMABuffer(ws2811TCH, ledStripDMABuffer[buffer]);
+    timerPWMPrepareDMA(ws2811TCH, WS2811_DMA_BUFFER_SIZE);
+    timerPWMStartDMA(ws2811TCH);
 
-    // fill transmit buffer with correct compare values to achieve
-    // correct pulse widths according to color values
-    while (ledIndex < WS2811_LED_STRIP_LENGTH)
-    {
-        rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
-        fastUpdateLEDDMABuffer(rgb24);
-        ledIndex++;
-    }
+    ledTxBuffer = buffer;
+    ledTxPending = false;
+}
 
-    // Initiate hardware transfer
+/*
+ * This method is non-blocking. Only LEDs that changed since the last frame are
+ * re-encoded, into the buffer which is not being sent. An identical frame is not
+ * sent at all. If DMA is still busy the frame is sent on the next call.
+ */
+void ws2811UpdateStrip(void)
+{
     if (!ws2811Initialised || !ws2811TCH) {
         return;
     }
 
-    timerPWMPrepareDMA(ws2811TCH, WS2811_DMA_BUFFER_SIZE);
-    timerPWMStartDMA(ws2811TCH);
+    const bool dmaBusy = timerPWMDMAInProgress(ws2811TCH);
+    const uint8_t backBuffer = ledTxBuffer ^ 1;
+
+    // Find LEDs which actually differ from the last frame
+    ledMask_t changedMask = 0;
+    for (ledMask_t dirty = ledDirtyMask; dirty; dirty &= dirty - 1) {
+        const int ledIndex = __builtin_ctz(dirty);
+        if (!hsvColorEqual(&ledColorBuffer[ledIndex], &ledFrameColor[ledIndex])) {
+            ledFrameColor[ledIndex] = ledColorBuffer[ledIndex];
+            changedMask |= 1U << ledIndex;
+        }
+    }
+    ledDirtyMask = 0;
+
+    if (changedMask) {
+        ledStaleMask[0] |= changedMask;
+        ledStaleMask[1] |= changedMask;
+
+        // fill transmit buffer with correct compare values to achieve
+        // correct pulse widths according to color values
+        for (ledMask_t stale = ledStaleMask[backBuffer]; stale; stale &= stale - 1) {
+            const int ledIndex = __builtin_ctz(stale);
+            rgbColor24bpp_t *rgb24 = hsvToRgb24(&ledFrameColor[ledIndex]);
+            if (ws2811GammaCorrection) {
+                rgb24ApplyGamma(rgb24);
+            }
+            fastUpdateLEDDMABuffer(&ledStripDMABuffer[backBuffer][ledIndex * WS2811_BITS_PER_LED], rgb24);
+        }
+        ledStaleMask[backBuffer] = 0;
+        ledTxPending = true;
+    }
+
+    // don't wait - risk of infinite block, the frame goes out next time round
+    if (ledTxPending && !dmaBusy) {
+        ws2811StartTransfer(backBuffer);
+    }
 }
 
 #endif
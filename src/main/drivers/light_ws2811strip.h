@@ -33,6 +33,7 @@ void ws2811LedStripInit(void);
 void ws2811LedStripHardwareInit(void);
 void ws2811LedStripDMAEnable(void);
 bool ws2811LedStripDMAInProgress(void);
+void ws2811LedStripSetGammaCorrection(bool enabled);
 
 void ws2811UpdateStrip(void);
 
@@ -196,6 +196,14 @@ static BITARRAY_DECLARE(screenIsDirty, MAX7456_BUFFER_CHARS_PAL);
 #define MAX_CHARS2UPDATE        10
 #define BYTES_PER_CHAR2UPDATE   (7 * 2) // SPI regs + values for them
 
+// Runs of dirty chars with the same attributes are sent in auto-increment
+// mode, which needs the address only once and then 2 bytes per char.
+// DMM, DMAH, DMAL before the chars plus the 0xFF terminator and restoring DMM
+// after them, it pays off from 3 chars on.
+#define BYTES_PER_BURST         (5 * 2)
+#define MIN_CHARS_PER_BURST     3
+#define CHAR_BURST_END          0xFF
+
 typedef struct max7456Registers_s {
     uint8_t vm0;
     uint8_t dmm;
@@ -487,16 +495,57 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff, uint8_t mode)
 
 // Must be called with the lock held. Returns whether any new characters
 // were drawn.
+// Returns how many dirty chars starting at pos can be sent as a burst with
+// the same attributes as the one at pos, up to maxCount.
+static unsigned max7456DirtyRunLength(size_t pos, unsigned maxCount)
+{
+    const uint16_t first = osdCharacterGridBuffer[pos];
+    unsigned count = 0;
+
+    if (CHAR_MODE_IS_EXT(MODE_BYTE(first))) {
+        return 0;
+    }
+
+    while (count < maxCount && pos + count < ARRAYLEN(osdCharacterGridBuffer) && bitArrayGet(screenIsDirty, pos + count)) {
+        const uint16_t val = osdCharacterGridBuffer[pos + count];
+        // 0xFF ends auto-increment mode, it can't be sent as a char
+        if (MODE_BYTE(val) != MODE_BYTE(first) || CHAR_BYTE(val) == CHAR_BURST_END) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+// Returns the buffer position after the burst
+static int max7456PrepareBurst(uint8_t *spiBuff, size_t bufsize, int bufPtr, size_t pos, unsigned count)
+{
+    const uint8_t charMode = MODE_BYTE(osdCharacterGridBuffer[pos]);
+
+    state.registers.dmm = (state.registers.dmm & ~(DMM_8BIT_MODE | DMM_CHAR_MODE_MASK)) | charMode;
+    bufPtr = max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMM, state.registers.dmm | DMM_AUTOINCREMENT);
+    bufPtr = max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMAH, pos >> 8);
+    bufPtr = max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMAL, pos & 0xff);
+
+    for (unsigned ii = 0; ii < count; ii++) {
+        bufPtr = max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMDI, CHAR_BYTE(osdCharacterGridBuffer[pos + ii]));
+        bitArrayClr(screenIsDirty, pos + ii);
+    }
+
+    bufPtr = max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMDI, CHAR_BURST_END);
+    return max7456PrepareBuffer(spiBuff, bufsize, bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+}
+
 static bool max7456DrawScreenPartial(void)
 {
     uint8_t spiBuff[MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE];
     int bufPtr = 0;
     size_t pos;
-    uint_fast16_t updatedCharCount;
     uint8_t charMode;
     int next;
 
-    for (pos = 0, updatedCharCount = 0; pos < ARRAYLEN(osdCharacterGridBuffer);) {
+    // The SPI budget per call is fixed, bursts let more chars fit into it
+    for (pos = 0; pos < ARRAYLEN(osdCharacterGridBuffer) && bufPtr + BYTES_PER_CHAR2UPDATE <= (int)sizeof(spiBuff);) {
         next = BITARRAY_FIND_FIRST_SET(screenIsDirty, pos);
         if (next < 0) {
             // No more dirty chars.
@@ -507,6 +556,13 @@ static bool max7456DrawScreenPartial(void)
             BOUNDS_CHECK_FAILED();
         }
 
+        const unsigned runLength = max7456DirtyRunLength(pos, (sizeof(spiBuff) - bufPtr - BYTES_PER_BURST) / 2);
+        if (runLength >= MIN_CHARS_PER_BURST) {
+            bufPtr = max7456PrepareBurst(spiBuff, sizeof(spiBuff), bufPtr, pos, runLength);
+            pos += runLength;
+            continue;
+        }
+
         // Found one dirty character to send
         uint8_t ph = pos >> 8;
         uint8_t pl = pos & 0xff;
@@ -548,9 +604,6 @@ static bool max7456DrawScreenPartial(void)
         }
 
         bitArrayClr(screenIsDirty, pos);
-        if (++updatedCharCount == MAX_CHARS2UPDATE) {
-            break;
-        }
         // Start next search at next bit
         pos++;
     }
@@ -13,6 +13,7 @@
 #define NVIC_PRIO_TIMER_DMA                 3
 #define NVIC_PRIO_SDIO                      3
 #define NVIC_PRIO_GYRO_INT_EXTI             4
+#define NVIC_PRIO_SPI_DMA                   5
 #define NVIC_PRIO_USB                       5
 #define NVIC_PRIO_SERIALUART                5
 #define NVIC_PRIO_SONAR_EXTI                7
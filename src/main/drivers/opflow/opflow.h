@@ -30,6 +30,7 @@
 struct opflowDev_s;
 
 typedef struct opflowData_s {
+    timeUs_t    sampleTimeUs;   // Reception time, end of the integration timeframe
     timeDelta_t deltaTime;      // Integration timeframe of motionX/Y
     int32_t     flowRateRaw[3]; // Flow rotation in raw sensor uints (per deltaTime interval). Use dummy 3-rd axis (always zero) for compatibility with alignment functions
     int16_t     quality;
@@ -38,5 +39,6 @@ typedef struct opflowData_s {
 typedef struct opflowDev_s {
     sensorOpflowInitFuncPtr initFn;
     sensorOpflowUpdateFuncPtr updateFn;
+    sensorOpflowDataReadyFuncPtr isDataReadyFn;     // optional, event driven drivers: a sample is waiting
     opflowData_t rawData;
 } opflowDev_t;
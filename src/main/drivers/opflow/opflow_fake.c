@@ -32,6 +32,8 @@
 
 #include "common/utils.h"
 
+#include "drivers/time.h"
+
 #include "opflow.h"
 #include "opflow_fake.h"
 
@@ -56,6 +58,7 @@ static bool fakeOpflowInit(opflowDev_t * dev)
 static bool fakeOpflowUpdate(opflowDev_t * dev)
 {
     memcpy(&dev->rawData, &fakeData, sizeof(opflowData_t));
+    dev->rawData.sampleTimeUs = micros();
     return true;
 }
 
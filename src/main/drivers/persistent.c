@@ -31,6 +31,10 @@
 
 #define PERSISTENT_OBJECT_MAGIC_VALUE (('i' << 24)|('N' << 16)|('a' << 8)|('v' << 0))
 
+#if !defined(RCC_CSR_IWDGRSTF) && defined(RCC_CSR_WDGRSTF)
+#define RCC_CSR_IWDGRSTF RCC_CSR_WDGRSTF    // F4 standard peripheral library name
+#endif
+
 #ifdef USE_HAL_DRIVER
 
 uint32_t persistentObjectRead(persistentObjectId_e id)
@@ -102,15 +106,25 @@ void persistentObjectInit(void)
 
     // XXX Magic value checking may be sufficient
 
-    uint32_t wasSoftReset;
+    // Watchdog and brown-out resets keep the objects as well, they carry the
+    // warm restart snapshot. A brown-out flag is also raised on power-on.
+    uint32_t keepObjects;
 
 #ifdef STM32H7
-    wasSoftReset = RCC->RSR & RCC_RSR_SFTRSTF;
+    const uint32_t resetFlags = RCC->RSR;
+    keepObjects = resetFlags & (RCC_RSR_SFTRSTF | RCC_RSR_IWDG1RSTF | RCC_RSR_WWDG1RSTF);
+    if ((resetFlags & RCC_RSR_BORRSTF) && !(resetFlags & RCC_RSR_PORRSTF)) {
+        keepObjects = 1;
+    }
 #else
-    wasSoftReset = RCC->CSR & RCC_CSR_SFTRSTF;
+    const uint32_t resetFlags = RCC->CSR;
+    keepObjects = resetFlags & (RCC_CSR_SFTRSTF | RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF);
+    if ((resetFlags & RCC_CSR_BORRSTF) && !(resetFlags & RCC_CSR_PORRSTF)) {
+        keepObjects = 1;
+    }
 #endif
 
-    if (!wasSoftReset || (persistentObjectRead(PERSISTENT_OBJECT_MAGIC) != PERSISTENT_OBJECT_MAGIC_VALUE)) {
+    if (!keepObjects || (persistentObjectRead(PERSISTENT_OBJECT_MAGIC) != PERSISTENT_OBJECT_MAGIC_VALUE)) {
         for (int i = 1; i < PERSISTENT_OBJECT_COUNT; i++) {
             persistentObjectWrite(i, 0);
         }
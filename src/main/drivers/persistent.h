@@ -30,6 +30,14 @@
 typedef enum {
     PERSISTENT_OBJECT_MAGIC = 0,
     PERSISTENT_OBJECT_RESET_REASON,
+    PERSISTENT_OBJECT_WARM_RESTART,         // Magic and checksum of the in-flight snapshot below
+    PERSISTENT_OBJECT_WARM_GYRO_ZERO_XY,
+    PERSISTENT_OBJECT_WARM_GYRO_ZERO_Z,     // Gyro Z zero and home heading
+    PERSISTENT_OBJECT_WARM_ATTITUDE_Q01,
+    PERSISTENT_OBJECT_WARM_ATTITUDE_Q23,
+    PERSISTENT_OBJECT_WARM_HOME_LAT,
+    PERSISTENT_OBJECT_WARM_HOME_LON,
+    PERSISTENT_OBJECT_WARM_HOME_ALT,        // Home altitude relative to the aircraft
     PERSISTENT_OBJECT_COUNT,
 } persistentObjectId_e;
 
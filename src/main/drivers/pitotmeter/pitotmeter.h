@@ -29,4 +29,7 @@ typedef struct pitotDev_s {
     pitotOpFuncPtr start;
     pitotOpFuncPtr get;
     pitotCalculateFuncPtr calculate;
+    pitotOpFuncPtr readAsync;               // optional, queue a background read of a sample into asyncBuf
+    pitotOpFuncPtr readAsyncDecode;         // convert asyncBuf once the background read has completed
+    uint8_t asyncBuf[4];
 } pitotDev_t;
@@ -0,0 +1,143 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "common/utils.h"
+#include "common/maths.h"
+#include "drivers/bus_i2c.h"
+#include "drivers/time.h"
+#include "drivers/pitotmeter/pitotmeter.h"
+#include "drivers/pitotmeter/pitotmeter_dlvr_l10d.h"
+
+#if defined(USE_PITOT_DLVR)
+
+// DLVR-L10D, differential +-10 inH2O, standard address 0x28
+#define DLVR_RANGE_INCH_H2O         10.0f
+#define DLVR_OFFSET                 8192.0f     // Half of the 14 bit range, zero differential pressure
+#define DLVR_SCALE                  16384.0f
+#define INCH_H2O_TO_PA              248.84f
+
+typedef struct dlvrCtx_s {
+    bool     dataValid;
+    uint16_t dlvr_up;
+    uint16_t dlvr_ut;
+} dlvrCtx_t;
+
+STATIC_ASSERT(sizeof(dlvrCtx_t) < BUS_SCRATCHPAD_MEMORY_SIZE, busDevice_scratchpad_memory_too_small);
+
+// Status in the two upper bits: 0 new sample, 2 stale sample, 3 fault
+static bool dlvr_decode(pitotDev_t * pitot, const uint8_t * buf)
+{
+    dlvrCtx_t * ctx = busDeviceGetScratchpadMemory(pitot->busDev);
+
+    const uint8_t status = (buf[0] & 0xC0) >> 6;
+    if (status == 3) {
+        return false;
+    }
+
+    if (status == 2) {
+        return ctx->dataValid;
+    }
+
+    ctx->dataValid = true;
+    ctx->dlvr_up = 0x3FFF & ((buf[0] << 8) + buf[1]);
+    ctx->dlvr_ut = (0xFFE0 & ((buf[2] << 8) + buf[3])) >> 5;
+    return true;
+}
+
+static bool dlvr_start(pitotDev_t * pitot)
+{
+    UNUSED(pitot);
+    return true;
+}
+
+static bool dlvr_read(pitotDev_t * pitot)
+{
+    uint8_t rxbuf[4];
+
+    if (!busReadBuf(pitot->busDev, 0xFF, rxbuf, 4)) {
+        return false;
+    }
+
+    return dlvr_decode(pitot, rxbuf);
+}
+
+static bool dlvr_readAsync(pitotDev_t * pitot)
+{
+    return busReadBufAsync(pitot->busDev, 0xFF, pitot->asyncBuf, 4);
+}
+
+static bool dlvr_readAsyncDecode(pitotDev_t * pitot)
+{
+    return dlvr_decode(pitot, pitot->asyncBuf);
+}
+
+static void dlvr_calculate(pitotDev_t * pitot, float *pressure, float *temperature)
+{
+    dlvrCtx_t * ctx = busDeviceGetScratchpadMemory(pitot->busDev);
+
+    // Datasheet transfer function: P = 1.25 * (output - offset) / 2^14 * full span
+    const float dP_inchH2O = 1.25f * 2.0f * DLVR_RANGE_INCH_H2O * ((float)ctx->dlvr_up - DLVR_OFFSET) / DLVR_SCALE;
+    const float T = C_TO_KELVIN((float)ctx->dlvr_ut * (200.0f / 2047.0f) - 50.0f);
+
+    if (pressure) {
+        *pressure = dP_inchH2O * INCH_H2O_TO_PA;    // Pa
+    }
+
+    if (temperature) {
+        *temperature = T; // K
+    }
+}
+
+bool dlvrDetect(pitotDev_t * pitot)
+{
+    uint8_t rxbuf[4];
+
+    pitot->busDev = busDeviceInit(BUSTYPE_I2C, DEVHW_DLVR, 0, OWNER_AIRSPEED);
+    if (pitot->busDev == NULL) {
+        return false;
+    }
+
+    // Same double read as for the MS4525 to recover the bus after a start-stop without clock
+    busReadBuf(pitot->busDev, 0xFF, rxbuf, 4);
+    if (!busReadBuf(pitot->busDev, 0xFF, rxbuf, 4) || ((rxbuf[0] & 0xC0) >> 6) == 3) {
+        busDeviceDeInit(pitot->busDev);
+        return false;
+    }
+
+    dlvrCtx_t * ctx = busDeviceGetScratchpadMemory(pitot->busDev);
+    ctx->dataValid = false;
+    ctx->dlvr_up = DLVR_OFFSET;
+    ctx->dlvr_ut = 0;
+
+    pitot->delay = 10000;
+    pitot->start = dlvr_start;
+    pitot->get = dlvr_read;
+    pitot->calculate = dlvr_calculate;
+    pitot->readAsync = dlvr_readAsync;
+    pitot->readAsyncDecode = dlvr_readAsyncDecode;
+    return true;
+}
+
+#endif
@@ -86,6 +86,33 @@ static bool ms4525_read(pitotDev_t * pitot)
     return true;
 }
 
+static bool ms4525_readAsync(pitotDev_t * pitot)
+{
+    return busReadBufAsync(pitot->busDev, 0xFF, pitot->asyncBuf, 4);
+}
+
+// The sensor measures continuously, a single read returns its latest sample
+static bool ms4525_readAsyncDecode(pitotDev_t * pitot)
+{
+    const uint8_t * buf = pitot->asyncBuf;
+    ms4525Ctx_t * ctx = busDeviceGetScratchpadMemory(pitot->busDev);
+
+    const uint8_t status = ((buf[0] & 0xC0) >> 6);
+    if (status == 3) {
+        return false;
+    }
+
+    // Stale, no new sample since the last read. Keep the last one.
+    if (status == 2) {
+        return ctx->dataValid;
+    }
+
+    ctx->dataValid = true;
+    ctx->ms4525_up = 0x3FFF & ((buf[0] << 8) + buf[1]);
+    ctx->ms4525_ut = (0xFFE0 & ((buf[2] << 8) + buf[3])) >> 5;
+    return true;
+}
+
 static void ms4525_calculate(pitotDev_t * pitot, float *pressure, float *temperature)
 {
     ms4525Ctx_t * ctx = busDeviceGetScratchpadMemory(pitot->busDev);
@@ -139,5 +166,7 @@ bool ms4525Detect(pitotDev_t * pitot)
     pitot->start = ms4525_start;
     pitot->get = ms4525_read;
     pitot->calculate = ms4525_calculate;
+    pitot->readAsync = ms4525_readAsync;
+    pitot->readAsyncDecode = ms4525_readAsyncDecode;
     return true;
 }
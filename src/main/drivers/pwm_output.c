@@ -28,6 +28,7 @@ FILE_COMPILE_FOR_SPEED
 
 #include "common/log.h"
 #include "common/maths.h"
+#include "common/utils.h"
 #include "common/circular_queue.h"
 
 #include "drivers/io.h"
@@ -57,13 +58,46 @@ FILE_COMPILE_FOR_SPEED
 
 #define DSHOT_DMA_BUFFER_SIZE   18 /* resolution + frame reset (2us) */
 
-#define DSHOT_COMMAND_INTERVAL_US 10000
+#ifdef USE_DSHOT_BIDIR
+/*
+ * Bidirectional DShot: ESC answers each frame on the same wire with a 21 bit GCR frame
+ * at 5/4 of the DShot bitrate, so a GCR bit is 16 timer ticks. At most one edge per bit
+ */
+#define DSHOT_BIDIR_CAPTURE_BUFFER_SIZE 24
+#define DSHOT_BIDIR_GCR_BIT_TICKS       16
+#define DSHOT_BIDIR_GCR_FRAME_BITS      21
+#endif
+
+#ifdef USE_DSHOT_DMAR
+#define DSHOT_BURST_MAX_TIMERS          4
+#endif
+
+/*
+ * Commands take the place of single throttle frames, they never go out back to
+ * back. Repeats of one command are spaced by DSHOT_COMMAND_REPEAT_INTERVAL_US,
+ * two commands by DSHOT_COMMAND_INTERVAL_US, and at least
+ * DSHOT_COMMAND_MIN_THROTTLE_FRAMES throttle frames follow every command frame
+ * whatever the motor update rate is.
+ */
+#define DSHOT_COMMAND_INTERVAL_US           10000
+#define DSHOT_COMMAND_REPEAT_INTERVAL_US    1000
+#define DSHOT_COMMAND_MIN_THROTTLE_FRAMES   4
 #define DSHOT_COMMAND_QUEUE_LENGTH 8
 #define DHSOT_COMMAND_QUEUE_SIZE   DSHOT_COMMAND_QUEUE_LENGTH * sizeof(dshotCommands_e)
 #endif
 
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
 
+#ifdef USE_DSHOT_DMAR
+// All DShot motors of one timer, fed through TIMx_DMAR by the DMA stream of the first motor channel
+typedef struct {
+    TCH_t * tch;                    // Channel owning the DMA stream
+    uint8_t firstChannelIndex;
+    uint8_t channelCount;
+    timerDMASafeType_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE * CC_CHANNELS_PER_TIMER];
+} dshotBurstGroup_t;
+#endif
+
 typedef struct {
     TCH_t * tch;
     bool configured;
@@ -78,12 +112,22 @@ typedef struct {
     // DSHOT parameters
     timerDMASafeType_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE];
 #endif
+#ifdef USE_DSHOT_BIDIR
+    bool bidir;
+    timerDMASafeType_t dmaCaptureBuffer[DSHOT_BIDIR_CAPTURE_BUFFER_SIZE];
+#endif
+#ifdef USE_DSHOT_DMAR
+    dshotBurstGroup_t * burst;      // NULL if the channel has its own DMA stream
+#endif
 } pwmOutputPort_t;
 
 typedef struct {
     pwmOutputPort_t *   pwmPort;        // May be NULL if motor doesn't use the PWM port
     uint16_t            value;          // Used to keep track of last motor value
     bool                requestTelemetry;
+#ifdef USE_DSHOT_BIDIR
+    uint32_t            rpm;            // Last valid RPM reported by the ESC over bidirectional DShot
+#endif
 } pwmOutputMotor_t;
 
 static DMA_RAM pwmOutputPort_t pwmOutputPorts[MAX_PWM_OUTPUT_PORTS];
@@ -106,13 +150,22 @@ static bool pwmMotorsEnabled = true;
 #ifdef USE_DSHOT
 static timeUs_t digitalMotorUpdateIntervalUs = 0;
 static timeUs_t digitalMotorLastUpdateUs;
-static timeUs_t lastCommandSent = 0;
-    
+
 static circularBuffer_t commandsCircularBuffer;
 static uint8_t commandsBuff[DHSOT_COMMAND_QUEUE_SIZE];
 static currentExecutingCommand_t currentExecutingCommand;
 #endif
 
+#ifdef USE_DSHOT_BIDIR
+static bool dshotBidirEnabled = false;
+#endif
+
+#ifdef USE_DSHOT_DMAR
+static bool dshotBurstEnabled = false;
+static DMA_RAM dshotBurstGroup_t dshotBurstGroups[DSHOT_BURST_MAX_TIMERS];
+static uint8_t dshotBurstGroupCount = 0;
+#endif
+
 static void pwmOutConfigTimer(pwmOutputPort_t * p, TCH_t * tch, uint32_t hz, uint16_t period, uint16_t value)
 {
     p->tch = tch;
@@ -138,6 +191,12 @@ static pwmOutputPort_t *pwmOutAllocatePort(void)
 
     p->tch = NULL;
     p->configured = false;
+#ifdef USE_DSHOT_BIDIR
+    p->bidir = false;
+#endif
+#ifdef USE_DSHOT_DMAR
+    p->burst = NULL;
+#endif
 
     return p;
 }
@@ -249,6 +308,61 @@ uint32_t getDshotHz(motorPwmProtocolTypes_e pwmProtocolType)
     }
 }
 
+#ifdef USE_DSHOT_BIDIR
+// DMA IRQ context, called right after the last bit of the frame was loaded
+static void dshotBidirDMACallback(TCH_t * tch, void * param)
+{
+    pwmOutputPort_t * port = (pwmOutputPort_t *)param;
+    timerPWMStartDMACapture(tch, port->dmaCaptureBuffer, DSHOT_BIDIR_CAPTURE_BUFFER_SIZE);
+}
+#endif
+
+#ifdef USE_DSHOT_DMAR
+static dshotBurstGroup_t * dshotBurstGetGroup(TCH_t * tch)
+{
+    for (int i = 0; i < dshotBurstGroupCount; i++) {
+        if (dshotBurstGroups[i].tch->timCtx == tch->timCtx) {
+            return &dshotBurstGroups[i];
+        }
+    }
+
+    if (dshotBurstGroupCount >= DSHOT_BURST_MAX_TIMERS) {
+        return NULL;
+    }
+
+    // First motor on this timer, its DMA stream will serve the whole timer
+    dshotBurstGroup_t * group = &dshotBurstGroups[dshotBurstGroupCount];
+    if (!timerPWMConfigDMABurst(tch, group->dmaBuffer, sizeof(group->dmaBuffer[0]), ARRAYLEN(group->dmaBuffer))) {
+        return NULL;
+    }
+
+    memset(group->dmaBuffer, 0, sizeof(group->dmaBuffer));
+    group->tch = tch;
+    group->firstChannelIndex = tch->timHw->channelIndex;
+    group->channelCount = 1;
+    dshotBurstGroupCount++;
+
+    return group;
+}
+
+static bool motorConfigDshotBurst(pwmOutputPort_t * port)
+{
+    dshotBurstGroup_t * group = dshotBurstGetGroup(port->tch);
+    if (!group) {
+        return false;
+    }
+
+    // Burst covers a contiguous range of CCR registers
+    const uint8_t channelIndex = port->tch->timHw->channelIndex;
+    const uint8_t lastChannelIndex = MAX(group->firstChannelIndex + group->channelCount - 1, channelIndex);
+    group->firstChannelIndex = MIN(group->firstChannelIndex, channelIndex);
+    group->channelCount = lastChannelIndex - group->firstChannelIndex + 1;
+
+    port->burst = group;
+    return true;
+}
+#endif
+
 static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware, uint32_t dshotHz, bool enableOutput)
 {
     // Try allocating new port
@@ -258,6 +372,28 @@ static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware,
         return NULL;
     }
 
+#ifdef USE_DSHOT_BIDIR
+    // Complementary outputs can't be used for input capture
+    if (dshotBidirEnabled && !(timerHardware->output & TIMER_OUTPUT_N_CHANNEL)) {
+        // Line idles high, ESC pulls it low to answer
+        if (enableOutput) {
+            IOConfigGPIOAF(IOGetByTag(timerHardware->tag), IOCFG_AF_PP_UP, timerHardware->alternateFunction);
+        }
+        timerPWMSetInverted(port->tch, true);
+        timerPWMConfigChannel(port->tch, 0);
+        timerPWMSetDMACallback(port->tch, dshotBidirDMACallback, port);
+        port->bidir = true;
+    }
+#endif
+
+#ifdef USE_DSHOT_DMAR
+    // Fall back to a DMA stream per channel if burst groups are exhausted
+    if (dshotBurstEnabled && motorConfigDshotBurst(port)) {
+        port->configured = true;
+        return port;
+    }
+#endif
+
     // Configure timer DMA
     if (timerPWMConfigChannelDMA(port->tch, port->dmaBuffer, sizeof(port->dmaBuffer[0]), DSHOT_DMA_BUFFER_SIZE)) {
         // Only mark as DSHOT channel if DMA was set successfully
@@ -268,10 +404,11 @@ static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware,
     return port;
 }
 
-static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, uint16_t packet)
+// stride is the number of channels sharing the buffer, elements of one channel are interleaved
+static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, int stride, uint16_t packet)
 {
     for (int i = 0; i < 16; i++) {
-        dmaBuffer[i] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
+        dmaBuffer[i * stride] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
         packet <<= 1;
     }
 }
@@ -289,6 +426,13 @@ static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
     }
     csum &= 0xf;
 
+#ifdef USE_DSHOT_BIDIR
+    // Inverted checksum tells the ESC to answer over the signal wire
+    if (dshotBidirEnabled) {
+        csum = ~csum & 0xf;
+    }
+#endif
+
     // append checksum
     packet = (packet << 4) | csum;
 
@@ -296,6 +440,86 @@ static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
 }
 #endif
 
+#ifdef USE_DSHOT_BIDIR
+/*
+ * Rebuild the 21 bit GCR frame from edge timestamps. Returns false if the frame is invalid,
+ * rpm is set to 0 when the motor is stopped
+ */
+static bool decodeDshotBidirFrame(const timerDMASafeType_t *edges, uint32_t edgeCount, uint32_t *rpm)
+{
+    if (edgeCount < 2) {
+        return false;
+    }
+
+    uint32_t gcr = 0;
+    int bits = 0;
+
+    for (uint32_t i = 1; i <= edgeCount && bits < DSHOT_BIDIR_GCR_FRAME_BITS; i++) {
+        int len;
+        if (i < edgeCount) {
+            const uint16_t ticks = (uint16_t)(edges[i] - edges[i - 1]);
+            len = MAX((ticks + DSHOT_BIDIR_GCR_BIT_TICKS / 2) / DSHOT_BIDIR_GCR_BIT_TICKS, 1);
+        } else {
+            // Last level lasts until the end of the frame
+            len = DSHOT_BIDIR_GCR_FRAME_BITS - bits;
+        }
+
+        gcr <<= len;
+        gcr |= 1 << (len - 1);
+        bits += len;
+    }
+
+    if (bits != DSHOT_BIDIR_GCR_FRAME_BITS) {
+        return false;
+    }
+
+    // Edges mark ones in the NRZI coded stream
+    gcr = gcr ^ (gcr >> 1);
+
+    static const uint8_t gcrDecode[32] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 10, 11, 0, 13, 14, 15,
+        0, 0, 2, 3, 0, 5, 6, 7, 0, 0, 8, 1, 0, 4, 12, 0
+    };
+
+    uint32_t value = gcrDecode[gcr & 0x1f];
+    value |= gcrDecode[(gcr >> 5) & 0x1f] << 4;
+    value |= gcrDecode[(gcr >> 10) & 0x1f] << 8;
+    value |= gcrDecode[(gcr >> 15) & 0x1f] << 12;
+
+    uint32_t csum = value;
+    csum = csum ^ (csum >> 8);
+    csum = csum ^ (csum >> 4);
+    if ((csum & 0xf) != 0xf) {
+        return false;
+    }
+
+    // 3 bit exponent, 9 bit mantissa: eRPM period in us
+    value >>= 4;
+    if (value == 0x0fff) {
+        *rpm = 0;
+        return true;
+    }
+
+    const uint32_t periodUs = (value & 0x1ff) << (value >> 9);
+    if (periodUs == 0) {
+        return false;
+    }
+
+    *rpm = (60000000 / periodUs) * 2 / motorConfig()->motorPoleCount;
+    return true;
+}
+
+bool isMotorProtocolDshotBidir(void)
+{
+    return dshotBidirEnabled && isMotorProtocolDshot();
+}
+
+uint32_t pwmGetMotorRpm(uint8_t motorIndex)
+{
+    return motors[motorIndex].rpm;
+}
+#endif
+
 #if defined(USE_DSHOT)
 static void motorConfigDigitalUpdateInterval(uint16_t motorPwmRateHz)
 {
@@ -345,6 +569,9 @@ void initDShotCommands(void) {
     circularBufferInit(&commandsCircularBuffer, commandsBuff,DHSOT_COMMAND_QUEUE_SIZE, sizeof(dshotCommands_e));
 
     currentExecutingCommand.remainingRepeats = 0;
+    currentExecutingCommand.lastFrameUs = 0;
+    currentExecutingCommand.nextFrameDelayUs = 0;
+    currentExecutingCommand.throttleFrames = DSHOT_COMMAND_MIN_THROTTLE_FRAMES;
 }
 
 static int getDShotCommandRepeats(dshotCommands_e cmd) {
@@ -362,28 +589,35 @@ static int getDShotCommandRepeats(dshotCommands_e cmd) {
     return repeats;
 }
 
-static void executeDShotCommands(void){
-    
-    timeUs_t tNow = micros();
+// True when this motor update carries a command frame instead of throttle
+static bool executeDShotCommands(timeUs_t currentTimeUs)
+{
+    if (currentExecutingCommand.throttleFrames < DSHOT_COMMAND_MIN_THROTTLE_FRAMES) {
+        currentExecutingCommand.throttleFrames++;
+        return false;
+    }
 
-    if(currentExecutingCommand.remainingRepeats == 0) {
-       const int isTherePendingCommands = !circularBufferIsEmpty(&commandsCircularBuffer);
-        if (isTherePendingCommands && (tNow - lastCommandSent > DSHOT_COMMAND_INTERVAL_US)){
-            //Load the command
-            dshotCommands_e cmd;
-            circularBufferPopHead(&commandsCircularBuffer, (uint8_t *) &cmd);
-            currentExecutingCommand.cmd = cmd;
-            currentExecutingCommand.remainingRepeats = getDShotCommandRepeats(cmd);           
-        } else {
-        return;
-        }  
+    if (currentTimeUs - currentExecutingCommand.lastFrameUs < currentExecutingCommand.nextFrameDelayUs) {
+        return false;
     }
-    for (uint8_t i = 0; i < getMotorCount(); i++) {
-         motors[i].requestTelemetry = true;
-         motors[i].value = currentExecutingCommand.cmd;
+
+    if (currentExecutingCommand.remainingRepeats == 0) {
+        if (circularBufferIsEmpty(&commandsCircularBuffer)) {
+            return false;
+        }
+
+        dshotCommands_e cmd;
+        circularBufferPopHead(&commandsCircularBuffer, (uint8_t *) &cmd);
+        currentExecutingCommand.cmd = cmd;
+        currentExecutingCommand.remainingRepeats = getDShotCommandRepeats(cmd);
     }
-    currentExecutingCommand.remainingRepeats--; 
-    lastCommandSent = tNow;
+
+    currentExecutingCommand.remainingRepeats--;
+    currentExecutingCommand.lastFrameUs = currentTimeUs;
+    currentExecutingCommand.nextFrameDelayUs = currentExecutingCommand.remainingRepeats ? DSHOT_COMMAND_REPEAT_INTERVAL_US : DSHOT_COMMAND_INTERVAL_US;
+    currentExecutingCommand.throttleFrames = 0;
+
+    return true;
 }
 #endif
 
@@ -406,18 +640,46 @@ void pwmCompleteMotorUpdate(void) {
 #ifdef USE_DSHOT
     if (isMotorProtocolDshot()) {
 
-        executeDShotCommands();
+        const bool commandFrame = executeDShotCommands(currentTimeUs);
 
         // Generate DMA buffers
         for (int index = 0; index < motorCount; index++) {
             if (motors[index].pwmPort && motors[index].pwmPort->configured) {
-                uint16_t packet = prepareDshotPacket(motors[index].value, motors[index].requestTelemetry);
-                loadDmaBufferDshot(motors[index].pwmPort->dmaBuffer, packet);
-                timerPWMPrepareDMA(motors[index].pwmPort->tch, DSHOT_DMA_BUFFER_SIZE);
+#ifdef USE_DSHOT_BIDIR
+                // Collect the answer to the previous frame and turn the line back to output
+                if (motors[index].pwmPort->bidir) {
+                    pwmOutputPort_t * port = motors[index].pwmPort;
+                    const uint32_t edgeCount = timerPWMStopDMACapture(port->tch, DSHOT_MOTOR_BITLENGTH);
+                    uint32_t rpm;
+                    if (decodeDshotBidirFrame(port->dmaCaptureBuffer, edgeCount, &rpm)) {
+                        motors[index].rpm = rpm;
+                    }
+                }
+#endif
+                // Commands are sent with the telemetry bit set, the throttle value is kept for the next frame
+                uint16_t packet = commandFrame ?
+                    prepareDshotPacket(currentExecutingCommand.cmd, true) :
+                    prepareDshotPacket(motors[index].value, motors[index].requestTelemetry);
                 motors[index].requestTelemetry = false;
+#ifdef USE_DSHOT_DMAR
+                if (motors[index].pwmPort->burst) {
+                    dshotBurstGroup_t * group = motors[index].pwmPort->burst;
+                    const int offset = motors[index].pwmPort->tch->timHw->channelIndex - group->firstChannelIndex;
+                    loadDmaBufferDshot(&group->dmaBuffer[offset], group->channelCount, packet);
+                    continue;
+                }
+#endif
+                loadDmaBufferDshot(motors[index].pwmPort->dmaBuffer, 1, packet);
+                timerPWMPrepareDMA(motors[index].pwmPort->tch, DSHOT_DMA_BUFFER_SIZE);
             }
         }
 
+#ifdef USE_DSHOT_DMAR
+        for (int i = 0; i < dshotBurstGroupCount; i++) {
+            timerPWMPrepareDMABurst(dshotBurstGroups[i].tch, dshotBurstGroups[i].firstChannelIndex, dshotBurstGroups[i].channelCount, DSHOT_DMA_BUFFER_SIZE * dshotBurstGroups[i].channelCount);
+        }
+#endif
+
         // Start DMA on all timers
         for (int index = 0; index < motorCount; index++) {
             if (motors[index].pwmPort && motors[index].pwmPort->configured) {
@@ -442,6 +704,17 @@ void pwmMotorPreconfigure(void)
 {
     // Keep track of initial motor protocol
     initMotorProtocol = motorConfig()->motorPwmProtocol;
+#ifdef USE_DSHOT_BIDIR
+    dshotBidirEnabled = motorConfig()->dshotBidir;
+#endif
+#ifdef USE_DSHOT_DMAR
+    // Bidirectional DShot needs a DMA stream per channel to capture the answer
+#ifdef USE_DSHOT_BIDIR
+    dshotBurstEnabled = motorConfig()->dshotBurst && !dshotBidirEnabled;
+#else
+    dshotBurstEnabled = motorConfig()->dshotBurst;
+#endif
+#endif
 
 #ifdef BRUSHED_MOTORS
     initMotorProtocol = PWM_TYPE_BRUSHED;   // Override proto
@@ -475,6 +748,21 @@ void pwmMotorPreconfigure(void)
  * This function return the PWM frequency based on ESC protocol. We allow customer rates only for Brushed motors
  */ 
 uint32_t getEscUpdateFrequency(void) {
+#ifdef USE_DSHOT_BIDIR
+    // ESC answer has to fit between two frames
+    if (isMotorProtocolDshotBidir()) {
+        switch (initMotorProtocol) {
+            case PWM_TYPE_DSHOT150:
+                return 2000;
+            case PWM_TYPE_DSHOT300:
+                return 4000;
+            case PWM_TYPE_DSHOT600:
+            default:
+                return 8000;
+        }
+    }
+#endif
+
     switch (initMotorProtocol) {
         case PWM_TYPE_BRUSHED:
             return motorConfig()->motorPwmRate;
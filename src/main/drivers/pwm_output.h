@@ -28,6 +28,9 @@ typedef enum {
 typedef struct {
     dshotCommands_e cmd;
     int remainingRepeats;
+    timeUs_t lastFrameUs;           // Last command frame
+    timeUs_t nextFrameDelayUs;      // From the last command frame to the next one
+    uint8_t throttleFrames;         // Since the last command frame, saturates at DSHOT_COMMAND_MIN_THROTTLE_FRAMES
 } currentExecutingCommand_t;
 
 void pwmRequestMotorTelemetry(int motorIndex);
@@ -39,6 +42,10 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteMotorUpdate(void);
 bool isMotorProtocolDigital(void);
 bool isMotorProtocolDshot(void);
+#ifdef USE_DSHOT_BIDIR
+bool isMotorProtocolDshotBidir(void);
+uint32_t pwmGetMotorRpm(uint8_t motorIndex);
+#endif
 
 void pwmWriteServo(uint8_t index, uint16_t value);
 
@@ -30,6 +30,7 @@ struct rangefinderDev_s;
 typedef void (*rangefinderOpInitFuncPtr)(struct rangefinderDev_s * dev);
 typedef void (*rangefinderOpStartFuncPtr)(struct rangefinderDev_s * dev);
 typedef int32_t (*rangefinderOpReadFuncPtr)(struct rangefinderDev_s * dev);
+typedef bool (*rangefinderOpDataReadyFuncPtr)(struct rangefinderDev_s * dev, timeUs_t * sampleTimeUs);
 
 typedef struct rangefinderDev_s {
     busDevice_t * busDev;           // Device on a bus (if applicable)
@@ -45,4 +46,5 @@ typedef struct rangefinderDev_s {
     rangefinderOpInitFuncPtr init;
     rangefinderOpStartFuncPtr update;
     rangefinderOpReadFuncPtr read;
+    rangefinderOpDataReadyFuncPtr isDataReady;  // optional, event driven drivers: a sample is waiting, with its arrival time
 } rangefinderDev_t;
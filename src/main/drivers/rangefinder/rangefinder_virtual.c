@@ -58,6 +58,12 @@ static int32_t virtualRangefinderGetDistance(rangefinderDev_t * dev)
     return highLevelDeviceVTable->read();
 }
 
+static bool virtualRangefinderIsDataReady(rangefinderDev_t * dev, timeUs_t * sampleTimeUs)
+{
+    UNUSED(dev);
+    return highLevelDeviceVTable->isDataReady(sampleTimeUs);
+}
+
 #define VIRTUAL_MAX_RANGE_CM                250
 #define VIRTUAL_DETECTION_CONE_DECIDEGREES  900
 
@@ -74,6 +80,7 @@ bool virtualRangefinderDetect(rangefinderDev_t * dev, const virtualRangefinderVT
         dev->init = &virtualRangefinderInit;
         dev->update = &virtualRangefinderUpdate;
         dev->read = &virtualRangefinderGetDistance;
+        dev->isDataReady = vtable->isDataReady ? &virtualRangefinderIsDataReady : NULL;
 
         return true;
     }
@@ -26,13 +26,14 @@
 
 #include "drivers/rangefinder/rangefinder.h"
 
-#define RANGEFINDER_VIRTUAL_TASK_PERIOD_MS  30
+#define RANGEFINDER_VIRTUAL_TASK_PERIOD_MS  10      // Keep up with 100Hz streaming sensors (TFmini)
 
 typedef struct virtualRangefinderVTable_s {
     bool (*detect)(void);
     void (*init)(void);
     void (*update)(void);
     int32_t (*read)(void);
+    bool (*isDataReady)(timeUs_t * sampleTimeUs);    // optional
 } virtualRangefinderVTable_t;
 
 bool virtualRangefinderDetect(rangefinderDev_t * dev, const virtualRangefinderVTable_t * vtable);
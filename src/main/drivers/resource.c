@@ -22,14 +22,14 @@ const char * const ownerNames[OWNER_TOTAL_COUNT] = {
     "RANGEFINDER", "SYSTEM", "SPI", "I2C", "SDCARD", "FLASH", "USB", "BEEPER", "OSD",
     "BARO", "MPU", "INVERTER", "LED STRIP", "LED", "RECEIVER", "TRANSMITTER",
     "VTX", "SPI_PREINIT", "COMPASS", "TEMPERATURE", "1-WIRE", "AIRSPEED", "OLED DISPLAY",
-    "PINIO", "IRLOCK"
+    "PINIO", "IRLOCK", "BLACKBOX"
 };
 
 const char * const resourceNames[RESOURCE_TOTAL_COUNT] = {
     "", // NONE
     "IN", "OUT", "IN / OUT",
     "TIMER",
-    "UART TX", "UART RX", "UART TX/RX",
+    "UART TX", "UART RX", "UART TX/RX", "UART CTS",
     "EXTI",
     "SCL", "SDA",
     "SCK", "MOSI", "MISO", "CS",
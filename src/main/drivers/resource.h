@@ -53,6 +53,7 @@ typedef enum {
     OWNER_OLED_DISPLAY,
     OWNER_PINIO,
     OWNER_IRLOCK,
+    OWNER_BLACKBOX,
     OWNER_TOTAL_COUNT
 } resourceOwner_e;
 
@@ -64,7 +65,7 @@ typedef enum {
     RESOURCE_NONE       = 0,
     RESOURCE_INPUT, RESOURCE_OUTPUT, RESOURCE_IO,
     RESOURCE_TIMER,
-    RESOURCE_UART_TX, RESOURCE_UART_RX, RESOURCE_UART_TXRX,
+    RESOURCE_UART_TX, RESOURCE_UART_RX, RESOURCE_UART_TXRX, RESOURCE_UART_CTS,
     RESOURCE_EXTI,
     RESOURCE_I2C_SCL, RESOURCE_I2C_SDA,
     RESOURCE_SPI_SCK, RESOURCE_SPI_MOSI, RESOURCE_SPI_MISO, RESOURCE_SPI_CS,
@@ -23,6 +23,7 @@
 #if defined(USE_SDCARD)
 
 #include "build/debug.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/time.h"
@@ -42,6 +43,11 @@
 
 sdcard_t sdcard;
 
+static sdcardWriteStats_t sdcardWriteStats;
+static sdcard_operationCompleteCallback_c sdcardWriteCallback;
+static timeUs_t sdcardWriteStartUs;
+static bool sdcardWriteAttemptPending;
+
 void sdcardInsertionDetectDeinit(void)
 {
     sdcard.cardDetectPin = IOGetByTag(IO_TAG(SDCARD_DETECT_PIN));
@@ -116,15 +122,92 @@ sdcardOperationStatus_e sdcard_beginWriteBlocks(uint32_t blockIndex, uint32_t bl
     }
 }
 
+static void sdcardRecordWriteLatency(timeDelta_t latencyUs)
+{
+    sdcardWriteStats.writeCount++;
+    sdcardWriteStats.lastLatencyUs = latencyUs;
+    sdcardWriteStats.maxLatencyUs = MAX(sdcardWriteStats.maxLatencyUs, (uint32_t)latencyUs);
+
+    if (latencyUs >= SDCARD_WRITE_STALL_THRESHOLD_US) {
+        sdcardWriteStats.stallCount++;
+    }
+
+    // Decaying peak: follows a stall instantly, forgets it over the next ~1000 writes
+    sdcardWriteStats.latencyEstimateUs -= sdcardWriteStats.latencyEstimateUs >> 10;
+    sdcardWriteStats.latencyEstimateUs = MAX(sdcardWriteStats.latencyEstimateUs, (uint32_t)latencyUs);
+}
+
+static void sdcardWriteComplete(sdcardBlockOperation_e operation, uint32_t blockIndex, uint8_t *buffer, uint32_t callbackData)
+{
+    sdcardRecordWriteLatency(micros() - sdcardWriteStartUs);
+
+    if (sdcardWriteCallback) {
+        sdcardWriteCallback(operation, blockIndex, buffer, callbackData);
+    }
+}
+
 sdcardOperationStatus_e sdcard_writeBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData)
 {
     if (sdcardVTable) {
-        return sdcardVTable->writeBlock(blockIndex, buffer, callback, callbackData);
+        /*
+         * Latency is measured from the first attempt, so the time a card spends busy (and rejecting writes with
+         * SDCARD_OPERATION_BUSY) after the previous block is charged to this one. Only one write can be
+         * outstanding, so a single saved callback is enough to time it.
+         */
+        if (!sdcardWriteAttemptPending) {
+            sdcardWriteAttemptPending = true;
+            sdcardWriteStartUs = micros();
+        }
+
+        const sdcard_operationCompleteCallback_c savedCallback = sdcardWriteCallback;
+        sdcardWriteCallback = callback;
+
+        const sdcardOperationStatus_e status = sdcardVTable->writeBlock(blockIndex, buffer, sdcardWriteComplete, callbackData);
+
+        switch (status) {
+            case SDCARD_OPERATION_IN_PROGRESS:
+                sdcardWriteAttemptPending = false;
+                break;
+            case SDCARD_OPERATION_SUCCESS:
+                sdcardWriteAttemptPending = false;
+                sdcardWriteCallback = savedCallback;
+                sdcardRecordWriteLatency(micros() - sdcardWriteStartUs);
+                break;
+            case SDCARD_OPERATION_BUSY:
+                sdcardWriteCallback = savedCallback;
+                break;
+            case SDCARD_OPERATION_FAILURE:
+            default:
+                sdcardWriteAttemptPending = false;
+                sdcardWriteCallback = savedCallback;
+                break;
+        }
+
+        return status;
     } else {
         return false;
     }
 }
 
+const sdcardWriteStats_t * sdcard_getWriteStats(void)
+{
+    return &sdcardWriteStats;
+}
+
+/**
+ * Returns true and the index of the block the card expects next if a multi-block write is in progress. Writing that
+ * block keeps the card streaming, writing any other block forces the write to be stopped first.
+ */
+bool sdcard_getMultiWriteNextBlock(uint32_t *blockIndex)
+{
+    if (sdcardVTable && sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS) {
+        *blockIndex = sdcard.multiWriteNextBlock;
+        return true;
+    }
+
+    return false;
+}
+
 bool sdcard_poll(void)
 {
     if (sdcardVTable) {
@@ -48,6 +48,17 @@ typedef enum {
     SDCARD_OPERATION_FAILURE
 } sdcardOperationStatus_e;
 
+// Writes slower than this are counted as card stalls (internal garbage collection, wear levelling)
+#define SDCARD_WRITE_STALL_THRESHOLD_US     10000
+
+typedef struct sdcardWriteStats_s {
+    uint32_t writeCount;
+    uint32_t stallCount;
+    uint32_t lastLatencyUs;
+    uint32_t maxLatencyUs;
+    uint32_t latencyEstimateUs;     // Decaying peak of recent write latencies, what a write buffer has to absorb
+} sdcardWriteStats_t;
+
 typedef void(*sdcard_operationCompleteCallback_c)(sdcardBlockOperation_e operation, uint32_t blockIndex, uint8_t *buffer, uint32_t callbackData);
 
 void sdcard_init(void);
@@ -56,6 +67,8 @@ bool sdcard_readBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationComp
 
 sdcardOperationStatus_e sdcard_beginWriteBlocks(uint32_t blockIndex, uint32_t blockCount);
 sdcardOperationStatus_e sdcard_writeBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData);
+bool sdcard_getMultiWriteNextBlock(uint32_t *blockIndex);
+const sdcardWriteStats_t * sdcard_getWriteStats(void);
 
 void sdcardInsertionDetectDeinit(void);
 void sdcardInsertionDetectInit(void);
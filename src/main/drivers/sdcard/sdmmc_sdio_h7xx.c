@@ -42,6 +42,7 @@
 #include "drivers/time.h"
 #include "drivers/rcc.h"
 #include "drivers/dma.h"
+#include "drivers/dma_cache.h"
 
 #include "build/debug.h"
 
@@ -513,12 +514,12 @@ SD_Error_t SD_WriteBlocks_DMA(uint64_t WriteAddress, uint32_t *buffer, uint32_t
         return SD_ERROR; // unsupported.
     }
 
-    if ((uint32_t)buffer & 0x1f) {
+    if ((uint32_t)buffer & (DMA_CACHE_LINE_SIZE - 1)) {
         return SD_ADDR_MISALIGNED;
     }
 
     // Ensure the data is flushed to main memory
-    SCB_CleanDCache_by_Addr(buffer, NumberOfBlocks * BlockSize);
+    dmaCacheCleanForDevice(buffer, NumberOfBlocks * BlockSize);
 
     HAL_StatusTypeDef status;
     if ((status = HAL_SD_WriteBlocks_DMA(&hsd1, (uint8_t *)buffer, WriteAddress, NumberOfBlocks)) != HAL_OK) {
@@ -544,7 +545,7 @@ SD_Error_t SD_ReadBlocks_DMA(uint64_t ReadAddress, uint32_t *buffer, uint32_t Bl
         return SD_ERROR; // unsupported.
     }
 
-    if ((uint32_t)buffer & 0x1f) {
+    if ((uint32_t)buffer & (DMA_CACHE_LINE_SIZE - 1)) {
         return SD_ADDR_MISALIGNED;
     }
 
@@ -585,12 +586,7 @@ void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd)
 
     SD_Handle.RXCplt = 0;
 
-    /*
-       the SCB_InvalidateDCache_by_Addr() requires a 32-Byte aligned address,
-       adjust the address and the D-Cache size to invalidate accordingly.
-     */
-    uint32_t alignedAddr = (uint32_t)sdReadParameters.buffer &  ~0x1F;
-    SCB_InvalidateDCache_by_Addr((uint32_t*)alignedAddr, sdReadParameters.NumberOfBlocks * sdReadParameters.BlockSize + ((uint32_t)sdReadParameters.buffer - alignedAddr));
+    dmaCacheInvalidateForCpu(sdReadParameters.buffer, sdReadParameters.NumberOfBlocks * sdReadParameters.BlockSize);
 }
 
 void HAL_SD_AbortCallback(SD_HandleTypeDef *hsd)
@@ -20,6 +20,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "common/time.h"
+
 #include "drivers/io_types.h"
 #include "drivers/bus.h"
 
@@ -35,6 +37,31 @@ typedef enum {
     CW270_DEG_FLIP = 8
 } sensor_align_e;
 
+// Header of a sensor sample, filled where the sample is captured
+typedef struct sensorSample_s {
+    timeUs_t timeUs;                // Capture time, as close to the measurement as the driver can tell
+    timeDelta_t latencyUs;          // Capture to first use by the estimator
+    uint16_t sequence;              // Incremented with every new sample
+    uint16_t consumedSequence;      // Sample latencyUs was measured for
+    bool valid;
+} sensorSample_t;
+
+static inline void sensorSampleCapture(sensorSample_t *sample, timeUs_t timeUs, bool valid)
+{
+    sample->timeUs = timeUs;
+    sample->valid = valid;
+    sample->sequence++;
+}
+
+// Called by the estimator using the sample, measures the latency once per sample
+static inline void sensorSampleConsume(sensorSample_t *sample, timeUs_t timeUs)
+{
+    if (sample->consumedSequence != sample->sequence) {
+        sample->consumedSequence = sample->sequence;
+        sample->latencyUs = cmpTimeUs(timeUs, sample->timeUs);
+    }
+}
+
 typedef bool (*sensorInitFuncPtr)(void);                    // sensor init prototype
 typedef bool (*sensorReadFuncPtr)(int16_t *data);           // sensor read and align prototype
 typedef bool (*sensorInterruptFuncPtr)(void);
@@ -55,3 +82,4 @@ typedef bool (*sensorTempReadFuncPtr)(struct temperatureDev_s *tempDev, int16_t
 struct opflowDev_s;
 typedef bool (*sensorOpflowInitFuncPtr)(struct opflowDev_s *mag);
 typedef bool (*sensorOpflowUpdateFuncPtr)(struct opflowDev_s *mag);
+typedef bool (*sensorOpflowDataReadyFuncPtr)(struct opflowDev_s *mag);
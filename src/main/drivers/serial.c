@@ -20,6 +20,8 @@
 
 #include "platform.h"
 
+#include "common/maths.h"
+
 #include "serial.h"
 
 void serialPrint(serialPort_t *instance, const char *str)
@@ -71,6 +73,19 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
+{
+    if (instance->vTable->readBuf) {
+        return instance->vTable->readBuf(instance, data, count);
+    }
+
+    count = MIN(count, serialRxBytesWaiting(instance));
+    for (uint32_t i = 0; i < count; i++) {
+        data[i] = serialRead(instance);
+    }
+    return count;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -103,6 +118,15 @@ void serialEndWrite(serialPort_t *instance)
         instance->vTable->endWrite(instance);
 }
 
+// The size must be a power of two. Returns false when the port keeps its own buffer.
+bool serialSetTxBuffer(serialPort_t *instance, volatile uint8_t *buffer, uint32_t size)
+{
+    if (instance->vTable->setTxBuffer)
+        return instance->vTable->setTxBuffer(instance, buffer, size);
+    else
+        return false;
+}
+
 bool serialIsConnected(const serialPort_t *instance)
 {
     if (instance->vTable->isConnected)
@@ -119,3 +143,19 @@ bool serialIsIdle(serialPort_t *instance)
     else
         return false;
 }
+
+// Only ports receiving through DMA detect the end of a burst, others never call it
+void serialSetIdleCallback(serialPort_t *instance, serialIdleCallbackPtr idleCallback)
+{
+    instance->idleCallback = idleCallback;
+}
+
+bool serialRxSignalled(const serialPort_t *instance)
+{
+    return instance->rxSignalled;
+}
+
+void serialClearRxSignal(serialPort_t *instance)
+{
+    instance->rxSignalled = false;
+}
@@ -16,6 +16,8 @@
  */
 
 #pragma once
+#include "common/spsc_ring.h"
+#include "common/time.h"
 #include "drivers/io.h"
 
 typedef struct {
@@ -53,9 +55,12 @@ typedef enum portOptions_t {
 
     SERIAL_LONGSTOP      = 0 << 6,
     SERIAL_SHORTSTOP     = 1 << 6,
+
+    SERIAL_CTS           = 1 << 7, // TX waits while CTS is high, only on UARTs the target assigns a UARTx_CTS_PIN to
 } portOptions_t;
 
 typedef void (*serialReceiveCallbackPtr)(uint16_t data, void *rxCallbackData);   // used by serial drivers to return frames to app
+typedef void (*serialIdleCallbackPtr)(timeUs_t frameEndUs, void *rxCallbackData);  // called when the RX line goes idle after a burst, with the time the last byte ended
 
 typedef struct serialPort_s {
 
@@ -67,17 +72,14 @@ typedef struct serialPort_s {
 
     uint32_t baudRate;
 
-    uint32_t rxBufferSize;
-    uint32_t txBufferSize;
-    volatile uint8_t *rxBuffer;
-    volatile uint8_t *txBuffer;
-    uint32_t rxBufferHead;
-    uint32_t rxBufferTail;
-    uint32_t txBufferHead;
-    uint32_t txBufferTail;
+    spscRing_t rxRing;          // Filled by the ISR or the RX DMA stream, drained by the task
+    spscRing_t txRing;          // Filled by the task, drained by the ISR or the TX DMA stream
 
     serialReceiveCallbackPtr rxCallback;
     void *rxCallbackData;
+    serialIdleCallbackPtr idleCallback;
+
+    volatile bool rxSignalled;  // Set by the driver when bytes were stored in rxRing, cleared by the consumer
 } serialPort_t;
 
 struct serialPortVTable {
@@ -97,6 +99,9 @@ struct serialPortVTable {
 
     void (*writeBuf)(serialPort_t *instance, const void *data, int count);
 
+    // Optional, reads up to count bytes that are already waiting. Returns number of bytes read.
+    uint32_t (*readBuf)(serialPort_t *instance, uint8_t *data, uint32_t count);
+
     bool (*isConnected)(const serialPort_t *instance);
 
     bool (*isIdle)(serialPort_t *instance);
@@ -104,6 +109,9 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+
+    // Optional, replaces the TX ring buffer until the port is opened again. Only while nothing is queued.
+    bool (*setTxBuffer)(serialPort_t *instance, volatile uint8_t *buffer, uint32_t size);
 };
 
 void serialWrite(serialPort_t *instance, uint8_t ch);
@@ -111,6 +119,7 @@ uint32_t serialRxBytesWaiting(const serialPort_t *instance);
 uint32_t serialTxBytesFree(const serialPort_t *instance);
 void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count);
 uint8_t serialRead(serialPort_t *instance);
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count);
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_t mode);
 bool isSerialTransmitBufferEmpty(const serialPort_t *instance);
@@ -118,8 +127,12 @@ void serialPrint(serialPort_t *instance, const char *str);
 uint32_t serialGetBaudRate(serialPort_t *instance);
 bool serialIsConnected(const serialPort_t *instance);
 bool serialIsIdle(serialPort_t *instance);
+void serialSetIdleCallback(serialPort_t *instance, serialIdleCallbackPtr idleCallback);
+bool serialRxSignalled(const serialPort_t *instance);
+void serialClearRxSignal(serialPort_t *instance);
 
 // A shim that adapts the bufWriter API to the serialWriteBuf() API.
 void serialWriteBufShim(void *instance, const uint8_t *data, int count);
 void serialBeginWrite(serialPort_t *instance);
 void serialEndWrite(serialPort_t *instance);
+bool serialSetTxBuffer(serialPort_t *instance, volatile uint8_t *buffer, uint32_t size);
@@ -33,8 +33,11 @@
 
 #include "build/debug.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
+#include "drivers/dma.h"
+#include "drivers/dma_cache.h"
 #include "drivers/nvic.h"
 #include "drivers/io.h"
 #include "drivers/timer.h"
@@ -93,12 +96,50 @@ typedef struct softSerial_s {
 
     uint8_t          softSerialPortIndex;
     timerMode_e      timerMode;
+
+#ifdef USE_SOFTSERIAL_DMA
+    bool             useDma;
+    TCH_t *          txTch;                         // Channel driving the TX pin
+    uint32_t         txBitTicks;                    // [1/256 timer ticks]
+    uint16_t         txEndTick;                     // End of the stop bit of the last queued frame
+    uint16_t         rxBitCenter[RX_TOTAL_BITS];    // [timer ticks] from the falling edge of the start bit
+    uint16_t         rxFrameStart;
+    uint16_t         rxEdgeTail;
+    bool             rxFrameActive;
+    uint8_t          rxLevel;                       // Line level after the last processed edge, 1 is idle
+#endif
 } softSerial_t;
 
 static const struct serialPortVTable softSerialVTable; // Forward
 
 static softSerial_t softSerialPorts[MAX_SOFTSERIAL_PORTS];
 
+#ifdef USE_SOFTSERIAL_DMA
+/*
+ * DMA mode: the timer runs free and its channel DMA stores the time of every RX edge or feeds
+ * the times the TX output toggles at. Bits are decoded and frames built from the main loop,
+ * there are no per-bit or per-edge interrupts.
+ */
+#define SOFTSERIAL_DMA_TIMER_PERIOD     0xFFFF      // Counter wraps before reaching it, a CCR parked here never matches
+#define SOFTSERIAL_DMA_TICKS_PER_BIT    16
+#define SOFTSERIAL_DMA_TX_LEAD_BITS     4           // First edge of a transfer is scheduled this far ahead
+#define SOFTSERIAL_DMA_RX_EDGES         256         // Over 2ms of worst case traffic at 115200
+#define SOFTSERIAL_DMA_TX_CHUNK         16          // Bytes per DMA transfer
+#define SOFTSERIAL_DMA_TX_EDGES         (SOFTSERIAL_DMA_TX_CHUNK * TX_TOTAL_BITS + 1)
+
+// Stream owners are initialized after serial ports, never take a DMA stream one of them is going to need
+#define SOFTSERIAL_DMA_FOREIGN_USAGE    (TIM_USE_MC_MOTOR | TIM_USE_MC_SERVO | TIM_USE_FW_MOTOR | TIM_USE_FW_SERVO | TIM_USE_LED)
+
+typedef struct softSerialDMABuffer_s {
+    timerDMASafeType_t rxEdges[SOFTSERIAL_DMA_RX_EDGES];
+    timerDMASafeType_t txEdges[SOFTSERIAL_DMA_TX_EDGES];
+} softSerialDMABuffer_t;
+
+static DMA_RAM softSerialDMABuffer_t softSerialDMABuffers[MAX_SOFTSERIAL_PORTS];
+
+static bool softSerialDMAConfigure(softSerial_t *softSerial);
+#endif
+
 void onSerialTimerOverflow(TCH_t * tch, uint32_t capture);
 void onSerialRxPinChange(TCH_t * tch, uint32_t capture);
 
@@ -190,15 +231,8 @@ static void serialTimerConfigureTimebase(TCH_t * tch, uint32_t baud)
 
 static void resetBuffers(softSerial_t *softSerial)
 {
-    softSerial->port.rxBufferSize = SOFTSERIAL_BUFFER_SIZE;
-    softSerial->port.rxBuffer = softSerial->rxBuffer;
-    softSerial->port.rxBufferTail = 0;
-    softSerial->port.rxBufferHead = 0;
-
-    softSerial->port.txBuffer = softSerial->txBuffer;
-    softSerial->port.txBufferSize = SOFTSERIAL_BUFFER_SIZE;
-    softSerial->port.txBufferTail = 0;
-    softSerial->port.txBufferHead = 0;
+    spscRingInit(&softSerial->port.rxRing, softSerial->rxBuffer, SOFTSERIAL_BUFFER_SIZE);
+    spscRingInit(&softSerial->port.txRing, softSerial->txBuffer, SOFTSERIAL_BUFFER_SIZE);
 }
 
 serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr rxCallback, void *rxCallbackData, uint32_t baud, portMode_t mode, portOptions_t options)
@@ -311,6 +345,12 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     softSerial->rxActive = false;
     softSerial->isTransmittingData = false;
 
+#ifdef USE_SOFTSERIAL_DMA
+    if (softSerialDMAConfigure(softSerial)) {
+        return &softSerial->port;
+    }
+#endif
+
     // Configure master timer (on RX); time base and input capture
     serialTimerConfigureTimebase(softSerial->tch, baud);
     timerChConfigIC(softSerial->tch, options & SERIAL_INVERTED, 0);
@@ -365,10 +405,8 @@ void processTxState(softSerial_t *softSerial)
         }
 
         // data to send
-        uint8_t byteToSend = softSerial->port.txBuffer[softSerial->port.txBufferTail++];
-        if (softSerial->port.txBufferTail >= softSerial->port.txBufferSize) {
-            softSerial->port.txBufferTail = 0;
-        }
+        uint8_t byteToSend = 0;
+        spscRingGet(&softSerial->port.txRing, &byteToSend);
 
         // build internal buffer, MSB = Stop Bit (1) + data bits (MSB to LSB) + start bit(0) LSB
         softSerial->internalTxBuffer = (1 << (TX_TOTAL_BITS - 1)) | (byteToSend << 1);
@@ -431,6 +469,16 @@ void prepareForNextRxByte(softSerial_t *softSerial)
 #define STOP_BIT_MASK (1 << 0)
 #define START_BIT_MASK (1 << (RX_TOTAL_BITS - 1))
 
+static void storeRxByte(softSerial_t *softSerial, uint8_t rxByte)
+{
+    if (softSerial->port.rxCallback) {
+        softSerial->port.rxCallback(rxByte, softSerial->port.rxCallbackData);
+    } else {
+        spscRingPut(&softSerial->port.rxRing, rxByte);
+        softSerial->port.rxSignalled = true;
+    }
+}
+
 void extractAndStoreRxByte(softSerial_t *softSerial)
 {
     if ((softSerial->port.mode & MODE_RX) == 0) {
@@ -445,14 +493,7 @@ void extractAndStoreRxByte(softSerial_t *softSerial)
         return;
     }
 
-    uint8_t rxByte = (softSerial->internalRxBuffer >> 1) & 0xFF;
-
-    if (softSerial->port.rxCallback) {
-        softSerial->port.rxCallback(rxByte, softSerial->port.rxCallbackData);
-    } else {
-        softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
-        softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
-    }
+    storeRxByte(softSerial, (softSerial->internalRxBuffer >> 1) & 0xFF);
 }
 
 void processRxState(softSerial_t *softSerial)
@@ -553,6 +594,274 @@ void onSerialRxPinChange(TCH_t * tch, uint32_t capture)
 #endif
 }
 
+#ifdef USE_SOFTSERIAL_DMA
+static uint32_t softSerialDMATicksBetween(uint32_t from, uint32_t to)
+{
+    return (to >= from) ? (to - from) : (to + SOFTSERIAL_DMA_TIMER_PERIOD - from);
+}
+
+static uint16_t softSerialDMATickAdd(uint32_t tick, uint32_t ticks)
+{
+    return (tick + ticks) % SOFTSERIAL_DMA_TIMER_PERIOD;
+}
+
+static bool softSerialDMAAvailable(const timerHardware_t *timHw)
+{
+    const DMA_t dma = dmaGetByTag(timHw->dmaTag);
+
+    if (!dma || dmaGetOwner(dma) != OWNER_FREE) {
+        return false;
+    }
+
+    for (int i = 0; i < timerHardwareCount; i++) {
+        const timerHardware_t *other = &timerHardware[i];
+        if (other != timHw && (other->usageFlags & SOFTSERIAL_DMA_FOREIGN_USAGE) && dmaGetByTag(other->dmaTag) == dma) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns the bit length [1/256 timer ticks]
+static uint32_t softSerialDMAConfigureTimebase(TCH_t *tch, uint32_t baud)
+{
+    const uint32_t clock = timerClock(tch->timHw->tim);
+    const uint32_t prescaler = constrain(clock / (baud * SOFTSERIAL_DMA_TICKS_PER_BIT), 1, 0x10000);
+
+    timerConfigure(tch, SOFTSERIAL_DMA_TIMER_PERIOD, clock / prescaler);
+
+    return ((uint64_t)(clock / prescaler) << 8) / baud;
+}
+
+static void softSerialDMAConfigureTiming(softSerial_t *softSerial)
+{
+    if (softSerial->port.mode & MODE_RX) {
+        const uint32_t bitTicks = softSerialDMAConfigureTimebase(softSerial->tch, softSerial->port.baudRate);
+        for (int bit = 0; bit < RX_TOTAL_BITS; bit++) {
+            softSerial->rxBitCenter[bit] = ((2 * bit + 1) * bitTicks) >> 9;
+        }
+    }
+
+    if (softSerial->txTch) {
+        softSerial->txBitTicks = softSerialDMAConfigureTimebase(softSerial->txTch, softSerial->port.baudRate);
+    }
+}
+
+static void softSerialDMAStartRx(softSerial_t *softSerial)
+{
+    serialInputPortActivate(softSerial);
+
+    softSerial->rxEdgeTail = 0;
+    softSerial->rxFrameActive = false;
+    softSerial->rxLevel = 1;
+
+    timerChStartDMACaptureCircular(softSerial->tch, softSerialDMABuffers[softSerial->softSerialPortIndex].rxEdges, SOFTSERIAL_DMA_RX_EDGES, 0);
+}
+
+static bool softSerialDMAConfigure(softSerial_t *softSerial)
+{
+    const bool bidir = softSerial->port.options & SERIAL_BIDIR;
+    softSerialDMABuffer_t *buffer = &softSerialDMABuffers[softSerial->softSerialPortIndex];
+    TCH_t *rxTch = (softSerial->port.mode & MODE_RX) ? softSerial->tch : NULL;
+    TCH_t *txTch = NULL;
+
+    if (softSerial->port.mode & MODE_TX) {
+        // TX pin needs a timer channel of its own unless it is the only pin
+        txTch = (bidir || !(softSerial->port.mode & MODE_RX)) ? softSerial->tch : softSerial->exTch;
+        if (!txTch || (txTch->timHw->output & TIMER_OUTPUT_N_CHANNEL)) {
+            return false;
+        }
+    }
+
+    if ((rxTch && !softSerialDMAAvailable(rxTch->timHw)) || (txTch && txTch != rxTch && !softSerialDMAAvailable(txTch->timHw))) {
+        return false;
+    }
+
+    if (rxTch && txTch && rxTch != txTch && dmaGetByTag(rxTch->timHw->dmaTag) == dmaGetByTag(txTch->timHw->dmaTag)) {
+        return false;
+    }
+
+    softSerial->txTch = txTch;
+    softSerialDMAConfigureTiming(softSerial);
+
+    // Claims the stream, channel modes are set up when capture or output starts
+    if ((rxTch && !timerPWMConfigChannelDMA(rxTch, buffer->rxEdges, sizeof(timerDMASafeType_t), SOFTSERIAL_DMA_RX_EDGES)) ||
+        (txTch && txTch != rxTch && !timerPWMConfigChannelDMA(txTch, buffer->txEdges, sizeof(timerDMASafeType_t), SOFTSERIAL_DMA_TX_EDGES))) {
+        softSerial->txTch = NULL;
+        return false;
+    }
+
+    softSerial->useDma = true;
+
+    if (txTch && !bidir) {
+        // Nothing to toggle at, the output idles at the active level
+        buffer->txEdges[0] = SOFTSERIAL_DMA_TIMER_PERIOD;
+        timerChStartDMAToggle(txTch, buffer->txEdges, 1, softSerial->port.options & SERIAL_INVERTED);
+        IOConfigGPIOAF(softSerial->txIO, IOCFG_AF_PP, txTch->timHw->alternateFunction);
+    }
+
+    if (rxTch) {
+        softSerialDMAStartRx(softSerial);
+    }
+
+    return true;
+}
+
+static void softSerialDMASampleRxBits(softSerial_t *softSerial, uint32_t ticksFromStart)
+{
+    while (softSerial->rxBitIndex < RX_TOTAL_BITS && softSerial->rxBitCenter[softSerial->rxBitIndex] < ticksFromStart) {
+        if (softSerial->rxLevel) {
+            softSerial->internalRxBuffer |= 1 << softSerial->rxBitIndex;
+        }
+        softSerial->rxBitIndex++;
+    }
+
+    if (softSerial->rxBitIndex == RX_TOTAL_BITS) {
+        softSerial->rxFrameActive = false;
+
+        // Start bit is the LSB here, stop bit the MSB
+        if ((softSerial->internalRxBuffer & (1 << 0 | 1 << (RX_TOTAL_BITS - 1))) == (1 << (RX_TOTAL_BITS - 1))) {
+            storeRxByte(softSerial, (softSerial->internalRxBuffer >> 1) & 0xFF);
+        } else {
+            softSerial->receiveErrors++;
+        }
+    }
+}
+
+static void softSerialDMAProcessRxEdge(softSerial_t *softSerial, uint16_t edgeTick)
+{
+    if (softSerial->rxFrameActive) {
+        // Bits before this edge still have the previous level
+        softSerialDMASampleRxBits(softSerial, softSerialDMATicksBetween(softSerial->rxFrameStart, edgeTick));
+    }
+
+    softSerial->rxLevel = !softSerial->rxLevel;
+
+    // Between frames the line only leaves idle for a start bit. A low stop bit returns to idle with the next edge
+    if (!softSerial->rxFrameActive && !softSerial->rxLevel) {
+        softSerial->rxFrameActive = true;
+        softSerial->rxFrameStart = edgeTick;
+        softSerial->rxBitIndex = 0;
+        softSerial->internalRxBuffer = 0;
+    }
+}
+
+static void softSerialDMAProcessRx(softSerial_t *softSerial)
+{
+    if (!softSerial->rxActive) {
+        return;
+    }
+
+    TCH_t *tch = softSerial->tch;
+    const timerDMASafeType_t *edges = softSerialDMABuffers[softSerial->softSerialPortIndex].rxEdges;
+    const uint32_t head = timerChGetDMACapturePosition(tch);
+    const uint32_t now = tch->timHw->tim->CNT;
+    const bool edgeArrived = timerChGetDMACapturePosition(tch) != head;
+
+    dmaCacheInvalidateForCpu(edges, sizeof(softSerialDMABuffers[0].rxEdges));
+
+    while (softSerial->rxEdgeTail != head) {
+        softSerialDMAProcessRxEdge(softSerial, edges[softSerial->rxEdgeTail]);
+        softSerial->rxEdgeTail = (softSerial->rxEdgeTail + 1) % SOFTSERIAL_DMA_RX_EDGES;
+    }
+
+    // Trailing ones and the stop bit leave no edge, the frame is complete when its stop bit is past.
+    // An edge stored while reading the counter has to be processed first
+    if (softSerial->rxFrameActive && !edgeArrived) {
+        const uint32_t ticksFromStart = softSerialDMATicksBetween(softSerial->rxFrameStart, now);
+        if (ticksFromStart < SOFTSERIAL_DMA_TIMER_PERIOD / 2) {
+            softSerialDMASampleRxBits(softSerial, ticksFromStart);
+        }
+    }
+}
+
+static void softSerialDMAProcessTx(softSerial_t *softSerial)
+{
+    TCH_t *tch = softSerial->txTch;
+    const bool bidir = softSerial->port.options & SERIAL_BIDIR;
+
+    if (!tch || tch->dmaState != TCH_DMA_IDLE) {
+        return;
+    }
+
+    // Last frame queued is still on the line until the counter passes the end of its stop bit
+    const uint32_t lead = (SOFTSERIAL_DMA_TX_LEAD_BITS * softSerial->txBitTicks) >> 8;
+    const uint32_t untilEnd = softSerialDMATicksBetween(tch->timHw->tim->CNT, softSerial->txEndTick);
+    const bool lineBusy = softSerial->isTransmittingData && untilEnd < SOFTSERIAL_DMA_TIMER_PERIOD / 2;
+
+    if (spscRingIsEmpty(&softSerial->port.txRing)) {
+        if (softSerial->isTransmittingData && !lineBusy) {
+            softSerial->isTransmittingData = false;
+            if (bidir) {
+                // Half-duplex: back to listening
+                softSerialDMAStartRx(softSerial);
+            }
+        }
+        return;
+    }
+
+    if (bidir && softSerial->rxActive) {
+        // Half-duplex: keep what was received so far and turn the pin around
+        softSerialDMAProcessRx(softSerial);
+        serialInputPortDeActivate(softSerial);
+    }
+
+    timerDMASafeType_t *edges = softSerialDMABuffers[softSerial->softSerialPortIndex].txEdges;
+    uint32_t edgeCount = 0;
+    uint32_t bitCount = 0;
+    uint8_t level = 1;
+
+    uint8_t byteToSend;
+    for (int byteCount = 0; byteCount < SOFTSERIAL_DMA_TX_CHUNK && spscRingGet(&softSerial->port.txRing, &byteToSend); byteCount++) {
+        // Start bit (0) as LSB, stop bit (1) as MSB
+        const uint16_t frame = (1 << (TX_TOTAL_BITS - 1)) | (byteToSend << 1);
+        for (int bit = 0; bit < TX_TOTAL_BITS; bit++, bitCount++) {
+            const uint8_t bitLevel = (frame >> bit) & 1;
+            if (bitLevel != level) {
+                edges[edgeCount++] = (bitCount * softSerial->txBitTicks) >> 8;
+                level = bitLevel;
+            }
+        }
+    }
+
+    // Follows the previous frame back to back if it has not ended yet. Should this code get delayed past the
+    // first edge, the transfer goes out intact one counter period later
+    const uint32_t start = (lineBusy && untilEnd > lead) ? softSerial->txEndTick : softSerialDMATickAdd(tch->timHw->tim->CNT, lead);
+    for (uint32_t i = 0; i < edgeCount; i++) {
+        edges[i] = softSerialDMATickAdd(start, edges[i]);
+    }
+    edges[edgeCount++] = SOFTSERIAL_DMA_TIMER_PERIOD;
+
+    softSerial->txEndTick = softSerialDMATickAdd(start, (bitCount * softSerial->txBitTicks) >> 8);
+    softSerial->isTransmittingData = true;
+
+    timerChStartDMAToggle(tch, edges, edgeCount, softSerial->port.options & SERIAL_INVERTED);
+
+    if (bidir) {
+        IOConfigGPIOAF(softSerial->txIO, IOCFG_AF_PP, tch->timHw->alternateFunction);
+    }
+}
+
+void softSerialProcess(void)
+{
+    for (int i = 0; i < MAX_SOFTSERIAL_PORTS; i++) {
+        softSerial_t *softSerial = &softSerialPorts[i];
+
+        if (!softSerial->useDma) {
+            continue;
+        }
+
+        if (softSerial->port.mode & MODE_RX) {
+            softSerialDMAProcessRx(softSerial);
+        }
+
+        if (softSerial->port.mode & MODE_TX) {
+            softSerialDMAProcessTx(softSerial);
+        }
+    }
+}
+#endif
 
 /*
  * Standard serial driver API
@@ -566,7 +875,13 @@ uint32_t softSerialRxBytesWaiting(const serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
-    return (s->port.rxBufferHead - s->port.rxBufferTail) & (s->port.rxBufferSize - 1);
+#ifdef USE_SOFTSERIAL_DMA
+    if (s->useDma) {
+        softSerialDMAProcessRx(s);
+    }
+#endif
+
+    return spscRingCount(&s->port.rxRing);
 }
 
 uint32_t softSerialTxBytesFree(const serialPort_t *instance)
@@ -577,14 +892,18 @@ uint32_t softSerialTxBytesFree(const serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
-    uint32_t bytesUsed = (s->port.txBufferHead - s->port.txBufferTail) & (s->port.txBufferSize - 1);
+#ifdef USE_SOFTSERIAL_DMA
+    if (s->useDma) {
+        softSerialDMAProcessTx(s);
+    }
+#endif
 
-    return (s->port.txBufferSize - 1) - bytesUsed;
+    return spscRingFree(&s->port.txRing);
 }
 
 uint8_t softSerialReadByte(serialPort_t *instance)
 {
-    uint8_t ch;
+    uint8_t ch = 0;
 
     if ((instance->mode & MODE_RX) == 0) {
         return 0;
@@ -594,8 +913,7 @@ uint8_t softSerialReadByte(serialPort_t *instance)
         return 0;
     }
 
-    ch = instance->rxBuffer[instance->rxBufferTail];
-    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    spscRingGet(&instance->rxRing, &ch);
     return ch;
 }
 
@@ -605,8 +923,7 @@ void softSerialWriteByte(serialPort_t *s, uint8_t ch)
         return;
     }
 
-    s->txBuffer[s->txBufferHead] = ch;
-    s->txBufferHead = (s->txBufferHead + 1) % s->txBufferSize;
+    spscRingPut(&s->txRing, ch);
 }
 
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
@@ -615,6 +932,13 @@ void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
 
     softSerial->port.baudRate = baudRate;
 
+#ifdef USE_SOFTSERIAL_DMA
+    if (softSerial->useDma) {
+        softSerialDMAConfigureTiming(softSerial);
+        return;
+    }
+#endif
+
     serialTimerConfigureTimebase(softSerial->tch, baudRate);
 }
 
@@ -625,7 +949,14 @@ void softSerialSetMode(serialPort_t *instance, portMode_t mode)
 
 bool isSoftSerialTransmitBufferEmpty(const serialPort_t *instance)
 {
-    return instance->txBufferHead == instance->txBufferTail;
+#ifdef USE_SOFTSERIAL_DMA
+    softSerial_t *s = (softSerial_t *)instance;
+    if (s->useDma) {
+        softSerialDMAProcessTx(s);
+    }
+#endif
+
+    return spscRingIsEmpty(&instance->txRing);
 }
 
 static const struct serialPortVTable softSerialVTable = {
@@ -638,6 +969,7 @@ static const struct serialPortVTable softSerialVTable = {
     .setMode = softSerialSetMode,
     .isConnected = NULL,
     .writeBuf = NULL,
+    .readBuf = NULL,
     .beginWrite = NULL,
     .endWrite = NULL,
     .isIdle = NULL,
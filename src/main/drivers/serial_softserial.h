@@ -33,3 +33,8 @@ uint32_t softSerialTxBytesFree(const serialPort_t *instance);
 uint8_t softSerialReadByte(serialPort_t *instance);
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate);
 bool isSoftSerialTransmitBufferEmpty(const serialPort_t *s);
+
+#ifdef USE_SOFTSERIAL_DMA
+// Decodes captured RX edges and queues TX frames of ports running on DMA
+void softSerialProcess(void);
+#endif
@@ -22,13 +22,18 @@
 */
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
+#include "build/atomic.h"
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
+#include "drivers/nvic.h"
+#include "drivers/time.h"
 #include "drivers/uart_inverter.h"
 
 #include "serial.h"
@@ -73,7 +78,7 @@ static void uartReconfigure(uartPort_t *uartPort)
     USART_InitStructure.USART_StopBits = (uartPort->port.options & SERIAL_STOPBITS_2) ? USART_StopBits_2 : USART_StopBits_1;
     USART_InitStructure.USART_Parity   = (uartPort->port.options & SERIAL_PARITY_EVEN) ? USART_Parity_Even : USART_Parity_No;
 
-    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_HardwareFlowControl = uartPort->ctsEnabled ? USART_HardwareFlowControl_CTS : USART_HardwareFlowControl_None;
     USART_InitStructure.USART_Mode = 0;
     if (uartPort->port.mode & MODE_RX)
         USART_InitStructure.USART_Mode |= USART_Mode_Rx;
@@ -92,6 +97,202 @@ static void uartReconfigure(uartPort_t *uartPort)
     USART_Cmd(uartPort->USARTx, ENABLE);
 }
 
+#if defined(USE_UART_RX_DMA) || defined(USE_UART_TX_DMA)
+static DMA_t uartDmaClaim(dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (tag == DMA_NONE) {
+        return NULL;
+    }
+
+    DMA_t dma = dmaGetByTag(tag);
+    if (!dma || dmaGetOwner(dma) != OWNER_FREE) {
+        return NULL;
+    }
+
+    dmaInit(dma, OWNER_SERIAL, resourceIndex);
+    return dma;
+}
+#endif
+
+#ifdef USE_UART_RX_DMA
+// 1 start bit, 8 data bits, optional parity and 1 or 2 stop bits
+static timeUs_t uartCharTimeUs(const uartPort_t *s)
+{
+    const uint32_t bits = 10 + ((s->port.options & SERIAL_PARITY_EVEN) ? 1 : 0) + ((s->port.options & SERIAL_STOPBITS_2) ? 1 : 0);
+    return (bits * 1000000 + s->port.baudRate - 1) / s->port.baudRate;
+}
+
+static uint32_t uartRxDmaHead(const uartPort_t *s)
+{
+    // The stream counts down the bytes left before it wraps around the buffer
+    return s->port.rxRing.size - DMA_GetCurrDataCounter(s->rxDma->ref);
+}
+
+void uartRxDmaReceive(uartPort_t *s, bool idle)
+{
+    const uint32_t head = s->port.rxRing.head;
+
+    spscRingSetHead(&s->port.rxRing, uartRxDmaHead(s));
+
+    if (s->port.rxCallback) {
+        // Everything received since the last interrupt is handed over in one burst
+        uint8_t ch;
+        while (spscRingGet(&s->port.rxRing, &ch)) {
+            s->port.rxCallback(ch, s->port.rxCallbackData);
+        }
+    } else if (s->port.rxRing.head != head) {
+        s->port.rxSignalled = true;
+    }
+
+    if (idle) {
+        s->rxIdle = true;
+        if (s->port.idleCallback) {
+            // The line has been idle for one character time when the flag is raised
+            s->port.idleCallback(micros() - uartCharTimeUs(s), s->port.rxCallbackData);
+        }
+    }
+}
+
+static void uartRxDmaIrqHandler(DMA_t dma)
+{
+    uartPort_t *s = (uartPort_t *)dma->userParam;
+
+    DMA_CLEAR_FLAG(dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    uartRxDmaReceive(s, false);
+}
+
+bool uartRxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (s->rxDma) {
+        // Keeps running from an earlier open of the same port
+        return true;
+    }
+
+    DMA_t dma = uartDmaClaim(tag, resourceIndex);
+    if (!dma) {
+        return false;
+    }
+
+    DMA_InitTypeDef DMA_InitStructure;
+    DMA_Cmd(dma->ref, DISABLE);
+    DMA_DeInit(dma->ref);
+    DMA_StructInit(&DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Channel = dmaGetChannelByTag(tag);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)s->port.rxRing.buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = s->port.rxRing.size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+
+    DMA_Init(dma->ref, &DMA_InitStructure);
+
+    // Half and full transfer interrupts drain long bursts before the stream wraps onto unread data
+    DMA_ITConfig(dma->ref, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    dmaSetHandler(dma, uartRxDmaIrqHandler, NVIC_PRIO_SERIALUART, (uint32_t)s);
+    DMA_Cmd(dma->ref, ENABLE);
+
+    s->rxDma = dma;
+    return true;
+}
+#endif
+
+#ifdef USE_UART_TX_DMA
+// Called with the UART interrupts masked
+void uartStartTxDMA(uartPort_t *s)
+{
+    if (s->txDmaLength || spscRingIsEmpty(&s->port.txRing)) {
+        return;
+    }
+
+    // The ring is handed over in contiguous chunks, a wrapped ring goes out in two transfers
+    volatile uint8_t *span;
+    const uint32_t length = spscRingReadSpan(&s->port.txRing, &span);
+
+    s->txDmaLength = length;
+    s->txDma->ref->M0AR = (uint32_t)span;
+    DMA_SetCurrDataCounter(s->txDma->ref, length);
+    DMA_Cmd(s->txDma->ref, ENABLE);
+}
+
+static void uartTxDmaIrqHandler(DMA_t dma)
+{
+    uartPort_t *s = (uartPort_t *)dma->userParam;
+
+    DMA_CLEAR_FLAG(dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    spscRingCommitRead(&s->port.txRing, s->txDmaLength);
+    s->txDmaLength = 0;
+    uartStartTxDMA(s);
+}
+
+bool uartTxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (s->txDma) {
+        // Reopening the port drops whatever was still queued
+        DMA_Cmd(s->txDma->ref, DISABLE);
+        s->txDmaLength = 0;
+        return true;
+    }
+
+    DMA_t dma = uartDmaClaim(tag, resourceIndex);
+    if (!dma) {
+        return false;
+    }
+
+    DMA_InitTypeDef DMA_InitStructure;
+    DMA_Cmd(dma->ref, DISABLE);
+    DMA_DeInit(dma->ref);
+    DMA_StructInit(&DMA_InitStructure);
+
+    DMA_InitStructure.DMA_Channel = dmaGetChannelByTag(tag);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)s->port.txRing.buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = s->port.txRing.size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+
+    DMA_Init(dma->ref, &DMA_InitStructure);
+
+    DMA_ITConfig(dma->ref, DMA_IT_TC | DMA_IT_TE, ENABLE);
+    dmaSetHandler(dma, uartTxDmaIrqHandler, NVIC_PRIO_SERIALUART, (uint32_t)s);
+
+    s->txDma = dma;
+    s->txDmaLength = 0;
+    return true;
+}
+#endif
+
+// Starts draining the TX ring, DMA ports hold off until endWrite unless the ring has to make room
+static void uartTxKick(uartPort_t *s, bool flush)
+{
+#ifdef USE_UART_TX_DMA
+    if (s->txDma) {
+        if (flush || !s->txDmaDeferred) {
+            ATOMIC_BLOCK(NVIC_PRIO_SERIALUART) {
+                uartStartTxDMA(s);
+            }
+        }
+        return;
+    }
+#else
+    UNUSED(flush);
+#endif
+    USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+}
+
 serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr rxCallback, void *rxCallbackData, uint32_t baudRate, portMode_t mode, portOptions_t options)
 {
     uartPort_t *s = NULL;
@@ -136,22 +337,41 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr rxCallbac
     }
 
     // common serial initialisation code should move to serialPort::init()
-    s->port.rxBufferHead = s->port.rxBufferTail = 0;
-    s->port.txBufferHead = s->port.txBufferTail = 0;
+    spscRingReset(&s->port.rxRing);
+    spscRingReset(&s->port.txRing);
     // callback works for IRQ-based RX ONLY
     s->port.rxCallback = rxCallback;
     s->port.rxCallbackData = rxCallbackData;
+    s->port.idleCallback = NULL;
     s->port.mode = mode;
     s->port.baudRate = baudRate;
     s->port.options = options;
 
     uartReconfigure(s);
 
+#ifdef USE_UART_RX_DMA
+    if ((mode & MODE_RX) && s->rxDma) {
+        // Bytes are moved by the DMA stream, the idle line interrupt marks the end of each burst.
+        // The stream may still be running from an earlier open, start reading where it is now
+        spscRingSetHead(&s->port.rxRing, uartRxDmaHead(s));
+        spscRingFlush(&s->port.rxRing);
+        s->rxIdle = false;
+        USART_DMACmd(s->USARTx, USART_DMAReq_Rx, ENABLE);
+        uartClearIdleFlag(s);
+        USART_ITConfig(s->USARTx, USART_IT_IDLE, ENABLE);
+    } else
+#endif
     if (mode & MODE_RX) {
         USART_ClearITPendingBit(s->USARTx, USART_IT_RXNE);
         USART_ITConfig(s->USARTx, USART_IT_RXNE, ENABLE);
     }
 
+#ifdef USE_UART_TX_DMA
+    s->txDmaDeferred = false;
+    if ((mode & MODE_TX) && s->txDma) {
+        USART_DMACmd(s->USARTx, USART_DMAReq_Tx, ENABLE);
+    } else
+#endif
     if (mode & MODE_TX) {
         USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
     }
@@ -178,46 +398,27 @@ void uartSetMode(serialPort_t *instance, portMode_t mode)
 uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t*)instance;
-
-    if (s->port.rxBufferHead >= s->port.rxBufferTail) {
-        return s->port.rxBufferHead - s->port.rxBufferTail;
-    } else {
-        return s->port.rxBufferSize + s->port.rxBufferHead - s->port.rxBufferTail;
-    }
+    return spscRingCount(&s->port.rxRing);
 }
 
 uint32_t uartTotalTxBytesFree(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t*)instance;
-
-    uint32_t bytesUsed;
-
-    if (s->port.txBufferHead >= s->port.txBufferTail) {
-        bytesUsed = s->port.txBufferHead - s->port.txBufferTail;
-    } else {
-        bytesUsed = s->port.txBufferSize + s->port.txBufferHead - s->port.txBufferTail;
-    }
-
-    return (s->port.txBufferSize - 1) - bytesUsed;
+    return spscRingFree(&s->port.txRing);
 }
 
 bool isUartTransmitBufferEmpty(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t *)instance;
-    return s->port.txBufferTail == s->port.txBufferHead;
+    return spscRingIsEmpty(&s->port.txRing);
 }
 
 uint8_t uartRead(serialPort_t *instance)
 {
-    uint8_t ch;
+    uint8_t ch = 0;
     uartPort_t *s = (uartPort_t *)instance;
 
-    ch = s->port.rxBuffer[s->port.rxBufferTail];
-    if (s->port.rxBufferTail + 1 >= s->port.rxBufferSize) {
-        s->port.rxBufferTail = 0;
-    } else {
-        s->port.rxBufferTail++;
-    }
+    spscRingGet(&s->port.rxRing, &ch);
 
     return ch;
 }
@@ -225,19 +426,74 @@ uint8_t uartRead(serialPort_t *instance)
 void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    s->port.txBuffer[s->port.txBufferHead] = ch;
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
-    } else {
-        s->port.txBufferHead++;
+    spscRingPut(&s->port.txRing, ch);
+
+    // A full ring can't wait for endWrite
+    uartTxKick(s, uartTotalTxBytesFree(instance) == 0);
+}
+
+static void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        const uint32_t written = spscRingWrite(&s->port.txRing, p, count);
+        if (!written) {
+            // Frames larger than the ring go out in parts, even between beginWrite and endWrite
+            uartTxKick(s, true);
+            continue;
+        }
+
+        p += written;
+        count -= written;
     }
 
-    USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+    uartTxKick(s, false);
+}
+
+#ifdef USE_UART_TX_DMA
+static void uartBeginWrite(serialPort_t *instance)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->txDmaDeferred = true;
+}
+
+static void uartEndWrite(serialPort_t *instance)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->txDmaDeferred = false;
+    uartTxKick(s, true);
+}
+#endif
+
+static bool uartSetTxBuffer(serialPort_t *instance, volatile uint8_t *buffer, uint32_t size)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    // An empty ring also means no TX DMA transfer is in flight, it commits the read when it completes
+    if (!isUartTransmitBufferEmpty(instance)) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_SERIALUART) {
+        spscRingInit(&s->port.txRing, buffer, size);
+    }
+
+    return true;
 }
 
 bool isUartIdle(serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t *)instance;
+#ifdef USE_UART_RX_DMA
+    if (s->rxDma) {
+        // The idle flag is consumed by the interrupt handler
+        const bool idle = s->rxIdle;
+        s->rxIdle = false;
+        return idle;
+    }
+#endif
     if(USART_GetFlagStatus(s->USARTx, USART_FLAG_IDLE)) {
         uartClearIdleFlag(s);
         return true;
@@ -256,9 +512,16 @@ const struct serialPortVTable uartVTable[] = {
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
         .isConnected = NULL,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
+        .readBuf = NULL,
+#ifdef USE_UART_TX_DMA
+        .beginWrite = uartBeginWrite,
+        .endWrite = uartEndWrite,
+#else
         .beginWrite = NULL,
         .endWrite = NULL,
+#endif
         .isIdle = isUartIdle,
+        .setTxBuffer = uartSetTxBuffer,
     }
 };
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "drivers/dma.h"
+
 #define UART_AF(uart, af) CONCAT3(GPIO_AF, af, _ ## uart)
 
 // Since serial ports can be used for any function these buffer sizes should be equal
@@ -61,6 +63,21 @@ typedef struct {
 #endif
 
     USART_TypeDef *USARTx;
+
+    bool ctsEnabled;                    // SERIAL_CTS was asked for and the target assigns a CTS pin
+
+#ifdef USE_UART_RX_DMA
+    // Circular RX stream writing into port.rxRing, NULL when receiving byte by byte
+    DMA_t rxDma;
+    volatile bool rxIdle;
+#endif
+
+#ifdef USE_UART_TX_DMA
+    // Normal mode TX stream sending contiguous chunks of port.txRing, NULL when sending byte by byte
+    DMA_t txDma;
+    volatile uint32_t txDmaLength;      // Bytes in flight, 0 when the stream is idle
+    bool txDmaDeferred;                 // Between beginWrite and endWrite, the frame is sent in one go
+#endif
 } uartPort_t;
 
 void uartGetPortPins(UARTDevice_e device, serialPortPins_t * pins);
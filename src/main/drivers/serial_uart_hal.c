@@ -23,14 +23,19 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "platform.h"
 
+#include "build/atomic.h"
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
+#include "drivers/dma_cache.h"
 #include "drivers/io.h"
 #include "drivers/nvic.h"
+#include "drivers/time.h"
 
 #include "serial.h"
 #include "serial_uart.h"
@@ -74,7 +79,7 @@ static void uartReconfigure(uartPort_t *uartPort)
     uartPort->Handle.Init.WordLength = (uartPort->port.options & SERIAL_PARITY_EVEN) ? UART_WORDLENGTH_9B : UART_WORDLENGTH_8B;
     uartPort->Handle.Init.StopBits = (uartPort->port.options & SERIAL_STOPBITS_2) ? USART_STOPBITS_2 : USART_STOPBITS_1;
     uartPort->Handle.Init.Parity = (uartPort->port.options & SERIAL_PARITY_EVEN) ? USART_PARITY_EVEN : USART_PARITY_NONE;
-    uartPort->Handle.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    uartPort->Handle.Init.HwFlowCtl = uartPort->ctsEnabled ? UART_HWCONTROL_CTS : UART_HWCONTROL_NONE;
     uartPort->Handle.Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
     uartPort->Handle.Init.Mode = 0;
 
@@ -102,18 +107,237 @@ static void uartReconfigure(uartPort_t *uartPort)
         /* Enable the UART Error Interrupt: (Frame error, noise error, overrun error) */
         SET_BIT(uartPort->USARTx->CR3, USART_CR3_EIE);
 
+#ifdef USE_UART_RX_DMA
+        if (uartPort->rxDma) {
+            /* Bytes are moved by the DMA stream, the idle line interrupt marks the end of each burst */
+            SET_BIT(uartPort->USARTx->CR3, USART_CR3_DMAR);
+            __HAL_UART_CLEAR_IDLEFLAG(&uartPort->Handle);
+            SET_BIT(uartPort->USARTx->CR1, USART_CR1_IDLEIE);
+        } else
+#endif
         /* Enable the UART Data Register not empty Interrupt */
         SET_BIT(uartPort->USARTx->CR1, USART_CR1_RXNEIE);
     }
 
     // Transmit IRQ
     if (uartPort->port.mode & MODE_TX) {
+#ifdef USE_UART_TX_DMA
+        if (uartPort->txDma) {
+            /* The TX stream is started whenever bytes are queued */
+            SET_BIT(uartPort->USARTx->CR3, USART_CR3_DMAT);
+        } else
+#endif
         /* Enable the UART Transmit Data Register Empty Interrupt */
         SET_BIT(uartPort->USARTx->CR1, USART_CR1_TXEIE);
     }
     return;
 }
 
+#if defined(USE_UART_RX_DMA) || defined(USE_UART_TX_DMA)
+static const uint32_t uartDmaLLStreamTable[] = { LL_DMA_STREAM_0, LL_DMA_STREAM_1, LL_DMA_STREAM_2, LL_DMA_STREAM_3, LL_DMA_STREAM_4, LL_DMA_STREAM_5, LL_DMA_STREAM_6, LL_DMA_STREAM_7 };
+
+#if !defined(STM32H7)
+static const uint32_t uartDmaLLChannelTable[] = { LL_DMA_CHANNEL_0, LL_DMA_CHANNEL_1, LL_DMA_CHANNEL_2, LL_DMA_CHANNEL_3, LL_DMA_CHANNEL_4, LL_DMA_CHANNEL_5, LL_DMA_CHANNEL_6, LL_DMA_CHANNEL_7 };
+#endif
+
+static DMA_t uartDmaClaim(dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (tag == DMA_NONE) {
+        return NULL;
+    }
+
+    DMA_t dma = dmaGetByTag(tag);
+    if (!dma || dmaGetOwner(dma) != OWNER_FREE) {
+        return NULL;
+    }
+
+    dmaInit(dma, OWNER_SERIAL, resourceIndex);
+    return dma;
+}
+
+static void uartDmaInitStream(DMA_t dma, dmaTag_t tag, uint32_t periphAddress, volatile uint8_t *buffer, uint32_t length, bool isRx)
+{
+    const uint32_t streamLL = uartDmaLLStreamTable[DMATAG_GET_STREAM(tag)];
+
+    LL_DMA_DisableStream(dma->dma, streamLL);
+    LL_DMA_DeInit(dma->dma, streamLL);
+
+    LL_DMA_InitTypeDef init;
+    LL_DMA_StructInit(&init);
+
+#if defined(STM32H7)
+    init.PeriphRequest = DMATAG_GET_CHANNEL(tag);
+#else
+    init.Channel = uartDmaLLChannelTable[DMATAG_GET_CHANNEL(tag)];
+#endif
+    init.PeriphOrM2MSrcAddress = periphAddress;
+    init.MemoryOrM2MDstAddress = (uint32_t)buffer;
+    init.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+    init.PeriphOrM2MSrcDataSize = LL_DMA_PDATAALIGN_BYTE;
+    init.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+    init.MemoryOrM2MDstDataSize = LL_DMA_MDATAALIGN_BYTE;
+    init.NbData = length;
+    init.Direction = isRx ? LL_DMA_DIRECTION_PERIPH_TO_MEMORY : LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+    init.Mode = isRx ? LL_DMA_MODE_CIRCULAR : LL_DMA_MODE_NORMAL;
+    init.Priority = isRx ? LL_DMA_PRIORITY_MEDIUM : LL_DMA_PRIORITY_LOW;
+    init.FIFOMode = LL_DMA_FIFOMODE_DISABLE;
+
+    LL_DMA_Init(dma->dma, streamLL, &init);
+}
+#endif
+
+#ifdef USE_UART_RX_DMA
+
+// 1 start bit, 8 data bits, optional parity and 1 or 2 stop bits
+static timeUs_t uartCharTimeUs(const uartPort_t *s)
+{
+    const uint32_t bits = 10 + ((s->port.options & SERIAL_PARITY_EVEN) ? 1 : 0) + ((s->port.options & SERIAL_STOPBITS_2) ? 1 : 0);
+    return (bits * 1000000 + s->port.baudRate - 1) / s->port.baudRate;
+}
+
+static uint32_t uartRxDmaHead(const uartPort_t *s)
+{
+    // The stream counts down the bytes left before it wraps around the buffer
+    return s->port.rxRing.size - LL_DMA_GetDataLength(s->rxDma->dma, uartDmaLLStreamTable[DMATAG_GET_STREAM(s->rxDma->tag)]);
+}
+
+void uartRxDmaReceive(uartPort_t *s, bool idle)
+{
+    const uint32_t head = s->port.rxRing.head;
+
+    dmaCacheInvalidateForCpu(s->port.rxRing.buffer, s->port.rxRing.size);
+    spscRingSetHead(&s->port.rxRing, uartRxDmaHead(s));
+
+    if (s->port.rxCallback) {
+        // Everything received since the last interrupt is handed over in one burst
+        uint8_t ch;
+        while (spscRingGet(&s->port.rxRing, &ch)) {
+            s->port.rxCallback(ch, s->port.rxCallbackData);
+        }
+    } else if (s->port.rxRing.head != head) {
+        s->port.rxSignalled = true;
+    }
+
+    if (idle) {
+        s->rxIdle = true;
+        if (s->port.idleCallback) {
+            // The line has been idle for one character time when the flag is raised
+            s->port.idleCallback(micros() - uartCharTimeUs(s), s->port.rxCallbackData);
+        }
+    }
+}
+
+static void uartRxDmaIrqHandler(DMA_t dma)
+{
+    uartPort_t *s = (uartPort_t *)dma->userParam;
+
+    DMA_CLEAR_FLAG(dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    uartRxDmaReceive(s, false);
+}
+
+bool uartRxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (s->rxDma) {
+        // Keeps running from an earlier open of the same port
+        return true;
+    }
+
+    DMA_t dma = uartDmaClaim(tag, resourceIndex);
+    if (!dma) {
+        return false;
+    }
+
+    const uint32_t streamLL = uartDmaLLStreamTable[DMATAG_GET_STREAM(tag)];
+    uartDmaInitStream(dma, tag, (uint32_t)&s->USARTx->RDR, s->port.rxRing.buffer, s->port.rxRing.size, true);
+
+    // Half and full transfer interrupts drain long bursts before the stream wraps onto unread data
+    LL_DMA_EnableIT_HT(dma->dma, streamLL);
+    LL_DMA_EnableIT_TC(dma->dma, streamLL);
+    dmaSetHandler(dma, uartRxDmaIrqHandler, NVIC_PRIO_SERIALUART, (uint32_t)s);
+    LL_DMA_EnableStream(dma->dma, streamLL);
+
+    s->rxDma = dma;
+    return true;
+}
+#endif
+
+#ifdef USE_UART_TX_DMA
+// Called with the UART interrupts masked
+void uartStartTxDMA(uartPort_t *s)
+{
+    if (s->txDmaLength || spscRingIsEmpty(&s->port.txRing)) {
+        return;
+    }
+
+    // The ring is handed over in contiguous chunks, a wrapped ring goes out in two transfers
+    volatile uint8_t *span;
+    const uint32_t length = spscRingReadSpan(&s->port.txRing, &span);
+    const uint32_t streamLL = uartDmaLLStreamTable[DMATAG_GET_STREAM(s->txDma->tag)];
+
+    dmaCacheCleanForDevice(span, length);
+
+    s->txDmaLength = length;
+    LL_DMA_SetMemoryAddress(s->txDma->dma, streamLL, (uint32_t)span);
+    LL_DMA_SetDataLength(s->txDma->dma, streamLL, length);
+    LL_DMA_EnableStream(s->txDma->dma, streamLL);
+}
+
+static void uartTxDmaIrqHandler(DMA_t dma)
+{
+    uartPort_t *s = (uartPort_t *)dma->userParam;
+
+    DMA_CLEAR_FLAG(dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    spscRingCommitRead(&s->port.txRing, s->txDmaLength);
+    s->txDmaLength = 0;
+    uartStartTxDMA(s);
+}
+
+bool uartTxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex)
+{
+    if (s->txDma) {
+        // Reopening the port drops whatever was still queued
+        LL_DMA_DisableStream(s->txDma->dma, uartDmaLLStreamTable[DMATAG_GET_STREAM(s->txDma->tag)]);
+        s->txDmaLength = 0;
+        return true;
+    }
+
+    DMA_t dma = uartDmaClaim(tag, resourceIndex);
+    if (!dma) {
+        return false;
+    }
+
+    const uint32_t streamLL = uartDmaLLStreamTable[DMATAG_GET_STREAM(tag)];
+    uartDmaInitStream(dma, tag, (uint32_t)&s->USARTx->TDR, s->port.txRing.buffer, s->port.txRing.size, false);
+
+    LL_DMA_EnableIT_TC(dma->dma, streamLL);
+    LL_DMA_EnableIT_TE(dma->dma, streamLL);
+    dmaSetHandler(dma, uartTxDmaIrqHandler, NVIC_PRIO_SERIALUART, (uint32_t)s);
+
+    s->txDma = dma;
+    s->txDmaLength = 0;
+    return true;
+}
+#endif
+
+// Starts draining the TX ring, DMA ports hold off until endWrite unless the ring has to make room
+static void uartTxKick(uartPort_t *s, bool flush)
+{
+#ifdef USE_UART_TX_DMA
+    if (s->txDma) {
+        if (flush || !s->txDmaDeferred) {
+            ATOMIC_BLOCK(NVIC_PRIO_SERIALUART) {
+                uartStartTxDMA(s);
+            }
+        }
+        return;
+    }
+#else
+    UNUSED(flush);
+#endif
+    __HAL_UART_ENABLE_IT(&s->Handle, UART_IT_TXE);
+}
+
 serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback, void *rxCallbackData, uint32_t baudRate, portMode_t mode, portOptions_t options)
 {
     uartPort_t *s = NULL;
@@ -157,15 +381,29 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
 
 
     // common serial initialisation code should move to serialPort::init()
-    s->port.rxBufferHead = s->port.rxBufferTail = 0;
-    s->port.txBufferHead = s->port.txBufferTail = 0;
+    spscRingReset(&s->port.rxRing);
+    spscRingReset(&s->port.txRing);
     // callback works for IRQ-based RX ONLY
     s->port.rxCallback = callback;
     s->port.rxCallbackData = rxCallbackData;
+    s->port.idleCallback = NULL;
     s->port.mode = mode;
     s->port.baudRate = baudRate;
     s->port.options = options;
 
+#ifdef USE_UART_RX_DMA
+    if (s->rxDma) {
+        // The stream may still be running from an earlier open, start reading where it is now
+        spscRingSetHead(&s->port.rxRing, uartRxDmaHead(s));
+        spscRingFlush(&s->port.rxRing);
+        s->rxIdle = false;
+    }
+#endif
+
+#ifdef USE_UART_TX_DMA
+    s->txDmaDeferred = false;
+#endif
+
     uartReconfigure(s);
 
     return (serialPort_t *)s;
@@ -188,47 +426,27 @@ void uartSetMode(serialPort_t *instance, portMode_t mode)
 uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t*)instance;
-
-    if (s->port.rxBufferHead >= s->port.rxBufferTail) {
-        return s->port.rxBufferHead - s->port.rxBufferTail;
-    } else {
-        return s->port.rxBufferSize + s->port.rxBufferHead - s->port.rxBufferTail;
-    }
+    return spscRingCount(&s->port.rxRing);
 }
 
 uint32_t uartTotalTxBytesFree(const serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t*)instance;
-
-    uint32_t bytesUsed;
-
-    if (s->port.txBufferHead >= s->port.txBufferTail) {
-        bytesUsed = s->port.txBufferHead - s->port.txBufferTail;
-    } else {
-        bytesUsed = s->port.txBufferSize + s->port.txBufferHead - s->port.txBufferTail;
-    }
-
-    return (s->port.txBufferSize - 1) - bytesUsed;
+    return spscRingFree(&s->port.txRing);
 }
 
 bool isUartTransmitBufferEmpty(const serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    return s->port.txBufferTail == s->port.txBufferHead;
+    return spscRingIsEmpty(&s->port.txRing);
 }
 
 uint8_t uartRead(serialPort_t *instance)
 {
-    uint8_t ch;
+    uint8_t ch = 0;
     uartPort_t *s = (uartPort_t *)instance;
 
-
-    ch = s->port.rxBuffer[s->port.rxBufferTail];
-    if (s->port.rxBufferTail + 1 >= s->port.rxBufferSize) {
-        s->port.rxBufferTail = 0;
-    } else {
-        s->port.rxBufferTail++;
-    }
+    spscRingGet(&s->port.rxRing, &ch);
 
     return ch;
 }
@@ -236,19 +454,74 @@ uint8_t uartRead(serialPort_t *instance)
 void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    s->port.txBuffer[s->port.txBufferHead] = ch;
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
-    } else {
-        s->port.txBufferHead++;
+    spscRingPut(&s->port.txRing, ch);
+
+    // A full ring can't wait for endWrite
+    uartTxKick(s, uartTotalTxBytesFree(instance) == 0);
+}
+
+static void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        const uint32_t written = spscRingWrite(&s->port.txRing, p, count);
+        if (!written) {
+            // Frames larger than the ring go out in parts, even between beginWrite and endWrite
+            uartTxKick(s, true);
+            continue;
+        }
+
+        p += written;
+        count -= written;
     }
 
-    __HAL_UART_ENABLE_IT(&s->Handle, UART_IT_TXE);
+    uartTxKick(s, false);
+}
+
+#ifdef USE_UART_TX_DMA
+static void uartBeginWrite(serialPort_t *instance)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->txDmaDeferred = true;
+}
+
+static void uartEndWrite(serialPort_t *instance)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->txDmaDeferred = false;
+    uartTxKick(s, true);
+}
+#endif
+
+static bool uartSetTxBuffer(serialPort_t *instance, volatile uint8_t *buffer, uint32_t size)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    // An empty ring also means no TX DMA transfer is in flight, it commits the read when it completes
+    if (!isUartTransmitBufferEmpty(instance)) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_SERIALUART) {
+        spscRingInit(&s->port.txRing, buffer, size);
+    }
+
+    return true;
 }
 
 bool isUartIdle(serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t *)instance;
+#ifdef USE_UART_RX_DMA
+    if (s->rxDma) {
+        // The idle flag is consumed by the interrupt handler
+        const bool idle = s->rxIdle;
+        s->rxIdle = false;
+        return idle;
+    }
+#endif
     if(__HAL_UART_GET_FLAG(&s->Handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&s->Handle);
         return true;
@@ -267,9 +540,16 @@ const struct serialPortVTable uartVTable[] = {
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
         .isConnected = NULL,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
+        .readBuf = NULL,
+#ifdef USE_UART_TX_DMA
+        .beginWrite = uartBeginWrite,
+        .endWrite = uartEndWrite,
+#else
         .beginWrite = NULL,
         .endWrite = NULL,
+#endif
         .isIdle = isUartIdle,
+        .setTxBuffer = uartSetTxBuffer,
     }
 };
@@ -23,6 +23,93 @@ extern const struct serialPortVTable uartVTable[];
 
 void uartStartTxDMA(uartPort_t *s);
 
+#ifdef USE_UART_RX_DMA
+// Targets opt in by defining UARTx_RX_DMA, the port falls back to per byte interrupts when the stream is taken
+#ifndef UART1_RX_DMA
+#define UART1_RX_DMA DMA_NONE
+#endif
+#ifndef UART2_RX_DMA
+#define UART2_RX_DMA DMA_NONE
+#endif
+#ifndef UART3_RX_DMA
+#define UART3_RX_DMA DMA_NONE
+#endif
+#ifndef UART4_RX_DMA
+#define UART4_RX_DMA DMA_NONE
+#endif
+#ifndef UART5_RX_DMA
+#define UART5_RX_DMA DMA_NONE
+#endif
+#ifndef UART6_RX_DMA
+#define UART6_RX_DMA DMA_NONE
+#endif
+#ifndef UART7_RX_DMA
+#define UART7_RX_DMA DMA_NONE
+#endif
+#ifndef UART8_RX_DMA
+#define UART8_RX_DMA DMA_NONE
+#endif
+
+bool uartRxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex);
+void uartRxDmaReceive(uartPort_t *s, bool idle);
+#endif
+
+#ifdef USE_UART_TX_DMA
+// Targets opt in by defining UARTx_TX_DMA, the port falls back to TXE interrupts when the stream is taken
+#ifndef UART1_TX_DMA
+#define UART1_TX_DMA DMA_NONE
+#endif
+#ifndef UART2_TX_DMA
+#define UART2_TX_DMA DMA_NONE
+#endif
+#ifndef UART3_TX_DMA
+#define UART3_TX_DMA DMA_NONE
+#endif
+#ifndef UART4_TX_DMA
+#define UART4_TX_DMA DMA_NONE
+#endif
+#ifndef UART5_TX_DMA
+#define UART5_TX_DMA DMA_NONE
+#endif
+#ifndef UART6_TX_DMA
+#define UART6_TX_DMA DMA_NONE
+#endif
+#ifndef UART7_TX_DMA
+#define UART7_TX_DMA DMA_NONE
+#endif
+#ifndef UART8_TX_DMA
+#define UART8_TX_DMA DMA_NONE
+#endif
+
+bool uartTxDmaInit(uartPort_t *s, dmaTag_t tag, uint8_t resourceIndex);
+#endif
+
+// Targets opt in to hardware flow control on transmission by defining UARTx_CTS_PIN, used with SERIAL_CTS
+#ifndef UART1_CTS_PIN
+#define UART1_CTS_PIN NONE
+#endif
+#ifndef UART2_CTS_PIN
+#define UART2_CTS_PIN NONE
+#endif
+#ifndef UART3_CTS_PIN
+#define UART3_CTS_PIN NONE
+#endif
+#ifndef UART4_CTS_PIN
+#define UART4_CTS_PIN NONE
+#endif
+#ifndef UART5_CTS_PIN
+#define UART5_CTS_PIN NONE
+#endif
+#ifndef UART6_CTS_PIN
+#define UART6_CTS_PIN NONE
+#endif
+#ifndef UART7_CTS_PIN
+#define UART7_CTS_PIN NONE
+#endif
+#ifndef UART8_CTS_PIN
+#define UART8_CTS_PIN NONE
+#endif
+
 uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t options);
 uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t options);
 uartPort_t *serialUART3(uint32_t baudRate, portMode_t mode, portOptions_t options);
@@ -37,6 +37,7 @@ typedef struct uartDevice_s {
     uartPort_t port;
     ioTag_t rx;
     ioTag_t tx;
+    ioTag_t cts;
     volatile uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
     volatile uint8_t txBuffer[UART_TX_BUFFER_SIZE];
     uint32_t rcc_ahb1;
@@ -54,6 +55,7 @@ static uartDevice_t uart1 =
     .dev = USART1,
     .rx = IO_TAG(UART1_RX_PIN),
     .tx = IO_TAG(UART1_TX_PIN),
+    .cts = IO_TAG(UART1_CTS_PIN),
     .af = GPIO_AF_USART1,
 #ifdef UART1_AHB1_PERIPHERALS
     .rcc_ahb1 = UART1_AHB1_PERIPHERALS,
@@ -70,6 +72,7 @@ static uartDevice_t uart2 =
     .dev = USART2,
     .rx = IO_TAG(UART2_RX_PIN),
     .tx = IO_TAG(UART2_TX_PIN),
+    .cts = IO_TAG(UART2_CTS_PIN),
     .af = GPIO_AF_USART2,
 #ifdef UART2_AHB1_PERIPHERALS
     .rcc_ahb1 = UART2_AHB1_PERIPHERALS,
@@ -86,6 +89,7 @@ static uartDevice_t uart3 =
     .dev = USART3,
     .rx = IO_TAG(UART3_RX_PIN),
     .tx = IO_TAG(UART3_TX_PIN),
+    .cts = IO_TAG(UART3_CTS_PIN),
     .af = GPIO_AF_USART3,
 #ifdef UART3_AHB1_PERIPHERALS
     .rcc_ahb1 = UART3_AHB1_PERIPHERALS,
@@ -102,6 +106,7 @@ static uartDevice_t uart4 =
     .dev = UART4,
     .rx = IO_TAG(UART4_RX_PIN),
     .tx = IO_TAG(UART4_TX_PIN),
+    .cts = IO_TAG(UART4_CTS_PIN),
     .af = GPIO_AF_UART4,
 #ifdef UART4_AHB1_PERIPHERALS
     .rcc_ahb1 = UART4_AHB1_PERIPHERALS,
@@ -118,6 +123,7 @@ static uartDevice_t uart5 =
     .dev = UART5,
     .rx = IO_TAG(UART5_RX_PIN),
     .tx = IO_TAG(UART5_TX_PIN),
+    .cts = IO_TAG(UART5_CTS_PIN),
     .af = GPIO_AF_UART5,
 #ifdef UART5_AHB1_PERIPHERALS
     .rcc_ahb1 = UART5_AHB1_PERIPHERALS,
@@ -134,6 +140,7 @@ static uartDevice_t uart6 =
     .dev = USART6,
     .rx = IO_TAG(UART6_RX_PIN),
     .tx = IO_TAG(UART6_TX_PIN),
+    .cts = IO_TAG(UART6_CTS_PIN),
     .af = GPIO_AF_USART6,
 #ifdef UART6_AHB1_PERIPHERALS
     .rcc_ahb1 = UART6_AHB1_PERIPHERALS,
@@ -150,6 +157,7 @@ static uartDevice_t uart7 =
     .dev = UART7,
     .rx = IO_TAG(UART7_RX_PIN),
     .tx = IO_TAG(UART7_TX_PIN),
+    .cts = IO_TAG(UART7_CTS_PIN),
     .af = GPIO_AF_UART7,
     .rcc_apb1 = RCC_APB1(UART7),
     .irq = UART7_IRQn,
@@ -163,6 +171,7 @@ static uartDevice_t uart8 =
     .dev = UART8,
     .rx = IO_TAG(UART8_RX_PIN),
     .tx = IO_TAG(UART8_TX_PIN),
+    .cts = IO_TAG(UART8_CTS_PIN),
     .af = GPIO_AF_UART8,
     .rcc_apb1 = RCC_APB1(UART8),
     .irq = UART8_IRQn,
@@ -213,21 +222,41 @@ static uartDevice_t* uartHardwareMap[] = {
 #endif
     };
 
+#ifdef USE_UART_RX_DMA
+// RX DMA stream tags indexed by UARTDevice_e
+static const dmaTag_t uartRxDmaTags[] = {
+    UART1_RX_DMA, UART2_RX_DMA, UART3_RX_DMA, UART4_RX_DMA, UART5_RX_DMA, UART6_RX_DMA, UART7_RX_DMA, UART8_RX_DMA
+};
+#endif
+
+#ifdef USE_UART_TX_DMA
+static const dmaTag_t uartTxDmaTags[] = {
+    UART1_TX_DMA, UART2_TX_DMA, UART3_TX_DMA, UART4_TX_DMA, UART5_TX_DMA, UART6_TX_DMA, UART7_TX_DMA, UART8_TX_DMA
+};
+#endif
+
 void uartIrqHandler(uartPort_t *s)
 {
+#ifdef USE_UART_RX_DMA
+    if (s->rxDma && USART_GetITStatus(s->USARTx, USART_IT_IDLE) == SET) {
+        uartClearIdleFlag(s);
+        uartRxDmaReceive(s, true);
+    }
+#endif
+
     if (USART_GetITStatus(s->USARTx, USART_IT_RXNE) == SET) {
         if (s->port.rxCallback) {
             s->port.rxCallback(s->USARTx->DR, s->port.rxCallbackData);
         } else {
-            s->port.rxBuffer[s->port.rxBufferHead] = s->USARTx->DR;
-            s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
+            spscRingPut(&s->port.rxRing, s->USARTx->DR);
+            s->port.rxSignalled = true;
         }
     }
 
     if (USART_GetITStatus(s->USARTx, USART_IT_TXE) == SET) {
-        if (s->port.txBufferTail != s->port.txBufferHead) {
-            USART_SendData(s->USARTx, s->port.txBuffer[s->port.txBufferTail]);
-            s->port.txBufferTail = (s->port.txBufferTail + 1) % s->port.txBufferSize;
+        uint8_t ch;
+        if (spscRingGet(&s->port.txRing, &ch)) {
+            USART_SendData(s->USARTx, ch);
         } else {
             USART_ITConfig(s->USARTx, USART_IT_TXE, DISABLE);
         }
@@ -271,10 +300,8 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_t mode,
 
     s->port.baudRate = baudRate;
 
-    s->port.rxBuffer = uart->rxBuffer;
-    s->port.txBuffer = uart->txBuffer;
-    s->port.rxBufferSize = sizeof(uart->rxBuffer);
-    s->port.txBufferSize = sizeof(uart->txBuffer);
+    spscRingInit(&s->port.rxRing, uart->rxBuffer, sizeof(uart->rxBuffer));
+    spscRingInit(&s->port.txRing, uart->txBuffer, sizeof(uart->txBuffer));
 
     s->USARTx = uart->dev;
 
@@ -312,9 +339,30 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_t mode,
         }
     }
 
+    s->ctsEnabled = false;
+    if ((mode & MODE_TX) && (options & SERIAL_CTS) && uart->cts) {
+        // Pulled down, so the port doesn't stall when nothing drives the pin
+        IO_t cts = IOGetByTag(uart->cts);
+        IOInit(cts, OWNER_SERIAL, RESOURCE_UART_CTS, RESOURCE_INDEX(device));
+        IOConfigGPIOAF(cts, IOCFG_AF_PP_PD, uart->af);
+        s->ctsEnabled = true;
+    }
+
     NVIC_SetPriority(uart->irq, uart->irqPriority);
     NVIC_EnableIRQ(uart->irq);
 
+#ifdef USE_UART_RX_DMA
+    if (mode & MODE_RX) {
+        uartRxDmaInit(s, uartRxDmaTags[device], RESOURCE_INDEX(device));
+    }
+#endif
+
+#ifdef USE_UART_TX_DMA
+    if (mode & MODE_TX) {
+        uartTxDmaInit(s, uartTxDmaTags[device], RESOURCE_INDEX(device));
+    }
+#endif
+
     return s;
 }
 
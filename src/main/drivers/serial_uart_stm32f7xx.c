@@ -37,6 +37,7 @@ typedef struct uartDevice_s {
     uartPort_t port;
     ioTag_t rx;
     ioTag_t tx;
+    ioTag_t cts;
     volatile uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
     volatile uint8_t txBuffer[UART_TX_BUFFER_SIZE];
     uint32_t rcc_ahb1;
@@ -53,6 +54,7 @@ static uartDevice_t uart1 =
     .dev = USART1,
     .rx = IO_TAG(UART1_RX_PIN),
     .tx = IO_TAG(UART1_TX_PIN),
+    .cts = IO_TAG(UART1_CTS_PIN),
 #ifdef UART1_AF
     .af = UART_AF(USART1, UART1_AF),
 #else
@@ -73,6 +75,7 @@ static uartDevice_t uart2 =
     .dev = USART2,
     .rx = IO_TAG(UART2_RX_PIN),
     .tx = IO_TAG(UART2_TX_PIN),
+    .cts = IO_TAG(UART2_CTS_PIN),
 #ifdef UART2_AF
     .af = UART_AF(USART2, UART2_AF),
 #else
@@ -93,6 +96,7 @@ static uartDevice_t uart3 =
     .dev = USART3,
     .rx = IO_TAG(UART3_RX_PIN),
     .tx = IO_TAG(UART3_TX_PIN),
+    .cts = IO_TAG(UART3_CTS_PIN),
 #ifdef UART3_AF
     .af = UART_AF(USART3, UART3_AF),
 #else
@@ -113,6 +117,7 @@ static uartDevice_t uart4 =
     .dev = UART4,
     .rx = IO_TAG(UART4_RX_PIN),
     .tx = IO_TAG(UART4_TX_PIN),
+    .cts = IO_TAG(UART4_CTS_PIN),
 #ifdef UART4_AF
     .af = UART_AF(UART4, UART4_AF),
 #else
@@ -133,6 +138,7 @@ static uartDevice_t uart5 =
     .dev = UART5,
     .rx = IO_TAG(UART5_RX_PIN),
     .tx = IO_TAG(UART5_TX_PIN),
+    .cts = IO_TAG(UART5_CTS_PIN),
 #ifdef UART5_AF
     .af = UART_AF(UART5, UART5_AF),
 #else
@@ -153,6 +159,7 @@ static uartDevice_t uart6 =
     .dev = USART6,
     .rx = IO_TAG(UART6_RX_PIN),
     .tx = IO_TAG(UART6_TX_PIN),
+    .cts = IO_TAG(UART6_CTS_PIN),
 #ifdef UART6_AF
     .af = UART_AF(USART6, UART6_AF),
 #else
@@ -173,6 +180,7 @@ static uartDevice_t uart7 =
     .dev = UART7,
     .rx = IO_TAG(UART7_RX_PIN),
     .tx = IO_TAG(UART7_TX_PIN),
+    .cts = IO_TAG(UART7_CTS_PIN),
 #ifdef UART7_AF
     .af = UART_AF(UART7, UART7_AF),
 #else
@@ -192,6 +200,7 @@ static uartDevice_t uart8 =
     .dev = UART8,
     .rx = IO_TAG(UART8_RX_PIN),
     .tx = IO_TAG(UART8_TX_PIN),
+    .cts = IO_TAG(UART8_CTS_PIN),
 #ifdef UART8_AF
     .af = UART_AF(UART8, UART8_AF),
 #else
@@ -207,7 +216,6 @@ static uartDevice_t uart8 =
 #endif
 
 
-
 static uartDevice_t* uartHardwareMap[] = {
 #ifdef USE_UART1
     &uart1,
@@ -251,9 +259,29 @@ static uartDevice_t* uartHardwareMap[] = {
 #endif
 };
 
+#ifdef USE_UART_RX_DMA
+// RX DMA stream tags indexed by UARTDevice_e
+static const dmaTag_t uartRxDmaTags[] = {
+    UART1_RX_DMA, UART2_RX_DMA, UART3_RX_DMA, UART4_RX_DMA, UART5_RX_DMA, UART6_RX_DMA, UART7_RX_DMA, UART8_RX_DMA
+};
+#endif
+
+#ifdef USE_UART_TX_DMA
+static const dmaTag_t uartTxDmaTags[] = {
+    UART1_TX_DMA, UART2_TX_DMA, UART3_TX_DMA, UART4_TX_DMA, UART5_TX_DMA, UART6_TX_DMA, UART7_TX_DMA, UART8_TX_DMA
+};
+#endif
+
 void uartIrqHandler(uartPort_t *s)
 {
     UART_HandleTypeDef *huart = &s->Handle;
+#ifdef USE_UART_RX_DMA
+    /* UART idle line after a DMA burst -----------------------------------------*/
+    if (s->rxDma && (__HAL_UART_GET_IT(huart, UART_IT_IDLE) != RESET)) {
+        __HAL_UART_CLEAR_IDLEFLAG(huart);
+        uartRxDmaReceive(s, true);
+    }
+#endif
     /* UART in mode Receiver ---------------------------------------------------*/
     if ((__HAL_UART_GET_IT(huart, UART_IT_RXNE) != RESET)) {
         uint8_t rbyte = (uint8_t)(huart->Instance->RDR & (uint8_t) 0xff);
@@ -261,8 +289,8 @@ void uartIrqHandler(uartPort_t *s)
         if (s->port.rxCallback) {
             s->port.rxCallback(rbyte, s->port.rxCallbackData);
         } else {
-            s->port.rxBuffer[s->port.rxBufferHead] = rbyte;
-            s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
+            spscRingPut(&s->port.rxRing, rbyte);
+            s->port.rxSignalled = true;
         }
         CLEAR_BIT(huart->Instance->CR1, (USART_CR1_PEIE));
 
@@ -296,17 +324,17 @@ void uartIrqHandler(uartPort_t *s)
     if (__HAL_UART_GET_IT(huart, UART_IT_TXE) != RESET) {
         /* Check that a Tx process is ongoing */
         if (huart->gState != HAL_UART_STATE_BUSY_TX) {
-            if (s->port.txBufferTail == s->port.txBufferHead) {
+            uint8_t ch;
+            if (!spscRingGet(&s->port.txRing, &ch)) {
                 huart->TxXferCount = 0;
                 /* Disable the UART Transmit Data Register Empty Interrupt */
                 CLEAR_BIT(huart->Instance->CR1, USART_CR1_TXEIE);
             } else {
                 if ((huart->Init.WordLength == UART_WORDLENGTH_9B) && (huart->Init.Parity == UART_PARITY_NONE)) {
-                    huart->Instance->TDR = (((uint16_t) s->port.txBuffer[s->port.txBufferTail]) & (uint16_t) 0x01FFU);
+                    huart->Instance->TDR = (((uint16_t) ch) & (uint16_t) 0x01FFU);
                 } else {
-                    huart->Instance->TDR = (uint8_t)(s->port.txBuffer[s->port.txBufferTail]);
+                    huart->Instance->TDR = ch;
                 }
-                s->port.txBufferTail = (s->port.txBufferTail + 1) % s->port.txBufferSize;
             }
         }
     }
@@ -343,10 +371,8 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_t mode,
 
     s->port.baudRate = baudRate;
 
-    s->port.rxBuffer = uart->rxBuffer;
-    s->port.txBuffer = uart->txBuffer;
-    s->port.rxBufferSize = sizeof(uart->rxBuffer);
-    s->port.txBufferSize = sizeof(uart->txBuffer);
+    spscRingInit(&s->port.rxRing, uart->rxBuffer, sizeof(uart->rxBuffer));
+    spscRingInit(&s->port.txRing, uart->txBuffer, sizeof(uart->txBuffer));
 
     s->USARTx = uart->dev;
 
@@ -371,9 +397,30 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_t mode,
         }
     }
 
+    s->ctsEnabled = false;
+    if ((mode & MODE_TX) && (options & SERIAL_CTS) && uart->cts) {
+        // Pulled down, so the port doesn't stall when nothing drives the pin
+        IO_t cts = IOGetByTag(uart->cts);
+        IOInit(cts, OWNER_SERIAL, RESOURCE_UART_CTS, RESOURCE_INDEX(device));
+        IOConfigGPIOAF(cts, IOCFG_AF_PP_PD, uart->af);
+        s->ctsEnabled = true;
+    }
+
     HAL_NVIC_SetPriority(uart->irq, uart->irqPriority, 0);
     HAL_NVIC_EnableIRQ(uart->irq);
 
+#ifdef USE_UART_RX_DMA
+    if (mode & MODE_RX) {
+        uartRxDmaInit(s, uartRxDmaTags[device], RESOURCE_INDEX(device));
+    }
+#endif
+
+#ifdef USE_UART_TX_DMA
+    if (mode & MODE_TX) {
+        uartTxDmaInit(s, uartTxDmaTags[device], RESOURCE_INDEX(device));
+    }
+#endif
+
     return s;
 }
 
@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -92,20 +93,39 @@ static uint8_t usbVcpRead(serialPort_t *instance)
     }
 }
 
+static uint32_t usbVcpReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
+{
+    UNUSED(instance);
+
+    return CDC_Receive_DATA(data, count);
+}
+
 static bool usbVcpIsConnected(const serialPort_t *instance)
 {
     (void)instance;
     return usbIsConnected() && usbIsConfigured();
 }
 
+static bool usbVcpFlush(vcpPort_t *port);
+
 static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
 {
-    UNUSED(instance);
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
 
     if (!usbVcpIsConnected(instance)) {
         return;
     }
 
+    // Small pieces of a buffered write (frame headers, checksums) are collected into one packet
+    if (port->buffering && port->txAt + count <= (int)ARRAYLEN(port->txBuf)) {
+        memcpy(&port->txBuf[port->txAt], data, count);
+        port->txAt += count;
+        return;
+    }
+
+    // Whatever was collected so far goes out first to keep the byte order
+    usbVcpFlush(port);
+
     uint32_t start = millis();
     const uint8_t *p = data;
     while (count > 0) {
@@ -186,6 +206,7 @@ static const struct serialPortVTable usbVTable[] = {
         .setMode = usbVcpSetMode,
         .isConnected = usbVcpIsConnected,
         .writeBuf = usbVcpWriteBuf,
+        .readBuf = usbVcpReadBuf,
         .beginWrite = usbVcpBeginWrite,
         .endWrite = usbVcpEndWrite,
         .isIdle = NULL,
@@ -230,6 +251,12 @@ void usbVcpInitHardware(void)
 #endif
 }
 
+static void usbVcpRxSignal(void *context)
+{
+    serialPort_t *instance = context;
+    instance->rxSignalled = true;
+}
+
 serialPort_t *usbVcpOpen(void)
 {
     vcpPort_t *s;
@@ -237,6 +264,8 @@ serialPort_t *usbVcpOpen(void)
     s = &vcpPort;
     s->port.vTable = usbVTable;
 
+    CDC_SetRxCb(usbVcpRxSignal, &s->port);
+
     return (serialPort_t *)s;
 }
 
@@ -14,11 +14,24 @@
 #include "build/build_config.h"
 #include "build/debug.h"
 
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/stack_check.h"
+
 #define STACK_FILL_CHAR 0xa5
+#define STACK_PAINT_GUARD 64    // bytes below the stack pointer left alone when repainting, covers the caller's frame
 
 extern char _estack; // end of stack, declared in .LD file
 extern char _Min_Stack_Size; // declared in .LD file
 
+extern char _sdata, _edata;
+extern char _sbss, _ebss;
+extern char __fastram_bss_start__, __fastram_bss_end__;
+#if defined(STM32H7)
+extern char _sdmaram, _edmaram;
+#endif
+
 /*
  * The ARM processor uses a full descending stack. This means the stack pointer holds the address
  * of the last stacked item in memory. When the processor pushes a new item onto the stack,
@@ -45,29 +58,57 @@ extern char _Min_Stack_Size; // declared in .LD file
 
 static uint32_t usedStackSize;
 
-void taskStackCheck(timeUs_t currentTimeUs)
+static char *stackLowMem(void)
 {
-    (void)currentTimeUs;
+    return &_estack - (uint32_t)&_Min_Stack_Size;
+}
 
-    char * const stackHighMem = &_estack;
-    const uint32_t stackSize = (uint32_t)&_Min_Stack_Size;
-    char * const stackLowMem = stackHighMem - stackSize;
-    const char * const stackCurrent = (char *)&stackLowMem;
+/*
+ * Bytes of stack touched since the stack was last painted. The painted region
+ * is scanned from the bottom, so a large local buffer that was never written
+ * does not end the scan early.
+ */
+uint32_t stackMeasureUsed(void)
+{
+    char * const highMem = &_estack;
+    const char * const stackCurrent = (char *)&highMem;
 
-    char *p;
-    for (p = stackLowMem; p < stackCurrent; ++p) {
+    const uint8_t *p;
+    for (p = (const uint8_t *)stackLowMem(); p < (const uint8_t *)stackCurrent; ++p) {
         if (*p != STACK_FILL_CHAR) {
             break;
         }
     }
 
-    usedStackSize = (uint32_t)stackHighMem - (uint32_t)p;
+    const uint32_t used = (uint32_t)highMem - (uint32_t)p;
+    usedStackSize = MAX(usedStackSize, used);
+
+    return used;
+}
+
+// Repaints the unused part of the stack so the next stackMeasureUsed() sees only what ran in between
+void stackPaintUnused(void)
+{
+    uint8_t *p = (uint8_t *)stackLowMem();
+    uint8_t * const stackCurrent = (uint8_t *)&p - STACK_PAINT_GUARD;
+
+    for (; p < stackCurrent; ++p) {
+        *p = STACK_FILL_CHAR;
+    }
+}
+
+void taskStackCheck(timeUs_t currentTimeUs)
+{
+    (void)currentTimeUs;
+
+    const uint32_t used = stackMeasureUsed();
+    UNUSED(used);
 
 #ifdef DEBUG_STACK
-    debug[0] = (uint32_t)stackHighMem & 0xffff;
-    debug[1] = (uint32_t)stackLowMem & 0xffff;
-    debug[2] = (uint32_t)stackCurrent & 0xffff;
-    debug[3] = (uint32_t)p & 0xffff;
+    debug[0] = (uint32_t)&_estack & 0xffff;
+    debug[1] = (uint32_t)stackLowMem() & 0xffff;
+    debug[2] = used;
+    debug[3] = usedStackSize;
 #endif
 }
 
@@ -77,6 +118,19 @@ uint32_t stackUsedSize(void)
 }
 #endif
 
+void stackGetRamMap(ramMap_t *ramMap)
+{
+    ramMap->dataSize = &_edata - &_sdata;
+    ramMap->bssSize = &_ebss - &_sbss;
+    ramMap->fastramSize = &__fastram_bss_end__ - &__fastram_bss_start__;
+#if defined(STM32H7)
+    ramMap->dmaramSize = &_edmaram - &_sdmaram;
+#else
+    ramMap->dmaramSize = 0;
+#endif
+    ramMap->stackSize = stackTotalSize();
+}
+
 uint32_t stackTotalSize(void)
 {
     return (uint32_t)&_Min_Stack_Size;
@@ -17,7 +17,23 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include "common/time.h"
+
+// Sizes in bytes of the statically allocated RAM regions, from the linker script
+typedef struct ramMap_s {
+    uint32_t dataSize;
+    uint32_t bssSize;
+    uint32_t fastramSize;
+    uint32_t dmaramSize;        // 0 on targets without a separate DMA RAM section
+    uint32_t stackSize;
+} ramMap_t;
+
 void taskStackCheck(timeUs_t currentTimeUs);
+uint32_t stackMeasureUsed(void);
+void stackPaintUnused(void);
 uint32_t stackUsedSize(void);
+void stackGetRamMap(ramMap_t *ramMap);
 uint32_t stackTotalSize(void);
 uint32_t stackHighMem(void);
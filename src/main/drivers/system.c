@@ -64,6 +64,8 @@ void cycleCounterInit(void)
 
     DWT->CYCCNT = 0;
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    timebaseInit();
 }
 
 static inline void systemDisableAllIRQs(void)
@@ -43,6 +43,7 @@ void systemResetRequest(uint32_t requestId);
 void systemResetToBootloader(void);
 uint32_t systemBootloaderAddress(void);
 bool isMPUSoftReset(void);
+bool isMPUUnexpectedReset(void);   // Watchdog or brown-out reset
 void cycleCounterInit(void);
 void checkForBootLoaderRequest(void);
 
@@ -61,6 +61,15 @@ bool isMPUSoftReset(void)
         return false;
 }
 
+bool isMPUUnexpectedReset(void)
+{
+    if (cachedRccCsrValue & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF))
+        return true;
+
+    // Power-on raises the brown-out flag as well
+    return (cachedRccCsrValue & RCC_CSR_BORRSTF) && !(cachedRccCsrValue & RCC_CSR_PORRSTF);
+}
+
 uint32_t systemBootloaderAddress(void)
 {
     return 0x1FF00000;
@@ -51,6 +51,18 @@ bool isMPUSoftReset(void)
         return false;
 }
 
+bool isMPUUnexpectedReset(void)
+{
+    // Reset flags are never cleared on H7, RSR can be read at any time
+    const uint32_t resetFlags = RCC->RSR;
+
+    if (resetFlags & (RCC_RSR_IWDG1RSTF | RCC_RSR_WWDG1RSTF))
+        return true;
+
+    // Power-on raises the brown-out flag as well
+    return (resetFlags & RCC_RSR_BORRSTF) && !(resetFlags & RCC_RSR_PORRSTF);
+}
+
 uint32_t systemBootloaderAddress(void)
 {
 #if defined(STM32H743xx) || defined(STM32H750xx) || defined(STM32H723xx) || defined(STM32H725xx)
@@ -47,6 +47,37 @@ timeMs_t millis(void)
     return sysTickUptime;
 }
 
+#ifdef USE_DWT_TIMEBASE
+// The DWT cycle counter wraps every few seconds. SysTick moves the time base
+// along in whole microseconds, micros() only adds the cycles since then.
+STATIC_UNIT_TESTED volatile timeUs_t timebaseUs = 0;
+STATIC_UNIT_TESTED volatile uint32_t timebaseCycleStamp = 0;
+// 2^32 / usTicks rounded up, exact for deltas below 2^32 / usTicks cycles (~18ms at 480MHz)
+STATIC_UNIT_TESTED uint32_t usTicksReciprocal = 0;
+
+void timebaseInit(void)
+{
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        usTicksReciprocal = (uint32_t)((((uint64_t)1 << 32) + usTicks - 1) / usTicks);
+        timebaseCycleStamp = DWT->CYCCNT;
+        timebaseUs = (timeUs_t)sysTickUptime * 1000;
+    }
+}
+
+static void timebaseAdvance(void)
+{
+    if (usTicksReciprocal) {
+        const uint32_t us = (DWT->CYCCNT - timebaseCycleStamp) / usTicks;
+        timebaseCycleStamp += us * usTicks;
+        timebaseUs += us;
+    }
+}
+#else
+void timebaseInit(void)
+{
+}
+#endif
+
 // SysTick
 
 static volatile int sysTickPending = 0;
@@ -58,6 +89,9 @@ void SysTick_Handler(void)
         sysTickValStamp = SysTick->VAL;
         sysTickPending = 0;
         (void)(SysTick->CTRL);
+#ifdef USE_DWT_TIMEBASE
+        timebaseAdvance();
+#endif
     }
 #ifdef USE_HAL_DRIVER
     // used by the HAL for some timekeeping and timeouts, should always be 1ms
@@ -81,6 +115,30 @@ void delayNanos(timeDelta_t ns)
     while (ticks() - startTicks <= ticksToWait);
 }
 
+#ifdef USE_DWT_TIMEBASE
+// Return system uptime in microseconds. No critical section needed, the
+// SysTick update runs masked and a change of sysTickUptime means it ran
+// while reading. Also valid in interrupt context with SysTick held off, the
+// extra cycles simply add up past 1ms.
+timeUs_t micros(void)
+{
+    uint32_t ms, cycles;
+    timeUs_t us;
+
+    do {
+        ms = sysTickUptime;
+        us = timebaseUs;
+        cycles = DWT->CYCCNT - timebaseCycleStamp;
+    } while (ms != sysTickUptime);
+
+    return us + (uint32_t)(((uint64_t)cycles * usTicksReciprocal) >> 32);
+}
+
+timeUs_t microsISR(void)
+{
+    return micros();
+}
+#else
 // Return system uptime in microseconds
 timeUs_t microsISR(void)
 {
@@ -132,6 +190,7 @@ timeUs_t micros(void)
     const uint32_t partial = (usTicks * 1000U - cycle_cnt) / usTicks;
     return ((timeUs_t)ms * 1000LL) + ((timeUs_t)partial);
 }
+#endif
 
 #if 1
 void delayMicroseconds(timeUs_t us)
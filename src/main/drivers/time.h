@@ -27,6 +27,7 @@ void delayMicroseconds(timeUs_t us);
 void delayNanos(timeDelta_t ns);
 void delay(timeMs_t ms);
 
+void timebaseInit(void);
 timeUs_t micros(void);
 timeUs_t microsISR(void);
 timeMs_t millis(void);
@@ -111,6 +111,11 @@ TCH_t * timerGetTCH(const timerHardware_t * timHw)
     timerCtx[timerIndex]->ch[timHw->channelIndex].dma = NULL;
     timerCtx[timerIndex]->ch[timHw->channelIndex].cb = NULL;
     timerCtx[timerIndex]->ch[timHw->channelIndex].dmaState = TCH_DMA_IDLE;
+#ifdef USE_DSHOT_BIDIR
+    timerCtx[timerIndex]->ch[timHw->channelIndex].pwmInverted = false;
+    timerCtx[timerIndex]->ch[timHw->channelIndex].dmaCallback = NULL;
+    timerCtx[timerIndex]->ch[timHw->channelIndex].dmaCaptureActive = false;
+#endif
 
     return &timerCtx[timerIndex]->ch[timHw->channelIndex];
 }
@@ -253,6 +258,11 @@ void timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount)
     impl_timerPWMPrepareDMA(tch, dmaBufferElementCount);
 }
 
+void timerPWMSetDMABuffer(TCH_t * tch, void * dmaBuffer)
+{
+    tch->dmaBuffer = dmaBuffer;
+}
+
 void timerPWMStartDMA(TCH_t * tch)
 {
     impl_timerPWMStartDMA(tch);
@@ -267,3 +277,63 @@ bool timerPWMDMAInProgress(TCH_t * tch)
 {
     return tch->dmaState != TCH_DMA_IDLE;
 }
+
+#ifdef USE_DSHOT_DMAR
+bool timerPWMConfigDMABurst(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
+{
+    return impl_timerPWMConfigDMABurst(tch, dmaBuffer, dmaBufferElementSize, dmaBufferElementCount);
+}
+
+void timerPWMPrepareDMABurst(TCH_t * tch, uint8_t firstChannelIndex, uint8_t channelCount, uint32_t dmaBufferElementCount)
+{
+    impl_timerPWMPrepareDMABurst(tch, firstChannelIndex, channelCount, dmaBufferElementCount);
+}
+#endif
+
+#ifdef USE_DSHOT_BIDIR
+void timerPWMSetInverted(TCH_t * tch, bool inverted)
+{
+    tch->pwmInverted = inverted;
+}
+
+void timerPWMSetDMACallback(TCH_t * tch, timerDMACallbackFn * callback, void * param)
+{
+    tch->dmaCallbackParam = param;
+    tch->dmaCallback = callback;
+}
+
+void timerPWMStartDMACapture(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount)
+{
+    impl_timerPWMStartDMACapture(tch, dmaBuffer, dmaBufferElementCount);
+}
+
+uint32_t timerPWMStopDMACapture(TCH_t * tch, uint16_t period)
+{
+    if (!tch->dmaCaptureActive) {
+        return 0;
+    }
+
+    return impl_timerPWMStopDMACapture(tch, period);
+}
+#endif
+
+#ifdef USE_SOFTSERIAL_DMA
+void timerChStartDMACaptureCircular(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, unsigned inputFilterTicks)
+{
+    impl_timerChStartDMACaptureCircular(tch, dmaBuffer, dmaBufferElementCount, inputFilterTicks);
+}
+
+uint32_t timerChGetDMACapturePosition(TCH_t * tch)
+{
+    if (!tch->dmaCaptureActive) {
+        return 0;
+    }
+
+    return impl_timerChGetDMACapturePosition(tch);
+}
+
+void timerChStartDMAToggle(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, bool inverted)
+{
+    impl_timerChStartDMAToggle(tch, dmaBuffer, dmaBufferElementCount, inverted);
+}
+#endif
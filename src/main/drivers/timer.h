@@ -104,6 +104,11 @@ struct timHardwareContext_s;
 // Timer generic callback
 typedef void timerCallbackFn(struct TCH_s * tch, uint32_t value);
 
+#ifdef USE_DSHOT_BIDIR
+// Called from DMA IRQ when a PWM DMA burst is complete
+typedef void timerDMACallbackFn(struct TCH_s * tch, void * param);
+#endif
+
 typedef struct timerCallbacks_s {
     void *            callbackParam;
     timerCallbackFn * callbackEdge;
@@ -118,6 +123,16 @@ typedef struct TCH_s {
     DMA_t                           dma;            // Timer channel DMA handle
     volatile tchDmaState_e          dmaState;
     void *                          dmaBuffer;
+#ifdef USE_DSHOT_BIDIR
+    bool                            pwmInverted;        // Inverted on top of timHw->output, bidirectional DShot idles high
+    timerDMACallbackFn *            dmaCallback;
+    void *                          dmaCallbackParam;
+    volatile bool                   dmaCaptureActive;   // DMA is reading captured edges from CCR instead of writing it
+    uint32_t                        dmaCaptureLength;
+#endif
+#ifdef USE_DSHOT_DMAR
+    bool                            dmaBurst;           // DMA writes TIMx_DMAR, serving CCR registers of several channels
+#endif
 } TCH_t;
 
 // Run-time timer context (dynamically allocated), includes 4x TCH
@@ -186,10 +201,38 @@ void timerPWMStart(TCH_t * tch);
 // dmaBufferElementCount is the number of elements in the buffer
 bool timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount);
 void timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount);
+// Switch to another buffer of the same size, takes effect at next timerPWMPrepareDMA()
+void timerPWMSetDMABuffer(TCH_t * tch, void * dmaBuffer);
 void timerPWMStartDMA(TCH_t * tch);
 void timerPWMStopDMA(TCH_t * tch);
 bool timerPWMDMAInProgress(TCH_t * tch);
 
+#ifdef USE_DSHOT_BIDIR
+// Bidirectional DShot: after the PWM burst the channel is switched to input capture on both edges,
+// timer is set free-running and edge timestamps are stored by the same DMA stream
+void timerPWMSetInverted(TCH_t * tch, bool inverted);
+void timerPWMSetDMACallback(TCH_t * tch, timerDMACallbackFn * callback, void * param);
+void timerPWMStartDMACapture(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount);
+uint32_t timerPWMStopDMACapture(TCH_t * tch, uint16_t period);
+#endif
+
+#ifdef USE_SOFTSERIAL_DMA
+// Edge timing over the channel DMA stream, the timer is expected to run free. Channel DMA has to be
+// claimed with timerPWMConfigChannelDMA() first, buffer elements are timerDMASafeType_t.
+// Circular capture keeps storing timestamps of both edges, position is the index the next one goes to
+void timerChStartDMACaptureCircular(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, unsigned inputFilterTicks);
+uint32_t timerChGetDMACapturePosition(TCH_t * tch);
+// Output starts at the active level and toggles at every counter value from the buffer
+void timerChStartDMAToggle(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, bool inverted);
+#endif
+
+#ifdef USE_DSHOT_DMAR
+// DMAR burst: the DMA stream of tch is triggered by its CC event and writes channelCount consecutive
+// CCR registers starting at firstChannelIndex on every request. Buffer is interleaved per channel
+bool timerPWMConfigDMABurst(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount);
+void timerPWMPrepareDMABurst(TCH_t * tch, uint8_t firstChannelIndex, uint8_t channelCount, uint32_t dmaBufferElementCount);
+#endif
+
 volatile timCCR_t *timerCCR(TCH_t * tch);
 
 uint16_t timerGetPrescalerByDesiredMhz(TIM_TypeDef *tim, uint16_t mhz);
@@ -59,3 +59,16 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
 void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount);
 void impl_timerPWMStartDMA(TCH_t * tch);
 void impl_timerPWMStopDMA(TCH_t * tch);
+#ifdef USE_DSHOT_DMAR
+bool impl_timerPWMConfigDMABurst(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount);
+void impl_timerPWMPrepareDMABurst(TCH_t * tch, uint8_t firstChannelIndex, uint8_t channelCount, uint32_t dmaBufferElementCount);
+#endif
+#ifdef USE_DSHOT_BIDIR
+void impl_timerPWMStartDMACapture(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount);
+uint32_t impl_timerPWMStopDMACapture(TCH_t * tch, uint16_t period);
+#endif
+#ifdef USE_SOFTSERIAL_DMA
+void impl_timerChStartDMACaptureCircular(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, unsigned inputFilterTicks);
+uint32_t impl_timerChGetDMACapturePosition(TCH_t * tch);
+void impl_timerChStartDMAToggle(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, bool inverted);
+#endif
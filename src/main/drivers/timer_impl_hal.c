@@ -27,6 +27,7 @@
 
 #include "common/utils.h"
 
+#include "drivers/dma_cache.h"
 #include "drivers/io.h"
 #include "drivers/rcc.h"
 #include "drivers/time.h"
@@ -39,6 +40,10 @@ extern uint32_t timerClock(TIM_TypeDef *tim);
 const uint16_t lookupDMASourceTable[] = { TIM_DMA_CC1, TIM_DMA_CC2, TIM_DMA_CC3, TIM_DMA_CC4 };
 const uint8_t lookupTIMChannelTable[] = { TIM_CHANNEL_1, TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4 };
 
+#ifdef USE_DSHOT_BIDIR
+static const uint32_t lookupLLChannelTable[] = { LL_TIM_CHANNEL_CH1, LL_TIM_CHANNEL_CH2, LL_TIM_CHANNEL_CH3, LL_TIM_CHANNEL_CH4 };
+#endif
+
 static const uint32_t lookupDMALLStreamTable[] = { LL_DMA_STREAM_0, LL_DMA_STREAM_1, LL_DMA_STREAM_2, LL_DMA_STREAM_3, LL_DMA_STREAM_4, LL_DMA_STREAM_5, LL_DMA_STREAM_6, LL_DMA_STREAM_7 };
 
 #if !(defined(STM32H7) || defined(STM32G4))
@@ -120,7 +125,11 @@ void impl_timerConfigBase(TCH_t * tch, uint16_t period, uint32_t hz)
 
 void impl_timerPWMConfigChannel(TCH_t * tch, uint16_t value)
 {
+#ifdef USE_DSHOT_BIDIR
+    const bool inverted = ((tch->timHw->output & TIMER_OUTPUT_INVERTED) != 0) != tch->pwmInverted;
+#else
     const bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+#endif
 
     TIM_OC_InitTypeDef TIM_OCInitStructure;
 
@@ -325,9 +334,26 @@ static void impl_timerDMA_IRQHandler(DMA_t descriptor)
         LL_TIM_DisableDMAReq_CCx(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex]);
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+#ifdef USE_DSHOT_BIDIR
+        // PWM burst is over, let the owner turn the channel around
+        if (tch->dmaCallback && !tch->dmaCaptureActive) {
+            tch->dmaCallback(tch, tch->dmaCallbackParam);
+        }
+#endif
     }
 }
 
+static volatile void * impl_timerDMAPeriphAddress(TCH_t * tch)
+{
+#ifdef USE_DSHOT_DMAR
+    if (tch->dmaBurst) {
+        return &tch->timHw->tim->DMAR;
+    }
+#endif
+    return impl_timerCCR(tch);
+}
+
 bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
 {
     tch->dma = dmaGetByTag(tch->timHw->dmaTag);
@@ -358,7 +384,7 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
     init.Channel = lookupDMALLChannelTable[DMATAG_GET_CHANNEL(tch->timHw->dmaTag)];
 #endif
 
-    init.PeriphOrM2MSrcAddress = (uint32_t)impl_timerCCR(tch);
+    init.PeriphOrM2MSrcAddress = (uint32_t)impl_timerDMAPeriphAddress(tch);
     init.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
 
     switch (dmaBufferElementSize) {
@@ -422,8 +448,10 @@ void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount)
         DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
     }
 
+    dmaCacheCleanForDevice(tch->dmaBuffer, dmaBufferElementCount * sizeof(timerDMASafeType_t));
+
     LL_DMA_SetDataLength(dmaBase, streamLL, dmaBufferElementCount);
-    LL_DMA_ConfigAddresses(dmaBase, streamLL, (uint32_t)tch->dmaBuffer, (uint32_t)impl_timerCCR(tch), LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_ConfigAddresses(dmaBase, streamLL, (uint32_t)tch->dmaBuffer, (uint32_t)impl_timerDMAPeriphAddress(tch), LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
     LL_DMA_EnableIT_TC(dmaBase, streamLL);
     LL_DMA_EnableStream(dmaBase, streamLL);
     tch->dmaState = TCH_DMA_READY;
@@ -465,3 +493,190 @@ void impl_timerPWMStopDMA(TCH_t * tch)
     (void)tch;
     // FIXME
 }
+
+#ifdef USE_DSHOT_DMAR
+bool impl_timerPWMConfigDMABurst(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
+{
+    // Set before the stream is initialized, so it points to TIMx_DMAR
+    tch->dmaBurst = true;
+
+    if (!impl_timerPWMConfigChannelDMA(tch, dmaBuffer, dmaBufferElementSize, dmaBufferElementCount)) {
+        tch->dmaBurst = false;
+        return false;
+    }
+
+    return true;
+}
+
+void impl_timerPWMPrepareDMABurst(TCH_t * tch, uint8_t firstChannelIndex, uint8_t channelCount, uint32_t dmaBufferElementCount)
+{
+    // CCR1..CCR4 are consecutive, so is the DMA base address encoding
+    LL_TIM_ConfigDMABurst(tch->timHw->tim, LL_TIM_DMABURST_BASEADDR_CCR1 + firstChannelIndex, LL_TIM_DMABURST_LENGTH_1TRANSFER + ((channelCount - 1) << TIM_DCR_DBL_Pos));
+    impl_timerPWMPrepareDMA(tch, dmaBufferElementCount);
+}
+#endif
+
+#ifdef USE_DSHOT_BIDIR
+void impl_timerPWMStartDMACapture(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+    const uint32_t channelLL = lookupLLChannelTable[tch->timHw->channelIndex];
+    DMA_TypeDef *dmaBase = tch->dma->dma;
+
+    LL_DMA_DisableStream(dmaBase, streamLL);
+    while (LL_DMA_IsEnabledStream(dmaBase, streamLL));
+
+    // Timer is shared by all channels of the motor group, let it run free while capturing
+    LL_TIM_DisableARRPreload(timer);
+    LL_TIM_SetAutoReload(timer, 0xFFFF);
+
+    LL_TIM_CC_DisableChannel(timer, channelLL);
+    LL_TIM_IC_Config(timer, channelLL, LL_TIM_ACTIVEINPUT_DIRECTTI | LL_TIM_ICPSC_DIV1 | LL_TIM_IC_FILTER_FDIV1_N4 | LL_TIM_IC_POLARITY_BOTHEDGE);
+    LL_TIM_CC_EnableChannel(timer, channelLL);
+
+    // Same stream, reversed direction. Direct mode so no samples are left in the FIFO when stopped
+    LL_DMA_DisableFifoMode(dmaBase, streamLL);
+    LL_DMA_ConfigAddresses(dmaBase, streamLL, (uint32_t)impl_timerCCR(tch), (uint32_t)dmaBuffer, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(dmaBase, streamLL, dmaBufferElementCount);
+    DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    tch->dmaCaptureLength = dmaBufferElementCount;
+    tch->dmaCaptureActive = true;
+
+    LL_DMA_EnableStream(dmaBase, streamLL);
+    LL_TIM_EnableDMAReq_CCx(timer, lookupDMASourceTable[tch->timHw->channelIndex]);
+}
+
+uint32_t impl_timerPWMStopDMACapture(TCH_t * tch, uint16_t period)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+    const uint32_t channelLL = lookupLLChannelTable[tch->timHw->channelIndex];
+    DMA_TypeDef *dmaBase = tch->dma->dma;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        LL_TIM_DisableDMAReq_CCx(timer, lookupDMASourceTable[tch->timHw->channelIndex]);
+        LL_DMA_DisableStream(dmaBase, streamLL);
+        DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
+    }
+    while (LL_DMA_IsEnabledStream(dmaBase, streamLL));
+
+    const uint32_t captured = tch->dmaCaptureLength - LL_DMA_GetDataLength(dmaBase, streamLL);
+    dmaCacheInvalidateForCpu((void *)LL_DMA_GetMemoryAddress(dmaBase, streamLL), captured * sizeof(timerDMASafeType_t));
+
+    // Back to PWM output, impl_timerPWMPrepareDMA() restores the memory to peripheral direction
+    LL_DMA_EnableFifoMode(dmaBase, streamLL);
+
+    LL_TIM_SetAutoReload(timer, period - 1);
+    LL_TIM_EnableARRPreload(timer);
+
+    impl_timerPWMConfigChannel(tch, 0);
+    LL_TIM_CC_EnableChannel(timer, channelLL);
+
+    tch->dmaCaptureActive = false;
+
+    return captured;
+}
+#endif
+
+#ifdef USE_SOFTSERIAL_DMA
+static void impl_timerChSetOCMode(TCH_t * tch, uint32_t ocMode)
+{
+    // CCMR keeps two channels, OCxM values are given for the lower one. Preload is off, CCR writes apply right away
+    volatile uint32_t * ccmr = (tch->timHw->channelIndex < 2) ? &tch->timHw->tim->CCMR1 : &tch->timHw->tim->CCMR2;
+    const unsigned shift = (tch->timHw->channelIndex & 1) ? 8 : 0;
+
+    *ccmr = (*ccmr & ~((TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE | TIM_CCMR1_CC1S) << shift)) | (ocMode << shift);
+}
+
+static void impl_timerChStopDMA(TCH_t * tch)
+{
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+    DMA_TypeDef *dmaBase = tch->dma->dma;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        LL_TIM_DisableDMAReq_CCx(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex]);
+        LL_DMA_DisableStream(dmaBase, streamLL);
+        DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    }
+    while (LL_DMA_IsEnabledStream(dmaBase, streamLL));
+
+    // Direct mode, captured samples must not wait in the FIFO
+    LL_DMA_DisableFifoMode(dmaBase, streamLL);
+    tch->dmaState = TCH_DMA_IDLE;
+}
+
+void impl_timerChStartDMACaptureCircular(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, unsigned inputFilterTicks)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+    const uint32_t channelLL = lookupLLChannelTable[tch->timHw->channelIndex];
+    DMA_TypeDef *dmaBase = tch->dma->dma;
+
+    impl_timerChStopDMA(tch);
+
+    LL_TIM_CC_DisableChannel(timer, channelLL);
+    LL_TIM_IC_Config(timer, channelLL, LL_TIM_ACTIVEINPUT_DIRECTTI | LL_TIM_ICPSC_DIV1 | LL_TIM_IC_POLARITY_BOTHEDGE |
+        ((uint32_t)getFilter(inputFilterTicks) << (TIM_CCMR1_IC1F_Pos + 16U)));
+    LL_TIM_CC_EnableChannel(timer, channelLL);
+
+    // Peripheral to memory, wrapping around. No transfer complete IRQ, the reader follows the data counter
+    LL_DMA_SetMode(dmaBase, streamLL, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_DisableIT_TC(dmaBase, streamLL);
+    LL_DMA_ConfigAddresses(dmaBase, streamLL, (uint32_t)impl_timerCCR(tch), (uint32_t)dmaBuffer, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(dmaBase, streamLL, dmaBufferElementCount);
+
+    tch->dmaCaptureLength = dmaBufferElementCount;
+    tch->dmaCaptureActive = true;
+
+    LL_DMA_EnableStream(dmaBase, streamLL);
+    LL_TIM_EnableDMAReq_CCx(timer, lookupDMASourceTable[tch->timHw->channelIndex]);
+}
+
+uint32_t impl_timerChGetDMACapturePosition(TCH_t * tch)
+{
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+
+    return (tch->dmaCaptureLength - LL_DMA_GetDataLength(tch->dma->dma, streamLL)) % tch->dmaCaptureLength;
+}
+
+void impl_timerChStartDMAToggle(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, bool inverted)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    const uint32_t streamLL = lookupDMALLStreamTable[DMATAG_GET_STREAM(tch->timHw->dmaTag)];
+    const unsigned ccerShift = tch->timHw->channelIndex * 4;
+    DMA_TypeDef *dmaBase = tch->dma->dma;
+    const timerDMASafeType_t * buffer = dmaBuffer;
+
+    impl_timerChStopDMA(tch);
+
+    // Output mode can only be selected with the channel off, start from the active level
+    timer->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P | TIM_CCER_CC1NP) << ccerShift);
+    impl_timerChSetOCMode(tch, LL_TIM_OCMODE_FORCED_ACTIVE);
+    if (inverted) {
+        timer->CCER |= TIM_CCER_CC1P << ccerShift;
+    }
+    *impl_timerCCR(tch) = buffer[0];
+    timer->CCER |= TIM_CCER_CC1E << ccerShift;
+    impl_timerChSetOCMode(tch, LL_TIM_OCMODE_TOGGLE);
+
+    tch->dmaCaptureActive = false;
+
+    if (dmaBufferElementCount < 2) {
+        return;
+    }
+
+    // First toggle time is in CCR already, each compare match fetches the next one
+    dmaCacheCleanForDevice(&buffer[1], (dmaBufferElementCount - 1) * sizeof(timerDMASafeType_t));
+    LL_DMA_SetMode(dmaBase, streamLL, LL_DMA_MODE_NORMAL);
+    LL_DMA_ConfigAddresses(dmaBase, streamLL, (uint32_t)&buffer[1], (uint32_t)impl_timerCCR(tch), LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetDataLength(dmaBase, streamLL, dmaBufferElementCount - 1);
+    LL_DMA_EnableIT_TC(dmaBase, streamLL);
+
+    tch->dmaState = TCH_DMA_ACTIVE;
+
+    LL_DMA_EnableStream(dmaBase, streamLL);
+    LL_TIM_EnableDMAReq_CCx(timer, lookupDMASourceTable[tch->timHw->channelIndex]);
+}
+#endif
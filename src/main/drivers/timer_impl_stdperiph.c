@@ -202,7 +202,11 @@ void impl_timerCaptureCompareHandler(TIM_TypeDef *tim, timHardwareContext_t *tim
 
 void impl_timerPWMConfigChannel(TCH_t * tch, uint16_t value)
 {
+#ifdef USE_DSHOT_BIDIR
+    const bool inverted = ((tch->timHw->output & TIMER_OUTPUT_INVERTED) != 0) != tch->pwmInverted;
+#else
     const bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+#endif
 
     TIM_OCInitTypeDef  TIM_OCInitStructure;
 
@@ -276,15 +280,23 @@ static void impl_timerDMA_IRQHandler(DMA_t descriptor)
         TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+#ifdef USE_DSHOT_BIDIR
+        // PWM burst is over, let the owner turn the channel around
+        if (tch->dmaCallback && !tch->dmaCaptureActive) {
+            tch->dmaCallback(tch, tch->dmaCallbackParam);
+        }
+#endif
     }
 }
 
-bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
+static bool impl_timerPWMConfigDMA(TCH_t * tch, volatile void * periphAddress, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
 {
     DMA_InitTypeDef DMA_InitStructure;
     TIM_TypeDef * timer = tch->timHw->tim;
     
     tch->dma = dmaGetByTag(tch->timHw->dmaTag);
+    tch->dmaBuffer = dmaBuffer;
     if (tch->dma == NULL) {
         return false;
     }
@@ -313,7 +325,7 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
     DMA_DeInit(tch->dma->ref);
     DMA_StructInit(&DMA_InitStructure);
 
-    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)impl_timerCCR(tch);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)periphAddress;
     DMA_InitStructure.DMA_BufferSize = dmaBufferElementCount;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
     DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
@@ -357,6 +369,30 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
     return true;
 }
 
+bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
+{
+    return impl_timerPWMConfigDMA(tch, impl_timerCCR(tch), dmaBuffer, dmaBufferElementSize, dmaBufferElementCount);
+}
+
+#ifdef USE_DSHOT_DMAR
+bool impl_timerPWMConfigDMABurst(TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
+{
+    if (!impl_timerPWMConfigDMA(tch, &tch->timHw->tim->DMAR, dmaBuffer, dmaBufferElementSize, dmaBufferElementCount)) {
+        return false;
+    }
+
+    tch->dmaBurst = true;
+    return true;
+}
+
+void impl_timerPWMPrepareDMABurst(TCH_t * tch, uint8_t firstChannelIndex, uint8_t channelCount, uint32_t dmaBufferElementCount)
+{
+    // CCR1..CCR4 are consecutive, so is the DMA base address encoding
+    TIM_DMAConfig(tch->timHw->tim, TIM_DMABase_CCR1 + firstChannelIndex, TIM_DMABurstLength_1Transfer + ((channelCount - 1) << 8));
+    impl_timerPWMPrepareDMA(tch, dmaBufferElementCount);
+}
+#endif
+
 void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount)
 {
     // Make sure we terminate any DMA transaction currently in progress
@@ -368,6 +404,7 @@ void impl_timerPWMPrepareDMA(TCH_t * tch, uint32_t dmaBufferElementCount)
         DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
     }
 
+    tch->dma->ref->M0AR = (uint32_t)tch->dmaBuffer;
     DMA_SetCurrDataCounter(tch->dma->ref, dmaBufferElementCount);
     DMA_Cmd(tch->dma->ref, ENABLE);
     tch->dmaState = TCH_DMA_READY;
@@ -410,3 +447,164 @@ void impl_timerPWMStopDMA(TCH_t * tch)
     TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
     TIM_Cmd(tch->timHw->tim, ENABLE);
 }
+
+#ifdef USE_DSHOT_BIDIR
+void impl_timerPWMStartDMACapture(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+
+    DMA_Cmd(stream, DISABLE);
+    while (DMA_GetCmdStatus(stream) != DISABLE);
+
+    // Timer is shared by all channels of the motor group, let it run free while capturing
+    TIM_ARRPreloadConfig(timer, DISABLE);
+    timer->ARR = 0xFFFF;
+
+    TIM_ICStructInit(&TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = lookupTIMChannelTable[tch->timHw->channelIndex];
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = 2;
+    TIM_ICInit(timer, &TIM_ICInitStructure);
+
+    // Same stream, reversed direction
+    stream->CR &= ~DMA_SxCR_DIR;
+    stream->M0AR = (uint32_t)dmaBuffer;
+    DMA_SetCurrDataCounter(stream, dmaBufferElementCount);
+    DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    tch->dmaCaptureLength = dmaBufferElementCount;
+    tch->dmaCaptureActive = true;
+
+    DMA_Cmd(stream, ENABLE);
+    TIM_DMACmd(timer, lookupDMASourceTable[tch->timHw->channelIndex], ENABLE);
+}
+
+uint32_t impl_timerPWMStopDMACapture(TCH_t * tch, uint16_t period)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        DMA_Cmd(stream, DISABLE);
+        TIM_DMACmd(timer, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
+        DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
+    }
+    while (DMA_GetCmdStatus(stream) != DISABLE);
+
+    const uint32_t captured = tch->dmaCaptureLength - DMA_GetCurrDataCounter(stream);
+
+    // Back to PWM output fed from the original buffer
+    TIM_CCxCmd(timer, lookupTIMChannelTable[tch->timHw->channelIndex], TIM_CCx_Disable);
+    stream->CR |= DMA_DIR_MemoryToPeripheral;
+    stream->M0AR = (uint32_t)tch->dmaBuffer;
+
+    timer->ARR = period - 1;
+    TIM_ARRPreloadConfig(timer, ENABLE);
+
+    impl_timerPWMConfigChannel(tch, 0);
+    TIM_CCxCmd(timer, lookupTIMChannelTable[tch->timHw->channelIndex], TIM_CCx_Enable);
+
+    tch->dmaCaptureActive = false;
+
+    return captured;
+}
+#endif
+
+#ifdef USE_SOFTSERIAL_DMA
+static void impl_timerChSetOCMode(TCH_t * tch, uint16_t ocMode)
+{
+    // CCMR keeps two channels, OCxM values are given for the lower one. Preload is off, CCR writes apply right away
+    volatile uint16_t * ccmr = (tch->timHw->channelIndex < 2) ? &tch->timHw->tim->CCMR1 : &tch->timHw->tim->CCMR2;
+    const unsigned shift = (tch->timHw->channelIndex & 1) ? 8 : 0;
+
+    *ccmr = (*ccmr & ~((TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE | TIM_CCMR1_CC1S) << shift)) | (ocMode << shift);
+}
+
+static void impl_timerChStopDMA(TCH_t * tch)
+{
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        DMA_Cmd(stream, DISABLE);
+        TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
+        DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    }
+    while (DMA_GetCmdStatus(stream) != DISABLE);
+
+    tch->dmaState = TCH_DMA_IDLE;
+}
+
+void impl_timerChStartDMACaptureCircular(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, unsigned inputFilterTicks)
+{
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+
+    impl_timerChStopDMA(tch);
+
+    TIM_ICStructInit(&TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = lookupTIMChannelTable[tch->timHw->channelIndex];
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = getFilter(inputFilterTicks);
+    TIM_ICInit(tch->timHw->tim, &TIM_ICInitStructure);
+
+    // Peripheral to memory, wrapping around. No transfer complete IRQ, the reader follows the data counter
+    stream->CR = (stream->CR & ~DMA_SxCR_DIR) | DMA_SxCR_CIRC;
+    DMA_ITConfig(stream, DMA_IT_TC, DISABLE);
+    stream->M0AR = (uint32_t)dmaBuffer;
+    DMA_SetCurrDataCounter(stream, dmaBufferElementCount);
+
+    tch->dmaCaptureLength = dmaBufferElementCount;
+    tch->dmaCaptureActive = true;
+
+    DMA_Cmd(stream, ENABLE);
+    TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], ENABLE);
+}
+
+uint32_t impl_timerChGetDMACapturePosition(TCH_t * tch)
+{
+    return (tch->dmaCaptureLength - DMA_GetCurrDataCounter(tch->dma->ref)) % tch->dmaCaptureLength;
+}
+
+void impl_timerChStartDMAToggle(TCH_t * tch, void * dmaBuffer, uint32_t dmaBufferElementCount, bool inverted)
+{
+    TIM_TypeDef * timer = tch->timHw->tim;
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+    const unsigned ccerShift = tch->timHw->channelIndex * 4;
+    const timerDMASafeType_t * buffer = dmaBuffer;
+
+    impl_timerChStopDMA(tch);
+
+    // Output mode can only be selected with the channel off, start from the active level
+    timer->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P | TIM_CCER_CC1NP) << ccerShift);
+    impl_timerChSetOCMode(tch, TIM_ForcedAction_Active);
+    if (inverted) {
+        timer->CCER |= TIM_CCER_CC1P << ccerShift;
+    }
+    *impl_timerCCR(tch) = buffer[0];
+    timer->CCER |= TIM_CCER_CC1E << ccerShift;
+    impl_timerChSetOCMode(tch, TIM_OCMode_Toggle);
+
+    tch->dmaCaptureActive = false;
+
+    if (dmaBufferElementCount < 2) {
+        return;
+    }
+
+    // First toggle time is in CCR already, each compare match fetches the next one
+    stream->CR = (stream->CR & ~(DMA_SxCR_CIRC | DMA_SxCR_DIR)) | DMA_DIR_MemoryToPeripheral;
+    stream->M0AR = (uint32_t)&buffer[1];
+    DMA_SetCurrDataCounter(stream, dmaBufferElementCount - 1);
+    DMA_ITConfig(stream, DMA_IT_TC, ENABLE);
+
+    tch->dmaState = TCH_DMA_ACTIVE;
+
+    DMA_Cmd(stream, ENABLE);
+    TIM_DMACmd(timer, lookupDMASourceTable[tch->timHw->channelIndex], ENABLE);
+}
+#endif
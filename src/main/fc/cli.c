@@ -28,6 +28,7 @@
 bool cliMode = false;
 
 #include "blackbox/blackbox.h"
+#include "blackbox/blackbox_io.h"
 
 #include "build/assert.h"
 #include "build/build_config.h"
@@ -124,6 +125,9 @@ bool cliMode = false;
 #include "telemetry/frsky_d.h"
 #include "telemetry/telemetry.h"
 #include "build/debug.h"
+#include "build/profiling.h"
+#include "build/bench.h"
+#include "build/trace_ring.h"
 
 extern timeDelta_t cycleTime; // FIXME dependency on mw.c
 extern uint8_t detectedSensors[SENSOR_INDEX_COUNT];
@@ -232,6 +236,7 @@ static void cliPrintLinefeed(void)
 {
     cliPrint("\r\n");
     if (cliDelayMs) {
+        bufWriterFlush(cliWriter);
         delay(cliDelayMs);
     }
 }
@@ -293,13 +298,11 @@ typedef enum {
 static void cliPrintfva(const char *format, va_list va)
 {
     tfp_format(cliWriter, cliPutp, format, va);
-    bufWriterFlush(cliWriter);
 }
 
 static void cliPrintLinefva(const char *format, va_list va)
 {
     tfp_format(cliWriter, cliPutp, format, va);
-    bufWriterFlush(cliWriter);
     cliPrintLinefeed();
 }
 
@@ -507,13 +510,33 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
     }
 }
 
+// Returns false when the PG instance the settings currently point to (the
+// current profile for profile PGs) is the same as its defaults
+static bool settingsGroupDiffers(const pgRegistry_t *pg, const setting_t *first)
+{
+    const size_t offset = (const uint8_t *)settingGetValuePointer(first) - first->offset - pg->address;
+    const size_t size = SETTING_SECTION(first) == BATTERY_CONFIG_VALUE ? sizeof(batteryProfile_t) : pgSize(pg);
+    return memcmp(pg->address + offset, pg->copy + offset, size) != 0;
+}
+
 static void dumpAllValues(uint16_t valueSection, uint8_t dumpMask)
 {
-    for (unsigned i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-        const setting_t *value = settingGet(i);
-        bufWriterFlush(cliWriter);
-        if (SETTING_SECTION(value) == valueSection) {
-            dumpPgValue(value, dumpMask);
+    uint16_t end;
+    // Settings are sorted by PG, in a diff the PGs that are the same as their
+    // defaults are skipped without looking at their settings
+    for (unsigned i = 0; i < SETTINGS_TABLE_COUNT; i = end + 1) {
+        const setting_t *first = settingGet(i);
+        const pgRegistry_t *pg = pgFind(settingGetPgn(first));
+        settingsGetParameterGroupIndexes(pgN(pg), NULL, &end);
+
+        if (SETTING_SECTION(first) != valueSection) {
+            continue;
+        }
+        if ((dumpMask & DO_DIFF) && !settingsGroupDiffers(pg, first)) {
+            continue;
+        }
+        for (unsigned j = i; j <= end; j++) {
+            dumpPgValue(settingGet(j), dumpMask);
         }
     }
 }
@@ -1032,6 +1055,8 @@ static void cliAdjustmentRange(char *cmdline)
                 memset(ar, 0, sizeof(adjustmentRange_t));
                 cliShowParseError();
             }
+
+            updateAdjustmentRangeTable();
         } else {
             cliShowArgumentRangeError("index", 0, MAX_ADJUSTMENT_RANGE_COUNT - 1);
         }
@@ -1362,6 +1387,129 @@ static void cliSafeHomes(char *cmdline)
     }
 }
 
+#endif
+#if defined(USE_GEOZONE)
+static void printGeozones(uint8_t dumpMask, const geozone_t *zones, const geozone_t *defaultZones)
+{
+    const char *format = "geozone %u %u %u %u %u %d %d"; // type, action, first vertex, vertex count, min alt, max alt
+    for (uint8_t i = 0; i < MAX_GEOZONES; i++) {
+        bool equalsDefault = false;
+        if (defaultZones) {
+            equalsDefault = memcmp(&zones[i], &defaultZones[i], sizeof(geozone_t)) == 0;
+            cliDefaultPrintLinef(dumpMask, equalsDefault, format, i,
+                defaultZones[i].type, defaultZones[i].action, defaultZones[i].firstVertex, defaultZones[i].vertexCount,
+                defaultZones[i].minAltitude, defaultZones[i].maxAltitude);
+        }
+        cliDumpPrintLinef(dumpMask, equalsDefault, format, i,
+            zones[i].type, zones[i].action, zones[i].firstVertex, zones[i].vertexCount,
+            zones[i].minAltitude, zones[i].maxAltitude);
+    }
+}
+
+static void cliGeozone(char *cmdline)
+{
+    char * saveptr;
+    int args[7], check = 0;
+
+    if (isEmpty(cmdline)) {
+        printGeozones(DUMP_MASTER, geozones(0), NULL);
+    } else if (sl_strcasecmp(cmdline, "reset") == 0) {
+        pgResetCopy(geozonesMutable(0), PG_GEOZONE_CONFIG);
+        geozoneInvalidate();
+    } else {
+        enum {
+            INDEX = 0,
+            TYPE,
+            ACTION,
+            FIRST_VERTEX,
+            VERTEX_COUNT,
+            MIN_ALTITUDE,
+            MAX_ALTITUDE,
+            ARGS_COUNT
+        };
+        char *ptr = strtok_r(cmdline, " ", &saveptr);
+        while (ptr != NULL && check < ARGS_COUNT) {
+            args[check++] = fastA2I(ptr);
+            ptr = strtok_r(NULL, " ", &saveptr);
+        }
+
+        if (ptr != NULL || check != ARGS_COUNT) {
+            cliShowParseError();
+            return;
+        }
+
+        const int i = args[INDEX];
+        if (
+            i >= 0 && i < MAX_GEOZONES &&
+            args[TYPE] >= GEOZONE_TYPE_EXCLUSION && args[TYPE] <= GEOZONE_TYPE_INCLUSION &&
+            args[ACTION] >= GEOZONE_ACTION_NONE && args[ACTION] <= GEOZONE_ACTION_RTH &&
+            args[FIRST_VERTEX] >= 0 && args[VERTEX_COUNT] >= 0 && args[FIRST_VERTEX] + args[VERTEX_COUNT] <= MAX_GEOZONE_VERTICES &&
+            (args[MAX_ALTITUDE] == 0 || args[MAX_ALTITUDE] > args[MIN_ALTITUDE])
+        ) {
+            geozonesMutable(i)->type = args[TYPE];
+            geozonesMutable(i)->action = args[ACTION];
+            geozonesMutable(i)->firstVertex = args[FIRST_VERTEX];
+            geozonesMutable(i)->vertexCount = args[VERTEX_COUNT];
+            geozonesMutable(i)->minAltitude = args[MIN_ALTITUDE];
+            geozonesMutable(i)->maxAltitude = args[MAX_ALTITUDE];
+            geozoneInvalidate();
+        } else {
+            cliShowParseError();
+        }
+    }
+}
+
+static void printGeozoneVertices(uint8_t dumpMask, const geozoneVertex_t *vertices, const geozoneVertex_t *defaultVertices)
+{
+    const char *format = "geovertex %u %d %d"; // lat, lon
+    for (uint8_t i = 0; i < MAX_GEOZONE_VERTICES; i++) {
+        bool equalsDefault = false;
+        if (defaultVertices) {
+            equalsDefault = vertices[i].lat == defaultVertices[i].lat && vertices[i].lon == defaultVertices[i].lon;
+            cliDefaultPrintLinef(dumpMask, equalsDefault, format, i, defaultVertices[i].lat, defaultVertices[i].lon);
+        }
+        cliDumpPrintLinef(dumpMask, equalsDefault, format, i, vertices[i].lat, vertices[i].lon);
+    }
+}
+
+static void cliGeozoneVertex(char *cmdline)
+{
+    if (isEmpty(cmdline)) {
+        printGeozoneVertices(DUMP_MASTER, geozoneVertices(0), NULL);
+    } else if (sl_strcasecmp(cmdline, "reset") == 0) {
+        pgResetCopy(geozoneVerticesMutable(0), PG_GEOZONE_VERTICES);
+        geozoneInvalidate();
+    } else {
+        int32_t lat = 0, lon = 0;
+        uint8_t validArgumentCount = 0;
+        const char *ptr = cmdline;
+        int i = fastA2I(ptr);
+        if (i < 0 || i >= MAX_GEOZONE_VERTICES) {
+            cliShowArgumentRangeError("vertex index", 0, MAX_GEOZONE_VERTICES - 1);
+        } else {
+            if ((ptr = nextArg(ptr))) {
+                lat = fastA2I(ptr);
+                validArgumentCount++;
+            }
+            if ((ptr = nextArg(ptr))) {
+                lon = fastA2I(ptr);
+                validArgumentCount++;
+            }
+            if ((ptr = nextArg(ptr))) {
+                // check for too many arguments
+                validArgumentCount++;
+            }
+            if (validArgumentCount != 2) {
+                cliShowParseError();
+            } else {
+                geozoneVerticesMutable(i)->lat = lat;
+                geozoneVerticesMutable(i)->lon = lon;
+                geozoneInvalidate();
+            }
+        }
+    }
+}
+
 #endif
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
 static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, const navWaypoint_t *defaultNavWaypoint)
@@ -1957,6 +2105,7 @@ static void cliLogic(char *cmdline) {
         printLogic(DUMP_MASTER, logicConditions(0), NULL);
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         pgResetCopy(logicConditionsMutable(0), PG_LOGIC_CONDITIONS);
+        logicConditionInvalidateProgram();
     } else {
         enum {
             INDEX = 0,
@@ -2002,6 +2151,7 @@ static void cliLogic(char *cmdline) {
             logicConditionsMutable(i)->operandB.type = args[OPERAND_B_TYPE];
             logicConditionsMutable(i)->operandB.value = args[OPERAND_B_VALUE];
             logicConditionsMutable(i)->flags = args[FLAGS];
+            logicConditionInvalidateProgram();
 
             cliLogic("");
         } else {
@@ -2171,7 +2321,7 @@ static void cliPid(char *cmdline) {
         int32_t i = args[INDEX];
         if (
             i >= 0 && i < MAX_PROGRAMMING_PID_COUNT &&
-            args[ENABLED] >= 0 && args[ENABLED] <= 1 &&
+            args[ENABLED] >= PROGRAMMING_PID_DISABLED && args[ENABLED] <= PROGRAMMING_PID_ENABLED_FAST &&
             args[SETPOINT_TYPE] >= 0 && args[SETPOINT_TYPE] < LOGIC_CONDITION_OPERAND_TYPE_LAST &&
             args[SETPOINT_VALUE] >= -1000000 && args[SETPOINT_VALUE] <= 1000000 &&
             args[MEASUREMENT_TYPE] >= 0 && args[MEASUREMENT_TYPE] < LOGIC_CONDITION_OPERAND_TYPE_LAST &&
@@ -2268,6 +2418,26 @@ static void cliSdInfo(char *cmdline)
         break;
     }
     cliPrintLinefeed();
+
+    const sdcardWriteStats_t *writeStats = sdcard_getWriteStats();
+    cliPrintLinef("Writes: %u, stalls: %u, latency last %uus, max %uus, estimate %uus",
+        writeStats->writeCount,
+        writeStats->stallCount,
+        writeStats->lastLatencyUs,
+        writeStats->maxLatencyUs,
+        writeStats->latencyEstimateUs
+    );
+
+#ifdef USE_BLACKBOX
+    const blackboxSDCardBufferStats_t *bufferStats = blackboxGetSDCardBufferStats();
+    cliPrintLinef("Blackbox buffer: %u bytes, peak %u, dropped %u, %u B/s, stalls need %u",
+        bufferStats->bufferSize,
+        bufferStats->peakUsedBytes,
+        bufferStats->droppedBytes,
+        bufferStats->bytesPerSecond,
+        bufferStats->requiredBytes
+    );
+#endif
 }
 
 #endif
@@ -2299,6 +2469,13 @@ static void cliFlashInfo(char *cmdline)
         }
         cliPrintLinef("  %d: %s %u %u", index, flashPartitionGetTypeName(partition->type), partition->startSector, partition->endSector);
     }
+
+    flashHealth_t health;
+    if (flashGetHealth(&health)) {
+        cliPrintLinef("Health badBlocks=%u, remapped=%u, spare=%u, eccCorrected=%u, eccUncorrectable=%u, programFail=%u, eraseFail=%u",
+                health.badBlocks, health.remappedBlocks, health.spareBlocks, (unsigned)health.eccCorrected,
+                (unsigned)health.eccUncorrectable, health.programFailures, health.eraseFailures);
+    }
 #ifdef USE_FLASHFS
     const flashPartition_t *flashPartition = flashPartitionFindByType(FLASH_PARTITION_TYPE_FLASHFS);
 
@@ -3228,70 +3405,68 @@ static void cliSet(char *cmdline)
             eqptr++;
         }
 
-        for (uint32_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-            val = settingGet(i);
-            // ensure exact match when setting to prevent setting variables with shorter names
-            if (settingNameIsExactMatch(val, name, cmdline, variableNameLength)) {
-                const setting_type_e type = SETTING_TYPE(val);
-                if (type == VAR_STRING) {
-                    // if setting the craftname, remove any quotes around the name.  This allows leading spaces in the name
-                    if (strcmp(name, "name") == 0 && eqptr[0] == '"' && eqptr[strlen(eqptr)-1] == '"') {
-                        settingSetString(val, eqptr + 1, strlen(eqptr)-2);
-                    } else {
-                        settingSetString(val, eqptr, strlen(eqptr));
-                    }
-                    return;
+        // ensure exact match when setting to prevent setting variables with shorter names
+        val = settingFindIgnoreCase(cmdline, variableNameLength, name);
+        if (val) {
+            const setting_type_e type = SETTING_TYPE(val);
+            if (type == VAR_STRING) {
+                // if setting the craftname, remove any quotes around the name.  This allows leading spaces in the name
+                if (strcmp(name, "name") == 0 && eqptr[0] == '"' && eqptr[strlen(eqptr)-1] == '"') {
+                    settingSetString(val, eqptr + 1, strlen(eqptr)-2);
+                } else {
+                    settingSetString(val, eqptr, strlen(eqptr));
                 }
-                const setting_mode_e mode = SETTING_MODE(val);
-                bool changeValue = false;
-                int_float_value_t tmp = {0};
-                switch (mode) {
-                case MODE_DIRECT: {
-                        if (*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
-                            float valuef = fastA2F(eqptr);
-                            // note: compare float values
-                            if (valuef >= (float)settingGetMin(val) && valuef <= (float)settingGetMax(val)) {
-
-                                if (type == VAR_FLOAT)
-                                    tmp.float_value = valuef;
-                                else if (type == VAR_UINT32)
-                                    tmp.uint_value = fastA2UL(eqptr);
-                                else
-                                    tmp.int_value = fastA2I(eqptr);
-
-                                changeValue = true;
-                            }
+                return;
+            }
+            const setting_mode_e mode = SETTING_MODE(val);
+            bool changeValue = false;
+            int_float_value_t tmp = {0};
+            switch (mode) {
+            case MODE_DIRECT: {
+                    if (*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
+                        float valuef = fastA2F(eqptr);
+                        // note: compare float values
+                        if (valuef >= (float)settingGetMin(val) && valuef <= (float)settingGetMax(val)) {
+
+                            if (type == VAR_FLOAT)
+                                tmp.float_value = valuef;
+                            else if (type == VAR_UINT32)
+                                tmp.uint_value = fastA2UL(eqptr);
+                            else
+                                tmp.int_value = fastA2I(eqptr);
+
+                            changeValue = true;
                         }
                     }
-                    break;
-                case MODE_LOOKUP: {
-                        const lookupTableEntry_t *tableEntry = settingLookupTable(val);
-                        bool matched = false;
-                        for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
-                            matched = sl_strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
-
-                            if (matched) {
-                                tmp.int_value = tableValueIndex;
-                                changeValue = true;
-                            }
+                }
+                break;
+            case MODE_LOOKUP: {
+                    const lookupTableEntry_t *tableEntry = settingLookupTable(val);
+                    bool matched = false;
+                    for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
+                        matched = sl_strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
+
+                        if (matched) {
+                            tmp.int_value = tableValueIndex;
+                            changeValue = true;
                         }
                     }
-                    break;
                 }
+                break;
+            }
 
-                if (changeValue) {
-                    cliSetIntFloatVar(val, tmp);
-
-                    cliPrintf("%s set to ", name);
-                    cliPrintVar(val, 0);
-                } else {
-                    cliPrintError("Invalid value. ");
-                    cliPrintVarRange(val);
-                    cliPrintLinefeed();
-                }
+            if (changeValue) {
+                cliSetIntFloatVar(val, tmp);
 
-                return;
+                cliPrintf("%s set to ", name);
+                cliPrintVar(val, 0);
+            } else {
+                cliPrintError("Invalid value. ");
+                cliPrintVarRange(val);
+                cliPrintLinefeed();
             }
+
+            return;
         }
         cliPrintErrorLine("Invalid name");
     } else {
@@ -3366,6 +3541,10 @@ static void cliStatus(char *cmdline)
 #endif
     );
 
+    if (gyro.initialized) {
+        cliPrintLinef("Gyro clipped samples: X=%u, Y=%u, Z=%u", (unsigned)gyro.clipCount[X], (unsigned)gyro.clipCount[Y], (unsigned)gyro.clipCount[Z]);
+    }
+
 #ifdef USE_ESC_SENSOR
     uint8_t motorCount = getMotorCount();
     if (STATE(ESC_SENSOR_ENABLED) && motorCount > 0) {
@@ -3502,6 +3681,108 @@ static void cliTasks(char *cmdline)
     cliPrintLinef("Total (excluding SERIAL) %21d.%1d%% %4d.%1d%%", maxLoadSum/10, maxLoadSum%10, averageLoadSum/10, averageLoadSum%10);
 }
 
+#ifdef USE_TRACE_RING
+static const char *cliTraceTaskName(uint8_t taskId)
+{
+    if (taskId >= TASK_COUNT) {
+        return "?";
+    }
+    cfTaskInfo_t taskInfo;
+    getTaskInfo(taskId, &taskInfo);
+    return taskInfo.taskName;
+}
+
+static void cliTrace(char *cmdline)
+{
+    static const char * const eventNames[] = {
+        [TRACE_EVENT_NONE] = "",
+        [TRACE_EVENT_BOOT] = "BOOT",
+        [TRACE_EVENT_LONG_TASK] = "LONG_TASK",
+        [TRACE_EVENT_BUS_ERROR] = "BUS_ERROR",
+        [TRACE_EVENT_FAULT_PC] = "FAULT_PC",
+        [TRACE_EVENT_FAULT_LR] = "FAULT_LR",
+        [TRACE_EVENT_FAULT_STATUS] = "FAULT_CFSR",
+    };
+
+    if (strcasecmp(cmdline, "clear") == 0) {
+        traceRingClear();
+        return;
+    }
+
+    cliPrintLinef("Current boot %d", traceRingBootCount());
+    cliPrintLine("Events, newest first:");
+    cliPrintLine(" boot    time/ms  event        id        data");
+    const traceEvent_t *event;
+    for (unsigned ii = 0; (event = traceRingGetEvent(ii)) != NULL; ii++) {
+        const char *name = event->type < ARRAYLEN(eventNames) ? eventNames[event->type] : "?";
+        if (event->type == TRACE_EVENT_LONG_TASK) {
+            cliPrintLinef("%5d %10d  %-12s %-8s %5d us", event->boot, event->timeUs / 1000, name, cliTraceTaskName(event->id), event->data);
+        } else {
+            cliPrintLinef("%5d %10d  %-12s %-8d 0x%08x", event->boot, event->timeUs / 1000, name, event->id, event->data);
+        }
+    }
+
+    cliPrintLine("Task starts before the last reset, newest first:");
+    const traceTaskStart_t *start;
+    for (unsigned ii = 0; (start = traceRingGetTaskStart(ii)) != NULL; ii++) {
+        cliPrintLinef("%10d us  %s", start->timeUs, cliTraceTaskName(start->taskId));
+    }
+}
+#endif
+
+#ifdef USE_CLI_BENCH
+static void cliBench(char *cmdline)
+{
+    const int calls = isEmpty(cmdline) ? BENCH_DEFAULT_CALLS : fastA2I(cmdline);
+
+    if (ARMING_FLAG(ARMED)) {
+        cliPrintErrorLinef("Not available while armed");
+        return;
+    }
+    if (calls < 1 || calls > BENCH_MAX_CALLS) {
+        cliShowArgumentRangeError("calls", 1, BENCH_MAX_CALLS);
+        return;
+    }
+
+    cliPrintLinef("%d calls per kernel at %d MHz", calls, usTicks);
+    cliPrintLinef("                 Kernel  min/cyc  avg/cyc  max/cyc  avg/us");
+    for (int kernel = 0; kernel < BENCH_KERNEL_COUNT; kernel++) {
+        benchResult_t result;
+
+        if (!benchRun(kernel, calls, &result)) {
+            cliPrintLinef("%23s  not available", benchKernelName(kernel));
+            continue;
+        }
+
+        cliPrintLinef("%23s %8d %8d %8d %7d",
+                benchKernelName(kernel), result.minCycles, result.avgCycles, result.maxCycles, result.avgCycles / usTicks);
+    }
+}
+#endif
+
+#ifdef USE_PROFILING_ZONES
+static void cliTiming(char *cmdline)
+{
+    UNUSED(cmdline);
+    const uint32_t cyclesPerUs = profilingCyclesPerUs();
+
+    cliPrintLinef("                   Zone  calls  min/cyc  avg/cyc  max/cyc  avg/us  max/us  peak/us");
+    for (int zone = 0; zone < PROFILING_ZONE_COUNT; zone++) {
+        const profilingWindow_t *window = profilingZoneGetWindow(zone, 0);
+
+        // Worst case over the whole history
+        uint32_t peakCycles = 0;
+        for (int ii = 0; ii < PROFILING_HISTORY_LENGTH; ii++) {
+            peakCycles = MAX(peakCycles, profilingZoneGetWindow(zone, ii)->maxCycles);
+        }
+
+        cliPrintLinef("%23s %6d %8d %8d %8d %7d %7d %8d",
+                profilingZoneName(zone), window->count, window->minCycles, window->avgCycles, window->maxCycles,
+                window->avgCycles / cyclesPerUs, window->maxCycles / cyclesPerUs, peakCycles / cyclesPerUs);
+    }
+}
+#endif
+
 static void cliVersion(char *cmdline)
 {
     UNUSED(cmdline);
@@ -3531,6 +3812,10 @@ static void cliMemory(char *cmdline)
             cliPrintLinef("%s : %d bytes", owner, memUsed);
         }
     }
+
+    if (memGetArenaSize()) {
+        cliPrintLinef("Arena : %d of %d bytes free", memGetArenaAvailableBytes(), memGetArenaSize());
+    }
 }
 
 static void cliResource(char *cmdline)
@@ -3652,6 +3937,14 @@ static void printConfig(const char *cmdline, bool doDiff)
         printSafeHomes(dumpMask, safeHomeConfig_CopyArray, safeHomeConfig(0));
 #endif
 
+#if defined(USE_GEOZONE)
+        cliPrintHashLine("geozone");
+        printGeozones(dumpMask, geozones_CopyArray, geozones(0));
+
+        cliPrintHashLine("geozone vertices");
+        printGeozoneVertices(dumpMask, geozoneVertices_CopyArray, geozoneVertices(0));
+#endif
+
         cliPrintHashLine("feature");
         printFeature(dumpMask, &featureConfig_Copy, featureConfig());
 
@@ -3849,6 +4142,9 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("beeper", "turn on/off beeper", "list\r\n"
             "\t<+|->[name]", cliBeeper),
 #endif
+#ifdef USE_CLI_BENCH
+    CLI_COMMAND_DEF("bench", "time the flight kernels on synthetic data", "[<calls>]", cliBench),
+#endif
 #if defined (USE_SERIALRX_SRXL2)
     CLI_COMMAND_DEF("bind_rx", "initiate binding for RX SPI or SRXL2", NULL, cliRxBind),
 #endif
@@ -3885,6 +4181,10 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("flash_read", NULL, "<length> <address>", cliFlashRead),
     CLI_COMMAND_DEF("flash_write", NULL, "<address> <message>", cliFlashWrite),
 #endif
+#endif
+#if defined(USE_GEOZONE)
+    CLI_COMMAND_DEF("geovertex", "geozone vertex list", "[<index> <lat> <lon>]", cliGeozoneVertex),
+    CLI_COMMAND_DEF("geozone", "geozone list", "[<index> <type> <action> <first vertex> <vertex count> <min alt> <max alt>]", cliGeozone),
 #endif
     CLI_COMMAND_DEF("get", "get variable value", "[name]", cliGet),
 #ifdef USE_GPS
@@ -3942,6 +4242,12 @@ const clicmd_t cmdTable[] = {
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
+#ifdef USE_TRACE_RING
+    CLI_COMMAND_DEF("trace", "show events before the last resets", "[clear]", cliTrace),
+#endif
+#ifdef USE_PROFILING_ZONES
+    CLI_COMMAND_DEF("timing", "show code zone timing", NULL, cliTiming),
+#endif
 #ifdef USE_TEMPERATURE_SENSOR
     CLI_COMMAND_DEF("temp_sensor", "change temp sensor settings", NULL, cliTempSensor),
 #endif
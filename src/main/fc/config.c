@@ -76,6 +76,8 @@
 
 #include "navigation/navigation.h"
 
+#include "programming/logic_condition.h"
+
 #ifndef DEFAULT_FEATURES
 #define DEFAULT_FEATURES 0
 #endif
@@ -102,7 +104,7 @@ PG_RESET_TEMPLATE(featureConfig_t, featureConfig,
     .enabledFeatures = DEFAULT_FEATURES | COMMON_DEFAULT_FEATURES
 );
 
-PG_REGISTER_WITH_RESET_TEMPLATE(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 7);
+PG_REGISTER_WITH_RESET_TEMPLATE(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 9);
 
 PG_RESET_TEMPLATE(systemConfig_t, systemConfig,
     .current_profile_index = 0,
@@ -118,6 +120,10 @@ PG_RESET_TEMPLATE(systemConfig_t, systemConfig,
     .cpuUnderclock = SETTING_CPU_UNDERCLOCK_DEFAULT,
 #endif
     .throttle_tilt_compensation_strength = SETTING_THROTTLE_TILT_COMP_STR_DEFAULT,      // 0-100, 0 - disabled
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    .programming_task_hz = SETTING_PROGRAMMING_TASK_HZ_DEFAULT,
+#endif
+    .loadShedding = SETTING_LOAD_SHEDDING_DEFAULT,
     .name = SETTING_NAME_DEFAULT
 );
 
@@ -307,6 +313,12 @@ static void activateConfig(void)
     pidInit();
 
     navigationUsePIDs();
+
+    logicConditionInvalidateProgram();
+
+#if defined(USE_GEOZONE)
+    geozoneInvalidate();
+#endif
 }
 
 void readEEPROM(void)
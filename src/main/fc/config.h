@@ -80,6 +80,10 @@ typedef struct systemConfig_s {
     uint8_t cpuUnderclock;
 #endif
     uint8_t throttle_tilt_compensation_strength;    // the correction that will be applied at throttle_correction_angle.
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    uint8_t programming_task_hz;
+#endif
+    bool loadShedding;                      // Cut non-critical work back while the PID loop misses deadlines
     char name[MAX_NAME_LENGTH + 1];
 } systemConfig_t;
 
@@ -87,15 +87,20 @@ void setControlRateProfile(uint8_t profileIndex)
         profileIndex = 0;
     }
     currentControlRateProfile = controlRateProfiles(profileIndex);
+    selectRcCurves(profileIndex);
 }
 
 void activateControlRateConfig(void)
 {
-    generateThrottleCurve(currentControlRateProfile);
+    // Curves of all profiles are ready before any of them is selected
+    for (int i = 0; i < MAX_CONTROL_RATE_PROFILE_COUNT; i++) {
+        generateThrottleCurve(controlRateProfiles(i));
+        generateRcCurves(controlRateProfiles(i));
+        generateTpaCurves(controlRateProfiles(i));
+    }
 }
 
 void changeControlRateProfile(uint8_t profileIndex)
 {
     setControlRateProfile(profileIndex);
-    activateControlRateConfig();
 }
@@ -26,6 +26,7 @@ FILE_COMPILE_FOR_SPEED
 #include "blackbox/blackbox.h"
 
 #include "build/debug.h"
+#include "build/profiling.h"
 
 #include "common/maths.h"
 #include "common/axis.h"
@@ -35,8 +36,11 @@ FILE_COMPILE_FOR_SPEED
 
 #include "drivers/light_led.h"
 #include "drivers/serial.h"
+#include "drivers/serial_softserial.h"
 #include "drivers/time.h"
 #include "drivers/system.h"
+#include "drivers/adc.h"
+#include "drivers/bus.h"
 #include "drivers/pwm_output.h"
 
 #include "sensors/sensors.h"
@@ -56,12 +60,14 @@ FILE_COMPILE_FOR_SPEED
 #include "fc/cli.h"
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
+#include "fc/load_shedding.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_smoothing.h"
 #include "fc/rc_controls.h"
 #include "fc/rc_curves.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
+#include "fc/warm_restart.h"
 
 #include "io/beeper.h"
 #include "io/dashboard.h"
@@ -86,6 +92,7 @@ FILE_COMPILE_FOR_SPEED
 #include "flight/servos.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
+#include "flight/dynamic_lpf.h"
 #include "flight/secondary_imu.h"
 #include "flight/rate_dynamics.h"
 
@@ -130,6 +137,7 @@ int16_t headFreeModeHold;
 uint8_t motorControlEnable = false;
 
 static bool isRXDataNew;
+static uint16_t rcLatencyUs;
 static disarmReason_t lastDisarmReason = DISARM_NONE;
 timeUs_t lastDisarmTimeUs = 0;
 static emergencyArmingState_t emergencyArming;
@@ -172,21 +180,25 @@ bool areSensorsCalibrating(void)
     return false;
 }
 
-int16_t getAxisRcCommand(int16_t rawData, int16_t rate, int16_t deadband)
+int16_t getAxisRcCommand(int16_t rawData, rcCurve_e curve, int16_t deadband)
 {
     int16_t stickDeflection;
 
     stickDeflection = constrain(rawData - PWM_RANGE_MIDDLE, -500, 500);
     stickDeflection = applyDeadbandRescaled(stickDeflection, deadband, -500, 500);
 
-    return rcLookup(stickDeflection, rate);
+    return rcLookupCurve(stickDeflection, curve);
 }
 
-static void updateArmingStatus(void)
+/*
+ * Arming blockers follow RC, sensor and system state that changes at human
+ * timescales. They are re-evaluated from processRx(), on every RC frame or at
+ * the RX task fallback rate, and right before an arming attempt. The PID loop
+ * only looks at the combined flags.
+ */
+static void updateArmingBlockers(void)
 {
-    if (ARMING_FLAG(ARMED)) {
-        LED0_ON;
-    } else {
+    if (!ARMING_FLAG(ARMED)) {
         /* CHECK: Run-time calibration */
         static bool calibratingFinishedBeep = false;
         if (areSensorsCalibrating()) {
@@ -358,7 +370,14 @@ static void updateArmingStatus(void)
         } else if (!IS_RC_MODE_ACTIVE(BOXARM)) {
             DISABLE_ARMING_FLAG(ARMING_DISABLED_ARM_SWITCH);
         }
+    }
+}
 
+static void updateArmingStatus(void)
+{
+    if (ARMING_FLAG(ARMED)) {
+        LED0_ON;
+    } else {
         if (isArmingDisabled()) {
             warningLedFlash();
         } else {
@@ -397,9 +416,9 @@ static void processPilotAndFailSafeActions(float dT)
     }
     else {
         // Compute ROLL PITCH and YAW command
-        rcCommand[ROLL] = getAxisRcCommand(rxGetChannelValue(ROLL), FLIGHT_MODE(MANUAL_MODE) ? currentControlRateProfile->manual.rcExpo8 : currentControlRateProfile->stabilized.rcExpo8, rcControlsConfig()->deadband);
-        rcCommand[PITCH] = getAxisRcCommand(rxGetChannelValue(PITCH), FLIGHT_MODE(MANUAL_MODE) ? currentControlRateProfile->manual.rcExpo8 : currentControlRateProfile->stabilized.rcExpo8, rcControlsConfig()->deadband);
-        rcCommand[YAW] = -getAxisRcCommand(rxGetChannelValue(YAW), FLIGHT_MODE(MANUAL_MODE) ? currentControlRateProfile->manual.rcYawExpo8 : currentControlRateProfile->stabilized.rcYawExpo8, rcControlsConfig()->yaw_deadband);
+        rcCommand[ROLL] = getAxisRcCommand(rxGetChannelValue(ROLL), FLIGHT_MODE(MANUAL_MODE) ? RC_CURVE_MANUAL : RC_CURVE_STABILIZED, rcControlsConfig()->deadband);
+        rcCommand[PITCH] = getAxisRcCommand(rxGetChannelValue(PITCH), FLIGHT_MODE(MANUAL_MODE) ? RC_CURVE_MANUAL : RC_CURVE_STABILIZED, rcControlsConfig()->deadband);
+        rcCommand[YAW] = -getAxisRcCommand(rxGetChannelValue(YAW), FLIGHT_MODE(MANUAL_MODE) ? RC_CURVE_MANUAL_YAW : RC_CURVE_STABILIZED_YAW, rcControlsConfig()->yaw_deadband);
 
         // Apply manual control rates
         if (FLIGHT_MODE(MANUAL_MODE)) {
@@ -429,8 +448,8 @@ static void processPilotAndFailSafeActions(float dT)
 
         if (FLIGHT_MODE(HEADFREE_MODE)) {
             const float radDiff = degreesToRadians(DECIDEGREES_TO_DEGREES(attitude.values.yaw) - headFreeModeHold);
-            const float cosDiff = cos_approx(radDiff);
-            const float sinDiff = sin_approx(radDiff);
+            float sinDiff, cosDiff;
+            sincos_approx(radDiff, &sinDiff, &cosDiff);
             const int16_t rcCommand_PITCH = rcCommand[PITCH] * cosDiff + rcCommand[ROLL] * sinDiff;
             rcCommand[ROLL] = rcCommand[ROLL] * cosDiff - rcCommand[PITCH] * sinDiff;
             rcCommand[PITCH] = rcCommand_PITCH;
@@ -444,6 +463,7 @@ void disarm(disarmReason_t disarmReason)
         lastDisarmReason = disarmReason;
         lastDisarmTimeUs = micros();
         DISABLE_ARMING_FLAG(ARMED);
+        warmRestartClear();
 
 #ifdef USE_BLACKBOX
         if (feature(FEATURE_BLACKBOX)) {
@@ -457,6 +477,9 @@ void disarm(disarmReason_t disarmReason)
         }
 #endif
         statsOnDisarm();
+#ifdef USE_GPS
+        gpsOnDisarm();
+#endif
         logicConditionReset();
 
 #ifdef USE_PROGRAMMING_FRAMEWORK
@@ -521,12 +544,61 @@ void releaseSharedTelemetryPorts(void) {
     }
 }
 
+static void performArm(void)
+{
+    lastDisarmReason = DISARM_NONE;
+
+    ENABLE_ARMING_FLAG(ARMED);
+    ENABLE_ARMING_FLAG(WAS_EVER_ARMED);
+    //It is required to inform the mixer that arming was executed and it has to switch to the FORWARD direction
+    ENABLE_STATE(SET_REVERSIBLE_MOTORS_FORWARD);
+    logicConditionReset();
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    programmingPidReset();
+#endif
+
+    headFreeModeHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+
+    resetHeadingHoldTarget(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+
+#ifdef USE_BLACKBOX
+    if (feature(FEATURE_BLACKBOX)) {
+        serialPort_t *sharedBlackboxAndMspPort = findSharedSerialPort(FUNCTION_BLACKBOX, FUNCTION_MSP);
+        if (sharedBlackboxAndMspPort) {
+            mspSerialReleasePortIfAllocated(sharedBlackboxAndMspPort);
+        }
+        blackboxStart();
+    }
+#endif
+
+    //beep to indicate arming
+    if (navigationPositionEstimateIsHealthy()) {
+        beeper(BEEPER_ARMING_GPS_FIX);
+    } else {
+        beeper(BEEPER_ARMING);
+    }
+
+    statsOnArm();
+}
+
+/*
+ * Re-arm without the arming checks, the system was reset while armed in
+ * flight. See fc/warm_restart.c
+ */
+void armAfterWarmRestart(void)
+{
+    if (!ARMING_FLAG(ARMED)) {
+        performArm();
+    }
+}
+
 void tryArm(void)
 {
 #ifdef USE_MULTI_MISSION
     setMultiMissionOnArm();
 #endif
-    updateArmingStatus();
+    updateArmingBlockers();
 
 #ifdef USE_DSHOT
     if (
@@ -570,40 +642,7 @@ void tryArm(void)
             ENABLE_STATE(NAV_EXTRA_ARMING_SAFETY_BYPASSED);
         }
 
-        lastDisarmReason = DISARM_NONE;
-
-        ENABLE_ARMING_FLAG(ARMED);
-        ENABLE_ARMING_FLAG(WAS_EVER_ARMED);
-        //It is required to inform the mixer that arming was executed and it has to switch to the FORWARD direction
-        ENABLE_STATE(SET_REVERSIBLE_MOTORS_FORWARD);
-        logicConditionReset();
-
-#ifdef USE_PROGRAMMING_FRAMEWORK
-        programmingPidReset();
-#endif
-
-        headFreeModeHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
-
-        resetHeadingHoldTarget(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
-
-#ifdef USE_BLACKBOX
-        if (feature(FEATURE_BLACKBOX)) {
-            serialPort_t *sharedBlackboxAndMspPort = findSharedSerialPort(FUNCTION_BLACKBOX, FUNCTION_MSP);
-            if (sharedBlackboxAndMspPort) {
-                mspSerialReleasePortIfAllocated(sharedBlackboxAndMspPort);
-            }
-            blackboxStart();
-        }
-#endif
-
-        //beep to indicate arming
-        if (navigationPositionEstimateIsHealthy()) {
-            beeper(BEEPER_ARMING_GPS_FIX);
-        } else {
-            beeper(BEEPER_ARMING);
-        }
-
-        statsOnArm();
+        performArm();
 
         return;
     }
@@ -833,9 +872,36 @@ void processRx(timeUs_t currentTimeUs)
     }
 #endif
 
+    updateArmingBlockers();
 }
 
 // Function for loop trigger
+#ifdef USE_MPU_DATA_READY_SIGNAL
+// Fall back to polling if the data-ready interrupt hasn't fired for this many gyro sample intervals
+#define GYRO_SYNC_WATCHDOG_PERIODS  2
+
+static FASTRAM uint8_t gyroSyncSamplesSincePid = 0;
+
+bool FAST_CODE taskGyroSyncCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
+    return gyroSyncCheckUpdate() || currentDeltaTimeUs >= (timeDelta_t)(getGyroLooptime() * GYRO_SYNC_WATCHDOG_PERIODS);
+}
+
+bool FAST_CODE taskPidSyncCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
+    UNUSED(currentDeltaTimeUs);
+
+    // PID loop runs right after every N-th gyro sample, N = looptime / gyro sampling interval
+    if (gyroSyncSamplesSincePid > 0 && gyroSyncSamplesSincePid >= getLooptime() / getGyroLooptime()) {
+        gyroSyncSamplesSincePid = 0;
+        return true;
+    }
+    return false;
+}
+#endif
+
 void FAST_CODE taskGyro(timeUs_t currentTimeUs) {
     UNUSED(currentTimeUs);
     // getTaskDeltaTime() returns delta time frozen at the moment of entering the scheduler. currentTime is frozen at the very same point.
@@ -843,11 +909,19 @@ void FAST_CODE taskGyro(timeUs_t currentTimeUs) {
     const timeDelta_t currentDeltaTime = getTaskDeltaTime(TASK_SELF);
 
     /* Update actual hardware readings */
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_GYRO_UPDATE);
     gyroUpdate();
+    PROFILING_ZONE_END(PROFILING_ZONE_GYRO_UPDATE);
+
+#ifdef USE_MPU_DATA_READY_SIGNAL
+    if (gyroSyncSamplesSincePid < UINT8_MAX) {
+        gyroSyncSamplesSincePid++;
+    }
+#endif
 
 #ifdef USE_OPFLOW
     if (sensors(SENSOR_OPFLOW)) {
-        opflowGyroUpdateCallback(currentDeltaTime);
+        opflowGyroUpdateCallback(currentTimeUs, currentDeltaTime);
     }
 #endif
 }
@@ -867,6 +941,8 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     cycleTime = getTaskDeltaTime(TASK_SELF);
     dT = (float)cycleTime * 0.000001f;
 
+    loadSheddingUpdate(currentTimeUs, cycleTime);
+
     if (ARMING_FLAG(ARMED) && (!STATE(FIXED_WING_LEGACY) || !isNavLaunchEnabled() || (isNavLaunchEnabled() && fixedWingLaunchStatus() >= FW_LAUNCH_DETECTED))) {
         flightTime += cycleTime;
         armTime += cycleTime;
@@ -876,15 +952,31 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
         armTime = 0;
     }
 
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_GYRO_FILTER);
+    dynamicLpfGyroTask();
     gyroFilter();
+    PROFILING_ZONE_END(PROFILING_ZONE_GYRO_FILTER);
 
     imuUpdateAccelerometer();
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_IMU_UPDATE_ATTITUDE);
     imuUpdateAttitude(currentTimeUs);
+    PROFILING_ZONE_END(PROFILING_ZONE_IMU_UPDATE_ATTITUDE);
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    logicConditionUpdateFast();
+    programmingPidUpdateFast(dT);
+#endif
 
     processPilotAndFailSafeActions(dT);
 
     updateArmingStatus();
 
+    if (isRXDataNew) {
+        // Time from the end of the RC frame on the wire to the first PID loop using it
+        const timeDelta_t latency = cmpTimeUs(currentTimeUs, rxGetFrameTimeUs());
+        rcLatencyUs = constrain(latency, 0, UINT16_MAX);
+    }
+
     if (rxConfig()->rcFilterFrequency) {
         rcInterpolationApply(isRXDataNew, currentTimeUs);
     }
@@ -895,7 +987,9 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 
     isRXDataNew = false;
 
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_POSITION_ESTIMATOR);
     updatePositionEstimator();
+    PROFILING_ZONE_END(PROFILING_ZONE_POSITION_ESTIMATOR);
     applyWaypointNavigationAndAltitudeHold();
 
     // Apply throttle tilt compensation
@@ -925,20 +1019,29 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 #endif
 
     // Calculate stabilisation
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_PID_CONTROLLER);
     pidController(dT);
+    PROFILING_ZONE_END(PROFILING_ZONE_PID_CONTROLLER);
 
+    PROFILING_ZONE_BEGIN(PROFILING_ZONE_MIX_TABLE);
     mixTable();
+    PROFILING_ZONE_END(PROFILING_ZONE_MIX_TABLE);
+
+    float servoDT;
+    const bool servoUpdate = servoUpdateIsDue(dT, &servoDT);
 
-    if (isMixerUsingServos()) {
-        servoMixer(dT);
-        processServoAutotrim(dT);
+    if (isMixerUsingServos() && servoUpdate) {
+        PROFILING_ZONE_BEGIN(PROFILING_ZONE_SERVO_MIXER);
+        servoMixer(servoDT);
+        PROFILING_ZONE_END(PROFILING_ZONE_SERVO_MIXER);
+        processServoAutotrim(servoDT);
     }
 
     //Servos should be filtered or written only when mixer is using servos or special feaures are enabled
 
 #ifdef USE_SMULATOR
 	if (!ARMING_FLAG(SIMULATOR_MODE)) {
-	    if (isServoOutputEnabled()) {
+	    if (isServoOutputEnabled() && servoUpdate) {
 	        writeServos();
 	    }
 
@@ -947,7 +1050,7 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 	    }
 	}
 #else
-    if (isServoOutputEnabled()) {
+    if (isServoOutputEnabled() && servoUpdate) {
         writeServos();
     }
 
@@ -963,7 +1066,9 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 
 #ifdef USE_BLACKBOX
     if (!cliMode && feature(FEATURE_BLACKBOX)) {
+        PROFILING_ZONE_BEGIN(PROFILING_ZONE_BLACKBOX_UPDATE);
         blackboxUpdate(micros());
+        PROFILING_ZONE_END(PROFILING_ZONE_BLACKBOX_UPDATE);
     }
 #endif
 }
@@ -978,6 +1083,14 @@ void taskRunRealtimeCallbacks(timeUs_t currentTimeUs)
     afatfs_poll();
 #endif
 
+    busAsyncProcess();
+
+    rxReplySlotProcess(currentTimeUs);
+
+#ifdef USE_SOFTSERIAL_DMA
+    softSerialProcess();
+#endif
+
 #ifdef USE_DSHOT
     pwmCompleteMotorUpdate();
 #endif
@@ -985,6 +1098,10 @@ void taskRunRealtimeCallbacks(timeUs_t currentTimeUs)
 #ifdef USE_ESC_SENSOR
     escSensorUpdate(currentTimeUs);
 #endif
+
+#ifdef USE_ADC
+    adcAccumulatorUpdate(currentTimeUs);
+#endif
 }
 
 bool taskUpdateRxCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
@@ -1001,6 +1118,11 @@ void taskUpdateRxMain(timeUs_t currentTimeUs)
 }
 
 // returns seconds
+uint16_t getRcLatencyUs(void)
+{
+    return rcLatencyUs;
+}
+
 float getFlightTime()
 {
     return US2S(flightTime);
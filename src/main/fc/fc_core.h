@@ -40,6 +40,7 @@ void handleInflightCalibrationStickPosition(void);
 void disarm(disarmReason_t disarmReason);
 timeUs_t getLastDisarmTimeUs(void);
 void tryArm(void);
+void armAfterWarmRestart(void);
 disarmReason_t getDisarmReason(void);
 
 void emergencyArmingUpdate(bool armingSwitchIsOn);
@@ -47,5 +48,6 @@ void emergencyArmingUpdate(bool armingSwitchIsOn);
 bool areSensorsCalibrating(void);
 float getFlightTime(void);
 float getArmTime(void);
+uint16_t getRcLatencyUs(void);
 
 void fcReboot(bool bootLoader);
\ No newline at end of file
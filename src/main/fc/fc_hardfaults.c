@@ -20,6 +20,8 @@
 
 #include "platform.h"
 
+#include "build/trace_ring.h"
+
 #include "drivers/light_led.h"
 #include "drivers/time.h"
 
@@ -90,8 +92,28 @@ void hard_fault_handler_c(unsigned long *hardfault_args)
 
 #else
 
+#ifdef USE_TRACE_RING
+void hardFaultHandlerC(uint32_t *stackFrame);
+
+// Hands the exception frame of the faulting context to hardFaultHandlerC()
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile (
+        "tst lr, #4             \n"
+        "ite eq                 \n"
+        "mrseq r0, msp          \n"
+        "mrsne r0, psp          \n"
+        "b hardFaultHandlerC    \n"
+    );
+}
+
+void hardFaultHandlerC(uint32_t *stackFrame)
+{
+    traceRingRecordFault(stackFrame);
+#else
 void HardFault_Handler(void)
 {
+#endif
     LED2_ON;
 
     // fall out of the sky
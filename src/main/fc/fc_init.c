@@ -28,6 +28,7 @@
 #include "build/atomic.h"
 #include "build/build_config.h"
 #include "build/debug.h"
+#include "build/trace_ring.h"
 
 #include "common/axis.h"
 #include "common/color.h"
@@ -49,6 +50,7 @@
 #include "drivers/adc.h"
 #include "drivers/compass/compass.h"
 #include "drivers/bus.h"
+#include "drivers/crc_hw.h"
 #include "drivers/dma.h"
 #include "drivers/exti.h"
 #include "drivers/io.h"
@@ -89,6 +91,7 @@
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
 #include "fc/firmware_update.h"
+#include "fc/warm_restart.h"
 
 #include "flight/failsafe.h"
 #include "flight/imu.h"
@@ -201,6 +204,10 @@ void init(void)
     // Initialize system and CPU clocks to their initial values
     systemInit();
 
+#ifdef USE_TRACE_RING
+    traceRingInit();
+#endif
+
     __enable_irq();
 
     // initialize IO (needed for all IO operations)
@@ -221,6 +228,10 @@ void init(void)
     flashDeviceInitialized = flashInit();
 #endif
 
+#ifdef USE_CRC_HW
+    crcHwInit();
+#endif
+
     initEEPROM();
     ensureEEPROMContainsValidData();
     readEEPROM();
@@ -471,22 +482,14 @@ void init(void)
     pinioBoxInit();
 #endif
 
-#if defined(USE_GPS) || defined(USE_MAG)
-    delay(500);
-
-    /* Extra 500ms delay prior to initialising hardware if board is cold-booting */
-    if (!isMPUSoftReset()) {
-        LED1_ON;
-        LED0_OFF;
-
-        for (int i = 0; i < 5; i++) {
-            LED1_TOGGLE;
-            LED0_TOGGLE;
-            delay(100);
-        }
+    warmRestartInit();
 
-        LED0_OFF;
-        LED1_OFF;
+#if defined(USE_GPS) || defined(USE_MAG)
+    /* Give GPS and mag 500ms to power up, extra 500ms if board is cold-booting.
+     * Only waited for right before they are initialised. Not waited for at
+     * all when restarting in flight, the motors must come back first */
+    if (!warmRestartIsPending()) {
+        sensorsSetPowerOnDelay(isMPUSoftReset() ? 500 : 1000);
     }
 #endif
 
@@ -520,7 +523,9 @@ void init(void)
 
     systemState |= SYSTEM_STATE_SENSORS_READY;
 
-    flashLedsAndBeep();
+    if (!warmRestartIsPending()) {
+        flashLedsAndBeep();
+    }
 
     pidInitFilters();
 
@@ -575,6 +580,7 @@ void init(void)
 
 #ifdef USE_GPS
     if (feature(FEATURE_GPS)) {
+        sensorsWaitForPowerOn();
         gpsInit();
     }
 #endif
@@ -616,6 +622,9 @@ void init(void)
             }
             if (flashDeviceInitialized) {
                 // do not initialize flashfs if no flash was found
+#if defined(USE_BLACKBOX) && defined(USE_FLASHFS_INDEX)
+                flashfsSetEraseAhead(blackboxConfig()->device == BLACKBOX_DEVICE_FLASH ? blackboxConfig()->flashEraseAhead * 1024 : 0);
+#endif
                 flashfsInit();
             }
             break;
@@ -635,7 +644,27 @@ void init(void)
     blackboxInit();
 #endif
 
-    gyroStartCalibration();
+#if defined(USE_MISSION_STORE) || defined(USE_TERRAIN)
+    if (!flashDeviceInitialized) {
+        flashDeviceInitialized = flashInit();
+    }
+#endif
+#ifdef USE_MISSION_STORE
+    if (flashDeviceInitialized && missionStoreInit() && navConfig()->general.waypoint_load_on_boot && !isWaypointListValid()) {
+        loadMissionStoreWaypointList();
+    }
+#endif
+#ifdef USE_TERRAIN
+    if (flashDeviceInitialized) {
+        terrainInit();
+    }
+#endif
+
+    if (warmRestartIsPending()) {
+        warmRestartRestoreSensors();
+    } else {
+        gyroStartCalibration();
+    }
 
 #ifdef USE_BARO
     baroStartCalibration();
@@ -693,8 +722,10 @@ void init(void)
 
 #ifdef USE_RPM_FILTER
     disableRpmFilters();
-    if (STATE(ESC_SENSOR_ENABLED) && (rpmFilterConfig()->gyro_filter_enabled || rpmFilterConfig()->dterm_filter_enabled)) {
+    // Dynamic gyro LPF follows the motor frequency the RPM filter task measures
+    if (rpmFilterSourceAvailable() && (rpmFilterConfig()->gyro_filter_enabled || rpmFilterConfig()->dterm_filter_enabled || gyroConfig()->useDynamicLpf)) {
         rpmFiltersInit();
+        rescheduleTask(TASK_RPM_FILTER, rpmFilterGetUpdateIntervalUs());
         setTaskEnabled(TASK_RPM_FILTER, true);
     }
 #endif
@@ -711,4 +742,6 @@ void init(void)
     persistentObjectWrite(PERSISTENT_OBJECT_RESET_REASON, RESET_NONE);
 
     systemState |= SYSTEM_STATE_READY;
+
+    warmRestartResume();
 }
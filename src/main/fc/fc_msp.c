@@ -25,13 +25,17 @@
 #include "platform.h"
 
 #include "blackbox/blackbox.h"
+#include "blackbox/blackbox_io.h"
 
 #include "build/debug.h"
+#include "build/profiling.h"
+#include "build/trace_ring.h"
 #include "build/version.h"
 
 #include "common/axis.h"
 #include "common/color.h"
 #include "common/maths.h"
+#include "common/memory.h"
 #include "common/streambuf.h"
 #include "common/bitarray.h"
 #include "common/time.h"
@@ -54,6 +58,7 @@
 #include "drivers/pwm_mapping.h"
 #include "drivers/sdcard/sdcard.h"
 #include "drivers/serial.h"
+#include "drivers/stack_check.h"
 #include "drivers/system.h"
 #include "drivers/time.h"
 #include "drivers/timer.h"
@@ -70,11 +75,13 @@
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 #include "fc/settings.h"
+#include "fc/simulator.h"
 
 #include "flight/failsafe.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/rth_estimator.h"
 #include "flight/servos.h"
 #include "flight/secondary_imu.h"
 
@@ -122,6 +129,7 @@
 #include "sensors/esc_sensor.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/smartport.h"
 
 #ifdef USE_HARDWARE_REVISION_DETECTION
 #include "hardware_revision.h"
@@ -316,6 +324,21 @@ static void serializeDataflashSummaryReply(sbuf_t *dst)
 }
 
 #ifdef USE_FLASHFS
+static void serializeFlashHealthReply(sbuf_t *dst)
+{
+    flashHealth_t health = { 0 };
+    const bool supported = flashGetHealth(&health);
+
+    sbufWriteU8(dst, supported ? 1 : 0);
+    sbufWriteU16(dst, health.badBlocks);
+    sbufWriteU16(dst, health.remappedBlocks);
+    sbufWriteU16(dst, health.spareBlocks);
+    sbufWriteU32(dst, health.eccCorrected);
+    sbufWriteU32(dst, health.eccUncorrectable);
+    sbufWriteU16(dst, health.programFailures);
+    sbufWriteU16(dst, health.eraseFailures);
+}
+
 static void serializeDataflashReadReply(sbuf_t *dst, uint32_t address, uint16_t size)
 {
     // Check how much bytes we can read
@@ -1082,6 +1105,55 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         serializeDataflashSummaryReply(dst);
         break;
 
+#ifdef USE_FLASHFS
+    case MSP2_INAV_FLASH_HEALTH:
+        serializeFlashHealthReply(dst);
+        break;
+#endif
+
+#if defined(USE_ADC) && defined(USE_GPS)
+    case MSP2_INAV_RTH_ESTIMATE:
+        // Without and with wind compensation, negative values are error codes
+        sbufWriteU32(dst, (int32_t)getRemainingFlightTimeBeforeRTH(false));
+        sbufWriteU32(dst, (int32_t)getRemainingDistanceBeforeRTH(false));
+        sbufWriteU32(dst, (int32_t)getRemainingFlightTimeBeforeRTH(true));
+        sbufWriteU32(dst, (int32_t)getRemainingDistanceBeforeRTH(true));
+        sbufWriteU32(dst, getRTHEstimateAgeMs());
+        break;
+#endif
+
+#ifdef USE_TRACE_RING
+    case MSP2_INAV_TRACE:
+        {
+            // Newest entries first, the task starts are from before the last reset
+            sbufWriteU16(dst, traceRingBootCount());
+            const traceEvent_t *event;
+            unsigned count = 0;
+            while (traceRingGetEvent(count)) {
+                count++;
+            }
+            sbufWriteU8(dst, count);
+            for (unsigned ii = 0; (event = traceRingGetEvent(ii)) != NULL; ii++) {
+                sbufWriteU32(dst, event->timeUs);
+                sbufWriteU32(dst, event->data);
+                sbufWriteU16(dst, event->boot);
+                sbufWriteU8(dst, event->type);
+                sbufWriteU8(dst, event->id);
+            }
+            const traceTaskStart_t *start;
+            count = 0;
+            while (traceRingGetTaskStart(count)) {
+                count++;
+            }
+            sbufWriteU8(dst, count);
+            for (unsigned ii = 0; (start = traceRingGetTaskStart(ii)) != NULL; ii++) {
+                sbufWriteU32(dst, start->timeUs);
+                sbufWriteU8(dst, start->taskId);
+            }
+        }
+        break;
+#endif
+
     case MSP_BLACKBOX_CONFIG:
         sbufWriteU8(dst, 0); // API no longer supported
         sbufWriteU8(dst, 0);
@@ -1516,6 +1588,107 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         break;
 #endif
 
+#ifdef USE_SDCARD
+    case MSP2_INAV_SDCARD_STATS:
+        {
+            const sdcardWriteStats_t *writeStats = sdcard_getWriteStats();
+
+            sbufWriteU32(dst, writeStats->writeCount);
+            sbufWriteU32(dst, writeStats->stallCount);
+            sbufWriteU32(dst, writeStats->lastLatencyUs);
+            sbufWriteU32(dst, writeStats->maxLatencyUs);
+            sbufWriteU32(dst, writeStats->latencyEstimateUs);
+#ifdef USE_BLACKBOX
+            const blackboxSDCardBufferStats_t *bufferStats = blackboxGetSDCardBufferStats();
+
+            sbufWriteU32(dst, bufferStats->bufferSize);
+            sbufWriteU32(dst, bufferStats->peakUsedBytes);
+            sbufWriteU32(dst, bufferStats->droppedBytes);
+            sbufWriteU32(dst, bufferStats->bytesPerSecond);
+            sbufWriteU32(dst, bufferStats->requiredBytes);
+#else
+            for (int i = 0; i < 5; i++) {
+                sbufWriteU32(dst, 0);
+            }
+#endif
+        }
+        break;
+#endif
+
+#ifdef USE_MISSION_STORE
+    case MSP2_INAV_MISSION_STORE_INFO:
+        {
+            missionStoreInfo_t storeInfo;
+            missionStoreGetInfo(&storeInfo);
+
+            sbufWriteU16(dst, storeInfo.capacity);
+            sbufWriteU16(dst, storeInfo.count);
+            sbufWriteU8(dst, isMissionStoreWaypointListActive() ? 1 : 0);
+        }
+        break;
+#endif
+
+#ifdef STACK_CHECK
+    case MSP2_INAV_STACK_INFO:
+        // Overall stack use, then the sampled high-water of every enabled task
+        sbufWriteU32(dst, stackTotalSize());
+        sbufWriteU32(dst, stackUsedSize());
+        for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+            cfTaskInfo_t taskInfo;
+            getTaskInfo(taskId, &taskInfo);
+            if (taskInfo.isEnabled) {
+                sbufWriteU8(dst, taskId);
+                sbufWriteU16(dst, taskInfo.stackHighWater);
+            }
+        }
+        break;
+#endif
+
+    case MSP2_INAV_RAM_MAP:
+        {
+            ramMap_t ramMap;
+            stackGetRamMap(&ramMap);
+
+            sbufWriteU32(dst, ramMap.dataSize);
+            sbufWriteU32(dst, ramMap.bssSize);
+            sbufWriteU32(dst, ramMap.fastramSize);
+            sbufWriteU32(dst, ramMap.dmaramSize);
+            sbufWriteU32(dst, ramMap.stackSize);
+            sbufWriteU32(dst, memGetAvailableBytes());
+        }
+        break;
+
+#if defined(USE_TELEMETRY) && defined(USE_TELEMETRY_SMARTPORT)
+    case MSP2_INAV_SMARTPORT_SENSOR_AGE:
+        // One entry per value sent so far: data id and ms since the receiver got its last update
+        for (int i = 0; i < smartPortGetSensorCount(); i++) {
+            uint16_t id;
+            timeMs_t ageMs;
+            if (smartPortGetSensorAge(i, &id, &ageMs)) {
+                sbufWriteU16(dst, id);
+                sbufWriteU16(dst, MIN(ageMs, (timeMs_t)UINT16_MAX));
+            }
+        }
+        break;
+#endif
+
+#ifdef USE_TERRAIN
+    case MSP2_INAV_TERRAIN_INFO:
+        {
+            terrainStoreInfo_t storeInfo;
+            terrainStoreGetInfo(&storeInfo);
+
+            int32_t terrainHeight;
+            const bool terrainValid = STATE(GPS_FIX) && terrainGetHeight(gpsSol.llh.lat, gpsSol.llh.lon, &terrainHeight);
+
+            sbufWriteU16(dst, storeInfo.capacity);
+            sbufWriteU16(dst, storeInfo.count);
+            sbufWriteU8(dst, terrainValid ? 1 : 0);
+            sbufWriteU32(dst, terrainValid ? terrainHeight : 0);    // Terrain under the craft above mean sea level (cm)
+        }
+        break;
+#endif
+
 #ifdef USE_ESC_SENSOR
     case MSP2_INAV_ESC_RPM:
         {
@@ -1525,6 +1698,13 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
                 const escSensorData_t *escState = getEscTelemetry(i); //Get ESC telemetry
                 sbufWriteU32(dst, escState->rpm);
             }
+
+            // Appended per-motor link statistics, older readers stop after the RPM block
+            for (uint8_t i = 0; i < motorCount; i++) {
+                const escSensorStats_t *escStats = escSensorGetStats(i);
+                sbufWriteU16(dst, escStats->rateHz);
+                sbufWriteU16(dst, escStats->crcErrors);
+            }
         }
         break;
 #endif
@@ -1566,6 +1746,62 @@ static mspResult_e mspFcLogicConditionCommand(sbuf_t *dst, sbuf_t *src) {
     }
 }
 
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+static mspResult_e mspFcTaskHistogramCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) < 1) {
+        return MSP_RESULT_ERROR;
+    }
+
+    const uint8_t taskId = sbufReadU8(src);
+    const cfTaskHistogram_t *histogram = getTaskHistogram(taskId);
+    if (!histogram) {
+        return MSP_RESULT_ERROR;
+    }
+
+    sbufWriteU8(dst, taskId);
+    sbufWriteU8(dst, SCHEDULER_HISTOGRAM_BUCKETS);
+    for (int ii = 0; ii < SCHEDULER_HISTOGRAM_BUCKETS; ii++) {
+        sbufWriteU16(dst, histogram->executionTime[ii]);
+    }
+    for (int ii = 0; ii < SCHEDULER_HISTOGRAM_BUCKETS; ii++) {
+        sbufWriteU16(dst, histogram->lateness[ii]);
+    }
+    return MSP_RESULT_ACK;
+}
+#endif
+
+#ifdef USE_PROFILING_ZONES
+static mspResult_e mspFcProfilingZoneCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) < 1) {
+        return MSP_RESULT_ERROR;
+    }
+
+    const uint8_t zone = sbufReadU8(src);
+    const char *name = profilingZoneName(zone);
+    if (!name) {
+        return MSP_RESULT_ERROR;
+    }
+
+    sbufWriteU8(dst, zone);
+    sbufWriteU8(dst, PROFILING_ZONE_COUNT);
+    sbufWriteU16(dst, profilingCyclesPerUs());
+    sbufWriteDataSafe(dst, name, strlen(name) + 1);
+
+    // Newest window first
+    sbufWriteU8(dst, PROFILING_HISTORY_LENGTH);
+    for (int ii = 0; ii < PROFILING_HISTORY_LENGTH; ii++) {
+        const profilingWindow_t *window = profilingZoneGetWindow(zone, ii);
+        sbufWriteU32(dst, window->minCycles);
+        sbufWriteU32(dst, window->avgCycles);
+        sbufWriteU32(dst, window->maxCycles);
+        sbufWriteU16(dst, window->count);
+    }
+    return MSP_RESULT_ACK;
+}
+#endif
+
 static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
 {
     const uint8_t msp_wp_no = sbufReadU8(src);    // get the wp number
@@ -1582,6 +1818,60 @@ static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
     sbufWriteU8(dst, msp_wp.flag);    // flags
 }
 
+#ifdef USE_MISSION_STORE
+static mspResult_e mspFcMissionStoreWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
+{
+    uint16_t msp_wp_no;
+    navWaypoint_t msp_wp;
+
+    if (!sbufReadU16Safe(&msp_wp_no, src) || !missionStoreReadWaypoints(msp_wp_no, &msp_wp, 1)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    sbufWriteU16(dst, msp_wp_no);     // wp_no, 0 based
+    sbufWriteU8(dst, msp_wp.action);  // action
+    sbufWriteU32(dst, msp_wp.lat);    // lat
+    sbufWriteU32(dst, msp_wp.lon);    // lon
+    sbufWriteU32(dst, msp_wp.alt);    // altitude (cm)
+    sbufWriteU16(dst, msp_wp.p1);     // P1
+    sbufWriteU16(dst, msp_wp.p2);     // P2
+    sbufWriteU16(dst, msp_wp.p3);     // P3
+    sbufWriteU8(dst, msp_wp.flag);    // flags
+    return MSP_RESULT_ACK;
+}
+#endif
+
+#ifdef USE_FLASHFS_INDEX
+/*
+ * Lists the logs of the volume index from the requested one onwards, as many as fit. Each one can then be
+ * fetched on its own with MSP_DATAFLASH_READ or MSP2_INAV_DATAFLASH_STREAM.
+ */
+static mspResult_e mspFcFlashfsLogListCommand(sbuf_t *dst, sbuf_t *src)
+{
+    uint16_t firstLog = 0;
+
+    if (sbufBytesRemaining(src) && !sbufReadU16Safe(&firstLog, src)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    const uint16_t logCount = flashfsGetLogCount();
+
+    sbufWriteU16(dst, logCount);
+    sbufWriteU16(dst, firstLog);
+
+    for (uint16_t i = firstLog; i < logCount && sbufBytesRemaining(dst) >= 12; i++) {
+        flashfsLogInfo_t info;
+        flashfsGetLogInfo(i, &info);    // Bad entries are listed as empty logs
+
+        sbufWriteU32(dst, info.start);
+        sbufWriteU32(dst, info.size);
+        sbufWriteU32(dst, info.timestamp);
+    }
+
+    return MSP_RESULT_ACK;
+}
+#endif
+
 #ifdef USE_FLASHFS
 static void mspFcDataFlashReadCommand(sbuf_t *dst, sbuf_t *src)
 {
@@ -1705,6 +1995,8 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
                 adjRange->range.endStep = sbufReadU8(src);
                 adjRange->adjustmentFunction = sbufReadU8(src);
                 adjRange->auxSwitchChannelIndex = sbufReadU8(src);
+
+                updateAdjustmentRangeTable();
             } else {
                 return MSP_RESULT_ERROR;
             }
@@ -1736,6 +2028,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
                 ((controlRateConfig_t*)currentControlRateProfile)->stabilized.rcYawExpo8 = sbufReadU8(src);
             }
 
+            activateControlRateConfig();
             schedulePidGainsUpdate();
         } else {
             return MSP_RESULT_ERROR;
@@ -1776,6 +2069,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
                 }
             }
 
+            activateControlRateConfig();
         } else {
             return MSP_RESULT_ERROR;
         }
@@ -2006,6 +2300,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             logicConditionsMutable(tmp_u8)->operandB.type = sbufReadU8(src);
             logicConditionsMutable(tmp_u8)->operandB.value = sbufReadU32(src);
             logicConditionsMutable(tmp_u8)->flags = sbufReadU8(src);
+            logicConditionInvalidateProgram();
         } else
             return MSP_RESULT_ERROR;
         break;
@@ -2033,6 +2328,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             primaryMotorMixerMutable(tmp_u8)->roll = constrainf(sbufReadU16(src) / 1000.0f, 0.0f, 4.0f) - 2.0f;
             primaryMotorMixerMutable(tmp_u8)->pitch = constrainf(sbufReadU16(src) / 1000.0f, 0.0f, 4.0f) - 2.0f;
             primaryMotorMixerMutable(tmp_u8)->yaw = constrainf(sbufReadU16(src) / 1000.0f, 0.0f, 4.0f) - 2.0f;
+            mixerSwitchMotorMixer();
         } else
             return MSP_RESULT_ERROR;
         break;
@@ -2489,6 +2785,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             gpsSol.epv = 100;
             // Feed data to navigation
             sensorsSet(SENSOR_GPS);
+            sensorSampleCapture(&gpsSol.sample, micros(), STATE(GPS_FIX));
             onNewGPSData();
         } else
             return MSP_RESULT_ERROR;
@@ -2521,6 +2818,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             radar_pois[msp_radar_no].heading = sbufReadU16(src);                   // °
             radar_pois[msp_radar_no].speed = sbufReadU16(src);                     // cm/s
             radar_pois[msp_radar_no].lq = sbufReadU8(src);                         // Link quality, from 0 to 4
+            radar_pois[msp_radar_no].updated = true;
         } else
             return MSP_RESULT_ERROR;
         break;
@@ -2925,6 +3223,79 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
         return MSP_RESULT_ERROR; // will only be reached if the rollback is not ready
         break;
 #endif
+#ifdef USE_MISSION_STORE
+    case MSP2_INAV_SET_MISSION_STORE_WP:
+        if (dataSize == 22) {
+            const uint16_t msp_wp_no = sbufReadU16(src);    // 0 based, 0 starts a new upload
+            navWaypoint_t msp_wp;
+            msp_wp.action = sbufReadU8(src);    // action
+            msp_wp.lat = sbufReadU32(src);      // lat
+            msp_wp.lon = sbufReadU32(src);      // lon
+            msp_wp.alt = sbufReadU32(src);      // to set altitude (cm)
+            msp_wp.p1 = sbufReadU16(src);       // P1
+            msp_wp.p2 = sbufReadU16(src);       // P2
+            msp_wp.p3 = sbufReadU16(src);       // P3
+            msp_wp.flag = sbufReadU8(src);      // NAV_WP_FLAG_LAST ends the upload
+
+            if (msp_wp_no == 0) {
+                resetWaypointList();
+                if (!missionStoreBeginUpload()) {
+                    return MSP_RESULT_ERROR;
+                }
+            }
+
+            if (!missionStoreWriteWaypoint(msp_wp_no, &msp_wp)) {
+                return MSP_RESULT_ERROR;
+            }
+
+            if (msp_wp.flag == NAV_WP_FLAG_LAST && (!missionStoreFinishUpload(msp_wp_no + 1) || !loadMissionStoreWaypointList())) {
+                return MSP_RESULT_ERROR;
+            }
+        } else {
+            return MSP_RESULT_ERROR;
+        }
+        break;
+#endif
+#ifdef USE_TERRAIN
+    case MSP2_INAV_SET_TERRAIN_TILE_DATA:
+        // Samples of a tile in order, the first samples of tile 0 start a new upload
+        if (dataSize > 4 && dataSize <= 4 + 128) {
+            const uint16_t tileIndex = sbufReadU16(src);
+            const uint16_t offset = sbufReadU16(src);
+
+            if (tileIndex == 0 && offset == 0 && !terrainStoreBeginUpload()) {
+                return MSP_RESULT_ERROR;
+            }
+
+            if (!terrainStoreWriteTileData(tileIndex, offset, sbufPtr(src), sbufBytesRemaining(src))) {
+                return MSP_RESULT_ERROR;
+            }
+        } else {
+            return MSP_RESULT_ERROR;
+        }
+        break;
+
+    case MSP2_INAV_SET_TERRAIN_TILE:
+        // Header of a tile, once all its samples were sent
+        if (dataSize == 18) {
+            const uint16_t tileIndex = sbufReadU16(src);
+            terrainTileHeader_t header;
+            header.lat = sbufReadU32(src);
+            header.lon = sbufReadU32(src);
+            header.spacing = sbufReadU16(src);
+            header.baseHeight = sbufReadU16(src);
+            header.step = sbufReadU16(src);
+            header.reserved = sbufReadU16(src);
+
+            if (!terrainStoreFinishTile(tileIndex, &header)) {
+                return MSP_RESULT_ERROR;
+            }
+        } else {
+            return MSP_RESULT_ERROR;
+        }
+        break;
+#endif
+
     case MSP2_INAV_SET_SAFEHOME:
         if (dataSize == 10) {
              uint8_t i;
@@ -2988,15 +3359,11 @@ static bool mspSettingCommand(sbuf_t *dst, sbuf_t *src)
     return true;
 }
 
-static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
+// Reads a value for the setting from src and checks its range. When apply is
+// true it's also stored. Strings take the rest of src, unless they are zero
+// terminated.
+static bool mspReadSettingValue(const setting_t *setting, sbuf_t *src, bool apply, bool zeroTerminatedString)
 {
-    UNUSED(dst);
-
-    const setting_t *setting = mspReadSetting(src);
-    if (!setting) {
-        return false;
-    }
-
     setting_min_t min = settingGetMin(setting);
     setting_max_t max = settingGetMax(setting);
 
@@ -3011,7 +3378,9 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val > max) {
                     return false;
                 }
-                *((uint8_t*)ptr) = val;
+                if (apply) {
+                    *((uint8_t*)ptr) = val;
+                }
             }
             break;
         case VAR_INT8:
@@ -3023,7 +3392,9 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val < min || val > (int8_t)max) {
                     return false;
                 }
-                *((int8_t*)ptr) = val;
+                if (apply) {
+                    *((int8_t*)ptr) = val;
+                }
             }
             break;
         case VAR_UINT16:
@@ -3035,7 +3406,9 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val > max) {
                     return false;
                 }
-                *((uint16_t*)ptr) = val;
+                if (apply) {
+                    *((uint16_t*)ptr) = val;
+                }
             }
             break;
         case VAR_INT16:
@@ -3047,7 +3420,9 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val < min || val > (int16_t)max) {
                     return false;
                 }
-                *((int16_t*)ptr) = val;
+                if (apply) {
+                    *((int16_t*)ptr) = val;
+                }
             }
             break;
         case VAR_UINT32:
@@ -3059,7 +3434,9 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val > max) {
                     return false;
                 }
-                *((uint32_t*)ptr) = val;
+                if (apply) {
+                    *((uint32_t*)ptr) = val;
+                }
             }
             break;
         case VAR_FLOAT:
@@ -3071,12 +3448,27 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
                 if (val < (float)min || val > (float)max) {
                     return false;
                 }
-                *((float*)ptr) = val;
+                if (apply) {
+                    *((float*)ptr) = val;
+                }
             }
             break;
         case VAR_STRING:
             {
-                settingSetString(setting, (const char*)sbufPtr(src), sbufBytesRemaining(src));
+                const char *str = (const char*)sbufPtr(src);
+                size_t len = sbufBytesRemaining(src);
+                if (zeroTerminatedString) {
+                    len = strnlen(str, len);
+                    if (len == (size_t)sbufBytesRemaining(src)) {
+                        return false;
+                    }
+                    sbufAdvance(src, len + 1);
+                } else {
+                    sbufAdvance(src, len);
+                }
+                if (apply) {
+                    settingSetString(setting, str, len);
+                }
             }
             break;
     }
@@ -3084,6 +3476,142 @@ static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
     return true;
 }
 
+static bool mspSetSettingCommand(sbuf_t *dst, sbuf_t *src)
+{
+    UNUSED(dst);
+
+    const setting_t *setting = mspReadSetting(src);
+    if (!setting) {
+        return false;
+    }
+
+    return mspReadSettingValue(setting, src, true, false);
+}
+
+typedef enum {
+    MSP_SETTINGS_BY_INDEX = 0,  // u16 setting indexes follow
+    MSP_SETTINGS_BY_PG = 1,     // u16 PG id follows, selects all the settings in the PG
+} mspSettingsSelector_e;
+
+typedef struct {
+    uint8_t selector;
+    uint16_t next;
+    uint16_t end;
+} mspSettingsIterator_t;
+
+static bool mspSettingsIteratorInit(mspSettingsIterator_t *it, sbuf_t *src)
+{
+    if (!sbufReadU8Safe(&it->selector, src)) {
+        return false;
+    }
+
+    switch (it->selector) {
+    case MSP_SETTINGS_BY_INDEX:
+        return true;
+    case MSP_SETTINGS_BY_PG:
+        {
+            uint16_t pgn;
+            uint16_t start;
+            uint16_t end;
+            if (!sbufReadU16Safe(&pgn, src) || !settingsGetParameterGroupIndexes(pgn, &start, &end)) {
+                return false;
+            }
+            it->next = start;
+            it->end = end + 1;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Returns the next selected setting, indexes are read from src. Sets
+// *error if the next index is out of range.
+static const setting_t *mspSettingsIteratorNext(mspSettingsIterator_t *it, sbuf_t *src, bool *error)
+{
+    if (it->selector == MSP_SETTINGS_BY_PG) {
+        return it->next < it->end ? settingGet(it->next++) : NULL;
+    }
+
+    uint16_t index;
+    if (!sbufReadU16Safe(&index, src)) {
+        return NULL;
+    }
+    const setting_t *setting = settingGet(index);
+    if (!setting) {
+        *error = true;
+    }
+    return setting;
+}
+
+// Returns the count of values that fit into the reply (u16), followed by the
+// values in the same format as MSP2_COMMON_SETTING. If not all of them fit,
+// the caller requests the rest by index.
+static bool mspSettingsCommand(sbuf_t *dst, sbuf_t *src)
+{
+    mspSettingsIterator_t it;
+    if (!mspSettingsIteratorInit(&it, src)) {
+        return false;
+    }
+
+    uint8_t *countPtr = sbufPtr(dst);
+    sbufWriteU16(dst, 0);
+
+    uint16_t count = 0;
+    bool error = false;
+    const setting_t *setting;
+    while ((setting = mspSettingsIteratorNext(&it, src, &error))) {
+        const size_t size = settingGetValueSize(setting);
+        if (sbufBytesRemaining(dst) < (int)size) {
+            break;
+        }
+        sbufWriteData(dst, settingGetValuePointer(setting), size);
+        count++;
+    }
+
+    if (error) {
+        return false;
+    }
+
+    countPtr[0] = count & 0xFF;
+    countPtr[1] = count >> 8;
+    return true;
+}
+
+// Each index is followed by the value (or just the values in the PG
+// order), with strings zero terminated. All the values are checked before
+// any of them is stored.
+static bool mspSetSettingsCommand(sbuf_t *dst, sbuf_t *src)
+{
+    UNUSED(dst);
+
+    mspSettingsIterator_t it;
+    if (!mspSettingsIteratorInit(&it, src)) {
+        return false;
+    }
+
+    const mspSettingsIterator_t start = it;
+    uint8_t *values = sbufPtr(src);
+
+    for (int pass = 0; pass < 2; pass++) {
+        const bool apply = pass == 1;
+        it = start;
+        src->ptr = values;
+
+        bool error = false;
+        const setting_t *setting;
+        while ((setting = mspSettingsIteratorNext(&it, src, &error))) {
+            if (!mspReadSettingValue(setting, src, apply, true)) {
+                return false;
+            }
+        }
+        if (error || sbufBytesRemaining(src) > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static bool mspSettingInfoCommand(sbuf_t *dst, sbuf_t *src)
 {
     const setting_t *setting = mspReadSetting(src);
@@ -3339,6 +3867,14 @@ bool mspFCProcessInOutCommand(uint16_t cmdMSP, sbuf_t *dst, sbuf_t *src, mspResu
         *ret = mspSetSettingCommand(dst, src) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
         break;
 
+    case MSP2_COMMON_SETTINGS:
+        *ret = mspSettingsCommand(dst, src) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+        break;
+
+    case MSP2_COMMON_SET_SETTINGS:
+        *ret = mspSetSettingsCommand(dst, src) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+        break;
+
     case MSP2_COMMON_SETTING_INFO:
         *ret = mspSettingInfoCommand(dst, src) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
         break;
@@ -3387,6 +3923,44 @@ bool mspFCProcessInOutCommand(uint16_t cmdMSP, sbuf_t *dst, sbuf_t *src, mspResu
          *ret = mspFcSafeHomeOutCommand(dst, src);
          break;
 
+#ifdef USE_MISSION_STORE
+    case MSP2_INAV_MISSION_STORE_WP:
+        *ret = mspFcMissionStoreWaypointOutCommand(dst, src);
+        break;
+#endif
+
+#ifdef USE_FLASHFS_INDEX
+    case MSP2_INAV_FLASHFS_LOG_LIST:
+        *ret = mspFcFlashfsLogListCommand(dst, src);
+        break;
+#endif
+
+#ifdef MSP_FIRMWARE_UPDATE
+    case MSP2_INAV_FWUPDT_STORE_AT:
+        // Windowed upload: the sender flags all but every Nth chunk MSP_FLAG_DONT_REPLY and resumes from the acknowledged size
+        if (sbufBytesRemaining(src) < 4) {
+            *ret = MSP_RESULT_ERROR;
+        } else {
+            const uint32_t offset = sbufReadU32(src);
+            *ret = firmwareUpdateStoreAt(offset, sbufPtr(src), sbufBytesRemaining(src)) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+            sbufWriteU32(dst, firmwareUpdateGetReceivedSize());
+            sbufWriteU8(dst, firmwareUpdateGetCRC());
+        }
+        break;
+#endif
+
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+    case MSP2_INAV_TASK_HISTOGRAM:
+        *ret = mspFcTaskHistogramCommand(dst, src);
+        break;
+#endif
+
+#ifdef USE_PROFILING_ZONES
+    case MSP2_INAV_PROFILING_ZONE:
+        *ret = mspFcProfilingZoneCommand(dst, src);
+        break;
+#endif
+
 #ifdef USE_SIMULATOR
     case MSP_SIMULATOR:
 		tmp_u8 = sbufReadU8(src); //MSP_SIMULATOR version
@@ -3395,82 +3969,11 @@ bool mspFCProcessInOutCommand(uint16_t cmdMSP, sbuf_t *dst, sbuf_t *src, mspResu
 		simulatorData.flags = sbufReadU8(src);
 
         if ((simulatorData.flags & SIMU_ENABLE) == 0) {
-
-			if (ARMING_FLAG(SIMULATOR_MODE)) { // just once
-				DISABLE_ARMING_FLAG(SIMULATOR_MODE);
-
-#ifdef USE_BARO
-				baroStartCalibration();
-#endif
-#ifdef USE_MAG
-				DISABLE_STATE(COMPASS_CALIBRATED);
-				compassInit();
-#endif
-				simulatorData.flags = 0;
-				//review: many states were affected. reboot?
-
-				disarm(DISARM_SWITCH);  //disarm to prevent motor output!!!
-			}
+			simulatorDisable();
 		}
-		else if (!areSensorsCalibrating()) {
-			if (!ARMING_FLAG(SIMULATOR_MODE)) { // just once
-#ifdef USE_BARO
-				baroStartCalibration(); 
-#endif			
-#ifdef USE_MAG
-				if (compassConfig()->mag_hardware != MAG_NONE){
-					sensorsSet(SENSOR_MAG);
-					ENABLE_STATE(COMPASS_CALIBRATED);
-					DISABLE_ARMING_FLAG(ARMING_DISABLED_HARDWARE_FAILURE);
-					mag.magADC[X] = 800;
-					mag.magADC[Y] = 0;
-					mag.magADC[Z] = 0;
-				}
-#endif
-				ENABLE_ARMING_FLAG(SIMULATOR_MODE);
-				LOG_D(SYSTEM, "Simulator enabled");
-			}
-
+		else if (simulatorEnable()) {
 			if (dataSize >= 14) {
-
-				if (feature(FEATURE_GPS) && ((simulatorData.flags & SIMU_HAS_NEW_GPS_DATA)!=0) ) {
-					gpsSol.fixType = sbufReadU8(src);
-					gpsSol.hdop = gpsSol.fixType == GPS_NO_FIX ? 9999 : 100;
-					gpsSol.flags.hasNewData = true;
-					gpsSol.numSat = sbufReadU8(src);
-
-					if (gpsSol.fixType != GPS_NO_FIX) {
-						gpsSol.flags.validVelNE = 1;
-						gpsSol.flags.validVelD = 1;
-						gpsSol.flags.validEPE = 1;
-
-						gpsSol.llh.lat = sbufReadU32(src);
-						gpsSol.llh.lon = sbufReadU32(src);
-						gpsSol.llh.alt = sbufReadU32(src);
-						gpsSol.groundSpeed = (int16_t)sbufReadU16(src);
-						gpsSol.groundCourse = (int16_t)sbufReadU16(src);
-
-						gpsSol.velNED[X] = (int16_t)sbufReadU16(src);
-						gpsSol.velNED[Y] = (int16_t)sbufReadU16(src);
-						gpsSol.velNED[Z] = (int16_t)sbufReadU16(src);
-
-						gpsSol.eph = 100;
-						gpsSol.epv = 100;
-
-						ENABLE_STATE(GPS_FIX);
-
-						// Feed data to navigation
-						gpsProcessNewSolutionData();
-					}
-					else {
-						sbufAdvance(src, 4 + 4 + 4 + 2 + 2 + 2 * 3);
-						// Feed data to navigation
-						gpsProcessNewSolutionData();
-					}
-				}
-				else {
-					sbufAdvance(src, 1 + 1 + 4 + 4 + 4 + 2 + 2 + 2 * 3);
-				}
+				simulatorReadGps(src, (simulatorData.flags & SIMU_HAS_NEW_GPS_DATA) != 0);
 
 				if ((simulatorData.flags & SIMU_USE_SENSORS) == 0) {
 					attitude.values.roll = (int16_t)sbufReadU16(src);
@@ -21,6 +21,9 @@
 
 #include "platform.h"
 
+#include "blackbox/blackbox.h"
+#include "blackbox/blackbox_io.h"
+
 #include "cms/cms.h"
 
 #include "common/axis.h"
@@ -42,13 +45,15 @@
 #include "fc/fc_tasks.h"
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
+#include "fc/simulator.h"
+#include "fc/warm_restart.h"
 
-#include "flight/dynamic_lpf.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
-#include "flight/power_limits.h"
 #include "flight/rpm_filter.h"
+#include "flight/rth_estimator.h"
+#include "flight/telemetry_snapshot.h"
 #include "flight/secondary_imu.h"
 #include "flight/servos.h"
 #include "flight/wind_estimator.h"
@@ -91,6 +96,16 @@
 
 #include "config/feature.h"
 
+#define TASK_SERIAL_PERIOD_US   TASK_PERIOD_HZ(100)     // 100 Hz should be enough to flush up to 115 bytes @ 115200 baud
+
+bool taskHandleSerialCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
+{
+    UNUSED(currentTimeUs);
+
+    // Run as soon as an MSP port received data, the period only paces CLI, OSD links and TX flushing
+    return mspSerialRxPending() || currentDeltaTime >= TASK_SERIAL_PERIOD_US;
+}
+
 void taskHandleSerial(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
@@ -120,9 +135,6 @@ void taskUpdateBattery(timeUs_t currentTimeUs)
 
     if (isAmperageConfigured()) {
         currentMeterUpdate(BatMonitoringTimeSinceLastServiced);
-#ifdef USE_POWER_LIMITS
-        currentLimiterUpdate(BatMonitoringTimeSinceLastServiced);
-#endif
     }
 
 #ifdef USE_ADC
@@ -133,9 +145,6 @@ void taskUpdateBattery(timeUs_t currentTimeUs)
     if (feature(FEATURE_VBAT) && isAmperageConfigured()) {
         powerMeterUpdate(BatMonitoringTimeSinceLastServiced);
         sagCompensatedVBatUpdate(currentTimeUs, BatMonitoringTimeSinceLastServiced);
-#if defined(USE_POWER_LIMITS) && defined(USE_ADC)
-        powerLimiterUpdate(BatMonitoringTimeSinceLastServiced);
-#endif
     }
 #endif
 
@@ -223,7 +232,7 @@ void taskUpdateRangefinder(timeUs_t currentTimeUs)
      * Process raw rangefinder readout
      */
     if (rangefinderProcess(calculateCosTiltAngle())) {
-        updatePositionEstimator_SurfaceTopic(currentTimeUs, rangefinderGetLatestAltitude());
+        updatePositionEstimator_SurfaceTopic(rangefinder.sample.timeUs, rangefinderGetLatestAltitude());
     }
 }
 #endif
@@ -302,10 +311,17 @@ void taskUpdateOsd(timeUs_t currentTimeUs)
 }
 #endif
 
+#if defined(USE_BLACKBOX) && (defined(USE_SDCARD) || defined(USE_FLASHFS_INDEX))
+void taskBlackboxWriter(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+    blackboxDeviceWriterUpdate();
+}
+#endif
+
 void taskUpdateAux(timeUs_t currentTimeUs)
 {
     updatePIDCoefficients();
-    dynamicLpfGyroTask();
 #ifdef USE_SIMULATOR
     if (!ARMING_FLAG(SIMULATOR_MODE)) {
         updateFixedWingLevelTrim(currentTimeUs);
@@ -313,18 +329,29 @@ void taskUpdateAux(timeUs_t currentTimeUs)
 #else
     updateFixedWingLevelTrim(currentTimeUs);
 #endif
+    warmRestartUpdate();
 }
 
 void fcTasksInit(void)
 {
     schedulerInit();
 
+#ifdef USE_MPU_DATA_READY_SIGNAL
+    if (gyroSyncIsActive()) {
+        // Gyro is read on the sensor data-ready interrupt and the PID loop is phase-locked to gyro samples
+        cfTasks[TASK_GYRO].checkFunc = taskGyroSyncCheck;
+        cfTasks[TASK_PID].checkFunc = taskPidSyncCheck;
+    }
+#endif
+
     rescheduleTask(TASK_PID, getLooptime());
     setTaskEnabled(TASK_PID, true);
 
     rescheduleTask(TASK_GYRO, getGyroLooptime());
     setTaskEnabled(TASK_GYRO, true);
 
+    setTaskEnabled(TASK_AHRS, sensors(SENSOR_ACC));
+
     setTaskEnabled(TASK_AUX, true);
 
     setTaskEnabled(TASK_SERIAL, true);
@@ -336,12 +363,19 @@ void fcTasksInit(void)
 #endif
     setTaskEnabled(TASK_BATTERY, feature(FEATURE_VBAT) || isAmperageConfigured());
     setTaskEnabled(TASK_TEMPERATURE, true);
+    setTaskEnabled(TASK_TELEMETRY_SNAPSHOT, true);
     setTaskEnabled(TASK_RX, true);
 #ifdef USE_GPS
     setTaskEnabled(TASK_GPS, feature(FEATURE_GPS));
 #endif
+#if defined(USE_ADC) && defined(USE_GPS)
+    setTaskEnabled(TASK_RTH_ESTIMATOR, feature(FEATURE_GPS) && feature(FEATURE_VBAT) && feature(FEATURE_CURRENT_METER));
+#endif
 #ifdef USE_MAG
     setTaskEnabled(TASK_COMPASS, sensors(SENSOR_MAG));
+    if (compassHasBackgroundRead()) {
+        rescheduleTask(TASK_COMPASS, TASK_PERIOD_HZ(COMPASS_BACKGROUND_READ_RATE_HZ));
+    }
 #if defined(USE_MAG_MPU9250)
     // fixme temporary solution for AK6983 via slave I2C on MPU9250
     rescheduleTask(TASK_COMPASS, TASK_PERIOD_HZ(40));
@@ -352,8 +386,15 @@ void fcTasksInit(void)
 #endif
 #ifdef USE_PITOT
     setTaskEnabled(TASK_PITOT, sensors(SENSOR_PITOT));
+    if (sensors(SENSOR_PITOT) && pitotHasAsyncRead()) {
+        rescheduleTask(TASK_PITOT, TASK_PERIOD_HZ(PITOT_ASYNC_RATE_HZ));
+    }
 #endif
 #ifdef USE_RANGEFINDER
+    if (sensors(SENSOR_RANGEFINDER) && rangefinderIsEventDriven()) {
+        // Samples arrive over MSP, the task runs when one is waiting
+        cfTasks[TASK_RANGEFINDER].checkFunc = rangefinderUpdateCheck;
+    }
     setTaskEnabled(TASK_RANGEFINDER, sensors(SENSOR_RANGEFINDER));
 #endif
 #ifdef USE_DASHBOARD
@@ -379,6 +420,9 @@ void fcTasksInit(void)
 #endif
 #endif
 #ifdef USE_OPFLOW
+    if (sensors(SENSOR_OPFLOW) && opflowIsEventDriven()) {
+        cfTasks[TASK_OPFLOW].checkFunc = opflowUpdateCheck;
+    }
     setTaskEnabled(TASK_OPFLOW, sensors(SENSOR_OPFLOW));
 #endif
 #ifdef USE_VTX_CONTROL
@@ -390,6 +434,7 @@ void fcTasksInit(void)
     setTaskEnabled(TASK_RCDEVICE, rcdeviceIsEnabled());
 #endif
 #ifdef USE_PROGRAMMING_FRAMEWORK
+    rescheduleTask(TASK_PROGRAMMING_FRAMEWORK, TASK_PERIOD_HZ(systemConfig()->programming_task_hz));
     setTaskEnabled(TASK_PROGRAMMING_FRAMEWORK, true);
 #endif
 #ifdef USE_IRLOCK
@@ -398,6 +443,12 @@ void fcTasksInit(void)
 #if defined(USE_SMARTPORT_MASTER)
     setTaskEnabled(TASK_SMARTPORT_MASTER, true);
 #endif
+#if defined(USE_BLACKBOX) && (defined(USE_SDCARD) || defined(USE_FLASHFS_INDEX))
+    setTaskEnabled(TASK_BLACKBOX_WRITER, feature(FEATURE_BLACKBOX) && blackboxDeviceNeedsWriterTask());
+#endif
+#ifdef USE_AUTOTUNE_FIXED_WING
+    setTaskEnabled(TASK_AUTOTUNE, pidIndexGetType(PID_ROLL) == PID_TYPE_PIFF);
+#endif
 #ifdef USE_SECONDARY_IMU
     setTaskEnabled(TASK_SECONDARY_IMU, secondaryImuConfig()->hardwareType != SECONDARY_IMU_NONE && secondaryImuState.active);
 #endif
@@ -422,10 +473,17 @@ cfTask_t cfTasks[TASK_COUNT] = {
         .desiredPeriod = TASK_PERIOD_US(TASK_GYRO_LOOPTIME),
         .staticPriority = TASK_PRIORITY_REALTIME,
     },
+    [TASK_AHRS] = {
+        .taskName = "AHRS",
+        .taskFunc = imuUpdateCorrection,
+        .desiredPeriod = TASK_PERIOD_HZ(IMU_CORRECTION_RATE_HZ),    // acc/mag/COG corrections of the attitude estimate
+        .staticPriority = TASK_PRIORITY_HIGH,
+    },
     [TASK_SERIAL] = {
         .taskName = "SERIAL",
+        .checkFunc = taskHandleSerialCheck,
         .taskFunc = taskHandleSerial,
-        .desiredPeriod = TASK_PERIOD_HZ(100),     // 100 Hz should be enough to flush up to 115 bytes @ 115200 baud
+        .desiredPeriod = TASK_SERIAL_PERIOD_US,
         .staticPriority = TASK_PRIORITY_LOW,
     },
 
@@ -457,7 +515,14 @@ cfTask_t cfTasks[TASK_COUNT] = {
     [TASK_TEMPERATURE] = {
         .taskName = "TEMPERATURE",
         .taskFunc = taskUpdateTemperature,
-        .desiredPeriod = TASK_PERIOD_HZ(100),     // 100 Hz
+        .desiredPeriod = TASK_PERIOD_HZ(10),      // Rescheduled by the update thread, fast only while it talks to the bus
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+
+    [TASK_TELEMETRY_SNAPSHOT] = {
+        .taskName = "TLMSNAP",
+        .taskFunc = telemetrySnapshotUpdate,
+        .desiredPeriod = TASK_PERIOD_HZ(20),      // Fast enough for the OSD refresh and the telemetry links
         .staticPriority = TASK_PRIORITY_LOW,
     },
 
@@ -472,12 +537,22 @@ cfTask_t cfTasks[TASK_COUNT] = {
 #ifdef USE_GPS
     [TASK_GPS] = {
         .taskName = "GPS",
+        .checkFunc = gpsUpdateCheck,
         .taskFunc = taskProcessGPS,
-        .desiredPeriod = TASK_PERIOD_HZ(50),      // GPS usually don't go raster than 10Hz
+        .desiredPeriod = TASK_PERIOD_HZ(50),      // Fallback rate, the task runs when GPS data arrives
         .staticPriority = TASK_PRIORITY_MEDIUM,
     },
 #endif
 
+#if defined(USE_ADC) && defined(USE_GPS)
+    [TASK_RTH_ESTIMATOR] = {
+        .taskName = "RTHEST",
+        .taskFunc = rthEstimatorUpdate,
+        .desiredPeriod = TASK_PERIOD_HZ(2),       // Battery and wind move slowly, OSD and MSP read the cached result
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+#endif
+
 #ifdef USE_MAG
     [TASK_COMPASS] = {
         .taskName = "COMPASS",
@@ -527,7 +602,7 @@ cfTask_t cfTasks[TASK_COUNT] = {
     [TASK_DASHBOARD] = {
         .taskName = "DASHBOARD",
         .taskFunc = taskDashboardUpdate,
-        .desiredPeriod = TASK_PERIOD_HZ(10),
+        .desiredPeriod = TASK_PERIOD_HZ(50),     // Content is redrawn at 5Hz, the runs in between send changed pages
         .staticPriority = TASK_PRIORITY_LOW,
     },
 #endif
@@ -616,8 +691,9 @@ cfTask_t cfTasks[TASK_COUNT] = {
 #if defined(USE_VTX_CONTROL)
     [TASK_VTXCTRL] = {
         .taskName = "VTXCTRL",
+        .checkFunc = vtxUpdateCheck,
         .taskFunc = vtxUpdate,
-        .desiredPeriod = TASK_PERIOD_HZ(5),          // 5Hz @200msec
+        .desiredPeriod = TASK_PERIOD_HZ(5),          // 5Hz @200msec, earlier when a VTX response arrived
         .staticPriority = TASK_PRIORITY_IDLE,
     },
 #endif
@@ -637,6 +713,14 @@ cfTask_t cfTasks[TASK_COUNT] = {
         .staticPriority = TASK_PRIORITY_IDLE,
     },
 #endif
+#ifdef USE_SIMULATOR_STREAM
+    [TASK_SIMULATOR_STREAM] = {
+        .taskName = "SIMSTREAM",
+        .taskFunc = taskSimulatorStream,
+        .desiredPeriod = TASK_PERIOD_HZ(500),         // Rescheduled to the rate the simulator asks for
+        .staticPriority = TASK_PRIORITY_MEDIUM_HIGH,
+    },
+#endif
 #ifdef USE_RPM_FILTER
     [TASK_RPM_FILTER] = {
         .taskName = "RPM",
@@ -644,6 +728,22 @@ cfTask_t cfTasks[TASK_COUNT] = {
         .desiredPeriod = TASK_PERIOD_HZ(RPM_FILTER_UPDATE_RATE_HZ),          // 300Hz @3,33ms
         .staticPriority = TASK_PRIORITY_LOW,
     },
+#endif
+#if defined(USE_BLACKBOX) && (defined(USE_SDCARD) || defined(USE_FLASHFS_INDEX))
+    [TASK_BLACKBOX_WRITER] = {
+        .taskName = "BLACKBOX",
+        .taskFunc = taskBlackboxWriter,
+        .desiredPeriod = TASK_PERIOD_HZ(1000),        // 1kHz keeps up with 4kHz logging given a 16KB buffer
+        .staticPriority = TASK_PRIORITY_MEDIUM_HIGH,
+    },
+#endif
+#ifdef USE_AUTOTUNE_FIXED_WING
+    [TASK_AUTOTUNE] = {
+        .taskName = "AUTOTUNE",
+        .taskFunc = autotuneFixedWingTask,
+        .desiredPeriod = TASK_PERIOD_HZ(10),          // Drains 5 decimated samples per axis per run
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
 #endif
     [TASK_AUX] = {
         .taskName = "AUX",
@@ -27,5 +27,9 @@ void taskUpdateRxMain(timeUs_t currentTimeUs);
 
 void taskMainPidLoop(timeUs_t currentTimeUs);
 void taskGyro(timeUs_t currentTimeUs);
+#ifdef USE_MPU_DATA_READY_SIGNAL
+bool taskGyroSyncCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
+bool taskPidSyncCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
+#endif
 
 void fcTasksInit(void);
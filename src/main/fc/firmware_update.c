@@ -25,6 +25,7 @@
 #include "platform.h"
 
 #include "common/crc.h"
+#include "common/maths.h"
 
 #include "drivers/flash.h"
 #include "drivers/light_led.h"
@@ -66,6 +67,7 @@ static void backupFileOpenCallback(afatfsFilePtr_t file)
 
 #elif defined(USE_FLASHFS)
 static uint32_t flashStartAddress, flashOverflowAddress;
+static uint32_t flashErasedAddress;     // The staging area is erased up to here
 
 #endif
 
@@ -223,11 +225,9 @@ bool firmwareUpdatePrepare(uint32_t updateSize)
 
     flashStartAddress = flashUpdatePartition->startSector * flashGeometry->sectorSize;
     flashOverflowAddress = ((flashUpdatePartition->endSector + 1) * flashGeometry->sectorSize);
-    receivedSize = 0;
-
-    uint32_t partitionSize = (flashUpdatePartition->endSector - flashUpdatePartition->startSector + 1) * (flashGeometry->sectorSize * flashGeometry->pageSize);
+    flashErasedAddress = flashStartAddress;
 
-    if (updateSize > partitionSize) {
+    if (updateSize > flashOverflowAddress - flashStartAddress) {
         return false;
     }
 
@@ -235,6 +235,7 @@ bool firmwareUpdatePrepare(uint32_t updateSize)
 
 #endif
 
+    receivedSize = 0;
     updateFirmwareCalcCRC = 0;
 
     return true;
@@ -265,13 +266,31 @@ bool firmwareUpdateStore(uint8_t *data, uint16_t length)
 
     const flashGeometry_t *flashGeometry = flashGetGeometry();
     const uint32_t flashSectorSize = flashGeometry->sectorSize;
+    const uint32_t flashPageSize = flashGeometry->pageSize;
+
+    // Normally erased ahead already, the program below waits for an erase still running
+    while (flashErasedAddress < flashAddress + length) {
+        flashEraseSector(flashErasedAddress);
+        flashErasedAddress += flashSectorSize;
+    }
 
-    if (flashAddress % flashSectorSize == 0) {
-        flashEraseSector(flashAddress);
-        flashWaitForReady(1000);
+    // Chunks don't line up with pages, a page program must not cross a page boundary
+    uint32_t address = flashAddress;
+    for (uint32_t offset = 0; offset < length;) {
+        const uint32_t pageLength = MIN(length - offset, flashPageSize - (address % flashPageSize));
+        address = flashPageProgram(address, data + offset, pageLength);
+        offset += pageLength;
     }
 
-    flashPageProgram(flashAddress, data, length);
+    const uint32_t imageEnd = flashStartAddress + updateMetadata.firmwareSize;
+    if (address == imageEnd) {
+        // Write out a partial last page held in the chip's buffer
+        flashFlush();
+    } else if (flashErasedAddress < imageEnd && flashErasedAddress - address < flashSectorSize) {
+        // Keep the next sector erased while the chunks for this one come in
+        flashEraseSector(flashErasedAddress);
+        flashErasedAddress += flashSectorSize;
+    }
 
 #endif
 
@@ -281,6 +300,32 @@ bool firmwareUpdateStore(uint8_t *data, uint16_t length)
     return true;
 }
 
+bool firmwareUpdateStoreAt(uint32_t offset, uint8_t *data, uint16_t length)
+{
+    // Retransmission of a chunk written already, the sender went back to the last offset it saw acknowledged
+    if (offset + length <= receivedSize) {
+        return !ARMING_FLAG(ARMED);
+    }
+
+    // Chunks are written in order. A gap is not an error, the sender learns where to resume from the reply.
+    if (offset > receivedSize) {
+        return !ARMING_FLAG(ARMED);
+    }
+
+    const uint32_t skip = receivedSize - offset;
+    return firmwareUpdateStore(data + skip, length - skip);
+}
+
+uint32_t firmwareUpdateGetReceivedSize(void)
+{
+    return receivedSize;
+}
+
+uint8_t firmwareUpdateGetCRC(void)
+{
+    return updateFirmwareCalcCRC;
+}
+
 void firmwareUpdateExec(uint8_t expectCRC)
 {
     if (ARMING_FLAG(ARMED)) return;
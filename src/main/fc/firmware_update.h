@@ -22,6 +22,9 @@
 
 bool firmwareUpdatePrepare(uint32_t firmwareSize);
 bool firmwareUpdateStore(uint8_t *data, uint16_t length);
+bool firmwareUpdateStoreAt(uint32_t offset, uint8_t *data, uint16_t length);
+uint32_t firmwareUpdateGetReceivedSize(void);
+uint8_t firmwareUpdateGetCRC(void);
 void firmwareUpdateExec(uint8_t expectCRC);
 bool firmwareUpdateRollbackPrepare(void);
 void firmwareUpdateRollbackExec(void);
@@ -0,0 +1,152 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Load shedding: when the PID loop keeps missing its deadline the less
+ * important work is cut back one step at a time, in a fixed order, and given
+ * back in reverse order once the loop has been on time for a while. Every
+ * change is logged as a blackbox event so overloaded builds show up in logs.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "blackbox/blackbox.h"
+
+#include "common/utils.h"
+
+#include "config/feature.h"
+
+#include "fc/config.h"
+#include "fc/load_shedding.h"
+
+#include "scheduler/scheduler.h"
+
+#define LOAD_SHEDDING_WINDOW_US         500000  // deadline misses are counted over this window
+#define LOAD_SHEDDING_MISS_LIMIT        5       // misses in one window that shed the next step
+#define LOAD_SHEDDING_RESTORE_WINDOWS   10      // windows without a miss before the last step is restored
+
+static uint8_t loadShedLevel = 0;
+static uint16_t deadlineMisses = 0;
+static uint8_t cleanWindows = 0;
+static timeUs_t windowStartUs = 0;
+
+static void loadSheddingSlowTask(cfTaskId_e taskId, timeDelta_t *savedPeriod, int factor, bool active)
+{
+    if (active) {
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(taskId, &taskInfo);
+        *savedPeriod = taskInfo.desiredPeriod;
+        rescheduleTask(taskId, taskInfo.desiredPeriod * factor);
+    } else if (*savedPeriod) {
+        rescheduleTask(taskId, *savedPeriod);
+    }
+}
+
+static void loadSheddingApply(loadShedStep_e step, bool active)
+{
+    switch (step) {
+    case LOAD_SHED_OSD_LEDS:
+    {
+#ifdef USE_OSD
+        static timeDelta_t osdPeriod;
+        loadSheddingSlowTask(TASK_OSD, &osdPeriod, 2, active);
+#endif
+#ifdef USE_LED_STRIP
+        static timeDelta_t ledStripPeriod;
+        loadSheddingSlowTask(TASK_LEDSTRIP, &ledStripPeriod, 2, active);
+#endif
+        break;
+    }
+    case LOAD_SHED_BLACKBOX:
+#ifdef USE_BLACKBOX
+        blackboxSetLoadShedding(active);
+#endif
+        break;
+    case LOAD_SHED_SECONDARY_NOTCH:
+        // gyroFilter() polls loadSheddingIsActive()
+        break;
+    case LOAD_SHED_TELEMETRY:
+    {
+#ifdef USE_TELEMETRY
+        static timeDelta_t telemetryPeriod;
+        loadSheddingSlowTask(TASK_TELEMETRY, &telemetryPeriod, 4, active);
+#endif
+        break;
+    }
+    default:
+        break;
+    }
+
+#ifdef USE_BLACKBOX
+    if (feature(FEATURE_BLACKBOX)) {
+        flightLogEvent_loadShedding_t eventData;
+        eventData.step = step;
+        eventData.active = active;
+        eventData.level = loadShedLevel;
+        blackboxLogEvent(FLIGHT_LOG_EVENT_LOAD_SHEDDING, (flightLogEventData_t *)&eventData);
+    }
+#endif
+}
+
+void loadSheddingUpdate(timeUs_t currentTimeUs, timeDelta_t pidDeltaUs)
+{
+    if (!systemConfig()->loadShedding) {
+        return;
+    }
+
+    // A PID iteration that started more than 1.5 periods after the previous one missed its deadline
+    if (pidDeltaUs > (timeDelta_t)(getLooptime() * 3 / 2)) {
+        deadlineMisses++;
+    }
+
+    if (cmpTimeUs(currentTimeUs, windowStartUs) < LOAD_SHEDDING_WINDOW_US) {
+        return;
+    }
+
+    if (deadlineMisses >= LOAD_SHEDDING_MISS_LIMIT) {
+        cleanWindows = 0;
+        if (loadShedLevel < LOAD_SHED_STEP_COUNT) {
+            loadShedLevel++;
+            loadSheddingApply(loadShedLevel - 1, true);
+        }
+    } else if (deadlineMisses == 0 && loadShedLevel > 0) {
+        if (++cleanWindows >= LOAD_SHEDDING_RESTORE_WINDOWS) {
+            cleanWindows = 0;
+            loadShedLevel--;
+            loadSheddingApply(loadShedLevel, false);
+        }
+    }
+
+    deadlineMisses = 0;
+    windowStartUs = currentTimeUs;
+}
+
+uint8_t loadSheddingGetLevel(void)
+{
+    return loadShedLevel;
+}
+
+bool loadSheddingIsActive(loadShedStep_e step)
+{
+    return step < loadShedLevel;
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+// Shedding steps, applied in this order and restored in reverse
+typedef enum {
+    LOAD_SHED_OSD_LEDS = 0,         // OSD and LED strip refresh halved
+    LOAD_SHED_BLACKBOX,             // blackbox rate groups held on most frames
+    LOAD_SHED_SECONDARY_NOTCH,      // secondary dynamic notch frequency no longer tracked
+    LOAD_SHED_TELEMETRY,            // telemetry task rate quartered
+    LOAD_SHED_STEP_COUNT
+} loadShedStep_e;
+
+void loadSheddingUpdate(timeUs_t currentTimeUs, timeDelta_t pidDeltaUs);
+uint8_t loadSheddingGetLevel(void);
+bool loadSheddingIsActive(loadShedStep_e step);
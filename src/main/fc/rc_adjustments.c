@@ -304,6 +304,39 @@ static const adjustmentConfig_t defaultAdjustmentConfigs[ADJUSTMENT_FUNCTION_COU
 
 static adjustmentState_t adjustmentStates[MAX_SIMULTANEOUS_ADJUSTMENT_COUNT];
 
+/*
+ * The configured adjustment ranges are compiled into a table whenever they change, with
+ * the range bounds as channel values and the ranges of each AUX channel together, so
+ * every RX update reads each channel in use once and checks ranges that are set up only.
+ */
+typedef struct {
+    const adjustmentConfig_t *config;
+    uint16_t minValue;                      // active for channel values in [minValue, maxValue)
+    uint16_t maxValue;
+    uint8_t auxSwitchChannelIndex;
+    uint8_t adjustmentIndex;
+} adjustmentRangeEntry_t;
+
+typedef struct {
+    uint8_t auxChannelIndex;
+    uint8_t firstRange;
+    uint8_t rangeCount;
+} adjustmentChannelTable_t;
+
+static adjustmentRangeEntry_t adjustmentRangeTable[MAX_ADJUSTMENT_RANGE_COUNT];
+static adjustmentChannelTable_t adjustmentChannels[MAX_ADJUSTMENT_RANGE_COUNT];
+static uint8_t adjustmentChannelCount;
+
+// Derived state the step adjustments of one RX update changed, recomputed once at its end
+typedef enum {
+    ADJUSTMENT_UPDATE_RC_CURVES         = (1 << 0),
+    ADJUSTMENT_UPDATE_THROTTLE_CURVE    = (1 << 1),
+    ADJUSTMENT_UPDATE_TPA_CURVES        = (1 << 2),
+    ADJUSTMENT_UPDATE_NAV_PIDS          = (1 << 3),
+} adjustmentUpdate_e;
+
+static uint8_t adjustmentUpdates;
+
 static void configureAdjustment(uint8_t index, uint8_t auxSwitchChannelIndex, const adjustmentConfig_t *adjustmentConfig)
 {
     adjustmentState_t * const adjustmentState = &adjustmentStates[index];
@@ -374,18 +407,23 @@ static void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t
     switch (adjustmentFunction) {
         case ADJUSTMENT_RC_EXPO:
             applyAdjustmentExpo(ADJUSTMENT_RC_EXPO, &controlRateConfig->stabilized.rcExpo8, delta);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_RC_CURVES;
             break;
         case ADJUSTMENT_RC_YAW_EXPO:
             applyAdjustmentExpo(ADJUSTMENT_RC_YAW_EXPO, &controlRateConfig->stabilized.rcYawExpo8, delta);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_RC_CURVES;
             break;
         case ADJUSTMENT_MANUAL_RC_EXPO:
             applyAdjustmentExpo(ADJUSTMENT_MANUAL_RC_EXPO, &controlRateConfig->manual.rcExpo8, delta);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_RC_CURVES;
             break;
         case ADJUSTMENT_MANUAL_RC_YAW_EXPO:
             applyAdjustmentExpo(ADJUSTMENT_MANUAL_RC_YAW_EXPO, &controlRateConfig->manual.rcYawExpo8, delta);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_RC_CURVES;
             break;
         case ADJUSTMENT_THROTTLE_EXPO:
             applyAdjustmentExpo(ADJUSTMENT_THROTTLE_EXPO, &controlRateConfig->throttle.rcExpo8, delta);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_THROTTLE_CURVE;
             break;
         case ADJUSTMENT_PITCH_ROLL_RATE:
         case ADJUSTMENT_PITCH_RATE:
@@ -518,27 +556,27 @@ static void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t
             break;
         case ADJUSTMENT_POS_XY_P:
             applyAdjustmentPID(ADJUSTMENT_POS_XY_P, &pidBankMutable()->pid[PID_POS_XY].P, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_POS_XY_I:
             applyAdjustmentPID(ADJUSTMENT_POS_XY_I, &pidBankMutable()->pid[PID_POS_XY].I, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_POS_XY_D:
             applyAdjustmentPID(ADJUSTMENT_POS_XY_D, &pidBankMutable()->pid[PID_POS_XY].D, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_POS_Z_P:
             applyAdjustmentPID(ADJUSTMENT_POS_Z_P, &pidBankMutable()->pid[PID_POS_Z].P, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_POS_Z_I:
             applyAdjustmentPID(ADJUSTMENT_POS_Z_I, &pidBankMutable()->pid[PID_POS_Z].I, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_POS_Z_D:
             applyAdjustmentPID(ADJUSTMENT_POS_Z_D, &pidBankMutable()->pid[PID_POS_Z].D, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_HEADING_P:
             applyAdjustmentPID(ADJUSTMENT_HEADING_P, &pidBankMutable()->pid[PID_HEADING].P, delta);
@@ -546,27 +584,27 @@ static void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t
             break;
         case ADJUSTMENT_VEL_XY_P:
             applyAdjustmentPID(ADJUSTMENT_VEL_XY_P, &pidBankMutable()->pid[PID_VEL_XY].P, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_VEL_XY_I:
             applyAdjustmentPID(ADJUSTMENT_VEL_XY_I, &pidBankMutable()->pid[PID_VEL_XY].I, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_VEL_XY_D:
             applyAdjustmentPID(ADJUSTMENT_VEL_XY_D, &pidBankMutable()->pid[PID_VEL_XY].D, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_VEL_Z_P:
             applyAdjustmentPID(ADJUSTMENT_VEL_Z_P, &pidBankMutable()->pid[PID_VEL_Z].P, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_VEL_Z_I:
             applyAdjustmentPID(ADJUSTMENT_VEL_Z_I, &pidBankMutable()->pid[PID_VEL_Z].I, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_VEL_Z_D:
             applyAdjustmentPID(ADJUSTMENT_VEL_Z_D, &pidBankMutable()->pid[PID_VEL_Z].D, delta);
-            navigationUsePIDs();
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_NAV_PIDS;
             break;
         case ADJUSTMENT_FW_MIN_THROTTLE_DOWN_PITCH_ANGLE:
             applyAdjustmentU16(ADJUSTMENT_FW_MIN_THROTTLE_DOWN_PITCH_ANGLE, &currentBatteryProfileMutable->fwMinThrottleDownPitchAngle, delta, SETTING_FW_MIN_THROTTLE_DOWN_PITCH_MIN, SETTING_FW_MIN_THROTTLE_DOWN_PITCH_MAX);
@@ -583,9 +621,11 @@ static void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t
 #endif
         case ADJUSTMENT_TPA:
             applyAdjustmentU8(ADJUSTMENT_TPA, &controlRateConfig->throttle.dynPID, delta, 0, SETTING_TPA_RATE_MAX);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_TPA_CURVES;
             break;
         case ADJUSTMENT_TPA_BREAKPOINT:
             applyAdjustmentU16(ADJUSTMENT_TPA_BREAKPOINT, &controlRateConfig->throttle.pa_breakpoint, delta, PWM_RANGE_MIN, PWM_RANGE_MAX);
+            adjustmentUpdates |= ADJUSTMENT_UPDATE_TPA_CURVES;
             break;
         case ADJUSTMENT_FW_TPA_TIME_CONSTANT: 
             applyAdjustmentU16(ADJUSTMENT_FW_TPA_TIME_CONSTANT, &controlRateConfig->throttle.fixedWingTauMs, delta, SETTING_FW_TPA_TIME_CONSTANT_MIN, SETTING_FW_TPA_TIME_CONSTANT_MAX);
@@ -687,31 +727,97 @@ void processRcAdjustments(controlRateConfig_t *controlRateConfig, bool canUseRxD
         }
         MARK_ADJUSTMENT_FUNCTION_AS_BUSY(adjustmentIndex);
     }
+
+    // The PID gains follow schedulePidGainsUpdate() on their own, the rest is recomputed once for all adjustments
+    if (adjustmentUpdates & ADJUSTMENT_UPDATE_RC_CURVES) {
+        generateRcCurves(controlRateConfig);
+    }
+    if (adjustmentUpdates & ADJUSTMENT_UPDATE_THROTTLE_CURVE) {
+        generateThrottleCurve(controlRateConfig);
+    }
+    if (adjustmentUpdates & ADJUSTMENT_UPDATE_TPA_CURVES) {
+        generateTpaCurves(controlRateConfig);
+    }
+    if (adjustmentUpdates & ADJUSTMENT_UPDATE_NAV_PIDS) {
+        navigationUsePIDs();
+    }
+    adjustmentUpdates = 0;
 }
 
 void resetAdjustmentStates(void)
 {
     memset(adjustmentStates, 0, sizeof(adjustmentStates));
+
+    updateAdjustmentRangeTable();
 }
 
-void updateAdjustmentStates(bool canUseRxData)
+void updateAdjustmentRangeTable(void)
 {
+    uint8_t rangeCount = 0;
+
+    adjustmentChannelCount = 0;
+
     for (int index = 0; index < MAX_ADJUSTMENT_RANGE_COUNT; index++) {
         const adjustmentRange_t * const adjustmentRange = adjustmentRanges(index);
-        if (adjustmentRange->adjustmentFunction == ADJUSTMENT_NONE) {
-            // Range not set up
+        // Ranges not set up, or set up with values out of bounds, are left out
+        if (adjustmentRange->adjustmentFunction == ADJUSTMENT_NONE || adjustmentRange->adjustmentFunction >= ADJUSTMENT_FUNCTION_COUNT ||
+            adjustmentRange->adjustmentIndex >= MAX_SIMULTANEOUS_ADJUSTMENT_COUNT || adjustmentRange->auxChannelIndex >= MAX_AUX_CHANNEL_COUNT ||
+            !IS_RANGE_USABLE(&adjustmentRange->range)) {
+            continue;
+        }
+
+        // Channel table: built once per channel, from all of its ranges in index order
+        bool channelKnown = false;
+        for (int i = 0; i < adjustmentChannelCount; i++) {
+            channelKnown |= adjustmentChannels[i].auxChannelIndex == adjustmentRange->auxChannelIndex;
+        }
+        if (channelKnown) {
             continue;
         }
-        const adjustmentConfig_t *adjustmentConfig = &defaultAdjustmentConfigs[adjustmentRange->adjustmentFunction - ADJUSTMENT_FUNCTION_CONFIG_INDEX_OFFSET];
-        adjustmentState_t * const adjustmentState = &adjustmentStates[adjustmentRange->adjustmentIndex];
 
-        if (canUseRxData && isRangeActive(adjustmentRange->auxChannelIndex, &adjustmentRange->range)) {
-            if (!adjustmentState->config) {
-                configureAdjustment(adjustmentRange->adjustmentIndex, adjustmentRange->auxSwitchChannelIndex, adjustmentConfig);
+        adjustmentChannelTable_t *channel = &adjustmentChannels[adjustmentChannelCount++];
+        channel->auxChannelIndex = adjustmentRange->auxChannelIndex;
+        channel->firstRange = rangeCount;
+        channel->rangeCount = 0;
+
+        for (int other = index; other < MAX_ADJUSTMENT_RANGE_COUNT; other++) {
+            const adjustmentRange_t * const otherRange = adjustmentRanges(other);
+            if (otherRange->adjustmentFunction == ADJUSTMENT_NONE || otherRange->adjustmentFunction >= ADJUSTMENT_FUNCTION_COUNT ||
+                otherRange->adjustmentIndex >= MAX_SIMULTANEOUS_ADJUSTMENT_COUNT || otherRange->auxChannelIndex != channel->auxChannelIndex ||
+                !IS_RANGE_USABLE(&otherRange->range)) {
+                continue;
             }
-        } else {
-            if (adjustmentState->config == adjustmentConfig) {
-                adjustmentState->config = NULL;
+
+            adjustmentRangeEntry_t *entry = &adjustmentRangeTable[rangeCount++];
+            entry->config = &defaultAdjustmentConfigs[otherRange->adjustmentFunction - ADJUSTMENT_FUNCTION_CONFIG_INDEX_OFFSET];
+            entry->minValue = MODE_STEP_TO_CHANNEL_VALUE(otherRange->range.startStep);
+            entry->maxValue = MODE_STEP_TO_CHANNEL_VALUE(otherRange->range.endStep);
+            entry->auxSwitchChannelIndex = otherRange->auxSwitchChannelIndex;
+            entry->adjustmentIndex = otherRange->adjustmentIndex;
+            channel->rangeCount++;
+        }
+    }
+}
+
+void updateAdjustmentStates(bool canUseRxData)
+{
+    for (int i = 0; i < adjustmentChannelCount; i++) {
+        const adjustmentChannelTable_t *channel = &adjustmentChannels[i];
+        const uint16_t channelValue = rxGetChannelValue(channel->auxChannelIndex + NON_AUX_CHANNEL_COUNT);
+
+        for (int r = channel->firstRange; r < channel->firstRange + channel->rangeCount; r++) {
+            const adjustmentRangeEntry_t *entry = &adjustmentRangeTable[r];
+            adjustmentState_t * const adjustmentState = &adjustmentStates[entry->adjustmentIndex];
+
+            // Same closed-open test as isRangeActive()
+            if (canUseRxData && channelValue >= entry->minValue && channelValue < entry->maxValue) {
+                if (!adjustmentState->config) {
+                    configureAdjustment(entry->adjustmentIndex, entry->auxSwitchChannelIndex, entry->config);
+                }
+            } else {
+                if (adjustmentState->config == entry->config) {
+                    adjustmentState->config = NULL;
+                }
             }
         }
     }
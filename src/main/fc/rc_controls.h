@@ -99,6 +99,7 @@ typedef struct armingConfig_s {
     bool disarm_kill_switch;             // allow disarm via AUX switch regardless of throttle value
     uint16_t switchDisarmDelayMs;           // additional delay between ARM box going off and actual disarm
     uint16_t prearmTimeoutMs;               // duration for which Prearm being activated is valid. after this, Prearm needs to be reset. 0 means Prearm does not timeout.
+    bool warm_restart;                      // Resume armed flight after an in-flight watchdog or brown-out reset
 } armingConfig_t;
 
 PG_DECLARE(armingConfig_t, armingConfig);
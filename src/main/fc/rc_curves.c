@@ -33,13 +33,42 @@
 
 #define THROTTLE_LOOKUP_LENGTH 11
 
-static EXTENDED_FASTRAM int16_t lookupThrottleRC[THROTTLE_LOOKUP_LENGTH];    // lookup table for expo & mid THROTTLE
-int16_t lookupThrottleRCMid;                         // THROTTLE curve mid point
+#define RC_EXPO_LOOKUP_STEP     20
+#define RC_EXPO_LOOKUP_LENGTH   (500 / RC_EXPO_LOOKUP_STEP + 1)
+
+#define TPA_LOOKUP_STEP_SHIFT   4
+#define TPA_LOOKUP_STEP         (1 << TPA_LOOKUP_STEP_SHIFT)
+#define TPA_LOOKUP_LENGTH       ((PWM_RANGE_MAX - PWM_RANGE_MIN) / TPA_LOOKUP_STEP + 2)
+
+// Curves of one control rate profile
+typedef struct {
+    int16_t lookupThrottleRC[THROTTLE_LOOKUP_LENGTH];                   // lookup table for expo & mid THROTTLE
+    int16_t lookupThrottleRCMid;                                        // THROTTLE curve mid point
+    int16_t lookupExpoRC[RC_CURVE_COUNT][RC_EXPO_LOOKUP_LENGTH];        // stick deflection [0;500] to expo-ed command
+    float lookupTpa[TPA_CURVE_COUNT][TPA_LOOKUP_LENGTH];                // throttle [PWM_RANGE_MIN;PWM_RANGE_MAX] to TPA factor
+} rcCurveSet_t;
+
+// Every profile keeps its curves, a profile switch only moves the pointer
+static EXTENDED_FASTRAM rcCurveSet_t rcCurveSets[MAX_CONTROL_RATE_PROFILE_COUNT];
+static EXTENDED_FASTRAM const rcCurveSet_t *rcCurves = &rcCurveSets[0];
+
+static rcCurveSet_t *rcCurveSetOf(const controlRateConfig_t *controlRateConfig)
+{
+    return &rcCurveSets[controlRateConfig - controlRateProfiles(0)];
+}
+
+void selectRcCurves(uint8_t profileIndex)
+{
+    rcCurves = &rcCurveSets[profileIndex];
+}
 
 void generateThrottleCurve(const controlRateConfig_t *controlRateConfig)
 {
+    rcCurveSet_t *curves = rcCurveSetOf(controlRateConfig);
+    int16_t *lookupThrottleRC = curves->lookupThrottleRC;
+
     const int minThrottle = getThrottleIdleValue();
-    lookupThrottleRCMid = minThrottle + (int32_t)(motorConfig()->maxthrottle - minThrottle) * controlRateConfig->throttle.rcMid8 / 100; // [MINTHROTTLE;MAXTHROTTLE]
+    curves->lookupThrottleRCMid = minThrottle + (int32_t)(motorConfig()->maxthrottle - minThrottle) * controlRateConfig->throttle.rcMid8 / 100; // [MINTHROTTLE;MAXTHROTTLE]
 
     for (int i = 0; i < THROTTLE_LOOKUP_LENGTH; i++) {
         const int16_t tmp = 10 * i - controlRateConfig->throttle.rcMid8;
@@ -59,16 +88,105 @@ int16_t rcLookup(int32_t stickDeflection, uint8_t expo)
     return lrintf((2500.0f + (float)expo * (tmpf * tmpf - 25.0f)) * tmpf / 25.0f);
 }
 
+void generateRcCurves(const controlRateConfig_t *controlRateConfig)
+{
+    const uint8_t curveExpo[RC_CURVE_COUNT] = {
+        [RC_CURVE_STABILIZED]       = controlRateConfig->stabilized.rcExpo8,
+        [RC_CURVE_STABILIZED_YAW]   = controlRateConfig->stabilized.rcYawExpo8,
+        [RC_CURVE_MANUAL]           = controlRateConfig->manual.rcExpo8,
+        [RC_CURVE_MANUAL_YAW]       = controlRateConfig->manual.rcYawExpo8,
+    };
+
+    rcCurveSet_t *curves = rcCurveSetOf(controlRateConfig);
+
+    for (int curve = 0; curve < RC_CURVE_COUNT; curve++) {
+        for (int i = 0; i < RC_EXPO_LOOKUP_LENGTH; i++) {
+            curves->lookupExpoRC[curve][i] = rcLookup(i * RC_EXPO_LOOKUP_STEP, curveExpo[curve]);
+        }
+    }
+}
+
+int16_t rcLookupCurve(int32_t stickDeflection, rcCurve_e curve)
+{
+    // Expo curve is odd-symmetric, only the positive half is stored
+    const int32_t absoluteDeflection = MIN(ABS(stickDeflection), 500);
+    const int16_t *lookup = rcCurves->lookupExpoRC[curve];
+    const uint8_t lookupStep = absoluteDeflection / RC_EXPO_LOOKUP_STEP;
+
+    int32_t value = lookup[lookupStep];
+    if (lookupStep < RC_EXPO_LOOKUP_LENGTH - 1) {
+        value += (absoluteDeflection - lookupStep * RC_EXPO_LOOKUP_STEP) * (lookup[lookupStep + 1] - value) / RC_EXPO_LOOKUP_STEP;
+    }
+
+    return stickDeflection < 0 ? -value : value;
+}
+
+static float calculateMultirotorTpa(const controlRateConfig_t *controlRateConfig, uint16_t throttle)
+{
+    if (controlRateConfig->throttle.dynPID == 0 || throttle < controlRateConfig->throttle.pa_breakpoint) {
+        return 1.0f;
+    } else if (throttle < motorConfig()->maxthrottle) {
+        return (100 - (uint16_t)controlRateConfig->throttle.dynPID * (throttle - controlRateConfig->throttle.pa_breakpoint) / (float)(motorConfig()->maxthrottle - controlRateConfig->throttle.pa_breakpoint)) / 100.0f;
+    } else {
+        return (100 - controlRateConfig->throttle.dynPID) / 100.0f;
+    }
+}
+
+static float calculateFixedWingTpa(const controlRateConfig_t *controlRateConfig, uint16_t throttle)
+{
+    // tpa_rate is amount of curve TPA applied to PIDs
+    // tpa_breakpoint for fixed wing is cruise throttle value (value at which PIDs were tuned)
+    if (controlRateConfig->throttle.dynPID == 0 || controlRateConfig->throttle.pa_breakpoint <= getThrottleIdleValue()) {
+        return 1.0f;
+    }
+
+    float tpaFactor;
+    if (throttle > getThrottleIdleValue()) {
+        // Calculate TPA according to throttle
+        tpaFactor = 0.5f + ((float)(controlRateConfig->throttle.pa_breakpoint - getThrottleIdleValue()) / (throttle - getThrottleIdleValue()) / 2.0f);
+
+        // Limit to [0.5; 2] range
+        tpaFactor = constrainf(tpaFactor, 0.5f, 2.0f);
+    }
+    else {
+        tpaFactor = 2.0f;
+    }
+
+    // Attenuate TPA curve according to configured amount
+    return 1.0f + (tpaFactor - 1.0f) * (controlRateConfig->throttle.dynPID / 100.0f);
+}
+
+void generateTpaCurves(const controlRateConfig_t *controlRateConfig)
+{
+    rcCurveSet_t *curves = rcCurveSetOf(controlRateConfig);
+
+    for (int i = 0; i < TPA_LOOKUP_LENGTH; i++) {
+        const uint16_t throttle = PWM_RANGE_MIN + i * TPA_LOOKUP_STEP;
+        curves->lookupTpa[TPA_CURVE_MULTIROTOR][i] = calculateMultirotorTpa(controlRateConfig, throttle);
+        curves->lookupTpa[TPA_CURVE_FIXED_WING][i] = calculateFixedWingTpa(controlRateConfig, throttle);
+    }
+}
+
+float rcLookupTpa(tpaCurve_e curve, uint16_t throttle)
+{
+    const uint16_t throttleOffset = constrain(throttle, PWM_RANGE_MIN, PWM_RANGE_MAX) - PWM_RANGE_MIN;
+    const uint8_t lookupStep = throttleOffset >> TPA_LOOKUP_STEP_SHIFT;
+    const float *lookup = rcCurves->lookupTpa[curve];
+
+    return lookup[lookupStep] + (throttleOffset & (TPA_LOOKUP_STEP - 1)) * (lookup[lookupStep + 1] - lookup[lookupStep]) / TPA_LOOKUP_STEP;
+}
+
 uint16_t rcLookupThrottle(uint16_t absoluteDeflection)
 {
     if (absoluteDeflection > 999)
         return motorConfig()->maxthrottle;
 
+    const int16_t *lookupThrottleRC = rcCurves->lookupThrottleRC;
     const uint8_t lookupStep = absoluteDeflection / 100;
     return lookupThrottleRC[lookupStep] + (absoluteDeflection - lookupStep * 100) * (lookupThrottleRC[lookupStep + 1] - lookupThrottleRC[lookupStep]) / 100;
 }
 
 int16_t rcLookupThrottleMid(void)
 {
-    return lookupThrottleRCMid;
+    return rcCurves->lookupThrottleRCMid;
 }
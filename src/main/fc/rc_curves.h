@@ -17,9 +17,28 @@
 
 #pragma once
 
+typedef enum {
+    RC_CURVE_STABILIZED = 0,
+    RC_CURVE_STABILIZED_YAW,
+    RC_CURVE_MANUAL,
+    RC_CURVE_MANUAL_YAW,
+    RC_CURVE_COUNT
+} rcCurve_e;
+
+typedef enum {
+    TPA_CURVE_MULTIROTOR = 0,
+    TPA_CURVE_FIXED_WING,
+    TPA_CURVE_COUNT
+} tpaCurve_e;
+
 struct controlRateConfig_s;
+void selectRcCurves(uint8_t profileIndex);
 void generateThrottleCurve(const struct controlRateConfig_s *controlRateConfig);
+void generateRcCurves(const struct controlRateConfig_s *controlRateConfig);
+void generateTpaCurves(const struct controlRateConfig_s *controlRateConfig);
 
 int16_t rcLookup(int32_t stickDeflection, uint8_t expo);
+int16_t rcLookupCurve(int32_t stickDeflection, rcCurve_e curve);
+float rcLookupTpa(tpaCurve_e curve, uint16_t throttle);
 uint16_t rcLookupThrottle(uint16_t tmp);
 int16_t rcLookupThrottleMid(void);
@@ -41,6 +41,40 @@
 static uint8_t specifiedConditionCountPerMode[CHECKBOX_ITEM_COUNT];
 static bool isUsingNAVModes = false;
 
+/*
+ * Mode activation is evaluated from tables built when the conditions change.
+ * Each AUX channel in use gets a sorted list of the steps where one of its
+ * ranges starts or ends, tagged with the set of conditions active from that
+ * step on. A channel is looked up again only when its value moves to another
+ * step, and the modes are recomputed only when one of the channels did.
+ */
+typedef uint64_t modeConditionMask_t;          // one bit per modeActivationConditions() index
+STATIC_ASSERT(MAX_MODE_ACTIVATION_CONDITION_COUNT <= 64, mode_condition_mask_too_small);
+
+#define MODE_STEP_BELOW_RANGE   0xFF            // channel value below CHANNEL_RANGE_MIN matches no range
+
+typedef struct {
+    uint8_t auxChannelIndex;
+    uint8_t firstBreakpoint;
+    uint8_t breakpointCount;
+    uint8_t step;                               // step the channel was at when last looked up
+    modeConditionMask_t activeConditions;
+} modeChannelTable_t;
+
+typedef struct {
+    uint8_t modeId;
+    modeConditionMask_t conditions;
+} modeConditionTable_t;
+
+static uint8_t modeBreakpointStep[MAX_MODE_ACTIVATION_CONDITION_COUNT * 2];
+static modeConditionMask_t modeBreakpointConditions[MAX_MODE_ACTIVATION_CONDITION_COUNT * 2];
+static modeChannelTable_t modeChannels[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+static uint8_t modeChannelCount;
+static modeConditionTable_t modeConditions[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+static uint8_t modeConditionCount;
+static bool modeTablesChanged = true;
+static modeActivationOperator_e modeTablesOperator;
+
 boxBitmask_t rcModeActivationMask; // one bit per mode defined in boxId_e
 
 // TODO(alberto): It looks like we can now safely remove this assert, since everything
@@ -151,43 +185,156 @@ bool isRangeActive(uint8_t auxChannelIndex, const channelRange_t *range)
             channelValue < CHANNEL_RANGE_MIN + (range->endStep * CHANNEL_RANGE_STEP_WIDTH));
 }
 
-void updateActivatedModes(void)
+static uint8_t modeChannelStep(uint8_t auxChannelIndex)
 {
-    // Disable all modes to begin with
-    boxBitmask_t newMask;
-    memset(&newMask, 0, sizeof(newMask));
+    // Same closed-open test as isRangeActive(), a value inside [start, end) steps has its step in [start, end)
+    const int channelValue = rxGetChannelValue(auxChannelIndex + NON_AUX_CHANNEL_COUNT);
+    if (channelValue < CHANNEL_RANGE_MIN) {
+        return MODE_STEP_BELOW_RANGE;
+    }
+    return MIN((channelValue - CHANNEL_RANGE_MIN) / CHANNEL_RANGE_STEP_WIDTH, MODE_STEP_BELOW_RANGE - 1);
+}
 
-    // Unfortunately for AND logic it's not enough to simply check if any of the specified channel range conditions are valid for a mode.
-    // We need to count the total number of conditions specified for each mode, and check that all those conditions are currently valid.
-    uint8_t activeConditionCountPerMode[CHECKBOX_ITEM_COUNT];
-    memset(activeConditionCountPerMode, 0, CHECKBOX_ITEM_COUNT);
+static modeConditionMask_t modeChannelLookup(const modeChannelTable_t *channel, uint8_t step)
+{
+    modeConditionMask_t conditions = 0;
 
-    for (int index = 0; index < MAX_MODE_ACTIVATION_CONDITION_COUNT; index++) {
-        if (isRangeActive(modeActivationConditions(index)->auxChannelIndex, &modeActivationConditions(index)->range)) {
-            // Increment the number of valid conditions for this mode
-            activeConditionCountPerMode[modeActivationConditions(index)->modeId]++;
+    if (step != MODE_STEP_BELOW_RANGE) {
+        // Breakpoints are sorted, the last one at or below the step applies
+        for (int i = channel->firstBreakpoint; i < channel->firstBreakpoint + channel->breakpointCount; i++) {
+            if (modeBreakpointStep[i] > step) {
+                break;
+            }
+            conditions = modeBreakpointConditions[i];
         }
     }
 
-    // Now see which modes should be enabled
-    for (int modeIndex = 0; modeIndex < CHECKBOX_ITEM_COUNT; modeIndex++) {
-        // only modes with conditions specified are considered
-        if (specifiedConditionCountPerMode[modeIndex] > 0) {
-            // For AND logic, the specified condition count and valid condition count must be the same.
-            // For OR logic, the valid condition count must be greater than zero.
-
-            if (modeActivationOperatorConfig()->modeActivationOperator == MODE_OPERATOR_AND) {
-                // AND the conditions
-                if (activeConditionCountPerMode[modeIndex] == specifiedConditionCountPerMode[modeIndex]) {
-                    bitArraySet(newMask.bits, modeIndex);
+    return conditions;
+}
+
+static void buildModeActivationTables(void)
+{
+    uint8_t breakpointCount = 0;
+
+    modeChannelCount = 0;
+    modeConditionCount = 0;
+
+    for (int index = 0; index < MAX_MODE_ACTIVATION_CONDITION_COUNT; index++) {
+        const modeActivationCondition_t *condition = modeActivationConditions(index);
+        if (!IS_RANGE_USABLE(&condition->range)) {
+            continue;
+        }
+
+        const modeConditionMask_t conditionBit = (modeConditionMask_t)1 << index;
+
+        // Mode table: which conditions belong to the mode
+        int modeIndex = 0;
+        while (modeIndex < modeConditionCount && modeConditions[modeIndex].modeId != condition->modeId) {
+            modeIndex++;
+        }
+        if (modeIndex == modeConditionCount) {
+            modeConditions[modeConditionCount].modeId = condition->modeId;
+            modeConditions[modeConditionCount].conditions = 0;
+            modeConditionCount++;
+        }
+        modeConditions[modeIndex].conditions |= conditionBit;
+
+        // A condition on a channel that does not exist is never active
+        if (condition->auxChannelIndex >= MAX_AUX_CHANNEL_COUNT) {
+            continue;
+        }
+
+        // Channel table: built once per channel, from all of its conditions
+        bool channelKnown = false;
+        for (int i = 0; i < modeChannelCount; i++) {
+            channelKnown |= modeChannels[i].auxChannelIndex == condition->auxChannelIndex;
+        }
+        if (channelKnown) {
+            continue;
+        }
+
+        modeChannelTable_t *channel = &modeChannels[modeChannelCount++];
+        channel->auxChannelIndex = condition->auxChannelIndex;
+        channel->firstBreakpoint = breakpointCount;
+        channel->breakpointCount = 0;
+        channel->step = MODE_STEP_BELOW_RANGE;
+        channel->activeConditions = 0;
+
+        uint8_t *steps = &modeBreakpointStep[channel->firstBreakpoint];
+        for (int other = index; other < MAX_MODE_ACTIVATION_CONDITION_COUNT; other++) {
+            const modeActivationCondition_t *otherCondition = modeActivationConditions(other);
+            if (!IS_RANGE_USABLE(&otherCondition->range) || otherCondition->auxChannelIndex != channel->auxChannelIndex) {
+                continue;
+            }
+
+            const uint8_t edges[2] = { otherCondition->range.startStep, otherCondition->range.endStep };
+            for (int e = 0; e < 2; e++) {
+                // Insertion into the sorted breakpoint list, duplicates are dropped
+                int pos = 0;
+                while (pos < channel->breakpointCount && steps[pos] < edges[e]) {
+                    pos++;
                 }
+                if (pos < channel->breakpointCount && steps[pos] == edges[e]) {
+                    continue;
+                }
+                memmove(&steps[pos + 1], &steps[pos], channel->breakpointCount - pos);
+                steps[pos] = edges[e];
+                channel->breakpointCount++;
             }
-            else {
-                // OR the conditions
-                if (activeConditionCountPerMode[modeIndex] > 0) {
-                    bitArraySet(newMask.bits, modeIndex);
+        }
+
+        for (int i = 0; i < channel->breakpointCount; i++) {
+            modeConditionMask_t conditions = 0;
+            for (int other = index; other < MAX_MODE_ACTIVATION_CONDITION_COUNT; other++) {
+                const modeActivationCondition_t *otherCondition = modeActivationConditions(other);
+                if (IS_RANGE_USABLE(&otherCondition->range) && otherCondition->auxChannelIndex == channel->auxChannelIndex &&
+                    steps[i] >= otherCondition->range.startStep && steps[i] < otherCondition->range.endStep) {
+                    conditions |= (modeConditionMask_t)1 << other;
                 }
             }
+            modeBreakpointConditions[channel->firstBreakpoint + i] = conditions;
+        }
+
+        breakpointCount += channel->breakpointCount;
+    }
+
+    modeTablesChanged = true;
+}
+
+void updateActivatedModes(void)
+{
+    bool channelMoved = false;
+    modeConditionMask_t activeConditions = 0;
+
+    for (int i = 0; i < modeChannelCount; i++) {
+        modeChannelTable_t *channel = &modeChannels[i];
+        const uint8_t step = modeChannelStep(channel->auxChannelIndex);
+        if (step != channel->step || modeTablesChanged) {
+            channel->step = step;
+            channel->activeConditions = modeChannelLookup(channel, step);
+            channelMoved = true;
+        }
+        activeConditions |= channel->activeConditions;
+    }
+
+    const modeActivationOperator_e modeOperator = modeActivationOperatorConfig()->modeActivationOperator;
+    if (!channelMoved && !modeTablesChanged && modeOperator == modeTablesOperator) {
+        return;
+    }
+
+    modeTablesChanged = false;
+    modeTablesOperator = modeOperator;
+
+    // Disable all modes to begin with
+    boxBitmask_t newMask;
+    memset(&newMask, 0, sizeof(newMask));
+
+    // Only modes with conditions specified are in the table.
+    // For AND logic all of the conditions of the mode must be active, for OR logic any of them.
+    for (int i = 0; i < modeConditionCount; i++) {
+        const modeConditionMask_t conditions = activeConditions & modeConditions[i].conditions;
+        if (modeOperator == MODE_OPERATOR_AND ? (conditions == modeConditions[i].conditions) : (conditions != 0)) {
+            bitArraySet(newMask.bits, modeConditions[i].modeId);
         }
     }
 
@@ -203,6 +350,8 @@ void updateUsedModeActivationConditionFlags(void)
         }
     }
 
+    buildModeActivationTables();
+
     isUsingNAVModes = isModeActivationConditionPresent(BOXNAVPOSHOLD) ||
                         isModeActivationConditionPresent(BOXNAVRTH) ||
                         isModeActivationConditionPresent(BOXNAVCOURSEHOLD) ||
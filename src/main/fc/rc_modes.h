@@ -123,6 +123,8 @@ typedef struct modeActivationOperatorConfig_s {
 PG_DECLARE_ARRAY(modeActivationCondition_t, MAX_MODE_ACTIVATION_CONDITION_COUNT, modeActivationConditions);
 PG_DECLARE(modeActivationOperatorConfig_t, modeActivationOperatorConfig);
 
+extern boxBitmask_t rcModeActivationMask; // one bit per mode defined in boxId_e
+
 bool IS_RC_MODE_ACTIVE(boxId_e boxId);
 void rcModeUpdate(boxBitmask_t *newState);
 
@@ -58,13 +58,64 @@ uint16_t getRcUpdateFrequency(void) {
     return rcUpdateFrequency;
 }
 
-static int32_t applyRcUpdateFrequencyMedianFilter(int32_t newReading)
+// Frames further apart than this are not used to estimate the stick rate (RX loss, failsafe)
+#define RC_EXTRAPOLATION_MAX_FRAME_PERIOD_US 100000
+
+static void rcExtrapolationApply(bool isRXDataNew, timeUs_t currentTimeUs)
+{
+    static float stickValue[4];
+    static float stickRate[4];
+    static timeUs_t frameTimeUs;
+    static timeDelta_t framePeriodUs;
+
+    if (isRXDataNew) {
+        const timeUs_t newFrameTimeUs = rxGetFrameTimeUs();
+        const timeDelta_t periodUs = cmpTimeUs(newFrameTimeUs, frameTimeUs);
+
+        for (int stick = 0; stick < 4; stick++) {
+            if (periodUs > 0 && periodUs < RC_EXTRAPOLATION_MAX_FRAME_PERIOD_US) {
+                stickRate[stick] = (rcStickUnfiltered[stick] - stickValue[stick]) / (periodUs * 1e-6f);
+            } else {
+                // Forced update without a new frame or after a gap, just hold the value
+                stickRate[stick] = 0;
+            }
+            stickValue[stick] = rcStickUnfiltered[stick];
+        }
+
+        if (periodUs > 0) {
+            frameTimeUs = newFrameTimeUs;
+            framePeriodUs = MIN(periodUs, RC_EXTRAPOLATION_MAX_FRAME_PERIOD_US);
+        }
+    }
+
+    // Predict at most one frame ahead, if the next frame is late the last prediction is held
+    const float sinceFrameS = constrain(cmpTimeUs(currentTimeUs, frameTimeUs), 0, framePeriodUs) * 1e-6f;
+
+    for (int stick = 0; stick < 4; stick++) {
+        const float predicted = stickValue[stick] + stickRate[stick] * sinceFrameS;
+
+        // The prediction is kept within the stick range, the received value itself is never altered
+        if (stick == THROTTLE) {
+            rcCommand[stick] = constrainf(predicted, MIN(stickValue[stick], getThrottleIdleValue()), MAX(stickValue[stick], motorConfig()->maxthrottle));
+        } else {
+            rcCommand[stick] = constrainf(predicted, MIN(stickValue[stick], -500), MAX(stickValue[stick], 500));
+        }
+    }
+}
+
+#define RC_FILTER_SAMPLES_MEDIAN 9
+static int32_t filterSamples[RC_FILTER_SAMPLES_MEDIAN];
+static int filterSampleIndex = 0;
+static bool medianFilterReady = false;
+
+static void resetRcUpdateFrequencyMedianFilter(void)
 {
-    #define RC_FILTER_SAMPLES_MEDIAN 9
-    static int32_t filterSamples[RC_FILTER_SAMPLES_MEDIAN];
-    static int filterSampleIndex = 0;
-    static bool medianFilterReady = false;
+    filterSampleIndex = 0;
+    medianFilterReady = false;
+}
 
+static int32_t applyRcUpdateFrequencyMedianFilter(int32_t newReading)
+{
     filterSamples[filterSampleIndex] = newReading;
     ++filterSampleIndex;
     if (filterSampleIndex == RC_FILTER_SAMPLES_MEDIAN) {
@@ -81,6 +132,7 @@ void rcInterpolationApply(bool isRXDataNew, timeUs_t currentTimeUs)
     static timeUs_t previousRcData;
     static int filterFrequency;
     static bool initDone = false;
+    static uint8_t rateChangeCount = 0;
 
     const float dT = getLooptime() * 1e-6f;
 
@@ -108,9 +160,21 @@ void rcInterpolationApply(bool isRXDataNew, timeUs_t currentTimeUs)
     }
 
     if (isRXDataNew) {
-        const timeDelta_t delta = cmpTimeUs(currentTimeUs, previousRcData);
-        rcUpdateFrequency = applyRcUpdateFrequencyMedianFilter(1.0f / (delta * 0.000001f));
-        previousRcData = currentTimeUs;
+        // The receiver switched packet rate, the samples in the median filter would hold the old
+        // rate (and the auto smoothing cutoff with it) for several frames
+        if (rateChangeCount != rxGetRateChangeCount()) {
+            rateChangeCount = rxGetRateChangeCount();
+            resetRcUpdateFrequencyMedianFilter();
+        }
+
+        // The rate is measured between the frame timestamps, the RX task adds its scheduling jitter otherwise.
+        // Forced RX updates without a new frame don't count as a sample
+        const timeUs_t frameTimeUs = rxGetFrameTimeUs();
+        const timeDelta_t delta = cmpTimeUs(frameTimeUs, previousRcData);
+        if (delta > 0) {
+            rcUpdateFrequency = applyRcUpdateFrequencyMedianFilter(1.0f / (delta * 0.000001f));
+        }
+        previousRcData = frameTimeUs;
 
         /*
          * If auto smoothing is enabled, update the filters
@@ -140,6 +204,11 @@ void rcInterpolationApply(bool isRXDataNew, timeUs_t currentTimeUs)
 
     }
 
+    if (rxConfig()->rcFilterMode == RC_FILTER_MODE_EXTRAPOLATE) {
+        rcExtrapolationApply(isRXDataNew, currentTimeUs);
+        return;
+    }
+
     for (int stick = 0; stick < 4; stick++) {
         rcCommand[stick] = pt3FilterApply(&rcSmoothFilter[stick], rcStickUnfiltered[stick]);
     }
@@ -28,5 +28,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "common/time.h"
+
 uint16_t getRcUpdateFrequency(void);
 void rcInterpolationApply(bool isRXDataNew, timeUs_t currentTimeUs);
\ No newline at end of file
@@ -138,6 +138,7 @@ typedef enum {
     FW_HEADING_USE_YAW                  = (1 << 24),
     ANTI_WINDUP_DEACTIVATED             = (1 << 25),
     LANDING_DETECTED                    = (1 << 26),
+    GYRO_CLIPPING                       = (1 << 27),    // Gyro samples reached the sensor full scale recently
 } stateFlags_t;
 
 #define DISABLE_STATE(mask) (stateFlags &= ~(mask))
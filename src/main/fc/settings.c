@@ -111,17 +111,37 @@ bool settingNameIsExactMatch(const setting_t *val, char *buf, const char *cmdlin
 	return sl_strncasecmp(cmdline, buf, strlen(buf)) == 0 && var_name_length == strlen(buf);
 }
 
+// FNV-1a of the lowercased name. Must match NameHasher.hash in utils/settings.rb
+static uint32_t settingNameHash(const char *name, size_t length, uint32_t seed)
+{
+	uint32_t hash = 2166136261U ^ seed;
+	for (size_t ii = 0; ii < length; ii++) {
+		hash ^= (uint8_t)sl_tolower(name[ii]);
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+// Returns the only setting that can have the given name, its name
+// still needs to be compared since the name might not exist
+static const setting_t *settingFindCandidate(const char *name, size_t length)
+{
+	const uint16_t seed = settingsHashSeeds[settingNameHash(name, length, 0) % SETTINGS_HASH_BUCKET_COUNT];
+	return &settingsTable[settingsHashIndexes[settingNameHash(name, length, seed) % SETTINGS_TABLE_COUNT]];
+}
+
 const setting_t *settingFind(const char *name)
 {
 	char buf[SETTING_MAX_NAME_LENGTH];
-	for (int ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
-		const setting_t *setting = &settingsTable[ii];
-		settingGetName(setting, buf);
-		if (strcmp(buf, name) == 0) {
-			return setting;
-		}
-	}
-	return NULL;
+	const setting_t *setting = settingFindCandidate(name, strlen(name));
+	settingGetName(setting, buf);
+	return strcmp(buf, name) == 0 ? setting : NULL;
+}
+
+const setting_t *settingFindIgnoreCase(const char *name, uint8_t length, char *buf)
+{
+	const setting_t *setting = settingFindCandidate(name, length);
+	return settingNameIsExactMatch(setting, buf, name, length) ? setting : NULL;
 }
 
 const setting_t *settingGet(unsigned index)
@@ -77,6 +77,10 @@ bool settingNameIsExactMatch(const setting_t *val, char *buf, const char *cmdlin
 // Returns a setting_t with the exact name (case sensitive), or
 // NULL if no setting with that name exists.
 const setting_t *settingFind(const char *name);
+// Returns a setting_t whose name matches the first length characters
+// of name ignoring case, or NULL if there's none. The setting name is
+// stored in buf, which must be at least SETTING_MAX_NAME_LENGTH.
+const setting_t *settingFindIgnoreCase(const char *name, uint8_t length, char *buf);
 // Returns the setting at the given index, or NULL if
 // the index is greater than the total count.
 const setting_t *settingGet(unsigned index);
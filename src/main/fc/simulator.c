@@ -0,0 +1,361 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_SIMULATOR
+
+#include "common/axis.h"
+#include "common/log.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/feature.h"
+
+#include "drivers/time.h"
+
+#include "fc/config.h"
+#include "fc/fc_core.h"
+#include "fc/runtime_config.h"
+#include "fc/simulator.h"
+
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/servos.h"
+
+#include "io/gps.h"
+#include "io/gps_private.h"
+
+#include "msp/msp_protocol_v2_inav.h"
+#include "msp/msp_serial.h"
+
+#include "scheduler/scheduler.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "sensors/compass.h"
+#include "sensors/gyro.h"
+#include "sensors/sensors.h"
+
+// Returns true when the simulator is allowed to drive the sensors
+bool simulatorEnable(void)
+{
+    if (areSensorsCalibrating()) {
+        return false;
+    }
+
+    if (!ARMING_FLAG(SIMULATOR_MODE)) { // just once
+#ifdef USE_BARO
+        baroStartCalibration();
+#endif
+#ifdef USE_MAG
+        if (compassConfig()->mag_hardware != MAG_NONE) {
+            sensorsSet(SENSOR_MAG);
+            ENABLE_STATE(COMPASS_CALIBRATED);
+            DISABLE_ARMING_FLAG(ARMING_DISABLED_HARDWARE_FAILURE);
+            mag.magADC[X] = 800;
+            mag.magADC[Y] = 0;
+            mag.magADC[Z] = 0;
+        }
+#endif
+        ENABLE_ARMING_FLAG(SIMULATOR_MODE);
+        LOG_D(SYSTEM, "Simulator enabled");
+    }
+
+    return true;
+}
+
+void simulatorDisable(void)
+{
+    if (!ARMING_FLAG(SIMULATOR_MODE)) { // just once
+        return;
+    }
+
+    DISABLE_ARMING_FLAG(SIMULATOR_MODE);
+
+#ifdef USE_BARO
+    baroStartCalibration();
+#endif
+#ifdef USE_MAG
+    DISABLE_STATE(COMPASS_CALIBRATED);
+    compassInit();
+#endif
+    simulatorData.flags = 0;
+    //review: many states were affected. reboot?
+
+    disarm(DISARM_SWITCH);  //disarm to prevent motor output!!!
+}
+
+/*
+ * GPS block shared by MSP_SIMULATOR and the stream:
+ *  U8 fix type, U8 satellites, I32 lat, I32 lon, I32 alt [cm],
+ *  I16 ground speed [cm/s], I16 ground course [decidegrees], I16 velNED[3] [cm/s]
+ */
+void simulatorReadGps(sbuf_t *src, bool hasNewData)
+{
+    if (!feature(FEATURE_GPS) || !hasNewData) {
+        sbufAdvance(src, 1 + 1 + 4 + 4 + 4 + 2 + 2 + 2 * 3);
+        return;
+    }
+
+    gpsSol.fixType = sbufReadU8(src);
+    gpsSol.hdop = gpsSol.fixType == GPS_NO_FIX ? 9999 : 100;
+    gpsSol.flags.hasNewData = true;
+    gpsSol.numSat = sbufReadU8(src);
+
+    if (gpsSol.fixType != GPS_NO_FIX) {
+        gpsSol.flags.validVelNE = 1;
+        gpsSol.flags.validVelD = 1;
+        gpsSol.flags.validEPE = 1;
+
+        gpsSol.llh.lat = sbufReadU32(src);
+        gpsSol.llh.lon = sbufReadU32(src);
+        gpsSol.llh.alt = sbufReadU32(src);
+        gpsSol.groundSpeed = (int16_t)sbufReadU16(src);
+        gpsSol.groundCourse = (int16_t)sbufReadU16(src);
+
+        gpsSol.velNED[X] = (int16_t)sbufReadU16(src);
+        gpsSol.velNED[Y] = (int16_t)sbufReadU16(src);
+        gpsSol.velNED[Z] = (int16_t)sbufReadU16(src);
+
+        gpsSol.eph = 100;
+        gpsSol.epv = 100;
+
+        ENABLE_STATE(GPS_FIX);
+    } else {
+        sbufAdvance(src, 4 + 4 + 4 + 2 + 2 + 2 * 3);
+    }
+
+    // Feed data to navigation
+    gpsProcessNewSolutionData();
+}
+
+#ifdef USE_SIMULATOR_STREAM
+/*
+ * Streaming HITL. Instead of one MSP_SIMULATOR request per response the simulator pushes
+ * MSP2_INAV_SIMULATOR_STREAM sensor frames without expecting a reply, and the FC pushes actuator
+ * frames with the same command back to that MSP port at the rate the simulator asked for. Both
+ * directions carry sequence numbers, so either end can tell lost and reordered frames apart.
+ * The stream stops when no sensor frame came in for SIMULATOR_STREAM_TIMEOUT_US.
+ *
+ * Sensor frame:
+ *  U8 version, U16 sequence, U8 flags (simulatorFlags_t), U16 actuator frame rate [Hz],
+ *  U8 IMU sample count (1..SIMULATOR_STREAM_MAX_IMU_SAMPLES), then per sample
+ *      I16 gyro[3] [1/16 deg/s], I16 acc[3] [mG]
+ *  I16 attitude roll, pitch, yaw [decidegrees] (ignored with SIMU_USE_SENSORS),
+ *  U32 baro pressure [Pa], I16 mag[3], U8 battery voltage [0.1V], U16 airspeed [cm/s],
+ *  with SIMU_HAS_NEW_GPS_DATA the GPS block of MSP_SIMULATOR follows
+ *
+ * Actuator frame:
+ *  U8 version, U16 sequence, U16 last sensor sequence, U16 lost sensor frames, U16 late sensor frames,
+ *  U8 status (bit 0 armed, bit 1 airplane), I16 stabilized roll, pitch, yaw, throttle,
+ *  I16 attitude roll, pitch, yaw [decidegrees], U8 motor count, U16 motors, U8 servo count, U16 servos
+ */
+#define SIMULATOR_STREAM_HEADER_SIZE        7
+#define SIMULATOR_STREAM_IMU_SAMPLE_SIZE    12
+#define SIMULATOR_STREAM_SENSORS_SIZE       19
+#define SIMULATOR_STREAM_GPS_SIZE           24
+#define SIMULATOR_STREAM_ACTUATOR_SIZE      (24 + 1 + 2 * MAX_SUPPORTED_MOTORS + 1 + 2 * MAX_SUPPORTED_SERVOS)
+
+typedef struct simulatorStream_s {
+    mspPort_t *mspPort;
+    mspVersion_e mspVersion;
+    bool active;
+    uint16_t rateHz;
+    uint16_t sensorSequence;        // last accepted sensor frame
+    uint16_t actuatorSequence;      // next actuator frame
+    uint16_t lostFrames;
+    uint16_t lateFrames;
+    timeUs_t lastFrameUs;
+} simulatorStream_t;
+
+static simulatorStream_t stream;
+
+static void simulatorStreamStop(void)
+{
+    stream.active = false;
+    setTaskEnabled(TASK_SIMULATOR_STREAM, false);
+}
+
+bool simulatorStreamIsActive(void)
+{
+    return stream.active;
+}
+
+void simulatorStreamReceive(mspPort_t *mspPort, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) < SIMULATOR_STREAM_HEADER_SIZE || sbufReadU8(src) != SIMULATOR_STREAM_VERSION) {
+        return;
+    }
+
+    const uint16_t sequence = sbufReadU16(src);
+    const uint8_t flags = sbufReadU8(src);
+    const uint16_t rateHz = constrain(sbufReadU16(src), SIMULATOR_STREAM_MIN_RATE_HZ, SIMULATOR_STREAM_MAX_RATE_HZ);
+    const uint8_t imuSamples = sbufReadU8(src);
+    const int payloadSize = imuSamples * SIMULATOR_STREAM_IMU_SAMPLE_SIZE + SIMULATOR_STREAM_SENSORS_SIZE +
+        ((flags & SIMU_HAS_NEW_GPS_DATA) ? SIMULATOR_STREAM_GPS_SIZE : 0);
+
+    if (imuSamples == 0 || imuSamples > SIMULATOR_STREAM_MAX_IMU_SAMPLES || sbufBytesRemaining(src) < payloadSize) {
+        return;
+    }
+
+    if (stream.active && stream.mspPort == mspPort) {
+        // A frame that is not newer than the last one arrived out of order, applying it would step time back
+        const int16_t gap = (int16_t)(sequence - stream.sensorSequence);
+        if (gap <= 0) {
+            stream.lateFrames++;
+            return;
+        }
+        stream.lostFrames += gap - 1;
+    } else {
+        stream.lostFrames = 0;
+        stream.lateFrames = 0;
+        stream.actuatorSequence = 0;
+    }
+
+    stream.sensorSequence = sequence;
+    stream.lastFrameUs = micros();
+
+    simulatorData.flags = flags;
+    if ((flags & SIMU_ENABLE) == 0) {
+        simulatorDisable();
+        simulatorStreamStop();
+        return;
+    }
+
+    if (!simulatorEnable()) {
+        return;
+    }
+
+    // The simulator steps its physics faster than it sends, a batch is averaged like the gyro decimator does with real samples
+    int32_t gyroSum[XYZ_AXIS_COUNT] = { 0 };
+    int32_t accSum[XYZ_AXIS_COUNT] = { 0 };
+    for (int i = 0; i < imuSamples; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroSum[axis] += (int16_t)sbufReadU16(src);
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            accSum[axis] += (int16_t)sbufReadU16(src);
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyro.gyroADCf[axis] = gyroSum[axis] / (16.0f * imuSamples);
+        acc.accADCf[axis] = accSum[axis] / (1000.0f * imuSamples);   // acceleration in 1G units
+        acc.accVibeSq[axis] = 0;
+    }
+    sensorSampleCapture(&gyro.sample, stream.lastFrameUs, true);
+    sensorSampleCapture(&acc.sample, stream.lastFrameUs, true);
+
+    if ((flags & SIMU_USE_SENSORS) == 0) {
+        attitude.values.roll = (int16_t)sbufReadU16(src);
+        attitude.values.pitch = (int16_t)sbufReadU16(src);
+        attitude.values.yaw = (int16_t)sbufReadU16(src);
+    } else {
+        sbufAdvance(src, 2 * 3);
+    }
+
+    if (sensors(SENSOR_BARO)) {
+        baro.baroPressure = (int32_t)sbufReadU32(src);
+        baro.baroTemperature = 2500;
+    } else {
+        sbufAdvance(src, 4);
+    }
+
+    if (sensors(SENSOR_MAG)) {
+        mag.magADC[X] = ((int16_t)sbufReadU16(src)) / 20;  //16000/20 = 800uT
+        mag.magADC[Y] = ((int16_t)sbufReadU16(src)) / 20;
+        mag.magADC[Z] = ((int16_t)sbufReadU16(src)) / 20;
+    } else {
+        sbufAdvance(src, 2 * 3);
+    }
+
+    const uint8_t vbat = sbufReadU8(src);
+    simulatorData.vbat = (flags & SIMU_EXT_BATTERY_VOLTAGE) ? vbat : 126;
+    simulatorData.airSpeed = sbufReadU16(src);
+
+    if (flags & SIMU_HAS_NEW_GPS_DATA) {
+        simulatorReadGps(src, true);
+    }
+
+    if (!stream.active || stream.mspPort != mspPort || stream.rateHz != rateHz) {
+        stream.mspPort = mspPort;
+        stream.mspVersion = mspPort->mspVersion;
+        stream.rateHz = rateHz;
+        rescheduleTask(TASK_SIMULATOR_STREAM, TASK_PERIOD_HZ(rateHz));
+        setTaskEnabled(TASK_SIMULATOR_STREAM, true);
+        stream.active = true;
+    }
+}
+
+void taskSimulatorStream(timeUs_t currentTimeUs)
+{
+    if (!stream.active) {
+        return;
+    }
+
+    // Simulator went away, don't keep the link busy until it's back
+    if (cmpTimeUs(currentTimeUs, stream.lastFrameUs) > SIMULATOR_STREAM_TIMEOUT_US || !stream.mspPort->port) {
+        simulatorStreamStop();
+        return;
+    }
+
+    uint8_t buf[SIMULATOR_STREAM_ACTUATOR_SIZE];
+    sbuf_t sbuf = { .ptr = buf, .end = ARRAYEND(buf), };
+    sbuf_t *dst = &sbuf;
+
+    sbufWriteU8(dst, SIMULATOR_STREAM_VERSION);
+    sbufWriteU16(dst, stream.actuatorSequence);
+    sbufWriteU16(dst, stream.sensorSequence);
+    sbufWriteU16(dst, stream.lostFrames);
+    sbufWriteU16(dst, stream.lateFrames);
+    sbufWriteU8(dst, (ARMING_FLAG(ARMED) ? 1 : 0) | ((mixerConfig()->platformType == PLATFORM_AIRPLANE) ? 2 : 0));
+
+    sbufWriteU16(dst, (uint16_t)simulatorData.INPUT_STABILIZED_ROLL);
+    sbufWriteU16(dst, (uint16_t)simulatorData.INPUT_STABILIZED_PITCH);
+    sbufWriteU16(dst, (uint16_t)simulatorData.INPUT_STABILIZED_YAW);
+    sbufWriteU16(dst, (uint16_t)(ARMING_FLAG(ARMED) ? simulatorData.INPUT_STABILIZED_THROTTLE : -500));
+
+    sbufWriteU16(dst, attitude.values.roll);
+    sbufWriteU16(dst, attitude.values.pitch);
+    sbufWriteU16(dst, attitude.values.yaw);
+
+    const uint8_t motorCount = getMotorCount();
+    sbufWriteU8(dst, motorCount);
+    for (int i = 0; i < motorCount; i++) {
+        sbufWriteU16(dst, motor[i]);
+    }
+
+    const uint8_t servoCount = getServoCount();
+    sbufWriteU8(dst, servoCount);
+    for (int i = 0; i < servoCount; i++) {
+        sbufWriteU16(dst, servo[i]);
+    }
+
+    // A full TX buffer drops the frame, the gap in the sequence tells the simulator
+    mspSerialPushPort(MSP2_INAV_SIMULATOR_STREAM, buf, dst->ptr - buf, stream.mspPort, stream.mspVersion);
+    stream.actuatorSequence++;
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/streambuf.h"
+#include "common/time.h"
+
+#ifdef USE_SIMULATOR
+
+bool simulatorEnable(void);
+void simulatorDisable(void);
+void simulatorReadGps(sbuf_t *src, bool hasNewData);
+
+#ifdef USE_SIMULATOR_STREAM
+#define SIMULATOR_STREAM_VERSION            1
+#define SIMULATOR_STREAM_MAX_IMU_SAMPLES    8
+#define SIMULATOR_STREAM_MIN_RATE_HZ        50
+#define SIMULATOR_STREAM_MAX_RATE_HZ        1000
+#define SIMULATOR_STREAM_TIMEOUT_US         200000
+
+struct mspPort_s;
+void simulatorStreamReceive(struct mspPort_s *mspPort, sbuf_t *src);
+bool simulatorStreamIsActive(void);
+void taskSimulatorStream(timeUs_t currentTimeUs);
+#endif
+
+#endif
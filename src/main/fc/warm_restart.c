@@ -0,0 +1,197 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Warm restart: while armed a snapshot of the state that takes long to
+ * rebuild on the ground (gyro zero, attitude, home) is kept in the RTC backup
+ * registers. When a watchdog or brown-out reset hits in flight the snapshot
+ * survives, the boot skips gyro calibration and the system is re-armed at the
+ * end of init instead of falling out of the sky.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/crc.h"
+#include "common/maths.h"
+#include "common/quaternion.h"
+#include "common/utils.h"
+
+#include "drivers/persistent.h"
+#include "drivers/system.h"
+
+#include "fc/fc_core.h"
+#include "fc/rc_controls.h"
+#include "fc/runtime_config.h"
+#include "fc/warm_restart.h"
+
+#include "flight/failsafe.h"
+#include "flight/imu.h"
+
+#include "navigation/navigation.h"
+
+#include "sensors/gyro.h"
+
+#define WARM_RESTART_MAGIC          0x5752      // 'WR'
+#define WARM_RESTART_NO_HOME        0xFFFF
+
+#define WARM_RESTART_FIRST_OBJECT   PERSISTENT_OBJECT_WARM_GYRO_ZERO_XY
+#define WARM_RESTART_OBJECT_COUNT   (PERSISTENT_OBJECT_COUNT - WARM_RESTART_FIRST_OBJECT)
+
+typedef struct {
+    int16_t gyroZero[XYZ_AXIS_COUNT];
+    uint16_t homeHeading;                   // [centidegrees], WARM_RESTART_NO_HOME when home was not set
+    int16_t quat[4];                        // Attitude quaternion, scaled by INT16_MAX
+    int32_t homeLat;
+    int32_t homeLon;
+    int32_t homeAltOffset;                  // [cm] home altitude relative to the aircraft
+} warmRestartSnapshot_t;
+
+STATIC_ASSERT(sizeof(warmRestartSnapshot_t) == WARM_RESTART_OBJECT_COUNT * sizeof(uint32_t), warm_restart_snapshot_size);
+
+static warmRestartSnapshot_t snapshot;
+static bool snapshotStored = false;
+static bool restartPending = false;
+static bool homeRestorePending = false;
+
+static uint16_t warmRestartChecksum(const warmRestartSnapshot_t *s)
+{
+    return crc16_ccitt_update(0, s, sizeof(*s));
+}
+
+static bool warmRestartLoad(warmRestartSnapshot_t *s)
+{
+    const uint32_t header = persistentObjectRead(PERSISTENT_OBJECT_WARM_RESTART);
+    if ((header >> 16) != WARM_RESTART_MAGIC) {
+        return false;
+    }
+
+    uint32_t *words = (uint32_t *)s;
+    for (int i = 0; i < WARM_RESTART_OBJECT_COUNT; i++) {
+        words[i] = persistentObjectRead(WARM_RESTART_FIRST_OBJECT + i);
+    }
+
+    return (header & 0xFFFF) == warmRestartChecksum(s);
+}
+
+static void warmRestartStore(const warmRestartSnapshot_t *s)
+{
+    // Header goes last, a reset half way through leaves a checksum mismatch
+    const uint32_t *words = (const uint32_t *)s;
+    for (int i = 0; i < WARM_RESTART_OBJECT_COUNT; i++) {
+        persistentObjectWrite(WARM_RESTART_FIRST_OBJECT + i, words[i]);
+    }
+
+    persistentObjectWrite(PERSISTENT_OBJECT_WARM_RESTART, ((uint32_t)WARM_RESTART_MAGIC << 16) | warmRestartChecksum(s));
+    snapshotStored = true;
+}
+
+void warmRestartClear(void)
+{
+    if (snapshotStored || persistentObjectRead(PERSISTENT_OBJECT_WARM_RESTART) != 0) {
+        persistentObjectWrite(PERSISTENT_OBJECT_WARM_RESTART, 0);
+    }
+    snapshotStored = false;
+}
+
+void warmRestartInit(void)
+{
+    restartPending = armingConfig()->warm_restart && isMPUUnexpectedReset() && warmRestartLoad(&snapshot);
+
+    if (!restartPending) {
+        warmRestartClear();
+    }
+}
+
+bool warmRestartIsPending(void)
+{
+    return restartPending;
+}
+
+void warmRestartRestoreSensors(void)
+{
+    gyroRestoreCalibration(snapshot.gyroZero);
+
+    const fpQuaternion_t quat = {
+        .q0 = snapshot.quat[0] / (float)INT16_MAX,
+        .q1 = snapshot.quat[1] / (float)INT16_MAX,
+        .q2 = snapshot.quat[2] / (float)INT16_MAX,
+        .q3 = snapshot.quat[3] / (float)INT16_MAX,
+    };
+    imuRestoreOrientation(&quat);
+
+    homeRestorePending = snapshot.homeHeading != WARM_RESTART_NO_HOME;
+}
+
+void warmRestartResume(void)
+{
+    if (!restartPending) {
+        return;
+    }
+
+    restartPending = false;
+
+    // The RX may not come back, fail safe on it right away instead of after the power-on grace period
+    failsafeStartMonitoring();
+    armAfterWarmRestart();
+}
+
+static void warmRestartTakeSnapshot(void)
+{
+    gyroGetCalibration(snapshot.gyroZero);
+
+    snapshot.quat[0] = lrintf(constrainf(orientation.q0, -1.0f, 1.0f) * INT16_MAX);
+    snapshot.quat[1] = lrintf(constrainf(orientation.q1, -1.0f, 1.0f) * INT16_MAX);
+    snapshot.quat[2] = lrintf(constrainf(orientation.q2, -1.0f, 1.0f) * INT16_MAX);
+    snapshot.quat[3] = lrintf(constrainf(orientation.q3, -1.0f, 1.0f) * INT16_MAX);
+
+    // Keep the restored home in the snapshot until navigation could take it
+    if (!homeRestorePending) {
+        if (STATE(GPS_FIX_HOME)) {
+            snapshot.homeLat = GPS_home.lat;
+            snapshot.homeLon = GPS_home.lon;
+            snapshot.homeAltOffset = navigationGetHomeAltitudeOffset();
+            snapshot.homeHeading = navigationGetHomeHeading();
+        } else {
+            snapshot.homeHeading = WARM_RESTART_NO_HOME;
+        }
+    }
+}
+
+void warmRestartUpdate(void)
+{
+    if (!armingConfig()->warm_restart || !ARMING_FLAG(ARMED) || FLIGHT_MODE(TURTLE_MODE)) {
+        return;
+    }
+
+    if (homeRestorePending) {
+        const gpsLocation_t homeLLH = { .lat = snapshot.homeLat, .lon = snapshot.homeLon, .alt = 0 };
+        if (navigationRestoreHomePosition(&homeLLH, snapshot.homeAltOffset, snapshot.homeHeading)) {
+            homeRestorePending = false;
+        }
+    }
+
+    warmRestartTakeSnapshot();
+    warmRestartStore(&snapshot);
+}
@@ -22,9 +22,12 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
  */
 
+#include "platform.h"
+
 #include "flight/dynamic_lpf.h"
 #include "sensors/gyro.h"
 #include "flight/mixer.h"
+#include "flight/rpm_filter.h"
 #include "fc/rc_controls.h"
 #include "build/debug.h"
 
@@ -35,14 +38,32 @@ static float dynLpfCutoffFreq(float throttle, uint16_t dynLpfMin, uint16_t dynLp
     return (dynLpfMax - dynLpfMin) * curve + dynLpfMin;
 }
 
+/*
+ * Lowest motor fundamental when RPM telemetry is available, motor noise starts there.
+ * Throttle position otherwise
+ */
+static float dynLpfGetGyroCutoffFreq(void) {
+#ifdef USE_RPM_FILTER
+    const float motorFrequency = rpmFilterGetMinMotorFrequency();
+
+    DEBUG_SET(DEBUG_DYNAMIC_GYRO_LPF, 1, motorFrequency);
+
+    if (motorFrequency > 0.0f) {
+        return constrainf(motorFrequency, gyroConfig()->gyroDynamicLpfMinHz, gyroConfig()->gyroDynamicLpfMaxHz);
+    }
+#endif
+
+    const float throttle = scaleRangef((float) rcCommand[THROTTLE], getThrottleIdleValue(), motorConfig()->maxthrottle, 0.0f, 1.0f);
+    return dynLpfCutoffFreq(throttle, gyroConfig()->gyroDynamicLpfMinHz, gyroConfig()->gyroDynamicLpfMaxHz, gyroConfig()->gyroDynamicLpfCurveExpo);
+}
+
 void dynamicLpfGyroTask(void) {
 
     if (!gyroConfig()->useDynamicLpf) {
         return;
     }
 
-    const float throttle = scaleRangef((float) rcCommand[THROTTLE], getThrottleIdleValue(), motorConfig()->maxthrottle, 0.0f, 1.0f);
-    const float cutoffFreq = dynLpfCutoffFreq(throttle, gyroConfig()->gyroDynamicLpfMinHz, gyroConfig()->gyroDynamicLpfMaxHz, gyroConfig()->gyroDynamicLpfCurveExpo);
+    const float cutoffFreq = dynLpfGetGyroCutoffFreq();
 
     DEBUG_SET(DEBUG_DYNAMIC_GYRO_LPF, 0, cutoffFreq);
 
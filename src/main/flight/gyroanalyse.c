@@ -24,6 +24,7 @@
  * test pilots icr4sh, UAV Tech, Flint723
  */
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 FILE_COMPILE_FOR_SPEED
@@ -58,8 +59,7 @@ enum {
 // A sampling frequency of 1000 and max frequency of 500 at a window size of 32 gives 16 frequency bins each 31.25Hz wide
 // Eg [0,31), [31,62), [62, 93) etc
 // for gyro loop >= 4KHz, sample rate 2000 defines FFT range to 1000Hz, 16 bins each 62.5 Hz wide
-// NB  FFT_WINDOW_SIZE is set to 32 in gyroanalyse.h
-#define FFT_BIN_COUNT             (FFT_WINDOW_SIZE / 2)
+// NB  FFT window size is selected with fftWindowSize, bin count is half of it
 // smoothing frequency for FFT centre frequency
 #define DYN_NOTCH_SMOOTH_FREQ_HZ  25
 
@@ -70,27 +70,62 @@ enum {
  */
 #define FFT_SAMPLING_DENOMINATOR 2
 
+/*
+ * Sliding DFT damping factor. Keeps the recursive update stable against float rounding
+ */
+#define SDFT_DAMPING_FACTOR 0.9999f
+
 void gyroDataAnalyseStateInit(
     gyroAnalyseState_t *state, 
     uint16_t minFrequency,
+    uint16_t fftWindowSize,
+    uint8_t fftAveraging,
+    uint8_t engine,
     uint32_t targetLooptimeUs
 ) {
     state->minFrequency = minFrequency;
 
+    state->fftWindowSize = constrain(fftWindowSize, FFT_WINDOW_SIZE_MIN, FFT_WINDOW_SIZE_MAX);
+    state->fftBinCount = state->fftWindowSize / 2;
+
     state->fftSamplingRateHz = 1e6f / targetLooptimeUs / FFT_SAMPLING_DENOMINATOR;
     state->maxFrequency = state->fftSamplingRateHz / 2; //max possible frequency is half the sampling rate
-    state->fftResolution = (float)state->maxFrequency / FFT_BIN_COUNT;
+    state->fftResolution = (float)state->maxFrequency / state->fftBinCount;
 
-    state->fftStartBin = state->minFrequency / lrintf(state->fftResolution);
+    state->fftStartBin = state->minFrequency / MAX(lrintf(state->fftResolution), 1);
 
-    for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
-        state->hanningWindow[i] = (0.5f - 0.5f * cos_approx(2 * M_PIf * i / (FFT_WINDOW_SIZE - 1)));
+    for (int i = 0; i < state->fftWindowSize; i++) {
+        state->hanningWindow[i] = (0.5f - 0.5f * cos_approx(2 * M_PIf * i / (state->fftWindowSize - 1)));
     }
 
-    arm_rfft_fast_init_f32(&state->fftInstance, FFT_WINDOW_SIZE);
+    arm_rfft_fast_init_f32(&state->fftInstance, state->fftWindowSize);
+
+    /*
+     * Welch method: magnitude spectra of consecutive, overlapping windows are averaged.
+     * Running average over fftAveraging windows keeps the per-axis update rate unchanged
+     */
+    state->averagingGain = 1.0f / MAX(fftAveraging, 1);
+    memset(state->averagedSpectrum, 0, sizeof(state->averagedSpectrum));
+
+    /*
+     * Sliding DFT: X[k] = r * e^(j*2*pi*k/N) * (X[k] + x[n] - r^N * x[n-N])
+     * Only bins from fftStartBin are tracked, one extra on each side for the Hanning window
+     */
+    state->engine = engine;
+    state->sdftStartBin = state->fftStartBin > 0 ? state->fftStartBin - 1 : 0;
+    state->sdftDampingN = powf(SDFT_DAMPING_FACTOR, state->fftWindowSize);
+
+    for (int bin = 0; bin <= state->fftBinCount; bin++) {
+        const float phase = 2 * M_PIf * bin / state->fftWindowSize;
+        state->sdftTwiddle[bin].re = SDFT_DAMPING_FACTOR * cos_approx(phase);
+        state->sdftTwiddle[bin].im = SDFT_DAMPING_FACTOR * sin_approx(phase);
+    }
+    memset(state->sdftBins, 0, sizeof(state->sdftBins));
+    memset(state->fftData, 0, sizeof(state->fftData));
 
-    // Frequency filter is executed every 12 cycles. 4 steps per cycle, 3 axises
-    const uint32_t filterUpdateUs = targetLooptimeUs * STEP_COUNT * XYZ_AXIS_COUNT;
+    // FFT: frequency filter is executed every 12 cycles. 4 steps per cycle, 3 axises
+    // SDFT: one axis is updated every cycle
+    const uint32_t filterUpdateUs = targetLooptimeUs * (engine == DYNAMIC_NOTCH_ENGINE_SDFT ? 1 : STEP_COUNT) * XYZ_AXIS_COUNT;
 
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         
@@ -108,6 +143,25 @@ void gyroDataAnalysePush(gyroAnalyseState_t *state, const int axis, const float
 }
 
 static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state);
+static void gyroDataAnalyseSdftUpdate(gyroAnalyseState_t *state);
+
+/*
+ * Slide the DFT of every axis by one sample. Must be called before the oldest sample is overwritten
+ */
+static void gyroDataAnalyseSdftPush(gyroAnalyseState_t *state)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float delta = state->currentSample[axis] - state->sdftDampingN * state->downsampledGyroData[axis][state->circularBufferIdx];
+        sdftBin_t *bins = state->sdftBins[axis];
+
+        for (int bin = state->sdftStartBin; bin <= state->fftBinCount; bin++) {
+            const float re = bins[bin].re + delta;
+            const float im = bins[bin].im;
+            bins[bin].re = re * state->sdftTwiddle[bin].re - im * state->sdftTwiddle[bin].im;
+            bins[bin].im = re * state->sdftTwiddle[bin].im + im * state->sdftTwiddle[bin].re;
+        }
+    }
+}
 
 /*
  * Collect gyro data, to be analysed in gyroDataAnalyseUpdate function
@@ -119,21 +173,31 @@ void gyroDataAnalyse(gyroAnalyseState_t *state)
     static uint8_t samplingIndex = 0;
 
     if (samplingIndex == 0) {
+        if (state->engine == DYNAMIC_NOTCH_ENGINE_SDFT) {
+            gyroDataAnalyseSdftPush(state);
+        }
+
         // calculate mean value of accumulated samples
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             state->downsampledGyroData[axis][state->circularBufferIdx] = state->currentSample[axis];
         }
 
-        state->circularBufferIdx = (state->circularBufferIdx + 1) % FFT_WINDOW_SIZE;
+        state->circularBufferIdx = (state->circularBufferIdx + 1) % state->fftWindowSize;
     }
 
     samplingIndex = (samplingIndex + 1) % FFT_SAMPLING_DENOMINATOR;
 
-    gyroDataAnalyseUpdate(state);
+    if (state->engine == DYNAMIC_NOTCH_ENGINE_SDFT) {
+        gyroDataAnalyseSdftUpdate(state);
+    } else {
+        gyroDataAnalyseUpdate(state);
+    }
 }
 
 void stage_rfft_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut);
+void arm_cfft_radix8by2_f32(arm_cfft_instance_f32 *S, float32_t *p1);
 void arm_cfft_radix8by4_f32(arm_cfft_instance_f32 *S, float32_t *p1);
+void arm_radix8_butterfly_f32(float32_t *pSrc, uint16_t fftLen, const float32_t *pCoef, uint16_t twidCoefModifier);
 void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable);
 
 static float computeParabolaMean(gyroAnalyseState_t *state, uint8_t peakBinIndex) {
@@ -155,7 +219,93 @@ static float computeParabolaMean(gyroAnalyseState_t *state, uint8_t peakBinIndex
 }
 
 /*
- * Analyse last gyro data from the last FFT_WINDOW_SIZE milliseconds
+ * Average spectrum in fftData and find DYN_NOTCH_PEAK_COUNT biggest peaks in it
+ */
+static void gyroDataAnalyseFindPeaks(gyroAnalyseState_t *state)
+{
+    // Kept also without averaging (gain 1), gyroDataAnalyseGetMagnitude() reads it
+    float *averagedSpectrum = state->averagedSpectrum[state->updateAxis];
+    for (int bin = 0; bin < state->fftBinCount; bin++) {
+        averagedSpectrum[bin] += (state->fftData[bin] - averagedSpectrum[bin]) * state->averagingGain;
+        state->fftData[bin] = averagedSpectrum[bin];
+    }
+
+    //Zero the data structure
+    for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
+        state->peaks[i].bin = 0;
+        state->peaks[i].value = 0.0f;
+    }
+
+    // Find peaks
+    for (int bin = (state->fftStartBin + 1); bin < state->fftBinCount - 1; bin++) {
+        /*
+         * Peak is defined if the current bin is greater than the previous bin and the next bin
+         */
+        if (
+            state->fftData[bin] > state->fftData[bin - 1] && 
+            state->fftData[bin] > state->fftData[bin + 1]
+        ) {
+            /*
+             * We are only interested in N biggest peaks
+             * Check previously found peaks and update the structure if necessary
+             */
+            for (int p = 0; p < DYN_NOTCH_PEAK_COUNT; p++) {
+                if (state->fftData[bin] > state->peaks[p].value) {
+                    for (int k = DYN_NOTCH_PEAK_COUNT - 1; k > p; k--) {
+                        state->peaks[k] = state->peaks[k - 1];
+                    }
+                    state->peaks[p].bin = bin;
+                    state->peaks[p].value = state->fftData[bin];
+                    break;
+                }
+            }
+            bin++; // If bin is peak, next bin can't be peak => jump it
+        }
+    }
+
+    // Sort N biggest peaks in ascending bin order (example: 3, 8, 25, 0, 0, ..., 0)
+    for (int p = DYN_NOTCH_PEAK_COUNT - 1; p > 0; p--) {
+        for (int k = 0; k < p; k++) {
+            // Swap peaks but ignore swapping void peaks (bin = 0). This leaves
+            // void peaks at the end of peaks array without moving them
+            if (state->peaks[k].bin > state->peaks[k + 1].bin && state->peaks[k + 1].bin != 0) {
+                peak_t temp = state->peaks[k];
+                state->peaks[k] = state->peaks[k + 1];
+                state->peaks[k + 1] = temp;
+            }
+        }
+    }
+}
+
+/*
+ * Convert peaks to frequencies of updateAxis and request filter update
+ */
+static void gyroDataAnalyseUpdateFrequencies(gyroAnalyseState_t *state)
+{
+    /*
+     * Update frequencies
+     */
+    for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
+
+        if (state->peaks[i].bin > 0) {
+            const int bin = constrain(state->peaks[i].bin, state->fftStartBin, state->fftBinCount - 1);
+            float frequency = computeParabolaMean(state, bin) * state->fftResolution;
+
+            state->centerFrequency[state->updateAxis][i] = pt1FilterApply(&state->detectedFrequencyFilter[state->updateAxis][i], frequency);
+        } else {
+            state->centerFrequency[state->updateAxis][i] = 0.0f;
+        }
+    }
+
+    /*
+     * Filters will be updated inside dynamicGyroNotchFiltersUpdate()
+     */
+    state->filterUpdateExecute = true;
+    state->filterUpdateAxis = state->updateAxis;
+}
+
+/*
+ * Analyse last gyro data from the last fftWindowSize samples
  */
 static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
 {
@@ -165,8 +315,18 @@ static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
     switch (state->updateStep) {
         case STEP_ARM_CFFT_F32:
         {
-            // Important this works only with FFT windows size of 64 elements!
-            arm_cfft_radix8by4_f32(Sint, state->fftData);
+            // Same kernel selection as arm_cfft_f32(), real FFT of N points is a complex FFT of N/2 points
+            switch (Sint->fftLen) {
+                case 32:
+                    arm_cfft_radix8by4_f32(Sint, state->fftData);
+                    break;
+                case 64:
+                    arm_radix8_butterfly_f32(state->fftData, Sint->fftLen, Sint->pTwiddle, 1);
+                    break;
+                case 128:
+                    arm_cfft_radix8by2_f32(Sint, state->fftData);
+                    break;
+            }
             break;
         }
         case STEP_BITREVERSAL_AND_STAGE_RFFT_F32:
@@ -178,90 +338,72 @@ static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
         case STEP_MAGNITUDE_AND_FREQUENCY:
         {
             // 8us
-            arm_cmplx_mag_f32(state->rfftData, state->fftData, FFT_BIN_COUNT);
+            arm_cmplx_mag_f32(state->rfftData, state->fftData, state->fftBinCount);
 
-            //Zero the data structure
-            for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-                state->peaks[i].bin = 0;
-                state->peaks[i].value = 0.0f;
-            }
-
-            // Find peaks
-            for (int bin = (state->fftStartBin + 1); bin < FFT_BIN_COUNT - 1; bin++) {
-                /*
-                 * Peak is defined if the current bin is greater than the previous bin and the next bin
-                 */
-                if (
-                    state->fftData[bin] > state->fftData[bin - 1] && 
-                    state->fftData[bin] > state->fftData[bin + 1]
-                ) {
-                    /*
-                     * We are only interested in N biggest peaks
-                     * Check previously found peaks and update the structure if necessary
-                     */
-                    for (int p = 0; p < DYN_NOTCH_PEAK_COUNT; p++) {
-                        if (state->fftData[bin] > state->peaks[p].value) {
-                            for (int k = DYN_NOTCH_PEAK_COUNT - 1; k > p; k--) {
-                                state->peaks[k] = state->peaks[k - 1];
-                            }
-                            state->peaks[p].bin = bin;
-                            state->peaks[p].value = state->fftData[bin];
-                            break;
-                        }
-                    }
-                    bin++; // If bin is peak, next bin can't be peak => jump it
-                }
-            }
-
-            // Sort N biggest peaks in ascending bin order (example: 3, 8, 25, 0, 0, ..., 0)
-            for (int p = DYN_NOTCH_PEAK_COUNT - 1; p > 0; p--) {
-                for (int k = 0; k < p; k++) {
-                    // Swap peaks but ignore swapping void peaks (bin = 0). This leaves
-                    // void peaks at the end of peaks array without moving them
-                    if (state->peaks[k].bin > state->peaks[k + 1].bin && state->peaks[k + 1].bin != 0) {
-                        peak_t temp = state->peaks[k];
-                        state->peaks[k] = state->peaks[k + 1];
-                        state->peaks[k + 1] = temp;
-                    }
-                }
-            }
+            gyroDataAnalyseFindPeaks(state);
 
             break;
         }
         case STEP_UPDATE_FILTERS_AND_HANNING:
         {
 
-            /*
-             * Update frequencies
-             */
-            for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-
-                if (state->peaks[i].bin > 0) {
-                    const int bin = constrain(state->peaks[i].bin, state->fftStartBin, FFT_BIN_COUNT - 1);
-                    float frequency = computeParabolaMean(state, bin) * state->fftResolution;
-
-                    state->centerFrequency[state->updateAxis][i] = pt1FilterApply(&state->detectedFrequencyFilter[state->updateAxis][i], frequency);
-                } else {
-                    state->centerFrequency[state->updateAxis][i] = 0.0f;
-                }
-            }
-
-            /*
-             * Filters will be updated inside dynamicGyroNotchFiltersUpdate()
-             */
-            state->filterUpdateExecute = true;
-            state->filterUpdateAxis = state->updateAxis;
+            gyroDataAnalyseUpdateFrequencies(state);
 
             //Switch to the next axis
             state->updateAxis = (state->updateAxis + 1) % XYZ_AXIS_COUNT;
             
             // apply hanning window to gyro samples and store result in fftData
-            // hanning starts and ends with 0, could be skipped for minor speed improvement
-            arm_mult_f32(state->downsampledGyroData[state->updateAxis], state->hanningWindow, state->fftData, FFT_WINDOW_SIZE);
+            // circular buffer is unrolled so the window starts at the oldest sample
+            float *gyroData = state->downsampledGyroData[state->updateAxis];
+            const uint16_t oldestSampleCount = state->fftWindowSize - state->circularBufferIdx;
+            arm_mult_f32(&gyroData[state->circularBufferIdx], state->hanningWindow, state->fftData, oldestSampleCount);
+            if (state->circularBufferIdx) {
+                arm_mult_f32(gyroData, &state->hanningWindow[oldestSampleCount], &state->fftData[oldestSampleCount], state->circularBufferIdx);
+            }
         }
     }
 
     state->updateStep = (state->updateStep + 1) % STEP_COUNT;
 }
 
+/*
+ * Sliding DFT bins are already up to date, only the Hanning window and peak search
+ * are left. One axis per call keeps the cost constant
+ */
+static NOINLINE void gyroDataAnalyseSdftUpdate(gyroAnalyseState_t *state)
+{
+    const sdftBin_t *bins = state->sdftBins[state->updateAxis];
+
+    // Hanning window in frequency domain: Y[k] = 0.5 * X[k] - 0.25 * (X[k - 1] + X[k + 1])
+    for (int bin = MAX(state->fftStartBin, 1); bin < state->fftBinCount; bin++) {
+        const float re = 0.5f * bins[bin].re - 0.25f * (bins[bin - 1].re + bins[bin + 1].re);
+        const float im = 0.5f * bins[bin].im - 0.25f * (bins[bin - 1].im + bins[bin + 1].im);
+        state->fftData[bin] = sqrtf(re * re + im * im);
+    }
+
+    gyroDataAnalyseFindPeaks(state);
+    gyroDataAnalyseUpdateFrequencies(state);
+
+    state->updateAxis = (state->updateAxis + 1) % XYZ_AXIS_COUNT;
+}
+
+/*
+ * Largest spectrum magnitude of all axes at the given frequency, negative when outside of the analysed band
+ */
+float gyroDataAnalyseGetMagnitude(const gyroAnalyseState_t *state, float frequencyHz)
+{
+    const int bin = lrintf(frequencyHz / state->fftResolution);
+
+    if (bin < state->fftStartBin || bin >= state->fftBinCount) {
+        return -1.0f;
+    }
+
+    float magnitude = 0.0f;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magnitude = MAX(magnitude, state->averagedSpectrum[axis][bin]);
+    }
+
+    return magnitude;
+}
+
 #endif // USE_DYNAMIC_FILTERS
@@ -26,31 +26,53 @@
 #include "common/filter.h"
 
 /*
- * Current code works only with 64 window size. Changing it do a different size would require
- * adapting the gyroDataAnalyseUpdate in STEP_ARM_CFFT_F32 step
+ * FFT window size is selected at runtime with dynamic_gyro_notch_fft_size.
+ * 256 samples are available only on F7/H7 where the state fits in DTCM
  */
-#define FFT_WINDOW_SIZE 64
+#define FFT_WINDOW_SIZE_MIN 64
+#if defined(STM32F7) || defined(STM32H7)
+#define FFT_WINDOW_SIZE_MAX 256
+#else
+#define FFT_WINDOW_SIZE_MAX 128
+#endif
+#define FFT_BIN_COUNT_MAX   (FFT_WINDOW_SIZE_MAX / 2)
 
 typedef struct peak_s {
     int bin;
     float value;
 } peak_t;
 
+typedef struct sdftBin_s {
+    float re;
+    float im;
+} sdftBin_t;
+
 typedef struct gyroAnalyseState_s {
     // accumulator for oversampled data => no aliasing and less noise
     float currentSample[XYZ_AXIS_COUNT];
 
     // downsampled gyro data circular buffer for frequency analysis
-    uint8_t circularBufferIdx;
-    float downsampledGyroData[XYZ_AXIS_COUNT][FFT_WINDOW_SIZE];
+    uint16_t circularBufferIdx;
+    float downsampledGyroData[XYZ_AXIS_COUNT][FFT_WINDOW_SIZE_MAX];
 
     // update state machine step information
     uint8_t updateStep;
     uint8_t updateAxis;
 
     arm_rfft_fast_instance_f32 fftInstance;
-    float fftData[FFT_WINDOW_SIZE];
-    float rfftData[FFT_WINDOW_SIZE];
+    float fftData[FFT_WINDOW_SIZE_MAX];
+    float rfftData[FFT_WINDOW_SIZE_MAX];
+
+    // Welch averaged magnitude spectrum of overlapping windows
+    float averagedSpectrum[XYZ_AXIS_COUNT][FFT_BIN_COUNT_MAX];
+    float averagingGain;
+
+    // Sliding DFT engine, bins are updated from every downsampled gyro sample
+    uint8_t engine;
+    uint8_t sdftStartBin;
+    float sdftDampingN;
+    sdftBin_t sdftTwiddle[FFT_BIN_COUNT_MAX + 1];
+    sdftBin_t sdftBins[XYZ_AXIS_COUNT][FFT_BIN_COUNT_MAX + 1];
 
     pt1Filter_t detectedFrequencyFilter[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
     float centerFrequency[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
@@ -61,6 +83,8 @@ typedef struct gyroAnalyseState_s {
     uint8_t filterUpdateAxis;
     uint16_t filterUpdateFrequency;
 
+    uint16_t fftWindowSize;
+    uint16_t fftBinCount;
     uint16_t fftSamplingRateHz;
     uint8_t fftStartBin;
     float fftResolution;
@@ -68,16 +92,23 @@ typedef struct gyroAnalyseState_s {
     uint16_t maxFrequency;
 
     // Hanning window, see https://en.wikipedia.org/wiki/Window_function#Hann_.28Hanning.29_window
-    float hanningWindow[FFT_WINDOW_SIZE];
+    float hanningWindow[FFT_WINDOW_SIZE_MAX];
 } gyroAnalyseState_t;
 
-STATIC_ASSERT(FFT_WINDOW_SIZE <= (uint8_t) -1, window_size_greater_than_underlying_type);
+STATIC_ASSERT(FFT_WINDOW_SIZE_MAX <= (uint16_t) -1, window_size_greater_than_underlying_type);
+STATIC_ASSERT(FFT_BIN_COUNT_MAX <= (uint8_t) -1, bin_count_greater_than_start_bin_type);
 
 void gyroDataAnalyseStateInit(
     gyroAnalyseState_t *state, 
     uint16_t minFrequency,
+    uint16_t fftWindowSize,
+    uint8_t fftAveraging,
+    uint8_t engine,
     uint32_t targetLooptimeUs
 );
 void gyroDataAnalysePush(gyroAnalyseState_t *gyroAnalyse, int axis, float sample);
 void gyroDataAnalyse(gyroAnalyseState_t *gyroAnalyse);
+float gyroDataAnalyseGetMagnitude(const gyroAnalyseState_t *gyroAnalyse, float frequencyHz);
+
+extern gyroAnalyseState_t gyroAnalyseState;
 #endif
\ No newline at end of file
@@ -50,6 +50,7 @@ FILE_COMPILE_FOR_SPEED
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/secondary_imu.h"
 
 #include "io/gps.h"
 
@@ -80,17 +81,35 @@ FASTRAM fpVector3_t imuMeasuredRotationBF;
 STATIC_FASTRAM float smallAngleCosZ;
 
 STATIC_FASTRAM bool isAccelUpdatedAtLeastOnce;
+STATIC_FASTRAM bool isAccelSampleNew;                      // accUpdate() delivered a new averaged sample this loop
 STATIC_FASTRAM fpVector3_t vCorrectedMagNorth;             // Magnetic North vector in EF (true North rotated by declination)
 
 FASTRAM fpQuaternion_t orientation;
 FASTRAM attitudeEulerAngles_t attitude;             // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
-FASTRAM float rMat[3][3];
+STATIC_FASTRAM fpMat3_t rMat;                       // Computed from orientation when asked for
+STATIC_FASTRAM bool rMatValid;
 
 STATIC_FASTRAM imuRuntimeConfig_t imuRuntimeConfig;
 STATIC_FASTRAM pt1Filter_t rotRateFilter;
 
 STATIC_FASTRAM bool gpsHeadingInitialized;
 
+STATIC_FASTRAM fpVector3_t vGyroDriftEstimate;
+STATIC_FASTRAM fpVector3_t vCorrectionRate;         // Feedback of the correction step, applied by every propagation step
+
+#ifdef USE_SECONDARY_IMU
+#define IMU2_HISTORY_SIZE           16      // 64ms at IMU_CORRECTION_RATE_HZ, longer than the secondary IMU latency
+
+typedef struct {
+    fpQuaternion_t orientation;
+    timeUs_t timeUs;
+} imuOrientationSample_t;
+
+static imuOrientationSample_t imu2History[IMU2_HISTORY_SIZE];
+static uint8_t imu2HistoryHead;
+static timeUs_t imu2LastFusedSampleUs;
+#endif
+
 PG_REGISTER_WITH_RESET_TEMPLATE(imuConfig_t, imuConfig, PG_IMU_CONFIG, 2);
 
 PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
@@ -103,7 +122,7 @@ PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
     .acc_ignore_slope = SETTING_IMU_ACC_IGNORE_SLOPE_DEFAULT
 );
 
-STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
+static void imuComputeRotationMatrix(void)
 {
     float q1q1 = orientation.q1 * orientation.q1;
     float q2q2 = orientation.q2 * orientation.q2;
@@ -116,17 +135,29 @@ STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
     float q1q3 = orientation.q1 * orientation.q3;
     float q2q3 = orientation.q2 * orientation.q3;
 
-    rMat[0][0] = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
-    rMat[0][1] = 2.0f * (q1q2 + -q0q3);
-    rMat[0][2] = 2.0f * (q1q3 - -q0q2);
+    rMat.m[0][0] = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
+    rMat.m[0][1] = 2.0f * (q1q2 + -q0q3);
+    rMat.m[0][2] = 2.0f * (q1q3 - -q0q2);
+
+    rMat.m[1][0] = 2.0f * (q1q2 - -q0q3);
+    rMat.m[1][1] = 1.0f - 2.0f * q1q1 - 2.0f * q3q3;
+    rMat.m[1][2] = 2.0f * (q2q3 + -q0q1);
 
-    rMat[1][0] = 2.0f * (q1q2 - -q0q3);
-    rMat[1][1] = 1.0f - 2.0f * q1q1 - 2.0f * q3q3;
-    rMat[1][2] = 2.0f * (q2q3 + -q0q1);
+    rMat.m[2][0] = 2.0f * (q1q3 + -q0q2);
+    rMat.m[2][1] = 2.0f * (q2q3 - -q0q1);
+    rMat.m[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
+
+    rMatValid = true;
+}
+
+const fpMat3_t * imuGetRotationMatrix(void)
+{
+    // Consumers of the whole matrix run far slower than the PID loop, compute it on demand
+    if (!rMatValid) {
+        imuComputeRotationMatrix();
+    }
 
-    rMat[2][0] = 2.0f * (q1q3 + -q0q2);
-    rMat[2][1] = 2.0f * (q2q3 - -q0q1);
-    rMat[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
+    return &rMat;
 }
 
 void imuConfigure(void)
@@ -148,7 +179,10 @@ void imuInit(void)
 
     // Explicitly initialize FASTRAM statics
     isAccelUpdatedAtLeastOnce = false;
+    isAccelSampleNew = false;
     gpsHeadingInitialized = false;
+    vectorZero(&vGyroDriftEstimate);
+    vectorZero(&vCorrectionRate);
 
     // Create magnetic declination matrix
 #ifdef USE_MAG
@@ -161,12 +195,24 @@ void imuInit(void)
     imuSetMagneticDeclination(deg + min / 60.0f);
 
     quaternionInitUnit(&orientation);
-    imuComputeRotationMatrix();
+    rMatValid = false;
 
     // Initialize rotation rate filter
     pt1FilterReset(&rotRateFilter, 0);
 }
 
+// Start from the attitude captured before an unexpected reset
+void imuRestoreOrientation(const fpQuaternion_t *quat)
+{
+    const float normSq = quaternionNormSqared(quat);
+    if (isnan(normSq) || normSq < 0.5f || normSq > 1.5f) {
+        return;
+    }
+
+    quaternionScale(&orientation, quat, 1.0f / fast_fsqrtf(normSq));
+    rMatValid = false;
+}
+
 void imuSetMagneticDeclination(float declinationDeg)
 {
     const float declinationRad = -DEGREES_TO_RADIANS(declinationDeg);
@@ -193,28 +239,37 @@ void imuTransformVectorEarthToBody(fpVector3_t * v)
     quaternionRotateVector(v, v, &orientation);
 }
 
-#if defined(USE_GPS)
-STATIC_UNIT_TESTED void imuComputeQuaternionFromRPY(int16_t initialRoll, int16_t initialPitch, int16_t initialYaw)
+#if defined(USE_GPS) || defined(USE_SECONDARY_IMU)
+static void imuQuaternionFromRPY(fpQuaternion_t * quat, int16_t initialRoll, int16_t initialPitch, int16_t initialYaw)
 {
     if (initialRoll > 1800) initialRoll -= 3600;
     if (initialPitch > 1800) initialPitch -= 3600;
     if (initialYaw > 1800) initialYaw -= 3600;
 
-    const float cosRoll = cos_approx(DECIDEGREES_TO_RADIANS(initialRoll) * 0.5f);
-    const float sinRoll = sin_approx(DECIDEGREES_TO_RADIANS(initialRoll) * 0.5f);
-
-    const float cosPitch = cos_approx(DECIDEGREES_TO_RADIANS(initialPitch) * 0.5f);
-    const float sinPitch = sin_approx(DECIDEGREES_TO_RADIANS(initialPitch) * 0.5f);
-
-    const float cosYaw = cos_approx(DECIDEGREES_TO_RADIANS(-initialYaw) * 0.5f);
-    const float sinYaw = sin_approx(DECIDEGREES_TO_RADIANS(-initialYaw) * 0.5f);
-
-    orientation.q0 = cosRoll * cosPitch * cosYaw + sinRoll * sinPitch * sinYaw;
-    orientation.q1 = sinRoll * cosPitch * cosYaw - cosRoll * sinPitch * sinYaw;
-    orientation.q2 = cosRoll * sinPitch * cosYaw + sinRoll * cosPitch * sinYaw;
-    orientation.q3 = cosRoll * cosPitch * sinYaw - sinRoll * sinPitch * cosYaw;
+    const float halfAngles[3] = {
+        DECIDEGREES_TO_RADIANS(initialRoll) * 0.5f,
+        DECIDEGREES_TO_RADIANS(initialPitch) * 0.5f,
+        DECIDEGREES_TO_RADIANS(-initialYaw) * 0.5f,
+    };
+    float s[3], c[3];
+    sincos_approx_array(halfAngles, s, c, 3);
+
+    const float cosRoll = c[0], sinRoll = s[0];
+    const float cosPitch = c[1], sinPitch = s[1];
+    const float cosYaw = c[2], sinYaw = s[2];
+
+    quat->q0 = cosRoll * cosPitch * cosYaw + sinRoll * sinPitch * sinYaw;
+    quat->q1 = sinRoll * cosPitch * cosYaw - cosRoll * sinPitch * sinYaw;
+    quat->q2 = cosRoll * sinPitch * cosYaw + sinRoll * cosPitch * sinYaw;
+    quat->q3 = cosRoll * cosPitch * sinYaw - sinRoll * sinPitch * cosYaw;
+}
+#endif
 
-    imuComputeRotationMatrix();
+#if defined(USE_GPS)
+STATIC_UNIT_TESTED void imuComputeQuaternionFromRPY(int16_t initialRoll, int16_t initialPitch, int16_t initialYaw)
+{
+    imuQuaternionFromRPY(&orientation, initialRoll, initialPitch, initialYaw);
+    rMatValid = false;
 }
 #endif
 
@@ -261,13 +316,8 @@ static bool imuValidateQuaternion(const fpQuaternion_t * quat)
     return false;
 }
 
-static void imuCheckAndResetOrientationQuaternion(const fpQuaternion_t * quat, const fpVector3_t * accBF)
+static void imuResetInvalidOrientationQuaternion(const fpQuaternion_t * quat, const fpVector3_t * accBF)
 {
-    // Check if some calculation in IMU update yield NAN or zero quaternion
-    if (imuValidateQuaternion(&orientation)) {
-        return;
-    }
-
     flightLogEvent_IMUError_t imuErrorEvent;
 
     // Orientation is invalid. We need to reset it
@@ -291,15 +341,18 @@ static void imuCheckAndResetOrientationQuaternion(const fpQuaternion_t * quat, c
 #endif
 }
 
-static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, bool useCOG, float courseOverGround, float accWScaler, float magWScaler)
+/*
+ * The Mahony filter is split in two steps. The correction step compares the orientation
+ * with the acc, mag and COG references and updates the feedback rate, it runs in
+ * TASK_AHRS at IMU_CORRECTION_RATE_HZ since acc is heavily filtered and mag and GPS are
+ * much slower still. The propagation step integrates gyro and feedback at PID rate.
+ */
+STATIC_UNIT_TESTED void imuMahonyAHRSCorrection(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, bool useCOG, float courseOverGround, float accWScaler, float magWScaler)
 {
-    STATIC_FASTRAM fpVector3_t vGyroDriftEstimate = { 0 };
-
-    fpQuaternion_t prevOrientation = orientation;
-    fpVector3_t vRotation = *gyroBF;
+    fpVector3_t vRotation = { .v = { 0.0f, 0.0f, 0.0f } };
 
     /* Calculate general spin rate (rad/s) */
-    const float spin_rate_sq = vectorNormSquared(&vRotation);
+    const float spin_rate_sq = vectorNormSquared(gyroBF);
 
     /* Step 1: Yaw correction */
     // Use measured magnetic field vector
@@ -352,7 +405,9 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
             // (-cos(COG), sin(COG)) - reference heading vector (EF)
 
             // Compute heading vector in EF from scalar CoG
-            fpVector3_t vCoG = { .v = { -cos_approx(courseOverGround), sin_approx(courseOverGround), 0.0f } };
+            float sinCoG, cosCoG;
+            sincos_approx(courseOverGround, &sinCoG, &cosCoG);
+            fpVector3_t vCoG = { .v = { -cosCoG, sinCoG, 0.0f } };
 
             // Rotate Forward vector from BF to EF - will yield Heading vector in Earth frame
             quaternionRotateVectorInv(&vHeadingEF, &vForward, &orientation);
@@ -419,7 +474,92 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
     }
 
     // Apply gyro drift correction
-    vectorAdd(&vRotation, &vRotation, &vGyroDriftEstimate);
+    vectorAdd(&vCorrectionRate, &vRotation, &vGyroDriftEstimate);
+}
+
+#ifdef USE_SECONDARY_IMU
+static void imuSecondaryStoreHistory(timeUs_t currentTimeUs)
+{
+    imu2History[imu2HistoryHead].orientation = orientation;
+    imu2History[imu2HistoryHead].timeUs = currentTimeUs;
+    imu2HistoryHead = (imu2HistoryHead + 1) % IMU2_HISTORY_SIZE;
+}
+
+/*
+ * Orientation estimate as it was when the secondary IMU sample was taken,
+ * NULL if the sample is older than the history
+ */
+static const fpQuaternion_t * imuSecondaryFindHistory(timeUs_t sampleTimeUs)
+{
+    for (int i = 1; i <= IMU2_HISTORY_SIZE; i++) {
+        const imuOrientationSample_t * sample = &imu2History[(imu2HistoryHead + IMU2_HISTORY_SIZE - i) % IMU2_HISTORY_SIZE];
+
+        if (sample->timeUs == 0) {
+            break;
+        }
+
+        if (cmpTimeUs(sample->timeUs, sampleTimeUs) <= 0) {
+            return &sample->orientation;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * The secondary IMU attitude is used as an additional reference: gravity and north
+ * are rotated into body frame once by the secondary attitude and once by our own
+ * estimate at the time of the sample. Comparing against the delayed estimate keeps
+ * the sensor latency out of the error, the BNO055 output lags by tens of ms.
+ */
+static void imuSecondaryImuCorrection(void)
+{
+    const timeUs_t sampleTimeUs = secondaryImuState.sampleTimeUs;
+
+    if (!secondaryImuConfig()->useForFusion || !isSecondaryImuHealthy() || sampleTimeUs == imu2LastFusedSampleUs) {
+        return;
+    }
+
+    imu2LastFusedSampleUs = sampleTimeUs;
+
+    const fpQuaternion_t * estimated = imuSecondaryFindHistory(sampleTimeUs);
+    if (!estimated) {
+        return;
+    }
+
+    static const fpVector3_t vGravity = { .v = { 0.0f, 0.0f, 1.0f } };
+    static const fpVector3_t vNorth = { .v = { 1.0f, 0.0f, 0.0f } };
+    fpQuaternion_t measured;
+    fpVector3_t vMeas, vEst, vErr;
+
+    imuQuaternionFromRPY(&measured, secondaryImuState.eulerAngles.values.roll, secondaryImuState.eulerAngles.values.pitch, secondaryImuState.eulerAngles.values.yaw);
+
+    const float pGainScale = imuGetPGainScaleFactor();
+
+    // Roll and pitch, weighted like the accelerometer
+    quaternionRotateVector(&vMeas, &vGravity, &measured);
+    quaternionRotateVector(&vEst, &vGravity, estimated);
+    vectorCrossProduct(&vErr, &vMeas, &vEst);
+    vectorScale(&vErr, &vErr, imuRuntimeConfig.dcm_kp_acc * pGainScale);
+    vectorAdd(&vCorrectionRate, &vCorrectionRate, &vErr);
+
+    // Heading only once the BNO055 magnetometer is calibrated
+    if (secondaryImuState.calibrationStatus.mag >= 2) {
+        quaternionRotateVector(&vMeas, &vNorth, &measured);
+        quaternionRotateVector(&vEst, &vNorth, estimated);
+        vectorCrossProduct(&vErr, &vMeas, &vEst);
+        vectorScale(&vErr, &vErr, imuRuntimeConfig.dcm_kp_mag * pGainScale);
+        vectorAdd(&vCorrectionRate, &vCorrectionRate, &vErr);
+    }
+}
+#endif
+
+STATIC_UNIT_TESTED void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF)
+{
+    fpQuaternion_t prevOrientation = orientation;
+    fpVector3_t vRotation;
+
+    vectorAdd(&vRotation, gyroBF, &vCorrectionRate);
 
     // Integrate rate of change of quaternion
     fpVector3_t vTheta;
@@ -436,26 +576,32 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
         // Proper quaternion from axis/angle involves computing sin/cos, but the formula becomes numerically unstable as Theta approaches zero.
         // For near-zero cases we use the first 3 terms of the Taylor series expansion for sin/cos. We check if fourth term is less than machine precision -
         // then we can safely use the "low angle" approximated version without loss of accuracy.
-        if (thetaMagnitudeSq < fast_fsqrtf(24.0f * 1e-6f)) {
+        if (thetaMagnitudeSq < 0.00489897949f) {  // sqrt(24 * 1e-6)
             quaternionScale(&deltaQ, &deltaQ, 1.0f - thetaMagnitudeSq / 6.0f);
             deltaQ.q0 = 1.0f - thetaMagnitudeSq / 2.0f;
         }
         else {
             const float thetaMagnitude = fast_fsqrtf(thetaMagnitudeSq);
-            quaternionScale(&deltaQ, &deltaQ, sin_approx(thetaMagnitude) / thetaMagnitude);
-            deltaQ.q0 = cos_approx(thetaMagnitude);
+            float sinTheta, cosTheta;
+            sincos_approx(thetaMagnitude, &sinTheta, &cosTheta);
+            quaternionScale(&deltaQ, &deltaQ, sinTheta / thetaMagnitude);
+            deltaQ.q0 = cosTheta;
         }
 
-        // Calculate final orientation and renormalize
+        // Calculate final orientation and renormalize. The norm also tells if some calculation
+        // in the update yield NAN or a zero quaternion, so there is no separate check of the result
         quaternionMultiply(&orientation, &orientation, &deltaQ);
-        quaternionNormalize(&orientation, &orientation);
-    }
 
-    // Check for invalid quaternion and reset to previous known good one
-    imuCheckAndResetOrientationQuaternion(&prevOrientation, accBF);
+        const float normSq = quaternionNormSqared(&orientation);
+        if (normSq > 1e-12f && !isnan(normSq) && !isinf(normSq)) {
+            quaternionScale(&orientation, &orientation, 1.0f / fast_fsqrtf(normSq));
+        } else {
+            // Reset to previous known good one
+            imuResetInvalidOrientationQuaternion(&prevOrientation, &imuMeasuredAccelBF);
+        }
 
-    // Pre-compute rotation matrix from quaternion
-    imuComputeRotationMatrix();
+        rMatValid = false;
+    }
 }
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
@@ -463,15 +609,24 @@ STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
 #ifdef USE_SIMULATOR
 	if (ARMING_FLAG(SIMULATOR_MODE) && ((simulatorData.flags & SIMU_USE_SENSORS) == 0)) {
 		imuComputeQuaternionFromRPY(attitude.values.roll, attitude.values.pitch, attitude.values.yaw);
-		imuComputeRotationMatrix();
 	}
 	else
 #endif
 	{
-		/* Compute pitch/roll angles */
-		attitude.values.roll = RADIANS_TO_DECIDEGREES(atan2_approx(rMat[2][1], rMat[2][2]));
-		attitude.values.pitch = RADIANS_TO_DECIDEGREES((0.5f * M_PIf) - acos_approx(-rMat[2][0]));
-		attitude.values.yaw = RADIANS_TO_DECIDEGREES(-atan2_approx(rMat[1][0], rMat[0][0]));
+		/* Compute pitch/roll angles straight from the quaternion, only 5 elements of the rotation matrix are needed */
+		const float q1q1 = orientation.q1 * orientation.q1;
+		const float q2q2 = orientation.q2 * orientation.q2;
+		const float q3q3 = orientation.q3 * orientation.q3;
+
+		const float r00 = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
+		const float r10 = 2.0f * (orientation.q1 * orientation.q2 + orientation.q0 * orientation.q3);
+		const float r20 = 2.0f * (orientation.q1 * orientation.q3 - orientation.q0 * orientation.q2);
+		const float r21 = 2.0f * (orientation.q2 * orientation.q3 + orientation.q0 * orientation.q1);
+		const float r22 = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
+
+		attitude.values.roll = RADIANS_TO_DECIDEGREES(atan2_approx(r21, r22));
+		attitude.values.pitch = RADIANS_TO_DECIDEGREES((0.5f * M_PIf) - acos_approx(-r20));
+		attitude.values.yaw = RADIANS_TO_DECIDEGREES(-atan2_approx(r10, r00));
 	}
 
     if (attitude.values.yaw < 0)
@@ -532,7 +687,7 @@ static float imuCalculateAccelerometerWeight(const float dT)
     return accWeight_Nearness * accWeight_RateIgnore;
 }
 
-static void imuCalculateEstimatedAttitude(float dT)
+static void imuCalculateCorrection(float dT)
 {
 #if defined(USE_MAG)
     const bool canUseMAG = sensors(SENSOR_MAG) && compassIsHealthy();
@@ -589,21 +744,24 @@ static void imuCalculateEstimatedAttitude(float dT)
     const float accWeight = imuGetPGainScaleFactor() * imuCalculateAccelerometerWeight(dT);
     const bool useAcc = (accWeight > 0.001f);
 
-    imuMahonyAHRSupdate(dT, &imuMeasuredRotationBF,
+    imuMahonyAHRSCorrection(dT, &imuMeasuredRotationBF,
                             useAcc ? &imuMeasuredAccelBF : NULL,
                             useMag ? &measuredMagBF : NULL,
                             useCOG, courseOverGround,
                             accWeight,
                             magWeight);
 
-    imuUpdateEulerAngles();
+#ifdef USE_SECONDARY_IMU
+    imuSecondaryImuCorrection();
+#endif
 }
 
 void imuUpdateAccelerometer(void)
 {
     if (sensors(SENSOR_ACC)) {
-        accUpdate();
-        isAccelUpdatedAtLeastOnce = true;
+        // Reads every loop, the averaged output comes at acc_output_rate
+        isAccelSampleNew = accUpdate();
+        isAccelUpdatedAtLeastOnce |= isAccelSampleNew;
     }
 }
 
@@ -629,10 +787,16 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
     previousIMUUpdateTimeUs = currentTimeUs;
 
     if (sensors(SENSOR_ACC) && isAccelUpdatedAtLeastOnce) {
+        sensorSampleConsume(&gyro.sample, currentTimeUs);
         gyroGetMeasuredRotationRate(&imuMeasuredRotationBF);    // Calculate gyro rate in body frame in rad/s
-        accGetMeasuredAcceleration(&imuMeasuredAccelBF);  // Calculate accel in body frame in cm/s/s
-        imuCheckVibrationLevels();
-        imuCalculateEstimatedAttitude(dT);  // Update attitude estimate
+        if (isAccelSampleNew) {
+            // Between outputs the last averaged sample stays in use
+            sensorSampleConsume(&acc.sample, currentTimeUs);
+            accGetMeasuredAcceleration(&imuMeasuredAccelBF);  // Calculate accel in body frame in cm/s/s
+            imuCheckVibrationLevels();
+        }
+        imuMahonyAHRSupdate(dT, &imuMeasuredRotationBF);  // Update attitude estimate
+        imuUpdateEulerAngles();
     } else {
         acc.accADCf[X] = 0.0f;
         acc.accADCf[Y] = 0.0f;
@@ -640,6 +804,26 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
     }
 }
 
+void imuUpdateCorrection(timeUs_t currentTimeUs)
+{
+    static timeUs_t previousCorrectionTimeUs;
+    const float dT = (currentTimeUs - previousCorrectionTimeUs) * 1e-6f;
+    previousCorrectionTimeUs = currentTimeUs;
+
+    // Measurements are taken by imuUpdateAttitude() in the PID loop
+    if (sensors(SENSOR_ACC) && isAccelUpdatedAtLeastOnce) {
+#if defined(USE_MAG)
+        if (sensors(SENSOR_MAG)) {
+            sensorSampleConsume(&mag.sample, currentTimeUs);
+        }
+#endif
+        imuCalculateCorrection(dT);
+#ifdef USE_SECONDARY_IMU
+        imuSecondaryStoreHistory(currentTimeUs);
+#endif
+    }
+}
+
 bool isImuReady(void)
 {
     return sensors(SENSOR_ACC) && gyroIsCalibrationComplete();
@@ -39,7 +39,6 @@ typedef union {
 
 extern fpQuaternion_t orientation;
 extern attitudeEulerAngles_t attitude;
-extern float rMat[3][3];
 
 typedef struct imuConfig_s {
     uint16_t dcm_kp_acc;                    // DCM filter proportional gain ( x 10000) for accelerometer
@@ -61,12 +60,16 @@ typedef struct imuRuntimeConfig_s {
     uint8_t small_angle;
 } imuRuntimeConfig_t;
 
+#define IMU_CORRECTION_RATE_HZ      250
+
 void imuConfigure(void);
 
 void imuSetMagneticDeclination(float declinationDeg);
 void imuUpdateAttitude(timeUs_t currentTimeUs);
+void imuUpdateCorrection(timeUs_t currentTimeUs);
 void imuUpdateAccelerometer(void);
 float calculateCosTiltAngle(void);
+const fpMat3_t * imuGetRotationMatrix(void);
 bool isImuReady(void);
 bool isImuHeadingValid(void);
 
@@ -74,3 +77,4 @@ void imuTransformVectorBodyToEarth(fpVector3_t * v);
 void imuTransformVectorEarthToBody(fpVector3_t * v);
 
 void imuInit(void);
+void imuRestoreOrientation(const fpQuaternion_t *quat);
@@ -28,84 +28,78 @@ FILE_COMPILE_FOR_SPEED
 #include "kalman.h"
 #include "build/debug.h"
 
-kalman_t kalmanFilterStateRate[XYZ_AXIS_COUNT];
+kalman_t kalmanFilterStateRate;
 
-static void gyroKalmanInitAxis(kalman_t *filter, uint16_t q)
+void gyroKalmanInitialize(uint16_t q)
 {
+    kalman_t *filter = &kalmanFilterStateRate;
+
     memset(filter, 0, sizeof(kalman_t));
     filter->q = q * 0.03f; //add multiplier to make tuning easier
-    filter->r = 88.0f;      //seeding R at 88.0f
-    filter->p = 30.0f;      //seeding P at 30.0f
-    filter->e = 1.0f;
-    filter->w = MAX_KALMAN_WINDOW_SIZE;         
-    filter->inverseN = 1.0f / (float)(filter->w);
-}
-
-void gyroKalmanInitialize(uint16_t q)
-{
-    gyroKalmanInitAxis(&kalmanFilterStateRate[X], q);
-    gyroKalmanInitAxis(&kalmanFilterStateRate[Y], q);
-    gyroKalmanInitAxis(&kalmanFilterStateRate[Z], q);
+    filter->alpha = 1.0f / KALMAN_VARIANCE_WINDOW;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->r[axis] = 88.0f;   //seeding R at 88.0f
+        filter->p[axis] = 30.0f;   //seeding P at 30.0f
+        filter->e[axis] = 1.0f;
+    }
 }
 
-float kalman_process(kalman_t *kalmanState, float input)
+/*
+ * Exponentially weighted mean and variance of the gyro rate, constant time and memory per sample.
+ * Measurement noise R follows the standard deviation
+ */
+static void updateVariance(kalman_t *kalmanState, const float *rate)
 {
-    //project the state ahead using acceleration
-    kalmanState->x += (kalmanState->x - kalmanState->lastX);
+    const float alpha = kalmanState->alpha;
 
-    //update last state
-    kalmanState->lastX = kalmanState->x;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float diff = rate[axis] - kalmanState->axisMean[axis];
+        const float increment = alpha * diff;
 
-    if (kalmanState->lastX != 0.0f)
-    {
-        kalmanState->e = fabsf(1.0f - (kalmanState->setpoint / kalmanState->lastX));
+        kalmanState->axisMean[axis] += increment;
+        kalmanState->axisVar[axis] = (1.0f - alpha) * (kalmanState->axisVar[axis] + diff * increment);
     }
 
-    //prediction update
-    kalmanState->p = kalmanState->p + (kalmanState->q * kalmanState->e);
-
-    //measurement update
-    kalmanState->k = kalmanState->p / (kalmanState->p + kalmanState->r);
-    kalmanState->x += kalmanState->k * (input - kalmanState->x);
-    kalmanState->p = (1.0f - kalmanState->k) * kalmanState->p;
-    return kalmanState->x;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        float squirt;
+        arm_sqrt_f32(kalmanState->axisVar[axis], &squirt);
+        kalmanState->r[axis] = squirt * VARIANCE_SCALE;
+    }
 }
 
-static void updateAxisVariance(kalman_t *kalmanState, float rate)
+static void kalmanProcess(kalman_t *kalmanState, float *values)
 {
-    kalmanState->axisWindow[kalmanState->windex] = rate;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        //project the state ahead using acceleration
+        kalmanState->x[axis] += (kalmanState->x[axis] - kalmanState->lastX[axis]);
 
-    kalmanState->axisSumMean += kalmanState->axisWindow[kalmanState->windex];
-    float varianceElement = kalmanState->axisWindow[kalmanState->windex] - kalmanState->axisMean;
-    varianceElement = varianceElement * varianceElement;
-    kalmanState->axisSumVar += varianceElement;
-    kalmanState->varianceWindow[kalmanState->windex] = varianceElement;
+        //update last state
+        kalmanState->lastX[axis] = kalmanState->x[axis];
 
-    kalmanState->windex++;
-    if (kalmanState->windex > kalmanState->w) {
-        kalmanState->windex = 0;
-    }
+        if (kalmanState->lastX[axis] != 0.0f) {
+            kalmanState->e[axis] = fabsf(1.0f - (kalmanState->setpoint[axis] / kalmanState->lastX[axis]));
+        }
 
-    kalmanState->axisSumMean -= kalmanState->axisWindow[kalmanState->windex];
-    kalmanState->axisSumVar -= kalmanState->varianceWindow[kalmanState->windex];
+        //prediction update
+        kalmanState->p[axis] = kalmanState->p[axis] + (kalmanState->q * kalmanState->e[axis]);
 
-    //New mean
-    kalmanState->axisMean = kalmanState->axisSumMean * kalmanState->inverseN;
-    kalmanState->axisVar = kalmanState->axisSumVar * kalmanState->inverseN;
+        //measurement update
+        const float k = kalmanState->p[axis] / (kalmanState->p[axis] + kalmanState->r[axis]);
+        kalmanState->x[axis] += k * (values[axis] - kalmanState->x[axis]);
+        kalmanState->p[axis] = (1.0f - k) * kalmanState->p[axis];
 
-    float squirt;
-    arm_sqrt_f32(kalmanState->axisVar, &squirt);
-    kalmanState->r = squirt * VARIANCE_SCALE;
+        values[axis] = kalmanState->x[axis];
+    }
 }
 
-float NOINLINE gyroKalmanUpdate(uint8_t axis, float input)
+void NOINLINE gyroKalmanUpdateAxes(float *values)
 {
-    updateAxisVariance(&kalmanFilterStateRate[axis], input);
-    return kalman_process(&kalmanFilterStateRate[axis], input);
+    updateVariance(&kalmanFilterStateRate, values);
+    kalmanProcess(&kalmanFilterStateRate, values);
 }
 
 void gyroKalmanUpdateSetpoint(uint8_t axis, float setpoint) {
-    kalmanFilterStateRate[axis].setpoint = setpoint;
+    kalmanFilterStateRate.setpoint[axis] = setpoint;
 }
 
 #endif
\ No newline at end of file
@@ -23,33 +23,27 @@
 #include "sensors/gyro.h"
 #include "common/filter.h"
 
-#define MAX_KALMAN_WINDOW_SIZE 64
+#define KALMAN_VARIANCE_WINDOW 64  // Effective length of the exponentially weighted variance [samples]
 
 #define VARIANCE_SCALE 0.67f
 
+// All axes side by side, so every step of the update runs over contiguous arrays
 typedef struct kalman
 {
-    float q;     //process noise covariance
-    float r;     //measurement noise covariance
-    float p;     //estimation error covariance matrix
-    float k;     //kalman gain
-    float x;     //state
-    float lastX; //previous state
-    float e;
-
-    float setpoint;
-    
-    float axisVar;
-    uint16_t windex;
-    float axisWindow[MAX_KALMAN_WINDOW_SIZE + 1];
-    float varianceWindow[MAX_KALMAN_WINDOW_SIZE + 1];
-    float axisSumMean;
-    float axisMean;
-    float axisSumVar;
-    float inverseN;
-    uint16_t w;
+    float q;                        //process noise covariance
+    float alpha;                    //variance estimator weight of a new sample
+    float r[XYZ_AXIS_COUNT];        //measurement noise covariance
+    float p[XYZ_AXIS_COUNT];        //estimation error covariance matrix
+    float x[XYZ_AXIS_COUNT];        //state
+    float lastX[XYZ_AXIS_COUNT];    //previous state
+    float e[XYZ_AXIS_COUNT];
+
+    float setpoint[XYZ_AXIS_COUNT];
+
+    float axisMean[XYZ_AXIS_COUNT];
+    float axisVar[XYZ_AXIS_COUNT];
 } kalman_t;
 
 void gyroKalmanInitialize(uint16_t q);
-float gyroKalmanUpdate(uint8_t axis, float input);
+void gyroKalmanUpdateAxes(float *values);
 void gyroKalmanUpdateSetpoint(uint8_t axis, float setpoint);
\ No newline at end of file
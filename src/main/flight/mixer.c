@@ -62,6 +62,13 @@ FASTRAM int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
 static float motorMixRange;
 static float mixerScale = 1.0f;
 static EXTENDED_FASTRAM motorMixer_t currentMixer[MAX_SUPPORTED_MOTORS];
+// currentMixer compiled into rows indexed by ROLL, PITCH, YAW, THROTTLE, so mixTable() streams contiguous coefficients.
+// A mixer switch compiles into the idle matrix and swaps the pointers, the previous matrix is kept for the cross-fade
+static EXTENDED_FASTRAM float mixerMatrices[2][4][MAX_SUPPORTED_MOTORS];
+static EXTENDED_FASTRAM float (*mixerMatrix)[MAX_SUPPORTED_MOTORS] = mixerMatrices[0];
+static EXTENDED_FASTRAM float (*mixerMatrixPrevious)[MAX_SUPPORTED_MOTORS] = mixerMatrices[1];
+static EXTENDED_FASTRAM bool mixerSwitchBlending = false;
+static EXTENDED_FASTRAM timeUs_t mixerSwitchStartUs;
 static EXTENDED_FASTRAM uint8_t motorCount = 0;
 EXTENDED_FASTRAM int mixerThrottleCommand;
 static EXTENDED_FASTRAM int throttleIdleValue = 0;
@@ -83,7 +90,7 @@ PG_RESET_TEMPLATE(reversibleMotorsConfig_t, reversibleMotorsConfig,
     .neutral = SETTING_3D_NEUTRAL_DEFAULT
 );
 
-PG_REGISTER_WITH_RESET_TEMPLATE(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 5);
+PG_REGISTER_WITH_RESET_TEMPLATE(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 6);
 
 PG_RESET_TEMPLATE(mixerConfig_t, mixerConfig,
     .motorDirectionInverted = SETTING_MOTOR_DIRECTION_INVERTED_DEFAULT,
@@ -91,9 +98,10 @@ PG_RESET_TEMPLATE(mixerConfig_t, mixerConfig,
     .hasFlaps = SETTING_HAS_FLAPS_DEFAULT,
     .appliedMixerPreset = SETTING_MODEL_PREVIEW_TYPE_DEFAULT, //This flag is not available in CLI and used by Configurator only
     .outputMode = SETTING_OUTPUT_MODE_DEFAULT,
+    .switchBlendTime = SETTING_MIXER_SWITCH_BLEND_TIME_DEFAULT,
 );
 
-PG_REGISTER_WITH_RESET_TEMPLATE(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 9);
+PG_REGISTER_WITH_RESET_TEMPLATE(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 11);
 
 PG_RESET_TEMPLATE(motorConfig_t, motorConfig,
     .motorPwmProtocol = SETTING_MOTOR_PWM_PROTOCOL_DEFAULT,
@@ -101,6 +109,12 @@ PG_RESET_TEMPLATE(motorConfig_t, motorConfig,
     .maxthrottle = SETTING_MAX_THROTTLE_DEFAULT,
     .mincommand = SETTING_MIN_COMMAND_DEFAULT,
     .motorPoleCount = SETTING_MOTOR_POLES_DEFAULT,            // Most brushless motors that we use are 14 poles
+#ifdef USE_DSHOT_BIDIR
+    .dshotBidir = SETTING_DSHOT_BIDIR_DEFAULT,
+#endif
+#ifdef USE_DSHOT_DMAR
+    .dshotBurst = SETTING_DSHOT_BURST_DEFAULT,
+#endif
 );
 
 PG_REGISTER_ARRAY(motorMixer_t, MAX_SUPPORTED_MOTORS, primaryMotorMixer, PG_MOTOR_MIXER, 0);
@@ -116,16 +130,23 @@ int getThrottleIdleValue(void)
     return throttleIdleValue;
 }
 
-static void computeMotorCount(void)
+static uint8_t countMixerMotors(void)
 {
-    motorCount = 0;
+    uint8_t count = 0;
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         // check if done
         if (primaryMotorMixer(i)->throttle == 0.0f) {
             break;
         }
-        motorCount++;
+        count++;
     }
+
+    return count;
+}
+
+static void computeMotorCount(void)
+{
+    motorCount = countMixerMotors();
 }
 
 uint8_t getMotorCount(void) {
@@ -190,22 +211,24 @@ void nullMotorRateLimiting(const float dT)
 void mixerInit(void)
 {
     computeMotorCount();
-    loadPrimaryMotorMixer();
     // in 3D mode, mixer gain has to be halved
     if (feature(FEATURE_REVERSIBLE_MOTORS)) {
         mixerScale = 0.5f;
     }
 
-    throttleDeadbandLow = PWM_RANGE_MIDDLE - rcControlsConfig()->mid_throttle_deadband;
-    throttleDeadbandHigh = PWM_RANGE_MIDDLE + rcControlsConfig()->mid_throttle_deadband;
-
-    mixerResetDisarmedMotors();
-
     if (mixerConfig()->motorDirectionInverted) {
         motorYawMultiplier = -1;
     } else {
         motorYawMultiplier = 1;
     }
+
+    // Mixer scale and yaw direction are folded into the mixer matrix
+    loadPrimaryMotorMixer();
+
+    throttleDeadbandLow = PWM_RANGE_MIDDLE - rcControlsConfig()->mid_throttle_deadband;
+    throttleDeadbandHigh = PWM_RANGE_MIDDLE + rcControlsConfig()->mid_throttle_deadband;
+
+    mixerResetDisarmedMotors();
 }
 
 void mixerResetDisarmedMotors(void)
@@ -486,15 +509,39 @@ void FAST_CODE mixTable()
     int16_t rpyMixMax = 0; // assumption: symetrical about zero.
     int16_t rpyMixMin = 0;
 
+    const float inputRoll = input[ROLL];
+    const float inputPitch = input[PITCH];
+    const float inputYaw = input[YAW];
+
+    // Cross-fade from the previous mixer after a switch, both matrices are precompiled so only the weight changes
+    float mixerBlend = 1.0f;
+    if (mixerSwitchBlending) {
+        mixerBlend = cmpTimeUs(micros(), mixerSwitchStartUs) / (mixerConfig()->switchBlendTime * 1000.0f);
+        if (mixerBlend >= 1.0f) {
+            mixerBlend = 1.0f;
+            mixerSwitchBlending = false;
+        }
+    }
+
     // motors for non-servo mixes
     for (int i = 0; i < motorCount; i++) {
-        rpyMix[i] =
-            (input[PITCH] * currentMixer[i].pitch +
-            input[ROLL] * currentMixer[i].roll +
-            -motorYawMultiplier * input[YAW] * currentMixer[i].yaw) * mixerScale;
+        float mix =
+            inputPitch * mixerMatrix[PITCH][i] +
+            inputRoll * mixerMatrix[ROLL][i] +
+            inputYaw * mixerMatrix[YAW][i];
+
+        if (mixerBlend < 1.0f) {
+            const float previousMix =
+                inputPitch * mixerMatrixPrevious[PITCH][i] +
+                inputRoll * mixerMatrixPrevious[ROLL][i] +
+                inputYaw * mixerMatrixPrevious[YAW][i];
+            mix = previousMix + (mix - previousMix) * mixerBlend;
+        }
 
-        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
-        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
+        rpyMix[i] = mix;
+
+        rpyMixMax = MAX(rpyMix[i], rpyMixMax);
+        rpyMixMin = MIN(rpyMix[i], rpyMixMin);
     }
 
     int16_t rpyMixRange = rpyMixMax - rpyMixMin;
@@ -566,11 +613,9 @@ void FAST_CODE mixTable()
 
     #define THROTTLE_CLIPPING_FACTOR    0.33f
     motorMixRange = (float)rpyMixRange / (float)throttleRange;
+    // RPY mix is scaled down when saturated, applied to all motors in the output pass
+    const float rpyMixScale = 1.0f / MAX(motorMixRange, 1.0f);
     if (motorMixRange > 1.0f) {
-        for (int i = 0; i < motorCount; i++) {
-            rpyMix[i] /= motorMixRange;
-        }
-
         // Allow some clipping on edges to soften correction response
         throttleMin = throttleMin + (throttleRange / 2) - (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
         throttleMax = throttleMin + (throttleRange / 2) + (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
@@ -583,25 +628,33 @@ void FAST_CODE mixTable()
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
     if (ARMING_FLAG(ARMED)) {
         const motorStatus_e currentMotorStatus = getMotorStatus();
-        for (int i = 0; i < motorCount; i++) {
-            motor[i] = rpyMix[i] + constrain(mixerThrottleCommand * currentMixer[i].throttle, throttleMin, throttleMax);
+        const bool failsafeActive = failsafeIsActive();
+        const int motorOutputMin = failsafeActive ? motorConfig()->mincommand : throttleRangeMin;
+        const int motorOutputMax = failsafeActive ? motorConfig()->maxthrottle : throttleRangeMax;
 
-            if (failsafeIsActive()) {
-                motor[i] = constrain(motor[i], motorConfig()->mincommand, motorConfig()->maxthrottle);
-            } else {
-                motor[i] = constrain(motor[i], throttleRangeMin, throttleRangeMax);
+        for (int i = 0; i < motorCount; i++) {
+            const int16_t motorRpyMix = rpyMix[i] * rpyMixScale;
+            float throttleWeight = mixerMatrix[THROTTLE][i];
+            if (mixerBlend < 1.0f) {
+                throttleWeight = mixerMatrixPrevious[THROTTLE][i] + (throttleWeight - mixerMatrixPrevious[THROTTLE][i]) * mixerBlend;
             }
+            const int16_t motorThrottle = constrain(mixerThrottleCommand * throttleWeight, throttleMin, throttleMax);
+            motor[i] = constrain(motorRpyMix + motorThrottle, motorOutputMin, motorOutputMax);
+        }
 
-            // Motor stop handling
-            if (currentMotorStatus != MOTOR_RUNNING) {
+        // Motor stop handling
+        if (currentMotorStatus != MOTOR_RUNNING) {
+            for (int i = 0; i < motorCount; i++) {
                 motor[i] = motorValueWhenStopped;
             }
+        }
 #ifdef USE_DEV_TOOLS
-            if (systemConfig()->groundTestMode) {
+        if (systemConfig()->groundTestMode) {
+            for (int i = 0; i < motorCount; i++) {
                 motor[i] = motorZeroCommand;
             }
-#endif
         }
+#endif
     } else {
         for (int i = 0; i < motorCount; i++) {
             motor[i] = motor_disarmed[i];
@@ -658,10 +711,42 @@ motorStatus_e getMotorStatus(void)
     return MOTOR_RUNNING;
 }
 
-void loadPrimaryMotorMixer(void) {
+static void compileMotorMixer(float (*matrix)[MAX_SUPPORTED_MOTORS])
+{
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         currentMixer[i] = *primaryMotorMixer(i);
+
+        matrix[ROLL][i] = currentMixer[i].roll * mixerScale;
+        matrix[PITCH][i] = currentMixer[i].pitch * mixerScale;
+        matrix[YAW][i] = -motorYawMultiplier * currentMixer[i].yaw * mixerScale;
+        matrix[THROTTLE][i] = currentMixer[i].throttle;
+    }
+}
+
+void loadPrimaryMotorMixer(void) {
+    compileMotorMixer(mixerMatrix);
+    memcpy(mixerMatrixPrevious, mixerMatrix, sizeof(mixerMatrices[0]));
+    mixerSwitchBlending = false;
+}
+
+bool mixerSwitchMotorMixer(void)
+{
+    // Motor outputs are bound at boot, a mixer with a different motor count only applies after a reboot
+    if (countMixerMotors() != motorCount) {
+        return false;
     }
+
+    // Compile into the idle matrix first so mixTable() never sees a half written one, a switch
+    // during a cross-fade restarts the fade from the last target
+    float (*next)[MAX_SUPPORTED_MOTORS] = mixerMatrixPrevious;
+    compileMotorMixer(next);
+    mixerMatrixPrevious = mixerMatrix;
+    mixerMatrix = next;
+
+    mixerSwitchStartUs = micros();
+    mixerSwitchBlending = mixerConfig()->switchBlendTime > 0;
+
+    return true;
 }
 
 bool areMotorsRunning(void)
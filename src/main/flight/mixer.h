@@ -70,6 +70,7 @@ typedef struct mixerConfig_s {
     bool hasFlaps;
     int16_t appliedMixerPreset;
     uint8_t outputMode;
+    uint16_t switchBlendTime;               // [ms] cross-fade time when the motor mixer is switched at runtime
 } mixerConfig_t;
 
 PG_DECLARE(mixerConfig_t, mixerConfig);
@@ -90,6 +91,12 @@ typedef struct motorConfig_s {
     uint8_t  motorPwmProtocol;
     uint16_t digitalIdleOffsetValue;
     uint8_t motorPoleCount;                 // Magnetic poles in the motors for calculating actual RPM from eRPM provided by ESC telemetry
+#ifdef USE_DSHOT_BIDIR
+    bool dshotBidir;                        // Request eRPM from the ESC over the DShot signal wire
+#endif
+#ifdef USE_DSHOT_DMAR
+    bool dshotBurst;                        // Drive all DShot motors of a timer with a single DMA stream
+#endif
 } motorConfig_t;
 
 PG_DECLARE(motorConfig_t, motorConfig);
@@ -130,4 +137,5 @@ void stopMotors(void);
 void stopPwmAllMotors(void);
 
 void loadPrimaryMotorMixer(void);
+bool mixerSwitchMotorMixer(void);
 bool areMotorsRunning(void);
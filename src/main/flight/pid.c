@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 
 #include <platform.h>
@@ -38,6 +39,7 @@ FILE_COMPILE_FOR_SPEED
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_curves.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 #include "fc/settings.h"
@@ -67,47 +69,53 @@ FILE_COMPILE_FOR_SPEED
 
 #include "programming/logic_condition.h"
 
+/*
+ * Hot controller state touched on every PID cycle, laid out as struct-of-arrays
+ * so the rate controller walks gains, rates and integrators of all axes contiguously
+ */
 typedef struct {
-    uint8_t axis;
-    float kP;   // Proportional gain
-    float kI;   // Integral gain
-    float kD;   // Derivative gain
-    float kFF;  // Feed-forward gain
-    float kCD;  // Control Derivative
-    float kT;   // Back-calculation tracking gain
-
-    float gyroRate;
-    float rateTarget;
+    float kP[FLIGHT_DYNAMICS_INDEX_COUNT];   // Proportional gain
+    float kI[FLIGHT_DYNAMICS_INDEX_COUNT];   // Integral gain
+    float kD[FLIGHT_DYNAMICS_INDEX_COUNT];   // Derivative gain
+    float kFF[FLIGHT_DYNAMICS_INDEX_COUNT];  // Feed-forward gain
+    float kCD[FLIGHT_DYNAMICS_INDEX_COUNT];  // Control Derivative
+    float kT[FLIGHT_DYNAMICS_INDEX_COUNT];   // Back-calculation tracking gain
+
+    float gyroRate[FLIGHT_DYNAMICS_INDEX_COUNT];
+    float rateTarget[FLIGHT_DYNAMICS_INDEX_COUNT];
+    float previousRateTarget[FLIGHT_DYNAMICS_INDEX_COUNT];
+    float previousRateGyro[FLIGHT_DYNAMICS_INDEX_COUNT];
+
+    // Setpoint shaping output, see pidShapeSetpoints()
+    float shapedRateTarget[FLIGHT_DYNAMICS_INDEX_COUNT];        // Rate limited target with logic condition overrides, tracked by the rate controllers
+    float rateTargetDerivative[FLIGHT_DYNAMICS_INDEX_COUNT];    // Filtered change of the shaped target, drives the control derivative
+    float itermRelaxFactor[FLIGHT_DYNAMICS_INDEX_COUNT];        // I-term attenuation from the setpoint HPF, 1 when relax is off
 
     // Rate integrator
-    float errorGyroIf;
-    float errorGyroIfLimit;
+    float errorGyroIf[FLIGHT_DYNAMICS_INDEX_COUNT];
+    float errorGyroIfLimit[FLIGHT_DYNAMICS_INDEX_COUNT];
+
+    float pidSumLimit[FLIGHT_DYNAMICS_INDEX_COUNT];
+    bool itermLimitActive[FLIGHT_DYNAMICS_INDEX_COUNT];
+    bool itermFreezeActive[FLIGHT_DYNAMICS_INDEX_COUNT];
+} pidAxisData_t;
+
+// Cold per-axis state: filters and predictors that are only reached through their own axis
+typedef struct {
+    uint8_t axis;
 
     // Used for ANGLE filtering (PT1, we don't need super-sharpness here)
     pt1Filter_t angleFilterState;
 
     // Rate filtering
-    rateLimitFilter_t axisAccelFilter;
     pt1Filter_t ptermLpfState;
-    filter_t dtermLpfState;
-    filter_t dtermLpf2State;
 
     float stickPosition;
 
-    float previousRateTarget;
-    float previousRateGyro;
-
 #ifdef USE_D_BOOST
-    pt1Filter_t dBoostLpf;
-    biquadFilter_t dBoostGyroLpf;
     float dBoostTargetAcceleration;
 #endif
-    uint16_t pidSumLimit;
     filterApply4FnPtr ptermFilterApplyFn;
-    bool itermLimitActive;
-    bool itermFreezeActive;
-
-    pt3Filter_t rateTargetFilter;
 
     smithPredictor_t smithPredictor;
 } pidState_t;
@@ -130,8 +138,17 @@ int32_t axisPID_F[FLIGHT_DYNAMICS_INDEX_COUNT];
 int32_t axisPID_Setpoint[FLIGHT_DYNAMICS_INDEX_COUNT];
 #endif
 
+static EXTENDED_FASTRAM pidAxisData_t pidAxis;
 static EXTENDED_FASTRAM pidState_t pidState[FLIGHT_DYNAMICS_INDEX_COUNT];
-static EXTENDED_FASTRAM pt1Filter_t windupLpf[XYZ_AXIS_COUNT];
+
+// Setpoint shaping state, all stages of all axes are walked in the single shaping pass
+typedef struct {
+    rateLimitFilter_t accelLimit[XYZ_AXIS_COUNT];
+    pt1Filter_t itermRelaxLpf[XYZ_AXIS_COUNT];
+    pt3Filter_t derivativeLpf[XYZ_AXIS_COUNT];
+} pidSetpointShaping_t;
+
+static EXTENDED_FASTRAM pidSetpointShaping_t setpointShaping;
 static EXTENDED_FASTRAM uint8_t itermRelax;
 
 #ifdef USE_ANTIGRAVITY
@@ -141,6 +158,10 @@ static EXTENDED_FASTRAM float antigravityGain;
 static EXTENDED_FASTRAM float antigravityAccelerator;
 #endif
 
+#define FW_TPA_AIRSPEED_MIN         100.0f  // cm/s, keeps the factor finite near standstill
+#define FW_TPA_AIRSPEED_FACTOR_MIN  0.3f
+#define FW_TPA_AIRSPEED_FACTOR_MAX  2.0f
+
 #define D_BOOST_GYRO_LPF_HZ 80    // Biquad lowpass input cutoff to peak D around propwash frequencies
 #define D_BOOST_LPF_HZ 7          // PT1 lowpass cutoff to smooth the boost effect
 
@@ -150,6 +171,14 @@ static EXTENDED_FASTRAM float dBoostMax;
 static EXTENDED_FASTRAM float dBoostMaxAtAlleceleration;
 #endif
 
+// D-term filters are kept per stage rather than per axis, every stage runs over all axes in one pass
+static EXTENDED_FASTRAM filter_t dtermLpfState[XYZ_AXIS_COUNT];
+static EXTENDED_FASTRAM filter_t dtermLpf2State[XYZ_AXIS_COUNT];
+#ifdef USE_D_BOOST
+static EXTENDED_FASTRAM filter_t dBoostLpf[XYZ_AXIS_COUNT];
+static EXTENDED_FASTRAM filter_t dBoostGyroLpf[XYZ_AXIS_COUNT];
+#endif
+
 static EXTENDED_FASTRAM uint8_t yawLpfHz;
 static EXTENDED_FASTRAM float motorItermWindupPoint;
 static EXTENDED_FASTRAM float antiWindupScaler;
@@ -158,10 +187,32 @@ static EXTENDED_FASTRAM float iTermAntigravityGain;
 #endif
 static EXTENDED_FASTRAM uint8_t usedPidControllerType;
 
-typedef void (*pidControllerFnPtr)(pidState_t *pidState, flight_dynamics_index_t axis, float dT);
+typedef void (*pidControllerFnPtr)(float dT);
 static EXTENDED_FASTRAM pidControllerFnPtr pidControllerApplyFn;
 static EXTENDED_FASTRAM filterApplyFnPtr dTermLpfFilterApplyFn;
 static EXTENDED_FASTRAM filterApplyFnPtr dTermLpf2FilterApplyFn;
+#ifdef USE_FILTER_CHAIN_SPECIALIZATION
+static EXTENDED_FASTRAM filterChain2ApplyAxesFnPtr dTermFilterChainApplyFn;
+#endif
+
+// Filter coefficients of every PID profile, a profile switch loads them into the running filters
+typedef struct {
+    filterApplyFnPtr dtermLpfApplyFn;
+    filterApplyFnPtr dtermLpf2ApplyFn;
+    filter_t dtermLpf;
+    filter_t dtermLpf2;
+    pt1Filter_t itermRelaxLpf;
+    pt3Filter_t derivativeLpf;
+#ifdef USE_ANTIGRAVITY
+    pt1Filter_t antigravityThrottleLpf;
+#endif
+#ifdef USE_D_BOOST
+    biquadFilter_t dBoostGyroLpf;
+#endif
+} pidProfileFilters_t;
+
+static pidProfileFilters_t pidProfileFilters[MAX_PROFILE_COUNT];
+static uint8_t pidFiltersProfileIndex;      // Profile the running filters were loaded from
 static EXTENDED_FASTRAM bool levelingEnabled = false;
 
 #define FIXED_WING_LEVEL_TRIM_MAX_ANGLE 10.0f // Max angle auto trimming can demand
@@ -172,7 +223,8 @@ static EXTENDED_FASTRAM bool levelingEnabled = false;
 static EXTENDED_FASTRAM float fixedWingLevelTrim;
 static EXTENDED_FASTRAM pidController_t fixedWingLevelTrimController;
 
-PG_REGISTER_PROFILE_WITH_RESET_TEMPLATE(pidProfile_t, pidProfile, PG_PID_PROFILE, 4);
+PG_REGISTER_PROFILE_WITH_RESET_TEMPLATE(pidProfile_t, pidProfile, PG_PID_PROFILE, 6);
+PG_REGISTER_MIGRATION_KEEP_UNTIL(pidProfile_t, pidProfile, 5, fixedWingTpaAirspeedPow);
 
 PG_RESET_TEMPLATE(pidProfile_t, pidProfile,
         .bank_mc = {
@@ -310,65 +362,124 @@ PG_RESET_TEMPLATE(pidProfile_t, pidProfile,
         .smithPredictorStrength = SETTING_SMITH_PREDICTOR_STRENGTH_DEFAULT,
         .smithPredictorDelay = SETTING_SMITH_PREDICTOR_DELAY_DEFAULT,
         .smithPredictorFilterHz = SETTING_SMITH_PREDICTOR_LPF_HZ_DEFAULT,
+        .smithPredictorAdaptive = SETTING_SMITH_PREDICTOR_ADAPTIVE_DEFAULT,
 #endif
+        .fixedWingTpaAirspeedPow = SETTING_FW_TPA_AIRSPEED_POW_DEFAULT,
 );
 
-FUNCTION_COMPILE_FOR_SIZE
-bool pidInitFilters(void)
+static void pidProfileFiltersInit(pidProfileFilters_t *filters, const pidProfile_t *profile, uint32_t refreshRate)
 {
-    const uint32_t refreshRate = getLooptime();
+    memset(filters, 0, sizeof(*filters));
 
-    if (refreshRate == 0) {
-        return false;
+    assignFilterApplyFn(profile->dterm_lpf_type, profile->dterm_lpf_hz, &filters->dtermLpfApplyFn);
+    assignFilterApplyFn(profile->dterm_lpf2_type, profile->dterm_lpf2_hz, &filters->dtermLpf2ApplyFn);
+    initFilter(profile->dterm_lpf_type, &filters->dtermLpf, profile->dterm_lpf_hz, refreshRate);
+    initFilter(profile->dterm_lpf2_type, &filters->dtermLpf2, profile->dterm_lpf2_hz, refreshRate);
+
+    pt1FilterInit(&filters->itermRelaxLpf, profile->iterm_relax_cutoff, refreshRate * 1e-6f);
+
+    if (profile->controlDerivativeLpfHz) {
+        pt3FilterInit(&filters->derivativeLpf, pt3FilterGain(profile->controlDerivativeLpfHz, refreshRate * 1e-6f));
     }
 
-    for (int axis = 0; axis < 3; ++ axis) {
-        initFilter(pidProfile()->dterm_lpf_type, &pidState[axis].dtermLpfState, pidProfile()->dterm_lpf_hz, refreshRate);
-        initFilter(pidProfile()->dterm_lpf2_type, &pidState[axis].dtermLpf2State, pidProfile()->dterm_lpf2_hz, refreshRate);
+#ifdef USE_ANTIGRAVITY
+    pt1FilterInit(&filters->antigravityThrottleLpf, profile->antigravityCutoff, TASK_PERIOD_HZ(TASK_AUX_RATE_HZ) * 1e-6f);
+#endif
+
+#ifdef USE_D_BOOST
+    biquadFilterInitLPF(&filters->dBoostGyroLpf, profile->dBoostGyroDeltaLpfHz, refreshRate);
+#endif
+}
+
+static void pidUpdateProfileFilters(uint32_t refreshRate)
+{
+    for (int i = 0; i < MAX_PROFILE_COUNT; i++) {
+        pidProfileFiltersInit(&pidProfileFilters[i], &pidProfile_Storage[i], refreshRate);
     }
+}
+
+/*
+ * Loads the filter coefficients of a profile. With keepState the running filters
+ * only change their coefficients, a D-term stage that changes its type starts over.
+ */
+static void pidLoadProfileFilters(uint8_t profileIndex, bool keepState)
+{
+    const pidProfileFilters_t *filters = &pidProfileFilters[profileIndex];
+    const pidProfileFilters_t *previous = &pidProfileFilters[pidFiltersProfileIndex];
+    const bool keepDtermLpf = keepState && filters->dtermLpfApplyFn == previous->dtermLpfApplyFn;
+    const bool keepDtermLpf2 = keepState && filters->dtermLpf2ApplyFn == previous->dtermLpf2ApplyFn;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (keepDtermLpf) {
+            filterUpdateCoefficients(filters->dtermLpfApplyFn, &dtermLpfState[axis], &filters->dtermLpf);
+        } else {
+            dtermLpfState[axis] = filters->dtermLpf;
+        }
+
+        if (keepDtermLpf2) {
+            filterUpdateCoefficients(filters->dtermLpf2ApplyFn, &dtermLpf2State[axis], &filters->dtermLpf2);
+        } else {
+            dtermLpf2State[axis] = filters->dtermLpf2;
+        }
 
-    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
-        pt1FilterInit(&windupLpf[i], pidProfile()->iterm_relax_cutoff, refreshRate * 1e-6f);
+        if (keepState) {
+            filterUpdateCoefficients((filterApplyFnPtr) pt1FilterApply, (filter_t *) &setpointShaping.itermRelaxLpf[axis], (const filter_t *) &filters->itermRelaxLpf);
+            filterUpdateCoefficients((filterApplyFnPtr) pt3FilterApply, (filter_t *) &setpointShaping.derivativeLpf[axis], (const filter_t *) &filters->derivativeLpf);
+        } else {
+            setpointShaping.itermRelaxLpf[axis] = filters->itermRelaxLpf;
+            setpointShaping.derivativeLpf[axis] = filters->derivativeLpf;
+        }
+
+#ifdef USE_D_BOOST
+        if (keepState) {
+            filterUpdateCoefficients((filterApplyFnPtr) biquadFilterApply, &dBoostGyroLpf[axis], (const filter_t *) &filters->dBoostGyroLpf);
+        } else {
+            dBoostGyroLpf[axis].biquad = filters->dBoostGyroLpf;
+        }
+#endif
     }
 
 #ifdef USE_ANTIGRAVITY
-    pt1FilterInit(&antigravityThrottleLpf, pidProfile()->antigravityCutoff, TASK_PERIOD_HZ(TASK_AUX_RATE_HZ) * 1e-6f);
+    if (keepState) {
+        filterUpdateCoefficients((filterApplyFnPtr) pt1FilterApply, (filter_t *) &antigravityThrottleLpf, (const filter_t *) &filters->antigravityThrottleLpf);
+    } else {
+        antigravityThrottleLpf = filters->antigravityThrottleLpf;
+    }
 #endif
 
-#ifdef USE_D_BOOST
+    pidFiltersProfileIndex = profileIndex;
+}
+
+#ifdef USE_SMITH_PREDICTOR
+static void pidInitSmithPredictors(void)
+{
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        biquadFilterInitLPF(&pidState[axis].dBoostGyroLpf, pidProfile()->dBoostGyroDeltaLpfHz, getLooptime());
+        smithPredictorInit(
+            &pidState[axis].smithPredictor,
+            pidProfile()->smithPredictorDelay,
+            pidProfile()->smithPredictorStrength,
+            pidProfile()->smithPredictorFilterHz,
+            getLooptime(),
+            pidProfile()->smithPredictorAdaptive
+        );
     }
+}
 #endif
 
-    if (pidProfile()->controlDerivativeLpfHz) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            pt3FilterInit(&pidState[axis].rateTargetFilter, pt3FilterGain(pidProfile()->controlDerivativeLpfHz, refreshRate * 1e-6f));
-        }
+FUNCTION_COMPILE_FOR_SIZE
+bool pidInitFilters(void)
+{
+    const uint32_t refreshRate = getLooptime();
+
+    if (refreshRate == 0) {
+        return false;
     }
 
+    pidUpdateProfileFilters(refreshRate);
+    pidLoadProfileFilters(getConfigProfile(), false);
+
 #ifdef USE_SMITH_PREDICTOR
-    smithPredictorInit(
-        &pidState[FD_ROLL].smithPredictor,
-        pidProfile()->smithPredictorDelay,
-        pidProfile()->smithPredictorStrength,
-        pidProfile()->smithPredictorFilterHz,
-        getLooptime()
-    );
-    smithPredictorInit(
-        &pidState[FD_PITCH].smithPredictor,
-        pidProfile()->smithPredictorDelay,
-        pidProfile()->smithPredictorStrength,
-        pidProfile()->smithPredictorFilterHz,
-        getLooptime()
-    );
-    smithPredictorInit(
-        &pidState[FD_YAW].smithPredictor,
-        pidProfile()->smithPredictorDelay,
-        pidProfile()->smithPredictorStrength,
-        pidProfile()->smithPredictorFilterHz,
-        getLooptime()
-    );
+    pidInitSmithPredictors();
 #endif
 
     pidFiltersConfigured = true;
@@ -388,25 +499,25 @@ void pidResetErrorAccumulators(void)
 {
     // Reset R/P/Y integrator
     for (int axis = 0; axis < 3; axis++) {
-        pidState[axis].errorGyroIf = 0.0f;
-        pidState[axis].errorGyroIfLimit = 0.0f;
+        pidAxis.errorGyroIf[axis] = 0.0f;
+        pidAxis.errorGyroIfLimit[axis] = 0.0f;
     }
 }
 
 void pidReduceErrorAccumulators(int8_t delta, uint8_t axis)
 {
-    pidState[axis].errorGyroIf -= delta;
-    pidState[axis].errorGyroIfLimit -= delta;
+    pidAxis.errorGyroIf[axis] -= delta;
+    pidAxis.errorGyroIfLimit[axis] -= delta;
 }
 
 float getTotalRateTarget(void)
 {
-    return calc_length_pythagorean_3D(pidState[FD_ROLL].rateTarget, pidState[FD_PITCH].rateTarget, pidState[FD_YAW].rateTarget);
+    return calc_length_pythagorean_3D(pidAxis.rateTarget[FD_ROLL], pidAxis.rateTarget[FD_PITCH], pidAxis.rateTarget[FD_YAW]);
 }
 
 float getAxisIterm(uint8_t axis)
 {
-    return pidState[axis].errorGyroIf;
+    return pidAxis.errorGyroIf[axis];
 }
 
 static float pidRcCommandToAngle(int16_t stick, int16_t maxInclination)
@@ -438,48 +549,35 @@ float pidRcCommandToRate(int16_t stick, uint8_t rate)
     return scaleRangef((float) stick, -500.0f, 500.0f, -maxRateDPS, maxRateDPS);
 }
 
-static float calculateFixedWingTPAFactor(uint16_t throttle)
+#ifdef USE_PITOT
+// Gains scale with (reference airspeed / airspeed)^pow, the airspeed is the last one of the pitot task
+static float calculateFixedWingAirspeedTPAFactor(void)
 {
-    float tpaFactor;
+    const float airspeed = MAX(getAirspeedEstimate(), FW_TPA_AIRSPEED_MIN);
+    const float tpaFactor = powf(pidProfile()->fixedWingReferenceAirspeed / airspeed, pidProfile()->fixedWingTpaAirspeedPow / 100.0f);
 
-    // tpa_rate is amount of curve TPA applied to PIDs
-    // tpa_breakpoint for fixed wing is cruise throttle value (value at which PIDs were tuned)
-    if (currentControlRateProfile->throttle.dynPID != 0 && currentControlRateProfile->throttle.pa_breakpoint > getThrottleIdleValue() && !FLIGHT_MODE(AUTO_TUNE) && ARMING_FLAG(ARMED)) {
-        if (throttle > getThrottleIdleValue()) {
-            // Calculate TPA according to throttle
-            tpaFactor = 0.5f + ((float)(currentControlRateProfile->throttle.pa_breakpoint - getThrottleIdleValue()) / (throttle - getThrottleIdleValue()) / 2.0f);
+    return constrainf(tpaFactor, FW_TPA_AIRSPEED_FACTOR_MIN, FW_TPA_AIRSPEED_FACTOR_MAX);
+}
+#endif
 
-            // Limit to [0.5; 2] range
-            tpaFactor = constrainf(tpaFactor, 0.5f, 2.0f);
-        }
-        else {
-            tpaFactor = 2.0f;
+static float calculateFixedWingTPAFactor(uint16_t throttle)
+{
+    // TPA curve is baked per control rate profile, autotune and disarmed state always use the tuned gains
+    if (!FLIGHT_MODE(AUTO_TUNE) && ARMING_FLAG(ARMED)) {
+#ifdef USE_PITOT
+        if (pidProfile()->fixedWingTpaAirspeedPow && pitotHasValidAirspeed()) {
+            return calculateFixedWingAirspeedTPAFactor();
         }
-
-        // Attenuate TPA curve according to configured amount
-        tpaFactor = 1.0f + (tpaFactor - 1.0f) * (currentControlRateProfile->throttle.dynPID / 100.0f);
-    }
-    else {
-        tpaFactor = 1.0f;
+#endif
+        return rcLookupTpa(TPA_CURVE_FIXED_WING, throttle);
     }
 
-    return tpaFactor;
+    return 1.0f;
 }
 
-static float calculateMultirotorTPAFactor(void)
+static float calculateMultirotorTPAFactor(uint16_t throttle)
 {
-    float tpaFactor;
-
-    // TPA should be updated only when TPA is actually set
-    if (currentControlRateProfile->throttle.dynPID == 0 || rcCommand[THROTTLE] < currentControlRateProfile->throttle.pa_breakpoint) {
-        tpaFactor = 1.0f;
-    } else if (rcCommand[THROTTLE] < motorConfig()->maxthrottle) {
-        tpaFactor = (100 - (uint16_t)currentControlRateProfile->throttle.dynPID * (rcCommand[THROTTLE] - currentControlRateProfile->throttle.pa_breakpoint) / (float)(motorConfig()->maxthrottle - currentControlRateProfile->throttle.pa_breakpoint)) / 100.0f;
-    } else {
-        tpaFactor = (100 - currentControlRateProfile->throttle.dynPID) / 100.0f;
-    }
-
-    return tpaFactor;
+    return rcLookupTpa(TPA_CURVE_MULTIROTOR, throttle);
 }
 
 void schedulePidGainsUpdate(void)
@@ -489,21 +587,22 @@ void schedulePidGainsUpdate(void)
 
 void updatePIDCoefficients()
 {
-    STATIC_FASTRAM uint16_t prevThrottle = 0;
+    STATIC_FASTRAM float prevTpaFactor = 1.0f;
 
-    // Check if throttle changed. Different logic for fixed wing vs multirotor
+    // Different throttle source for fixed wing vs multirotor
+    uint16_t throttle;
     if (usedPidControllerType == PID_TYPE_PIFF && (currentControlRateProfile->throttle.fixedWingTauMs > 0)) {
-        uint16_t filteredThrottle = pt1FilterApply(&fixedWingTpaFilter, rcCommand[THROTTLE]);
-        if (filteredThrottle != prevThrottle) {
-            prevThrottle = filteredThrottle;
-            pidGainsUpdateRequired = true;
-        }
+        throttle = pt1FilterApply(&fixedWingTpaFilter, rcCommand[THROTTLE]);
     }
     else {
-        if (rcCommand[THROTTLE] != prevThrottle) {
-            prevThrottle = rcCommand[THROTTLE];
-            pidGainsUpdateRequired = true;
-        }
+        throttle = rcCommand[THROTTLE];
+    }
+
+    // Rescale gains only when the TPA factor actually moved, not on every throttle change
+    const float tpaFactor = usedPidControllerType == PID_TYPE_PIFF ? calculateFixedWingTPAFactor(throttle) : calculateMultirotorTPAFactor(throttle);
+    if (tpaFactor != prevTpaFactor) {
+        prevTpaFactor = tpaFactor;
+        pidGainsUpdateRequired = true;
     }
 
 #ifdef USE_ANTIGRAVITY
@@ -525,33 +624,31 @@ void updatePIDCoefficients()
         return;
     }
 
-    const float tpaFactor = usedPidControllerType == PID_TYPE_PIFF ? calculateFixedWingTPAFactor(prevThrottle) : calculateMultirotorTPAFactor();
-
     // PID coefficients can be update only with THROTTLE and TPA or inflight PID adjustments
     //TODO: Next step would be to update those only at THROTTLE or inflight adjustments change
     for (int axis = 0; axis < 3; axis++) {
         if (usedPidControllerType == PID_TYPE_PIFF) {
             // Airplanes - scale all PIDs according to TPA
-            pidState[axis].kP  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER  * tpaFactor;
-            pidState[axis].kI  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER  * tpaFactor;
-            pidState[axis].kD  = pidBank()->pid[axis].D / FP_PID_RATE_D_MULTIPLIER * tpaFactor;
-            pidState[axis].kFF = pidBank()->pid[axis].FF / FP_PID_RATE_FF_MULTIPLIER * tpaFactor;
-            pidState[axis].kCD = 0.0f;
-            pidState[axis].kT  = 0.0f;
+            pidAxis.kP[axis]  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER  * tpaFactor;
+            pidAxis.kI[axis]  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER  * tpaFactor;
+            pidAxis.kD[axis]  = pidBank()->pid[axis].D / FP_PID_RATE_D_MULTIPLIER * tpaFactor;
+            pidAxis.kFF[axis] = pidBank()->pid[axis].FF / FP_PID_RATE_FF_MULTIPLIER * tpaFactor;
+            pidAxis.kCD[axis] = 0.0f;
+            pidAxis.kT[axis]  = 0.0f;
         }
         else {
             const float axisTPA = (axis == FD_YAW) ? 1.0f : tpaFactor;
-            pidState[axis].kP  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER * axisTPA;
-            pidState[axis].kI  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER;
-            pidState[axis].kD  = pidBank()->pid[axis].D / FP_PID_RATE_D_MULTIPLIER * axisTPA;
-            pidState[axis].kCD = (pidBank()->pid[axis].FF / FP_PID_RATE_D_FF_MULTIPLIER * axisTPA) / (getLooptime() * 0.000001f);
-            pidState[axis].kFF = 0.0f;
+            pidAxis.kP[axis]  = pidBank()->pid[axis].P / FP_PID_RATE_P_MULTIPLIER * axisTPA;
+            pidAxis.kI[axis]  = pidBank()->pid[axis].I / FP_PID_RATE_I_MULTIPLIER;
+            pidAxis.kD[axis]  = pidBank()->pid[axis].D / FP_PID_RATE_D_MULTIPLIER * axisTPA;
+            pidAxis.kCD[axis] = (pidBank()->pid[axis].FF / FP_PID_RATE_D_FF_MULTIPLIER * axisTPA) / (getLooptime() * 0.000001f);
+            pidAxis.kFF[axis] = 0.0f;
 
             // Tracking anti-windup requires P/I/D to be all defined which is only true for MC
             if ((pidBank()->pid[axis].P != 0) && (pidBank()->pid[axis].I != 0) && (usedPidControllerType == PID_TYPE_PID)) {
-                pidState[axis].kT = 2.0f / ((pidState[axis].kP / pidState[axis].kI) + (pidState[axis].kD / pidState[axis].kP));
+                pidAxis.kT[axis] = 2.0f / ((pidAxis.kP[axis] / pidAxis.kI[axis]) + (pidAxis.kD[axis] / pidAxis.kP[axis]));
             } else {
-                pidState[axis].kT = 0;
+                pidAxis.kT[axis] = 0;
             }
         }
     }
@@ -646,8 +743,8 @@ static void pidLevel(const float angleTarget, pidState_t *pidState, flight_dynam
     if (FLIGHT_MODE(SOARING_MODE) && axis == FD_PITCH && calculateRollPitchCenterStatus() == CENTERED) {
         angleErrorDeg = DECIDEGREES_TO_DEGREES((float)angleFreefloatDeadband(DEGREES_TO_DECIDEGREES(navConfig()->fw.soaring_pitch_deadband), FD_PITCH));
         if (!angleErrorDeg) {
-            pidState->errorGyroIf = 0.0f;
-            pidState->errorGyroIfLimit = 0.0f;
+            pidAxis.errorGyroIf[axis] = 0.0f;
+            pidAxis.errorGyroIfLimit[axis] = 0.0f;
         }
     }
 
@@ -671,19 +768,45 @@ static void pidLevel(const float angleTarget, pidState_t *pidState, flight_dynam
 
     // P[LEVEL] defines self-leveling strength (both for ANGLE and HORIZON modes)
     if (FLIGHT_MODE(HORIZON_MODE)) {
-        pidState->rateTarget = (1.0f - horizonRateMagnitude) * angleRateTarget + horizonRateMagnitude * pidState->rateTarget;
+        pidAxis.rateTarget[axis] = (1.0f - horizonRateMagnitude) * angleRateTarget + horizonRateMagnitude * pidAxis.rateTarget[axis];
     } else {
-        pidState->rateTarget = angleRateTarget;
+        pidAxis.rateTarget[axis] = angleRateTarget;
     }
 }
 
 /* Apply angular acceleration limit to rate target to limit extreme stick inputs to respect physical capabilities of the machine */
-static void pidApplySetpointRateLimiting(pidState_t *pidState, flight_dynamics_index_t axis, float dT)
+/*
+ * Everything derived from the setpoint alone, for all axes in one pass: rate of
+ * change limiting, logic condition overrides and, for the multicopter controller,
+ * the control derivative input and the iterm relax setpoint HPF
+ */
+static void FAST_CODE pidShapeSetpoints(float dT)
 {
-    const uint32_t axisAccelLimit = (axis == FD_YAW) ? pidProfile()->axisAccelerationLimitYaw : pidProfile()->axisAccelerationLimitRollPitch;
+    const bool multicopterShaping = usedPidControllerType == PID_TYPE_PID;
 
-    if (axisAccelLimit > AXIS_ACCEL_MIN_LIMIT) {
-        pidState->rateTarget = rateLimitFilterApply4(&pidState->axisAccelFilter, pidState->rateTarget, (float)axisAccelLimit, dT);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // Apply setpoint rate of change limits
+        const uint32_t axisAccelLimit = (axis == FD_YAW) ? pidProfile()->axisAccelerationLimitYaw : pidProfile()->axisAccelerationLimitRollPitch;
+        if (axisAccelLimit > AXIS_ACCEL_MIN_LIMIT) {
+            pidAxis.rateTarget[axis] = rateLimitFilterApply4(&setpointShaping.accelLimit[axis], pidAxis.rateTarget[axis], (float)axisAccelLimit, dT);
+        }
+
+        const float rateTarget = getFlightAxisRateOverride(axis, pidAxis.rateTarget[axis]);
+        pidAxis.shapedRateTarget[axis] = rateTarget;
+
+        if (!multicopterShaping) {
+            continue;
+        }
+
+        pidAxis.rateTargetDerivative[axis] = pt3FilterApply(&setpointShaping.derivativeLpf[axis], rateTarget - pidAxis.previousRateTarget[axis]);
+
+        if (itermRelax && (axis < FD_YAW || itermRelax == ITERM_RELAX_RPY)) {
+            const float setpointLpf = pt1FilterApply(&setpointShaping.itermRelaxLpf[axis], rateTarget);
+            const float setpointHpf = fabsf(rateTarget - setpointLpf);
+            pidAxis.itermRelaxFactor[axis] = MAX(0, 1 - setpointHpf / MC_ITERM_RELAX_SETPOINT_THRESHOLD);
+        } else {
+            pidAxis.itermRelaxFactor[axis] = 1.0f;
+        }
     }
 }
 
@@ -701,183 +824,194 @@ bool isFixedWingItermLimitActive(float stickPosition)
 }
 
 static float pTermProcess(pidState_t *pidState, float rateError, float dT) {
-    float newPTerm = rateError * pidState->kP;
+    float newPTerm = rateError * pidAxis.kP[pidState->axis];
 
     return pidState->ptermFilterApplyFn(&pidState->ptermLpfState, newPTerm, yawLpfHz, dT);
 }
 
 #ifdef USE_D_BOOST
-static float FAST_CODE applyDBoost(pidState_t *pidState, float currentRateTarget, float dT) {
+static void FAST_CODE applyDBoostAxes(float *dBoost, float dT)
+{
+    float dBoostGyroAcceleration[XYZ_AXIS_COUNT];
 
-    float dBoost = 1.0f;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        dBoostGyroAcceleration[axis] = (pidAxis.gyroRate[axis] - pidAxis.previousRateGyro[axis]) / dT;
+    }
+    biquadFilterApplyAxes(dBoostGyroLpf, dBoostGyroAcceleration);
 
-    const float dBoostGyroDelta = (pidState->gyroRate - pidState->previousRateGyro) / dT;
-    const float dBoostGyroAcceleration = fabsf(biquadFilterApply(&pidState->dBoostGyroLpf, dBoostGyroDelta));
-    const float dBoostRateAcceleration = fabsf((currentRateTarget - pidState->previousRateTarget) / dT);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float gyroAcceleration = fabsf(dBoostGyroAcceleration[axis]);
+        const float rateAcceleration = fabsf((pidAxis.shapedRateTarget[axis] - pidAxis.previousRateTarget[axis]) / dT);
 
-    if (dBoostGyroAcceleration >= dBoostRateAcceleration) {
-        //Gyro is accelerating faster than setpoint, we want to smooth out
-        dBoost = scaleRangef(dBoostGyroAcceleration, 0.0f, dBoostMaxAtAlleceleration, 1.0f, dBoostMax);
-    } else {
-        //Setpoint is accelerating, we want to boost response
-        dBoost = scaleRangef(dBoostRateAcceleration, 0.0f, pidState->dBoostTargetAcceleration, 1.0f, dBoostMin);
+        if (gyroAcceleration >= rateAcceleration) {
+            //Gyro is accelerating faster than setpoint, we want to smooth out
+            dBoost[axis] = scaleRangef(gyroAcceleration, 0.0f, dBoostMaxAtAlleceleration, 1.0f, dBoostMax);
+        } else {
+            //Setpoint is accelerating, we want to boost response
+            dBoost[axis] = scaleRangef(rateAcceleration, 0.0f, pidState[axis].dBoostTargetAcceleration, 1.0f, dBoostMin);
+        }
     }
 
-    dBoost = pt1FilterApply4(&pidState->dBoostLpf, dBoost, D_BOOST_LPF_HZ, dT);
-    dBoost = constrainf(dBoost, dBoostMin, dBoostMax);
+    pt1FilterApplyAxes4(dBoostLpf, dBoost, D_BOOST_LPF_HZ, dT);
 
-    return dBoost;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        dBoost[axis] = constrainf(dBoost[axis], dBoostMin, dBoostMax);
+    }
 }
 #else
-static float applyDBoost(pidState_t *pidState, float dT) {
-    UNUSED(pidState);
+static void applyDBoostAxes(float *dBoost, float dT)
+{
     UNUSED(dT);
-    return 1.0f;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        dBoost[axis] = 1.0f;
+    }
 }
 #endif
 
-static float dTermProcess(pidState_t *pidState, float currentRateTarget, float dT) {
-    // Calculate new D-term
-    float newDTerm = 0;
-    if (pidState->kD == 0) {
-        // optimisation for when D is zero, often used by YAW axis
-        newDTerm = 0;
-    } else {
-        float delta = pidState->previousRateGyro - pidState->gyroRate;
+/*
+ * D-term of all axes in one pass. All axes share the D-term cutoffs, so the
+ * filter chain always runs as one vector operation, also for axes with D = 0
+ */
+static void FAST_CODE dTermProcessAxes(float *dTerms, float dT)
+{
+    float dBoost[XYZ_AXIS_COUNT];
 
-        delta = dTermLpfFilterApplyFn((filter_t *) &pidState->dtermLpfState, delta);
-        delta = dTermLpf2FilterApplyFn((filter_t *) &pidState->dtermLpf2State, delta);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        dTerms[axis] = pidAxis.previousRateGyro[axis] - pidAxis.gyroRate[axis];
+    }
 
+#ifdef USE_FILTER_CHAIN_SPECIALIZATION
+    dTermFilterChainApplyFn(dtermLpfState, dtermLpf2State, dTerms);
+#else
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        dTerms[axis] = dTermLpf2FilterApplyFn(&dtermLpf2State[axis], dTermLpfFilterApplyFn(&dtermLpfState[axis], dTerms[axis]));
+    }
+#endif
+
+    applyDBoostAxes(dBoost, dT);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         // Calculate derivative
-        newDTerm =  delta * (pidState->kD / dT) * applyDBoost(pidState, currentRateTarget, dT);
+        dTerms[axis] = dTerms[axis] * (pidAxis.kD[axis] / dT) * dBoost[axis];
     }
-    return(newDTerm);
 }
 
-static void applyItermLimiting(pidState_t *pidState) {
-    if (pidState->itermLimitActive) {
-        pidState->errorGyroIf = constrainf(pidState->errorGyroIf, -pidState->errorGyroIfLimit, pidState->errorGyroIfLimit);
+static void applyItermLimiting(flight_dynamics_index_t axis) {
+    if (pidAxis.itermLimitActive[axis]) {
+        pidAxis.errorGyroIf[axis] = constrainf(pidAxis.errorGyroIf[axis], -pidAxis.errorGyroIfLimit[axis], pidAxis.errorGyroIfLimit[axis]);
     } else
     {
-        pidState->errorGyroIfLimit = fabsf(pidState->errorGyroIf);
+        pidAxis.errorGyroIfLimit[axis] = fabsf(pidAxis.errorGyroIf[axis]);
     }
 }
 
-static void nullRateController(pidState_t *pidState, flight_dynamics_index_t axis, float dT) {
-    UNUSED(pidState);
-    UNUSED(axis);
+static void nullRateController(float dT) {
     UNUSED(dT);
 }
 
-static void NOINLINE pidApplyFixedWingRateController(pidState_t *pidState, flight_dynamics_index_t axis, float dT)
+static void NOINLINE pidApplyFixedWingRateController(float dT)
 {
-    const float rateTarget = getFlightAxisRateOverride(axis, pidState->rateTarget);
+    float dTerms[XYZ_AXIS_COUNT];
 
-    const float rateError = rateTarget - pidState->gyroRate;
-    const float newPTerm = pTermProcess(pidState, rateError, dT);
-    const float newDTerm = dTermProcess(pidState, rateTarget, dT);
-    const float newFFTerm = rateTarget * pidState->kFF;
+    dTermProcessAxes(dTerms, dT);
 
-    /*
-     * Integral should be updated only if axis Iterm is not frozen
-     */
-    if (!pidState->itermFreezeActive) {
-        pidState->errorGyroIf += rateError * pidState->kI * dT;
-    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pidState_t *axisState = &pidState[axis];
+        const float rateTarget = pidAxis.shapedRateTarget[axis];
 
-    applyItermLimiting(pidState);
+        const float rateError = rateTarget - pidAxis.gyroRate[axis];
+        const float newPTerm = pTermProcess(axisState, rateError, dT);
+        const float newDTerm = dTerms[axis];
+        const float newFFTerm = rateTarget * pidAxis.kFF[axis];
 
-    if (pidProfile()->fixedWingItermThrowLimit != 0) {
-        pidState->errorGyroIf = constrainf(pidState->errorGyroIf, -pidProfile()->fixedWingItermThrowLimit, pidProfile()->fixedWingItermThrowLimit);
-    }
+        /*
+         * Integral should be updated only if axis Iterm is not frozen
+         */
+        if (!pidAxis.itermFreezeActive[axis]) {
+            pidAxis.errorGyroIf[axis] += rateError * pidAxis.kI[axis] * dT;
+        }
 
-    axisPID[axis] = constrainf(newPTerm + newFFTerm + pidState->errorGyroIf + newDTerm, -pidState->pidSumLimit, +pidState->pidSumLimit);
+        applyItermLimiting(axis);
 
-    if (FLIGHT_MODE(SOARING_MODE) && axis == FD_PITCH && calculateRollPitchCenterStatus() == CENTERED) {
-        if (!angleFreefloatDeadband(DEGREES_TO_DECIDEGREES(navConfig()->fw.soaring_pitch_deadband), FD_PITCH)) {
-            axisPID[FD_PITCH] = 0;  // center pitch servo if pitch attitude within soaring mode deadband
+        if (pidProfile()->fixedWingItermThrowLimit != 0) {
+            pidAxis.errorGyroIf[axis] = constrainf(pidAxis.errorGyroIf[axis], -pidProfile()->fixedWingItermThrowLimit, pidProfile()->fixedWingItermThrowLimit);
+        }
+
+        axisPID[axis] = constrainf(newPTerm + newFFTerm + pidAxis.errorGyroIf[axis] + newDTerm, -pidAxis.pidSumLimit[axis], +pidAxis.pidSumLimit[axis]);
+
+        if (FLIGHT_MODE(SOARING_MODE) && axis == FD_PITCH && calculateRollPitchCenterStatus() == CENTERED) {
+            if (!angleFreefloatDeadband(DEGREES_TO_DECIDEGREES(navConfig()->fw.soaring_pitch_deadband), FD_PITCH)) {
+                axisPID[FD_PITCH] = 0;  // center pitch servo if pitch attitude within soaring mode deadband
+            }
         }
-    }
 
 #ifdef USE_AUTOTUNE_FIXED_WING
-    if (FLIGHT_MODE(AUTO_TUNE) && !FLIGHT_MODE(MANUAL_MODE)) {
-        autotuneFixedWingUpdate(axis, rateTarget, pidState->gyroRate, constrainf(newPTerm + newFFTerm, -pidState->pidSumLimit, +pidState->pidSumLimit));
-    }
+        if (FLIGHT_MODE(AUTO_TUNE) && !FLIGHT_MODE(MANUAL_MODE)) {
+            autotuneFixedWingUpdate(axis, rateTarget, pidAxis.gyroRate[axis], constrainf(newPTerm + newFFTerm, -pidAxis.pidSumLimit[axis], +pidAxis.pidSumLimit[axis]));
+        }
 #endif
 
 #ifdef USE_BLACKBOX
-    axisPID_P[axis] = newPTerm;
-    axisPID_I[axis] = pidState->errorGyroIf;
-    axisPID_D[axis] = newDTerm;
-    axisPID_F[axis] = newFFTerm;
-    axisPID_Setpoint[axis] = rateTarget;
+        axisPID_P[axis] = newPTerm;
+        axisPID_I[axis] = pidAxis.errorGyroIf[axis];
+        axisPID_D[axis] = newDTerm;
+        axisPID_F[axis] = newFFTerm;
+        axisPID_Setpoint[axis] = rateTarget;
 #endif
 
-    pidState->previousRateGyro = pidState->gyroRate;
-
-}
-
-static float FAST_CODE applyItermRelax(const int axis, float currentPidSetpoint, float itermErrorRate)
-{
-    if (itermRelax) {
-        if (axis < FD_YAW || itermRelax == ITERM_RELAX_RPY) {
-
-            const float setpointLpf = pt1FilterApply(&windupLpf[axis], currentPidSetpoint);
-            const float setpointHpf = fabsf(currentPidSetpoint - setpointLpf);
-
-            const float itermRelaxFactor = MAX(0, 1 - setpointHpf / MC_ITERM_RELAX_SETPOINT_THRESHOLD);
-            return itermErrorRate * itermRelaxFactor;
-        }
+        pidAxis.previousRateGyro[axis] = pidAxis.gyroRate[axis];
     }
-
-    return itermErrorRate;
 }
 
-static void FAST_CODE NOINLINE pidApplyMulticopterRateController(pidState_t *pidState, flight_dynamics_index_t axis, float dT)
+static void FAST_CODE NOINLINE pidApplyMulticopterRateController(float dT)
 {
+    float dTerms[XYZ_AXIS_COUNT];
 
-    const float rateTarget = getFlightAxisRateOverride(axis, pidState->rateTarget);
+    dTermProcessAxes(dTerms, dT);
 
-    const float rateError = rateTarget - pidState->gyroRate;
-    const float newPTerm = pTermProcess(pidState, rateError, dT);
-    const float newDTerm = dTermProcess(pidState, rateTarget, dT);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pidState_t *axisState = &pidState[axis];
+        const float rateTarget = pidAxis.shapedRateTarget[axis];
 
-    const float rateTargetDelta = rateTarget - pidState->previousRateTarget;
-    const float rateTargetDeltaFiltered = pt3FilterApply(&pidState->rateTargetFilter, rateTargetDelta);
+        const float rateError = rateTarget - pidAxis.gyroRate[axis];
+        const float newPTerm = pTermProcess(axisState, rateError, dT);
+        const float newDTerm = dTerms[axis];
 
-    /*
-     * Compute Control Derivative
-     */
-    const float newCDTerm = rateTargetDeltaFiltered * pidState->kCD;
+        /*
+         * Compute Control Derivative
+         */
+        const float newCDTerm = pidAxis.rateTargetDerivative[axis] * pidAxis.kCD[axis];
 
-    // TODO: Get feedback from mixer on available correction range for each axis
-    const float newOutput = newPTerm + newDTerm + pidState->errorGyroIf + newCDTerm;
-    const float newOutputLimited = constrainf(newOutput, -pidState->pidSumLimit, +pidState->pidSumLimit);
+        // TODO: Get feedback from mixer on available correction range for each axis
+        const float newOutput = newPTerm + newDTerm + pidAxis.errorGyroIf[axis] + newCDTerm;
+        const float newOutputLimited = constrainf(newOutput, -pidAxis.pidSumLimit[axis], +pidAxis.pidSumLimit[axis]);
 
-    float itermErrorRate = applyItermRelax(axis, rateTarget, rateError);
+        float itermErrorRate = rateError * pidAxis.itermRelaxFactor[axis];
 
 #ifdef USE_ANTIGRAVITY
-    itermErrorRate *= iTermAntigravityGain;
+        itermErrorRate *= iTermAntigravityGain;
 #endif
 
-    pidState->errorGyroIf += (itermErrorRate * pidState->kI * antiWindupScaler * dT)
-                             + ((newOutputLimited - newOutput) * pidState->kT * antiWindupScaler * dT);
+        pidAxis.errorGyroIf[axis] += (itermErrorRate * pidAxis.kI[axis] * antiWindupScaler * dT)
+                                     + ((newOutputLimited - newOutput) * pidAxis.kT[axis] * antiWindupScaler * dT);
 
-    // Don't grow I-term if motors are at their limit
-    applyItermLimiting(pidState);
+        // Don't grow I-term if motors are at their limit
+        applyItermLimiting(axis);
 
-    axisPID[axis] = newOutputLimited;
+        axisPID[axis] = newOutputLimited;
 
 #ifdef USE_BLACKBOX
-    axisPID_P[axis] = newPTerm;
-    axisPID_I[axis] = pidState->errorGyroIf;
-    axisPID_D[axis] = newDTerm;
-    axisPID_F[axis] = newCDTerm;
-    axisPID_Setpoint[axis] = rateTarget;
+        axisPID_P[axis] = newPTerm;
+        axisPID_I[axis] = pidAxis.errorGyroIf[axis];
+        axisPID_D[axis] = newDTerm;
+        axisPID_F[axis] = newCDTerm;
+        axisPID_Setpoint[axis] = rateTarget;
 #endif
 
-    pidState->previousRateTarget = rateTarget;
-    pidState->previousRateGyro = pidState->gyroRate;
+        pidAxis.previousRateTarget[axis] = rateTarget;
+        pidAxis.previousRateGyro[axis] = pidAxis.gyroRate[axis];
+    }
 }
 
 void updateHeadingHoldTarget(int16_t heading)
@@ -980,7 +1114,7 @@ float pidHeadingHold(float dT)
  * TURN ASSISTANT mode is an assisted mode to do a Yaw rotation on a ground plane, allowing one-stick turn in RATE more
  * and keeping ROLL and PITCH attitude though the turn.
  */
-static void NOINLINE pidTurnAssistant(pidState_t *pidState, float bankAngleTarget, float pitchAngleTarget)
+static void NOINLINE pidTurnAssistant(float bankAngleTarget, float pitchAngleTarget)
 {
     fpVector3_t targetRates;
     targetRates.x = 0.0f;
@@ -1018,26 +1152,26 @@ static void NOINLINE pidTurnAssistant(pidState_t *pidState, float bankAngleTarge
         }
     }
     else {
-        targetRates.z = pidState[YAW].rateTarget;
+        targetRates.z = pidAxis.rateTarget[YAW];
     }
 
     // Transform calculated rate offsets into body frame and apply
     imuTransformVectorEarthToBody(&targetRates);
 
     // Add in roll and pitch
-    pidState[ROLL].rateTarget = constrainf(pidState[ROLL].rateTarget + targetRates.x, -currentControlRateProfile->stabilized.rates[ROLL] * 10.0f, currentControlRateProfile->stabilized.rates[ROLL] * 10.0f);
-    pidState[PITCH].rateTarget = constrainf(pidState[PITCH].rateTarget + targetRates.y * pidProfile()->fixedWingCoordinatedPitchGain, -currentControlRateProfile->stabilized.rates[PITCH] * 10.0f, currentControlRateProfile->stabilized.rates[PITCH] * 10.0f);
+    pidAxis.rateTarget[ROLL] = constrainf(pidAxis.rateTarget[ROLL] + targetRates.x, -currentControlRateProfile->stabilized.rates[ROLL] * 10.0f, currentControlRateProfile->stabilized.rates[ROLL] * 10.0f);
+    pidAxis.rateTarget[PITCH] = constrainf(pidAxis.rateTarget[PITCH] + targetRates.y * pidProfile()->fixedWingCoordinatedPitchGain, -currentControlRateProfile->stabilized.rates[PITCH] * 10.0f, currentControlRateProfile->stabilized.rates[PITCH] * 10.0f);
 
     // Replace YAW on quads - add it in on airplanes
     if (STATE(AIRPLANE)) {
-        pidState[YAW].rateTarget = constrainf(pidState[YAW].rateTarget + targetRates.z * pidProfile()->fixedWingCoordinatedYawGain, -currentControlRateProfile->stabilized.rates[YAW] * 10.0f, currentControlRateProfile->stabilized.rates[YAW] * 10.0f);
+        pidAxis.rateTarget[YAW] = constrainf(pidAxis.rateTarget[YAW] + targetRates.z * pidProfile()->fixedWingCoordinatedYawGain, -currentControlRateProfile->stabilized.rates[YAW] * 10.0f, currentControlRateProfile->stabilized.rates[YAW] * 10.0f);
     }
     else {
-        pidState[YAW].rateTarget = constrainf(targetRates.z, -currentControlRateProfile->stabilized.rates[YAW] * 10.0f, currentControlRateProfile->stabilized.rates[YAW] * 10.0f);
+        pidAxis.rateTarget[YAW] = constrainf(targetRates.z, -currentControlRateProfile->stabilized.rates[YAW] * 10.0f, currentControlRateProfile->stabilized.rates[YAW] * 10.0f);
     }
 }
 
-static void pidApplyFpvCameraAngleMix(pidState_t *pidState, uint8_t fpvCameraAngle)
+static void pidApplyFpvCameraAngleMix(uint8_t fpvCameraAngle)
 {
     static uint8_t lastFpvCamAngleDegrees = 0;
     static float cosCameraAngle = 1.0f;
@@ -1050,39 +1184,39 @@ static void pidApplyFpvCameraAngleMix(pidState_t *pidState, uint8_t fpvCameraAng
     }
 
     // Rotate roll/yaw command from camera-frame coordinate system to body-frame coordinate system
-    const float rollRate = pidState[ROLL].rateTarget;
-    const float yawRate = pidState[YAW].rateTarget;
-    pidState[ROLL].rateTarget = constrainf(rollRate * cosCameraAngle -  yawRate * sinCameraAngle, -GYRO_SATURATION_LIMIT, GYRO_SATURATION_LIMIT);
-    pidState[YAW].rateTarget = constrainf(yawRate * cosCameraAngle + rollRate * sinCameraAngle, -GYRO_SATURATION_LIMIT, GYRO_SATURATION_LIMIT);
+    const float rollRate = pidAxis.rateTarget[ROLL];
+    const float yawRate = pidAxis.rateTarget[YAW];
+    pidAxis.rateTarget[ROLL] = constrainf(rollRate * cosCameraAngle -  yawRate * sinCameraAngle, -GYRO_SATURATION_LIMIT, GYRO_SATURATION_LIMIT);
+    pidAxis.rateTarget[YAW] = constrainf(yawRate * cosCameraAngle + rollRate * sinCameraAngle, -GYRO_SATURATION_LIMIT, GYRO_SATURATION_LIMIT);
 }
 
-void checkItermLimitingActive(pidState_t *pidState)
+void checkItermLimitingActive(flight_dynamics_index_t axis)
 {
     bool shouldActivate;
     if (usedPidControllerType == PID_TYPE_PIFF) {
-        shouldActivate = isFixedWingItermLimitActive(pidState->stickPosition);
+        shouldActivate = isFixedWingItermLimitActive(pidState[axis].stickPosition);
     } else
     {
         shouldActivate = mixerIsOutputSaturated();
     }
 
-    pidState->itermLimitActive = STATE(ANTI_WINDUP) || shouldActivate;
+    pidAxis.itermLimitActive[axis] = STATE(ANTI_WINDUP) || shouldActivate;
 }
 
-void checkItermFreezingActive(pidState_t *pidState, flight_dynamics_index_t axis)
+void checkItermFreezingActive(flight_dynamics_index_t axis)
 {
     if (usedPidControllerType == PID_TYPE_PIFF && pidProfile()->fixedWingYawItermBankFreeze != 0 && axis == FD_YAW) {
         // Do not allow yaw I-term to grow when bank angle is too large
         float bankAngle = DECIDEGREES_TO_DEGREES(attitude.values.roll);
         if (fabsf(bankAngle) > pidProfile()->fixedWingYawItermBankFreeze && !(FLIGHT_MODE(AUTO_TUNE) || FLIGHT_MODE(TURN_ASSISTANT) || navigationRequiresTurnAssistance())){
-            pidState->itermFreezeActive = true;
+            pidAxis.itermFreezeActive[axis] = true;
         } else
         {
-            pidState->itermFreezeActive = false;
+            pidAxis.itermFreezeActive[axis] = false;
         }
     } else
     {
-        pidState->itermFreezeActive = false;
+        pidAxis.itermFreezeActive[axis] = false;
     }
 
 }
@@ -1108,7 +1242,7 @@ void FAST_CODE pidController(float dT)
 
     for (int axis = 0; axis < 3; axis++) {
         // Step 1: Calculate gyro rates
-        pidState[axis].gyroRate = gyro.gyroADCf[axis];
+        pidAxis.gyroRate[axis] = gyro.gyroADCf[axis];
 
         // Step 2: Read target
         float rateTarget;
@@ -1124,14 +1258,14 @@ void FAST_CODE pidController(float dT)
         }
 
         // Limit desired rate to something gyro can measure reliably
-        pidState[axis].rateTarget = constrainf(rateTarget, -GYRO_SATURATION_LIMIT, +GYRO_SATURATION_LIMIT);
+        pidAxis.rateTarget[axis] = constrainf(rateTarget, -GYRO_SATURATION_LIMIT, +GYRO_SATURATION_LIMIT);
 
 #ifdef USE_GYRO_KALMAN
-        gyroKalmanUpdateSetpoint(axis, pidState[axis].rateTarget);
+        gyroKalmanUpdateSetpoint(axis, pidAxis.rateTarget[axis]);
 #endif
 
 #ifdef USE_SMITH_PREDICTOR
-        pidState[axis].gyroRate = applySmithPredictor(axis, &pidState[axis].smithPredictor, pidState[axis].gyroRate);
+        pidAxis.gyroRate[axis] = applySmithPredictor(axis, &pidState[axis].smithPredictor, pidAxis.gyroRate[axis], axisPID[axis]);
 #endif
     }
 
@@ -1153,27 +1287,28 @@ void FAST_CODE pidController(float dT)
     if ((FLIGHT_MODE(TURN_ASSISTANT) || navigationRequiresTurnAssistance()) && (FLIGHT_MODE(ANGLE_MODE) || FLIGHT_MODE(HORIZON_MODE) || navigationRequiresTurnAssistance())) {
         float bankAngleTarget = DECIDEGREES_TO_RADIANS(pidRcCommandToAngle(rcCommand[FD_ROLL], pidProfile()->max_angle_inclination[FD_ROLL]));
         float pitchAngleTarget = DECIDEGREES_TO_RADIANS(pidRcCommandToAngle(rcCommand[FD_PITCH], pidProfile()->max_angle_inclination[FD_PITCH]));
-        pidTurnAssistant(pidState, bankAngleTarget, pitchAngleTarget);
+        pidTurnAssistant(bankAngleTarget, pitchAngleTarget);
         canUseFpvCameraMix = false;     // FPVANGLEMIX is incompatible with TURN_ASSISTANT
     }
 
     if (canUseFpvCameraMix && IS_RC_MODE_ACTIVE(BOXFPVANGLEMIX) && currentControlRateProfile->misc.fpvCamAngleDegrees) {
-        pidApplyFpvCameraAngleMix(pidState, currentControlRateProfile->misc.fpvCamAngleDegrees);
+        pidApplyFpvCameraAngleMix(currentControlRateProfile->misc.fpvCamAngleDegrees);
     }
 
     // Prevent strong Iterm accumulation during stick inputs
     antiWindupScaler = constrainf((1.0f - getMotorMixRange()) / motorItermWindupPoint, 0.0f, 1.0f);
 
-    for (int axis = 0; axis < 3; axis++) {
-        // Apply setpoint rate of change limits
-        pidApplySetpointRateLimiting(&pidState[axis], axis, dT);
+    // Step 4: Shape the setpoints of all axes
+    pidShapeSetpoints(dT);
 
-        // Step 4: Run gyro-driven control
-        checkItermLimitingActive(&pidState[axis]);
-        checkItermFreezingActive(&pidState[axis], axis);
-
-        pidControllerApplyFn(&pidState[axis], axis, dT);
+    for (int axis = 0; axis < 3; axis++) {
+        // Step 5: Update I-term limiting and freezing
+        checkItermLimitingActive(axis);
+        checkItermFreezingActive(axis);
     }
+
+    // Step 6: Run gyro-driven control for all axes in a single pass
+    pidControllerApplyFn(dT);
 }
 
 pidType_e pidIndexGetType(pidIndex_e pidIndex)
@@ -1193,7 +1328,8 @@ pidType_e pidIndexGetType(pidIndex_e pidIndex)
     return PID_TYPE_PID;
 }
 
-void pidInit(void)
+// Profile derived values of the controller, cheap enough to compute on every profile switch
+static void pidApplyProfile(void)
 {
     // Calculate max overall tilt (max pitch + max roll combined) as a limit to heading hold
     headingHoldCosZLimit = cos_approx(DECIDEGREES_TO_RADIANS(pidProfile()->max_angle_inclination[FD_ROLL])) *
@@ -1227,14 +1363,14 @@ void pidInit(void)
 
         pidState[axis].axis = axis;
         if (axis == FD_YAW) {
-            pidState[axis].pidSumLimit = pidProfile()->pidSumLimitYaw;
+            pidAxis.pidSumLimit[axis] = pidProfile()->pidSumLimitYaw;
             if (yawLpfHz) {
                 pidState[axis].ptermFilterApplyFn = (filterApply4FnPtr) pt1FilterApply4;
             } else {
                 pidState[axis].ptermFilterApplyFn = (filterApply4FnPtr) nullFilterApply4;
             }
         } else {
-            pidState[axis].pidSumLimit = pidProfile()->pidSumLimit;
+            pidAxis.pidSumLimit[axis] = pidProfile()->pidSumLimit;
             pidState[axis].ptermFilterApplyFn = (filterApply4FnPtr) nullFilterApply4;
         }
     }
@@ -1255,6 +1391,10 @@ void pidInit(void)
 
     assignFilterApplyFn(pidProfile()->dterm_lpf_type, pidProfile()->dterm_lpf_hz, &dTermLpfFilterApplyFn);
     assignFilterApplyFn(pidProfile()->dterm_lpf2_type, pidProfile()->dterm_lpf2_hz, &dTermLpf2FilterApplyFn);
+#ifdef USE_FILTER_CHAIN_SPECIALIZATION
+    dTermFilterChainApplyFn = assignFilterChain2ApplyAxesFn(pidProfile()->dterm_lpf_type, pidProfile()->dterm_lpf_hz,
+                                                            pidProfile()->dterm_lpf2_type, pidProfile()->dterm_lpf2_hz);
+#endif
 
     if (usedPidControllerType == PID_TYPE_PIFF) {
         pidControllerApplyFn = pidApplyFixedWingRateController;
@@ -1264,9 +1404,14 @@ void pidInit(void)
         pidControllerApplyFn = nullRateController;
     }
 
-    pidResetTPAFilter();
-
     fixedWingLevelTrim = pidProfile()->fixedWingLevelTrim;
+}
+
+void pidInit(void)
+{
+    pidApplyProfile();
+
+    pidResetTPAFilter();
 
     navPidInit(
         &fixedWingLevelTrimController,
@@ -1278,6 +1423,58 @@ void pidInit(void)
         0.0f
     );
 
+    // Config changed, filters of all profiles are set up again for the next switch
+    if (getLooptime()) {
+        pidUpdateProfileFilters(getLooptime());
+    }
+}
+
+/*
+ * Switches the running controller to the current PID profile, which was just
+ * activated. Filters keep their state and only take over the coefficients of
+ * the profile, prepared by pidInitFilters(). New gains follow with the next
+ * PID gains update.
+ */
+void pidActivateProfile(void)
+{
+    const pidProfile_t *previous = &pidProfile_Storage[pidFiltersProfileIndex];
+    const uint16_t previousTpaTauMs = controlRateProfiles(pidFiltersProfileIndex)->throttle.fixedWingTauMs;
+
+    if (pidFiltersConfigured) {
+        pidLoadProfileFilters(getConfigProfile(), true);
+    }
+
+    pidApplyProfile();
+
+    // TPA filter follows the new time constant from where it is
+    if (usedPidControllerType == PID_TYPE_PIFF && currentControlRateProfile->throttle.fixedWingTauMs > 0) {
+        if (previousTpaTauMs > 0 && fixedWingTpaFilter.dT > 0) {
+            const float throttle = pt1FilterGetLastOutput(&fixedWingTpaFilter);
+            pt1FilterInitRC(&fixedWingTpaFilter, MS2S(currentControlRateProfile->throttle.fixedWingTauMs), TASK_PERIOD_HZ(TASK_AUX_RATE_HZ) * 1e-6f);
+            pt1FilterReset(&fixedWingTpaFilter, throttle);
+        } else {
+            pidResetTPAFilter();
+        }
+    }
+
+    // Level trim keeps its integrator, only the gain changes
+    fixedWingLevelTrimController.param.kI = (float)pidProfile()->fixedWingLevelTrimGain / 100000.0f;
+
+#ifdef USE_SMITH_PREDICTOR
+    // The delay line of a different delay has nothing to keep
+    if (pidFiltersConfigured && (
+        previous->smithPredictorDelay != pidProfile()->smithPredictorDelay ||
+        previous->smithPredictorStrength != pidProfile()->smithPredictorStrength ||
+        previous->smithPredictorFilterHz != pidProfile()->smithPredictorFilterHz ||
+        previous->smithPredictorAdaptive != pidProfile()->smithPredictorAdaptive
+    )) {
+        pidInitSmithPredictors();
+    }
+#else
+    UNUSED(previous);
+#endif
+
+    schedulePidGainsUpdate();
 }
 
 const pidBank_t * pidBank(void) {
@@ -163,7 +163,9 @@ typedef struct pidProfile_s {
     float smithPredictorStrength;
     float smithPredictorDelay;
     uint16_t smithPredictorFilterHz;
+    bool smithPredictorAdaptive;
 #endif
+    uint8_t fixedWingTpaAirspeedPow;        // Airspeed based TPA exponent in percent, 0 uses throttle based TPA
 } pidProfile_t;
 
 typedef struct pidAutotuneConfig_s {
@@ -193,6 +195,7 @@ extern int32_t axisPID_P[], axisPID_I[], axisPID_D[], axisPID_F[], axisPID_Setpo
 
 void pidInit(void);
 bool pidInitFilters(void);
+void pidActivateProfile(void);
 void pidResetErrorAccumulators(void);
 void pidReduceErrorAccumulators(int8_t delta, uint8_t axis);
 float getAxisIterm(uint8_t axis);
@@ -222,6 +225,7 @@ int16_t getHeadingHoldTarget(void);
 
 void autotuneUpdateState(void);
 void autotuneFixedWingUpdate(const flight_dynamics_index_t axis, float desiredRateDps, float reachedRateDps, float pidOutput);
+void autotuneFixedWingTask(timeUs_t currentTimeUs);
 
 pidType_e pidIndexGetType(pidIndex_e pidIndex);
 
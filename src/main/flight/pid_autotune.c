@@ -46,6 +46,10 @@
 
 #include "flight/pid.h"
 
+#ifdef USE_ARM_MATH
+#include "arm_math.h"
+#endif
+
 #define AUTOTUNE_FIXED_WING_MIN_FF              10
 #define AUTOTUNE_FIXED_WING_MAX_FF              255
 #define AUTOTUNE_FIXED_WING_MIN_ROLL_PITCH_RATE 40
@@ -55,6 +59,10 @@
 #define AUTOTUNE_FIXED_WING_SAMPLE_INTERVAL     20      // ms
 #define AUTOTUNE_FIXED_WING_SAMPLES             1000    // Use average over the last 20 seconds of hard maneuvers
 #define AUTOTUNE_FIXED_WING_MIN_SAMPLES         250     // Start updating tune after 5 seconds of hard maneuvers
+#define AUTOTUNE_FIXED_WING_RING_SIZE           32      // Decimated samples buffered between PID loop and analysis task
+#define AUTOTUNE_FIXED_WING_WINDOW_SIZE         64      // 1.28s identification window, 0.78Hz resolution
+#define AUTOTUNE_FIXED_WING_WINDOW_HOP          32      // Re-identify every 0.64s
+#define AUTOTUNE_FIXED_WING_MAX_BIN             16      // Fit gain over 0.78 - 12.5Hz where stick excitation lives
 
 PG_REGISTER_WITH_RESET_TEMPLATE(pidAutotuneConfig_t, pidAutotuneConfig, PG_PID_AUTOTUNE_CONFIG, 2);
 
@@ -81,6 +89,30 @@ typedef struct {
     uint32_t updateCount;
 } pidAutotuneData_t;
 
+typedef struct {
+    float   desiredRate;
+    float   reachedRate;
+    float   pidOutput;
+} pidAutotuneSample_t;
+
+typedef struct {
+    // Written at PID rate: boxcar average decimated into the ring buffer
+    pidAutotuneSample_t accum;
+    uint16_t            accumCount;
+    pidAutotuneSample_t ring[AUTOTUNE_FIXED_WING_RING_SIZE];
+    uint8_t             ringHead;
+    uint8_t             ringTail;
+
+    // Analysis task only: sliding identification window
+    float               reachedRateWindow[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+    float               pidOutputWindow[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+    bool                qualifiedWindow[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+    uint8_t             windowIdx;
+    uint8_t             windowFill;
+    uint8_t             windowHop;
+    float               identifiedGain;     // pidOutput per dps, 0 if not identified yet
+} pidAutotuneRecorder_t;
+
 #define AUTOTUNE_SAVE_PERIOD        5000        // Save interval is 5 seconds - when we turn off autotune we'll restore values from previous update at most 5 sec ago
 
 #if defined(USE_AUTOTUNE_FIXED_WING) || defined(USE_AUTOTUNE_MULTIROTOR)
@@ -88,6 +120,10 @@ typedef struct {
 static pidAutotuneData_t    tuneCurrent[XYZ_AXIS_COUNT];
 static pidAutotuneData_t    tuneSaved[XYZ_AXIS_COUNT];
 static timeMs_t             lastGainsUpdateTime;
+#if defined(USE_AUTOTUNE_FIXED_WING)
+static pidAutotuneRecorder_t tuneRecorder[XYZ_AXIS_COUNT];
+static timeMs_t             lastRecorderSampleTime;
+#endif
 
 void autotuneUpdateGains(pidAutotuneData_t * data)
 {
@@ -124,6 +160,11 @@ void autotuneStart(void)
         tuneCurrent[axis].updateCount = 0;
     }
 
+#if defined(USE_AUTOTUNE_FIXED_WING)
+    memset(tuneRecorder, 0, sizeof(tuneRecorder));
+    lastRecorderSampleTime = millis();
+#endif
+
     memcpy(tuneSaved, tuneCurrent, sizeof(pidAutotuneData_t) * XYZ_AXIS_COUNT);
     lastGainsUpdateTime = millis();
 }
@@ -165,26 +206,160 @@ static void blackboxLogAutotuneEvent(adjustmentFunction_e adjustmentFunction, in
 
 #if defined(USE_AUTOTUNE_FIXED_WING)
 
+/*
+ * Called from the fixed wing rate controller at PID rate. Only accumulates the sample, decimation into the
+ * ring buffer happens once per AUTOTUNE_FIXED_WING_SAMPLE_INTERVAL and analysis is left to autotuneFixedWingTask()
+ */
 void autotuneFixedWingUpdate(const flight_dynamics_index_t axis, float desiredRate, float reachedRate, float pidOutput)
 {
+    pidAutotuneRecorder_t *recorder = &tuneRecorder[axis];
+
+    recorder->accum.desiredRate += desiredRate;
+    recorder->accum.reachedRate += reachedRate;
+    recorder->accum.pidOutput += pidOutput;
+    recorder->accumCount++;
+
+    // The yaw axis is the last one processed by the rate controller, decimate all axes together
+    if (axis != FD_YAW) {
+        return;
+    }
+
+    const timeMs_t currentTimeMs = millis();
+    if ((currentTimeMs - lastRecorderSampleTime) < AUTOTUNE_FIXED_WING_SAMPLE_INTERVAL) {
+        return;
+    }
+    lastRecorderSampleTime = currentTimeMs;
+
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        recorder = &tuneRecorder[i];
+        const uint8_t nextHead = (recorder->ringHead + 1) % AUTOTUNE_FIXED_WING_RING_SIZE;
+
+        // Drop the sample if analysis task is falling behind
+        if (recorder->accumCount && nextHead != recorder->ringTail) {
+            const float scale = 1.0f / recorder->accumCount;
+            recorder->ring[recorder->ringHead].desiredRate = recorder->accum.desiredRate * scale;
+            recorder->ring[recorder->ringHead].reachedRate = recorder->accum.reachedRate * scale;
+            recorder->ring[recorder->ringHead].pidOutput = recorder->accum.pidOutput * scale;
+            recorder->ringHead = nextHead;
+        }
+
+        memset(&recorder->accum, 0, sizeof(recorder->accum));
+        recorder->accumCount = 0;
+    }
+}
+
+#ifdef USE_ARM_MATH
+static arm_rfft_fast_instance_f32 autotuneFftInstance;
+static bool autotuneFftInitialized = false;
+static float autotuneFftInput[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+static float autotuneFftReachedRate[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+static float autotuneFftPidOutput[AUTOTUNE_FIXED_WING_WINDOW_SIZE];
+
+static void autotuneWindowToSpectrum(const pidAutotuneRecorder_t *recorder, const float *window, float *spectrum)
+{
+    // Unroll circular window oldest first and apply Hann window to limit leakage between bins
+    for (int i = 0; i < AUTOTUNE_FIXED_WING_WINDOW_SIZE; i++) {
+        const int idx = (recorder->windowIdx + i) % AUTOTUNE_FIXED_WING_WINDOW_SIZE;
+        const float hann = 0.5f - 0.5f * cos_approx(2.0f * M_PIf * i / (AUTOTUNE_FIXED_WING_WINDOW_SIZE - 1));
+        autotuneFftInput[i] = window[idx] * hann;
+    }
+
+    arm_rfft_fast_f32(&autotuneFftInstance, autotuneFftInput, spectrum, 0);
+}
+#endif
+
+/*
+ * Least squares fit of pidOutput = gain * reachedRate over the identification window. With CMSIS DSP this is done in
+ * frequency domain over the stick excitation band, rejecting DC trim offsets and gyro noise above it.
+ */
+static float autotuneIdentifyGain(const pidAutotuneRecorder_t *recorder)
+{
+    float crossPower = 0.0f;
+    float ratePower = 0.0f;
+
+#ifdef USE_ARM_MATH
+    if (!autotuneFftInitialized) {
+        arm_rfft_fast_init_f32(&autotuneFftInstance, AUTOTUNE_FIXED_WING_WINDOW_SIZE);
+        autotuneFftInitialized = true;
+    }
+
+    autotuneWindowToSpectrum(recorder, recorder->reachedRateWindow, autotuneFftReachedRate);
+    autotuneWindowToSpectrum(recorder, recorder->pidOutputWindow, autotuneFftPidOutput);
+
+    // Packed RFFT output: [DC, Nyquist, re1, im1, re2, im2, ...], DC bin is deliberately skipped
+    for (int bin = 1; bin <= AUTOTUNE_FIXED_WING_MAX_BIN; bin++) {
+        const float rateRe = autotuneFftReachedRate[2 * bin];
+        const float rateIm = autotuneFftReachedRate[2 * bin + 1];
+        crossPower += autotuneFftPidOutput[2 * bin] * rateRe + autotuneFftPidOutput[2 * bin + 1] * rateIm;
+        ratePower += rateRe * rateRe + rateIm * rateIm;
+    }
+#else
+    float rateMean = 0.0f;
+    float outputMean = 0.0f;
+    for (int i = 0; i < AUTOTUNE_FIXED_WING_WINDOW_SIZE; i++) {
+        rateMean += recorder->reachedRateWindow[i];
+        outputMean += recorder->pidOutputWindow[i];
+    }
+    rateMean /= AUTOTUNE_FIXED_WING_WINDOW_SIZE;
+    outputMean /= AUTOTUNE_FIXED_WING_WINDOW_SIZE;
+
+    for (int i = 0; i < AUTOTUNE_FIXED_WING_WINDOW_SIZE; i++) {
+        const float rate = recorder->reachedRateWindow[i] - rateMean;
+        crossPower += (recorder->pidOutputWindow[i] - outputMean) * rate;
+        ratePower += rate * rate;
+    }
+#endif
+
+    return (ratePower > 0.0f && crossPower > 0.0f) ? crossPower / ratePower : 0.0f;
+}
+
+static void autotuneFixedWingRecordWindow(pidAutotuneRecorder_t *recorder, const pidAutotuneSample_t *sample, bool qualified)
+{
+    recorder->reachedRateWindow[recorder->windowIdx] = sample->reachedRate;
+    recorder->pidOutputWindow[recorder->windowIdx] = sample->pidOutput;
+    recorder->qualifiedWindow[recorder->windowIdx] = qualified;
+    recorder->windowIdx = (recorder->windowIdx + 1) % AUTOTUNE_FIXED_WING_WINDOW_SIZE;
+
+    if (recorder->windowFill < AUTOTUNE_FIXED_WING_WINDOW_SIZE) {
+        recorder->windowFill++;
+    }
+
+    if (recorder->windowFill < AUTOTUNE_FIXED_WING_WINDOW_SIZE || ++recorder->windowHop < AUTOTUNE_FIXED_WING_WINDOW_HOP) {
+        return;
+    }
+    recorder->windowHop = 0;
+
+    // Identify only from windows dominated by hard maneuvers, otherwise keep the previous estimate
+    int qualifiedCount = 0;
+    for (int i = 0; i < AUTOTUNE_FIXED_WING_WINDOW_SIZE; i++) {
+        qualifiedCount += recorder->qualifiedWindow[i];
+    }
+
+    if (qualifiedCount >= AUTOTUNE_FIXED_WING_WINDOW_SIZE / 2) {
+        const float gain = autotuneIdentifyGain(recorder);
+        if (gain > 0.0f) {
+            recorder->identifiedGain = gain;
+        }
+    }
+}
+
+static void autotuneFixedWingProcessSample(const flight_dynamics_index_t axis, const pidAutotuneSample_t *sample)
+{
+    pidAutotuneRecorder_t *recorder = &tuneRecorder[axis];
     float maxRateSetting = tuneCurrent[axis].rate;
     float gainFF = tuneCurrent[axis].gainFF;
     float maxDesiredRate = maxRateSetting;
 
     const float pidSumLimit = (axis == FD_YAW) ? pidProfile()->pidSumLimitYaw : pidProfile()->pidSumLimit;
-    const float absDesiredRate = fabsf(desiredRate);
-    const float absReachedRate = fabsf(reachedRate);
-    const float absPidOutput = fabsf(pidOutput);
-    const bool correctDirection = (desiredRate>0) == (reachedRate>0);
+    const float absDesiredRate = fabsf(sample->desiredRate);
+    const float absReachedRate = fabsf(sample->reachedRate);
+    const float absPidOutput = fabsf(sample->pidOutput);
+    const bool correctDirection = (sample->desiredRate>0) == (sample->reachedRate>0);
     float rateFullStick;
 
     bool gainsUpdated = false;
     bool ratesUpdated = false;
 
-    const timeMs_t currentTimeMs = millis();
-    static timeMs_t previousSampleTimeMs = 0;
-    const timeDelta_t timeSincePreviousSample = currentTimeMs - previousSampleTimeMs;
-
     // Use different max rate in ANLGE mode
     if (FLIGHT_MODE(ANGLE_MODE)) {
         float maxDesiredRateInAngleMode = DECIDEGREES_TO_DEGREES(pidProfile()->max_angle_inclination[axis] * 1.0f) * pidBank()->pid[PID_LEVEL].P / FP_PID_LEVEL_P_MULTIPLIER;
@@ -192,9 +367,12 @@ void autotuneFixedWingUpdate(const flight_dynamics_index_t axis, float desiredRa
     }
 
     const float stickInput = absDesiredRate / maxDesiredRate;
+    const bool qualified = (stickInput > (pidAutotuneConfig()->fw_min_stick / 100.0f)) && correctDirection;
+
+    autotuneFixedWingRecordWindow(recorder, sample, qualified);
 
-    if ((stickInput > (pidAutotuneConfig()->fw_min_stick / 100.0f)) && correctDirection && (timeSincePreviousSample >= AUTOTUNE_FIXED_WING_SAMPLE_INTERVAL)) {
-        // Record values every 20ms and calculate moving average over samples
+    if (qualified) {
+        // Calculate moving average over 20ms samples
         tuneCurrent[axis].updateCount++;
         tuneCurrent[axis].absDesiredRateAccum += (absDesiredRate - tuneCurrent[axis].absDesiredRateAccum) / MIN(tuneCurrent[axis].updateCount, (uint32_t)AUTOTUNE_FIXED_WING_SAMPLES);
         tuneCurrent[axis].absReachedRateAccum += (absReachedRate - tuneCurrent[axis].absReachedRateAccum) / MIN(tuneCurrent[axis].updateCount, (uint32_t)AUTOTUNE_FIXED_WING_SAMPLES);
@@ -223,14 +401,12 @@ void autotuneFixedWingUpdate(const flight_dynamics_index_t axis, float desiredRa
                 ratesUpdated = true;
             }
 
-            // Update FF towards value needed to achieve current rate target
-            gainFF += (tuneCurrent[axis].absPidOutputAccum / tuneCurrent[axis].absReachedRateAccum * FP_PID_RATE_FF_MULTIPLIER - gainFF) * (AUTOTUNE_FIXED_WING_CONVERGENCE_RATE / 100.0f);
+            // Update FF towards value needed to achieve current rate target, prefer the identified gain when available
+            const float gainTarget = recorder->identifiedGain > 0.0f ? recorder->identifiedGain : tuneCurrent[axis].absPidOutputAccum / tuneCurrent[axis].absReachedRateAccum;
+            gainFF += (gainTarget * FP_PID_RATE_FF_MULTIPLIER - gainFF) * (AUTOTUNE_FIXED_WING_CONVERGENCE_RATE / 100.0f);
             tuneCurrent[axis].gainFF = constrainf(gainFF, AUTOTUNE_FIXED_WING_MIN_FF, AUTOTUNE_FIXED_WING_MAX_FF);
             gainsUpdated = true;
         }
-
-        // Reset timer
-        previousSampleTimeMs = currentTimeMs;
     }
 
     if (gainsUpdated) {
@@ -274,6 +450,24 @@ void autotuneFixedWingUpdate(const flight_dynamics_index_t axis, float desiredRa
         ratesUpdated = false;
     }
 }
+
+void autotuneFixedWingTask(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (!FLIGHT_MODE(AUTO_TUNE)) {
+        return;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pidAutotuneRecorder_t *recorder = &tuneRecorder[axis];
+
+        while (recorder->ringTail != recorder->ringHead) {
+            autotuneFixedWingProcessSample(axis, &recorder->ring[recorder->ringTail]);
+            recorder->ringTail = (recorder->ringTail + 1) % AUTOTUNE_FIXED_WING_RING_SIZE;
+        }
+    }
+}
 #endif
 
 #endif
@@ -39,6 +39,8 @@ FILE_COMPILE_FOR_SPEED
 
 #include "fc/settings.h"
 
+#include "flight/mixer.h"
+
 #include "rx/rx.h"
 
 #include "sensors/battery.h"
@@ -115,16 +117,16 @@ static uint32_t calculateActiveLimit(int32_t value, uint32_t continuousLimit, ui
     return (*burstReserve ? burstLimit : continuousLimit) * 10;
 }
 
-void currentLimiterUpdate(timeDelta_t timeDelta) {
-    activeCurrentLimit = calculateActiveLimit(getAmperage(),
+static void currentLimiterUpdate(int32_t current, timeDelta_t timeDelta) {
+    activeCurrentLimit = calculateActiveLimit(current,
                             currentBatteryProfile->powerLimits.continuousCurrent, currentBatteryProfile->powerLimits.burstCurrent,
                             &burstCurrentReserve, burstCurrentReserveFalldown, burstCurrentReserveMax,
                             timeDelta);
 }
 
 #ifdef USE_ADC
-void powerLimiterUpdate(timeDelta_t timeDelta) {
-    activePowerLimit = calculateActiveLimit(getPower(),
+static void powerLimiterUpdate(int32_t power, timeDelta_t timeDelta) {
+    activePowerLimit = calculateActiveLimit(power,
                             currentBatteryProfile->powerLimits.continuousPower, currentBatteryProfile->powerLimits.burstPower,
                             &burstPowerReserve, burstPowerReserveFalldown, burstPowerReserveMax,
                             timeDelta);
@@ -153,16 +155,29 @@ void powerLimiterApply(int16_t *throttleCommand) {
     int16_t powerThrottleCommand;
 #endif
 
-    int16_t current = getAmperageSample();
+    // Work on fresh samples at PID rate when the sensors are read by the ADC,
+    // the battery task values are only refreshed at 50Hz
+    int16_t current = batteryMetersConfig()->current.type == CURRENT_SENSOR_ADC ? getAmperageSample() : getAmperage();
 #ifdef USE_ADC
-    uint16_t voltage = getVBatSample();
+    uint16_t voltage = batteryMetersConfig()->voltage.type == VOLTAGE_SENSOR_ADC ? getVBatSample() : getBatteryVoltage();
     int32_t power = (int32_t)voltage * current / 100;
 #endif
 
+    if (lastCallTimestamp) {
+        currentLimiterUpdate(current, callTimeDelta);
+#ifdef USE_ADC
+        powerLimiterUpdate(power, callTimeDelta);
+#endif
+    }
+
+    // Anti-windup: while the mixer is saturated lowering the throttle doesn't
+    // translate into less current, so only let the integrators unwind
+    const bool outputSaturated = mixerIsOutputSaturated();
+
     // Current limiting
     int32_t overCurrent = current - activeCurrentLimit;
 
-    if (lastCallTimestamp) {
+    if (lastCallTimestamp && !(outputSaturated && overCurrent > 0)) {
         currentThrAttnIntegrator = constrainf(currentThrAttnIntegrator + overCurrent * powerLimitsConfig()->piI * callTimeDelta * 2e-7, 0, PWM_RANGE_MAX - PWM_RANGE_MIN);
     }
 
@@ -174,7 +189,7 @@ void powerLimiterApply(int16_t *throttleCommand) {
     uint16_t currentThrAttned = MAX(PWM_RANGE_MIN, (int16_t)throttleBase - currentThrAttn);
 
     if (activeCurrentLimit && currentThrAttned < *throttleCommand) {
-        if (!wasLimitingCurrent && getAmperage() >= activeCurrentLimit) {
+        if (!wasLimitingCurrent && current >= activeCurrentLimit) {
             pt1FilterReset(&currentThrLimitingBaseFilter, *throttleCommand);
             wasLimitingCurrent = true;
         }
@@ -191,7 +206,7 @@ void powerLimiterApply(int16_t *throttleCommand) {
     // Power limiting
     int32_t overPower = power - activePowerLimit;
 
-    if (lastCallTimestamp) {
+    if (lastCallTimestamp && !(outputSaturated && overPower > 0)) {
         powerThrAttnIntegrator = constrainf(powerThrAttnIntegrator + overPower * powerLimitsConfig()->piI * callTimeDelta / voltage * 2e-5, 0, PWM_RANGE_MAX - PWM_RANGE_MIN);
     }
 
@@ -203,7 +218,7 @@ void powerLimiterApply(int16_t *throttleCommand) {
     uint16_t powerThrAttned = MAX(PWM_RANGE_MIN, (int16_t)throttleBase - powerThrAttn);
 
     if (activePowerLimit && powerThrAttned < *throttleCommand) {
-        if (!wasLimitingPower && getPower() >= activePowerLimit) {
+        if (!wasLimitingPower && power >= activePowerLimit) {
             pt1FilterReset(&powerThrLimitingBaseFilter, *throttleCommand);
             wasLimitingPower = true;
         }
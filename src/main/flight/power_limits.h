@@ -41,8 +41,6 @@ typedef struct {
 PG_DECLARE(powerLimitsConfig_t, powerLimitsConfig);
 
 void powerLimiterInit(void);
-void currentLimiterUpdate(timeDelta_t timeDelta);
-void powerLimiterUpdate(timeDelta_t timeDelta);
 void powerLimiterApply(int16_t *throttleCommand);
 bool powerLimiterIsLimiting(void);
 bool powerLimiterIsLimitingCurrent(void);
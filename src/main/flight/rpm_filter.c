@@ -22,6 +22,8 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
  */
 
+#include <float.h>
+
 #include "platform.h"
 
 #include "flight/rpm_filter.h"
@@ -36,9 +38,14 @@
 #include "common/maths.h"
 #include "common/filter.h"
 #include "flight/mixer.h"
+#include "drivers/pwm_output.h"
 #include "sensors/esc_sensor.h"
 #include "fc/config.h"
 #include "fc/settings.h"
+#include "fc/runtime_config.h"
+#include "sensors/gyro.h"
+#include "flight/dynamic_gyro_notch.h"
+#include "flight/gyroanalyse.h"
 
 #ifdef USE_RPM_FILTER
 
@@ -46,13 +53,20 @@
 #define RPM_FILTER_RPM_LPF_HZ 150
 #define RPM_FILTER_HARMONICS 3
 
-PG_REGISTER_WITH_RESET_TEMPLATE(rpmFilterConfig_t, rpmFilterConfig, PG_RPM_FILTER_CONFIG, 1);
+PG_REGISTER_WITH_RESET_TEMPLATE(rpmFilterConfig_t, rpmFilterConfig, PG_RPM_FILTER_CONFIG, 2);
 
 PG_RESET_TEMPLATE(rpmFilterConfig_t, rpmFilterConfig,
                   .gyro_filter_enabled = SETTING_RPM_GYRO_FILTER_ENABLED_DEFAULT,
                   .gyro_harmonics = SETTING_RPM_GYRO_HARMONICS_DEFAULT,
                   .gyro_min_hz = SETTING_RPM_GYRO_MIN_HZ_DEFAULT,
-                  .gyro_q = SETTING_RPM_GYRO_Q_DEFAULT, );
+                  .gyro_q = SETTING_RPM_GYRO_Q_DEFAULT,
+                  .gyro_adaptive = SETTING_RPM_GYRO_ADAPTIVE_DEFAULT, );
+
+#define RPM_FILTER_MIN_HZ_HYSTERESIS    0.9f    // Active notches are dropped below this fraction of min_hz
+#define RPM_FILTER_Q_SCALE_MAX          3.0f    // Adaptive Q grows with sqrt(frequency / min_hz) up to this factor
+#define RPM_FILTER_MIN_DEPTH            0.25f   // Adaptive notch depth of a harmonic much weaker than the strongest one
+
+#define RPM_FILTER_MAX_NOTCHES          BIQUAD_FILTER_BANK_MAX_STAGES
 
 typedef struct
 {
@@ -60,77 +74,62 @@ typedef struct
     float minHz;
     float maxHz;
     uint8_t harmonics;
-    biquadFilter_t filters[XYZ_AXIS_COUNT][MAX_SUPPORTED_MOTORS][RPM_FILTER_HARMONICS];
+    uint8_t notchCount;                             // Motors x harmonics, notch index is motor * harmonics + harmonic
+    bool adaptive;
+    float frequency[RPM_FILTER_MAX_NOTCHES];        // 0 while the notch is out of band and skipped
+    int8_t stage[RPM_FILTER_MAX_NOTCHES];           // Filter bank stage of the notch, -1 when skipped
+    biquadFilterBank_t filters;                     // Only the active notches, packed in notch order
 } rpmFilterBank_t;
 
-typedef float (*rpmFilterApplyFnPtr)(rpmFilterBank_t *filter, uint8_t axis, float input);
-typedef void (*rpmFilterUpdateFnPtr)(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency);
+typedef void (*rpmFilterApplyFnPtr)(rpmFilterBank_t *filter, float *input);
+typedef void (*rpmFilterUpdateFnPtr)(rpmFilterBank_t *filterBank, const float *baseFrequency, uint8_t motorCount);
 
 static EXTENDED_FASTRAM pt1Filter_t motorFrequencyFilter[MAX_SUPPORTED_MOTORS];
 static EXTENDED_FASTRAM rpmFilterBank_t gyroRpmFilters;
 static EXTENDED_FASTRAM rpmFilterApplyFnPtr rpmGyroApplyFn;
 static EXTENDED_FASTRAM rpmFilterUpdateFnPtr rpmGyroUpdateFn;
+static EXTENDED_FASTRAM bool rpmFromDshotBidir;
+static EXTENDED_FASTRAM float rpmMinMotorFrequency;
 
-float nullRpmFilterApply(rpmFilterBank_t *filter, uint8_t axis, float input)
+void nullRpmFilterApply(rpmFilterBank_t *filter, float *input)
 {
     UNUSED(filter);
-    UNUSED(axis);
-    return input;
+    UNUSED(input);
 }
 
-void nullRpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency) {
+void nullRpmFilterUpdate(rpmFilterBank_t *filterBank, const float *baseFrequency, uint8_t motorCount) {
     UNUSED(filterBank);
-    UNUSED(motor);
     UNUSED(baseFrequency);
+    UNUSED(motorCount);
 }
 
-float rpmFilterApply(rpmFilterBank_t *filterBank, uint8_t axis, float input)
+void rpmFilterApply(rpmFilterBank_t *filterBank, float *input)
 {
-    float output = input;
-
-    for (uint8_t motor = 0; motor < getMotorCount(); motor++)
-    {
-        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
-        {
-            output = biquadFilterApplyDF1(
-                &filterBank->filters[axis][motor][harmonicIndex],
-                output
-            );
-        }
-    }
-
-    return output;
+    /*
+     * All active motor harmonics for X, Y and Z in a single cascade
+     */
+    biquadFilterBankApply(&filterBank->filters, input);
 }
 
-static void rpmFilterInit(rpmFilterBank_t *filter, uint16_t q, uint8_t minHz, uint8_t harmonics)
+static void rpmFilterInit(rpmFilterBank_t *filter, uint16_t q, uint8_t minHz, uint8_t harmonics, bool adaptive)
 {
     filter->q = q / 100.0f;
     filter->minHz = minHz;
-    filter->harmonics = harmonics;
+    filter->harmonics = MIN(harmonics, RPM_FILTER_HARMONICS);
+    filter->adaptive = adaptive;
     /*
      * Max frequency has to be lower than Nyquist frequency for looptime
      */
     filter->maxHz = 0.48f * 1000000.0f / getLooptime();
+    filter->notchCount = MIN(getMotorCount() * filter->harmonics, RPM_FILTER_MAX_NOTCHES);
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++)
-    {
-        for (int motor = 0; motor < getMotorCount(); motor++)
-        {
-
-            /*
-             * Harmonics are indexed from 1 where 1 means base frequency
-             * C indexes arrays from 0, so we need to shift
-             */
-            for (int harmonicIndex = 0; harmonicIndex < harmonics; harmonicIndex++)
-            {
-                biquadFilterInit(
-                    &filter->filters[axis][motor][harmonicIndex],
-                    filter->minHz * (harmonicIndex + 1),
-                    getLooptime(),
-                    filter->q,
-                    FILTER_NOTCH);
-            }
-        }
+    // Motors are stopped at boot, cascade starts empty
+    biquadFilterBankInit(&filter->filters, filter->notchCount);
+    biquadFilterBankSetStageCount(&filter->filters, 0);
+
+    for (int notch = 0; notch < filter->notchCount; notch++) {
+        filter->frequency[notch] = 0.0f;
+        filter->stage[notch] = -1;
     }
 }
 
@@ -138,30 +137,188 @@ void disableRpmFilters(void) {
     rpmGyroApplyFn = (rpmFilterApplyFnPtr)nullRpmFilterApply;
 }
 
-void rpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency)
+/*
+ * Notches leaving the band between min_hz and Nyquist are skipped instead of being parked at the
+ * band edge, so the cascade only runs the harmonics that are actually there
+ */
+static bool rpmFilterNotchIsActive(const rpmFilterBank_t *filterBank, int notch, float frequency)
 {
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++)
-    {
-        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
-        {
-            float harmonicFrequency = baseFrequency * (harmonicIndex + 1);
-            harmonicFrequency = constrainf(harmonicFrequency, filterBank->minHz, filterBank->maxHz);
-
-            biquadFilterUpdate(
-                &filterBank->filters[axis][motor][harmonicIndex],
-                harmonicFrequency,
+    const float minHz = filterBank->stage[notch] >= 0 ? filterBank->minHz * RPM_FILTER_MIN_HZ_HYSTERESIS : filterBank->minHz;
+
+    return frequency >= minHz && frequency <= filterBank->maxHz;
+}
+
+/*
+ * Notch depth of every harmonic of a motor follows its magnitude in the gyro spectrum, relative
+ * to the strongest harmonic. Full depth when the spectrum is not available
+ */
+static void rpmFilterGetHarmonicDepths(const rpmFilterBank_t *filterBank, const float *frequency, float *depth)
+{
+    for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++) {
+        depth[harmonicIndex] = 1.0f;
+    }
+
+#ifdef USE_DYNAMIC_FILTERS
+    if (!filterBank->adaptive || !dynamicGyroNotchState.enabled) {
+        return;
+    }
+
+    float magnitude[RPM_FILTER_HARMONICS];
+    float maxMagnitude = 0.0f;
+    for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++) {
+        if (frequency[harmonicIndex] <= 0.0f) {
+            // Skipped notch
+            magnitude[harmonicIndex] = 0.0f;
+            continue;
+        }
+
+        magnitude[harmonicIndex] = gyroDataAnalyseGetMagnitude(&gyroAnalyseState, frequency[harmonicIndex]);
+        if (magnitude[harmonicIndex] < 0.0f) {
+            // Harmonic outside of the analysed band
+            return;
+        }
+        maxMagnitude = MAX(maxMagnitude, magnitude[harmonicIndex]);
+    }
+
+    if (maxMagnitude <= 0.0f) {
+        return;
+    }
+
+    for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++) {
+        depth[harmonicIndex] = constrainf(magnitude[harmonicIndex] / maxMagnitude, RPM_FILTER_MIN_DEPTH, 1.0f);
+    }
+#else
+    UNUSED(frequency);
+#endif
+}
+
+static float rpmFilterGetQ(const rpmFilterBank_t *filterBank, float frequency)
+{
+    if (!filterBank->adaptive) {
+        return filterBank->q;
+    }
+
+    return filterBank->q * MIN(fast_fsqrtf(frequency / filterBank->minHz), RPM_FILTER_Q_SCALE_MAX);
+}
+
+/*
+ * Packs the active notches to the front of the cascade in notch order. State of a notch moves
+ * with it, a notch entering the band starts from zero state
+ */
+static void rpmFilterRebuildCascade(rpmFilterBank_t *filterBank, const bool *active)
+{
+    int8_t newStage[RPM_FILTER_MAX_NOTCHES];
+    uint8_t stageCount = 0;
+
+    for (int notch = 0; notch < filterBank->notchCount; notch++) {
+        newStage[notch] = active[notch] ? stageCount++ : -1;
+    }
+
+    // Order is kept, so moving down in ascending and moving up in descending order never overwrites a pending state
+    for (int notch = 0; notch < filterBank->notchCount; notch++) {
+        if (newStage[notch] >= 0 && filterBank->stage[notch] > newStage[notch]) {
+            biquadFilterBankMoveStageState(&filterBank->filters, filterBank->stage[notch], newStage[notch]);
+        }
+    }
+    for (int notch = filterBank->notchCount - 1; notch >= 0; notch--) {
+        if (newStage[notch] >= 0 && filterBank->stage[notch] >= 0 && filterBank->stage[notch] < newStage[notch]) {
+            biquadFilterBankMoveStageState(&filterBank->filters, filterBank->stage[notch], newStage[notch]);
+        }
+    }
+    for (int notch = 0; notch < filterBank->notchCount; notch++) {
+        if (newStage[notch] >= 0 && filterBank->stage[notch] < 0) {
+            biquadFilterBankResetStageState(&filterBank->filters, newStage[notch]);
+        }
+        filterBank->stage[notch] = newStage[notch];
+    }
+
+    biquadFilterBankSetStageCount(&filterBank->filters, stageCount);
+}
+
+void rpmFilterUpdate(rpmFilterBank_t *filterBank, const float *baseFrequency, uint8_t motorCount)
+{
+    bool active[RPM_FILTER_MAX_NOTCHES];
+    bool cascadeChanged = false;
+
+    motorCount = MIN(motorCount, filterBank->notchCount / MAX(filterBank->harmonics, 1));
+
+    for (int motor = 0; motor < motorCount; motor++) {
+        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++) {
+            const int notch = motor * filterBank->harmonics + harmonicIndex;
+            const float harmonicFrequency = baseFrequency[motor] * (harmonicIndex + 1);
+
+            active[notch] = rpmFilterNotchIsActive(filterBank, notch, harmonicFrequency);
+            filterBank->frequency[notch] = active[notch] ? harmonicFrequency : 0.0f;
+            cascadeChanged |= active[notch] != (filterBank->stage[notch] >= 0);
+        }
+    }
+
+    for (int notch = motorCount * filterBank->harmonics; notch < filterBank->notchCount; notch++) {
+        active[notch] = false;
+        cascadeChanged |= filterBank->stage[notch] >= 0;
+    }
+
+    if (cascadeChanged) {
+        rpmFilterRebuildCascade(filterBank, active);
+    }
+
+    /*
+     * Coefficients are shared by all axes, so they are computed once per active motor harmonic
+     */
+    for (int motor = 0; motor < motorCount; motor++) {
+        const float *frequency = &filterBank->frequency[motor * filterBank->harmonics];
+        float depth[RPM_FILTER_HARMONICS];
+
+        rpmFilterGetHarmonicDepths(filterBank, frequency, depth);
+
+        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++) {
+            const int notch = motor * filterBank->harmonics + harmonicIndex;
+
+            if (filterBank->stage[notch] < 0) {
+                continue;
+            }
+
+            biquadFilterBankUpdateNotch(
+                &filterBank->filters,
+                filterBank->stage[notch],
+                frequency[harmonicIndex],
                 getLooptime(),
-                filterBank->q,
-                FILTER_NOTCH);
+                rpmFilterGetQ(filterBank, frequency[harmonicIndex]),
+                depth[harmonicIndex]);
         }
     }
 }
 
+bool rpmFilterSourceAvailable(void)
+{
+#ifdef USE_DSHOT_BIDIR
+    if (isMotorProtocolDshotBidir()) {
+        return true;
+    }
+#endif
+    return STATE(ESC_SENSOR_ENABLED);
+}
+
+/*
+ * Bidirectional DShot delivers RPM of all motors every frame, so filters are updated every loop.
+ * Serial ESC telemetry polls one motor at a time and is updated at RPM_FILTER_UPDATE_RATE_HZ
+ */
+timeDelta_t rpmFilterGetUpdateIntervalUs(void)
+{
+    return rpmFromDshotBidir ? (timeDelta_t)getLooptime() : (timeDelta_t)RPM_FILTER_UPDATE_RATE_US;
+}
+
 void rpmFiltersInit(void)
 {
+#ifdef USE_DSHOT_BIDIR
+    rpmFromDshotBidir = isMotorProtocolDshotBidir();
+#else
+    rpmFromDshotBidir = false;
+#endif
+
     for (uint8_t i = 0; i < MAX_SUPPORTED_MOTORS; i++)
     {
-        pt1FilterInit(&motorFrequencyFilter[i], RPM_FILTER_RPM_LPF_HZ, RPM_FILTER_UPDATE_RATE_US * 1e-6f);
+        pt1FilterInit(&motorFrequencyFilter[i], RPM_FILTER_RPM_LPF_HZ, rpmFilterGetUpdateIntervalUs() * 1e-6f);
     }
 
     rpmGyroUpdateFn = (rpmFilterUpdateFnPtr)nullRpmFilterUpdate;
@@ -172,7 +329,8 @@ void rpmFiltersInit(void)
             &gyroRpmFilters,
             rpmFilterConfig()->gyro_q,
             rpmFilterConfig()->gyro_min_hz,
-            rpmFilterConfig()->gyro_harmonics);
+            rpmFilterConfig()->gyro_harmonics,
+            rpmFilterConfig()->gyro_adaptive);
         rpmGyroApplyFn = (rpmFilterApplyFnPtr)rpmFilterApply;
         rpmGyroUpdateFn = (rpmFilterUpdateFnPtr)rpmFilterUpdate;
     }
@@ -183,21 +341,45 @@ void rpmFilterUpdateTask(timeUs_t currentTimeUs)
     UNUSED(currentTimeUs);
 
     uint8_t motorCount = getMotorCount();
+    float baseFrequency[MAX_SUPPORTED_MOTORS];
+    float minMotorFrequency = motorCount > 0 ? FLT_MAX : 0.0f;
+
     /*
      * For each motor, read ERPM, filter it and update motor frequency
      */
     for (uint8_t i = 0; i < motorCount; i++)
     {
-        const escSensorData_t *escState = getEscTelemetry(i); //Get ESC telemetry
-        const float baseFrequency = pt1FilterApply(&motorFrequencyFilter[i], escState->rpm * HZ_TO_RPM); //Filter motor frequency
-
-        rpmGyroUpdateFn(&gyroRpmFilters, i, baseFrequency);
+        uint32_t rpm = 0;
+#ifdef USE_DSHOT_BIDIR
+        if (rpmFromDshotBidir) {
+            rpm = pwmGetMotorRpm(i);
+        }
+#endif
+#ifdef USE_ESC_SENSOR
+        if (!rpmFromDshotBidir) {
+            rpm = getEscTelemetry(i)->rpm; //Get ESC telemetry
+        }
+#endif
+        baseFrequency[i] = pt1FilterApply(&motorFrequencyFilter[i], rpm * HZ_TO_RPM); //Filter motor frequency
+        minMotorFrequency = MIN(minMotorFrequency, baseFrequency[i]);
     }
+
+    rpmMinMotorFrequency = minMotorFrequency;
+
+    rpmGyroUpdateFn(&gyroRpmFilters, baseFrequency, motorCount);
+}
+
+/*
+ * Lowest filtered fundamental of all motors [Hz], 0 when RPM data is not available or a motor is stopped
+ */
+float rpmFilterGetMinMotorFrequency(void)
+{
+    return rpmMinMotorFrequency;
 }
 
-float rpmFilterGyroApply(uint8_t axis, float input)
+void rpmFilterGyroApply(float *gyroADCf)
 {
-    return rpmGyroApplyFn(&gyroRpmFilters, axis, input);
+    rpmGyroApplyFn(&gyroRpmFilters, gyroADCf);
 }
 
 #endif
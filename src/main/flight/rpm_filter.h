@@ -34,6 +34,7 @@ typedef struct rpmFilterConfig_s {
     uint8_t  gyro_harmonics;
     uint8_t  gyro_min_hz;
     uint16_t gyro_q;
+    bool     gyro_adaptive;
 
     uint8_t  dterm_harmonics;
     uint8_t  dterm_min_hz;
@@ -47,6 +48,9 @@ PG_DECLARE(rpmFilterConfig_t, rpmFilterConfig);
 #define RPM_FILTER_UPDATE_RATE_US (1000000.0f / RPM_FILTER_UPDATE_RATE_HZ)
 
 void disableRpmFilters(void);
+bool rpmFilterSourceAvailable(void);
+timeDelta_t rpmFilterGetUpdateIntervalUs(void);
 void rpmFiltersInit(void);
 void rpmFilterUpdateTask(timeUs_t currentTimeUs);
-float rpmFilterGyroApply(uint8_t axis, float input);
\ No newline at end of file
+void rpmFilterGyroApply(float *gyroADCf);
+float rpmFilterGetMinMotorFrequency(void);
\ No newline at end of file
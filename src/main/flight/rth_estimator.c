@@ -4,12 +4,15 @@
 #include "common/maths.h"
 #include "common/utils.h"
 
+#include "drivers/time.h"
+
 #include "fc/config.h"
 #include "fc/fc_core.h"
 #include "fc/runtime_config.h"
 
 #include "flight/imu.h"
 #include "flight/mixer.h"
+#include "flight/rth_estimator.h"
 #include "flight/wind_estimator.h"
 
 #include "navigation/navigation.h"
@@ -20,6 +23,15 @@
 
 #if defined(USE_ADC) && defined(USE_GPS)
 
+typedef struct {
+    float remainingFlightTime;  // [s], negative values are error codes
+    float remainingDistance;    // [m], negative values are error codes
+} rthEstimate_t;
+
+// Without and with wind compensation
+static rthEstimate_t rthEstimate[2] = { { -1, -1 }, { -1, -1 } };
+static timeMs_t rthEstimateUpdatedMs = 0;
+
 /* INPUTS:
  *   - heading degrees
  *   - horizontalWindSpeed
@@ -188,7 +200,7 @@ static float calculateRemainingEnergyBeforeRTH(bool takeWindIntoAccount) {
 }
 
 // returns seconds
-float calculateRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount) {
+static float calculateRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount) {
 
     const float remainingEnergyBeforeRTH = calculateRemainingEnergyBeforeRTH(takeWindIntoAccount);
 
@@ -207,7 +219,7 @@ float calculateRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount) {
 }
 
 // returns meters
-float calculateRemainingDistanceBeforeRTH(bool takeWindIntoAccount) {
+static float calculateRemainingDistanceBeforeRTH(bool takeWindIntoAccount, float remainingFlightTimeBeforeRTH) {
 
     // Fixed wing only for now
     if (!(STATE(FIXED_WING_LEGACY) || ARMING_FLAG(ARMED))) {
@@ -229,8 +241,6 @@ float calculateRemainingDistanceBeforeRTH(bool takeWindIntoAccount) {
         return -1;
     }
 
-    const float remainingFlightTimeBeforeRTH = calculateRemainingFlightTimeBeforeRTH(takeWindIntoAccount);
-
     // error: return error code directly
     if (remainingFlightTimeBeforeRTH < 0)
         return remainingFlightTimeBeforeRTH;
@@ -238,4 +248,47 @@ float calculateRemainingDistanceBeforeRTH(bool takeWindIntoAccount) {
     return remainingFlightTimeBeforeRTH * calculateAverageSpeed();
 }
 
+static void updateRTHEstimate(rthEstimate_t *estimate, bool takeWindIntoAccount)
+{
+    estimate->remainingFlightTime = calculateRemainingFlightTimeBeforeRTH(takeWindIntoAccount);
+    estimate->remainingDistance = calculateRemainingDistanceBeforeRTH(takeWindIntoAccount, estimate->remainingFlightTime);
+}
+
+// Runs from its own low priority task, readers just get the last result
+void rthEstimatorUpdate(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    updateRTHEstimate(&rthEstimate[0], false);
+#ifdef USE_WIND_ESTIMATOR
+    updateRTHEstimate(&rthEstimate[1], true);
+#endif
+    rthEstimateUpdatedMs = millis();
+}
+
+static const rthEstimate_t *getRTHEstimate(bool takeWindIntoAccount)
+{
+#ifdef USE_WIND_ESTIMATOR
+    return &rthEstimate[takeWindIntoAccount ? 1 : 0];
+#else
+    UNUSED(takeWindIntoAccount);
+    return &rthEstimate[0];
+#endif
+}
+
+float getRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount)
+{
+    return getRTHEstimate(takeWindIntoAccount)->remainingFlightTime;
+}
+
+float getRemainingDistanceBeforeRTH(bool takeWindIntoAccount)
+{
+    return getRTHEstimate(takeWindIntoAccount)->remainingDistance;
+}
+
+timeMs_t getRTHEstimateAgeMs(void)
+{
+    return millis() - rthEstimateUpdatedMs;
+}
+
 #endif
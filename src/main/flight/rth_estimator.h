@@ -1,5 +1,11 @@
 
 #if defined(USE_ADC) && defined(USE_GPS)
-float calculateRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount);
-float calculateRemainingDistanceBeforeRTH(bool takeWindIntoAccount);
+#include "common/time.h"
+
+void rthEstimatorUpdate(timeUs_t currentTimeUs);
+
+// Cached results of the last update, -1 when unavailable and -2 when the wind is too strong to return
+float getRemainingFlightTimeBeforeRTH(bool takeWindIntoAccount);    // [s]
+float getRemainingDistanceBeforeRTH(bool takeWindIntoAccount);      // [m]
+timeMs_t getRTHEstimateAgeMs(void);
 #endif
@@ -46,7 +46,7 @@
 #include "sensors/boardalignment.h"
 #include "sensors/compass.h"
 
-PG_REGISTER_WITH_RESET_FN(secondaryImuConfig_t, secondaryImuConfig, PG_SECONDARY_IMU, 2);
+PG_REGISTER_WITH_RESET_FN(secondaryImuConfig_t, secondaryImuConfig, PG_SECONDARY_IMU, 3);
 
 EXTENDED_FASTRAM secondaryImuState_t secondaryImuState;
 
@@ -59,6 +59,7 @@ void pgResetFn_secondaryImuConfig(secondaryImuConfig_t *instance)
     instance->useForOsdHeading = 0;
     instance->useForOsdAHI = 0;
     instance->useForStabilized = 0;
+    instance->useForFusion = 0;
 
     for (uint8_t i = 0; i < 3; i++)
     {
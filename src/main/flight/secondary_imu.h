@@ -43,6 +43,7 @@ typedef struct secondaryImuConfig_s {
     uint8_t useForOsdHeading;
     uint8_t useForOsdAHI;
     uint8_t useForStabilized;
+    uint8_t useForFusion;
     int16_t calibrationOffsetGyro[3];
     int16_t calibrationOffsetMag[3];
     int16_t calibrationOffsetAcc[3];
@@ -55,6 +56,7 @@ typedef struct secondaryImuState_s {
     bno055CalibStat_t calibrationStatus;
     uint8_t active;
     float magDeclination;
+    timeUs_t sampleTimeUs;              // Time the attitude in eulerAngles was valid at, compensated for sensor latency
 } secondaryImuState_t;
 
 extern secondaryImuState_t secondaryImuState;
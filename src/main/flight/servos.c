@@ -28,6 +28,7 @@
 #include "common/axis.h"
 #include "common/filter.h"
 #include "common/maths.h"
+#include "common/utils.h"
 #include "programming/global_variables.h"
 
 #include "config/config_reset.h"
@@ -58,11 +59,12 @@
 
 #include "sensors/gyro.h"
 
-PG_REGISTER_WITH_RESET_TEMPLATE(servoConfig_t, servoConfig, PG_SERVO_CONFIG, 3);
+PG_REGISTER_WITH_RESET_TEMPLATE(servoConfig_t, servoConfig, PG_SERVO_CONFIG, 4);
 
 PG_RESET_TEMPLATE(servoConfig_t, servoConfig,
     .servoCenterPulse = SETTING_SERVO_CENTER_PULSE_DEFAULT,
     .servoPwmRate = SETTING_SERVO_PWM_RATE_DEFAULT,             // Default for analog servos
+    .servoUpdateRate = SETTING_SERVO_UPDATE_RATE_DEFAULT,
     .servo_lowpass_freq = SETTING_SERVO_LPF_HZ_DEFAULT,         // Default servo update rate is 50Hz, everything above Nyquist frequency (25Hz) is going to fold and cause distortions
     .servo_protocol = SETTING_SERVO_PROTOCOL_DEFAULT,
     .flaperon_throw_offset = SETTING_FLAPERON_THROW_OFFSET_DEFAULT,
@@ -115,8 +117,40 @@ static biquadFilter_t servoFilter[MAX_SUPPORTED_SERVOS];
 static bool servoFilterIsSet;
 
 static servoMetadata_t servoMetadata[MAX_SUPPORTED_SERVOS];
+
+/*
+ * Servo mixer compiled at configuration change: speed limited rules first, so their
+ * limiters are packed at the start of servoSpeedLimitFilter[], and every distinct gating
+ * logic condition is read once per update. The list of rules to run is only rebuilt when
+ * one of those conditions changes value.
+ */
+#define SERVO_MIXER_NO_CONDITION    0xFF
+
+typedef struct servoMixerRule_s {
+    uint8_t target;
+    uint8_t input;
+    int16_t rate;
+    uint8_t speed;
+    uint8_t conditionIndex;                 // Into servoMixerConditionIds[], SERVO_MIXER_NO_CONDITION if always active
+} servoMixerRule_t;
+
+static servoMixerRule_t servoMixerRules[MAX_SERVO_RULES];
+static uint8_t servoMixerLimitedRuleCount;
 static rateLimitFilter_t servoSpeedLimitFilter[MAX_SERVO_RULES];
 
+static uint8_t servoMixerActiveRules[MAX_SERVO_RULES];
+static uint8_t servoMixerActiveRuleCount;
+static uint8_t servoMixerActiveLimitedRuleCount;
+static bool servoMixerActiveRulesValid;
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+static int8_t servoMixerConditionIds[MAX_SERVO_RULES];
+static uint8_t servoMixerConditionCount;
+static uint32_t servoMixerConditionMask;
+
+STATIC_ASSERT(MAX_SERVO_RULES <= 32, servo_mixer_condition_mask_too_small);
+#endif
+
 STATIC_FASTRAM pt1Filter_t rotRateFilter;
 STATIC_FASTRAM pt1Filter_t targetRateFilter;
 
@@ -170,6 +204,96 @@ int getServoCount(void)
     }
 }
 
+static void compileServoMixer(void)
+{
+    uint8_t ruleCount = 0;
+
+    servoMixerLimitedRuleCount = 0;
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    servoMixerConditionCount = 0;
+#endif
+
+    // Two passes, speed limited rules go first
+    for (int pass = 0; pass < 2; pass++) {
+        const bool limited = (pass == 0);
+
+        for (int i = 0; i < servoRuleCount; i++) {
+            if ((currentServoMixer[i].speed != 0) != limited) {
+                continue;
+            }
+
+            servoMixerRule_t *rule = &servoMixerRules[ruleCount++];
+            rule->target = currentServoMixer[i].targetChannel;
+            rule->input = currentServoMixer[i].inputSource;
+            rule->rate = currentServoMixer[i].rate;
+            rule->speed = currentServoMixer[i].speed;
+            rule->conditionIndex = SERVO_MIXER_NO_CONDITION;
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+            const int8_t conditionId = currentServoMixer[i].conditionId;
+            if (conditionId >= 0) {
+                int index = 0;
+                while (index < servoMixerConditionCount && servoMixerConditionIds[index] != conditionId) {
+                    index++;
+                }
+                if (index == servoMixerConditionCount) {
+                    servoMixerConditionIds[servoMixerConditionCount++] = conditionId;
+                }
+                rule->conditionIndex = index;
+            }
+#endif
+        }
+
+        if (limited) {
+            servoMixerLimitedRuleCount = ruleCount;
+        }
+    }
+
+    memset(servoSpeedLimitFilter, 0, sizeof(servoSpeedLimitFilter));
+    servoMixerActiveRulesValid = false;
+}
+
+static void updateServoMixerActiveRules(void)
+{
+    uint32_t conditionMask = 0;
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    for (int i = 0; i < servoMixerConditionCount; i++) {
+        if (logicConditionGetValue(servoMixerConditionIds[i])) {
+            conditionMask |= 1U << i;
+        }
+    }
+
+    if (servoMixerActiveRulesValid && conditionMask == servoMixerConditionMask) {
+        return;
+    }
+
+    servoMixerConditionMask = conditionMask;
+#else
+    if (servoMixerActiveRulesValid) {
+        return;
+    }
+#endif
+
+    servoMixerActiveRuleCount = 0;
+    servoMixerActiveLimitedRuleCount = 0;
+
+    for (int i = 0; i < servoRuleCount; i++) {
+        const uint8_t conditionIndex = servoMixerRules[i].conditionIndex;
+
+        if (conditionIndex != SERVO_MIXER_NO_CONDITION && !(conditionMask & (1U << conditionIndex))) {
+            continue;
+        }
+
+        servoMixerActiveRules[servoMixerActiveRuleCount++] = i;
+        if (i < servoMixerLimitedRuleCount) {
+            servoMixerActiveLimitedRuleCount++;
+        }
+    }
+
+    servoMixerActiveRulesValid = true;
+}
+
 void loadCustomServoMixer(void)
 {
     // reset settings
@@ -195,15 +319,47 @@ void loadCustomServoMixer(void)
         memcpy(&currentServoMixer[i], customServoMixers(i), sizeof(servoMixer_t));
         servoRuleCount++;
     }
+
+    compileServoMixer();
+}
+
+static float servoUpdateElapsed = 0.0f;
+
+// [us] servo outputs are calculated at looptime rate unless servo_update_rate is lower
+static uint32_t getServoUpdateInterval(void)
+{
+    if (servoConfig()->servoUpdateRate) {
+        return MAX(getLooptime(), 1000000U / servoConfig()->servoUpdateRate);
+    }
+
+    return getLooptime();
+}
+
+// Servo mixer and outputs only run when a new value can reach the servos, servoDT is the time since the last update
+bool servoUpdateIsDue(float dT, float *servoDT)
+{
+    servoUpdateElapsed += dT;
+
+    // Half a loop of slack, float sums of dT must not push the update one loop later
+    if (servoConfig()->servoUpdateRate && servoUpdateElapsed + 0.5f * dT < US2S(getServoUpdateInterval())) {
+        return false;
+    }
+
+    *servoDT = servoUpdateElapsed;
+    servoUpdateElapsed = 0.0f;
+    return true;
 }
 
 static void filterServos(void)
 {
     if (servoConfig()->servo_lowpass_freq) {
-        // Initialize servo lowpass filter (servos are calculated at looptime rate)
+        // Initialize servo lowpass filter
         if (!servoFilterIsSet) {
+            const uint32_t updateInterval = getServoUpdateInterval();
+            // Keep the cutoff below Nyquist frequency of the update rate
+            const int16_t cutoff = MIN(servoConfig()->servo_lowpass_freq, (int16_t)(400000 / updateInterval));
             for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-                biquadFilterInitLPF(&servoFilter[i], servoConfig()->servo_lowpass_freq, getLooptime());
+                biquadFilterInitLPF(&servoFilter[i], cutoff, updateInterval);
                 biquadFilterReset(&servoFilter[i], servo[i]);
             }
             servoFilterIsSet = true;
@@ -331,31 +487,31 @@ void servoMixer(float dT)
         servo[i] = 0;
     }
 
-    // mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
-
-        /*
-         * Check if conditions for a rule are met, not all conditions apply all the time
-         */
-    #ifdef USE_PROGRAMMING_FRAMEWORK
-        if (!logicConditionGetValue(currentServoMixer[i].conditionId)) {
-            continue; 
-        }
-    #endif
+    /*
+     * Check if conditions for rules are met, not all conditions apply all the time
+     */
+    updateServoMixerActiveRules();
 
-        const uint8_t target = currentServoMixer[i].targetChannel;
-        const uint8_t from = currentServoMixer[i].inputSource;
+    // mix servos according to rules
+    for (int i = 0; i < servoMixerActiveLimitedRuleCount; i++) {
+        const uint8_t ruleIndex = servoMixerActiveRules[i];
+        const servoMixerRule_t *rule = &servoMixerRules[ruleIndex];
 
         /*
          * Apply mixer speed limit. 1 [one] speed unit is defined as 10us/s:
-         * 0 = no limiting
          * 1 = 10us/s -> full servo sweep (from 1000 to 2000) is performed in 100s
          * 10 = 100us/s -> full sweep (from 1000 to 2000)  is performed in 10s
          * 100 = 1000us/s -> full sweep in 1s
          */
-        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[i], input[from], currentServoMixer[i].speed * 10, dT);
+        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[ruleIndex], input[rule->input], rule->speed * 10, dT);
+
+        servo[rule->target] += ((int32_t)inputLimited * rule->rate) / 100;
+    }
+
+    for (int i = servoMixerActiveLimitedRuleCount; i < servoMixerActiveRuleCount; i++) {
+        const servoMixerRule_t *rule = &servoMixerRules[servoMixerActiveRules[i]];
 
-        servo[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
+        servo[rule->target] += ((int32_t)input[rule->input] * rule->rate) / 100;
     }
 
     for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
@@ -134,6 +134,7 @@ typedef struct servoConfig_s {
     // PWM values, in milliseconds, common range is 1000-2000 (1ms to 2ms)
     uint16_t servoCenterPulse;              // This is the value for servos when they should be in the middle. e.g. 1500.
     uint16_t servoPwmRate;                  // The update rate of servo outputs (50-498Hz)
+    uint16_t servoUpdateRate;               // [Hz] Servo mixer and output update rate, 0 = every PID loop
     int16_t servo_lowpass_freq;             // lowpass servo filter frequency selection; 1/1000ths of loop freq
     uint16_t flaperon_throw_offset;
     uint8_t servo_protocol;                 // See servoProtocolType_e
@@ -157,6 +158,7 @@ bool isMixerUsingServos(void);
 void writeServos(void);
 void loadCustomServoMixer(void);
 void servoMixer(float dT);
+bool servoUpdateIsDue(float dT, float *servoDT);
 void servoComputeScalingFactors(uint8_t servoIndex);
 void servosInit(void);
 int getServoCount(void);
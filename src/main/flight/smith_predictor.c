@@ -29,15 +29,72 @@
 #ifdef USE_SMITH_PREDICTOR
 
 #include <stdbool.h>
+#include <string.h>
+#include <math.h>
 #include "common/axis.h"
+#include "common/maths.h"
 #include "common/utils.h"
 #include "flight/smith_predictor.h"
 #include "build/debug.h"
 
+#define SMITH_DELAY_LAGS_PER_LOOP       8       // Lags correlated per loop, a full scan takes MAX_SMITH_SAMPLES / 8 loops
+#define SMITH_DELAY_CORRELATION_GAIN    0.01f   // Per-lag correlation averaging
+#define SMITH_DELAY_OUTPUT_MEAN_GAIN    0.01f   // Removes hover/trim offset from actuator output
+#define SMITH_DELAY_ESTIMATE_GAIN       0.05f   // Smoothing of the measured delay between scans
+#define SMITH_DELAY_PEAK_RATIO          2.0f    // Peak has to stand out of the average correlation to be trusted
+
+/*
+ * Angular acceleration responds to actuator output after the plant delay, so the lag with the strongest
+ * correlation between the gyro delta and the (mean removed) output is the delay to compensate.
+ * Only SMITH_DELAY_LAGS_PER_LOOP lags are updated per call to keep the per-loop cost constant.
+ */
+static void smithPredictorMeasureDelay(smithPredictor_t *predictor, float sample, float output)
+{
+    predictor->outputMean += SMITH_DELAY_OUTPUT_MEAN_GAIN * (output - predictor->outputMean);
+    predictor->historyIdx = (predictor->historyIdx + 1) % (MAX_SMITH_SAMPLES + 1);
+    predictor->outputHistory[predictor->historyIdx] = output - predictor->outputMean;
+
+    const float gyroDelta = sample - predictor->previousSample;
+    predictor->previousSample = sample;
+
+    for (int i = 0; i < SMITH_DELAY_LAGS_PER_LOOP; i++) {
+        const uint8_t lag = predictor->lagIdx + i;
+        const uint8_t idx = (predictor->historyIdx + MAX_SMITH_SAMPLES + 1 - lag) % (MAX_SMITH_SAMPLES + 1);
+        predictor->correlation[lag] += SMITH_DELAY_CORRELATION_GAIN * (gyroDelta * predictor->outputHistory[idx] - predictor->correlation[lag]);
+    }
+
+    predictor->lagIdx += SMITH_DELAY_LAGS_PER_LOOP;
+    if (predictor->lagIdx <= MAX_SMITH_SAMPLES) {
+        return;
+    }
+    predictor->lagIdx = 1;
+
+    // Full scan done, pick the correlation peak
+    uint8_t peakLag = 0;
+    float peak = 0.0f;
+    float correlationSum = 0.0f;
+    for (int lag = 1; lag <= MAX_SMITH_SAMPLES; lag++) {
+        correlationSum += fabsf(predictor->correlation[lag]);
+        if (predictor->correlation[lag] > peak) {
+            peak = predictor->correlation[lag];
+            peakLag = lag;
+        }
+    }
+
+    if (peakLag && peak * MAX_SMITH_SAMPLES > SMITH_DELAY_PEAK_RATIO * correlationSum) {
+        predictor->delayEstimate += SMITH_DELAY_ESTIMATE_GAIN * (peakLag - predictor->delayEstimate);
+        predictor->samples = constrain(lrintf(predictor->delayEstimate), 1, MAX_SMITH_SAMPLES);
+    }
+}
+
 FUNCTION_COMPILE_FOR_SPEED
-float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample) {
+float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample, float output) {
     UNUSED(axis);
     if (predictor->enabled) {
+        if (predictor->adaptive) {
+            smithPredictorMeasureDelay(predictor, sample, output);
+        }
+
         predictor->data[predictor->idx] = sample;
 
         predictor->idx++;
@@ -55,11 +112,19 @@ float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sampl
 }
 
 FUNCTION_COMPILE_FOR_SIZE
-void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime) {
+void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime, bool adaptive) {
     if (delay > 0.1) {
         predictor->enabled = true;
-        predictor->samples = (delay * 1000) / looptime;
+        predictor->samples = constrain((delay * 1000) / looptime, 1, MAX_SMITH_SAMPLES);
         predictor->idx = 0;
+        predictor->adaptive = adaptive;
+        predictor->lagIdx = 1;
+        predictor->historyIdx = 0;
+        predictor->outputMean = 0.0f;
+        predictor->previousSample = 0.0f;
+        predictor->delayEstimate = predictor->samples;
+        memset(predictor->outputHistory, 0, sizeof(predictor->outputHistory));
+        memset(predictor->correlation, 0, sizeof(predictor->correlation));
         predictor->smithPredictorStrength = strength;
         pt1FilterInit(&predictor->smithPredictorFilter, filterLpfHz, looptime * 1e-6f);
     } else {
@@ -39,7 +39,17 @@ typedef struct smithPredictor_s {
     float data[MAX_SMITH_SAMPLES + 1];
     pt1Filter_t smithPredictorFilter;
     float smithPredictorStrength;
+
+    // Online delay measurement: correlation of actuator output with gyro response per lag
+    bool adaptive;
+    uint8_t lagIdx;
+    uint8_t historyIdx;
+    float outputMean;
+    float previousSample;
+    float delayEstimate;
+    float outputHistory[MAX_SMITH_SAMPLES + 1];
+    float correlation[MAX_SMITH_SAMPLES + 1];
 } smithPredictor_t;
 
-float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample);
-void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime);
\ No newline at end of file
+float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample, float output);
+void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime, bool adaptive);
\ No newline at end of file
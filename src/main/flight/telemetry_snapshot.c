@@ -0,0 +1,109 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "fc/runtime_config.h"
+
+#include "flight/telemetry_snapshot.h"
+
+#include "io/gps.h"
+
+#include "navigation/navigation.h"
+
+#include "sensors/battery.h"
+
+#define TELEMETRY_SNAPSHOT_EFFICIENCY_TAU   1.0f    // [s] same smoothing the OSD elements used
+
+telemetrySnapshot_t telemetrySnapshot;
+
+static pt1Filter_t mAhPerKmFilter;
+static pt1Filter_t mWhPerKmFilter;
+static pt1Filter_t climbEfficiencyFilter;
+static timeUs_t lastUpdateUs = 0;
+
+static void telemetrySnapshotUpdateMotion(void)
+{
+    const int16_t climbRate = lrintf(getEstimatedActualVelocity(Z));
+#ifdef USE_GPS
+    const int16_t groundSpeed = gpsSol.groundSpeed;
+#else
+    const int16_t groundSpeed = 0;
+#endif
+    const int16_t speed3D = calc_length_pythagorean_2D(groundSpeed, climbRate);
+
+    if (groundSpeed != telemetrySnapshot.groundSpeed || speed3D != telemetrySnapshot.speed3D || climbRate != telemetrySnapshot.climbRate) {
+        telemetrySnapshot.groundSpeed = groundSpeed;
+        telemetrySnapshot.speed3D = speed3D;
+        telemetrySnapshot.climbRate = climbRate;
+        telemetrySnapshot.version[TELEMETRY_SNAPSHOT_MOTION]++;
+    }
+}
+
+static void telemetrySnapshotUpdateEfficiency(float dT)
+{
+    int32_t mAhPerKm = 0;
+    int32_t mWhPerKm = 0;
+    int32_t climbEfficiency = 0;
+
+    // amperage is in centi amps, speed is in cm/s
+    if (STATE(GPS_FIX) && telemetrySnapshot.groundSpeed > 0) {
+        mAhPerKm = pt1FilterApply4(&mAhPerKmFilter, ((float)getAmperage() / telemetrySnapshot.groundSpeed) / 0.0036f, TELEMETRY_SNAPSHOT_EFFICIENCY_TAU, dT);
+        mWhPerKm = pt1FilterApply4(&mWhPerKmFilter, ((float)getPower() / telemetrySnapshot.groundSpeed) / 0.0036f, TELEMETRY_SNAPSHOT_EFFICIENCY_TAU, dT);
+    }
+
+    if (telemetrySnapshot.climbRate > 0) {
+        climbEfficiency = pt1FilterApply4(&climbEfficiencyFilter, (float)getAmperage() / (telemetrySnapshot.climbRate / 100.0f), TELEMETRY_SNAPSHOT_EFFICIENCY_TAU, dT);
+    }
+
+    if (mAhPerKm != telemetrySnapshot.mAhPerKm || mWhPerKm != telemetrySnapshot.mWhPerKm || climbEfficiency != telemetrySnapshot.climbEfficiency) {
+        telemetrySnapshot.mAhPerKm = mAhPerKm;
+        telemetrySnapshot.mWhPerKm = mWhPerKm;
+        telemetrySnapshot.climbEfficiency = climbEfficiency;
+        telemetrySnapshot.version[TELEMETRY_SNAPSHOT_EFFICIENCY]++;
+    }
+}
+
+void telemetrySnapshotUpdate(timeUs_t currentTimeUs)
+{
+    const float dT = US2S(cmpTimeUs(currentTimeUs, lastUpdateUs));
+    lastUpdateUs = currentTimeUs;
+
+    telemetrySnapshotUpdateMotion();
+    telemetrySnapshotUpdateEfficiency(dT);
+}
+
+bool telemetrySnapshotChanged(telemetrySnapshotGroup_e group, uint16_t *seenVersion)
+{
+    if (*seenVersion == telemetrySnapshot.version[group]) {
+        return false;
+    }
+
+    *seenVersion = telemetrySnapshot.version[group];
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+/*
+ * Derived values shared by the OSD, DJI OSD and the telemetry links. They are
+ * computed once per update of a low priority task and every group carries a
+ * version counter, so a consumer can tell whether anything changed since it
+ * last read the group.
+ */
+typedef enum {
+    TELEMETRY_SNAPSHOT_MOTION = 0,          // groundSpeed, speed3D, climbRate
+    TELEMETRY_SNAPSHOT_EFFICIENCY,          // mAhPerKm, mWhPerKm, climbEfficiency
+    TELEMETRY_SNAPSHOT_GROUP_COUNT
+} telemetrySnapshotGroup_e;
+
+typedef struct telemetrySnapshot_s {
+    int16_t groundSpeed;                    // [cm/s]
+    int16_t speed3D;                        // [cm/s]
+    int16_t climbRate;                      // [cm/s]
+    int32_t mAhPerKm;                       // Filtered, 0 without GPS fix or ground speed
+    int32_t mWhPerKm;                       // Filtered, 0 without GPS fix or ground speed
+    int32_t climbEfficiency;                // [cA per m/s] filtered, 0 while not climbing
+    uint16_t version[TELEMETRY_SNAPSHOT_GROUP_COUNT];
+} telemetrySnapshot_t;
+
+extern telemetrySnapshot_t telemetrySnapshot;
+
+void telemetrySnapshotUpdate(timeUs_t currentTimeUs);
+// Returns true and takes the new version when the group changed since seenVersion
+bool telemetrySnapshotChanged(telemetrySnapshotGroup_e group, uint16_t *seenVersion);
@@ -40,23 +40,51 @@
 
 #include "io/gps.h"
 
-// Based on WindEstimation.pdf paper
+/*
+ * Wind is estimated with a small Kalman filter on every GPS velocity sample.
+ * The state is the wind vector in earth frame plus the airspeed along the
+ * fuselage, the measurement model is
+ *
+ *     groundVelocity = wind + airspeed * fuselageDirection
+ *
+ * which is linear in the state for a given attitude. The three velocity axes
+ * are fused one at a time, so an update costs the same on every sample and
+ * needs no matrix inversion. Straight flight leaves wind and airspeed along
+ * the fuselage unobservable, the covariance grows along that direction until
+ * a turn resolves it.
+ */
 
+#define WIND_STATE_AIRSPEED         3
+#define WIND_STATE_COUNT            4
+
+#define WIND_INITIAL_STD            1000.0f     // [cm/s]
+#define WIND_AIRSPEED_INITIAL_STD   500.0f      // [cm/s]
+#define WIND_PROCESS_NOISE          20.0f       // [cm/s/sqrt(s)] how fast wind is allowed to change
+#define WIND_AIRSPEED_PROCESS_NOISE 100.0f      // [cm/s/sqrt(s)] how fast airspeed is allowed to change
+#define WIND_GPS_VEL_NOISE_XY       50.0f       // [cm/s]
+#define WIND_GPS_VEL_NOISE_Z        100.0f      // [cm/s] angle of attack makes flight path and fuselage differ
+#define WIND_INNOVATION_GATE        5.0f        // [sigma] samples further off are rejected
+#define WIND_VALID_STD              150.0f      // [cm/s] horizontal wind is reported valid below this
+#define WIND_TIMEOUT_US             (10 * USECS_PER_SEC)
+
+static float windState[WIND_STATE_COUNT];                   // wind velocity vectors in cm / sec in earth frame, airspeed in cm / sec
+static float windCovariance[WIND_STATE_COUNT][WIND_STATE_COUNT];
+static timeUs_t lastUpdateUs = 0;
 static bool hasValidWindEstimate = false;
-static float estimatedWind[XYZ_AXIS_COUNT] = {0, 0, 0};    // wind velocity vectors in cm / sec in earth frame
-static float lastGroundVelocity[XYZ_AXIS_COUNT];
-static float lastFuselageDirection[XYZ_AXIS_COUNT];
 
 bool isEstimatedWindSpeedValid(void)
 {
-    // TODO: Add a timeout. Estimated wind should expire if
-    // if we can't update it for an extended time.
-    return hasValidWindEstimate;
+    return hasValidWindEstimate && cmpTimeUs(micros(), lastUpdateUs) < WIND_TIMEOUT_US;
 }
 
 float getEstimatedWindSpeed(int axis)
 {
-    return estimatedWind[axis];
+    return windState[axis];
+}
+
+float getEstimatedWindSpeedVariance(int axis)
+{
+    return windCovariance[axis][axis];
 }
 
 float getEstimatedHorizontalWindSpeed(uint16_t *angle)
@@ -75,10 +103,64 @@ float getEstimatedHorizontalWindSpeed(uint16_t *angle)
     return calc_length_pythagorean_2D(xWindSpeed, yWindSpeed);
 }
 
-void updateWindEstimator(timeUs_t currentTimeUs)
+static void windEstimatorResetAirspeed(float airspeed)
 {
-    static timeUs_t lastUpdateUs = 0;
+    for (int i = 0; i < WIND_STATE_COUNT; i++) {
+        windCovariance[i][WIND_STATE_AIRSPEED] = 0;
+        windCovariance[WIND_STATE_AIRSPEED][i] = 0;
+    }
+
+    windState[WIND_STATE_AIRSPEED] = MAX(airspeed, 0.0f);
+    windCovariance[WIND_STATE_AIRSPEED][WIND_STATE_AIRSPEED] = sq(WIND_AIRSPEED_INITIAL_STD);
+}
+
+static void windEstimatorReset(float airspeed)
+{
+    memset(windState, 0, sizeof(windState));
+    memset(windCovariance, 0, sizeof(windCovariance));
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        windCovariance[axis][axis] = sq(WIND_INITIAL_STD);
+    }
+
+    windEstimatorResetAirspeed(airspeed);
+    hasValidWindEstimate = false;
+}
+
+static void windEstimatorPredict(float dT)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        windCovariance[axis][axis] += sq(WIND_PROCESS_NOISE) * dT;
+    }
+    windCovariance[WIND_STATE_AIRSPEED][WIND_STATE_AIRSPEED] += sq(WIND_AIRSPEED_PROCESS_NOISE) * dT;
+}
 
+// Scalar update with groundVelocity[axis] = wind[axis] + airspeed * direction
+static void windEstimatorFuse(int axis, float groundVelocity, float direction, float variance)
+{
+    float PHt[WIND_STATE_COUNT];
+    for (int i = 0; i < WIND_STATE_COUNT; i++) {
+        PHt[i] = windCovariance[i][axis] + windCovariance[i][WIND_STATE_AIRSPEED] * direction;
+    }
+
+    const float innovationVariance = PHt[axis] + PHt[WIND_STATE_AIRSPEED] * direction + variance;
+    const float innovation = groundVelocity - (windState[axis] + windState[WIND_STATE_AIRSPEED] * direction);
+
+    if (sq(innovation) > sq(WIND_INNOVATION_GATE) * innovationVariance) {
+        return;
+    }
+
+    for (int i = 0; i < WIND_STATE_COUNT; i++) {
+        const float K = PHt[i] / innovationVariance;
+        windState[i] += K * innovation;
+        for (int j = 0; j < WIND_STATE_COUNT; j++) {
+            windCovariance[i][j] -= K * PHt[j];
+        }
+    }
+}
+
+void updateWindEstimator(timeUs_t currentTimeUs)
+{
     if (!STATE(FIXED_WING_LEGACY) ||
         !isGPSHeadingValid() ||
         !gpsSol.flags.validVelNE ||
@@ -87,12 +169,7 @@ void updateWindEstimator(timeUs_t currentTimeUs)
     }
 
     float groundVelocity[XYZ_AXIS_COUNT];
-    float groundVelocityDiff[XYZ_AXIS_COUNT];
-    float groundVelocitySum[XYZ_AXIS_COUNT];
-
     float fuselageDirection[XYZ_AXIS_COUNT];
-    float fuselageDirectionDiff[XYZ_AXIS_COUNT];
-    float fuselageDirectionSum[XYZ_AXIS_COUNT];
 
     // Get current 3D velocity from GPS in cm/s
     // relative to earth frame
@@ -101,74 +178,33 @@ void updateWindEstimator(timeUs_t currentTimeUs)
     groundVelocity[Z] = gpsSol.velNED[Z];
 
     // Fuselage direction in earth frame
-    fuselageDirection[X] = rMat[0][0];
-    fuselageDirection[Y] = -rMat[1][0];
-    fuselageDirection[Z] = -rMat[2][0];
-
-    timeDelta_t timeDelta = cmpTimeUs(currentTimeUs, lastUpdateUs);
-    // scrap our data and start over if we're taking too long to get a direction change
-    if (lastUpdateUs == 0 || timeDelta > 10 * USECS_PER_SEC) {
+    const fpMat3_t *rMat = imuGetRotationMatrix();
+    fuselageDirection[X] = rMat->m[0][0];
+    fuselageDirection[Y] = -rMat->m[1][0];
+    fuselageDirection[Z] = -rMat->m[2][0];
+
+    const float airspeed = groundVelocity[X] * fuselageDirection[X] + groundVelocity[Y] * fuselageDirection[Y] + groundVelocity[Z] * fuselageDirection[Z];
+    const timeDelta_t timeDelta = cmpTimeUs(currentTimeUs, lastUpdateUs);
+
+    if (lastUpdateUs == 0) {
+        windEstimatorReset(airspeed);
+    } else if (timeDelta > WIND_TIMEOUT_US) {
+        // Airspeed is long gone after a gap, wind is kept with the uncertainty it gathered meanwhile
+        windEstimatorPredict(US2S(WIND_TIMEOUT_US));
+        windEstimatorResetAirspeed(airspeed);
+    } else {
+        windEstimatorPredict(US2S(timeDelta));
+    }
 
-        lastUpdateUs = currentTimeUs;
+    lastUpdateUs = currentTimeUs;
 
-        memcpy(lastFuselageDirection, fuselageDirection, sizeof(lastFuselageDirection));
-        memcpy(lastGroundVelocity, groundVelocity, sizeof(lastGroundVelocity));
-        return;
-    }
+    windEstimatorFuse(X, groundVelocity[X], fuselageDirection[X], sq(WIND_GPS_VEL_NOISE_XY));
+    windEstimatorFuse(Y, groundVelocity[Y], fuselageDirection[Y], sq(WIND_GPS_VEL_NOISE_XY));
+    windEstimatorFuse(Z, groundVelocity[Z], fuselageDirection[Z], sq(WIND_GPS_VEL_NOISE_Z));
 
-    fuselageDirectionDiff[X] = fuselageDirection[X] - lastFuselageDirection[X];
-    fuselageDirectionDiff[Y] = fuselageDirection[Y] - lastFuselageDirection[Y];
-    fuselageDirectionDiff[Z] = fuselageDirection[Z] - lastFuselageDirection[Z];
-
-    float diffLengthSq = sq(fuselageDirectionDiff[X]) + sq(fuselageDirectionDiff[Y]) + sq(fuselageDirectionDiff[Z]);
-    
-    // Very small changes in attitude will result in a denominator
-    // very close to zero which will introduce too much error in the
-    // estimation.
-    //
-    // TODO: Is 0.2f an adequate threshold?
-    if (diffLengthSq > sq(0.2f)) {
-        // when turning, use the attitude response to estimate wind speed
-        groundVelocityDiff[X] = groundVelocity[X] - lastGroundVelocity[X];
-        groundVelocityDiff[Y] = groundVelocity[Y] - lastGroundVelocity[Y];
-        groundVelocityDiff[Z] = groundVelocity[Z] - lastGroundVelocity[Z];
-
-        // estimate airspeed it using equation 6
-        float V = (calc_length_pythagorean_3D(groundVelocityDiff[X], groundVelocityDiff[Y], groundVelocityDiff[Z])) / fast_fsqrtf(diffLengthSq);
-
-        fuselageDirectionSum[X] = fuselageDirection[X] + lastFuselageDirection[X];
-        fuselageDirectionSum[Y] = fuselageDirection[Y] + lastFuselageDirection[Y];
-        fuselageDirectionSum[Z] = fuselageDirection[Z] + lastFuselageDirection[Z];
-
-        groundVelocitySum[X] = groundVelocity[X] + lastGroundVelocity[X];
-        groundVelocitySum[Y] = groundVelocity[Y] + lastGroundVelocity[Y];
-        groundVelocitySum[Z] = groundVelocity[Z] + lastGroundVelocity[Z];
-
-        memcpy(lastFuselageDirection, fuselageDirection, sizeof(lastFuselageDirection));
-        memcpy(lastGroundVelocity, groundVelocity, sizeof(lastGroundVelocity));
-
-        float theta = atan2f(groundVelocityDiff[Y], groundVelocityDiff[X]) - atan2f(fuselageDirectionDiff[Y], fuselageDirectionDiff[X]);// equation 9
-        float sintheta = sinf(theta);
-        float costheta = cosf(theta);
-
-        float wind[XYZ_AXIS_COUNT];
-        wind[X] = (groundVelocitySum[X] - V * (costheta * fuselageDirectionSum[X] - sintheta * fuselageDirectionSum[Y])) * 0.5f;// equation 10
-        wind[Y] = (groundVelocitySum[Y] - V * (sintheta * fuselageDirectionSum[X] + costheta * fuselageDirectionSum[Y])) * 0.5f;// equation 11
-        wind[Z] = (groundVelocitySum[Z] - V * fuselageDirectionSum[Z]) * 0.5f;// equation 12
-
-        float prevWindLength = calc_length_pythagorean_3D(estimatedWind[X], estimatedWind[Y], estimatedWind[Z]);
-        float windLength = calc_length_pythagorean_3D(wind[X], wind[Y], wind[Z]);
-
-        if (windLength < prevWindLength + 2000) {
-            // TODO: Better filtering
-            estimatedWind[X] = estimatedWind[X] * 0.95f + wind[X] * 0.05f;
-            estimatedWind[Y] = estimatedWind[Y] * 0.95f + wind[Y] * 0.05f;
-            estimatedWind[Z] = estimatedWind[Z] * 0.95f + wind[Z] * 0.05f;
-        }
+    windState[WIND_STATE_AIRSPEED] = MAX(windState[WIND_STATE_AIRSPEED], 0.0f);
 
-        lastUpdateUs = currentTimeUs;
-        hasValidWindEstimate = true;
-    }
+    hasValidWindEstimate = MAX(windCovariance[X][X], windCovariance[Y][Y]) < sq(WIND_VALID_STD);
 }
 
 #endif
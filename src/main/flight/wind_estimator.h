@@ -28,6 +28,8 @@
 bool isEstimatedWindSpeedValid(void);
 // wind velocity vectors in cm / sec relative to the earth frame
 float getEstimatedWindSpeed(int axis);
+// Variance of the wind estimate in (cm/s)^2
+float getEstimatedWindSpeedVariance(int axis);
 // Returns the horizontal wind velocity as a magnitude in cm/s and,
 // optionally, its heading in EF in 0.01deg ([0, 360*100)).
 float getEstimatedHorizontalWindSpeed(uint16_t *angle);
@@ -38,7 +38,17 @@
     #define ONLY_EXPOSE_FOR_TESTING static
 #endif
 
+/*
+ * Number of 512-byte sectors in the cache. Targets with RAM to spare can override this, a larger cache lets more
+ * consecutive file sectors queue up behind a slow card and go out as one multi-block write.
+ */
+#ifndef AFATFS_NUM_CACHE_SECTORS
+#if defined(STM32F7) || defined(STM32H7)
+#define AFATFS_NUM_CACHE_SECTORS 16
+#else
 #define AFATFS_NUM_CACHE_SECTORS 8
+#endif
+#endif
 
 // FAT filesystems are allowed to differ from these parameters, but we choose not to support those weird filesystems:
 #define AFATFS_SECTOR_SIZE  512
@@ -813,14 +823,23 @@ static int afatfs_allocateCacheSector(uint32_t sectorIndex)
 bool afatfs_flush(void)
 {
     if (afatfs.cacheDirtyEntries > 0) {
-        // Flush the oldest flushable sector
+        // Flush the sector which continues the card's multi-block write if we have it, otherwise the oldest one
         uint32_t earliestSectorTime = 0xFFFFFFFF;
         int earliestSectorIndex = -1;
+        uint32_t multiWriteNextBlock;
+        const bool multiWriteInProgress = sdcard_getMultiWriteNextBlock(&multiWriteNextBlock);
 
         for (int i = 0; i < AFATFS_NUM_CACHE_SECTORS; i++) {
-            if (afatfs.cacheDescriptor[i].state == AFATFS_CACHE_STATE_DIRTY && !afatfs.cacheDescriptor[i].locked
-                && (earliestSectorIndex == -1 || afatfs.cacheDescriptor[i].writeTimestamp < earliestSectorTime)
-            ) {
+            if (afatfs.cacheDescriptor[i].state != AFATFS_CACHE_STATE_DIRTY || afatfs.cacheDescriptor[i].locked) {
+                continue;
+            }
+
+            if (multiWriteInProgress && afatfs.cacheDescriptor[i].sectorIndex == multiWriteNextBlock) {
+                earliestSectorIndex = i;
+                break;
+            }
+
+            if (earliestSectorIndex == -1 || afatfs.cacheDescriptor[i].writeTimestamp < earliestSectorTime) {
                 earliestSectorIndex = i;
                 earliestSectorTime = afatfs.cacheDescriptor[i].writeTimestamp;
             }
@@ -423,6 +423,11 @@ void dashboardUpdate(timeUs_t currentTimeUs)
     static uint8_t previousArmedState = 0;
     bool pageChanging;
 
+    // Changed pages go out in the background, also while CMS has the display
+    if (displayPresent) {
+        i2c_OLED_flush();
+    }
+
 #ifdef USE_CMS
     static bool wasGrabbed = false;
     if (displayIsGrabbed(displayPort)) {
@@ -24,12 +24,14 @@
 
 #ifdef USE_MSP_DISPLAYPORT
 
+#include "common/bitarray.h"
 #include "common/utils.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
 
 #include "drivers/display.h"
+#include "drivers/osd_symbols.h"
 
 #include "fc/fc_msp.h"
 
@@ -38,8 +40,27 @@
 #include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
 
+#define MSP_CLEAR_SCREEN    2
+#define MSP_WRITE_STRING    3
+#define MSP_DRAW_SCREEN     4
+
+#define MSP_DISPLAYPORT_MAX_ROWS    18
+#define MSP_DISPLAYPORT_MAX_COLS    50
+#define MSP_DISPLAYPORT_SCREEN_SIZE (MSP_DISPLAYPORT_MAX_ROWS * MSP_DISPLAYPORT_MAX_COLS)
+
+// MSPv1 framing ($M> + size + cmd + checksum) around a payload
+#define MSP_FRAME_OVERHEAD          6
+// Framing plus the row, column and attribute bytes of a string write
+#define MSP_WRITE_STRING_OVERHEAD   (MSP_FRAME_OVERHEAD + 4)
+
 static displayPort_t mspDisplayPort;
 
+// Writes only update this copy of the remote screen, the changed
+// characters are sent from drawScreen()
+static uint8_t screen[MSP_DISPLAYPORT_SCREEN_SIZE];
+static BITARRAY_DECLARE(dirty, MSP_DISPLAYPORT_SCREEN_SIZE);
+static bool screenChanged;
+
 extern uint8_t cliMode;
 
 static int output(displayPort_t *displayPort, uint8_t cmd, uint8_t *buf, int len)
@@ -75,17 +96,79 @@ static int release(displayPort_t *displayPort)
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
+static void resetScreen(void)
+{
+    memset(screen, SYM_BLANK, sizeof(screen));
+    BITARRAY_CLR_ALL(dirty);
+}
+
 static int clearScreen(displayPort_t *displayPort)
 {
-    uint8_t subcmd[] = { 2 };
+    uint8_t subcmd[] = { MSP_CLEAR_SCREEN };
 
+    resetScreen();
+    screenChanged = true;
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
+static uint32_t txBytesFree(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return mspSerialTxBytesFree();
+}
+
+/**
+ * Sends the changed characters as one string write per run on each row,
+ * then asks the remote to draw. Runs that don't fit in the TX buffer are
+ * kept for the next call.
+ */
 static int drawScreen(displayPort_t *displayPort)
 {
-    uint8_t subcmd[] = { 4 };
-    return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
+    uint8_t buf[MSP_DISPLAYPORT_MAX_COLS + 4];
+    const int cols = displayPort->cols;
+
+    buf[0] = MSP_WRITE_STRING;
+
+    int next = BITARRAY_FIND_FIRST_SET(dirty, 0);
+    while (next >= 0) {
+        const int row = next / cols;
+        const int rowEnd = (row + 1) * cols;
+
+        // Resending a few unchanged characters is cheaper than the
+        // header of another frame, so runs are merged across short gaps
+        int end = next + 1;
+        for (int pos = end; pos < rowEnd && pos - end < MSP_WRITE_STRING_OVERHEAD; pos++) {
+            if (bitArrayGet(dirty, pos)) {
+                end = pos + 1;
+            }
+        }
+
+        const int len = end - next;
+        // Keep room for the draw command
+        if (txBytesFree(displayPort) < (uint32_t)(len + MSP_WRITE_STRING_OVERHEAD + MSP_FRAME_OVERHEAD + 1)) {
+            break;
+        }
+
+        buf[1] = row;
+        buf[2] = next - row * cols;
+        buf[3] = 0;
+        memcpy(&buf[4], &screen[next], len);
+        for (int pos = next; pos < end; pos++) {
+            bitArrayClr(dirty, pos);
+        }
+        output(displayPort, MSP_DISPLAYPORT, buf, len + 4);
+        screenChanged = true;
+
+        next = BITARRAY_FIND_FIRST_SET(dirty, end);
+    }
+
+    if (!screenChanged) {
+        return 0;
+    }
+    screenChanged = false;
+
+    buf[0] = MSP_DRAW_SCREEN;
+    return output(displayPort, MSP_DISPLAYPORT, buf, 1);
 }
 
 static int screenSize(const displayPort_t *displayPort)
@@ -93,33 +176,35 @@ static int screenSize(const displayPort_t *displayPort)
     return displayPort->rows * displayPort->cols;
 }
 
-static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, const char *string, textAttributes_t attr)
+static int setChar(displayPort_t *displayPort, uint8_t col, uint8_t row, uint8_t c)
 {
-    UNUSED(attr);
-#define MSP_OSD_MAX_STRING_LENGTH 30 // FIXME move this
-    uint8_t buf[MSP_OSD_MAX_STRING_LENGTH + 4];
+    if (row >= displayPort->rows || col >= displayPort->cols) {
+        return 0;
+    }
 
-    int len = strlen(string);
-    if (len >= MSP_OSD_MAX_STRING_LENGTH) {
-        len = MSP_OSD_MAX_STRING_LENGTH;
+    const unsigned pos = row * displayPort->cols + col;
+    if (screen[pos] != c) {
+        screen[pos] = c;
+        bitArraySet(dirty, pos);
     }
+    return 0;
+}
 
-    buf[0] = 3;
-    buf[1] = row;
-    buf[2] = col;
-    buf[3] = 0;
-    memcpy(&buf[4], string, len);
+static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, const char *string, textAttributes_t attr)
+{
+    UNUSED(attr);
 
-    return output(displayPort, MSP_DISPLAYPORT, buf, len + 4);
+    while (*string && col < displayPort->cols) {
+        setChar(displayPort, col++, row, *string++);
+    }
+    return 0;
 }
 
 static int writeChar(displayPort_t *displayPort, uint8_t col, uint8_t row, uint16_t c, textAttributes_t attr)
 {
-    char buf[2];
+    UNUSED(attr);
 
-    buf[0] = c;
-    buf[1] = 0;
-    return writeString(displayPort, col, row, buf, attr); //!!TODO - check if there is a direct MSP command to do this
+    return setChar(displayPort, col, row, c);
 }
 
 static bool isTransferInProgress(const displayPort_t *displayPort)
@@ -134,12 +219,6 @@ static void resync(displayPort_t *displayPort)
     displayPort->cols = 30;
 }
 
-static uint32_t txBytesFree(const displayPort_t *displayPort)
-{
-    UNUSED(displayPort);
-    return mspSerialTxBytesFree();
-}
-
 static const displayPortVTable_t mspDisplayPortVTable = {
     .grab = grab,
     .release = release,
@@ -158,6 +237,7 @@ static const displayPortVTable_t mspDisplayPortVTable = {
 
 displayPort_t *displayPortMspInit(void)
 {
+    resetScreen();
     displayInit(&mspDisplayPort, &mspDisplayPortVTable);
     resync(&mspDisplayPort);
     return &mspDisplayPort;
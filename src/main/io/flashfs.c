@@ -28,18 +28,70 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "platform.h"
 
 #if defined(USE_FLASHFS)
 
+#include "common/crc.h"
+#include "common/maths.h"
+#include "common/time.h"
+#include "common/utils.h"
+
 #include "drivers/flash.h"
 
 #include "io/flashfs.h"
 
+// Granularity of the checks for erased space
+#define FLASHFS_FREE_BLOCK_SIZE 2048
+
 static flashPartition_t *flashPartition;
 
+#if defined(USE_FLASHFS_INDEX)
+/*
+ * The volume index is a journal of the logs on the volume, kept in a partition of its own. An entry is added when
+ * a log is closed and never rewritten, so a reset can at worst cost the entry of the log that was being written.
+ * The slots form a ring: once all of them are used the sector holding the oldest entries is erased for reuse, and
+ * the sequence number tells the newest entry apart after a reboot.
+ *
+ * With erase-ahead the volume is used as a ring too. The space ahead of the write head is erased in the background,
+ * and every sector that gets erased retires the old logs in it. A log never wraps around the end of the volume,
+ * the head goes back to the start between logs once less than the erase-ahead amount is left.
+ */
+#define FLASHFS_INDEX_MAGIC     0x4C46      // 'FL', seeds the entry CRC
+
+typedef struct {
+    uint32_t start;
+    uint32_t size;
+    uint32_t timestamp;
+    uint16_t sequence;
+    uint16_t crc;
+} flashfsIndexEntry_t;
+
+static struct {
+    uint32_t address;           // Flash address of the first slot
+    uint16_t slotSize;          // NAND pages can only be programmed a few times, so entries get a page each there
+    uint16_t slotsPerSector;
+    uint16_t capacity;
+    uint16_t used;              // Slots in use, the oldest one is `used` slots before nextSlot
+    uint16_t live;              // Newest entries whose logs are still intact
+    uint16_t nextSlot;
+    uint16_t nextSequence;
+    uint32_t end;               // End of the newest log
+    uint32_t logStart;
+    uint32_t logTimestamp;
+    bool logOpen;
+} flashfsIndex;
+
+static struct {
+    uint32_t size;              // Space to keep erased ahead of the head, 0 when the volume isn't used as a ring
+    uint32_t erasedEnd;         // Everything from the head up to here is erased
+    uint32_t checkOffset;       // How much of the sector at erasedEnd was found erased already
+} flashfsEraseAhead;
+#endif
+
 static uint8_t flashWriteBuffer[FLASHFS_WRITE_BUFFER_SIZE];
 
 /* The position of our head and tail in the circular flash write buffer.
@@ -74,6 +126,20 @@ void flashfsEraseCompletely(void)
     flashPartitionErase(flashPartition);
     flashfsClearBuffer();
     flashfsSetTailAddress(0);
+
+#if defined(USE_FLASHFS_INDEX)
+    flashPartition_t *indexPartition = flashPartitionFindByType(FLASH_PARTITION_TYPE_FLASHFS_INDEX);
+    if (indexPartition) {
+        flashPartitionErase(indexPartition);
+    }
+    flashfsIndex.used = 0;
+    flashfsIndex.live = 0;
+    flashfsIndex.nextSlot = 0;
+    flashfsIndex.end = 0;
+    flashfsIndex.logOpen = false;
+    flashfsEraseAhead.erasedEnd = flashfsGetSize();
+    flashfsEraseAhead.checkOffset = 0;
+#endif
 }
 
 void flashfsClose(void)
@@ -141,6 +207,21 @@ static uint32_t flashfsTransmitBufferUsed(void)
     return FLASHFS_WRITE_BUFFER_SIZE - bufferTail + bufferHead;
 }
 
+/**
+ * Number of buffered bytes that should trigger a flush: enough to reach the end of the page being written,
+ * so program operations line up with the chip's pages, but never more than FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN.
+ */
+static uint32_t flashfsAutoFlushLen(void)
+{
+    const uint32_t pageSize = flashGetGeometry()->pageSize;
+
+    if (pageSize == 0) {
+        return FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN;
+    }
+
+    return MIN(pageSize - tailAddress % pageSize, (uint32_t)FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN);
+}
+
 /**
  * Get the size of the largest single write that flashfs could ever accept without blocking or data loss.
  */
@@ -209,6 +290,14 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
             bytesTotalThisIteration = bytesTotalRemaining;
         }
 
+        /*
+         * Large pages are loaded in several asynchronous calls, the chip only starts programming once the load
+         * reaches the page boundary.
+         */
+        if (!sync) {
+            bytesTotalThisIteration = MIN(bytesTotalThisIteration, (uint32_t)FLASHFS_ASYNC_WRITE_MAX_LEN);
+        }
+
         // Are we at EOF already? Abort.
         if (flashfsIsEOF()) {
             // May as well throw away any buffered data
@@ -382,7 +471,7 @@ void flashfsWriteByte(uint8_t byte)
         bufferHead = 0;
     }
 
-    if (flashfsTransmitBufferUsed() >= FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN) {
+    if (flashfsTransmitBufferUsed() >= flashfsAutoFlushLen()) {
         flashfsFlushAsync();
     }
 }
@@ -409,7 +498,7 @@ void flashfsWrite(const uint8_t *data, unsigned int len, bool sync)
      * Would writing this data to our buffer cause our buffer to reach the flush threshold? If so try to write through
      * to the flash now
      */
-    if (bufferSizes[0] + bufferSizes[1] + bufferSizes[2] >= FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN) {
+    if (bufferSizes[0] + bufferSizes[1] + bufferSizes[2] >= flashfsAutoFlushLen()) {
         uint32_t bytesWritten;
 
         // Attempt to write all three buffers through to the flash asynchronously
@@ -494,10 +583,30 @@ int flashfsReadAbs(uint32_t address, uint8_t *buffer, unsigned int len)
     return bytesRead;
 }
 
+#if defined(USE_FLASHFS_INDEX)
+static bool flashfsIsBlockErased(uint32_t address)
+{
+    uint32_t testBuffer[4];
+
+    if (flashReadBytes(address, (uint8_t *)testBuffer, sizeof(testBuffer)) < (int)sizeof(testBuffer)) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < ARRAYLEN(testBuffer); i++) {
+        if (testBuffer[i] != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 /**
- * Find the offset of the start of the free space on the device (or the size of the device if it is full).
+ * Find the offset of the start of the free space on the device (or the size of the device if it is full), searching
+ * from the given offset onwards.
  */
-int flashfsIdentifyStartOfFreeSpace(void)
+static uint32_t flashfsSearchStartOfFreeSpace(uint32_t from)
 {
     /* Find the start of the free space on the device by examining the beginning of blocks with a binary search,
      * looking for ones that appear to be erased. We can achieve this with good accuracy because an erased block
@@ -512,7 +621,7 @@ int flashfsIdentifyStartOfFreeSpace(void)
         /* We can choose whatever power of 2 size we like, which determines how much wastage of free space we'll have
          * at the end of the last written data. But smaller blocksizes will require more searching.
          */
-        FREE_BLOCK_SIZE = 2048,
+        FREE_BLOCK_SIZE = FLASHFS_FREE_BLOCK_SIZE,
 
         /* We don't expect valid data to ever contain this many consecutive uint32_t's of all 1 bits: */
         FREE_BLOCK_TEST_SIZE_INTS = 4, // i.e. 16 bytes
@@ -524,7 +633,7 @@ int flashfsIdentifyStartOfFreeSpace(void)
         uint32_t ints[FREE_BLOCK_TEST_SIZE_INTS];
     } testBuffer;
 
-    int left = 0; // Smallest block index in the search region
+    int left = (from + FREE_BLOCK_SIZE - 1) / FREE_BLOCK_SIZE; // Smallest block index in the search region
     int right = flashfsGetSize() / FREE_BLOCK_SIZE; // One past the largest block index in the search region
     int mid;
     int result = right;
@@ -560,7 +669,346 @@ int flashfsIdentifyStartOfFreeSpace(void)
         }
     }
 
-    return result * FREE_BLOCK_SIZE;
+    return MAX(result * FREE_BLOCK_SIZE, (int)from);
+}
+
+#if defined(USE_FLASHFS_INDEX)
+static uint16_t flashfsIndexEntryCrc(const flashfsIndexEntry_t *entry)
+{
+    return crc16_ccitt_update(FLASHFS_INDEX_MAGIC, entry, offsetof(flashfsIndexEntry_t, crc));
+}
+
+static bool flashfsIndexReadSlot(uint16_t slot, flashfsIndexEntry_t *entry)
+{
+    return flashReadBytes(flashfsIndex.address + slot * flashfsIndex.slotSize, (uint8_t *)entry, sizeof(*entry)) == (int)sizeof(*entry);
+}
+
+static bool flashfsIndexIsEntryErased(const flashfsIndexEntry_t *entry)
+{
+    const uint8_t *bytes = (const uint8_t *)entry;
+
+    for (unsigned i = 0; i < sizeof(*entry); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Slot of the given live entry, 0 being the oldest one.
+ */
+static uint16_t flashfsIndexGetSlot(uint16_t liveIndex)
+{
+    return (flashfsIndex.nextSlot + flashfsIndex.capacity - flashfsIndex.live + liveIndex) % flashfsIndex.capacity;
+}
+
+/**
+ * Where the free space starts if everything on the volume went through the index.
+ */
+static uint32_t flashfsIndexGetFreeSpaceHint(void)
+{
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    if (geometry->flashType == FLASH_TYPE_NAND) {
+        // flashfsClose() moved on to the next page after the log
+        return (flashfsIndex.end + geometry->pageSize - 1) & ~(geometry->pageSize - 1);
+    }
+
+    return flashfsIndex.end;
+}
+
+static void flashfsIndexAppend(uint32_t start, uint32_t size, uint32_t timestamp)
+{
+    if (!flashfsIndex.capacity || size == 0) {
+        return;
+    }
+
+    // The next slot is the oldest one when all are used, its sector makes room
+    if (flashfsIndex.used == flashfsIndex.capacity) {
+        flashEraseSector(flashfsIndex.address + flashfsIndex.nextSlot * flashfsIndex.slotSize);
+        flashfsIndex.used -= flashfsIndex.slotsPerSector;
+        flashfsIndex.live = MIN(flashfsIndex.live, flashfsIndex.used);
+    }
+
+    flashfsIndexEntry_t entry = {
+        .start = start,
+        .size = size,
+        .timestamp = timestamp,
+        .sequence = flashfsIndex.nextSequence,
+    };
+    entry.crc = flashfsIndexEntryCrc(&entry);
+
+    flashPageProgram(flashfsIndex.address + flashfsIndex.nextSlot * flashfsIndex.slotSize, (const uint8_t *)&entry, sizeof(entry));
+    flashFlush();
+
+    flashfsIndex.nextSlot = (flashfsIndex.nextSlot + 1) % flashfsIndex.capacity;
+    flashfsIndex.nextSequence++;
+    flashfsIndex.used++;
+    flashfsIndex.live++;
+    flashfsIndex.end = start + size;
+}
+
+/**
+ * Drop the oldest live entries whose logs overlap [start, end), the range is about to be erased.
+ */
+static void flashfsIndexRetire(uint32_t start, uint32_t end)
+{
+    while (flashfsIndex.live > 0) {
+        flashfsIndexEntry_t entry;
+
+        if (flashfsIndexReadSlot(flashfsIndexGetSlot(0), &entry) && entry.crc == flashfsIndexEntryCrc(&entry) &&
+            (entry.start >= end || entry.start + entry.size <= start)) {
+            break;
+        }
+
+        flashfsIndex.live--;
+    }
+}
+
+/**
+ * Walk back from the newest entry for as long as the logs lie behind each other in the order they were written,
+ * wrapping around the end of the volume at most once and not into the erased space.
+ */
+static void flashfsIndexUpdateLive(void)
+{
+    uint32_t low = tailAddress;
+    bool wrapped = false;
+
+    flashfsIndex.live = 0;
+
+    while (flashfsIndex.live < flashfsIndex.used) {
+        const uint16_t slot = (flashfsIndex.nextSlot + flashfsIndex.capacity - 1 - flashfsIndex.live) % flashfsIndex.capacity;
+        flashfsIndexEntry_t entry;
+
+        if (!flashfsIndexReadSlot(slot, &entry) || entry.crc != flashfsIndexEntryCrc(&entry)) {
+            break;
+        }
+
+        const uint32_t logEnd = entry.start + entry.size;
+
+        if (!wrapped && logEnd <= low) {
+            low = entry.start;
+        } else if (entry.start >= flashfsEraseAhead.erasedEnd && logEnd <= (wrapped ? low : flashfsGetSize())) {
+            wrapped = true;
+            low = entry.start;
+        } else {
+            break;
+        }
+
+        flashfsIndex.live++;
+    }
+}
+
+/**
+ * Read the used slots, writes go in order within a sector and sectors are erased as a whole.
+ */
+static void flashfsIndexInit(void)
+{
+    const flashPartition_t *partition = flashPartitionFindByType(FLASH_PARTITION_TYPE_FLASHFS_INDEX);
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    memset(&flashfsIndex, 0, sizeof(flashfsIndex));
+
+    if (!partition) {
+        return;
+    }
+
+    flashfsIndex.address = partition->startSector * geometry->sectorSize;
+    flashfsIndex.slotSize = geometry->flashType == FLASH_TYPE_NAND ? geometry->pageSize : sizeof(flashfsIndexEntry_t);
+    flashfsIndex.slotsPerSector = geometry->sectorSize / flashfsIndex.slotSize;
+    flashfsIndex.capacity = FLASH_PARTITION_SECTOR_COUNT(partition) * flashfsIndex.slotsPerSector;
+
+    flashfsIndexEntry_t entry;
+    flashfsIndexEntry_t newest;
+    int newestSlot = -1;
+
+    for (int slot = 0; slot < flashfsIndex.capacity; slot++) {
+        if (!flashfsIndexReadSlot(slot, &entry) || flashfsIndexIsEntryErased(&entry)) {
+            // Skip to the next sector
+            slot += flashfsIndex.slotsPerSector - 1 - slot % flashfsIndex.slotsPerSector;
+            continue;
+        }
+
+        flashfsIndex.used++;
+
+        if (entry.crc == flashfsIndexEntryCrc(&entry) && (newestSlot < 0 || (int16_t)(entry.sequence - newest.sequence) > 0)) {
+            newest = entry;
+            newestSlot = slot;
+        }
+    }
+
+    if (newestSlot < 0) {
+        // Nothing but unknown data, which the slots can't be programmed over
+        if (flashfsIndex.used) {
+            flashPartitionErase((flashPartition_t *)partition);
+            flashfsIndex.used = 0;
+        }
+        return;
+    }
+
+    flashfsIndex.nextSlot = (newestSlot + 1) % flashfsIndex.capacity;
+    flashfsIndex.nextSequence = newest.sequence + 1;
+    flashfsIndex.end = newest.start + newest.size;
+}
+
+/**
+ * Remember where the log starting now begins, its entry is written by flashfsEndLog().
+ */
+void flashfsBeginLog(void)
+{
+    rtcTime_t now;
+
+    flashfsIndex.logStart = flashfsGetOffset();
+    flashfsIndex.logTimestamp = rtcGet(&now) ? rtcTimeGetSeconds(&now) : 0;
+    flashfsIndex.logOpen = true;
+}
+
+void flashfsEndLog(void)
+{
+    if (!flashfsIndex.logOpen) {
+        return;
+    }
+
+    flashfsFlushSync();
+
+    flashfsIndex.logOpen = false;
+    flashfsIndexAppend(flashfsIndex.logStart, tailAddress - flashfsIndex.logStart, flashfsIndex.logTimestamp);
+}
+
+uint16_t flashfsGetLogCount(void)
+{
+    return flashfsIndex.live;
+}
+
+/**
+ * Logs are numbered from the oldest one still on the volume. An entry that doesn't check out is reported as an empty
+ * log, so the numbers stay stable.
+ */
+bool flashfsGetLogInfo(uint16_t index, flashfsLogInfo_t *info)
+{
+    flashfsIndexEntry_t entry;
+
+    memset(info, 0, sizeof(*info));
+
+    if (index >= flashfsIndex.live || !flashfsIndexReadSlot(flashfsIndexGetSlot(index), &entry) || entry.crc != flashfsIndexEntryCrc(&entry)) {
+        return false;
+    }
+
+    info->start = entry.start;
+    info->size = entry.size;
+    info->timestamp = entry.timestamp;
+
+    return true;
+}
+
+/**
+ * Keep the given amount of space erased ahead of the write head and retire the oldest logs to make room, instead of
+ * refusing to log once the volume is full. Must be called before flashfsInit().
+ */
+void flashfsSetEraseAhead(uint32_t size)
+{
+    flashfsEraseAhead.size = size;
+}
+
+/**
+ * Background part of erase-ahead, call regularly. Sector erases on NOR chips take long enough to stall anything else
+ * that reads the chip, they have to be allowed by the caller and never happen during a log. NAND blocks erase within
+ * a few milliseconds, which the write buffer absorbs.
+ */
+void flashfsEraseAheadUpdate(bool allowLongErase)
+{
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    if (!flashfsEraseAhead.size || !flashfsBufferIsEmpty() || !flashIsReady()) {
+        return;
+    }
+
+    if (flashfsIndex.logOpen && tailAddress >= flashfsEraseAhead.erasedEnd) {
+        // The log ran into the end of the erased space and the blackbox stopped, anything past it went over old data
+        flashfsIndexRetire(flashfsEraseAhead.erasedEnd, tailAddress);
+        flashfsEndLog();
+
+        // Carry on erasing after the sector that is partly overwritten
+        const uint32_t sectorSize = geometry->sectorSize;
+        flashfsEraseAhead.erasedEnd = MIN((tailAddress + sectorSize - 1) / sectorSize * sectorSize, flashfsGetSize());
+        flashfsEraseAhead.checkOffset = 0;
+        flashfsSetTailAddress(flashfsEraseAhead.erasedEnd);
+        return;
+    }
+
+    if (!flashfsIndex.logOpen && flashfsGetSize() - tailAddress < flashfsEraseAhead.size) {
+        // Not enough room left for a log, go round to the start of the volume
+        flashfsSetTailAddress(0);
+        flashfsEraseAhead.erasedEnd = 0;
+        flashfsEraseAhead.checkOffset = 0;
+    }
+
+    if (flashfsEraseAhead.erasedEnd >= flashfsGetSize() || flashfsEraseAhead.erasedEnd - tailAddress >= flashfsEraseAhead.size) {
+        return;
+    }
+
+    if (flashfsEraseAhead.checkOffset == 0) {
+        flashfsIndexRetire(flashfsEraseAhead.erasedEnd, flashfsEraseAhead.erasedEnd + geometry->sectorSize);
+    }
+
+    // Sectors that are erased already are left alone, which spares the chip the same erases after every reboot
+    if (flashfsIsBlockErased(flashfsEraseAhead.erasedEnd + flashfsEraseAhead.checkOffset)) {
+        flashfsEraseAhead.checkOffset += FLASHFS_FREE_BLOCK_SIZE;
+
+        if (flashfsEraseAhead.checkOffset < geometry->sectorSize) {
+            return;
+        }
+    } else {
+        if (geometry->flashType != FLASH_TYPE_NAND && (!allowLongErase || flashfsIndex.logOpen)) {
+            return;
+        }
+
+        flashEraseSector(flashfsEraseAhead.erasedEnd);
+    }
+
+    flashfsEraseAhead.erasedEnd += geometry->sectorSize;
+    flashfsEraseAhead.checkOffset = 0;
+}
+#endif
+
+/**
+ * Find the offset of the start of the free space on the device (or the size of the device if it is full).
+ *
+ * With a volume index this is normally a single read confirming the space after the last indexed log is erased.
+ * Data written after it without an index entry (e.g. a log cut short by a reset) is skipped with a search.
+ */
+int flashfsIdentifyStartOfFreeSpace(void)
+{
+    uint32_t from = 0;
+
+#if defined(USE_FLASHFS_INDEX)
+    from = flashfsIndexGetFreeSpaceHint();
+
+    if (from >= flashfsGetSize()) {
+        return flashfsGetSize();
+    }
+
+    if (flashfsIsBlockErased(from)) {
+        return from;
+    }
+
+    if (flashfsEraseAhead.size) {
+        // Past the erased space the volume holds older logs, which a binary search would take for newer ones
+        const uint32_t limit = MIN(from + flashfsEraseAhead.size, flashfsGetSize());
+
+        for (uint32_t address = (from + FLASHFS_FREE_BLOCK_SIZE - 1) & ~(FLASHFS_FREE_BLOCK_SIZE - 1); address < limit; address += FLASHFS_FREE_BLOCK_SIZE) {
+            if (flashfsIsBlockErased(address)) {
+                return address;
+            }
+        }
+
+        return limit;
+    }
+#endif
+
+    return flashfsSearchStartOfFreeSpace(from);
 }
 
 /**
@@ -568,6 +1016,12 @@ int flashfsIdentifyStartOfFreeSpace(void)
  */
 bool flashfsIsEOF(void)
 {
+#if defined(USE_FLASHFS_INDEX)
+    if (flashfsEraseAhead.size) {
+        return tailAddress >= flashfsEraseAhead.erasedEnd;
+    }
+#endif
+
     return tailAddress >= flashfsGetSize();
 }
 
@@ -579,8 +1033,30 @@ void flashfsInit(void)
     flashPartition = flashPartitionFindByType(FLASH_PARTITION_TYPE_FLASHFS);
 
     if (flashPartition) {
+#if defined(USE_FLASHFS_INDEX)
+        const uint32_t sectorSize = flashGetGeometry()->sectorSize;
+
+        flashfsEraseAhead.size = MIN(flashfsEraseAhead.size, flashfsGetSize() / 2);
+        flashfsIndexInit();
+
+        const uint32_t indexEnd = flashfsIndexGetFreeSpaceHint();
+        const uint32_t freeStart = flashfsIdentifyStartOfFreeSpace();
+
+        // Give data nobody indexed an entry of its own, so it's listed and the next boot doesn't search again
+        if (freeStart > indexEnd) {
+            flashfsIndexAppend(indexEnd, freeStart - indexEnd, 0);
+        }
+
+        // Start the file pointer off at the beginning of free space so caller can start writing immediately
+        flashfsSeekAbs(freeStart);
+
+        // The rest of the sector the head is in was erased together with it
+        flashfsEraseAhead.erasedEnd = flashfsEraseAhead.size ? MIN((freeStart + sectorSize - 1) / sectorSize * sectorSize, flashfsGetSize()) : flashfsGetSize();
+        flashfsIndexUpdateLive();
+#else
         // Start the file pointer off at the beginning of free space so caller can start writing immediately
         flashfsSeekAbs(flashfsIdentifyStartOfFreeSpace());
+#endif
     }
 }
 
@@ -21,11 +21,27 @@
 
 #include "drivers/flash.h"
 
+/*
+ * Targets can override the write buffer size. NAND chips with 2KB pages (W25N01G) get a buffer that holds a whole
+ * page, so every program operation writes a complete page instead of a string of partial ones.
+ */
+#ifndef FLASHFS_WRITE_BUFFER_SIZE
+#if defined(USE_FLASH_W25N01G) && (defined(STM32F7) || defined(STM32H7))
+#define FLASHFS_WRITE_BUFFER_SIZE 4096
+#elif defined(USE_FLASH_W25N01G)
+#define FLASHFS_WRITE_BUFFER_SIZE 2048
+#else
 #define FLASHFS_WRITE_BUFFER_SIZE 128
+#endif
+#endif
+
 #define FLASHFS_WRITE_BUFFER_USABLE (FLASHFS_WRITE_BUFFER_SIZE - 1)
 
-// Automatically trigger a flush when this much data is in the buffer
-#define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN 64
+// Automatically trigger a flush when this much data is in the buffer, or earlier if it completes the current page
+#define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN (FLASHFS_WRITE_BUFFER_SIZE / 2)
+
+// Largest chunk an asynchronous flush hands to the chip in one call, bounds the time spent blocking on the bus
+#define FLASHFS_ASYNC_WRITE_MAX_LEN 512
 
 void flashfsEraseCompletely(void);
 void flashfsEraseRange(uint32_t start, uint32_t end);
@@ -53,3 +69,20 @@ void flashfsInit(void);
 
 bool flashfsIsReady(void);
 bool flashfsIsEOF(void);
+
+#if defined(USE_FLASHFS_INDEX)
+typedef struct {
+    uint32_t start;
+    uint32_t size;
+    uint32_t timestamp;     // Seconds since 1970 at the start of the log, 0 when the time wasn't known
+} flashfsLogInfo_t;
+
+void flashfsBeginLog(void);
+void flashfsEndLog(void);
+
+uint16_t flashfsGetLogCount(void);
+bool flashfsGetLogInfo(uint16_t index, flashfsLogInfo_t *info);
+
+void flashfsSetEraseAhead(uint32_t size);
+void flashfsEraseAheadUpdate(bool allowLongErase);
+#endif
@@ -239,7 +239,9 @@ typedef struct frskyOSDState_s {
         uint8_t pos;
     } sendBuffer;
     struct {
-        uint8_t state;
+        // Filled from the serial RX callback, state is only reset from
+        // the main loop once it reached RECV_STATE_DONE
+        volatile uint8_t state;
         uint8_t crc;
         uint16_t expected;
         uint8_t expectedShift;
@@ -287,11 +289,12 @@ static bool frskyOSDSpeaksV2(void)
 
 static void frskyOSDResetReceiveBuffer(void)
 {
-    state.recvBuffer.state = RECV_STATE_NONE;
     state.recvBuffer.crc = 0;
     state.recvBuffer.expected = 0;
     state.recvBuffer.expectedShift = 0;
     state.recvBuffer.pos = 0;
+    // Last, the RX callback starts on a new frame as soon as it sees this
+    state.recvBuffer.state = RECV_STATE_NONE;
 }
 
 static void frskyOSDResetSendBuffer(void)
@@ -299,13 +302,17 @@ static void frskyOSDResetSendBuffer(void)
     state.sendBuffer.pos = 0;
 }
 
-static void frskyOSDProcessCommandU8(uint8_t *crc, uint8_t c)
+static void frskyOSDWriteBuf(const uint8_t *data, size_t size)
 {
-    while (serialTxBytesFree(state.port) == 0) {
-    };
-    serialWrite(state.port, c);
-    if (crc) {
-        *crc = crc8_dvb_s2(*crc, c);
+    // Hand the frame to the serial driver in as large chunks as its
+    // TX buffer takes instead of a byte at a time
+    while (size > 0) {
+        const size_t chunk = MIN(size, serialTxBytesFree(state.port));
+        if (chunk > 0) {
+            serialWriteBuf(state.port, data, chunk);
+            data += chunk;
+            size -= chunk;
+        }
     }
 }
 
@@ -339,60 +346,58 @@ static void frskyOSDStateReset(serialPort_t *port, baudRate_e baudrate)
     state.initialized = false;
 }
 
-static void frskyOSDUpdateReceiveBuffer(void)
+// Called from the serial RX interrupt, so it must not log
+static void frskyOSDReceiveByte(uint16_t data, void *rxCallbackData)
 {
-    while (serialRxBytesWaiting(state.port) > 0) {
-        uint8_t c = serialRead(state.port);
-        switch ((frskyOSDRecvState_e)state.recvBuffer.state) {
-            case RECV_STATE_NONE:
-                if (c != FRSKY_OSD_PREAMBLE_BYTE_0) {
-                    break;
-                }
-                state.recvBuffer.state = RECV_STATE_SYNC;
-                break;
-            case RECV_STATE_SYNC:
-                if (c != FRSKY_OSD_PREAMBLE_BYTE_1) {
-                    frskyOSDResetReceiveBuffer();
-                    break;
-                }
-                state.recvBuffer.state = RECV_STATE_LENGTH;
-                break;
-            case RECV_STATE_LENGTH:
-                state.recvBuffer.crc = frskyOSDChecksum(state.recvBuffer.crc, c);
-                state.recvBuffer.expected |= (c & 0x7F) << state.recvBuffer.expectedShift;
-                state.recvBuffer.expectedShift += 7;
-                if (c < 0x80) {
-                    // Full uvarint decoded. Check against buffer size.
-                    if (state.recvBuffer.expected > sizeof(state.recvBuffer.data)) {
-                        FRSKY_OSD_ERROR("Can't handle payload of size %u with a buffer of size %u",
-                            state.recvBuffer.expected, sizeof(state.recvBuffer.data));
-                        frskyOSDResetReceiveBuffer();
-                        break;
-                    }
-                    FRSKY_OSD_TRACE("Payload of size %u", state.recvBuffer.expected);
-                    state.recvBuffer.state = state.recvBuffer.expected > 0 ? RECV_STATE_DATA : RECV_STATE_CHECKSUM;
-                }
+    UNUSED(rxCallbackData);
+
+    const uint8_t c = data;
+
+    switch ((frskyOSDRecvState_e)state.recvBuffer.state) {
+        case RECV_STATE_NONE:
+            if (c != FRSKY_OSD_PREAMBLE_BYTE_0) {
                 break;
-            case RECV_STATE_DATA:
-                state.recvBuffer.data[state.recvBuffer.pos++] = c;
-                state.recvBuffer.crc = frskyOSDChecksum(state.recvBuffer.crc, c);
-                if (state.recvBuffer.pos == state.recvBuffer.expected) {
-                    state.recvBuffer.state = RECV_STATE_CHECKSUM;
-                }
+            }
+            state.recvBuffer.state = RECV_STATE_SYNC;
+            break;
+        case RECV_STATE_SYNC:
+            if (c != FRSKY_OSD_PREAMBLE_BYTE_1) {
+                frskyOSDResetReceiveBuffer();
                 break;
-            case RECV_STATE_CHECKSUM:
-                if (c != state.recvBuffer.crc) {
-                    FRSKY_OSD_DEBUG("Checksum error %u != %u. Discarding %u bytes",
-                        c, state.recvBuffer.crc, state.recvBuffer.pos);
+            }
+            state.recvBuffer.state = RECV_STATE_LENGTH;
+            break;
+        case RECV_STATE_LENGTH:
+            state.recvBuffer.crc = frskyOSDChecksum(state.recvBuffer.crc, c);
+            state.recvBuffer.expected |= (c & 0x7F) << state.recvBuffer.expectedShift;
+            state.recvBuffer.expectedShift += 7;
+            if (c < 0x80) {
+                // Full uvarint decoded. Check against buffer size.
+                if (state.recvBuffer.expected > sizeof(state.recvBuffer.data)) {
                     frskyOSDResetReceiveBuffer();
                     break;
                 }
-                state.recvBuffer.state = RECV_STATE_DONE;
-                break;
-            case RECV_STATE_DONE:
-                FRSKY_OSD_DEBUG("Received unexpected byte %u after data", c);
+                state.recvBuffer.state = state.recvBuffer.expected > 0 ? RECV_STATE_DATA : RECV_STATE_CHECKSUM;
+            }
+            break;
+        case RECV_STATE_DATA:
+            state.recvBuffer.data[state.recvBuffer.pos++] = c;
+            state.recvBuffer.crc = frskyOSDChecksum(state.recvBuffer.crc, c);
+            if (state.recvBuffer.pos == state.recvBuffer.expected) {
+                state.recvBuffer.state = RECV_STATE_CHECKSUM;
+            }
+            break;
+        case RECV_STATE_CHECKSUM:
+            if (c != state.recvBuffer.crc) {
+                frskyOSDResetReceiveBuffer();
                 break;
-        }
+            }
+            state.recvBuffer.state = RECV_STATE_DONE;
+            break;
+        case RECV_STATE_DONE:
+            // The OSD answers one command at a time, nothing should
+            // arrive before the response was dispatched
+            break;
     }
 }
 
@@ -403,13 +408,10 @@ static bool frskyOSDIsResponseAvailable(void)
 
 static void frskyOSDClearReceiveBuffer(void)
 {
-    frskyOSDUpdateReceiveBuffer();
-
+    // A frame still being received is left to the RX callback, it
+    // resyncs on its own if the frame turns out to be garbage
     if (frskyOSDIsResponseAvailable()) {
         frskyOSDDispatchResponse();
-    } else if (state.recvBuffer.pos > 0) {
-        FRSKY_OSD_DEBUG("Discarding receive buffer with %u bytes", state.recvBuffer.pos);
-        frskyOSDResetReceiveBuffer();
     }
 }
 
@@ -427,7 +429,6 @@ static bool frskyOSDSendSyncCommand(uint8_t cmd, const void *data, size_t size,
     frskyOSDFlushSendBuffer();
     timeMs_t end = millis() + timeout;
     while (millis() < end) {
-        frskyOSDUpdateReceiveBuffer();
         if (frskyOSDIsResponseAvailable() && frskyOSDDispatchResponse()) {
             FRSKY_OSD_TRACE("Got sync response");
             return true;
@@ -622,7 +623,7 @@ static bool frskyOSDOpenPort(baudRate_e baudrate)
         FRSKY_OSD_TRACE("configured, trying to connect...");
         portOptions_t portOptions = SERIAL_STOPBITS_1 | SERIAL_PARITY_NO;
         serialPort_t *port = openSerialPort(portConfig->identifier,
-            FUNCTION_FRSKY_OSD, NULL, NULL, baudRates[baudrate],
+            FUNCTION_FRSKY_OSD, frskyOSDReceiveByte, NULL, baudRates[baudrate],
             MODE_RXTX, portOptions);
 
         if (port) {
@@ -663,7 +664,6 @@ void frskyOSDUpdate(void)
     if (!state.port) {
         return;
     }
-    frskyOSDUpdateReceiveBuffer();
 
     if (frskyOSDIsResponseAvailable()) {
         frskyOSDDispatchResponse();
@@ -709,19 +709,17 @@ void frskyOSDCommitTransaction(void)
 void frskyOSDFlushSendBuffer(void)
 {
     if (state.sendBuffer.pos > 0) {
-        frskyOSDProcessCommandU8(NULL, FRSKY_OSD_PREAMBLE_BYTE_0);
-        frskyOSDProcessCommandU8(NULL, FRSKY_OSD_PREAMBLE_BYTE_1);
-
-        uint8_t crc = 0;
-        uint8_t buffer[4];
-        int lengthSize = uvarintEncode(state.sendBuffer.pos, buffer, sizeof(buffer));
-        for (int ii = 0; ii < lengthSize; ii++) {
-            frskyOSDProcessCommandU8(&crc, buffer[ii]);
-        }
-        for (unsigned ii = 0; ii < state.sendBuffer.pos; ii++) {
-            frskyOSDProcessCommandU8(&crc, state.sendBuffer.data[ii]);
-        }
-        frskyOSDProcessCommandU8(NULL, crc);
+        // All the commands queued since the last flush go out as a
+        // single checksummed frame
+        uint8_t header[2 + 4] = { FRSKY_OSD_PREAMBLE_BYTE_0, FRSKY_OSD_PREAMBLE_BYTE_1 };
+        int lengthSize = uvarintEncode(state.sendBuffer.pos, &header[2], sizeof(header) - 2);
+
+        uint8_t crc = crc8_dvb_s2_update(0, &header[2], lengthSize);
+        crc = crc8_dvb_s2_update(crc, state.sendBuffer.data, state.sendBuffer.pos);
+
+        frskyOSDWriteBuf(header, 2 + lengthSize);
+        frskyOSDWriteBuf(state.sendBuffer.data, state.sendBuffer.pos);
+        frskyOSDWriteBuf(&crc, sizeof(crc));
         state.sendBuffer.pos = 0;
     }
 }
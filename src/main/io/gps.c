@@ -50,6 +50,7 @@
 
 #include "io/serial.h"
 #include "io/gps.h"
+#include "io/gps_blend.h"
 #include "io/gps_private.h"
 
 #include "navigation/navigation.h"
@@ -62,50 +63,54 @@
 
 typedef struct {
     bool                isDriverBased;
+    bool                multiReceiver;      // Driver can run for a second receiver on another port
     portMode_t          portMode;           // Port mode RX/TX (only for serial based)
     void                (*restart)(void);   // Restart protocol driver thread
     void                (*protocol)(void);  // Process protocol driver thread
 } gpsProviderDescriptor_t;
 
 // GPS public data
-gpsReceiverData_t gpsState;
+gpsReceiverData_t gpsReceivers[GPS_RECEIVER_COUNT];
+gpsReceiverData_t *gpsState = &gpsReceivers[0];
 gpsStatistics_t   gpsStats;
 gpsSolutionData_t gpsSol;
 
+static uint8_t gpsReceiverCount = 1;
+
 // Map gpsBaudRate_e index to baudRate_e
 baudRate_e gpsToSerialBaudRate[GPS_BAUDRATE_COUNT] = { BAUD_115200, BAUD_57600, BAUD_38400, BAUD_19200, BAUD_9600, BAUD_230400 };
 
 static gpsProviderDescriptor_t gpsProviders[GPS_PROVIDER_COUNT] = {
     /* NMEA GPS */
 #ifdef USE_GPS_PROTO_NMEA
-    { false, MODE_RX, gpsRestartNMEA, &gpsHandleNMEA },
+    { false, false, MODE_RX, gpsRestartNMEA, &gpsHandleNMEA },
 #else
-    { false, 0, NULL, NULL },
+    { false, false, 0, NULL, NULL },
 #endif
 
     /* UBLOX binary */
 #ifdef USE_GPS_PROTO_UBLOX
-    { false, MODE_RXTX, &gpsRestartUBLOX, &gpsHandleUBLOX },
+    { false, true, MODE_RXTX, &gpsRestartUBLOX, &gpsHandleUBLOX },
 #else
-    { false, 0, NULL, NULL },
+    { false, false, 0, NULL, NULL },
 #endif
 
     /* UBLOX7PLUS binary */
 #ifdef USE_GPS_PROTO_UBLOX
-    { false, MODE_RXTX, &gpsRestartUBLOX, &gpsHandleUBLOX },
+    { false, true, MODE_RXTX, &gpsRestartUBLOX, &gpsHandleUBLOX },
 #else
-    { false, 0,  NULL, NULL },
+    { false, false, 0,  NULL, NULL },
 #endif
 
     /* MSP GPS */
 #ifdef USE_GPS_PROTO_MSP
-    { true, 0, &gpsRestartMSP, &gpsHandleMSP },
+    { true, false, 0, &gpsRestartMSP, &gpsHandleMSP },
 #else
-    { false, 0, NULL, NULL },
+    { false, false, 0, NULL, NULL },
 #endif
 };
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gpsConfig_t, gpsConfig, PG_GPS_CONFIG, 2);
+PG_REGISTER_WITH_RESET_TEMPLATE(gpsConfig_t, gpsConfig, PG_GPS_CONFIG, 4);
 
 PG_RESET_TEMPLATE(gpsConfig_t, gpsConfig,
     .provider = SETTING_GPS_PROVIDER_DEFAULT,
@@ -114,13 +119,22 @@ PG_RESET_TEMPLATE(gpsConfig_t, gpsConfig,
     .autoBaud = SETTING_GPS_AUTO_BAUD_DEFAULT,
     .dynModel = SETTING_GPS_DYN_MODEL_DEFAULT,
     .gpsMinSats = SETTING_GPS_MIN_SATS_DEFAULT,
-    .ubloxUseGalileo = SETTING_GPS_UBLOX_USE_GALILEO_DEFAULT
+    .ubloxUseGalileo = SETTING_GPS_UBLOX_USE_GALILEO_DEFAULT,
+    .ubloxNavHz = SETTING_GPS_UBLOX_NAV_HZ_DEFAULT,
+    .ubloxFastStart = SETTING_GPS_UBLOX_FAST_START_DEFAULT
 );
 
+PG_REGISTER(gpsFastStart_t, gpsFastStart, PG_GPS_FAST_START, 1);
+
+// Position aiding only needs to be within a few km, don't wear the flash for less
+#define GPS_FAST_START_POSITION_UPDATE_CM   (1000 * 100)
+
+static bool gpsFastStartDirty;
+
 void gpsSetState(gpsState_e state)
 {
-    gpsState.state = state;
-    gpsState.lastStateSwitchMs = millis();
+    gpsState->state = state;
+    gpsState->lastStateSwitchMs = millis();
 }
 
 static void gpsUpdateTime(void)
@@ -132,13 +146,55 @@ static void gpsUpdateTime(void)
 
 void gpsSetProtocolTimeout(timeMs_t timeoutMs)
 {
-    gpsState.lastLastMessageMs = gpsState.lastMessageMs;
-    gpsState.lastMessageMs = millis();
-    gpsState.timeoutMs = timeoutMs;
+    gpsState->lastLastMessageMs = gpsState->lastMessageMs;
+    gpsState->lastMessageMs = millis();
+    gpsState->timeoutMs = timeoutMs;
 }
 
-void gpsProcessNewSolutionData(void)
+void gpsFastStartSetConfigHash(uint16_t hash)
+{
+    if (gpsFastStart()->ubloxConfigHash[gpsState->index] != hash) {
+        gpsFastStartMutable()->ubloxConfigHash[gpsState->index] = hash;
+        gpsFastStartDirty = true;
+    }
+}
+
+/*
+ * Learned state is written with the stats, on disarm. A new configuration
+ * hash from the boot-time setup waits for the first disarm as well.
+ */
+void gpsOnDisarm(void)
 {
+    if (!feature(FEATURE_GPS) || !gpsConfig()->ubloxFastStart) {
+        return;
+    }
+
+    if (gpsSol.fixType == GPS_FIX_3D) {
+        const gpsLocation_t *last = &gpsFastStart()->lastPosition;
+        // 1e-7 deg of latitude is 1.11cm, longitude shrinks with cos(lat)
+        const float dLatCm = ((float)gpsSol.llh.lat - last->lat) * 1.113195f;
+        const float dLonCm = ((float)gpsSol.llh.lon - last->lon) * 1.113195f * cos_approx(DEGREES_TO_RADIANS(gpsSol.llh.lat / 1e7f));
+
+        if ((last->lat == 0 && last->lon == 0) || calc_length_pythagorean_2D(dLatCm, dLonCm) > GPS_FAST_START_POSITION_UPDATE_CM) {
+            gpsFastStartMutable()->lastPosition = gpsSol.llh;
+            gpsFastStartDirty = true;
+        }
+    }
+
+    if (gpsFastStartDirty) {
+        gpsFastStartDirty = false;
+        writeEEPROM();
+    }
+}
+
+static void gpsPublishSolution(const gpsSolutionData_t *solution)
+{
+    const sensorSample_t sample = gpsSol.sample;
+    const bool heartbeat = gpsSol.flags.gpsHeartbeat;
+
+    gpsSol = *solution;
+    gpsSol.sample = sample;
+
     // Set GPS fix flag only if we have 3D fix
     if (gpsSol.fixType == GPS_FIX_3D && gpsSol.numSat >= gpsConfig()->gpsMinSats) {
         ENABLE_STATE(GPS_FIX);
@@ -154,66 +210,131 @@ void gpsProcessNewSolutionData(void)
     // Set sensor as ready and available
     sensorsSet(SENSOR_GPS);
 
+    sensorSampleCapture(&gpsSol.sample, solution->sample.timeUs, STATE(GPS_FIX));
+
     // Pass on GPS update to NAV and IMU
     onNewGPSData();
 
     // Update time
     gpsUpdateTime();
 
+    gpsSol.flags.hasNewData = true;
+
+    // Toggle heartbeat
+    gpsSol.flags.gpsHeartbeat = !heartbeat;
+}
+
+// Called by the provider driver when the receiver in gpsState has a complete solution
+void gpsProcessNewSolutionData(void)
+{
+    gpsSolutionData_t *solution = &gpsState->solution;
+
+    sensorSampleCapture(&solution->sample, micros(), solution->fixType == GPS_FIX_3D);
+
     // Update timeout
     gpsSetProtocolTimeout(GPS_TIMEOUT);
 
     // Update statistics
-    gpsStats.lastMessageDt = gpsState.lastMessageMs - gpsState.lastLastMessageMs;
-    gpsSol.flags.hasNewData = true;
+    gpsStats.lastMessageDt = gpsState->lastMessageMs - gpsState->lastLastMessageMs;
 
-    // Toggle heartbeat
-    gpsSol.flags.gpsHeartbeat = !gpsSol.flags.gpsHeartbeat;
+#ifdef USE_GPS_DUAL
+    if (gpsReceiverCount > 1) {
+        const gpsSolutionData_t *solutions[GPS_RECEIVER_COUNT];
+        gpsSolutionData_t blended;
+
+        for (int i = 0; i < gpsReceiverCount; i++) {
+            solutions[i] = (gpsReceivers[i].state == GPS_RUNNING) ? &gpsReceivers[i].solution : NULL;
+        }
+
+        // The output follows one of the receivers, the other waits for its next solution
+        if (gpsBlendUpdate(solutions, gpsReceiverCount, gpsState->index, &blended)) {
+            gpsPublishSolution(&blended);
+        }
+        return;
+    }
+#endif
+
+    gpsPublishSolution(solution);
 }
 
-static void gpsResetSolution(void)
+static void gpsResetSolution(gpsSolutionData_t *solution)
 {
-    gpsSol.eph = 9999;
-    gpsSol.epv = 9999;
-    gpsSol.numSat = 0;
-    gpsSol.hdop = 9999;
-
-    gpsSol.fixType = GPS_NO_FIX;
-
-    gpsSol.flags.validVelNE = 0;
-    gpsSol.flags.validVelD = 0;
-    gpsSol.flags.validMag = 0;
-    gpsSol.flags.validEPE = 0;
-    gpsSol.flags.validTime = 0;
+    solution->eph = 9999;
+    solution->epv = 9999;
+    solution->numSat = 0;
+    solution->hdop = 9999;
+
+    solution->fixType = GPS_NO_FIX;
+
+    solution->flags.validVelNE = 0;
+    solution->flags.validVelD = 0;
+    solution->flags.validMag = 0;
+    solution->flags.validEPE = 0;
+    solution->flags.validTime = 0;
 }
 
 void gpsPreInit(void)
 {
     // Make sure gpsProvider is known when gpsMagDetect is called
-    gpsState.gpsConfig = gpsConfig();
+    gpsState->gpsConfig = gpsConfig();
+}
+
+static bool gpsOpenReceiver(const serialPortConfig_t *gpsPortConfig)
+{
+    // Start with baud rate index as configured for serial port
+    int baudrateIndex;
+    gpsState->baudrateIndex = GPS_BAUDRATE_115200;
+    for (baudrateIndex = 0, gpsState->baudrateIndex = 0; baudrateIndex < GPS_BAUDRATE_COUNT; baudrateIndex++) {
+        if (gpsToSerialBaudRate[baudrateIndex] == gpsPortConfig->gps_baudrateIndex) {
+            gpsState->baudrateIndex = baudrateIndex;
+            break;
+        }
+    }
+
+    // Start with the same baud for autodetection
+    gpsState->autoBaudrateIndex = gpsState->baudrateIndex;
+
+    // Open serial port
+    portMode_t mode = gpsProviders[gpsState->gpsConfig->provider].portMode;
+    gpsState->gpsPort = openSerialPort(gpsPortConfig->identifier, FUNCTION_GPS, NULL, NULL, baudRates[gpsToSerialBaudRate[gpsState->baudrateIndex]], mode, SERIAL_NOT_INVERTED);
+
+    // Check if we have a serial port opened
+    if (!gpsState->gpsPort) {
+        return false;
+    }
+
+    gpsSetState(GPS_INITIALIZING);
+    return true;
 }
 
 void gpsInit(void)
 {
-    gpsState.serialConfig = serialConfig();
-    gpsState.gpsConfig = gpsConfig();
+    for (int i = 0; i < GPS_RECEIVER_COUNT; i++) {
+        gpsState = &gpsReceivers[i];
+        gpsState->index = i;
+        gpsState->serialConfig = serialConfig();
+        gpsState->gpsConfig = gpsConfig();
+        gpsResetSolution(&gpsState->solution);
+        gpsSetProtocolTimeout(GPS_TIMEOUT);
+        gpsSetState(GPS_UNKNOWN);
+    }
+    gpsState = &gpsReceivers[0];
+    gpsReceiverCount = 1;
 
     gpsStats.errors = 0;
     gpsStats.timeouts = 0;
 
     // Reset solution, timeout and prepare to start
-    gpsResetSolution();
-    gpsSetProtocolTimeout(GPS_TIMEOUT);
-    gpsSetState(GPS_UNKNOWN);
+    gpsResetSolution(&gpsSol);
 
     // If given GPS provider has protocol() function not defined - we can't use it
-    if (!gpsProviders[gpsState.gpsConfig->provider].protocol) {
+    if (!gpsProviders[gpsState->gpsConfig->provider].protocol) {
         featureClear(FEATURE_GPS);
         return;
     }
 
     // Shortcut for driver-based GPS (MSP)
-    if (gpsProviders[gpsState.gpsConfig->provider].isDriverBased) {
+    if (gpsProviders[gpsState->gpsConfig->provider].isDriverBased) {
         gpsSetState(GPS_INITIALIZING);
         return;
     }
@@ -224,30 +345,25 @@ void gpsInit(void)
         return;
     }
 
-    // Start with baud rate index as configured for serial port
-    int baudrateIndex;
-    gpsState.baudrateIndex = GPS_BAUDRATE_115200;
-    for (baudrateIndex = 0, gpsState.baudrateIndex = 0; baudrateIndex < GPS_BAUDRATE_COUNT; baudrateIndex++) {
-        if (gpsToSerialBaudRate[baudrateIndex] == gpsPortConfig->gps_baudrateIndex) {
-            gpsState.baudrateIndex = baudrateIndex;
-            break;
-        }
-    }
-
-    // Start with the same baud for autodetection
-    gpsState.autoBaudrateIndex = gpsState.baudrateIndex;
-
-    // Open serial port
-    portMode_t mode = gpsProviders[gpsState.gpsConfig->provider].portMode;
-    gpsState.gpsPort = openSerialPort(gpsPortConfig->identifier, FUNCTION_GPS, NULL, NULL, baudRates[gpsToSerialBaudRate[gpsState.baudrateIndex]], mode, SERIAL_NOT_INVERTED);
-
-    // Check if we have a serial port opened
-    if (!gpsState.gpsPort) {
+    if (!gpsOpenReceiver(gpsPortConfig)) {
         featureClear(FEATURE_GPS);
         return;
     }
 
-    gpsSetState(GPS_INITIALIZING);
+#ifdef USE_GPS_DUAL
+    // Another port with the GPS function adds a receiver
+    if (gpsProviders[gpsState->gpsConfig->provider].multiReceiver) {
+        gpsPortConfig = findNextSerialPortConfig(FUNCTION_GPS);
+        if (gpsPortConfig) {
+            gpsState = &gpsReceivers[1];
+            if (gpsOpenReceiver(gpsPortConfig)) {
+                gpsReceiverCount = 2;
+            }
+            gpsState = &gpsReceivers[0];
+        }
+        gpsBlendReset();
+    }
+#endif
 }
 
 #ifdef USE_FAKE_GPS
@@ -268,7 +384,7 @@ static bool gpsFakeGPSUpdate(void)
     static int32_t lon = FAKE_GPS_INITIAL_LON;
 
     timeMs_t now = millis();
-    uint32_t delta = now - gpsState.lastMessageMs;
+    uint32_t delta = now - gpsState->lastMessageMs;
     if (delta > 100) {
         int32_t speed = ARMING_FLAG(ARMED) ? FAKE_GPS_GROUND_ARMED_SPEED : FAKE_GPS_GROUND_UNARMED_SPEED;
         int32_t cmDelta = speed * (delta / 1000.0f);
@@ -307,6 +423,7 @@ static bool gpsFakeGPSUpdate(void)
         ENABLE_STATE(GPS_FIX);
         sensorsSet(SENSOR_GPS);
         gpsUpdateTime();
+        sensorSampleCapture(&gpsSol.sample, micros(), true);
         onNewGPSData();
 
         gpsSetProtocolTimeout(GPS_TIMEOUT);
@@ -318,6 +435,67 @@ static bool gpsFakeGPSUpdate(void)
 }
 #endif
 
+#ifndef USE_FAKE_GPS
+static bool gpsOtherReceiverRunning(void)
+{
+    for (int i = 0; i < gpsReceiverCount; i++) {
+        if (&gpsReceivers[i] != gpsState && gpsReceivers[i].state == GPS_RUNNING && (millis() - gpsReceivers[i].lastMessageMs) <= GPS_TIMEOUT) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void gpsUpdateReceiver(void)
+{
+    switch (gpsState->state) {
+    default:
+    case GPS_INITIALIZING:
+        // Wait for GPS_INIT_DELAY before starting the GPS protocol thread
+        if ((millis() - gpsState->lastStateSwitchMs) >= GPS_INIT_DELAY) {
+            // Reset internals, unless the other receiver keeps the solution going
+            if (!gpsOtherReceiverRunning()) {
+                DISABLE_STATE(GPS_FIX);
+                gpsResetSolution(&gpsSol);
+            }
+
+            // Reset solution
+            gpsResetSolution(&gpsState->solution);
+
+            // Call GPS protocol reset handler
+            gpsProviders[gpsState->gpsConfig->provider].restart();
+
+            // Switch to GPS_RUNNING state (mind the timeout)
+            gpsSetProtocolTimeout(GPS_TIMEOUT);
+            gpsSetState(GPS_RUNNING);
+        }
+        break;
+
+    case GPS_RUNNING:
+        // Call GPS protocol thread
+        gpsProviders[gpsState->gpsConfig->provider].protocol();
+
+        // Check for GPS timeout
+        if ((millis() - gpsState->lastMessageMs) > GPS_TIMEOUT) {
+            if (!gpsOtherReceiverRunning()) {
+                sensorsClear(SENSOR_GPS);
+                DISABLE_STATE(GPS_FIX);
+                gpsSol.fixType = GPS_NO_FIX;
+            }
+            gpsState->solution.fixType = GPS_NO_FIX;
+            gpsSetState(GPS_LOST_COMMUNICATION);
+        }
+        break;
+
+    case GPS_LOST_COMMUNICATION:
+        gpsStats.timeouts++;
+        gpsSetState(GPS_INITIALIZING);
+        break;
+    }
+}
+#endif
+
 uint16_t gpsConstrainEPE(uint32_t epe)
 {
     return (epe > 9999) ? 9999 : epe; // max 99.99m error
@@ -359,73 +537,67 @@ bool gpsUpdate(void)
     // Assume that we don't have new data this run
     gpsSol.flags.hasNewData = false;
 
-    switch (gpsState.state) {
-    default:
-    case GPS_INITIALIZING:
-        // Wait for GPS_INIT_DELAY before starting the GPS protocol thread
-        if ((millis() - gpsState.lastStateSwitchMs) >= GPS_INIT_DELAY) {
-            // Reset internals
-            DISABLE_STATE(GPS_FIX);
-            gpsSol.fixType = GPS_NO_FIX;
+    for (int i = 0; i < gpsReceiverCount; i++) {
+        gpsState = &gpsReceivers[i];
+        gpsUpdateReceiver();
+    }
+    gpsState = &gpsReceivers[0];
 
-            // Reset solution
-            gpsResetSolution();
+    return gpsSol.flags.hasNewData;
+#endif
+}
 
-            // Call GPS protocol reset handler
-            gpsProviders[gpsState.gpsConfig->provider].restart();
+/*
+ * GPS task is event driven. It runs shortly after bytes arrive, so a new
+ * solution is processed right after the end of its frame instead of up to
+ * a task period later, and at the task period otherwise to handle timeouts.
+ * Providers that get the whole solution at once (MSP) signal it through
+ * gpsState->solutionReady and the task runs on the next scheduler pass.
+ */
+bool gpsUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
 
-            // Switch to GPS_RUNNING state (mind the timeout)
-            gpsSetProtocolTimeout(GPS_TIMEOUT);
-            gpsSetState(GPS_RUNNING);
-        }
-        break;
+    if (currentDeltaTimeUs >= GPS_TASK_PERIOD_US || (gpsState->solutionReady && gpsState->state == GPS_RUNNING)) {
+        return true;
+    }
 
-    case GPS_RUNNING:
-        // Call GPS protocol thread
-        gpsProviders[gpsState.gpsConfig->provider].protocol();
+    if (!feature(FEATURE_GPS) || currentDeltaTimeUs < GPS_TASK_MIN_INTERVAL_US) {
+        return false;
+    }
 
-        // Check for GPS timeout
-        if ((millis() - gpsState.lastMessageMs) > GPS_TIMEOUT) {
-            sensorsClear(SENSOR_GPS);
-            DISABLE_STATE(GPS_FIX);
-            gpsSol.fixType = GPS_NO_FIX;
-            gpsSetState(GPS_LOST_COMMUNICATION);
+    for (int i = 0; i < gpsReceiverCount; i++) {
+        if (gpsReceivers[i].gpsPort && serialRxBytesWaiting(gpsReceivers[i].gpsPort)) {
+            return true;
         }
-        break;
-
-    case GPS_LOST_COMMUNICATION:
-        gpsStats.timeouts++;
-        gpsSetState(GPS_INITIALIZING);
-        break;
     }
 
-    return gpsSol.flags.hasNewData;
-#endif
+    return false;
 }
 
 void gpsEnablePassthrough(serialPort_t *gpsPassthroughPort)
 {
-    waitForSerialPortToFinishTransmitting(gpsState.gpsPort);
+    waitForSerialPortToFinishTransmitting(gpsState->gpsPort);
     waitForSerialPortToFinishTransmitting(gpsPassthroughPort);
 
-    if (!(gpsState.gpsPort->mode & MODE_TX))
-    serialSetMode(gpsState.gpsPort, gpsState.gpsPort->mode | MODE_TX);
+    if (!(gpsState->gpsPort->mode & MODE_TX))
+    serialSetMode(gpsState->gpsPort, gpsState->gpsPort->mode | MODE_TX);
 
     LED0_OFF;
     LED1_OFF;
 
     char c;
     while (1) {
-        if (serialRxBytesWaiting(gpsState.gpsPort)) {
+        if (serialRxBytesWaiting(gpsState->gpsPort)) {
             LED0_ON;
-            c = serialRead(gpsState.gpsPort);
+            c = serialRead(gpsState->gpsPort);
             serialWrite(gpsPassthroughPort, c);
             LED0_OFF;
         }
         if (serialRxBytesWaiting(gpsPassthroughPort)) {
             LED1_ON;
             c = serialRead(gpsPassthroughPort);
-            serialWrite(gpsState.gpsPort, c);
+            serialWrite(gpsState->gpsPort, c);
             LED1_OFF;
         }
     }
@@ -23,6 +23,8 @@
 
 #include "common/time.h"
 
+#include "drivers/sensor.h"
+
 #define GPS_DBHZ_MIN 0
 #define GPS_DBHZ_MAX 55
 
@@ -31,6 +33,13 @@
 
 #define GPS_DEGREES_DIVIDER 10000000L
 
+// A second receiver on another GPS port is blended with the first
+#ifdef USE_GPS_DUAL
+#define GPS_RECEIVER_COUNT 2
+#else
+#define GPS_RECEIVER_COUNT 1
+#endif
+
 typedef enum {
     GPS_NMEA = 0,
     GPS_UBLOX,
@@ -92,6 +101,8 @@ typedef struct gpsConfig_s {
     gpsDynModel_e dynModel;
     bool ubloxUseGalileo;
     uint8_t gpsMinSats;
+    uint8_t ubloxNavHz;     // Navigation solution rate of u-blox M9/M10, 0 for the default
+    bool ubloxFastStart;    // Skip the configuration of a u-blox receiver that kept it, aid it with position and time
 } gpsConfig_t;
 
 PG_DECLARE(gpsConfig_t, gpsConfig);
@@ -108,6 +119,14 @@ typedef struct gpsLocation_s {
     int32_t alt;    // Altitude in centimeters (meters * 100)
 } gpsLocation_t;
 
+// Learned state for a fast receiver start, not user settings
+typedef struct gpsFastStart_s {
+    uint16_t ubloxConfigHash[GPS_RECEIVER_COUNT];   // Checksum of the setup saved in each u-blox receiver, 0 if none
+    gpsLocation_t lastPosition;     // Last 3D fix at disarm, 0/0 if none
+} gpsFastStart_t;
+
+PG_DECLARE(gpsFastStart_t, gpsFastStart);
+
 #define HDOP_SCALE (100)
 
 typedef struct gpsSolutionData_s {
@@ -138,6 +157,7 @@ typedef struct gpsSolutionData_s {
 
     dateTime_t time; // GPS time in UTC
 
+    sensorSample_t sample;  // Stamped when the solution has been received
 } gpsSolutionData_t;
 
 typedef struct {
@@ -156,9 +176,11 @@ void gpsInit(void);
 // Called periodically from GPS task. Returns true iff the GPS
 // information was updated.
 bool gpsUpdate(void);
+bool gpsUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 void updateGpsIndicator(timeUs_t currentTimeUs);
 bool isGPSHealthy(void);
 bool isGPSHeadingValid(void);
 struct serialPort_s;
 void gpsEnablePassthrough(struct serialPort_s *gpsPassthroughPort);
+void gpsOnDisarm(void);
 void mspGPSReceiveNewData(const uint8_t * bufferPtr);
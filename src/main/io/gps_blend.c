@@ -0,0 +1,272 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#ifdef USE_GPS_DUAL
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/time.h"
+#include "common/utils.h"
+
+#include "io/gps.h"
+#include "io/gps_blend.h"
+
+#define CM_PER_DEG_E7   1.113195f   // 1e-7 deg of latitude, or of longitude at the equator
+
+// Last solution of a receiver or of the output
+typedef struct {
+    bool valid;
+    timeUs_t timeUs;
+    gpsLocation_t llh;
+    int16_t velNED[3];
+} gpsBlendTrack_t;
+
+static struct {
+    int8_t primary;
+    uint8_t sources;                            // Receivers in the last output
+    float offset[3];                            // N, E, up in cm, added to the output after a switch
+    gpsBlendTrack_t output;
+    gpsBlendTrack_t track[GPS_RECEIVER_COUNT];
+    bool glitched[GPS_RECEIVER_COUNT];
+    timeUs_t glitchUntilUs[GPS_RECEIVER_COUNT];
+} blend;
+
+static float gpsBlendCosLat(int32_t lat)
+{
+    return MAX(cos_approx(DEGREES_TO_RADIANS(lat / 1e7f)), 0.01f);
+}
+
+// N, E and up from one location to the other in cm
+static void gpsBlendDeltaCm(const gpsLocation_t *from, const gpsLocation_t *to, float delta[3])
+{
+    int64_t dLon = (int64_t)to->lon - from->lon;
+
+    // Across the antimeridian
+    if (dLon > 1800000000LL) {
+        dLon -= 3600000000LL;
+    }
+    else if (dLon < -1800000000LL) {
+        dLon += 3600000000LL;
+    }
+
+    delta[X] = (float)(to->lat - from->lat) * CM_PER_DEG_E7;
+    delta[Y] = (float)dLon * CM_PER_DEG_E7 * gpsBlendCosLat(from->lat);
+    delta[Z] = (float)(to->alt - from->alt);
+}
+
+static void gpsBlendMove(gpsLocation_t *llh, const float delta[3])
+{
+    llh->lon += lrintf(delta[Y] / (CM_PER_DEG_E7 * gpsBlendCosLat(llh->lat)));
+    llh->lat += lrintf(delta[X] / CM_PER_DEG_E7);
+    llh->alt += lrintf(delta[Z]);
+}
+
+static void gpsBlendTrackUpdate(gpsBlendTrack_t *track, const gpsSolutionData_t *solution)
+{
+    track->valid = true;
+    track->timeUs = solution->sample.timeUs;
+    track->llh = solution->llh;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        track->velNED[axis] = solution->flags.validVelNE ? solution->velNED[axis] : 0;
+    }
+}
+
+// A receiver whose position jumped away from its own velocity is left out for a while
+static void gpsBlendCheckGlitch(int receiver, const gpsSolutionData_t *solution)
+{
+    gpsBlendTrack_t *track = &blend.track[receiver];
+
+    if (solution->fixType != GPS_FIX_3D) {
+        track->valid = false;
+        return;
+    }
+
+    const timeDelta_t dtUs = cmpTimeUs(solution->sample.timeUs, track->timeUs);
+    if (track->valid && dtUs > 0 && dtUs <= GPS_BLEND_MAX_AGE_US) {
+        const float dt = US2S(dtUs);
+        float delta[3];
+
+        gpsBlendDeltaCm(&track->llh, &solution->llh, delta);
+        const float innovation = calc_length_pythagorean_2D(delta[X] - track->velNED[X] * dt, delta[Y] - track->velNED[Y] * dt);
+        if (innovation > GPS_BLEND_GATE_SIGMA * solution->eph + GPS_BLEND_GATE_MIN_CM) {
+            blend.glitched[receiver] = true;
+            blend.glitchUntilUs[receiver] = solution->sample.timeUs + GPS_BLEND_GLITCH_HOLD_US;
+        }
+    }
+
+    if (blend.glitched[receiver] && cmpTimeUs(solution->sample.timeUs, blend.glitchUntilUs[receiver]) >= 0) {
+        blend.glitched[receiver] = false;
+    }
+
+    gpsBlendTrackUpdate(track, solution);
+}
+
+static bool gpsBlendUsable(int receiver, const gpsSolutionData_t *solution, timeUs_t currentTimeUs)
+{
+    return solution && solution->fixType == GPS_FIX_3D && solution->flags.validEPE &&
+           cmpTimeUs(currentTimeUs, solution->sample.timeUs) <= GPS_BLEND_MAX_AGE_US &&
+           !blend.glitched[receiver];
+}
+
+// Blends other into out, which holds the primary. False if they disagree.
+static bool gpsBlendCombine(gpsSolutionData_t *out, const gpsSolutionData_t *other)
+{
+    const float dt = US2S(cmpTimeUs(out->sample.timeUs, other->sample.timeUs));
+    float delta[3];
+
+    // Other receiver moved to the time of the primary
+    gpsBlendDeltaCm(&out->llh, &other->llh, delta);
+    if (other->flags.validVelNE) {
+        delta[X] += other->velNED[X] * dt;
+        delta[Y] += other->velNED[Y] * dt;
+    }
+    if (other->flags.validVelD) {
+        delta[Z] -= other->velNED[Z] * dt;
+    }
+
+    const float ephPrimary = MAX(out->eph, 1);
+    const float ephOther = MAX(other->eph, 1);
+    const float epvPrimary = MAX(out->epv, 1);
+    const float epvOther = MAX(other->epv, 1);
+
+    if (calc_length_pythagorean_2D(delta[X], delta[Y]) > GPS_BLEND_GATE_SIGMA * calc_length_pythagorean_2D(ephPrimary, ephOther) + GPS_BLEND_GATE_MIN_CM ||
+        fabsf(delta[Z]) > GPS_BLEND_GATE_SIGMA * calc_length_pythagorean_2D(epvPrimary, epvOther) + GPS_BLEND_GATE_MIN_CM) {
+        return false;
+    }
+
+    // Share of the other receiver with 1/acc^2 weights
+    const float kH = sq(ephPrimary) / (sq(ephPrimary) + sq(ephOther));
+    const float kV = sq(epvPrimary) / (sq(epvPrimary) + sq(epvOther));
+
+    delta[X] *= kH;
+    delta[Y] *= kH;
+    delta[Z] *= kV;
+    gpsBlendMove(&out->llh, delta);
+
+    if (out->flags.validVelNE && other->flags.validVelNE) {
+        out->velNED[X] += lrintf(kH * (other->velNED[X] - out->velNED[X]));
+        out->velNED[Y] += lrintf(kH * (other->velNED[Y] - out->velNED[Y]));
+        out->groundSpeed = lrintf(calc_length_pythagorean_2D(out->velNED[X], out->velNED[Y]));
+
+        int16_t groundCourse = lrintf(RADIANS_TO_DECIDEGREES(atan2_approx(out->velNED[Y], out->velNED[X])));
+        out->groundCourse = groundCourse < 0 ? groundCourse + 3600 : groundCourse;
+    }
+    if (out->flags.validVelD && other->flags.validVelD) {
+        out->velNED[Z] += lrintf(kV * (other->velNED[Z] - out->velNED[Z]));
+    }
+
+    out->eph = lrintf(ephPrimary + kH * (ephOther - ephPrimary));
+    out->epv = lrintf(epvPrimary + kV * (epvOther - epvPrimary));
+    out->numSat = MAX(out->numSat, other->numSat);
+
+    return true;
+}
+
+// Keeps the output continuous when receivers join, leave or take over
+static void gpsBlendSmoothSwitch(gpsSolutionData_t *out, uint8_t sources)
+{
+    const timeDelta_t dtUs = cmpTimeUs(out->sample.timeUs, blend.output.timeUs);
+
+    if (!blend.output.valid || dtUs <= 0 || dtUs > GPS_BLEND_MAX_AGE_US) {
+        blend.offset[X] = blend.offset[Y] = blend.offset[Z] = 0;
+    }
+    else if (sources != blend.sources) {
+        // Step from the new solution to where the last output would be now
+        const float dt = US2S(dtUs);
+        gpsBlendDeltaCm(&out->llh, &blend.output.llh, blend.offset);
+        blend.offset[X] += blend.output.velNED[X] * dt;
+        blend.offset[Y] += blend.output.velNED[Y] * dt;
+        blend.offset[Z] -= blend.output.velNED[Z] * dt;
+    }
+    else {
+        const float decay = constrainf(1.0f - US2S(dtUs) / GPS_BLEND_OFFSET_TIME_CONSTANT, 0.0f, 1.0f);
+        blend.offset[X] *= decay;
+        blend.offset[Y] *= decay;
+        blend.offset[Z] *= decay;
+    }
+
+    gpsBlendMove(&out->llh, blend.offset);
+    blend.sources = sources;
+
+    gpsBlendTrackUpdate(&blend.output, out);
+}
+
+void gpsBlendReset(void)
+{
+    memset(&blend, 0, sizeof(blend));
+    blend.primary = -1;
+}
+
+bool gpsBlendUpdate(const gpsSolutionData_t * const solutions[], int count, int updated, gpsSolutionData_t *out)
+{
+    const timeUs_t currentTimeUs = solutions[updated]->sample.timeUs;
+    int best = -1;
+
+    gpsBlendCheckGlitch(updated, solutions[updated]);
+
+    for (int i = 0; i < count; i++) {
+        if (gpsBlendUsable(i, solutions[i], currentTimeUs) && (best < 0 || solutions[i]->eph < solutions[best]->eph)) {
+            best = i;
+        }
+    }
+
+    if (best < 0) {
+        // No receiver has a usable fix, stay with one that is running
+        if (blend.primary < 0 || !solutions[blend.primary]) {
+            blend.primary = updated;
+        }
+    }
+    else if (blend.primary < 0 || !gpsBlendUsable(blend.primary, solutions[blend.primary], currentTimeUs) ||
+             solutions[best]->eph < solutions[blend.primary]->eph * GPS_BLEND_SWITCH_RATIO) {
+        blend.primary = best;
+    }
+
+    if (updated != blend.primary) {
+        return false;
+    }
+
+    *out = *solutions[updated];
+
+    if (best < 0) {
+        blend.output.valid = false;
+        blend.sources = 0;
+        return true;
+    }
+
+    uint8_t sources = BIT(updated);
+    for (int i = 0; i < count; i++) {
+        if (i != updated && gpsBlendUsable(i, solutions[i], currentTimeUs) && gpsBlendCombine(out, solutions[i])) {
+            sources |= BIT(i);
+        }
+    }
+
+    gpsBlendSmoothSwitch(out, sources);
+
+    return true;
+}
+
+#endif
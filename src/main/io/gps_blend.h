@@ -0,0 +1,52 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "io/gps.h"
+
+#ifdef USE_GPS_DUAL
+
+#define GPS_BLEND_MAX_AGE_US            300000  // Older solutions of the other receiver are neither blended nor selected
+#define GPS_BLEND_SWITCH_RATIO          0.7f    // The other receiver takes over when its eph is below this share of the current one
+#define GPS_BLEND_GATE_SIGMA            3.0f    // Disagreement in combined eph before the receivers are no longer blended
+#define GPS_BLEND_GATE_MIN_CM           500.0f
+#define GPS_BLEND_GLITCH_HOLD_US        2000000 // A receiver that jumped away from its own track is left out this long
+#define GPS_BLEND_OFFSET_TIME_CONSTANT  2.0f    // Seconds for the output to move to the new source after a switch
+
+void gpsBlendReset(void);
+
+/*
+ * The output follows a primary receiver: the one with the best reported accuracy
+ * that has a 3D fix and did not just glitch. A new solution of the primary makes
+ * a new output, the other receiver's newest solution is moved to the same time
+ * along its velocity and blended in with 1/acc^2 weights. When the receivers
+ * disagree the primary alone is used. Whenever the set of receivers in the
+ * output changes, the step between old and new output is spread over a few
+ * seconds.
+ *
+ * solutions[i] is NULL while receiver i is not running. Returns true when out
+ * holds a new solution.
+ */
+bool gpsBlendUpdate(const gpsSolutionData_t * const solutions[], int count, int updated, gpsSolutionData_t *out);
+
+#endif
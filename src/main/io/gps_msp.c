@@ -53,8 +53,6 @@
 
 #include "msp/msp_protocol_v2_sensor_msg.h"
 
-static bool newDataReady;
-
 void gpsRestartMSP(void)
 {
     // NOP
@@ -62,9 +60,9 @@ void gpsRestartMSP(void)
 
 void gpsHandleMSP(void)
 {
-    if (newDataReady) {
+    if (gpsState->solutionReady) {
+        gpsState->solutionReady = false;
         gpsProcessNewSolutionData();
-        newDataReady = false;
     }
 }
 
@@ -81,33 +79,34 @@ void mspGPSReceiveNewData(const uint8_t * bufferPtr)
 {
     const mspSensorGpsDataMessage_t * pkt = (const mspSensorGpsDataMessage_t *)bufferPtr;
 
-    gpsSol.fixType   = gpsMapFixType(pkt->fixType);
-    gpsSol.numSat    = pkt->satellitesInView;
-    gpsSol.llh.lon   = pkt->longitude;
-    gpsSol.llh.lat   = pkt->latitude;
-    gpsSol.llh.alt   = pkt->mslAltitude;
-    gpsSol.velNED[X] = pkt->nedVelNorth;
-    gpsSol.velNED[Y] = pkt->nedVelEast;
-    gpsSol.velNED[Z] = pkt->nedVelDown;
-    gpsSol.groundSpeed = calc_length_pythagorean_2D((float)pkt->nedVelNorth, (float)pkt->nedVelEast);
-    gpsSol.groundCourse = pkt->groundCourse / 10;   // in deg * 10
-    gpsSol.eph = gpsConstrainEPE(pkt->horizontalPosAccuracy / 10);
-    gpsSol.epv = gpsConstrainEPE(pkt->verticalPosAccuracy / 10);
-    gpsSol.hdop = gpsConstrainHDOP(pkt->hdop);
-    gpsSol.flags.validVelNE = 1;
-    gpsSol.flags.validVelD = 1;
-    gpsSol.flags.validEPE = 1;
-
-    gpsSol.time.year   = pkt->year;
-    gpsSol.time.month  = pkt->month;
-    gpsSol.time.day    = pkt->day;
-    gpsSol.time.hours  = pkt->hour;
-    gpsSol.time.minutes = pkt->min;
-    gpsSol.time.seconds = pkt->sec;
-    gpsSol.time.millis  = 0;
-
-    gpsSol.flags.validTime = (pkt->fixType >= 3);
-
-    newDataReady = true;
+    gpsState->solution.fixType   = gpsMapFixType(pkt->fixType);
+    gpsState->solution.numSat    = pkt->satellitesInView;
+    gpsState->solution.llh.lon   = pkt->longitude;
+    gpsState->solution.llh.lat   = pkt->latitude;
+    gpsState->solution.llh.alt   = pkt->mslAltitude;
+    gpsState->solution.velNED[X] = pkt->nedVelNorth;
+    gpsState->solution.velNED[Y] = pkt->nedVelEast;
+    gpsState->solution.velNED[Z] = pkt->nedVelDown;
+    gpsState->solution.groundSpeed = calc_length_pythagorean_2D((float)pkt->nedVelNorth, (float)pkt->nedVelEast);
+    gpsState->solution.groundCourse = pkt->groundCourse / 10;   // in deg * 10
+    gpsState->solution.eph = gpsConstrainEPE(pkt->horizontalPosAccuracy / 10);
+    gpsState->solution.epv = gpsConstrainEPE(pkt->verticalPosAccuracy / 10);
+    gpsState->solution.hdop = gpsConstrainHDOP(pkt->hdop);
+    gpsState->solution.flags.validVelNE = 1;
+    gpsState->solution.flags.validVelD = 1;
+    gpsState->solution.flags.validEPE = 1;
+
+    gpsState->solution.time.year   = pkt->year;
+    gpsState->solution.time.month  = pkt->month;
+    gpsState->solution.time.day    = pkt->day;
+    gpsState->solution.time.hours  = pkt->hour;
+    gpsState->solution.time.minutes = pkt->min;
+    gpsState->solution.time.seconds = pkt->sec;
+    gpsState->solution.time.millis  = 0;
+
+    gpsState->solution.flags.validTime = (pkt->fixType >= 3);
+
+    // Wake the GPS task, the solution is complete already
+    gpsState->solutionReady = true;
 }
 #endif
@@ -29,7 +29,6 @@
 #include "build/debug.h"
 
 #include "common/axis.h"
-#include "common/gps_conversion.h"
 #include "common/maths.h"
 #include "common/utils.h"
 
@@ -60,30 +59,50 @@
      - GPS speed (for OSD displaying)
 */
 
-#define NO_FRAME   0
-#define FRAME_GGA  1
-#define FRAME_RMC  2
-
-static uint32_t grab_fields(char *src, uint8_t mult)
-{                               // convert string to uint32
-    uint32_t i;
-    uint32_t tmp = 0;
-    for (i = 0; src[i] != 0; i++) {
-        if (src[i] == '.') {
-            i++;
-            if (mult == 0)
-                break;
-            else
-                src[i + mult] = 0;
-        }
-        tmp *= 10;
-        if (src[i] >= '0' && src[i] <= '9')
-            tmp += src[i] - '0';
-        if (i >= 15)
-            return 0; // out of bounds
-    }
-    return tmp;
-}
+#define NMEA_SENTENCE_ID_LENGTH     5
+#define NMEA_MAX_INTEGER_PART       100000000   // More digits than any field we use has
+#define NMEA_MAX_FRACTION_DIGITS    5
+
+/*
+ * Fields are converted as their characters arrive, the field tables tell what the
+ * n-th field of a sentence is. Values land in gps_Msg and go to gpsSol only once
+ * the checksum of the sentence matches.
+ */
+typedef enum {
+    NMEA_FIELD_IGNORE = 0,
+    NMEA_FIELD_TIME,
+    NMEA_FIELD_LATITUDE,
+    NMEA_FIELD_LATITUDE_HEMISPHERE,
+    NMEA_FIELD_LONGITUDE,
+    NMEA_FIELD_LONGITUDE_HEMISPHERE,
+    NMEA_FIELD_FIX_QUALITY,
+    NMEA_FIELD_NUM_SAT,
+    NMEA_FIELD_HDOP,
+    NMEA_FIELD_ALTITUDE,
+    NMEA_FIELD_SPEED,
+    NMEA_FIELD_COURSE,
+    NMEA_FIELD_DATE,
+} nmeaField_e;
+
+typedef enum {
+    NO_FRAME = 0,
+    FRAME_GGA,
+    FRAME_RMC,
+} nmeaFrame_e;
+
+// $GNGGA,hhmmss.ss,ddmm.mmmmm,N,dddmm.mmmmm,E,q,nn,h.h,a.a,M,...
+static const uint8_t nmeaFieldsGGA[] = {
+    NMEA_FIELD_IGNORE, NMEA_FIELD_IGNORE,
+    NMEA_FIELD_LATITUDE, NMEA_FIELD_LATITUDE_HEMISPHERE, NMEA_FIELD_LONGITUDE, NMEA_FIELD_LONGITUDE_HEMISPHERE,
+    NMEA_FIELD_FIX_QUALITY, NMEA_FIELD_NUM_SAT, NMEA_FIELD_HDOP, NMEA_FIELD_ALTITUDE,
+};
+
+// $GNRMC,hhmmss.ss,A,ddmm.mmmmm,N,dddmm.mmmmm,E,s.s,c.c,ddmmyy,...
+static const uint8_t nmeaFieldsRMC[] = {
+    NMEA_FIELD_IGNORE, NMEA_FIELD_TIME, NMEA_FIELD_IGNORE,
+    NMEA_FIELD_IGNORE, NMEA_FIELD_IGNORE, NMEA_FIELD_IGNORE, NMEA_FIELD_IGNORE,
+    NMEA_FIELD_SPEED, NMEA_FIELD_COURSE, NMEA_FIELD_DATE,
+};
 
 typedef struct gpsDataNmea_s {
     bool fix;
@@ -98,168 +117,323 @@ typedef struct gpsDataNmea_s {
     uint32_t date;
 } gpsDataNmea_t;
 
-#define NMEA_BUFFER_SIZE        16
+typedef struct nmeaParser_s {
+    nmeaFrame_e frame;
+    const uint8_t *fields;          // Field table of the sentence being parsed
+    uint8_t fieldCount;
+    uint8_t field;
+    bool inSentence;
+    bool inChecksum;
+    bool invalid;
+    uint8_t parity;
+    uint8_t checksum;
+    uint8_t checksumDigits;
+    char id[NMEA_SENTENCE_ID_LENGTH];
+
+    // Current field
+    uint8_t length;
+    char first;
+    bool negative;
+    bool inFraction;
+    uint8_t fractionDigits;
+    uint32_t integerPart;
+    uint32_t fractionPart;
+} nmeaParser_t;
+
+static gpsDataNmea_t gps_Msg;
+static nmeaParser_t nmea;
+
+static void nmeaFieldReset(void)
+{
+    nmea.length = 0;
+    nmea.first = 0;
+    nmea.negative = false;
+    nmea.inFraction = false;
+    nmea.fractionDigits = 0;
+    nmea.integerPart = 0;
+    nmea.fractionPart = 0;
+}
+
+// Fractional digits scaled to the given count, extra ones are truncated
+static uint32_t nmeaFieldFraction(uint8_t decimals)
+{
+    uint32_t fraction = nmea.fractionPart;
+    uint8_t digits = nmea.fractionDigits;
+
+    for (; digits > decimals; digits--) {
+        fraction /= 10;
+    }
+    for (; digits < decimals; digits++) {
+        fraction *= 10;
+    }
+
+    return fraction;
+}
+
+static uint32_t nmeaFieldFixed(uint8_t decimals)
+{
+    uint32_t value = nmea.integerPart;
+    for (int i = 0; i < decimals; i++) {
+        value *= 10;
+    }
+
+    return value + nmeaFieldFraction(decimals);
+}
+
+// ddmm.mmmmm to degrees * 1e7
+static int32_t nmeaFieldCoordinate(void)
+{
+    const uint32_t degrees = nmea.integerPart / 100;
+    const uint32_t minutes = nmea.integerPart % 100;
+
+    return degrees * 10000000UL + (minutes * 100000UL + nmeaFieldFraction(5)) * 10 / 6;
+}
+
+static void nmeaFieldChar(char c)
+{
+    if (nmea.length == 0) {
+        nmea.first = c;
+    }
+    if (nmea.length < UINT8_MAX) {
+        nmea.length++;
+    }
+
+    if (c >= '0' && c <= '9') {
+        if (nmea.inFraction) {
+            if (nmea.fractionDigits < NMEA_MAX_FRACTION_DIGITS) {
+                nmea.fractionPart = nmea.fractionPart * 10 + (c - '0');
+                nmea.fractionDigits++;
+            }
+        } else if (nmea.integerPart < NMEA_MAX_INTEGER_PART) {
+            nmea.integerPart = nmea.integerPart * 10 + (c - '0');
+        } else {
+            nmea.invalid = true;
+        }
+    } else if (c == '.') {
+        nmea.inFraction = true;
+    } else if (c == '-' && nmea.length == 1) {
+        nmea.negative = true;
+    }
+}
+
+static void nmeaIdentifySentence(void)
+{
+    nmea.frame = NO_FRAME;
+
+    if (nmea.length == NMEA_SENTENCE_ID_LENGTH && nmea.id[0] == 'G' && (nmea.id[1] == 'P' || nmea.id[1] == 'N')) {
+        if (memcmp(&nmea.id[2], "GGA", 3) == 0) {
+            nmea.frame = FRAME_GGA;
+            nmea.fields = nmeaFieldsGGA;
+            nmea.fieldCount = ARRAYLEN(nmeaFieldsGGA);
+        } else if (memcmp(&nmea.id[2], "RMC", 3) == 0) {
+            nmea.frame = FRAME_RMC;
+            nmea.fields = nmeaFieldsRMC;
+            nmea.fieldCount = ARRAYLEN(nmeaFieldsRMC);
+        }
+    }
+
+    // Nothing to take from other sentences, skip them up to the next '$'
+    if (nmea.frame == NO_FRAME) {
+        nmea.inSentence = false;
+    }
+}
+
+static void nmeaFieldEnd(void)
+{
+    if (nmea.field == 0) {
+        nmeaIdentifySentence();
+        return;
+    }
+
+    if (nmea.field >= nmea.fieldCount) {
+        return;
+    }
+
+    switch (nmea.fields[nmea.field]) {
+        case NMEA_FIELD_TIME:
+            gps_Msg.time = nmeaFieldFixed(2);   // hhmmsscc
+            break;
+        case NMEA_FIELD_LATITUDE:
+            gps_Msg.latitude = nmeaFieldCoordinate();
+            break;
+        case NMEA_FIELD_LATITUDE_HEMISPHERE:
+            if (nmea.first == 'S')
+                gps_Msg.latitude *= -1;
+            break;
+        case NMEA_FIELD_LONGITUDE:
+            gps_Msg.longitude = nmeaFieldCoordinate();
+            break;
+        case NMEA_FIELD_LONGITUDE_HEMISPHERE:
+            if (nmea.first == 'W')
+                gps_Msg.longitude *= -1;
+            break;
+        case NMEA_FIELD_FIX_QUALITY:
+            gps_Msg.fix = nmea.first > '0';
+            break;
+        case NMEA_FIELD_NUM_SAT:
+            gps_Msg.numSat = nmea.integerPart;
+            break;
+        case NMEA_FIELD_HDOP:
+            gps_Msg.hdop = nmeaFieldFixed(2);
+            break;
+        case NMEA_FIELD_ALTITUDE:
+            gps_Msg.altitude = nmea.negative ? -(int32_t)nmeaFieldFixed(2) : (int32_t)nmeaFieldFixed(2);   // altitude in cm
+            break;
+        case NMEA_FIELD_SPEED:
+            gps_Msg.speed = (nmeaFieldFixed(2) * 5144UL) / 10000UL;    // knots to cm/s
+            break;
+        case NMEA_FIELD_COURSE:
+            gps_Msg.ground_course = nmeaFieldFixed(1);    // deg * 10
+            break;
+        case NMEA_FIELD_DATE:
+            gps_Msg.date = nmea.integerPart;
+            break;
+        default:
+            break;
+    }
+}
+
+static bool nmeaSentenceEnd(void)
+{
+    if (nmea.invalid || nmea.checksumDigits != 2 || nmea.checksum != nmea.parity) {
+        gpsStats.errors++;
+        return false;
+    }
+
+    gpsStats.packetCount++;
+
+    switch (nmea.frame) {
+    case FRAME_GGA:
+        gpsState->solution.numSat = gps_Msg.numSat;
+        if (gps_Msg.fix) {
+            gpsState->solution.fixType = GPS_FIX_3D;    // NMEA doesn't report fix type, assume 3D
+
+            gpsState->solution.llh.lat = gps_Msg.latitude;
+            gpsState->solution.llh.lon = gps_Msg.longitude;
+            gpsState->solution.llh.alt = gps_Msg.altitude;
+
+            // EPH/EPV are unreliable for NMEA as they are not real accuracy
+            gpsState->solution.hdop = gpsConstrainHDOP(gps_Msg.hdop);
+            gpsState->solution.eph = gpsConstrainEPE(gps_Msg.hdop * GPS_HDOP_TO_EPH_MULTIPLIER);
+            gpsState->solution.epv = gpsConstrainEPE(gps_Msg.hdop * GPS_HDOP_TO_EPH_MULTIPLIER);
+            gpsState->solution.flags.validEPE = 0;
+        }
+        else {
+            gpsState->solution.fixType = GPS_NO_FIX;
+        }
+
+        // NMEA does not report VELNED
+        gpsState->solution.flags.validVelNE = 0;
+        gpsState->solution.flags.validVelD = 0;
+        return true;
+
+    case FRAME_RMC:
+        gpsState->solution.groundSpeed = gps_Msg.speed;
+        gpsState->solution.groundCourse = gps_Msg.ground_course;
+
+        // This check will miss 00:00:00.00, but we shouldn't care - next report will be valid
+        if (gps_Msg.date != 0 && gps_Msg.time != 0) {
+            gpsState->solution.time.year = (gps_Msg.date % 100) + 2000;
+            gpsState->solution.time.month = (gps_Msg.date / 100) % 100;
+            gpsState->solution.time.day = (gps_Msg.date / 10000) % 100;
+            gpsState->solution.time.hours = (gps_Msg.time / 1000000) % 100;
+            gpsState->solution.time.minutes = (gps_Msg.time / 10000) % 100;
+            gpsState->solution.time.seconds = (gps_Msg.time / 100) % 100;
+            gpsState->solution.time.millis = (gps_Msg.time % 100) * 10;
+            gpsState->solution.flags.validTime = 1;
+        }
+        else {
+            gpsState->solution.flags.validTime = 0;
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+static int nmeaHexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
 
 static bool gpsNewFrameNMEA(char c)
 {
-    static gpsDataNmea_t gps_Msg;
+    if (c == '$') {
+        nmea.inSentence = true;
+        nmea.inChecksum = false;
+        nmea.invalid = false;
+        nmea.frame = NO_FRAME;
+        nmea.field = 0;
+        nmea.parity = 0;
+        nmeaFieldReset();
+        return false;
+    }
 
-    uint8_t frameOK = 0;
-    static uint8_t param = 0, offset = 0, parity = 0;
-    static char string[NMEA_BUFFER_SIZE];
-    static uint8_t checksum_param, gps_frame = NO_FRAME;
+    if (!nmea.inSentence) {
+        return false;
+    }
+
+    if (nmea.inChecksum) {
+        if (c == '\r' || c == '\n') {
+            nmea.inSentence = false;
+            return nmeaSentenceEnd();
+        }
+
+        const int digit = nmeaHexDigit(c);
+        if (digit < 0 || nmea.checksumDigits >= 2) {
+            nmea.invalid = true;
+        } else {
+            nmea.checksum = (nmea.checksum << 4) | digit;
+            nmea.checksumDigits++;
+        }
+        return false;
+    }
 
     switch (c) {
-        case '$':
-            param = 0;
-            offset = 0;
-            parity = 0;
-            break;
         case ',':
+            nmea.parity ^= c;
+            nmeaFieldEnd();
+            nmea.field++;
+            nmeaFieldReset();
+            break;
         case '*':
-            string[offset] = 0;
-            if (param == 0) {       //frame identification
-                gps_frame = NO_FRAME;
-                if (strcmp(string, "GPGGA") == 0 || strcmp(string, "GNGGA") == 0) {
-                    gps_frame = FRAME_GGA;
-                }
-                else if (strcmp(string, "GPRMC") == 0 || strcmp(string, "GNRMC") == 0) {
-                    gps_frame = FRAME_RMC;
-                }
-            }
-
-            switch (gps_frame) {
-                case FRAME_GGA:        //************* GPGGA FRAME parsing
-                    switch (param) {
-            //          case 1:             // Time information
-            //              break;
-                        case 2:
-                            gps_Msg.latitude = GPS_coord_to_degrees(string);
-                            break;
-                        case 3:
-                            if (string[0] == 'S')
-                                gps_Msg.latitude *= -1;
-                            break;
-                        case 4:
-                            gps_Msg.longitude = GPS_coord_to_degrees(string);
-                            break;
-                        case 5:
-                            if (string[0] == 'W')
-                                gps_Msg.longitude *= -1;
-                            break;
-                        case 6:
-                            if (string[0] > '0') {
-                                gps_Msg.fix = true;
-                            } else {
-                                gps_Msg.fix = false;
-                            }
-                            break;
-                        case 7:
-                            gps_Msg.numSat = grab_fields(string, 0);
-                            break;
-                        case 8:
-                            gps_Msg.hdop = grab_fields(string, 1) * 10;          // hdop
-                            break;
-                        case 9:
-                            gps_Msg.altitude = grab_fields(string, 1) * 10;     // altitude in cm
-                            break;
-                    }
-                    break;
-                case FRAME_RMC:        //************* GPRMC FRAME parsing
-                                       // $GNRMC,130059.00,V,,,,,,,110917,,,N*62
-                    switch (param) {
-                        case 1:
-                            gps_Msg.time = grab_fields(string, 2);
-                            break;
-                        case 7:
-                            gps_Msg.speed = ((grab_fields(string, 1) * 5144L) / 1000L);    // speed in cm/s added by Mis
-                            break;
-                        case 8:
-                            gps_Msg.ground_course = (grab_fields(string, 1));      // ground course deg * 10
-                            break;
-                        case 9:
-                            gps_Msg.date = grab_fields(string, 0);
-                            break;
-                    }
-                    break;
-            }
-
-            param++;
-            offset = 0;
-            if (c == '*')
-                checksum_param = 1;
-            else
-                parity ^= c;
+            nmeaFieldEnd();
+            nmea.inChecksum = true;
+            nmea.checksum = 0;
+            nmea.checksumDigits = 0;
             break;
         case '\r':
         case '\n':
-            if (checksum_param) {   //parity checksum
-                uint8_t checksum = 16 * ((string[0] >= 'A') ? string[0] - 'A' + 10 : string[0] - '0') + ((string[1] >= 'A') ? string[1] - 'A' + 10 : string[1] - '0');
-                if (checksum == parity) {
-                    gpsStats.packetCount++;
-                    switch (gps_frame) {
-                    case FRAME_GGA:
-                        frameOK = 1;
-                        gpsSol.numSat = gps_Msg.numSat;
-                        if (gps_Msg.fix) {
-                            gpsSol.fixType = GPS_FIX_3D;    // NMEA doesn't report fix type, assume 3D
-
-                            gpsSol.llh.lat = gps_Msg.latitude;
-                            gpsSol.llh.lon = gps_Msg.longitude;
-                            gpsSol.llh.alt = gps_Msg.altitude;
-
-                            // EPH/EPV are unreliable for NMEA as they are not real accuracy
-                            gpsSol.hdop = gpsConstrainHDOP(gps_Msg.hdop);
-                            gpsSol.eph = gpsConstrainEPE(gps_Msg.hdop * GPS_HDOP_TO_EPH_MULTIPLIER);
-                            gpsSol.epv = gpsConstrainEPE(gps_Msg.hdop * GPS_HDOP_TO_EPH_MULTIPLIER);
-                            gpsSol.flags.validEPE = 0;
-                        }
-                        else {
-                            gpsSol.fixType = GPS_NO_FIX;
-                        }
-
-                        // NMEA does not report VELNED
-                        gpsSol.flags.validVelNE = 0;
-                        gpsSol.flags.validVelD = 0;
-                        break;
-                    case FRAME_RMC:
-                        gpsSol.groundSpeed = gps_Msg.speed;
-                        gpsSol.groundCourse = gps_Msg.ground_course;
-
-                        // This check will miss 00:00:00.00, but we shouldn't care - next report will be valid
-                        if (gps_Msg.date != 0 && gps_Msg.time != 0) {
-                            gpsSol.time.year = (gps_Msg.date % 100) + 2000;
-                            gpsSol.time.month = (gps_Msg.date / 100) % 100;
-                            gpsSol.time.day = (gps_Msg.date / 10000) % 100;
-                            gpsSol.time.hours = (gps_Msg.time / 1000000) % 100;
-                            gpsSol.time.minutes = (gps_Msg.time / 10000) % 100;
-                            gpsSol.time.seconds = (gps_Msg.time / 100) % 100;
-                            gpsSol.time.millis = (gps_Msg.time & 100) * 10;
-                            gpsSol.flags.validTime = 1;
-                        }
-                        else {
-                            gpsSol.flags.validTime = 0;
-                        }
-
-                        break;
-                    } // end switch
+            // A sentence without a checksum can't be trusted
+            nmea.inSentence = false;
+            gpsStats.errors++;
+            break;
+        default:
+            nmea.parity ^= c;
+            if (nmea.field == 0) {
+                if (nmea.length < NMEA_SENTENCE_ID_LENGTH) {
+                    nmea.id[nmea.length] = c;
                 }
-                else {
-                    gpsStats.errors++;
+                if (nmea.length <= NMEA_SENTENCE_ID_LENGTH) {
+                    nmea.length++;
                 }
+            } else {
+                nmeaFieldChar(c);
             }
-            checksum_param = 0;
             break;
-        default:
-            if (offset < (NMEA_BUFFER_SIZE-1)) {    // leave 1 byte to trailing zero
-                string[offset++] = c;
-
-                // only checksum if character is recorded and used (will cause checksum failure on dropped characters)
-                if (!checksum_param)
-                    parity ^= c;
-            }
     }
-    return frameOK;
+
+    return false;
 }
 
 static ptSemaphore_t semNewDataReady;
@@ -270,14 +444,14 @@ STATIC_PROTOTHREAD(gpsProtocolReceiverThread)
 
     while (1) {
         // Wait until there are bytes to consume
-        ptWait(serialRxBytesWaiting(gpsState.gpsPort));
+        ptWait(serialRxBytesWaiting(gpsState->gpsPort));
 
         // Consume bytes until buffer empty of until we have full message received
-        while (serialRxBytesWaiting(gpsState.gpsPort)) {
-            uint8_t newChar = serialRead(gpsState.gpsPort);
+        while (serialRxBytesWaiting(gpsState->gpsPort)) {
+            uint8_t newChar = serialRead(gpsState->gpsPort);
             if (gpsNewFrameNMEA(newChar)) {
-                gpsSol.flags.validVelNE = 0;
-                gpsSol.flags.validVelD = 0;
+                gpsState->solution.flags.validVelNE = 0;
+                gpsState->solution.flags.validVelD = 0;
                 ptSemaphoreSignal(semNewDataReady);
                 break;
             }
@@ -292,16 +466,16 @@ STATIC_PROTOTHREAD(gpsProtocolStateThreadNMEA)
     ptBegin(gpsProtocolStateThreadNMEA);
 
     // Change baud rate
-    ptWait(isSerialTransmitBufferEmpty(gpsState.gpsPort));
-    if (gpsState.gpsConfig->autoBaud != GPS_AUTOBAUD_OFF) {
+    ptWait(isSerialTransmitBufferEmpty(gpsState->gpsPort));
+    if (gpsState->gpsConfig->autoBaud != GPS_AUTOBAUD_OFF) {
         // Cycle through available baud rates and hope that we will match GPS
-        serialSetBaudRate(gpsState.gpsPort, baudRates[gpsToSerialBaudRate[gpsState.autoBaudrateIndex]]);
-        gpsState.autoBaudrateIndex = (gpsState.autoBaudrateIndex + 1) % GPS_BAUDRATE_COUNT;
+        serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->autoBaudrateIndex]]);
+        gpsState->autoBaudrateIndex = (gpsState->autoBaudrateIndex + 1) % GPS_BAUDRATE_COUNT;
         ptDelayMs(GPS_BAUD_CHANGE_DELAY);
     }
     else {
         // Set baud rate
-        serialSetBaudRate(gpsState.gpsPort, baudRates[gpsToSerialBaudRate[gpsState.baudrateIndex]]);
+        serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->baudrateIndex]]);
     }
 
     // No configuration is done for pure NMEA modules
@@ -30,6 +30,9 @@
 #define GPS_INIT_DELAY          (500)
 #define GPS_BOOT_DELAY          (3000)
 
+#define GPS_TASK_PERIOD_US          (1000000 / 50)          // Task rate when no data arrives
+#define GPS_TASK_MIN_INTERVAL_US    (1000)                  // Limits the task rate while a frame is being received
+
 typedef enum {
     GPS_UNKNOWN,                // 0
     GPS_INITIALIZING,           // 1
@@ -38,6 +41,7 @@ typedef enum {
 } gpsState_e;
 
 typedef struct {
+    uint8_t         index;
     const gpsConfig_t *   gpsConfig;
     const serialConfig_t * serialConfig;
     serialPort_t *  gpsPort;                // Serial GPS only
@@ -53,9 +57,15 @@ typedef struct {
     timeMs_t        lastLastMessageMs;
     timeMs_t        lastMessageMs;
     timeMs_t        timeoutMs;
+
+    volatile bool   solutionReady;          // Set by providers that receive a complete solution outside of the GPS task
+
+    gpsSolutionData_t solution;             // Raw solution of this receiver, gpsSol is made from these
 } gpsReceiverData_t;
 
-extern gpsReceiverData_t gpsState;
+extern gpsReceiverData_t gpsReceivers[GPS_RECEIVER_COUNT];
+// Receiver the provider driver runs for
+extern gpsReceiverData_t *gpsState;
 
 extern baudRate_e gpsToSerialBaudRate[GPS_BAUDRATE_COUNT];
 
@@ -67,6 +77,7 @@ extern uint16_t gpsConstrainHDOP(uint32_t hdop);
 
 void gpsProcessNewSolutionData(void);
 void gpsSetProtocolTimeout(timeMs_t timeoutMs);
+void gpsFastStartSetConfigHash(uint16_t hash);
 
 extern void gpsRestartUBLOX(void);
 extern void gpsHandleUBLOX(void);
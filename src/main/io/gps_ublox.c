@@ -32,9 +32,11 @@
 
 
 #include "common/axis.h"
+#include "common/crc.h"
 #include "common/typeconversion.h"
 #include "common/gps_conversion.h"
 #include "common/maths.h"
+#include "common/time.h"
 #include "common/utils.h"
 
 #include "drivers/serial.h"
@@ -50,6 +52,7 @@
 #include "scheduler/protothreads.h"
 
 #define GPS_CFG_CMD_TIMEOUT_MS              200
+#define GPS_CFG_SAVE_TIMEOUT_MS             500     // Writing the flash of the receiver takes a while
 #define GPS_VERSION_RETRY_TIMES             2
 #define MAX_UBLOX_PAYLOAD_SIZE              256
 #define UBLOX_BUFFER_SIZE                   MAX_UBLOX_PAYLOAD_SIZE
@@ -143,12 +146,50 @@ typedef struct {
 #define MAX_GNSS 7
 #define MAX_GNSS_SIZE_BYTES (sizeof(ubx_gnss_msg_t) + sizeof(ubx_gnss_element_t)*MAX_GNSS)
 
+typedef struct {
+    uint32_t clearMask;
+    uint32_t saveMask;
+    uint32_t loadMask;
+    uint8_t deviceMask;
+} __attribute__((packed)) ubx_cfg_cfg;
+
+typedef struct {
+    uint8_t type;
+    uint8_t version;
+    uint8_t reserved1[2];
+    int32_t lat;
+    int32_t lon;
+    int32_t alt;                // cm above the ellipsoid
+    uint32_t posAcc;            // cm
+} ubx_mga_ini_pos_llh;
+
+typedef struct {
+    uint8_t type;
+    uint8_t version;
+    uint8_t ref;
+    int8_t leapSecs;            // -128 if unknown
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t reserved1;
+    uint32_t ns;
+    uint16_t tAccS;
+    uint8_t reserved2[2];
+    uint32_t tAccNs;
+} ubx_mga_ini_time_utc;
+
 typedef union {
     uint8_t bytes[MAX_GNSS_SIZE_BYTES]; // placeholder
     ubx_sbas sbas;
     ubx_msg msg;
     ubx_rate rate;
     ubx_gnss_msg_t gnss;
+    ubx_cfg_cfg cfg;
+    ubx_mga_ini_pos_llh iniPos;
+    ubx_mga_ini_time_utc iniTime;
 } ubx_payload;
 
 // UBX support
@@ -299,6 +340,7 @@ enum {
     CLASS_ACK = 0x05,
     CLASS_CFG = 0x06,
     CLASS_MON = 0x0A,
+    CLASS_MGA = 0x13,
     MSG_CLASS_UBX = 0x01,
     MSG_CLASS_NMEA = 0xF0,
     MSG_VER = 0x04,
@@ -324,7 +366,11 @@ enum {
     MSG_CFG_SET_RATE = 0x01,
     MSG_CFG_NAV_SETTINGS = 0x24,
     MSG_CFG_SBAS = 0x16,
-    MSG_CFG_GNSS = 0x3e
+    MSG_CFG_GNSS = 0x3e,
+    MSG_CFG_CFG = 0x09,
+    MSG_CFG_NAVX5 = 0x23,
+    MSG_CFG_VALSET = 0x8a,
+    MSG_MGA_INI = 0x40
 } ubx_protocol_bytes;
 
 enum {
@@ -346,31 +392,6 @@ enum {
     UBX_ACK_GOT_NAK = 2
 } ubx_ack_state;
 
-// Packet checksum accumulators
-static uint8_t _ck_a;
-static uint8_t _ck_b;
-
-// State machine state
-static bool _skip_packet;
-static uint8_t _step;
-static uint8_t _msg_id;
-static uint16_t _payload_length;
-static uint16_t _payload_counter;
-
-static uint8_t next_fix_type;
-static uint8_t _class;
-static uint8_t _ack_state;
-static uint8_t _ack_waiting_msg;
-
-// do we have new position information?
-static bool _new_position;
-
-// do we have new speed information?
-static bool _new_speed;
-
-// Need this to determine if Galileo capable only
-static bool capGalileo;
-
 // Example packet sizes from UBlox u-center from a Glonass capable GPS receiver.
 //15:17:55  R -> UBX NAV-STATUS,  Size  24,  'Navigation Status'
 //15:17:55  R -> UBX NAV-POSLLH,  Size  36,  'Geodetic Position'
@@ -384,14 +405,14 @@ static bool capGalileo;
 //15:17:55  R -> UBX NAV-SVINFO,  Size 328,  'Satellite Status and Information'
 
 
-// Send buffer
+// Send buffer, shared as messages are copied to the port right away
 static union {
     ubx_message message;
     uint8_t bytes[58];
 } send_buffer;
 
 // Receive buffer
-static union {
+typedef union {
     ubx_nav_posllh posllh;
     ubx_nav_status status;
     ubx_nav_solution solution;
@@ -402,7 +423,58 @@ static union {
     ubx_nav_timeutc timeutc;
     ubx_ack_ack ack;
     uint8_t bytes[UBLOX_BUFFER_SIZE];
-} _buffer;
+} ubxReceiveBuffer_t;
+
+// Driver state, one per receiver
+typedef struct {
+    // Packet checksum accumulators
+    uint8_t ck_a;
+    uint8_t ck_b;
+
+    // State machine state
+    bool skipPacket;
+    uint8_t step;
+    uint8_t msgId;
+    uint16_t payloadLength;
+    uint16_t payloadCounter;
+
+    uint8_t nextFixType;
+    uint8_t msgClass;
+    uint8_t ackState;
+    uint8_t ackWaitingMsg;
+
+    // do we have new position information?
+    bool newPosition;
+
+    // do we have new speed information?
+    bool newSpeed;
+
+    // Need this to determine if Galileo capable only
+    bool capGalileo;
+
+    // Configuration was skipped on this start and no solution arrived yet
+    bool fastStartPending;
+    // A start without configuration failed, always configure until reboot
+    bool fastStartFailed;
+
+    ptSemaphore_t semNewDataReady;
+    struct ptState_s ptConfigure;
+    struct ptState_s ptDetectVersion;
+    struct ptState_s ptReceiver;
+    struct ptState_s ptState;
+
+    ubxReceiveBuffer_t buffer;
+} ubloxReceiver_t;
+
+static ubloxReceiver_t ubloxReceivers[GPS_RECEIVER_COUNT];
+// Receiver the driver runs for, follows gpsState
+static ubloxReceiver_t *ubx = &ubloxReceivers[0];
+
+// Protothread states are per receiver as well
+#define gpsConfigure_protothreadState               (ubx->ptConfigure)
+#define gpsDetectVersion_protothreadState           (ubx->ptDetectVersion)
+#define gpsProtocolReceiverThread_protothreadState  (ubx->ptReceiver)
+#define gpsProtocolStateThread_protothreadState     (ubx->ptState)
 
 void _update_checksum(uint8_t *data, uint8_t len, uint8_t *ck_a, uint8_t *ck_b)
 {
@@ -430,11 +502,11 @@ static void sendConfigMessageUBLOX(void)
     _update_checksum(&send_buffer.bytes[2], send_buffer.message.header.length+4, &ck_a, &ck_b);
     send_buffer.bytes[send_buffer.message.header.length+6] = ck_a;
     send_buffer.bytes[send_buffer.message.header.length+7] = ck_b;
-    serialWriteBuf(gpsState.gpsPort, send_buffer.bytes, send_buffer.message.header.length+8);
+    serialWriteBuf(gpsState->gpsPort, send_buffer.bytes, send_buffer.message.header.length+8);
 
     // Save state for ACK waiting
-    _ack_waiting_msg = send_buffer.message.header.msg_id;
-    _ack_state = UBX_ACK_WAITING;
+    ubx->ackWaitingMsg = send_buffer.message.header.msg_id;
+    ubx->ackState = UBX_ACK_WAITING;
 }
 
 static void pollVersion(void)
@@ -460,7 +532,7 @@ static int configureGNSS_SBAS(ubx_gnss_element_t * gnss_block)
     gnss_block->gnssId = GNSSID_SBAS;
     gnss_block->maxTrkCh = 3;
     gnss_block->sigCfgMask = 1;
-    if (gpsState.gpsConfig->sbasMode == SBAS_NONE) {
+    if (gpsState->gpsConfig->sbasMode == SBAS_NONE) {
          gnss_block->enabled = 0;
          gnss_block->resTrkCh = 0;
     } else {
@@ -473,14 +545,14 @@ static int configureGNSS_SBAS(ubx_gnss_element_t * gnss_block)
 
 static int configureGNSS_GALILEO(ubx_gnss_element_t * gnss_block)
 {
-    if (!capGalileo) {
+    if (!ubx->capGalileo) {
         return 0;
     }
 
     gnss_block->gnssId = GNSSID_GALILEO;
     gnss_block->maxTrkCh = 8;
     gnss_block->sigCfgMask = 1;
-    if (gpsState.gpsConfig->ubloxUseGalileo) {
+    if (gpsState->gpsConfig->ubloxUseGalileo) {
         gnss_block->enabled = 1;
         gnss_block->resTrkCh = 4;
     } else {
@@ -557,14 +629,109 @@ static void configureSBAS(void)
     send_buffer.message.header.msg_class = CLASS_CFG;
     send_buffer.message.header.msg_id = MSG_CFG_SBAS;
     send_buffer.message.header.length = 8;
-    send_buffer.message.payload.sbas.mode=(gpsState.gpsConfig->sbasMode == SBAS_NONE?2:3);
+    send_buffer.message.payload.sbas.mode=(gpsState->gpsConfig->sbasMode == SBAS_NONE?2:3);
     send_buffer.message.payload.sbas.usage=3;
     send_buffer.message.payload.sbas.maxSBAS=3;
     send_buffer.message.payload.sbas.scanmode2=0;
-    send_buffer.message.payload.sbas.scanmode1=ubloxScanMode1[gpsState.gpsConfig->sbasMode];
+    send_buffer.message.payload.sbas.scanmode1=ubloxScanMode1[gpsState->gpsConfig->sbasMode];
+    sendConfigMessageUBLOX();
+}
+
+/*
+ * Save the whole current configuration (ioPort, msgConf, infMsg, navConf, rxmConf and
+ * the M8+ sections) to BBR, flash and EEPROM, whichever the receiver has
+ */
+static void saveConfigurationUBLOX(void)
+{
+    send_buffer.message.header.msg_class = CLASS_CFG;
+    send_buffer.message.header.msg_id = MSG_CFG_CFG;
+    send_buffer.message.header.length = sizeof(ubx_cfg_cfg);
+    send_buffer.message.payload.cfg.clearMask = 0;
+    send_buffer.message.payload.cfg.saveMask = 0x1F1F;
+    send_buffer.message.payload.cfg.loadMask = 0;
+    send_buffer.message.payload.cfg.deviceMask = 0x17;
+    sendConfigMessageUBLOX();
+}
+
+/*
+ * AssistNow Autonomous: the receiver predicts orbits from the broadcast
+ * ephemeris it saw, which shortens the next fix after a few hours off
+ */
+static void configureAOP(void)
+{
+    if (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX10) {
+        // CFG-NAVX5 is gone, set CFG-ANA-USE_ANA in RAM, BBR and flash
+        static const uint8_t valset[] = { 0x00, 0x07, 0x00, 0x00, 0x01, 0x00, 0x23, 0x10, 0x01 };
+        send_buffer.message.header.msg_class = CLASS_CFG;
+        send_buffer.message.header.msg_id = MSG_CFG_VALSET;
+        send_buffer.message.header.length = sizeof(valset);
+        memcpy(send_buffer.message.payload.bytes, valset, sizeof(valset));
+    }
+    else {
+        send_buffer.message.header.msg_class = CLASS_CFG;
+        send_buffer.message.header.msg_id = MSG_CFG_NAVX5;
+        send_buffer.message.header.length = 40;
+        memset(send_buffer.message.payload.bytes, 0, 40);
+        send_buffer.message.payload.bytes[0] = (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX8) ? 2 : 0;  // version
+        send_buffer.message.payload.bytes[3] = 0x40;    // mask1: apply aopCfg only
+        send_buffer.message.payload.bytes[27] = 0x01;   // aopCfg: useAOP
+    }
+    sendConfigMessageUBLOX();
+}
+
+// MGA messages are not acknowledged unless asked to
+static void sendPositionAidingUBLOX(const gpsLocation_t *llh)
+{
+    send_buffer.message.header.msg_class = CLASS_MGA;
+    send_buffer.message.header.msg_id = MSG_MGA_INI;
+    send_buffer.message.header.length = sizeof(ubx_mga_ini_pos_llh);
+    memset(&send_buffer.message.payload.iniPos, 0, sizeof(ubx_mga_ini_pos_llh));
+    send_buffer.message.payload.iniPos.type = 0x01;
+    send_buffer.message.payload.iniPos.lat = llh->lat;
+    send_buffer.message.payload.iniPos.lon = llh->lon;
+    // Saved altitude is MSL, the geoid separation is well within the accuracy
+    send_buffer.message.payload.iniPos.alt = llh->alt;
+    send_buffer.message.payload.iniPos.posAcc = 20 * 1000 * 100;
+    sendConfigMessageUBLOX();
+}
+
+static void sendTimeAidingUBLOX(const dateTime_t *dt)
+{
+    send_buffer.message.header.msg_class = CLASS_MGA;
+    send_buffer.message.header.msg_id = MSG_MGA_INI;
+    send_buffer.message.header.length = sizeof(ubx_mga_ini_time_utc);
+    memset(&send_buffer.message.payload.iniTime, 0, sizeof(ubx_mga_ini_time_utc));
+    send_buffer.message.payload.iniTime.type = 0x10;
+    send_buffer.message.payload.iniTime.leapSecs = -128;
+    send_buffer.message.payload.iniTime.year = dt->year;
+    send_buffer.message.payload.iniTime.month = dt->month;
+    send_buffer.message.payload.iniTime.day = dt->day;
+    send_buffer.message.payload.iniTime.hour = dt->hours;
+    send_buffer.message.payload.iniTime.minute = dt->minutes;
+    send_buffer.message.payload.iniTime.second = dt->seconds;
+    send_buffer.message.payload.iniTime.ns = dt->millis * 1000000;
+    send_buffer.message.payload.iniTime.tAccS = 5;
     sendConfigMessageUBLOX();
 }
 
+// Everything gpsConfigure() depends on, so a saved configuration can be told from a stale one
+static uint16_t gpsConfigHashUBLOX(void)
+{
+    const uint32_t fields[] = {
+        gpsState->hwVersion,
+        gpsState->baudrateIndex,
+        gpsState->gpsConfig->provider,
+        gpsState->gpsConfig->sbasMode,
+        gpsState->gpsConfig->dynModel,
+        gpsState->gpsConfig->ubloxUseGalileo,
+        gpsState->gpsConfig->ubloxNavHz,
+        ubx->capGalileo,
+    };
+    const uint16_t hash = crc16_ccitt_update(0, fields, sizeof(fields));
+
+    return hash ? hash : 1;
+}
+
 static uint32_t gpsDecodeHardwareVersion(const char * szBuf, unsigned nBufSize)
 {
     // ublox_5   hwVersion 00040005
@@ -602,100 +769,100 @@ static uint32_t gpsDecodeHardwareVersion(const char * szBuf, unsigned nBufSize)
 
 static bool gpsParceFrameUBLOX(void)
 {
-    switch (_msg_id) {
+    switch (ubx->msgId) {
     case MSG_POSLLH:
-        gpsSol.llh.lon = _buffer.posllh.longitude;
-        gpsSol.llh.lat = _buffer.posllh.latitude;
-        gpsSol.llh.alt = _buffer.posllh.altitude_msl / 10;  //alt in cm
-        gpsSol.eph = gpsConstrainEPE(_buffer.posllh.horizontal_accuracy / 10);
-        gpsSol.epv = gpsConstrainEPE(_buffer.posllh.vertical_accuracy / 10);
-        gpsSol.flags.validEPE = 1;
-        if (next_fix_type != GPS_NO_FIX)
-            gpsSol.fixType = next_fix_type;
-        _new_position = true;
+        gpsState->solution.llh.lon = ubx->buffer.posllh.longitude;
+        gpsState->solution.llh.lat = ubx->buffer.posllh.latitude;
+        gpsState->solution.llh.alt = ubx->buffer.posllh.altitude_msl / 10;  //alt in cm
+        gpsState->solution.eph = gpsConstrainEPE(ubx->buffer.posllh.horizontal_accuracy / 10);
+        gpsState->solution.epv = gpsConstrainEPE(ubx->buffer.posllh.vertical_accuracy / 10);
+        gpsState->solution.flags.validEPE = 1;
+        if (ubx->nextFixType != GPS_NO_FIX)
+            gpsState->solution.fixType = ubx->nextFixType;
+        ubx->newPosition = true;
         break;
     case MSG_STATUS:
-        next_fix_type = gpsMapFixType(_buffer.status.fix_status & NAV_STATUS_FIX_VALID, _buffer.status.fix_type);
-        if (next_fix_type == GPS_NO_FIX)
-            gpsSol.fixType = GPS_NO_FIX;
+        ubx->nextFixType = gpsMapFixType(ubx->buffer.status.fix_status & NAV_STATUS_FIX_VALID, ubx->buffer.status.fix_type);
+        if (ubx->nextFixType == GPS_NO_FIX)
+            gpsState->solution.fixType = GPS_NO_FIX;
         break;
     case MSG_SOL:
-        next_fix_type = gpsMapFixType(_buffer.solution.fix_status & NAV_STATUS_FIX_VALID, _buffer.solution.fix_type);
-        if (next_fix_type == GPS_NO_FIX)
-            gpsSol.fixType = GPS_NO_FIX;
-        gpsSol.numSat = _buffer.solution.satellites;
-        gpsSol.hdop = gpsConstrainHDOP(_buffer.solution.position_DOP);
+        ubx->nextFixType = gpsMapFixType(ubx->buffer.solution.fix_status & NAV_STATUS_FIX_VALID, ubx->buffer.solution.fix_type);
+        if (ubx->nextFixType == GPS_NO_FIX)
+            gpsState->solution.fixType = GPS_NO_FIX;
+        gpsState->solution.numSat = ubx->buffer.solution.satellites;
+        gpsState->solution.hdop = gpsConstrainHDOP(ubx->buffer.solution.position_DOP);
         break;
     case MSG_VELNED:
-        gpsSol.groundSpeed = _buffer.velned.speed_2d;    // cm/s
-        gpsSol.groundCourse = (uint16_t) (_buffer.velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
-        gpsSol.velNED[X] = _buffer.velned.ned_north;
-        gpsSol.velNED[Y] = _buffer.velned.ned_east;
-        gpsSol.velNED[Z] = _buffer.velned.ned_down;
-        gpsSol.flags.validVelNE = 1;
-        gpsSol.flags.validVelD = 1;
-        _new_speed = true;
+        gpsState->solution.groundSpeed = ubx->buffer.velned.speed_2d;    // cm/s
+        gpsState->solution.groundCourse = (uint16_t) (ubx->buffer.velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+        gpsState->solution.velNED[X] = ubx->buffer.velned.ned_north;
+        gpsState->solution.velNED[Y] = ubx->buffer.velned.ned_east;
+        gpsState->solution.velNED[Z] = ubx->buffer.velned.ned_down;
+        gpsState->solution.flags.validVelNE = 1;
+        gpsState->solution.flags.validVelD = 1;
+        ubx->newSpeed = true;
         break;
     case MSG_TIMEUTC:
-        if (UBX_VALID_GPS_DATE_TIME(_buffer.timeutc.valid)) {
-            gpsSol.time.year = _buffer.timeutc.year;
-            gpsSol.time.month = _buffer.timeutc.month;
-            gpsSol.time.day = _buffer.timeutc.day;
-            gpsSol.time.hours = _buffer.timeutc.hour;
-            gpsSol.time.minutes = _buffer.timeutc.min;
-            gpsSol.time.seconds = _buffer.timeutc.sec;
-            gpsSol.time.millis = _buffer.timeutc.nano / (1000*1000);
-
-            gpsSol.flags.validTime = 1;
+        if (UBX_VALID_GPS_DATE_TIME(ubx->buffer.timeutc.valid)) {
+            gpsState->solution.time.year = ubx->buffer.timeutc.year;
+            gpsState->solution.time.month = ubx->buffer.timeutc.month;
+            gpsState->solution.time.day = ubx->buffer.timeutc.day;
+            gpsState->solution.time.hours = ubx->buffer.timeutc.hour;
+            gpsState->solution.time.minutes = ubx->buffer.timeutc.min;
+            gpsState->solution.time.seconds = ubx->buffer.timeutc.sec;
+            gpsState->solution.time.millis = ubx->buffer.timeutc.nano / (1000*1000);
+
+            gpsState->solution.flags.validTime = 1;
         } else {
-            gpsSol.flags.validTime = 0;
+            gpsState->solution.flags.validTime = 0;
         }
         break;
     case MSG_PVT:
-        next_fix_type = gpsMapFixType(_buffer.pvt.fix_status & NAV_STATUS_FIX_VALID, _buffer.pvt.fix_type);
-        gpsSol.fixType = next_fix_type;
-        gpsSol.llh.lon = _buffer.pvt.longitude;
-        gpsSol.llh.lat = _buffer.pvt.latitude;
-        gpsSol.llh.alt = _buffer.pvt.altitude_msl / 10;  //alt in cm
-        gpsSol.velNED[X]=_buffer.pvt.ned_north / 10;  // to cm/s
-        gpsSol.velNED[Y]=_buffer.pvt.ned_east / 10;   // to cm/s
-        gpsSol.velNED[Z]=_buffer.pvt.ned_down / 10;   // to cm/s
-        gpsSol.groundSpeed = _buffer.pvt.speed_2d / 10;    // to cm/s
-        gpsSol.groundCourse = (uint16_t) (_buffer.pvt.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
-        gpsSol.numSat = _buffer.pvt.satellites;
-        gpsSol.eph = gpsConstrainEPE(_buffer.pvt.horizontal_accuracy / 10);
-        gpsSol.epv = gpsConstrainEPE(_buffer.pvt.vertical_accuracy / 10);
-        gpsSol.hdop = gpsConstrainHDOP(_buffer.pvt.position_DOP);
-        gpsSol.flags.validVelNE = 1;
-        gpsSol.flags.validVelD = 1;
-        gpsSol.flags.validEPE = 1;
-
-        if (UBX_VALID_GPS_DATE_TIME(_buffer.pvt.valid)) {
-            gpsSol.time.year = _buffer.pvt.year;
-            gpsSol.time.month = _buffer.pvt.month;
-            gpsSol.time.day = _buffer.pvt.day;
-            gpsSol.time.hours = _buffer.pvt.hour;
-            gpsSol.time.minutes = _buffer.pvt.min;
-            gpsSol.time.seconds = _buffer.pvt.sec;
-            gpsSol.time.millis = _buffer.pvt.nano / (1000*1000);
-
-            gpsSol.flags.validTime = 1;
+        ubx->nextFixType = gpsMapFixType(ubx->buffer.pvt.fix_status & NAV_STATUS_FIX_VALID, ubx->buffer.pvt.fix_type);
+        gpsState->solution.fixType = ubx->nextFixType;
+        gpsState->solution.llh.lon = ubx->buffer.pvt.longitude;
+        gpsState->solution.llh.lat = ubx->buffer.pvt.latitude;
+        gpsState->solution.llh.alt = ubx->buffer.pvt.altitude_msl / 10;  //alt in cm
+        gpsState->solution.velNED[X]=ubx->buffer.pvt.ned_north / 10;  // to cm/s
+        gpsState->solution.velNED[Y]=ubx->buffer.pvt.ned_east / 10;   // to cm/s
+        gpsState->solution.velNED[Z]=ubx->buffer.pvt.ned_down / 10;   // to cm/s
+        gpsState->solution.groundSpeed = ubx->buffer.pvt.speed_2d / 10;    // to cm/s
+        gpsState->solution.groundCourse = (uint16_t) (ubx->buffer.pvt.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+        gpsState->solution.numSat = ubx->buffer.pvt.satellites;
+        gpsState->solution.eph = gpsConstrainEPE(ubx->buffer.pvt.horizontal_accuracy / 10);
+        gpsState->solution.epv = gpsConstrainEPE(ubx->buffer.pvt.vertical_accuracy / 10);
+        gpsState->solution.hdop = gpsConstrainHDOP(ubx->buffer.pvt.position_DOP);
+        gpsState->solution.flags.validVelNE = 1;
+        gpsState->solution.flags.validVelD = 1;
+        gpsState->solution.flags.validEPE = 1;
+
+        if (UBX_VALID_GPS_DATE_TIME(ubx->buffer.pvt.valid)) {
+            gpsState->solution.time.year = ubx->buffer.pvt.year;
+            gpsState->solution.time.month = ubx->buffer.pvt.month;
+            gpsState->solution.time.day = ubx->buffer.pvt.day;
+            gpsState->solution.time.hours = ubx->buffer.pvt.hour;
+            gpsState->solution.time.minutes = ubx->buffer.pvt.min;
+            gpsState->solution.time.seconds = ubx->buffer.pvt.sec;
+            gpsState->solution.time.millis = ubx->buffer.pvt.nano / (1000*1000);
+
+            gpsState->solution.flags.validTime = 1;
         } else {
-            gpsSol.flags.validTime = 0;
+            gpsState->solution.flags.validTime = 0;
         }
 
-        _new_position = true;
-        _new_speed = true;
+        ubx->newPosition = true;
+        ubx->newSpeed = true;
         break;
     case MSG_VER:
-        if (_class == CLASS_MON) {
-            gpsState.hwVersion = gpsDecodeHardwareVersion(_buffer.ver.hwVersion, sizeof(_buffer.ver.hwVersion));
-            if  ((gpsState.hwVersion >= UBX_HW_VERSION_UBLOX8) && (_buffer.ver.swVersion[9] > '2')) {
+        if (ubx->msgClass == CLASS_MON) {
+            gpsState->hwVersion = gpsDecodeHardwareVersion(ubx->buffer.ver.hwVersion, sizeof(ubx->buffer.ver.hwVersion));
+            if  ((gpsState->hwVersion >= UBX_HW_VERSION_UBLOX8) && (ubx->buffer.ver.swVersion[9] > '2')) {
                 // check extensions;
                 // after hw + sw vers; each is 30 bytes
-                for(int j = 40; j < _payload_length; j += 30) {
-                    if (strnstr((const char *)(_buffer.bytes+j), "GAL", 30)) {
-                        capGalileo = true;
+                for(int j = 40; j < ubx->payloadLength; j += 30) {
+                    if (strnstr((const char *)(ubx->buffer.bytes+j), "GAL", 30)) {
+                        ubx->capGalileo = true;
                         break;
                     }
                 }
@@ -703,13 +870,13 @@ static bool gpsParceFrameUBLOX(void)
         }
         break;
     case MSG_ACK_ACK:
-        if ((_ack_state == UBX_ACK_WAITING) && (_buffer.ack.msg == _ack_waiting_msg)) {
-            _ack_state = UBX_ACK_GOT_ACK;
+        if ((ubx->ackState == UBX_ACK_WAITING) && (ubx->buffer.ack.msg == ubx->ackWaitingMsg)) {
+            ubx->ackState = UBX_ACK_GOT_ACK;
         }
         break;
     case MSG_ACK_NACK:
-        if ((_ack_state == UBX_ACK_WAITING) && (_buffer.ack.msg == _ack_waiting_msg)) {
-            _ack_state = UBX_ACK_GOT_NAK;
+        if ((ubx->ackState == UBX_ACK_WAITING) && (ubx->buffer.ack.msg == ubx->ackWaitingMsg)) {
+            ubx->ackState = UBX_ACK_GOT_NAK;
         }
         break;
     default:
@@ -718,8 +885,8 @@ static bool gpsParceFrameUBLOX(void)
 
     // we only return true when we get new position and speed data
     // this ensures we don't use stale data
-    if (_new_position && _new_speed) {
-        _new_speed = _new_position = false;
+    if (ubx->newPosition && ubx->newSpeed) {
+        ubx->newSpeed = ubx->newPosition = false;
         return true;
     }
 
@@ -730,81 +897,81 @@ static bool gpsNewFrameUBLOX(uint8_t data)
 {
     bool parsed = false;
 
-    switch (_step) {
+    switch (ubx->step) {
         case 0: // Sync char 1 (0xB5)
             if (PREAMBLE1 == data) {
-                _skip_packet = false;
-                _step++;
+                ubx->skipPacket = false;
+                ubx->step++;
             }
             break;
         case 1: // Sync char 2 (0x62)
             if (PREAMBLE2 != data) {
-                _step = 0;
+                ubx->step = 0;
                 break;
             }
-            _step++;
+            ubx->step++;
             break;
         case 2: // Class
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;   // reset the checksum accumulators
+            ubx->step++;
+            ubx->msgClass = data;
+            ubx->ck_b = ubx->ck_a = data;   // reset the checksum accumulators
             break;
         case 3: // Id
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _msg_id = data;
+            ubx->step++;
+            ubx->ck_b += (ubx->ck_a += data);       // checksum byte
+            ubx->msgId = data;
             break;
         case 4: // Payload length (part 1)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length = data; // payload length low byte
+            ubx->step++;
+            ubx->ck_b += (ubx->ck_a += data);       // checksum byte
+            ubx->payloadLength = data; // payload length low byte
             break;
         case 5: // Payload length (part 2)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length |= (uint16_t)(data << 8);
-            if (_payload_length > MAX_UBLOX_PAYLOAD_SIZE ) {
+            ubx->step++;
+            ubx->ck_b += (ubx->ck_a += data);       // checksum byte
+            ubx->payloadLength |= (uint16_t)(data << 8);
+            if (ubx->payloadLength > MAX_UBLOX_PAYLOAD_SIZE ) {
                 // we can't receive the whole packet, just log the error and start searching for the next packet.
                 gpsStats.errors++;
-                _step = 0;
+                ubx->step = 0;
                 break;
             }
             // prepare to receive payload
-            _payload_counter = 0;
-            if (_payload_length == 0) {
-                _step = 7;
+            ubx->payloadCounter = 0;
+            if (ubx->payloadLength == 0) {
+                ubx->step = 7;
             }
             break;
         case 6:
-            _ck_b += (_ck_a += data);       // checksum byte
-            if (_payload_counter < MAX_UBLOX_PAYLOAD_SIZE) {
-                _buffer.bytes[_payload_counter] = data;
+            ubx->ck_b += (ubx->ck_a += data);       // checksum byte
+            if (ubx->payloadCounter < MAX_UBLOX_PAYLOAD_SIZE) {
+                ubx->buffer.bytes[ubx->payloadCounter] = data;
             }
             // NOTE: check counter BEFORE increasing so that a payload_size of 65535 is correctly handled.  This can happen if garbage data is received.
-            if (_payload_counter ==  _payload_length - 1) {
-                _step++;
+            if (ubx->payloadCounter ==  ubx->payloadLength - 1) {
+                ubx->step++;
             }
-            _payload_counter++;
+            ubx->payloadCounter++;
             break;
         case 7:
-            _step++;
-            if (_ck_a != data) {
-                _skip_packet = true;          // bad checksum
+            ubx->step++;
+            if (ubx->ck_a != data) {
+                ubx->skipPacket = true;          // bad checksum
                 gpsStats.errors++;
-                _step = 0;
+                ubx->step = 0;
             }
             break;
         case 8:
-            _step = 0;
+            ubx->step = 0;
 
-            if (_ck_b != data) {
+            if (ubx->ck_b != data) {
                 gpsStats.errors++;
                 break;              // bad checksum
             }
 
             gpsStats.packetCount++;
 
-            if (_skip_packet) {
+            if (ubx->skipPacket) {
                 break;
             }
 
@@ -816,7 +983,7 @@ static bool gpsNewFrameUBLOX(uint8_t data)
     return parsed;
 }
 
-STATIC_PROTOTHREAD(gpsConfigure)
+static void gpsConfigure(void)
 {
     ptBegin(gpsConfigure);
 
@@ -824,7 +991,7 @@ STATIC_PROTOTHREAD(gpsConfigure)
     gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
 
     // Set dynamic model
-    switch (gpsState.gpsConfig->dynModel) {
+    switch (gpsState->gpsConfig->dynModel) {
         case GPS_DYNMODEL_PEDESTRIAN:
             configureNAV5(UBX_DYNMODEL_PEDESTRIAN, UBX_FIXMODE_AUTO);
             break;
@@ -836,121 +1003,127 @@ STATIC_PROTOTHREAD(gpsConfigure)
             configureNAV5(UBX_DYNMODEL_AIR_4G, UBX_FIXMODE_AUTO);
             break;
     }
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     // Disable NMEA messages
     gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_GGA, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_GLL, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_GSA, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_GSV, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_RMC, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     configureMSG(MSG_CLASS_NMEA, MSG_NMEA_VGS, 0);
-    ptWait(_ack_state == UBX_ACK_GOT_ACK);
+    ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
     // Configure UBX binary messages
     gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
 
     // M9N & M10 does not support some of the UBX 6/7/8 messages, so we have to configure it using special sequence
-    if (gpsState.hwVersion >= UBX_HW_VERSION_UBLOX9) {
+    if (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX9) {
         configureMSG(MSG_CLASS_UBX, MSG_POSLLH, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_STATUS, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_VELNED, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_TIMEUTC, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_PVT, 1);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_NAV_SAT, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         configureMSG(MSG_CLASS_UBX, MSG_NAV_SIG, 0);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
         // u-Blox 9 receivers such as M9N can do 10Hz as well, but the number of used satellites will be restricted to 16.
         // Not mentioned in the datasheet
-        configureRATE(200);
-        ptWait(_ack_state == UBX_ACK_GOT_ACK);
+        // With only NAV-PVT enabled the link can carry up to 25Hz at 115200 baud
+        if (gpsState->gpsConfig->ubloxNavHz > 0) {
+            configureRATE(1000 / gpsState->gpsConfig->ubloxNavHz);
+        }
+        else {
+            configureRATE(200); // 5Hz
+        }
+        ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
     }
     else {
         // u-Blox 5/6/7/8 or unknown
         // u-Blox 7-8 support PVT
-        if (gpsState.hwVersion >= UBX_HW_VERSION_UBLOX7) {
+        if (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX7) {
             configureMSG(MSG_CLASS_UBX, MSG_POSLLH, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_STATUS, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_SOL, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_VELNED, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_TIMEUTC, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_PVT, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_SVINFO, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
-            if ((gpsState.gpsConfig->provider == GPS_UBLOX7PLUS) && (gpsState.hwVersion >= UBX_HW_VERSION_UBLOX7)) {
+            if ((gpsState->gpsConfig->provider == GPS_UBLOX7PLUS) && (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX7)) {
                 configureRATE(100); // 10Hz
             }
             else {
                 configureRATE(200); // 5Hz
             }
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
         }
         // u-Blox 5/6 doesn't support PVT, use legacy config
         // UNKNOWN also falls here, use as a last resort
         else {
             configureMSG(MSG_CLASS_UBX, MSG_POSLLH, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_STATUS, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_SOL, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_VELNED, 1);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             configureMSG(MSG_CLASS_UBX, MSG_TIMEUTC, 10);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             // This may fail on old UBLOX units, advance forward on both ACK and NAK
             configureMSG(MSG_CLASS_UBX, MSG_PVT, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK || _ack_state == UBX_ACK_GOT_NAK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK || ubx->ackState == UBX_ACK_GOT_NAK);
 
             configureMSG(MSG_CLASS_UBX, MSG_SVINFO, 0);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
 
             // Configure data rate to 5HZ
             configureRATE(200);
-            ptWait(_ack_state == UBX_ACK_GOT_ACK);
+            ptWait(ubx->ackState == UBX_ACK_GOT_ACK);
         }
     }
 
@@ -959,33 +1132,85 @@ STATIC_PROTOTHREAD(gpsConfigure)
     // however GPS would be functional. We are waiting for any response - ACK/NACK
     gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
     configureSBAS();
-    ptWaitTimeout((_ack_state == UBX_ACK_GOT_ACK || _ack_state == UBX_ACK_GOT_NAK), GPS_CFG_CMD_TIMEOUT_MS);
+    ptWaitTimeout((ubx->ackState == UBX_ACK_GOT_ACK || ubx->ackState == UBX_ACK_GOT_NAK), GPS_CFG_CMD_TIMEOUT_MS);
 
     // Configure GNSS for M8N and later
-    if (gpsState.hwVersion >= 80000) {
+    if (gpsState->hwVersion >= 80000) {
          gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
          configureGNSS();
-         ptWaitTimeout((_ack_state == UBX_ACK_GOT_ACK || _ack_state == UBX_ACK_GOT_NAK), GPS_CFG_CMD_TIMEOUT_MS);
+         ptWaitTimeout((ubx->ackState == UBX_ACK_GOT_ACK || ubx->ackState == UBX_ACK_GOT_NAK), GPS_CFG_CMD_TIMEOUT_MS);
     }
 
+    if (gpsState->gpsConfig->ubloxFastStart) {
+        // M9 has no AssistNow Autonomous, older hardware may NAK it
+        if (gpsState->hwVersion >= UBX_HW_VERSION_UBLOX7 && gpsState->hwVersion != UBX_HW_VERSION_UBLOX9) {
+            gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
+            configureAOP();
+            ptWaitTimeout((ubx->ackState == UBX_ACK_GOT_ACK || ubx->ackState == UBX_ACK_GOT_NAK), GPS_CFG_CMD_TIMEOUT_MS);
+        }
+
+        // Keep it all across power cycles and remember what was saved
+        gpsSetProtocolTimeout(GPS_SHORT_TIMEOUT);
+        saveConfigurationUBLOX();
+        ptWaitTimeout((ubx->ackState == UBX_ACK_GOT_ACK || ubx->ackState == UBX_ACK_GOT_NAK), GPS_CFG_SAVE_TIMEOUT_MS);
+        gpsFastStartSetConfigHash(ubx->ackState == UBX_ACK_GOT_ACK ? gpsConfigHashUBLOX() : 0);
+    }
+
+    ptEnd(0);
+}
+
+static void gpsDetectVersion(void)
+{
+    ptBegin(gpsDetectVersion);
+
+    // Reset protocol timeout
+    gpsSetProtocolTimeout(MAX(GPS_TIMEOUT, ((GPS_VERSION_RETRY_TIMES + 3) * GPS_CFG_CMD_TIMEOUT_MS)));
+
+    // Attempt to detect GPS hw version
+    gpsState->hwVersion = UBX_HW_VERSION_UNKNOWN;
+    gpsState->autoConfigStep = 0;
+
+    do {
+        pollVersion();
+        gpsState->autoConfigStep++;
+        ptWaitTimeout((gpsState->hwVersion != UBX_HW_VERSION_UNKNOWN), GPS_CFG_CMD_TIMEOUT_MS);
+    } while(gpsState->autoConfigStep < GPS_VERSION_RETRY_TIMES && gpsState->hwVersion == UBX_HW_VERSION_UNKNOWN);
+
     ptEnd(0);
 }
 
-static ptSemaphore_t semNewDataReady;
+// Hot start help for M8 and later, the receiver drops aiding it can't use
+static void gpsSendAidingUBLOX(void)
+{
+    const gpsLocation_t *lastPosition = &gpsFastStart()->lastPosition;
+    dateTime_t dt;
+
+    if (gpsState->hwVersion < UBX_HW_VERSION_UBLOX8) {
+        return;
+    }
 
-STATIC_PROTOTHREAD(gpsProtocolReceiverThread)
+    if (rtcGetDateTime(&dt)) {
+        sendTimeAidingUBLOX(&dt);
+    }
+
+    if (lastPosition->lat != 0 || lastPosition->lon != 0) {
+        sendPositionAidingUBLOX(lastPosition);
+    }
+}
+
+static void gpsProtocolReceiverThread(void)
 {
     ptBegin(gpsProtocolReceiverThread);
 
     while (1) {
         // Wait until there are bytes to consume
-        ptWait(serialRxBytesWaiting(gpsState.gpsPort));
+        ptWait(serialRxBytesWaiting(gpsState->gpsPort));
 
         // Consume bytes until buffer empty of until we have full message received
-        while (serialRxBytesWaiting(gpsState.gpsPort)) {
-            uint8_t newChar = serialRead(gpsState.gpsPort);
+        while (serialRxBytesWaiting(gpsState->gpsPort)) {
+            uint8_t newChar = serialRead(gpsState->gpsPort);
             if (gpsNewFrameUBLOX(newChar)) {
-                ptSemaphoreSignal(semNewDataReady);
+                ptSemaphoreSignal(ubx->semNewDataReady);
                 break;
             }
         }
@@ -994,65 +1219,72 @@ STATIC_PROTOTHREAD(gpsProtocolReceiverThread)
     ptEnd(0);
 }
 
-STATIC_PROTOTHREAD(gpsProtocolStateThread)
+static void gpsProtocolStateThread(void)
 {
     ptBegin(gpsProtocolStateThread);
 
-    // Change baud rate
-    if (gpsState.gpsConfig->autoBaud != GPS_AUTOBAUD_OFF) {
+    ubx->fastStartPending = false;
+
+    // A receiver that saved the last full configuration answers at the configured baud rate right away
+    if (gpsState->gpsConfig->ubloxFastStart && gpsState->gpsConfig->autoConfig && !ubx->fastStartFailed && gpsFastStart()->ubloxConfigHash[gpsState->index]) {
+        ptWait(isSerialTransmitBufferEmpty(gpsState->gpsPort));
+        serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->baudrateIndex]]);
+
+        ptSpawn(gpsDetectVersion);
+        ubx->fastStartPending = (gpsState->hwVersion != UBX_HW_VERSION_UNKNOWN) && (gpsFastStart()->ubloxConfigHash[gpsState->index] == gpsConfigHashUBLOX());
+    }
+
+    if (ubx->fastStartPending) {
+        // Nothing to change, skip baud rate switch and configuration
+    }
+    else if (gpsState->gpsConfig->autoBaud != GPS_AUTOBAUD_OFF) {
         //  0. Wait for TX buffer to be empty
-        ptWait(isSerialTransmitBufferEmpty(gpsState.gpsPort));
+        ptWait(isSerialTransmitBufferEmpty(gpsState->gpsPort));
 
         // Try sending baud rate switch command at all common baud rates
         gpsSetProtocolTimeout((GPS_BAUD_CHANGE_DELAY + 50) * (GPS_BAUDRATE_COUNT));
-        for (gpsState.autoBaudrateIndex = 0; gpsState.autoBaudrateIndex < GPS_BAUDRATE_COUNT; gpsState.autoBaudrateIndex++) {
+        for (gpsState->autoBaudrateIndex = 0; gpsState->autoBaudrateIndex < GPS_BAUDRATE_COUNT; gpsState->autoBaudrateIndex++) {
             // 2. Set serial port to baud rate and send an $UBX command to switch the baud rate specified by portConfig [baudrateIndex]
-            serialSetBaudRate(gpsState.gpsPort, baudRates[gpsToSerialBaudRate[gpsState.autoBaudrateIndex]]);
-            serialPrint(gpsState.gpsPort, baudInitDataNMEA[gpsState.baudrateIndex]);
+            serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->autoBaudrateIndex]]);
+            serialPrint(gpsState->gpsPort, baudInitDataNMEA[gpsState->baudrateIndex]);
 
             // 3. Wait for serial port to finish transmitting
-            ptWait(isSerialTransmitBufferEmpty(gpsState.gpsPort));
+            ptWait(isSerialTransmitBufferEmpty(gpsState->gpsPort));
 
             // 4. Extra wait to make sure GPS processed the command
             ptDelayMs(GPS_BAUD_CHANGE_DELAY);
         }
-        serialSetBaudRate(gpsState.gpsPort, baudRates[gpsToSerialBaudRate[gpsState.baudrateIndex]]);
+        serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->baudrateIndex]]);
     }
     else {
         // No auto baud - set port baud rate to [baudrateIndex]
         // Wait for TX buffer to be empty
-        ptWait(isSerialTransmitBufferEmpty(gpsState.gpsPort));
+        ptWait(isSerialTransmitBufferEmpty(gpsState->gpsPort));
 
         // Set baud rate and reset GPS timeout
-        serialSetBaudRate(gpsState.gpsPort, baudRates[gpsToSerialBaudRate[gpsState.baudrateIndex]]);
+        serialSetBaudRate(gpsState->gpsPort, baudRates[gpsToSerialBaudRate[gpsState->baudrateIndex]]);
     }
 
     // Configure GPS module if enabled
-    if (gpsState.gpsConfig->autoConfig) {
-        // Reset protocol timeout
-        gpsSetProtocolTimeout(MAX(GPS_TIMEOUT, ((GPS_VERSION_RETRY_TIMES + 3) * GPS_CFG_CMD_TIMEOUT_MS)));
-
-        // Attempt to detect GPS hw version
-        gpsState.hwVersion = UBX_HW_VERSION_UNKNOWN;
-        gpsState.autoConfigStep = 0;
-
-        do {
-            pollVersion();
-            gpsState.autoConfigStep++;
-            ptWaitTimeout((gpsState.hwVersion != UBX_HW_VERSION_UNKNOWN), GPS_CFG_CMD_TIMEOUT_MS);
-        } while(gpsState.autoConfigStep < GPS_VERSION_RETRY_TIMES && gpsState.hwVersion == UBX_HW_VERSION_UNKNOWN);
+    if (gpsState->gpsConfig->autoConfig && !ubx->fastStartPending) {
+        ptSpawn(gpsDetectVersion);
 
         // Configure GPS
         ptSpawn(gpsConfigure);
     }
 
+    if (gpsState->gpsConfig->autoConfig && gpsState->gpsConfig->ubloxFastStart) {
+        gpsSendAidingUBLOX();
+    }
+
     // GPS setup done, reset timeout
     gpsSetProtocolTimeout(GPS_TIMEOUT);
 
     // GPS is ready - execute the gpsProcessNewSolutionData() based on gpsProtocolReceiverThread semaphore
     while (1) {
-        ptSemaphoreWait(semNewDataReady);
+        ptSemaphoreWait(ubx->semNewDataReady);
         gpsProcessNewSolutionData();
+        ubx->fastStartPending = false;
     }
 
     ptEnd(0);
@@ -1060,13 +1292,22 @@ STATIC_PROTOTHREAD(gpsProtocolStateThread)
 
 void gpsRestartUBLOX(void)
 {
-    ptSemaphoreInit(semNewDataReady);
+    ubx = &ubloxReceivers[gpsState->index];
+
+    // The receiver did not keep its configuration after all
+    if (ubx->fastStartPending) {
+        ubx->fastStartFailed = true;
+    }
+
+    ptSemaphoreInit(ubx->semNewDataReady);
     ptRestart(ptGetHandle(gpsProtocolReceiverThread));
     ptRestart(ptGetHandle(gpsProtocolStateThread));
 }
 
 void gpsHandleUBLOX(void)
 {
+    ubx = &ubloxReceivers[gpsState->index];
+
     // Run the protocol threads
     gpsProtocolReceiverThread();
     gpsProtocolStateThread();
@@ -73,7 +73,7 @@
 #include "telemetry/telemetry.h"
 
 
-PG_REGISTER_WITH_RESET_FN(ledStripConfig_t, ledStripConfig, PG_LED_STRIP_CONFIG, 1);
+PG_REGISTER_WITH_RESET_FN(ledStripConfig_t, ledStripConfig, PG_LED_STRIP_CONFIG, 2);
 
 static bool ledStripInitialised = false;
 static bool ledStripEnabled = true;
@@ -152,6 +152,7 @@ void pgResetFn_ledStripConfig(ledStripConfig_t *instance)
     }
     memcpy_fn(&instance->modeColors, &defaultModeColors, sizeof(defaultModeColors));
     memcpy_fn(&instance->specialColors, &defaultSpecialColors, sizeof(defaultSpecialColors));
+    instance->ledstrip_gamma = SETTING_LEDSTRIP_GAMMA_DEFAULT;
 }
 
 static int scaledThrottle;
@@ -930,7 +931,7 @@ static applyLayerFn_timed* layerTable[timTimerCount] = {
 
 void ledStripUpdate(timeUs_t currentTimeUs)
 {
-    if (!(ledStripInitialised && isWS2811LedStripReady())) {
+    if (!ledStripInitialised) {
         return;
     }
 
@@ -957,8 +958,11 @@ void ledStripUpdate(timeUs_t currentTimeUs)
         }
     }
 
-    if (!timActive)
-        return;          // no change this update, keep old state
+    if (!timActive) {
+        // no change this update, keep old state but send a frame that waited for DMA
+        ws2811UpdateStrip();
+        return;
+    }
 
     // apply all layers; triggered timed functions has to update timers
 
@@ -1052,6 +1056,7 @@ void ledStripEnable(void)
     reevaluateLedConfig();
     ledStripInitialised = true;
 
+    ws2811LedStripSetGammaCorrection(ledStripConfig()->ledstrip_gamma);
     ws2811LedStripInit();
 }
 
@@ -159,6 +159,7 @@ typedef struct ledStripConfig_s {
     modeColorIndexes_t modeColors[LED_MODE_COUNT];
     specialColorIndexes_t specialColors;
     uint8_t ledstrip_visual_beeper; // suppress LEDLOW mode if beeper is on
+    uint8_t ledstrip_gamma;         // apply gamma correction to the LED output
 } ledStripConfig_t;
 
 PG_DECLARE(ledStripConfig_t, ledStripConfig);
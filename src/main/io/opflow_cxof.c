@@ -110,6 +110,7 @@ static bool cxofOpflowUpdate(opflowData_t * data)
 
                 if (pkt->header == 0xFE && pkt->footer == 0xAA) {
                     // Valid packet
+                    tmpData.sampleTimeUs = currentTimeUs;
                     tmpData.deltaTime += (currentTimeUs - previousTimeUs);
                     tmpData.flowRateRaw[0] += pkt->motionX;
                     tmpData.flowRateRaw[1] += pkt->motionY;
@@ -36,6 +36,7 @@ FILE_COMPILE_FOR_SPEED
 #ifdef USE_OSD
 
 #include "build/debug.h"
+#include "build/profiling.h"
 #include "build/version.h"
 
 #include "cms/cms.h"
@@ -89,6 +90,7 @@ FILE_COMPILE_FOR_SPEED
 #include "flight/rth_estimator.h"
 #include "flight/secondary_imu.h"
 #include "flight/servos.h"
+#include "flight/telemetry_snapshot.h"
 #include "flight/wind_estimator.h"
 
 #include "navigation/navigation.h"
@@ -127,7 +129,6 @@ FILE_COMPILE_FOR_SPEED
 #define ARMED_SCREEN_DISPLAY_TIME 1500 // ms
 #define STATS_SCREEN_DISPLAY_TIME 60000 // ms
 
-#define EFFICIENCY_UPDATE_INTERVAL (5 * 1000)
 
 // Adjust OSD_MESSAGE's default position when
 // changing OSD_MESSAGE_LENGTH
@@ -148,6 +149,21 @@ FILE_COMPILE_FOR_SPEED
 
 #define OSD_MIN_FONT_VERSION 3
 
+// Elements drawn per refresh are limited by time and count, the count
+// keeps displayports that send every write right away from flooding
+// their serial port
+#define OSD_REFRESH_TIME_BUDGET_US  300
+#define OSD_REFRESH_MAX_ELEMENTS    4
+
+// How often an element needs to be redrawn, fast elements track the
+// attitude and the sticks, slow ones mostly show settings
+typedef enum {
+    OSD_ELEMENT_RATE_FAST = 0,
+    OSD_ELEMENT_RATE_NORMAL,
+    OSD_ELEMENT_RATE_SLOW,
+    OSD_ELEMENT_RATE_COUNT
+} osdElementRate_e;
+
 static unsigned currentLayout = 0;
 static int layoutOverride = -1;
 static bool hasExtendedFont = false; // Wether the font supports characters > 256
@@ -175,6 +191,10 @@ static timeUs_t resumeRefreshAt = 0;
 static bool refreshWaitForResumeCmdRelease;
 
 static bool fullRedraw = false;
+static uint8_t renderList[OSD_ITEM_COUNT];
+static uint8_t renderListStart[OSD_ELEMENT_RATE_COUNT];
+static uint8_t renderListLength[OSD_ELEMENT_RATE_COUNT];
+static bool renderListValid = false;
 
 static uint8_t armState;
 static uint8_t statsPagesCheck = 0;
@@ -200,19 +220,6 @@ static bool osdDisplayHasCanvas;
 PG_REGISTER_WITH_RESET_TEMPLATE(osdConfig_t, osdConfig, PG_OSD_CONFIG, 7);
 PG_REGISTER_WITH_RESET_FN(osdLayoutsConfig_t, osdLayoutsConfig, PG_OSD_LAYOUTS_CONFIG, 1);
 
-static int digitCount(int32_t value)
-{
-    int digits = 1;
-    while(1) {
-        value = value / 10;
-        if (value == 0) {
-            break;
-        }
-        digits++;
-    }
-    return digits;
-}
-
 bool osdDisplayIsPAL(void)
 {
     return displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL;
@@ -223,88 +230,6 @@ bool osdDisplayIsHD(void)
     return displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_HD;
 }
 
-/**
- * Formats a number given in cents, to support non integer values
- * without using floating point math. Value is always right aligned
- * and spaces are inserted before the number to always yield a string
- * of the same length. If the value doesn't fit into the provided length
- * it will be divided by scale and true will be returned.
- */
-bool osdFormatCentiNumber(char *buff, int32_t centivalue, uint32_t scale, int maxDecimals, int maxScaledDecimals, int length)
-{
-    char *ptr = buff;
-    char *dec;
-    int decimals = maxDecimals;
-    bool negative = false;
-    bool scaled = false;
-
-    buff[length] = '\0';
-
-    if (centivalue < 0) {
-        negative = true;
-        centivalue = -centivalue;
-        length--;
-    }
-
-    int32_t integerPart = centivalue / 100;
-    // 3 decimal digits
-    int32_t millis = (centivalue % 100) * 10;
-
-    int digits = digitCount(integerPart);
-    int remaining = length - digits;
-
-    if (remaining < 0 && scale > 0) {
-        // Reduce by scale
-        scaled = true;
-        decimals = maxScaledDecimals;
-        integerPart = integerPart / scale;
-        // Multiply by 10 to get 3 decimal digits
-        millis = ((centivalue % (100 * scale)) * 10) / scale;
-        digits = digitCount(integerPart);
-        remaining = length - digits;
-    }
-
-    // 3 decimals at most
-    decimals = MIN(remaining, MIN(decimals, 3));
-    remaining -= decimals;
-
-    // Done counting. Time to write the characters.
-
-    // Write spaces at the start
-    while (remaining > 0) {
-        *ptr = SYM_BLANK;
-        ptr++;
-        remaining--;
-    }
-
-    // Write the minus sign if required
-    if (negative) {
-        *ptr = '-';
-        ptr++;
-    }
-    // Now write the digits.
-    ui2a(integerPart, 10, 0, ptr);
-    ptr += digits;
-    if (decimals > 0) {
-        *(ptr-1) += SYM_ZERO_HALF_TRAILING_DOT - '0';
-        dec = ptr;
-        int factor = 3; // we're getting the decimal part in millis first
-        while (decimals < factor) {
-            factor--;
-            millis /= 10;
-        }
-        int decimalDigits = digitCount(millis);
-        while (decimalDigits < decimals) {
-            decimalDigits++;
-            *ptr = '0';
-            ptr++;
-        }
-        ui2a(millis, 10, 0, ptr);
-        *dec += SYM_ZERO_HALF_LEADING_DOT - '0';
-    }
-    return scaled;
-}
-
 /*
  * Aligns text to the left side. Adds spaces at the end to keep string length unchanged.
  */
@@ -322,6 +247,32 @@ static void osdLeftAlignString(char *buff)
  * prefixed by a a symbol to indicate the unit used.
  * @param dist Distance in centimeters
  */
+/*
+ * Fast paths for the number formats of the elements drawn on every refresh,
+ * they write into the element buffer without going through format parsing.
+ * Same output as tfp_sprintf(buff, "%<width>d%c", value, sym), no symbol for sym 0
+ */
+static int osdFormatIntSymbol(char *buff, int value, int width, char sym)
+{
+    int length = i2aPadded(value, width, ' ', buff);
+    if (sym) {
+        buff[length++] = sym;
+    }
+    buff[length] = '\0';
+    return length;
+}
+
+// Same as tfp_sprintf(buff, "%d.%02d%c", integerPart, hundredths, sym)
+static int osdFormatFixedTwoDecimalsSymbol(char *buff, int integerPart, int hundredths, char sym)
+{
+    int length = i2aPadded(integerPart, 0, ' ', buff);
+    buff[length++] = '.';
+    length += i2aPadded(hundredths, 2, '0', buff + length);
+    buff[length++] = sym;
+    buff[length] = '\0';
+    return length;
+}
+
 static void osdFormatDistanceSymbol(char *buff, int32_t dist, uint8_t decimals)
 {
     switch ((osd_unit_e)osdConfig()->units) {
@@ -370,10 +321,10 @@ static void osdFormatDistanceStr(char *buff, int32_t dist)
         centifeet = CENTIMETERS_TO_CENTIFEET(dist);
         if (abs(centifeet) < FEET_PER_MILE * 100 / 2) {
             // Show feet when dist < 0.5mi
-            tfp_sprintf(buff, "%d%c", (int)(centifeet / 100), SYM_FT);
+            osdFormatIntSymbol(buff, centifeet / 100, 0, SYM_FT);
         } else {
             // Show miles when dist >= 0.5mi
-            tfp_sprintf(buff, "%d.%02d%c", (int)(centifeet / (100*FEET_PER_MILE)),
+            osdFormatFixedTwoDecimalsSymbol(buff, centifeet / (100*FEET_PER_MILE),
                 (abs(centifeet) % (100 * FEET_PER_MILE)) / FEET_PER_MILE, SYM_MI);
         }
         break;
@@ -382,10 +333,10 @@ static void osdFormatDistanceStr(char *buff, int32_t dist)
     case OSD_UNIT_METRIC:
         if (abs(dist) < METERS_PER_KILOMETER * 100) {
             // Show meters when dist < 1km
-            tfp_sprintf(buff, "%d%c", (int)(dist / 100), SYM_M);
+            osdFormatIntSymbol(buff, dist / 100, 0, SYM_M);
         } else {
             // Show kilometers when dist >= 1km
-            tfp_sprintf(buff, "%d.%02d%c", (int)(dist / (100*METERS_PER_KILOMETER)),
+            osdFormatFixedTwoDecimalsSymbol(buff, dist / (100*METERS_PER_KILOMETER),
                 (abs(dist) % (100 * METERS_PER_KILOMETER)) / METERS_PER_KILOMETER, SYM_KM);
         }
         break;
@@ -393,38 +344,16 @@ static void osdFormatDistanceStr(char *buff, int32_t dist)
          centifeet = CENTIMETERS_TO_CENTIFEET(dist);
         if (abs(centifeet) < 100000) {
             // Show feet when dist < 1000ft
-            tfp_sprintf(buff, "%d%c", (int)(centifeet / 100), SYM_FT);
+            osdFormatIntSymbol(buff, centifeet / 100, 0, SYM_FT);
         } else {
             // Show nautical miles when dist >= 1000ft
-            tfp_sprintf(buff, "%d.%02d%c", (int)(centifeet / (100 * FEET_PER_NAUTICALMILE)),
+            osdFormatFixedTwoDecimalsSymbol(buff, centifeet / (100 * FEET_PER_NAUTICALMILE),
                 (int)((abs(centifeet) % (int)(100 * FEET_PER_NAUTICALMILE)) / FEET_PER_NAUTICALMILE), SYM_NM);
         }
         break;
     }
 }
 
-/**
- * Converts velocity based on the current unit system (kmh or mph).
- * @param alt Raw velocity (i.e. as taken from gpsSol.groundSpeed in centimeters/second)
- */
-static int32_t osdConvertVelocityToUnit(int32_t vel)
-{
-    switch ((osd_unit_e)osdConfig()->units) {
-    case OSD_UNIT_UK:
-        FALLTHROUGH;
-    case OSD_UNIT_METRIC_MPH:
-        FALLTHROUGH;
-    case OSD_UNIT_IMPERIAL:
-        return CMSEC_TO_CENTIMPH(vel) / 100; // Convert to mph
-    case OSD_UNIT_METRIC:
-        return CMSEC_TO_CENTIKPH(vel) / 100;   // Convert to kmh
-    case OSD_UNIT_GA:
-        return CMSEC_TO_CENTIKNOTS(vel) / 100; // Convert to Knots
-    }
-    // Unreachable
-    return -1;
-}
-
 /**
  * Converts velocity into a string based on the current unit system.
  * @param vel Raw velocity (i.e. as taken from gpsSol.groundSpeed in centimeters/seconds)
@@ -433,33 +362,28 @@ static int32_t osdConvertVelocityToUnit(int32_t vel)
  */
 void osdFormatVelocityStr(char* buff, int32_t vel, bool _3D, bool _max)
 {
+    char sym = 0;
+
     switch ((osd_unit_e)osdConfig()->units) {
     case OSD_UNIT_UK:
         FALLTHROUGH;
     case OSD_UNIT_METRIC_MPH:
         FALLTHROUGH;
     case OSD_UNIT_IMPERIAL:
-        if (_max) {
-            tfp_sprintf(buff, "%c%3d%c", SYM_MAX, (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_MPH : SYM_MPH));
-        } else {
-            tfp_sprintf(buff, "%3d%c", (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_MPH : SYM_MPH));
-        }
+        sym = _3D ? SYM_3D_MPH : SYM_MPH;
         break;
     case OSD_UNIT_METRIC:
-        if (_max) {
-            tfp_sprintf(buff, "%c%3d%c", SYM_MAX, (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_KMH : SYM_KMH));
-        } else {
-            tfp_sprintf(buff, "%3d%c", (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_KMH : SYM_KMH));
-        }
+        sym = _3D ? SYM_3D_KMH : SYM_KMH;
         break;
     case OSD_UNIT_GA:
-        if (_max) {
-            tfp_sprintf(buff, "%c%3d%c", SYM_MAX, (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_KT : SYM_KT));
-        } else {
-            tfp_sprintf(buff, "%3d%c", (int)osdConvertVelocityToUnit(vel), (_3D ? SYM_3D_KT : SYM_KT));
-        }
+        sym = _3D ? SYM_3D_KT : SYM_KT;
         break;
     }
+
+    if (_max) {
+        *buff++ = SYM_MAX;
+    }
+    osdFormatIntSymbol(buff, osdConvertVelocityToUnit(vel), 3, sym);
 }
 
 /**
@@ -569,13 +493,13 @@ static void osdFormatAltitudeStr(char *buff, int32_t alt)
             FALLTHROUGH;
         case OSD_UNIT_IMPERIAL:
             value = CENTIMETERS_TO_FEET(alt);
-            tfp_sprintf(buff, "%d%c", (int)value, SYM_FT);
+            osdFormatIntSymbol(buff, value, 0, SYM_FT);
             break;
         case OSD_UNIT_METRIC_MPH:
             FALLTHROUGH;
         case OSD_UNIT_METRIC:
             value = CENTIMETERS_TO_METERS(alt);
-            tfp_sprintf(buff, "%d%c", (int)value, SYM_M);
+            osdFormatIntSymbol(buff, value, 0, SYM_M);
             break;
     }
 }
@@ -590,7 +514,10 @@ static void osdFormatTime(char *buff, uint32_t seconds, char sym_m, char sym_h)
         value = seconds / 60;
     }
     buff[0] = sym;
-    tfp_sprintf(buff + 1, "%02d:%02d", (int)(value / 60), (int)(value % 60));
+    int length = 1 + i2aPadded(value / 60, 2, '0', buff + 1);
+    buff[length++] = ':';
+    length += i2aPadded(value % 60, 2, '0', buff + length);
+    buff[length] = '\0';
 }
 
 static inline void osdFormatOnTime(char *buff)
@@ -698,6 +625,15 @@ static void osdDisplayTemperatureSensor(uint8_t elemPosX, uint8_t elemPosY, uint
 }
 #endif
 
+typedef struct {
+    int32_t val;
+    uint8_t digits;         // coordinate_digits of str, 0 before the first use
+    char str[13];           // Symbol, up to 4 integer and 7 decimal digits
+} osdCoordinateCache_t;
+
+static osdCoordinateCache_t osdLatCache;
+static osdCoordinateCache_t osdLonCache;
+
 static void osdFormatCoordinate(char *buff, char sym, int32_t val)
 {
     // up to 4 for number + 1 for the symbol + null terminator + fill the rest with decimals
@@ -724,6 +660,17 @@ static void osdFormatCoordinate(char *buff, char sym, int32_t val)
     buff[coordinateLength] = '\0';
 }
 
+// The string only changes with a new GPS solution, while the OSD redraws it far more often
+static void osdFormatCoordinateCached(char *buff, char sym, int32_t val, osdCoordinateCache_t *cache)
+{
+    if (cache->digits != osdConfig()->coordinate_digits || cache->val != val) {
+        osdFormatCoordinate(cache->str, sym, val);
+        cache->digits = osdConfig()->coordinate_digits;
+        cache->val = val;
+    }
+    strcpy(buff, cache->str);
+}
+
 static void osdFormatCraftName(char *buff)
 {
     if (strlen(systemConfig()->name) == 0)
@@ -1026,7 +973,7 @@ static void osdFormatThrottlePosition(char *buff, bool autoThr, textAttributes_t
         TEXT_ATTRIBUTES_ADD_BLINK(*elemAttr);
     }
 #endif
-    tfp_sprintf(buff + 2, "%3d", getThrottlePercent());
+    osdFormatIntSymbol(buff + 2, getThrottlePercent(), 3, 0);
 }
 
 /**
@@ -1231,8 +1178,8 @@ static void osdDrawMap(int referenceHeading, uint16_t referenceSym, uint16_t cen
 
         int directionToPoi = osdGetHeadingAngle(poiDirection - referenceHeading);
         float poiAngle = DEGREES_TO_RADIANS(directionToPoi);
-        float poiSin = sin_approx(poiAngle);
-        float poiCos = cos_approx(poiAngle);
+        float poiSin, poiCos;
+        sincos_approx(poiAngle, &poiSin, &poiCos);
 
         // Now start looking for a valid scale that lets us draw everything
         int ii;
@@ -1578,7 +1525,7 @@ static bool osdDrawSingleElement(uint8_t item)
         {
             uint16_t osdRssi = osdConvertRSSI();
             buff[0] = SYM_RSSI;
-            tfp_sprintf(buff + 1, "%2d", osdRssi);
+            osdFormatIntSymbol(buff + 1, osdRssi, 2, 0);
             if (osdRssi < osdConfig()->rssi_alarm) {
                 TEXT_ATTRIBUTES_ADD_BLINK(elemAttr);
             }
@@ -1661,7 +1608,7 @@ static bool osdDrawSingleElement(uint8_t item)
     case OSD_GPS_SATS:
         buff[0] = SYM_SAT_L;
         buff[1] = SYM_SAT_R;
-        tfp_sprintf(buff + 2, "%2d", gpsSol.numSat);
+        osdFormatIntSymbol(buff + 2, gpsSol.numSat, 2, 0);
         if (!STATE(GPS_FIX)) {
             if (getHwGPSStatus() == HW_SENSOR_UNAVAILABLE || getHwGPSStatus() == HW_SENSOR_UNHEALTHY) {
                 strcpy(buff + 2, "X!");
@@ -1708,11 +1655,11 @@ static bool osdDrawSingleElement(uint8_t item)
         }
 
     case OSD_GPS_LAT:
-        osdFormatCoordinate(buff, SYM_LAT, gpsSol.llh.lat);
+        osdFormatCoordinateCached(buff, SYM_LAT, gpsSol.llh.lat, &osdLatCache);
         break;
 
     case OSD_GPS_LON:
-        osdFormatCoordinate(buff, SYM_LON, gpsSol.llh.lon);
+        osdFormatCoordinateCached(buff, SYM_LON, gpsSol.llh.lon, &osdLonCache);
         break;
 
     case OSD_HOME_DIR:
@@ -1748,7 +1695,7 @@ static bool osdDrawSingleElement(uint8_t item)
 
             if (isImuHeadingValid() && navigationPositionEstimateIsHealthy()) {
                 int16_t h = lrintf(CENTIDEGREES_TO_DEGREES((float)wrap_18000(DEGREES_TO_CENTIDEGREES((int32_t)GPS_directionToHome) - DECIDEGREES_TO_CENTIDEGREES((int32_t)osdGetHeading()))));
-                tfp_sprintf(buff + 2, "%4d", h);
+                osdFormatIntSymbol(buff + 2, h, 4, 0);
             } else {
                 strcpy(buff + 2, "----");
             }
@@ -1807,7 +1754,7 @@ static bool osdDrawSingleElement(uint8_t item)
                 if (ABS(herr) > 99)
                     strcpy(buff + 1, ">99");
                 else
-                    tfp_sprintf(buff + 1, "%3d", herr);
+                    osdFormatIntSymbol(buff + 1, herr, 3, 0);
             }
 
             buff[4] = SYM_DEGREES;
@@ -1829,7 +1776,7 @@ static bool osdDrawSingleElement(uint8_t item)
             if (!ARMING_FLAG(ARMED)) {
                 buff[1] = buff[2] = buff[3] = buff[4] = '-';
             } else if (FLIGHT_MODE(NAV_COURSE_HOLD_MODE)) {
-                tfp_sprintf(buff + 1, "%4d", heading_adjust);
+                osdFormatIntSymbol(buff + 1, heading_adjust, 4, 0);
             }
 
             buff[5] = SYM_DEGREES;
@@ -1927,26 +1874,17 @@ static bool osdDrawSingleElement(uint8_t item)
 
     case OSD_REMAINING_FLIGHT_TIME_BEFORE_RTH:
         {
-            /*static int32_t updatedTimeSeconds = 0;*/
-            static int32_t timeSeconds = -1;
+            int32_t timeSeconds = -1;
 #if defined(USE_ADC) && defined(USE_GPS)
-            static timeUs_t updatedTimestamp = 0;
-            timeUs_t currentTimeUs = micros();
-            if (cmpTimeUs(currentTimeUs, updatedTimestamp) >= MS2US(1000)) {
 #ifdef USE_WIND_ESTIMATOR
-                timeSeconds = calculateRemainingFlightTimeBeforeRTH(osdConfig()->estimations_wind_compensation);
+            timeSeconds = getRemainingFlightTimeBeforeRTH(osdConfig()->estimations_wind_compensation);
 #else
-                timeSeconds = calculateRemainingFlightTimeBeforeRTH(false);
+            timeSeconds = getRemainingFlightTimeBeforeRTH(false);
 #endif
-                updatedTimestamp = currentTimeUs;
-            }
 #endif
             if ((!ARMING_FLAG(ARMED)) || (timeSeconds == -1)) {
                 buff[0] = SYM_FLY_M;
                 strcpy(buff + 1, "--:--");
-#if defined(USE_ADC) && defined(USE_GPS)
-                updatedTimestamp = 0;
-#endif
             } else if (timeSeconds == -2) {
                 // Wind is too strong to come back with cruise throttle
                 buff[0] = SYM_FLY_M;
@@ -1963,18 +1901,13 @@ static bool osdDrawSingleElement(uint8_t item)
         break;
 
     case OSD_REMAINING_DISTANCE_BEFORE_RTH:;
-        static int32_t distanceMeters = -1;
+        int32_t distanceMeters = -1;
 #if defined(USE_ADC) && defined(USE_GPS)
-        static timeUs_t updatedTimestamp = 0;
-        timeUs_t currentTimeUs = micros();
-        if (cmpTimeUs(currentTimeUs, updatedTimestamp) >= MS2US(1000)) {
 #ifdef USE_WIND_ESTIMATOR
-            distanceMeters = calculateRemainingDistanceBeforeRTH(osdConfig()->estimations_wind_compensation);
+        distanceMeters = getRemainingDistanceBeforeRTH(osdConfig()->estimations_wind_compensation);
 #else
-            distanceMeters = calculateRemainingDistanceBeforeRTH(false);
+        distanceMeters = getRemainingDistanceBeforeRTH(false);
 #endif
-            updatedTimestamp = currentTimeUs;
-        }
 #endif
         buff[0] = SYM_TRIP_DIST;
         if ((!ARMING_FLAG(ARMED)) || (distanceMeters == -1)) {
@@ -2088,7 +2021,7 @@ static bool osdDrawSingleElement(uint8_t item)
             int16_t rssi = rxLinkStatistics.uplinkRSSI;
             buff[0] = (rxLinkStatistics.activeAntenna == 0) ? SYM_RSSI : SYM_2RSS; // Separate symbols for each antenna
             if (rssi <= -100) {
-                tfp_sprintf(buff + 1, "%4d%c", rssi, SYM_DBM);
+                osdFormatIntSymbol(buff + 1, rssi, 4, SYM_DBM);
             } else {
                 tfp_sprintf(buff + 1, "%3d%c%c", rssi, SYM_DBM, ' ');
             }
@@ -2155,7 +2088,7 @@ static bool osdDrawSingleElement(uint8_t item)
             } else if (snrFiltered <= osdConfig()->snr_alarm) {
                 buff[0] = SYM_SNR;
                 if (snrFiltered <= -10) {
-                    tfp_sprintf(buff + 1, "%3d%c", snrFiltered, SYM_DB);
+                    osdFormatIntSymbol(buff + 1, snrFiltered, 3, SYM_DB);
                 } else {
                     tfp_sprintf(buff + 1, "%2d%c%c", snrFiltered, SYM_DB, ' ');
                 }
@@ -2168,7 +2101,7 @@ static bool osdDrawSingleElement(uint8_t item)
             if (!failsafeIsReceivingRxData())
                 tfp_sprintf(buff, "%s%c", "    ", SYM_BLANK);
             else
-                tfp_sprintf(buff, "%4d%c", rxLinkStatistics.uplinkTXPower, SYM_MW);
+                osdFormatIntSymbol(buff, rxLinkStatistics.uplinkTXPower, 4, SYM_MW);
             break;
         }
 #endif
@@ -2197,17 +2130,10 @@ static bool osdDrawSingleElement(uint8_t item)
             // -------- POI : Nearby aircrafts from ESP32 radar
 
             if (osdConfig()->hud_radar_disp > 0) { // Display the POI from the radar
+                radarUpdatePois(osdGetAltitudeMsl());
                 for (uint8_t i = 0; i < osdConfig()->hud_radar_disp; i++) {
-                    if (radar_pois[i].gps.lat != 0 && radar_pois[i].gps.lon != 0 && radar_pois[i].state < 2) { // state 2 means POI has been lost and must be skipped
-                        fpVector3_t poi;
-                        geoConvertGeodeticToLocal(&poi, &posControl.gpsOrigin, &radar_pois[i].gps, GEO_ALT_RELATIVE);
-                        radar_pois[i].distance = calculateDistanceToDestination(&poi) / 100; // In meters
-
-                        if (radar_pois[i].distance >= osdConfig()->hud_radar_range_min && radar_pois[i].distance <= osdConfig()->hud_radar_range_max) {
-                            radar_pois[i].direction = calculateBearingToDestination(&poi) / 100; // In °
-                            radar_pois[i].altitude = (radar_pois[i].gps.alt - osdGetAltitudeMsl()) / 100;
-                            osdHudDrawPoi(radar_pois[i].distance, osdGetHeadingAngle(radar_pois[i].direction), radar_pois[i].altitude, 1, 65 + i, radar_pois[i].heading, radar_pois[i].lq);
-                        }
+                    if (radar_pois[i].inRange) {
+                        osdHudDrawPoi(radar_pois[i].distance, osdGetHeadingAngle(radar_pois[i].direction), radar_pois[i].altitude, 1, 65 + i, radar_pois[i].heading, radar_pois[i].lq);
                     }
                 }
             }
@@ -2335,24 +2261,10 @@ static bool osdDrawSingleElement(uint8_t item)
         }
     case OSD_CLIMB_EFFICIENCY:
         {
-            // amperage is in centi amps (10mA), vertical speed is in cms/s. We want
             // Ah/dist only to show when vertical speed > 1m/s.
-            static pt1Filter_t veFilterState;
-            static timeUs_t vEfficiencyUpdated = 0;
-            int32_t value = 0;
-            timeUs_t currentTimeUs = micros();
-            timeDelta_t vEfficiencyTimeDelta = cmpTimeUs(currentTimeUs, vEfficiencyUpdated);
-            if (getEstimatedActualVelocity(Z) > 0) {
-                if (vEfficiencyTimeDelta >= EFFICIENCY_UPDATE_INTERVAL) {
-                                                            // Centiamps (kept for osdFormatCentiNumber) / m/s - Will appear as A / m/s in OSD
-                    value = pt1FilterApply4(&veFilterState, (float)getAmperage() / (getEstimatedActualVelocity(Z) / 100.0f), 1, US2S(vEfficiencyTimeDelta));
-
-                    vEfficiencyUpdated = currentTimeUs;
-                } else {
-                    value = veFilterState.state;
-                }
-            }
-            bool efficiencyValid = (value > 0) && (getEstimatedActualVelocity(Z) > 100);
+            // Centiamps (kept for osdFormatCentiNumber) / m/s - Will appear as A / m/s in OSD
+            const int32_t value = telemetrySnapshot.climbEfficiency;
+            bool efficiencyValid = (value > 0) && (telemetrySnapshot.climbRate > 100);
             switch (osdConfig()->units) {
                 case OSD_UNIT_UK:
                     FALLTHROUGH;
@@ -2714,25 +2626,10 @@ static bool osdDrawSingleElement(uint8_t item)
 
     case OSD_EFFICIENCY_MAH_PER_KM:
         {
-            // amperage is in centi amps, speed is in cms/s. We want
             // mah/km. Only show when ground speed > 1m/s.
-            static pt1Filter_t eFilterState;
-            static timeUs_t efficiencyUpdated = 0;
-            int32_t value = 0;
+            const int32_t value = telemetrySnapshot.mAhPerKm;
             bool moreThanAh = false;
-            timeUs_t currentTimeUs = micros();
-            timeDelta_t efficiencyTimeDelta = cmpTimeUs(currentTimeUs, efficiencyUpdated);
-            if (STATE(GPS_FIX) && gpsSol.groundSpeed > 0) {
-                if (efficiencyTimeDelta >= EFFICIENCY_UPDATE_INTERVAL) {
-                    value = pt1FilterApply4(&eFilterState, ((float)getAmperage() / gpsSol.groundSpeed) / 0.0036f,
-                        1, US2S(efficiencyTimeDelta));
-
-                    efficiencyUpdated = currentTimeUs;
-                } else {
-                    value = eFilterState.state;
-                }
-            }
-            bool efficiencyValid = (value > 0) && (gpsSol.groundSpeed > 100);
+            bool efficiencyValid = (value > 0) && (telemetrySnapshot.groundSpeed > 100);
             switch (osdConfig()->units) {
                 case OSD_UNIT_UK:
                     FALLTHROUGH;
@@ -2786,24 +2683,9 @@ static bool osdDrawSingleElement(uint8_t item)
 
     case OSD_EFFICIENCY_WH_PER_KM:
         {
-            // amperage is in centi amps, speed is in cms/s. We want
             // mWh/km. Only show when ground speed > 1m/s.
-            static pt1Filter_t eFilterState;
-            static timeUs_t efficiencyUpdated = 0;
-            int32_t value = 0;
-            timeUs_t currentTimeUs = micros();
-            timeDelta_t efficiencyTimeDelta = cmpTimeUs(currentTimeUs, efficiencyUpdated);
-            if (STATE(GPS_FIX) && gpsSol.groundSpeed > 0) {
-                if (efficiencyTimeDelta >= EFFICIENCY_UPDATE_INTERVAL) {
-                    value = pt1FilterApply4(&eFilterState, ((float)getPower() / gpsSol.groundSpeed) / 0.0036f,
-                        1, US2S(efficiencyTimeDelta));
-
-                    efficiencyUpdated = currentTimeUs;
-                } else {
-                    value = eFilterState.state;
-                }
-            }
-            bool efficiencyValid = (value > 0) && (gpsSol.groundSpeed > 100);
+            const int32_t value = telemetrySnapshot.mWhPerKm;
+            bool efficiencyValid = (value > 0) && (telemetrySnapshot.groundSpeed > 100);
             switch (osdConfig()->units) {
                 case OSD_UNIT_UK:
                     FALLTHROUGH;
@@ -2955,7 +2837,7 @@ static bool osdDrawSingleElement(uint8_t item)
             int digits = osdConfig()->plus_code_digits;
             int digitsRemoved = osdConfig()->plus_code_short * 2;
             if (STATE(GPS_FIX)) {
-                olc_encode(gpsSol.llh.lat, gpsSol.llh.lon, digits, buff, sizeof(buff));
+                olc_encode_cached(gpsSol.llh.lat, gpsSol.llh.lon, digits, buff, sizeof(buff));
             } else {
                 // +codes with > 8 digits have a + at the 9th digit
                 // and we only support 10 and up.
@@ -3313,21 +3195,185 @@ static uint8_t osdIncElementIndex(uint8_t elementIndex)
     return elementIndex;
 }
 
+static osdElementRate_e osdElementRate(uint8_t item)
+{
+    switch (item) {
+        case OSD_HORIZON_SIDEBARS:
+        case OSD_THROTTLE_POS:
+        case OSD_THROTTLE_POS_AUTO_THR:
+        case OSD_CURRENT_DRAW:
+        case OSD_POWER:
+        case OSD_GPS_SPEED:
+        case OSD_3D_SPEED:
+        case OSD_AIR_SPEED:
+        case OSD_ALTITUDE:
+        case OSD_ALTITUDE_MSL:
+        case OSD_VARIO:
+        case OSD_VARIO_NUM:
+        case OSD_HEADING:
+        case OSD_HEADING_GRAPH:
+        case OSD_HOME_DIR:
+        case OSD_ATTITUDE_PITCH:
+        case OSD_ATTITUDE_ROLL:
+        case OSD_GFORCE:
+        case OSD_GFORCE_X:
+        case OSD_GFORCE_Y:
+        case OSD_GFORCE_Z:
+        case OSD_RANGEFINDER:
+        case OSD_DEBUG:
+            return OSD_ELEMENT_RATE_FAST;
+        case OSD_CRAFT_NAME:
+        case OSD_VTX_CHANNEL:
+        case OSD_VTX_POWER:
+        case OSD_GPS_HDOP:
+        case OSD_GPS_SATS:
+        case OSD_ROLL_PIDS:
+        case OSD_PITCH_PIDS:
+        case OSD_YAW_PIDS:
+        case OSD_LEVEL_PIDS:
+        case OSD_POS_XY_PIDS:
+        case OSD_POS_Z_PIDS:
+        case OSD_VEL_XY_PIDS:
+        case OSD_VEL_Z_PIDS:
+        case OSD_HEADING_P:
+        case OSD_BOARD_ALIGN_ROLL:
+        case OSD_BOARD_ALIGN_PITCH:
+        case OSD_RC_EXPO:
+        case OSD_RC_YAW_EXPO:
+        case OSD_THROTTLE_EXPO:
+        case OSD_PITCH_RATE:
+        case OSD_ROLL_RATE:
+        case OSD_YAW_RATE:
+        case OSD_MANUAL_RC_EXPO:
+        case OSD_MANUAL_RC_YAW_EXPO:
+        case OSD_MANUAL_PITCH_RATE:
+        case OSD_MANUAL_ROLL_RATE:
+        case OSD_MANUAL_YAW_RATE:
+        case OSD_NAV_FW_CRUISE_THR:
+        case OSD_NAV_FW_PITCH2THR:
+        case OSD_FW_MIN_THROTTLE_DOWN_PITCH_ANGLE:
+        case OSD_IMU_TEMPERATURE:
+        case OSD_BARO_TEMPERATURE:
+        case OSD_TEMP_SENSOR_0_TEMPERATURE:
+        case OSD_TEMP_SENSOR_1_TEMPERATURE:
+        case OSD_TEMP_SENSOR_2_TEMPERATURE:
+        case OSD_TEMP_SENSOR_3_TEMPERATURE:
+        case OSD_TEMP_SENSOR_4_TEMPERATURE:
+        case OSD_TEMP_SENSOR_5_TEMPERATURE:
+        case OSD_TEMP_SENSOR_6_TEMPERATURE:
+        case OSD_TEMP_SENSOR_7_TEMPERATURE:
+        case OSD_ESC_TEMPERATURE:
+        case OSD_PLUS_CODE:
+        case OSD_MAP_SCALE:
+        case OSD_MAP_REFERENCE:
+        case OSD_VERSION:
+        case OSD_ACTIVE_PROFILE:
+        case OSD_TPA:
+        case OSD_TPA_TIME_CONSTANT:
+        case OSD_FW_LEVEL_TRIM:
+            return OSD_ELEMENT_RATE_SLOW;
+        default:
+            return OSD_ELEMENT_RATE_NORMAL;
+    }
+}
+
+// Visible elements of the current layout, grouped by rate class. Rebuilt
+// on the next refresh after the layout or the OSD config changed, so the
+// refresh loop does not have to walk the hidden elements.
+static void osdBuildRenderList(void)
+{
+    unsigned count = 0;
+
+    for (unsigned rate = 0; rate < OSD_ELEMENT_RATE_COUNT; rate++) {
+        renderListStart[rate] = count;
+        uint8_t item = 0;
+        do {
+            // The artificial horizon is drawn on every refresh
+            if (item != OSD_ARTIFICIAL_HORIZON && osdElementRate(item) == rate &&
+                OSD_VISIBLE(osdLayoutsConfig()->item_pos[currentLayout][item])) {
+                renderList[count++] = item;
+            }
+            item = osdIncElementIndex(item);
+        } while (item != 0);
+        renderListLength[rate] = count - renderListStart[rate];
+    }
+
+    renderListValid = true;
+}
+
+// Draws the next element of the given rate class after *index.
+// Returns false if no element of the class is visible.
+static bool osdDrawNextElementOfRate(osdElementRate_e rate, uint8_t *index)
+{
+    for (unsigned ii = 0; ii < renderListLength[rate]; ii++) {
+        if (++(*index) >= renderListLength[rate]) {
+            *index = 0;
+        }
+        if (osdDrawSingleElement(renderList[renderListStart[rate] + *index])) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void osdDrawNextElement(void)
 {
-    static uint8_t elementIndex = 0;
-    // Prevent infinite loop when no elements are enabled
-    uint8_t index = elementIndex;
-    do {
-        elementIndex = osdIncElementIndex(elementIndex);
-    } while(!osdDrawSingleElement(elementIndex) && index != elementIndex);
+    static const uint8_t rateWeights[OSD_ELEMENT_RATE_COUNT] = {
+        [OSD_ELEMENT_RATE_FAST] = 4,
+        [OSD_ELEMENT_RATE_NORMAL] = 2,
+        [OSD_ELEMENT_RATE_SLOW] = 1,
+    };
+    static uint8_t elementIndex[OSD_ELEMENT_RATE_COUNT];
+    static int8_t rateCredits[OSD_ELEMENT_RATE_COUNT];
+
+    const timeUs_t startUs = micros();
+    uint8_t emptyRates = 0;
+    unsigned drawn = 0;
+
+    if (!renderListValid) {
+        osdBuildRenderList();
+    }
+
+    // Smooth weighted round robin between the rate classes: every pick
+    // credits each class with its weight and charges the chosen one the
+    // weight total, so classes are interleaved instead of drawn in bursts.
+    // Classes without visible elements drop out until the next refresh.
+    while (drawn < OSD_REFRESH_MAX_ELEMENTS) {
+        int best = -1;
+        int weightTotal = 0;
+        for (int rate = 0; rate < OSD_ELEMENT_RATE_COUNT; rate++) {
+            if (emptyRates & (1 << rate)) {
+                continue;
+            }
+            rateCredits[rate] += rateWeights[rate];
+            weightTotal += rateWeights[rate];
+            if (best < 0 || rateCredits[rate] > rateCredits[best]) {
+                best = rate;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        rateCredits[best] -= weightTotal;
+
+        if (!osdDrawNextElementOfRate(best, &elementIndex[best])) {
+            emptyRates |= 1 << best;
+            rateCredits[best] = 0;
+            continue;
+        }
+        drawn++;
+
+        if (cmpTimeUs(micros(), startUs) >= OSD_REFRESH_TIME_BUDGET_US) {
+            break;
+        }
+    }
 
     // Draw artificial horizon + tracking telemtry last
-		osdDrawSingleElement(OSD_ARTIFICIAL_HORIZON);
-		if (osdConfig()->telemetry>0){
-		  osdDisplayTelemetry();
-		}
+    osdDrawSingleElement(OSD_ARTIFICIAL_HORIZON);
+    if (osdConfig()->telemetry>0){
+        osdDisplayTelemetry();
     }
+}
 
 PG_RESET_TEMPLATE(osdConfig_t, osdConfig,
     .rssi_alarm = SETTING_OSD_RSSI_ALARM_DEFAULT,
@@ -4313,7 +4359,9 @@ void osdUpdate(timeUs_t currentTimeUs)
 
     if ((counter % DRAW_FREQ_DENOM) == 0) {
         // redraw values in buffer
+        PROFILING_ZONE_BEGIN(PROFILING_ZONE_OSD_REFRESH);
         osdRefresh(currentTimeUs);
+        PROFILING_ZONE_END(PROFILING_ZONE_OSD_REFRESH);
     } else {
         // rest of time redraw screen
         displayDrawScreen(osdDisplayPort);
@@ -4332,6 +4380,7 @@ void osdUpdate(timeUs_t currentTimeUs)
 void osdStartFullRedraw(void)
 {
     fullRedraw = true;
+    renderListValid = false;
 }
 
 void osdOverrideLayout(int layout, timeMs_t duration)
@@ -4393,11 +4442,12 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
     if (buff != NULL) {
         const char *message = NULL;
         char messageBuf[MAX(SETTING_MAX_NAME_LENGTH, OSD_MESSAGE_LENGTH+1)];
-        // We might have up to 5 messages to show.
-        const char *messages[5];
+        // We might have up to 6 messages to show.
+        const char *messages[6];
         unsigned messageCount = 0;
         const char *failsafeInfoMessage = NULL;
         const char *invertedInfoMessage = NULL;
+        const char *geozoneMessage = NULL;
 
         if (ARMING_FLAG(ARMED)) {
             if (FLIGHT_MODE(FAILSAFE_MODE) || FLIGHT_MODE(NAV_RTH_MODE) || FLIGHT_MODE(NAV_WP_MODE) || navigationIsExecutingAnEmergencyLanding()) {
@@ -4411,6 +4461,11 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
                     // Countdown display for remaining Waypoints
                     char buf[6];
                     osdFormatDistanceSymbol(buf, posControl.wpDistance, 0);
+#ifdef USE_MISSION_STORE
+                    if (posControl.missionStoreActive) {
+                        tfp_sprintf(messageBuf, "TO WP %u/%u (%s)", posControl.missionStoreWindowStart + posControl.activeWaypointIndex + 1, posControl.missionStoreWaypointCount, buf);
+                    } else
+#endif
                     tfp_sprintf(messageBuf, "TO WP %u/%u (%s)", getGeoWaypointNumber(posControl.activeWaypointIndex), posControl.geoWaypointCount, buf);
                     messages[messageCount++] = messageBuf;
                 } else if (NAV_Status.state == MW_NAV_STATE_HOLD_TIMED) {
@@ -4521,6 +4576,17 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
             }
         }
 
+#if defined(USE_GEOZONE)
+        if (ARMING_FLAG(ARMED) && geozoneIsBreached()) {
+            geozoneMessage = geozoneIsInExclusionZone() ? OSD_MESSAGE_STR(OSD_MSG_GEOZONE_EXCLUSION) : OSD_MESSAGE_STR(OSD_MSG_GEOZONE_INCLUSION);
+            messages[messageCount++] = geozoneMessage;
+        }
+#endif
+
+        if (ARMING_FLAG(ARMED) && STATE(GYRO_CLIPPING) && messageCount < ARRAYLEN(messages)) {
+            messages[messageCount++] = OSD_MESSAGE_STR(OSD_MSG_GYRO_CLIPPING);
+        }
+
         /* Messages that are shown regardless of Arming state */
 #ifdef USE_DEV_TOOLS
         if (systemConfig()->groundTestMode) {
@@ -4530,7 +4596,7 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
 
         if (messageCount > 0) {
             message = messages[OSD_ALTERNATING_CHOICES(systemMessageCycleTime(messageCount, messages), messageCount)];
-            if (message == failsafeInfoMessage) {
+            if (message == failsafeInfoMessage || message == geozoneMessage) {
                 // failsafeInfoMessage is not useful for recovering
                 // a lost model, but might help avoiding a crash.
                 // Blink to grab user attention.
@@ -24,6 +24,8 @@
 #include "drivers/osd.h"
 #include "drivers/display.h"
 
+#include "io/osd_utils.h"
+
 #ifndef OSD_ALTERNATE_LAYOUT_COUNT
 #define OSD_ALTERNATE_LAYOUT_COUNT 3
 #endif
@@ -123,6 +125,9 @@
 #if defined(USE_SAFE_HOME)
 #define OSD_MSG_DIVERT_SAFEHOME     "DIVERTING TO SAFEHOME"
 #define OSD_MSG_LOITERING_SAFEHOME  "LOITERING AROUND SAFEHOME"
+#define OSD_MSG_GEOZONE_EXCLUSION   "INSIDE NO FLY ZONE"
+#define OSD_MSG_GYRO_CLIPPING       "GYRO CLIPPING"
+#define OSD_MSG_GEOZONE_INCLUSION   "OUTSIDE FLIGHT ZONE"
 #endif
 
 typedef enum {
@@ -464,7 +469,6 @@ int16_t osdGetHeading(void);
 int32_t osdGetAltitude(void);
 
 void osdCrosshairPosition(uint8_t *x, uint8_t *y);
-bool osdFormatCentiNumber(char *buff, int32_t centivalue, uint32_t scale, int maxDecimals, int maxScaledDecimals, int length);
 void osdFormatAltitudeSymbol(char *buff, int32_t alt);
 void osdFormatVelocityStr(char* buff, int32_t vel, bool _3D, bool _max);
 // Returns a heading angle in degrees normalized to [0, 360).
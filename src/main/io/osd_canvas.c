@@ -35,6 +35,7 @@
 #define AHI_CROSSHAIR_MARGIN 6
 
 #define SIDEBAR_REDRAW_INTERVAL_MS 100
+#define SIDEBAR_MAX_REDRAW_INTERVAL_MS 1000
 #define WIDGET_SIDEBAR_LEFT_INSTANCE 0
 #define WIDGET_SIDEBAR_RIGHT_INSTANCE 1
 
@@ -340,7 +341,7 @@ static bool osdCanvasDrawArtificialHorizonWidget(displayPort_t *display, display
 
     displayWidgets_t widgets;
     if (displayCanvasGetWidgets(&widgets, canvas) &&
-        displayWidgetsSupportedInstances(&widgets, DISPLAY_WIDGET_TYPE_AHI) >= instance) {
+        displayWidgetsSupportedInstances(&widgets, DISPLAY_WIDGET_TYPE_AHI) > instance) {
 
         int ahiWidth = osdConfig()->ahi_width;
         int ahiX = (canvas->width - ahiWidth) / 2;
@@ -663,7 +664,8 @@ static void osdCanvasSidebarGetUnit(osdUnit_t *unit, uint16_t *countsPerStep, os
     }
 }
 
-static bool osdCanvasDrawSidebar(uint32_t *configured, displayWidgets_t *widgets,
+static bool osdCanvasDrawSidebar(uint32_t *configured, int32_t *drawnData, bool refresh,
+                                displayWidgets_t *widgets,
                                 displayCanvas_t *canvas,
                                 int instance,
                                 osd_sidebar_scroll_e scroll, unsigned scrollStep)
@@ -710,10 +712,19 @@ static bool osdCanvasDrawSidebar(uint32_t *configured, displayWidgets_t *widgets
         }
 
         *configured = configuration;
+        refresh = true;
     }
-    // Actual drawing
+    // Actual drawing. The widget keeps showing the last value it was
+    // given, so it's only sent again when it changes.
     int32_t data = osdCanvasSidebarGetValue(scroll);
-    return displayWidgetsDrawSidebar(widgets, instance, data);
+    if (!refresh && data == *drawnData) {
+        return true;
+    }
+    if (!displayWidgetsDrawSidebar(widgets, instance, data)) {
+        return false;
+    }
+    *drawnData = data;
+    return true;
 }
 
 bool osdCanvasDrawSidebars(displayPort_t *display, displayCanvas_t *canvas)
@@ -722,7 +733,10 @@ bool osdCanvasDrawSidebars(displayPort_t *display, displayCanvas_t *canvas)
 
     static uint32_t leftConfigured = UINT32_MAX;
     static uint32_t rightConfigured = UINT32_MAX;
+    static int32_t leftDrawn;
+    static int32_t rightDrawn;
     static timeMs_t nextRedraw = 0;
+    static timeMs_t nextRefresh = 0;
 
     timeMs_t now = millis();
 
@@ -730,21 +744,28 @@ bool osdCanvasDrawSidebars(displayPort_t *display, displayCanvas_t *canvas)
         return true;
     }
 
+    // Unchanged values are still resent once in a while, in case
+    // the device lost them
+    const bool refresh = now >= nextRefresh;
+
     displayWidgets_t widgets;
     if (displayCanvasGetWidgets(&widgets, canvas)) {
-        if (!osdCanvasDrawSidebar(&leftConfigured, &widgets, canvas,
+        if (!osdCanvasDrawSidebar(&leftConfigured, &leftDrawn, refresh, &widgets, canvas,
             WIDGET_SIDEBAR_LEFT_INSTANCE,
             osdConfig()->left_sidebar_scroll,
             osdConfig()->left_sidebar_scroll_step)) {
             return false;
         }
-        if (!osdCanvasDrawSidebar(&rightConfigured, &widgets, canvas,
+        if (!osdCanvasDrawSidebar(&rightConfigured, &rightDrawn, refresh, &widgets, canvas,
             WIDGET_SIDEBAR_RIGHT_INSTANCE,
             osdConfig()->right_sidebar_scroll,
             osdConfig()->right_sidebar_scroll_step)) {
             return false;
         }
         nextRedraw = now + SIDEBAR_REDRAW_INTERVAL_MS;
+        if (refresh) {
+            nextRefresh = now + SIDEBAR_MAX_REDRAW_INTERVAL_MS;
+        }
         return true;
     }
     return false;
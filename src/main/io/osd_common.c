@@ -26,6 +26,7 @@
 
 #include "platform.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "config/parameter_group.h"
@@ -37,6 +38,9 @@
 
 #include "fc/settings.h"
 
+#include "flight/telemetry_snapshot.h"
+
+#include "io/osd.h"
 #include "io/osd_canvas.h"
 #include "io/osd_common.h"
 #include "io/osd_grid.h"
@@ -193,8 +197,30 @@ void osdDrawSidebars(displayPort_t *display, displayCanvas_t *canvas)
 #ifdef USE_GPS
 int16_t osdGet3DSpeed(void)
 {
-    int16_t vert_speed = getEstimatedActualVelocity(Z);
-    int16_t hor_speed = gpsSol.groundSpeed;
-    return (int16_t)calc_length_pythagorean_2D(hor_speed, vert_speed);
+    return telemetrySnapshot.speed3D;
+}
+#endif
+
+#if defined(USE_OSD) || defined(USE_DJI_HD_OSD)
+/**
+ * Converts velocity based on the current unit system (kmh, mph or knots).
+ * @param vel Raw velocity (i.e. as taken from gpsSol.groundSpeed in centimeters/second)
+ */
+int32_t osdConvertVelocityToUnit(int32_t vel)
+{
+    switch ((osd_unit_e)osdConfig()->units) {
+    case OSD_UNIT_UK:
+        FALLTHROUGH;
+    case OSD_UNIT_METRIC_MPH:
+        FALLTHROUGH;
+    case OSD_UNIT_IMPERIAL:
+        return CMSEC_TO_CENTIMPH(vel) / 100; // Convert to mph
+    case OSD_UNIT_METRIC:
+        return CMSEC_TO_CENTIKPH(vel) / 100;   // Convert to kmh
+    case OSD_UNIT_GA:
+        return CMSEC_TO_CENTIKNOTS(vel) / 100; // Convert to Knots
+    }
+    // Unreachable
+    return -1;
 }
 #endif
@@ -106,3 +106,4 @@ void osdDrawSidebars(displayPort_t *display, displayCanvas_t *canvas);
 #ifdef USE_GPS
 int16_t osdGet3DSpeed(void);
 #endif
+int32_t osdConvertVelocityToUnit(int32_t vel);
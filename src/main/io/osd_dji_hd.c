@@ -54,6 +54,7 @@
 #include "flight/imu.h"
 #include "flight/pid.h"
 #include "flight/mixer.h"
+#include "flight/telemetry_snapshot.h"
 
 #include "io/serial.h"
 #include "io/gps.h"
@@ -95,7 +96,6 @@
 #define DJI_OSD_WARNING_COUNT               16
 #define DJI_OSD_TIMER_COUNT                 2
 #define DJI_OSD_FLAGS_OSD_FEATURE           (1 << 0)
-#define EFFICIENCY_UPDATE_INTERVAL          (5 * 1000)
 
 #define RC_RX_LINK_LOST_MSG "!RC RX LINK LOST!"
 
@@ -648,29 +648,6 @@ static char * navigationStateMessage(void)
 }
 
 
-/**
- * Converts velocity based on the current unit system (kmh or mph).
- * @param alt Raw velocity (i.e. as taken from gpsSol.groundSpeed in centimeters/second)
- */
-static int32_t osdConvertVelocityToUnit(int32_t vel)
-{
-    switch (osdConfig()->units) {
-        case OSD_UNIT_UK:
-            FALLTHROUGH;
-        case OSD_UNIT_METRIC_MPH:
-            FALLTHROUGH;
-        case OSD_UNIT_IMPERIAL:
-            return CMSEC_TO_CENTIMPH(vel) / 100; // Convert to mph
-        case OSD_UNIT_GA:
-            return CMSEC_TO_CENTIKNOTS(vel) / 100; // Convert to Knots
-        case OSD_UNIT_METRIC:
-            return CMSEC_TO_CENTIKPH(vel) / 100;   // Convert to kmh
-    }
-
-    // Unreachable
-    return -1;
-}
-
 /**
  * Converts velocity into a string based on the current unit system.
  * @param alt Raw velocity (i.e. as taken from gpsSol.groundSpeed in centimeters/seconds)
@@ -775,25 +752,9 @@ static void osdDJIFormatDistanceStr(char *buff, int32_t dist)
 
 static void osdDJIEfficiencyMahPerKM(char *buff)
 {
-    // amperage is in centi amps, speed is in cms/s. We want
     // mah/km. Values over 999 are considered useless and
     // displayed as "---""
-    static pt1Filter_t eFilterState;
-    static timeUs_t efficiencyUpdated = 0;
-    int32_t value = 0;
-    timeUs_t currentTimeUs = micros();
-    timeDelta_t efficiencyTimeDelta = cmpTimeUs(currentTimeUs, efficiencyUpdated);
-
-    if (STATE(GPS_FIX) && gpsSol.groundSpeed > 0) {
-        if (efficiencyTimeDelta >= EFFICIENCY_UPDATE_INTERVAL) {
-            value = pt1FilterApply4(&eFilterState, ((float)getAmperage() / gpsSol.groundSpeed) / 0.0036f,
-                1, US2S(efficiencyTimeDelta));
-
-            efficiencyUpdated = currentTimeUs;
-        } else {
-            value = eFilterState.state;
-        }
-    }
+    const int32_t value = telemetrySnapshot.mAhPerKm;
 
     if (value > 0 && value <= 999) {
         tfp_sprintf(buff, "%3d%s", (int)value, "mAhKM");
@@ -125,8 +125,8 @@ void osdGridDrawArtificialHorizon(displayPort_t *display, unsigned gx, unsigned
 
     const float pitch_rad_to_char = (float)(OSD_AHI_HEIGHT / 2 + 0.5) / DEGREES_TO_RADIANS(osdConfig()->ahi_max_pitch);
 
-    const float ky = sin_approx(rollAngle);
-    const float kx = cos_approx(rollAngle);
+    float ky, kx;
+    sincos_approx(rollAngle, &ky, &kx);
     const float ratio = osdGetAspectRatioCorrection();
 
     if (previous_orient != -1) {
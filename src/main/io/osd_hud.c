@@ -16,6 +16,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -24,6 +25,7 @@
 
 #include "flight/imu.h"
 
+#include "io/gps.h"
 #include "io/osd.h"
 #include "io/osd_hud.h"
 
@@ -34,14 +36,40 @@
 #include "drivers/time.h"
 
 #include "navigation/navigation.h"
+#include "navigation/navigation_private.h"
 
 #ifdef USE_OSD
 
 #define HUD_DRAWN_MAXCHARS 54 // 8 POI (1 home, 4 radar, 3 WP) x 7 chars max for each, minus 2 for H
 
+#define HUD_POI_SLOTS (1 + RADAR_MAX_POIS + 3) // Home, radar peers and up to 3 waypoints
+
 static int8_t hud_drawn[HUD_DRAWN_MAXCHARS][2];
 static int8_t hud_drawn_pt;
 
+/*
+ * Projection results of each POI from the previous refresh. Each part is
+ * only recomputed when the angle or position it depends on changes.
+ */
+typedef struct hudPoiProjection_s {
+    bool hasScaledX;
+    bool hasElevation;
+    bool hasScaledY;
+    int16_t errorX;     // Horizontal angle to the POI, as seen from the craft (°)
+    int16_t errorY;     // Vertical angle to the POI, seen from the camera (°)
+    int32_t altitude;   // Relative altitude the elevation was computed for (m)
+    uint32_t distance;  // Distance the elevation was computed for (m)
+    float scaledX;
+    float scaledY;
+    float elevation;    // (°)
+} hudPoiProjection_t;
+
+static hudPoiProjection_t hud_projections[HUD_POI_SLOTS];
+static uint8_t hud_fov_h;
+static uint8_t hud_fov_v;
+static float hud_fov_scale_h;
+static float hud_fov_scale_v;
+
 /*
  * Overwrite all previously written positions on the OSD with a blank
  */
@@ -96,6 +124,44 @@ static int16_t hudWrap360(int16_t angle)
     return angle;
 }
 
+/*
+ * Radar, relative position of the peers. A peer is only computed again when
+ * it sent new data or the own position changed, peers that are lost or out
+ * of the HUD radar range are marked so the OSD skips them.
+ */
+void radarUpdatePois(int32_t altitudeMsl)
+{
+    static timeUs_t ownPositionTimeUs;
+    const bool ownPositionChanged = gpsSol.sample.timeUs != ownPositionTimeUs;
+    ownPositionTimeUs = gpsSol.sample.timeUs;
+
+    for (int i = 0; i < RADAR_MAX_POIS; i++) {
+        radar_pois_t *poi = &radar_pois[i];
+
+        if (!poi->updated && !ownPositionChanged) {
+            continue;
+        }
+        poi->updated = false;
+
+        // state 2 means POI has been lost and must be skipped
+        if (poi->gps.lat == 0 || poi->gps.lon == 0 || poi->state >= 2) {
+            poi->distance = 0;
+            poi->inRange = false;
+            continue;
+        }
+
+        fpVector3_t position;
+        geoConvertGeodeticToLocal(&position, &posControl.gpsOrigin, &poi->gps, GEO_ALT_RELATIVE);
+        poi->distance = calculateDistanceToDestination(&position) / 100; // In meters
+        poi->inRange = poi->distance >= osdConfig()->hud_radar_range_min && poi->distance <= osdConfig()->hud_radar_range_max;
+
+        if (poi->inRange) {
+            poi->direction = calculateBearingToDestination(&position) / 100; // In °
+            poi->altitude = (poi->gps.alt - altitudeMsl) / 100;
+        }
+    }
+}
+
 /*
  * Radar, get the nearest POI
  */
@@ -113,6 +179,69 @@ int8_t radarGetNearestPOI(void)
     return poi;
 }
 
+static hudPoiProjection_t *hudGetPoiProjection(uint8_t poiType, uint16_t poiSymbol, int16_t poiP2)
+{
+    // The camera FOV scales every projection, start over when it changes
+    if (hud_fov_h != osdConfig()->camera_fov_h || hud_fov_v != osdConfig()->camera_fov_v) {
+        hud_fov_h = osdConfig()->camera_fov_h;
+        hud_fov_v = osdConfig()->camera_fov_v;
+        hud_fov_scale_h = sin_approx(DEGREES_TO_RADIANS(hud_fov_h / 2));
+        hud_fov_scale_v = sin_approx(DEGREES_TO_RADIANS(hud_fov_v / 2));
+        memset(hud_projections, 0, sizeof(hud_projections));
+    }
+
+    int slot = 0;
+    if (poiType == 1) {
+        slot = 1 + constrain(poiSymbol - 65, 0, RADAR_MAX_POIS - 1);
+    } else if (poiType == 2) {
+        slot = 1 + RADAR_MAX_POIS + constrain(poiP2, 0, 2);
+    }
+    return &hud_projections[slot];
+}
+
+/*
+ * Horizontal position of a POI in the camera view, from -1 (left edge) to 1 (right edge)
+ */
+static float hudPoiScaledX(hudPoiProjection_t *proj, int16_t error_x)
+{
+    if (!proj->hasScaledX || proj->errorX != error_x) {
+        proj->scaledX = sin_approx(DEGREES_TO_RADIANS(error_x)) / hud_fov_scale_h;
+        proj->errorX = error_x;
+        proj->hasScaledX = true;
+    }
+    return proj->scaledX;
+}
+
+/*
+ * Angle of the POI below the horizon, as seen from the craft (°)
+ */
+static float hudPoiElevation(hudPoiProjection_t *proj, int32_t poiAltitude, uint32_t poiDistance)
+{
+    // A change of less than 1/128 in distance moves the angle by less than 0.25°,
+    // well below the 1° resolution of the vertical projection
+    const uint32_t distanceChange = ABS((int32_t)(poiDistance - proj->distance));
+    if (!proj->hasElevation || proj->altitude != poiAltitude || distanceChange > proj->distance / 128) {
+        proj->elevation = RADIANS_TO_DEGREES(atan2_approx(-poiAltitude, poiDistance));
+        proj->altitude = poiAltitude;
+        proj->distance = poiDistance;
+        proj->hasElevation = true;
+    }
+    return proj->elevation;
+}
+
+/*
+ * Vertical position of a POI in the camera view, from -1 (top edge) to 1 (bottom edge)
+ */
+static float hudPoiScaledY(hudPoiProjection_t *proj, int16_t error_y)
+{
+    if (!proj->hasScaledY || proj->errorY != error_y) {
+        proj->scaledY = sin_approx(DEGREES_TO_RADIANS(error_y)) / hud_fov_scale_v;
+        proj->errorY = error_y;
+        proj->hasScaledY = true;
+    }
+    return proj->scaledY;
+}
+
 /*
  * Display a POI as a 3D-marker on the hud
  * Distance (m), Direction (°), Altitude (relative, m, negative means below), Heading (°),
@@ -137,22 +266,23 @@ void osdHudDrawPoi(uint32_t poiDistance, int16_t poiDirection, int32_t poiAltitu
 
     osdCrosshairPosition(&center_x, &center_y);
 
+    hudPoiProjection_t *proj = hudGetPoiProjection(poiType, poiSymbol, poiP2);
+
     int16_t error_x = hudWrap180(poiDirection - DECIDEGREES_TO_DEGREES(osdGetHeading()));
 
     if ((error_x > -(osdConfig()->camera_fov_h / 2)) && (error_x < osdConfig()->camera_fov_h / 2)) { // POI might be in sight, extra geometry needed
-        float scaled_x = sin_approx(DEGREES_TO_RADIANS(error_x)) / sin_approx(DEGREES_TO_RADIANS(osdConfig()->camera_fov_h / 2));
+        float scaled_x = hudPoiScaledX(proj, error_x);
         poi_x = center_x + 15 * scaled_x;
 
         if (poi_x < minX || poi_x > maxX ) { // In camera view, but out of the hud area
             poi_is_oos = 1;
         }
         else { // POI is on sight, compute the vertical
-            float poi_angle = atan2_approx(-poiAltitude, poiDistance);
-            poi_angle = RADIANS_TO_DEGREES(poi_angle);
+            float poi_angle = hudPoiElevation(proj, poiAltitude, poiDistance);
             int16_t plane_angle = attitude.values.pitch / 10;
             int camera_angle = osdConfig()->camera_uptilt;
             int16_t error_y = poi_angle - plane_angle + camera_angle;
-            float scaled_y = sin_approx(DEGREES_TO_RADIANS(error_y)) / sin_approx(DEGREES_TO_RADIANS(osdConfig()->camera_fov_v / 2));
+            float scaled_y = hudPoiScaledY(proj, error_y);
             poi_y = constrain(center_y + (osdGetDisplayPort()->rows / 2) * scaled_y, minY, maxY - 1);
         }
     }
@@ -56,6 +56,7 @@ typedef struct __attribute__((packed)) {
 #define BENEWAKE_PACKET_SIZE    sizeof(tfminiPacket_t)
 #define BENEWAKE_MIN_QUALITY    0
 #define BENEWAKE_TIMEOUT_MS     200 // 200ms
+#define BENEWAKE_RX_CHUNK_SIZE  32
 
 static serialPort_t * serialPort = NULL;
 static serialPortConfig_t * portConfig;
@@ -105,45 +106,50 @@ static void benewakeRangefinderUpdate(void)
         lastProtocolActivityMs = millis();
     }
 
-    // Process incoming bytes
+    // Process incoming bytes, drained from the serial buffer in chunks
     tfminiPacket_t *tfminiPacket = (tfminiPacket_t *)buffer;
-    while (serialRxBytesWaiting(serialPort) > 0) {
-        uint8_t c = serialRead(serialPort);
+    uint8_t rxChunk[BENEWAKE_RX_CHUNK_SIZE];
+    uint32_t rxCount;
 
-        // Add byte to buffer
-        if (bufferPtr < BENEWAKE_PACKET_SIZE) {
-            buffer[bufferPtr++] = c;
-        }
+    while ((rxCount = serialReadBuf(serialPort, rxChunk, sizeof(rxChunk))) > 0) {
+        for (uint32_t rxIndex = 0; rxIndex < rxCount; rxIndex++) {
+            const uint8_t c = rxChunk[rxIndex];
 
-        // Check header bytes
-        if ((bufferPtr == 1) && (tfminiPacket->header0 != 0x59)) {
-            bufferPtr = 0;
-            continue;
-        }
+            // Add byte to buffer
+            if (bufferPtr < BENEWAKE_PACKET_SIZE) {
+                buffer[bufferPtr++] = c;
+            }
 
-        if ((bufferPtr == 2) && (tfminiPacket->header1 != 0x59)) {
-            bufferPtr = 0;
-            continue;
-        }
+            // Check header bytes
+            if ((bufferPtr == 1) && (tfminiPacket->header0 != 0x59)) {
+                bufferPtr = 0;
+                continue;
+            }
 
-        // Check for complete packet
-        if (bufferPtr == BENEWAKE_PACKET_SIZE) {
-            const uint8_t checksum = buffer[0] + buffer[1] + buffer[2] + buffer[3] + buffer[4] + buffer[5] + buffer[6] + buffer[7];
-            if (tfminiPacket->checksum == checksum) {
-                // Valid packet
-                hasNewData = true;
-                sensorData = (tfminiPacket->distL << 0) | (tfminiPacket->distH << 8);
-                lastProtocolActivityMs = millis();
+            if ((bufferPtr == 2) && (tfminiPacket->header1 != 0x59)) {
+                bufferPtr = 0;
+                continue;
+            }
+
+            // Check for complete packet
+            if (bufferPtr == BENEWAKE_PACKET_SIZE) {
+                const uint8_t checksum = buffer[0] + buffer[1] + buffer[2] + buffer[3] + buffer[4] + buffer[5] + buffer[6] + buffer[7];
+                if (tfminiPacket->checksum == checksum) {
+                    // Valid packet
+                    hasNewData = true;
+                    sensorData = (tfminiPacket->distL << 0) | (tfminiPacket->distH << 8);
+                    lastProtocolActivityMs = millis();
 
-                uint16_t qual = (tfminiPacket->strengthL << 0) | (tfminiPacket->strengthH << 8);
+                    uint16_t qual = (tfminiPacket->strengthL << 0) | (tfminiPacket->strengthH << 8);
 
-                if (sensorData == 0 || qual <= BENEWAKE_MIN_QUALITY) {
-                    sensorData = -1;
+                    if (sensorData == 0 || qual <= BENEWAKE_MIN_QUALITY) {
+                        sensorData = -1;
+                    }
                 }
-            }
 
-            // Prepare for new packet
-            bufferPtr = 0;
+                // Prepare for new packet
+                bufferPtr = 0;
+            }
         }
     }
 }
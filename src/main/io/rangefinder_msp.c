@@ -46,6 +46,7 @@
 
 static bool hasNewData = false;
 static int32_t sensorData = RANGEFINDER_NO_NEW_DATA;
+static timeUs_t sensorDataTimeUs = 0;
 
 static bool mspRangefinderDetect(void)
 {
@@ -72,11 +73,21 @@ static int32_t mspRangefinderGetDistance(void)
     }
 }
 
+static bool mspRangefinderIsDataReady(timeUs_t * sampleTimeUs)
+{
+    if (hasNewData) {
+        *sampleTimeUs = sensorDataTimeUs;
+    }
+
+    return hasNewData;
+}
+
 void mspRangefinderReceiveNewData(uint8_t * bufferPtr)
 {
     const mspSensorRangefinderDataMessage_t * pkt = (const mspSensorRangefinderDataMessage_t *)bufferPtr;
 
     sensorData = pkt->distanceMm / 10;
+    sensorDataTimeUs = micros();
     hasNewData = true;
 }
 
@@ -84,7 +95,8 @@ virtualRangefinderVTable_t rangefinderMSPVtable = {
     .detect = mspRangefinderDetect,
     .init = mspRangefinderInit,
     .update = mspRangefinderUpdate,
-    .read = mspRangefinderGetDistance
+    .read = mspRangefinderGetDistance,
+    .isDataReady = mspRangefinderIsDataReady
 };
 
 #endif
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include "build/build_config.h"
 
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "config/parameter_group.h"
@@ -507,6 +508,29 @@ static void nopConsumer(uint8_t data)
     UNUSED(data);
 }
 
+#define SERIAL_PASSTHROUGH_CHUNK_SIZE   64
+
+// Moves whatever is waiting on one side, as much as the other side can take, in one block
+static void serialPassthroughForward(serialPort_t *from, serialPort_t *to, serialConsumer *consumer)
+{
+    if (!serialRxBytesWaiting(from)) {
+        return;
+    }
+
+    uint8_t buf[SERIAL_PASSTHROUGH_CHUNK_SIZE];
+    const uint32_t count = serialReadBuf(from, buf, MIN(serialTxBytesFree(to), sizeof(buf)));
+    if (count == 0) {
+        return;
+    }
+
+    LED0_ON;
+    serialWriteBuf(to, buf, count);
+    for (uint32_t i = 0; i < count; i++) {
+        consumer(buf[i]);
+    }
+    LED0_OFF;
+}
+
 /*
  A high-level serial passthrough implementation. Used by cli to start an
  arbitrary serial passthrough "proxy". Optional callbacks can be given to allow
@@ -534,24 +558,8 @@ void serialPassthrough(serialPort_t *left, serialPort_t *right, serialConsumer
         // implement a guard interval and check for `+++` as an escape sequence
         // to return to CLI command mode.
         // https://en.wikipedia.org/wiki/Escape_sequence#Modem_control
-        if (serialRxBytesWaiting(left)) {
-            LED0_ON;
-            uint8_t c = serialRead(left);
-            // Make sure there is space in the tx buffer
-            while (!serialTxBytesFree(right));
-            serialWrite(right, c);
-            leftC(c);
-            LED0_OFF;
-         }
-         if (serialRxBytesWaiting(right)) {
-             LED0_ON;
-             uint8_t c = serialRead(right);
-             // Make sure there is space in the tx buffer
-             while (!serialTxBytesFree(left));
-             serialWrite(left, c);
-             rightC(c);
-             LED0_OFF;
-         }
+        serialPassthroughForward(left, right, leftC);
+        serialPassthroughForward(right, left, rightC);
      }
  }
  #endif
@@ -24,6 +24,8 @@
 
 #ifdef  USE_SERIAL_4WAY_BLHELI_INTERFACE
 
+#include "common/crc.h"
+
 #include "drivers/buf_writer.h"
 #include "drivers/io.h"
 #include "drivers/serial.h"
@@ -397,6 +399,18 @@ static uint8_t ReadByteCrc(void)
     return b;
 }
 
+// Parameter blocks are taken as the USB packets arrive, CRC-16/XMODEM equals the table driven CCITT one
+static void ReadBlockCrc(uint8_t *data, unsigned len)
+{
+    uint8_t *p = data;
+    while (len > 0) {
+        const unsigned count = serialReadBuf(port, p, len);
+        p += count;
+        len -= count;
+    }
+    CRC_in.word = crc16_ccitt_update(CRC_in.word, data, p - data);
+}
+
 static void WriteByte(uint8_t b)
 {
     serialWrite(port, b);
@@ -409,6 +423,12 @@ static void WriteByteCrc(uint8_t b)
     CRCout.word = _crc_xmodem_update(CRCout.word, b);
 }
 
+static void WriteBlockCrc(const uint8_t *data, unsigned len)
+{
+    serialWriteBuf(port, data, len);
+    CRCout.word = crc16_ccitt_update(CRCout.word, data, len);
+}
+
 void esc4wayProcess(serialPort_t *mspPort)
 {
 
@@ -421,7 +441,6 @@ void esc4wayProcess(serialPort_t *mspPort)
     uint8_16_u Dummy;
     uint8_t O_PARAM_LEN;
     uint8_t *O_PARAM;
-    uint8_t *InBuff;
     ioMem_t ioMem;
 
     port = mspPort;
@@ -451,13 +470,8 @@ void esc4wayProcess(serialPort_t *mspPort)
         ioMem.D_FLASH_ADDR_L = ReadByteCrc();
         I_PARAM_LEN = ReadByteCrc();
 
-        InBuff = ParamBuf;
-        uint8_t i = I_PARAM_LEN;
-        do {
-          *InBuff = ReadByteCrc();
-          InBuff++;
-          i--;
-        } while (i != 0);
+        // Length 0 stands for 256 bytes
+        ReadBlockCrc(ParamBuf, I_PARAM_LEN ? I_PARAM_LEN : 256);
 
         CRC_check.bytes[1] = ReadByte();
         CRC_check.bytes[0] = ReadByte();
@@ -870,14 +884,7 @@ void esc4wayProcess(serialPort_t *mspPort)
         WriteByteCrc(ioMem.D_FLASH_ADDR_L);
         WriteByteCrc(O_PARAM_LEN);
 
-        i=O_PARAM_LEN;
-        do {
-            while (!serialTxBytesFree(port));
-
-            WriteByteCrc(*O_PARAM);
-            O_PARAM++;
-            i--;
-        } while (i > 0);
+        WriteBlockCrc(O_PARAM, O_PARAM_LEN ? O_PARAM_LEN : 256);
 
         WriteByteCrc(ACK_OUT);
         WriteByte(CRCout.bytes[1]);
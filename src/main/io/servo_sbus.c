@@ -43,9 +43,11 @@
 
 #define SERVO_SBUS_UART_BAUD            100000
 #define SERVO_SBUS_OPTIONS              (SBUS_PORT_OPTIONS | SERIAL_INVERTED | SERIAL_UNIDIR)
+#define SERVO_SBUS_CHANNELS             16
 
 static serialPort_t * servoSbusPort = NULL;
 static sbusFrame_t sbusFrame;
+static uint16_t sbusServoValue[SERVO_SBUS_CHANNELS];  // Last value encoded into sbusFrame
 
 bool sbusServoInitialize(void)
 {
@@ -87,11 +89,22 @@ bool sbusServoInitialize(void)
     sbusFrame.channels.chan15 = sbusEncodeChannelValue(1500);
     sbusFrame.endByte = 0x00;
 
+    for (int i = 0; i < SERVO_SBUS_CHANNELS; i++) {
+        sbusServoValue[i] = 1500;
+    }
+
     return true;
 }
 
 void sbusServoUpdate(uint8_t index, uint16_t value)
 {
+    // Frame keeps the encoded values, bit packing is only redone for a channel that moved
+    if (index >= SERVO_SBUS_CHANNELS || sbusServoValue[index] == value) {
+        return;
+    }
+
+    sbusServoValue[index] = value;
+
     switch(index) {
         case 0: sbusFrame.channels.chan0 = sbusEncodeChannelValue(value); break;
         case 1: sbusFrame.channels.chan1 = sbusEncodeChannelValue(value); break;
@@ -127,7 +140,10 @@ void sbusServoSendUpdate(void)
         return;
     }
 
+    // Whole frame in one go, a port with TX DMA sends it as a single transfer
+    serialBeginWrite(servoSbusPort);
     serialWriteBuf(servoSbusPort, (const uint8_t *)&sbusFrame, sizeof(sbusFrame));
+    serialEndWrite(servoSbusPort);
 }
 
 #endif
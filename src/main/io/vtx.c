@@ -43,6 +43,7 @@
 #include "io/vtx.h"
 #include "io/vtx_string.h"
 #include "io/vtx_control.h"
+#include "io/vtx_transaction.h"
 
 PG_REGISTER_WITH_RESET_TEMPLATE(vtxSettingsConfig_t, vtxSettingsConfig, PG_VTX_SETTINGS_CONFIG, 2);
 
@@ -159,6 +160,16 @@ static bool vtxProcessPitMode(vtxDevice_t *vtxDevice, const vtxSettingsConfig_t
     return false;
 }
 
+#define VTX_UPDATE_PERIOD_US    200000
+
+bool vtxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
+{
+    UNUSED(currentTimeUs);
+
+    // Run as soon as the VTX answered, otherwise at the polling rate for the config and switch updates
+    return vtxTransactionEventPending() || currentDeltaTime >= VTX_UPDATE_PERIOD_US;
+}
+
 void vtxUpdate(timeUs_t currentTimeUs)
 {
     static uint8_t currentSchedule = 0;
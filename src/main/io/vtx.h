@@ -47,4 +47,5 @@ typedef struct vtxSettingsConfig_s {
 PG_DECLARE(vtxSettingsConfig_t, vtxSettingsConfig);
 
 void vtxInit(void);
+bool vtxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime);
 void vtxUpdate(timeUs_t currentTimeUs);
@@ -45,6 +45,7 @@
 #include "io/vtx_ffpv24g.h"
 #include "io/vtx_control.h"
 #include "io/vtx_string.h"
+#include "io/vtx_transaction.h"
 #include "io/serial.h"
 
 
@@ -99,8 +100,8 @@ typedef struct {
     // Comms flags and state
     ffpvPacket_t sendPkt;
     ffpvPacket_t recvPkt;
-    unsigned     recvPtr;
     bool         pktReceived;
+    vtxTransaction_t transaction;
 } vtxProtoState_t;
 
 /*****************************************************************************/
@@ -132,7 +133,6 @@ const unsigned ffpvPowerTable[VTX_FFPV_POWER_COUNT] = {
 
 
 /*******************************************************************************/
-static serialPort_t * vtxSerialPort = NULL;
 static vtxProtoState_t vtxState;
 
 static uint8_t vtxCalcChecksum(ffpvPacket_t * pkt)
@@ -144,53 +144,31 @@ static uint8_t vtxCalcChecksum(ffpvPacket_t * pkt)
     return sum;
 }
 
-static bool vtxProtoRecv(void)
+static bool vtxValidateResponse(const uint8_t *response, const uint8_t *request)
 {
-    // Return success instantly if packet is already awaiting processing
-    if (vtxState.pktReceived) {
-        return true;
-    }
+    ffpvPacket_t pkt;
+    memcpy(&pkt, response, sizeof(pkt));
 
-    uint8_t * bufPtr = (uint8_t*)&vtxState.recvPkt;
-    while (serialRxBytesWaiting(vtxSerialPort) && !vtxState.pktReceived) {
-        const uint8_t c = serialRead(vtxSerialPort);
+    // Must answer the command we sent and carry different data, an echo of the request would pass otherwise
+    return pkt.header == 0x0F && pkt.cmd == request[1] && pkt.footer == 0x00 && pkt.checksum == vtxCalcChecksum(&pkt) &&
+           memcmp(pkt.data, &request[2], sizeof(pkt.data)) != 0;
+}
 
-        if (vtxState.recvPtr == 0) {
-            // Wait for sync byte
-            if (c == 0x0F) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-        }
-        else {
-            // Sync byte ok - wait for full packet
-            if (vtxState.recvPtr < sizeof(vtxState.recvPkt)) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
+// Returns true once the response is in or the command timed out, pktReceived tells which
+static bool vtxProtoRecv(void)
+{
+    switch (vtxTransactionPoll(&vtxState.transaction)) {
+        case VTX_TRANSACTION_DONE:
+            memcpy(&vtxState.recvPkt, vtxTransactionResponse(&vtxState.transaction), sizeof(vtxState.recvPkt));
+            vtxState.pktReceived = true;
+            return true;
 
-            // Received full packet - do some processing
-            if (vtxState.recvPtr == sizeof(vtxState.recvPkt)) {
-                // Full packet received - validate packet, make sure it's the one we expect
-                const bool pktValid = (vtxState.recvPkt.header == 0x0F && vtxState.recvPkt.cmd == vtxState.sendPkt.cmd && vtxState.recvPkt.footer == 0x00 && vtxState.recvPkt.checksum == vtxCalcChecksum(&vtxState.recvPkt));
-                if (!pktValid) {
-                    // Reset the receiver state - keep waiting
-                    vtxState.pktReceived = false;
-                    vtxState.recvPtr = 0;
-                }
-                // Make sure it's not the echo one (half-duplex serial might receive it's own data)
-                else if (memcmp(&vtxState.recvPkt.data, &vtxState.sendPkt.data, sizeof(vtxState.recvPkt.data)) == 0) {
-                    vtxState.pktReceived = false;
-                    vtxState.recvPtr = 0;
-                }
-                // Valid receive packet
-                else {
-                    vtxState.pktReceived = true;
-                    return true;
-                }
-            }
-        }
-    }
+        case VTX_TRANSACTION_PENDING:
+            return false;
 
-    return false;
+        default:
+            return true;
+    }
 }
 
 static void vtxProtoSend(uint8_t cmd, const uint8_t * data)
@@ -209,12 +187,10 @@ static void vtxProtoSend(uint8_t cmd, const uint8_t * data)
     vtxState.sendPkt.checksum = vtxCalcChecksum(&vtxState.sendPkt);
     vtxState.sendPkt.footer = 0x00;
 
-    // Send data 
-    serialWriteBuf(vtxSerialPort, (uint8_t *)&vtxState.sendPkt, sizeof(vtxState.sendPkt));
-
     // Reset cmd response state
     vtxState.pktReceived = false;
-    vtxState.recvPtr = 0;
+
+    vtxTransactionStart(&vtxState.transaction, (const uint8_t *)&vtxState.sendPkt, VTX_FFPV_CMD_TIMEOUT_MS);
 }
 
 static void vtxProtoSend_SetFreqency(unsigned freq)
@@ -242,7 +218,7 @@ STATIC_PROTOTHREAD(impl_VtxProtocolThread)
     while(!vtxState.ready) {
         // Send capabilities request and wait
         vtxProtoSend(0x72, NULL);
-        ptWaitTimeout(vtxProtoRecv(), VTX_FFPV_CMD_TIMEOUT_MS);
+        ptWait(vtxProtoRecv());
 
         // Check if we got a valid response
         if (vtxState.pktReceived) {
@@ -280,7 +256,7 @@ STATIC_PROTOTHREAD(impl_VtxProtocolThread)
         else {
             // Periodic check for VTX liveness
             vtxProtoSend(0x76, NULL);
-            ptWaitTimeout(vtxProtoRecv(), VTX_FFPV_CMD_TIMEOUT_MS);
+            ptWait(vtxProtoRecv());
 
             if (vtxState.pktReceived) {
                 // Got a valid state from VTX
@@ -335,7 +311,7 @@ static vtxDevType_e impl_GetDeviceType(const vtxDevice_t *vtxDevice)
 
 static bool impl_IsReady(const vtxDevice_t *vtxDevice)
 {
-    return vtxDevice != NULL && vtxSerialPort != NULL && vtxState.ready;
+    return vtxDevice != NULL && vtxState.transaction.port != NULL && vtxState.ready;
 }
 
 static bool impl_DevSetFreq(uint16_t freq)
@@ -497,15 +473,9 @@ static vtxDevice_t impl_vtxDevice = {
 
 bool vtxFuriousFPVInit(void)
 {
-    serialPortConfig_t * portConfig = findSerialPortConfig(FUNCTION_VTX_FFPV);
-
-    if (portConfig) {
-        portOptions_t portOptions = 0;
-        portOptions = portOptions | (vtxConfig()->halfDuplex ? SERIAL_BIDIR : SERIAL_UNIDIR);
-        vtxSerialPort = openSerialPort(portConfig->identifier, FUNCTION_VTX_FFPV, NULL, NULL, 9600, MODE_RXTX, portOptions);
-    }
+    const portOptions_t portOptions = vtxConfig()->halfDuplex ? SERIAL_BIDIR : SERIAL_UNIDIR;
 
-    if (!vtxSerialPort) {
+    if (!vtxTransactionOpen(&vtxState.transaction, FUNCTION_VTX_FFPV, 9600, portOptions, 0x0F, sizeof(ffpvPacket_t), vtxValidateResponse)) {
         return false;
     }
 
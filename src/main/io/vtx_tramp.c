@@ -42,9 +42,11 @@
 #include "io/vtx_control.h"
 #include "io/vtx.h"
 #include "io/vtx_string.h"
+#include "io/vtx_transaction.h"
 
 #define VTX_PKT_SIZE                16
 #define VTX_PROTO_STATE_TIMEOUT_MS  1000
+#define VTX_PROTO_CMD_DELAY_MS      200     // Settle time after a command before its result is read back
 #define VTX_STATUS_INTERVAL_MS      2000
 
 #define VTX_UPDATE_REQ_NONE         0x00
@@ -107,11 +109,10 @@ typedef struct {
         const uint16_t * powerTablePtr;
     } metadata;
 
-    // Comms flags and state
+    // Comms state
     uint8_t         sendPkt[VTX_PKT_SIZE];
-    uint8_t         recvPkt[VTX_PKT_SIZE];
-    unsigned        recvPtr;
-    serialPort_t *  port;
+    const uint8_t * recvPkt;
+    vtxTransaction_t transaction;
 } vtxProtoState_t;
 
 static vtxProtoState_t vtxState;
@@ -123,51 +124,17 @@ static bool trampIsValidResponseCode(uint8_t code)
     return (code == 'r' || code == 'v' || code == 's');
 }
 
-static bool vtxProtoRecv(void)
+static bool trampValidateResponse(const uint8_t *response, const uint8_t *request)
 {
-    uint8_t * bufPtr = (uint8_t*)&vtxState.recvPkt;
-    while (serialRxBytesWaiting(vtxState.port)) {
-        const uint8_t c = serialRead(vtxState.port);
-
-        if (vtxState.recvPtr == 0) {
-            // Wait for sync byte
-            if (c == 0x0F) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-        }
-        else if (vtxState.recvPtr == 1) {
-            // Check if we received a valid response code
-            if (trampIsValidResponseCode(c)) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-            else {
-                vtxState.recvPtr = 0;
-            }
-        }
-        else {
-            // Consume character and check if we have got a full packet
-            if (vtxState.recvPtr < VTX_PKT_SIZE) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-
-            if (vtxState.recvPtr == VTX_PKT_SIZE) {
-                // Full packet received - validate packet, make sure it's the one we expect
-                const bool pktValid = ((bufPtr[14] == crc8_sum_update(0, &bufPtr[1], 13)) && (bufPtr[15] == 0));
+    UNUSED(request);
+    return trampIsValidResponseCode(response[1]) && (response[14] == crc8_sum_update(0, &response[1], 13)) && (response[15] == 0);
+}
 
-                if (!pktValid) {
-                    // Reset the receiver state - keep waiting
-                    vtxState.recvPtr = 0;
-                }
-                // Make sure it's not the echo one (half-duplex serial might receive it's own data)
-                else if (memcmp(&vtxState.recvPkt, &vtxState.sendPkt, VTX_PKT_SIZE) == 0) {
-                    vtxState.recvPtr = 0;
-                }
-                // Valid receive packet
-                else {
-                    return true;
-                }
-            }
-        }
+static bool vtxProtoRecv(void)
+{
+    if (vtxTransactionPoll(&vtxState.transaction) == VTX_TRANSACTION_DONE) {
+        vtxState.recvPkt = vtxTransactionResponse(&vtxState.transaction);
+        return true;
     }
 
     return false;
@@ -183,11 +150,9 @@ static void vtxProtoSend(uint8_t cmd, uint16_t param)
     vtxState.sendPkt[3] = (param >> 8) & 0xff;
     vtxState.sendPkt[14] = crc8_sum_update(0, &vtxState.sendPkt[1], 13);
 
-    // Send data 
-    serialWriteBuf(vtxState.port, (uint8_t *)&vtxState.sendPkt, sizeof(vtxState.sendPkt));
-
-    // Reset cmd response state
-    vtxState.recvPtr = 0;
+    // Set commands are not answered, queries are read back when the response frame is in
+    const bool isQuery = (cmd == 0x72 || cmd == 0x76);
+    vtxTransactionStart(&vtxState.transaction, vtxState.sendPkt, isQuery ? VTX_PROTO_STATE_TIMEOUT_MS : 0);
 }
 
 static void vtxProtoSetState(vtxProtoState_e newState)
@@ -196,9 +161,9 @@ static void vtxProtoSetState(vtxProtoState_e newState)
     vtxState.protoState = newState;
 }
 
-static bool vtxProtoTimeout(void)
+static bool vtxProtoCommandDelayElapsed(void)
 {
-    return (millis() - vtxState.lastStateChangeMs) > VTX_PROTO_STATE_TIMEOUT_MS;
+    return (millis() - vtxState.lastStateChangeMs) > VTX_PROTO_CMD_DELAY_MS;
 }
 
 static void vtxProtoQueryCapabilities(void)
@@ -275,7 +240,7 @@ static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
     UNUSED(vtxDevice);
     UNUSED(currentTimeUs);
 
-    if (!vtxState.port) {
+    if (!vtxState.transaction.port) {
         return;
     }
 
@@ -305,7 +270,7 @@ static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
                     vtxProtoSetState(VTX_STATE_RESET);
                 }
             }
-            else if (vtxProtoTimeout()) {
+            else if (vtxTransactionPoll(&vtxState.transaction) == VTX_TRANSACTION_TIMEOUT) {
                 // Time-out while waiting for capabilities. Reset the state
                 vtxProtoSetState(VTX_STATE_RESET);
             }
@@ -339,11 +304,11 @@ static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
             break;
 
         case VTX_STATE_QUERY_DELAY:
-            // We get here after sending the command. We give VTX some time to process the command
-            // and switch to VTX_STATE_QUERY_STATUS
-            if (vtxProtoTimeout()) {
+            // We get here after sending the command. We give VTX some time to process the command,
+            // send the next pending one or switch to VTX_STATE_QUERY_STATUS
+            if (vtxProtoCommandDelayElapsed()) {
                 // We gave VTX some time to process the command. Query status to confirm success
-                vtxProtoSetState(VTX_STATE_QUERY_STATUS);
+                vtxProtoSetState(vtxState.updateReqMask != VTX_UPDATE_REQ_NONE ? VTX_STATE_IDLE : VTX_STATE_QUERY_STATUS);
             }
             break;
 
@@ -375,7 +340,7 @@ static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
                     vtxProtoSetState(VTX_STATE_QUERY_STATUS);
                 }
             }
-            else if (vtxProtoTimeout()) {
+            else if (vtxTransactionPoll(&vtxState.transaction) == VTX_TRANSACTION_TIMEOUT) {
                 vtxState.protoTimeoutCount++;
                 if (vtxState.protoTimeoutCount > 3) {
                     vtxProtoSetState(VTX_STATE_RESET);
@@ -396,7 +361,7 @@ static vtxDevType_e impl_GetDeviceType(const vtxDevice_t *vtxDevice)
 
 static bool impl_IsReady(const vtxDevice_t *vtxDevice)
 {
-    return vtxDevice != NULL && vtxState.port != NULL && vtxState.protoState >= VTX_STATE_IDLE;
+    return vtxDevice != NULL && vtxState.transaction.port != NULL && vtxState.protoState >= VTX_STATE_IDLE;
 }
 
 static void impl_SetBandAndChannel(vtxDevice_t * vtxDevice, uint8_t band, uint8_t channel)
@@ -637,16 +602,11 @@ static void vtxProtoUpdatePowerMetadata(uint16_t maxPower)
 
 bool vtxTrampInit(void)
 {
-    serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_VTX_TRAMP);
-
-    if (portConfig) {
-        portOptions_t portOptions = 0;
-        portOptions = portOptions | (vtxConfig()->halfDuplex ? SERIAL_BIDIR : SERIAL_UNIDIR);
-        portOptions = portOptions | (vtxConfig()->softSerialShortStop ? SERIAL_SHORTSTOP : SERIAL_LONGSTOP);
-        vtxState.port = openSerialPort(portConfig->identifier, FUNCTION_VTX_TRAMP, NULL, NULL, 9600, MODE_RXTX, portOptions);
-    }
+    portOptions_t portOptions = 0;
+    portOptions = portOptions | (vtxConfig()->halfDuplex ? SERIAL_BIDIR : SERIAL_UNIDIR);
+    portOptions = portOptions | (vtxConfig()->softSerialShortStop ? SERIAL_SHORTSTOP : SERIAL_LONGSTOP);
 
-    if (!vtxState.port) {
+    if (!vtxTransactionOpen(&vtxState.transaction, FUNCTION_VTX_TRAMP, 9600, portOptions, 0x0F, VTX_PKT_SIZE, trampValidateResponse)) {
         return false;
     }
 
@@ -0,0 +1,147 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if (defined(USE_VTX_TRAMP) || defined(USE_VTX_FFPV)) && defined(USE_VTX_CONTROL)
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/time.h"
+
+#include "io/serial.h"
+#include "io/vtx_transaction.h"
+
+static volatile bool vtxTransactionEvent = false;
+
+// Receive ISR callback
+static void vtxTransactionDataReceive(uint16_t c, void *data)
+{
+    vtxTransaction_t *transaction = data;
+
+    // Hold everything until the task took the last frame
+    if (transaction->responseReady) {
+        return;
+    }
+
+    if (transaction->responsePos == 0 && c != transaction->syncByte) {
+        return;
+    }
+
+    transaction->response[transaction->responsePos++] = (uint8_t)c;
+
+    if (transaction->responsePos == transaction->frameSize) {
+        transaction->responsePos = 0;
+
+        // Half duplex lines read back our own request, it has to go before the VTX starts answering
+        if (memcmp(transaction->response, transaction->request, transaction->frameSize) != 0) {
+            transaction->responseReady = true;
+            vtxTransactionEvent = true;
+        }
+    }
+}
+
+bool vtxTransactionOpen(vtxTransaction_t *transaction, serialPortFunction_e function, uint32_t baudRate, portOptions_t options,
+                        uint8_t syncByte, uint8_t frameSize, vtxTransactionValidateFnPtr validateFn)
+{
+    memset(transaction, 0, sizeof(*transaction));
+
+    transaction->syncByte = syncByte;
+    transaction->frameSize = MIN(frameSize, VTX_TRANSACTION_FRAME_SIZE_MAX);
+    transaction->validateFn = validateFn;
+    transaction->status = VTX_TRANSACTION_IDLE;
+
+    const serialPortConfig_t *portConfig = findSerialPortConfig(function);
+    if (portConfig) {
+        transaction->port = openSerialPort(portConfig->identifier, function, vtxTransactionDataReceive, transaction, baudRate, MODE_RXTX, options);
+    }
+
+    return transaction->port != NULL;
+}
+
+void vtxTransactionStart(vtxTransaction_t *transaction, const uint8_t *request, timeMs_t timeoutMs)
+{
+    // Request goes in place before the bytes hit the wire, the receive callback compares against it
+    memcpy(transaction->request, request, transaction->frameSize);
+    transaction->responsePos = 0;
+    transaction->responseReady = false;
+
+    transaction->sentAtMs = millis();
+    transaction->timeoutMs = timeoutMs;
+    transaction->status = timeoutMs ? VTX_TRANSACTION_PENDING : VTX_TRANSACTION_IDLE;
+
+    serialWriteBuf(transaction->port, transaction->request, transaction->frameSize);
+}
+
+vtxTransactionStatus_e vtxTransactionPoll(vtxTransaction_t *transaction)
+{
+    if (transaction->status != VTX_TRANSACTION_PENDING) {
+        return transaction->status;
+    }
+
+    if (transaction->responseReady) {
+        if (!transaction->validateFn || transaction->validateFn(transaction->response, transaction->request)) {
+            transaction->status = VTX_TRANSACTION_DONE;
+            return transaction->status;
+        }
+
+        // Corrupted or unrelated frame, keep listening
+        transaction->responseReady = false;
+    }
+
+    if ((millis() - transaction->sentAtMs) > transaction->timeoutMs) {
+        transaction->status = VTX_TRANSACTION_TIMEOUT;
+    }
+
+    return transaction->status;
+}
+
+const uint8_t *vtxTransactionResponse(const vtxTransaction_t *transaction)
+{
+    return transaction->response;
+}
+
+bool vtxTransactionEventPending(void)
+{
+    if (vtxTransactionEvent) {
+        vtxTransactionEvent = false;
+        return true;
+    }
+
+    return false;
+}
+
+#else
+
+bool vtxTransactionEventPending(void)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#include "io/serial.h"
+
+#define VTX_TRANSACTION_FRAME_SIZE_MAX  16
+
+typedef enum {
+    VTX_TRANSACTION_IDLE = 0,       // Nothing sent yet or the command is not answered
+    VTX_TRANSACTION_PENDING,        // Request sent, waiting for the response
+    VTX_TRANSACTION_DONE,           // Valid response available
+    VTX_TRANSACTION_TIMEOUT,        // No valid response within the timeout
+} vtxTransactionStatus_e;
+
+// Checks a complete frame against the request it answers (checksum, command echo)
+typedef bool (*vtxTransactionValidateFnPtr)(const uint8_t *response, const uint8_t *request);
+
+/*
+ * Request/response exchange with a VTX talking fixed size frames that start
+ * with a sync byte. Responses are framed in the serial receive callback, a
+ * copy of our own request read back on a half duplex line is dropped there
+ * as well. The VTX task is signalled as soon as a frame is complete and the
+ * driver picks it up with vtxTransactionPoll() without ever waiting on the line.
+ */
+typedef struct vtxTransaction_s {
+    serialPort_t *                  port;
+    vtxTransactionValidateFnPtr     validateFn;
+    uint8_t                         syncByte;
+    uint8_t                         frameSize;
+
+    vtxTransactionStatus_e          status;
+    timeMs_t                        sentAtMs;
+    timeMs_t                        timeoutMs;
+
+    uint8_t                         request[VTX_TRANSACTION_FRAME_SIZE_MAX];
+    uint8_t                         response[VTX_TRANSACTION_FRAME_SIZE_MAX];
+    volatile uint8_t                responsePos;
+    volatile bool                   responseReady;
+} vtxTransaction_t;
+
+bool vtxTransactionOpen(vtxTransaction_t *transaction, serialPortFunction_e function, uint32_t baudRate, portOptions_t options,
+                        uint8_t syncByte, uint8_t frameSize, vtxTransactionValidateFnPtr validateFn);
+// timeoutMs of 0 sends a command the VTX does not answer, the transaction goes back to idle
+void vtxTransactionStart(vtxTransaction_t *transaction, const uint8_t *request, timeMs_t timeoutMs);
+vtxTransactionStatus_e vtxTransactionPoll(vtxTransaction_t *transaction);
+const uint8_t *vtxTransactionResponse(const vtxTransaction_t *transaction);
+
+// True when a response frame arrived since the last call, used to wake the VTX task
+bool vtxTransactionEventPending(void);
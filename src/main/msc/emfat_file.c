@@ -23,6 +23,7 @@
  */
 
 #include "platform.h"
+#include "common/maths.h"
 #include "common/utils.h"
 #include "common/printf.h"
 
@@ -298,11 +299,49 @@ static void memory_read_proc(uint8_t *dest, int size, uint32_t offset, emfat_ent
     memcpy(dest, &((char *)entry->user_data)[offset], len);
 }
 
+// Hosts read log files sector by sector. Fetch whole aligned blocks from the chip and serve them from RAM,
+// so each chip transaction moves a useful amount of data. The size is a multiple of the page size of all supported chips.
+#define BBLOG_READAHEAD_SIZE 4096
+
+static uint8_t bblogReadAheadBuf[BBLOG_READAHEAD_SIZE] __attribute__((aligned(4)));
+static uint32_t bblogReadAheadAddress;
+static uint32_t bblogReadAheadLength;  // 0 when nothing is cached
+
+static void bblogReadAheadFill(uint32_t address)
+{
+    // Some chips only read up to a page boundary per call
+    uint32_t total = 0;
+    while (total < BBLOG_READAHEAD_SIZE) {
+        const int bytesRead = flashfsReadAbs(address + total, &bblogReadAheadBuf[total], BBLOG_READAHEAD_SIZE - total);
+        if (bytesRead <= 0) {
+            break;
+        }
+        total += bytesRead;
+    }
+
+    bblogReadAheadAddress = address;
+    bblogReadAheadLength = total;
+}
+
 static void bblog_read_proc(uint8_t *dest, int size, uint32_t offset, emfat_entry_t *entry)
 {
     UNUSED(entry);
 
-    flashfsReadAbs(offset, dest, size);
+    while (size > 0) {
+        if (offset < bblogReadAheadAddress || offset >= bblogReadAheadAddress + bblogReadAheadLength) {
+            bblogReadAheadFill(offset & ~(BBLOG_READAHEAD_SIZE - 1));
+            if (offset >= bblogReadAheadAddress + bblogReadAheadLength) {
+                // Past the end of the volume
+                return;
+            }
+        }
+
+        const uint32_t len = MIN((uint32_t)size, bblogReadAheadAddress + bblogReadAheadLength - offset);
+        memcpy(dest, &bblogReadAheadBuf[offset - bblogReadAheadAddress], len);
+        dest += len;
+        offset += len;
+        size -= len;
+    }
 }
 
 static const emfat_entry_t entriesPredefined[] =
@@ -486,6 +525,7 @@ void emfat_init_files(void)
     emfat_entry_t *entry;
 
     flashfsInit();
+    bblogReadAheadLength = 0;
     flashfsUsedSpace = flashfsIdentifyStartOfFreeSpace();
 
     // Detect and create entries for each individual log
@@ -48,6 +48,10 @@ typedef enum {
     MSP_FLAG_DONT_REPLY           = (1 << 0),
 } mspFlags_e;
 
+// MSPv2 requests may carry a sequence tag in the upper flag bits. It is echoed back in the reply
+// so a host can keep several requests in flight and match the responses.
+#define MSP_FLAG_SEQUENCE_MASK  0xF0
+
 struct serialPort_s;
 typedef void (*mspPostProcessFnPtr)(struct serialPort_s *port); // msp post process function, used for gracefully handling reboots, etc.
 typedef mspResult_e (*mspProcessCommandFnPtr)(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn);
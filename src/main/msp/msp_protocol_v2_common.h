@@ -33,3 +33,6 @@
 #define MSP2_COMMON_SET_RADAR_POS       0x100B //SET radar position information
 #define MSP2_COMMON_SET_RADAR_ITD       0x100C //SET radar information to display
 
+#define MSP2_COMMON_SETTINGS            0x100D  //in/out message    Returns the values of several settings, selected by index or by PG
+#define MSP2_COMMON_SET_SETTINGS        0x100E  //in message        Sets the values of several settings, selected by index or by PG
+
@@ -84,4 +84,25 @@
 #define MSP2_INAV_MISC2                         0x203A
 #define MSP2_INAV_LOGIC_CONDITIONS_SINGLE       0x203B
 
-#define MSP2_INAV_ESC_RPM                       0x2040
\ No newline at end of file
+#define MSP2_INAV_ESC_RPM                       0x2040
+#define MSP2_INAV_TASK_HISTOGRAM                0x2041
+#define MSP2_INAV_PROFILING_ZONE                0x2042
+#define MSP2_INAV_SDCARD_STATS                  0x2043
+#define MSP2_INAV_DATAFLASH_STREAM              0x2044
+#define MSP2_INAV_DATAFLASH_STREAM_DATA         0x2045
+#define MSP2_INAV_MISSION_STORE_INFO            0x2046
+#define MSP2_INAV_MISSION_STORE_WP              0x2047
+#define MSP2_INAV_SET_MISSION_STORE_WP          0x2048
+#define MSP2_INAV_TERRAIN_INFO                  0x2049
+#define MSP2_INAV_SET_TERRAIN_TILE_DATA         0x204A
+#define MSP2_INAV_SET_TERRAIN_TILE              0x204B
+#define MSP2_INAV_TELEMETRY_SUBSCRIBE           0x204C
+#define MSP2_INAV_SMARTPORT_SENSOR_AGE          0x204D
+#define MSP2_INAV_STACK_INFO                    0x204E
+#define MSP2_INAV_RAM_MAP                       0x204F
+#define MSP2_INAV_FLASHFS_LOG_LIST              0x2050
+#define MSP2_INAV_FLASH_HEALTH                  0x2051
+#define MSP2_INAV_FWUPDT_STORE_AT               0x2052
+#define MSP2_INAV_RTH_ESTIMATE                  0x2053
+#define MSP2_INAV_TRACE                         0x2054
+#define MSP2_INAV_SIMULATOR_STREAM              0x2055
@@ -31,14 +31,22 @@
 #include "drivers/system.h"
 #include "drivers/serial.h"
 
+#include "io/flashfs.h"
 #include "io/serial.h"
 #include "fc/cli.h"
+#include "fc/runtime_config.h"
+#include "fc/simulator.h"
 
 #include "msp/msp.h"
+#include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
 
 static mspPort_t mspPorts[MAX_MSP_PORT_COUNT];
 
+// Replies and streamed frames are built here rather than on the stack. MSP ports are only
+// serviced from the main loop and each frame is fully encoded before the next one is built.
+static uint8_t mspSerialOutBuf[MSP_PORT_OUTBUF_SIZE];
+
 
 void resetMspPort(mspPort_t *mspPortToReset, serialPort_t *serialPort)
 {
@@ -265,6 +273,21 @@ static uint8_t mspSerialChecksumBuf(uint8_t checksum, const uint8_t *data, int l
     return checksum;
 }
 
+// MSPv2 over MSPv1 needs both the CRC8 and the XOR of the payload, walk it only once
+static void mspSerialChecksumPayloadV2OverV1(uint8_t *crc, uint8_t *checksum, const uint8_t *data, int len)
+{
+    uint8_t c = *crc;
+    uint8_t x = *checksum;
+
+    while (len-- > 0) {
+        c = crc8_dvb_s2(c, *data);
+        x ^= *data++;
+    }
+
+    *crc = c;
+    *checksum = x;
+}
+
 #define JUMBO_FRAME_SIZE_LIMIT 255
 static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, const uint8_t * data, int dataLen, const uint8_t * crc, int crcLen)
 {
@@ -358,15 +381,12 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
         hdrV2->size = dataLen;
 
         // V2 CRC: only V2 header + data payload
-        crcBuf[crcLen] = crc8_dvb_s2_update(0, (uint8_t *)hdrV2, sizeof(mspHeaderV2_t));
-        crcBuf[crcLen] = crc8_dvb_s2_update(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcLen++;
-
         // V1 CRC: All headers + data payload + V2 CRC byte
-        crcBuf[crcLen] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
-        crcBuf[crcLen] = mspSerialChecksumBuf(crcBuf[crcLen], sbufPtr(&packet->buf), dataLen);
-        crcBuf[crcLen] = mspSerialChecksumBuf(crcBuf[crcLen], crcBuf, crcLen);
-        crcLen++;
+        crcBuf[0] = crc8_dvb_s2_update(0, (uint8_t *)hdrV2, sizeof(mspHeaderV2_t));
+        crcBuf[1] = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
+        mspSerialChecksumPayloadV2OverV1(&crcBuf[0], &crcBuf[1], sbufPtr(&packet->buf), dataLen);
+        crcBuf[1] ^= crcBuf[0];
+        crcLen = 2;
     }
     else if (mspVersion == MSP_V2_NATIVE) {
         mspHeaderV2_t * hdrV2 = (mspHeaderV2_t *)&hdrBuf[hdrLen];
@@ -389,12 +409,311 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
     return mspSerialSendFrame(msp, hdrBuf, hdrLen, sbufPtr(&packet->buf), dataLen, crcBuf, crcLen);
 }
 
-static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+#ifdef USE_FLASHFS
+/*
+ * Streaming dataflash read. Unlike MSP_DATAFLASH_READ the host doesn't request every chunk: after START the FC
+ * pushes consecutive MSP2_INAV_DATAFLASH_STREAM_DATA frames (U16 sequence, U32 address, data) for as long as fewer
+ * than <window> chunks are unacknowledged. The host acknowledges cumulatively with the sequence number it expects
+ * next. A zero-length chunk marks the end of the requested range. To recover from a lost chunk the host simply
+ * restarts the stream from the first address it's missing.
+ *
+ * Request payload:
+ *  U8 action (mspDataflashStreamAction_e)
+ *  START: U32 address, U32 length (0 - up to the end of the logged data), U16 chunk size (0 - default), U8 window (0 - default)
+ *  ACK:   U16 next expected sequence number
+ *
+ * Reply: U8 active, U32 next address, U32 end address, U16 chunk size, U8 window, U16 next sequence number
+ */
+static mspResult_e mspSerialDataflashStreamCommand(mspPort_t *msp, sbuf_t *src, sbuf_t *dst)
+{
+    mspDataflashStream_t *stream = &msp->dataflashStream;
+    uint8_t action;
+
+    if (!sbufReadU8Safe(&action, src)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    switch (action) {
+    case MSP_DATAFLASH_STREAM_STOP:
+        stream->active = false;
+        break;
+
+    case MSP_DATAFLASH_STREAM_START:
+        {
+            if (sbufBytesRemaining(src) < 11 || ARMING_FLAG(ARMED) || !flashfsIsReady()) {
+                return MSP_RESULT_ERROR;
+            }
+
+            const uint32_t address = sbufReadU32(src);
+            const uint32_t length = sbufReadU32(src);
+            const uint16_t chunkSize = sbufReadU16(src);
+            const uint8_t window = sbufReadU8(src);
+            const uint32_t dataEnd = length ? flashfsGetSize() : flashfsGetOffset();
+
+            if (address > dataEnd) {
+                return MSP_RESULT_ERROR;
+            }
+
+            stream->address = address;
+            stream->endAddress = length ? MIN(dataEnd - address, length) + address : dataEnd;
+            stream->chunkSize = chunkSize ? MIN(chunkSize, MSP_PORT_DATAFLASH_BUFFER_SIZE) : MSP_DATAFLASH_STREAM_DEFAULT_CHUNK_SIZE;
+            stream->window = window ? MIN(window, MSP_DATAFLASH_STREAM_MAX_WINDOW) : MSP_DATAFLASH_STREAM_DEFAULT_WINDOW;
+            stream->nextSeq = 0;
+            stream->ackedSeq = 0;
+            stream->endSent = false;
+            stream->mspVersion = msp->mspVersion;
+            stream->lastAckMs = millis();
+            stream->active = true;
+        }
+        break;
+
+    case MSP_DATAFLASH_STREAM_ACK:
+        {
+            uint16_t ackedSeq;
+
+            if (!stream->active || !sbufReadU16Safe(&ackedSeq, src)) {
+                return MSP_RESULT_ERROR;
+            }
+
+            // Ignore stale acknowledgements and ones for chunks that weren't sent yet
+            if ((uint16_t)(ackedSeq - stream->ackedSeq) <= (uint16_t)(stream->nextSeq - stream->ackedSeq)) {
+                stream->ackedSeq = ackedSeq;
+                stream->lastAckMs = millis();
+            }
+
+            // Everything including the end marker has been received
+            if (stream->endSent && stream->ackedSeq == stream->nextSeq) {
+                stream->active = false;
+            }
+        }
+        break;
+
+    default:
+        return MSP_RESULT_ERROR;
+    }
+
+    sbufWriteU8(dst, stream->active);
+    sbufWriteU32(dst, stream->address);
+    sbufWriteU32(dst, stream->endAddress);
+    sbufWriteU16(dst, stream->chunkSize);
+    sbufWriteU8(dst, stream->window);
+    sbufWriteU16(dst, stream->nextSeq);
+
+    return MSP_RESULT_ACK;
+}
+
+static void mspSerialDataflashStreamProcess(mspPort_t *msp)
+{
+    mspDataflashStream_t *stream = &msp->dataflashStream;
+
+    if (!stream->active) {
+        return;
+    }
+
+    // Host went away or the FC got armed meanwhile
+    if (ARMING_FLAG(ARMED) || millis() - stream->lastAckMs > MSP_DATAFLASH_STREAM_ACK_TIMEOUT_MS) {
+        stream->active = false;
+        return;
+    }
+
+    while (!stream->endSent && (uint16_t)(stream->nextSeq - stream->ackedSeq) < stream->window) {
+        mspPacket_t push = {
+            .buf = { .ptr = mspSerialOutBuf, .end = ARRAYEND(mspSerialOutBuf), },
+            .cmd = MSP2_INAV_DATAFLASH_STREAM_DATA,
+            .flags = 0,
+            .result = 0,
+        };
+
+        const uint16_t readLen = MIN(stream->endAddress - stream->address, stream->chunkSize);
+
+        sbufWriteU16(&push.buf, stream->nextSeq);
+        sbufWriteU32(&push.buf, stream->address);
+        const int bytesRead = readLen ? flashfsReadAbs(stream->address, sbufPtr(&push.buf), readLen) : 0;
+        sbufAdvance(&push.buf, bytesRead);
+        sbufSwitchToReader(&push.buf, mspSerialOutBuf);
+
+        // TX buffer full - try again on the next call, the chunk is re-read then
+        if (!mspSerialEncode(msp, &push, stream->mspVersion)) {
+            break;
+        }
+
+        stream->address += bytesRead;
+        stream->endSent = (bytesRead == 0);
+        stream->nextSeq++;
+    }
+}
+#endif
+
+/*
+ * Only side effect free out messages can be subscribed to, they are produced by the regular command processor
+ * with an empty request payload.
+ */
+static const uint16_t mspSubscribableCommands[] = {
+    MSP_STATUS,
+    MSP_STATUS_EX,
+    MSP_RAW_IMU,
+    MSP_SERVO,
+    MSP_MOTOR,
+    MSP_RC,
+    MSP_RAW_GPS,
+    MSP_COMP_GPS,
+    MSP_ATTITUDE,
+    MSP_ALTITUDE,
+    MSP_ANALOG,
+    MSP_NAV_STATUS,
+    MSP_SONAR_ALTITUDE,
+    MSP2_INAV_STATUS,
+    MSP2_INAV_ANALOG,
+    MSP2_INAV_AIR_SPEED,
+    MSP2_INAV_MISC2,
+    MSP2_INAV_ESC_RPM,
+};
+
+static bool mspSerialIsSubscribable(uint16_t cmd)
+{
+    for (unsigned i = 0; i < ARRAYLEN(mspSubscribableCommands); i++) {
+        if (mspSubscribableCommands[i] == cmd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static mspSubscription_t *mspSerialFindSubscription(mspSubscriptions_t *subscriptions, uint16_t cmd)
+{
+    for (int i = 0; i < subscriptions->count; i++) {
+        if (subscriptions->items[i].cmd == cmd) {
+            return &subscriptions->items[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Telemetry subscription. Replaces request/response polling of out messages: the FC pushes every subscribed
+ * message on this port at the requested rate, as long as the TX buffer has room for it.
+ *
+ * Request payload: zero or more of
+ *  U16 command, U8 rate in Hz (0 - unsubscribe, capped to MSP_SUBSCRIPTION_MAX_RATE_HZ)
+ * An empty payload removes all subscriptions. Entries are validated before any of them is applied.
+ *
+ * Reply: U8 subscription count, then U16 command and U8 rate in Hz for every active subscription
+ */
+static mspResult_e mspSerialSubscribeCommand(mspPort_t *msp, sbuf_t *src, sbuf_t *dst)
+{
+    mspSubscriptions_t *subscriptions = &msp->subscriptions;
+    const int entryCount = sbufBytesRemaining(src) / 3;
+
+    if (sbufBytesRemaining(src) % 3) {
+        return MSP_RESULT_ERROR;
+    }
+
+    if (entryCount == 0) {
+        subscriptions->count = 0;
+    }
+
+    // Validate first, so a bad request leaves existing subscriptions untouched
+    sbuf_t validate = *src;
+    int newCount = subscriptions->count;
+    for (int i = 0; i < entryCount; i++) {
+        const uint16_t cmd = sbufReadU16(&validate);
+        const uint8_t rateHz = sbufReadU8(&validate);
+
+        if (!mspSerialIsSubscribable(cmd)) {
+            return MSP_RESULT_ERROR;
+        }
+        if (rateHz && !mspSerialFindSubscription(subscriptions, cmd)) {
+            newCount++;
+        }
+    }
+
+    if (newCount > MSP_SUBSCRIPTION_MAX_COUNT) {
+        return MSP_RESULT_ERROR;
+    }
+
+    const timeMs_t currentTimeMs = millis();
+    for (int i = 0; i < entryCount; i++) {
+        const uint16_t cmd = sbufReadU16(src);
+        const uint8_t rateHz = MIN(sbufReadU8(src), MSP_SUBSCRIPTION_MAX_RATE_HZ);
+        mspSubscription_t *subscription = mspSerialFindSubscription(subscriptions, cmd);
+
+        if (rateHz == 0) {
+            if (subscription) {
+                *subscription = subscriptions->items[--subscriptions->count];
+            }
+            continue;
+        }
+
+        if (!subscription) {
+            subscription = &subscriptions->items[subscriptions->count++];
+            subscription->cmd = cmd;
+            subscription->lastSentMs = currentTimeMs;
+        }
+        subscription->periodMs = 1000 / rateHz;
+    }
+
+    subscriptions->mspVersion = msp->mspVersion;
+    subscriptions->nextIdx = 0;
+
+    sbufWriteU8(dst, subscriptions->count);
+    for (int i = 0; i < subscriptions->count; i++) {
+        sbufWriteU16(dst, subscriptions->items[i].cmd);
+        sbufWriteU8(dst, 1000 / subscriptions->items[i].periodMs);
+    }
+
+    return MSP_RESULT_ACK;
+}
+
+static void mspSerialSubscriptionsProcess(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
 {
-    uint8_t outBuf[MSP_PORT_OUTBUF_SIZE];
+    mspSubscriptions_t *subscriptions = &msp->subscriptions;
+    const timeMs_t currentTimeMs = millis();
 
+    for (int n = 0; n < subscriptions->count; n++) {
+        const int idx = (subscriptions->nextIdx + n) % subscriptions->count;
+        mspSubscription_t *subscription = &subscriptions->items[idx];
+
+        if (currentTimeMs - subscription->lastSentMs < subscription->periodMs) {
+            continue;
+        }
+
+        mspPacket_t push = {
+            .buf = { .ptr = mspSerialOutBuf, .end = ARRAYEND(mspSerialOutBuf), },
+            .cmd = subscription->cmd,
+            .flags = 0,
+            .result = 0,
+        };
+        mspPacket_t command = {
+            .buf = { .ptr = msp->inBuf, .end = msp->inBuf, },
+            .cmd = subscription->cmd,
+            .flags = 0,
+            .result = 0,
+        };
+        mspPostProcessFnPtr mspPostProcessFn = NULL;
+
+        // Message not supported by this build, drop it instead of pushing errors
+        if (mspProcessCommandFn(&command, &push, &mspPostProcessFn) != MSP_RESULT_ACK) {
+            *subscription = subscriptions->items[--subscriptions->count];
+            n--;
+            continue;
+        }
+
+        sbufSwitchToReader(&push.buf, mspSerialOutBuf);
+
+        // TX buffer full - leave the rest for the next call, starting with this one
+        if (!mspSerialEncode(msp, &push, subscriptions->mspVersion)) {
+            subscriptions->nextIdx = idx;
+            return;
+        }
+
+        subscription->lastSentMs = currentTimeMs;
+    }
+}
+
+static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+{
     mspPacket_t reply = {
-        .buf = { .ptr = outBuf, .end = ARRAYEND(outBuf), },
+        .buf = { .ptr = mspSerialOutBuf, .end = ARRAYEND(mspSerialOutBuf), },
         .cmd = -1,
         .flags = 0,
         .result = 0,
@@ -409,9 +728,40 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
     };
 
     mspPostProcessFnPtr mspPostProcessFn = NULL;
-    const mspResult_e status = mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
+    mspResult_e status;
+
+#ifdef USE_FLASHFS
+    // Streaming state lives in the MSP port, so this command is handled here rather than by the FC command processor
+    if (command.cmd == MSP2_INAV_DATAFLASH_STREAM) {
+        status = mspSerialDataflashStreamCommand(msp, &command.buf, &reply.buf);
+        if (command.flags & MSP_FLAG_DONT_REPLY) {
+            status = MSP_RESULT_NO_REPLY;
+        }
+        reply.cmd = command.cmd;
+        reply.result = status;
+    } else
+#endif
+#ifdef USE_SIMULATOR_STREAM
+    if (command.cmd == MSP2_INAV_SIMULATOR_STREAM) {
+        // Actuator frames go back to the port the sensor frames come from, there is nothing to reply
+        simulatorStreamReceive(msp, &command.buf);
+        status = MSP_RESULT_NO_REPLY;
+    } else
+#endif
+    if (command.cmd == MSP2_INAV_TELEMETRY_SUBSCRIBE) {
+        // Subscriptions are per port as well
+        status = mspSerialSubscribeCommand(msp, &command.buf, &reply.buf);
+        if (command.flags & MSP_FLAG_DONT_REPLY) {
+            status = MSP_RESULT_NO_REPLY;
+        }
+        reply.cmd = command.cmd;
+        reply.result = status;
+    } else {
+        status = mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
+    }
 
     if (status != MSP_RESULT_NO_REPLY) {
+        reply.flags |= command.flags & MSP_FLAG_SEQUENCE_MASK;
         sbufSwitchToReader(&reply.buf, outBufHead); // change streambuf direction
         mspSerialEncode(msp, &reply, msp->mspVersion);
     }
@@ -462,12 +812,16 @@ void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e
 {
     mspPostProcessFnPtr mspPostProcessFn = NULL;
 
+    // Cleared before reading, bytes landing from here on raise it again
+    serialClearRxSignal(mspPort->port);
+
     if (serialRxBytesWaiting(mspPort->port)) {
         // There are bytes incoming - abort pending request
         mspPort->lastActivityMs = millis();
         mspPort->pendingRequest = MSP_PENDING_NONE;
 
         // Process incoming bytes
+        unsigned commandsProcessed = 0;
         while (serialRxBytesWaiting(mspPort->port)) {
             const uint8_t c = serialRead(mspPort->port);
             const bool consumed = mspSerialProcessReceivedData(mspPort, c);
@@ -478,18 +832,37 @@ void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e
 
             if (mspPort->c_state == MSP_COMMAND_RECEIVED) {
                 mspPostProcessFn = mspSerialProcessReceivedCommand(mspPort, mspProcessCommandFn);
-                break; // process one command at a time so as not to block.
+
+                // Keep serving pipelined requests, but bounded so as not to block, and never past
+                // a command that needs post-processing or when the reply could not be queued
+                if (mspPostProcessFn || ++commandsProcessed >= MSP_PORT_MAX_PIPELINED_REQUESTS ||
+                    !mspPort->port || serialTxBytesFree(mspPort->port) < MSP_PORT_PIPELINE_TX_RESERVE) {
+                    break;
+                }
             }
         }
 
         if (mspPostProcessFn) {
             waitForSerialPortToFinishTransmitting(mspPort->port);
             mspPostProcessFn(mspPort->port);
+        } else if (mspPort->port && serialRxBytesWaiting(mspPort->port)) {
+            // Requests left behind by the pipelining bound are served on the next pass
+            mspPort->port->rxSignalled = true;
         }
     }
     else {
         mspProcessPendingRequest(mspPort);
     }
+
+#ifdef USE_FLASHFS
+    if (mspPort->port) {
+        mspSerialDataflashStreamProcess(mspPort);
+    }
+#endif
+
+    if (mspPort->port && mspPort->subscriptions.count) {
+        mspSerialSubscriptionsProcess(mspPort, mspProcessCommandFn);
+    }
 }
 
 /*
@@ -497,6 +870,17 @@ void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e
  *
  * Called periodically by the scheduler.
  */
+bool mspSerialRxPending(void)
+{
+    for (uint8_t portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
+        const mspPort_t * const mspPort = &mspPorts[portIndex];
+        if (mspPort->port && serialRxSignalled(mspPort->port)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn)
 {
     for (uint8_t portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
@@ -515,18 +899,13 @@ void mspSerialInit(void)
 
 int mspSerialPushPort(uint16_t cmd, const uint8_t *data, int datalen, mspPort_t *mspPort, mspVersion_e version)
 {
-    uint8_t pushBuf[MSP_PORT_OUTBUF_SIZE];
-
+    // Encode straight from the caller's buffer, mspSerialEncode only reads the payload
     mspPacket_t push = {
-        .buf = { .ptr = pushBuf, .end = ARRAYEND(pushBuf), },
+        .buf = { .ptr = (uint8_t *)data, .end = (uint8_t *)data + datalen, },
         .cmd = cmd,
         .result = 0,
     };
 
-    sbufWriteData(&push.buf, data, datalen);
-
-    sbufSwitchToReader(&push.buf, pushBuf);
-
     return mspSerialEncode(mspPort, &push, version);
 }
 
@@ -60,7 +60,7 @@ typedef enum {
 #ifdef USE_FLASHFS
 #define MSP_PORT_DATAFLASH_BUFFER_SIZE 4096
 #define MSP_PORT_DATAFLASH_INFO_SIZE 16
-#define MSP_PORT_OUTBUF_SIZE (MSP_PORT_DATAFLASH_BUFFER_SIZE + MSP_PORT_DATAFLASH_INFO_SIZE)    // WARNING! Must fit in stack!
+#define MSP_PORT_OUTBUF_SIZE (MSP_PORT_DATAFLASH_BUFFER_SIZE + MSP_PORT_DATAFLASH_INFO_SIZE)    // Single static buffer in msp_serial.c
 #else
 #define MSP_PORT_OUTBUF_SIZE 512
 #endif
@@ -82,6 +82,55 @@ typedef struct __attribute__((packed)) {
 
 #define MSP_MAX_HEADER_SIZE     9
 
+// Requests already sitting in the RX buffer are answered back to back, up to this many per call,
+// as long as the TX buffer has room for another typical reply
+#define MSP_PORT_MAX_PIPELINED_REQUESTS     4
+#define MSP_PORT_PIPELINE_TX_RESERVE        128
+
+#ifdef USE_FLASHFS
+// Dataflash streaming (MSP2_INAV_DATAFLASH_STREAM): FC pushes consecutive chunks, host acknowledges a sliding window
+#define MSP_DATAFLASH_STREAM_DEFAULT_CHUNK_SIZE     2048
+#define MSP_DATAFLASH_STREAM_DEFAULT_WINDOW         4
+#define MSP_DATAFLASH_STREAM_MAX_WINDOW             32
+#define MSP_DATAFLASH_STREAM_ACK_TIMEOUT_MS         1000
+
+typedef enum {
+    MSP_DATAFLASH_STREAM_STOP   = 0,
+    MSP_DATAFLASH_STREAM_START  = 1,
+    MSP_DATAFLASH_STREAM_ACK    = 2,
+} mspDataflashStreamAction_e;
+
+typedef struct mspDataflashStream_s {
+    bool active;
+    bool endSent;               // zero-length end-of-stream chunk has been sent
+    mspVersion_e mspVersion;
+    uint32_t address;           // flash address of the next chunk to send
+    uint32_t endAddress;
+    uint16_t chunkSize;
+    uint16_t nextSeq;           // sequence number of the next chunk to send
+    uint16_t ackedSeq;          // host has received all chunks before this one
+    uint8_t window;             // maximum number of unacknowledged chunks
+    timeMs_t lastAckMs;
+} mspDataflashStream_t;
+#endif
+
+// Telemetry subscriptions (MSP2_INAV_TELEMETRY_SUBSCRIBE): FC pushes selected out messages at a requested rate
+#define MSP_SUBSCRIPTION_MAX_COUNT      8
+#define MSP_SUBSCRIPTION_MAX_RATE_HZ    50
+
+typedef struct mspSubscription_s {
+    uint16_t cmd;
+    uint16_t periodMs;
+    timeMs_t lastSentMs;
+} mspSubscription_t;
+
+typedef struct mspSubscriptions_s {
+    mspVersion_e mspVersion;
+    uint8_t count;
+    uint8_t nextIdx;            // round-robin start, so a slow link doesn't starve the last subscriptions
+    mspSubscription_t items[MSP_SUBSCRIPTION_MAX_COUNT];
+} mspSubscriptions_t;
+
 struct serialPort_s;
 typedef struct mspPort_s {
     struct serialPort_s *port; // null when port unused.
@@ -96,12 +145,17 @@ typedef struct mspPort_s {
     uint16_t cmdMSP;
     uint8_t checksum1;
     uint8_t checksum2;
+#ifdef USE_FLASHFS
+    mspDataflashStream_t dataflashStream;
+#endif
+    mspSubscriptions_t subscriptions;
 } mspPort_t;
 
 
 void mspSerialInit(void);
 void resetMspPort(mspPort_t *mspPortToReset, serialPort_t *serialPort);
 void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn);
+bool mspSerialRxPending(void);
 void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn);
 void mspSerialAllocatePorts(void);
 void mspSerialReleasePortIfAllocated(struct serialPort_s *serialPort);
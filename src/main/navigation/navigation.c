@@ -98,7 +98,7 @@ STATIC_ASSERT(NAV_MAX_WAYPOINTS < 254, NAV_MAX_WAYPOINTS_exceeded_allowable_rang
 PG_REGISTER_ARRAY(navWaypoint_t, NAV_MAX_WAYPOINTS, nonVolatileWaypointList, PG_WAYPOINT_MISSION_STORAGE, 2);
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(navConfig_t, navConfig, PG_NAV_CONFIG, 2);
+PG_REGISTER_WITH_RESET_TEMPLATE(navConfig_t, navConfig, PG_NAV_CONFIG, 7);
 
 PG_RESET_TEMPLATE(navConfig_t, navConfig,
     .general = {
@@ -151,6 +151,10 @@ PG_RESET_TEMPLATE(navConfig_t, navConfig,
         .max_altitude = SETTING_NAV_MAX_ALTITUDE_DEFAULT,
         .rth_trackback_distance = SETTING_NAV_RTH_TRACKBACK_DISTANCE_DEFAULT,                   // Max distance allowed for RTH trackback
         .waypoint_enforce_altitude = SETTING_NAV_WP_ENFORCE_ALTITUDE_DEFAULT,                   // Forces set wp altitude to be achieved
+#ifdef USE_TERRAIN
+        .waypoint_terrain_following = SETTING_NAV_WP_TERRAIN_FOLLOWING_DEFAULT,                 // Waypoint altitudes are above terrain
+        .waypoint_terrain_lookahead = SETTING_NAV_WP_TERRAIN_LOOKAHEAD_DEFAULT,                 // meters
+#endif
     },
 
     // MC-specific
@@ -172,6 +176,8 @@ PG_RESET_TEMPLATE(navConfig_t, navConfig,
         .posDecelerationTime = SETTING_NAV_MC_POS_DECELERATION_TIME_DEFAULT,          // posDecelerationTime * 100
         .posResponseExpo = SETTING_NAV_MC_POS_EXPO_DEFAULT,                           // posResponseExpo * 100
         .slowDownForTurning = SETTING_NAV_MC_WP_SLOWDOWN_DEFAULT,
+        .posTrajectory = SETTING_NAV_MC_POS_TRAJECTORY_DEFAULT,
+        .landDetectFusion = SETTING_NAV_MC_LAND_DETECT_FUSION_DEFAULT,
     },
 
     // Fixed wing
@@ -203,6 +209,7 @@ PG_RESET_TEMPLATE(navConfig_t, navConfig,
         .launch_max_angle = SETTING_NAV_FW_LAUNCH_MAX_ANGLE_DEFAULT,            // 45 deg
         .launch_manual_throttle = SETTING_NAV_FW_LAUNCH_MANUAL_THROTTLE_DEFAULT,// OFF
         .launch_abort_deadband = SETTING_NAV_FW_LAUNCH_ABORT_DEADBAND_DEFAULT,  // 100 us
+        .launch_fast_detect = SETTING_NAV_FW_LAUNCH_FAST_DETECT_DEFAULT,        // OFF
 
         .cruise_yaw_rate  = SETTING_NAV_FW_CRUISE_YAW_RATE_DEFAULT,             // 20dps
         .allow_manual_thr_increase = SETTING_NAV_FW_ALLOW_MANUAL_THR_INCREASE_DEFAULT,
@@ -213,6 +220,9 @@ PG_RESET_TEMPLATE(navConfig_t, navConfig,
         .wp_tracking_accuracy = SETTING_NAV_FW_WP_TRACKING_ACCURACY_DEFAULT,    // 0, improves course tracking accuracy during FW WP missions
         .wp_tracking_max_angle = SETTING_NAV_FW_WP_TRACKING_MAX_ANGLE_DEFAULT,  // 60 degs    CR67
         .wp_turn_smoothing = SETTING_NAV_FW_WP_TURN_SMOOTHING_DEFAULT,          // 0, smooths turns during FW WP mode missions
+        .lateral_guidance = SETTING_NAV_FW_LATERAL_GUIDANCE_DEFAULT,            // LEGACY
+        .l1_period = SETTING_NAV_FW_L1_PERIOD_DEFAULT,                          // 17 s
+        .l1_damping = SETTING_NAV_FW_L1_DAMPING_DEFAULT,                        // 75 %
     }
 );
 
@@ -247,6 +257,10 @@ void resetGCSFlags(void);
 static void setupJumpCounters(void);
 static void resetJumpCounter(void);
 static void clearJumpCounters(void);
+#ifdef USE_MISSION_STORE
+static bool loadMissionStoreWindow(uint16_t windowStart);
+static void advanceMissionStoreWindow(void);
+#endif
 
 static void calculateAndSetActiveWaypoint(const navWaypoint_t * waypoint);
 static void calculateAndSetActiveWaypointToLocalPosition(const fpVector3_t * pos);
@@ -269,6 +283,7 @@ static bool rthAltControlStickOverrideCheck(unsigned axis);
 
 static void updateRthTrackback(bool forceSaveTrackPoint);
 static fpVector3_t * rthGetTrackbackPos(void);
+static void rthTrackbackResetPoints(void);
 
 /*************************************************************************************************/
 static navigationFSMEvent_t navOnEnteringState_NAV_STATE_IDLE(navigationFSMState_t previousState);
@@ -1326,26 +1341,26 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_RTH_TRACKBACK(navigatio
     }
 
     if (posControl.flags.estPosStatus >= EST_USABLE) {
-        const int32_t distFromStartTrackback = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.rthTBLastSavedIndex]) / 100;
+        const int32_t distFromStartTrackback = calculateDistanceToDestination(&posControl.rthTBLastPoint) / 100;
         const bool cancelTrackback = distFromStartTrackback > navConfig()->general.rth_trackback_distance ||
                                      (rthAltControlStickOverrideCheck(ROLL) && !posControl.flags.forcedRTHActivated);
 
         if (posControl.activeRthTBPointIndex < 0 || cancelTrackback) {
-            posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = -1;
+            rthTrackbackResetPoints();
             posControl.flags.rthTrackbackActive = false;
             return NAV_FSM_EVENT_SWITCH_TO_NAV_STATE_RTH_INITIALIZE;    // procede to home after final trackback point
         }
 
         if (isWaypointReached(&posControl.activeWaypoint.pos, &posControl.activeWaypoint.yaw)) {
+            // Step back to the previous point, -1 once the oldest point is reached
+            const navRthTrackbackOffset_t *offset = &posControl.rthTBPointOffsets[posControl.activeRthTBPointIndex];
             posControl.activeRthTBPointIndex--;
 
-            if (posControl.rthTBWrapAroundCounter > -1 && posControl.activeRthTBPointIndex < 0) {
-                posControl.activeRthTBPointIndex = NAV_RTH_TRACKBACK_POINTS - 1;
-            }
-            calculateAndSetActiveWaypointToLocalPosition(rthGetTrackbackPos());
-
-            if (posControl.activeRthTBPointIndex - posControl.rthTBWrapAroundCounter == 0) {
-                posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = -1;
+            if (posControl.activeRthTBPointIndex >= 0) {
+                posControl.rthTBActivePoint.x -= offset->x * NAV_RTH_TRACKBACK_POINT_UNIT;
+                posControl.rthTBActivePoint.y -= offset->y * NAV_RTH_TRACKBACK_POINT_UNIT;
+                posControl.rthTBActivePoint.z -= offset->z * NAV_RTH_TRACKBACK_POINT_UNIT;
+                calculateAndSetActiveWaypointToLocalPosition(rthGetTrackbackPos());
             }
         } else {
             setDesiredPosition(rthGetTrackbackPos(), 0, NAV_POS_UPDATE_XY | NAV_POS_UPDATE_Z | NAV_POS_UPDATE_BEARING);
@@ -1530,6 +1545,11 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_WAYPOINT_INITIALIZE(nav
   Using p3 minimises the risk of saving an invalid counter if a mission is aborted.
 */
         if (posControl.activeWaypointIndex == 0 || posControl.wpMissionRestart) {
+#ifdef USE_MISSION_STORE
+            if (posControl.missionStoreActive && posControl.missionStoreWindowStart && !loadMissionStoreWindow(0)) {
+                return NAV_FSM_EVENT_ERROR;
+            }
+#endif
             setupJumpCounters();
             posControl.activeWaypointIndex = 0;
             wpHeadingControl.mode = NAV_WP_HEAD_MODE_NONE;
@@ -1635,9 +1655,21 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_WAYPOINT_IN_PROGRESS(na
                     fpVector3_t tmpWaypoint;
                     tmpWaypoint.x = posControl.activeWaypoint.pos.x;
                     tmpWaypoint.y = posControl.activeWaypoint.pos.y;
-                    tmpWaypoint.z = scaleRangef(constrainf(posControl.wpDistance, posControl.wpInitialDistance / 10.0f, posControl.wpInitialDistance),
-                        posControl.wpInitialDistance, posControl.wpInitialDistance / 10.0f,
-                        posControl.wpInitialAltitude, posControl.activeWaypoint.pos.z);
+#ifdef USE_TERRAIN
+                    float terrainAltitude;
+                    const navWaypoint_t *waypoint = &posControl.waypointList[posControl.activeWaypointIndex];
+                    if (navConfig()->general.waypoint_terrain_following && waypointMissionAltConvMode(waypoint->p3) == GEO_ALT_RELATIVE &&
+                        terrainGetAltitudeAlongPath(&navGetCurrentActualPositionAndVelocity()->pos, &posControl.activeWaypoint.pos, navConfig()->general.waypoint_terrain_lookahead, &terrainAltitude)) {
+                        // Waypoint altitude is above the highest terrain under the craft and ahead of it
+                        posControl.activeWaypoint.pos.z = terrainAltitude + waypoint->alt;
+                        tmpWaypoint.z = posControl.activeWaypoint.pos.z;
+                    } else
+#endif
+                    {
+                        tmpWaypoint.z = scaleRangef(constrainf(posControl.wpDistance, posControl.wpInitialDistance / 10.0f, posControl.wpInitialDistance),
+                            posControl.wpInitialDistance, posControl.wpInitialDistance / 10.0f,
+                            posControl.wpInitialAltitude, posControl.activeWaypoint.pos.z);
+                    }
                     setDesiredPosition(&tmpWaypoint, 0, NAV_POS_UPDATE_XY | NAV_POS_UPDATE_Z | NAV_POS_UPDATE_BEARING);
                     if(STATE(MULTIROTOR)) {
                         switch (wpHeadingControl.mode) {
@@ -1766,6 +1798,9 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_WAYPOINT_NEXT(navigatio
     else {
         // Waypoint reached, do something and move on to next waypoint
         posControl.activeWaypointIndex++;
+#ifdef USE_MISSION_STORE
+        advanceMissionStoreWindow();
+#endif
         return NAV_FSM_EVENT_SUCCESS;   // will switch to NAV_STATE_WAYPOINT_PRE_ACTION
     }
 }
@@ -2096,6 +2131,9 @@ void updateActualAltitudeAndClimbRate(bool estimateValid, float newAltitude, flo
         posControl.flags.verticalPositionDataNew = false;
     }
 
+    // Altitude is published last, home/statistics/mission bookkeeping may run again
+    posControl.flags.estimateUpdated = true;
+
     if (ARMING_FLAG(ARMED)) {
         if ((posControl.flags.estAglStatus == EST_TRUSTED) && surfaceDistance > 0) {
             if (posControl.actualState.surfaceMin > 0) {
@@ -2153,8 +2191,7 @@ void updateActualHeading(bool headingValid, int32_t newHeading)
     posControl.flags.estHeadingStatus = newEstHeading;
 
     /* Precompute sin/cos of yaw angle */
-    posControl.actualState.sinYaw = sin_approx(CENTIDEGREES_TO_RADIANS(newHeading));
-    posControl.actualState.cosYaw = cos_approx(CENTIDEGREES_TO_RADIANS(newHeading));
+    sincos_approx(CENTIDEGREES_TO_RADIANS(newHeading), &posControl.actualState.sinYaw, &posControl.actualState.cosYaw);
 }
 
 /*-----------------------------------------------------------
@@ -2641,7 +2678,118 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
  * Reverts to normal RTH heading direct to home when end of track reached.
  * Trackpoints logged with precedence for course/altitude changes. Distance based changes
  * only logged if no course/altitude changes logged over an extended distance.
+ * Points are stored as whole metre offsets from the previous point. When the store is
+ * full the point closest to the line between its neighbours is dropped, so the track
+ * loses detail rather than its oldest part.
  * --------------------------------------------------------------------------------- */
+static void rthTrackbackResetPoints(void)
+{
+    posControl.rthTBPointCount = 0;
+    posControl.activeRthTBPointIndex = -1;
+}
+
+// Squared distance (m^2) of a point from the segment between its neighbours, given the offsets to and from it
+static float rthTrackbackPointDeviationSq(const navRthTrackbackOffset_t *toPoint, const navRthTrackbackOffset_t *toNext)
+{
+    const float segX = toPoint->x + toNext->x;
+    const float segY = toPoint->y + toNext->y;
+    const float segZ = toPoint->z + toNext->z;
+    const float segLengthSq = sq(segX) + sq(segY) + sq(segZ);
+
+    float t = 0.0f;
+    if (segLengthSq > 0.0f) {
+        t = constrainf((toPoint->x * segX + toPoint->y * segY + toPoint->z * segZ) / segLengthSq, 0.0f, 1.0f);
+    }
+
+    return sq(toPoint->x - t * segX) + sq(toPoint->y - t * segY) + sq(toPoint->z - t * segZ);
+}
+
+static void rthTrackbackDecimate(void)
+{
+    navRthTrackbackOffset_t *offsets = posControl.rthTBPointOffsets;
+    float minDeviationSq = 0.0f;
+    int dropIndex = 0;
+
+    // First and last points are always kept
+    for (int i = 1; i < posControl.rthTBPointCount - 1; i++) {
+        if (ABS(offsets[i].x + offsets[i + 1].x) > INT16_MAX || ABS(offsets[i].y + offsets[i + 1].y) > INT16_MAX ||
+            ABS(offsets[i].z + offsets[i + 1].z) > INT16_MAX) {
+            continue;   // merged offset wouldn't fit
+        }
+
+        const float deviationSq = rthTrackbackPointDeviationSq(&offsets[i], &offsets[i + 1]);
+        if (!dropIndex || deviationSq < minDeviationSq) {
+            minDeviationSq = deviationSq;
+            dropIndex = i;
+        }
+    }
+
+    if (dropIndex) {
+        offsets[dropIndex + 1].x += offsets[dropIndex].x;
+        offsets[dropIndex + 1].y += offsets[dropIndex].y;
+        offsets[dropIndex + 1].z += offsets[dropIndex].z;
+    } else {
+        // Only long legs left, drop the oldest point instead
+        posControl.rthTBFirstPoint.x += offsets[1].x * NAV_RTH_TRACKBACK_POINT_UNIT;
+        posControl.rthTBFirstPoint.y += offsets[1].y * NAV_RTH_TRACKBACK_POINT_UNIT;
+        posControl.rthTBFirstPoint.z += offsets[1].z * NAV_RTH_TRACKBACK_POINT_UNIT;
+        dropIndex = 1;
+    }
+
+    memmove(&offsets[dropIndex], &offsets[dropIndex + 1], (posControl.rthTBPointCount - dropIndex - 1) * sizeof(navRthTrackbackOffset_t));
+    posControl.rthTBPointCount--;
+}
+
+static void rthTrackbackAddPoint(const fpVector3_t *pos)
+{
+    // Points are kept on the offset grid so rounding doesn't add up along the track
+    fpVector3_t point;
+    point.x = lrintf(pos->x / NAV_RTH_TRACKBACK_POINT_UNIT) * NAV_RTH_TRACKBACK_POINT_UNIT;
+    point.y = lrintf(pos->y / NAV_RTH_TRACKBACK_POINT_UNIT) * NAV_RTH_TRACKBACK_POINT_UNIT;
+    point.z = lrintf(pos->z / NAV_RTH_TRACKBACK_POINT_UNIT) * NAV_RTH_TRACKBACK_POINT_UNIT;
+
+    if (posControl.rthTBPointCount == 0) {
+        posControl.rthTBFirstPoint = posControl.rthTBLastPoint = point;
+        posControl.rthTBPointCount = 1;
+    }
+
+    // Legs too long for a single offset are split
+    while (true) {
+        int32_t offsetX = lrintf((point.x - posControl.rthTBLastPoint.x) / NAV_RTH_TRACKBACK_POINT_UNIT);
+        int32_t offsetY = lrintf((point.y - posControl.rthTBLastPoint.y) / NAV_RTH_TRACKBACK_POINT_UNIT);
+        int32_t offsetZ = lrintf((point.z - posControl.rthTBLastPoint.z) / NAV_RTH_TRACKBACK_POINT_UNIT);
+        const int32_t maxOffset = MAX(ABS(offsetX), MAX(ABS(offsetY), ABS(offsetZ)));
+
+        if (maxOffset == 0) {
+            break;
+        }
+
+        if (maxOffset > INT16_MAX) {
+            const float scale = (float)INT16_MAX / maxOffset;
+            offsetX *= scale;
+            offsetY *= scale;
+            offsetZ *= scale;
+        }
+
+        if (posControl.rthTBPointCount == NAV_RTH_TRACKBACK_POINTS) {
+            rthTrackbackDecimate();
+        }
+
+        navRthTrackbackOffset_t *offset = &posControl.rthTBPointOffsets[posControl.rthTBPointCount++];
+        offset->x = offsetX;
+        offset->y = offsetY;
+        offset->z = offsetZ;
+
+        posControl.rthTBLastPoint.x += offsetX * NAV_RTH_TRACKBACK_POINT_UNIT;
+        posControl.rthTBLastPoint.y += offsetY * NAV_RTH_TRACKBACK_POINT_UNIT;
+        posControl.rthTBLastPoint.z += offsetZ * NAV_RTH_TRACKBACK_POINT_UNIT;
+    }
+
+    // Trackback starts from the newest point
+    posControl.rthTBActivePoint = posControl.rthTBLastPoint;
+    posControl.activeRthTBPointIndex = posControl.rthTBPointCount - 1;
+}
+
  static void updateRthTrackback(bool forceSaveTrackPoint)
 {
     if (navConfig()->general.flags.rth_trackback_mode == RTH_TRACKBACK_OFF || FLIGHT_MODE(NAV_RTH_MODE) || !ARMING_FLAG(ARMED)) {
@@ -2678,11 +2826,11 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
                 } else if (distanceCounter >= 9) {
                     // Distance based trackpoint logged if at least 10 distance increments occur without altitude or course change
                     // and deviation from projected course path > 20m
-                    float distToPrevPoint = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.activeRthTBPointIndex]);
+                    float distToPrevPoint = calculateDistanceToDestination(&posControl.rthTBLastPoint);
 
                     fpVector3_t virtualCoursePoint;
-                    virtualCoursePoint.x = posControl.rthTBPointsList[posControl.activeRthTBPointIndex].x + distToPrevPoint * cos_approx(DEGREES_TO_RADIANS(previousTBCourse));
-                    virtualCoursePoint.y = posControl.rthTBPointsList[posControl.activeRthTBPointIndex].y + distToPrevPoint * sin_approx(DEGREES_TO_RADIANS(previousTBCourse));
+                    virtualCoursePoint.x = posControl.rthTBLastPoint.x + distToPrevPoint * cos_approx(DEGREES_TO_RADIANS(previousTBCourse));
+                    virtualCoursePoint.y = posControl.rthTBLastPoint.y + distToPrevPoint * sin_approx(DEGREES_TO_RADIANS(previousTBCourse));
 
                     saveTrackpoint = calculateDistanceToDestination(&virtualCoursePoint) > METERS_TO_CENTIMETERS(20);
                 }
@@ -2690,24 +2838,14 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
                 previousTBTripDist = posControl.totalTripDistance;
             } else if (!GPSCourseIsValid) {
                 // if no reliable course revert to basic distance logging based on direct distance from last point - set to 20m
-                saveTrackpoint = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.activeRthTBPointIndex]) > METERS_TO_CENTIMETERS(20);
+                saveTrackpoint = calculateDistanceToDestination(&posControl.rthTBLastPoint) > METERS_TO_CENTIMETERS(20);
                 previousTBTripDist = posControl.totalTripDistance;
             }
         }
 
-        // when trackpoint store full, overwrite from start of store using 'rthTBWrapAroundCounter' to track overwrite position
         if (saveTrackpoint) {
-            if (posControl.activeRthTBPointIndex == (NAV_RTH_TRACKBACK_POINTS - 1)) {   // wraparound to start
-                posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = 0;
-            } else {
-                posControl.activeRthTBPointIndex++;
-                if (posControl.rthTBWrapAroundCounter > -1) {   // track wraparound overwrite position after store first filled
-                    posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex;
-                }
-            }
-            posControl.rthTBPointsList[posControl.activeRthTBPointIndex] = posControl.actualState.abs.pos;
+            rthTrackbackAddPoint(&posControl.actualState.abs.pos);
 
-            posControl.rthTBLastSavedIndex = posControl.activeRthTBPointIndex;
             previousTBAltitude = CENTIMETERS_TO_METERS(posControl.actualState.abs.pos.z);
             previousTBCourse = GPSCourseIsValid ? DECIDEGREES_TO_DEGREES(gpsSol.groundCourse) : previousTBCourse;
             distanceCounter = 0;
@@ -2717,12 +2855,13 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
 
 static fpVector3_t * rthGetTrackbackPos(void)
 {
+    static fpVector3_t trackbackPos;
+
     // ensure trackback altitude never lower than altitude of start point
-    if (posControl.rthTBPointsList[posControl.activeRthTBPointIndex].z < posControl.rthTBPointsList[posControl.rthTBLastSavedIndex].z) {
-        posControl.rthTBPointsList[posControl.activeRthTBPointIndex].z = posControl.rthTBPointsList[posControl.rthTBLastSavedIndex].z;
-    }
+    trackbackPos = posControl.rthTBActivePoint;
+    trackbackPos.z = MAX(trackbackPos.z, posControl.rthTBLastPoint.z);
 
-    return &posControl.rthTBPointsList[posControl.activeRthTBPointIndex];
+    return &trackbackPos;
 }
 
 /*-----------------------------------------------------------
@@ -2790,15 +2929,19 @@ void setDesiredPosition(const fpVector3_t * pos, int32_t yaw, navSetWaypointFlag
 
 void calculateFarAwayTarget(fpVector3_t * farAwayPos, int32_t yaw, int32_t distance)
 {
-    farAwayPos->x = navGetCurrentActualPositionAndVelocity()->pos.x + distance * cos_approx(CENTIDEGREES_TO_RADIANS(yaw));
-    farAwayPos->y = navGetCurrentActualPositionAndVelocity()->pos.y + distance * sin_approx(CENTIDEGREES_TO_RADIANS(yaw));
+    float sinYaw, cosYaw;
+    sincos_approx(CENTIDEGREES_TO_RADIANS(yaw), &sinYaw, &cosYaw);
+    farAwayPos->x = navGetCurrentActualPositionAndVelocity()->pos.x + distance * cosYaw;
+    farAwayPos->y = navGetCurrentActualPositionAndVelocity()->pos.y + distance * sinYaw;
     farAwayPos->z = navGetCurrentActualPositionAndVelocity()->pos.z;
 }
 
 void calculateNewCruiseTarget(fpVector3_t * origin, int32_t yaw, int32_t distance)
 {
-    origin->x = origin->x + distance * cos_approx(CENTIDEGREES_TO_RADIANS(yaw));
-    origin->y = origin->y + distance * sin_approx(CENTIDEGREES_TO_RADIANS(yaw));
+    float sinYaw, cosYaw;
+    sincos_approx(CENTIDEGREES_TO_RADIANS(yaw), &sinYaw, &cosYaw);
+    origin->x = origin->x + distance * cosYaw;
+    origin->y = origin->y + distance * sinYaw;
     origin->z = origin->z;
 }
 
@@ -3162,6 +3305,9 @@ void resetWaypointList(void)
         posControl.waypointCount = 0;
         posControl.waypointListValid = false;
         posControl.geoWaypointCount = 0;
+#ifdef USE_MISSION_STORE
+        posControl.missionStoreActive = false;
+#endif
 #ifdef USE_MULTI_MISSION
         posControl.loadedMultiMissionIndex = 0;
         posControl.loadedMultiMissionStartWP = 0;
@@ -3294,6 +3440,12 @@ bool saveNonVolatileWaypointList(void)
     if (ARMING_FLAG(ARMED) || !posControl.waypointListValid)
         return false;
 
+#ifdef USE_MISSION_STORE
+    // Only a window of the stored mission is in RAM
+    if (posControl.missionStoreActive)
+        return false;
+#endif
+
     for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {
         getWaypoint(i + 1, nonVolatileWaypointListMutable(i));
     }
@@ -3306,6 +3458,87 @@ bool saveNonVolatileWaypointList(void)
 }
 #endif
 
+#ifdef USE_MISSION_STORE
+static bool loadMissionStoreWindow(uint16_t windowStart)
+{
+    const uint16_t count = MIN(posControl.missionStoreWaypointCount - windowStart, NAV_MAX_WAYPOINTS);
+
+    if (!missionStoreReadWaypoints(windowStart, posControl.waypointList, count)) {
+        return false;
+    }
+
+    posControl.missionStoreWindowStart = windowStart;
+    posControl.waypointCount = posControl.geoWaypointCount = count;
+
+    return true;
+}
+
+/* Moves the window on once the active WP is past its middle, keeping the previous WP in it.
+ * If the flash can't be read the window is kept and the next WP tries again. */
+static void advanceMissionStoreWindow(void)
+{
+    if (!posControl.missionStoreActive || posControl.activeWaypointIndex < NAV_MAX_WAYPOINTS / 2 ||
+        posControl.missionStoreWindowStart + posControl.waypointCount >= posControl.missionStoreWaypointCount) {
+        return;
+    }
+
+    if (loadMissionStoreWindow(posControl.missionStoreWindowStart + posControl.activeWaypointIndex - 1)) {
+        posControl.activeWaypointIndex = 1;
+    }
+}
+
+bool loadMissionStoreWaypointList(void)
+{
+    if (ARMING_FLAG(ARMED)) {
+        return false;
+    }
+
+    missionStoreInfo_t info;
+    missionStoreGetInfo(&info);
+
+    resetWaypointList();
+
+    if (info.count == 0) {
+        return false;
+    }
+
+    posControl.missionStoreWaypointCount = info.count;
+    if (!loadMissionStoreWindow(0)) {
+        resetWaypointList();
+        return false;
+    }
+
+    posControl.missionStoreActive = true;
+    posControl.waypointListValid = true;
+
+    return true;
+}
+
+bool isMissionStoreWaypointListActive(void)
+{
+    return posControl.missionStoreActive;
+}
+
+uint16_t getMissionStoreWaypointCount(void)
+{
+    return posControl.missionStoreActive ? posControl.missionStoreWaypointCount : 0;
+}
+
+bool getMissionStoreWaypoint(uint16_t index, navWaypoint_t *wpData)
+{
+    if (!posControl.missionStoreActive || index >= posControl.missionStoreWaypointCount) {
+        return false;
+    }
+
+    if (index >= posControl.missionStoreWindowStart && index < posControl.missionStoreWindowStart + posControl.waypointCount) {
+        *wpData = posControl.waypointList[index - posControl.missionStoreWindowStart];
+        return true;
+    }
+
+    return missionStoreReadWaypoints(index, wpData, 1);
+}
+#endif
+
 #if defined(USE_SAFE_HOME)
 
 void resetSafeHomes(void)
@@ -3421,7 +3654,7 @@ bool isWaypointNavTrackingActive(void)
     // is set from current position not previous WP. Works for WP Restart intermediate WP as well as first mission WP.
     // (NAV_WP_MODE flag isn't set until WP initialisation is finished, i.e. after calculateAndSetActiveWaypoint called)
 
-    return FLIGHT_MODE(NAV_WP_MODE) || (posControl.flags.rthTrackbackActive && posControl.activeRthTBPointIndex != posControl.rthTBLastSavedIndex);
+    return FLIGHT_MODE(NAV_WP_MODE) || (posControl.flags.rthTrackbackActive && posControl.activeRthTBPointIndex != posControl.rthTBPointCount - 1);
 }
 
 /*-----------------------------------------------------------
@@ -3485,9 +3718,8 @@ void applyWaypointNavigationAndAltitudeHold(void)
         //  ensure WP missions always restart from first waypoint after disarm
         posControl.activeWaypointIndex = 0;
         // Reset RTH trackback
-        posControl.activeRthTBPointIndex = -1;
+        rthTrackbackResetPoints();
         posControl.flags.rthTrackbackActive = false;
-        posControl.rthTBWrapAroundCounter = -1;
 
         return;
     }
@@ -3496,9 +3728,11 @@ void applyWaypointNavigationAndAltitudeHold(void)
     posControl.flags.horizontalPositionDataConsumed = false;
     posControl.flags.verticalPositionDataConsumed = false;
 
-    /* Process controllers */
+    /* Process controllers, nothing to do at PID rate unless a nav controller is active */
     navigationFSMStateFlags_t navStateFlags = navGetStateFlags(posControl.navState);
-    if (STATE(ROVER) || STATE(BOAT)) {
+    if (!(navStateFlags & (NAV_CTL_ALT | NAV_CTL_POS | NAV_CTL_YAW | NAV_CTL_EMERG | NAV_CTL_LAUNCH))) {
+        // No controller, leave the position data for the next active state
+    } else if (STATE(ROVER) || STATE(BOAT)) {
         applyRoverBoatNavigationController(navStateFlags, currentTimeUs);
     } else if (STATE(FIXED_WING_LEGACY)) {
         applyFixedWingNavigationController(navStateFlags, currentTimeUs);
@@ -3651,6 +3885,13 @@ static navigationFSMEvent_t selectNavEventFromBoxModeInput(void)
             return NAV_FSM_EVENT_SWITCH_TO_RTH;
         }
 
+#if defined(USE_GEOZONE)
+        // Geozone breach RTH (can override MANUAL), released once back in allowed airspace
+        if (geozoneShouldForceRTH() && (isExecutingRTH || (canActivateNavigation && canActivateAltHold && STATE(GPS_FIX_HOME)))) {
+            return NAV_FSM_EVENT_SWITCH_TO_RTH;
+        }
+#endif
+
         /* Pilot-triggered RTH (can override MANUAL), also fall-back for WP if there is no mission loaded
          * Prevent MANUAL falling back to RTH if selected during active mission (canActivateWaypoint is set false on MANUAL selection)
          * Also prevent WP falling back to RTH if WP mission planner is active */
@@ -3924,6 +4165,9 @@ void missionPlannerSetWaypoint(void)
 
     if (!posControl.wpPlannerActiveWPIndex) {   // reset existing mission data before adding first WP
         resetWaypointList();
+#ifdef USE_MISSION_STORE
+        posControl.missionStoreActive = false;  // resetWaypointList does nothing when armed
+#endif
     }
 
     gpsLocation_t wpLLH;
@@ -3952,7 +4196,11 @@ void missionPlannerSetWaypoint(void)
  * Process NAV mode transition and WP/RTH state machine
  *  Update rate: RX (data driven or 50Hz)
  */
-void updateWaypointsAndNavigationMode(void)
+/*-----------------------------------------------------------
+ * Nav-rate housekeeping, only depends on the estimator output so it runs
+ * once per published estimate rather than on every RX frame
+ *-----------------------------------------------------------*/
+static void updateNavigationEstimateDependents(void)
 {
     /* Initiate home position update */
     updateHomePosition();
@@ -3963,6 +4211,21 @@ void updateWaypointsAndNavigationMode(void)
     /* Update NAV ready status */
     updateReadyStatus();
 
+#if defined(USE_GEOZONE)
+    // Check the position against the geozones
+    geozoneUpdate();
+#endif
+}
+
+void updateWaypointsAndNavigationMode(void)
+{
+    const bool estimateUpdated = posControl.flags.estimateUpdated;
+
+    if (estimateUpdated) {
+        posControl.flags.estimateUpdated = false;
+        updateNavigationEstimateDependents();
+    }
+
     // Update flight behaviour modifiers
     updateFlightBehaviorModifiers();
 
@@ -3975,11 +4238,13 @@ void updateWaypointsAndNavigationMode(void)
     // Map navMode back to enabled flight modes
     switchNavigationFlightModes();
 
-    // Update WP mission planner
-    updateWpMissionPlanner();
+    if (estimateUpdated) {
+        // Update WP mission planner
+        updateWpMissionPlanner();
 
-    // Update RTH trackback
-    updateRthTrackback(false);
+        // Update RTH trackback
+        updateRthTrackback(false);
+    }
 
     //Update Blackbox data
     navCurrentState = (int16_t)posControl.navPersistentId;
@@ -4091,6 +4356,7 @@ void navigationInit(void)
 
     posControl.flags.horizontalPositionDataNew = false;
     posControl.flags.verticalPositionDataNew = false;
+    posControl.flags.estimateUpdated = false;
 
     posControl.flags.estAltStatus = EST_NONE;
     posControl.flags.estPosStatus = EST_NONE;
@@ -4293,6 +4559,31 @@ int32_t navigationGetHomeHeading(void)
     return posControl.rthState.homePosition.yaw;
 }
 
+int32_t navigationGetHomeAltitudeOffset(void)
+{
+    return lrintf(posControl.rthState.homePosition.pos.z - posControl.actualState.abs.pos.z);
+}
+
+bool navigationRestoreHomePosition(const gpsLocation_t *llh, int32_t altitudeOffset, int32_t yaw)
+{
+    if (posControl.flags.estPosStatus < EST_USABLE || posControl.flags.estAltStatus < EST_USABLE) {
+        return false;
+    }
+
+    fpVector3_t homePos;
+    if (!geoConvertGeodeticToLocal(&homePos, &posControl.gpsOrigin, llh, GEO_ALT_RELATIVE)) {
+        return false;
+    }
+
+    // Altitude origin was reset by the reboot, keep the height above home instead
+    homePos.z = posControl.actualState.abs.pos.z + altitudeOffset;
+
+    setHomePosition(&homePos, yaw, NAV_POS_UPDATE_XY | NAV_POS_UPDATE_Z | NAV_POS_UPDATE_HEADING, NAV_HOME_VALID_ALL);
+    original_rth_home = homePos;
+
+    return true;
+}
+
 // returns m/s
 float calculateAverageSpeed() {
     float flightTime = getFlightTime();
@@ -68,6 +68,46 @@ bool findNearestSafeHome(void);                  // Find nearest safehome
 
 #endif // defined(USE_SAFE_HOME)
 
+#if defined(USE_GEOZONE)
+
+#define MAX_GEOZONES            24
+#define MAX_GEOZONE_VERTICES    96
+
+typedef enum {
+    GEOZONE_TYPE_EXCLUSION = 0,             // Flying inside the zone is a breach
+    GEOZONE_TYPE_INCLUSION = 1,             // Flying outside of all inclusion zones is a breach
+} geozoneType_e;
+
+typedef enum {
+    GEOZONE_ACTION_NONE = 0,                // Warn only
+    GEOZONE_ACTION_RTH = 1,                 // RTH until the breach is cleared
+} geozoneAction_e;
+
+typedef struct {
+    uint8_t type;                           // geozoneType_e
+    uint8_t action;                         // geozoneAction_e
+    uint8_t firstVertex;                    // Index of the first vertex in geozoneVertices
+    uint8_t vertexCount;                    // Less than 3 disables the zone
+    int32_t minAltitude;                    // cm above home
+    int32_t maxAltitude;                    // cm above home, 0 for no upper limit
+} geozone_t;
+
+typedef struct {
+    int32_t lat;
+    int32_t lon;
+} geozoneVertex_t;
+
+PG_DECLARE_ARRAY(geozone_t, MAX_GEOZONES, geozones);
+PG_DECLARE_ARRAY(geozoneVertex_t, MAX_GEOZONE_VERTICES, geozoneVertices);
+
+void geozoneInvalidate(void);               // zones changed, rebuild the index before the next check
+void geozoneUpdate(void);
+bool geozoneIsBreached(void);
+bool geozoneIsInExclusionZone(void);
+bool geozoneShouldForceRTH(void);
+
+#endif // defined(USE_GEOZONE)
+
 #ifndef NAV_MAX_WAYPOINTS
 #define NAV_MAX_WAYPOINTS 15
 #endif
@@ -112,6 +152,11 @@ typedef enum {
     NAV_RESET_ON_EACH_ARM,
 } nav_reset_type_e;
 
+typedef enum {
+    NAV_POS_ESTIMATOR_COMPLEMENTARY = 0,
+    NAV_POS_ESTIMATOR_EKF,
+} nav_pos_estimator_type_e;
+
 typedef enum {
     NAV_RTH_ALLOW_LANDING_NEVER = 0,
     NAV_RTH_ALLOW_LANDING_ALWAYS = 1,
@@ -175,6 +220,11 @@ typedef enum {
     WP_TURN_SMOOTHING_CUT,
 } wpFwTurnSmoothing_e;
 
+typedef enum {
+    NAV_FW_GUIDANCE_LEGACY,
+    NAV_FW_GUIDANCE_L1,
+} navFwLateralGuidance_e;
+
 typedef struct positionEstimationConfig_s {
     uint8_t automatic_mag_declination;
     uint8_t reset_altitude_type; // from nav_reset_type_e
@@ -209,6 +259,11 @@ typedef struct positionEstimationConfig_s {
     float baro_epv;     // Baro position error
 
     uint8_t use_gps_no_baro;
+    uint8_t gps_delay;  // Delay of the GPS solution relative to the IMU (ms)
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+    uint8_t estimator_type;     // nav_pos_estimator_type_e
+#endif
 } positionEstimationConfig_t;
 
 PG_DECLARE(positionEstimationConfig_t, positionEstimationConfig);
@@ -263,6 +318,10 @@ typedef struct navConfig_s {
         uint16_t max_altitude;                      // Max altitude when in AltHold mode (not Surface Following)
         uint16_t rth_trackback_distance;            // RTH trackback maximum distance [m]
         uint16_t waypoint_enforce_altitude;         // Forces waypoint altitude to be achieved
+#ifdef USE_TERRAIN
+        bool     waypoint_terrain_following;        // Waypoint altitudes are above the terrain of the stored elevation tiles
+        uint16_t waypoint_terrain_lookahead;        // Distance ahead to clear the terrain by the waypoint altitude [m]
+#endif
     } general;
 
     struct {
@@ -283,6 +342,8 @@ typedef struct navConfig_s {
         uint8_t posDecelerationTime;            // Brake time parameter
         uint8_t posResponseExpo;                // Position controller expo (taret vel expo for MC)
         bool slowDownForTurning;             // Slow down during WP missions when changing heading on next waypoint
+        bool posTrajectory;                  // Jerk limited trajectory toward new hold positions
+        bool landDetectFusion;               // Fuse thrust, motion and vibration statistics for landing detection
     } mc;
 
     struct {
@@ -309,6 +370,7 @@ typedef struct navConfig_s {
         uint8_t  launch_max_angle;           // Max tilt angle (pitch/roll combined) to consider launch successful. Set to 180 to disable completely [deg]
         bool     launch_manual_throttle;     // Allows launch with manual throttle control
         uint8_t  launch_abort_deadband;      // roll/pitch stick movement deadband for launch abort
+        bool     launch_fast_detect;         // Detect bungee launches from the unfiltered accelerometer
         uint8_t  cruise_yaw_rate;            // Max yaw rate (dps) when CRUISE MODE is enabled
         bool     allow_manual_thr_increase;
         bool     useFwNavYawControl;
@@ -318,6 +380,9 @@ typedef struct navConfig_s {
         uint8_t  wp_tracking_accuracy;       // fixed wing tracking accuracy response factor
         uint8_t  wp_tracking_max_angle;      // fixed wing tracking accuracy max alignment angle [degs]
         uint8_t  wp_turn_smoothing;          // WP mission turn smoothing options
+        uint8_t  lateral_guidance;           // navFwLateralGuidance_e
+        uint8_t  l1_period;                  // L1 guidance period [s]
+        uint8_t  l1_damping;                 // L1 guidance damping ratio [%]
     } fw;
 } navConfig_t;
 
@@ -325,7 +390,8 @@ PG_DECLARE(navConfig_t, navConfig);
 
 typedef struct gpsOrigin_s {
     bool    valid;
-    float   scale;
+    float   scale;  // cos(lat)
+    float   sinLat; // sin(lat), for the change of scale away from the origin
     int32_t lat;    // Lattitude * 1e+7
     int32_t lon;    // Longitude * 1e+7
     int32_t alt;    // Altitude in centimeters (meters * 100)
@@ -385,6 +451,8 @@ typedef struct radar_pois_s {
     uint16_t distance; // m
     int16_t altitude; // m
     int16_t direction; // °
+    bool updated; // New data from MSP, distance, altitude and direction are due
+    bool inRange; // Not lost and within the HUD radar range
 } radar_pois_t;
 
 #define RADAR_MAX_POIS 5
@@ -526,6 +594,53 @@ bool saveNonVolatileWaypointList(void);
 void selectMultiMissionIndex(int8_t increment);
 void setMultiMissionOnArm(void);
 #endif
+#if defined(USE_MISSION_STORE)
+/* Missions too long for waypointList are streamed into a dedicated partition of the
+ * external flash and paged into waypointList as they are flown */
+typedef struct {
+    uint16_t capacity;                      // Waypoints the partition can hold, 0 if there is no usable flash
+    uint16_t count;                         // Waypoints of the stored mission
+} missionStoreInfo_t;
+
+bool missionStoreInit(void);
+void missionStoreGetInfo(missionStoreInfo_t *info);
+bool missionStoreBeginUpload(void);
+bool missionStoreWriteWaypoint(uint16_t index, const navWaypoint_t *wpData);
+bool missionStoreFinishUpload(uint16_t count);
+bool missionStoreReadWaypoints(uint16_t index, navWaypoint_t *wpData, uint16_t count);
+
+bool loadMissionStoreWaypointList(void);
+bool isMissionStoreWaypointListActive(void);
+uint16_t getMissionStoreWaypointCount(void);
+bool getMissionStoreWaypoint(uint16_t index, navWaypoint_t *wpData);
+#endif
+#if defined(USE_TERRAIN)
+/* Terrain elevation tiles of the mission area in a dedicated partition of the external flash */
+#define TERRAIN_TILE_SAMPLES    32          // Samples along each side of a tile
+#define TERRAIN_MAX_TILES       128
+
+typedef struct {
+    int32_t  lat;                           // South west corner (deg * 1e7)
+    int32_t  lon;
+    uint16_t spacing;                       // Distance between samples in both directions (deg * 1e7)
+    int16_t  baseHeight;                    // Height of a zero sample above mean sea level (m)
+    uint16_t step;                          // Height of a sample count (dm)
+    uint16_t reserved;
+} terrainTileHeader_t;
+
+typedef struct {
+    uint16_t capacity;                      // Tiles the partition can hold, 0 if there is no usable flash
+    uint16_t count;                         // Tiles stored
+} terrainStoreInfo_t;
+
+bool terrainInit(void);
+void terrainStoreGetInfo(terrainStoreInfo_t *info);
+bool terrainStoreBeginUpload(void);
+bool terrainStoreWriteTileData(uint16_t index, uint16_t offset, const uint8_t *data, uint16_t length);
+bool terrainStoreFinishTile(uint16_t index, const terrainTileHeader_t *header);
+bool terrainGetHeight(int32_t lat, int32_t lon, int32_t *heightCm);
+bool terrainGetAltitudeAlongPath(const fpVector3_t *pos, const fpVector3_t *destination, uint16_t lookahead, float *altitude);
+#endif
 float getFinalRTHAltitude(void);
 int16_t fixedWingPitchToThrottleCorrection(int16_t pitch, timeUs_t currentTimeUs);
 
@@ -621,6 +736,13 @@ bool isEstimatedAglTrusted(void);
  */
 int32_t navigationGetHomeHeading(void);
 
+/* Home altitude relative to the current altitude estimate [cm] */
+int32_t navigationGetHomeAltitudeOffset(void);
+/* Sets home from a location saved before a warm restart, returns false
+ * until the position estimate can take it.
+ */
+bool navigationRestoreHomePosition(const gpsLocation_t *llh, int32_t altitudeOffset, int32_t yaw);
+
 /* Compatibility data */
 extern navSystemStatus_t    NAV_Status;
 
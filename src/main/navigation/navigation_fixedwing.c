@@ -218,6 +218,22 @@ bool adjustFixedWingHeadingFromRCInput(void)
 static fpVector3_t virtualDesiredPosition;
 static pt1Filter_t fwPosControllerCorrectionFilterState;
 
+typedef enum {
+    FW_PATH_NONE = 0,
+    FW_PATH_LINE,
+    FW_PATH_CIRCLE,
+} fwPathType_e;
+
+typedef struct {
+    fwPathType_e type;
+    fpVector3_t target;         // Line end point or circle center
+    int32_t course;             // [centidegrees] line course
+    float dirX;                 // Line unit direction
+    float dirY;
+} fwPathSegment_t;
+
+static fwPathSegment_t fwPath;
+
 /*
  * TODO Currently this function resets both FixedWing and Rover & Boat position controller
  */
@@ -235,6 +251,7 @@ void resetFixedWingPositionController(void)
     isYawAdjustmentValid = false;
 
     pt1FilterReset(&fwPosControllerCorrectionFilterState, 0.0f);
+    fwPath.type = FW_PATH_NONE;
 }
 
 static int8_t loiterDirection(void) {
@@ -323,8 +340,10 @@ static void calculateVirtualPositionTarget_FW(float trackingPeriod)
     // We are closing in on a waypoint, calculate circular loiter if required
     if (needToCalculateCircularLoiter) {
         float loiterAngle = atan2_approx(-posErrorY, -posErrorX) + DEGREES_TO_RADIANS(loiterTurnDirection * 45.0f);
-        float loiterTargetX = loiterCenterPos.x + navLoiterRadius * cos_approx(loiterAngle);
-        float loiterTargetY = loiterCenterPos.y + navLoiterRadius * sin_approx(loiterAngle);
+        float sinLoiterAngle, cosLoiterAngle;
+        sincos_approx(loiterAngle, &sinLoiterAngle, &cosLoiterAngle);
+        float loiterTargetX = loiterCenterPos.x + navLoiterRadius * cosLoiterAngle;
+        float loiterTargetY = loiterCenterPos.y + navLoiterRadius * sinLoiterAngle;
 
         // We have temporary loiter target. Recalculate distance and position error
         posErrorX = loiterTargetX - navGetCurrentActualPositionAndVelocity()->pos.x;
@@ -477,6 +496,168 @@ static void updatePositionHeadingController_FW(timeUs_t currentTimeUs, timeDelta
     }
 }
 
+/*-----------------------------------------------------------
+ * L1 lateral guidance
+ * Waypoint legs and loiter circles are turned into a path segment once, when
+ * the target changes. Per position update only the cross track geometry is
+ * evaluated, the L1 law gives the lateral acceleration and thus the bank.
+ *-----------------------------------------------------------*/
+static fwPathType_e selectPathSegmentType_FW(void)
+{
+    if (navConfig()->fw.lateral_guidance != NAV_FW_GUIDANCE_L1 || posControl.flags.isAdjustingPosition) {
+        return FW_PATH_NONE;
+    }
+
+    if (isNavHoldPositionActive()) {
+        return FW_PATH_CIRCLE;
+    }
+
+    if (isWaypointNavTrackingActive()) {
+        // Turn smoothing loiters start within 2 loiter radii of the waypoint, leave them to the target point guidance
+        if (navConfig()->fw.wp_turn_smoothing && posControl.activeWaypoint.nextTurnAngle != -1 &&
+            posControl.wpDistance < 2 * getLoiterRadius(navConfig()->fw.loiter_radius)) {
+            return FW_PATH_NONE;
+        }
+        return FW_PATH_LINE;
+    }
+
+    return FW_PATH_NONE;
+}
+
+static bool updatePathSegment_FW(void)
+{
+    const fwPathType_e type = selectPathSegmentType_FW();
+
+    if (type == FW_PATH_NONE) {
+        if (fwPath.type != FW_PATH_NONE) {
+            // Target point guidance takes over, don't let it start from a stale integrator
+            navPidReset(&posControl.pids.fw_nav);
+            fwPath.type = FW_PATH_NONE;
+        }
+        return false;
+    }
+
+    const fpVector3_t *target = (type == FW_PATH_CIRCLE) ? &posControl.desiredState.pos : &posControl.activeWaypoint.pos;
+    const bool segmentValid = (fwPath.type == type) && (fwPath.target.x == target->x) && (fwPath.target.y == target->y) &&
+                              (type == FW_PATH_CIRCLE || fwPath.course == posControl.activeWaypoint.yaw);
+
+    if (!segmentValid) {
+        fwPath.type = type;
+        fwPath.target = *target;
+
+        if (type == FW_PATH_LINE) {
+            fwPath.course = posControl.activeWaypoint.yaw;
+            sincos_approx(CENTIDEGREES_TO_RADIANS(fwPath.course), &fwPath.dirY, &fwPath.dirX);
+        }
+    }
+
+    return true;
+}
+
+// Limit the L1 angle to +/-90 deg, beyond that the aircraft just turns as hard as the law allows
+static void constrainL1Angle(float *sinNu, float *cosNu)
+{
+    if (*cosNu < 0.0f) {
+        *sinNu = (*sinNu < 0.0f || (*sinNu == 0.0f && loiterDirection() < 0)) ? -1.0f : 1.0f;
+        *cosNu = 0.0f;
+    }
+}
+
+static void updatePathGuidance_FW(timeDelta_t deltaMicros)
+{
+    const navEstimatedPosVel_t *actual = navGetCurrentActualPositionAndVelocity();
+    const float period = navConfig()->fw.l1_period;
+    const float damping = navConfig()->fw.l1_damping / 100.0f;
+
+    // Limit minimum ground speed to 1 m/s
+    const float speed = MAX(posControl.actualState.velXY, 100.0f);
+    const float velX = posControl.actualState.velXY > 1.0f ? actual->vel.x : speed * posControl.actualState.cosYaw;
+    const float velY = posControl.actualState.velXY > 1.0f ? actual->vel.y : speed * posControl.actualState.sinYaw;
+
+    // L1 distance is damping * period * speed / pi, the law a = 4 * damping^2 * V^2 / L1 * sin(Nu) then reduces to
+    const float l1AccelScale = 4.0f * M_PIf * damping * speed / period;
+    float lateralAccel;
+
+    if (fwPath.type == FW_PATH_LINE) {
+        const float toTargetX = fwPath.target.x - actual->pos.x;
+        const float toTargetY = fwPath.target.y - actual->pos.y;
+        const float alongTrackToGo = toTargetX * fwPath.dirX + toTargetY * fwPath.dirY;
+        float sinNu, cosNu;
+
+        if (alongTrackToGo < 0.0f) {
+            // Past the end of the leg, head straight for the waypoint until it is declared reached
+            const float distance = MAX(calc_length_pythagorean_2D(toTargetX, toTargetY), 1.0f);
+            sinNu = (velX * toTargetY - velY * toTargetX) / (speed * distance);
+            cosNu = (velX * toTargetX + velY * toTargetY) / (speed * distance);
+        } else {
+            // Positive cross track error is right of the track
+            const float l1Distance = damping * period * speed / M_PIf;
+            const float crossTrack = fwPath.dirY * toTargetX - fwPath.dirX * toTargetY;
+            const float sinNu1 = constrainf(-crossTrack / l1Distance, -0.7071f, 0.7071f);
+            const float cosNu1 = fast_fsqrtf(1.0f - sq(sinNu1));
+            const float sinTrack = (fwPath.dirX * velY - fwPath.dirY * velX) / speed;
+            const float cosTrack = (fwPath.dirX * velX + fwPath.dirY * velY) / speed;
+            sinNu = sinNu1 * cosTrack - cosNu1 * sinTrack;
+            cosNu = cosNu1 * cosTrack + sinNu1 * sinTrack;
+        }
+
+        constrainL1Angle(&sinNu, &cosNu);
+        lateralAccel = l1AccelScale * sinNu;
+        needToCalculateCircularLoiter = false;
+    } else {
+        const float radius = getLoiterRadius(navConfig()->fw.loiter_radius);
+        const int8_t turnDirection = loiterDirection();
+        const float offsetX = actual->pos.x - fwPath.target.x;
+        const float offsetY = actual->pos.y - fwPath.target.y;
+        const float offset = calc_length_pythagorean_2D(offsetX, offsetY);
+        const float unitX = offset > 1.0f ? offsetX / offset : velX / speed;
+        const float unitY = offset > 1.0f ? offsetY / offset : velY / speed;
+
+        // Capture: steer toward the circle center
+        const float crossTrackVel = unitX * velY - unitY * velX;
+        const float alongTrackVel = -(velX * unitX + velY * unitY);
+        float sinNu = crossTrackVel / speed;
+        float cosNu = alongTrackVel / speed;
+        constrainL1Angle(&sinNu, &cosNu);
+        const float captureAccel = l1AccelScale * sinNu;
+
+        // Circle: PD on the radial error plus the centripetal term
+        const float omega = 2.0f * M_PIf / period;
+        const float radialError = offset - radius;
+        const float tangentVel = crossTrackVel * turnDirection;
+        float circlePDAccel = radialError * sq(omega) - alongTrackVel * 2.0f * damping * omega;
+        if (alongTrackVel < 0.0f && tangentVel < 0.0f) {
+            // Flying outward the wrong way round, don't steer out of the circle
+            circlePDAccel = MAX(circlePDAccel, 0.0f);
+        }
+        const float circleAccel = turnDirection * (circlePDAccel + sq(tangentVel) / MAX(0.5f * radius, radius + radialError));
+
+        lateralAccel = (radialError > 0.0f && turnDirection * captureAccel < turnDirection * circleAccel) ? captureAccel : circleAccel;
+        needToCalculateCircularLoiter = true;
+    }
+
+    posControl.flags.wpTurnSmoothingActive = false;
+
+    // Heading error equivalent of the demand, for the yaw controller and the OSD
+    navHeadingError = RADIANS_TO_CENTIDEGREES(asin_approx(constrainf(lateralAccel / l1AccelScale, -1.0f, 1.0f)));
+
+    float rollAdjustment = constrainf(RADIANS_TO_CENTIDEGREES(atan2_approx(lateralAccel, GRAVITY_CMSS)),
+                                      -DEGREES_TO_CENTIDEGREES(navConfig()->fw.max_bank_angle),
+                                       DEGREES_TO_CENTIDEGREES(navConfig()->fw.max_bank_angle));
+
+    // Apply low-pass filter to prevent rapid correction
+    rollAdjustment = pt1FilterApply4(&fwPosControllerCorrectionFilterState, rollAdjustment, getSmoothnessCutoffFreq(NAV_FW_BASE_ROLL_CUTOFF_FREQUENCY_HZ), US2S(deltaMicros));
+
+    // Convert rollAdjustment to decidegrees (rcAdjustment holds decidegrees)
+    posControl.rcAdjustment[ROLL] = CENTIDEGREES_TO_DECIDEGREES(rollAdjustment);
+
+    if (STATE(FW_HEADING_USE_YAW)) {
+        posControl.rcAdjustment[YAW] = processHeadingYawController(deltaMicros, navHeadingError, false);
+    } else {
+        posControl.rcAdjustment[YAW] = 0;
+    }
+}
+
 void applyFixedWingPositionController(timeUs_t currentTimeUs)
 {
     static timeUs_t previousTimePositionUpdate = 0;         // Occurs @ GPS update rate
@@ -488,7 +669,10 @@ void applyFixedWingPositionController(timeUs_t currentTimeUs)
             const timeDeltaLarge_t deltaMicrosPositionUpdate = currentTimeUs - previousTimePositionUpdate;
             previousTimePositionUpdate = currentTimeUs;
 
-            if (deltaMicrosPositionUpdate < MAX_POSITION_UPDATE_INTERVAL_US) {
+            if (deltaMicrosPositionUpdate < MAX_POSITION_UPDATE_INTERVAL_US && updatePathSegment_FW()) {
+                updatePathGuidance_FW(deltaMicrosPositionUpdate);
+            }
+            else if (deltaMicrosPositionUpdate < MAX_POSITION_UPDATE_INTERVAL_US) {
                 // Calculate virtual position target at a distance of forwardVelocity * HZ2S(POSITION_TARGET_UPDATE_RATE_HZ)
                 // Account for pilot's roll input (move position target left/right at max of max_manual_speed)
                 // POSITION_TARGET_UPDATE_RATE_HZ should be chosen keeping in mind that position target shouldn't be reached until next pos update occurs
@@ -48,10 +48,12 @@
 
 #include "io/gps.h"
 
+#include "sensors/acceleration.h"
 #include "sensors/battery.h"
 
 #define SWING_LAUNCH_MIN_ROTATION_RATE      DEGREES_TO_RADIANS(100)     // expect minimum 100dps rotation rate
 #define LAUNCH_MOTOR_IDLE_SPINUP_TIME 1500                              // ms
+#define LAUNCH_ACC_WINDOW_SIZE              32                          // PID loops, matched filter window upper bound
 #define UNUSED(x) ((void)(x))
 #define FW_LAUNCH_MESSAGE_TEXT_WAIT_THROTTLE "RAISE THE THROTTLE"
 #define FW_LAUNCH_MESSAGE_TEXT_WAIT_IDLE "WAITING FOR IDLE"
@@ -119,6 +121,16 @@ typedef struct fixedWingLaunchData_s {
 static EXTENDED_FASTRAM fixedWingLaunchData_t fwLaunch;
 static bool idleMotorAboutToStart;
 
+// Unfiltered forward acceleration over the last PID loops, the launch impulse template is a step so the matched filter is a boxcar
+typedef struct fixedWingLaunchAccWindow_s {
+    float samples[LAUNCH_ACC_WINDOW_SIZE];
+    float sum;
+    uint8_t head;
+    uint8_t count;
+} fixedWingLaunchAccWindow_t;
+
+static EXTENDED_FASTRAM fixedWingLaunchAccWindow_t launchAccWindow;
+
 static const fixedWingLaunchStateDescriptor_t launchStateMachine[FW_LAUNCH_STATE_COUNT] = {
 
     [FW_LAUNCH_STATE_WAIT_THROTTLE] = {
@@ -228,6 +240,36 @@ static void setCurrentState(fixedWingLaunchState_t nextState, timeUs_t currentTi
 {
     fwLaunch.currentState = nextState;
     fwLaunch.currentStateTimeUs = currentTimeUs;
+
+    if (nextState == FW_LAUNCH_STATE_WAIT_DETECTION) {
+        memset(&launchAccWindow, 0, sizeof(launchAccWindow));
+    }
+}
+
+static uint8_t getLaunchAccWindowLength(void)
+{
+    return constrain(navConfig()->fw.launch_time_thresh * 1000 / getLooptime(), 1, LAUNCH_ACC_WINDOW_SIZE);
+}
+
+// Called every PID loop while waiting for the launch, true once the averaged raw forward acceleration breaches the threshold
+static bool isLaunchAccelerationDetected(void)
+{
+    const uint8_t windowLength = getLaunchAccWindowLength();
+    const float sample = accGetUnfilteredAcceleration(X);
+
+    if (launchAccWindow.count >= windowLength) {
+        // Drop the sample leaving the window
+        const uint8_t tail = (launchAccWindow.head + LAUNCH_ACC_WINDOW_SIZE - windowLength) % LAUNCH_ACC_WINDOW_SIZE;
+        launchAccWindow.sum -= launchAccWindow.samples[tail];
+    } else {
+        launchAccWindow.count++;
+    }
+
+    launchAccWindow.samples[launchAccWindow.head] = sample;
+    launchAccWindow.sum += sample;
+    launchAccWindow.head = (launchAccWindow.head + 1) % LAUNCH_ACC_WINDOW_SIZE;
+
+    return launchAccWindow.count >= windowLength && launchAccWindow.sum > windowLength * navConfig()->fw.launch_accel_thresh;
 }
 
 /* Wing control Helpers */
@@ -361,8 +403,16 @@ static fixedWingLaunchEvent_t fwLaunchState_FW_LAUNCH_STATE_WAIT_DETECTION(timeU
     const bool isSwingLaunched = (swingVelocity > navConfig()->fw.launch_velocity_thresh) && (imuMeasuredAccelBF.x > 0);
     const bool isForwardLaunched = isGPSHeadingValid() && (gpsSol.groundSpeed > navConfig()->fw.launch_velocity_thresh) && (imuMeasuredAccelBF.x > 0);
 
+    // Sample every loop so the window stays contiguous
+    const bool isFastBungeeLaunched = navConfig()->fw.launch_fast_detect && isLaunchAccelerationDetected() && isAircraftAlmostLevel;
+
     applyThrottleIdleLogic(false);
 
+    if (isFastBungeeLaunched) {
+        // The matched filter window already covers the detection time
+        return FW_LAUNCH_EVENT_SUCCESS;
+    }
+
     if (isBungeeLaunched || isSwingLaunched || isForwardLaunched) {
         if (currentStateElapsedMs(currentTimeUs) > navConfig()->fw.launch_time_thresh) {
             return FW_LAUNCH_EVENT_SUCCESS; // the launch is detected now, go to FW_LAUNCH_STATE_DETECTED
@@ -105,14 +105,35 @@ float geoCalculateMagDeclination(const gpsLocation_t * llh) // degrees units
     return ((lat - min_lat) / SAMPLING_RES) * (declination_max - declination_min) + declination_min;
 }
 
+#define GEO_LAT_UNIT_TO_RAD     (0.0174532925f / 10000000.0f)
+
+/*
+ * Local coordinates are an equirectangular projection around the origin. Using cos() of
+ * the origin latitude for the longitude scale everywhere makes east/west distances wrong
+ * by about 1% 50km north or south of the origin at mid latitudes, so the scale is taken at
+ * the mid latitude between origin and point instead. cos() of it is expanded around the
+ * origin latitude, which leaves an error below 1e-7 within 100km of the origin.
+ * Going back from local to geodetic the latitude is found first, so both ways use the same
+ * scale and conversions are reversible.
+ */
+static float geoLonScale(const gpsOrigin_t *origin, int32_t deltaLat)
+{
+    const float halfDeltaLat = deltaLat * (0.5f * GEO_LAT_UNIT_TO_RAD);
+
+    return constrainf(origin->scale * (1.0f - 0.5f * sq(halfDeltaLat)) - origin->sinLat * halfDeltaLat, 0.01f, 1.0f);
+}
+
 void geoSetOrigin(gpsOrigin_t *origin, const gpsLocation_t *llh, geoOriginResetMode_e resetMode)
 {
     if (resetMode == GEO_ORIGIN_SET) {
+        const float originLat = llh->lat * GEO_LAT_UNIT_TO_RAD;
+
         origin->valid = true;
         origin->lat = llh->lat;
         origin->lon = llh->lon;
         origin->alt = llh->alt;
-        origin->scale = constrainf(cos_approx((ABS(origin->lat) / 10000000.0f) * 0.0174532925f), 0.01f, 1.0f);
+        origin->scale = constrainf(cosf(originLat), 0.01f, 1.0f);
+        origin->sinLat = sinf(originLat);
     }
     else if (origin->valid && (resetMode == GEO_ORIGIN_RESET_ALTITUDE)) {
         origin->alt = llh->alt;
@@ -122,8 +143,10 @@ void geoSetOrigin(gpsOrigin_t *origin, const gpsLocation_t *llh, geoOriginResetM
 bool geoConvertGeodeticToLocal(fpVector3_t *pos, const gpsOrigin_t *origin, const gpsLocation_t *llh, geoAltitudeConversionMode_e altConv)
 {
     if (origin->valid) {
-        pos->x = (llh->lat - origin->lat) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR;
-        pos->y = (llh->lon - origin->lon) * (DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR * origin->scale);
+        const int32_t deltaLat = llh->lat - origin->lat;
+
+        pos->x = deltaLat * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR;
+        pos->y = (llh->lon - origin->lon) * (DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR * geoLonScale(origin, deltaLat));
 
         // If flag GEO_ALT_RELATIVE, than llh altitude is already relative to origin
         if (altConv == GEO_ALT_RELATIVE) {
@@ -147,13 +170,14 @@ bool geoConvertGeodeticToLocalOrigin(fpVector3_t * pos, const gpsLocation_t *llh
 
 bool geoConvertLocalToGeodetic(gpsLocation_t *llh, const gpsOrigin_t * origin, const fpVector3_t *pos)
 {
+    const int32_t deltaLat = lrintf(pos->x * (1.0f / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR));
     float scaleLonDown;
 
     if (origin->valid) {
         llh->lat = origin->lat;
         llh->lon = origin->lon;
         llh->alt = origin->alt;
-        scaleLonDown = origin->scale;
+        scaleLonDown = geoLonScale(origin, deltaLat);
     }
     else {
         llh->lat = 0;
@@ -162,7 +186,7 @@ bool geoConvertLocalToGeodetic(gpsLocation_t *llh, const gpsOrigin_t * origin, c
         scaleLonDown = 1.0f;
     }
 
-    llh->lat += lrintf(pos->x / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR);
+    llh->lat += deltaLat;
     llh->lon += lrintf(pos->y / (DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR * scaleLonDown));
     llh->alt += lrintf(pos->z);
     return origin->valid;
@@ -0,0 +1,326 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Geozones are polygons in lat/lon with an altitude band. Being inside an
+ * exclusion zone or outside of all inclusion zones is a breach.
+ *
+ * Checking the position against every polygon edge at nav rate doesn't
+ * scale to dozens of zones, so the zones are indexed on a grid laid over
+ * their common bounding box when they change. Each cell stores a mask of
+ * the zones covering it completely and a mask of the zones with an edge
+ * running through it. A check looks up a single cell and only runs the
+ * point in polygon test for the zones crossing that cell.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#if defined(USE_GEOZONE)
+
+#include "common/utils.h"
+
+#include "config/parameter_group.h"
+#include "config/parameter_group_ids.h"
+
+#include "fc/runtime_config.h"
+
+#include "navigation/navigation.h"
+#include "navigation/navigation_private.h"
+
+#define GEOZONE_GRID_SIZE   16
+
+typedef struct {
+    int32_t latMin;
+    int32_t latMax;
+    int32_t lonMin;
+    int32_t lonMax;
+} geozoneBounds_t;
+
+typedef struct {
+    bool            valid;
+    uint32_t        activeMask;         // Zones with a valid polygon
+    uint32_t        inclusionMask;
+    geozoneBounds_t zoneBounds[MAX_GEOZONES];
+    geozoneBounds_t gridBounds;
+    uint32_t        cellInside[GEOZONE_GRID_SIZE][GEOZONE_GRID_SIZE];
+    uint32_t        cellCrossing[GEOZONE_GRID_SIZE][GEOZONE_GRID_SIZE];
+} geozoneIndex_t;
+
+typedef struct {
+    bool    breached;
+    bool    inExclusionZone;
+    uint8_t action;                     // geozoneAction_e of the breach
+} geozoneStatus_t;
+
+PG_REGISTER_ARRAY(geozone_t, MAX_GEOZONES, geozones, PG_GEOZONE_CONFIG, 0);
+PG_REGISTER_ARRAY(geozoneVertex_t, MAX_GEOZONE_VERTICES, geozoneVertices, PG_GEOZONE_VERTICES, 0);
+
+static geozoneIndex_t geozoneIndex;
+static geozoneStatus_t geozoneStatus;
+
+STATIC_ASSERT(MAX_GEOZONES <= 32, geozone_masks_too_small);
+
+static bool geozoneIsActive(const geozone_t *zone)
+{
+    return zone->vertexCount >= 3 && zone->firstVertex + zone->vertexCount <= MAX_GEOZONE_VERTICES;
+}
+
+static bool geozoneBoundsOverlap(const geozoneBounds_t *a, const geozoneBounds_t *b)
+{
+    return a->latMin <= b->latMax && b->latMin <= a->latMax && a->lonMin <= b->lonMax && b->lonMin <= a->lonMax;
+}
+
+static bool geozoneBoundsContain(const geozoneBounds_t *bounds, int32_t lat, int32_t lon)
+{
+    return lat >= bounds->latMin && lat <= bounds->latMax && lon >= bounds->lonMin && lon <= bounds->lonMax;
+}
+
+// Crossing number test, in 64 bits since the coordinate differences need 32 bits already
+static bool geozoneContainsPoint(const geozone_t *zone, int32_t lat, int32_t lon)
+{
+    const geozoneVertex_t *vertices = geozoneVertices(zone->firstVertex);
+    bool inside = false;
+
+    for (int i = 0, j = zone->vertexCount - 1; i < zone->vertexCount; j = i++) {
+        const geozoneVertex_t *a = &vertices[i];
+        const geozoneVertex_t *b = &vertices[j];
+
+        if ((a->lat > lat) != (b->lat > lat)) {
+            const int64_t lhs = ((int64_t)lon - a->lon) * ((int64_t)b->lat - a->lat);
+            const int64_t rhs = ((int64_t)b->lon - a->lon) * ((int64_t)lat - a->lat);
+            if ((b->lat > a->lat) ? (lhs < rhs) : (lhs > rhs)) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+static bool geozoneContainsAltitude(const geozone_t *zone, int32_t alt)
+{
+    return alt >= zone->minAltitude && (zone->maxAltitude == 0 || alt <= zone->maxAltitude);
+}
+
+// First coordinate of a grid row or column, rounded up to match the cell lookup in geozoneFindZones()
+static int32_t geozoneGridLine(int32_t min, int32_t max, int line)
+{
+    return min + (int32_t)((((int64_t)max - min + 1) * line + GEOZONE_GRID_SIZE - 1) / GEOZONE_GRID_SIZE);
+}
+
+static void geozoneCellBounds(geozoneBounds_t *cell, int row, int col)
+{
+    const geozoneBounds_t *grid = &geozoneIndex.gridBounds;
+
+    cell->latMin = geozoneGridLine(grid->latMin, grid->latMax, row);
+    cell->latMax = geozoneGridLine(grid->latMin, grid->latMax, row + 1) - 1;
+    cell->lonMin = geozoneGridLine(grid->lonMin, grid->lonMax, col);
+    cell->lonMax = geozoneGridLine(grid->lonMin, grid->lonMax, col + 1) - 1;
+}
+
+static bool geozoneCrossesCell(const geozone_t *zone, const geozoneBounds_t *cell)
+{
+    const geozoneVertex_t *vertices = geozoneVertices(zone->firstVertex);
+
+    // Conservative, an edge whose bounding box touches the cell counts as crossing it
+    for (int i = 0, j = zone->vertexCount - 1; i < zone->vertexCount; j = i++) {
+        const geozoneBounds_t edge = {
+            .latMin = MIN(vertices[i].lat, vertices[j].lat),
+            .latMax = MAX(vertices[i].lat, vertices[j].lat),
+            .lonMin = MIN(vertices[i].lon, vertices[j].lon),
+            .lonMax = MAX(vertices[i].lon, vertices[j].lon),
+        };
+        if (geozoneBoundsOverlap(&edge, cell)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void geozoneBuildIndex(void)
+{
+    memset(&geozoneIndex, 0, sizeof(geozoneIndex));
+
+    for (int i = 0; i < MAX_GEOZONES; i++) {
+        const geozone_t *zone = geozones(i);
+        if (!geozoneIsActive(zone)) {
+            continue;
+        }
+
+        const geozoneVertex_t *vertices = geozoneVertices(zone->firstVertex);
+        geozoneBounds_t *bounds = &geozoneIndex.zoneBounds[i];
+        bounds->latMin = bounds->latMax = vertices[0].lat;
+        bounds->lonMin = bounds->lonMax = vertices[0].lon;
+        for (int v = 1; v < zone->vertexCount; v++) {
+            bounds->latMin = MIN(bounds->latMin, vertices[v].lat);
+            bounds->latMax = MAX(bounds->latMax, vertices[v].lat);
+            bounds->lonMin = MIN(bounds->lonMin, vertices[v].lon);
+            bounds->lonMax = MAX(bounds->lonMax, vertices[v].lon);
+        }
+
+        if (geozoneIndex.activeMask) {
+            geozoneIndex.gridBounds.latMin = MIN(geozoneIndex.gridBounds.latMin, bounds->latMin);
+            geozoneIndex.gridBounds.latMax = MAX(geozoneIndex.gridBounds.latMax, bounds->latMax);
+            geozoneIndex.gridBounds.lonMin = MIN(geozoneIndex.gridBounds.lonMin, bounds->lonMin);
+            geozoneIndex.gridBounds.lonMax = MAX(geozoneIndex.gridBounds.lonMax, bounds->lonMax);
+        }
+        else {
+            geozoneIndex.gridBounds = *bounds;
+        }
+
+        geozoneIndex.activeMask |= 1U << i;
+        if (zone->type == GEOZONE_TYPE_INCLUSION) {
+            geozoneIndex.inclusionMask |= 1U << i;
+        }
+    }
+
+    for (int row = 0; row < GEOZONE_GRID_SIZE; row++) {
+        for (int col = 0; col < GEOZONE_GRID_SIZE; col++) {
+            geozoneBounds_t cell;
+            geozoneCellBounds(&cell, row, col);
+
+            for (int i = 0; i < MAX_GEOZONES; i++) {
+                if (!(geozoneIndex.activeMask & (1U << i)) || !geozoneBoundsOverlap(&geozoneIndex.zoneBounds[i], &cell)) {
+                    continue;
+                }
+
+                const geozone_t *zone = geozones(i);
+                if (geozoneCrossesCell(zone, &cell)) {
+                    geozoneIndex.cellCrossing[row][col] |= 1U << i;
+                }
+                else if (geozoneContainsPoint(zone, cell.latMin, cell.lonMin)) {
+                    // No edge runs through the cell, so any of its points tells if all of it is inside
+                    geozoneIndex.cellInside[row][col] |= 1U << i;
+                }
+            }
+        }
+    }
+
+    geozoneIndex.valid = true;
+}
+
+// Zones containing the point, altitude not considered
+static uint32_t geozoneFindZones(int32_t lat, int32_t lon)
+{
+    if (!geozoneIndex.activeMask || !geozoneBoundsContain(&geozoneIndex.gridBounds, lat, lon)) {
+        return 0;
+    }
+
+    const geozoneBounds_t *grid = &geozoneIndex.gridBounds;
+    const int row = ((int64_t)lat - grid->latMin) * GEOZONE_GRID_SIZE / ((int64_t)grid->latMax - grid->latMin + 1);
+    const int col = ((int64_t)lon - grid->lonMin) * GEOZONE_GRID_SIZE / ((int64_t)grid->lonMax - grid->lonMin + 1);
+
+    uint32_t zones = geozoneIndex.cellInside[row][col];
+    uint32_t crossing = geozoneIndex.cellCrossing[row][col];
+
+    while (crossing) {
+        const int i = __builtin_ctz(crossing);
+        crossing &= crossing - 1;
+        if (geozoneContainsPoint(geozones(i), lat, lon)) {
+            zones |= 1U << i;
+        }
+    }
+
+    return zones;
+}
+
+void geozoneInvalidate(void)
+{
+    geozoneIndex.valid = false;
+}
+
+void geozoneUpdate(void)
+{
+    if (!geozoneIndex.valid) {
+        geozoneBuildIndex();
+    }
+
+    memset(&geozoneStatus, 0, sizeof(geozoneStatus));
+
+    if (!geozoneIndex.activeMask || !posControl.gpsOrigin.valid || posControl.flags.estPosStatus < EST_USABLE || posControl.flags.estAltStatus < EST_USABLE) {
+        return;
+    }
+
+    const fpVector3_t *pos = &navGetCurrentActualPositionAndVelocity()->pos;
+    gpsLocation_t llh;
+    if (!geoConvertLocalToGeodetic(&llh, &posControl.gpsOrigin, pos)) {
+        return;
+    }
+
+    const int32_t alt = lrintf(pos->z);
+    uint32_t zones = geozoneFindZones(llh.lat, llh.lon);
+    bool inInclusionZone = false;
+
+    while (zones) {
+        const int i = __builtin_ctz(zones);
+        zones &= zones - 1;
+
+        const geozone_t *zone = geozones(i);
+        if (!geozoneContainsAltitude(zone, alt)) {
+            continue;
+        }
+
+        if (zone->type == GEOZONE_TYPE_INCLUSION) {
+            inInclusionZone = true;
+        }
+        else {
+            geozoneStatus.breached = true;
+            geozoneStatus.inExclusionZone = true;
+            geozoneStatus.action = MAX(geozoneStatus.action, zone->action);
+        }
+    }
+
+    if (geozoneIndex.inclusionMask && !inInclusionZone) {
+        // Outside of all inclusion zones, take the strictest action any of them asks for
+        geozoneStatus.breached = true;
+        for (int i = 0; i < MAX_GEOZONES; i++) {
+            if (geozoneIndex.inclusionMask & (1U << i)) {
+                geozoneStatus.action = MAX(geozoneStatus.action, geozones(i)->action);
+            }
+        }
+    }
+}
+
+bool geozoneIsBreached(void)
+{
+    return geozoneStatus.breached;
+}
+
+bool geozoneIsInExclusionZone(void)
+{
+    return geozoneStatus.inExclusionZone;
+}
+
+bool geozoneShouldForceRTH(void)
+{
+    return ARMING_FLAG(ARMED) && geozoneStatus.breached && geozoneStatus.action == GEOZONE_ACTION_RTH;
+}
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * The mission store keeps missions far longer than NAV_MAX_WAYPOINTS in a
+ * partition of the external flash. Uploads stream into it one waypoint at
+ * a time and navigation pages the mission into waypointList as it's flown.
+ *
+ * Waypoints are kept in fixed size records, the first record holds the
+ * header. The header is written last, so an interrupted upload leaves an
+ * empty store rather than a truncated mission. Records are collected in a
+ * page buffer and programmed a page at a time, erasing each sector when
+ * the first page of it is programmed.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_MISSION_STORE)
+
+#include "common/utils.h"
+
+#include "drivers/flash.h"
+
+#include "fc/runtime_config.h"
+
+#include "navigation/navigation.h"
+
+#define MISSION_STORE_MAGIC         0x314E534D  // "MSN1"
+#define MISSION_STORE_RECORD_SIZE   32          // Power of two so records never straddle a flash page
+#define MISSION_STORE_PAGE_SIZE     256
+
+STATIC_ASSERT(sizeof(navWaypoint_t) <= MISSION_STORE_RECORD_SIZE, missionStoreRecordTooSmall);
+
+typedef struct {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t recordSize;
+} missionStoreHeader_t;
+
+typedef struct {
+    uint32_t startAddress;
+    uint32_t sectorSize;
+    uint16_t capacity;
+    uint16_t count;
+
+    /* Upload in progress */
+    bool     uploading;
+    uint16_t nextIndex;
+    uint32_t bufferAddress;             // Flash address of pageBuffer
+    uint8_t  pageBuffer[MISSION_STORE_PAGE_SIZE];
+} missionStore_t;
+
+static missionStore_t missionStore;
+
+static uint32_t missionStoreRecordAddress(uint32_t record)
+{
+    return missionStore.startAddress + record * MISSION_STORE_RECORD_SIZE;
+}
+
+static bool missionStoreIsSupportedAction(uint8_t action)
+{
+    // JUMP targets, POI and heading changes refer to other waypoints of the
+    // mission which aren't necessarily in RAM while it's flown
+    return action == NAV_WP_ACTION_WAYPOINT || action == NAV_WP_ACTION_HOLD_TIME ||
+           action == NAV_WP_ACTION_RTH || action == NAV_WP_ACTION_LAND;
+}
+
+bool missionStoreInit(void)
+{
+    const flashPartition_t *partition = flashPartitionFindByType(FLASH_PARTITION_TYPE_MISSION);
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    memset(&missionStore, 0, sizeof(missionStore));
+
+    // NAND pages are too big to buffer and can only be programmed a few times
+    if (!partition || geometry->flashType != FLASH_TYPE_NOR || geometry->pageSize != MISSION_STORE_PAGE_SIZE) {
+        return false;
+    }
+
+    const uint32_t records = FLASH_PARTITION_SECTOR_COUNT(partition) * geometry->sectorSize / MISSION_STORE_RECORD_SIZE;
+
+    missionStore.startAddress = partition->startSector * geometry->sectorSize;
+    missionStore.sectorSize = geometry->sectorSize;
+    missionStore.capacity = MIN(records - 1, (uint32_t)UINT16_MAX);
+
+    missionStoreHeader_t header;
+    if (flashReadBytes(missionStoreRecordAddress(0), (uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+        header.magic == MISSION_STORE_MAGIC && header.recordSize == MISSION_STORE_RECORD_SIZE && header.count <= missionStore.capacity) {
+        missionStore.count = header.count;
+    }
+
+    return true;
+}
+
+void missionStoreGetInfo(missionStoreInfo_t *info)
+{
+    info->capacity = missionStore.capacity;
+    info->count = missionStore.uploading ? 0 : missionStore.count;
+}
+
+bool missionStoreBeginUpload(void)
+{
+    if (!missionStore.capacity || ARMING_FLAG(ARMED)) {
+        return false;
+    }
+
+    // The header lives in the first sector, the stored mission is gone from here on
+    flashEraseSector(missionStore.startAddress);
+
+    missionStore.count = 0;
+    missionStore.uploading = true;
+    missionStore.nextIndex = 0;
+    missionStore.bufferAddress = missionStore.startAddress;
+    memset(missionStore.pageBuffer, 0xFF, sizeof(missionStore.pageBuffer));
+
+    return true;
+}
+
+static bool missionStoreFlushPage(void)
+{
+    const uint32_t address = missionStore.bufferAddress;
+
+    if (address != missionStore.startAddress && (address % missionStore.sectorSize) == 0) {
+        flashEraseSector(address);
+    }
+
+    const bool success = flashPageProgram(address, missionStore.pageBuffer, MISSION_STORE_PAGE_SIZE) != address;
+
+    missionStore.bufferAddress += MISSION_STORE_PAGE_SIZE;
+    memset(missionStore.pageBuffer, 0xFF, sizeof(missionStore.pageBuffer));
+
+    return success;
+}
+
+bool missionStoreWriteWaypoint(uint16_t index, const navWaypoint_t *wpData)
+{
+    // Waypoints have to come in order, they are programmed a page at a time
+    if (!missionStore.uploading || index != missionStore.nextIndex || index >= missionStore.capacity || !missionStoreIsSupportedAction(wpData->action)) {
+        return false;
+    }
+
+    const uint32_t address = missionStoreRecordAddress(index + 1);
+
+    if (address >= missionStore.bufferAddress + MISSION_STORE_PAGE_SIZE && !missionStoreFlushPage()) {
+        missionStore.uploading = false;
+        return false;
+    }
+
+    memcpy(&missionStore.pageBuffer[address - missionStore.bufferAddress], wpData, sizeof(navWaypoint_t));
+    missionStore.nextIndex++;
+
+    return true;
+}
+
+bool missionStoreFinishUpload(uint16_t count)
+{
+    if (!missionStore.uploading) {
+        return false;
+    }
+
+    missionStore.uploading = false;
+
+    if (count == 0 || count != missionStore.nextIndex || !missionStoreFlushPage()) {
+        return false;
+    }
+
+    const missionStoreHeader_t header = {
+        .magic = MISSION_STORE_MAGIC,
+        .count = count,
+        .recordSize = MISSION_STORE_RECORD_SIZE,
+    };
+
+    const uint32_t address = missionStoreRecordAddress(0);
+    if (flashPageProgram(address, (const uint8_t *)&header, sizeof(header)) == address) {
+        return false;
+    }
+
+    missionStore.count = count;
+
+    return true;
+}
+
+bool missionStoreReadWaypoints(uint16_t index, navWaypoint_t *wpData, uint16_t count)
+{
+    if (missionStore.uploading || (uint32_t)index + count > missionStore.count) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        // Waits for a pending blackbox write to the flash, fails on timeout
+        if (flashReadBytes(missionStoreRecordAddress(index + i + 1), (uint8_t *)&wpData[i], sizeof(navWaypoint_t)) != sizeof(navWaypoint_t)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif // defined(USE_MISSION_STORE)
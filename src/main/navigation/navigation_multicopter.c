@@ -396,6 +396,174 @@ static void processMulticopterBrakingMode(const bool isAdjusting)
 #endif
 }
 
+/*-----------------------------------------------------------
+ * Jerk limited trajectory toward a new XY hold position
+ * Built once per target change as a 7 phase S-curve along the straight line
+ * from the current position, then sampled at each position update.
+ *-----------------------------------------------------------*/
+#define MC_TRAJECTORY_PHASE_COUNT   7
+#define MC_TRAJECTORY_ACCEL_MAX     (NAV_ACCELERATION_XY_MAX / 2)   // Leave headroom for the velocity controller
+
+typedef struct {
+    float duration;
+    float jerk;
+    // State along the path at the start of the phase
+    float pos;
+    float vel;
+    float acc;
+} mcTrajectoryPhase_t;
+
+typedef struct {
+    bool valid;
+    float targetX;
+    float targetY;
+    float startX;
+    float startY;
+    float dirX;
+    float dirY;
+    timeUs_t startTimeUs;
+    mcTrajectoryPhase_t phase[MC_TRAJECTORY_PHASE_COUNT];
+    // Feedforward from the last sample
+    float velX;
+    float velY;
+    float accelX;
+    float accelY;
+} mcTrajectory_t;
+
+static mcTrajectory_t mcTrajectory;
+
+// Durations of the jerk and constant acceleration parts of a symmetric jerk limited velocity change
+static void calculateVelocityChangeTiming(float deltaVel, float *jerkTime, float *accelTime)
+{
+    if (deltaVel >= sq(MC_TRAJECTORY_ACCEL_MAX) / MC_POS_CONTROL_JERK_LIMIT_CMSSS) {
+        *jerkTime = MC_TRAJECTORY_ACCEL_MAX / MC_POS_CONTROL_JERK_LIMIT_CMSSS;
+        *accelTime = deltaVel / MC_TRAJECTORY_ACCEL_MAX - *jerkTime;
+    } else {
+        *jerkTime = fast_fsqrtf(MAX(deltaVel, 0.0f) / MC_POS_CONTROL_JERK_LIMIT_CMSSS);
+        *accelTime = 0.0f;
+    }
+}
+
+// Distance to accelerate from startVel to peakVel and brake to a stop again
+static float calculateTrajectoryDistance(float startVel, float peakVel)
+{
+    float jerkTime, accelTime;
+
+    // A symmetric velocity change covers the average velocity times its duration
+    calculateVelocityChangeTiming(peakVel - startVel, &jerkTime, &accelTime);
+    const float accelDistance = (startVel + peakVel) / 2 * (2 * jerkTime + accelTime);
+
+    calculateVelocityChangeTiming(peakVel, &jerkTime, &accelTime);
+    return accelDistance + peakVel / 2 * (2 * jerkTime + accelTime);
+}
+
+static void buildPositionTrajectory(const fpVector3_t *target, float maxSpeed, timeUs_t currentTimeUs)
+{
+    const navEstimatedPosVel_t *actual = navGetCurrentActualPositionAndVelocity();
+    const float deltaX = target->x - actual->pos.x;
+    const float deltaY = target->y - actual->pos.y;
+    const float distance = calc_length_pythagorean_2D(deltaX, deltaY);
+
+    mcTrajectory.valid = true;
+    mcTrajectory.targetX = target->x;
+    mcTrajectory.targetY = target->y;
+    mcTrajectory.startX = actual->pos.x;
+    mcTrajectory.startY = actual->pos.y;
+    mcTrajectory.dirX = distance > 1.0f ? deltaX / distance : 0.0f;
+    mcTrajectory.dirY = distance > 1.0f ? deltaY / distance : 0.0f;
+    mcTrajectory.startTimeUs = currentTimeUs;
+
+    // Velocity across the path is left to the velocity controller
+    const float startVel = constrainf(actual->vel.x * mcTrajectory.dirX + actual->vel.y * mcTrajectory.dirY, 0.0f, maxSpeed);
+
+    float peakVel = maxSpeed;
+    if (calculateTrajectoryDistance(startVel, startVel) >= distance) {
+        // Too close to stop in time, brake right away and let the position controller pull back
+        peakVel = startVel;
+    } else if (calculateTrajectoryDistance(startVel, maxSpeed) > distance) {
+        float low = startVel;
+        float high = maxSpeed;
+        for (int i = 0; i < 12; i++) {
+            peakVel = (low + high) / 2;
+            if (calculateTrajectoryDistance(startVel, peakVel) > distance) {
+                high = peakVel;
+            } else {
+                low = peakVel;
+            }
+        }
+        peakVel = low;
+    }
+
+    float accelJerkTime, accelTime, brakeJerkTime, brakeTime;
+    calculateVelocityChangeTiming(peakVel - startVel, &accelJerkTime, &accelTime);
+    calculateVelocityChangeTiming(peakVel, &brakeJerkTime, &brakeTime);
+    const float cruiseTime = peakVel > 1.0f ? MAX(distance - calculateTrajectoryDistance(startVel, peakVel), 0.0f) / peakVel : 0.0f;
+
+    const float phaseDuration[MC_TRAJECTORY_PHASE_COUNT] = { accelJerkTime, accelTime, accelJerkTime, cruiseTime, brakeJerkTime, brakeTime, brakeJerkTime };
+    const float phaseJerk[MC_TRAJECTORY_PHASE_COUNT] = { 1.0f, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f };
+
+    float pos = 0.0f;
+    float vel = startVel;
+    float acc = 0.0f;
+    for (int i = 0; i < MC_TRAJECTORY_PHASE_COUNT; i++) {
+        mcTrajectoryPhase_t *phase = &mcTrajectory.phase[i];
+        const float t = phaseDuration[i];
+
+        phase->duration = t;
+        phase->jerk = phaseJerk[i] * MC_POS_CONTROL_JERK_LIMIT_CMSSS;
+        phase->pos = pos;
+        phase->vel = vel;
+        phase->acc = acc;
+
+        pos += vel * t + acc * sq(t) / 2 + phase->jerk * t * sq(t) / 6;
+        vel += acc * t + phase->jerk * sq(t) / 2;
+        acc += phase->jerk * t;
+    }
+}
+
+// Constant time lookup of the reference position, velocity and acceleration
+static void samplePositionTrajectory(timeUs_t currentTimeUs, float *refX, float *refY)
+{
+    float t = US2S(currentTimeUs - mcTrajectory.startTimeUs);
+
+    for (int i = 0; i < MC_TRAJECTORY_PHASE_COUNT; i++) {
+        const mcTrajectoryPhase_t *phase = &mcTrajectory.phase[i];
+
+        if (t < phase->duration) {
+            const float pos = phase->pos + phase->vel * t + phase->acc * sq(t) / 2 + phase->jerk * t * sq(t) / 6;
+            const float vel = phase->vel + phase->acc * t + phase->jerk * sq(t) / 2;
+            const float acc = phase->acc + phase->jerk * t;
+
+            *refX = mcTrajectory.startX + pos * mcTrajectory.dirX;
+            *refY = mcTrajectory.startY + pos * mcTrajectory.dirY;
+            mcTrajectory.velX = vel * mcTrajectory.dirX;
+            mcTrajectory.velY = vel * mcTrajectory.dirY;
+            mcTrajectory.accelX = acc * mcTrajectory.dirX;
+            mcTrajectory.accelY = acc * mcTrajectory.dirY;
+            return;
+        }
+
+        t -= phase->duration;
+    }
+
+    // Trajectory finished, hold the target
+    *refX = mcTrajectory.targetX;
+    *refY = mcTrajectory.targetY;
+    mcTrajectory.velX = 0.0f;
+    mcTrajectory.velY = 0.0f;
+    mcTrajectory.accelX = 0.0f;
+    mcTrajectory.accelY = 0.0f;
+}
+
+static bool isPositionTrajectoryAllowed(void)
+{
+    // Stick input and braking move the target continuously, WP legs are flown at constant speed
+    return navConfig()->mc.posTrajectory &&
+           !posControl.flags.isAdjustingPosition &&
+           !STATE(NAV_CRUISE_BRAKING) &&
+           (!(navGetCurrentStateFlags() & NAV_AUTO_WP) || isNavHoldPositionActive());
+}
+
 void resetMulticopterPositionController(void)
 {
     for (int axis = 0; axis < 2; axis++) {
@@ -404,6 +572,8 @@ void resetMulticopterPositionController(void)
         lastAccelTargetX = 0.0f;
         lastAccelTargetY = 0.0f;
     }
+
+    mcTrajectory.valid = false;
 }
 
 bool adjustMulticopterPositionFromRCInput(int16_t rcPitchAdjustment, int16_t rcRollAdjustment)
@@ -465,14 +635,31 @@ static float getVelocityExpoAttenuationFactor(float velTotal, float velMax)
     return 1.0f - posControl.posResponseExpo * (1.0f - (velScale * velScale));  // x^3 expo factor
 }
 
-static void updatePositionVelocityController_MC(const float maxSpeed)
+static void updatePositionVelocityController_MC(const float maxSpeed, timeUs_t currentTimeUs)
 {
-    const float posErrorX = posControl.desiredState.pos.x - navGetCurrentActualPositionAndVelocity()->pos.x;
-    const float posErrorY = posControl.desiredState.pos.y - navGetCurrentActualPositionAndVelocity()->pos.y;
+    float refX = posControl.desiredState.pos.x;
+    float refY = posControl.desiredState.pos.y;
+    float velFeedForwardX = 0.0f;
+    float velFeedForwardY = 0.0f;
+
+    if (isPositionTrajectoryAllowed()) {
+        if (!mcTrajectory.valid || mcTrajectory.targetX != posControl.desiredState.pos.x || mcTrajectory.targetY != posControl.desiredState.pos.y) {
+            buildPositionTrajectory(&posControl.desiredState.pos, maxSpeed, currentTimeUs);
+        }
+
+        samplePositionTrajectory(currentTimeUs, &refX, &refY);
+        velFeedForwardX = mcTrajectory.velX;
+        velFeedForwardY = mcTrajectory.velY;
+    } else {
+        mcTrajectory.valid = false;
+    }
+
+    const float posErrorX = refX - navGetCurrentActualPositionAndVelocity()->pos.x;
+    const float posErrorY = refY - navGetCurrentActualPositionAndVelocity()->pos.y;
 
     // Calculate target velocity
-    float newVelX = posErrorX * posControl.pids.pos[X].param.kP;
-    float newVelY = posErrorY * posControl.pids.pos[Y].param.kP;
+    float newVelX = posErrorX * posControl.pids.pos[X].param.kP + velFeedForwardX;
+    float newVelY = posErrorY * posControl.pids.pos[Y].param.kP + velFeedForwardY;
 
     // Scale velocity to respect max_speed
     float newVelTotal = calc_length_pythagorean_2D(newVelX, newVelY);
@@ -650,6 +837,12 @@ static void updatePositionAccelController_MC(timeDelta_t deltaMicros, float maxA
     lastAccelTargetX = newAccelX;
     lastAccelTargetY = newAccelY;
 
+    // Trajectory acceleration feedforward, kept out of the jerk limited PID output above
+    if (mcTrajectory.valid) {
+        newAccelX = constrainf(newAccelX + mcTrajectory.accelX, -maxAccelLimit, maxAccelLimit);
+        newAccelY = constrainf(newAccelY + mcTrajectory.accelY, -maxAccelLimit, maxAccelLimit);
+    }
+
     // Rotate acceleration target into forward-right frame (aircraft)
     const float accelForward = newAccelX * posControl.actualState.cosYaw + newAccelY * posControl.actualState.sinYaw;
     const float accelRight = -newAccelX * posControl.actualState.sinYaw + newAccelY * posControl.actualState.cosYaw;
@@ -683,7 +876,7 @@ static void applyMulticopterPositionController(timeUs_t currentTimeUs)
                 if (deltaMicrosPositionUpdate < MAX_POSITION_UPDATE_INTERVAL_US) {
                     // Get max speed from generic NAV (waypoint specific), don't allow to move slower than 0.5 m/s
                     const float maxSpeed = getActiveWaypointSpeed();
-                    updatePositionVelocityController_MC(maxSpeed);
+                    updatePositionVelocityController_MC(maxSpeed, currentTimeUs);
                     updatePositionAccelController_MC(deltaMicrosPositionUpdate, NAV_ACCELERATION_XY_MAX, maxSpeed);
                 }
                 else {
@@ -720,6 +913,83 @@ bool isMulticopterFlying(void)
 /*-----------------------------------------------------------
  * Multicopter land detector
  *-----------------------------------------------------------*/
+// Exponentially weighted mean and variance, constant time per sample
+typedef struct {
+    float mean;
+    float variance;
+} landingDetectorStat_t;
+
+typedef struct {
+    timeUs_t lastUpdateUs;
+    landingDetectorStat_t thrust;
+    landingDetectorStat_t velZ;
+    landingDetectorStat_t accel;
+    landingDetectorStat_t gyro;
+} landingDetectorStats_t;
+
+static landingDetectorStats_t landingStats;
+
+static void landingDetectorStatUpdate(landingDetectorStat_t *stat, float sample, float alpha)
+{
+    const float delta = sample - stat->mean;
+    stat->mean += alpha * delta;
+    stat->variance = (1.0f - alpha) * (stat->variance + alpha * sq(delta));
+}
+
+static float getMotorThrustRatio(void)
+{
+    const int motorCount = getMotorCount();
+    if (motorCount == 0) {
+        return 0.0f;
+    }
+
+    int32_t motorSum = 0;
+    for (int i = 0; i < motorCount; i++) {
+        motorSum += motor[i];
+    }
+
+    const float hoverRange = MAX(currentBatteryProfile->nav.mc.hover_throttle - getThrottleIdleValue(), 1);
+    return ((float)motorSum / motorCount - getThrottleIdleValue()) / hoverRange;
+}
+
+static void updateLandingDetectorStats(timeUs_t currentTimeUs)
+{
+    const float dT = US2S(currentTimeUs - landingStats.lastUpdateUs);
+    landingStats.lastUpdateUs = currentTimeUs;
+
+    if (dT <= 0.0f || dT > MC_LAND_FUSION_WINDOW) {
+        // First sample or a long pause: restart the statistics from this sample
+        landingStats.thrust = (landingDetectorStat_t){ .mean = getMotorThrustRatio(), .variance = 0 };
+        landingStats.velZ = (landingDetectorStat_t){ .mean = navGetCurrentActualPositionAndVelocity()->vel.z, .variance = 0 };
+        landingStats.accel = (landingDetectorStat_t){ .mean = fast_fsqrtf(vectorNormSquared(&imuMeasuredAccelBF)), .variance = 0 };
+        landingStats.gyro = (landingDetectorStat_t){ .mean = averageAbsGyroRates(), .variance = 0 };
+        return;
+    }
+
+    const float alpha = dT / (MC_LAND_FUSION_WINDOW + dT);
+    landingDetectorStatUpdate(&landingStats.thrust, getMotorThrustRatio(), alpha);
+    landingDetectorStatUpdate(&landingStats.velZ, navGetCurrentActualPositionAndVelocity()->vel.z, alpha);
+    landingDetectorStatUpdate(&landingStats.accel, fast_fsqrtf(vectorNormSquared(&imuMeasuredAccelBF)), alpha);
+    landingDetectorStatUpdate(&landingStats.gyro, averageAbsGyroRates(), alpha);
+}
+
+static bool isLandingDetectedFromStats(void)
+{
+    const bool thrustCondition = landingStats.thrust.mean < MC_LAND_FUSION_THRUST_RATIO;
+    const bool velCondition = fabsf(landingStats.velZ.mean) < MC_LAND_CHECK_VEL_Z_MOVING &&
+                              posControl.actualState.velXY < MC_LAND_CHECK_VEL_XY_MOVING;
+    // A bouncing touchdown shows up as acceleration spread even when the mean looks settled
+    const bool accelCondition = landingStats.accel.variance < sq(MC_LAND_FUSION_ACC_STD);
+    const bool gyroCondition = landingStats.gyro.mean < 2.0f && landingStats.gyro.variance < sq(MC_LAND_FUSION_GYRO_STD);
+
+    DEBUG_SET(DEBUG_LANDING, 2, velCondition);
+    DEBUG_SET(DEBUG_LANDING, 3, gyroCondition);
+    DEBUG_SET(DEBUG_LANDING, 6, thrustCondition);
+    DEBUG_SET(DEBUG_LANDING, 7, accelCondition);
+
+    return thrustCondition && velCondition && accelCondition && gyroCondition;
+}
+
 bool isMulticopterLandingDetected(void)
 {
     DEBUG_SET(DEBUG_LANDING, 4, 0);
@@ -734,9 +1004,31 @@ bool isMulticopterLandingDetected(void)
 
     if (!startCondition || posControl.flags.resetLandingDetector) {
         landingDetectorStartedAt = 0;
+        landingStats.lastUpdateUs = 0;
         return posControl.flags.resetLandingDetector = false;
     }
 
+    if (navConfig()->mc.landDetectFusion) {
+        const timeUs_t currentTimeUs = micros();
+        updateLandingDetectorStats(currentTimeUs);
+
+        bool possibleLandingDetected = isLandingDetectedFromStats();
+
+        if ((posControl.flags.estAglStatus == EST_TRUSTED) && (posControl.actualState.agl.pos.z >= 0)) {
+            possibleLandingDetected = possibleLandingDetected && (posControl.actualState.agl.pos.z <= (posControl.actualState.surfaceMin + MC_LAND_SAFE_SURFACE));
+        }
+        DEBUG_SET(DEBUG_LANDING, 4, 3);
+        DEBUG_SET(DEBUG_LANDING, 5, possibleLandingDetected);
+
+        if (!possibleLandingDetected || !landingDetectorStartedAt) {
+            landingDetectorStartedAt = currentTimeUs;
+            return false;
+        }
+
+        const timeUs_t confirmTimeUs = MS2US(MC_LAND_FUSION_CONFIRM_TIME + navConfig()->mc.auto_disarm_delay);
+        return currentTimeUs - landingDetectorStartedAt > confirmTimeUs;
+    }
+
     // check vertical and horizontal velocities are low (cm/s)
     bool velCondition = fabsf(navGetCurrentActualPositionAndVelocity()->vel.z) < MC_LAND_CHECK_VEL_Z_MOVING &&
                         posControl.actualState.velXY < MC_LAND_CHECK_VEL_XY_MOVING;
@@ -55,7 +55,7 @@
 
 navigationPosEstimator_t posEstimator;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 5);
+PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 7);
 
 PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         // Inertial position estimator parameters
@@ -91,7 +91,12 @@ PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         .w_acc_bias = SETTING_INAV_W_ACC_BIAS_DEFAULT,
 
         .max_eph_epv = SETTING_INAV_MAX_EPH_EPV_DEFAULT,
-        .baro_epv = SETTING_INAV_BARO_EPV_DEFAULT
+        .baro_epv = SETTING_INAV_BARO_EPV_DEFAULT,
+        .gps_delay = SETTING_INAV_GPS_DELAY_DEFAULT,
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+        .estimator_type = SETTING_INAV_POS_ESTIMATOR_DEFAULT,
+#endif
 );
 
 #define resetTimer(tim, currentTimeUs) { (tim)->deltaTime = 0; (tim)->lastTriggeredTime = currentTimeUs; }
@@ -195,7 +200,10 @@ void onNewGPSData(void)
     static bool isFirstGPSUpdate = true;
 
     gpsLocation_t newLLH;
-    const timeUs_t currentTimeUs = micros();
+    // Fixes are timed by their reception, not by when the estimator gets to them
+    const timeUs_t currentTimeUs = gpsSol.sample.timeUs;
+
+    sensorSampleConsume(&gpsSol.sample, micros());
 
     newLLH.lat = gpsSol.llh.lat;
     newLLH.lon = gpsSol.llh.lon;
@@ -317,11 +325,14 @@ void updatePositionEstimator_BaroTopic(timeUs_t currentTimeUs)
     }
 
     if (sensors(SENSOR_BARO) && baroIsCalibrationComplete()) {
-        const timeUs_t baroDtUs = currentTimeUs - posEstimator.baro.lastUpdateTime;
+        const timeUs_t sampleTimeUs = baro.sample.timeUs;
+        const timeUs_t baroDtUs = sampleTimeUs - posEstimator.baro.lastUpdateTime;
+
+        sensorSampleConsume(&baro.sample, currentTimeUs);
 
         posEstimator.baro.alt = newBaroAlt - initialBaroAltitudeOffset;
         posEstimator.baro.epv = positionEstimationConfig()->baro_epv;
-        posEstimator.baro.lastUpdateTime = currentTimeUs;
+        posEstimator.baro.lastUpdateTime = sampleTimeUs;
 
         if (baroDtUs <= MS2US(INAV_BARO_TIMEOUT_MS)) {
             pt1FilterApply3(&posEstimator.baro.avgFilter, posEstimator.baro.alt, US2S(baroDtUs));
@@ -556,31 +567,104 @@ static void estimationPredict(estimationContext_t * ctx)
     }
 }
 
-static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
+static void estimationRecordHistory(timeUs_t currentTimeUs)
 {
-    if (ctx->newFlags & EST_BARO_VALID) {
-        timeUs_t currentTimeUs = micros();
+    navPositionEstimatorHISTORY_t *history = &posEstimator.history;
 
-        if (!ARMING_FLAG(ARMED)) {
-            posEstimator.state.baroGroundAlt = posEstimator.est.pos.z;
-            posEstimator.state.isBaroGroundValid = true;
-            posEstimator.state.baroGroundTimeout = currentTimeUs + 250000;   // 0.25 sec
+    if (history->count > 0) {
+        const navPositionEstimatorHistoryEntry_t *last = &history->entry[(history->head + INAV_HISTORY_SIZE - 1) % INAV_HISTORY_SIZE];
+        if (cmpTimeUs(currentTimeUs, last->time) < INAV_HISTORY_INTERVAL_US) {
+            return;
         }
-        else {
-            if (posEstimator.est.vel.z > 15) {
-                if (currentTimeUs > posEstimator.state.baroGroundTimeout) {
-                    posEstimator.state.isBaroGroundValid = false;
-                }
-            }
-            else {
-                posEstimator.state.baroGroundTimeout = currentTimeUs + 250000;   // 0.25 sec
+    }
+
+    navPositionEstimatorHistoryEntry_t *entry = &history->entry[history->head];
+    entry->time = currentTimeUs;
+    entry->pos = posEstimator.est.pos;
+    entry->vel = posEstimator.est.vel;
+
+    history->head = (history->head + 1) % INAV_HISTORY_SIZE;
+    if (history->count < INAV_HISTORY_SIZE) {
+        history->count++;
+    }
+}
+
+/*
+ * Corrections to the current estimate apply to the past estimates as well,
+ * otherwise a delayed residual would keep asking for the same correction
+ */
+static void estimationCorrectHistory(const fpVector3_t * posCorr, const fpVector3_t * velCorr)
+{
+    for (int i = 0; i < posEstimator.history.count; i++) {
+        vectorAdd(&posEstimator.history.entry[i].pos, &posEstimator.history.entry[i].pos, posCorr);
+        vectorAdd(&posEstimator.history.entry[i].vel, &posEstimator.history.entry[i].vel, velCorr);
+    }
+}
+
+/*
+ * Estimate at the time the last GPS solution was measured. Falls back to the
+ * oldest estimate when the history doesn't go back far enough and to the
+ * current estimate when there is no GPS delay.
+ */
+const navPositionEstimatorHistoryEntry_t * estimationGetGpsSampleEstimate(void)
+{
+    static navPositionEstimatorHistoryEntry_t current;
+    const navPositionEstimatorHISTORY_t *history = &posEstimator.history;
+
+    if (positionEstimationConfig()->gps_delay == 0 || history->count == 0) {
+        current.time = posEstimator.est.lastUpdateTime;
+        current.pos = posEstimator.est.pos;
+        current.vel = posEstimator.est.vel;
+        return &current;
+    }
+
+    const timeUs_t sampleTime = posEstimator.gps.lastUpdateTime - MS2US(positionEstimationConfig()->gps_delay);
+    const navPositionEstimatorHistoryEntry_t *entry = NULL;
+
+    for (int i = 1; i <= history->count; i++) {
+        entry = &history->entry[(history->head + INAV_HISTORY_SIZE - i) % INAV_HISTORY_SIZE];
+        if (cmpTimeUs(sampleTime, entry->time) >= 0) {
+            break;
+        }
+    }
+
+    return entry;
+}
+
+/*
+ * Tracks the baro altitude of the ground while taking off and checks if the
+ * baro may be disturbed by the air cushion effect close to the ground
+ */
+bool estimationDetectAirCushion(estimationContext_t * ctx)
+{
+    timeUs_t currentTimeUs = micros();
+
+    if (!ARMING_FLAG(ARMED)) {
+        posEstimator.state.baroGroundAlt = posEstimator.est.pos.z;
+        posEstimator.state.isBaroGroundValid = true;
+        posEstimator.state.baroGroundTimeout = currentTimeUs + 250000;   // 0.25 sec
+    }
+    else {
+        if (posEstimator.est.vel.z > 15) {
+            if (currentTimeUs > posEstimator.state.baroGroundTimeout) {
+                posEstimator.state.isBaroGroundValid = false;
             }
         }
+        else {
+            posEstimator.state.baroGroundTimeout = currentTimeUs + 250000;   // 0.25 sec
+        }
+    }
+
+    // We might be experiencing air cushion effect - use sonar or baro groung altitude to detect it
+    return ARMING_FLAG(ARMED) &&
+            (((ctx->newFlags & EST_SURFACE_VALID) && posEstimator.surface.alt < 20.0f && posEstimator.state.isBaroGroundValid) ||
+             ((ctx->newFlags & EST_BARO_VALID) && posEstimator.state.isBaroGroundValid && posEstimator.baro.alt < posEstimator.state.baroGroundAlt));
+}
 
-        // We might be experiencing air cushion effect - use sonar or baro groung altitude to detect it
-        bool isAirCushionEffectDetected = ARMING_FLAG(ARMED) &&
-                                            (((ctx->newFlags & EST_SURFACE_VALID) && posEstimator.surface.alt < 20.0f && posEstimator.state.isBaroGroundValid) ||
-                                             ((ctx->newFlags & EST_BARO_VALID) && posEstimator.state.isBaroGroundValid && posEstimator.baro.alt < posEstimator.state.baroGroundAlt));
+static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
+{
+    if (ctx->newFlags & EST_BARO_VALID) {
+        const bool isAirCushionEffectDetected = estimationDetectAirCushion(ctx);
 
         // Altitude
         const float baroAltResidual = (isAirCushionEffectDetected ? posEstimator.state.baroGroundAlt : posEstimator.baro.alt) - posEstimator.est.pos.z;
@@ -590,7 +674,7 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
         // If GPS is available - also use GPS climb rate
         if (ctx->newFlags & EST_GPS_Z_VALID) {
             // Trust GPS velocity only if residual/error is less than 2.5 m/s, scale weight according to gaussian distribution
-            const float gpsRocResidual = posEstimator.gps.vel.z - posEstimator.est.vel.z;
+            const float gpsRocResidual = posEstimator.gps.vel.z - estimationGetGpsSampleEstimate()->vel.z;
             const float gpsRocScaler = bellCurve(gpsRocResidual, 250.0f);
             ctx->estVelCorr.z += gpsRocResidual * positionEstimationConfig()->w_z_gps_v * gpsRocScaler * ctx->dt;
         }
@@ -613,12 +697,14 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
             ctx->newEPV = posEstimator.gps.epv;
         }
         else {
+            const navPositionEstimatorHistoryEntry_t * gpsSampleEstimate = estimationGetGpsSampleEstimate();
+
             // Altitude
-            const float gpsAltResudual = posEstimator.gps.pos.z - posEstimator.est.pos.z;
+            const float gpsAltResudual = posEstimator.gps.pos.z - gpsSampleEstimate->pos.z;
 
             ctx->estPosCorr.z += gpsAltResudual * positionEstimationConfig()->w_z_gps_p * ctx->dt;
             ctx->estVelCorr.z += gpsAltResudual * sq(positionEstimationConfig()->w_z_gps_p) * ctx->dt;
-            ctx->estVelCorr.z += (posEstimator.gps.vel.z - posEstimator.est.vel.z) * positionEstimationConfig()->w_z_gps_v * ctx->dt;
+            ctx->estVelCorr.z += (posEstimator.gps.vel.z - gpsSampleEstimate->vel.z) * positionEstimationConfig()->w_z_gps_v * ctx->dt;
             ctx->newEPV = updateEPE(posEstimator.est.epv, ctx->dt, MAX(posEstimator.gps.epv, gpsAltResudual), positionEstimationConfig()->w_z_gps_p);
 
             // Accelerometer bias
@@ -652,10 +738,12 @@ static bool estimationCalculateCorrection_XY_GPS(estimationContext_t * ctx)
             ctx->newEPH = posEstimator.gps.eph;
         }
         else {
-            const float gpsPosXResidual = posEstimator.gps.pos.x - posEstimator.est.pos.x;
-            const float gpsPosYResidual = posEstimator.gps.pos.y - posEstimator.est.pos.y;
-            const float gpsVelXResidual = posEstimator.gps.vel.x - posEstimator.est.vel.x;
-            const float gpsVelYResidual = posEstimator.gps.vel.y - posEstimator.est.vel.y;
+            // Residuals against the estimate from when the GPS solution was measured
+            const navPositionEstimatorHistoryEntry_t * gpsSampleEstimate = estimationGetGpsSampleEstimate();
+            const float gpsPosXResidual = posEstimator.gps.pos.x - gpsSampleEstimate->pos.x;
+            const float gpsPosYResidual = posEstimator.gps.pos.y - gpsSampleEstimate->pos.y;
+            const float gpsVelXResidual = posEstimator.gps.vel.x - gpsSampleEstimate->vel.x;
+            const float gpsVelYResidual = posEstimator.gps.vel.y - gpsSampleEstimate->vel.y;
             const float gpsPosResidualMag = calc_length_pythagorean_2D(gpsPosXResidual, gpsPosYResidual);
 
             //const float gpsWeightScaler = scaleRangef(bellCurve(gpsPosResidualMag, INAV_GPS_ACCEPTANCE_EPE), 0.0f, 1.0f, 0.1f, 1.0f);
@@ -723,16 +811,40 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
 
     /* Prediction stage: X,Y,Z */
     estimationPredict(&ctx);
+    estimationRecordHistory(currentTimeUs);
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+    const bool useEkf = positionEstimationConfig()->estimator_type == NAV_POS_ESTIMATOR_EKF;
+#else
+    const bool useEkf = false;
+#endif
+
+    bool estZCorrectOk;
+    bool estXYCorrectOk;
+
+    if (useEkf) {
+#if defined(USE_POS_ESTIMATOR_EKF)
+        estimationEkfPredict(&ctx);
 
-    /* Correction stage: Z */
-    const bool estZCorrectOk =
-        estimationCalculateCorrection_Z(&ctx);
+        estZCorrectOk = estimationEkfCorrect_Z(&ctx);
+        estXYCorrectOk =
+            estimationEkfCorrect_XY(&ctx, currentTimeUs) ||
+            estimationCalculateCorrection_XY_FLOW(&ctx);
 
-    /* Correction stage: XY: GPS, FLOW */
-    // FIXME: Handle transition from FLOW to GPS and back - seamlessly fly indoor/outdoor
-    const bool estXYCorrectOk =
-        estimationCalculateCorrection_XY_GPS(&ctx) ||
-        estimationCalculateCorrection_XY_FLOW(&ctx);
+        estimationEkfApply(&ctx);
+#endif
+    }
+    else {
+        /* Correction stage: Z */
+        estZCorrectOk =
+            estimationCalculateCorrection_Z(&ctx);
+
+        /* Correction stage: XY: GPS, FLOW */
+        // FIXME: Handle transition from FLOW to GPS and back - seamlessly fly indoor/outdoor
+        estXYCorrectOk =
+            estimationCalculateCorrection_XY_GPS(&ctx) ||
+            estimationCalculateCorrection_XY_FLOW(&ctx);
+    }
 
     // If we can't apply correction or accuracy is off the charts - decay velocity to zero
     if (!estXYCorrectOk || ctx.newEPH > positionEstimationConfig()->max_eph_epv) {
@@ -747,6 +859,7 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
     // Apply corrections
     vectorAdd(&posEstimator.est.pos, &posEstimator.est.pos, &ctx.estPosCorr);
     vectorAdd(&posEstimator.est.vel, &posEstimator.est.vel, &ctx.estVelCorr);
+    estimationCorrectHistory(&ctx.estPosCorr, &ctx.estVelCorr);
 
     /* Correct accelerometer bias */
     if (positionEstimationConfig()->w_acc_bias > 0.0f) {
@@ -848,6 +961,9 @@ void initializePositionEstimator(void)
 
     restartGravityCalibration();
 
+    posEstimator.history.head = 0;
+    posEstimator.history.count = 0;
+
     for (axis = 0; axis < 3; axis++) {
         posEstimator.imu.accelBias.v[axis] = 0;
         posEstimator.est.pos.v[axis] = 0;
@@ -856,6 +972,10 @@ void initializePositionEstimator(void)
 
     pt1FilterInit(&posEstimator.baro.avgFilter, INAV_BARO_AVERAGE_HZ, 0.0f);
     pt1FilterInit(&posEstimator.surface.avgFilter, INAV_SURFACE_AVERAGE_HZ, 0.0f);
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+    estimationEkfReset();
+#endif
 }
 
 /**
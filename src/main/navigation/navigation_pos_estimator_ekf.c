@@ -0,0 +1,341 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Error-state Kalman filter alternative to the complementary corrections.
+ *
+ * The nominal position and velocity are still predicted from the earth frame
+ * acceleration by estimationPredict(). The filter tracks the errors of
+ * position, velocity and accelerometer bias on each NEU axis. With the
+ * attitude coming from the AHRS the axes are independent, so the covariance
+ * is three 3x3 blocks and each measurement is fused as a scalar update.
+ * The estimated errors are injected into the nominal state right away, the
+ * bias error into imu.accelBias in body frame.
+ *
+ * GPS samples are compared with the estimate from when they were taken,
+ * see estimationGetGpsSampleEstimate().
+ * Samples too far from the estimate for the current covariance are
+ * rejected instead of being handled by the GPS glitch heuristics.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+
+#include "build/build_config.h"
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+
+#include "drivers/time.h"
+
+#include "fc/runtime_config.h"
+
+#include "flight/imu.h"
+
+#include "navigation/navigation.h"
+#include "navigation/navigation_private.h"
+#include "navigation/navigation_pos_estimator_private.h"
+
+#include "sensors/acceleration.h"
+
+#define EKF_STATE_POS               0
+#define EKF_STATE_VEL               1
+#define EKF_STATE_ACC_BIAS          2
+#define EKF_AXIS_STATE_COUNT        3
+
+#define EKF_ACC_NOISE               50.0f       // Acceleration noise (cm/s/s)
+#define EKF_ACC_BIAS_NOISE          0.5f        // Accelerometer bias random walk (cm/s/s per sqrt(s))
+#define EKF_ACC_MIN_WEIGHT          0.1f        // Acc noise is scaled up to 1/EKF_ACC_MIN_WEIGHT while the acc is clipping
+#define EKF_MAX_VARIANCE            1.0e8f      // Limit of the variances while nothing is fused (cm^2), keeps the floats finite
+#define EKF_INITIAL_VEL_VARIANCE    sq(100.0f)  // Velocity variance after an axis reset ((cm/s)^2)
+#define EKF_INITIAL_BIAS_VARIANCE   sq(20.0f)   // Accelerometer bias variance on startup ((cm/s/s)^2)
+#define EKF_GPS_VEL_VARIANCE        sq(50.0f)   // GPS velocity noise ((cm/s)^2)
+#define EKF_INNOVATION_GATE         5.0f        // Measurements further than this many sigma away are rejected
+#define EKF_GPS_REJECT_TIMEOUT_MS   5000        // Reset to GPS after rejecting all samples for this long
+
+typedef struct {
+    float P[EKF_AXIS_STATE_COUNT][EKF_AXIS_STATE_COUNT];
+} ekfAxis_t;
+
+typedef struct {
+    ekfAxis_t           axis[XYZ_AXIS_COUNT];
+    timeUs_t            lastGpsFusedTime;
+    timeUs_t            lastBaroFusedTime;
+    timeUs_t            lastGpsAcceptedTime;
+    fpVector3_t         posCorr;
+    fpVector3_t         velCorr;
+    fpVector3_t         accBiasCorr;
+} ekfState_t;
+
+static ekfState_t ekf;
+
+static void ekfResetAxis(ekfAxis_t *axis, float posVariance, float velVariance)
+{
+    const float biasVariance = axis->P[EKF_STATE_ACC_BIAS][EKF_STATE_ACC_BIAS];
+
+    memset(axis->P, 0, sizeof(axis->P));
+    axis->P[EKF_STATE_POS][EKF_STATE_POS] = posVariance;
+    axis->P[EKF_STATE_VEL][EKF_STATE_VEL] = velVariance;
+    // What is known about the bias doesn't depend on the position
+    axis->P[EKF_STATE_ACC_BIAS][EKF_STATE_ACC_BIAS] = biasVariance;
+}
+
+void estimationEkfReset(void)
+{
+    memset(&ekf, 0, sizeof(ekf));
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        ekf.axis[i].P[EKF_STATE_ACC_BIAS][EKF_STATE_ACC_BIAS] = EKF_INITIAL_BIAS_VARIANCE;
+        ekfResetAxis(&ekf.axis[i], EKF_MAX_VARIANCE, EKF_MAX_VARIANCE);
+    }
+}
+
+/*
+ * P = F * P * F' + Q, with F = [1 dt 0; 0 1 -dt; 0 0 1] for the
+ * position, velocity and acc bias errors
+ */
+static void ekfPredictAxis(ekfAxis_t *axis, float dt, float accVariance)
+{
+    float (*P)[EKF_AXIS_STATE_COUNT] = axis->P;
+
+    // F * P
+    for (int j = 0; j < EKF_AXIS_STATE_COUNT; j++) {
+        P[EKF_STATE_POS][j] += dt * P[EKF_STATE_VEL][j];
+        P[EKF_STATE_VEL][j] -= dt * P[EKF_STATE_ACC_BIAS][j];
+    }
+    // (F * P) * F'
+    for (int i = 0; i < EKF_AXIS_STATE_COUNT; i++) {
+        P[i][EKF_STATE_POS] += dt * P[i][EKF_STATE_VEL];
+        P[i][EKF_STATE_VEL] -= dt * P[i][EKF_STATE_ACC_BIAS];
+    }
+
+    // Acceleration noise drives the velocity and through it the position
+    P[EKF_STATE_POS][EKF_STATE_POS] += accVariance * dt * dt * dt / 3.0f;
+    P[EKF_STATE_POS][EKF_STATE_VEL] += accVariance * dt * dt / 2.0f;
+    P[EKF_STATE_VEL][EKF_STATE_POS] += accVariance * dt * dt / 2.0f;
+    P[EKF_STATE_VEL][EKF_STATE_VEL] += accVariance * dt;
+    P[EKF_STATE_ACC_BIAS][EKF_STATE_ACC_BIAS] += sq(EKF_ACC_BIAS_NOISE) * dt;
+
+    for (int i = 0; i < EKF_AXIS_STATE_COUNT; i++) {
+        P[i][i] = MIN(P[i][i], EKF_MAX_VARIANCE);
+    }
+}
+
+/*
+ * Scalar update of a position (EKF_STATE_POS) or velocity (EKF_STATE_VEL)
+ * measurement. The error estimate is added to corr, which holds the position,
+ * velocity and acc bias corrections of the axis. Returns false if the
+ * measurement was rejected.
+ */
+static bool ekfFuse(ekfAxis_t *axis, int state, float innovation, float variance, float *corr)
+{
+    float (*P)[EKF_AXIS_STATE_COUNT] = axis->P;
+    const float S = P[state][state] + variance;
+
+    if (sq(innovation) > sq(EKF_INNOVATION_GATE) * S) {
+        return false;
+    }
+
+    float K[EKF_AXIS_STATE_COUNT];
+    float Ph[EKF_AXIS_STATE_COUNT];
+    for (int i = 0; i < EKF_AXIS_STATE_COUNT; i++) {
+        K[i] = P[i][state] / S;
+        Ph[i] = P[state][i];
+        corr[i] += K[i] * innovation;
+    }
+
+    // P = (I - K * H) * P
+    for (int i = 0; i < EKF_AXIS_STATE_COUNT; i++) {
+        for (int j = 0; j < EKF_AXIS_STATE_COUNT; j++) {
+            P[i][j] -= K[i] * Ph[j];
+        }
+    }
+
+    return true;
+}
+
+static void ekfAxisCorrection(int axis, float *corr)
+{
+    corr[EKF_STATE_POS] = ekf.posCorr.v[axis];
+    corr[EKF_STATE_VEL] = ekf.velCorr.v[axis];
+    corr[EKF_STATE_ACC_BIAS] = ekf.accBiasCorr.v[axis];
+}
+
+static void ekfSetAxisCorrection(int axis, const float *corr)
+{
+    ekf.posCorr.v[axis] = corr[EKF_STATE_POS];
+    ekf.velCorr.v[axis] = corr[EKF_STATE_VEL];
+    ekf.accBiasCorr.v[axis] = corr[EKF_STATE_ACC_BIAS];
+}
+
+static void ekfFuseState(int axis, int state, const navPositionEstimatorHistoryEntry_t *past, float measurement, float variance, bool *accepted)
+{
+    float corr[EKF_AXIS_STATE_COUNT];
+    ekfAxisCorrection(axis, corr);
+
+    // The corrections of this run apply to the past estimate as well
+    const float estimate = (state == EKF_STATE_POS) ?
+        past->pos.v[axis] + corr[EKF_STATE_POS] :
+        past->vel.v[axis] + corr[EKF_STATE_VEL];
+
+    if (ekfFuse(&ekf.axis[axis], state, measurement - estimate, variance, corr)) {
+        ekfSetAxisCorrection(axis, corr);
+    } else if (accepted) {
+        *accepted = false;
+    }
+}
+
+static void ekfResetAxisToGps(estimationContext_t *ctx, int axis, float posVariance)
+{
+    if (axis == Z) {
+        ctx->estPosCorr.z += posEstimator.gps.pos.z - posEstimator.est.pos.z;
+        ctx->estVelCorr.z += posEstimator.gps.vel.z - posEstimator.est.vel.z;
+    } else {
+        ctx->estPosCorr.v[axis] += posEstimator.gps.pos.v[axis] - posEstimator.est.pos.v[axis];
+        ctx->estVelCorr.v[axis] += posEstimator.gps.vel.v[axis] - posEstimator.est.vel.v[axis];
+    }
+    ekfResetAxis(&ekf.axis[axis], posVariance, EKF_INITIAL_VEL_VARIANCE);
+}
+
+void estimationEkfPredict(estimationContext_t *ctx)
+{
+    const float accWeight = MAX(posEstimator.imu.accWeightFactor, EKF_ACC_MIN_WEIGHT);
+    const float accVariance = sq(EKF_ACC_NOISE / accWeight);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        ekfPredictAxis(&ekf.axis[axis], ctx->dt, accVariance);
+    }
+
+    vectorZero(&ekf.posCorr);
+    vectorZero(&ekf.velCorr);
+    vectorZero(&ekf.accBiasCorr);
+}
+
+bool estimationEkfCorrect_Z(estimationContext_t *ctx)
+{
+    if (ctx->newFlags & EST_BARO_VALID) {
+        const bool isAirCushionEffectDetected = estimationDetectAirCushion(ctx);
+
+        if (posEstimator.baro.lastUpdateTime != ekf.lastBaroFusedTime) {
+            ekf.lastBaroFusedTime = posEstimator.baro.lastUpdateTime;
+
+            const float baroAlt = isAirCushionEffectDetected ? posEstimator.state.baroGroundAlt : posEstimator.baro.alt;
+            const navPositionEstimatorHistoryEntry_t current = { .pos = posEstimator.est.pos, .vel = posEstimator.est.vel };
+            ekfFuseState(Z, EKF_STATE_POS, &current, baroAlt, sq(posEstimator.baro.epv), NULL);
+        }
+
+        if ((ctx->newFlags & EST_GPS_Z_VALID) && posEstimator.gps.lastUpdateTime != ekf.lastGpsFusedTime) {
+            ekfFuseState(Z, EKF_STATE_VEL, estimationGetGpsSampleEstimate(), posEstimator.gps.vel.z, EKF_GPS_VEL_VARIANCE, NULL);
+        }
+
+        // A ground effect pushing the baro reading down doesn't say anything about the acc bias
+        if (isAirCushionEffectDetected) {
+            ekf.accBiasCorr.z = 0;
+        }
+
+        ctx->newEPV = sqrtf(ekf.axis[Z].P[EKF_STATE_POS][EKF_STATE_POS]);
+        return true;
+    }
+    else if ((STATE(FIXED_WING_LEGACY) || positionEstimationConfig()->use_gps_no_baro) && (ctx->newFlags & EST_GPS_Z_VALID)) {
+        if (!(ctx->newFlags & EST_Z_VALID)) {
+            ekfResetAxisToGps(ctx, Z, sq(posEstimator.gps.epv));
+        }
+        else if (posEstimator.gps.lastUpdateTime != ekf.lastGpsFusedTime) {
+            const navPositionEstimatorHistoryEntry_t *past = estimationGetGpsSampleEstimate();
+            ekfFuseState(Z, EKF_STATE_POS, past, posEstimator.gps.pos.z, sq(posEstimator.gps.epv), NULL);
+            ekfFuseState(Z, EKF_STATE_VEL, past, posEstimator.gps.vel.z, EKF_GPS_VEL_VARIANCE, NULL);
+        }
+
+        ctx->newEPV = sqrtf(ekf.axis[Z].P[EKF_STATE_POS][EKF_STATE_POS]);
+        return true;
+    }
+
+    return false;
+}
+
+bool estimationEkfCorrect_XY(estimationContext_t *ctx, timeUs_t currentTimeUs)
+{
+    if (!(ctx->newFlags & EST_GPS_XY_VALID)) {
+        return false;
+    }
+
+    if (!(ctx->newFlags & EST_XY_VALID)) {
+        ekfResetAxisToGps(ctx, X, sq(posEstimator.gps.eph));
+        ekfResetAxisToGps(ctx, Y, sq(posEstimator.gps.eph));
+        ekf.lastGpsAcceptedTime = currentTimeUs;
+    }
+    else if (posEstimator.gps.lastUpdateTime != ekf.lastGpsFusedTime) {
+        const navPositionEstimatorHistoryEntry_t *past = estimationGetGpsSampleEstimate();
+        bool accepted = true;
+        for (int axis = X; axis <= Y; axis++) {
+            ekfFuseState(axis, EKF_STATE_POS, past, posEstimator.gps.pos.v[axis], sq(posEstimator.gps.eph), &accepted);
+            if (positionEstimationConfig()->use_gps_velned) {
+                ekfFuseState(axis, EKF_STATE_VEL, past, posEstimator.gps.vel.v[axis], EKF_GPS_VEL_VARIANCE, &accepted);
+            }
+        }
+
+        if (accepted) {
+            ekf.lastGpsAcceptedTime = currentTimeUs;
+        }
+        else if (cmpTimeUs(currentTimeUs, ekf.lastGpsAcceptedTime) > MS2US(EKF_GPS_REJECT_TIMEOUT_MS)) {
+            // The estimate drifted away for good, start over from GPS
+            ekfResetAxisToGps(ctx, X, sq(posEstimator.gps.eph));
+            ekfResetAxisToGps(ctx, Y, sq(posEstimator.gps.eph));
+            ekf.lastGpsAcceptedTime = currentTimeUs;
+        }
+    }
+
+    ctx->newEPH = sqrtf(MAX(ekf.axis[X].P[EKF_STATE_POS][EKF_STATE_POS], ekf.axis[Y].P[EKF_STATE_POS][EKF_STATE_POS]));
+    return true;
+}
+
+/*
+ * Moves the estimated errors into the context corrections and the
+ * accelerometer bias, called after all measurements of the run were fused
+ */
+void estimationEkfApply(estimationContext_t *ctx)
+{
+    ekf.lastGpsFusedTime = posEstimator.gps.lastUpdateTime;
+
+    vectorAdd(&ctx->estPosCorr, &ctx->estPosCorr, &ekf.posCorr);
+    vectorAdd(&ctx->estVelCorr, &ctx->estVelCorr, &ekf.velCorr);
+
+    if (positionEstimationConfig()->w_acc_bias > 0.0f) {
+        fpVector3_t accBiasCorr = ekf.accBiasCorr;
+        const float accelBiasCorrMagnitudeSq = sq(accBiasCorr.x) + sq(accBiasCorr.y) + sq(accBiasCorr.z);
+        if (accelBiasCorrMagnitudeSq < sq(INAV_ACC_BIAS_ACCEPTANCE_VALUE)) {
+            /* transform error vector from NEU frame to body frame */
+            imuTransformVectorEarthToBody(&accBiasCorr);
+            vectorAdd(&posEstimator.imu.accelBias, &posEstimator.imu.accelBias, &accBiasCorr);
+        }
+    }
+}
+
+#endif
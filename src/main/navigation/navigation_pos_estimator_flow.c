@@ -50,8 +50,12 @@ extern navigationPosEstimator_t posEstimator;
  */
 void updatePositionEstimator_OpticalFlowTopic(timeUs_t currentTimeUs)
 {
+    sensorSampleConsume(&opflow.sample, currentTimeUs);
+
     posEstimator.flow.lastUpdateTime = currentTimeUs;
     posEstimator.flow.isValid = opflow.isHwHealty && (opflow.flowQuality == OPFLOW_QUALITY_VALID);
+    // Normalized surface quality, 1.0 for anything well above the acquisition threshold
+    posEstimator.flow.quality = scaleRangef(constrain(opflow.rawQuality, OPFLOW_SQUAL_THRESHOLD_LOW, OPFLOW_SQUAL_THRESHOLD_GOOD), OPFLOW_SQUAL_THRESHOLD_LOW, OPFLOW_SQUAL_THRESHOLD_GOOD, 0.0f, 1.0f);
     posEstimator.flow.flowRate[X] = opflow.flowRate[X];
     posEstimator.flow.flowRate[Y] = opflow.flowRate[Y];
     posEstimator.flow.bodyRate[X] = opflow.bodyRate[X];
@@ -88,8 +92,11 @@ bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx)
     const float flowVelXInnov = flowVel.x - posEstimator.est.vel.x;
     const float flowVelYInnov = flowVel.y - posEstimator.est.vel.y;
 
-    ctx->estVelCorr.x = flowVelXInnov * positionEstimationConfig()->w_xy_flow_v * ctx->dt;
-    ctx->estVelCorr.y = flowVelYInnov * positionEstimationConfig()->w_xy_flow_v * ctx->dt;
+    // Velocity noise variance is roughly inverse to the square of surface quality, weight the correction accordingly
+    const float flowVelWeight = positionEstimationConfig()->w_xy_flow_v * sq(posEstimator.flow.quality);
+
+    ctx->estVelCorr.x = flowVelXInnov * flowVelWeight * ctx->dt;
+    ctx->estVelCorr.y = flowVelYInnov * flowVelWeight * ctx->dt;
 
     // Calculate position correction if possible/allowed
     if ((ctx->newFlags & EST_GPS_XY_VALID)) {
@@ -53,6 +53,9 @@
 
 #define INAV_ACC_CLIPPING_RC_CONSTANT           (0.010f)    // Reduce acc weight for ~10ms after clipping
 
+#define INAV_HISTORY_SIZE                   32      // Estimate history used to compensate the GPS delay
+#define INAV_HISTORY_INTERVAL_US            10000   // 320ms of history, more than the max inav_gps_delay
+
 #define RANGEFINDER_RELIABILITY_RC_CONSTANT     (0.47802f)
 #define RANGEFINDER_RELIABILITY_LIGHT_THRESHOLD (0.15f)
 #define RANGEFINDER_RELIABILITY_LOW_THRESHOLD   (0.33f)
@@ -153,6 +156,18 @@ typedef struct {
 } navPositionEstimatorSTATE_t;
 
 
+typedef struct {
+    timeUs_t    time;
+    fpVector3_t pos;
+    fpVector3_t vel;
+} navPositionEstimatorHistoryEntry_t;
+
+typedef struct {
+    navPositionEstimatorHistoryEntry_t entry[INAV_HISTORY_SIZE];
+    uint8_t     head;
+    uint8_t     count;
+} navPositionEstimatorHISTORY_t;
+
 typedef struct {
     uint32_t                    flags;
 
@@ -171,6 +186,9 @@ typedef struct {
 
     // Extra state variables
     navPositionEstimatorSTATE_t state;
+
+    // Past estimates
+    navPositionEstimatorHISTORY_t history;
 } navigationPosEstimator_t;
 
 typedef struct {
@@ -189,4 +207,14 @@ extern float updateEPE(const float oldEPE, const float dt, const float newEPE, c
 extern void estimationCalculateAGL(estimationContext_t * ctx);
 extern bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx);
 extern float navGetAccelerometerWeight(void);
+extern bool estimationDetectAirCushion(estimationContext_t * ctx);
+extern const navPositionEstimatorHistoryEntry_t * estimationGetGpsSampleEstimate(void);
+
+#if defined(USE_POS_ESTIMATOR_EKF)
+extern void estimationEkfReset(void);
+extern void estimationEkfPredict(estimationContext_t * ctx);
+extern bool estimationEkfCorrect_Z(estimationContext_t * ctx);
+extern bool estimationEkfCorrect_XY(estimationContext_t * ctx, timeUs_t currentTimeUs);
+extern void estimationEkfApply(estimationContext_t * ctx);
+#endif
 
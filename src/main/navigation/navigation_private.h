@@ -44,8 +44,14 @@
 #define MC_LAND_THR_STABILISE_DELAY         1       // seconds
 #define MC_LAND_DESCEND_THROTTLE            40      // uS
 #define MC_LAND_SAFE_SURFACE                5.0f    // cm
+#define MC_LAND_FUSION_WINDOW               0.25f   // seconds, time constant of the landing detector statistics
+#define MC_LAND_FUSION_CONFIRM_TIME         500     // ms
+#define MC_LAND_FUSION_THRUST_RATIO         0.6f    // Motor output above idle, relative to hover
+#define MC_LAND_FUSION_ACC_STD              100.0f  // cm/s/s
+#define MC_LAND_FUSION_GYRO_STD             5.0f    // dps
 
-#define NAV_RTH_TRACKBACK_POINTS            50      // max number RTH trackback points
+#define NAV_RTH_TRACKBACK_POINTS            100     // max number RTH trackback points
+#define NAV_RTH_TRACKBACK_POINT_UNIT        100     // cm per unit of trackback point offsets
 
 #define MAX_POSITION_UPDATE_INTERVAL_US     HZ2US(MIN_POSITION_UPDATE_RATE_HZ)        // convenience macro
 _Static_assert(MAX_POSITION_UPDATE_INTERVAL_US <= TIMEDELTA_MAX, "deltaMicros can overflow!");
@@ -85,6 +91,8 @@ typedef struct navigationFlags_s {
     bool horizontalPositionDataConsumed;
     bool verticalPositionDataConsumed;
 
+    bool estimateUpdated;                           // Estimator published since the last nav-rate housekeeping pass
+
     navigationEstimateStatus_e estAltStatus;        // Indicates that we have a working altitude sensor (got at least one valid reading from it)
     navigationEstimateStatus_e estPosStatus;        // Indicates that GPS is working (or not)
     navigationEstimateStatus_e estVelStatus;        // Indicates that GPS is working (or not)
@@ -346,6 +354,12 @@ typedef enum {
     RTH_HOME_FINAL_LAND,            // Home position and altitude
 } rthTargetMode_e;
 
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} navRthTrackbackOffset_t;          // NAV_RTH_TRACKBACK_POINT_UNIT
+
 typedef struct {
     /* Flags and navigation system state */
     navigationFSMState_t        navState;
@@ -395,6 +409,12 @@ typedef struct {
     int8_t                      loadedMultiMissionIndex;    // index of selected multi mission
     int8_t                      loadedMultiMissionStartWP;  // selected multi mission start WP
     int8_t                      loadedMultiMissionWPCount;  // number of WPs in selected multi mission
+#endif
+#ifdef USE_MISSION_STORE
+    /* Mission store */
+    bool                        missionStoreActive;         // waypointList is a window into the mission store
+    uint16_t                    missionStoreWindowStart;    // mission store index of waypointList[0]
+    uint16_t                    missionStoreWaypointCount;  // number of WPs in the stored mission
 #endif
     navWaypointPosition_t       activeWaypoint;             // Local position, current bearing and turn angle to next WP, filled on waypoint activation
     int8_t                      activeWaypointIndex;
@@ -405,10 +425,12 @@ typedef struct {
     bool                        wpAltitudeReached;          // WP altitude achieved
 
     /* RTH Trackback */
-    fpVector3_t                 rthTBPointsList[NAV_RTH_TRACKBACK_POINTS];
-    int8_t                      rthTBLastSavedIndex;        // last trackback point index saved
+    fpVector3_t                 rthTBFirstPoint;            // oldest trackback point
+    fpVector3_t                 rthTBLastPoint;             // newest trackback point
+    fpVector3_t                 rthTBActivePoint;           // trackback point at activeRthTBPointIndex
+    navRthTrackbackOffset_t     rthTBPointOffsets[NAV_RTH_TRACKBACK_POINTS];   // offset of each point from the previous one, [0] unused
+    int8_t                      rthTBPointCount;
     int8_t                      activeRthTBPointIndex;
-    int8_t                      rthTBWrapAroundCounter;     // stores trackpoint array overwrite index position
 
     /* Internals & statistics */
     int16_t                     rcAdjustment[4];
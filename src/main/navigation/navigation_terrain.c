@@ -0,0 +1,420 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Terrain elevation of the mission area, kept in a partition of the
+ * external flash as square tiles of TERRAIN_TILE_SAMPLES^2 samples.
+ *
+ * The ground station cuts the tiles from SRTM style elevation data and
+ * quantizes each one to a byte per sample above the lowest point of the
+ * tile, which halves the size of the 16 bit source data. The first sector
+ * holds the store header followed by the tile headers, the samples of each
+ * tile follow in the next sectors. A tile header is programmed only once
+ * all the samples of the tile are in flash, so an interrupted upload
+ * leaves the tiles which were complete.
+ *
+ * Tiles are read into a small LRU cache as navigation needs them.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_TERRAIN)
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/flash.h"
+#include "drivers/time.h"
+
+#include "fc/runtime_config.h"
+
+#include "navigation/navigation.h"
+#include "navigation/navigation_private.h"
+
+#define TERRAIN_STORE_MAGIC         0x314E5254  // "TRN1"
+#define TERRAIN_TILE_DATA_SIZE      (TERRAIN_TILE_SAMPLES * TERRAIN_TILE_SAMPLES)
+#define TERRAIN_PAGE_SIZE           256
+#define TERRAIN_SAMPLE_VOID         0xFF        // No elevation data for the sample
+#define TERRAIN_CACHE_TILES         4
+#define TERRAIN_LOOKAHEAD_SAMPLES   8
+
+STATIC_ASSERT(sizeof(terrainTileHeader_t) == 16, terrainTileHeaderSize);
+STATIC_ASSERT((TERRAIN_TILE_DATA_SIZE % TERRAIN_PAGE_SIZE) == 0, terrainTileNotPageAligned);
+
+typedef struct {
+    uint32_t magic;
+    uint16_t tileSamples;
+    uint16_t reserved[5];
+} terrainStoreHeader_t;
+
+typedef struct {
+    int16_t  tileIndex;                 // -1 for an empty entry
+    timeMs_t lastUsed;
+    uint8_t  samples[TERRAIN_TILE_DATA_SIZE];
+} terrainCacheEntry_t;
+
+typedef struct {
+    uint32_t startAddress;
+    uint32_t sectorSize;
+    uint16_t capacity;
+    uint16_t count;
+    terrainTileHeader_t tiles[TERRAIN_MAX_TILES];
+
+    /* Upload in progress */
+    bool     uploading;
+    uint16_t nextOffset;
+    uint8_t  pageBuffer[TERRAIN_PAGE_SIZE];
+
+    /* Lookups */
+    int16_t  lastTileIndex;
+    terrainCacheEntry_t cache[TERRAIN_CACHE_TILES];
+
+    /* Highest terrain ahead, evaluated a sample per update */
+    uint8_t  lookaheadSample;
+    bool     lookaheadValid;
+    int32_t  lookaheadMax;
+    int32_t  pathMax;
+    bool     pathMaxValid;
+} terrainStore_t;
+
+static terrainStore_t terrainStore;
+
+static uint32_t terrainHeaderAddress(uint16_t tile)
+{
+    return terrainStore.startAddress + (tile + 1) * sizeof(terrainTileHeader_t);
+}
+
+static uint32_t terrainTileDataAddress(uint16_t tile)
+{
+    return terrainStore.startAddress + terrainStore.sectorSize + tile * TERRAIN_TILE_DATA_SIZE;
+}
+
+static void terrainResetCache(void)
+{
+    for (int i = 0; i < TERRAIN_CACHE_TILES; i++) {
+        terrainStore.cache[i].tileIndex = -1;
+    }
+    terrainStore.lastTileIndex = -1;
+    terrainStore.lookaheadSample = 0;
+    terrainStore.lookaheadValid = false;
+    terrainStore.pathMaxValid = false;
+}
+
+bool terrainInit(void)
+{
+    const flashPartition_t *partition = flashPartitionFindByType(FLASH_PARTITION_TYPE_TERRAIN);
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    memset(&terrainStore, 0, sizeof(terrainStore));
+    terrainResetCache();
+
+    // Same restrictions as the mission store, a page is buffered and programmed once
+    if (!partition || geometry->flashType != FLASH_TYPE_NOR || geometry->pageSize != TERRAIN_PAGE_SIZE) {
+        return false;
+    }
+
+    const uint32_t partitionSize = FLASH_PARTITION_SECTOR_COUNT(partition) * geometry->sectorSize;
+    if (partitionSize <= geometry->sectorSize) {
+        return false;
+    }
+
+    const uint32_t headerCapacity = geometry->sectorSize / sizeof(terrainTileHeader_t) - 1;
+    const uint32_t dataCapacity = (partitionSize - geometry->sectorSize) / TERRAIN_TILE_DATA_SIZE;
+
+    terrainStore.startAddress = partition->startSector * geometry->sectorSize;
+    terrainStore.sectorSize = geometry->sectorSize;
+    terrainStore.capacity = MIN(MIN(headerCapacity, dataCapacity), (uint32_t)TERRAIN_MAX_TILES);
+
+    terrainStoreHeader_t header;
+    if (flashReadBytes(terrainStore.startAddress, (uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != TERRAIN_STORE_MAGIC || header.tileSamples != TERRAIN_TILE_SAMPLES) {
+        return true;
+    }
+
+    // Tiles are valid up to the first header which was never programmed
+    while (terrainStore.count < terrainStore.capacity) {
+        terrainTileHeader_t *tile = &terrainStore.tiles[terrainStore.count];
+
+        if (flashReadBytes(terrainHeaderAddress(terrainStore.count), (uint8_t *)tile, sizeof(*tile)) != sizeof(*tile) || tile->spacing == 0xFFFF || tile->spacing == 0) {
+            break;
+        }
+
+        terrainStore.count++;
+    }
+
+    return true;
+}
+
+void terrainStoreGetInfo(terrainStoreInfo_t *info)
+{
+    info->capacity = terrainStore.capacity;
+    info->count = terrainStore.count;
+}
+
+bool terrainStoreBeginUpload(void)
+{
+    if (!terrainStore.capacity || ARMING_FLAG(ARMED)) {
+        return false;
+    }
+
+    flashEraseSector(terrainStore.startAddress);
+
+    const terrainStoreHeader_t header = {
+        .magic = TERRAIN_STORE_MAGIC,
+        .tileSamples = TERRAIN_TILE_SAMPLES,
+    };
+
+    terrainStore.count = 0;
+    terrainResetCache();
+
+    if (flashPageProgram(terrainStore.startAddress, (const uint8_t *)&header, sizeof(header)) == terrainStore.startAddress) {
+        terrainStore.uploading = false;
+        return false;
+    }
+
+    terrainStore.uploading = true;
+    terrainStore.nextOffset = 0;
+    memset(terrainStore.pageBuffer, 0xFF, sizeof(terrainStore.pageBuffer));
+
+    return true;
+}
+
+bool terrainStoreWriteTileData(uint16_t index, uint16_t offset, const uint8_t *data, uint16_t length)
+{
+    // Tiles and their samples have to come in order, they are programmed a page at a time
+    if (!terrainStore.uploading || index != terrainStore.count || index >= terrainStore.capacity ||
+        offset != terrainStore.nextOffset || offset + length > TERRAIN_TILE_DATA_SIZE) {
+        return false;
+    }
+
+    while (length) {
+        const uint16_t pageOffset = terrainStore.nextOffset % TERRAIN_PAGE_SIZE;
+        const uint16_t chunk = MIN(length, TERRAIN_PAGE_SIZE - pageOffset);
+
+        memcpy(&terrainStore.pageBuffer[pageOffset], data, chunk);
+        terrainStore.nextOffset += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (pageOffset + chunk == TERRAIN_PAGE_SIZE) {
+            const uint32_t address = terrainTileDataAddress(index) + terrainStore.nextOffset - TERRAIN_PAGE_SIZE;
+
+            if ((address % terrainStore.sectorSize) == 0) {
+                flashEraseSector(address);
+            }
+
+            if (flashPageProgram(address, terrainStore.pageBuffer, TERRAIN_PAGE_SIZE) == address) {
+                terrainStore.uploading = false;
+                return false;
+            }
+
+            memset(terrainStore.pageBuffer, 0xFF, sizeof(terrainStore.pageBuffer));
+        }
+    }
+
+    return true;
+}
+
+bool terrainStoreFinishTile(uint16_t index, const terrainTileHeader_t *header)
+{
+    if (!terrainStore.uploading || index != terrainStore.count || terrainStore.nextOffset != TERRAIN_TILE_DATA_SIZE ||
+        header->spacing == 0 || header->spacing == 0xFFFF) {
+        return false;
+    }
+
+    const uint32_t address = terrainHeaderAddress(index);
+    if (flashPageProgram(address, (const uint8_t *)header, sizeof(*header)) == address) {
+        terrainStore.uploading = false;
+        return false;
+    }
+
+    terrainStore.tiles[index] = *header;
+    terrainStore.count++;
+    terrainStore.nextOffset = 0;
+
+    return true;
+}
+
+static int64_t terrainLonOffset(const terrainTileHeader_t *tile, int32_t lon)
+{
+    // Longitudes wrap at the antimeridian, a tile may cross it
+    const int64_t deltaLon = (int64_t)lon - tile->lon;
+    return deltaLon < 0 ? deltaLon + 3600000000LL : deltaLon;
+}
+
+static bool terrainTileContains(const terrainTileHeader_t *tile, int32_t lat, int32_t lon)
+{
+    const int32_t extent = tile->spacing * (TERRAIN_TILE_SAMPLES - 1);
+
+    return lat >= tile->lat && lat < tile->lat + extent && terrainLonOffset(tile, lon) < extent;
+}
+
+static int terrainFindTile(int32_t lat, int32_t lon)
+{
+    // Consecutive lookups are mostly made on the same tile
+    if (terrainStore.lastTileIndex >= 0 && terrainTileContains(&terrainStore.tiles[terrainStore.lastTileIndex], lat, lon)) {
+        return terrainStore.lastTileIndex;
+    }
+
+    for (int i = 0; i < terrainStore.count; i++) {
+        if (terrainTileContains(&terrainStore.tiles[i], lat, lon)) {
+            terrainStore.lastTileIndex = i;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static const uint8_t *terrainLoadTile(int tileIndex)
+{
+    terrainCacheEntry_t *victim = &terrainStore.cache[0];
+
+    for (int i = 0; i < TERRAIN_CACHE_TILES; i++) {
+        terrainCacheEntry_t *entry = &terrainStore.cache[i];
+
+        if (entry->tileIndex == tileIndex) {
+            entry->lastUsed = millis();
+            return entry->samples;
+        }
+
+        if (entry->tileIndex < 0 || (victim->tileIndex >= 0 && entry->lastUsed < victim->lastUsed)) {
+            victim = entry;
+        }
+    }
+
+    // Waits for a pending blackbox write to the flash, fails on timeout
+    if (flashReadBytes(terrainTileDataAddress(tileIndex), victim->samples, TERRAIN_TILE_DATA_SIZE) != TERRAIN_TILE_DATA_SIZE) {
+        victim->tileIndex = -1;
+        return NULL;
+    }
+
+    victim->tileIndex = tileIndex;
+    victim->lastUsed = millis();
+
+    return victim->samples;
+}
+
+bool terrainGetHeight(int32_t lat, int32_t lon, int32_t *heightCm)
+{
+    // Tiles below count are complete, even while an upload is in progress
+    const int tileIndex = terrainFindTile(lat, lon);
+    if (tileIndex < 0) {
+        return false;
+    }
+
+    const uint8_t *samples = terrainLoadTile(tileIndex);
+    if (!samples) {
+        return false;
+    }
+
+    const terrainTileHeader_t *tile = &terrainStore.tiles[tileIndex];
+
+    // Rows go north, columns go east from the south west corner
+    const float row = (float)(lat - tile->lat) / tile->spacing;
+    const float col = (float)terrainLonOffset(tile, lon) / tile->spacing;
+    const int r = constrain((int)row, 0, TERRAIN_TILE_SAMPLES - 2);
+    const int c = constrain((int)col, 0, TERRAIN_TILE_SAMPLES - 2);
+    const float fr = constrainf(row - r, 0.0f, 1.0f);
+    const float fc = constrainf(col - c, 0.0f, 1.0f);
+
+    const uint8_t s00 = samples[r * TERRAIN_TILE_SAMPLES + c];
+    const uint8_t s01 = samples[r * TERRAIN_TILE_SAMPLES + c + 1];
+    const uint8_t s10 = samples[(r + 1) * TERRAIN_TILE_SAMPLES + c];
+    const uint8_t s11 = samples[(r + 1) * TERRAIN_TILE_SAMPLES + c + 1];
+
+    if (s00 == TERRAIN_SAMPLE_VOID || s01 == TERRAIN_SAMPLE_VOID || s10 == TERRAIN_SAMPLE_VOID || s11 == TERRAIN_SAMPLE_VOID) {
+        return false;
+    }
+
+    // Bilinear interpolation between the four surrounding samples
+    const float sample = (s00 * (1.0f - fc) + s01 * fc) * (1.0f - fr) + (s10 * (1.0f - fc) + s11 * fc) * fr;
+
+    *heightCm = tile->baseHeight * 100 + lrintf(sample * tile->step * 10);
+
+    return true;
+}
+
+static bool terrainGetLocalHeight(const fpVector3_t *pos, int32_t *altitude)
+{
+    gpsLocation_t llh;
+    int32_t heightCm;
+
+    if (!geoConvertLocalToGeodetic(&llh, &posControl.gpsOrigin, pos) || !terrainGetHeight(llh.lat, llh.lon, &heightCm)) {
+        return false;
+    }
+
+    // Terrain heights are above mean sea level, local positions are relative to the GPS origin
+    *altitude = heightCm - posControl.gpsOrigin.alt;
+
+    return true;
+}
+
+bool terrainGetAltitudeAlongPath(const fpVector3_t *pos, const fpVector3_t *destination, uint16_t lookahead, float *altitude)
+{
+    int32_t below;
+
+    if (!terrainGetLocalHeight(pos, &below)) {
+        terrainStore.lookaheadSample = 0;
+        terrainStore.lookaheadValid = false;
+        terrainStore.pathMaxValid = false;
+        return false;
+    }
+
+    // A single point ahead is looked up per update so at most one more tile is read from flash
+    const float dx = destination->x - pos->x;
+    const float dy = destination->y - pos->y;
+    const float distance = calc_length_pythagorean_2D(dx, dy);
+    const float range = MIN(distance, lookahead * 100.0f);
+    const float ratio = distance > 1.0f ? range / distance * (terrainStore.lookaheadSample + 1) / TERRAIN_LOOKAHEAD_SAMPLES : 0.0f;
+
+    const fpVector3_t ahead = {
+        .x = pos->x + dx * ratio,
+        .y = pos->y + dy * ratio,
+        .z = pos->z,
+    };
+
+    int32_t height;
+    if (terrainGetLocalHeight(&ahead, &height)) {
+        terrainStore.lookaheadMax = terrainStore.lookaheadValid ? MAX(terrainStore.lookaheadMax, height) : height;
+        terrainStore.lookaheadValid = true;
+    }
+
+    if (++terrainStore.lookaheadSample >= TERRAIN_LOOKAHEAD_SAMPLES) {
+        terrainStore.pathMax = terrainStore.lookaheadMax;
+        terrainStore.pathMaxValid = terrainStore.lookaheadValid;
+        terrainStore.lookaheadSample = 0;
+        terrainStore.lookaheadValid = false;
+    }
+
+    *altitude = terrainStore.pathMaxValid ? MAX(below, terrainStore.pathMax) : below;
+
+    return true;
+}
+
+#endif // defined(USE_TERRAIN)
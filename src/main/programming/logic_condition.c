@@ -85,6 +85,13 @@ void pgResetFn_logicConditions(logicCondition_t *instance)
 
 logicConditionState_t logicConditionStates[MAX_LOGIC_CONDITIONS];
 
+// Enabled conditions in evaluation order, rebuilt when the conditions change.
+// Conditions flagged as fast come last, from logicConditionProgramFastStart.
+static EXTENDED_FASTRAM uint8_t logicConditionProgram[MAX_LOGIC_CONDITIONS];
+static EXTENDED_FASTRAM uint8_t logicConditionProgramLength;
+static EXTENDED_FASTRAM uint8_t logicConditionProgramFastStart;
+static EXTENDED_FASTRAM bool logicConditionProgramValid;
+
 static int logicConditionCompute(
     int32_t currentVaue,
     logicOperation_e operation,
@@ -350,9 +357,7 @@ static int logicConditionCompute(
             if ( getConfigProfile() != operandA  && (operandA >= 0 && operandA < MAX_PROFILE_COUNT)) {
                 bool profileChanged = false;
                 if (setConfigProfile(operandA)) {
-                    pidInit();
-                    pidInitFilters();
-                    schedulePidGainsUpdate();
+                    pidActivateProfile();
                     profileChanged = true;
                 }
                 return profileChanged;
@@ -743,6 +748,80 @@ int logicConditionGetOperandValue(logicOperandType_e type, int operand) {
     return retVal;
 }
 
+static int logicOperandGetRcChannel(int channel)
+{
+    return rxGetChannelValue(channel);
+}
+
+static int logicOperandGetLogicCondition(int conditionId)
+{
+    return logicConditionStates[conditionId].value;
+}
+
+static int logicOperandGetGlobalVariable(int index)
+{
+    return gvGet(index);
+}
+
+static int logicOperandGetPid(int index)
+{
+    return programmingPidGetOutput(index);
+}
+
+// Same results as logicConditionGetOperandValue(), out of range operands resolve to a constant 0
+void logicConditionResolveOperand(const logicOperand_t *operand, logicOperandAccessor_t *accessor)
+{
+    accessor->get = NULL;
+    accessor->operand = 0;
+
+    switch (operand->type) {
+        case LOGIC_CONDITION_OPERAND_TYPE_VALUE:
+            accessor->operand = operand->value;
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_RC_CHANNEL:
+            if (operand->value >= 1 && operand->value <= 16) {
+                accessor->get = logicOperandGetRcChannel;
+                accessor->operand = operand->value - 1;
+            }
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_FLIGHT:
+            accessor->get = logicConditionGetFlightOperandValue;
+            accessor->operand = operand->value;
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_FLIGHT_MODE:
+            accessor->get = logicConditionGetFlightModeOperandValue;
+            accessor->operand = operand->value;
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_LC:
+            if (operand->value >= 0 && operand->value < MAX_LOGIC_CONDITIONS) {
+                accessor->get = logicOperandGetLogicCondition;
+                accessor->operand = operand->value;
+            }
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_GVAR:
+            if (operand->value >= 0 && operand->value < MAX_GLOBAL_VARIABLES) {
+                accessor->get = logicOperandGetGlobalVariable;
+                accessor->operand = operand->value;
+            }
+            break;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_PID:
+            if (operand->value >= 0 && operand->value < MAX_PROGRAMMING_PID_COUNT) {
+                accessor->get = logicOperandGetPid;
+                accessor->operand = operand->value;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
 /*
  * conditionId == -1 is always evaluated as true
  */ 
@@ -754,6 +833,86 @@ int logicConditionGetValue(int8_t conditionId) {
     }
 }
 
+/*
+ * A condition is ready to be placed in the program once the condition it
+ * depends on has been placed. Disabled conditions are always false and
+ * conditions referencing themselves read their own value from the previous
+ * run, so neither needs to be waited for.
+ */
+static bool logicConditionDependencyReady(uint8_t i, int dependency, const bool *placed)
+{
+    return dependency < 0 || dependency >= MAX_LOGIC_CONDITIONS || dependency == i ||
+        !logicConditions(dependency)->enabled || placed[dependency];
+}
+
+static int logicConditionOperandDependency(const logicOperand_t *operand)
+{
+    return operand->type == LOGIC_CONDITION_OPERAND_TYPE_LC ? operand->value : -1;
+}
+
+/*
+ * Orders the enabled conditions so each one runs after the conditions used
+ * as its activator or operands, letting chains settle within a single run.
+ * Conditions in a dependency loop keep their index order and see the
+ * previous run's values for the part of the loop that comes later.
+ */
+static void logicConditionCompile(void)
+{
+    uint8_t order[MAX_LOGIC_CONDITIONS];
+    uint8_t orderLength = 0;
+    bool placed[MAX_LOGIC_CONDITIONS] = { false };
+    bool progress;
+
+    do {
+        progress = false;
+        for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+            const logicCondition_t *condition = logicConditions(i);
+            if (!condition->enabled || placed[i]) {
+                continue;
+            }
+            if (logicConditionDependencyReady(i, condition->activatorId, placed) &&
+                logicConditionDependencyReady(i, logicConditionOperandDependency(&condition->operandA), placed) &&
+                logicConditionDependencyReady(i, logicConditionOperandDependency(&condition->operandB), placed)) {
+
+                order[orderLength++] = i;
+                placed[i] = true;
+                progress = true;
+            }
+        }
+    } while (progress);
+
+    for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+        if (!logicConditions(i)->enabled) {
+            // Disabled conditions are skipped, so they need to be cleared once here
+            logicConditionStates[i].value = false;
+        } else if (!placed[i]) {
+            order[orderLength++] = i;
+        }
+    }
+
+    // Split the program keeping the order within each part. Fast conditions
+    // depending on slow ones read the value from the last slow run.
+    logicConditionProgramLength = 0;
+    for (uint8_t i = 0; i < orderLength; i++) {
+        if (!(logicConditions(order[i])->flags & LOGIC_CONDITION_FLAG_FAST)) {
+            logicConditionProgram[logicConditionProgramLength++] = order[i];
+        }
+    }
+    logicConditionProgramFastStart = logicConditionProgramLength;
+    for (uint8_t i = 0; i < orderLength; i++) {
+        if (logicConditions(order[i])->flags & LOGIC_CONDITION_FLAG_FAST) {
+            logicConditionProgram[logicConditionProgramLength++] = order[i];
+        }
+    }
+
+    logicConditionProgramValid = true;
+}
+
+void logicConditionInvalidateProgram(void)
+{
+    logicConditionProgramValid = false;
+}
+
 void logicConditionUpdateTask(timeUs_t currentTimeUs) {
     UNUSED(currentTimeUs);
 
@@ -769,8 +928,14 @@ void logicConditionUpdateTask(timeUs_t currentTimeUs) {
         flightAxisOverride[i].angleTargetActive = false;
     }
 
-    for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
-        logicConditionProcess(i);
+    if (!logicConditionProgramValid) {
+        logicConditionCompile();
+    }
+
+    // Fast conditions run here too, so the overrides cleared above are
+    // complete again once the task is done
+    for (uint8_t i = 0; i < logicConditionProgramLength; i++) {
+        logicConditionProcess(logicConditionProgram[i]);
     }
 
 #ifdef USE_I2C_IO_EXPANDER
@@ -778,6 +943,20 @@ void logicConditionUpdateTask(timeUs_t currentTimeUs) {
 #endif
 }
 
+/*
+ * Called from the PID loop. Conditions flagged as fast are evaluated on
+ * every iteration, their overrides last until the next task run clears them.
+ */
+void logicConditionUpdateFast(void) {
+    if (!logicConditionProgramValid) {
+        return;
+    }
+
+    for (uint8_t i = logicConditionProgramFastStart; i < logicConditionProgramLength; i++) {
+        logicConditionProcess(logicConditionProgram[i]);
+    }
+}
+
 void logicConditionReset(void) {
     for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
         logicConditionStates[i].value = 0;
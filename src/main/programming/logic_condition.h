@@ -166,6 +166,7 @@ typedef enum {
 
 typedef enum {
     LOGIC_CONDITION_FLAG_LATCH      = 1 << 0,
+    LOGIC_CONDITION_FLAG_FAST       = 1 << 1,   // Evaluated on every PID loop iteration
 } logicConditionFlags_e;
 
 typedef struct logicOperand_s {
@@ -208,13 +209,30 @@ extern uint64_t logicConditionsGlobalFlags;
 #define LOGIC_CONDITION_GLOBAL_FLAG_ENABLE(mask) (logicConditionsGlobalFlags |= (mask))
 #define LOGIC_CONDITION_GLOBAL_FLAG(mask) (logicConditionsGlobalFlags & (mask))
 
+/*
+ * Operand with its type dispatch and range checks done ahead of time, used
+ * where operands are read at PID loop rate. A NULL accessor means a constant.
+ */
+typedef struct logicOperandAccessor_s {
+    int (*get)(int operand);
+    int operand;
+} logicOperandAccessor_t;
+
 void logicConditionProcess(uint8_t i);
 
 int logicConditionGetOperandValue(logicOperandType_e type, int operand);
+void logicConditionResolveOperand(const logicOperand_t *operand, logicOperandAccessor_t *accessor);
+
+static inline int logicOperandAccessorGet(const logicOperandAccessor_t *accessor)
+{
+    return accessor->get ? accessor->get(accessor->operand) : accessor->operand;
+}
 
 int logicConditionGetValue(int8_t conditionId);
 void logicConditionUpdateTask(timeUs_t currentTimeUs);
+void logicConditionUpdateFast(void);
 void logicConditionReset(void);
+void logicConditionInvalidateProgram(void);
 
 float getThrottleScale(float globalThrottleScale);
 int16_t getRcCommandOverride(int16_t command[], uint8_t axis);
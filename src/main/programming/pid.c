@@ -65,35 +65,65 @@ void pgResetFn_programmingPids(programmingPid_t *instance)
     }
 }
 
+static void programmingPidApply(uint8_t i, float setpoint, float measurement, float dT)
+{
+    programmingPidState[i].output = navPidApply2(
+        &programmingPidState[i].controller,
+        setpoint,
+        measurement,
+        dT,
+        -1000,
+        1000,
+        PID_LIMIT_INTEGRATOR
+    );
+}
+
 void programmingPidUpdateTask(timeUs_t currentTimeUs)
 {
     static timeUs_t previousUpdateTimeUs;
-    const float dT = US2S(currentTimeUs - previousUpdateTimeUs);
-    
+
     if (!pidsInitiated) {
         programmingPidInit();
         pidsInitiated = true;
+        previousUpdateTimeUs = currentTimeUs;
+        return;
     }
 
+    const float dT = US2S(currentTimeUs - previousUpdateTimeUs);
+    previousUpdateTimeUs = currentTimeUs;
+
     for (uint8_t i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
-        if (programmingPids(i)->enabled) {
+        if (programmingPids(i)->enabled == PROGRAMMING_PID_ENABLED) {
             const int setpoint = logicConditionGetOperandValue(programmingPids(i)->setpoint.type, programmingPids(i)->setpoint.value);
             const int measurement = logicConditionGetOperandValue(programmingPids(i)->measurement.type, programmingPids(i)->measurement.value);
 
-            programmingPidState[i].output = navPidApply2(
-                &programmingPidState[i].controller,
-                setpoint,
-                measurement,
-                dT,
-                -1000,
-                1000,
-                PID_LIMIT_INTEGRATOR
-            );
-
+            programmingPidApply(i, setpoint, measurement, dT);
+        } else if (programmingPids(i)->enabled == PROGRAMMING_PID_ENABLED_FAST) {
+            // Operand changes reach the fast PIDs within a task period
+            logicConditionResolveOperand(&programmingPids(i)->setpoint, &programmingPidState[i].setpoint);
+            logicConditionResolveOperand(&programmingPids(i)->measurement, &programmingPidState[i].measurement);
         }
     }
+}
 
-    previousUpdateTimeUs = currentTimeUs;
+/*
+ * Called from the PID loop with its dT. Only PIDs enabled as fast are
+ * updated here, their operands were resolved by the programming task.
+ */
+void programmingPidUpdateFast(float dT)
+{
+    if (!pidsInitiated) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
+        if (programmingPids(i)->enabled == PROGRAMMING_PID_ENABLED_FAST) {
+            const float setpoint = logicOperandAccessorGet(&programmingPidState[i].setpoint);
+            const float measurement = logicOperandAccessorGet(&programmingPidState[i].measurement);
+
+            programmingPidApply(i, setpoint, measurement, dT);
+        }
+    }
 }
 
 void programmingPidInit(void)
@@ -108,11 +138,13 @@ void programmingPidInit(void)
             5.0f,
             0.0f
         );
+        logicConditionResolveOperand(&programmingPids(i)->setpoint, &programmingPidState[i].setpoint);
+        logicConditionResolveOperand(&programmingPids(i)->measurement, &programmingPidState[i].measurement);
     }
 }
 
 int32_t programmingPidGetOutput(uint8_t i) {
-    return programmingPidState[constrain(i, 0, MAX_PROGRAMMING_PID_COUNT)].output;
+    return programmingPidState[constrain(i, 0, MAX_PROGRAMMING_PID_COUNT - 1)].output;
 }
 
 void programmingPidReset(void)
@@ -43,12 +43,21 @@ typedef struct programmingPid_s {
 
 PG_DECLARE_ARRAY(programmingPid_t, MAX_PROGRAMMING_PID_COUNT, programmingPids);
 
+typedef enum {
+    PROGRAMMING_PID_DISABLED = 0,
+    PROGRAMMING_PID_ENABLED,
+    PROGRAMMING_PID_ENABLED_FAST,       // Updated on every PID loop iteration instead of the programming task
+} programmingPidEnabled_e;
+
 typedef struct programmingPidState_s {
     pidController_t controller;
+    logicOperandAccessor_t setpoint;
+    logicOperandAccessor_t measurement;
     float output;
 } programmingPidState_t;
 
 void programmingPidUpdateTask(timeUs_t currentTimeUs);
+void programmingPidUpdateFast(float dT);
 void programmingPidInit(void);
 void programmingPidReset(void);
 int32_t programmingPidGetOutput(uint8_t i);
\ No newline at end of file
@@ -44,6 +44,7 @@ FILE_COMPILE_FOR_SPEED
 #include "telemetry/crsf.h"
 #define CRSF_TIME_NEEDED_PER_FRAME_US   1100 // 700 ms + 400 ms for potential ad-hoc request
 #define CRSF_TIME_BETWEEN_FRAMES_US     6667 // At fastest, frames are sent by the transmitter every 6.667 milliseconds, 150 Hz
+#define CRSF_RC_FRAME_INTERVAL_MAX_US   250000 // Gaps longer than this are link loss, not a packet rate
 
 #define CRSF_DIGITAL_CHANNEL_MIN 172
 #define CRSF_DIGITAL_CHANNEL_MAX 1811
@@ -57,6 +58,15 @@ STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
 static serialPort_t *serialPort;
 static timeUs_t crsfFrameStartAt = 0;
+static uint8_t crsfFramePosition = 0;
+static timeUs_t crsfFrameTimeUs = 0;
+static bool crsfFrameTimePending = false;
+static timeUs_t crsfLastRcFrameTimeUs = 0;
+static uint32_t crsfRcFrameIntervalUs = 0;
+static uint8_t crsfLastRcPayload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE];
+static bool crsfLastRcPayloadValid = false;
+static uint8_t crsfRfMode = 0;
+static bool crsfRfModeValid = false;
 static uint8_t telemetryBuf[CRSF_FRAME_SIZE_MAX];
 static uint8_t telemetryBufLen = 0;
 
@@ -126,14 +136,34 @@ typedef struct crsfPayloadLinkStatistics_s {
 
 typedef struct crsfPayloadLinkStatistics_s crsfPayloadLinkStatistics_t;
 
+#define CRSF_RC_CHANNEL_COUNT   16
+#define CRSF_RC_CHANNEL_BITS    11
+#define CRSF_RC_CHANNEL_MASK    ((1 << CRSF_RC_CHANNEL_BITS) - 1)
+
+STATIC_ASSERT(sizeof(crsfPayloadRcChannelsPacked_t) == CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE, crsf_rc_channels_payload_size);
+
+static void crsfUnpackRcChannels(const uint8_t *payload)
+{
+    // 11 bit channels packed LSB first, shift them out of an accumulator
+    uint32_t bits = 0;
+    unsigned bitCount = 0;
+
+    for (int i = 0; i < CRSF_RC_CHANNEL_COUNT; i++) {
+        while (bitCount < CRSF_RC_CHANNEL_BITS) {
+            bits |= (uint32_t)(*payload++) << bitCount;
+            bitCount += 8;
+        }
+        crsfChannelData[i] = bits & CRSF_RC_CHANNEL_MASK;
+        bits >>= CRSF_RC_CHANNEL_BITS;
+        bitCount -= CRSF_RC_CHANNEL_BITS;
+    }
+}
+
 STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
 {
     // CRC includes type and payload
-    uint8_t crc = crc8_dvb_s2(0, crsfFrame.frame.type);
-    for (int ii = 0; ii < crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC; ++ii) {
-        crc = crc8_dvb_s2(crc, crsfFrame.frame.payload[ii]);
-    }
-    return crc;
+    const uint8_t crc = crc8_dvb_s2(0, crsfFrame.frame.type);
+    return crc8_dvb_s2_update(crc, crsfFrame.frame.payload, crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC);
 }
 
 // Receive ISR callback, called back from serial port
@@ -141,7 +171,6 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *rxCallbackData)
 {
     UNUSED(rxCallbackData);
 
-    static uint8_t crsfFramePosition = 0;
     const timeUs_t now = micros();
 
 #ifdef DEBUG_CRSF_PACKETS
@@ -166,6 +195,8 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *rxCallbackData)
         crsfFrameDone = crsfFramePosition < fullFrameLength ? false : true;
         if (crsfFrameDone) {
             crsfFramePosition = 0;
+            crsfFrameTimeUs = now;
+            crsfFrameTimePending = true;
             if (crsfFrame.frame.type != CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
                 const uint8_t crc = crsfFrameCRC();
                 if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
@@ -190,10 +221,21 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *rxCallbackData)
     }
 }
 
-STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
+// Ports receiving through DMA deliver each frame in one burst, anything still pending when the line goes idle was truncated.
+// The bytes were handed over after the fact, the idle line timestamp is when the frame really ended
+static void crsfIdleReceive(timeUs_t frameEndUs, void *rxCallbackData)
 {
-    UNUSED(rxRuntimeConfig);
+    UNUSED(rxCallbackData);
 
+    crsfFramePosition = 0;
+    if (crsfFrameTimePending) {
+        crsfFrameTimeUs = frameEndUs;
+        crsfFrameTimePending = false;
+    }
+}
+
+STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
+{
     if (crsfFrameDone) {
         crsfFrameDone = false;
         if (crsfFrame.frame.type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
@@ -204,24 +246,20 @@ STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
             }
             crsfFrame.frame.frameLength = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
 
-            // unpack the RC channels
-            const crsfPayloadRcChannelsPacked_t* rcChannels = (crsfPayloadRcChannelsPacked_t*)&crsfFrame.frame.payload;
-            crsfChannelData[0] = rcChannels->chan0;
-            crsfChannelData[1] = rcChannels->chan1;
-            crsfChannelData[2] = rcChannels->chan2;
-            crsfChannelData[3] = rcChannels->chan3;
-            crsfChannelData[4] = rcChannels->chan4;
-            crsfChannelData[5] = rcChannels->chan5;
-            crsfChannelData[6] = rcChannels->chan6;
-            crsfChannelData[7] = rcChannels->chan7;
-            crsfChannelData[8] = rcChannels->chan8;
-            crsfChannelData[9] = rcChannels->chan9;
-            crsfChannelData[10] = rcChannels->chan10;
-            crsfChannelData[11] = rcChannels->chan11;
-            crsfChannelData[12] = rcChannels->chan12;
-            crsfChannelData[13] = rcChannels->chan13;
-            crsfChannelData[14] = rcChannels->chan14;
-            crsfChannelData[15] = rcChannels->chan15;
+            // At high packet rates most frames repeat the previous sticks, the channels are only unpacked on change
+            if (!crsfLastRcPayloadValid || memcmp(crsfLastRcPayload, crsfFrame.frame.payload, CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE) != 0) {
+                memcpy(crsfLastRcPayload, crsfFrame.frame.payload, CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE);
+                crsfLastRcPayloadValid = true;
+                crsfUnpackRcChannels(crsfLastRcPayload);
+            }
+            rxRuntimeConfig->frameTimeUs = crsfFrameTimeUs;
+
+            // Track the packet rate, telemetry is paced by it. Low pass so a single late frame doesn't matter
+            if (crsfLastRcFrameTimeUs) {
+                const uint32_t intervalUs = MIN(cmpTimeUs(crsfFrameTimeUs, crsfLastRcFrameTimeUs), CRSF_RC_FRAME_INTERVAL_MAX_US);
+                crsfRcFrameIntervalUs = crsfRcFrameIntervalUs ? (crsfRcFrameIntervalUs * 7 + intervalUs) / 8 : intervalUs;
+            }
+            crsfLastRcFrameTimeUs = crsfFrameTimeUs;
             return RX_FRAME_COMPLETE;
         }
         else if (crsfFrame.frame.type == CRSF_FRAMETYPE_LINK_STATISTICS) {
@@ -239,6 +277,17 @@ STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
             rxLinkStatistics.uplinkLQ = linkStats->uplinkLQ;
             rxLinkStatistics.uplinkSNR = linkStats->uplinkSNR;
             rxLinkStatistics.rfMode = linkStats->rfMode;
+
+            // Crossfire and ExpressLRS report the packet rate as RF mode. On a switch the
+            // measured frame interval restarts, telemetry pacing and RC smoothing follow it
+            uint8_t rateStatus = RX_FRAME_PENDING;
+            if (crsfRfModeValid && linkStats->rfMode != crsfRfMode) {
+                crsfLastRcFrameTimeUs = 0;
+                crsfRcFrameIntervalUs = 0;
+                rateStatus = RX_FRAME_RATE_CHANGED;
+            }
+            crsfRfMode = linkStats->rfMode;
+            crsfRfModeValid = true;
             rxLinkStatistics.uplinkTXPower = crsfTxPowerStatesmW[crsftxpowerindex];
             rxLinkStatistics.activeAntenna = linkStats->activeAntenna;
 
@@ -255,7 +304,7 @@ STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
                 lqTrackerSet(rxRuntimeConfig->lqTracker, 0);
 
             // This is not RC channels frame, update channel value but don't indicate frame completion
-            return RX_FRAME_PENDING;
+            return rateStatus;
         }
     }
     return RX_FRAME_PENDING;
@@ -282,6 +331,16 @@ void crsfRxWriteTelemetryData(const void *data, int len)
     telemetryBufLen = len;
 }
 
+bool crsfRxIsTelemetryBufferEmpty(void)
+{
+    return telemetryBufLen == 0;
+}
+
+uint32_t crsfRxFrameIntervalUs(void)
+{
+    return crsfRcFrameIntervalUs;
+}
+
 void crsfRxSendTelemetryData(void)
 {
     // if there is telemetry data to write
@@ -324,6 +383,10 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
         CRSF_PORT_OPTIONS | (tristateWithDefaultOffIsActive(rxConfig->halfDuplex) ? SERIAL_BIDIR : 0)
         );
 
+    if (serialPort) {
+        serialSetIdleCallback(serialPort, crsfIdleReceive);
+    }
+
     return serialPort != NULL;
 }
 
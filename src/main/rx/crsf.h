@@ -119,6 +119,8 @@ typedef union crsfFrame_u {
 
 void crsfRxWriteTelemetryData(const void *data, int len);
 void crsfRxSendTelemetryData(void);
+bool crsfRxIsTelemetryBufferEmpty(void);
+uint32_t crsfRxFrameIntervalUs(void);    // Filtered interval between RC frames, 0 until known
 
 struct rxConfig_s;
 struct rxRuntimeConfig_s;
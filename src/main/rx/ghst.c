@@ -110,12 +110,33 @@ static ghstFailsafeTracker_t ghstFsTracker[GHST_UL_RC_CHANS_FRAME_COUNT];
 #define GHST_FRAME_LENGTH_FRAMELENGTH   1
 #define GHST_FRAME_LENGTH_TYPE_CRC      1
 
+static bool ghstTelemetrySlotSend(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (telemetryBufLen > 0) {
+        ghstTransmittingTelemetry = true;
+        ghstRxSendTelemetryData();
+    }
+
+    return true;
+}
+
+static void ghstArmTelemetrySlot(void)
+{
+    // The slot is relative to the end of the last frame, a reply prepared too late for it waits for the next frame
+    if (telemetryBufLen > 0 && cmpTimeUs(micros(), ghstRxFrameEndAtUs) < GHST_RX_TO_TELEMETRY_MAX_US) {
+        rxReplySlotArm(ghstTelemetrySlotSend, ghstRxFrameEndAtUs + GHST_RX_TO_TELEMETRY_MIN_US, GHST_RX_TO_TELEMETRY_MAX_US - GHST_RX_TO_TELEMETRY_MIN_US);
+    }
+}
+
 // called from telemetry/ghst.c
 void ghstRxWriteTelemetryData(const void *data, int len)
 {
     len = MIN(len, (int)sizeof(telemetryBuf));
     memcpy(telemetryBuf, data, len);
     telemetryBufLen = len;
+    ghstArmTelemetrySlot();
 }
 
 void ghstRxSendTelemetryData(void)
@@ -130,11 +151,8 @@ void ghstRxSendTelemetryData(void)
 STATIC_UNIT_TESTED uint8_t ghstFrameCRC(ghstFrame_t *pGhstFrame)
 {
     // CRC includes type and payload
-    uint8_t crc = crc8_dvb_s2(0, pGhstFrame->frame.type);
-    for (int i = 0; i < pGhstFrame->frame.len - GHST_FRAME_LENGTH_TYPE_CRC - 1; ++i) {
-        crc = crc8_dvb_s2(crc, pGhstFrame->frame.payload[i]);
-    }
-    return crc;
+    const uint8_t crc = crc8_dvb_s2(0, pGhstFrame->frame.type);
+    return crc8_dvb_s2_update(crc, pGhstFrame->frame.payload, pGhstFrame->frame.len - GHST_FRAME_LENGTH_TYPE_CRC - 1);
 }
 
 // Receive ISR callback, called back from serial port
@@ -175,13 +193,6 @@ STATIC_UNIT_TESTED void ghstDataReceive(uint16_t c, void *data)
     }
 }
 
-static bool shouldSendTelemetryFrame(void)
-{
-    const timeUs_t now = micros();
-    const timeDelta_t timeSinceRxFrameEndUs = cmpTimeUs(now, ghstRxFrameEndAtUs);
-    return telemetryBufLen > 0 && timeSinceRxFrameEndUs > GHST_RX_TO_TELEMETRY_MIN_US && timeSinceRxFrameEndUs < GHST_RX_TO_TELEMETRY_MAX_US;
-}
-
 static void ghstIdle(void)
 {
     if (ghstTransmittingTelemetry) {
@@ -239,7 +250,6 @@ static bool ghstDetectFailsafe(void)
 
 uint8_t ghstFrameStatus(rxRuntimeConfig_t *rxRuntimeState)
 {
-    UNUSED(rxRuntimeState);
 
     if (serialIsIdle(serialPort)) {
         ghstIdle();
@@ -254,16 +264,14 @@ uint8_t ghstFrameStatus(rxRuntimeConfig_t *rxRuntimeState)
         const int fullFrameLength = ghstValidatedFrame.frame.len + GHST_FRAME_LENGTH_ADDRESS + GHST_FRAME_LENGTH_FRAMELENGTH;
         if (crc == ghstValidatedFrame.bytes[fullFrameLength - 1] && ghstValidatedFrame.frame.addr == GHST_ADDR_FC) {
             ghstValidatedFrameAvailable = true;
+            rxRuntimeState->frameTimeUs = ghstRxFrameEndAtUs;
+            ghstArmTelemetrySlot();
             return ghstFailsafeFlag | RX_FRAME_COMPLETE | RX_FRAME_PROCESSING_REQUIRED;            // request callback through ghstProcessFrame to do the decoding  work
         }
 
         return ghstFailsafeFlag | RX_FRAME_DROPPED;                            // frame was invalid
     }
 
-    if (shouldSendTelemetryFrame()) {
-        return ghstFailsafeFlag | RX_FRAME_PROCESSING_REQUIRED;
-    }
-
     return ghstFailsafeFlag | RX_FRAME_PENDING;
 }
 
@@ -272,12 +280,6 @@ static bool ghstProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
     // Assume that the only way we get here is if ghstFrameStatus returned RX_FRAME_PROCESSING_REQUIRED, which indicates that the CRC
     // is correct, and the message was actually for us.
 
-    // do we have a telemetry buffer to send?
-    if (shouldSendTelemetryFrame()) {
-        ghstTransmittingTelemetry = true;
-        ghstRxSendTelemetryData();
-    }
-
     if (ghstValidatedFrameAvailable) {
         int startIdx = 0;
 
@@ -90,6 +90,9 @@ static uint8_t rxChannelCount;
 static timeUs_t rxNextUpdateAtUs = 0;
 static timeUs_t needRxSignalBefore = 0;
 static timeUs_t suspendRxSignalUntil = 0;
+static timeUs_t rxFrameTimeUs = 0;
+static timeDelta_t rxFrameIntervalUs = 0;   // Smoothed interval between complete frames, 0 until measured
+static uint8_t rxRateChangeCount = 0;
 static uint8_t skipRxSamples = 0;
 
 static rcChannel_t rcChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
@@ -97,11 +100,15 @@ static rcChannel_t rcChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
 #define SKIP_RC_ON_SUSPEND_PERIOD 1500000           // 1.5 second period in usec (call frequency independent)
 #define SKIP_RC_SAMPLES_ON_RESUME  2                // flush 2 samples to drop wrong measurements (timing independent)
 
+#define RX_FRAME_INTERVAL_MAX_US        100000      // Longer gaps are outages, not the packet rate
+#define RX_SIGNAL_LOSS_TIMEOUT_MIN_US   2000
+#define RX_SIGNAL_LOSS_TIMEOUT_MAX_US   500000
+
 rxLinkStatistics_t rxLinkStatistics;
 rxRuntimeConfig_t rxRuntimeConfig;
 static uint8_t rcSampleIndex = 0;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(rxConfig_t, rxConfig, PG_RX_CONFIG, 12);
+PG_REGISTER_WITH_RESET_TEMPLATE(rxConfig_t, rxConfig, PG_RX_CONFIG, 14);
 
 #ifndef SERIALRX_PROVIDER
 #define SERIALRX_PROVIDER 0
@@ -132,10 +139,12 @@ PG_RESET_TEMPLATE(rxConfig_t, rxConfig,
     .rcFilterFrequency = SETTING_RC_FILTER_LPF_HZ_DEFAULT,
     .autoSmooth = SETTING_RC_FILTER_AUTO_DEFAULT,
     .autoSmoothFactor = SETTING_RC_FILTER_SMOOTHING_FACTOR_DEFAULT,
+    .rcFilterMode = SETTING_RC_FILTER_MODE_DEFAULT,
 #if defined(USE_RX_MSP) && defined(USE_MSP_RC_OVERRIDE)
     .mspOverrideChannels = SETTING_MSP_OVERRIDE_CHANNELS_DEFAULT,
 #endif
     .rssi_source = SETTING_RSSI_SOURCE_DEFAULT,
+    .signalLossFrames = SETTING_RX_SIGNAL_LOSS_FRAMES_DEFAULT,
 #ifdef USE_SERIALRX_SRXL2
     .srxl2_unit_id = SETTING_SRXL2_UNIT_ID_DEFAULT,
     .srxl2_baud_fast = SETTING_SRXL2_BAUD_FAST_DEFAULT,
@@ -390,6 +399,17 @@ void resumeRxSignal(void)
     failsafeOnRxResume();
 }
 
+static timeUs_t rxGetSignalTimeoutUs(void)
+{
+    if (rxConfig()->signalLossFrames && rxFrameIntervalUs) {
+        // Lost once the given number of expected frames did not arrive, half a frame of margin for the jitter
+        const timeUs_t timeoutUs = rxConfig()->signalLossFrames * rxFrameIntervalUs + rxFrameIntervalUs / 2;
+        return constrain(timeoutUs, RX_SIGNAL_LOSS_TIMEOUT_MIN_US, RX_SIGNAL_LOSS_TIMEOUT_MAX_US);
+    }
+
+    return rxRuntimeConfig.rxSignalTimeout;
+}
+
 bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
 {
     UNUSED(currentDeltaTime);
@@ -397,16 +417,32 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     if (rxSignalReceived) {
         if (currentTimeUs >= needRxSignalBefore) {
             rxSignalReceived = false;
+            // Hold the channels and tell failsafe now rather than at the next forced update
+            rxDataProcessingRequired = true;
         }
     }
 
     const uint8_t frameStatus = rxRuntimeConfig.rcFrameStatusFn(&rxRuntimeConfig);
 
+    if (frameStatus & RX_FRAME_RATE_CHANGED) {
+        // Learn the new interval from scratch instead of slowly filtering over from the old one
+        rxFrameIntervalUs = 0;
+        rxRateChangeCount++;
+    }
+
     if (frameStatus & RX_FRAME_COMPLETE) {
+        const timeUs_t frameTimeUs = rxRuntimeConfig.frameTimeUs ? rxRuntimeConfig.frameTimeUs : currentTimeUs;
+        const timeDelta_t frameIntervalUs = cmpTimeUs(frameTimeUs, rxFrameTimeUs);
+
+        if (rxSignalReceived && frameIntervalUs > 0 && frameIntervalUs < RX_FRAME_INTERVAL_MAX_US) {
+            rxFrameIntervalUs = rxFrameIntervalUs ? rxFrameIntervalUs + (frameIntervalUs - rxFrameIntervalUs) / 8 : frameIntervalUs;
+        }
+
         // RX_FRAME_COMPLETE updated the failsafe status regardless
         rxSignalReceived = (frameStatus & RX_FRAME_FAILSAFE) == 0;
-        needRxSignalBefore = currentTimeUs + rxRuntimeConfig.rxSignalTimeout;
+        needRxSignalBefore = currentTimeUs + rxGetSignalTimeoutUs();
         rxDataProcessingRequired = true;
+        rxFrameTimeUs = frameTimeUs;
     }
     else if ((frameStatus & RX_FRAME_FAILSAFE) && rxSignalReceived) {
         // All other receiver statuses are allowed to report failsafe, but not allowed to leave it
@@ -521,6 +557,43 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
     return true;
 }
 
+timeUs_t rxGetFrameTimeUs(void)
+{
+    return rxFrameTimeUs;
+}
+
+uint8_t rxGetRateChangeCount(void)
+{
+    return rxRateChangeCount;
+}
+
+static rxReplySlotFnPtr replySlotFn = NULL;
+static timeUs_t replySlotOpenAtUs;
+static timeDelta_t replySlotLengthUs;
+
+void rxReplySlotArm(rxReplySlotFnPtr sendFn, timeUs_t openAtUs, timeDelta_t lengthUs)
+{
+    replySlotOpenAtUs = openAtUs;
+    replySlotLengthUs = lengthUs;
+    replySlotFn = sendFn;
+}
+
+void rxReplySlotProcess(timeUs_t currentTimeUs)
+{
+    if (!replySlotFn) {
+        return;
+    }
+
+    const timeDelta_t sinceOpenUs = cmpTimeUs(currentTimeUs, replySlotOpenAtUs);
+    if (sinceOpenUs < 0) {
+        return;
+    }
+
+    if ((replySlotLengthUs && sinceOpenUs > replySlotLengthUs) || replySlotFn(currentTimeUs)) {
+        replySlotFn = NULL;
+    }
+}
+
 void parseRcChannels(const char *input)
 {
     for (const char *c = input; *c; c++) {
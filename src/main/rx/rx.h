@@ -59,6 +59,7 @@ typedef enum {
     RX_FRAME_FAILSAFE            = (1 << 1),  // Receiver detected loss of RC link. Only valid when RX_FRAME_COMPLETE is set as well
     RX_FRAME_PROCESSING_REQUIRED = (1 << 2),
     RX_FRAME_DROPPED             = (1 << 3),  // Receiver detected dropped frame. Not loss of link yet.
+    RX_FRAME_RATE_CHANGED        = (1 << 4),  // Receiver reported a new packet rate, frame intervals measured so far are stale
 } rxFrameState_e;
 
 typedef enum {
@@ -105,6 +106,11 @@ typedef struct rxChannelRangeConfig_s {
 } rxChannelRangeConfig_t;
 PG_DECLARE_ARRAY(rxChannelRangeConfig_t, NON_AUX_CHANNEL_COUNT, rxChannelRangeConfigs);
 
+typedef enum {
+    RC_FILTER_MODE_LPF = 0,                 // Low pass filter the sticks
+    RC_FILTER_MODE_EXTRAPOLATE,             // Extrapolate the sticks between frames from their rate of change
+} rcFilterMode_e;
+
 typedef struct rxConfig_s {
     uint8_t receiverType;                   // RC receiver type (rxReceiverType_e enum)
     uint8_t rcmap[MAX_MAPPABLE_RX_INPUTS];  // mapping of radio channels to internal RPYTA+ order
@@ -126,8 +132,10 @@ typedef struct rxConfig_s {
     uint8_t rcFilterFrequency;              // RC filter cutoff frequency (smoothness vs response sharpness)
     uint8_t autoSmooth;                     // auto smooth rx input (0 = off, 1 = on)
     uint8_t autoSmoothFactor;               // auto smooth rx input factor (1 = no smoothing, 100 = lots of smoothing)
+    uint8_t rcFilterMode;                   // rcFilterMode_e
     uint16_t mspOverrideChannels;           // Channels to override with MSP RC when BOXMSPRCOVERRIDE is active
     uint8_t rssi_source;
+    uint8_t signalLossFrames;               // Missed frames, at the measured packet rate, before the signal is lost. 0 = fixed timeout
 #ifdef USE_SERIALRX_SRXL2
     uint8_t srxl2_unit_id;
     uint8_t srxl2_baud_fast;
@@ -160,6 +168,7 @@ typedef struct rxRuntimeConfig_s {
     rxLinkQualityTracker_e * lqTracker;     // Pointer to a
     uint16_t *channelData;
     void *frameData;
+    timeUs_t frameTimeUs;                   // When the last complete RC frame ended on the wire, left at 0 by drivers that don't timestamp frames
 } rxRuntimeConfig_t;
 
 typedef struct rcChannel_s {
@@ -215,6 +224,21 @@ void resetAllRxChannelRangeConfigurations(void);
 void suspendRxSignal(void);
 void resumeRxSignal(void);
 
+// When the RC frame currently in use ended, taken from the receiver driver
+// where it timestamps frames and from the RX task otherwise
+timeUs_t rxGetFrameTimeUs(void);
+// Incremented each time the receiver switches packet rate, consumers
+// tracking the frame rate compare it to restart their estimate
+uint8_t rxGetRateChangeCount(void);
+
+// Half duplex receivers expect the reply in a time slot after their frame. The driver
+// prepares the reply and arms the slot, sendFn is called from the real-time callbacks
+// once the slot opens and returns false to be retried. A lengthUs of 0 keeps the slot
+// open until the reply went out, otherwise a slot missed is dropped
+typedef bool (*rxReplySlotFnPtr)(timeUs_t currentTimeUs);
+void rxReplySlotArm(rxReplySlotFnPtr sendFn, timeUs_t openAtUs, timeDelta_t lengthUs);
+void rxReplySlotProcess(timeUs_t currentTimeUs);
+
 // Processed RC channel value. These values might include
 // filtering and some extra processing like value holding
 // during failsafe.
@@ -65,6 +65,8 @@ typedef struct sbusFrameData_s {
     uint8_t buffer[SBUS_FRAME_SIZE];
     uint8_t position;
     timeUs_t lastActivityTimeUs;
+    timeUs_t frameTimeUs;
+    bool frameTimePending;
 } sbusFrameData_t;
 
 // Receive ISR callback
@@ -119,6 +121,8 @@ static void sbusDataReceive(uint16_t c, void *data)
                 if (!sbusFrameData->frameDone && frameValid) {
 
                     memcpy((void *)&sbusFrameData->frame, (void *)&sbusFrameData->buffer[0], SBUS_FRAME_SIZE);
+                    sbusFrameData->frameTimeUs = currentTimeUs;
+                    sbusFrameData->frameTimePending = true;
                     sbusFrameData->frameDone = true;
                 }
             }
@@ -131,6 +135,18 @@ static void sbusDataReceive(uint16_t c, void *data)
     }
 }
 
+// On ports receiving through DMA the bytes of a frame are handed over together, the idle line
+// timestamp is when the last byte really ended and keeps the inter-frame gap measurement exact
+static void sbusIdleReceive(timeUs_t frameEndUs, void *data)
+{
+    sbusFrameData_t *sbusFrameData = data;
+    sbusFrameData->lastActivityTimeUs = frameEndUs;
+    if (sbusFrameData->frameTimePending) {
+        sbusFrameData->frameTimeUs = frameEndUs;
+        sbusFrameData->frameTimePending = false;
+    }
+}
+
 static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
@@ -141,6 +157,7 @@ static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 
     // Decode channel data and store return value
     const uint8_t retValue = sbusChannelsDecode(rxRuntimeConfig, (void *)&sbusFrameData->frame.channels);
+    rxRuntimeConfig->frameTimeUs = sbusFrameData->frameTimeUs;
 
     // Reset the frameDone flag - tell ISR that we're ready to receive next frame
     sbusFrameData->frameDone = false;
@@ -189,6 +206,10 @@ static bool sbusInitEx(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeC
             (tristateWithDefaultOffIsActive(rxConfig->halfDuplex) ? SERIAL_BIDIR : 0)
         );
 
+    if (sBusPort) {
+        serialSetIdleCallback(sBusPort, sbusIdleReceive);
+    }
+
 #ifdef USE_TELEMETRY
     if (portShared) {
         telemetrySharedPort = sBusPort;
@@ -36,25 +36,30 @@
 
 STATIC_ASSERT(SBUS_FRAME_SIZE == sizeof(sbusFrame_t), SBUS_FRAME_SIZE_doesnt_match_sbusFrame_t);
 
+#define SBUS_ANALOG_CHANNEL_COUNT   16
+#define SBUS_CHANNEL_BITS           11
+#define SBUS_CHANNEL_MASK           ((1 << SBUS_CHANNEL_BITS) - 1)
+
 uint8_t sbusChannelsDecode(rxRuntimeConfig_t *rxRuntimeConfig, const sbusChannels_t *channels)
 {
     uint16_t *sbusChannelData = rxRuntimeConfig->channelData;
-    sbusChannelData[0] = channels->chan0;
-    sbusChannelData[1] = channels->chan1;
-    sbusChannelData[2] = channels->chan2;
-    sbusChannelData[3] = channels->chan3;
-    sbusChannelData[4] = channels->chan4;
-    sbusChannelData[5] = channels->chan5;
-    sbusChannelData[6] = channels->chan6;
-    sbusChannelData[7] = channels->chan7;
-    sbusChannelData[8] = channels->chan8;
-    sbusChannelData[9] = channels->chan9;
-    sbusChannelData[10] = channels->chan10;
-    sbusChannelData[11] = channels->chan11;
-    sbusChannelData[12] = channels->chan12;
-    sbusChannelData[13] = channels->chan13;
-    sbusChannelData[14] = channels->chan14;
-    sbusChannelData[15] = channels->chan15;
+
+    // Channels are packed LSB first back to back. Feed the bytes through an accumulator
+    // and take 11 bits at a time instead of going through the bitfield accessors, which
+    // the compiler turns into an unaligned load and shift/mask pair per channel.
+    const uint8_t *payload = (const uint8_t *)channels;
+    uint32_t bits = 0;
+    unsigned bitCount = 0;
+
+    for (int i = 0; i < SBUS_ANALOG_CHANNEL_COUNT; i++) {
+        while (bitCount < SBUS_CHANNEL_BITS) {
+            bits |= (uint32_t)(*payload++) << bitCount;
+            bitCount += 8;
+        }
+        sbusChannelData[i] = bits & SBUS_CHANNEL_MASK;
+        bits >>= SBUS_CHANNEL_BITS;
+        bitCount -= SBUS_CHANNEL_BITS;
+    }
 
     if (channels->flags & SBUS_FLAG_CHANNEL_17) {
         sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MAX;
@@ -95,6 +95,7 @@ static uint32_t fullTimeoutTimestamp = 0;
 static uint32_t lastValidPacketTimestamp = 0;
 static volatile uint32_t lastReceiveTimestamp = 0;
 static volatile uint32_t lastIdleTimestamp = 0;
+static uint32_t lastPacketEndTimestamp = 0;
 
 struct rxBuf readBuffer[2];
 struct rxBuf* readBufferPtr = &readBuffer[0];
@@ -168,6 +169,7 @@ bool srxl2ProcessHandshake(const Srxl2Header* header)
 
 void srxl2ProcessChannelData(const Srxl2ChannelDataHeader* channelData, rxRuntimeConfig_t *rxRuntimeConfig) {
     globalResult = RX_FRAME_COMPLETE;
+    rxRuntimeConfig->frameTimeUs = lastPacketEndTimestamp;
 
     if (channelData->rssi >= 0) {
         const int rssiPercent = channelData->rssi;
@@ -312,6 +314,7 @@ static void srxl2Idle(void)
     }
     else {
         lastIdleTimestamp = microsISR();
+        lastPacketEndTimestamp = lastReceiveTimestamp;
         //Swap read and process buffer pointers
         if(processBufferPtr == &readBuffer[0]) {
             processBufferPtr = &readBuffer[1];
@@ -381,12 +384,7 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     } break;
 
     case SendHandshake: {
-        if (cmpTimeUs(now, timeoutTimestamp) >= 0) {
-            // @todo set another timeout for 50ms tries
-            // fill write buffer with handshake frame
-            result |= RX_FRAME_PROCESSING_REQUIRED;
-        }
-
+        // @todo set another timeout for 50ms tries, fill write buffer with handshake frame
         if (cmpTimeUs(now, fullTimeoutTimestamp) >= 0) {
             serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_DEFAULT);
             DEBUG_PRINTF("case SendHandshake: switching to %d baud\r\n", SRXL2_PORT_BAUDRATE_DEFAULT);
@@ -425,36 +423,24 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     } break;
     };
 
-    if (writeBufferIdx) {
-        result |= RX_FRAME_PROCESSING_REQUIRED;
-    }
-
     return result;
 }
 
-static bool srxl2ProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
+static bool srxl2ReplySlotSend(timeUs_t currentTimeUs)
 {
-    UNUSED(rxRuntimeConfig);
-
     if (writeBufferIdx == 0) {
         return true;
     }
 
-    const uint32_t now = micros();
-
-    if (cmpTimeUs(lastIdleTimestamp, lastReceiveTimestamp) > 0) {
-        // time sufficient for at least 2 characters has passed
-        if (cmpTimeUs(now, lastReceiveTimestamp) > SRXL2_REPLY_QUIESCENCE) {
-            transmittingTelemetry = true;
-            serialWriteBuf(serialPort, writeBuffer, writeBufferIdx);
-            writeBufferIdx = 0;
-        } else {
-            DEBUG_PRINTF("not enough time to send 2 characters passed yet, %d us since last receive, %d required\r\n", now - lastReceiveTimestamp, SRXL2_REPLY_QUIESCENCE);
-        }
-    } else {
-        DEBUG_PRINTF("still receiving a frame, %d %d\r\n", lastIdleTimestamp, lastReceiveTimestamp);
+    // The bus must have gone idle after the last frame and stayed quiet for at least 2 characters
+    if (cmpTimeUs(lastIdleTimestamp, lastReceiveTimestamp) <= 0 || cmpTimeUs(currentTimeUs, lastReceiveTimestamp) <= SRXL2_REPLY_QUIESCENCE) {
+        return false;
     }
 
+    transmittingTelemetry = true;
+    serialWriteBuf(serialPort, writeBuffer, writeBufferIdx);
+    writeBufferIdx = 0;
+
     return true;
 }
 
@@ -476,6 +462,9 @@ void srxl2RxWriteData(const void *data, int len)
     len = MIN(len, (int)sizeof(writeBuffer));
     memcpy(writeBuffer, data, len);
     writeBufferIdx = len;
+
+    // Sent once the bus is quiet after the frame that asked for it
+    rxReplySlotArm(srxl2ReplySlotSend, lastReceiveTimestamp + SRXL2_REPLY_QUIESCENCE, 0);
 }
 
 bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
@@ -492,7 +481,6 @@ bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     rxRuntimeConfig->channelCount = SRXL2_MAX_CHANNELS;
     rxRuntimeConfig->rcReadRawFn = srxl2ReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = srxl2FrameStatus;
-    rxRuntimeConfig->rcProcessFrameFn = srxl2ProcessFrame;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -23,6 +23,7 @@
 
 #ifdef USE_SERIALRX_SUMD
 
+#include "common/crc.h"
 #include "common/utils.h"
 
 #include "drivers/time.h"
@@ -42,29 +43,13 @@
 
 #define SUMD_SYNCBYTE 0xA8
 #define SUMD_MAX_CHANNEL 16
-#define SUMD_BUFFSIZE (SUMD_MAX_CHANNEL * 2 + 5) // 6 channels + 5 = 17 bytes for 6 channels
+#define SUMD_MAX_FRAME_CHANNEL 32
+#define SUMD_BUFFSIZE (SUMD_MAX_FRAME_CHANNEL * 2 + 5) // 6 channels + 5 = 17 bytes for 6 channels
 
 #define SUMD_BAUDRATE 115200
 
 static bool sumdFrameDone = false;
 static uint16_t sumdChannels[SUMD_MAX_CHANNEL];
-static uint16_t crc;
-
-#define CRC_POLYNOME 0x1021
-
-// CRC calculation, adds a 8 bit unsigned to 16 bit crc
-static void CRC16(uint8_t value)
-{
-    uint8_t i;
-
-    crc = crc ^ (int16_t)value << 8;
-    for (i = 0; i < 8; i++) {
-    if (crc & 0x8000)
-        crc = (crc << 1) ^ CRC_POLYNOME;
-    else
-        crc = (crc << 1);
-    }
-}
 
 static uint8_t sumd[SUMD_BUFFSIZE] = { 0, };
 static uint8_t sumdChannelCount;
@@ -87,23 +72,21 @@ static void sumdDataReceive(uint16_t c, void *rxCallbackData)
         if (c != SUMD_SYNCBYTE)
             return;
         else
-        {
             sumdFrameDone = false; // lazy main loop didnt fetch the stuff
-            crc = 0;
-        }
     }
-    if (sumdIndex == 2)
-        sumdChannelCount = (uint8_t)c;
-    if (sumdIndex < SUMD_BUFFSIZE)
-        sumd[sumdIndex] = (uint8_t)c;
-    sumdIndex++;
-    if (sumdIndex < sumdChannelCount * 2 + 4)
-        CRC16((uint8_t)c);
-    else
-        if (sumdIndex == sumdChannelCount * 2 + 5) {
+    if (sumdIndex == 2) {
+        // Frames beyond the buffer can't be checked, drop them
+        if (c == 0 || c > SUMD_MAX_FRAME_CHANNEL) {
             sumdIndex = 0;
-            sumdFrameDone = true;
+            return;
         }
+        sumdChannelCount = (uint8_t)c;
+    }
+    sumd[sumdIndex++] = (uint8_t)c;
+    if (sumdIndex == sumdChannelCount * 2 + 5) {
+        sumdIndex = 0;
+        sumdFrameDone = true;
+    }
 }
 
 #define SUMD_OFFSET_CHANNEL_1_HIGH 3
@@ -128,9 +111,10 @@ static uint8_t sumdFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 
     sumdFrameDone = false;
 
-    // verify CRC
-    if (crc != ((sumd[SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_HIGH] << 8) |
-            (sumd[SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_LOW])))
+    // verify CRC over header and channel data in one go, the ISR only collects the bytes
+    const uint8_t crcOffset = SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_HIGH;
+    const uint16_t crc = crc16_ccitt_update(0, sumd, crcOffset);
+    if (crc != ((sumd[crcOffset] << 8) | sumd[crcOffset + 1]))
         return frameStatus;
 
     switch (sumd[1]) {
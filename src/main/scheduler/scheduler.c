@@ -27,13 +27,18 @@ FILE_COMPILE_FOR_SPEED
 
 #include "build/build_config.h"
 #include "build/debug.h"
+#include "build/profiling.h"
+#include "build/trace_ring.h"
 
 #include "common/maths.h"
 #include "common/time.h"
 #include "common/utils.h"
 
+#include "drivers/stack_check.h"
 #include "drivers/time.h"
 
+#include "scheduler/protothreads.h"
+
 STATIC_FASTRAM cfTask_t *currentTask = NULL;
 
 STATIC_FASTRAM uint32_t totalWaitingTasks;
@@ -50,11 +55,116 @@ STATIC_FASTRAM_UNIT_TESTED cfTask_t* taskQueueArray[TASK_COUNT + 2]; // 1 extra
 #else
 STATIC_FASTRAM cfTask_t* taskQueueArray[TASK_COUNT + 1]; // extra item for NULL pointer at end of queue
 #endif
+
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+/*
+ * Time-driven tasks (no checkFunc, not realtime) are kept in a min-heap keyed
+ * on their next due time (lastExecutedAt + desiredPeriod). The scheduler only
+ * visits heap nodes that are due, pruning every subtree whose root is not.
+ * Event-driven and realtime tasks are still polled on every pass.
+ */
+STATIC_FASTRAM cfTask_t* timedTaskHeap[TASK_COUNT];
+STATIC_FASTRAM int timedTaskHeapSize = 0;
+STATIC_FASTRAM cfTask_t* polledTaskQueue[TASK_COUNT + 1]; // extra item for NULL pointer at end of queue
+
+static bool isTaskTimeDriven(const cfTask_t *task)
+{
+    return !task->checkFunc && task->staticPriority != TASK_PRIORITY_REALTIME;
+}
+
+static inline timeUs_t taskNextDueAt(const cfTask_t *task)
+{
+    return task->lastExecutedAt + task->desiredPeriod;
+}
+
+static inline bool heapLess(int a, int b)
+{
+    return (timeDelta_t)(taskNextDueAt(timedTaskHeap[a]) - taskNextDueAt(timedTaskHeap[b])) < 0;
+}
+
+static void heapSwap(int a, int b)
+{
+    cfTask_t *tmp = timedTaskHeap[a];
+    timedTaskHeap[a] = timedTaskHeap[b];
+    timedTaskHeap[b] = tmp;
+    timedTaskHeap[a]->heapIndex = a;
+    timedTaskHeap[b]->heapIndex = b;
+}
+
+static void heapSiftDown(int index)
+{
+    while (true) {
+        const int left = 2 * index + 1;
+        const int right = left + 1;
+        int smallest = index;
+
+        if (left < timedTaskHeapSize && heapLess(left, smallest)) {
+            smallest = left;
+        }
+        if (right < timedTaskHeapSize && heapLess(right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        heapSwap(index, smallest);
+        index = smallest;
+    }
+}
+
+// Restore heap order after the due time of the task at index has changed
+static void heapFix(int index)
+{
+    while (index > 0 && heapLess(index, (index - 1) / 2)) {
+        heapSwap(index, (index - 1) / 2);
+        index = (index - 1) / 2;
+    }
+    heapSiftDown(index);
+}
+
+// Called whenever the task queue changes, which only happens at startup or when tasks are enabled/disabled
+static void readyQueueRebuild(void)
+{
+    int polledTaskCount = 0;
+
+    for (int ii = 0; ii < TASK_COUNT; ii++) {
+        cfTasks[ii].heapIndex = -1;
+    }
+
+    timedTaskHeapSize = 0;
+    for (int ii = 0; ii < taskQueueSize; ii++) {
+        cfTask_t *task = taskQueueArray[ii];
+        task->queuePosition = ii;
+        if (isTaskTimeDriven(task)) {
+            task->heapIndex = timedTaskHeapSize;
+            timedTaskHeap[timedTaskHeapSize++] = task;
+        } else {
+            polledTaskQueue[polledTaskCount++] = task;
+        }
+    }
+    polledTaskQueue[polledTaskCount] = NULL;
+
+    for (int ii = timedTaskHeapSize / 2 - 1; ii >= 0; ii--) {
+        heapSiftDown(ii);
+    }
+}
+
+static inline bool isTaskPreferred(const cfTask_t *task, const cfTask_t *selectedTask, uint16_t selectedTaskDynamicPriority)
+{
+    // Same ordering as a linear scan over the priority-ordered queue: highest dynamic priority, earliest queue position on a tie
+    return task->dynamicPriority > selectedTaskDynamicPriority ||
+           (selectedTask && task->dynamicPriority == selectedTaskDynamicPriority && task->queuePosition < selectedTask->queuePosition);
+}
+#endif
+
 STATIC_UNIT_TESTED void queueClear(void)
 {
     memset(taskQueueArray, 0, sizeof(taskQueueArray));
     taskQueuePos = 0;
     taskQueueSize = 0;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+    readyQueueRebuild();
+#endif
 }
 
 #ifdef UNIT_TEST
@@ -84,6 +194,9 @@ STATIC_UNIT_TESTED bool queueAdd(cfTask_t *task)
             memmove(&taskQueueArray[ii+1], &taskQueueArray[ii], sizeof(task) * (taskQueueSize - ii));
             taskQueueArray[ii] = task;
             ++taskQueueSize;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+            readyQueueRebuild();
+#endif
             return true;
         }
     }
@@ -96,6 +209,9 @@ STATIC_UNIT_TESTED bool queueRemove(cfTask_t *task)
         if (taskQueueArray[ii] == task) {
             memmove(&taskQueueArray[ii], &taskQueueArray[ii+1], sizeof(task) * (taskQueueSize - ii));
             --taskQueueSize;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+            readyQueueRebuild();
+#endif
             return true;
         }
     }
@@ -129,6 +245,10 @@ void taskSystem(timeUs_t currentTimeUs)
         totalWaitingTasksSamples = 0;
         totalWaitingTasks = 0;
     }
+
+#ifdef USE_PROFILING_ZONES
+    profilingZonesRotate();
+#endif
 }
 
 #define TASK_MOVING_SUM_COUNT           32
@@ -136,6 +256,75 @@ FASTRAM timeUs_t checkFuncMaxExecutionTime;
 FASTRAM timeUs_t checkFuncTotalExecutionTime;
 FASTRAM timeUs_t checkFuncMovingSumExecutionTime;
 
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+STATIC_FASTRAM cfTaskHistogram_t taskHistograms[TASK_COUNT];
+
+static void taskHistogramAdd(uint16_t *histogram, timeDelta_t valueUs)
+{
+    const int bucket = valueUs > 0 ? MIN(32 - __builtin_clz(valueUs), SCHEDULER_HISTOGRAM_BUCKETS - 1) : 0;
+
+    // On saturation halve all buckets, this keeps the shape of the distribution and favours recent samples
+    if (histogram[bucket] == UINT16_MAX) {
+        for (int ii = 0; ii < SCHEDULER_HISTOGRAM_BUCKETS; ii++) {
+            histogram[ii] /= 2;
+        }
+    }
+    histogram[bucket]++;
+}
+
+const cfTaskHistogram_t *getTaskHistogram(cfTaskId_e taskId)
+{
+    return taskId < TASK_COUNT ? &taskHistograms[taskId] : NULL;
+}
+#endif
+
+STATIC_FASTRAM cfSchedulerSample_t schedulerSample;
+
+void schedulerGetSample(cfSchedulerSample_t *sample)
+{
+    *sample = schedulerSample;
+    sample->systemLoadPercent = averageSystemLoadPercent;
+
+    schedulerSample.maxLateness = 0;
+    schedulerSample.maxExecutionTime = 0;
+    schedulerSample.checkFuncMaxExecutionTime = 0;
+}
+
+#ifdef STACK_CHECK
+#define STACK_SAMPLE_INTERVAL_US        50000
+
+/*
+ * Stack high-water per task. The tasks take turns: when the sampled task is
+ * picked the unused stack is repainted, and the touched depth is measured when
+ * it returns. Repainting and scanning cost about a stack size of memory
+ * accesses, so only one task run is sampled every STACK_SAMPLE_INTERVAL_US.
+ */
+STATIC_FASTRAM cfTaskId_e stackSampleTaskId;
+STATIC_FASTRAM timeUs_t stackSampleDueAt;
+
+static bool stackSampleBegin(cfTask_t *task, timeUs_t currentTimeUs)
+{
+    if (task != &cfTasks[stackSampleTaskId] || cmpTimeUs(currentTimeUs, stackSampleDueAt) < 0) {
+        return false;
+    }
+
+    stackPaintUnused();
+    return true;
+}
+
+static void stackSampleEnd(cfTask_t *task, timeUs_t currentTimeUs)
+{
+    task->stackHighWater = MAX(task->stackHighWater, MIN(stackMeasureUsed(), (uint32_t)UINT16_MAX));
+
+    // Move on to the next task in the queue
+    do {
+        stackSampleTaskId = (stackSampleTaskId + 1) % TASK_COUNT;
+    } while (!queueContains(&cfTasks[stackSampleTaskId]));
+
+    stackSampleDueAt = currentTimeUs + STACK_SAMPLE_INTERVAL_US;
+}
+#endif
+
 void getCheckFuncInfo(cfCheckFuncInfo_t *checkFuncInfo)
 {
     checkFuncInfo->maxExecutionTime = checkFuncMaxExecutionTime;
@@ -153,6 +342,9 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->totalExecutionTime = cfTasks[taskId].totalExecutionTime;
     taskInfo->averageExecutionTime = cfTasks[taskId].movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
+#ifdef STACK_CHECK
+    taskInfo->stackHighWater = cfTasks[taskId].stackHighWater;
+#endif
 }
 
 void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs)
@@ -160,9 +352,19 @@ void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs)
     if (taskId == TASK_SELF) {
         cfTask_t *task = currentTask;
         task->desiredPeriod = MAX(SCHEDULER_DELAY_LIMIT, newPeriodUs);  // Limit delay to 100us (10 kHz) to prevent scheduler clogging
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+        if (task->heapIndex >= 0) {
+            heapFix(task->heapIndex);
+        }
+#endif
     } else if (taskId < TASK_COUNT) {
         cfTask_t *task = &cfTasks[taskId];
         task->desiredPeriod = MAX(SCHEDULER_DELAY_LIMIT, newPeriodUs);  // Limit delay to 100us (10 kHz) to prevent scheduler clogging
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+        if (task->heapIndex >= 0) {
+            heapFix(task->heapIndex);
+        }
+#endif
     }
 }
 
@@ -195,12 +397,77 @@ void schedulerResetTaskStatistics(cfTaskId_e taskId)
         currentTask->movingSumExecutionTime = 0;
         currentTask->totalExecutionTime = 0;
         currentTask->maxExecutionTime = 0;
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        memset(&taskHistograms[currentTask - cfTasks], 0, sizeof(cfTaskHistogram_t));
+#endif
     } else if (taskId < TASK_COUNT) {
         cfTasks[taskId].movingSumExecutionTime = 0;
         cfTasks[taskId].totalExecutionTime = 0;
         cfTasks[taskId].totalExecutionTime = 0;
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        memset(&taskHistograms[taskId], 0, sizeof(cfTaskHistogram_t));
+#endif
+    }
+}
+
+#ifdef USE_SCHEDULER_IDLE_JOBS
+typedef struct {
+    void (*run)(void);
+    struct ptState_s *state;
+} schedulerIdleJob_t;
+
+STATIC_FASTRAM schedulerIdleJob_t idleJobs[SCHEDULER_IDLE_JOB_COUNT];
+STATIC_FASTRAM uint8_t idleJobHead;
+STATIC_FASTRAM uint8_t idleJobCount;
+
+bool schedulerPostIdleJob(void (*run)(void), struct ptState_s *state)
+{
+    for (int ii = 0; ii < idleJobCount; ii++) {
+        if (idleJobs[(idleJobHead + ii) % SCHEDULER_IDLE_JOB_COUNT].run == run) {
+            return true;
+        }
+    }
+
+    if (idleJobCount == SCHEDULER_IDLE_JOB_COUNT) {
+        return false;
+    }
+
+    ptRestart(state);
+    schedulerIdleJob_t *job = &idleJobs[(idleJobHead + idleJobCount) % SCHEDULER_IDLE_JOB_COUNT];
+    job->run = run;
+    job->state = state;
+    idleJobCount++;
+
+    return true;
+}
+
+// Called when no task was due at currentTimeUs
+static void idleJobsRun(timeUs_t currentTimeUs)
+{
+    timeUs_t deadlineUs = currentTimeUs + SCHEDULER_IDLE_SLICE_US;
+
+    for (int ii = 0; ii < taskQueueSize; ii++) {
+        const cfTask_t *task = taskQueueArray[ii];
+        if (task->staticPriority == TASK_PRIORITY_REALTIME && cmpTimeUs(task->lastExecutedAt + task->desiredPeriod, deadlineUs) < 0) {
+            deadlineUs = task->lastExecutedAt + task->desiredPeriod;
+        }
+    }
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+    if (timedTaskHeapSize > 0 && cmpTimeUs(taskNextDueAt(timedTaskHeap[0]), deadlineUs) < 0) {
+        deadlineUs = taskNextDueAt(timedTaskHeap[0]);
+    }
+#endif
+
+    while (idleJobCount > 0 && cmpTimeUs(micros(), deadlineUs) < 0) {
+        schedulerIdleJob_t *job = &idleJobs[idleJobHead];
+        job->run();
+        if (ptIsStopped(job->state)) {
+            idleJobHead = (idleJobHead + 1) % SCHEDULER_IDLE_JOB_COUNT;
+            idleJobCount--;
+        }
     }
 }
+#endif
 
 void schedulerInit(void)
 {
@@ -220,7 +487,12 @@ void FAST_CODE NOINLINE scheduler(void)
 
     // Update task dynamic priorities
     uint16_t waitingTasks = 0;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+    for (cfTask_t **taskPtr = polledTaskQueue; *taskPtr != NULL; taskPtr++) {
+        cfTask_t *task = *taskPtr;
+#else
     for (cfTask_t *task = queueFirst(); task != NULL; task = queueNext()) {
+#endif
         // Task has checkFunc - event driven
         if (task->checkFunc) {
             const timeUs_t currentTimeBeforeCheckFuncCallUs = micros();
@@ -236,6 +508,7 @@ void FAST_CODE NOINLINE scheduler(void)
                 checkFuncMovingSumExecutionTime += checkFuncExecutionTime;
                 checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
                 checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
+                schedulerSample.checkFuncMaxExecutionTime = MAX(schedulerSample.checkFuncMaxExecutionTime, checkFuncExecutionTime);
                 task->lastSignaledAt = currentTimeBeforeCheckFuncCallUs;
                 task->taskAgeCycles = 1;
                 task->dynamicPriority = 1 + task->staticPriority;
@@ -251,7 +524,9 @@ void FAST_CODE NOINLINE scheduler(void)
                 waitingTasks++;
                 forcedRealTimeTask = true;
             }
-        } else {
+        }
+#ifndef USE_SCHEDULER_DEADLINE_QUEUE
+        else {
             // Task is time-driven, dynamicPriority is last execution age (measured in desiredPeriods)
             // Task age is calculated from last execution
             task->taskAgeCycles = ((timeDelta_t)(currentTimeUs - task->lastExecutedAt)) / task->desiredPeriod;
@@ -260,13 +535,54 @@ void FAST_CODE NOINLINE scheduler(void)
                 waitingTasks++;
             }
         }
+#endif
 
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+        if (!forcedRealTimeTask && isTaskPreferred(task, selectedTask, selectedTaskDynamicPriority)) {
+#else
         if (!forcedRealTimeTask && task->dynamicPriority > selectedTaskDynamicPriority) {
+#endif
             selectedTaskDynamicPriority = task->dynamicPriority;
             selectedTask = task;
         }
     }
 
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+    // Visit only the time-driven tasks that are due. Children are never due before
+    // their parent, so the walk stops at the first node in each branch that isn't.
+    int heapStack[TASK_COUNT];
+    int heapStackSize = 0;
+    if (timedTaskHeapSize > 0) {
+        heapStack[heapStackSize++] = 0;
+    }
+    while (heapStackSize > 0) {
+        const int index = heapStack[--heapStackSize];
+        cfTask_t *task = timedTaskHeap[index];
+
+        if ((timeDelta_t)(currentTimeUs - taskNextDueAt(task)) < 0) {
+            continue;
+        }
+
+        // Task is time-driven, dynamicPriority is last execution age (measured in desiredPeriods)
+        task->taskAgeCycles = ((timeDelta_t)(currentTimeUs - task->lastExecutedAt)) / task->desiredPeriod;
+        task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
+        waitingTasks++;
+
+        if (!forcedRealTimeTask && isTaskPreferred(task, selectedTask, selectedTaskDynamicPriority)) {
+            selectedTaskDynamicPriority = task->dynamicPriority;
+            selectedTask = task;
+        }
+
+        const int left = 2 * index + 1;
+        if (left < timedTaskHeapSize) {
+            heapStack[heapStackSize++] = left;
+        }
+        if (left + 1 < timedTaskHeapSize) {
+            heapStack[heapStackSize++] = left + 1;
+        }
+    }
+#endif
+
     totalWaitingTasksSamples++;
     totalWaitingTasks += waitingTasks;
 
@@ -275,16 +591,54 @@ void FAST_CODE NOINLINE scheduler(void)
     if (selectedTask) {
         // Found a task that should be run
         selectedTask->taskLatestDeltaTime = (timeDelta_t)(currentTimeUs - selectedTask->lastExecutedAt);
+        // Event driven tasks are due as soon as their checkFunc signals
+        const timeDelta_t taskLateness = selectedTask->checkFunc ?
+            (timeDelta_t)(currentTimeUs - selectedTask->lastSignaledAt) :
+            selectedTask->taskLatestDeltaTime - selectedTask->desiredPeriod;
+        if (taskLateness > 0 && (timeUs_t)taskLateness > schedulerSample.maxLateness) {
+            schedulerSample.maxLateness = taskLateness;
+            schedulerSample.latestTaskId = selectedTask - cfTasks;
+        }
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        cfTaskHistogram_t *selectedTaskHistogram = &taskHistograms[selectedTask - cfTasks];
+        taskHistogramAdd(selectedTaskHistogram->lateness, taskLateness);
+#endif
         selectedTask->lastExecutedAt = currentTimeUs;
         selectedTask->dynamicPriority = 0;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+        if (selectedTask->heapIndex >= 0) {
+            heapFix(selectedTask->heapIndex);
+        }
+#endif
 
         // Execute task
+#ifdef STACK_CHECK
+        const bool stackSampled = stackSampleBegin(selectedTask, currentTimeUs);
+#endif
         const timeUs_t currentTimeBeforeTaskCall = micros();
+#ifdef USE_TRACE_RING
+        traceRingTaskStart(selectedTask - cfTasks, currentTimeBeforeTaskCall);
+#endif
         selectedTask->taskFunc(currentTimeBeforeTaskCall);
         const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
+#ifdef USE_TRACE_RING
+        traceRingTaskEnd(selectedTask - cfTasks, taskExecutionTime);
+#endif
+#ifdef STACK_CHECK
+        if (stackSampled) {
+            stackSampleEnd(selectedTask, currentTimeUs);
+        }
+#endif
         selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
         selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
         selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
+        if (taskExecutionTime > schedulerSample.maxExecutionTime) {
+            schedulerSample.maxExecutionTime = taskExecutionTime;
+            schedulerSample.slowestTaskId = selectedTask - cfTasks;
+        }
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+        taskHistogramAdd(selectedTaskHistogram->executionTime, taskExecutionTime);
+#endif
     } 
     
     if (!selectedTask || forcedRealTimeTask) {
@@ -297,4 +651,10 @@ void FAST_CODE NOINLINE scheduler(void)
         selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
         selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
     }
+
+#ifdef USE_SCHEDULER_IDLE_JOBS
+    if (!currentTask && idleJobCount > 0) {
+        idleJobsRun(currentTimeUs);
+    }
+#endif
 }
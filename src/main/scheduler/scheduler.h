@@ -44,17 +44,41 @@ typedef struct {
     timeUs_t     totalExecutionTime;
     timeUs_t     averageExecutionTime;
     timeDelta_t     latestDeltaTime;
+#ifdef STACK_CHECK
+    uint16_t     stackHighWater;
+#endif
 } cfTaskInfo_t;
 
+// Worst case timings since the previous sample, for time series logging
+typedef struct {
+    uint16_t    systemLoadPercent;
+    uint8_t     latestTaskId;           // task with the largest lateness in the window
+    uint8_t     slowestTaskId;          // task with the longest execution in the window
+    timeUs_t    maxLateness;
+    timeUs_t    maxExecutionTime;
+    timeUs_t    checkFuncMaxExecutionTime;
+} cfSchedulerSample_t;
+
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+#define SCHEDULER_HISTOGRAM_BUCKETS     16  // bucket 0 holds zero, bucket N holds [2^(N-1), 2^N) us, last bucket is open-ended
+
+typedef struct {
+    uint16_t executionTime[SCHEDULER_HISTOGRAM_BUCKETS];
+    uint16_t lateness[SCHEDULER_HISTOGRAM_BUCKETS];      // actual start minus desired start
+} cfTaskHistogram_t;
+#endif
+
 typedef enum {
     /* Actual tasks */
     TASK_SYSTEM = 0,
     TASK_PID,
     TASK_GYRO,
+    TASK_AHRS,
     TASK_RX,
     TASK_SERIAL,
     TASK_BATTERY,
     TASK_TEMPERATURE,
+    TASK_TELEMETRY_SNAPSHOT,
 #if defined(BEEPER) || defined(USE_DSHOT)
     TASK_BEEPER,
 #endif
@@ -64,6 +88,9 @@ typedef enum {
 #ifdef USE_GPS
     TASK_GPS,
 #endif
+#if defined(USE_ADC) && defined(USE_GPS)
+    TASK_RTH_ESTIMATOR,
+#endif
 #ifdef USE_MAG
     TASK_COMPASS,
 #endif
@@ -111,6 +138,12 @@ typedef enum {
 #endif
 #ifdef USE_RPM_FILTER
     TASK_RPM_FILTER,
+#endif
+#if defined(USE_BLACKBOX) && (defined(USE_SDCARD) || defined(USE_FLASHFS_INDEX))
+    TASK_BLACKBOX_WRITER,
+#endif
+#ifdef USE_AUTOTUNE_FIXED_WING
+    TASK_AUTOTUNE,
 #endif
     TASK_AUX,
 #if defined(USE_SMARTPORT_MASTER)
@@ -121,6 +154,9 @@ typedef enum {
 #endif
 #ifdef USE_SECONDARY_IMU
     TASK_SECONDARY_IMU,
+#endif
+#ifdef USE_SIMULATOR_STREAM
+    TASK_SIMULATOR_STREAM,
 #endif
     /* Count of real tasks */
     TASK_COUNT,
@@ -144,11 +180,18 @@ typedef struct {
     timeUs_t lastExecutedAt;        // last time of invocation
     timeUs_t lastSignaledAt;        // time of invocation event for event-driven tasks
     timeDelta_t taskLatestDeltaTime;
+#ifdef USE_SCHEDULER_DEADLINE_QUEUE
+    int8_t heapIndex;               // position in the deadline heap, -1 for tasks polled on every pass
+    uint8_t queuePosition;          // position in the priority-ordered task queue, used to break priority ties
+#endif
 
     /* Statistics */
     timeUs_t movingSumExecutionTime;  // moving sum over 32 samples
     timeUs_t maxExecutionTime;
     timeUs_t totalExecutionTime;    // total time consumed by task since boot
+#ifdef STACK_CHECK
+    uint16_t stackHighWater;        // deepest stack use seen while sampling this task, interrupts included
+#endif
 } cfTask_t;
 
 extern cfTask_t cfTasks[TASK_COUNT];
@@ -160,6 +203,27 @@ void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs);
 void setTaskEnabled(cfTaskId_e taskId, bool newEnabledState);
 timeDelta_t getTaskDeltaTime(cfTaskId_e taskId);
 void schedulerResetTaskStatistics(cfTaskId_e taskId);
+void schedulerGetSample(cfSchedulerSample_t *sample);
+#ifdef USE_SCHEDULER_TASK_HISTOGRAMS
+const cfTaskHistogram_t *getTaskHistogram(cfTaskId_e taskId);
+#endif
+
+#ifdef USE_SCHEDULER_IDLE_JOBS
+#define SCHEDULER_IDLE_JOB_COUNT    4
+#define SCHEDULER_IDLE_SLICE_US     50      // Longest run of idle jobs in one scheduler pass
+
+struct ptState_s;
+
+/*
+ * A job is a protothread doing a small step per call. Jobs run one after the
+ * other when no task is due, for at most SCHEDULER_IDLE_SLICE_US per pass and
+ * never past the next due realtime or time-driven task. A job is done when its
+ * protothread stops. Returns false when the queue is full, the producer then
+ * does the work itself. Posting a job that is still queued does nothing.
+ */
+bool schedulerPostIdleJob(void (*run)(void), struct ptState_s *state);
+#define schedulerPostIdleProtothread(name) schedulerPostIdleJob(name, ptGetHandle(name))
+#endif
 
 void schedulerInit(void);
 void scheduler(void);
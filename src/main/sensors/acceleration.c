@@ -49,6 +49,7 @@ FILE_COMPILE_FOR_SPEED
 #include "drivers/accgyro/accgyro_icm42605.h"
 #include "drivers/accgyro/accgyro_fake.h"
 #include "drivers/sensor.h"
+#include "drivers/time.h"
 
 #include "fc/config.h"
 #include "fc/runtime_config.h"
@@ -83,7 +84,12 @@ static EXTENDED_FASTRAM pt1Filter_t accVibeFilter[XYZ_AXIS_COUNT];
 static EXTENDED_FASTRAM filterApplyFnPtr accNotchFilterApplyFn;
 static EXTENDED_FASTRAM void *accNotchFilter[XYZ_AXIS_COUNT];
 
-PG_REGISTER_WITH_RESET_FN(accelerometerConfig_t, accelerometerConfig, PG_ACCELEROMETER_CONFIG, 5);
+// Samples of the current output window, in G
+STATIC_FASTRAM float accWindowSum[XYZ_AXIS_COUNT];
+STATIC_FASTRAM float accWindowSumSq[XYZ_AXIS_COUNT];
+STATIC_FASTRAM uint8_t accWindowCount;
+
+PG_REGISTER_WITH_RESET_FN(accelerometerConfig_t, accelerometerConfig, PG_ACCELEROMETER_CONFIG, 6);
 
 void pgResetFn_accelerometerConfig(accelerometerConfig_t *instance)
 {
@@ -92,7 +98,8 @@ void pgResetFn_accelerometerConfig(accelerometerConfig_t *instance)
         .acc_lpf_hz = SETTING_ACC_LPF_HZ_DEFAULT,
         .acc_notch_hz = SETTING_ACC_NOTCH_HZ_DEFAULT,
         .acc_notch_cutoff = SETTING_ACC_NOTCH_CUTOFF_DEFAULT,
-        .acc_soft_lpf_type = SETTING_ACC_LPF_TYPE_DEFAULT
+        .acc_soft_lpf_type = SETTING_ACC_LPF_TYPE_DEFAULT,
+        .acc_output_rate = SETTING_ACC_OUTPUT_RATE_DEFAULT
     );
     RESET_CONFIG_2(flightDynamicsTrims_t, &instance->accZero,
         .raw[X] = SETTING_ACCZERO_X_DEFAULT,
@@ -488,6 +495,14 @@ void accGetMeasuredAcceleration(fpVector3_t *measuredAcc)
     }
 }
 
+/*
+ * Return cm/s/s of the latest sample, without the LPF and notch delay
+ */
+float accGetUnfilteredAcceleration(int axis)
+{
+    return acc.accADCfUnfiltered[axis] * GRAVITY_CMSS;
+}
+
 /*
  * Return g's
  */
@@ -501,17 +516,61 @@ float accGetMeasuredMaxG(void)
     return acc.maxG;
 }
 
-void accUpdate(void)
+/*
+ * Averaged window of samples, low rate side of the pipeline. The boxcar average is the
+ * anti-aliasing filter in front of the decimation, the spread of the samples inside the
+ * window keeps the vibration above the output rate in the vibration level.
+ */
+static void accProcessWindow(void)
+{
+    const float n = accWindowCount;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float mean = accWindowSum[axis] / n;
+        const float windowVariance = MAX(accWindowSumSq[axis] / n - mean * mean, 0.0f);
+
+        acc.accADCf[axis] = mean;
+        acc.accADCfUnfiltered[axis] = mean;
+
+        // filter accel at 5hz
+        const float accFloorFilt = pt1FilterApply(&accVibeFloorFilter[axis], mean);
+
+        // calc difference from this window and 5hz filtered value, square and filter at 2hz
+        const float accDiff = mean - accFloorFilt;
+        acc.accVibeSq[axis] = pt1FilterApply(&accVibeFilter[axis], accDiff * accDiff + windowVariance);
+
+        accWindowSum[axis] = 0.0f;
+        accWindowSumSq[axis] = 0.0f;
+    }
+    accWindowCount = 0;
+
+    // Filter acceleration
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        acc.accADCf[axis] = accSoftLpfFilterApplyFn(accSoftLpfFilter[axis], acc.accADCf[axis]);
+    }
+
+    if (accelerometerConfig()->acc_notch_hz) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.accADCf[axis] = accNotchFilterApplyFn(accNotchFilter[axis], acc.accADCf[axis]);
+        }
+    }
+}
+
+// Returns true when a new output sample is ready in acc.accADCf
+bool accUpdate(void)
 {
 #ifdef USE_SIMULATOR
     if (ARMING_FLAG(SIMULATOR_MODE)) {
         //output: acc.accADCf
         //unused: acc.dev.ADCRaw[], acc.accClipCount, acc.accVibeSq[]
-        return;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.accADCfUnfiltered[axis] = acc.accADCf[axis];
+        }
+        return true;
     }
 #endif
     if (!acc.dev.readFn(&acc.dev)) {
-        return;
+        return false;
     }
 
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
@@ -527,40 +586,32 @@ void accUpdate(void)
     applyBoardAlignment(accADC);
 
     // Calculate acceleration readings in G's
+    float accG[XYZ_AXIS_COUNT];
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        acc.accADCf[axis] = (float)accADC[axis] / acc.dev.acc_1G;
+        accG[axis] = (float)accADC[axis] / acc.dev.acc_1G;
     }
 
-    // Before filtering check for clipping and vibration levels
-    if (fabsf(acc.accADCf[X]) > ACC_CLIPPING_THRESHOLD_G || fabsf(acc.accADCf[Y]) > ACC_CLIPPING_THRESHOLD_G || fabsf(acc.accADCf[Z]) > ACC_CLIPPING_THRESHOLD_G) {
+    // Before averaging check for clipping, a clipped sample stays visible even inside a window
+    if (fabsf(accG[X]) > ACC_CLIPPING_THRESHOLD_G || fabsf(accG[Y]) > ACC_CLIPPING_THRESHOLD_G || fabsf(accG[Z]) > ACC_CLIPPING_THRESHOLD_G) {
         acc.isClipped = true;
         acc.accClipCount++;
     }
-    else {
+    else if (accWindowCount == 0) {
         acc.isClipped = false;
     }
 
-    // Calculate vibration levels
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        // filter accel at 5hz
-        const float accFloorFilt = pt1FilterApply(&accVibeFloorFilter[axis], acc.accADCf[axis]);
-
-        // calc difference from this sample and 5hz filtered value, square and filter at 2hz
-        const float accDiff = acc.accADCf[axis] - accFloorFilt;
-        acc.accVibeSq[axis] = pt1FilterApply(&accVibeFilter[axis], accDiff * accDiff);
+        accWindowSum[axis] += accG[axis];
+        accWindowSumSq[axis] += accG[axis] * accG[axis];
     }
 
-    // Filter acceleration
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        acc.accADCf[axis] = accSoftLpfFilterApplyFn(accSoftLpfFilter[axis], acc.accADCf[axis]);
-    }
-
-    if (accelerometerConfig()->acc_notch_hz) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            acc.accADCf[axis] = accNotchFilterApplyFn(accNotchFilter[axis], acc.accADCf[axis]);
-        }
+    if (++accWindowCount < acc.accDecimation) {
+        return false;
     }
 
+    sensorSampleCapture(&acc.sample, micros(), true);
+    accProcessWindow();
+    return true;
 }
 
 // Record extremes: min/max for each axis and acceleration vector modulus
@@ -610,9 +661,24 @@ void accSetCalibrationValues(void)
 
 void accInitFilters(void)
 {   
+    // The filters run once per output window
+    acc.accDecimation = 1;
+    if (acc.accTargetLooptime && accelerometerConfig()->acc_output_rate) {
+        const uint32_t decimation = (1000000 / accelerometerConfig()->acc_output_rate) / acc.accTargetLooptime;
+        acc.accDecimation = constrain(decimation, 1, UINT8_MAX);
+    }
+    const uint32_t accOutputLooptime = acc.accTargetLooptime * acc.accDecimation;
+    const uint16_t accLpfHz = accOutputLooptime ? MIN(accelerometerConfig()->acc_lpf_hz, 450000 / accOutputLooptime) : 0;
+
+    accWindowCount = 0;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        accWindowSum[axis] = 0.0f;
+        accWindowSumSq[axis] = 0.0f;
+    }
+
     accSoftLpfFilterApplyFn = nullFilterApply;
 
-    if (acc.accTargetLooptime && accelerometerConfig()->acc_lpf_hz) {
+    if (acc.accTargetLooptime && accLpfHz) {
 
         switch (accelerometerConfig()->acc_soft_lpf_type) 
         {
@@ -620,21 +686,21 @@ void accInitFilters(void)
             accSoftLpfFilterApplyFn = (filterApplyFnPtr)pt1FilterApply;
             for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
                 accSoftLpfFilter[axis] = &accFilter[axis].pt1;
-                pt1FilterInit(accSoftLpfFilter[axis], accelerometerConfig()->acc_lpf_hz, acc.accTargetLooptime * 1e-6f);
+                pt1FilterInit(accSoftLpfFilter[axis], accLpfHz, accOutputLooptime * 1e-6f);
             }
             break;
         case FILTER_BIQUAD:
             accSoftLpfFilterApplyFn = (filterApplyFnPtr)biquadFilterApply;
             for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
                 accSoftLpfFilter[axis] = &accFilter[axis].biquad;
-                biquadFilterInitLPF(accSoftLpfFilter[axis], accelerometerConfig()->acc_lpf_hz, acc.accTargetLooptime);
+                biquadFilterInitLPF(accSoftLpfFilter[axis], accLpfHz, accOutputLooptime);
             }
             break;
         }
 
     }
 
-    const float accDt = acc.accTargetLooptime * 1e-6f;
+    const float accDt = accOutputLooptime * 1e-6f;
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         pt1FilterInit(&accVibeFloorFilter[axis], ACC_VIBE_FLOOR_FILT_HZ, accDt);
         pt1FilterInit(&accVibeFilter[axis], ACC_VIBE_FILT_HZ, accDt);
@@ -643,11 +709,12 @@ void accInitFilters(void)
     STATIC_FASTRAM biquadFilter_t accFilterNotch[XYZ_AXIS_COUNT];
     accNotchFilterApplyFn = nullFilterApply;
 
-    if (acc.accTargetLooptime && accelerometerConfig()->acc_notch_hz) {
+    // A notch past the Nyquist frequency of the output rate has nothing left to remove
+    if (acc.accTargetLooptime && accelerometerConfig()->acc_notch_hz && accelerometerConfig()->acc_notch_hz * accOutputLooptime < 450000) {
         accNotchFilterApplyFn = (filterApplyFnPtr)biquadFilterApply;
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             accNotchFilter[axis] = &accFilterNotch[axis];
-            biquadFilterInitNotch(accNotchFilter[axis], acc.accTargetLooptime, accelerometerConfig()->acc_notch_hz, accelerometerConfig()->acc_notch_cutoff);
+            biquadFilterInitNotch(accNotchFilter[axis], accOutputLooptime, accelerometerConfig()->acc_notch_hz, accelerometerConfig()->acc_notch_cutoff);
         }
     }
 
@@ -55,12 +55,15 @@ typedef struct {
 typedef struct acc_s {
     accDev_t dev;
     uint32_t accTargetLooptime;
+    uint8_t accDecimation;          // Samples averaged into each output, 1 when acc runs at the loop rate
     float accADCf[XYZ_AXIS_COUNT]; // acceleration in g
+    float accADCfUnfiltered[XYZ_AXIS_COUNT]; // acceleration in g, before the LPF and notch
     float accVibeSq[XYZ_AXIS_COUNT];
     uint32_t accClipCount;
     bool isClipped;
     acc_extremes_t extremes[XYZ_AXIS_COUNT];
     float maxG;
+    sensorSample_t sample;
 } acc_t;
 
 extern acc_t acc;
@@ -73,6 +76,7 @@ typedef struct accelerometerConfig_s {
     uint8_t acc_notch_hz;                   // Accelerometer notch filter frequency
     uint8_t acc_notch_cutoff;               // Accelerometer notch filter cutoff frequency
     uint8_t acc_soft_lpf_type;              // Accelerometer LPF type 
+    uint16_t acc_output_rate;               // Rate of the averaged acc output in Hz, 0 to filter every sample
 } accelerometerConfig_t;
 
 PG_DECLARE(accelerometerConfig_t, accelerometerConfig);
@@ -81,6 +85,7 @@ bool accInit(uint32_t accTargetLooptime);
 bool accIsCalibrationComplete(void);
 void accStartCalibration(void);
 void accGetMeasuredAcceleration(fpVector3_t *measuredAcc);
+float accGetUnfilteredAcceleration(int axis);
 const acc_extremes_t* accGetMeasuredExtremes(void);
 float accGetMeasuredMaxG(void);
 void updateAccExtremes(void);
@@ -88,7 +93,7 @@ void accGetVibrationLevels(fpVector3_t *accVibeLevels);
 float accGetVibrationLevel(void);
 uint32_t accGetClipCount(void);
 bool accIsClipped(void);
-void accUpdate(void);
+bool accUpdate(void);
 void accSetCalibrationValues(void);
 void accInitFilters(void);
 bool accIsHealthy(void);
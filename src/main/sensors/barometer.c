@@ -47,6 +47,8 @@
 #include "fc/runtime_config.h"
 #include "fc/settings.h"
 
+#include "navigation/navigation.h"
+
 #include "sensors/barometer.h"
 #include "sensors/sensors.h"
 
@@ -58,11 +60,12 @@ baro_t baro;                        // barometer access functions
 
 #ifdef USE_BARO
 
-PG_REGISTER_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 4);
+PG_REGISTER_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 5);
 
 PG_RESET_TEMPLATE(barometerConfig_t, barometerConfig,
     .baro_hardware = SETTING_BARO_HARDWARE_DEFAULT,
-    .baro_calibration_tolerance = SETTING_BARO_CAL_TOLERANCE_DEFAULT
+    .baro_calibration_tolerance = SETTING_BARO_CAL_TOLERANCE_DEFAULT,
+    .baro_adaptive_osr = SETTING_BARO_ADAPTIVE_OSR_DEFAULT,
 );
 
 static zeroCalibrationScalar_t zeroCalibration;
@@ -250,9 +253,31 @@ typedef enum {
     BAROMETER_NEEDS_CALCULATION
 } barometerState_e;
 
+// Vertical speed hysteresis for switching oversampling [cm/s]
+#define BARO_LOW_LATENCY_ENTER_VELOCITY     250
+#define BARO_LOW_LATENCY_EXIT_VELOCITY      150
+
+static baroOversampling_e baroSelectOversampling(baroOversampling_e current)
+{
+    if (!barometerConfig()->baro_adaptive_osr || !ARMING_FLAG(ARMED)) {
+        return BARO_OVERSAMPLING_LOW_NOISE;
+    }
+
+    // Holding altitude is where baro noise shows, climbs and descents are
+    // where conversion latency makes the estimator lag behind
+    const float climbRate = fabsf(getEstimatedActualVelocity(Z));
+
+    if (current == BARO_OVERSAMPLING_LOW_LATENCY) {
+        return climbRate < BARO_LOW_LATENCY_EXIT_VELOCITY ? BARO_OVERSAMPLING_LOW_NOISE : BARO_OVERSAMPLING_LOW_LATENCY;
+    }
+
+    return climbRate > BARO_LOW_LATENCY_ENTER_VELOCITY ? BARO_OVERSAMPLING_LOW_LATENCY : BARO_OVERSAMPLING_LOW_NOISE;
+}
+
 uint32_t baroUpdate(void)
 {
     static barometerState_e state = BAROMETER_NEEDS_SAMPLES;
+    static baroOversampling_e baroOversampling = BARO_OVERSAMPLING_LOW_NOISE;
 
     switch (state) {
         default:
@@ -271,6 +296,16 @@ uint32_t baroUpdate(void)
             if (baro.dev.get_up) {
                 baro.dev.get_up(&baro.dev);
             }
+            // Pressure is an average over the conversion, stamp it with its middle
+            sensorSampleCapture(&baro.sample, micros() - baro.dev.up_delay / 2, true);
+            // Both conversions of the last cycle are complete, safe to change OSR
+            if (baro.dev.set_oversampling) {
+                const baroOversampling_e oversampling = baroSelectOversampling(baroOversampling);
+                if (oversampling != baroOversampling) {
+                    baro.dev.set_oversampling(&baro.dev, oversampling);
+                    baroOversampling = oversampling;
+                }
+            }
             if (baro.dev.start_ut) {
                 baro.dev.start_ut(&baro.dev);
             }
@@ -19,6 +19,7 @@
 
 #include "config/parameter_group.h"
 
+#include "drivers/sensor.h"
 #include "drivers/barometer/barometer.h"
 
 typedef enum {
@@ -43,6 +44,7 @@ typedef struct baro_s {
     int32_t BaroAlt;
     int32_t baroTemperature;            // Use temperature for telemetry
     int32_t baroPressure;               // Use pressure for telemetry
+    sensorSample_t sample;
 } baro_t;
 
 extern baro_t baro;
@@ -52,6 +54,7 @@ extern baro_t baro;
 typedef struct barometerConfig_s {
     uint8_t baro_hardware;                  // Barometer hardware to use
     uint16_t baro_calibration_tolerance;    // Baro calibration tolerance (cm at sea level)
+    uint8_t baro_adaptive_osr;              // Trade oversampling for latency during fast altitude changes
 } barometerConfig_t;
 
 PG_DECLARE(barometerConfig_t, barometerConfig);
@@ -87,6 +87,7 @@ static uint16_t sagCompensatedVBat = 0;         // calculated no load vbat
 static bool powerSupplyImpedanceIsValid = false;
 
 static int16_t amperage = 0;                    // amperage read by current sensor in centiampere (1/100th A)
+static int16_t amperagePeak = 0;                // highest raw amperage seen during the last current meter interval
 static int32_t power = 0;                       // power draw in cW (0.01W resolution)
 static int32_t mAhDrawn = 0;                    // milliampere hours drawn from the battery since start
 static int32_t mWhDrawn = 0;                    // energy (milliWatt hours) drawn from the battery since start
@@ -262,6 +263,13 @@ void activateBatteryProfile(void)
 }
 
 #ifdef USE_ADC
+static uint16_t adcToVBat(uint16_t adcValue)
+{
+    // calculate battery voltage based on ADC reading
+    // result is Vbatt in 0.01V steps. 3.3V = ADC Vref, 0xFFF = 12bit adc, 1100 = 11:1 voltage divider (10k:1k)
+    return (uint64_t)adcValue * batteryMetersConfig()->voltage.scale * ADCVREF / (0xFFF * 1000);
+}
+
 static void updateBatteryVoltage(timeUs_t timeDelta, bool justConnected)
 {
     static pt1Filter_t vbatFilterState;
@@ -269,7 +277,9 @@ static void updateBatteryVoltage(timeUs_t timeDelta, bool justConnected)
     switch (batteryMetersConfig()->voltage.type) {
         case VOLTAGE_SENSOR_ADC:
             {
-                vbat = getVBatSample();
+                adcWindow_t window;
+                adcGetChannelWindow(ADC_BATTERY, &window);
+                vbat = adcToVBat(window.average);
                 break;
             }
 #if defined(USE_ESC_SENSOR)
@@ -435,9 +445,7 @@ bool isBatteryVoltageConfigured(void)
 
 #ifdef USE_ADC
 uint16_t getVBatSample(void) {
-    // calculate battery voltage based on ADC reading
-    // result is Vbatt in 0.01V steps. 3.3V = ADC Vref, 0xFFF = 12bit adc, 1100 = 11:1 voltage divider (10k:1k)
-    return (uint64_t)adcGetChannel(ADC_BATTERY) * batteryMetersConfig()->voltage.scale * ADCVREF / (0xFFF * 1000);
+    return adcToVBat(adcGetChannel(ADC_BATTERY));
 }
 #endif
 
@@ -514,12 +522,22 @@ int16_t getAmperage(void)
     return amperage;
 }
 
-int16_t getAmperageSample(void)
+int16_t getAmperagePeak(void)
 {
-    int32_t microvolts = ((uint32_t)adcGetChannel(ADC_CURRENT) * ADCVREF * 100) / 0xFFF * 10 - (int32_t)batteryMetersConfig()->current.offset * 100;
+    return amperagePeak;
+}
+
+static int16_t adcToAmperage(uint16_t adcValue)
+{
+    int32_t microvolts = ((uint32_t)adcValue * ADCVREF * 100) / 0xFFF * 10 - (int32_t)batteryMetersConfig()->current.offset * 100;
     return microvolts / batteryMetersConfig()->current.scale; // current in 0.01A steps
 }
 
+int16_t getAmperageSample(void)
+{
+    return adcToAmperage(adcGetChannel(ADC_CURRENT));
+}
+
 int32_t getPower(void)
 {
     return power;
@@ -543,7 +561,12 @@ void currentMeterUpdate(timeUs_t timeDelta)
     switch (batteryMetersConfig()->current.type) {
         case CURRENT_SENSOR_ADC:
             {
-                amperage = pt1FilterApply4(&amperageFilterState, getAmperageSample(), AMPERAGE_LPF_FREQ, timeDelta * 1e-6f);
+                // Average over the whole task interval so short punch-outs are
+                // integrated into mAh instead of being aliased away
+                adcWindow_t window;
+                adcGetChannelWindow(ADC_CURRENT, &window);
+                amperage = pt1FilterApply4(&amperageFilterState, adcToAmperage(window.average), AMPERAGE_LPF_FREQ, timeDelta * 1e-6f);
+                amperagePeak = MAX(0, adcToAmperage(window.peak));
                 break;
             }
         case CURRENT_SENSOR_VIRTUAL:
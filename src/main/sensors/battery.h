@@ -86,6 +86,7 @@ uint16_t getPowerSupplyImpedance(void);
 bool isAmperageConfigured(void);
 int16_t getAmperage(void);
 int16_t getAmperageSample(void);
+int16_t getAmperagePeak(void);
 int32_t getPower(void);
 int32_t getMAhDrawn(void);
 int32_t getMWhDrawn(void);
@@ -44,6 +44,7 @@
 #include "drivers/compass/compass_vcm5883.h"
 #include "drivers/compass/compass_mlx90393.h"
 #include "drivers/compass/compass_msp.h"
+#include "drivers/bus.h"
 #include "drivers/io.h"
 #include "drivers/light_led.h"
 #include "drivers/time.h"
@@ -55,6 +56,7 @@
 #include "io/gps.h"
 #include "io/beeper.h"
 
+#include "sensors/battery.h"
 #include "sensors/boardalignment.h"
 #include "sensors/compass.h"
 #include "sensors/gyro.h"
@@ -64,7 +66,7 @@ mag_t mag;                   // mag access functions
 
 #ifdef USE_MAG
 
-PG_REGISTER_WITH_RESET_TEMPLATE(compassConfig_t, compassConfig, PG_COMPASS_CONFIG, 6);
+PG_REGISTER_WITH_RESET_TEMPLATE(compassConfig_t, compassConfig, PG_COMPASS_CONFIG, 7);
 
 PG_RESET_TEMPLATE(compassConfig_t, compassConfig,
     .mag_align = SETTING_ALIGN_MAG_DEFAULT,
@@ -74,6 +76,7 @@ PG_RESET_TEMPLATE(compassConfig_t, compassConfig,
     .mag_to_use = SETTING_MAG_TO_USE_DEFAULT,
 #endif
     .magCalibrationTimeLimit = SETTING_MAG_CALIBRATION_TIME_DEFAULT,
+    .magOnlineCalibration = SETTING_MAG_ONLINE_CAL_DEFAULT,
     .rollDeciDegrees = SETTING_ALIGN_MAG_ROLL_DEFAULT,
     .pitchDeciDegrees = SETTING_ALIGN_MAG_PITCH_DEFAULT,
     .yawDeciDegrees = SETTING_ALIGN_MAG_YAW_DEFAULT,
@@ -82,6 +85,37 @@ PG_RESET_TEMPLATE(compassConfig_t, compassConfig,
 
 static uint8_t magUpdatedAtLeastOnce = 0;
 
+/*
+ * In-flight calibration refinement. Works on samples normalized by the ground
+ * calibration, so the fit starts from the unit sphere and its result is a small
+ * correction on top of magZero/magGain.
+ */
+#define MAG_ONLINE_CAL_FORGETTING       0.998f      // Memory of roughly 500 accepted samples
+#define MAG_ONLINE_CAL_MIN_SAMPLES      200
+#define MAG_ONLINE_CAL_SOLVE_INTERVAL   25          // Accepted samples between solutions
+#define MAG_ONLINE_CAL_MAX_OFFSET       0.5f        // Largest accepted correction, relative to the field magnitude
+#define MAG_ONLINE_CAL_MIN_RADIUS       0.7f
+#define MAG_ONLINE_CAL_MAX_RADIUS       1.4f
+#define MAG_ONLINE_CAL_APPLY_GAIN       0.2f        // Low pass on applied corrections
+#define MAG_CURRENT_COMP_MIN_AMPS       2.0f
+#define MAG_CURRENT_COMP_STEP           0.01f
+
+typedef struct {
+    ellipsoidFitState_t fit;
+    fpVector3_t lastSample;
+    float offset[XYZ_AXIS_COUNT];           // Applied correction, normalized
+    float radius[XYZ_AXIS_COUNT];
+    float currentCoef[XYZ_AXIS_COUNT];      // [LSB/A] hard iron shift caused by battery current
+} magOnlineCalibration_t;
+
+static magOnlineCalibration_t magOnlineCal;
+
+typedef enum {
+    MAG_READ_NEW_SAMPLE,
+    MAG_READ_NO_SAMPLE,         // Background read still running, previous sample stays valid
+    MAG_READ_FAILED,
+} magReadResult_e;
+
 bool compassDetect(magDev_t *dev, magSensor_e magHardwareToUse)
 {
     magSensor_e magHardware = MAG_NONE;
@@ -289,6 +323,137 @@ bool compassDetect(magDev_t *dev, magSensor_e magHardwareToUse)
     return true;
 }
 
+static void compassOnlineCalibrationReset(void)
+{
+    ellipsoidFitReset(&magOnlineCal.fit, MAG_ONLINE_CAL_FORGETTING);
+    vectorZero(&magOnlineCal.lastSample);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magOnlineCal.offset[axis] = 0.0f;
+        magOnlineCal.radius[axis] = 1.0f;
+        magOnlineCal.currentCoef[axis] = 0.0f;
+    }
+}
+
+static void compassOnlineCalibrationSolve(void)
+{
+    float offset[XYZ_AXIS_COUNT];
+    float radius[XYZ_AXIS_COUNT];
+
+    if (!ellipsoidFitSolve(&magOnlineCal.fit, offset, radius)) {
+        return;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (fabsf(offset[axis]) > MAG_ONLINE_CAL_MAX_OFFSET || radius[axis] < MAG_ONLINE_CAL_MIN_RADIUS || radius[axis] > MAG_ONLINE_CAL_MAX_RADIUS) {
+            return;
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magOnlineCal.offset[axis] += MAG_ONLINE_CAL_APPLY_GAIN * (offset[axis] - magOnlineCal.offset[axis]);
+        magOnlineCal.radius[axis] += MAG_ONLINE_CAL_APPLY_GAIN * (radius[axis] - magOnlineCal.radius[axis]);
+    }
+}
+
+/*
+ * Applies ground calibration, the in-flight refinement and the current
+ * compensation to mag.magADC. The fit only takes samples while flying and only
+ * when the field direction moved by more than ~8 degrees since the last one,
+ * like the ground calibration, so cruising straight does not skew it.
+ */
+static void compassApplyOnlineCalibration(void)
+{
+    const float current = isAmperageConfigured() ? getAmperage() / 100.0f : 0.0f;
+    fpVector3_t sample;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        sample.v[axis] = (mag.magADC[axis] - magOnlineCal.currentCoef[axis] * current - compassConfig()->magZero.raw[axis]) / (float)compassConfig()->magGain[axis];
+    }
+
+    if (ARMING_FLAG(ARMED)) {
+        float diffMag = 0;
+        float avgMag = 0;
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float diff = sample.v[axis] - magOnlineCal.lastSample.v[axis];
+            const float sum = sample.v[axis] + magOnlineCal.lastSample.v[axis];
+            diffMag += diff * diff;
+            avgMag += sum * sum / 4.0f;
+        }
+
+        if ((avgMag > 0.01f) && ((diffMag / avgMag) > (0.14f * 0.14f))) {
+            ellipsoidFitPushSample(&magOnlineCal.fit, sample.v);
+            magOnlineCal.lastSample = sample;
+
+            if (magOnlineCal.fit.sampleCount >= MAG_ONLINE_CAL_MIN_SAMPLES && (magOnlineCal.fit.sampleCount % MAG_ONLINE_CAL_SOLVE_INTERVAL) == 0) {
+                compassOnlineCalibrationSolve();
+            }
+        }
+    }
+
+    fpVector3_t corrected;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        corrected.v[axis] = (sample.v[axis] - magOnlineCal.offset[axis]) / magOnlineCal.radius[axis];
+        mag.magADC[axis] = lrintf(corrected.v[axis] * 1024);
+    }
+
+    // Normalized LMS on the magnitude error: a current dependent offset makes the field
+    // magnitude deviate from the fitted one, the deviation direction gives the coefficient.
+    if (ARMING_FLAG(ARMED) && fabsf(current) >= MAG_CURRENT_COMP_MIN_AMPS && magOnlineCal.fit.sampleCount >= MAG_ONLINE_CAL_MIN_SAMPLES) {
+        const float error = vectorNormSquared(&corrected) - 1.0f;
+        float gradient[XYZ_AXIS_COUNT];
+        float gradientNormSq = 1e-6f;
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gradient[axis] = -2.0f * corrected.v[axis] * current / (compassConfig()->magGain[axis] * magOnlineCal.radius[axis]);
+            gradientNormSq += gradient[axis] * gradient[axis];
+        }
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            magOnlineCal.currentCoef[axis] -= MAG_CURRENT_COMP_STEP * error * gradient[axis] / gradientNormSq;
+        }
+    }
+}
+
+/*
+ * Drivers with readAsync get their data registers read in the background: each
+ * run takes the transfer queued by the previous one and queues the next, so the
+ * task never waits for the bus.
+ */
+static magReadResult_e compassRead(void)
+{
+    if (!mag.dev.readAsync) {
+        return mag.dev.read(&mag.dev) ? MAG_READ_NEW_SAMPLE : MAG_READ_FAILED;
+    }
+
+    magReadResult_e result = MAG_READ_NO_SAMPLE;
+
+    switch (busAsyncPoll(mag.dev.busDev)) {
+        case BUS_ASYNC_QUEUED:
+        case BUS_ASYNC_ACTIVE:
+            return MAG_READ_NO_SAMPLE;
+
+        case BUS_ASYNC_DONE:
+            result = mag.dev.readAsyncDecode(&mag.dev) ? MAG_READ_NEW_SAMPLE : MAG_READ_FAILED;
+            break;
+
+        case BUS_ASYNC_FAILED:
+            result = MAG_READ_FAILED;
+            break;
+
+        default:
+            break;
+    }
+
+    // Bus taken by another background transfer, read the usual way rather than skip a sample
+    if (!mag.dev.readAsync(&mag.dev) && result == MAG_READ_NO_SAMPLE) {
+        result = mag.dev.read(&mag.dev) ? MAG_READ_NEW_SAMPLE : MAG_READ_FAILED;
+    }
+
+    return result;
+}
+
 bool compassInit(void)
 {
 #ifdef USE_DUAL_MAG
@@ -331,9 +496,16 @@ bool compassInit(void)
         }
     }
 
+    compassOnlineCalibrationReset();
+
     return ret;
 }
 
+bool compassHasBackgroundRead(void)
+{
+    return mag.dev.readAsync != NULL;
+}
+
 bool compassIsHealthy(void)
 {
     return (mag.magADC[X] != 0) || (mag.magADC[Y] != 0) || (mag.magADC[Z] != 0);
@@ -378,13 +550,22 @@ void compassUpdate(timeUs_t currentTimeUs)
         ENABLE_STATE(COMPASS_CALIBRATED);
     }
 
-    if (!mag.dev.read(&mag.dev)) {
+    const magReadResult_e readResult = compassRead();
+
+    if (readResult == MAG_READ_NO_SAMPLE) {
+        return;
+    }
+
+    if (readResult == MAG_READ_FAILED) {
         mag.magADC[X] = 0;
         mag.magADC[Y] = 0;
         mag.magADC[Z] = 0;
+        sensorSampleCapture(&mag.sample, currentTimeUs, false);
         return;
     }
 
+    sensorSampleCapture(&mag.sample, currentTimeUs, true);
+
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         mag.magADC[axis] = mag.dev.magADCRaw[axis];  // int32_t copy to work with
     }
@@ -449,9 +630,13 @@ void compassUpdate(timeUs_t currentTimeUs)
             }
 
             calStartedAt = 0;
+            compassOnlineCalibrationReset();
             saveConfigAndNotify();
         }
     }
+    else if (compassConfig()->magOnlineCalibration && STATE(COMPASS_CALIBRATED)) {
+        compassApplyOnlineCalibration();
+    }
     else {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             mag.magADC[axis] = (mag.magADC[axis] - compassConfig()->magZero.raw[axis]) * 1024 / compassConfig()->magGain[axis];
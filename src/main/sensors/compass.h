@@ -50,6 +50,7 @@ typedef enum {
 typedef struct mag_s {
     magDev_t dev;
     int32_t magADC[XYZ_AXIS_COUNT];
+    sensorSample_t sample;
 } mag_t;
 
 extern mag_t mag;
@@ -67,6 +68,7 @@ typedef struct compassConfig_s {
     uint8_t mag_to_use;
 #endif
     uint8_t magCalibrationTimeLimit;        // Time for compass calibration (seconds)
+    bool magOnlineCalibration;              // Refine hard/soft iron and current compensation in flight
     int16_t rollDeciDegrees;                // Alignment for external mag on the roll (X) axis (0.1deg)
     int16_t pitchDeciDegrees;               // Alignment for external mag on the pitch (Y) axis (0.1deg)
     int16_t yawDeciDegrees;                 // Alignment for external mag on the yaw (Z) axis (0.1deg)
@@ -74,11 +76,14 @@ typedef struct compassConfig_s {
 
 PG_DECLARE(compassConfig_t, compassConfig);
 
+#define COMPASS_BACKGROUND_READ_RATE_HZ     25      // Task rate when the data registers are read in the background
+
 bool compassDetect(magDev_t *dev, magSensor_e magHardwareToUse);
 bool compassInit(void);
 void compassUpdate(timeUs_t currentTimeUs);
 bool compassIsReady(void);
 bool compassIsHealthy(void);
 bool compassIsCalibrationComplete(void);
+bool compassHasBackgroundRead(void);
 
 #endif
@@ -56,6 +56,12 @@
 #define ESC_SENSOR_BAUDRATE     115200
 #define TELEMETRY_FRAME_SIZE    10
 
+// A motor that has failed to answer this many times in a row is only polled
+// every ESC_RETRY_INTERVAL_MS so a dead ESC can't eat the other motors' slots
+#define ESC_MAX_CONSECUTIVE_FAILURES    3
+#define ESC_RETRY_INTERVAL_MS           500
+#define ESC_RATE_WINDOW_MS              1000
+
 typedef enum {
     ESC_SENSOR_WAIT_STARTUP = 0,
     ESC_SENSOR_READY = 1,
@@ -77,6 +83,11 @@ static int              bufferPosition = 0;
 static escSensorData_t  escSensorData[MAX_SUPPORTED_MOTORS];
 static escSensorData_t  escSensorDataCombined;
 static bool             escSensorDataNeedsUpdate;
+static escSensorStats_t escSensorStats[MAX_SUPPORTED_MOTORS];
+static timeMs_t         escLastPollMs[MAX_SUPPORTED_MOTORS];
+static uint8_t          escConsecutiveFailures[MAX_SUPPORTED_MOTORS];
+static uint16_t         escFramesInWindow[MAX_SUPPORTED_MOTORS];
+static timeMs_t         escRateWindowStartMs;
 
 PG_REGISTER_WITH_RESET_TEMPLATE(escSensorConfig_t, escSensorConfig, PG_ESC_SENSOR_CONFIG, 1);
 PG_RESET_TEMPLATE(escSensorConfig_t, escSensorConfig,
@@ -94,39 +105,82 @@ static int getTelemetryMotorCount(void)
     }
 }
 
-static void escSensorSelectNextMotor(void)
+static void escSensorSelectNextMotor(timeMs_t currentTimeMs)
 {
     if (escSensorConfig()->listenOnly) {
         escSensorMotor = 0;
+        return;
     }
-    else {
-        escSensorMotor = (escSensorMotor + 1) % getTelemetryMotorCount();
+
+    // Poll the motor that has waited longest. Motors which keep failing
+    // are skipped until their retry interval expires, so every responsive
+    // ESC is polled at least once per motorCount slots.
+    const int motorCount = getTelemetryMotorCount();
+    int bestMotor = -1;
+    timeMs_t bestWaitMs = 0;
+
+    for (int i = 1; i <= motorCount; i++) {
+        const int motor = (escSensorMotor + i) % motorCount;
+        const timeMs_t waitMs = currentTimeMs - escLastPollMs[motor];
+
+        if (escConsecutiveFailures[motor] >= ESC_MAX_CONSECUTIVE_FAILURES && waitMs < ESC_RETRY_INTERVAL_MS) {
+            continue;
+        }
+
+        if (bestMotor < 0 || waitMs > bestWaitMs) {
+            bestMotor = motor;
+            bestWaitMs = waitMs;
+        }
     }
+
+    // All motors are backing off, fall back to plain round robin
+    escSensorMotor = (bestMotor >= 0) ? bestMotor : (escSensorMotor + 1) % motorCount;
 }
 
 static void escSensorIncreaseDataAge(void)
 {
+    if (escConsecutiveFailures[escSensorMotor] < UINT8_MAX) {
+        escConsecutiveFailures[escSensorMotor]++;
+    }
+
     if (escSensorData[escSensorMotor].dataAge < ESC_DATA_INVALID) {
         escSensorData[escSensorMotor].dataAge++;
         escSensorDataNeedsUpdate = true;
     }
 }
 
-static bool escSensorDecodeFrame(void)
+static void escSensorUpdateRates(timeMs_t currentTimeMs)
 {
-    // Receive bytes
-    while (serialRxBytesWaiting(escSensorPort) > 0) {
-        uint8_t c = serialRead(escSensorPort);
+    const timeMs_t windowMs = currentTimeMs - escRateWindowStartMs;
 
-        if (bufferPosition < TELEMETRY_FRAME_SIZE) {
-            telemetryBuffer[bufferPosition++] = c;
-        }
+    if (windowMs < ESC_RATE_WINDOW_MS) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        escSensorStats[i].rateHz = (uint32_t)escFramesInWindow[i] * 1000 / windowMs;
+        escFramesInWindow[i] = 0;
+    }
+
+    escRateWindowStartMs = currentTimeMs;
+}
+
+static escSensorFrameStatus_t escSensorDecodeFrame(void)
+{
+    // Only touch the RX buffer once a whole frame has arrived
+    const uint32_t bytesWaiting = serialRxBytesWaiting(escSensorPort);
+    if (bufferPosition + bytesWaiting < TELEMETRY_FRAME_SIZE) {
+        return ESC_SENSOR_FRAME_PENDING;
     }
 
+    bufferPosition += serialReadBuf(escSensorPort, &telemetryBuffer[bufferPosition], TELEMETRY_FRAME_SIZE - bufferPosition);
+
     // Decode frame
     if (bufferPosition >= TELEMETRY_FRAME_SIZE) {
         uint8_t checksum = crc8_update(0, telemetryBuffer, TELEMETRY_FRAME_SIZE - 1);
         if (checksum == telemetryBuffer[TELEMETRY_FRAME_SIZE - 1]) {
+            escConsecutiveFailures[escSensorMotor] = 0;
+            escFramesInWindow[escSensorMotor]++;
             escSensorData[escSensorMotor].dataAge       = 0;
             escSensorData[escSensorMotor].temperature   = telemetryBuffer[0];
             escSensorData[escSensorMotor].voltage       = ((uint16_t)telemetryBuffer[1]) << 8 | telemetryBuffer[2];
@@ -138,6 +192,9 @@ static bool escSensorDecodeFrame(void)
         }
         else {
             // CRC error
+            if (escSensorStats[escSensorMotor].crcErrors < UINT16_MAX) {
+                escSensorStats[escSensorMotor].crcErrors++;
+            }
             return ESC_SENSOR_FRAME_FAILED;
         }
     }
@@ -154,6 +211,11 @@ escSensorData_t NOINLINE * getEscTelemetry(uint8_t esc)
     return &escSensorData[esc];
 }
 
+const escSensorStats_t * escSensorGetStats(uint8_t esc)
+{
+    return &escSensorStats[esc];
+}
+
 escSensorData_t * escSensorGetData(void)
 {
     if (!escSensorPort) {
@@ -226,6 +288,10 @@ bool escSensorInitialize(void)
 
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         escSensorData[i].dataAge = ESC_DATA_INVALID;
+        escSensorStats[i] = (escSensorStats_t){ 0 };
+        escLastPollMs[i] = 0;
+        escConsecutiveFailures[i] = 0;
+        escFramesInWindow[i] = 0;
     }
 
     ENABLE_STATE(ESC_SENSOR_ENABLED);
@@ -241,10 +307,13 @@ void escSensorUpdate(timeUs_t currentTimeUs)
 
     const timeMs_t currentTimeMs = currentTimeUs / 1000;
 
+    escSensorUpdateRates(currentTimeMs);
+
     switch (escSensorState) {
         case ESC_SENSOR_WAIT_STARTUP:
             if (currentTimeMs > ESC_BOOTTIME_MS) {
                 escSensorMotor = 0;
+                escRateWindowStartMs = currentTimeMs;
                 escSensorState = ESC_SENSOR_READY;
             }
             break;
@@ -253,7 +322,13 @@ void escSensorUpdate(timeUs_t currentTimeUs)
             if (!escSensorConfig()->listenOnly) {
                 pwmRequestMotorTelemetry(escSensorMotor);
             }
+            // Drop anything left over from the previous motor so the next
+            // frame starts on a boundary
+            while (serialRxBytesWaiting(escSensorPort) > 0) {
+                serialRead(escSensorPort);
+            }
             bufferPosition = 0;
+            escLastPollMs[escSensorMotor] = currentTimeMs;
             escTriggerTimeMs = currentTimeMs;
             escSensorState = ESC_SENSOR_WAITING;
             break;
@@ -261,8 +336,11 @@ void escSensorUpdate(timeUs_t currentTimeUs)
         case ESC_SENSOR_WAITING:
             if ((currentTimeMs - escTriggerTimeMs) >= ESC_REQUEST_TIMEOUT_MS) {
                 // Timed out. Select next motor and move on
+                if (escSensorStats[escSensorMotor].timeouts < UINT16_MAX) {
+                    escSensorStats[escSensorMotor].timeouts++;
+                }
                 escSensorIncreaseDataAge();
-                escSensorSelectNextMotor();
+                escSensorSelectNextMotor(currentTimeMs);
                 escSensorState = ESC_SENSOR_READY;
             }
             else {
@@ -271,13 +349,13 @@ void escSensorUpdate(timeUs_t currentTimeUs)
 
                 switch (status) {
                     case ESC_SENSOR_FRAME_COMPLETE:
-                        escSensorSelectNextMotor();
+                        escSensorSelectNextMotor(currentTimeMs);
                         escSensorState = ESC_SENSOR_READY;
                         break;
 
                     case ESC_SENSOR_FRAME_FAILED:
                         escSensorIncreaseDataAge();
-                        escSensorSelectNextMotor();
+                        escSensorSelectNextMotor(currentTimeMs);
                         escSensorState = ESC_SENSOR_READY;
                         break;
 
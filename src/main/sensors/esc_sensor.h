@@ -32,6 +32,12 @@ typedef struct {
     uint32_t rpm;
 } escSensorData_t;
 
+typedef struct {
+    uint16_t rateHz;        // Valid frames per second over the last window
+    uint16_t crcErrors;
+    uint16_t timeouts;
+} escSensorStats_t;
+
 typedef struct escSensorConfig_s {
     uint16_t currentOffset;             // offset consumed by the flight controller / VTX / cam / ... in mA
     uint8_t  listenOnly;
@@ -47,4 +53,5 @@ bool escSensorInitialize(void);
 void escSensorUpdate(timeUs_t currentTimeUs);
 escSensorData_t * escSensorGetData(void);
 escSensorData_t * getEscTelemetry(uint8_t esc);
+const escSensorStats_t * escSensorGetStats(uint8_t esc);
 uint32_t computeRpm(int16_t erpm);
@@ -51,8 +51,10 @@ FILE_COMPILE_FOR_SPEED
 #include "drivers/accgyro/accgyro_icm42605.h"
 #include "drivers/accgyro/accgyro_fake.h"
 #include "drivers/io.h"
+#include "drivers/time.h"
 
 #include "fc/config.h"
+#include "fc/load_shedding.h"
 #include "fc/runtime_config.h"
 #include "fc/rc_controls.h"
 #include "fc/settings.h"
@@ -76,27 +78,78 @@ FILE_COMPILE_FOR_SPEED
 
 FASTRAM gyro_t gyro; // gyro sensor object
 
+#ifdef USE_DUAL_GYRO
+#define MAX_GYRO_COUNT 2
+#else
 #define MAX_GYRO_COUNT 1
+#endif
 
 STATIC_UNIT_TESTED gyroDev_t gyroDev[MAX_GYRO_COUNT];  // Not in FASTRAM since it may hold DMA buffers
 STATIC_FASTRAM int16_t gyroTemperature[MAX_GYRO_COUNT];
 STATIC_FASTRAM_UNIT_TESTED zeroCalibrationVector_t gyroCalibration[MAX_GYRO_COUNT];
 
-STATIC_FASTRAM filterApplyFnPtr gyroLpfApplyFn;
+#ifdef USE_DUAL_GYRO
+#define GYRO_SENSOR_TAG_COUNT           3       // gyro_to_use range
+#define GYRO_FAILED_READ_LIMIT          100     // Consecutive failed bus reads before a gyro is dropped
+#define GYRO_STUCK_SAMPLE_LIMIT         200     // Consecutive identical raw samples before a gyro is dropped
+#define GYRO_SATURATED_SAMPLE_LIMIT     200     // Consecutive saturated samples (while the other gyro is not) before a gyro is dropped
+#define GYRO_STUCK_MIN_NOISE            0.5f    // [LSB] Calibration noise above which identical samples can only mean a stuck sensor
+
+typedef struct {
+    bool failed;                                // Latched until reboot, gyro no longer takes part in fusion
+    bool noiseChecked;                          // Calibration noise was evaluated for the stuck sample check
+    bool stuckCheckEnabled;
+    uint16_t failedReads;
+    uint16_t stuckSamples;
+    uint16_t saturatedSamples;
+    int16_t lastRaw[XYZ_AXIS_COUNT];
+} gyroHealth_t;
+
+STATIC_FASTRAM uint8_t gyroCount;
+STATIC_FASTRAM gyroHealth_t gyroHealth[MAX_GYRO_COUNT];
+#endif
+
+STATIC_FASTRAM filterApplyAxesFnPtr gyroLpfApplyFn;
 STATIC_FASTRAM filter_t gyroLpfState[XYZ_AXIS_COUNT];
 
-STATIC_FASTRAM filterApplyFnPtr gyroLpf2ApplyFn;
+#define GYRO_CLIP_MARGIN                8       // [LSB] Raw samples this close to the int16 limits are treated as clipped
+#define GYRO_CLIP_HOLD_US               500000  // GYRO_CLIPPING state is kept this long after the last clipped sample
+
+STATIC_FASTRAM uint32_t gyroClipHoldSamples;
+STATIC_FASTRAM uint32_t gyroClipHoldCounter;
+
+/*
+ * Anti-aliased gyro samples at sensor rate, written by gyroUpdate() and decimated by gyroFilter()
+ * at PID rate. Counters are free running, so the PID loop knows exactly how many samples it got
+ */
+typedef struct {
+    float samples[GYRO_DECIMATION_BUFFER_SIZE][XYZ_AXIS_COUNT];
+    uint32_t writeCount;
+    uint32_t readCount;
+} gyroDecimator_t;
+
+STATIC_FASTRAM gyroDecimator_t gyroDecimator;
+
+STATIC_FASTRAM filterApplyAxesFnPtr gyroLpf2ApplyFn;
 STATIC_FASTRAM filter_t gyroLpf2State[XYZ_AXIS_COUNT];
+STATIC_FASTRAM float gyroLpf2DynamicCutoff;
+
+#define GYRO_DYN_LPF_MIN_STEP_HZ        1.0f    // Biquad cutoff has 1Hz resolution, smaller changes are not worth the coefficient update
 
 #ifdef USE_DYNAMIC_FILTERS
 
+#ifdef STM32H7
+// EXTENDED_FASTRAM is a no-op on H7, keep the FFT window buffers in DTCM
+FASTRAM gyroAnalyseState_t gyroAnalyseState;
+#else
 EXTENDED_FASTRAM gyroAnalyseState_t gyroAnalyseState;
+#endif
 EXTENDED_FASTRAM dynamicGyroNotchState_t dynamicGyroNotchState;
 EXTENDED_FASTRAM secondaryDynamicGyroNotchState_t secondaryDynamicGyroNotchState;
 
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 5);
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 10);
 
 PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .gyro_lpf = SETTING_GYRO_HARDWARE_LPF_DEFAULT,
@@ -106,6 +159,7 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .looptime = SETTING_LOOPTIME_DEFAULT,
 #ifdef USE_DUAL_GYRO
     .gyro_to_use = SETTING_GYRO_TO_USE_DEFAULT,
+    .gyroFusion = SETTING_GYRO_FUSION_DEFAULT,
 #endif
     .gyro_main_lpf_hz = SETTING_GYRO_MAIN_LPF_HZ_DEFAULT,
     .gyro_main_lpf_type = SETTING_GYRO_MAIN_LPF_TYPE_DEFAULT,
@@ -119,6 +173,9 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .dynamicGyroNotchEnabled = SETTING_DYNAMIC_GYRO_NOTCH_ENABLED_DEFAULT,
     .dynamicGyroNotchMode = SETTING_DYNAMIC_GYRO_NOTCH_MODE_DEFAULT,
     .dynamicGyroNotch3dQ = SETTING_DYNAMIC_GYRO_NOTCH_3D_Q_DEFAULT,
+    .dynamicGyroNotchFftSize = SETTING_DYNAMIC_GYRO_NOTCH_FFT_SIZE_DEFAULT,
+    .dynamicGyroNotchFftAveraging = SETTING_DYNAMIC_GYRO_NOTCH_FFT_AVERAGING_DEFAULT,
+    .dynamicGyroNotchEngine = SETTING_DYNAMIC_GYRO_NOTCH_ENGINE_DEFAULT,
 #endif
 #ifdef USE_GYRO_KALMAN
     .kalman_q = SETTING_SETPOINT_KALMAN_Q_DEFAULT,
@@ -127,6 +184,12 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .init_gyro_cal_enabled = SETTING_INIT_GYRO_CAL_DEFAULT,
     .gyro_zero_cal = {SETTING_GYRO_ZERO_X_DEFAULT, SETTING_GYRO_ZERO_Y_DEFAULT, SETTING_GYRO_ZERO_Z_DEFAULT},
     .gravity_cmss_cal = SETTING_INS_GRAVITY_CMSS_DEFAULT,
+#ifdef USE_MPU_DATA_READY_SIGNAL
+    .gyroSync = SETTING_GYRO_SYNC_DEFAULT,
+#endif
+#ifdef USE_GYRO_FIFO_BURST_READ
+    .gyroFifo = SETTING_GYRO_FIFO_DEFAULT,
+#endif
 );
 
 STATIC_UNIT_TESTED gyroSensor_e gyroDetect(gyroDev_t *dev, gyroSensor_e gyroHardware)
@@ -226,20 +289,20 @@ STATIC_UNIT_TESTED gyroSensor_e gyroDetect(gyroDev_t *dev, gyroSensor_e gyroHard
     return gyroHardware;
 }
 
-static void initGyroFilter(filterApplyFnPtr *applyFn, filter_t state[], uint8_t type, uint16_t cutoff, uint32_t looptime)
+static void initGyroFilter(filterApplyAxesFnPtr *applyFn, filter_t state[], uint8_t type, uint16_t cutoff, uint32_t looptime)
 {
-    *applyFn = nullFilterApply;
+    *applyFn = nullFilterApplyAxes;
     if (cutoff > 0) {
         switch (type)
         {
             case FILTER_PT1:
-                *applyFn = (filterApplyFnPtr)pt1FilterApply;
+                *applyFn = pt1FilterApplyAxes;
                 for (int axis = 0; axis < 3; axis++) {
                     pt1FilterInit(&state[axis].pt1, cutoff, looptime * 1e-6f);
                 }
                 break;
             case FILTER_BIQUAD:
-                *applyFn = (filterApplyFnPtr)biquadFilterApply;
+                *applyFn = biquadFilterApplyAxes;
                 for (int axis = 0; axis < 3; axis++) {
                     biquadFilterInitLPF(&state[axis].biquad, cutoff, looptime);
                 }
@@ -248,13 +311,72 @@ static void initGyroFilter(filterApplyFnPtr *applyFn, filter_t state[], uint8_t
     }
 }
 
+// Interval between samples seen by the anti-aliasing LPF. In FIFO mode this is the sensor ODR, not the gyro task rate
+static uint32_t gyroGetSampleIntervalUs(void)
+{
+#ifdef USE_GYRO_FIFO_BURST_READ
+    if (gyroDev[0].fifoEnabled) {
+        return gyroDev[0].sampleRateIntervalUs;
+    }
+#endif
+    return getGyroLooptime();
+}
+
+static void gyroInitDecimator(void)
+{
+    memset(&gyroDecimator, 0, sizeof(gyroDecimator));
+
+    // PID loop consumes a boxcar average of exactly this many anti-aliased samples
+    const uint32_t sampleIntervalUs = gyroGetSampleIntervalUs();
+    gyro.decimationRatio = constrain((getLooptime() + sampleIntervalUs / 2) / sampleIntervalUs, 1, GYRO_DECIMATION_BUFFER_SIZE);
+}
+
+static void FAST_CODE gyroDecimatorPush(const float * gyroADCf)
+{
+    float * sample = gyroDecimator.samples[gyroDecimator.writeCount % GYRO_DECIMATION_BUFFER_SIZE];
+    sample[X] = gyroADCf[X];
+    sample[Y] = gyroADCf[Y];
+    sample[Z] = gyroADCf[Z];
+    gyroDecimator.writeCount++;
+}
+
+// Returns false if no sample was ever written, gyroADCf is left untouched then
+static bool FAST_CODE gyroDecimatorRead(float * gyroADCf)
+{
+    const uint32_t writeCount = gyroDecimator.writeCount;
+    const uint32_t newSamples = writeCount - gyroDecimator.readCount;
+    gyroDecimator.readCount = writeCount;
+    gyro.pidSampleCount = MIN(newSamples, (uint32_t)UINT8_MAX);
+
+    const uint32_t sampleCount = MIN(writeCount, (uint32_t)gyro.decimationRatio);
+    if (sampleCount == 0) {
+        return false;
+    }
+
+    float sum[XYZ_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f };
+    for (uint32_t i = writeCount - sampleCount; i != writeCount; i++) {
+        const float * sample = gyroDecimator.samples[i % GYRO_DECIMATION_BUFFER_SIZE];
+        sum[X] += sample[X];
+        sum[Y] += sample[Y];
+        sum[Z] += sample[Z];
+    }
+
+    const float scale = 1.0f / sampleCount;
+    gyroADCf[X] = sum[X] * scale;
+    gyroADCf[Y] = sum[Y] * scale;
+    gyroADCf[Z] = sum[Z] * scale;
+
+    return true;
+}
+
 static void gyroInitFilters(void)
 {
     //First gyro LPF running at full gyro frequency 8kHz
-    initGyroFilter(&gyroLpfApplyFn, gyroLpfState, gyroConfig()->gyro_anti_aliasing_lpf_type, gyroConfig()->gyro_anti_aliasing_lpf_hz, getGyroLooptime());
+    initGyroFilter(&gyroLpfApplyFn, gyroLpfState, gyroConfig()->gyro_anti_aliasing_lpf_type, gyroConfig()->gyro_anti_aliasing_lpf_hz, gyroGetSampleIntervalUs());
 
     //Second gyro LPF runnig and PID frequency - this filter is dynamic when gyro_use_dyn_lpf = ON
     initGyroFilter(&gyroLpf2ApplyFn, gyroLpf2State, gyroConfig()->gyro_main_lpf_type, gyroConfig()->gyro_main_lpf_hz, getLooptime());
+    gyroLpf2DynamicCutoff = gyroConfig()->gyro_main_lpf_hz;
 
 #ifdef USE_GYRO_KALMAN
     if (gyroConfig()->kalmanEnabled) {
@@ -263,6 +385,34 @@ static void gyroInitFilters(void)
 #endif
 }
 
+#ifdef USE_DUAL_GYRO
+static void gyroInitSecondary(void)
+{
+    gyroDev_t *dev = &gyroDev[1];
+
+    // First other IMU of the target becomes the secondary gyro
+    for (uint8_t tag = 0; tag < GYRO_SENSOR_TAG_COUNT; tag++) {
+        if (tag == gyroDev[0].imuSensorToUse) {
+            continue;
+        }
+
+        dev->imuSensorToUse = tag;
+        if (gyroDetect(dev, GYRO_AUTODETECT) == GYRO_NONE) {
+            continue;
+        }
+
+        dev->lpf = gyroConfig()->gyro_lpf;
+        dev->requestedSampleIntervalUs = TASK_GYRO_LOOPTIME;
+        dev->sampleRateIntervalUs = TASK_GYRO_LOOPTIME;
+        dev->initFn(dev);
+
+        gyroCount = 2;
+        LOG_I(GYRO, "Gyro fusion with IMU %d", tag);
+        return;
+    }
+}
+#endif
+
 bool gyroInit(void)
 {
     memset(&gyro, 0, sizeof(gyro));
@@ -291,12 +441,35 @@ bool gyroInit(void)
     gyroDev[0].lpf = gyroConfig()->gyro_lpf;
     gyroDev[0].requestedSampleIntervalUs = TASK_GYRO_LOOPTIME;
     gyroDev[0].sampleRateIntervalUs = TASK_GYRO_LOOPTIME;
+#ifdef USE_GYRO_FIFO_BURST_READ
+    gyroDev[0].fifoRequested = gyroConfig()->gyroFifo;
+#ifdef USE_DUAL_GYRO
+    // Fusion pairs one sample of each gyro per cycle, FIFO bursts would not line up
+    gyroDev[0].fifoRequested = gyroDev[0].fifoRequested && !gyroConfig()->gyroFusion;
+#endif
+#endif
     gyroDev[0].initFn(&gyroDev[0]);
 
+#ifdef USE_DUAL_GYRO
+    gyroCount = 1;
+    memset(gyroHealth, 0, sizeof(gyroHealth));
+    if (gyroConfig()->gyroFusion) {
+        gyroInitSecondary();
+    }
+#endif
+
     // initFn will initialize sampleRateIntervalUs to actual gyro sampling rate (if driver supports it). Calculate target looptime using that value
     gyro.targetLooptime = gyroDev[0].sampleRateIntervalUs;
+#ifdef USE_GYRO_FIFO_BURST_READ
+    // Sensor runs at its native ODR and buffers samples, gyro task keeps the requested rate
+    if (gyroDev[0].fifoEnabled) {
+        gyro.targetLooptime = gyroDev[0].requestedSampleIntervalUs;
+    }
+#endif
  
     gyroInitFilters();
+    gyroInitDecimator();
+    gyroClipHoldSamples = GYRO_CLIP_HOLD_US / getGyroLooptime();  // Counted per gyro task, not per FIFO sample
 
 #ifdef USE_DYNAMIC_FILTERS
     // Dynamic notch running at PID frequency
@@ -307,6 +480,9 @@ bool gyroInit(void)
     gyroDataAnalyseStateInit(
         &gyroAnalyseState,
         gyroConfig()->dynamicGyroNotchMinHz,
+        FFT_WINDOW_SIZE_MIN << gyroConfig()->dynamicGyroNotchFftSize,
+        gyroConfig()->dynamicGyroNotchFftAveraging,
+        gyroConfig()->dynamicGyroNotchEngine,
         getLooptime()
     );
 #endif
@@ -319,6 +495,15 @@ void gyroStartCalibration(void)
         return;
     }
 
+#ifdef USE_DUAL_GYRO
+    // Secondary gyro has no stored zero, it is calibrated on every start
+    for (int i = 1; i < gyroCount; i++) {
+        gyroHealth[i].noiseChecked = false;
+        zeroCalibrationStartV(&gyroCalibration[i], CALIBRATING_GYRO_TIME_MS, gyroConfig()->gyroMovementCalibrationThreshold, false);
+    }
+    gyroHealth[0].noiseChecked = false;
+#endif
+
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
     if (!gyroConfig()->init_gyro_cal_enabled) {
         return;
@@ -328,12 +513,50 @@ void gyroStartCalibration(void)
     zeroCalibrationStartV(&gyroCalibration[0], CALIBRATING_GYRO_TIME_MS, gyroConfig()->gyroMovementCalibrationThreshold, false);
 }
 
+void gyroGetCalibration(int16_t *gyroZero)
+{
+    gyroZero[X] = gyroDev[0].gyroZero[X];
+    gyroZero[Y] = gyroDev[0].gyroZero[Y];
+    gyroZero[Z] = gyroDev[0].gyroZero[Z];
+}
+
+/*
+ * Use a zero captured before an unexpected reset instead of calibrating,
+ * the aircraft is not stationary. Secondary gyros have no such zero and are
+ * dropped from fusion until the next reboot.
+ */
+void gyroRestoreCalibration(const int16_t *gyroZero)
+{
+    if (!gyro.initialized) {
+        return;
+    }
+
+#ifdef USE_DUAL_GYRO
+    for (int i = 1; i < gyroCount; i++) {
+        gyroHealth[i].failed = true;
+    }
+#endif
+
+    gyroDev[0].gyroZero[X] = gyroZero[X];
+    gyroDev[0].gyroZero[Y] = gyroZero[Y];
+    gyroDev[0].gyroZero[Z] = gyroZero[Z];
+    gyroCalibration[0].params.state = ZERO_CALIBRATION_DONE;
+}
+
 bool gyroIsCalibrationComplete(void)
 {
     if (!gyro.initialized) {
         return true;
     }
 
+#ifdef USE_DUAL_GYRO
+    for (int i = 1; i < gyroCount; i++) {
+        if (!gyroHealth[i].failed && !(zeroCalibrationIsCompleteV(&gyroCalibration[i]) && zeroCalibrationIsSuccessfulV(&gyroCalibration[i]))) {
+            return false;
+        }
+    }
+#endif
+
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
     if (!gyroConfig()->init_gyro_cal_enabled) {
         return true;
@@ -362,7 +585,10 @@ STATIC_UNIT_TESTED void performGyroCalibration(gyroDev_t *dev, zeroCalibrationVe
         dev->gyroZero[Z] = v.v[Z];
 
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
-        setGyroCalibrationAndWriteEEPROM(dev->gyroZero);
+        // Only the primary gyro zero is stored, see gyro_zero_x/y/z
+        if (dev == &gyroDev[0]) {
+            setGyroCalibrationAndWriteEEPROM(dev->gyroZero);
+        }
 #endif
 
         LOG_D(GYRO, "Gyro calibration complete (%d, %d, %d)", dev->gyroZero[X], dev->gyroZero[Y], dev->gyroZero[Z]);
@@ -384,14 +610,29 @@ void gyroGetMeasuredRotationRate(fpVector3_t *measuredRotationRate)
     }
 }
 
-static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, zeroCalibrationVector_t * gyroCal, float * gyroADCf)
+static void FAST_CODE gyroConvertRawSample(const gyroDev_t * gyroDev, const int16_t * gyroADCRaw, float * gyroADCf)
 {
+    int32_t gyroADCtmp[XYZ_AXIS_COUNT];
 
-    // range: +/- 8192; +/- 2000 deg/sec
-    if (gyroDev->readFn(gyroDev)) {
+    // Copy gyro value into int32_t (to prevent overflow) and then apply calibration and alignment
+    gyroADCtmp[X] = (int32_t)gyroADCRaw[X] - (int32_t)gyroDev->gyroZero[X];
+    gyroADCtmp[Y] = (int32_t)gyroADCRaw[Y] - (int32_t)gyroDev->gyroZero[Y];
+    gyroADCtmp[Z] = (int32_t)gyroADCRaw[Z] - (int32_t)gyroDev->gyroZero[Z];
+
+    // Apply sensor alignment
+    applySensorAlignment(gyroADCtmp, gyroADCtmp, gyroDev->gyroAlign);
+    applyBoardAlignment(gyroADCtmp);
+
+    // Convert to deg/s and store in unified data
+    gyroADCf[X] = (float)gyroADCtmp[X] * gyroDev->scale;
+    gyroADCf[Y] = (float)gyroADCtmp[Y] * gyroDev->scale;
+    gyroADCf[Z] = (float)gyroADCtmp[Z] * gyroDev->scale;
+}
 
+static bool FAST_CODE gyroCalibrateAndConvert(gyroDev_t * gyroDev, zeroCalibrationVector_t * gyroCal, float * gyroADCf)
+{
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
-    if (!gyroConfig()->init_gyro_cal_enabled) {
+    if (!gyroConfig()->init_gyro_cal_enabled && gyroCal == &gyroCalibration[0]) {
         // marks that the gyro calibration has ended
         gyroCalibration[0].params.state = ZERO_CALIBRATION_DONE;
         // pass the calibration values
@@ -401,34 +642,26 @@ static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, zeroC
     }
 #endif
 
-        if (zeroCalibrationIsCompleteV(gyroCal)) {
-            int32_t gyroADCtmp[XYZ_AXIS_COUNT];
-
-            // Copy gyro value into int32_t (to prevent overflow) and then apply calibration and alignment
-            gyroADCtmp[X] = (int32_t)gyroDev->gyroADCRaw[X] - (int32_t)gyroDev->gyroZero[X];
-            gyroADCtmp[Y] = (int32_t)gyroDev->gyroADCRaw[Y] - (int32_t)gyroDev->gyroZero[Y];
-            gyroADCtmp[Z] = (int32_t)gyroDev->gyroADCRaw[Z] - (int32_t)gyroDev->gyroZero[Z];
-
-            // Apply sensor alignment
-            applySensorAlignment(gyroADCtmp, gyroADCtmp, gyroDev->gyroAlign);
-            applyBoardAlignment(gyroADCtmp);
-
-            // Convert to deg/s and store in unified data
-            gyroADCf[X] = (float)gyroADCtmp[X] * gyroDev->scale;
-            gyroADCf[Y] = (float)gyroADCtmp[Y] * gyroDev->scale;
-            gyroADCf[Z] = (float)gyroADCtmp[Z] * gyroDev->scale;
+    if (zeroCalibrationIsCompleteV(gyroCal)) {
+        gyroConvertRawSample(gyroDev, gyroDev->gyroADCRaw, gyroADCf);
+        return true;
+    } else {
+        performGyroCalibration(gyroDev, gyroCal);
 
-            return true;
-        } else {
-            performGyroCalibration(gyroDev, gyroCal);
+        // Reset gyro values to zero to prevent other code from using uncalibrated data
+        gyroADCf[X] = 0.0f;
+        gyroADCf[Y] = 0.0f;
+        gyroADCf[Z] = 0.0f;
 
-            // Reset gyro values to zero to prevent other code from using uncalibrated data
-            gyroADCf[X] = 0.0f;
-            gyroADCf[Y] = 0.0f;
-            gyroADCf[Z] = 0.0f;
+        return false;
+    }
+}
 
-            return false;
-        }
+static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, zeroCalibrationVector_t * gyroCal, float * gyroADCf)
+{
+    // range: +/- 8192; +/- 2000 deg/sec
+    if (gyroDev->readFn(gyroDev)) {
+        return gyroCalibrateAndConvert(gyroDev, gyroCal, gyroADCf);
     } else {
         // no gyro reading to process
         return false;
@@ -441,14 +674,22 @@ void FAST_CODE NOINLINE gyroFilter()
         return;
     }
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        float gyroADCf = gyro.gyroADCf[axis];
+#ifdef USE_SIMULATOR
+    if (!ARMING_FLAG(SIMULATOR_MODE))
+#endif
+    {
+        // gyroADCf holds the last gyro task output, replace it with all samples since the previous PID loop
+        gyroDecimatorRead(gyro.gyroADCf);
+    }
 
 #ifdef USE_RPM_FILTER
-        gyroADCf = rpmFilterGyroApply(axis, gyroADCf);
+    rpmFilterGyroApply(gyro.gyroADCf);
 #endif
 
-        gyroADCf = gyroLpf2ApplyFn((filter_t *) &gyroLpf2State[axis], gyroADCf);
+    gyroLpf2ApplyFn(gyroLpf2State, gyro.gyroADCf);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        float gyroADCf = gyro.gyroADCf[axis];
 
 #ifdef USE_DYNAMIC_FILTERS
         if (dynamicGyroNotchState.enabled) {
@@ -465,36 +706,275 @@ void FAST_CODE NOINLINE gyroFilter()
 
 #endif
 
-#ifdef USE_GYRO_KALMAN
-        if (gyroConfig()->kalmanEnabled) {
-            gyroADCf = gyroKalmanUpdate(axis, gyroADCf);
-        }
-#endif
-
         gyro.gyroADCf[axis] = gyroADCf;
     }
 
+#ifdef USE_GYRO_KALMAN
+    if (gyroConfig()->kalmanEnabled) {
+        gyroKalmanUpdateAxes(gyro.gyroADCf);
+    }
+#endif
+
 #ifdef USE_DYNAMIC_FILTERS
     if (dynamicGyroNotchState.enabled) {
         gyroDataAnalyse(&gyroAnalyseState);
 
-        if (gyroAnalyseState.filterUpdateExecute) {
+        // Flat-topped samples put false peaks into the spectrum, keep the notches where they were
+        if (gyroAnalyseState.filterUpdateExecute && !STATE(GYRO_CLIPPING)) {
             dynamicGyroNotchFiltersUpdate(
                 &dynamicGyroNotchState,
                 gyroAnalyseState.filterUpdateAxis,
                 gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
             );
 
-            secondaryDynamicGyroNotchFiltersUpdate(
-                &secondaryDynamicGyroNotchState,
-                gyroAnalyseState.filterUpdateAxis,
-                gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
-            );
+            if (!loadSheddingIsActive(LOAD_SHED_SECONDARY_NOTCH)) {
+                secondaryDynamicGyroNotchFiltersUpdate(
+                    &secondaryDynamicGyroNotchState,
+                    gyroAnalyseState.filterUpdateAxis,
+                    gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
+                );
+            }
+        }
+    }
+#endif
+
+}
+
+bool gyroSyncIsActive(void)
+{
+#ifdef USE_MPU_DATA_READY_SIGNAL
+#ifdef USE_GYRO_FIFO_BURST_READ
+    // Data-ready fires for every sample, which defeats the burst read
+    if (gyroDev[0].fifoEnabled) {
+        return false;
+    }
+#endif
+    return gyro.initialized && gyroConfig()->gyroSync && gyroDev[0].dataReadyExtiEnabled && gyroDev[0].intStatusFn;
+#else
+    return false;
+#endif
+}
+
+// Returns true once per data-ready interrupt raised by the sensor
+bool FAST_CODE gyroSyncCheckUpdate(void)
+{
+    return gyroDev[0].intStatusFn(&gyroDev[0]);
+}
+
+/*
+ * Returns a bitmask of the sensor axes whose raw sample sits at the sensor full scale
+ */
+static uint8_t FAST_CODE gyroRawClippedAxes(const int16_t * gyroADCRaw)
+{
+    uint8_t clippedAxes = 0;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (gyroADCRaw[axis] >= INT16_MAX - GYRO_CLIP_MARGIN || gyroADCRaw[axis] <= INT16_MIN + GYRO_CLIP_MARGIN) {
+            clippedAxes |= BIT(axis);
+        }
+    }
+
+    return clippedAxes;
+}
+
+/*
+ * Counts clipped samples per sensor axis and keeps the GYRO_CLIPPING state for
+ * GYRO_CLIP_HOLD_US after the last one, so short flips are visible on the OSD and in blackbox
+ */
+static void FAST_CODE gyroUpdateClipping(uint8_t clippedAxes)
+{
+    if (clippedAxes) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            if (clippedAxes & BIT(axis)) {
+                gyro.clipCount[axis]++;
+            }
+        }
+        gyroClipHoldCounter = gyroClipHoldSamples;
+        ENABLE_STATE(GYRO_CLIPPING);
+    } else if (gyroClipHoldCounter > 0) {
+        if (--gyroClipHoldCounter == 0) {
+            DISABLE_STATE(GYRO_CLIPPING);
+        }
+    }
+}
+
+#ifdef USE_DUAL_GYRO
+
+static void FAST_CODE gyroUpdateStuckCount(int index)
+{
+    gyroHealth_t *health = &gyroHealth[index];
+    const int16_t *gyroADCRaw = gyroDev[index].gyroADCRaw;
+
+    if (!health->noiseChecked) {
+        // A sensor that was noise free while calibrating may legitimately repeat its output
+        float noise = 0.0f;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            noise = MAX(noise, devStandardDeviation(&gyroCalibration[index].val[axis].stdDev));
+        }
+        health->stuckCheckEnabled = noise >= GYRO_STUCK_MIN_NOISE;
+        health->noiseChecked = true;
+    }
+
+    if (health->stuckCheckEnabled && memcmp(gyroADCRaw, health->lastRaw, sizeof(health->lastRaw)) == 0) {
+        if (health->stuckSamples < GYRO_STUCK_SAMPLE_LIMIT) {
+            health->stuckSamples++;
+        }
+    } else {
+        health->stuckSamples = 0;
+    }
+
+    memcpy(health->lastRaw, gyroADCRaw, sizeof(health->lastRaw));
+}
+
+static void FAST_CODE gyroUpdateHealth(const bool * sampleValid, const bool * sampleSaturated)
+{
+    for (int i = 0; i < gyroCount; i++) {
+        gyroHealth_t *health = &gyroHealth[i];
+        const int other = gyroCount - 1 - i;
+
+        if (health->failed) {
+            continue;
+        }
+
+        // Saturation is only a fault when the other gyro sees the same motion within its range
+        if (sampleValid[i] && sampleValid[other]) {
+            if (sampleSaturated[i] && !sampleSaturated[other]) {
+                if (health->saturatedSamples < GYRO_SATURATED_SAMPLE_LIMIT) {
+                    health->saturatedSamples++;
+                }
+            } else {
+                health->saturatedSamples = 0;
+            }
+        }
+
+        const bool faulty = health->failedReads >= GYRO_FAILED_READ_LIMIT ||
+                            health->stuckSamples >= GYRO_STUCK_SAMPLE_LIMIT ||
+                            health->saturatedSamples >= GYRO_SATURATED_SAMPLE_LIMIT;
 
+        // Never drop the last gyro in use
+        if (faulty && !gyroHealth[other].failed) {
+            health->failed = true;
+            LOG_E(GYRO, "Gyro %d failed, continuing on the remaining one", i);
         }
     }
+}
+
+/*
+ * Reads all gyros back to back within the same gyro task, so their samples are at most
+ * a bus transfer apart, and averages the calibrated samples of the healthy ones into gyro.gyroADCf
+ */
+static bool FAST_CODE NOINLINE gyroUpdateFused(void)
+{
+    float sampleADCf[MAX_GYRO_COUNT][XYZ_AXIS_COUNT];
+    bool sampleValid[MAX_GYRO_COUNT];
+    bool sampleSaturated[MAX_GYRO_COUNT];
+    uint8_t sampleClippedAxes[MAX_GYRO_COUNT];
+    bool calibrating = false;
+
+    for (int i = 0; i < gyroCount; i++) {
+        gyroDev_t *dev = &gyroDev[i];
+        gyroHealth_t *health = &gyroHealth[i];
+
+        sampleValid[i] = false;
+        sampleSaturated[i] = false;
+
+        if (health->failed) {
+            continue;
+        }
+
+        if (!dev->readFn(dev)) {
+            if (health->failedReads < GYRO_FAILED_READ_LIMIT) {
+                health->failedReads++;
+            }
+            continue;
+        }
+        health->failedReads = 0;
+
+        if (!gyroCalibrateAndConvert(dev, &gyroCalibration[i], sampleADCf[i])) {
+            calibrating |= !zeroCalibrationIsCompleteV(&gyroCalibration[i]);
+            continue;
+        }
+
+        sampleValid[i] = true;
+        sampleClippedAxes[i] = gyroRawClippedAxes(dev->gyroADCRaw);
+        sampleSaturated[i] = sampleClippedAxes[i] != 0;
+        gyroUpdateStuckCount(i);
+    }
+
+    gyroUpdateHealth(sampleValid, sampleSaturated);
+
+    // Saturated samples are only used when no gyro has the motion within its range
+    bool unsaturatedAvailable = false;
+    for (int i = 0; i < gyroCount; i++) {
+        if (sampleValid[i] && !gyroHealth[i].failed && !sampleSaturated[i]) {
+            unsaturatedAvailable = true;
+        }
+    }
+
+    float gyroADCSum[XYZ_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f };
+    uint8_t clippedAxes = 0;
+    int sampleCount = 0;
+    for (int i = 0; i < gyroCount; i++) {
+        if (!sampleValid[i] || gyroHealth[i].failed || (sampleSaturated[i] && unsaturatedAvailable)) {
+            continue;
+        }
+
+        gyroADCSum[X] += sampleADCf[i][X];
+        gyroADCSum[Y] += sampleADCf[i][Y];
+        gyroADCSum[Z] += sampleADCf[i][Z];
+        clippedAxes |= sampleClippedAxes[i];
+        sampleCount++;
+    }
+
+    if (sampleCount == 0) {
+        // Drop samples taken before calibration, PID loop keeps the zeroed output meanwhile
+        if (calibrating) {
+            gyro.gyroADCf[X] = 0.0f;
+            gyro.gyroADCf[Y] = 0.0f;
+            gyro.gyroADCf[Z] = 0.0f;
+            gyroDecimator.writeCount = 0;
+            gyroDecimator.readCount = 0;
+        }
+        return false;
+    }
+
+    gyro.gyroADCf[X] = gyroADCSum[X] / sampleCount;
+    gyro.gyroADCf[Y] = gyroADCSum[Y] / sampleCount;
+    gyro.gyroADCf[Z] = gyroADCSum[Z] / sampleCount;
+
+    gyroUpdateClipping(clippedAxes);
+
+    return true;
+}
 #endif
 
+static void FAST_CODE gyroPushSample(void)
+{
+    // At this point gyro.gyroADCf contains unfiltered gyro value [deg/s]. Set raw gyro for blackbox purposes
+    gyro.gyroRaw[X] = gyro.gyroADCf[X];
+    gyro.gyroRaw[Y] = gyro.gyroADCf[Y];
+    gyro.gyroRaw[Z] = gyro.gyroADCf[Z];
+
+    /*
+     * First gyro LPF is the only filter applied with the full gyro sampling speed
+     */
+    gyroLpfApplyFn(gyroLpfState, gyro.gyroADCf);
+
+    gyroDecimatorPush(gyro.gyroADCf);
+}
+
+#ifdef USE_CLI_BENCH
+// Synthetic sample for gyroFilter(), enters where gyroUpdate() leaves its samples
+void gyroBenchPushSample(const float *gyroADCf)
+{
+    gyroDecimatorPush(gyroADCf);
+}
+#endif
+
+static timeUs_t gyroSampleTime(const gyroDev_t *dev)
+{
+    // The interrupt marks the end of the conversion, the read itself comes later
+    return dev->dataReadyExtiEnabled ? dev->dataReadyTimeUs : micros();
 }
 
 void FAST_CODE NOINLINE gyroUpdate()
@@ -510,24 +990,45 @@ void FAST_CODE NOINLINE gyroUpdate()
         return;
     }
 
-    if (!gyroUpdateAndCalibrate(&gyroDev[0], &gyroCalibration[0], gyro.gyroADCf)) {
+#ifdef USE_DUAL_GYRO
+    if (gyroCount > 1) {
+        if (gyroUpdateFused()) {
+            sensorSampleCapture(&gyro.sample, gyroSampleTime(&gyroDev[0]), true);
+            gyroPushSample();
+        }
         return;
     }
+#endif
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        // At this point gyro.gyroADCf contains unfiltered gyro value [deg/s]
-        float gyroADCf = gyro.gyroADCf[axis];
+    if (!gyroUpdateAndCalibrate(&gyroDev[0], &gyroCalibration[0], gyro.gyroADCf)) {
+        // Drop samples taken before calibration, PID loop keeps the zeroed output meanwhile
+        if (!zeroCalibrationIsCompleteV(&gyroCalibration[0])) {
+            gyroDecimator.writeCount = 0;
+            gyroDecimator.readCount = 0;
+        }
+        return;
+    }
 
-        // Set raw gyro for blackbox purposes
-        gyro.gyroRaw[axis] = gyroADCf;
+    uint8_t clippedAxes = gyroRawClippedAxes(gyroDev[0].gyroADCRaw);
 
-        /*
-         * First gyro LPF is the only filter applied with the full gyro sampling speed
-         */
-        gyroADCf = gyroLpfApplyFn((filter_t *) &gyroLpfState[axis], gyroADCf);
+#ifdef USE_GYRO_FIFO_BURST_READ
+    /*
+     * gyroADCRaw holds the newest FIFO sample and was converted above. Feed the older
+     * samples of this burst through the LPF first so it keeps running at the sensor ODR
+     */
+    for (int sample = 0; sample < gyroDev[0].fifoSampleCount - 1; sample++) {
+        float sampleADCf[XYZ_AXIS_COUNT];
+        gyroConvertRawSample(&gyroDev[0], gyroDev[0].gyroADCRawFifo[sample], sampleADCf);
+        clippedAxes |= gyroRawClippedAxes(gyroDev[0].gyroADCRawFifo[sample]);
 
-        gyro.gyroADCf[axis] = gyroADCf;
+        gyroLpfApplyFn(gyroLpfState, sampleADCf);
+        gyroDecimatorPush(sampleADCf);
     }
+#endif
+
+    gyroUpdateClipping(clippedAxes);
+    sensorSampleCapture(&gyro.sample, gyroSampleTime(&gyroDev[0]), true);
+    gyroPushSample();
 }
 
 bool gyroReadTemperature(void)
@@ -562,14 +1063,32 @@ int16_t gyroRateDps(int axis)
     return lrintf(gyro.gyroADCf[axis]);
 }
 
+/*
+ * Runs every PID loop. Coefficients are computed once for X and shared by Y and Z,
+ * and only when the cutoff moved by at least GYRO_DYN_LPF_MIN_STEP_HZ
+ */
 void gyroUpdateDynamicLpf(float cutoffFreq) {
+    if (fabsf(cutoffFreq - gyroLpf2DynamicCutoff) < GYRO_DYN_LPF_MIN_STEP_HZ) {
+        return;
+    }
+    gyroLpf2DynamicCutoff = cutoffFreq;
+
     if (gyroConfig()->gyro_main_lpf_type == FILTER_PT1) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            pt1FilterUpdateCutoff(&gyroLpf2State[axis].pt1, cutoffFreq);
+        pt1FilterUpdateCutoff(&gyroLpf2State[X].pt1, cutoffFreq);
+        for (int axis = Y; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroLpf2State[axis].pt1.RC = gyroLpf2State[X].pt1.RC;
+            gyroLpf2State[axis].pt1.alpha = gyroLpf2State[X].pt1.alpha;
         }
     } else if (gyroConfig()->gyro_main_lpf_type == FILTER_BIQUAD) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterUpdate(&gyroLpf2State[axis].biquad, cutoffFreq, getLooptime(), BIQUAD_Q, FILTER_LPF);
+        const biquadFilter_t *reference = &gyroLpf2State[X].biquad;
+        biquadFilterUpdate(&gyroLpf2State[X].biquad, cutoffFreq, getLooptime(), BIQUAD_Q, FILTER_LPF);
+        for (int axis = Y; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilter_t *filter = &gyroLpf2State[axis].biquad;
+            filter->b0 = reference->b0;
+            filter->b1 = reference->b1;
+            filter->b2 = reference->b2;
+            filter->a1 = reference->a1;
+            filter->a2 = reference->a2;
         }
     }
 }
@@ -51,11 +51,29 @@ typedef enum {
     DYNAMIC_NOTCH_MODE_3D
 } dynamicGyroNotchMode_e;
 
+typedef enum {
+    DYNAMIC_NOTCH_FFT_SIZE_64 = 0,
+    DYNAMIC_NOTCH_FFT_SIZE_128,
+    DYNAMIC_NOTCH_FFT_SIZE_256
+} dynamicGyroNotchFftSize_e;
+
+typedef enum {
+    DYNAMIC_NOTCH_ENGINE_FFT = 0,
+    DYNAMIC_NOTCH_ENGINE_SDFT
+} dynamicGyroNotchEngine_e;
+
+// Gyro to PID hand-off buffer, bounds the gyro/PID decimation ratio
+#define GYRO_DECIMATION_BUFFER_SIZE     16
+
 typedef struct gyro_s {
     bool initialized;
     uint32_t targetLooptime;
+    uint8_t decimationRatio;                // Gyro samples per PID loop
+    uint8_t pidSampleCount;                 // Gyro samples that arrived since the previous PID loop
     float gyroADCf[XYZ_AXIS_COUNT];
     float gyroRaw[XYZ_AXIS_COUNT];
+    uint32_t clipCount[XYZ_AXIS_COUNT];     // Samples at the sensor full scale since boot
+    sensorSample_t sample;                  // Newest sample, consumed by the IMU
 } gyro_t;
 
 extern gyro_t gyro;
@@ -69,6 +87,7 @@ typedef struct gyroConfig_s {
     uint8_t  gyro_anti_aliasing_lpf_type;
 #ifdef USE_DUAL_GYRO
     uint8_t  gyro_to_use;
+    bool     gyroFusion;                    // Average the samples of all detected gyros and drop a failing one
 #endif
     uint16_t gyro_main_lpf_hz;
     uint8_t gyro_main_lpf_type;
@@ -82,6 +101,9 @@ typedef struct gyroConfig_s {
     uint8_t dynamicGyroNotchEnabled;
     uint8_t dynamicGyroNotchMode;
     uint16_t dynamicGyroNotch3dQ;
+    uint8_t dynamicGyroNotchFftSize;
+    uint8_t dynamicGyroNotchFftAveraging;
+    uint8_t dynamicGyroNotchEngine;
 #endif
 #ifdef USE_GYRO_KALMAN
     uint16_t kalman_q;
@@ -90,6 +112,12 @@ typedef struct gyroConfig_s {
     bool init_gyro_cal_enabled;
     int16_t gyro_zero_cal[XYZ_AXIS_COUNT];
     float gravity_cmss_cal;
+#ifdef USE_MPU_DATA_READY_SIGNAL
+    bool gyroSync;                          // Trigger gyro reads from the sensor data-ready interrupt
+#endif
+#ifdef USE_GYRO_FIFO_BURST_READ
+    bool gyroFifo;                          // Read all pending samples from the sensor FIFO in one burst
+#endif
 } gyroConfig_t;
 
 PG_DECLARE(gyroConfig_t, gyroConfig);
@@ -98,7 +126,14 @@ bool gyroInit(void);
 void gyroGetMeasuredRotationRate(fpVector3_t *imuMeasuredRotationBF);
 void gyroUpdate(void);
 void gyroFilter(void);
+#ifdef USE_CLI_BENCH
+void gyroBenchPushSample(const float *gyroADCf);
+#endif
+bool gyroSyncIsActive(void);
+bool gyroSyncCheckUpdate(void);
 void gyroStartCalibration(void);
+void gyroGetCalibration(int16_t *gyroZero);
+void gyroRestoreCalibration(const int16_t *gyroZero);
 bool gyroIsCalibrationComplete(void);
 bool gyroReadTemperature(void);
 int16_t gyroGetTemperature(void);
@@ -24,6 +24,8 @@
 
 #include "config/config_eeprom.h"
 
+#include "drivers/time.h"
+
 #include "fc/config.h"
 #include "fc/runtime_config.h"
 
@@ -44,6 +46,25 @@
 uint8_t requestedSensors[SENSOR_INDEX_COUNT] = { GYRO_AUTODETECT, ACC_NONE, BARO_NONE, MAG_NONE, RANGEFINDER_NONE, PITOT_NONE, OPFLOW_NONE, SECONDARY_IMU_NONE };
 uint8_t detectedSensors[SENSOR_INDEX_COUNT] = { GYRO_NONE, ACC_NONE, BARO_NONE, MAG_NONE, RANGEFINDER_NONE, PITOT_NONE, OPFLOW_NONE, SECONDARY_IMU_NONE };
 
+// Mag and GPS modules need some time after power-on before they answer. Instead of waiting
+// up-front the deadline is enforced right before they are probed, everything else is
+// detected in the meantime
+static timeMs_t slowSensorsReadyAtMs = 0;
+
+void sensorsSetPowerOnDelay(timeMs_t delayMs)
+{
+    slowSensorsReadyAtMs = millis() + delayMs;
+}
+
+void sensorsWaitForPowerOn(void)
+{
+    const timeMs_t currentTimeMs = millis();
+
+    if (currentTimeMs < slowSensorsReadyAtMs) {
+        delay(slowSensorsReadyAtMs - currentTimeMs);
+    }
+}
+
 bool sensorsAutodetect(void)
 {
     bool eepromUpdatePending = false;
@@ -62,10 +83,6 @@ bool sensorsAutodetect(void)
     pitotInit();
 #endif
 
-#ifdef USE_MAG
-    compassInit();
-#endif
-
 #ifdef USE_TEMPERATURE_SENSOR
     temperatureInit();
 #endif
@@ -78,6 +95,12 @@ bool sensorsAutodetect(void)
     opflowInit();
 #endif
 
+    // Probed last so the detection above overlaps its power-on time
+#ifdef USE_MAG
+    sensorsWaitForPowerOn();
+    compassInit();
+#endif
+
     if (accelerometerConfig()->acc_hardware == ACC_AUTODETECT) {
         accelerometerConfigMutable()->acc_hardware = detectedSensors[SENSOR_INDEX_ACC];
         eepromUpdatePending = true;
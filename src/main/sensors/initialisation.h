@@ -17,4 +17,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 bool sensorsAutodetect(void);
+void sensorsSetPowerOnDelay(timeMs_t delayMs);
+void sensorsWaitForPowerOn(void);
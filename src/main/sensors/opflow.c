@@ -71,11 +71,22 @@ static timeMs_t opflowCalibrationStartedAt;
 static float opflowCalibrationBodyAcc;
 static float opflowCalibrationFlowAcc;
 
-#define OPFLOW_SQUAL_THRESHOLD_HIGH     35      // TBD
-#define OPFLOW_SQUAL_THRESHOLD_LOW      10      // TBD
 #define OPFLOW_UPDATE_TIMEOUT_US        200000  // At least 5Hz updates required
+#define OPFLOW_EVENT_TIMEOUT_US         50000   // Task period of event driven drivers without samples
 #define OPFLOW_CALIBRATE_TIME_MS        30000   // 30 second calibration time
 
+#define OPFLOW_GYRO_HISTORY_SIZE        32
+#define OPFLOW_GYRO_HISTORY_STEP_US     2500    // 80ms window, longer than one frame of the slowest (UART) sensors
+#define OPFLOW_GYRO_ANGLE_REBASE        3600.0f
+
+typedef struct {
+    timeUs_t timeUs;
+    float angle[2];
+} opflowGyroHistory_t;
+
+static opflowGyroHistory_t gyroHistory[OPFLOW_GYRO_HISTORY_SIZE];
+static uint8_t gyroHistoryHead;
+
 PG_REGISTER_WITH_RESET_TEMPLATE(opticalFlowConfig_t, opticalFlowConfig, PG_OPFLOW_CONFIG, 2);
 
 PG_RESET_TEMPLATE(opticalFlowConfig_t, opticalFlowConfig,
@@ -129,11 +140,71 @@ static bool opflowDetect(opflowDev_t * dev, uint8_t opflowHardwareToUse)
     return true;
 }
 
-static void opflowZeroBodyGyroAcc(void)
+static void opflowResetGyroHistory(void)
+{
+    memset(gyroHistory, 0, sizeof(gyroHistory));
+    gyroHistoryHead = 0;
+    opflow.gyroAngleTimeUs = 0;
+    opflow.gyroAngle[X] = 0;
+    opflow.gyroAngle[Y] = 0;
+}
+
+static const opflowGyroHistory_t * opflowGyroHistoryAt(int age)
+{
+    return &gyroHistory[(gyroHistoryHead + OPFLOW_GYRO_HISTORY_SIZE - 1 - age) % OPFLOW_GYRO_HISTORY_SIZE];
+}
+
+/*
+ * Integrated gyro angle at a past time, interpolated between the history
+ * entries. Returns false if the time is not covered by the history.
+ */
+static bool opflowGetGyroAngle(timeUs_t timeUs, float angle[2])
+{
+    opflowGyroHistory_t newer = { .timeUs = opflow.gyroAngleTimeUs, .angle = { opflow.gyroAngle[X], opflow.gyroAngle[Y] } };
+
+    if (newer.timeUs == 0 || cmpTimeUs(timeUs, newer.timeUs) > 0) {
+        return false;
+    }
+
+    for (int age = 0; age < OPFLOW_GYRO_HISTORY_SIZE; age++) {
+        const opflowGyroHistory_t * older = opflowGyroHistoryAt(age);
+
+        if (older->timeUs == 0) {
+            break;
+        }
+
+        const timeDelta_t span = cmpTimeUs(newer.timeUs, older->timeUs);
+        if (cmpTimeUs(timeUs, older->timeUs) >= 0) {
+            const float k = (span > 0) ? cmpTimeUs(timeUs, older->timeUs) / (float)span : 0.0f;
+            angle[X] = older->angle[X] + (newer.angle[X] - older->angle[X]) * k;
+            angle[Y] = older->angle[Y] + (newer.angle[Y] - older->angle[Y]) * k;
+            return true;
+        }
+
+        newer = *older;
+    }
+
+    return false;
+}
+
+/*
+ * Average body rate over the integration timeframe of the flow frame, so the
+ * rotation compensation matches the frame instead of the task period
+ */
+static bool opflowCalculateBodyRate(const opflowData_t * data, float bodyRate[2])
 {
-    opflow.gyroBodyRateTimeUs = 0;
-    opflow.gyroBodyRateAcc[X] = 0;
-    opflow.gyroBodyRateAcc[Y] = 0;
+    float angleStart[2], angleEnd[2];
+
+    if (data->deltaTime <= 0 ||
+        !opflowGetGyroAngle(data->sampleTimeUs - data->deltaTime, angleStart) ||
+        !opflowGetGyroAngle(data->sampleTimeUs, angleEnd)) {
+        return false;
+    }
+
+    const float invDt = 1.0e6f / data->deltaTime;
+    bodyRate[X] = (angleEnd[X] - angleStart[X]) * invDt;
+    bodyRate[Y] = (angleEnd[Y] - angleStart[Y]) * invDt;
+    return true;
 }
 
 bool opflowInit(void)
@@ -147,7 +218,7 @@ bool opflowInit(void)
         return false;
     }
 
-    opflowZeroBodyGyroAcc();
+    opflowResetGyroHistory();
 
     return true;
 }
@@ -173,6 +244,7 @@ void opflowUpdate(timeUs_t currentTimeUs)
         opflow.isHwHealty = true;
         opflow.lastValidUpdate = currentTimeUs;
         opflow.rawQuality = opflow.dev.rawData.quality;
+        sensorSampleCapture(&opflow.sample, opflow.dev.rawData.sampleTimeUs, true);
 
         // Handle state switching
         switch (opflow.flowQuality) {
@@ -197,10 +269,7 @@ void opflowUpdate(timeUs_t currentTimeUs)
 
         // In the following code we operate deg/s and do conversion to rad/s in the last step
         // Calculate body rates
-        if (opflow.gyroBodyRateTimeUs > 0) {
-            opflow.bodyRate[X] = opflow.gyroBodyRateAcc[X] / opflow.gyroBodyRateTimeUs;
-            opflow.bodyRate[Y] = opflow.gyroBodyRateAcc[Y] / opflow.gyroBodyRateTimeUs;
-        }
+        opflowCalculateBodyRate(&opflow.dev.rawData, opflow.bodyRate);
 
         // If quality of the flow from the sensor is good - process further
         if (opflow.flowQuality == OPFLOW_QUALITY_VALID) {
@@ -247,9 +316,6 @@ void opflowUpdate(timeUs_t currentTimeUs)
         opflow.bodyRate[Y] = DEGREES_TO_RADIANS(opflow.bodyRate[Y]);
         opflow.flowRate[X] = DEGREES_TO_RADIANS(opflow.flowRate[X]);
         opflow.flowRate[Y] = DEGREES_TO_RADIANS(opflow.flowRate[Y]);
-
-        // Zero out gyro accumulators to calculate rotation per flow update
-        opflowZeroBodyGyroAcc();
     }
     else {
         // No new data available
@@ -264,26 +330,60 @@ void opflowUpdate(timeUs_t currentTimeUs)
             opflow.bodyRate[X] = 0;
             opflow.bodyRate[Y] = 0;
 
-            opflowZeroBodyGyroAcc();
+            opflowResetGyroHistory();
         }
     }
 }
 
-/* Run a simple gyro update integrator to estimate average body rate between two optical flow updates */
-void opflowGyroUpdateCallback(timeUs_t gyroUpdateDeltaUs)
+/* Integrate gyro at gyro rate and keep a short history, so body rate over any flow frame can be looked up */
+void opflowGyroUpdateCallback(timeUs_t currentTimeUs, timeUs_t gyroUpdateDeltaUs)
 {
     if (!opflow.isHwHealty)
         return;
 
     for (int axis = 0; axis < 2; axis++) {
-        opflow.gyroBodyRateAcc[axis] += gyro.gyroADCf[axis] * gyroUpdateDeltaUs;
+        opflow.gyroAngle[axis] += gyro.gyroADCf[axis] * gyroUpdateDeltaUs * 1e-6f;
     }
 
-    opflow.gyroBodyRateTimeUs += gyroUpdateDeltaUs;
+    opflow.gyroAngleTimeUs = currentTimeUs;
+
+    const opflowGyroHistory_t * latest = opflowGyroHistoryAt(0);
+    if (latest->timeUs == 0 || cmpTimeUs(currentTimeUs, latest->timeUs) >= OPFLOW_GYRO_HISTORY_STEP_US) {
+        // Keep the integrators small to not lose float precision, only differences are used
+        for (int axis = 0; axis < 2; axis++) {
+            if (fabsf(opflow.gyroAngle[axis]) > OPFLOW_GYRO_ANGLE_REBASE) {
+                const float offset = opflow.gyroAngle[axis];
+                opflow.gyroAngle[axis] = 0;
+                for (int i = 0; i < OPFLOW_GYRO_HISTORY_SIZE; i++) {
+                    gyroHistory[i].angle[axis] -= offset;
+                }
+            }
+        }
+
+        gyroHistory[gyroHistoryHead].timeUs = currentTimeUs;
+        gyroHistory[gyroHistoryHead].angle[X] = opflow.gyroAngle[X];
+        gyroHistory[gyroHistoryHead].angle[Y] = opflow.gyroAngle[Y];
+        gyroHistoryHead = (gyroHistoryHead + 1) % OPFLOW_GYRO_HISTORY_SIZE;
+    }
 }
 
 bool opflowIsHealthy(void)
 {
     return opflow.isHwHealty;
 }
+
+bool opflowIsEventDriven(void)
+{
+    return opflow.dev.isDataReadyFn != NULL;
+}
+
+/*
+ * Task check of event driven drivers: the task runs as soon as a sample is
+ * waiting, and often enough without samples to notice the sensor timing out.
+ */
+bool opflowUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
+    return currentDeltaTimeUs >= OPFLOW_EVENT_TIMEOUT_US || opflow.dev.isDataReadyFn(&opflow.dev);
+}
 #endif
@@ -35,6 +35,10 @@ typedef enum {
     OPFLOW_FAKE         = 3,
 } opticalFlowSensor_e;
 
+#define OPFLOW_SQUAL_THRESHOLD_HIGH     35      // TBD
+#define OPFLOW_SQUAL_THRESHOLD_LOW      10      // TBD
+#define OPFLOW_SQUAL_THRESHOLD_GOOD     70      // Quality above which flow gets full estimator weight
+
 typedef enum {
     OPFLOW_QUALITY_INVALID,
     OPFLOW_QUALITY_VALID
@@ -57,16 +61,19 @@ typedef struct opflow_s {
     float           flowRate[2];    // optical flow angular rate in rad/sec measured about the X and Y body axis
     float           bodyRate[2];    // body inertial angular rate in rad/sec measured about the X and Y body axis
 
-    float           gyroBodyRateAcc[2];
-    timeUs_t        gyroBodyRateTimeUs;
+    float           gyroAngle[2];   // [deg] integrated body rate, only differences are meaningful
+    timeUs_t        gyroAngleTimeUs;
 
     uint8_t         rawQuality;
+    sensorSample_t  sample;
 } opflow_t;
 
 extern opflow_t opflow;
 
-void opflowGyroUpdateCallback(timeUs_t gyroUpdateDeltaUs);
+void opflowGyroUpdateCallback(timeUs_t currentTimeUs, timeUs_t gyroUpdateDeltaUs);
 bool opflowInit(void);
 void opflowUpdate(timeUs_t currentTimeUs);
 bool opflowIsHealthy(void);
+bool opflowIsEventDriven(void);
+bool opflowUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 void opflowStartCalibration(void);
@@ -31,6 +31,7 @@
 
 #include "drivers/pitotmeter/pitotmeter.h"
 #include "drivers/pitotmeter/pitotmeter_ms4525.h"
+#include "drivers/pitotmeter/pitotmeter_dlvr_l10d.h"
 #include "drivers/pitotmeter/pitotmeter_adc.h"
 #include "drivers/pitotmeter/pitotmeter_msp.h"
 #include "drivers/pitotmeter/pitotmeter_virtual.h"
@@ -85,6 +86,20 @@ bool pitotDetect(pitotDev_t *dev, uint8_t pitotHardwareToUse)
             }
             FALLTHROUGH;
 
+        case PITOT_DLVR:
+#ifdef USE_PITOT_DLVR
+            // Same address as the MS4525, only used when selected
+            if (pitotHardwareToUse != PITOT_AUTODETECT && dlvrDetect(dev)) {
+                pitotHardware = PITOT_DLVR;
+                break;
+            }
+#endif
+            /* If we are asked for a specific sensor - break out, otherwise - fall through and continue */
+            if (pitotHardwareToUse != PITOT_AUTODETECT) {
+                break;
+            }
+            FALLTHROUGH;
+
         case PITOT_ADC:
 #if defined(USE_ADC) && defined(USE_PITOT_ADC)
             if (adcPitotDetect(dev)) {
@@ -181,12 +196,46 @@ static void performPitotCalibrationCycle(void)
     }
 }
 
+// Filters a pressure sample taken at sampleTimeUs and updates the airspeed
+static void pitotProcessSample(float pressure, timeUs_t sampleTimeUs)
+{
+#ifdef USE_SIMULATOR
+    if (simulatorData.flags & SIMU_AIRSPEED) {
+        pressure = sq(simulatorData.airSpeed) * SSL_AIR_DENSITY / 20000.0f + SSL_AIR_PRESSURE;
+    }
+#endif
+
+    // Filter pressure
+    pitot.pressure = pt1FilterApply3(&pitot.lpfState, pressure, (sampleTimeUs - pitot.lastMeasurementUs) * 1e-6f);
+    pitot.lastMeasurementUs = sampleTimeUs;
+
+    // Calculate IAS
+    if (pitotIsCalibrationComplete()) {
+        // https://en.wikipedia.org/wiki/Indicated_airspeed
+        // Indicated airspeed (IAS) is the airspeed read directly from the airspeed indicator on an aircraft, driven by the pitot-static system.
+        // The IAS is an important value for the pilot because it is the indicated speeds which are specified in the aircraft flight manual for
+        // such important performance values as the stall speed. A typical aircraft will always stall at the same indicated airspeed (for the current configuration)
+        // regardless of density, altitude or true airspeed.
+        //
+        // Therefore we shouldn't care about CAS/TAS and only calculate IAS since it's more indicative to the pilot and more useful in calculations
+        // It also allows us to use pitot_scale to calibrate the dynamic pressure sensor scale
+        pitot.airSpeed = pitotmeterConfig()->pitot_scale * fast_fsqrtf(2.0f * fabsf(pitot.pressure - pitot.pressureZero) / SSL_AIR_DENSITY) * 100;
+    } else {
+        performPitotCalibrationCycle();
+        pitot.airSpeed = 0.0f;
+    }
+#ifdef USE_SIMULATOR
+    if (simulatorData.flags & SIMU_AIRSPEED) {
+        pitot.airSpeed = simulatorData.airSpeed;
+    }
+#endif
+}
+
 STATIC_PROTOTHREAD(pitotThread)
 {
     ptBegin(pitotThread);
 
     static float pitotPressureTmp;
-    timeUs_t currentTimeUs;
 
     // Init filter
     pitot.lastMeasurementUs = micros();
@@ -206,47 +255,76 @@ STATIC_PROTOTHREAD(pitotThread)
         }
 
         pitot.dev.calculate(&pitot.dev, &pitotPressureTmp, NULL);
-#ifdef USE_SIMULATOR
-    	if (simulatorData.flags & SIMU_AIRSPEED) {
-        	pitotPressureTmp = sq(simulatorData.airSpeed) * SSL_AIR_DENSITY / 20000.0f + SSL_AIR_PRESSURE;
-    	}
-#endif
         ptYield();
 
-        // Filter pressure
-        currentTimeUs = micros();
-        pitot.pressure = pt1FilterApply3(&pitot.lpfState, pitotPressureTmp, (currentTimeUs - pitot.lastMeasurementUs) * 1e-6f);
-        pitot.lastMeasurementUs = currentTimeUs;
+        pitotProcessSample(pitotPressureTmp, micros());
         ptDelayUs(pitot.dev.delay);
-
-        // Calculate IAS
-        if (pitotIsCalibrationComplete()) {
-            // https://en.wikipedia.org/wiki/Indicated_airspeed
-            // Indicated airspeed (IAS) is the airspeed read directly from the airspeed indicator on an aircraft, driven by the pitot-static system.
-            // The IAS is an important value for the pilot because it is the indicated speeds which are specified in the aircraft flight manual for
-            // such important performance values as the stall speed. A typical aircraft will always stall at the same indicated airspeed (for the current configuration)
-            // regardless of density, altitude or true airspeed.
-            //
-            // Therefore we shouldn't care about CAS/TAS and only calculate IAS since it's more indicative to the pilot and more useful in calculations
-            // It also allows us to use pitot_scale to calibrate the dynamic pressure sensor scale
-            pitot.airSpeed = pitotmeterConfig()->pitot_scale * fast_fsqrtf(2.0f * fabsf(pitot.pressure - pitot.pressureZero) / SSL_AIR_DENSITY) * 100;
-        } else {
-            performPitotCalibrationCycle();
-            pitot.airSpeed = 0.0f;
-        }
-#ifdef USE_SIMULATOR
-    	if (simulatorData.flags & SIMU_AIRSPEED) {
-        	pitot.airSpeed = simulatorData.airSpeed;
-    	}
-#endif
     }
 
     ptEnd(0);
 }
 
+/*
+ * Drivers with readAsync are read in the background at the task rate: each run
+ * takes the sample queued by the previous one and queues the next. A sample is
+ * stamped with the time its read was queued, the sensors convert continuously
+ * and return their latest result.
+ */
+static void pitotUpdateAsync(void)
+{
+    static timeUs_t readStartUs;
+    static bool filterInitialized;
+
+    if (!filterInitialized) {
+        pitot.lastMeasurementUs = micros();
+        pt1FilterInit(&pitot.lpfState, pitotmeterConfig()->pitot_lpf_milli_hz / 1000.0f, 0);
+        filterInitialized = true;
+    }
+
+    switch (busAsyncPoll(pitot.dev.busDev)) {
+        case BUS_ASYNC_QUEUED:
+        case BUS_ASYNC_ACTIVE:
+            return;
+
+        case BUS_ASYNC_DONE:
+            if (pitot.dev.readAsyncDecode(&pitot.dev)) {
+                float pressure;
+
+                pitot.lastSeenHealthyMs = millis();
+                pitot.dev.calculate(&pitot.dev, &pressure, NULL);
+                pitotProcessSample(pressure, readStartUs);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    readStartUs = micros();
+    if (!pitot.dev.readAsync(&pitot.dev)) {
+        // Bus taken by another background transfer, read the usual way rather than skip a sample
+        if (pitot.dev.get(&pitot.dev)) {
+            float pressure;
+
+            pitot.lastSeenHealthyMs = millis();
+            pitot.dev.calculate(&pitot.dev, &pressure, NULL);
+            pitotProcessSample(pressure, readStartUs);
+        }
+    }
+}
+
 void pitotUpdate(void)
 {
-    pitotThread();
+    if (pitot.dev.readAsync) {
+        pitotUpdateAsync();
+    } else {
+        pitotThread();
+    }
+}
+
+bool pitotHasAsyncRead(void)
+{
+    return pitot.dev.readAsync != NULL;
 }
 
 float getAirspeedEstimate(void)
@@ -259,4 +337,11 @@ bool pitotIsHealthy(void)
     return (millis() - pitot.lastSeenHealthyMs) < PITOT_HARDWARE_TIMEOUT_MS;
 }
 
+// Airspeed of a real sensor, the virtual pitot derives it from the wind estimate
+bool pitotHasValidAirspeed(void)
+{
+    return sensors(SENSOR_PITOT) && detectedSensors[SENSOR_INDEX_PITOT] != PITOT_VIRTUAL &&
+           pitotIsHealthy() && pitotIsCalibrationComplete();
+}
+
 #endif /* PITOT */
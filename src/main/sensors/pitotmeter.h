@@ -31,10 +31,12 @@ typedef enum {
     PITOT_VIRTUAL = 4,
     PITOT_FAKE = 5,
     PITOT_MSP = 6,
+    PITOT_DLVR = 7,
 } pitotSensor_e;
 
 #define PITOT_MAX  PITOT_FAKE
 #define PITOT_SAMPLE_COUNT_MAX   48
+#define PITOT_ASYNC_RATE_HZ      250     // Task rate of sensors read in the background
 
 typedef struct pitotmeterConfig_s {
     uint8_t pitot_hardware;                 // Pitotmeter hardware to use
@@ -65,7 +67,9 @@ bool pitotInit(void);
 bool pitotIsCalibrationComplete(void);
 void pitotStartCalibration(void);
 void pitotUpdate(void);
+bool pitotHasAsyncRead(void);
 float getAirspeedEstimate(void);
 bool pitotIsHealthy(void);
+bool pitotHasValidAirspeed(void);
 
 #endif
@@ -58,16 +58,20 @@
 rangefinder_t rangefinder;
 
 #define RANGEFINDER_HARDWARE_TIMEOUT_MS         500     // Accept 500ms of non-responsive sensor, report HW failure otherwise
+#define RANGEFINDER_EVENT_TIMEOUT_US            100000  // Task period of event driven drivers without samples
 
 #define RANGEFINDER_DYNAMIC_THRESHOLD           600     //Used to determine max. usable rangefinder disatance
 #define RANGEFINDER_DYNAMIC_FACTOR              75
 
+#define RANGEFINDER_SLOPE_REJECT_COUNT          3       // Consecutive outliers taken as a real step of the surface
+
 #ifdef USE_RANGEFINDER
-PG_REGISTER_WITH_RESET_TEMPLATE(rangefinderConfig_t, rangefinderConfig, PG_RANGEFINDER_CONFIG, 3);
+PG_REGISTER_WITH_RESET_TEMPLATE(rangefinderConfig_t, rangefinderConfig, PG_RANGEFINDER_CONFIG, 4);
 
 PG_RESET_TEMPLATE(rangefinderConfig_t, rangefinderConfig,
     .rangefinder_hardware = SETTING_RANGEFINDER_HARDWARE_DEFAULT,
     .use_median_filtering = SETTING_RANGEFINDER_MEDIAN_FILTER_DEFAULT,
+    .slope_limit = SETTING_RANGEFINDER_SLOPE_LIMIT_DEFAULT,
 );
 
 /*
@@ -190,6 +194,31 @@ static int32_t applyMedianFilter(int32_t newReading)
     return medianFilterReady ? quickMedianFilter5(filterSamples) : newReading;
 }
 
+/*
+ * Drop readings which change faster than the aircraft could move. A jump that
+ * persists is accepted, so a real step such as flying over a roof is followed.
+ */
+static bool applySlopeLimiter(int32_t newReading, timeMs_t currentTimeMs)
+{
+    static int32_t lastReading = RANGEFINDER_OUT_OF_RANGE;
+    static timeMs_t lastReadingMs;
+    static uint8_t rejectedCount;
+
+    if (lastReading > RANGEFINDER_OUT_OF_RANGE && newReading > RANGEFINDER_OUT_OF_RANGE) {
+        const int32_t maxStep = MAX(1, (int32_t)((uint32_t)rangefinderConfig()->slope_limit * (currentTimeMs - lastReadingMs) / 1000));
+
+        if (ABS(newReading - lastReading) > maxStep && rejectedCount < RANGEFINDER_SLOPE_REJECT_COUNT - 1) {
+            rejectedCount++;
+            return false;
+        }
+    }
+
+    rejectedCount = 0;
+    lastReading = newReading;
+    lastReadingMs = currentTimeMs;
+    return true;
+}
+
 /*
  * This is called periodically by the scheduler
  */
@@ -208,6 +237,12 @@ timeDelta_t rangefinderUpdate(void)
 bool rangefinderProcess(float cosTiltAngle)
 {
     if (rangefinder.dev.read) {
+        // Event driven drivers know when the sample arrived, others are stamped when read
+        timeUs_t sampleTimeUs = micros();
+        if (rangefinder.dev.isDataReady) {
+            rangefinder.dev.isDataReady(&rangefinder.dev, &sampleTimeUs);
+        }
+
         const int32_t distance = rangefinder.dev.read(&rangefinder.dev);
 
         // If driver reported no new measurement - don't do anything
@@ -215,8 +250,15 @@ bool rangefinderProcess(float cosTiltAngle)
             return false;
         }
 
+        sensorSampleCapture(&rangefinder.sample, sampleTimeUs, distance != RANGEFINDER_HARDWARE_FAILURE);
+
         if (distance >= 0) {
             rangefinder.lastValidResponseTimeMs = millis();
+
+            if (rangefinderConfig()->slope_limit && !applySlopeLimiter(distance, rangefinder.lastValidResponseTimeMs)) {
+                return false;
+            }
+
             rangefinder.rawAltitude = distance;
 
             if (rangefinderConfig()->use_median_filtering) {
@@ -226,6 +268,10 @@ bool rangefinderProcess(float cosTiltAngle)
         else if (distance == RANGEFINDER_OUT_OF_RANGE) {
             rangefinder.lastValidResponseTimeMs = millis();
             rangefinder.rawAltitude = RANGEFINDER_OUT_OF_RANGE;
+
+            if (rangefinderConfig()->slope_limit) {
+                applySlopeLimiter(RANGEFINDER_OUT_OF_RANGE, rangefinder.lastValidResponseTimeMs);
+            }
         }
         else {
             // Invalid response / hardware failure
@@ -269,4 +315,21 @@ bool rangefinderIsHealthy(void)
 {
     return (millis() - rangefinder.lastValidResponseTimeMs) < RANGEFINDER_HARDWARE_TIMEOUT_MS;
 }
+
+bool rangefinderIsEventDriven(void)
+{
+    return rangefinder.dev.isDataReady != NULL;
+}
+
+/*
+ * Task check of event driven drivers: the task runs as soon as a sample is
+ * waiting, and at a low rate without samples to keep the health up to date.
+ */
+bool rangefinderUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    timeUs_t sampleTimeUs;
+    return currentDeltaTimeUs >= RANGEFINDER_EVENT_TIMEOUT_US || rangefinder.dev.isDataReady(&rangefinder.dev, &sampleTimeUs);
+}
 #endif
@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include "config/parameter_group.h"
 #include "drivers/rangefinder/rangefinder.h"
+#include "drivers/sensor.h"
 
 typedef enum {
     RANGEFINDER_NONE        = 0,
@@ -35,6 +36,7 @@ typedef enum {
 typedef struct rangefinderConfig_s {
     uint8_t rangefinder_hardware;
     uint8_t use_median_filtering;
+    uint16_t slope_limit;                   // [cm/s], 0 - disabled
 } rangefinderConfig_t;
 
 PG_DECLARE(rangefinderConfig_t, rangefinderConfig);
@@ -45,6 +47,7 @@ typedef struct rangefinder_s {
     int32_t rawAltitude;
     int32_t calculatedAltitude;
     timeMs_t lastValidResponseTimeMs;
+    sensorSample_t sample;
 } rangefinder_t;
 
 extern rangefinder_t rangefinder;
@@ -57,3 +60,5 @@ int32_t rangefinderGetLatestRawAltitude(void);
 timeDelta_t rangefinderUpdate(void);
 bool rangefinderProcess(float cosTiltAngle);
 bool rangefinderIsHealthy(void);
+bool rangefinderIsEventDriven(void);
+bool rangefinderUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
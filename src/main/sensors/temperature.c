@@ -40,6 +40,7 @@
 #include "sensors/barometer.h"
 
 #include "scheduler/protothreads.h"
+#include "scheduler/scheduler.h"
 
 
 PG_REGISTER_ARRAY(tempSensorConfig_t, MAX_TEMP_SENSORS, tempSensorConfig, PG_TEMP_SENSOR_CONFIG, 2);
@@ -186,6 +187,19 @@ bool tempSensorStringToAddress(const char *hex_address, uint64_t *address)
 }
 #endif /* USE_TEMPERATURE_SENSOR */
 
+/*
+ * The update thread steps through one bus transaction per task run. While it
+ * talks to the sensors the task runs at a period matched to the 1-Wire timing,
+ * the DS2482 finishes a reset in 1.2 ms and a byte in 0.6 ms, so nearly every
+ * run finds the bus ready. All DS18B20 convert at once after a broadcast
+ * Convert-T and the task drops to a slow rate for the conversion time.
+ */
+#define TEMPERATURE_BUS_TASK_PERIOD_US      2000
+#define TEMPERATURE_CONVERSION_TIME_MS      100     // DS18B20 sensors take 94ms for a temperature conversion with 9bit resolution
+#define TEMPERATURE_UPDATE_INTERVAL_MS      500     // Minimum time between the start of two sensor sweeps
+
+static timeMs_t temperatureUpdateStartMs;
+
 #ifdef USE_TEMPERATURE_SENSOR
 
 static uint8_t temperatureUpdateSensorIndex;
@@ -204,6 +218,9 @@ PROTOTHREAD(temperatureUpdate)
 
     while (1) {
 
+        temperatureUpdateStartMs = millis();
+        rescheduleTask(TASK_TEMPERATURE, TEMPERATURE_BUS_TASK_PERIOD_US);
+
         if (gyroReadTemperature()) {
             mpuTemperature = gyroGetTemperature();
             mpuBaroTempValid |= (1 << MPU_TEMP_VALID_BIT);
@@ -285,7 +302,10 @@ temperatureUpdateError:;
            else
                sensorStatus[byteIndex] &= ~statusMask;
 
-           ptYield();
+           // Empty slots cost no bus time
+           if (tempSensorConfig(temperatureUpdateSensorIndex)->type != TEMP_SENSOR_NONE) {
+               ptYield();
+           }
 
         } while (++temperatureUpdateSensorIndex < MAX_TEMP_SENSORS);
 
@@ -299,6 +319,7 @@ temperatureUpdateError:;
             if (!ack) goto ds18b20StartConversionError;
             ptWait(owDev->owBusReady(owDev));
 
+            // All sensors convert at the same time, their scratchpads are read in one sweep on the next pass
             ds18b20StartConversionCommand(owDev);
         }
 
@@ -307,7 +328,10 @@ ds18b20StartConversionError:;
 
 #endif /* defined(USE_TEMPERATURE_SENSOR) */
 
-        ptDelayMs(100); // DS18B20 sensors take 94ms for a temperature conversion with 9bit resolution
+        // The next run comes after the conversion time at the earliest
+        const timeDelta_t sweepTimeMs = millis() - temperatureUpdateStartMs;
+        rescheduleTask(TASK_TEMPERATURE, TASK_PERIOD_MS(MAX(TEMPERATURE_CONVERSION_TIME_MS, TEMPERATURE_UPDATE_INTERVAL_MS - sweepTimeMs)));
+        ptYield();
 
     }
 
@@ -43,6 +43,7 @@
 #define USE_SERIALRX_FPORT2
 
 //#define USE_DEV_TOOLS           // tools for dev use only. Undefine for release builds.
+//#define USE_CLI_BENCH           // CLI bench command timing the flight kernels on the board, see build/bench.h. For measurement builds only.
 
 #define COMMON_DEFAULT_FEATURES (FEATURE_TX_PROF_SEL)
 
@@ -66,6 +67,82 @@
 #define SCHEDULER_DELAY_LIMIT           100
 #endif
 
+// Keep time-driven tasks in a heap ordered by due time instead of scanning them on every scheduler pass
+#define USE_SCHEDULER_DEADLINE_QUEUE
+
+// Deferred background jobs run in the time left when no task is due, see schedulerPostIdleJob()
+#define USE_SCHEDULER_IDLE_JOBS
+
+// DWT cycle counter based timing of named code regions, see build/profiling.h
+#define USE_PROFILING_ZONES
+
+// Scheduler, bus and fault events kept in RAM across resets, see build/trace_ring.h
+#define USE_TRACE_RING
+
+#if defined(STM32F7) || defined(STM32H7)
+// Log-bucketed execution time and start lateness histograms per task
+#define USE_SCHEDULER_TASK_HISTOGRAMS
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Optional LZ4 block compression of blackbox frame data, see blackbox/blackbox_compress.h
+#define USE_BLACKBOX_COMPRESSION
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Kalman filter alternative to the complementary position estimator, selected with inav_pos_estimator
+#define USE_POS_ESTIMATOR_EKF
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Second u-blox receiver on another GPS port, blended with the first, see io/gps_blend.c
+#define USE_GPS_DUAL
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Polygonal inclusion/exclusion zones, see navigation/navigation_geozone.c
+#define USE_GEOZONE
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Missions of thousands of waypoints in external flash, see navigation/navigation_mission_store.c
+#define USE_MISSION_STORE
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Terrain elevation tiles in external flash for terrain relative missions, see navigation/navigation_terrain.c
+#define USE_TERRAIN
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Journal of the blackbox logs on the dataflash, see io/flashfs.c
+#define USE_FLASHFS_INDEX
+#endif
+
+#if defined(STM32F7) || defined(STM32H7)
+// Bulk CRC8/CRC16 through the CRC calculation unit, see drivers/crc_hw.c
+#define USE_CRC_HW
+#endif
+
+// Drain the gyro FIFO in a single burst on sensors that support it
+#define USE_GYRO_FIFO_BURST_READ
+
+// Run back-to-back filter stages (D-term LPF + LPF2) through one specialized function per stage pair
+#define USE_FILTER_CHAIN_SPECIALIZATION
+
+// micros() from the DWT cycle counter, extended by SysTick, instead of SysTick->VAL with a division
+#define USE_DWT_TIMEBASE
+
+#if defined(USE_SPI)
+// Asynchronous SPI transfer queue. DMA is used on buses the target assigns SPIx_RX_DMA/SPIx_TX_DMA streams to
+#define USE_SPI_DMA
+#endif
+
+// Circular DMA reception with idle line detection on UARTs the target assigns a UARTx_RX_DMA stream to
+#define USE_UART_RX_DMA
+// Chunked DMA transmission from the TX ring on UARTs the target assigns a UARTx_TX_DMA stream to
+#define USE_UART_TX_DMA
+
 #if defined(MAG_I2C_BUS) || defined(VCM5883_I2C_BUS)
 #define USE_MAG_VCM5883
 #endif
@@ -97,6 +174,7 @@
 // Allow default airspeed sensors
 #define USE_PITOT
 #define USE_PITOT_MS4525
+#define USE_PITOT_DLVR
 #define USE_PITOT_MSP
 
 #define USE_1WIRE
@@ -186,6 +264,11 @@
 
 #define USE_SIMULATOR
 
+#if defined(STM32F7) || defined(STM32H7)
+// Streaming HITL link with batched sensor frames in and actuator frames out, see fc/simulator.c
+#define USE_SIMULATOR_STREAM
+#endif
+
 //Designed to free space of F722 and F411 MCUs
 #if (MCU_FLASH_SIZE > 512)
 
@@ -48,10 +48,44 @@ extern uint8_t __config_end;
 #define USE_BARO_MSP
 #endif
 
-#ifdef USE_ESC_SENSOR
+#ifdef USE_DSHOT
+    #define USE_DSHOT_BIDIR
+    #define USE_DSHOT_DMAR
+#endif
+
+// Soft serial DMA is built on the timer DMA capture of bidirectional DShot
+#if defined(USE_SOFTSERIAL_DMA) && !(defined(USE_DSHOT_BIDIR) && (defined(USE_SOFTSERIAL1) || defined(USE_SOFTSERIAL2)))
+#undef USE_SOFTSERIAL_DMA
+#endif
+
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_BIDIR)
     #define USE_RPM_FILTER
 #endif
 
+#if defined(USE_MISSION_STORE)
+#if !defined(USE_FLASHFS)
+#undef USE_MISSION_STORE
+#elif !defined(MISSION_STORE_SIZE)
+#define MISSION_STORE_SIZE (128 * 1024)
+#endif
+#endif
+
+#if defined(USE_TERRAIN)
+#if !defined(USE_FLASHFS)
+#undef USE_TERRAIN
+#elif !defined(TERRAIN_STORE_SIZE)
+#define TERRAIN_STORE_SIZE (256 * 1024)
+#endif
+#endif
+
+#if defined(USE_FLASHFS_INDEX)
+#if !defined(USE_FLASHFS)
+#undef USE_FLASHFS_INDEX
+#elif !defined(FLASHFS_INDEX_SIZE)
+#define FLASHFS_INDEX_SIZE (64 * 1024)
+#endif
+#endif
+
 #ifndef BEEPER_PWM_FREQUENCY
 #define BEEPER_PWM_FREQUENCY    2500
 #endif
@@ -72,6 +106,47 @@ extern uint8_t __config_end;
 #define FILE_COMPILE_NORMAL _Pragma("GCC optimize(\"O2\")")
 #define FILE_COMPILE_FOR_SPEED _Pragma("GCC optimize(\"Ofast\")")
 
+/*
+ * Memory arena budget (common/memory.c) for buffers that only the active configuration needs. The
+ * blackbox compression buffers are claimed first and the SD card ring takes what is left, so a log
+ * without compression gets a larger ring. Size of the SD card ring target/common.h used to reserve.
+ * Serial logs take a large TX ring for the UART instead, only one of the two devices is in use.
+ */
+#if defined(USE_BLACKBOX) && defined(USE_SDCARD)
+#ifndef BLACKBOX_SDCARD_BUFFER_SIZE
+#if defined(STM32F7) || defined(STM32H7)
+#define BLACKBOX_SDCARD_BUFFER_SIZE     16384
+#else
+#define BLACKBOX_SDCARD_BUFFER_SIZE     4096
+#endif
+#endif
+#define BLACKBOX_ARENA_SDCARD_SIZE      BLACKBOX_SDCARD_BUFFER_SIZE
+#else
+#define BLACKBOX_ARENA_SDCARD_SIZE      0
+#endif
+
+#if defined(USE_BLACKBOX) && defined(USE_UART_TX_DMA)
+#ifndef BLACKBOX_SERIAL_BUFFER_SIZE
+#if defined(STM32F7) || defined(STM32H7)
+#define BLACKBOX_SERIAL_BUFFER_SIZE     8192
+#else
+#define BLACKBOX_SERIAL_BUFFER_SIZE     2048
+#endif
+#endif
+#define BLACKBOX_ARENA_SERIAL_SIZE      BLACKBOX_SERIAL_BUFFER_SIZE
+#else
+#define BLACKBOX_ARENA_SERIAL_SIZE      0
+#endif
+
+#if defined(USE_BLACKBOX) && defined(USE_BLACKBOX_COMPRESSION)
+#define BLACKBOX_ARENA_COMPRESSION_SIZE 1088    // compression block and output, checked in blackbox_io.c
+#else
+#define BLACKBOX_ARENA_COMPRESSION_SIZE 0
+#endif
+
+#define BLACKBOX_ARENA_DEVICE_SIZE      (BLACKBOX_ARENA_SDCARD_SIZE > BLACKBOX_ARENA_SERIAL_SIZE ? BLACKBOX_ARENA_SDCARD_SIZE : BLACKBOX_ARENA_SERIAL_SIZE)
+#define DYNAMIC_HEAP_ARENA_SIZE         (BLACKBOX_ARENA_DEVICE_SIZE + BLACKBOX_ARENA_COMPRESSION_SIZE)
+
 #if defined(CONFIG_IN_RAM) || defined(CONFIG_IN_EXTERNAL_FLASH)
 #ifndef EEPROM_SIZE
 #define EEPROM_SIZE     8192
@@ -47,6 +47,7 @@ FILE_COMPILE_FOR_SPEED
 #include "fc/runtime_config.h"
 
 #include "flight/imu.h"
+#include "flight/telemetry_snapshot.h"
 
 #include "io/gps.h"
 #include "io/serial.h"
@@ -64,7 +65,10 @@ FILE_COMPILE_FOR_SPEED
 #include "telemetry/msp_shared.h"
 
 
-#define CRSF_CYCLETIME_US                   100000  // 100ms, 10 Hz
+// Telemetry slots follow the RC packet rate, the receiver relays roughly one downlink frame per CRSF_SLOT_RC_FRAME_RATIO RC frames
+#define CRSF_SLOT_RC_FRAME_RATIO            2
+#define CRSF_SLOT_INTERVAL_MIN_US           4000    // 250 Hz
+#define CRSF_SLOT_INTERVAL_MAX_US           20000   // 50 Hz, used until the packet rate is known
 #define CRSF_DEVICEINFO_VERSION             0x01
 // According to TBS: "CRSF over serial should always use a sync byte at the beginning of each frame.
 // To get better performance it's recommended to use the sync byte 0xC8 to get better performance"
@@ -75,7 +79,6 @@ FILE_COMPILE_FOR_SPEED
 #define CRSF_MSP_BUFFER_SIZE 96
 #define CRSF_MSP_LENGTH_OFFSET 1
 
-static uint8_t crsfCrc;
 static bool crsfTelemetryEnabled;
 static bool deviceInfoReplyPending;
 static uint8_t crsfFrame[CRSF_FRAME_SIZE_MAX];
@@ -132,7 +135,6 @@ bool handleCrsfMspFrameBuffer(uint8_t payloadSize, mspResponseFnPtr responseFn)
 
 static void crsfInitializeFrame(sbuf_t *dst)
 {
-    crsfCrc = 0;
     dst->ptr = crsfFrame;
     dst->end = ARRAYEND(crsfFrame);
 
@@ -142,7 +144,6 @@ static void crsfInitializeFrame(sbuf_t *dst)
 static void crsfSerialize8(sbuf_t *dst, uint8_t v)
 {
     sbufWriteU8(dst, v);
-    crsfCrc = crc8_dvb_s2(crsfCrc, v);
 }
 
 static void crsfSerialize16(sbuf_t *dst, uint16_t v)
@@ -163,14 +164,19 @@ static void crsfSerialize32(sbuf_t *dst, uint32_t v)
 
 static void crsfSerializeData(sbuf_t *dst, const uint8_t *data, int len)
 {
-    for (int ii = 0; ii< len; ++ii) {
-        crsfSerialize8(dst, data[ii]);
-    }
+    sbufWriteData(dst, data, len);
+}
+
+// CRC of the whole frame in one pass, it covers the type and the payload but not the sync byte and the frame length
+static uint8_t crsfFrameCrc(sbuf_t *dst)
+{
+    const uint8_t *start = crsfFrame + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
+    return crc8_dvb_s2_update(0, start, sbufPtr(dst) - start);
 }
 
 static void crsfFinalize(sbuf_t *dst)
 {
-    sbufWriteU8(dst, crsfCrc);
+    sbufWriteU8(dst, crsfFrameCrc(dst));
     sbufSwitchToReader(dst, crsfFrame);
     // write the telemetry frame to the receiver.
     crsfRxWriteTelemetryData(sbufPtr(dst), sbufBytesRemaining(dst));
@@ -178,7 +184,7 @@ static void crsfFinalize(sbuf_t *dst)
 
 static int crsfFinalizeBuf(sbuf_t *dst, uint8_t *frame)
 {
-    sbufWriteU8(dst, crsfCrc);
+    sbufWriteU8(dst, crsfFrameCrc(dst));
     sbufSwitchToReader(dst, crsfFrame);
     const int frameSize = sbufBytesRemaining(dst);
     for (int ii = 0; sbufBytesRemaining(dst); ++ii) {
@@ -230,7 +236,7 @@ static void crsfFrameVarioSensor(sbuf_t *dst)
     // use sbufWrite since CRC does not include frame length
     sbufWriteU8(dst, CRSF_FRAME_VARIO_SENSOR_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC);
     crsfSerialize8(dst, CRSF_FRAMETYPE_VARIO_SENSOR);
-    crsfSerialize16(dst, lrintf(getEstimatedActualVelocity(Z)));
+    crsfSerialize16(dst, telemetrySnapshot.climbRate);
 }
 
 /*
@@ -305,14 +311,8 @@ static void crsfFrameAttitude(sbuf_t *dst)
 Payload:
 char[]      Flight mode ( Null­terminated string )
 */
-static void crsfFrameFlightMode(sbuf_t *dst)
+static const char *crsfGetFlightModeString(void)
 {
-    // just do "OK" for the moment as a placeholder
-    // write zero for frame length, since we don't know it yet
-    uint8_t *lengthPtr = sbufPtr(dst);
-    sbufWriteU8(dst, 0);
-    crsfSerialize8(dst, CRSF_FRAMETYPE_FLIGHT_MODE);
-
     // use same logic as OSD, so telemetry displays same flight text as OSD when armed
     const char *flightMode = "OK";
     if (ARMING_FLAG(ARMED)) {
@@ -352,6 +352,17 @@ static void crsfFrameFlightMode(sbuf_t *dst)
         flightMode = "!ERR";
     }
 
+    return flightMode;
+}
+
+static void crsfFrameFlightMode(sbuf_t *dst)
+{
+    // write zero for frame length, since we don't know it yet
+    uint8_t *lengthPtr = sbufPtr(dst);
+    sbufWriteU8(dst, 0);
+    crsfSerialize8(dst, CRSF_FRAMETYPE_FLIGHT_MODE);
+
+    const char *flightMode = crsfGetFlightModeString();
     crsfSerializeData(dst, (const uint8_t*)flightMode, strlen(flightMode));
     crsfSerialize8(dst, 0); // zero terminator for string
     // write in the length
@@ -392,7 +403,7 @@ static void crsfFrameDeviceInfo(sbuf_t *dst)
 
 #define BV(x)  (1 << (x)) // bit value
 
-// schedule array to decide how often each type of frame is sent
+// Weighted schedule: each slot carries one frame, fast changing data gets most of the slots
 typedef enum {
     CRSF_FRAME_START_INDEX = 0,
     CRSF_FRAME_ATTITUDE_INDEX = CRSF_FRAME_START_INDEX,
@@ -403,8 +414,17 @@ typedef enum {
     CRSF_SCHEDULE_COUNT_MAX
 } crsfFrameTypeIndex_e;
 
-static uint8_t crsfScheduleCount;
-static uint8_t crsfSchedule[CRSF_SCHEDULE_COUNT_MAX];
+static const uint8_t crsfScheduleWeights[CRSF_SCHEDULE_COUNT_MAX] = {
+    [CRSF_FRAME_ATTITUDE_INDEX]         = 6,
+    [CRSF_FRAME_BATTERY_SENSOR_INDEX]   = 3,
+    [CRSF_FRAME_FLIGHT_MODE_INDEX]      = 1,    // also sent right away when it changes
+    [CRSF_FRAME_GPS_INDEX]              = 2,
+    [CRSF_FRAME_VARIO_SENSOR_INDEX]     = 3,
+};
+
+static uint8_t crsfScheduleMask;
+static int16_t crsfScheduleCredit[CRSF_SCHEDULE_COUNT_MAX];
+static const char *crsfLastFlightMode;
 
 #if defined(USE_MSP_OVER_TELEMETRY)
 
@@ -430,44 +450,71 @@ void crsfSendMspResponse(uint8_t *payload)
 }
 #endif
 
-static void processCrsf(void)
+static crsfFrameTypeIndex_e crsfNextScheduledFrame(void)
 {
-    static uint8_t crsfScheduleIndex = 0;
-    const uint8_t currentSchedule = crsfSchedule[crsfScheduleIndex];
+    if (crsfGetFlightModeString() != crsfLastFlightMode) {
+        return CRSF_FRAME_FLIGHT_MODE_INDEX;
+    }
+
+    // Smooth weighted round robin: every frame earns its weight, the richest one is sent and pays the total
+    crsfFrameTypeIndex_e next = CRSF_FRAME_ATTITUDE_INDEX;
+    int totalWeight = 0;
+
+    for (crsfFrameTypeIndex_e i = CRSF_FRAME_START_INDEX; i < CRSF_SCHEDULE_COUNT_MAX; i++) {
+        if (crsfScheduleMask & BV(i)) {
+            crsfScheduleCredit[i] += crsfScheduleWeights[i];
+            totalWeight += crsfScheduleWeights[i];
+            if (crsfScheduleCredit[i] > crsfScheduleCredit[next]) {
+                next = i;
+            }
+        }
+    }
 
+    crsfScheduleCredit[next] -= totalWeight;
+    return next;
+}
+
+static void processCrsf(void)
+{
     sbuf_t crsfPayloadBuf;
     sbuf_t *dst = &crsfPayloadBuf;
 
-    if (currentSchedule & BV(CRSF_FRAME_ATTITUDE_INDEX)) {
-        crsfInitializeFrame(dst);
+    crsfInitializeFrame(dst);
+    switch (crsfNextScheduledFrame()) {
+    default:
+    case CRSF_FRAME_ATTITUDE_INDEX:
         crsfFrameAttitude(dst);
-        crsfFinalize(dst);
-    }
-    if (currentSchedule & BV(CRSF_FRAME_BATTERY_SENSOR_INDEX)) {
-        crsfInitializeFrame(dst);
+        break;
+    case CRSF_FRAME_BATTERY_SENSOR_INDEX:
         crsfFrameBatterySensor(dst);
-        crsfFinalize(dst);
-    }
-    if (currentSchedule & BV(CRSF_FRAME_FLIGHT_MODE_INDEX)) {
-        crsfInitializeFrame(dst);
+        break;
+    case CRSF_FRAME_FLIGHT_MODE_INDEX:
+        crsfLastFlightMode = crsfGetFlightModeString();
         crsfFrameFlightMode(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #ifdef USE_GPS
-    if (currentSchedule & BV(CRSF_FRAME_GPS_INDEX)) {
-        crsfInitializeFrame(dst);
+    case CRSF_FRAME_GPS_INDEX:
         crsfFrameGps(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #endif
 #if defined(USE_BARO) || defined(USE_GPS)
-    if (currentSchedule & BV(CRSF_FRAME_VARIO_SENSOR_INDEX)) {
-        crsfInitializeFrame(dst);
+    case CRSF_FRAME_VARIO_SENSOR_INDEX:
         crsfFrameVarioSensor(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #endif
-    crsfScheduleIndex = (crsfScheduleIndex + 1) % crsfScheduleCount;
+    }
+    crsfFinalize(dst);
+}
+
+static timeDelta_t crsfSlotIntervalUs(void)
+{
+    const uint32_t rcFrameIntervalUs = crsfRxFrameIntervalUs();
+
+    if (rcFrameIntervalUs == 0) {
+        return CRSF_SLOT_INTERVAL_MAX_US;
+    }
+
+    return constrain(rcFrameIntervalUs * CRSF_SLOT_RC_FRAME_RATIO, CRSF_SLOT_INTERVAL_MIN_US, CRSF_SLOT_INTERVAL_MAX_US);
 }
 
 void crsfScheduleDeviceInfoResponse(void)
@@ -486,21 +533,19 @@ void initCrsfTelemetry(void)
     mspReplyPending = false;
 #endif
 
-    int index = 0;
-    crsfSchedule[index++] = BV(CRSF_FRAME_ATTITUDE_INDEX);
-    crsfSchedule[index++] = BV(CRSF_FRAME_BATTERY_SENSOR_INDEX);
-    crsfSchedule[index++] = BV(CRSF_FRAME_FLIGHT_MODE_INDEX);
+    crsfScheduleMask = BV(CRSF_FRAME_ATTITUDE_INDEX) | BV(CRSF_FRAME_BATTERY_SENSOR_INDEX) | BV(CRSF_FRAME_FLIGHT_MODE_INDEX);
 #ifdef USE_GPS
     if (feature(FEATURE_GPS)) {
-        crsfSchedule[index++] = BV(CRSF_FRAME_GPS_INDEX);
+        crsfScheduleMask |= BV(CRSF_FRAME_GPS_INDEX);
     }
 #endif
 #if defined(USE_BARO) || defined(USE_GPS)
     if (sensors(SENSOR_BARO) || (STATE(FIXED_WING_LEGACY) && feature(FEATURE_GPS))) {
-        crsfSchedule[index++] = BV(CRSF_FRAME_VARIO_SENSOR_INDEX);
+        crsfScheduleMask |= BV(CRSF_FRAME_VARIO_SENSOR_INDEX);
     }
 #endif
-    crsfScheduleCount = (uint8_t)index;
+    memset(crsfScheduleCredit, 0, sizeof(crsfScheduleCredit));
+    crsfLastFlightMode = NULL;
 }
 
 bool checkCrsfTelemetryState(void)
@@ -513,7 +558,7 @@ bool checkCrsfTelemetryState(void)
  */
 void handleCrsfTelemetry(timeUs_t currentTimeUs)
 {
-    static uint32_t crsfLastCycleTime;
+    static timeUs_t crsfLastSlotTime;
 
     if (!crsfTelemetryEnabled) {
         return;
@@ -523,14 +568,10 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
     // in between the RX frames.
     crsfRxSendTelemetryData();
 
-    // Send ad-hoc response frames as soon as possible
-#if defined(USE_MSP_OVER_TELEMETRY)
-    if (mspReplyPending) {
-        mspReplyPending = handleCrsfMspFrameBuffer(CRSF_FRAME_TX_MSP_FRAME_SIZE, &crsfSendMspResponse);
-        crsfLastCycleTime = currentTimeUs; // reset telemetry timing due to ad-hoc request
+    // Previous frame is still waiting for a gap between RX frames, don't overwrite it
+    if (!crsfRxIsTelemetryBufferEmpty()) {
         return;
     }
-#endif
 
     if (deviceInfoReplyPending) {
         sbuf_t crsfPayloadBuf;
@@ -539,16 +580,22 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
         crsfFrameDeviceInfo(dst);
         crsfFinalize(dst);
         deviceInfoReplyPending = false;
-        crsfLastCycleTime = currentTimeUs; // reset telemetry timing due to ad-hoc request
         return;
     }
 
-    // Actual telemetry data only needs to be sent at a low frequency, ie 10Hz
-    // Spread out scheduled frames evenly so each frame is sent at the same frequency.
-    if (currentTimeUs >= crsfLastCycleTime + (CRSF_CYCLETIME_US / crsfScheduleCount)) {
-        crsfLastCycleTime = currentTimeUs;
+    // Scheduled telemetry keeps its slots, also during long MSP transfers
+    if (cmpTimeUs(currentTimeUs, crsfLastSlotTime) >= crsfSlotIntervalUs()) {
+        crsfLastSlotTime = currentTimeUs;
         processCrsf();
+        return;
     }
+
+    // The rest of the downlink is free for MSP replies
+#if defined(USE_MSP_OVER_TELEMETRY)
+    if (mspReplyPending) {
+        mspReplyPending = handleCrsfMspFrameBuffer(CRSF_FRAME_TX_MSP_FRAME_SIZE, &crsfSendMspResponse);
+    }
+#endif
 }
 
 int getCrsfFrame(uint8_t *frame, crsfFrameType_e frameType)
@@ -57,6 +57,7 @@
 #include "flight/mixer.h"
 #include "flight/pid.h"
 #include "flight/servos.h"
+#include "flight/telemetry_snapshot.h"
 
 #include "io/gps.h"
 #include "io/ledstrip.h"
@@ -96,6 +97,7 @@
 #define TELEMETRY_MAVLINK_PORT_MODE     MODE_RXTX
 #define TELEMETRY_MAVLINK_MAXRATE       50
 #define TELEMETRY_MAVLINK_DELAY         ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
+#define TELEMETRY_MAVLINK_BUDGET_TICKS  2       // Unused budget carried over at most this many ticks, so an idle link can't build up a burst
 
 /**
  * MAVLink requires angles to be in the range -Pi..Pi.
@@ -176,6 +178,10 @@ static uint8_t mavRates[] = {
 
 static timeUs_t lastMavlinkMessage = 0;
 static uint8_t mavTicks[MAXSTREAMS];
+static uint16_t mavPendingStreams;          // Streams that are due but didn't fit into the link budget yet
+static uint8_t mavNextStream;               // Round robin start, so a saturated link doesn't starve the last streams
+static int32_t mavTxBudget;                 // Bytes the link can still take this tick, negative after a large message
+static int32_t mavTxBytesPerTick;
 static mavlink_message_t mavSendMsg;
 static mavlink_message_t mavRecvMsg;
 static mavlink_status_t mavRecvStatus;
@@ -296,6 +302,11 @@ void configureMAVLinkTelemetryPort(void)
         return;
     }
 
+    // 10 bits per byte on the wire, scaled by the share of time the radio can actually transmit
+    mavTxBytesPerTick = MAX(1, (int32_t)(baudRates[baudRateIndex] / 10 * telemetryConfig()->mavlink.link_duty_cycle / 100 / TELEMETRY_MAVLINK_MAXRATE));
+    mavTxBudget = mavTxBytesPerTick;
+    mavPendingStreams = 0;
+
     mavlinkTelemetryEnabled = true;
 }
 
@@ -335,11 +346,15 @@ static void mavlinkSendMessage(void)
         chan_state->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
     }
 
+    // MAVLink 2 frames come out with trailing zero payload bytes already truncated
     int msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavSendMsg);
 
-    for (int i = 0; i < msgLength; i++) {
-        serialWrite(mavlinkPort, mavBuffer[i]);
-    }
+    // Queue the whole message before the port starts sending it
+    serialBeginWrite(mavlinkPort);
+    serialWriteBuf(mavlinkPort, mavBuffer, msgLength);
+    serialEndWrite(mavlinkPort);
+
+    mavTxBudget -= msgLength;
 }
 
 void mavlinkSendSystemStatus(void)
@@ -651,7 +666,7 @@ void mavlinkSendHUDAndHeartbeat(void)
 
     // select best source for altitude
     mavAltitude = getEstimatedActualPosition(Z) / 100.0f;
-    mavClimbRate = getEstimatedActualVelocity(Z) / 100.0f;
+    mavClimbRate = telemetrySnapshot.climbRate / 100.0f;
 
     int16_t thr = rxGetChannelValue(THROTTLE);
     if (navigationIsControllingThrottle()) {
@@ -847,37 +862,77 @@ void mavlinkSendBatteryTemperatureStatusText(void)
 
 }
 
-void processMAVLinkTelemetry(timeUs_t currentTimeUs)
+static void mavlinkSendStream(enum MAV_DATA_STREAM streamNum, timeUs_t currentTimeUs)
 {
-    // is executed @ TELEMETRY_MAVLINK_MAXRATE rate
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTENDED_STATUS)) {
-        mavlinkSendSystemStatus();
-    }
-
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_RC_CHANNELS)) {
-        mavlinkSendRCChannelsAndRSSI();
-    }
+    UNUSED(currentTimeUs);
 
+    switch (streamNum) {
+        case MAV_DATA_STREAM_EXTENDED_STATUS:
+            mavlinkSendSystemStatus();
+            break;
+        case MAV_DATA_STREAM_RC_CHANNELS:
+            mavlinkSendRCChannelsAndRSSI();
+            break;
 #ifdef USE_GPS
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_POSITION)) {
-        mavlinkSendPosition(currentTimeUs);
-    }
+        case MAV_DATA_STREAM_POSITION:
+            mavlinkSendPosition(currentTimeUs);
+            break;
 #endif
-
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA1)) {
-        mavlinkSendAttitude();
+        case MAV_DATA_STREAM_EXTRA1:
+            mavlinkSendAttitude();
+            break;
+        case MAV_DATA_STREAM_EXTRA2:
+            mavlinkSendHUDAndHeartbeat();
+            break;
+        case MAV_DATA_STREAM_EXTRA3:
+            mavlinkSendBatteryTemperatureStatusText();
+            break;
+        default:
+            break;
     }
+}
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA2)) {
-        mavlinkSendHUDAndHeartbeat();
-    }
+void processMAVLinkTelemetry(timeUs_t currentTimeUs)
+{
+    // is executed @ TELEMETRY_MAVLINK_MAXRATE rate
+    mavTxBudget = MIN(mavTxBudget + mavTxBytesPerTick, mavTxBytesPerTick * TELEMETRY_MAVLINK_BUDGET_TICKS);
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA3)) {
-        mavlinkSendBatteryTemperatureStatusText();
+    for (unsigned streamNum = 0; streamNum < MAXSTREAMS; streamNum++) {
+        if (mavlinkStreamTrigger(streamNum)) {
+            mavPendingStreams |= BIT(streamNum);
+        }
     }
 
+    // Send due streams while the link has room, the rest stays pending for the next ticks
+    for (unsigned n = 0; n < MAXSTREAMS && mavPendingStreams && mavTxBudget > 0; n++) {
+        const uint8_t streamNum = mavNextStream;
+        mavNextStream = (mavNextStream + 1) % MAXSTREAMS;
+
+        if (mavPendingStreams & BIT(streamNum)) {
+            mavPendingStreams &= ~BIT(streamNum);
+            mavlinkSendStream(streamNum, currentTimeUs);
+        }
+    }
 }
 
+// Static state for MISSION UPLOAD transaction (starting with MISSION_COUNT)
+#define MAVLINK_MISSION_UPLOAD_WINDOW       4       // Items requested ahead, so the upload isn't bound by the link round trip
+#define MAVLINK_MISSION_RETRY_TIMEOUT_MS    1000
+#define MAVLINK_MISSION_MAX_RETRIES         5
+
+static bool incomingMissionActive = false;
+static int incomingMissionWpCount = 0;
+static int incomingMissionWpSequence = 0;           // Next item to store, all items before it are received
+static int incomingMissionRequestedSequence = 0;    // Next item to request
+static bool incomingMissionUseInt = false;          // GCS sent MISSION_ITEM_INT, keep requesting those
+static uint8_t incomingMissionSysId;
+static uint8_t incomingMissionCompId;
+static uint8_t incomingMissionRetries;
+static timeMs_t incomingMissionLastActivityMs;
+#ifdef USE_MISSION_STORE
+static bool incomingMissionToStore = false;
+#endif
+
 static bool handleIncoming_MISSION_CLEAR_ALL(void)
 {
     mavlink_mission_clear_all_t msg;
@@ -885,6 +940,7 @@ static bool handleIncoming_MISSION_CLEAR_ALL(void)
 
     // Check if this message is for us
     if (msg.target_system == mavSystemId) {
+        incomingMissionActive = false;
         resetWaypointList();
         mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ACCEPTED, MAV_MISSION_TYPE_MISSION);
         mavlinkSendMessage();
@@ -894,9 +950,76 @@ static bool handleIncoming_MISSION_CLEAR_ALL(void)
     return false;
 }
 
-// Static state for MISSION UPLOAD transaction (starting with MISSION_COUNT)
-static int incomingMissionWpCount = 0;
-static int incomingMissionWpSequence = 0;
+static int getMissionWaypointCount(void)
+{
+#ifdef USE_MISSION_STORE
+    if (isMissionStoreWaypointListActive()) {
+        return getMissionStoreWaypointCount();
+    }
+#endif
+    return getWaypointCount();
+}
+
+static void mavlinkSendMissionAck(uint8_t targetSystem, uint8_t targetComponent, enum MAV_MISSION_RESULT result)
+{
+    mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, targetSystem, targetComponent, result, MAV_MISSION_TYPE_MISSION);
+    mavlinkSendMessage();
+}
+
+static void mavlinkEndMissionUpload(enum MAV_MISSION_RESULT result)
+{
+    incomingMissionActive = false;
+#ifdef USE_MISSION_STORE
+    incomingMissionToStore = false;
+#endif
+    mavlinkSendMissionAck(incomingMissionSysId, incomingMissionCompId, result);
+}
+
+static void mavlinkRequestMissionWindow(void)
+{
+    while (incomingMissionRequestedSequence < incomingMissionWpCount &&
+           incomingMissionRequestedSequence < incomingMissionWpSequence + MAVLINK_MISSION_UPLOAD_WINDOW) {
+        if (incomingMissionUseInt) {
+            mavlink_msg_mission_request_int_pack(mavSystemId, mavComponentId, &mavSendMsg, incomingMissionSysId, incomingMissionCompId, incomingMissionRequestedSequence, MAV_MISSION_TYPE_MISSION);
+        }
+        else {
+            mavlink_msg_mission_request_pack(mavSystemId, mavComponentId, &mavSendMsg, incomingMissionSysId, incomingMissionCompId, incomingMissionRequestedSequence, MAV_MISSION_TYPE_MISSION);
+        }
+        mavlinkSendMessage();
+        incomingMissionRequestedSequence++;
+    }
+}
+
+static void mavlinkBeginMissionUpload(int count)
+{
+    incomingMissionActive = true;
+    incomingMissionWpCount = count; // We need to know how many items to request
+    incomingMissionWpSequence = 0;
+    incomingMissionRequestedSequence = 0;
+    incomingMissionUseInt = false;
+    incomingMissionSysId = mavRecvMsg.sysid;
+    incomingMissionCompId = mavRecvMsg.compid;
+    incomingMissionRetries = 0;
+    incomingMissionLastActivityMs = millis();
+    mavlinkRequestMissionWindow();
+}
+
+static void mavlinkMissionUploadCheckTimeout(timeMs_t currentTimeMs)
+{
+    if (!incomingMissionActive || currentTimeMs - incomingMissionLastActivityMs < MAVLINK_MISSION_RETRY_TIMEOUT_MS) {
+        return;
+    }
+
+    if (++incomingMissionRetries > MAVLINK_MISSION_MAX_RETRIES) {
+        mavlinkEndMissionUpload(MAV_MISSION_OPERATION_CANCELLED);
+        return;
+    }
+
+    // Items got lost, request the window again starting with the first missing one
+    incomingMissionRequestedSequence = incomingMissionWpSequence;
+    incomingMissionLastActivityMs = currentTimeMs;
+    mavlinkRequestMissionWindow();
+}
 
 static bool handleIncoming_MISSION_COUNT(void)
 {
@@ -905,21 +1028,38 @@ static bool handleIncoming_MISSION_COUNT(void)
 
     // Check if this message is for us
     if (msg.target_system == mavSystemId) {
-        if (msg.count <= NAV_MAX_WAYPOINTS) {
-            incomingMissionWpCount = msg.count; // We need to know how many items to request
-            incomingMissionWpSequence = 0;
-            mavlink_msg_mission_request_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, incomingMissionWpSequence, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
+#ifdef USE_MISSION_STORE
+        missionStoreInfo_t storeInfo;
+        missionStoreGetInfo(&storeInfo);
+        incomingMissionToStore = false;
+#endif
+
+        if (ARMING_FLAG(ARMED)) {
+            mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ERROR);
+            return true;
+        }
+        else if (msg.count == 0) {
+            // Nothing to request, an empty mission clears the list
+            incomingMissionActive = false;
+            resetWaypointList();
+            mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ACCEPTED);
+            return true;
+        }
+        else if (msg.count <= NAV_MAX_WAYPOINTS) {
+            mavlinkBeginMissionUpload(msg.count);
             return true;
         }
-        else if (ARMING_FLAG(ARMED)) {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ERROR, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
+#ifdef USE_MISSION_STORE
+        else if (msg.count <= storeInfo.capacity && missionStoreBeginUpload()) {
+            // Too long for the waypoint list, stream it into the mission store
+            resetWaypointList();
+            incomingMissionToStore = true;
+            mavlinkBeginMissionUpload(msg.count);
             return true;
         }
+#endif
         else {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_NO_SPACE, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
+            mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_NO_SPACE);
             return true;
         }
     }
@@ -927,6 +1067,73 @@ static bool handleIncoming_MISSION_COUNT(void)
     return false;
 }
 
+// Common part of MISSION_ITEM and MISSION_ITEM_INT, coordinates are in 1e-7 deg and altitude in m
+static void mavlinkHandleIncomingMissionItem(uint16_t seq, uint8_t frame, uint16_t command, uint8_t autocontinue, int32_t lat, int32_t lon, float alt)
+{
+    // Check supported values first
+    if (ARMING_FLAG(ARMED)) {
+        incomingMissionActive = false;
+        mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ERROR);
+        return;
+    }
+
+    if (!incomingMissionActive) {
+        // Late retransmission after the upload has ended, or no MISSION_COUNT seen
+        mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_INVALID_SEQUENCE);
+        return;
+    }
+
+    if (seq != incomingMissionWpSequence) {
+        // Duplicate of an item we already have, or one ahead of a lost item - it will be requested again
+        return;
+    }
+
+    if ((autocontinue == 0) || (command != MAV_CMD_NAV_WAYPOINT && command != MAV_CMD_NAV_RETURN_TO_LAUNCH)) {
+        mavlinkEndMissionUpload(MAV_MISSION_UNSUPPORTED);
+        return;
+    }
+
+    if ((frame != MAV_FRAME_GLOBAL_RELATIVE_ALT && frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) && !(frame == MAV_FRAME_MISSION && command == MAV_CMD_NAV_RETURN_TO_LAUNCH)) {
+        mavlinkEndMissionUpload(MAV_MISSION_UNSUPPORTED_FRAME);
+        return;
+    }
+
+    incomingMissionWpSequence++;
+    incomingMissionRetries = 0;
+    incomingMissionLastActivityMs = millis();
+
+    navWaypoint_t wp;
+    wp.action = (command == MAV_CMD_NAV_RETURN_TO_LAUNCH) ? NAV_WP_ACTION_RTH : NAV_WP_ACTION_WAYPOINT;
+    wp.lat = lat;
+    wp.lon = lon;
+    wp.alt = alt * 100.0f;
+    wp.p1 = 0;
+    wp.p2 = 0;
+    wp.p3 = 0;
+    wp.flag = (incomingMissionWpSequence >= incomingMissionWpCount) ? NAV_WP_FLAG_LAST : 0;
+
+#ifdef USE_MISSION_STORE
+    if (incomingMissionToStore) {
+        const bool lastItem = incomingMissionWpSequence >= incomingMissionWpCount;
+
+        if (!missionStoreWriteWaypoint(incomingMissionWpSequence - 1, &wp) ||
+            (lastItem && (!missionStoreFinishUpload(incomingMissionWpCount) || !loadMissionStoreWaypointList()))) {
+            mavlinkEndMissionUpload(MAV_MISSION_ERROR);
+            return;
+        }
+    }
+    else
+#endif
+    setWaypoint(incomingMissionWpSequence, &wp);
+
+    if (incomingMissionWpSequence >= incomingMissionWpCount) {
+        mavlinkEndMissionUpload(isWaypointListValid() ? MAV_MISSION_ACCEPTED : MAV_MISSION_INVALID);
+    }
+    else {
+        mavlinkRequestMissionWindow();
+    }
+}
+
 static bool handleIncoming_MISSION_ITEM(void)
 {
     mavlink_mission_item_t msg;
@@ -934,61 +1141,22 @@ static bool handleIncoming_MISSION_ITEM(void)
 
     // Check if this message is for us
     if (msg.target_system == mavSystemId) {
-        // Check supported values first
-        if (ARMING_FLAG(ARMED)) {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ERROR, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-            return true;
-        }
-
-        if ((msg.autocontinue == 0) || (msg.command != MAV_CMD_NAV_WAYPOINT && msg.command != MAV_CMD_NAV_RETURN_TO_LAUNCH)) {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_UNSUPPORTED, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-            return true;
-        }
+        mavlinkHandleIncomingMissionItem(msg.seq, msg.frame, msg.command, msg.autocontinue, (int32_t)(msg.x * 1e7f), (int32_t)(msg.y * 1e7f), msg.z);
+        return true;
+    }
 
-        if ((msg.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT) && !(msg.frame == MAV_FRAME_MISSION && msg.command == MAV_CMD_NAV_RETURN_TO_LAUNCH)) {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_UNSUPPORTED_FRAME, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-            return true;
-        }
+    return false;
+}
 
-        if (msg.seq == incomingMissionWpSequence) {
-            incomingMissionWpSequence++;
-
-            navWaypoint_t wp;
-            wp.action = (msg.command == MAV_CMD_NAV_RETURN_TO_LAUNCH) ? NAV_WP_ACTION_RTH : NAV_WP_ACTION_WAYPOINT;
-            wp.lat = (int32_t)(msg.x * 1e7f);
-            wp.lon = (int32_t)(msg.y * 1e7f);
-            wp.alt = msg.z * 100.0f;
-            wp.p1 = 0;
-            wp.p2 = 0;
-            wp.p3 = 0;
-            wp.flag = (incomingMissionWpSequence >= incomingMissionWpCount) ? NAV_WP_FLAG_LAST : 0;
-
-            setWaypoint(incomingMissionWpSequence, &wp);
-
-            if (incomingMissionWpSequence >= incomingMissionWpCount) {
-                if (isWaypointListValid()) {
-                    mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_ACCEPTED, MAV_MISSION_TYPE_MISSION);
-                    mavlinkSendMessage();
-                }
-                else {
-                    mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_INVALID, MAV_MISSION_TYPE_MISSION);
-                    mavlinkSendMessage();
-                }
-            }
-            else {
-                mavlink_msg_mission_request_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, incomingMissionWpSequence, MAV_MISSION_TYPE_MISSION);
-                mavlinkSendMessage();
-            }
-        }
-        else {
-            // Wrong sequence number received
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_INVALID_SEQUENCE, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-        }
+static bool handleIncoming_MISSION_ITEM_INT(void)
+{
+    mavlink_mission_item_int_t msg;
+    mavlink_msg_mission_item_int_decode(&mavRecvMsg, &msg);
 
+    // Check if this message is for us
+    if (msg.target_system == mavSystemId) {
+        incomingMissionUseInt = true;
+        mavlinkHandleIncomingMissionItem(msg.seq, msg.frame, msg.command, msg.autocontinue, msg.x, msg.y, msg.z);
         return true;
     }
 
@@ -1002,7 +1170,7 @@ static bool handleIncoming_MISSION_REQUEST_LIST(void)
 
     // Check if this message is for us
     if (msg.target_system == mavSystemId) {
-        mavlink_msg_mission_count_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, getWaypointCount(), MAV_MISSION_TYPE_MISSION);
+        mavlink_msg_mission_count_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, getMissionWaypointCount(), MAV_MISSION_TYPE_MISSION);
         mavlinkSendMessage();
         return true;
     }
@@ -1010,6 +1178,59 @@ static bool handleIncoming_MISSION_REQUEST_LIST(void)
     return false;
 }
 
+// Answers MISSION_REQUEST and MISSION_REQUEST_INT, the GCS may keep several of them in flight
+static void mavlinkSendMissionItem(uint16_t seq, bool useInt)
+{
+    int wpCount = getMissionWaypointCount();
+    bool wpValid = seq < wpCount;
+    navWaypoint_t wp;
+
+#ifdef USE_MISSION_STORE
+    if (wpValid && isMissionStoreWaypointListActive()) {
+        wpValid = getMissionStoreWaypoint(seq, &wp);
+    }
+    else
+#endif
+    if (wpValid) {
+        getWaypoint(seq + 1, &wp);
+    }
+
+    if (!wpValid) {
+        mavlinkSendMissionAck(mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_INVALID_SEQUENCE);
+        return;
+    }
+
+    const uint16_t command = wp.action == NAV_WP_ACTION_RTH ? MAV_CMD_NAV_RETURN_TO_LAUNCH : MAV_CMD_NAV_WAYPOINT;
+
+    if (useInt) {
+        mavlink_msg_mission_item_int_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid,
+                    seq,
+                    wp.action == NAV_WP_ACTION_RTH ? MAV_FRAME_MISSION : MAV_FRAME_GLOBAL_RELATIVE_ALT_INT,
+                    command,
+                    0,
+                    1,
+                    0, 0, 0, 0,
+                    wp.lat,
+                    wp.lon,
+                    wp.alt / 100.0f,
+                    MAV_MISSION_TYPE_MISSION);
+    }
+    else {
+        mavlink_msg_mission_item_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid,
+                    seq,
+                    wp.action == NAV_WP_ACTION_RTH ? MAV_FRAME_MISSION : MAV_FRAME_GLOBAL_RELATIVE_ALT,
+                    command,
+                    0,
+                    1,
+                    0, 0, 0, 0,
+                    wp.lat / 1e7f,
+                    wp.lon / 1e7f,
+                    wp.alt / 100.0f,
+                    MAV_MISSION_TYPE_MISSION);
+    }
+    mavlinkSendMessage();
+}
+
 static bool handleIncoming_MISSION_REQUEST(void)
 {
     mavlink_mission_request_t msg;
@@ -1017,30 +1238,21 @@ static bool handleIncoming_MISSION_REQUEST(void)
 
     // Check if this message is for us
     if (msg.target_system == mavSystemId) {
-        int wpCount = getWaypointCount();
-
-        if (msg.seq < wpCount) {
-            navWaypoint_t wp;
-            getWaypoint(msg.seq + 1, &wp);
-
-            mavlink_msg_mission_item_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid,
-                        msg.seq,
-                        wp.action == NAV_WP_ACTION_RTH ? MAV_FRAME_MISSION : MAV_FRAME_GLOBAL_RELATIVE_ALT,
-                        wp.action == NAV_WP_ACTION_RTH ? MAV_CMD_NAV_RETURN_TO_LAUNCH : MAV_CMD_NAV_WAYPOINT,
-                        0,
-                        1,
-                        0, 0, 0, 0,
-                        wp.lat / 1e7f,
-                        wp.lon / 1e7f,
-                        wp.alt / 100.0f,
-                        MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-        }
-        else {
-            mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg, mavRecvMsg.sysid, mavRecvMsg.compid, MAV_MISSION_INVALID_SEQUENCE, MAV_MISSION_TYPE_MISSION);
-            mavlinkSendMessage();
-        }
+        mavlinkSendMissionItem(msg.seq, false);
+        return true;
+    }
 
+    return false;
+}
+
+static bool handleIncoming_MISSION_REQUEST_INT(void)
+{
+    mavlink_mission_request_int_t msg;
+    mavlink_msg_mission_request_int_decode(&mavRecvMsg, &msg);
+
+    // Check if this message is for us
+    if (msg.target_system == mavSystemId) {
+        mavlinkSendMissionItem(msg.seq, true);
         return true;
     }
 
@@ -1071,10 +1283,14 @@ static bool processMAVLinkIncomingTelemetry(void)
                     return handleIncoming_MISSION_COUNT();
                 case MAVLINK_MSG_ID_MISSION_ITEM:
                     return handleIncoming_MISSION_ITEM();
+                case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+                    return handleIncoming_MISSION_ITEM_INT();
                 case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
                     return handleIncoming_MISSION_REQUEST_LIST();
                 case MAVLINK_MSG_ID_MISSION_REQUEST:
                     return handleIncoming_MISSION_REQUEST();
+                case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+                    return handleIncoming_MISSION_REQUEST_INT();
                 case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
                     return handleIncoming_RC_CHANNELS_OVERRIDE();
                 default:
@@ -1088,8 +1304,6 @@ static bool processMAVLinkIncomingTelemetry(void)
 
 void handleMAVLinkTelemetry(timeUs_t currentTimeUs)
 {
-    static bool incomingRequestServed;
-
     if (!mavlinkTelemetryEnabled) {
         return;
     }
@@ -1098,18 +1312,13 @@ void handleMAVLinkTelemetry(timeUs_t currentTimeUs)
         return;
     }
 
-    // If we did serve data on incoming request - skip next scheduled messages batch to avoid link clogging
-    if (processMAVLinkIncomingTelemetry()) {
-        incomingRequestServed = true;
-    }
+    // Replies to incoming requests are charged to the link budget, delaying the scheduled streams accordingly
+    processMAVLinkIncomingTelemetry();
+    mavlinkMissionUploadCheckTimeout(millis());
 
     if ((currentTimeUs - lastMavlinkMessage) >= TELEMETRY_MAVLINK_DELAY) {
-        // Only process scheduled data if we didn't serve any incoming request this cycle
-        if (!incomingRequestServed) {
-            processMAVLinkTelemetry(currentTimeUs);
-        }
+        processMAVLinkTelemetry(currentTimeUs);
         lastMavlinkMessage = currentTimeUs;
-        incomingRequestServed = false;
     }
 }
 
@@ -352,7 +352,7 @@ static void sendSMS(void)
         groundSpeed = gpsSol.groundSpeed / 100;
 
         char buf[20];
-        olc_encode(gpsSol.llh.lat, gpsSol.llh.lon, 11, buf, sizeof(buf));
+        olc_encode_cached(gpsSol.llh.lat, gpsSol.llh.lon, 11, buf, sizeof(buf));
 
         // URLencode plus code (replace plus sign with %2B)
         for (char *in = buf, *out = pluscode_url; *in; ) {
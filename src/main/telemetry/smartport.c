@@ -95,44 +95,54 @@ enum
     FSSP_DATAID_AZIMUTH    = 0x0460
 };
 
-const uint16_t frSkyDataIdTable[] = {
-    FSSP_DATAID_SPEED     ,
-    FSSP_DATAID_VFAS      ,
-    FSSP_DATAID_CURRENT   ,
-    //FSSP_DATAID_RPM       ,
-    FSSP_DATAID_ALTITUDE  ,
-    FSSP_DATAID_FUEL      ,
-    //FSSP_DATAID_ADC1      ,
-    //FSSP_DATAID_ADC2      ,
-    FSSP_DATAID_LATLONG   ,
-    FSSP_DATAID_LATLONG   , // twice
-    //FSSP_DATAID_CAP_USED  ,
-    FSSP_DATAID_VARIO     ,
-    //FSSP_DATAID_CELLS     ,
-    //FSSP_DATAID_CELLS_LAST,
-    FSSP_DATAID_HEADING   ,
-    FSSP_DATAID_FPV       ,
-    FSSP_DATAID_PITCH     ,
-    FSSP_DATAID_ROLL      ,
-    FSSP_DATAID_ACCX      ,
-    FSSP_DATAID_ACCY      ,
-    FSSP_DATAID_ACCZ      ,
-    FSSP_DATAID_T1        ,
-    FSSP_DATAID_T2        ,
-    FSSP_DATAID_HOME_DIST ,
-    FSSP_DATAID_GPS_ALT   ,
-    FSSP_DATAID_ASPD      ,
-    // FSSP_DATAID_A3        ,
-    FSSP_DATAID_A4        ,
-    FSSP_DATAID_AZIMUTH ,
-    0
-};
-
 #define __USE_C99_MATH // for roundf()
 #define SMARTPORT_BAUD 57600
 #define SMARTPORT_UART_MODE MODE_RXTX
 #define SMARTPORT_SERVICE_TIMEOUT_MS 1 // max allowed time to find a value to send
 
+#define SMARTPORT_SENSOR_LONGITUDE      (1 << 0)    // second half of FSSP_DATAID_LATLONG
+
+typedef struct smartPortSensor_s {
+    uint16_t id;
+    uint8_t priority;       // relative share of the bandwidth among values of the same age
+    uint8_t flags;
+} smartPortSensor_t;
+
+typedef struct smartPortSensorState_s {
+    uint32_t lastValue;     // value as last put on the wire
+    timeMs_t lastSentMs;    // 0 if never sent
+} smartPortSensorState_t;
+
+static const smartPortSensor_t smartPortSensors[] = {
+    { FSSP_DATAID_SPEED,     3, 0 },
+    { FSSP_DATAID_VFAS,      4, 0 },
+    { FSSP_DATAID_CURRENT,   4, 0 },
+    { FSSP_DATAID_ALTITUDE,  4, 0 },
+    { FSSP_DATAID_FUEL,      2, 0 },
+    { FSSP_DATAID_LATLONG,   3, 0 },
+    { FSSP_DATAID_LATLONG,   3, SMARTPORT_SENSOR_LONGITUDE },
+    { FSSP_DATAID_VARIO,     4, 0 },
+    { FSSP_DATAID_HEADING,   3, 0 },
+    { FSSP_DATAID_FPV,       2, 0 },
+    { FSSP_DATAID_PITCH,     4, 0 },
+    { FSSP_DATAID_ROLL,      4, 0 },
+    { FSSP_DATAID_ACCX,      3, 0 },
+    { FSSP_DATAID_ACCY,      3, 0 },
+    { FSSP_DATAID_ACCZ,      3, 0 },
+    { FSSP_DATAID_T1,        1, 0 },
+    { FSSP_DATAID_T2,        1, 0 },
+    { FSSP_DATAID_HOME_DIST, 2, 0 },
+    { FSSP_DATAID_GPS_ALT,   2, 0 },
+    { FSSP_DATAID_ASPD,      3, 0 },
+    { FSSP_DATAID_A4,        1, 0 },
+    { FSSP_DATAID_AZIMUTH,   2, 0 },
+};
+
+static smartPortSensorState_t smartPortSensorState[ARRAYLEN(smartPortSensors)];
+
+#define SMARTPORT_CHANGED_VALUE_BOOST   4       // a value that changed since it was last sent ages this much faster
+#define SMARTPORT_SENSOR_AGE_MAX_MS     60000U
+
 static serialPort_t *smartPortSerialPort = NULL; // The 'SmartPort'(tm) Port.
 static serialPortConfig_t *portConfig;
 
@@ -146,7 +156,6 @@ enum
 };
 
 static uint8_t telemetryState = TELEMETRY_STATE_UNINITIALIZED;
-static uint8_t smartPortIdCnt = 0;
 
 typedef struct smartPortFrame_s {
     uint8_t  sensorId;
@@ -349,6 +358,215 @@ static bool smartPortShouldSendGPSData(void)
     return feature(FEATURE_GPS) && (STATE(GPS_FIX) || !ARMING_FLAG(WAS_EVER_ARMED));
 }
 
+// Returns false when the value is not available on this craft
+static bool smartPortGetSensorValue(const smartPortSensor_t *sensor, uint32_t *value)
+{
+    switch (sensor->id) {
+        case FSSP_DATAID_VFAS       :
+            if (isBatteryVoltageConfigured()) {
+                *value = telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage();
+                return true;
+            }
+            break;
+        case FSSP_DATAID_CURRENT    :
+            if (isAmperageConfigured()) {
+                *value = getAmperage() / 10; // given in 10mA steps, unknown requested unit
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ALTITUDE   :
+            if (sensors(SENSOR_BARO)) {
+                *value = getEstimatedActualPosition(Z); // unknown given unit, requested 100 = 1 meter
+                return true;
+            }
+            break;
+        case FSSP_DATAID_FUEL       :
+            if (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_PERCENT) {
+                *value = calculateBatteryPercentage(); // Show remaining battery % if smartport_fuel_percent=ON
+                return true;
+            } else if (isAmperageConfigured()) {
+                *value = (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_MAH ? getMAhDrawn() : getMWhDrawn());
+                return true;
+            }
+            break;
+        case FSSP_DATAID_VARIO      :
+            if (sensors(SENSOR_BARO)) {
+                *value = lrintf(getEstimatedActualVelocity(Z)); // unknown given unit but requested in 100 = 1m/s
+                return true;
+            }
+            break;
+        case FSSP_DATAID_HEADING    :
+            *value = attitude.values.yaw * 10; // given in 10*deg, requested in 10000 = 100 deg
+            return true;
+        case FSSP_DATAID_PITCH      :
+            if (telemetryConfig()->frsky_pitch_roll) {
+                *value = attitude.values.pitch; // given in 10*deg
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ROLL       :
+            if (telemetryConfig()->frsky_pitch_roll) {
+                *value = attitude.values.roll; // given in 10*deg
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ACCX       :
+            if (!telemetryConfig()->frsky_pitch_roll) {
+                *value = lrintf(100 * acc.accADCf[X]);
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ACCY       :
+            if (!telemetryConfig()->frsky_pitch_roll) {
+                *value = lrintf(100 * acc.accADCf[Y]);
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ACCZ       :
+            if (!telemetryConfig()->frsky_pitch_roll) {
+                *value = lrintf(100 * acc.accADCf[Z]);
+                return true;
+            }
+            break;
+        case FSSP_DATAID_T1         :
+            *value = frskyGetFlightMode();
+            return true;
+#ifdef USE_GPS
+        case FSSP_DATAID_T2         :
+            if (smartPortShouldSendGPSData()) {
+                *value = frskyGetGPSState();
+                return true;
+            }
+            break;
+        case FSSP_DATAID_SPEED      :
+            if (smartPortShouldSendGPSData()) {
+                //convert to knots: 1cm/s = 0.0194384449 knots
+                //Speed should be sent in knots/1000 (GPS speed is in cm/s)
+                *value = gpsSol.groundSpeed * 1944 / 100;
+                return true;
+            }
+            break;
+        case FSSP_DATAID_LATLONG    :
+            if (smartPortShouldSendGPSData()) {
+                uint32_t tmpui = 0;
+                // the same ID is sent twice, one for longitude, one for latitude
+                // the MSB of the sent uint32_t helps FrSky keep track
+                if (sensor->flags & SMARTPORT_SENSOR_LONGITUDE) {
+                    tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
+                    tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
+                    if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
+                }
+                else {
+                    tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
+                    tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
+                    if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
+                }
+                *value = tmpui;
+                return true;
+            }
+            break;
+        case FSSP_DATAID_HOME_DIST  :
+            if (smartPortShouldSendGPSData()) {
+                *value = GPS_distanceToHome;
+                return true;
+            }
+            break;
+        case FSSP_DATAID_GPS_ALT    :
+            if (smartPortShouldSendGPSData()) {
+                *value = gpsSol.llh.alt; // cm
+                return true;
+            }
+            break;
+        case FSSP_DATAID_FPV       :
+            if (smartPortShouldSendGPSData()) {
+                *value = gpsSol.groundCourse; // given in 10*deg
+                return true;
+            }
+            break;
+        case FSSP_DATAID_AZIMUTH    :
+            if (smartPortShouldSendGPSData()) {
+                int16_t h = GPS_directionToHome;
+                if (h < 0) {
+                    h += 360;
+                }
+                if(h >= 180)
+                    h = h - 180;
+                else
+                    h = h + 180;
+                *value = h * 10; // given in 10*deg
+                return true;
+            }
+            break;
+#endif
+        case FSSP_DATAID_A4         :
+            if (isBatteryVoltageConfigured()) {
+                *value = getBatteryAverageCellVoltage();
+                return true;
+            }
+            break;
+        case FSSP_DATAID_ASPD       :
+#ifdef USE_PITOT
+            if (sensors(SENSOR_PITOT)) {
+                *value = getAirspeedEstimate() * 0.194384449f; // cm/s to knots*1
+                return true;
+            }
+#endif
+            break;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+// Picks the available value whose receiver copy is the most out of date, weighted by priority.
+// Values that changed since they were last sent age faster, so static ones only get a refresh now and then.
+static int smartPortNextSensor(timeMs_t currentTimeMs, uint32_t *value)
+{
+    int next = -1;
+    uint32_t nextScore = 0;
+
+    for (unsigned i = 0; i < ARRAYLEN(smartPortSensors); i++) {
+        uint32_t sensorValue;
+        if (!smartPortGetSensorValue(&smartPortSensors[i], &sensorValue)) {
+            continue;
+        }
+
+        const smartPortSensorState_t *state = &smartPortSensorState[i];
+        const uint32_t ageMs = state->lastSentMs ? MIN(currentTimeMs - state->lastSentMs, SMARTPORT_SENSOR_AGE_MAX_MS) : SMARTPORT_SENSOR_AGE_MAX_MS;
+        uint32_t score = (ageMs + 1) * smartPortSensors[i].priority;
+        if (sensorValue != state->lastValue) {
+            score *= SMARTPORT_CHANGED_VALUE_BOOST;
+        }
+
+        if (score > nextScore) {
+            next = i;
+            nextScore = score;
+            *value = sensorValue;
+        }
+    }
+
+    return next;
+}
+
+int smartPortGetSensorCount(void)
+{
+    return ARRAYLEN(smartPortSensors);
+}
+
+bool smartPortGetSensorAge(int index, uint16_t *id, timeMs_t *ageMs)
+{
+    const smartPortSensorState_t *state = &smartPortSensorState[index];
+
+    if (!state->lastSentMs) {
+        return false;
+    }
+
+    *id = smartPortSensors[index].id;
+    *ageMs = millis() - state->lastSentMs;
+    return true;
+}
+
 void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clearToSend, const uint32_t *requestTimeout)
 {
     if (payload) {
@@ -364,203 +582,41 @@ void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clear
 #endif
     }
 
-    bool doRun = true;
-    while (doRun && *clearToSend) {
-        // Ensure we won't get stuck in the loop if there happens to be nothing available to send in a timely manner - dump the slot if we loop in there for too long.
-        if (requestTimeout) {
-            if (millis() >= *requestTimeout) {
-                *clearToSend = false;
+    if (!*clearToSend) {
+        return;
+    }
 
-                return;
-            }
-        } else {
-            doRun = false;
-        }
+    // Dump the slot if we are already too late to answer it
+    const timeMs_t currentTimeMs = millis();
+    if (requestTimeout && currentTimeMs >= *requestTimeout) {
+        *clearToSend = false;
+        return;
+    }
 
 #if defined(USE_MSP_OVER_TELEMETRY)
-        if (smartPortMspReplyPending) {
-            smartPortMspReplyPending = sendMspReply(SMARTPORT_MSP_PAYLOAD_SIZE, &smartPortSendMspResponse);
-            *clearToSend = false;
+    if (smartPortMspReplyPending) {
+        smartPortMspReplyPending = sendMspReply(SMARTPORT_MSP_PAYLOAD_SIZE, &smartPortSendMspResponse);
+        *clearToSend = false;
 
-            return;
-        }
+        return;
+    }
 #endif
 
-        // we can send back any data we want, our table keeps track of the order and frequency of each data type we send
-        uint16_t id = frSkyDataIdTable[smartPortIdCnt];
-        if (id == 0) { // end of table reached, loop back
-            smartPortIdCnt = 0;
-            id = frSkyDataIdTable[smartPortIdCnt];
-        }
-        smartPortIdCnt++;
-
-        switch (id) {
-            case FSSP_DATAID_VFAS       :
-                if (isBatteryVoltageConfigured()) {
-                    uint16_t vfasVoltage = telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage();
-                    smartPortSendPackage(id, vfasVoltage);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_CURRENT    :
-                if (isAmperageConfigured()) {
-                    smartPortSendPackage(id, getAmperage() / 10); // given in 10mA steps, unknown requested unit
-                    *clearToSend = false;
-                }
-                break;
-            //case FSSP_DATAID_RPM        :
-            case FSSP_DATAID_ALTITUDE   :
-                if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, getEstimatedActualPosition(Z)); // unknown given unit, requested 100 = 1 meter
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_FUEL       :
-                if (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_PERCENT) {
-                    smartPortSendPackage(id, calculateBatteryPercentage()); // Show remaining battery % if smartport_fuel_percent=ON
-                    *clearToSend = false;
-                } else if (isAmperageConfigured()) {
-                    smartPortSendPackage(id, (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_MAH ? getMAhDrawn() : getMWhDrawn()));
-                    *clearToSend = false;
-                }
-                break;
-            //case FSSP_DATAID_ADC1       :
-            //case FSSP_DATAID_ADC2       :
-            //case FSSP_DATAID_CAP_USED   :
-            case FSSP_DATAID_VARIO      :
-                if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, lrintf(getEstimatedActualVelocity(Z))); // unknown given unit but requested in 100 = 1m/s
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_HEADING    :
-                smartPortSendPackage(id, attitude.values.yaw * 10); // given in 10*deg, requested in 10000 = 100 deg
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_PITCH      :
-                if (telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, attitude.values.pitch); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ROLL       :
-                if (telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, attitude.values.roll); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCX       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[X]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCY       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[Y]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCZ       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[Z]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_T1         :
-                {
-                    smartPortSendPackage(id, frskyGetFlightMode());
-                    *clearToSend = false;
-                    break;
-                }
-#ifdef USE_GPS
-            case FSSP_DATAID_T2         :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, frskyGetGPSState());
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_SPEED      :
-                if (smartPortShouldSendGPSData()) {
-                    //convert to knots: 1cm/s = 0.0194384449 knots
-                    //Speed should be sent in knots/1000 (GPS speed is in cm/s)
-                    uint32_t tmpui = gpsSol.groundSpeed * 1944 / 100;
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_LATLONG    :
-                if (smartPortShouldSendGPSData()) {
-                    uint32_t tmpui = 0;
-                    // the same ID is sent twice, one for longitude, one for latitude
-                    // the MSB of the sent uint32_t helps FrSky keep track
-                    // the even/odd bit of our counter helps us keep track
-                    if (smartPortIdCnt & 1) {
-                        tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
-                    }
-                    else {
-                        tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
-                    }
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_HOME_DIST  :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, GPS_distanceToHome);
-                     *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_GPS_ALT    :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, gpsSol.llh.alt); // cm
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_FPV       :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, gpsSol.groundCourse); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_AZIMUTH    :
-                if (smartPortShouldSendGPSData()) {
-                    int16_t h = GPS_directionToHome;
-                    if (h < 0) {
-                        h += 360;
-                    }
-                    if(h >= 180)
-                        h = h - 180;
-                    else
-                        h = h + 180;
-                    smartPortSendPackage(id, h *10); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-#endif
-            case FSSP_DATAID_A4         :
-                if (isBatteryVoltageConfigured()) {
-                    smartPortSendPackage(id, getBatteryAverageCellVoltage());
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ASPD       :
-#ifdef USE_PITOT
-                if (sensors(SENSOR_PITOT)) {
-                    smartPortSendPackage(id, getAirspeedEstimate() * 0.194384449f); // cm/s to knots*1
-                    *clearToSend = false;
-                }
-#endif
-                break;
-            default:
-                break;
-                // if nothing is sent, hasRequest isn't cleared, we already incremented the counter, just loop back to the start
+    uint32_t value;
+    const int index = smartPortNextSensor(currentTimeMs, &value);
+
+    if (index < 0) {
+        // Nothing available to send, on serial SmartPort the slot is dumped
+        if (requestTimeout) {
+            *clearToSend = false;
         }
+        return;
     }
+
+    smartPortSendPackage(smartPortSensors[index].id, value);
+    smartPortSensorState[index].lastValue = value;
+    smartPortSensorState[index].lastSentMs = currentTimeMs;
+    *clearToSend = false;
 }
 
 static bool serialCheckQueueEmpty(void)
@@ -88,6 +88,7 @@ typedef struct telemetryConfig_s {
         uint8_t extra2_rate;
         uint8_t extra3_rate;
         uint8_t version;
+        uint8_t link_duty_cycle;
     } mavlink;
 } telemetryConfig_t;
 
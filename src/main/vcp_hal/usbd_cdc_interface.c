@@ -53,6 +53,8 @@
 #include "usbd_cdc.h"
 #include "usbd_cdc_interface.h"
 #include "stdbool.h"
+#include <string.h>
+#include "common/maths.h"
 #include "drivers/time.h"
 
 /* Private typedef -----------------------------------------------------------*/
@@ -90,6 +92,8 @@ static void (*ctrlLineStateCb)(void *context, uint16_t ctrlLineState);
 static void *ctrlLineStateCbContext;
 static void (*baudRateCb)(void *context, uint32_t baud);
 static void *baudRateCbContext;
+static void (*rxCb)(void *context);
+static void *rxCbContext;
 
 /* Private function prototypes -----------------------------------------------*/
 static int8_t CDC_Itf_Init(void);
@@ -290,6 +294,8 @@ static int8_t CDC_Itf_Receive(uint8_t* Buf, uint32_t *Len)
         // This will happen after a packet that's exactly 64 bytes is received.
         // The USB protocol requires that an empty (0 byte) packet immediately follow.
         USBD_CDC_ReceivePacket(&USBD_Device);
+    } else if (rxCb) {
+        rxCb(rxCbContext);
     }
     return (USBD_OK);
 }
@@ -344,17 +350,14 @@ static void Error_Handler(void)
 uint32_t CDC_Receive_DATA(uint8_t* recvBuf, uint32_t len)
 {
     uint32_t count = 0;
-    if ( (rxBuffPtr != NULL))
+    if ( (rxBuffPtr != NULL) && (rxAvailable > 0))
     {
-        while ((rxAvailable > 0) && count < len)
-        {
-            recvBuf[count] = rxBuffPtr[0];
-            rxBuffPtr++;
-            rxAvailable--;
-            count++;
-            if (rxAvailable < 1)
-                USBD_CDC_ReceivePacket(&USBD_Device);
-        }
+        count = MIN(rxAvailable, len);
+        memcpy(recvBuf, rxBuffPtr, count);
+        rxBuffPtr += count;
+        rxAvailable -= count;
+        if (rxAvailable < 1)
+            USBD_CDC_ReceivePacket(&USBD_Device);
     }
     return count;
 }
@@ -389,13 +392,20 @@ uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
     USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)USBD_Device.pCDC_ClassData;
     while (hcdc->TxState != 0);
 
-    for (uint32_t i = 0; i < sendLength; i++)
+    uint32_t remaining = sendLength;
+    while (remaining > 0)
     {
-        UserTxBuffer[UserTxBufPtrIn] = ptrBuffer[i];
-        UserTxBufPtrIn = (UserTxBufPtrIn + 1) % APP_TX_DATA_SIZE;
-        while (CDC_Send_FreeBytes() == 0) {
+        // Copy as much as fits up to the end of the ring, the packet timer sends it in full packets
+        const uint32_t chunk = MIN(MIN(remaining, CDC_Send_FreeBytes()), APP_TX_DATA_SIZE - UserTxBufPtrIn);
+        if (chunk == 0) {
             delay(1);
+            continue;
         }
+
+        memcpy(&UserTxBuffer[UserTxBufPtrIn], ptrBuffer, chunk);
+        UserTxBufPtrIn = (UserTxBufPtrIn + chunk) % APP_TX_DATA_SIZE;
+        ptrBuffer += chunk;
+        remaining -= chunk;
     }
     return sendLength;
 }
@@ -463,4 +473,17 @@ void CDC_SetCtrlLineStateCb(void (*cb)(void *context, uint16_t ctrlLineState), v
     ctrlLineStateCb = cb;
 }
 
+/*******************************************************************************
+ * Function Name  : CDC_SetRxCb
+ * Description    : Set a callback to call when data was received
+ * Input          : callback function and context.
+ * Output         : None.
+ * Return         : None.
+ *******************************************************************************/
+void CDC_SetRxCb(void (*cb)(void *context), void *context)
+{
+    rxCbContext = context;
+    rxCb = cb;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -88,6 +88,7 @@ uint8_t usbIsConnected(void);
 uint32_t CDC_BaudRate(void);
 void CDC_SetCtrlLineStateCb(void (*cb)(void *context, uint16_t ctrlLineState), void *context);
 void CDC_SetBaudRateCb(void (*cb)(void *context, uint32_t baud), void *context);
+void CDC_SetRxCb(void (*cb)(void *context), void *context);
 
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
@@ -27,6 +27,8 @@
 #include "usbd_cdc_vcp.h"
 #include "stm32f4xx_conf.h"
 #include "stdbool.h"
+#include <string.h>
+#include "common/maths.h"
 #include "drivers/time.h"
 
 LINE_CODING g_lc;
@@ -62,6 +64,8 @@ static void (*ctrlLineStateCb)(void* context, uint16_t ctrlLineState);
 static void *ctrlLineStateCbContext;
 static void (*baudRateCb)(void *context, uint32_t baud);
 static void *baudRateCbContext;
+static void (*rxCb)(void *context);
+static void *rxCbContext;
 
 __ALIGN_BEGIN USB_OTG_CORE_HANDLE  USB_OTG_dev __ALIGN_END;
 
@@ -209,13 +213,18 @@ static uint16_t VCP_DataTx(const uint8_t* Buf, uint32_t Len)
     */
     while (USB_Tx_State != 0);
 
-    for (uint32_t i = 0; i < Len; i++) {
-        APP_Rx_Buffer[APP_Rx_ptr_in] = Buf[i];
-        APP_Rx_ptr_in = (APP_Rx_ptr_in + 1) % APP_RX_DATA_SIZE;
-
-        while (CDC_Send_FreeBytes() == 0) {
+    while (Len > 0) {
+        // Copy as much as fits up to the end of the ring, the IN endpoint sends it in full packets
+        const uint32_t chunk = MIN(MIN(Len, CDC_Send_FreeBytes()), APP_RX_DATA_SIZE - APP_Rx_ptr_in);
+        if (chunk == 0) {
             delay(1);
+            continue;
         }
+
+        memcpy(&APP_Rx_Buffer[APP_Rx_ptr_in], Buf, chunk);
+        APP_Rx_ptr_in = (APP_Rx_ptr_in + chunk) % APP_RX_DATA_SIZE;
+        Buf += chunk;
+        Len -= chunk;
     }
 
     return USBD_OK;
@@ -233,9 +242,14 @@ uint32_t CDC_Receive_DATA(uint8_t* recvBuf, uint32_t len)
     uint32_t count = 0;
 
     while (APP_Tx_ptr_out != APP_Tx_ptr_in && count < len) {
-        recvBuf[count] = APP_Tx_Buffer[APP_Tx_ptr_out];
-        APP_Tx_ptr_out = (APP_Tx_ptr_out + 1) % APP_TX_DATA_SIZE;
-        count++;
+        // Contiguous part of the ring only, the second pass picks up the wrapped part
+        const uint32_t ptrIn = APP_Tx_ptr_in;
+        const uint32_t available = (ptrIn > APP_Tx_ptr_out) ? ptrIn - APP_Tx_ptr_out : APP_TX_DATA_SIZE - APP_Tx_ptr_out;
+        const uint32_t chunk = MIN(available, len - count);
+
+        memcpy(&recvBuf[count], &APP_Tx_Buffer[APP_Tx_ptr_out], chunk);
+        APP_Tx_ptr_out = (APP_Tx_ptr_out + chunk) % APP_TX_DATA_SIZE;
+        count += chunk;
     }
     return count;
 }
@@ -272,6 +286,10 @@ static uint16_t VCP_DataRx(uint8_t* Buf, uint32_t Len)
         APP_Tx_ptr_in = (APP_Tx_ptr_in + 1) % APP_TX_DATA_SIZE;
     }
 
+    if (rxCb && Len) {
+        rxCb(rxCbContext);
+    }
+
     return USBD_OK;
 }
 
@@ -337,4 +355,17 @@ void CDC_SetCtrlLineStateCb(void (*cb)(void *context, uint16_t ctrlLineState), v
     ctrlLineStateCb = cb;
 }
 
+/*******************************************************************************
+ * Function Name  : CDC_SetRxCb
+ * Description    : Set a callback to call when data was received
+ * Input          : callback function and context.
+ * Output         : None.
+ * Return         : None.
+ *******************************************************************************/
+void CDC_SetRxCb(void (*cb)(void *context), void *context)
+{
+    rxCbContext = context;
+    rxCb = cb;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
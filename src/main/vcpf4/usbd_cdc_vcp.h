@@ -46,6 +46,7 @@ uint8_t usbIsConnected(void);   // HJI
 uint32_t CDC_BaudRate(void);
 void CDC_SetCtrlLineStateCb(void (*cb)(void *context, uint16_t ctrlLineState), void *context);
 void CDC_SetBaudRateCb(void (*cb)(void *context, uint32_t baud), void *context);
+void CDC_SetRxCb(void (*cb)(void *context), void *context);
 
 /* External variables --------------------------------------------------------*/
 extern __IO uint32_t bDeviceState; /* USB device status */
@@ -0,0 +1,95 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Minimal harness for the *_benchmark_unittest microbenchmarks. A kernel is
+ * called in batches and the fastest batch is reported, which is the least
+ * disturbed by the rest of the host and makes numbers of two builds on the
+ * same machine comparable. Cycles come from the time stamp counter on x86
+ * hosts, which counts at a fixed reference rate rather than the core clock.
+ *
+ * Benchmarks are built with -O2 like the firmware, see CMakeLists.txt, and
+ * `make benchmark` runs them all.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_HAS_CYCLES
+#endif
+
+#define BENCHMARK_BATCHES   7
+
+typedef struct {
+    double nsPerCall;
+    double cyclesPerCall;   // 0 when the host has no cycle counter
+} benchmarkResult_t;
+
+// Keeps results of the benchmarked calls alive without adding work to the loop
+template <typename T> static inline void benchmarkKeep(const T &value)
+{
+    __asm__ volatile("" : : "g"(&value) : "memory");
+}
+
+static inline uint64_t benchmarkCycles(void)
+{
+#ifdef BENCHMARK_HAS_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+template <typename F> static benchmarkResult_t benchmarkRun(const char *name, uint32_t callsPerBatch, F call)
+{
+    benchmarkResult_t best = { 0, 0 };
+
+    // Warm up caches and branch predictors
+    for (uint32_t n = 0; n < callsPerBatch / 4; n++) {
+        call(n);
+    }
+
+    for (int batch = 0; batch < BENCHMARK_BATCHES; batch++) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t startCycles = benchmarkCycles();
+        for (uint32_t n = 0; n < callsPerBatch; n++) {
+            call(n);
+        }
+        const uint64_t cycles = benchmarkCycles() - startCycles;
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / callsPerBatch;
+        if (batch == 0 || ns < best.nsPerCall) {
+            best.nsPerCall = ns;
+            best.cyclesPerCall = (double)cycles / callsPerBatch;
+        }
+    }
+
+#ifdef BENCHMARK_HAS_CYCLES
+    printf("[ BENCH    ] %-32s %9.2f ns/call %9.1f cycles/call\n", name, best.nsPerCall, best.cyclesPerCall);
+#else
+    printf("[ BENCH    ] %-32s %9.2f ns/call\n", name, best.nsPerCall);
+#endif
+
+    return best;
+}
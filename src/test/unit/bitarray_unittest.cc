@@ -94,3 +94,51 @@ TEST(BitArrayTest, TestOutOfBounds)
     EXPECT_EQ(-1, BITARRAY_FIND_FIRST_SET(p, bits));
     EXPECT_EQ(-1, BITARRAY_FIND_FIRST_SET(p, bits + 1));
 }
+
+TEST(BitArrayTest, TestAndOr)
+{
+    BITARRAY_DECLARE(a, 64);
+    BITARRAY_DECLARE(b, 64);
+    BITARRAY_DECLARE(r, 64);
+    BITARRAY_CLR_ALL(a);
+    BITARRAY_CLR_ALL(b);
+
+    bitArraySet(a, 3);
+    bitArraySet(a, 40);
+    bitArraySet(b, 40);
+    bitArraySet(b, 63);
+
+    BITARRAY_AND(r, a, b);
+    EXPECT_EQ(40, BITARRAY_FIND_FIRST_SET(r, 0));
+    EXPECT_EQ(-1, BITARRAY_FIND_FIRST_SET(r, 41));
+
+    BITARRAY_OR(r, a, b);
+    EXPECT_EQ(3, BITARRAY_FIND_FIRST_SET(r, 0));
+    EXPECT_EQ(40, BITARRAY_FIND_FIRST_SET(r, 4));
+    EXPECT_EQ(63, BITARRAY_FIND_FIRST_SET(r, 41));
+
+    // In place
+    BITARRAY_AND(a, a, b);
+    EXPECT_EQ(40, BITARRAY_FIND_FIRST_SET(a, 0));
+    EXPECT_EQ(-1, BITARRAY_FIND_FIRST_SET(a, 41));
+}
+
+TEST(BitArrayTest, TestFindFirstDiff)
+{
+    BITARRAY_DECLARE(a, 64);
+    BITARRAY_DECLARE(b, 64);
+    BITARRAY_CLR_ALL(a);
+    BITARRAY_CLR_ALL(b);
+
+    EXPECT_EQ(-1, BITARRAY_FIND_FIRST_DIFF(a, b));
+
+    bitArraySet(a, 50);
+    bitArraySet(b, 50);
+    EXPECT_EQ(-1, BITARRAY_FIND_FIRST_DIFF(a, b));
+
+    bitArraySet(b, 33);
+    EXPECT_EQ(33, BITARRAY_FIND_FIRST_DIFF(a, b));
+
+    bitArraySet(a, 31);
+    EXPECT_EQ(31, BITARRAY_FIND_FIRST_DIFF(a, b));
+}
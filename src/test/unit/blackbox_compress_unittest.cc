@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "blackbox/blackbox_compress.h"
+}
+
+#include "gtest/gtest.h"
+
+// Reference LZ4 block decoder, the same thing a log decoder has to do for every compressed block
+static std::vector<uint8_t> lz4DecompressBlock(const uint8_t *src, int srcLen)
+{
+    std::vector<uint8_t> out;
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + srcLen;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        uint32_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t b;
+            do {
+                b = *ip++;
+                literalLength += b;
+            } while (b == 255);
+        }
+        out.insert(out.end(), ip, ip + literalLength);
+        ip += literalLength;
+
+        if (ip >= iend) {
+            break;
+        }
+
+        const uint16_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        EXPECT_GT(offset, 0);
+        EXPECT_LE(offset, out.size());
+
+        uint32_t matchLength = token & 0x0F;
+        if (matchLength == 15) {
+            uint8_t b;
+            do {
+                b = *ip++;
+                matchLength += b;
+            } while (b == 255);
+        }
+        matchLength += 4;
+
+        const size_t start = out.size() - offset;
+        for (uint32_t i = 0; i < matchLength; i++) {
+            out.push_back(out[start + i]);
+        }
+    }
+
+    return out;
+}
+
+static void expectRoundTrip(const uint8_t *data, int len, int *compressedLen)
+{
+    std::vector<uint8_t> compressed(BLACKBOX_COMPRESSION_BOUND(len));
+
+    *compressedLen = blackboxCompressBlock(data, len, compressed.data());
+    ASSERT_LE(*compressedLen, BLACKBOX_COMPRESSION_BOUND(len));
+
+    std::vector<uint8_t> decompressed = lz4DecompressBlock(compressed.data(), *compressedLen);
+    ASSERT_EQ(decompressed.size(), (size_t)len);
+    EXPECT_EQ(memcmp(decompressed.data(), data, len), 0);
+}
+
+TEST(BlackboxCompressTest, TestShortBlocks)
+{
+    const uint8_t data[] = "IPPPPPPPPPPPPPPPPPPPP";
+    int compressedLen;
+
+    for (int len = 0; len <= (int)sizeof(data); len++) {
+        expectRoundTrip(data, len, &compressedLen);
+    }
+}
+
+TEST(BlackboxCompressTest, TestRepetitiveData)
+{
+    uint8_t data[BLACKBOX_COMPRESSION_BLOCK_SIZE];
+    int compressedLen;
+
+    memset(data, 0, sizeof(data));
+    expectRoundTrip(data, sizeof(data), &compressedLen);
+    EXPECT_LT(compressedLen, 32);
+
+    // Frame-like data: a constant frame header followed by slowly changing fields
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 16 == 0) ? 'P' : ((i % 16) < 8 ? 0x01 : (uint8_t)(i / 64));
+    }
+    expectRoundTrip(data, sizeof(data), &compressedLen);
+    EXPECT_LT(compressedLen, (int)sizeof(data) / 2);
+}
+
+TEST(BlackboxCompressTest, TestIncompressibleData)
+{
+    uint8_t data[BLACKBOX_COMPRESSION_BLOCK_SIZE];
+    uint32_t seed = 12345;
+    int compressedLen;
+
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        seed = seed * 1664525 + 1013904223;
+        data[i] = seed >> 24;
+    }
+
+    expectRoundTrip(data, sizeof(data), &compressedLen);
+    EXPECT_LE(compressedLen, BLACKBOX_COMPRESSION_BOUND((int)sizeof(data)));
+}
+
+TEST(BlackboxCompressTest, TestLongMatchesAndLiterals)
+{
+    uint8_t data[BLACKBOX_COMPRESSION_BLOCK_SIZE];
+    uint32_t seed = 777;
+    int compressedLen;
+
+    // 300 random literals (extended literal length) then a long run (extended match length)
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        seed = seed * 1664525 + 1013904223;
+        data[i] = (i < 300) ? (seed >> 24) : 0xAA;
+    }
+
+    expectRoundTrip(data, sizeof(data), &compressedLen);
+    EXPECT_LT(compressedLen, 340);
+}
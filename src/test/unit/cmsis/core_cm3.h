@@ -0,0 +1,9 @@
+/*
+ * Host stand-in for the CMSIS Cortex-M3 core header, arm_math.h needs only
+ * the compiler abstraction from it to build the float DSP sources for the
+ * benchmarks. Cortex-M3 keeps arm_math.h away from the M4 SIMD intrinsics.
+ */
+
+#pragma once
+
+#include "cmsis_compiler.h"
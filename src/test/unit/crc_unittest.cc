@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <cstring>
+
+extern "C" {
+#include "common/crc.h"
+#include "common/streambuf.h"
+}
+
+#include "gtest/gtest.h"
+
+static const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+// Bitwise reference the lookup tables replaced
+static uint8_t crc8Reference(uint8_t crc, uint8_t poly, const uint8_t *data, int length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ poly : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc16Reference(uint16_t crc, const uint8_t *data, int length)
+{
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+TEST(CrcTest, TestCheckValues)
+{
+    EXPECT_EQ(crc16_ccitt_update(0, check, sizeof(check)), 0x31C3);    // CRC-16/XMODEM
+    EXPECT_EQ(crc8_dvb_s2_update(0, check, sizeof(check)), 0xBC);      // CRC-8/DVB-S2
+    EXPECT_EQ(crc8_update(0, check, sizeof(check)), 0xF4);             // CRC-8/SMBUS
+}
+
+TEST(CrcTest, TestMatchesReference)
+{
+    uint8_t data[300];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 37 + 11) ^ (i >> 3);
+    }
+
+    for (int length = 0; length <= (int)sizeof(data); length += 23) {
+        EXPECT_EQ(crc16_ccitt_update(0x1D0F, data, length), crc16Reference(0x1D0F, data, length));
+        EXPECT_EQ(crc8_dvb_s2_update(0x5A, data, length), crc8Reference(0x5A, 0xD5, data, length));
+        EXPECT_EQ(crc8_update(0, data, length), crc8Reference(0, 0x07, data, length));
+    }
+}
+
+TEST(CrcTest, TestBytewiseMatchesBulk)
+{
+    uint16_t crc16 = 0;
+    uint8_t crc8 = 0;
+    for (unsigned i = 0; i < sizeof(check); i++) {
+        crc16 = crc16_ccitt(crc16, check[i]);
+        crc8 = crc8_dvb_s2(crc8, check[i]);
+    }
+
+    EXPECT_EQ(crc16, 0x31C3);
+    EXPECT_EQ(crc8, 0xBC);
+}
+
+TEST(CrcTest, TestSbufAppend)
+{
+    uint8_t buffer[16];
+    sbuf_t sbuf = { .ptr = buffer, .end = buffer + sizeof(buffer) };
+
+    sbufWriteData(&sbuf, check, sizeof(check));
+    crc8_dvb_s2_sbuf_append(&sbuf, buffer);
+
+    EXPECT_EQ(sbufPtr(&sbuf) - buffer, (int)sizeof(check) + 1);
+    EXPECT_EQ(buffer[sizeof(check)], 0xBC);
+}
@@ -0,0 +1,201 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks of the byte level encoders: blackbox field encodings,
+ * the CRSF/MSP CRC and the OSD number formatting. Blackbox output goes to
+ * a checksum instead of a device.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "blackbox/blackbox_encoding.h"
+    #include "blackbox/blackbox_io.h"
+    #include "common/crc.h"
+    #include "io/osd_utils.h"
+}
+
+#include "benchmark.h"
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_CALLS     200000
+#define VALUE_COUNT         256     // Power of two, values repeat after this
+
+static uint32_t blackboxBytes;
+static uint32_t blackboxChecksum;
+
+static int32_t values[VALUE_COUNT];
+
+// Mostly small deltas with an occasional large one, like blackbox P-frames
+static void benchmarkValuesInit(void)
+{
+    uint32_t lcgState = 0x9E3779B9;
+
+    for (int i = 0; i < VALUE_COUNT; i++) {
+        lcgState = lcgState * 1664525 + 1013904223;
+        const int32_t value = (int32_t)(lcgState >> 8);
+        values[i] = (i % 16 == 0) ? value : value % 64;
+    }
+}
+
+static void blackboxSinkReset(void)
+{
+    blackboxBytes = 0;
+    blackboxChecksum = 0;
+}
+
+static uint32_t unsignedVBRun(uint32_t calls)
+{
+    blackboxSinkReset();
+    blackboxFrameBegin();
+    benchmarkRun("blackboxWriteUnsignedVB", calls, [](uint32_t n) {
+        blackboxWriteUnsignedVB(values[n & (VALUE_COUNT - 1)]);
+    });
+    blackboxFrameEnd();
+
+    return blackboxChecksum;
+}
+
+static uint32_t tag8_8SVBRun(uint32_t calls)
+{
+    blackboxSinkReset();
+    blackboxFrameBegin();
+    benchmarkRun("blackboxWriteTag8_8SVB (8)", calls, [](uint32_t n) {
+        blackboxWriteTag8_8SVB(&values[n & (VALUE_COUNT - 8)], 8);
+    });
+    blackboxFrameEnd();
+
+    return blackboxChecksum;
+}
+
+static uint8_t crc8Run(uint32_t calls)
+{
+    // A full size CRSF frame
+    uint8_t frame[62];
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+        frame[i] = values[i] & 0xFF;
+    }
+
+    uint8_t crc = 0;
+    benchmarkRun("crc8_dvb_s2_update (62 bytes)", calls, [&](uint32_t) {
+        crc = crc8_dvb_s2_update(crc, frame, sizeof(frame));
+        benchmarkKeep(crc);
+    });
+
+    return crc;
+}
+
+static uint32_t osdFormatRun(uint32_t calls)
+{
+    uint32_t checksum = 0;
+    benchmarkRun("osdFormatCentiNumber", calls, [&](uint32_t n) {
+        char buff[8];
+        // Altitude in cm, shown in m with one decimal or in km when it does not fit
+        osdFormatCentiNumber(buff, values[n & (VALUE_COUNT - 1)] % 10000000, 1000, 1, 2, 5);
+        checksum = checksum * 31 + buff[0] + buff[2] + buff[4];
+    });
+
+    return checksum;
+}
+
+TEST(EncodingBenchmark, UnsignedVB)
+{
+    benchmarkValuesInit();
+    const uint32_t first = unsignedVBRun(BENCHMARK_CALLS);
+    EXPECT_GT(blackboxBytes, 0u);
+    EXPECT_EQ(first, unsignedVBRun(BENCHMARK_CALLS));
+}
+
+TEST(EncodingBenchmark, Tag8_8SVB)
+{
+    benchmarkValuesInit();
+    const uint32_t first = tag8_8SVBRun(BENCHMARK_CALLS);
+    EXPECT_GT(blackboxBytes, 0u);
+    EXPECT_EQ(first, tag8_8SVBRun(BENCHMARK_CALLS));
+}
+
+TEST(EncodingBenchmark, Crc8DvbS2)
+{
+    benchmarkValuesInit();
+    EXPECT_EQ(crc8Run(BENCHMARK_CALLS), crc8Run(BENCHMARK_CALLS));
+}
+
+TEST(EncodingBenchmark, OsdFormatCentiNumber)
+{
+    char buff[8];
+    EXPECT_FALSE(osdFormatCentiNumber(buff, 12345, 1000, 0, 2, 3));
+    EXPECT_STREQ(buff, "123");
+    EXPECT_TRUE(osdFormatCentiNumber(buff, 1234567, 1000, 0, 2, 3));
+
+    benchmarkValuesInit();
+    EXPECT_EQ(osdFormatRun(BENCHMARK_CALLS), osdFormatRun(BENCHMARK_CALLS));
+}
+
+// STUBS
+
+extern "C" {
+    blackboxFrameBuffer_t blackboxFrame = { blackboxFrame.data, false, { 0 } };
+
+    void blackboxWriteBytes(const uint8_t *data, uint32_t length)
+    {
+        for (uint32_t i = 0; i < length; i++) {
+            blackboxBytes++;
+            blackboxChecksum = blackboxChecksum * 31 + data[i];
+        }
+    }
+
+    void blackboxFrameBegin(void)
+    {
+        blackboxFrame.open = true;
+    }
+
+    void blackboxFrameEnd(void)
+    {
+        blackboxFrameCommit();
+        blackboxFrame.open = false;
+    }
+
+    void blackboxFrameCommit(void)
+    {
+        blackboxWriteBytes(blackboxFrame.data, blackboxFrame.pos - blackboxFrame.data);
+        blackboxFrame.pos = blackboxFrame.data;
+    }
+
+    void blackboxWrite(uint8_t value)
+    {
+        blackboxWriteBytes(&value, 1);
+    }
+
+    int32_t blackboxHeaderBudget;
+
+    int blackboxPrint(const char *s)
+    {
+        const int length = strlen(s);
+        while (*s) {
+            blackboxWrite(*s++);
+        }
+        return length;
+    }
+
+    int tfp_format(void *, void (*)(void *, char), const char *, va_list) {return 0;}
+}
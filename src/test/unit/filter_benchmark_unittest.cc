@@ -0,0 +1,190 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks of the gyro filter kernels. The RPM filter runs its notches
+ * through biquadFilterBankApply(), which is measured here with the stage count
+ * of a quad with three harmonics.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+    #include "flight/dynamic_gyro_notch.h"
+    #include "flight/gyroanalyse.h"
+    #include "sensors/gyro.h"
+}
+
+#include "benchmark.h"
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_CALLS         200000
+#define BENCHMARK_LOOPTIME_US   250
+#define BENCHMARK_RPM_STAGES    12      // 4 motors x 3 harmonics
+
+#define SAMPLE_COUNT            1024    // Power of two, samples repeat after this
+
+static float samples[SAMPLE_COUNT];
+
+// Two sines plus LCG noise, the same on every run
+static void benchmarkSamplesInit(void)
+{
+    uint32_t lcgState = 0x12345678;
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        lcgState = lcgState * 1664525 + 1013904223;
+        const float t = i * US2S(BENCHMARK_LOOPTIME_US);
+        const float noise = (int32_t)(lcgState >> 16) % 200 - 100;
+        samples[i] = 200.0f * sinf(2 * M_PIf * 12 * t) + 50.0f * sinf(2 * M_PIf * 230 * t) + noise * 0.1f;
+    }
+}
+
+static float biquadRun(uint32_t calls)
+{
+    biquadFilter_t filter;
+    biquadFilterInitLPF(&filter, 110, BENCHMARK_LOOPTIME_US);
+
+    float output = 0;
+    benchmarkRun("biquadFilterApply", calls, [&](uint32_t n) {
+        output = biquadFilterApply(&filter, samples[n & (SAMPLE_COUNT - 1)]);
+        benchmarkKeep(output);
+    });
+
+    return output;
+}
+
+static float pt1Run(uint32_t calls)
+{
+    pt1Filter_t filter;
+    pt1FilterInit(&filter, 110, US2S(BENCHMARK_LOOPTIME_US));
+
+    float output = 0;
+    benchmarkRun("pt1FilterApply4", calls, [&](uint32_t n) {
+        // Cutoff moving with the input, like the D-term filter follows throttle
+        output = pt1FilterApply4(&filter, samples[n & (SAMPLE_COUNT - 1)], 80 + (n & 63), US2S(BENCHMARK_LOOPTIME_US));
+        benchmarkKeep(output);
+    });
+
+    return output;
+}
+
+static float rpmBankRun(uint32_t calls)
+{
+    static biquadFilterBank_t bank;
+    biquadFilterBankInit(&bank, BENCHMARK_RPM_STAGES);
+    for (int stage = 0; stage < BENCHMARK_RPM_STAGES; stage++) {
+        biquadFilterBankUpdateNotch(&bank, stage, 150 + 37 * stage, BENCHMARK_LOOPTIME_US, 5.0f, 1.0f);
+    }
+
+    float values[XYZ_AXIS_COUNT] = { 0 };
+    benchmarkRun("rpmFilter bank (12 stages)", calls, [&](uint32_t n) {
+        const float sample = samples[n & (SAMPLE_COUNT - 1)];
+        values[X] = sample;
+        values[Y] = -sample;
+        values[Z] = 0.5f * sample;
+        biquadFilterBankApply(&bank, values);
+        benchmarkKeep(values);
+    });
+
+    return values[X] + values[Y] + values[Z];
+}
+
+static float gyroAnalyseRun(uint8_t engine, uint32_t calls)
+{
+    static gyroAnalyseState_t state;
+    memset(&state, 0, sizeof(state));
+    gyroDataAnalyseStateInit(&state, 100, FFT_WINDOW_SIZE_MAX, 2, engine, BENCHMARK_LOOPTIME_US);
+
+    benchmarkRun(engine == DYNAMIC_NOTCH_ENGINE_SDFT ? "gyroDataAnalyse (SDFT)" : "gyroDataAnalyse (FFT)", calls, [&](uint32_t n) {
+        const float sample = samples[n & (SAMPLE_COUNT - 1)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDataAnalysePush(&state, axis, sample);
+        }
+        gyroDataAnalyse(&state);
+        benchmarkKeep(state);
+    });
+
+    return state.centerFrequency[X][0] + state.centerFrequency[Y][1] + state.centerFrequency[Z][2];
+}
+
+TEST(FilterBenchmark, Biquad)
+{
+    benchmarkSamplesInit();
+    EXPECT_EQ(biquadRun(BENCHMARK_CALLS), biquadRun(BENCHMARK_CALLS));
+}
+
+TEST(FilterBenchmark, Pt1Apply4)
+{
+    benchmarkSamplesInit();
+    EXPECT_EQ(pt1Run(BENCHMARK_CALLS), pt1Run(BENCHMARK_CALLS));
+}
+
+TEST(FilterBenchmark, RpmFilterBank)
+{
+    benchmarkSamplesInit();
+    const float first = rpmBankRun(BENCHMARK_CALLS);
+    EXPECT_TRUE(isfinite(first));
+    EXPECT_EQ(first, rpmBankRun(BENCHMARK_CALLS));
+}
+
+TEST(FilterBenchmark, GyroDataAnalyse)
+{
+    benchmarkSamplesInit();
+    for (uint8_t engine = DYNAMIC_NOTCH_ENGINE_FFT; engine <= DYNAMIC_NOTCH_ENGINE_SDFT; engine++) {
+        const float first = gyroAnalyseRun(engine, BENCHMARK_CALLS);
+        EXPECT_TRUE(isfinite(first));
+        EXPECT_EQ(first, gyroAnalyseRun(engine, BENCHMARK_CALLS));
+    }
+}
+
+// STUBS
+
+extern "C" {
+    int32_t debug[DEBUG32_VALUE_COUNT];
+    uint8_t debugMode;
+
+    gyroAnalyseState_t gyroAnalyseState;
+
+    // Portable version of the Cortex-M assembly in arm_bitreversal2.S
+    void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable)
+    {
+        for (uint16_t i = 0; i < bitRevLen; i += 2) {
+            const uint32_t a = pBitRevTable[i] >> 2;
+            const uint32_t b = pBitRevTable[i + 1] >> 2;
+
+            uint32_t tmp = pSrc[a];
+            pSrc[a] = pSrc[b];
+            pSrc[b] = tmp;
+
+            tmp = pSrc[a + 1];
+            pSrc[a + 1] = pSrc[b + 1];
+            pSrc[b + 1] = tmp;
+        }
+    }
+}
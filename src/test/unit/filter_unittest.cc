@@ -0,0 +1,291 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOPTIME_US 250
+
+TEST(FilterUnittest, TestBiquadFilterBankPassthrough)
+{
+    biquadFilterBank_t bank;
+    biquadFilterBankInit(&bank, 6);
+
+    float values[XYZ_AXIS_COUNT] = { 1.0f, -2.0f, 3.5f };
+    biquadFilterBankApply(&bank, values);
+
+    EXPECT_FLOAT_EQ(values[X], 1.0f);
+    EXPECT_FLOAT_EQ(values[Y], -2.0f);
+    EXPECT_FLOAT_EQ(values[Z], 3.5f);
+}
+
+TEST(FilterUnittest, TestBiquadFilterBankMatchesDF1Cascade)
+{
+    const float frequencies[] = { 120.0f, 240.0f, 360.0f, 180.0f };
+    const int stageCount = ARRAYLEN(frequencies);
+
+    biquadFilterBank_t bank;
+    biquadFilter_t reference[XYZ_AXIS_COUNT][stageCount];
+
+    biquadFilterBankInit(&bank, stageCount);
+    for (int stage = 0; stage < stageCount; stage++) {
+        biquadFilterBankUpdate(&bank, stage, frequencies[stage], LOOPTIME_US, 3.0f, FILTER_NOTCH);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            // Bank stages get their coefficients from the runtime update path
+            biquadFilterInit(&reference[axis][stage], frequencies[stage], LOOPTIME_US, 3.0f, FILTER_NOTCH);
+            biquadFilterUpdate(&reference[axis][stage], frequencies[stage], LOOPTIME_US, 3.0f, FILTER_NOTCH);
+        }
+    }
+
+    for (int sample = 0; sample < 500; sample++) {
+        // Retune one stage half way through, state must be kept
+        if (sample == 250) {
+            biquadFilterBankUpdate(&bank, 1, 300.0f, LOOPTIME_US, 3.0f, FILTER_NOTCH);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                biquadFilterUpdate(&reference[axis][1], 300.0f, LOOPTIME_US, 3.0f, FILTER_NOTCH);
+            }
+        }
+
+        float values[XYZ_AXIS_COUNT];
+        float expected[XYZ_AXIS_COUNT];
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            values[axis] = expected[axis] = sinf(sample * 0.05f * (axis + 1)) * 100.0f;
+            for (int stage = 0; stage < stageCount; stage++) {
+                expected[axis] = biquadFilterApplyDF1(&reference[axis][stage], expected[axis]);
+            }
+        }
+
+        biquadFilterBankApply(&bank, values);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_NEAR(values[axis], expected[axis], 1e-3f);
+        }
+    }
+}
+
+TEST(FilterUnittest, TestBiquadFilterBankNotchAttenuates)
+{
+    biquadFilterBank_t bank;
+    biquadFilterBankInit(&bank, 1);
+    biquadFilterBankUpdate(&bank, 0, 200.0f, LOOPTIME_US, 3.0f, FILTER_NOTCH);
+
+    float peak = 0.0f;
+    for (int sample = 0; sample < 4000; sample++) {
+        const float input = sinf(2.0f * M_PIf * 200.0f * sample * LOOPTIME_US * 1e-6f);
+        float values[XYZ_AXIS_COUNT] = { input, input, input };
+        biquadFilterBankApply(&bank, values);
+        if (sample > 2000) {
+            peak = MAX(peak, fabsf(values[X]));
+        }
+    }
+
+    EXPECT_LT(peak, 0.05f);
+}
+
+TEST(FilterUnittest, TestBiquadFilterUpdateMatchesInit)
+{
+    const biquadFilterType_e types[] = { FILTER_LPF, FILTER_NOTCH };
+
+    for (unsigned t = 0; t < ARRAYLEN(types); t++) {
+        for (int frequency = 10; frequency < 2000; frequency += 10) {
+            biquadFilter_t reference;
+            biquadFilter_t updated;
+
+            biquadFilterInit(&reference, frequency, LOOPTIME_US, 3.0f, types[t]);
+            biquadFilterInit(&updated, 100, LOOPTIME_US, 3.0f, types[t]);
+            updated.x1 = 1.0f;
+            biquadFilterUpdate(&updated, frequency, LOOPTIME_US, 3.0f, types[t]);
+
+            EXPECT_NEAR(updated.b0, reference.b0, 1e-3f);
+            EXPECT_NEAR(updated.b1, reference.b1, 1e-3f);
+            EXPECT_NEAR(updated.b2, reference.b2, 1e-3f);
+            EXPECT_NEAR(updated.a1, reference.a1, 1e-3f);
+            EXPECT_NEAR(updated.a2, reference.a2, 1e-3f);
+            EXPECT_FLOAT_EQ(updated.x1, 1.0f);
+        }
+    }
+}
+
+TEST(FilterUnittest, TestBiquadFilterBankNotchDepth)
+{
+    const float depths[] = { 0.0f, 0.5f, 1.0f };
+    const float expectedGain[] = { 1.0f, 0.5f, 0.0f };
+
+    for (unsigned i = 0; i < ARRAYLEN(depths); i++) {
+        biquadFilterBank_t bank;
+        biquadFilterBankInit(&bank, 1);
+        biquadFilterBankUpdateNotch(&bank, 0, 200.0f, LOOPTIME_US, 3.0f, depths[i]);
+
+        float peak = 0.0f;
+        for (int sample = 0; sample < 4000; sample++) {
+            const float input = sinf(2.0f * M_PIf * 200.0f * sample * LOOPTIME_US * 1e-6f);
+            float values[XYZ_AXIS_COUNT] = { input, input, input };
+            biquadFilterBankApply(&bank, values);
+            if (sample > 2000) {
+                peak = MAX(peak, fabsf(values[X]));
+            }
+        }
+
+        EXPECT_NEAR(peak, expectedGain[i], 0.05f);
+    }
+}
+
+TEST(FilterUnittest, TestBiquadFilterBankStageCountKeepsState)
+{
+    biquadFilterBank_t bank;
+    biquadFilterBankInit(&bank, 2);
+    biquadFilterBankUpdate(&bank, 0, 200.0f, LOOPTIME_US, 3.0f, FILTER_NOTCH);
+    biquadFilterBankUpdate(&bank, 1, 200.0f, LOOPTIME_US, 3.0f, FILTER_NOTCH);
+
+    float values[XYZ_AXIS_COUNT] = { 1.0f, 1.0f, 1.0f };
+    biquadFilterBankApply(&bank, values);
+
+    // x1 of stage 0 holds the input sample, it follows the stage to slot 1
+    biquadFilterBankMoveStageState(&bank, 0, 1);
+    biquadFilterBankResetStageState(&bank, 0);
+    biquadFilterBankSetStageCount(&bank, 0);
+
+    values[X] = 2.0f;
+    biquadFilterBankApply(&bank, values);
+    EXPECT_FLOAT_EQ(values[X], 2.0f);
+
+    biquadFilterBankSetStageCount(&bank, 2);
+    EXPECT_EQ(bank.stageCount, 2);
+    EXPECT_FLOAT_EQ(bank.state[X][4], 1.0f);
+    EXPECT_FLOAT_EQ(bank.state[X][0], 0.0f);
+}
+
+TEST(FilterUnittest, TestFilterApplyAxesMatchesPerAxis)
+{
+    filter_t pt1Axes[XYZ_AXIS_COUNT];
+    filter_t biquadAxes[XYZ_AXIS_COUNT];
+    pt1Filter_t pt1Reference[XYZ_AXIS_COUNT];
+    biquadFilter_t biquadReference[XYZ_AXIS_COUNT];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1FilterInit(&pt1Axes[axis].pt1, 90.0f, LOOPTIME_US * 1e-6f);
+        pt1FilterInit(&pt1Reference[axis], 90.0f, LOOPTIME_US * 1e-6f);
+        biquadFilterInitLPF(&biquadAxes[axis].biquad, 110, LOOPTIME_US);
+        biquadFilterInitLPF(&biquadReference[axis], 110, LOOPTIME_US);
+    }
+
+    for (int sample = 0; sample < 200; sample++) {
+        float pt1Values[XYZ_AXIS_COUNT];
+        float biquadValues[XYZ_AXIS_COUNT];
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            pt1Values[axis] = biquadValues[axis] = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+        }
+
+        pt1FilterApplyAxes(pt1Axes, pt1Values);
+        biquadFilterApplyAxes(biquadAxes, biquadValues);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float input = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+            EXPECT_FLOAT_EQ(pt1Values[axis], pt1FilterApply(&pt1Reference[axis], input));
+            EXPECT_FLOAT_EQ(biquadValues[axis], biquadFilterApply(&biquadReference[axis], input));
+        }
+    }
+}
+
+TEST(FilterUnittest, TestFilterChain2MatchesSeparateStages)
+{
+    const uint8_t types[] = { FILTER_PT1, FILTER_BIQUAD, FILTER_PT2, FILTER_PT3 };
+    const float cutoffs[] = { 0.0f, 110.0f };
+
+    for (unsigned firstType = 0; firstType < ARRAYLEN(types); firstType++) {
+        for (unsigned secondType = 0; secondType < ARRAYLEN(types); secondType++) {
+            for (unsigned cutoff = 0; cutoff < ARRAYLEN(cutoffs); cutoff++) {
+                const float firstCutoff = cutoffs[cutoff];
+                const float secondCutoff = 80.0f;
+
+                filter_t chainFirst[XYZ_AXIS_COUNT];
+                filter_t chainSecond[XYZ_AXIS_COUNT];
+                filter_t referenceFirst[XYZ_AXIS_COUNT];
+                filter_t referenceSecond[XYZ_AXIS_COUNT];
+                for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                    initFilter(types[firstType], &chainFirst[axis], firstCutoff, LOOPTIME_US);
+                    initFilter(types[secondType], &chainSecond[axis], secondCutoff, LOOPTIME_US);
+                    initFilter(types[firstType], &referenceFirst[axis], firstCutoff, LOOPTIME_US);
+                    initFilter(types[secondType], &referenceSecond[axis], secondCutoff, LOOPTIME_US);
+                }
+
+                filterApplyFnPtr firstApplyFn;
+                filterApplyFnPtr secondApplyFn;
+                assignFilterApplyFn(types[firstType], firstCutoff, &firstApplyFn);
+                assignFilterApplyFn(types[secondType], secondCutoff, &secondApplyFn);
+                const filterChain2ApplyAxesFnPtr chainApplyFn = assignFilterChain2ApplyAxesFn(types[firstType], firstCutoff, types[secondType], secondCutoff);
+
+                for (int sample = 0; sample < 100; sample++) {
+                    float values[XYZ_AXIS_COUNT];
+                    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                        values[axis] = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+                    }
+
+                    chainApplyFn(chainFirst, chainSecond, values);
+
+                    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                        const float input = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+                        const float expected = secondApplyFn(&referenceSecond[axis], firstApplyFn(&referenceFirst[axis], input));
+                        EXPECT_FLOAT_EQ(values[axis], expected);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(FilterUnittest, TestPt1FilterApplyAxes4MatchesPerAxis)
+{
+    filter_t axes[XYZ_AXIS_COUNT];
+    pt1Filter_t reference[XYZ_AXIS_COUNT];
+
+    memset(axes, 0, sizeof(axes));
+    memset(reference, 0, sizeof(reference));
+
+    for (int sample = 0; sample < 200; sample++) {
+        // Jittery loop time, the shared coefficient must follow it
+        const float dT = (LOOPTIME_US + (sample % 7) * 10) * 1e-6f;
+        float values[XYZ_AXIS_COUNT];
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            values[axis] = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+        }
+
+        pt1FilterApplyAxes4(axes, values, 7.0f, dT);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float input = sinf(sample * 0.1f * (axis + 1)) * 50.0f;
+            EXPECT_FLOAT_EQ(values[axis], pt1FilterApply4(&reference[axis], input, 7.0f, dT));
+        }
+    }
+}
@@ -0,0 +1,263 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks of the attitude estimator and the mixer. The Mahony filter
+ * is measured in its two halves, the gyro propagation that runs every loop
+ * and the accelerometer/compass correction that runs at a lower rate.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <math.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/debug.h"
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+    #include "common/vector.h"
+    #include "config/feature.h"
+    #include "drivers/accgyro/accgyro_fake.h"
+    #include "fc/controlrate_profile.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_curves.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+    #include "fc/settings.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "io/beeper.h"
+    #include "io/gps.h"
+    #include "navigation/navigation.h"
+    #include "rx/rx.h"
+    #include "scheduler/scheduler.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+
+    extern fpQuaternion_t orientation;
+
+    extern const mixerConfig_t pgResetTemplate_mixerConfig;
+    extern const motorConfig_t pgResetTemplate_motorConfig;
+
+    STATIC_UNIT_TESTED void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF);
+    STATIC_UNIT_TESTED void imuMahonyAHRSCorrection(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, bool useCOG, float courseOverGround, float accWScaler, float magWScaler);
+    STATIC_UNIT_TESTED void imuComputeQuaternionFromRPY(int16_t initialRoll, int16_t initialPitch, int16_t initialYaw);
+}
+
+#include "benchmark.h"
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_CALLS         200000
+#define BENCHMARK_LOOPTIME_US   250
+#define BENCHMARK_MOTOR_COUNT   4
+
+static const motorMixer_t quadXMixer[BENCHMARK_MOTOR_COUNT] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },
+    { 1.0f, -1.0f, -1.0f,  1.0f },
+    { 1.0f,  1.0f,  1.0f,  1.0f },
+    { 1.0f,  1.0f, -1.0f, -1.0f },
+};
+
+// Slow coning motion, large enough to take the full quaternion update path
+static void benchmarkRotation(uint32_t n, fpVector3_t *rate)
+{
+    const float t = (n & 4095) * US2S(BENCHMARK_LOOPTIME_US);
+    rate->x = DEGREES_TO_RADIANS(300) * sin_approx(2 * M_PIf * 2 * t);
+    rate->y = DEGREES_TO_RADIANS(300) * cos_approx(2 * M_PIf * 2 * t);
+    rate->z = DEGREES_TO_RADIANS(90);
+}
+
+static fpQuaternion_t imuUpdateRun(uint32_t calls)
+{
+    imuConfigure();
+    imuComputeQuaternionFromRPY(0, 0, 0);
+
+    benchmarkRun("imuMahonyAHRSupdate", calls, [](uint32_t n) {
+        fpVector3_t rate;
+        benchmarkRotation(n, &rate);
+        imuMahonyAHRSupdate(US2S(BENCHMARK_LOOPTIME_US), &rate);
+        benchmarkKeep(orientation);
+    });
+
+    return orientation;
+}
+
+static fpQuaternion_t imuCorrectionRun(uint32_t calls)
+{
+    imuConfigure();
+    imuComputeQuaternionFromRPY(100, -50, 300);
+
+    static const fpVector3_t accBF = { .v = { 0.0f, 0.0f, GRAVITY_CMSS } };
+    static const fpVector3_t magBF = { .v = { 200.0f, 30.0f, 400.0f } };
+
+    benchmarkRun("imuMahonyAHRSCorrection", calls, [](uint32_t n) {
+        fpVector3_t rate;
+        benchmarkRotation(n, &rate);
+        imuMahonyAHRSCorrection(US2S(BENCHMARK_LOOPTIME_US), &rate, &accBF, &magBF, false, 0, 1.0f, 1.0f);
+        imuMahonyAHRSupdate(US2S(BENCHMARK_LOOPTIME_US), &rate);
+        benchmarkKeep(orientation);
+    });
+
+    return orientation;
+}
+
+static void mixerBenchmarkInit(void)
+{
+    memcpy(mixerConfigMutable(), &pgResetTemplate_mixerConfig, sizeof(mixerConfig_t));
+    memcpy(motorConfigMutable(), &pgResetTemplate_motorConfig, sizeof(motorConfig_t));
+    mixerConfigMutable()->platformType = PLATFORM_MULTIROTOR;
+
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        *primaryMotorMixerMutable(i) = (motorMixer_t) { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+    for (int i = 0; i < BENCHMARK_MOTOR_COUNT; i++) {
+        *primaryMotorMixerMutable(i) = quadXMixer[i];
+    }
+
+    mixerUpdateStateFlags();
+    mixerInit();
+    ENABLE_ARMING_FLAG(ARMED);
+}
+
+static uint32_t mixTableRun(uint32_t calls)
+{
+    mixerBenchmarkInit();
+
+    uint32_t checksum = 0;
+    benchmarkRun("mixTable (quad X)", calls, [&](uint32_t n) {
+        // Sweeps the PID outputs through saturation of the mixer
+        axisPID[ROLL] = (int)(n % 801) - 400;
+        axisPID[PITCH] = (int)(n % 613) - 300;
+        axisPID[YAW] = (int)(n % 401) - 200;
+        rcCommand[THROTTLE] = 1100 + n % 800;
+        mixTable();
+        checksum = checksum * 31 + motor[0] + motor[1] + motor[2] + motor[3];
+    });
+
+    return checksum;
+}
+
+TEST(FlightBenchmark, ImuMahonyUpdate)
+{
+    const fpQuaternion_t first = imuUpdateRun(BENCHMARK_CALLS);
+    const fpQuaternion_t second = imuUpdateRun(BENCHMARK_CALLS);
+
+    EXPECT_NEAR(quaternionNormSqared(&first), 1.0f, 1e-4f);
+    EXPECT_EQ(0, memcmp(&first, &second, sizeof(first)));
+}
+
+TEST(FlightBenchmark, ImuMahonyCorrection)
+{
+    const fpQuaternion_t first = imuCorrectionRun(BENCHMARK_CALLS);
+    const fpQuaternion_t second = imuCorrectionRun(BENCHMARK_CALLS);
+
+    EXPECT_NEAR(quaternionNormSqared(&first), 1.0f, 1e-4f);
+    EXPECT_EQ(0, memcmp(&first, &second, sizeof(first)));
+}
+
+TEST(FlightBenchmark, MixTable)
+{
+    const uint32_t first = mixTableRun(BENCHMARK_CALLS);
+    EXPECT_EQ(first, mixTableRun(BENCHMARK_CALLS));
+
+    for (int i = 0; i < BENCHMARK_MOTOR_COUNT; i++) {
+        EXPECT_GE(motor[i], getThrottleIdleValue());
+        EXPECT_LE(motor[i], motorConfig()->maxthrottle);
+    }
+}
+
+// STUBS
+
+extern "C" {
+static timeMs_t milliTime = 0;
+timeMs_t millis(void) {return milliTime++;}
+uint32_t micros(void) {return 0;}
+void delay(timeMs_t) {}
+void beeper(beeperMode_e) {}
+uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+timeDelta_t getLooptime(void) {return BENCHMARK_LOOPTIME_US;}
+timeDelta_t getGyroLooptime(void) {return gyro.targetLooptime;}
+void sensorsSet(uint32_t) {}
+void schedulerResetTaskStatistics(cfTaskId_e) {}
+
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+uint32_t stateFlags;
+int16_t rcCommand[4];
+
+static controlRateConfig_t benchmarkControlRateProfile = {
+    .throttle = { .rcMid8 = 50, .rcExpo8 = 0, .dynPID = 0, .pa_breakpoint = 1500, .fixedWingTauMs = 0 },
+    .stabilized = { .rcExpo8 = 70, .rcYawExpo8 = 20, .rates = { 20, 20, 20 } },
+};
+const controlRateConfig_t *currentControlRateProfile = &benchmarkControlRateProfile;
+controlRateConfig_t controlRateProfiles_SystemArray[MAX_CONTROL_RATE_PROFILE_COUNT];
+uint8_t getConfigProfile(void) {return 0;}
+
+static batteryProfile_t benchmarkBatteryProfile;
+const batteryProfile_t *currentBatteryProfile = &benchmarkBatteryProfile;
+
+rcControlsConfig_t rcControlsConfig_System;
+navConfig_t navConfig_System;
+
+bool feature(uint32_t) {return false;}
+bool IS_RC_MODE_ACTIVE(boxId_e) {return false;}
+bool areSticksDeflected(void) {return true;}
+int32_t getRcStickDeflection(int32_t) {return 0;}
+int16_t rxGetChannelValue(unsigned) {return PWM_RANGE_MIDDLE;}
+float rcLookupTpa(tpaCurve_e, uint16_t) {return 1.0f;}
+throttleStatus_e calculateThrottleStatus(throttleStatusType_e) {return THROTTLE_HIGH;}
+rollPitchStatus_e calculateRollPitchCenterStatus(void) {return NOT_CENTERED;}
+float calculateThrottleCompensationFactor(void) {return 1.0f;}
+bool isAmperageConfigured(void) {return false;}
+bool failsafeIsActive(void) {return false;}
+bool failsafeRequiresMotorStop(void) {return false;}
+float getEstimatedActualVelocity(int) {return 0;}
+bool isFlightAxisAngleOverrideActive(uint8_t) {return false;}
+float getFlightAxisAngleOverride(uint8_t, float angle) {return angle;}
+float getFlightAxisRateOverride(uint8_t, float rate) {return rate;}
+int16_t getRcCommandOverride(int16_t command[], uint8_t axis) {return command[axis];}
+int8_t navigationGetHeadingControlState(void) {return NAV_HEADING_CONTROL_NONE;}
+bool navigationInAutomaticThrottleMode(void) {return false;}
+bool navigationIsControllingAltitude(void) {return false;}
+bool navigationIsControllingThrottle(void) {return false;}
+bool navigationIsFlyingAutonomousMode(void) {return false;}
+bool navigationRequiresTurnAssistance(void) {return false;}
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+void pwmWriteMotor(uint8_t, uint16_t) {}
+
+acc_t acc;
+mag_t mag;
+gpsSolutionData_t gpsSol;
+compassConfig_t compassConfig_System;
+bool sensors(uint32_t) {return false;}
+bool compassIsHealthy(void) {return true;}
+void accGetVibrationLevels(fpVector3_t *accVibeLevels) {vectorZero(accVibeLevels);}
+void accGetMeasuredAcceleration(fpVector3_t *measuredAcc) {vectorZero(measuredAcc);}
+uint32_t accGetClipCount(void) {return 0;}
+bool accUpdate(void) {return true;}
+bool isGPSHeadingValid(void) {return false;}
+}
@@ -108,6 +108,7 @@ bool sensors(uint32_t mask)
     return false;
 };
 uint32_t millis(void) { return 0; }
+uint32_t micros(void) { return 0; }
 timeDelta_t getLooptime(void) { return gyro.targetLooptime; }
 timeDelta_t getGyroLooptime(void) { return gyro.targetLooptime; }
 void schedulerResetTaskStatistics(cfTaskId_e) {}
@@ -129,8 +130,9 @@ uint32_t accGetClipCount(void)
 {
     return acc.accClipCount;
 }
-void accUpdate(void)
+bool accUpdate(void)
 {
+    return true;
 }
 void resetHeadingHoldTarget(int16_t heading)
 {
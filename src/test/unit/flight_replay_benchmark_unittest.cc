@@ -0,0 +1,413 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Blackbox replay of the gyro -> PID -> mixer chain.
+ *
+ * Set INAV_REPLAY_CSV to a log decoded with blackbox_decode (the log must
+ * have been recorded with the gyroRaw field enabled). Every frame feeds
+ * gyroRaw[] and rcCommand[] through gyroUpdate(), gyroFilter(),
+ * pidController() and mixTable(), then compares motor[] with the logged
+ * motor outputs and accumulates host CPU time per stage.
+ *
+ * The mixer is a quad X with the firmware default PID profile, so the motor
+ * divergence is only meaningful for logs recorded with default tuning; it
+ * is intended to compare two builds of the chain against the same log.
+ * Without INAV_REPLAY_CSV a deterministic synthetic flight is replayed and
+ * only the sanity of the outputs is checked.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/build_config.h"
+    #include "build/debug.h"
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+    #include "config/feature.h"
+    #include "drivers/accgyro/accgyro_fake.h"
+    #include "fc/controlrate_profile.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_curves.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+    #include "fc/settings.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "io/beeper.h"
+    #include "navigation/navigation.h"
+    #include "rx/rx.h"
+    #include "scheduler/scheduler.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+
+    extern gyroDev_t gyroDev[];
+
+    extern const gyroConfig_t pgResetTemplate_gyroConfig;
+    extern const pidProfile_t pgResetTemplate_pidProfile;
+    extern const mixerConfig_t pgResetTemplate_mixerConfig;
+    extern const motorConfig_t pgResetTemplate_motorConfig;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define REPLAY_MOTOR_COUNT      4
+#define REPLAY_LOOPTIME_US      1000
+#define REPLAY_SYNTHETIC_FRAMES 5000
+
+typedef enum {
+    REPLAY_STAGE_GYRO_UPDATE = 0,
+    REPLAY_STAGE_GYRO_FILTER,
+    REPLAY_STAGE_PID_CONTROLLER,
+    REPLAY_STAGE_MIX_TABLE,
+    REPLAY_STAGE_COUNT
+} replayStage_e;
+
+static const char * const replayStageNames[REPLAY_STAGE_COUNT] = {
+    "gyroUpdate", "gyroFilter", "pidController", "mixTable"
+};
+
+typedef struct {
+    uint32_t timeUs;
+    float gyroRaw[XYZ_AXIS_COUNT];
+    int16_t rcCommand[4];
+    int16_t motor[REPLAY_MOTOR_COUNT];
+} replayFrame_t;
+
+typedef struct {
+    double stageNs[REPLAY_STAGE_COUNT];
+    double motorErrorSquaredSum;
+    int motorErrorMax;
+    bool motorsInRange;
+} replayResult_t;
+
+static const motorMixer_t quadXMixer[REPLAY_MOTOR_COUNT] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },
+    { 1.0f, -1.0f, -1.0f,  1.0f },
+    { 1.0f,  1.0f,  1.0f,  1.0f },
+    { 1.0f,  1.0f, -1.0f, -1.0f },
+};
+
+static int replayColumn(const std::vector<std::string> &header, const char *name)
+{
+    for (unsigned i = 0; i < header.size(); i++) {
+        if (header[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static std::vector<std::string> replaySplitCsvLine(const char *line)
+{
+    std::vector<std::string> fields;
+    std::string field;
+
+    for (const char *c = line; *c && *c != '\n' && *c != '\r'; c++) {
+        if (*c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else if (*c != ' ' || !field.empty()) {
+            field += *c;
+        }
+    }
+    fields.push_back(field);
+
+    return fields;
+}
+
+static bool replayLoadCsv(const char *path, std::vector<replayFrame_t> &frames, bool *hasMotors)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    char line[4096];
+    if (!fgets(line, sizeof(line), f)) {
+        fclose(f);
+        return false;
+    }
+
+    const std::vector<std::string> header = replaySplitCsvLine(line);
+    const int timeColumn = replayColumn(header, "time (us)");
+    int gyroColumns[XYZ_AXIS_COUNT];
+    int rcColumns[4];
+    int motorColumns[REPLAY_MOTOR_COUNT];
+
+    bool valid = timeColumn >= 0;
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        gyroColumns[i] = replayColumn(header, (std::string("gyroRaw[") + std::to_string(i) + "]").c_str());
+        valid = valid && gyroColumns[i] >= 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        rcColumns[i] = replayColumn(header, (std::string("rcCommand[") + std::to_string(i) + "]").c_str());
+        valid = valid && rcColumns[i] >= 0;
+    }
+    *hasMotors = true;
+    for (int i = 0; i < REPLAY_MOTOR_COUNT; i++) {
+        motorColumns[i] = replayColumn(header, (std::string("motor[") + std::to_string(i) + "]").c_str());
+        *hasMotors = *hasMotors && motorColumns[i] >= 0;
+    }
+
+    while (valid && fgets(line, sizeof(line), f)) {
+        const std::vector<std::string> fields = replaySplitCsvLine(line);
+        if (fields.size() < header.size()) {
+            continue;
+        }
+
+        replayFrame_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.timeUs = strtoul(fields[timeColumn].c_str(), NULL, 10);
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            frame.gyroRaw[i] = strtof(fields[gyroColumns[i]].c_str(), NULL);
+        }
+        for (int i = 0; i < 4; i++) {
+            frame.rcCommand[i] = atoi(fields[rcColumns[i]].c_str());
+        }
+        if (*hasMotors) {
+            for (int i = 0; i < REPLAY_MOTOR_COUNT; i++) {
+                frame.motor[i] = atoi(fields[motorColumns[i]].c_str());
+            }
+        }
+        frames.push_back(frame);
+    }
+
+    fclose(f);
+    return valid && !frames.empty();
+}
+
+static void replayGenerateSynthetic(std::vector<replayFrame_t> &frames)
+{
+    uint32_t lcgState = 0x2545F491;
+
+    for (uint32_t i = 0; i < REPLAY_SYNTHETIC_FRAMES; i++) {
+        replayFrame_t frame;
+        memset(&frame, 0, sizeof(frame));
+
+        const float t = i * (REPLAY_LOOPTIME_US * 1e-6f);
+        frame.timeUs = i * REPLAY_LOOPTIME_US;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            lcgState = lcgState * 1664525 + 1013904223;
+            const float noise = ((int32_t)(lcgState >> 16) % 100 - 50) * 0.1f;
+            frame.gyroRaw[axis] = 120.0f * sin_approx(2 * M_PIf * (1 + axis) * t) + noise;
+            frame.rcCommand[axis] = lrintf(200.0f * sin_approx(2 * M_PIf * (1 + axis) * t + 0.3f));
+        }
+        frame.rcCommand[THROTTLE] = 1400 + lrintf(150.0f * sin_approx(2 * M_PIf * 0.5f * t));
+        frames.push_back(frame);
+    }
+}
+
+static void replayInit(void)
+{
+    memcpy(gyroConfigMutable(), &pgResetTemplate_gyroConfig, sizeof(gyroConfig_t));
+    memcpy(pidProfileMutable(), &pgResetTemplate_pidProfile, sizeof(pidProfile_t));
+    memcpy(mixerConfigMutable(), &pgResetTemplate_mixerConfig, sizeof(mixerConfig_t));
+    memcpy(motorConfigMutable(), &pgResetTemplate_motorConfig, sizeof(motorConfig_t));
+    gyroConfigMutable()->looptime = REPLAY_LOOPTIME_US;
+    mixerConfigMutable()->platformType = PLATFORM_MULTIROTOR;
+
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        *primaryMotorMixerMutable(i) = (motorMixer_t) { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+    for (int i = 0; i < REPLAY_MOTOR_COUNT; i++) {
+        *primaryMotorMixerMutable(i) = quadXMixer[i];
+    }
+
+    fakeGyroSet(0, 0, 0);
+    gyroInit();
+    gyroStartCalibration();
+    while (!gyroIsCalibrationComplete()) {
+        gyroUpdate();
+    }
+
+    mixerUpdateStateFlags();
+    mixerInit();
+    pidInit();
+    pidInitFilters();
+    pidResetErrorAccumulators();
+
+    ENABLE_ARMING_FLAG(ARMED);
+}
+
+static void replayRun(const std::vector<replayFrame_t> &frames, bool compareMotors, replayResult_t *result)
+{
+    typedef std::chrono::steady_clock clock;
+
+    memset(result, 0, sizeof(*result));
+    result->motorsInRange = true;
+
+    replayInit();
+
+    uint32_t previousTimeUs = frames[0].timeUs;
+    for (const replayFrame_t &frame : frames) {
+        const float dT = constrainf((frame.timeUs - previousTimeUs) * 1e-6f, REPLAY_LOOPTIME_US * 1e-6f, 0.1f);
+        previousTimeUs = frame.timeUs;
+
+        const float scale = gyroDev[0].scale;
+        fakeGyroSet(lrintf(frame.gyroRaw[X] / scale), lrintf(frame.gyroRaw[Y] / scale), lrintf(frame.gyroRaw[Z] / scale));
+        for (int i = 0; i < 4; i++) {
+            rcCommand[i] = frame.rcCommand[i];
+        }
+
+        const clock::time_point t0 = clock::now();
+        gyroUpdate();
+        const clock::time_point t1 = clock::now();
+        gyroFilter();
+        const clock::time_point t2 = clock::now();
+        updatePIDCoefficients();
+        pidController(dT);
+        const clock::time_point t3 = clock::now();
+        mixTable();
+        const clock::time_point t4 = clock::now();
+
+        result->stageNs[REPLAY_STAGE_GYRO_UPDATE] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        result->stageNs[REPLAY_STAGE_GYRO_FILTER] += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        result->stageNs[REPLAY_STAGE_PID_CONTROLLER] += std::chrono::duration<double, std::nano>(t3 - t2).count();
+        result->stageNs[REPLAY_STAGE_MIX_TABLE] += std::chrono::duration<double, std::nano>(t4 - t3).count();
+
+        for (int i = 0; i < REPLAY_MOTOR_COUNT; i++) {
+            if (motor[i] < getThrottleIdleValue() || motor[i] > motorConfig()->maxthrottle) {
+                result->motorsInRange = false;
+            }
+            if (compareMotors) {
+                const int error = motor[i] - frame.motor[i];
+                result->motorErrorSquaredSum += (double)error * error;
+                result->motorErrorMax = MAX(result->motorErrorMax, ABS(error));
+            }
+        }
+    }
+
+    for (int stage = 0; stage < REPLAY_STAGE_COUNT; stage++) {
+        result->stageNs[stage] /= frames.size();
+    }
+}
+
+TEST(FlightReplayBenchmark, GyroPidMixerChain)
+{
+    std::vector<replayFrame_t> frames;
+    bool hasMotors = false;
+
+    const char *path = getenv("INAV_REPLAY_CSV");
+    if (path) {
+        ASSERT_TRUE(replayLoadCsv(path, frames, &hasMotors)) << "cannot replay " << path;
+    } else {
+        replayGenerateSynthetic(frames);
+    }
+
+    replayResult_t result;
+    replayRun(frames, hasMotors, &result);
+
+    printf("[ REPLAY   ] %s, %u frames\n", path ? path : "synthetic flight", (unsigned)frames.size());
+    for (int stage = 0; stage < REPLAY_STAGE_COUNT; stage++) {
+        printf("[ REPLAY   ] %-14s %8.1f ns/frame\n", replayStageNames[stage], result.stageNs[stage]);
+    }
+    if (hasMotors) {
+        printf("[ REPLAY   ] motor divergence: rms %.2f, max %d\n",
+            sqrt(result.motorErrorSquaredSum / (frames.size() * REPLAY_MOTOR_COUNT)), result.motorErrorMax);
+    }
+
+    EXPECT_TRUE(result.motorsInRange);
+
+    // Replaying the same frames must reproduce the same motor outputs
+    int16_t lastMotors[REPLAY_MOTOR_COUNT];
+    memcpy(lastMotors, motor, sizeof(lastMotors));
+    replayRun(frames, false, &result);
+    for (int i = 0; i < REPLAY_MOTOR_COUNT; i++) {
+        EXPECT_EQ(lastMotors[i], motor[i]);
+    }
+}
+
+// STUBS
+
+extern "C" {
+static timeMs_t milliTime = 0;
+timeMs_t millis(void) {return milliTime++;}
+uint32_t micros(void) {return 0;}
+void delay(timeMs_t) {}
+void beeper(beeperMode_e) {}
+uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+timeDelta_t getLooptime(void) {return REPLAY_LOOPTIME_US;}
+timeDelta_t getGyroLooptime(void) {return gyro.targetLooptime;}
+void sensorsSet(uint32_t) {}
+void schedulerResetTaskStatistics(cfTaskId_e) {}
+
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+uint32_t stateFlags;
+attitudeEulerAngles_t attitude;
+int16_t rcCommand[4];
+
+static controlRateConfig_t replayControlRateProfile = {
+    .throttle = { .rcMid8 = 50, .rcExpo8 = 0, .dynPID = 0, .pa_breakpoint = 1500, .fixedWingTauMs = 0 },
+    .stabilized = { .rcExpo8 = 70, .rcYawExpo8 = 20, .rates = { 20, 20, 20 } },
+};
+const controlRateConfig_t *currentControlRateProfile = &replayControlRateProfile;
+controlRateConfig_t controlRateProfiles_SystemArray[MAX_CONTROL_RATE_PROFILE_COUNT];
+uint8_t getConfigProfile(void) {return 0;}
+
+static batteryProfile_t replayBatteryProfile;
+const batteryProfile_t *currentBatteryProfile = &replayBatteryProfile;
+
+rcControlsConfig_t rcControlsConfig_System;
+navConfig_t navConfig_System;
+
+bool feature(uint32_t) {return false;}
+bool IS_RC_MODE_ACTIVE(boxId_e) {return false;}
+bool areSticksDeflected(void) {return true;}
+int32_t getRcStickDeflection(int32_t) {return 0;}
+int16_t rxGetChannelValue(unsigned) {return PWM_RANGE_MIDDLE;}
+float rcLookupTpa(tpaCurve_e, uint16_t) {return 1.0f;}
+throttleStatus_e calculateThrottleStatus(throttleStatusType_e) {return THROTTLE_HIGH;}
+rollPitchStatus_e calculateRollPitchCenterStatus(void) {return NOT_CENTERED;}
+float calculateCosTiltAngle(void) {return 1.0f;}
+float calculateThrottleCompensationFactor(void) {return 1.0f;}
+void imuTransformVectorEarthToBody(fpVector3_t *) {}
+bool isAmperageConfigured(void) {return false;}
+bool failsafeIsActive(void) {return false;}
+bool failsafeRequiresMotorStop(void) {return false;}
+float getEstimatedActualVelocity(int) {return 0;}
+bool isFlightAxisAngleOverrideActive(uint8_t) {return false;}
+float getFlightAxisAngleOverride(uint8_t, float angle) {return angle;}
+float getFlightAxisRateOverride(uint8_t, float rate) {return rate;}
+int16_t getRcCommandOverride(int16_t command[], uint8_t axis) {return command[axis];}
+int8_t navigationGetHeadingControlState(void) {return NAV_HEADING_CONTROL_NONE;}
+bool navigationInAutomaticThrottleMode(void) {return false;}
+bool navigationIsControllingAltitude(void) {return false;}
+bool navigationIsControllingThrottle(void) {return false;}
+bool navigationIsFlyingAutonomousMode(void) {return false;}
+bool navigationRequiresTurnAssistance(void) {return false;}
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+void pwmWriteMotor(uint8_t, uint16_t) {}
+}
@@ -0,0 +1,210 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+
+    #include "io/gps.h"
+    #include "io/gps_blend.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BASE_LAT    473977000   // 1e-7 deg
+#define BASE_LON    85455000
+#define CM_PER_DEG_E7   1.113195f
+
+static gpsSolutionData_t makeSolution(timeUs_t timeUs, float northCm, uint16_t eph)
+{
+    gpsSolutionData_t solution;
+    memset(&solution, 0, sizeof(solution));
+
+    solution.fixType = GPS_FIX_3D;
+    solution.numSat = 12;
+    solution.llh.lat = BASE_LAT + lrintf(northCm / CM_PER_DEG_E7);
+    solution.llh.lon = BASE_LON;
+    solution.llh.alt = 10000;
+    solution.eph = eph;
+    solution.epv = eph;
+    solution.flags.validEPE = true;
+    solution.flags.validVelNE = true;
+    solution.flags.validVelD = true;
+    solution.sample.timeUs = timeUs;
+
+    return solution;
+}
+
+static float northOf(const gpsSolutionData_t &solution)
+{
+    return (solution.llh.lat - BASE_LAT) * CM_PER_DEG_E7;
+}
+
+TEST(GpsBlendTest, SingleReceiverPassesThrough)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 150);
+    const gpsSolutionData_t *solutions[2] = { &first, NULL };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_EQ(out.llh.lat, first.llh.lat);
+    EXPECT_EQ(out.llh.lon, first.llh.lon);
+    EXPECT_EQ(out.eph, 150);
+}
+
+TEST(GpsBlendTest, WeightsByReportedAccuracy)
+{
+    gpsBlendReset();
+
+    // The second receiver is three times less accurate, so it gets a tenth of the weight
+    gpsSolutionData_t first = makeSolution(1000000, 0, 100);
+    gpsSolutionData_t second = makeSolution(1000000, 200, 300);
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_NEAR(northOf(out), 20, 2);
+    EXPECT_NEAR(out.eph, 120, 1);
+
+    // Solutions of the receiver that is not followed don't make an output
+    EXPECT_FALSE(gpsBlendUpdate(solutions, 2, 1, &out));
+}
+
+TEST(GpsBlendTest, AlignsTheOtherReceiverInTime)
+{
+    gpsBlendReset();
+
+    // Both receivers see the same track at 10m/s north, the second 100ms earlier
+    gpsSolutionData_t first = makeSolution(1000000, 100, 100);
+    gpsSolutionData_t second = makeSolution(900000, 0, 200);
+    first.velNED[X] = second.velNED[X] = 1000;
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_NEAR(northOf(out), 100, 2);
+    EXPECT_EQ(out.velNED[X], 1000);
+}
+
+TEST(GpsBlendTest, DisagreeingReceiversAreNotBlended)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 100);
+    gpsSolutionData_t second = makeSolution(1000000, 10000, 100);
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_NEAR(northOf(out), 0, 2);
+}
+
+TEST(GpsBlendTest, FollowsTheMoreAccurateReceiver)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 500);
+    gpsSolutionData_t second = makeSolution(1000000, 0, 100);
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_FALSE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 1, &out));
+
+    // Small changes in accuracy don't switch back and forth
+    first.eph = 90;
+    first.sample.timeUs = second.sample.timeUs = 1200000;
+    EXPECT_FALSE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 1, &out));
+
+    first.eph = 50;
+    first.sample.timeUs = 1400000;
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+}
+
+TEST(GpsBlendTest, SwitchDoesNotStepTheOutput)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 100);
+    gpsSolutionData_t second = makeSolution(1000000, 300, 100);
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_NEAR(northOf(out), 150, 2);
+
+    // Second receiver lost, the output stays and then moves to the first one
+    solutions[1] = NULL;
+    first.sample.timeUs = 1200000;
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_NEAR(northOf(out), 150, 2);
+
+    float lastNorth = northOf(out);
+    for (timeUs_t timeUs = 1400000; timeUs <= 10000000; timeUs += 200000) {
+        first.sample.timeUs = timeUs;
+        EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+        EXPECT_LE(northOf(out), lastNorth + 1);
+        lastNorth = northOf(out);
+    }
+    EXPECT_NEAR(northOf(out), 0, 2);
+}
+
+TEST(GpsBlendTest, GlitchingReceiverIsLeftOut)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 100);
+    gpsSolutionData_t second = makeSolution(1000000, 0, 80);
+    const gpsSolutionData_t *solutions[2] = { &first, &second };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 1, &out));
+
+    // The followed receiver jumps 50m while standing still, the other one takes over
+    second = makeSolution(1200000, 5000, 80);
+    first.sample.timeUs = 1200000;
+    EXPECT_FALSE(gpsBlendUpdate(solutions, 2, 1, &out));
+    first.sample.timeUs = 1210000;
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_LT(northOf(out), 100);
+}
+
+TEST(GpsBlendTest, NoFixFollowsARunningReceiver)
+{
+    gpsBlendReset();
+
+    gpsSolutionData_t first = makeSolution(1000000, 0, 100);
+    first.fixType = GPS_NO_FIX;
+    first.numSat = 3;
+    const gpsSolutionData_t *solutions[2] = { &first, NULL };
+    gpsSolutionData_t out;
+
+    EXPECT_TRUE(gpsBlendUpdate(solutions, 2, 0, &out));
+    EXPECT_EQ(out.fixType, GPS_NO_FIX);
+    EXPECT_EQ(out.numSat, 3);
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host-side loop-time benchmark of the gyro half of taskMainPidLoop().
+ * A deterministic synthetic gyro stream (two sines plus LCG noise) is replayed
+ * through gyroUpdate() + gyroFilter() for each filter stack and the mean cost
+ * per loop is reported. Numbers are host CPU numbers and are only meaningful
+ * relative to each other; the test asserts that the replay is reproducible.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <math.h>
+#include <chrono>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/build_config.h"
+    #include "build/debug.h"
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+    #include "drivers/accgyro/accgyro_fake.h"
+    #include "io/beeper.h"
+    #include "scheduler/scheduler.h"
+    #include "sensors/gyro.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/sensors.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_LOOPS     20000
+
+typedef struct {
+    const char *name;
+    uint8_t antiAliasingType;
+    uint16_t antiAliasingHz;
+    uint8_t mainType;
+    uint16_t mainHz;
+} benchmarkFilterStack_t;
+
+static const benchmarkFilterStack_t filterStacks[] = {
+    { "no filtering",       FILTER_PT1,    0,   FILTER_PT1,    0   },
+    { "pt1 main",           FILTER_PT1,    0,   FILTER_PT1,    110 },
+    { "biquad main",        FILTER_PT1,    0,   FILTER_BIQUAD, 110 },
+    { "pt1 aa + pt1 main",  FILTER_PT1,    250, FILTER_PT1,    110 },
+    { "pt1 aa + biq main",  FILTER_PT1,    250, FILTER_BIQUAD, 110 },
+    { "biq aa + biq main",  FILTER_BIQUAD, 250, FILTER_BIQUAD, 110 },
+};
+
+static uint32_t lcgState;
+
+static int16_t benchmarkSample(uint32_t loop, int axis)
+{
+    lcgState = lcgState * 1664525 + 1013904223;
+    const float t = loop * 0.00025f;
+    const float signal = 800.0f * sin_approx(2 * M_PIf * 12 * t + axis) + 150.0f * sin_approx(2 * M_PIf * 230 * t);
+    const float noise = (int32_t)(lcgState >> 16) % 200 - 100;
+    return (int16_t)(signal + noise);
+}
+
+static double benchmarkRun(const benchmarkFilterStack_t *stack, float *output)
+{
+    gyroConfigMutable()->gyro_anti_aliasing_lpf_type = stack->antiAliasingType;
+    gyroConfigMutable()->gyro_anti_aliasing_lpf_hz = stack->antiAliasingHz;
+    gyroConfigMutable()->gyro_main_lpf_type = stack->mainType;
+    gyroConfigMutable()->gyro_main_lpf_hz = stack->mainHz;
+
+    gyroInit();
+    gyroStartCalibration();
+    fakeGyroSet(0, 0, 0);
+    while (!gyroIsCalibrationComplete()) {
+        gyroUpdate();
+    }
+
+    lcgState = 0x12345678;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t loop = 0; loop < BENCHMARK_LOOPS; loop++) {
+        fakeGyroSet(benchmarkSample(loop, X), benchmarkSample(loop, Y), benchmarkSample(loop, Z));
+        gyroUpdate();
+        gyroFilter();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        output[axis] = gyro.gyroADCf[axis];
+    }
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / BENCHMARK_LOOPS;
+}
+
+TEST(GyroPipelineBenchmark, FilterStacks)
+{
+    for (unsigned i = 0; i < ARRAYLEN(filterStacks); i++) {
+        float first[XYZ_AXIS_COUNT];
+        float second[XYZ_AXIS_COUNT];
+
+        const double nsPerLoop = benchmarkRun(&filterStacks[i], first);
+        benchmarkRun(&filterStacks[i], second);
+
+        printf("[ BENCH    ] %-20s %8.1f ns/loop\n", filterStacks[i].name, nsPerLoop);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_TRUE(std::isfinite(first[axis]));
+            EXPECT_FLOAT_EQ(first[axis], second[axis]);
+        }
+    }
+}
+
+// STUBS
+
+extern "C" {
+static timeMs_t milliTime = 0;
+timeMs_t millis(void) {return milliTime++;}
+uint32_t micros(void) {return 0;}
+void beeper(beeperMode_e) {}
+uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+uint32_t stateFlags;
+timeDelta_t getLooptime(void) {return gyro.targetLooptime;}
+timeDelta_t getGyroLooptime(void) {return gyro.targetLooptime;}
+void sensorsSet(uint32_t) {}
+void schedulerResetTaskStatistics(cfTaskId_e) {}
+}
@@ -26,6 +26,7 @@
 
 extern "C" {
     #include "common/maths.h"
+    #include "common/quaternion.h"
     #include "common/vector.h"
 }
 
@@ -153,6 +154,67 @@ TEST(MathsUnittest, TestRotateVectorAroundAxis)
     expectVectorsAreEqual(&vector, &expected_result);
 }
 
+TEST(MathsUnittest, TestQuaternionRotateVector)
+{
+    // 90 degrees around Z
+    const fpQuaternion_t q = { 0.707106781f, 0.0f, 0.0f, 0.707106781f };
+    const fpVector3_t v = { 1.0f, 2.0f, 3.0f };
+    fpVector3_t r;
+
+    // The same rotations written as two quaternion products
+    fpQuaternion_t vq = { 0.0f, v.x, v.y, v.z };
+    fpQuaternion_t qConj, ref;
+
+    quaternionConjugate(&qConj, &q);
+    quaternionMultiply(&ref, &q, &vq);
+    quaternionMultiply(&ref, &ref, &qConj);
+    quaternionRotateVectorInv(&r, &v, &q);
+    EXPECT_NEAR(r.x, ref.q1, 1e-6);
+    EXPECT_NEAR(r.y, ref.q2, 1e-6);
+    EXPECT_NEAR(r.z, ref.q3, 1e-6);
+    EXPECT_NEAR(r.x, -2.0f, 1e-6);
+    EXPECT_NEAR(r.y, 1.0f, 1e-6);
+
+    quaternionMultiply(&ref, &qConj, &vq);
+    quaternionMultiply(&ref, &ref, &q);
+    quaternionRotateVector(&r, &v, &q);
+    EXPECT_NEAR(r.x, ref.q1, 1e-6);
+    EXPECT_NEAR(r.y, ref.q2, 1e-6);
+    EXPECT_NEAR(r.z, ref.q3, 1e-6);
+    EXPECT_NEAR(r.x, 2.0f, 1e-6);
+    EXPECT_NEAR(r.y, -1.0f, 1e-6);
+}
+
+TEST(MathsUnittest, TestEllipsoidFit)
+{
+    const float offset[3] = { 0.2f, -0.1f, 0.05f };
+    const float radius[3] = { 1.1f, 0.9f, 1.05f };
+
+    ellipsoidFitState_t state;
+    ellipsoidFitReset(&state, 1.0f);
+
+    // Walk the samples around the ellipsoid surface
+    for (int i = 0; i < 400; i++) {
+        const float lat = asinf(2.0f * ((i * 37) % 400) / 400.0f - 1.0f);
+        const float lon = i * 2.39996f;
+        const float sample[3] = {
+            offset[0] + radius[0] * cosf(lat) * cosf(lon),
+            offset[1] + radius[1] * cosf(lat) * sinf(lon),
+            offset[2] + radius[2] * sinf(lat),
+        };
+        ellipsoidFitPushSample(&state, sample);
+    }
+
+    float fitOffset[3];
+    float fitRadius[3];
+    EXPECT_TRUE(ellipsoidFitSolve(&state, fitOffset, fitRadius));
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(fitOffset[i], offset[i], 1e-2);
+        EXPECT_NEAR(fitRadius[i], radius[i], 1e-2);
+    }
+}
+
 #if defined(FAST_MATH) || defined(VERY_FAST_MATH)
 TEST(MathsUnittest, TestFastTrigonometrySinCos)
 {
@@ -185,6 +247,21 @@ TEST(MathsUnittest, TestFastTrigonometrySinCos)
     EXPECT_NEAR(cos_approx(-2 * M_PIf - 3 * M_PIf / 4), -0.707106781f, 1e-6);
 }
 
+TEST(MathsUnittest, TestFastTrigonometryPairedSinCos)
+{
+    float x[64], s[64], c[64];
+    for (int i = 0; i < 64; i++) {
+        x[i] = -4 * M_PIf + i * (8 * M_PIf / 63);
+    }
+
+    sincos_approx_array(x, s, c, 64);
+
+    for (int i = 0; i < 64; i++) {
+        EXPECT_NEAR(s[i], sin_approx(x[i]), 1e-6);
+        EXPECT_NEAR(c[i], cos_approx(x[i]), 1e-6);
+    }
+}
+
 TEST(MathsUnittest, TestFastTrigonometryATan2)
 {
     EXPECT_NEAR(atan2_approx(1, 1),          M_PIf / 4, 1e-6);
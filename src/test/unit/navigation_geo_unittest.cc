@@ -0,0 +1,110 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+
+// navigation_private.h is C11
+#define _Static_assert static_assert
+
+extern "C" {
+    #include "platform.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_private.h"
+
+    navigationPosControl_t posControl;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define EARTH_RADIUS_CM 637100000.0
+
+// Great circle distance and bearing, the reference for the local conversions
+static double referenceDistance(const gpsLocation_t *a, const gpsLocation_t *b)
+{
+    const double lat1 = a->lat * 1e-7 * M_PI / 180.0;
+    const double lat2 = b->lat * 1e-7 * M_PI / 180.0;
+    const double dLat = lat2 - lat1;
+    const double dLon = (b->lon - a->lon) * 1e-7 * M_PI / 180.0;
+    const double h = sin(dLat / 2) * sin(dLat / 2) + cos(lat1) * cos(lat2) * sin(dLon / 2) * sin(dLon / 2);
+
+    return 2.0 * EARTH_RADIUS_CM * asin(sqrt(h));
+}
+
+static void testLongRangeAccuracy(int32_t originLat)
+{
+    const gpsLocation_t originLLH = { .lat = originLat, .lon = 100000000, .alt = 0 };
+    gpsOrigin_t origin;
+    geoSetOrigin(&origin, &originLLH, GEO_ORIGIN_SET);
+
+    // Points up to ~100km from the origin in every direction
+    for (int bearing = 0; bearing < 360; bearing += 15) {
+        for (int32_t offset = 1000000; offset <= 9000000; offset += 2000000) {
+            const gpsLocation_t llh = {
+                .lat = originLat + (int32_t)(offset * cos(bearing * M_PI / 180.0)),
+                .lon = originLLH.lon + (int32_t)(offset * sin(bearing * M_PI / 180.0) / cos(originLat * 1e-7 * M_PI / 180.0)),
+                .alt = 10000,
+            };
+
+            fpVector3_t pos;
+            ASSERT_TRUE(geoConvertGeodeticToLocal(&pos, &origin, &llh, GEO_ALT_ABSOLUTE));
+
+            // Within 0.5% of the great circle distance
+            const double distance = sqrt((double)pos.x * pos.x + (double)pos.y * pos.y);
+            const double reference = referenceDistance(&originLLH, &llh);
+            EXPECT_NEAR(distance, reference, reference * 0.005);
+
+            // Converting back gets the same location
+            gpsLocation_t back;
+            ASSERT_TRUE(geoConvertLocalToGeodetic(&back, &origin, &pos));
+            EXPECT_NEAR(back.lat, llh.lat, 2);
+            EXPECT_NEAR(back.lon, llh.lon, 2);
+            EXPECT_EQ(back.alt, llh.alt);
+        }
+    }
+}
+
+TEST(NavigationGeoUnittest, LongRangeAccuracyEquator)
+{
+    testLongRangeAccuracy(0);
+}
+
+TEST(NavigationGeoUnittest, LongRangeAccuracyMidLatitude)
+{
+    testLongRangeAccuracy(450000000);
+}
+
+TEST(NavigationGeoUnittest, LongRangeAccuracyHighLatitude)
+{
+    testLongRangeAccuracy(-650000000);
+}
+
+TEST(NavigationGeoUnittest, InvalidOrigin)
+{
+    gpsOrigin_t origin = { .valid = false };
+    const gpsLocation_t llh = { .lat = 450000000, .lon = 100000000, .alt = 100 };
+    fpVector3_t pos;
+
+    EXPECT_FALSE(geoConvertGeodeticToLocal(&pos, &origin, &llh, GEO_ALT_ABSOLUTE));
+    EXPECT_EQ(pos.x, 0.0f);
+    EXPECT_EQ(pos.y, 0.0f);
+    EXPECT_EQ(pos.z, 0.0f);
+}
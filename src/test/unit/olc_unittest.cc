@@ -67,3 +67,20 @@ TEST(OLCTest, TestEncode)
         EXPECT_EQ(c.result, (string)buf);
     }
 }
+
+TEST(OLCTest, TestEncodeCached)
+{
+    char buf[20];
+    char cached[20];
+
+    // Every length of the same position comes from one cached code
+    for (unsigned ii = 0; ii < ARRAYLEN(encodeCases); ii++) {
+        struct EncodeCase c = encodeCases[ii];
+        int32_t lat = c.lat * OLC_DEG_MULTIPLIER;
+        int32_t lon = c.lon * OLC_DEG_MULTIPLIER;
+        for (int length = 8; length <= 15; length++) {
+            EXPECT_EQ(olc_encode(lat, lon, length, buf, sizeof(buf)), olc_encode_cached(lat, lon, length, cached, sizeof(cached)));
+            EXPECT_EQ((string)buf, (string)cached);
+        }
+    }
+}
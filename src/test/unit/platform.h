@@ -75,6 +75,14 @@ typedef struct
 
 extern SysTick_Type *SysTick;
 
+typedef struct
+{
+  uint32_t CTRL;                    /*!< Offset: 0x000 (R/W)  Control Register */
+  uint32_t CYCCNT;                  /*!< Offset: 0x004 (R/W)  Cycle Count Register */
+} DWT_Type;
+
+extern DWT_Type *DWT;
+
 
 #define WS2811_DMA_TC_FLAG 1
 #define WS2811_DMA_HANDLER_IDENTIFER 0
@@ -0,0 +1,173 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/bitarray.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "rx/rx.h"
+
+    int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    int16_t rcCommand[4];
+    uint32_t stateFlags;
+    uint32_t armingFlags;
+    rcControlsConfig_t rcControlsConfig_System;
+
+    int16_t rxGetChannelValue(unsigned ch)
+    {
+        return rcData[ch];
+    }
+
+    bool feature(uint32_t mask)
+    {
+        UNUSED(mask);
+        return false;
+    }
+}
+
+static void resetConditions(void)
+{
+    memset(modeActivationConditionsMutable(0), 0, sizeof(modeActivationCondition_t) * MAX_MODE_ACTIVATION_CONDITION_COUNT);
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        rcData[i] = 1500;
+    }
+}
+
+static void setCondition(int index, boxId_e modeId, uint8_t auxChannelIndex, uint16_t start, uint16_t end)
+{
+    modeActivationConditionsMutable(index)->modeId = modeId;
+    modeActivationConditionsMutable(index)->auxChannelIndex = auxChannelIndex;
+    modeActivationConditionsMutable(index)->range.startStep = CHANNEL_VALUE_TO_STEP(start);
+    modeActivationConditionsMutable(index)->range.endStep = CHANNEL_VALUE_TO_STEP(end);
+}
+
+// Reference evaluation, one isRangeActive() per condition
+static bool isModeActiveReference(boxId_e modeId)
+{
+    int specified = 0, active = 0;
+    for (int i = 0; i < MAX_MODE_ACTIVATION_CONDITION_COUNT; i++) {
+        const modeActivationCondition_t *condition = modeActivationConditions(i);
+        if (condition->modeId == modeId && IS_RANGE_USABLE(&condition->range)) {
+            specified++;
+            active += isRangeActive(condition->auxChannelIndex, &condition->range);
+        }
+    }
+
+    if (modeActivationOperatorConfig()->modeActivationOperator == MODE_OPERATOR_AND) {
+        return specified > 0 && active == specified;
+    }
+    return active > 0;
+}
+
+TEST(RcModesTest, RangeEdges)
+{
+    resetConditions();
+    modeActivationOperatorConfigMutable()->modeActivationOperator = MODE_OPERATOR_OR;
+    setCondition(0, BOXARM, 0, 1700, 2100);
+    updateUsedModeActivationConditionFlags();
+
+    rcData[NON_AUX_CHANNEL_COUNT] = 1699;
+    updateActivatedModes();
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(BOXARM));
+
+    rcData[NON_AUX_CHANNEL_COUNT] = 1700;
+    updateActivatedModes();
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXARM));
+
+    rcData[NON_AUX_CHANNEL_COUNT] = 2099;
+    updateActivatedModes();
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXARM));
+
+    rcData[NON_AUX_CHANNEL_COUNT] = 2100;
+    updateActivatedModes();
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(BOXARM));
+
+    rcData[NON_AUX_CHANNEL_COUNT] = 800;
+    updateActivatedModes();
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(BOXARM));
+}
+
+TEST(RcModesTest, OverlappingRangesAndLogic)
+{
+    resetConditions();
+    modeActivationOperatorConfigMutable()->modeActivationOperator = MODE_OPERATOR_AND;
+    setCondition(0, BOXANGLE, 1, 900, 1600);
+    setCondition(1, BOXANGLE, 2, 1300, 2100);
+    setCondition(2, BOXHORIZON, 1, 1400, 2100);
+    updateUsedModeActivationConditionFlags();
+
+    rcData[NON_AUX_CHANNEL_COUNT + 1] = 1500;
+    rcData[NON_AUX_CHANNEL_COUNT + 2] = 1000;
+    updateActivatedModes();
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(BOXANGLE));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXHORIZON));
+
+    rcData[NON_AUX_CHANNEL_COUNT + 2] = 1800;
+    updateActivatedModes();
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXANGLE));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXHORIZON));
+
+    // Operator changes take effect without a channel moving
+    modeActivationOperatorConfigMutable()->modeActivationOperator = MODE_OPERATOR_OR;
+    rcData[NON_AUX_CHANNEL_COUNT + 2] = 1000;
+    updateActivatedModes();
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(BOXANGLE));
+}
+
+TEST(RcModesTest, MatchesReferenceEvaluation)
+{
+    srand(1);
+
+    for (int round = 0; round < 50; round++) {
+        resetConditions();
+        modeActivationOperatorConfigMutable()->modeActivationOperator = (round & 1) ? MODE_OPERATOR_AND : MODE_OPERATOR_OR;
+
+        for (int i = 0; i < MAX_MODE_ACTIVATION_CONDITION_COUNT; i++) {
+            modeActivationConditionsMutable(i)->modeId = (boxId_e)(rand() % 8);
+            modeActivationConditionsMutable(i)->auxChannelIndex = rand() % 4;
+            modeActivationConditionsMutable(i)->range.startStep = rand() % (MAX_MODE_RANGE_STEP + 1);
+            modeActivationConditionsMutable(i)->range.endStep = rand() % (MAX_MODE_RANGE_STEP + 1);
+        }
+        updateUsedModeActivationConditionFlags();
+
+        for (int sample = 0; sample < 200; sample++) {
+            rcData[NON_AUX_CHANNEL_COUNT + rand() % 4] = 850 + rand() % 1300;
+            updateActivatedModes();
+
+            for (int modeId = 0; modeId < 8; modeId++) {
+                ASSERT_EQ(isModeActiveReference((boxId_e)modeId), IS_RC_MODE_ACTIVE((boxId_e)modeId)) << "round " << round << " mode " << modeId;
+            }
+        }
+    }
+}
@@ -725,12 +725,10 @@ extern "C" {
             s.vTable = NULL;
 
             // common serial initialisation code should move to serialPort::init()
-            s.rxBufferHead = s.rxBufferTail = 0;
-            s.txBufferHead = s.txBufferTail = 0;
-            s.rxBufferSize = 0;
-            s.txBufferSize = 0;
-            s.rxBuffer = s.rxBuffer;
-            s.txBuffer = s.txBuffer;
+            spscRingReset(&s.rxRing);
+            spscRingReset(&s.txRing);
+            s.rxRing.size = 0;
+            s.txRing.size = 0;
 
             // callback works for IRQ-based RX ONLY
             s.rxCallback = callback;
@@ -141,6 +141,7 @@ timeMs_t millis(void) {return milliTime++;}
 uint32_t micros(void) {return 0;}
 void beeper(beeperMode_e) {}
 uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+uint32_t stateFlags;
 timeDelta_t getLooptime(void) {return gyro.targetLooptime;}
 timeDelta_t getGyroLooptime(void) {return gyro.targetLooptime;}
 void sensorsSet(uint32_t) {}
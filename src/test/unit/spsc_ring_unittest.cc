@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+extern "C" {
+#include "common/spsc_ring.h"
+}
+
+#include "gtest/gtest.h"
+
+TEST(SpscRingTest, OneSlotStaysEmpty)
+{
+    volatile uint8_t buffer[8];
+    spscRing_t ring;
+    spscRingInit(&ring, buffer, sizeof(buffer));
+
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+    EXPECT_EQ(spscRingFree(&ring), 7u);
+
+    for (int i = 0; i < 7; i++) {
+        EXPECT_TRUE(spscRingPut(&ring, i));
+    }
+    EXPECT_FALSE(spscRingPut(&ring, 7));
+    EXPECT_EQ(spscRingCount(&ring), 7u);
+    EXPECT_EQ(spscRingFree(&ring), 0u);
+
+    uint8_t ch;
+    for (int i = 0; i < 7; i++) {
+        EXPECT_TRUE(spscRingGet(&ring, &ch));
+        EXPECT_EQ(ch, i);
+    }
+    EXPECT_FALSE(spscRingGet(&ring, &ch));
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+}
+
+TEST(SpscRingTest, SpansStopAtTheWrap)
+{
+    volatile uint8_t buffer[8];
+    spscRing_t ring;
+    spscRingInit(&ring, buffer, sizeof(buffer));
+
+    // Move both indices to 6
+    uint8_t scratch[6] = { 0 };
+    EXPECT_EQ(spscRingWrite(&ring, scratch, 6), 6u);
+    EXPECT_EQ(spscRingRead(&ring, scratch, 6), 6u);
+
+    volatile uint8_t *span;
+    EXPECT_EQ(spscRingWriteSpan(&ring, &span), 2u);
+    EXPECT_EQ(span, &buffer[6]);
+    span[0] = 10;
+    span[1] = 11;
+    spscRingCommitWrite(&ring, 2);
+
+    EXPECT_EQ(ring.head, 0u);
+    // Tail at 6 leaves slots 0 to 4 free
+    EXPECT_EQ(spscRingWriteSpan(&ring, &span), 5u);
+    EXPECT_EQ(span, &buffer[0]);
+    span[0] = 12;
+    spscRingCommitWrite(&ring, 1);
+
+    EXPECT_EQ(spscRingReadSpan(&ring, &span), 2u);
+    EXPECT_EQ(span[0], 10);
+    EXPECT_EQ(span[1], 11);
+    spscRingCommitRead(&ring, 2);
+
+    EXPECT_EQ(spscRingReadSpan(&ring, &span), 1u);
+    EXPECT_EQ(span[0], 12);
+    spscRingCommitRead(&ring, 1);
+    EXPECT_EQ(spscRingReadSpan(&ring, &span), 0u);
+}
+
+TEST(SpscRingTest, BulkCopyWrapsAround)
+{
+    volatile uint8_t buffer[16];
+    spscRing_t ring;
+    spscRingInit(&ring, buffer, sizeof(buffer));
+
+    uint8_t in[32];
+    uint8_t out[32];
+    for (unsigned i = 0; i < sizeof(in); i++) {
+        in[i] = i;
+    }
+
+    EXPECT_EQ(spscRingWrite(&ring, in, 10), 10u);
+    EXPECT_EQ(spscRingRead(&ring, out, 10), 10u);
+
+    // Only size - 1 fit, split across the end of the buffer
+    EXPECT_EQ(spscRingWrite(&ring, in, sizeof(in)), 15u);
+    EXPECT_EQ(spscRingWrite(&ring, in, 1), 0u);
+
+    memset(out, 0, sizeof(out));
+    EXPECT_EQ(spscRingRead(&ring, out, sizeof(out)), 15u);
+    EXPECT_EQ(memcmp(in, out, 15), 0);
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+}
+
+TEST(SpscRingTest, SetHeadPublishesStreamPosition)
+{
+    volatile uint8_t buffer[8];
+    spscRing_t ring;
+    spscRingInit(&ring, buffer, sizeof(buffer));
+
+    // A circular stream wrote 3 bytes and reports a position at the end of the buffer as 8
+    buffer[5] = 1;
+    buffer[6] = 2;
+    buffer[7] = 3;
+    ring.head = ring.tail = 5;
+    spscRingSetHead(&ring, 8);
+
+    EXPECT_EQ(ring.head, 0u);
+    EXPECT_EQ(spscRingCount(&ring), 3u);
+
+    spscRingFlush(&ring);
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+}
+
+TEST(SpscRingTest, ProducerAndConsumerThreads)
+{
+    volatile uint8_t buffer[64];
+    spscRing_t ring;
+    spscRingInit(&ring, buffer, sizeof(buffer));
+
+    const int total = 200000;
+
+    std::thread producer([&ring]() {
+        for (int i = 0; i < total; ) {
+            uint8_t chunk[7];
+            int count = 0;
+            while (count < 7 && i + count < total) {
+                chunk[count] = (i + count) & 0xFF;
+                count++;
+            }
+            i += spscRingWrite(&ring, chunk, count);
+        }
+    });
+
+    int received = 0;
+    bool inOrder = true;
+    while (received < total) {
+        volatile uint8_t *span;
+        const uint32_t count = spscRingReadSpan(&ring, &span);
+        for (uint32_t n = 0; n < count; n++) {
+            inOrder &= span[n] == ((received + n) & 0xFF);
+        }
+        spscRingCommitRead(&ring, count);
+        received += count;
+    }
+
+    producer.join();
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "common/time.h"
+    #include "drivers/time.h"
+    extern uint32_t usTicks;
+    extern volatile timeMs_t sysTickUptime;
+    void SysTick_Handler(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+SysTick_Type SysTickValue;
+SysTick_Type *SysTick = &SysTickValue;
+
+DWT_Type DWTValue;
+DWT_Type *DWT = &DWTValue;
+
+TEST(TimeDwtUnittest, TestMicros)
+{
+    usTicks = 480;
+    sysTickUptime = 0;
+    DWT->CYCCNT = 0;
+    timebaseInit();
+
+    EXPECT_EQ(0, micros());
+    DWT->CYCCNT = 479;
+    EXPECT_EQ(0, micros());
+    DWT->CYCCNT = 480;
+    EXPECT_EQ(1, micros());
+    DWT->CYCCNT = 480 * 999 + 1;
+    EXPECT_EQ(999, micros());
+    DWT->CYCCNT = 480 * 1000;
+    EXPECT_EQ(1000, micros());
+
+    // SysTick moves the time base along without changing the result
+    SysTick_Handler();
+    EXPECT_EQ(1000, micros());
+    DWT->CYCCNT += 480 * 250 + 100;
+    EXPECT_EQ(1250, micros());
+
+    // Late SysTick, the cycles past 1ms are kept
+    DWT->CYCCNT += 480 * 3000;
+    EXPECT_EQ(4250, micros());
+    SysTick_Handler();
+    EXPECT_EQ(4250, micros());
+}
+
+TEST(TimeDwtUnittest, TestCycleCounterWrap)
+{
+    usTicks = 168;
+    sysTickUptime = 0;
+    DWT->CYCCNT = UINT32_MAX - 168 * 500;
+    timebaseInit();
+
+    EXPECT_EQ(0, micros());
+    DWT->CYCCNT += 168 * 1000;
+    EXPECT_EQ(1000, micros());
+    SysTick_Handler();
+
+    // Many wraps of the cycle counter, each one at most a few ms from the last SysTick
+    for (int i = 0; i < 200000; i++) {
+        DWT->CYCCNT += 168 * 1000;
+        SysTick_Handler();
+    }
+    EXPECT_EQ(1000 + 200000 * (timeUs_t)1000, micros());
+}
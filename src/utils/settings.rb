@@ -184,6 +184,60 @@ class NameEncoder
     end
 end
 
+# Builds a minimal perfect hash from the setting names to their indexes,
+# using hash and displace. Names are first hashed into buckets, then each
+# bucket gets the first seed that places all its names into free slots.
+# The hash must match settingNameHash() in fc/settings.c
+class NameHasher
+    SEED_MAX = 0xffff
+
+    attr_reader :bucket_seeds
+    attr_reader :slots
+
+    def initialize(names)
+        @names = names
+        @slots = Array.new(names.length)
+        @bucket_seeds = Array.new(bucket_count(names.length), 0)
+        build
+    end
+
+    def self.hash(name, seed)
+        h = 2166136261 ^ seed
+        name.each_byte do |c|
+            h ^= c
+            h = (h * 16777619) & 0xffffffff
+        end
+        return h
+    end
+
+    private
+    def bucket_count(count)
+        # ~4 names per bucket keeps the seeds table small while the search stays fast
+        [(count + 3) / 4, 1].max
+    end
+
+    def build
+        buckets = Array.new(@bucket_seeds.length) { [] }
+        @names.each_with_index do |name, ii|
+            buckets[NameHasher.hash(name, 0) % buckets.length] << ii
+        end
+        # Place the largest buckets first, while most of the slots are free
+        order = (0...buckets.length).sort_by { |b| [-buckets[b].length, b] }
+        order.each do |b|
+            next if buckets[b].empty?
+            seed = (1..SEED_MAX).find do |s|
+                slots = buckets[b].map { |ii| NameHasher.hash(@names[ii], s) % @slots.length }
+                slots.uniq.length == slots.length && slots.all? { |slot| @slots[slot].nil? }
+            end
+            raise "Could not find a perfect hash for the setting names" if seed.nil?
+            @bucket_seeds[b] = seed
+            buckets[b].each do |ii|
+                @slots[NameHasher.hash(@names[ii], seed) % @slots.length] = ii
+            end
+        end
+    end
+end
+
 class ValueEncoder
     attr_reader :values
 
@@ -390,6 +444,7 @@ class Generator
         end
         buf << "#define SETTINGS_WORDS_BITS_PER_CHAR #{SETTINGS_WORDS_BITS_PER_CHAR}\n"
         buf << "#define SETTINGS_TABLE_COUNT #{@count}\n"
+        buf << "#define SETTINGS_HASH_BUCKET_COUNT #{@name_hasher.bucket_seeds.length}\n"
         offset_type = "uint16_t"
         if can_use_byte_offsetof
             offset_type = "uint8_t"
@@ -631,6 +686,18 @@ class Generator
         end
         buf << "};\n"
 
+        # Write the name hash tables
+        buf << "static const uint16_t settingsHashSeeds[] = {\n"
+        @name_hasher.bucket_seeds.each_slice(16) do |seeds|
+            buf << "\t#{seeds.join(", ")},\n"
+        end
+        buf << "};\n"
+        buf << "static const uint16_t settingsHashIndexes[] = {\n"
+        @name_hasher.slots.each_slice(16) do |indexes|
+            buf << "\t#{indexes.join(", ")},\n"
+        end
+        buf << "};\n"
+
         File.open(file, 'w') {|file| file.write(buf.string)}
     end
 
@@ -1028,6 +1095,7 @@ class Generator
         end
         dputs "Using name encoder with max_length = #{best.max_length}"
         @name_encoder = best
+        @name_hasher = NameHasher.new(names)
     end
 
     def initialize_value_encoder
@@ -0,0 +1,253 @@
+#!/usr/bin/env ruby
+
+# This file is part of INAV.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this file,
+# You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Alternatively, the contents of this file may be used under the terms
+# of the GNU General Public License Version 3, as described below:
+#
+# This file is free software: you may copy, redistribute and/or modify
+# it under the terms of the GNU General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# This file is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see http://www.gnu.org/licenses/.
+
+# Lists the functions reachable from the main loop tasks that are still
+# executed from flash instead of ITCM, and optionally writes a linker script
+# fragment that moves as many of them as fit into ITCM.
+#
+# The call graph is recovered from the disassembly of the linked firmware:
+# direct calls and tail calls, plus functions whose address is loaded from a
+# literal pool (callbacks being passed around). Calls through function
+# pointers stored in RAM can't be followed, their count is reported so the
+# targets can be added with --root.
+
+require 'getoptlong'
+require 'open3'
+require 'set'
+
+TCM_SECTION = ".tcm_code"
+ITCM_REGION = "ITCM_RAM"
+PLACE_HEADER = "/* Generated by tcm_report.rb, do not edit */"
+
+BRANCH_RE = /^(bl|blx|b(eq|ne|cs|cc|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|hs|lo)?(\.w|\.n)?|call|jmp)q?$/
+INDIRECT_RE = /^(blx|bx|call|jmp)q?$/
+
+class FunctionSymbol
+    attr_reader :name, :address, :size, :section
+    attr_accessor :refs, :indirect_calls
+
+    def initialize(name, address, size, section)
+        @name = name
+        @address = address
+        @size = size
+        @section = section
+        @refs = []
+        @indirect_calls = 0
+    end
+end
+
+class TcmReport
+    def initialize(objdump, elf, map)
+        @objdump = objdump
+        @elf = elf
+        @map = map
+        @functions = {}
+        @by_address = {}
+    end
+
+    def run(cmd)
+        out, err, status = Open3.capture3(*cmd)
+        raise "#{cmd.join(' ')} failed: #{err}" unless status.success?
+        out
+    end
+
+    def load
+        run([@objdump, "-t", "-w", @elf]).each_line do |line|
+            m = /^([0-9a-f]+)\s.*\sF\s+(\S+)\s+([0-9a-f]+)\s+(?:\.hidden\s+)?(\S+)$/.match(line)
+            next unless m
+            fn = FunctionSymbol.new(m[4], m[1].hex, m[3].hex, m[2])
+            # Static functions with the same name share the entry, they are matched by the same input section name
+            @functions[fn.name] ||= fn
+            @by_address[fn.address] = @functions[fn.name]
+        end
+
+        current = nil
+        run([@objdump, "-d", "-w", "--no-show-raw-insn", @elf]).each_line do |line|
+            if (m = /^([0-9a-f]+) <([^>]+)>:$/.match(line))
+                current = @functions[m[2]]
+                next
+            end
+            next unless current
+            m = /^\s*[0-9a-f]+:\s+(\S+)\s*(.*)$/.match(line)
+            next unless m
+            mnemonic, operands = m[1], m[2]
+            if mnemonic == ".word"
+                # Thumb function addresses have their low bit set
+                lit = /^0x([0-9a-f]+)/.match(operands)
+                target = lit && @by_address[lit[1].hex & ~1]
+                current.refs << target.name if target
+            elsif BRANCH_RE.match(mnemonic) && (t = /<([^>+]+)>\s*$/.match(operands))
+                current.refs << t[1] if @functions[t[1]] && t[1] != current.name
+            elsif INDIRECT_RE.match(mnemonic) && operands !~ /^lr\b/ && operands !~ /</
+                current.indirect_calls += 1
+            end
+        end
+    end
+
+    def itcm_size
+        return nil unless @map && File.file?(@map)
+        File.foreach(@map) do |line|
+            m = /^#{ITCM_REGION}\s+0x[0-9a-f]+\s+0x([0-9a-f]+)/.match(line)
+            return m[1].hex if m
+        end
+        nil
+    end
+
+    # Breadth first, so the functions closest to the roots come first
+    def closure(roots)
+        order = []
+        caller = {}
+        seen = Set.new
+        queue = roots.select { |r| @functions[r] }
+        queue.each { |r| seen << r }
+        until queue.empty?
+            name = queue.shift
+            order << name
+            @functions[name].refs.each do |ref|
+                next if seen.include?(ref)
+                seen << ref
+                caller[ref] = name
+                queue << ref
+            end
+        end
+        [order, caller]
+    end
+
+    def report(roots, place_file, reserve)
+        missing = roots.reject { |r| @functions[r] }
+        missing.each { |r| STDERR.puts "warning: #{r} not found in #{@elf}" }
+
+        order, caller = closure(roots)
+        auto_placed = Set.new
+        if place_file && File.file?(place_file)
+            File.foreach(place_file) do |line|
+                m = /^\s*\*\(\.text\.(\S+)\)/.match(line)
+                auto_placed << m[1] if m
+            end
+        end
+
+        tcm_functions = @functions.values.select { |fn| fn.section == TCM_SECTION }
+        hand_placed_size = tcm_functions.reject { |fn| auto_placed.include?(fn.name) }.sum(&:size)
+        auto_placed_size = tcm_functions.select { |fn| auto_placed.include?(fn.name) }.sum(&:size)
+
+        hot = order.map { |name| @functions[name] }
+        in_flash = hot.reject { |fn| fn.section == TCM_SECTION }
+        indirect = hot.sum(&:indirect_calls)
+
+        itcm = itcm_size
+        if itcm
+            puts format("ITCM: %d bytes, %d used by FAST_CODE, %d by automatic placement", itcm, hand_placed_size, auto_placed_size)
+        else
+            puts "No #{ITCM_REGION} region in the memory map, this target can't run code from ITCM"
+        end
+        puts format("Hot path from %s: %d functions, %d bytes, %d bytes of them outside ITCM",
+            roots.join(", "), hot.length, hot.sum(&:size), in_flash.sum(&:size))
+
+        unless in_flash.empty?
+            puts
+            puts format("%8s  %-40s %s", "size", "function", "called from")
+            in_flash.each do |fn|
+                puts format("%8d  %-40s %s", fn.size, fn.name, caller[fn.name] || "(root)")
+            end
+        end
+        if indirect > 0
+            puts
+            puts "#{indirect} call(s) through function pointers in the hot path can't be followed, add their targets with --root"
+        end
+
+        return unless place_file
+
+        picked = []
+        if itcm
+            budget = itcm - hand_placed_size - reserve
+            # Anything already placed by hand stays where it is, the rest is picked closest to the roots first
+            hot.each do |fn|
+                next if fn.section == TCM_SECTION && !auto_placed.include?(fn.name)
+                next if fn.section != TCM_SECTION && !fn.section.start_with?(".text")
+                size = (fn.size + 3) & ~3
+                next if size > budget
+                budget -= size
+                picked << fn.name
+            end
+            puts
+            puts format("Automatic placement: %d functions, %d bytes", picked.length, picked.sum { |n| @functions[n].size })
+        end
+
+        contents = ([PLACE_HEADER] + picked.map { |name| "*(.text.#{name})" }).join("\n") + "\n"
+        old = File.file?(place_file) ? File.read(place_file) : nil
+        # Only touch the file when the placement changes, since the firmware relinks when it does
+        File.write(place_file, contents) if old != contents
+    end
+end
+
+def usage
+    puts "Usage: ruby #{__FILE__} [--objdump <objdump>] [--map <map_file>] [--root <function>]... [--place <ld_file>] [--reserve <bytes>] <elf_file>"
+end
+
+if __FILE__ == $0
+    opts = GetoptLong.new(
+        [ "--objdump", GetoptLong::REQUIRED_ARGUMENT ],
+        [ "--map", "-m", GetoptLong::REQUIRED_ARGUMENT ],
+        [ "--root", "-r", GetoptLong::REQUIRED_ARGUMENT ],
+        [ "--place", "-p", GetoptLong::REQUIRED_ARGUMENT ],
+        [ "--reserve", GetoptLong::REQUIRED_ARGUMENT ],
+        [ "--help", "-h", GetoptLong::NO_ARGUMENT ],
+    )
+
+    objdump = "arm-none-eabi-objdump"
+    map = nil
+    roots = []
+    place_file = nil
+    # Leave some ITCM free, sizes from the symbol table don't include alignment padding or veneers
+    reserve = 256
+
+    opts.each do |opt, arg|
+        case opt
+        when "--objdump"
+            objdump = arg
+        when "--map"
+            map = arg
+        when "--root"
+            roots += arg.split(/[;,]/)
+        when "--place"
+            place_file = arg
+        when "--reserve"
+            reserve = arg.to_i
+        when "--help"
+            usage()
+            exit(0)
+        end
+    end
+
+    elf = ARGV[0]
+    if elf.nil?
+        usage()
+        exit(1)
+    end
+    roots = ["taskMainPidLoop", "taskGyro"] if roots.empty?
+
+    tcm = TcmReport.new(objdump, elf, map)
+    tcm.load
+    tcm.report(roots, place_file, reserve)
+end